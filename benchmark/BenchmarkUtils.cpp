@@ -0,0 +1,137 @@
+#include <BenchmarkUtils.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+
+// Counting the heap allocations of the process by replacing the global operator new. Note that
+// the array and nothrow versions of the standard library call this one
+static std::atomic<unsigned long> num_allocations(0);
+static std::atomic<unsigned long> allocated_bytes(0);
+
+void* operator new(std::size_t size)
+{
+	num_allocations.fetch_add(1, std::memory_order_relaxed);
+	allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	void* ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == NULL)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+
+unsigned long getNumberOfAllocations()
+{
+	return num_allocations.load(std::memory_order_relaxed);
+}
+
+
+unsigned long getAllocatedBytes()
+{
+	return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+
+double getPeakResidentMemory()
+{
+	// Note that the maximum resident set size is in kilobytes in Linux
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0.;
+
+	return usage.ru_maxrss / 1024.;
+}
+
+
+LatencyRecorder::LatencyRecorder(benchmark::State& state) : state_(state)
+{
+	latencies_.reserve(state.max_iterations);
+	allocations_ = getNumberOfAllocations();
+}
+
+
+LatencyRecorder::~LatencyRecorder()
+{
+	unsigned long allocations = getNumberOfAllocations() - allocations_;
+	state_.counters["allocs"] = benchmark::Counter(allocations,
+												   benchmark::Counter::kAvgIterations);
+	if (latencies_.empty())
+		return;
+
+	// Computing the percentiles of the latencies
+	std::sort(latencies_.begin(), latencies_.end());
+	const char* names[3] = {"p50_us", "p90_us", "p99_us"};
+	const double percentiles[3] = {0.5, 0.9, 0.99};
+	for (unsigned int i = 0; i < 3; i++) {
+		unsigned int idx = std::min((unsigned int) (percentiles[i] * latencies_.size()),
+									(unsigned int) latencies_.size() - 1);
+		state_.counters[names[i]] = latencies_[idx];
+	}
+}
+
+
+void LatencyRecorder::start()
+{
+	start_ = Clock::now();
+}
+
+
+void LatencyRecorder::stop()
+{
+	std::chrono::duration<double, std::micro> latency = Clock::now() - start_;
+	latencies_.push_back(latency.count());
+}
+
+
+StageRecorder::StageRecorder(benchmark::State& state,
+							 const std::string& name) : state_(state), name_(name),
+		total_time_(0.), allocations_(0), bytes_(0), start_allocations_(0), start_bytes_(0)
+{
+
+}
+
+
+StageRecorder::~StageRecorder()
+{
+	state_.counters[name_ + "_ms"] = benchmark::Counter(total_time_,
+														benchmark::Counter::kAvgIterations);
+	state_.counters[name_ + "_allocs"] = benchmark::Counter(allocations_,
+															benchmark::Counter::kAvgIterations);
+	state_.counters[name_ + "_kB"] = benchmark::Counter(bytes_ / 1024.,
+														benchmark::Counter::kAvgIterations);
+}
+
+
+void StageRecorder::start()
+{
+	start_allocations_ = getNumberOfAllocations();
+	start_bytes_ = getAllocatedBytes();
+	start_ = Clock::now();
+}
+
+
+void StageRecorder::stop()
+{
+	std::chrono::duration<double, std::milli> duration = Clock::now() - start_;
+	total_time_ += duration.count();
+	allocations_ += getNumberOfAllocations() - start_allocations_;
+	bytes_ += getAllocatedBytes() - start_bytes_;
+}
+
+
+BENCHMARK_MAIN();
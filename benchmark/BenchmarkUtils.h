@@ -0,0 +1,125 @@
+#ifndef DWL__BENCHMARK__BENCHMARK_UTILS__H
+#define DWL__BENCHMARK__BENCHMARK_UTILS__H
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Gets the number of heap allocations of the process, which are counted by the
+ * replaced global operator new of the benchmark executable
+ * @return The number of allocations
+ */
+unsigned long getNumberOfAllocations();
+
+/**
+ * @brief Gets the number of bytes requested to the heap by the process, which are counted by
+ * the replaced global operator new of the benchmark executable
+ * @return The number of allocated bytes
+ */
+unsigned long getAllocatedBytes();
+
+/**
+ * @brief Gets the peak resident memory of the process
+ * @return The peak resident memory in megabytes
+ */
+double getPeakResidentMemory();
+
+
+/**
+ * @class LatencyRecorder
+ * @brief Records the latency of every iteration of a benchmark, and reports its percentiles
+ * (p50, p90 and p99 in microseconds) and the heap allocations per iteration as user counters,
+ * i.e. they are part of the console and JSON outputs. Note that the recorder reserves its
+ * samples before counting the allocations, so it doesn't count itself
+ */
+class LatencyRecorder
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param benchmark::State& State of the benchmark
+		 */
+		LatencyRecorder(benchmark::State& state);
+
+		/** @brief Destructor function, which reports the counters */
+		~LatencyRecorder();
+
+		/** @brief Starts the timing of an iteration */
+		void start();
+
+		/** @brief Stops the timing of an iteration */
+		void stop();
+
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		/** @brief State of the benchmark */
+		benchmark::State& state_;
+
+		/** @brief Latency of every iteration in microseconds */
+		std::vector<double> latencies_;
+
+		/** @brief Start time of the current iteration */
+		Clock::time_point start_;
+
+		/** @brief Number of allocations before the first iteration */
+		unsigned long allocations_;
+};
+
+
+
+/**
+ * @class StageRecorder
+ * @brief Records the wall time and heap usage of a stage of a pipeline, e.g. the path or
+ * contact planning, which could be started and stopped many times per iteration. The time (ms),
+ * allocations and allocated memory (kB) per iteration are reported as the user counters
+ * <name>_ms, <name>_allocs and <name>_kB
+ */
+class StageRecorder
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param benchmark::State& State of the benchmark
+		 * @param const std::string& Name of the stage
+		 */
+		StageRecorder(benchmark::State& state,
+					  const std::string& name);
+
+		/** @brief Destructor function, which reports the counters */
+		~StageRecorder();
+
+		/** @brief Starts the recording of the stage */
+		void start();
+
+		/** @brief Stops the recording of the stage */
+		void stop();
+
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		/** @brief State of the benchmark */
+		benchmark::State& state_;
+
+		/** @brief Name of the stage */
+		std::string name_;
+
+		/** @brief Accumulated wall time in milliseconds */
+		double total_time_;
+
+		/** @brief Accumulated allocations and allocated bytes */
+		unsigned long allocations_;
+		unsigned long bytes_;
+
+		/** @brief Start time, allocations and allocated bytes of the current recording */
+		Clock::time_point start_;
+		unsigned long start_allocations_;
+		unsigned long start_bytes_;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include <BenchmarkUtils.h>
+#include <dwl/simulation/PreviewLocomotion.h>
+#include <dwl/ocp/OptimalControl.h>
+#include <model/HS071DynamicalSystem.cpp>
+#include <model/HS071Cost.cpp>
+
+
+static void BM_MultiPhasePreview(benchmark::State& state)
+{
+	dwl::simulation::PreviewLocomotion preview;
+	preview.resetFromURDFFile(DWL_SOURCE_DIR"/sample/hyq.urdf",
+							  DWL_SOURCE_DIR"/config/hyq.yarf");
+	preview.setSampleTime(0.01);
+	preview.setStepHeight(0.1);
+
+	// Standing state of the HyQ robot
+	dwl::ReducedBodyState robot_state;
+	robot_state.setCoMPosition(Eigen::Vector3d(0., 0., 0.58));
+	robot_state.support_region["lf_foot"] = Eigen::Vector3d(0.37, 0.33, 0.);
+	robot_state.support_region["rf_foot"] = Eigen::Vector3d(0.37, -0.33, 0.);
+	robot_state.support_region["lh_foot"] = Eigen::Vector3d(-0.37, 0.33, 0.);
+	robot_state.support_region["rh_foot"] = Eigen::Vector3d(-0.37, -0.33, 0.);
+
+	// Four-phases preview, i.e. a four-legs stance phase followed by three-legs stance phases
+	dwl::simulation::PreviewControl control;
+	control.params.push_back(dwl::simulation::PreviewParams(0.25, Eigen::Vector2d(0.05, 0.05)));
+	const char* swing_feet[3] = {"lf_foot", "rh_foot", "rf_foot"};
+	for (unsigned int i = 0; i < 3; i++) {
+		dwl::simulation::PreviewParams params(0.25, Eigen::Vector2d(0.02, -0.02));
+		params.phase = dwl::simulation::PreviewPhase(dwl::simulation::STANCE,
+				dwl::rbd::BodySelector(1, swing_feet[i]));
+		control.params.push_back(params);
+	}
+
+	// The argument indicates if it's computed the full trajectory or only the transitions
+	bool full = state.range(0) != 0;
+	dwl::ReducedBodyTrajectory trajectory;
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		preview.multiPhasePreview(trajectory, robot_state, control, full);
+		benchmark::DoNotOptimize(trajectory.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_MultiPhasePreview)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_OptimalControlEvaluation(benchmark::State& state)
+{
+	// HS071 problem with a horizon defined by the argument of the benchmark
+	dwl::ocp::OptimalControl optimal_control;
+	optimal_control.addDynamicalSystem(new dwl::model::HS071DynamicalSystem());
+	optimal_control.addCost(new dwl::model::HS071Cost());
+	optimal_control.setHorizon(state.range(0));
+	optimal_control.init(false);
+
+	unsigned int decision_dim = optimal_control.getDimensionOfState();
+	unsigned int constraint_dim = optimal_control.getDimensionOfConstraints();
+	Eigen::VectorXd decision(decision_dim), constraint(constraint_dim);
+	optimal_control.getStartingPoint(decision.data(), decision_dim);
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		// Evaluating the cost and constraints as in every iteration of the NLP solvers
+		double cost;
+		recorder.start();
+		optimal_control.evaluateCosts(cost, decision.data(), decision_dim);
+		optimal_control.evaluateConstraints(constraint.data(), constraint_dim,
+											decision.data(), decision_dim);
+		benchmark::DoNotOptimize(cost);
+		benchmark::DoNotOptimize(constraint.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_OptimalControlEvaluation)->Arg(1)->Arg(50)->Arg(200);
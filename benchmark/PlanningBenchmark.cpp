@@ -0,0 +1,91 @@
+#include <BenchmarkUtils.h>
+#include <dwl/solver/AStar.h>
+#include <dwl/solver/AnytimeRepairingAStar.h>
+
+
+// Synthetic 8-connected grid where the vertex id is (y * size + x). The edge weight is the
+// length of the edge times the cost of the target cell, and the grid has a field of random
+// high-cost cells (obstacles) with a fixed seed
+class SyntheticGrid : public dwl::model::AdjacencyModel
+{
+	public:
+		SyntheticGrid(unsigned int size) : size_(size), cost_(size * size, 1.) {
+			name_ = "Synthetic grid";
+			srand(0);
+			for (unsigned int i = 0; i < cost_.size(); i++) {
+				if (rand() % 5 == 0)
+					cost_[i] = 50.;
+			}
+			cost_[0] = cost_.back() = 1.;
+		}
+
+		void getSuccessors(dwl::EdgeList& successors,
+						   dwl::Vertex vertex) {
+			int x = vertex % size_, y = vertex / size_;
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					int nx = x + dx, ny = y + dy;
+					if ((dx == 0 && dy == 0) ||
+							nx < 0 || ny < 0 || nx >= (int) size_ || ny >= (int) size_)
+						continue;
+
+					dwl::Vertex neighbor = ny * size_ + nx;
+					double length = (dx != 0 && dy != 0) ? sqrt(2.) : 1.;
+					successors.push_back(dwl::Edge(neighbor, length * cost_[neighbor]));
+				}
+			}
+		}
+
+		double heuristicCost(dwl::Vertex source, dwl::Vertex target) {
+			double dx = (double) (source % size_) - (double) (target % size_);
+			double dy = (double) (source / size_) - (double) (target / size_);
+			return sqrt(dx * dx + dy * dy);
+		}
+
+		unsigned int size_;
+		std::vector<double> cost_;
+};
+
+
+// Searches the synthetic grid from a corner to the opposite one, where the size of the grid is
+// the argument of the benchmark
+template<typename Solver>
+static void runGridSearch(benchmark::State& state,
+						  bool indexed_heap)
+{
+	unsigned int size = state.range(0);
+	SyntheticGrid* grid = new SyntheticGrid(size);
+	Solver solver;
+	solver.setAdjacencyModel(grid);
+	solver.setIndexedHeap(indexed_heap, size * size);
+
+	dwl::Vertex source = 0, target = size * size - 1;
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		solver.compute(source, target, 1000.);
+		benchmark::DoNotOptimize(solver.getMinimumCost());
+		recorder.stop();
+	}
+	state.counters["cells"] = size * size;
+}
+
+
+static void BM_AStar(benchmark::State& state,
+					 bool indexed_heap)
+{
+	runGridSearch<dwl::solver::AStar>(state, indexed_heap);
+}
+BENCHMARK_CAPTURE(BM_AStar, set, false)
+		->Arg(32)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_AStar, heap, true)
+		->Arg(32)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_AnytimeRepairingAStar(benchmark::State& state,
+									 bool indexed_heap)
+{
+	runGridSearch<dwl::solver::AnytimeRepairingAStar>(state, indexed_heap);
+}
+BENCHMARK_CAPTURE(BM_AnytimeRepairingAStar, heap, true)
+		->Arg(32)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,261 @@
+#include <PlanningScenarios.h>
+#include <dwl/model/GridBasedBodyAdjacency.h>
+#include <dwl/solver/AStar.h>
+#include <dwl/utils/Orientation.h>
+#ifdef DWL_WITH_IPOPT
+#include <dwl/ocp/FullDynamicalSystem.h>
+#include <dwl/ocp/IntegralStateTrackingEnergyCost.h>
+#include <dwl/ocp/IntegralControlEnergyCost.h>
+#include <dwl/solver/IpoptNLP.h>
+#endif
+#include <random>
+
+
+void generateScenarioTerrain(Eigen::ArrayXXd& height,
+							 TerrainScenario scenario,
+							 unsigned int seed)
+{
+	const double resolution = 0.04;
+	const unsigned int size_x = 100, size_y = 50;
+	const double obstacle_start = 0.8, obstacle_end = 3.2;
+	height = Eigen::ArrayXXd::Zero(size_x, size_y);
+
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> uniform(0., 1.);
+	switch (scenario) {
+		case StairsTerrain: {
+			// Ascending steps, where the last step continues up to the goal area
+			double x = obstacle_start, step_height = 0.;
+			for (unsigned int k = 0; k < 5 && x < obstacle_end; k++) {
+				step_height += 0.06 + 0.06 * uniform(generator);
+				unsigned int first = round(x / resolution);
+				for (unsigned int i = first; i < size_x; i++)
+					height.row(i).setConstant(step_height);
+
+				x += 0.25 + 0.15 * uniform(generator);
+			}
+			break;
+		}
+		case RubbleTerrain: {
+			// Overlapping blocks, where the highest one defines the height of a cell
+			for (unsigned int k = 0; k < 20; k++) {
+				double center_x = obstacle_start +
+						(obstacle_end - obstacle_start) * uniform(generator);
+				double center_y = size_y * resolution * uniform(generator);
+				double half_x = 0.05 + 0.1 * uniform(generator);
+				double half_y = 0.05 + 0.1 * uniform(generator);
+				double block_height = 0.02 + 0.1 * uniform(generator);
+
+				int min_i = std::max((int) round((center_x - half_x) / resolution), 0);
+				int max_i = std::min((int) round((center_x + half_x) / resolution), (int) size_x - 1);
+				int min_j = std::max((int) round((center_y - half_y) / resolution), 0);
+				int max_j = std::min((int) round((center_y + half_y) / resolution), (int) size_y - 1);
+				for (int i = min_i; i <= max_i; i++) {
+					for (int j = min_j; j <= max_j; j++)
+						height(i, j) = std::max(height(i, j), block_height);
+				}
+			}
+			break;
+		}
+		case GapsTerrain: {
+			// Gaps across the grid, which are distributed in equal sections of the obstacle area
+			double section = (obstacle_end - obstacle_start) / 3;
+			for (unsigned int k = 0; k < 3; k++) {
+				double width = 0.08 + 0.12 * uniform(generator);
+				double x = obstacle_start + k * section + (section - width) * uniform(generator);
+				unsigned int first = round(x / resolution);
+				unsigned int last = std::min((unsigned int) round((x + width) / resolution), size_x);
+				for (unsigned int i = first; i < last; i++)
+					height.row(i).setConstant(-0.5);
+			}
+			break;
+		}
+	}
+}
+
+
+ScenarioBodyPlanning::ScenarioBodyPlanning(double nominal_height) :
+		nominal_height_(nominal_height), recorder_(NULL)
+{
+	name_ = "Scenario body";
+}
+
+
+void ScenarioBodyPlanning::setStageRecorder(StageRecorder* recorder)
+{
+	recorder_ = recorder;
+}
+
+
+bool ScenarioBodyPlanning::computePath(std::vector<dwl::Pose>& path,
+									   dwl::Pose start_pose,
+									   dwl::Pose goal_pose)
+{
+	if (recorder_ != NULL)
+		recorder_->start();
+
+	// Computing the path of state vertices (x,y,yaw), where the state window is centered at
+	// the start position
+	centerStateWindow(start_pose.position.head<2>());
+	Eigen::Vector3d start_state, goal_state;
+	start_state << start_pose.position.head<2>(),
+			dwl::math::getRPY(start_pose.orientation)(2);
+	goal_state << goal_pose.position.head<2>(),
+			dwl::math::getRPY(goal_pose.orientation)(2);
+	dwl::Vertex start_vertex, goal_vertex;
+	terrain_->getTerrainSpaceModel().stateToVertex(start_vertex, start_state);
+	terrain_->getTerrainSpaceModel().stateToVertex(goal_vertex, goal_state);
+
+	bool found = path_solver_->compute(start_vertex, goal_vertex, path_computation_time_);
+	if (found) {
+		getBodyPath(path, start_vertex, goal_vertex, 0.);
+
+		// Placing the body above the highest terrain of the body and nominal stance positions,
+		// so the body isn't lowered over the gaps
+		dwl::Vector3dMap stance = robot_->getNominalStance();
+		for (unsigned int k = 0; k < path.size(); k++) {
+			Eigen::Matrix3d rotation = dwl::math::getRotationMatrix(path[k].orientation);
+			double terrain_height = 0.;
+			terrain_->getTerrainHeight(terrain_height, (Eigen::Vector2d) path[k].position.head<2>());
+			for (dwl::Vector3dMap::iterator stance_it = stance.begin();
+					stance_it != stance.end(); stance_it++) {
+				Eigen::Vector3d foot_pos = path[k].position + rotation * stance_it->second;
+				double foot_height;
+				if (terrain_->getTerrainHeight(foot_height, (Eigen::Vector2d) foot_pos.head<2>()))
+					terrain_height = std::max(terrain_height, foot_height);
+			}
+			path[k].position(dwl::rbd::Z) = terrain_height + nominal_height_;
+		}
+	}
+
+	if (recorder_ != NULL)
+		recorder_->stop();
+
+	return found;
+}
+
+
+ScenarioContactPlanning::ScenarioContactPlanning() : recorder_(NULL)
+{
+	name_ = "Scenario contact";
+}
+
+
+void ScenarioContactPlanning::setStageRecorder(StageRecorder* recorder)
+{
+	recorder_ = recorder;
+}
+
+
+bool ScenarioContactPlanning::computeContactSequence(std::vector<dwl::Contact>& contact_sequence,
+													 const std::vector<dwl::Pose>& pose_trajectory)
+{
+	if (recorder_ != NULL)
+		recorder_->start();
+
+	contact_sequence.clear();
+	dwl::PatternOfLocomotionMap pattern = robot_->getPatternOfLocomotion();
+	unsigned int swing_foot = 0;
+	dwl::locomotion::FootholdCandidateMap candidates;
+	for (unsigned int k = 1; k < pose_trajectory.size(); k++) {
+		// Computing the action of the body (x,y,yaw) in the frame of the previous pose
+		const dwl::Pose& last_pose = pose_trajectory[k-1];
+		const dwl::Pose& pose = pose_trajectory[k];
+		Eigen::Vector3d last_rpy = dwl::math::getRPY(last_pose.orientation);
+		Eigen::Vector3d rpy = dwl::math::getRPY(pose.orientation);
+		Eigen::Vector3d displacement =
+				dwl::math::getRotationMatrix(last_pose.orientation).transpose() *
+				(pose.position - last_pose.position);
+		Eigen::Vector3d action(displacement(dwl::rbd::X), displacement(dwl::rbd::Y),
+							   rpy(2) - last_rpy(2));
+
+		// Moving the swing foot to its best candidate, where the foot is kept if there isn't any
+		// reachable candidate
+		scoreFootholdCandidates(candidates, pose, action);
+		dwl::locomotion::FootholdCandidateMap::iterator candidate_it =
+				candidates.find(swing_foot);
+		if (candidate_it != candidates.end() && !candidate_it->second.empty()) {
+			dwl::Contact contact;
+			contact.end_effector = swing_foot;
+			contact.position = candidate_it->second.front().position;
+			contact_sequence.push_back(contact);
+		}
+
+		if (pattern.find(swing_foot) == pattern.end())
+			break;
+		swing_foot = pattern[swing_foot];
+	}
+
+	if (recorder_ != NULL)
+		recorder_->stop();
+
+	return !contact_sequence.empty();
+}
+
+
+ScenarioPlanning::ScenarioPlanning() : body_planner(0.58)
+{
+	// Robot properties and terrain map, where the states have the resolution of the terrain
+	robot.read(DWL_SOURCE_DIR"/config/hyq_planning.yaml");
+	terrain.setStateResolution(0.04, M_PI / 8);
+
+	// Hierarchical planning, i.e. an A* body path planner over a grid-based body adjacency
+	// followed by the contact planner
+	dwl::solver::AStar* solver = new dwl::solver::AStar();
+	solver->setAdjacencyModel(new dwl::model::GridBasedBodyAdjacency());
+	body_planner.reset(solver);
+	planner.reset(&robot, &body_planner, &contact_planner, &terrain);
+	planner.initPlan();
+
+	start_pose.position << 0.4, 1., 0.58;
+	start_pose.orientation = Eigen::Quaterniond::Identity();
+	goal_pose.position << 3.6, 1., 0.58;
+	goal_pose.orientation = Eigen::Quaterniond::Identity();
+	planner.resetGoal(goal_pose);
+}
+
+
+#ifdef DWL_WITH_IPOPT
+ScenarioTrajectoryOptimization::ScenarioTrajectoryOptimization()
+{
+	dwl::ocp::DynamicalSystem* system = new dwl::ocp::FullDynamicalSystem();
+	system->modelFromURDFFile(DWL_SOURCE_DIR"/sample/hyq.urdf",
+							  DWL_SOURCE_DIR"/config/hyq.yarf");
+	dwl::model::FloatingBaseSystem& fbs = system->getFloatingBaseSystem();
+	wbto.addDynamicalSystem(system);
+
+	// Standing state of the HyQ robot
+	current_state.setJointDoF(fbs.getJointDoF());
+	current_state.setJointPosition(fbs.getDefaultPosture());
+
+	// Tracking the base position with a small regularization of the joint positions
+	dwl::WholeBodyState weights(fbs.getJointDoF());
+	weights.setBasePosition(Eigen::Vector3d::Ones());
+	weights.setJointPosition(0.1 * Eigen::VectorXd::Ones(fbs.getJointDoF()));
+	dwl::ocp::Cost* state_cost = new dwl::ocp::IntegralStateTrackingEnergyCost();
+	state_cost->setWeights(weights);
+	wbto.addCost(state_cost);
+	wbto.addCost(new dwl::ocp::IntegralControlEnergyCost());
+
+	wbto.setHorizon(10);
+	wbto.setStepIntegrationTime(0.05);
+	dwl::solver::IpoptNLP* ipopt = new dwl::solver::IpoptNLP();
+	ipopt->setPrintLevel(0);
+	ipopt->setMaxIteration(50);
+	wbto.init(ipopt);
+}
+
+
+dwl::WholeBodyState
+ScenarioTrajectoryOptimization::getDesiredState(const std::vector<dwl::Pose>& body_path) const
+{
+	dwl::WholeBodyState desired_state = current_state;
+	if (body_path.empty())
+		return desired_state;
+
+	unsigned int cycle = std::min((unsigned int) body_path.size() - 1, 4u);
+	desired_state.setBasePosition(current_state.getBasePosition() +
+			body_path[cycle].position - body_path[0].position);
+	return desired_state;
+}
+#endif
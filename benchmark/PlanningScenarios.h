@@ -0,0 +1,155 @@
+#ifndef DWL__BENCHMARK__PLANNING_SCENARIOS__H
+#define DWL__BENCHMARK__PLANNING_SCENARIOS__H
+
+#include <BenchmarkUtils.h>
+#include <dwl/locomotion/MotionPlanning.h>
+#include <dwl/locomotion/ContactPlanning.h>
+#include <dwl/locomotion/HierarchicalPlanning.h>
+#ifdef DWL_WITH_IPOPT
+#include <dwl/locomotion/WholeBodyTrajectoryOptimization.h>
+#endif
+
+
+/** @brief Procedural terrains of the planning scenarios */
+enum TerrainScenario {StairsTerrain, RubbleTerrain, GapsTerrain};
+
+
+/**
+ * @brief Generates the elevation grid of a scenario, where the grid is 4 x 2 m with a
+ * resolution of 4 cm and its (0,0) cell is at the origin. The first and last 0.8 m of the
+ * grid are flat, i.e. the start and goal areas, and the obstacles in the middle are:
+ *  - stairs: five steps with a random depth (0.25-0.4 m) and rise (6-12 cm)
+ *  - rubble: twenty blocks with a random footprint (0.1-0.3 m) and height (2-12 cm)
+ *  - gaps: three gaps across the grid with a random width (8-20 cm) and 0.5 m of depth
+ * The random generator is seeded, so a seed always generates the same terrain
+ * @param Eigen::ArrayXXd& Heights of the cells, indexed as (x,y)
+ * @param TerrainScenario Terrain of the scenario
+ * @param unsigned int Seed of the random generator
+ */
+void generateScenarioTerrain(Eigen::ArrayXXd& height,
+							 TerrainScenario scenario,
+							 unsigned int seed);
+
+
+/**
+ * @class ScenarioBodyPlanning
+ * @brief Body path planner of the planning scenarios, which searches the path of states
+ * (x,y,yaw) with the path solver, and places every pose at the nominal height above the
+ * terrain. The planning time is recorded in the stage recorder (if it's defined)
+ */
+class ScenarioBodyPlanning : public dwl::locomotion::MotionPlanning
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param double Nominal height of the body above the terrain
+		 */
+		ScenarioBodyPlanning(double nominal_height);
+
+		/**
+		 * @brief Sets the stage recorder of the body path planning
+		 * @param StageRecorder* Stage recorder (NULL disables the recording)
+		 */
+		void setStageRecorder(StageRecorder* recorder);
+
+		/**
+		 * @brief Computes a path from start pose to goal pose
+		 * @param std::vector<Pose>& Planned path
+		 * @param Pose Start pose
+		 * @param Pose Goal pose
+		 */
+		bool computePath(std::vector<dwl::Pose>& path,
+						 dwl::Pose start_pose,
+						 dwl::Pose goal_pose);
+
+
+	private:
+		/** @brief Nominal height of the body above the terrain */
+		double nominal_height_;
+
+		/** @brief Stage recorder of the body path planning */
+		StageRecorder* recorder_;
+};
+
+
+/**
+ * @class ScenarioContactPlanning
+ * @brief Contact planner of the planning scenarios, which moves one foot per pose of the body
+ * path following the pattern of locomotion of the robot, i.e. a crawl gait, where the
+ * foothold is the best scored candidate of the swing foot. The planning time is recorded
+ * in the stage recorder (if it's defined)
+ */
+class ScenarioContactPlanning : public dwl::locomotion::ContactPlanning
+{
+	public:
+		/** @brief Constructor function */
+		ScenarioContactPlanning();
+
+		/**
+		 * @brief Sets the stage recorder of the contact planning
+		 * @param StageRecorder* Stage recorder (NULL disables the recording)
+		 */
+		void setStageRecorder(StageRecorder* recorder);
+
+		/**
+		 * @brief Computes the contacts given a current pose of the robot
+		 * @param std::vector<Contact>& contact_sequence Set of contacts
+		 * @param const std::vector<Pose>& pose_trajectory Goal pose
+		 */
+		bool computeContactSequence(std::vector<dwl::Contact>& contact_sequence,
+									const std::vector<dwl::Pose>& pose_trajectory);
+
+
+	private:
+		/** @brief Stage recorder of the contact planning */
+		StageRecorder* recorder_;
+};
+
+
+/**
+ * @struct ScenarioPlanning
+ * @brief Hierarchical planning of the HyQ robot in the planning scenarios, i.e. an A* body
+ * path planner over a grid-based body adjacency followed by the scenario contact planner,
+ * where the states have the resolution of the terrain. The robot crosses the terrain from the
+ * start area to the goal area
+ */
+struct ScenarioPlanning
+{
+	/** @brief Constructor function, which initializes the planning */
+	ScenarioPlanning();
+
+	dwl::robot::Robot robot;
+	dwl::environment::TerrainMap terrain;
+	ScenarioBodyPlanning body_planner;
+	ScenarioContactPlanning contact_planner;
+	dwl::locomotion::HierarchicalPlanning planner;
+	dwl::Pose start_pose;
+	dwl::Pose goal_pose;
+};
+
+
+#ifdef DWL_WITH_IPOPT
+/**
+ * @struct ScenarioTrajectoryOptimization
+ * @brief Whole-body trajectory optimization of the HyQ robot, which tracks the body
+ * displacement of the first gait cycle of the plan
+ */
+struct ScenarioTrajectoryOptimization
+{
+	/** @brief Constructor function, which initializes the optimization with Ipopt */
+	ScenarioTrajectoryOptimization();
+
+	/**
+	 * @brief Gets the desired state of a plan, i.e. the standing state displaced by the body
+	 * displacement of the first gait cycle
+	 * @param const std::vector<dwl::Pose>& Body path of the plan
+	 * @return The desired whole-body state
+	 */
+	dwl::WholeBodyState getDesiredState(const std::vector<dwl::Pose>& body_path) const;
+
+	dwl::locomotion::WholeBodyTrajectoryOptimization wbto;
+	dwl::WholeBodyState current_state;
+};
+#endif
+
+#endif
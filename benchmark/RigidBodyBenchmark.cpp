@@ -0,0 +1,192 @@
+#include <BenchmarkUtils.h>
+#include <dwl/WholeBodyState.h>
+#include <dwl/model/WholeBodyKinematics.h>
+#include <dwl/model/WholeBodyDynamics.h>
+
+
+// HyQ model and a standing state, which are shared by the rigid-body benchmarks
+struct HyQModel
+{
+	HyQModel() {
+		// Resetting the system from the hyq urdf file
+		std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+		std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+		wdyn.modelFromURDFFile(urdf_file, yarf_file);
+		wkin = wdyn.getWholeBodyKinematics();
+		fbs = wdyn.getFloatingBaseSystem();
+		ws.setJointDoF(fbs.getJointDoF());
+		wkin.setIKSolver(1.0e-12, 0.01, 50);
+
+		// The robot state
+		ws.setBasePosition(Eigen::Vector3d(0., 0., 0.));
+		ws.setBaseRPY(Eigen::Vector3d(0., 0., 0.));
+		ws.setBaseVelocity_W(Eigen::Vector3d(0.1, 0., 0.));
+		ws.setBaseRPYVelocity_W(Eigen::Vector3d(0., 0., 0.05));
+		ws.setBaseAcceleration_W(Eigen::Vector3d(0., 0., 0.));
+		ws.setBaseRPYAcceleration_W(Eigen::Vector3d(0., 0., 0.));
+		ws.setJointPosition(0.75, fbs.getJointId("lf_hfe_joint"));
+		ws.setJointPosition(-1.5, fbs.getJointId("lf_kfe_joint"));
+		ws.setJointPosition(-0.75, fbs.getJointId("lh_hfe_joint"));
+		ws.setJointPosition(1.5, fbs.getJointId("lh_kfe_joint"));
+		ws.setJointPosition(0.75, fbs.getJointId("rf_hfe_joint"));
+		ws.setJointPosition(-1.5, fbs.getJointId("rf_kfe_joint"));
+		ws.setJointPosition(-0.75, fbs.getJointId("rh_hfe_joint"));
+		ws.setJointPosition(1.5, fbs.getJointId("rh_kfe_joint"));
+
+		grf["lf_foot"] << 0, 0, 0, 0, 0, 190.778;
+		grf["rf_foot"] << 0, 0, 0, 0, 0, 190.778;
+		grf["lh_foot"] << 0, 0, 0, 0, 0, 190.778;
+		grf["rh_foot"] << 0, 0, 0, 0, 0, 190.778;
+	}
+
+	static HyQModel& get() {
+		static HyQModel model;
+		return model;
+	}
+
+	dwl::WholeBodyState ws;
+	dwl::model::FloatingBaseSystem fbs;
+	dwl::model::WholeBodyKinematics wkin;
+	dwl::model::WholeBodyDynamics wdyn;
+	dwl::rbd::BodyVector6d grf;
+};
+
+
+static void BM_ForwardKinematics(benchmark::State& state)
+{
+	HyQModel& hyq = HyQModel::get();
+	const dwl::rbd::BodySelector& ee_names = hyq.fbs.getEndEffectorNames();
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		const dwl::rbd::BodyVectorXd& pos_W =
+				hyq.wkin.computePosition(hyq.ws.base_pos, hyq.ws.joint_pos,
+										 ee_names, dwl::rbd::Linear, dwl::RollPitchYaw);
+		benchmark::DoNotOptimize(&pos_W);
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_ForwardKinematics);
+
+
+static void BM_InverseKinematics(benchmark::State& state)
+{
+	HyQModel& hyq = HyQModel::get();
+	const dwl::rbd::BodyVectorXd& pos_W =
+			hyq.wkin.computePosition(hyq.ws.base_pos, hyq.ws.joint_pos,
+									 hyq.fbs.getEndEffectorNames(dwl::model::FOOT),
+									 dwl::rbd::Linear, dwl::RollPitchYaw);
+	dwl::rbd::BodyVector3d ik_pos;
+	for (dwl::rbd::BodyVectorXd::const_iterator it = pos_W.begin(); it != pos_W.end(); it++)
+		ik_pos[it->first] = it->second.tail(3);
+	Eigen::VectorXd joint_pos, joint_pos_init = hyq.fbs.getDefaultPosture();
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		hyq.wkin.computeJointPosition(joint_pos, ik_pos, joint_pos_init);
+		benchmark::DoNotOptimize(joint_pos.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_InverseKinematics);
+
+
+static void BM_Jacobian(benchmark::State& state)
+{
+	HyQModel& hyq = HyQModel::get();
+	const dwl::rbd::BodySelector& feet = hyq.fbs.getEndEffectorNames(dwl::model::FOOT);
+	Eigen::MatrixXd jacobian;
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		hyq.wkin.computeJacobian(jacobian,
+								 hyq.ws.base_pos, hyq.ws.joint_pos,
+								 feet, dwl::rbd::Full);
+		benchmark::DoNotOptimize(jacobian.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_Jacobian);
+
+
+static void BM_InverseDynamics(benchmark::State& state)
+{
+	HyQModel& hyq = HyQModel::get();
+	dwl::WholeBodyState& ws = hyq.ws;
+	dwl::rbd::Vector6d base_eff;
+	Eigen::VectorXd joint_eff;
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		hyq.wdyn.computeInverseDynamics(base_eff, joint_eff,
+										ws.base_pos, ws.joint_pos,
+										ws.base_vel, ws.joint_vel,
+										ws.base_acc, ws.joint_acc, hyq.grf);
+		benchmark::DoNotOptimize(joint_eff.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_InverseDynamics);
+
+
+static void BM_JointSpaceInertiaMatrix(benchmark::State& state)
+{
+	HyQModel& hyq = HyQModel::get();
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		const Eigen::MatrixXd& inertia_mat =
+				hyq.wdyn.computeJointSpaceInertiaMatrix(hyq.ws.base_pos, hyq.ws.joint_pos);
+		benchmark::DoNotOptimize(inertia_mat.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_JointSpaceInertiaMatrix);
+
+
+static void BM_ContactForces(benchmark::State& state)
+{
+	HyQModel& hyq = HyQModel::get();
+	dwl::WholeBodyState ws = hyq.ws;
+	const dwl::rbd::BodySelector& feet = hyq.fbs.getEndEffectorNames(dwl::model::FOOT);
+	dwl::rbd::BodyVector6d contact_forces;
+	Eigen::VectorXd joint_forces;
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		recorder.start();
+		hyq.wdyn.computeContactForces(contact_forces, joint_forces,
+									  ws.base_pos, ws.joint_pos,
+									  ws.base_vel, ws.joint_vel,
+									  ws.base_acc, ws.joint_acc, feet);
+		benchmark::DoNotOptimize(joint_forces.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_ContactForces);
+
+
+static void BM_WholeBodyStateConversions(benchmark::State& state)
+{
+	HyQModel& hyq = HyQModel::get();
+	dwl::WholeBodyState ws = hyq.ws;
+
+	LatencyRecorder recorder(state);
+	for (auto _ : state) {
+		// Converting the base velocities between the world, base and horizontal frames
+		recorder.start();
+		Eigen::Vector3d vel_B = ws.getBaseVelocity_B();
+		Eigen::Vector3d vel_H = ws.getBaseVelocity_H();
+		Eigen::Vector3d rate_B = ws.getBaseAngularVelocity_B();
+		ws.setBaseVelocity_B(vel_B);
+		benchmark::DoNotOptimize(vel_H.data());
+		benchmark::DoNotOptimize(rate_B.data());
+		recorder.stop();
+	}
+}
+BENCHMARK(BM_WholeBodyStateConversions);
@@ -0,0 +1,74 @@
+#include <PlanningScenarios.h>
+#include <dwl/environment/TerrainFeaturePipeline.h>
+
+
+// Plans the locomotion of the HyQ robot through a procedural terrain, where the seed of the
+// terrain is the argument of the benchmark. Every iteration runs the full pipeline, i.e. the
+// terrain map update, the hierarchical planning (body path and contact sequence) and the
+// whole-body trajectory optimization (if Ipopt is available), and the wall time and heap usage
+// of every stage are reported as counters
+static void BM_PlanningScenario(benchmark::State& state,
+								TerrainScenario scenario)
+{
+	ScenarioPlanning scenario_planning;
+	dwl::locomotion::HierarchicalPlanning& planner = scenario_planning.planner;
+	ScenarioBodyPlanning& body_planner = scenario_planning.body_planner;
+	ScenarioContactPlanning& contact_planner = scenario_planning.contact_planner;
+
+#ifdef DWL_WITH_IPOPT
+	ScenarioTrajectoryOptimization optimization;
+#endif
+
+	dwl::environment::TerrainFeaturePipeline feature_pipeline;
+	feature_pipeline.setResolution(0.04, 0.01);
+	Eigen::ArrayXXd height;
+	dwl::TerrainData terrain_data;
+	unsigned int seed = state.range(0);
+	unsigned int num_failures = 0;
+	{
+		StageRecorder terrain_recorder(state, "terrain");
+		StageRecorder path_recorder(state, "path");
+		StageRecorder contact_recorder(state, "contacts");
+#ifdef DWL_WITH_IPOPT
+		StageRecorder wbto_recorder(state, "wbto");
+#endif
+		body_planner.setStageRecorder(&path_recorder);
+		contact_planner.setStageRecorder(&contact_recorder);
+		for (auto _ : state) {
+			// Generating the terrain, and delivering it to the planner
+			terrain_recorder.start();
+			generateScenarioTerrain(height, scenario, seed);
+			feature_pipeline.computeTerrainData(terrain_data, height, Eigen::Vector2d::Zero());
+			planner.setTerrainMap(terrain_data);
+			terrain_recorder.stop();
+
+			if (!planner.computePlan(scenario_planning.start_pose)) {
+				num_failures++;
+				continue;
+			}
+
+#ifdef DWL_WITH_IPOPT
+			// Tracking the body displacement of the first gait cycle
+			dwl::WholeBodyState desired_state =
+					optimization.getDesiredState(planner.getBodyPath());
+			wbto_recorder.start();
+			optimization.wbto.compute(optimization.current_state, desired_state, 10.);
+			wbto_recorder.stop();
+#endif
+		}
+		body_planner.setStageRecorder(NULL);
+		contact_planner.setStageRecorder(NULL);
+	}
+
+	state.counters["cells"] = terrain_data.data.size();
+	state.counters["path_poses"] = planner.getBodyPath().size();
+	state.counters["contacts"] = planner.getContactSequence().size();
+	state.counters["failures"] = num_failures;
+	state.counters["peak_rss_mb"] = getPeakResidentMemory();
+}
+BENCHMARK_CAPTURE(BM_PlanningScenario, stairs, StairsTerrain)
+		->Arg(1)->Arg(2)->Arg(3)->Iterations(5)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PlanningScenario, rubble, RubbleTerrain)
+		->Arg(1)->Arg(2)->Arg(3)->Iterations(5)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PlanningScenario, gaps, GapsTerrain)
+		->Arg(1)->Arg(2)->Arg(3)->Iterations(5)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,253 @@
+#include <PlanningScenarios.h>
+#include <dwl/SolveSnapshot.h>
+#include <dwl/environment/TerrainFeaturePipeline.h>
+#include <dwl/simulation/PreviewLocomotion.h>
+#include <dwl/utils/Instrumentation.h>
+#include <dwl/utils/Macros.h>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+
+// Deterministic replay of the planner solves recorded in a snapshot file, e.g. of a robot
+// session, so their performance is profiled offline with the same inputs. Every record is
+// replayed in order, and its wall time is reported together with the probes of the
+// instrumentation (build with -DDWL_WITH_INSTRUMENTATION=ON for the breakdown of the solves).
+// The planners are the ones of the planning scenarios, so the recording mode plans a scenario
+// for generating a snapshot file, e.g.
+//   replay_benchmark --record stairs.snap stairs 10
+//   replay_benchmark stairs.snap
+// The preview optimization records are replayed as the multi-phase preview of their starting
+// preview control, i.e. the rollout that the optimization evaluates
+
+typedef std::chrono::steady_clock Clock;
+
+/** @brief Replay times of the records of a kind of solve */
+struct ReplaySummary
+{
+	ReplaySummary() : num_records(0), num_failures(0), total_time(0.), max_time(0.) {}
+
+	unsigned int num_records;
+	unsigned int num_failures;
+	double total_time;
+	double max_time;
+};
+
+
+static const char* getKindName(uint32_t kind)
+{
+	switch (kind) {
+		case dwl::solve_snapshot::HierarchicalPlanningKind:
+			return "hierarchical_planning";
+		case dwl::solve_snapshot::PreviewOptimizationKind:
+			return "preview_optimization";
+		case dwl::solve_snapshot::WholeBodyTrajectoryOptimizationKind:
+			return "whole_body_trajectory_optimization";
+		default:
+			return "unknown";
+	}
+}
+
+
+static bool readScenario(TerrainScenario& scenario,
+						 const std::string& name)
+{
+	if (name == "stairs")
+		scenario = StairsTerrain;
+	else if (name == "rubble")
+		scenario = RubbleTerrain;
+	else if (name == "gaps")
+		scenario = GapsTerrain;
+	else
+		return false;
+
+	return true;
+}
+
+
+// Plans a scenario with the recording of the solves, where every plan has a new terrain
+static int record(const std::string& filename,
+				  TerrainScenario scenario,
+				  unsigned int num_plans,
+				  unsigned int seed)
+{
+	dwl::SnapshotRecorder recorder;
+	if (!recorder.open(filename))
+		return 1;
+
+	ScenarioPlanning scenario_planning;
+	dwl::locomotion::HierarchicalPlanning& planner = scenario_planning.planner;
+	planner.setSnapshotRecorder(&recorder);
+#ifdef DWL_WITH_IPOPT
+	ScenarioTrajectoryOptimization optimization;
+	optimization.wbto.setSnapshotRecorder(&recorder);
+#endif
+
+	dwl::environment::TerrainFeaturePipeline feature_pipeline;
+	feature_pipeline.setResolution(0.04, 0.01);
+	Eigen::ArrayXXd height;
+	dwl::TerrainData terrain_data;
+	unsigned int num_failures = 0;
+	for (unsigned int i = 0; i < num_plans; i++) {
+		generateScenarioTerrain(height, scenario, seed + i);
+		feature_pipeline.computeTerrainData(terrain_data, height, Eigen::Vector2d::Zero());
+		planner.setTerrainMap(terrain_data);
+		if (!planner.computePlan(scenario_planning.start_pose)) {
+			num_failures++;
+			continue;
+		}
+
+#ifdef DWL_WITH_IPOPT
+		optimization.wbto.compute(optimization.current_state,
+								  optimization.getDesiredState(planner.getBodyPath()),
+								  10.);
+#endif
+	}
+	planner.setSnapshotRecorder(NULL);
+#ifdef DWL_WITH_IPOPT
+	optimization.wbto.setSnapshotRecorder(NULL);
+#endif
+	recorder.close();
+
+	printf("Recorded %u solves of %u plans (%u failed) in %s\n",
+			recorder.getNumberOfRecords(), num_plans, num_failures, filename.c_str());
+	return 0;
+}
+
+
+// Replays the preview of a preview optimization record, i.e. the rollout of its starting
+// preview control from its actual reduced-body state
+static bool replayPreview(dwl::simulation::PreviewLocomotion& preview,
+						  dwl::ReducedBodyTrajectory& trajectory,
+						  dwl::SnapshotDecoder& snapshot)
+{
+	dwl::WholeBodyState whole_body_state;
+	dwl::ReducedBodyState reduced_state;
+	dwl::simulation::PreviewControl control;
+	dwl::simulation::VelocityCommand command;
+	double computation_time = 0.;
+	snapshot.readState(whole_body_state);
+	snapshot.readState(reduced_state);
+	snapshot.readPreviewControl(control);
+	snapshot.readVelocityCommand(command);
+	snapshot.readDouble(computation_time);
+	if (!snapshot.isValid())
+		return false;
+
+	DWL_SCOPED_TIMER("PreviewOptimization::replayPreview");
+	preview.multiPhasePreview(trajectory, reduced_state, control);
+	return !trajectory.empty();
+}
+
+
+static int replay(const std::string& filename)
+{
+	dwl::SnapshotReader reader;
+	if (!reader.open(filename))
+		return 1;
+
+	// The planners of the recorded solves
+	ScenarioPlanning scenario_planning;
+#ifdef DWL_WITH_IPOPT
+	ScenarioTrajectoryOptimization optimization;
+#endif
+	dwl::simulation::PreviewLocomotion preview;
+	dwl::ReducedBodyTrajectory preview_trajectory;
+	bool with_preview_model = false;
+
+	// Replaying the records in order, since the planners keep the state of the previous
+	// solves (e.g. an unchanged terrain map or the relaxation of the constraints)
+	dwl::utils::Instrumentation::reset();
+	std::map<uint32_t,ReplaySummary> summaries;
+	printf("%8s %-36s %14s %14s %8s\n", "record", "solve", "recorded [s]", "replay [ms]",
+			"result");
+	for (unsigned int r = 0; r < reader.getNumberOfRecords(); r++) {
+		const dwl::solve_snapshot::RecordHeader& header = reader.getHeader(r);
+		dwl::SnapshotDecoder snapshot = reader.getPayload(r);
+		if (header.kind == dwl::solve_snapshot::PreviewOptimizationKind && !with_preview_model) {
+			preview.resetFromURDFFile(DWL_SOURCE_DIR"/sample/hyq.urdf",
+									  DWL_SOURCE_DIR"/config/hyq.yarf");
+			with_preview_model = true;
+		}
+
+		bool replayed = true, solved = false;
+		Clock::time_point started_time = Clock::now();
+		switch (header.kind) {
+			case dwl::solve_snapshot::HierarchicalPlanningKind:
+				solved = scenario_planning.planner.replay(snapshot);
+				break;
+			case dwl::solve_snapshot::PreviewOptimizationKind:
+				solved = replayPreview(preview, preview_trajectory, snapshot);
+				break;
+#ifdef DWL_WITH_IPOPT
+			case dwl::solve_snapshot::WholeBodyTrajectoryOptimizationKind:
+				solved = optimization.wbto.replay(snapshot);
+				break;
+#endif
+			default:
+				replayed = false;
+				break;
+		}
+		double replay_time = std::chrono::duration<double,std::milli>(
+				Clock::now() - started_time).count();
+
+		if (!replayed) {
+			printf("%8u %-36s %14.3f %14s %8s\n", header.sequence, getKindName(header.kind),
+					header.wall_time, "-", "skipped");
+			continue;
+		}
+		printf("%8u %-36s %14.3f %14.3f %8s\n", header.sequence, getKindName(header.kind),
+				header.wall_time, replay_time, solved ? "solved" : "failed");
+
+		ReplaySummary& summary = summaries[header.kind];
+		summary.num_records++;
+		summary.num_failures += solved ? 0 : 1;
+		summary.total_time += replay_time;
+		summary.max_time = std::max(summary.max_time, replay_time);
+	}
+
+	printf("\n%-36s %8s %8s %14s %14s\n", "solve", "records", "failed", "mean [ms]",
+			"max [ms]");
+	for (std::map<uint32_t,ReplaySummary>::const_iterator it = summaries.begin();
+			it != summaries.end(); ++it) {
+		const ReplaySummary& summary = it->second;
+		printf("%-36s %8u %8u %14.3f %14.3f\n", getKindName(it->first), summary.num_records,
+				summary.num_failures, summary.total_time / summary.num_records,
+				summary.max_time);
+	}
+	printf("\n");
+	dwl::utils::Instrumentation::print();
+#ifndef DWL_WITH_INSTRUMENTATION
+	printf(YELLOW "Warning: the instrumentation is disabled, so the solves aren't broken"
+			" down (build with -DDWL_WITH_INSTRUMENTATION=ON)\n" COLOR_RESET);
+#endif
+#ifndef DWL_WITH_IPOPT
+	printf(YELLOW "Warning: the whole-body trajectory optimization records are skipped"
+			" because Ipopt is not available\n" COLOR_RESET);
+#endif
+
+	return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+	if (argc >= 3 && strcmp(argv[1], "--record") == 0) {
+		TerrainScenario scenario = StairsTerrain;
+		if (argc > 3 && !readScenario(scenario, argv[3])) {
+			printf(RED "FATAL: the %s scenario doesn't exist (stairs, rubble or gaps)\n"
+					COLOR_RESET, argv[3]);
+			return 1;
+		}
+		unsigned int num_plans = argc > 4 ? atoi(argv[4]) : 10;
+		unsigned int seed = argc > 5 ? atoi(argv[5]) : 1;
+		return record(argv[2], scenario, num_plans, seed);
+	} else if (argc == 2 && strcmp(argv[1], "--record") != 0) {
+		return replay(argv[1]);
+	}
+
+	printf("Usage: %s <snapshot_file>\n"
+			"       %s --record <snapshot_file> [stairs|rubble|gaps] [num_plans] [seed]\n",
+			argv[0], argv[0]);
+	return 1;
+}
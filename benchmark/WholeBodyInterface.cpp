@@ -1,14 +1,91 @@
 #include <dwl/WholeBodyState.h>
+#include <dwl/TrajectoryContainer.h>
 #include <dwl/model/WholeBodyKinematics.h>
 #include <dwl/model/WholeBodyDynamics.h>
 #include <ctime>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+
+/** @brief Timing of a workload, i.e. its name and the CPU time per call in microseconds */
+typedef std::pair<std::string,double> Timing;
+
+
+/**
+ * @brief Reports the timing of a workload, where the human-readable line is printed and the
+ * timing is recorded for the JSON output
+ * @param std::vector<Timing>& Recorded timings
+ * @param const std::string& Name of the workload
+ * @param const std::string& Label of the human-readable line
+ * @param std::clock_t Start CPU time of the workload
+ * @param unsigned int Number of calls
+ * @return The CPU time per call in microseconds
+ */
+double report(std::vector<Timing>& timings,
+			  const std::string& name,
+			  const std::string& label,
+			  std::clock_t startcputime,
+			  unsigned int num_calls)
+{
+	double cpu_duration =
+			(std::clock() - startcputime) * 1000000 / (double) CLOCKS_PER_SEC;
+	double call_duration = cpu_duration / num_calls;
+	std::cout << "  " << label << ": " << call_duration << " (microsecs, CPU time)" << std::endl;
+	timings.push_back(Timing(name, call_duration));
+
+	return call_duration;
+}
+
+
+/**
+ * @brief Writes the timings in JSON, i.e. the workload parameters and the CPU time per call
+ * (microseconds) of every workload, which are compared with the Python ones by
+ * WholeBodyInterface.py
+ * @param const std::string& JSON file
+ * @param unsigned int Number of iterations
+ * @param unsigned int Number of states of the batched calls
+ * @param const std::vector<Timing>& Recorded timings
+ */
+void writeJSON(const std::string& filename,
+			   unsigned int num_iterations,
+			   unsigned int batch_size,
+			   const std::vector<Timing>& timings)
+{
+	std::ofstream file(filename.c_str());
+	file.precision(12);
+	file << "{\n  \"language\": \"cpp\",\n";
+	file << "  \"iterations\": " << num_iterations << ",\n";
+	file << "  \"batch_size\": " << batch_size << ",\n";
+	file << "  \"timings_us\": {";
+	for (unsigned int i = 0; i < timings.size(); i++)
+		file << (i == 0 ? "\n" : ",\n") << "    \"" << timings[i].first << "\": " << timings[i].second;
+	file << "\n  }\n}\n";
+}
 
 
 int main(int argc, char **argv)
 {
-	// The number of iterations
+	// The number of iterations, the number of states of the batched calls and the JSON file of
+	// the timings, i.e. wif_benchmark [iterations] [batch_size] [--json file]
 	unsigned int N = 100000;
+	unsigned int B = 100;
+	std::string json_file;
+	std::vector<unsigned int> values;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			json_file = argv[++i];
+		else
+			values.push_back(atoi(argv[i]));
+	}
+	if (values.size() > 0 && values[0] > 0)
+		N = values[0];
+	if (values.size() > 1 && values[1] > 0)
+		B = values[1];
+	unsigned int num_batches = std::max(N / B, 1u);
+	std::vector<Timing> timings;
 
 	dwl::WholeBodyState ws;
 	dwl::model::FloatingBaseSystem fbs;
@@ -52,31 +129,45 @@ int main(int argc, char **argv)
 	grf["rh_foot"] << 0, 0, 0, 0, 0, 190.778;
 
 
+	// Single calls, which are the same workloads of the Python benchmark
+	std::cout << "Single calls:" << std::endl;
+	dwl::rbd::BodySelector feet = fbs.getEndEffectorNames(dwl::model::FOOT);
 	std::clock_t startcputime = std::clock();
-	dwl::rbd::BodyVectorXd contact_pos_W;
+	dwl::rbd::BodyVectorXd contact_pos_B;
 	for (unsigned int i = 0; i < N; ++i)
-		contact_pos_W = wkin.computePosition(ws.base_pos, ws.joint_pos,
-											 fbs.getEndEffectorNames(), // it uses all the end-effector of the system
-											 dwl::rbd::Linear, dwl::RollPitchYaw);
+		contact_pos_B = wkin.computePosition(ws.base_pos, ws.joint_pos,
+											 feet, dwl::rbd::Linear, dwl::RollPitchYaw);
+	double cpu_duration = report(timings, "single/forward_kinematics",
+								 "Forward kinematics", startcputime, N);
 
-	double cpu_duration =
-				(std::clock() - startcputime) * 1000000 / (double) CLOCKS_PER_SEC;
-	std::cout << "  Forward kinematics: " << cpu_duration / N << " (microsecs, CPU time)" << std::endl;
+	// Computing the forward kinematics body-by-body, i.e. one kinematics
+	// update per body, in order to report the gain of the single-pass update
+	startcputime = std::clock();
+	dwl::rbd::BodyVectorXd body_pos_B;
+	for (unsigned int i = 0; i < N; ++i) {
+		for (unsigned int k = 0; k < feet.size(); ++k) {
+			dwl::rbd::BodySelector body(1, feet[k]);
+			wkin.computeForwardKinematics(body_pos_B,
+										  ws.base_pos, ws.joint_pos,
+										  body, dwl::rbd::Linear, dwl::RollPitchYaw);
+		}
+	}
+	double cpu_duration_per_body = report(timings, "single/forward_kinematics_per_body",
+										  "Forward kinematics (per-body update)",
+										  startcputime, N);
+	std::cout << "  Single-pass gain: " << cpu_duration_per_body / cpu_duration << "x" << std::endl;
 
 
 	dwl::rbd::BodyVector3d ik_pos;
-	ik_pos["lf_foot"] = contact_pos_W.find("lf_foot")->second.tail(3);
-	ik_pos["rf_foot"] = contact_pos_W.find("rf_foot")->second.tail(3);
-	ik_pos["lh_foot"] = contact_pos_W.find("lh_foot")->second.tail(3);
-	ik_pos["rh_foot"] = contact_pos_W.find("rh_foot")->second.tail(3);
+	for (dwl::rbd::BodyVectorXd::const_iterator it = contact_pos_B.begin();
+			it != contact_pos_B.end(); ++it)
+		ik_pos[it->first] = it->second.tail(3);
 	Eigen::VectorXd joint_pos_init = fbs.getDefaultPosture();
+	Eigen::VectorXd joint_pos = ws.joint_pos;
 	startcputime = std::clock();
 	for (unsigned int i = 0; i < N; ++i)
-		wkin.computeJointPosition(ws.joint_pos, ik_pos, joint_pos_init);
-
-	cpu_duration =
-				(std::clock() - startcputime) * 1000000 / (double) CLOCKS_PER_SEC;
-	std::cout << "  Inverse kinematics: " << cpu_duration / N << " (microsecs, CPU time)" << std::endl;
+		wkin.computeJointPosition(joint_pos, ik_pos, joint_pos_init);
+	report(timings, "single/inverse_kinematics", "Inverse kinematics", startcputime, N);
 
 
 	startcputime = std::clock();
@@ -84,11 +175,9 @@ int main(int argc, char **argv)
 	for (unsigned int i = 0; i < N; ++i)
 		wkin.computeJacobian(jacobian,
 							 ws.base_pos, ws.joint_pos,
-							 fbs.getEndEffectorNames(dwl::model::FOOT),
-							 dwl::rbd::Full);
-	cpu_duration =
-			(std::clock() - startcputime) * 1000000 / (double) CLOCKS_PER_SEC;
-	std::cout << "  Jacobians: " << cpu_duration / N << " (microsecs, CPU time)" << std::endl;
+							 feet, dwl::rbd::Linear);
+	report(timings, "single/jacobian", "Jacobians", startcputime, N);
+
 
 	startcputime = std::clock();
 	for (unsigned int i = 0; i < N; ++i)
@@ -96,19 +185,90 @@ int main(int argc, char **argv)
 									ws.base_pos, ws.joint_pos,
 									ws.base_vel, ws.joint_vel,
 									ws.base_acc, ws.joint_acc, grf);
-
-	cpu_duration =
-			(std::clock() - startcputime) * 1000000 / (double) CLOCKS_PER_SEC;
-	std::cout << "  Inverse dynamics: " << cpu_duration / N << " (microsecs, CPU time)" << std::endl;
+	report(timings, "single/inverse_dynamics", "Inverse dynamics", startcputime, N);
 
 
 	Eigen::MatrixXd inertial_mat;
 	startcputime = std::clock();
 	for (unsigned int i = 0; i < N; ++i)
 		inertial_mat = wdyn.computeJointSpaceInertiaMatrix(ws.base_pos, ws.joint_pos);
+	report(timings, "single/joint_space_inertia_matrix", "Joint space inertia matrix",
+		   startcputime, N);
+
+
+	// Batched calls of B states with one thread, i.e. N states in total, where every column
+	// is a state
+	std::cout << "Batched calls (" << B << " states per call):" << std::endl;
+	Eigen::MatrixXd base_pos_batch = ws.base_pos.replicate(1, B);
+	Eigen::MatrixXd joint_pos_batch = ws.joint_pos.replicate(1, B);
+	Eigen::MatrixXd base_vel_batch = ws.base_vel.replicate(1, B);
+	Eigen::MatrixXd joint_vel_batch = ws.joint_vel.replicate(1, B);
+	Eigen::MatrixXd base_acc_batch = ws.base_acc.replicate(1, B);
+	Eigen::MatrixXd joint_acc_batch = ws.joint_acc.replicate(1, B);
+	dwl::rbd::BodySelector ee_names = fbs.getEndEffectorNames();
+	Eigen::MatrixXd ext_force_batch = Eigen::MatrixXd::Zero(6 * ee_names.size(), B);
+	for (unsigned int k = 0; k < ee_names.size(); ++k) {
+		dwl::rbd::BodyVector6d::const_iterator it = grf.find(ee_names[k]);
+		if (it != grf.end())
+			ext_force_batch.block(6 * k, 0, 6, B) = it->second.replicate(1, B);
+	}
+
+	startcputime = std::clock();
+	Eigen::MatrixXd op_pos_batch;
+	for (unsigned int i = 0; i < num_batches; ++i)
+		wkin.computeForwardKinematics(op_pos_batch, base_pos_batch, joint_pos_batch,
+									  feet, dwl::rbd::Linear, dwl::RollPitchYaw, 1);
+	report(timings, "batch/forward_kinematics", "Forward kinematics",
+		   startcputime, num_batches);
+
+	startcputime = std::clock();
+	Eigen::MatrixXd base_wrench_batch, joint_forces_batch;
+	for (unsigned int i = 0; i < num_batches; ++i)
+		wdyn.computeInverseDynamics(base_wrench_batch, joint_forces_batch,
+									base_pos_batch, joint_pos_batch,
+									base_vel_batch, joint_vel_batch,
+									base_acc_batch, joint_acc_batch,
+									ext_force_batch, 1);
+	report(timings, "batch/inverse_dynamics", "Inverse dynamics",
+		   startcputime, num_batches);
+
+
+	// Access to the states, i.e. the copies of the whole-body states against the views of the
+	// trajectory containers
+	std::cout << "State access:" << std::endl;
+	dwl::WholeBodyTrajectory trajectory(B, ws);
+	dwl::WholeBodyTrajectoryContainer container;
+	container.fromTrajectory(trajectory);
+
+	startcputime = std::clock();
+	Eigen::VectorXd joint_pos_copy;
+	for (unsigned int i = 0; i < N; ++i)
+		joint_pos_copy = ws.getJointPosition();
+	report(timings, "view/state_joint_position_copy", "Joint position (copy)", startcputime, N);
+
+	startcputime = std::clock();
+	double accumulated = 0.;
+	for (unsigned int i = 0; i < N; ++i)
+		accumulated += container.getView(i % B).joint_pos()(0);
+	report(timings, "view/container_joint_position_view", "Joint position (container view)",
+		   startcputime, N);
+
+	startcputime = std::clock();
+	dwl::WholeBodyState point;
+	for (unsigned int i = 0; i < N; ++i)
+		container.getState(point, i % B);
+	report(timings, "view/container_get_state", "Container state (copy)", startcputime, N);
+
+	startcputime = std::clock();
+	for (unsigned int i = 0; i < num_batches; ++i)
+		container.fromTrajectory(trajectory);
+	report(timings, "view/trajectory_to_container", "Trajectory to container",
+		   startcputime, num_batches);
+	if (accumulated != accumulated) // it prevents that the view loop is optimized out
+		std::cout << accumulated << std::endl;
+
+	if (!json_file.empty())
+		writeJSON(json_file, N, B, timings);
 
-	cpu_duration =
-				(std::clock() - startcputime) * 1000000 / (double) CLOCKS_PER_SEC;
-	std::cout << "  Joint space inertia matrix: " << cpu_duration / N << " (microsecs, CPU time)" << std::endl;
 	return 0;
 }
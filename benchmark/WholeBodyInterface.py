@@ -1,120 +1,273 @@
 from __future__ import print_function
 # This lets us use the python3-style print() function even in python2. It should have no effect if you're already running python3.
 
+# Overhead benchmark of the Python bindings. It runs the same workloads of the C++ benchmark
+# (bin/wif_benchmark), i.e. single calls, batched calls and state access (copies against
+# zero-copy views), and it reports the CPU time per call of both languages, the binding
+# overhead per call, the speedup of the batched calls and the cost of converting the inputs
+# in JSON, e.g.
+#   python WholeBodyInterface.py --iterations 100000 --batch-size 100 --output overhead.json
+
 import os
+import argparse
+import json
+import tempfile
+import subprocess
+import time
 import dwl
 import numpy as np
-import time
-import subprocess
 
 
 fpath = os.path.dirname(os.path.abspath(__file__))
+cpu_time = getattr(time, 'process_time', None) or time.clock
+
+
+def measure(function, num_calls, baseline=0.):
+    # CPU time per call in microseconds, where the loop overhead (baseline) is removed
+    start = cpu_time()
+    for x in range(0, num_calls):
+        function()
+    duration = (cpu_time() - start) * 1000000. / num_calls
+    return max(duration - baseline, 0.)
+
+
+def runCppBenchmark(binary, num_iterations, batch_size):
+    # Running the C++ benchmark with the same workloads, which writes its timings in JSON
+    handle, json_file = tempfile.mkstemp(suffix='.json')
+    os.close(handle)
+    try:
+        subprocess.check_call([binary, str(num_iterations), str(batch_size), '--json', json_file])
+        with open(json_file) as f:
+            return json.load(f)['timings_us']
+    finally:
+        os.remove(json_file)
+
+
+def runPythonBenchmark(num_iterations, batch_size):
+    N = num_iterations
+    B = batch_size
+    num_batches = max(N // B, 1)
+    timings = {}
+
+    # Construct an instance of the WholeBodyDynamics class, which wraps the C++ class.
+    ws = dwl.WholeBodyState()
+    fbs = dwl.FloatingBaseSystem()
+    wkin = dwl.WholeBodyKinematics()
+    wdyn = dwl.WholeBodyDynamics()
+
+    # Resetting the system from the hyq urdf file
+    wdyn.modelFromURDFFile(fpath + "/../sample/hyq.urdf", fpath + "/../config/hyq.yarf")
+    fbs = wdyn.getFloatingBaseSystem()
+    wkin = wdyn.getWholeBodyKinematics()
+
+
+    # Define the DoF after initializing the robot model
+    ws.setJointDoF(fbs.getJointDoF())
+
+
+    # The robot state
+    ws.setBasePosition(np.array([0., 0., 0.]))
+    ws.setBaseRPY(np.array([0., 0., 0.]))
+    ws.setBaseVelocity_W(np.array([0., 0., 0.]))
+    ws.setBaseRPYVelocity_W(np.array([0., 0., 0.]))
+    ws.setBaseAcceleration_W(np.array([0., 0., 0.]))
+    ws.setBaseRPYAcceleration_W(np.array([0., 0., 0.]))
+    ws.setJointPosition(0.75, fbs.getJointId("lf_hfe_joint"))
+    ws.setJointPosition(-1.5, fbs.getJointId("lf_kfe_joint"))
+    ws.setJointPosition(-0.75, fbs.getJointId("lh_hfe_joint"))
+    ws.setJointPosition(1.5, fbs.getJointId("lh_kfe_joint"))
+    ws.setJointPosition(0.75, fbs.getJointId("rf_hfe_joint"))
+    ws.setJointPosition(-1.5, fbs.getJointId("rf_kfe_joint"))
+    ws.setJointPosition(-0.75, fbs.getJointId("rh_hfe_joint"))
+    ws.setJointPosition(1.5, fbs.getJointId("rh_kfe_joint"))
+
+    grf = { 'lf_foot' : np.array([0., 0., 0., 0., 0., 190.778]),
+            'rf_foot' : np.array([0., 0., 0., 0., 0., 190.778]),
+            'lh_foot' : np.array([0., 0., 0., 0., 0., 190.778]),
+            'rh_foot' : np.array([0., 0., 0., 0., 0., 190.778]) };
+    base_eff = ws.base_eff
+    joint_eff = ws.joint_eff
+    base_pos = ws.base_pos
+    joint_pos = ws.joint_pos
+    base_vel = ws.base_vel
+    joint_vel = ws.joint_vel
+    base_acc = ws.base_acc
+    joint_acc = ws.joint_acc
+
+    # Overhead of the timing loop, which is removed from the timings
+    baseline = measure(lambda: None, N)
+
+
+    # Single calls
+    feet = fbs.getEndEffectorNames(dwl.FOOT)
+    contact_pos_B = wkin.computePosition(base_pos, joint_pos, feet, dwl.Linear)
+    timings['single/forward_kinematics'] = \
+        measure(lambda: wkin.computePosition(base_pos, joint_pos, feet, dwl.Linear), N, baseline)
+
+    bodies = [[foot] for foot in feet]
+    def computePositionPerBody():
+        for body in bodies:
+            wkin.computePosition(base_pos, joint_pos, body, dwl.Linear)
+    timings['single/forward_kinematics_per_body'] = \
+        measure(computePositionPerBody, N, baseline)
+
+    wkin.setIKSolver(1.0e-12, 0.01, 50)
+    joint_pos_init = fbs.getDefaultPosture();
+    ik_joint_pos = np.array(joint_pos)
+    timings['single/inverse_kinematics'] = \
+        measure(lambda: wkin.computeJointPosition(ik_joint_pos, contact_pos_B, joint_pos_init),
+                N, baseline)
+
+    jacobian = np.zeros([3 * fbs.getNumberOfEndEffectors(dwl.FOOT), 6 + fbs.getJointDoF()])
+    timings['single/jacobian'] = \
+        measure(lambda: wkin.computeJacobian(jacobian, base_pos, joint_pos, feet, dwl.Linear),
+                N, baseline)
+
+    timings['single/inverse_dynamics'] = \
+        measure(lambda: wdyn.computeInverseDynamics(base_eff, joint_eff,
+                                                    base_pos, joint_pos,
+                                                    base_vel, joint_vel,
+                                                    base_acc, joint_acc,
+                                                    grf), N, baseline)
+
+    timings['single/joint_space_inertia_matrix'] = \
+        measure(lambda: wdyn.computeJointSpaceInertiaMatrix(base_pos, joint_pos), N, baseline)
+
+
+    # Batched calls of B states with one thread, where every row is a state
+    base_pos_batch = np.tile(base_pos, (B, 1))
+    joint_pos_batch = np.tile(joint_pos, (B, 1))
+    base_vel_batch = np.tile(base_vel, (B, 1))
+    joint_vel_batch = np.tile(joint_vel, (B, 1))
+    base_acc_batch = np.tile(base_acc, (B, 1))
+    joint_acc_batch = np.tile(joint_acc, (B, 1))
+    ee_names = fbs.getEndEffectorNames()
+    ext_force_batch = np.tile(np.concatenate([grf.get(name, np.zeros(6)) for name in ee_names]),
+                              (B, 1))
+    timings['batch/forward_kinematics'] = \
+        measure(lambda: wkin.computePositionBatch(base_pos_batch, joint_pos_batch,
+                                                  feet, dwl.Linear, dwl.RollPitchYaw, 1),
+                num_batches)
+
+    timings['batch/inverse_dynamics'] = \
+        measure(lambda: wdyn.computeInverseDynamicsBatch(base_pos_batch, joint_pos_batch,
+                                                         base_vel_batch, joint_vel_batch,
+                                                         base_acc_batch, joint_acc_batch,
+                                                         ext_force_batch, 1),
+                num_batches)
+
+    # The Fortran-ordered (e.g. transposed) arrays are converted to C-ordered arrays in every
+    # call, contrary to the C-ordered arrays that are mapped without copying them
+    base_pos_fortran = np.asfortranarray(base_pos_batch)
+    joint_pos_fortran = np.asfortranarray(joint_pos_batch)
+    timings['batch/forward_kinematics_converted'] = \
+        measure(lambda: wkin.computePositionBatch(base_pos_fortran, joint_pos_fortran,
+                                                  feet, dwl.Linear, dwl.RollPitchYaw, 1),
+                num_batches)
+
+
+    # Access to the states, i.e. the copies of the whole-body states against the zero-copy
+    # views of the attributes and of the trajectory containers
+    trajectory = dwl.WholeBodyTrajectory(B, ws)
+    container = dwl.WholeBodyTrajectoryContainer()
+    container.fromTrajectory(trajectory)
+    point = dwl.WholeBodyState()
+    index = [0]
+    def nextIndex():
+        index[0] = (index[0] + 1) % B
+        return index[0]
+    index_baseline = measure(nextIndex, N)
+
+    timings['view/state_joint_position_copy'] = \
+        measure(lambda: ws.getJointPosition(), N, baseline)
+
+    timings['view/state_joint_position_view'] = \
+        measure(lambda: ws.joint_pos, N, baseline)
+
+    timings['view/container_joint_position_view'] = \
+        measure(lambda: container.joint_pos[0, nextIndex()], N, index_baseline)
+
+    timings['view/container_get_state'] = \
+        measure(lambda: container.getState(point, nextIndex()), N, index_baseline)
+
+    timings['view/trajectory_to_container'] = \
+        measure(lambda: container.fromTrajectory(trajectory), num_batches)
+
+    timings['view/container_to_arrays'] = \
+        measure(lambda: dwl.wholeBodyTrajectoryToArrays(container), num_batches)
+
+    return timings
+
+
+def compare(cpp, python, batch_size):
+    # Binding overhead per call of the workloads of both languages
+    workloads = {}
+    for name in sorted(python):
+        if name not in cpp:
+            continue
+        workloads[name] = { 'cpp_us' : cpp[name],
+                            'python_us' : python[name],
+                            'overhead_us' : python[name] - cpp[name],
+                            'ratio' : python[name] / cpp[name] if cpp[name] > 0. else None }
+
+    # Speedup of the batched calls per state, which indicates the tools that should move to
+    # the batched interfaces
+    batching = {}
+    for name in ['forward_kinematics', 'inverse_dynamics']:
+        single = python['single/' + name]
+        per_state = python['batch/' + name] / batch_size
+        batching[name] = { 'single_us' : single,
+                           'batch_per_state_us' : per_state,
+                           'speedup' : single / per_state if per_state > 0. else None }
+
+    # Conversion costs, i.e. the time of the copies that the views avoid
+    conversion = {
+        'batch_input_conversion_us' :
+            python['batch/forward_kinematics_converted'] - python['batch/forward_kinematics'],
+        'state_copy_us' :
+            python['view/state_joint_position_copy'] - python['view/state_joint_position_view'],
+        'container_state_copy_us' :
+            python['view/container_get_state'] - python['view/container_joint_position_view'] }
+
+    return workloads, batching, conversion
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Overhead of the Python bindings against C++')
+    parser.add_argument('--iterations', type=int, default=100000,
+                        help='number of calls (or states of the batched calls)')
+    parser.add_argument('--batch-size', type=int, default=100,
+                        help='number of states of the batched calls')
+    parser.add_argument('--cpp-benchmark', default=fpath + '/../bin/wif_benchmark',
+                        help='C++ benchmark executable')
+    parser.add_argument('--skip-cpp', action='store_true',
+                        help='runs only the Python workloads')
+    parser.add_argument('--output', default=None,
+                        help='JSON file of the report (it is printed otherwise)')
+    args = parser.parse_args()
+
+    cpp = {}
+    if not args.skip_cpp:
+        print("C++ benchmark:")
+        cpp = runCppBenchmark(args.cpp_benchmark, args.iterations, args.batch_size)
+
+    print("Python benchmark:")
+    python = runPythonBenchmark(args.iterations, args.batch_size)
+    for name in sorted(python):
+        print("  " + name + ": ", python[name], "(microsecs, CPU time)")
 
-# Running the C++ benchmark
-print("C++ benchmark:")
-args = (fpath + "/../bin/wif_benchmark")
-popen = subprocess.call(args, stdin=None, stdout=None, stderr=None, shell=True)
-
-
-# Running the python benchmark
-# Number of iterations
-print("Python benchmark:")
-N = 100000
-
-# Construct an instance of the WholeBodyDynamics class, which wraps the C++ class.
-ws = dwl.WholeBodyState()
-fbs = dwl.FloatingBaseSystem()
-wkin = dwl.WholeBodyKinematics()
-wdyn = dwl.WholeBodyDynamics()
-
-# Resetting the system from the hyq urdf file
-wdyn.modelFromURDFFile(fpath + "/../sample/hyq.urdf", fpath + "/../config/hyq.yarf")
-fbs = wdyn.getFloatingBaseSystem()
-wkin = wdyn.getWholeBodyKinematics()
-
-
-# Define the DoF after initializing the robot model
-ws.setJointDoF(fbs.getJointDoF())
-
-
-# The robot state
-ws.setBasePosition(np.array([0., 0., 0.]))
-ws.setBaseRPY(np.array([0., 0., 0.]))
-ws.setBaseVelocity_W(np.array([0., 0., 0.]))
-ws.setBaseRPYVelocity_W(np.array([0., 0., 0.]))
-ws.setBaseAcceleration_W(np.array([0., 0., 0.]))
-ws.setBaseRPYAcceleration_W(np.array([0., 0., 0.]))
-ws.setJointPosition(0.75, fbs.getJointId("lf_hfe_joint"))
-ws.setJointPosition(-1.5, fbs.getJointId("lf_kfe_joint"))
-ws.setJointPosition(-0.75, fbs.getJointId("lh_hfe_joint"))
-ws.setJointPosition(1.5, fbs.getJointId("lh_kfe_joint"))
-ws.setJointPosition(0.75, fbs.getJointId("rf_hfe_joint"))
-ws.setJointPosition(-1.5, fbs.getJointId("rf_kfe_joint"))
-ws.setJointPosition(-0.75, fbs.getJointId("rh_hfe_joint"))
-ws.setJointPosition(1.5, fbs.getJointId("rh_kfe_joint"))
-
-grf = { 'lh_foot' : np.array([0., 0., 0., 0., 0., 190.778]),
-        'rf_foot' : np.array([0., 0., 0., 0., 0., 190.778]),
-        'lh_foot' : np.array([0., 0., 0., 0., 0., 190.778]),
-        'rh_foot' : np.array([0., 0., 0., 0., 0., 190.778]) };
-base_eff = ws.base_eff
-joint_eff = ws.joint_eff
-base_pos = ws.base_pos
-joint_pos = ws.joint_pos
-base_vel = ws.base_vel
-joint_vel = ws.joint_vel
-base_acc = ws.base_acc
-joint_acc = ws.joint_acc
-
-
-
-startcputime = time.clock()
-for x in range(0, N):
-    contact_pos_B = wkin.computePosition(base_pos, joint_pos,
-                                         fbs.getEndEffectorNames(dwl.FOOT),
-                                         dwl.Linear)
-cpu_duration = (time.clock() - startcputime) * 1000000;
-print("  Forward kinematics: ", cpu_duration / N, "(microsecs, CPU time)")
-
-
-
-wkin.setIKSolver(1.0e-12, 0.01, 50)
-base_pos_init = np.zeros(6);
-joint_pos_init = fbs.getDefaultPosture();
-startcputime = time.clock()
-for x in range(0, N):
-    wkin.computeJointPosition(joint_pos, contact_pos_B, joint_pos_init)
-cpu_duration = (time.clock() - startcputime) * 1000000;
-print("  Inverse kinematics: ", cpu_duration / N, "(microsecs, CPU time)")
-
-
-
-startcputime = time.clock()
-jacobian = np.zeros([3 * fbs.getNumberOfEndEffectors(dwl.FOOT), 6 + fbs.getJointDoF()])
-for x in range(0, N):
-    wkin.computeJacobian(jacobian,
-                         base_pos, joint_pos,
-                         fbs.getEndEffectorNames(dwl.FOOT),
-                         dwl.Linear)
-cpu_duration = (time.clock() - startcputime) * 1000000;
-print("  Jacobians: ", cpu_duration / N, "(microsecs, CPU time)")
-
-
-
-startcputime = time.clock()
-for x in range(0, N):
-    wdyn.computeInverseDynamics(base_eff, joint_eff,
-                                base_pos, joint_pos,
-                                base_vel, joint_vel,
-                                base_acc, joint_acc,
-                                grf);
-cpu_duration = (time.clock() - startcputime) * 1000000;
-print("  Inverse dynamics: ", cpu_duration / N, "(microsecs, CPU time)")
-
-
-
-startcputime = time.clock()
-for x in range(0, N):
-    joint_inertial_mat = wdyn.computeJointSpaceInertiaMatrix(base_pos, joint_pos);
-cpu_duration = (time.clock() - startcputime) * 1000000;
-print("  Joint space inertia matrix: ", cpu_duration / N, "(microsecs, CPU time)")
\ No newline at end of file
+    workloads, batching, conversion = compare(cpp, python, args.batch_size)
+    report = { 'iterations' : args.iterations,
+               'batch_size' : args.batch_size,
+               'unit' : 'microseconds per call (CPU time)',
+               'cpp' : cpp,
+               'python' : python,
+               'workloads' : workloads,
+               'batching' : batching,
+               'conversion' : conversion }
+    if args.output is None:
+        print(json.dumps(report, indent=2, sort_keys=True))
+    else:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+        print("Report written to " + args.output)
@@ -0,0 +1,160 @@
+#ifndef DWL__FIXED_WHOLE_BODY_STATE__H
+#define DWL__FIXED_WHOLE_BODY_STATE__H
+
+#include <dwl/WholeBodyState.h>
+
+
+namespace dwl
+{
+
+/**
+ * @brief The FixedWholeBodyState class
+ * This class describes the whole-body state of a robot with a number of joints and contacts
+ * known at compile time (e.g. 12 joints and 4 feet for HyQ), with the same conventions than
+ * WholeBodyState. All the quantities use fixed-size Eigen storage, so the state doesn't
+ * allocate heap memory and Eigen unrolls and vectorizes its operations. The contact quantities
+ * are stored as columns, in the order of a list of contact names, and they are expressed in
+ * the base frame. The contacts of the state are the active slots of a bitmask (e.g. the stance
+ * feet of a contact sequence), so the inactive ones are neither converted nor allocated in a
+ * WholeBodyState. The state is converted from and to WholeBodyState for the routines that use
+ * dynamic-size states.
+ */
+template<int JointDoF, int NumContacts>
+class FixedWholeBodyState
+{
+	public:
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+		enum {
+			JointDimension = JointDoF,
+			ContactDimension = NumContacts,
+			SystemDimension = 6 + JointDoF
+		};
+
+		typedef Eigen::Matrix<double, JointDoF, 1> JointVector;
+		typedef Eigen::Matrix<double, 6 + JointDoF, 1> GeneralizedVector;
+		typedef Eigen::Matrix<double, 3, NumContacts> ContactMatrix3d;
+		typedef Eigen::Matrix<double, 6, NumContacts> ContactMatrix6d;
+
+		/** @brief Constructor function, which sets all the quantities to zero */
+		FixedWholeBodyState();
+
+		/** @brief Destructor function */
+		~FixedWholeBodyState();
+
+		/**
+		 * @brief Copies a whole-body state, where the missing contacts are inactive and zero
+		 * @param const WholeBodyState& Whole-body state
+		 * @param const rbd::BodySelector& Names of the contacts (with NumContacts names)
+		 * @return False if the dimensions of the state are not consistent
+		 */
+		bool fromWholeBodyState(const WholeBodyState& state,
+								const rbd::BodySelector& contact_names);
+
+		/**
+		 * @brief Copies this state to a whole-body state, i.e. only its active contacts
+		 * @param WholeBodyState& Whole-body state
+		 * @param const rbd::BodySelector& Names of the contacts (with NumContacts names)
+		 */
+		void toWholeBodyState(WholeBodyState& state,
+							  const rbd::BodySelector& contact_names) const;
+
+		/**
+		 * @brief Gets the generalized position of a fully floating-base system, i.e.
+		 * with the RBDL order [linear base, angular base, joint]
+		 * @param Eigen::Ref<GeneralizedVector> Generalized position (e.g. a map of a workspace)
+		 */
+		void getGeneralizedPosition(Eigen::Ref<GeneralizedVector> q) const;
+
+		/**
+		 * @brief Gets the generalized velocity of a fully floating-base system
+		 * @param Eigen::Ref<GeneralizedVector> Generalized velocity
+		 */
+		void getGeneralizedVelocity(Eigen::Ref<GeneralizedVector> qd) const;
+
+		/**
+		 * @brief Gets the generalized acceleration of a fully floating-base system
+		 * @param Eigen::Ref<GeneralizedVector> Generalized acceleration
+		 */
+		void getGeneralizedAcceleration(Eigen::Ref<GeneralizedVector> qdd) const;
+
+		/**
+		 * @brief Sets the base and joint positions from the generalized position of a fully
+		 * floating-base system
+		 * @param const GeneralizedVector& Generalized position
+		 */
+		void setGeneralizedPosition(const GeneralizedVector& q);
+
+		/**
+		 * @brief Sets the base and joint velocities from the generalized velocity of a fully
+		 * floating-base system
+		 * @param const GeneralizedVector& Generalized velocity
+		 */
+		void setGeneralizedVelocity(const GeneralizedVector& qd);
+
+		/**
+		 * @brief Indicates if a contact slot is active
+		 * @param unsigned int Contact index
+		 */
+		bool isActiveContact(unsigned int index) const;
+
+		/**
+		 * @brief Sets if a contact slot is active, where an inactive slot is set to zero
+		 * @param unsigned int Contact index
+		 * @param bool Active flag
+		 */
+		void setActiveContact(unsigned int index,
+							  bool active);
+
+		/** @brief Gets the number of active contacts */
+		unsigned int getNumberOfActiveContacts() const;
+
+		/** @brief Gets the rotation matrix from the base to the world frame */
+		Eigen::Matrix3d getBaseRotation() const;
+
+		/**
+		 * @brief Gets the contact positions expressed in the world frame
+		 * @param ContactMatrix3d& Contact positions
+		 */
+		void getContactPosition_W(ContactMatrix3d& pos_W) const;
+
+		/**
+		 * @brief Gets the contact velocities expressed in the world frame
+		 * @param ContactMatrix3d& Contact velocities
+		 */
+		void getContactVelocity_W(ContactMatrix3d& vel_W) const;
+
+		/**
+		 * @brief Sets the contact positions from positions expressed in the world frame
+		 * @param const ContactMatrix3d& Contact positions
+		 */
+		void setContactPosition_W(const ContactMatrix3d& pos_W);
+
+		/** @brief Internal whole-body state variables with the WholeBodyState convention */
+		double time;
+		double duration;
+		rbd::Vector6d base_pos;
+		rbd::Vector6d base_vel;
+		rbd::Vector6d base_acc;
+		rbd::Vector6d base_eff;
+		JointVector joint_pos;
+		JointVector joint_vel;
+		JointVector joint_acc;
+		JointVector joint_eff;
+		ContactMatrix3d contact_pos;
+		ContactMatrix3d contact_vel;
+		ContactMatrix3d contact_acc;
+		ContactMatrix6d contact_eff;
+
+		/** @brief Bitmask of the active contact slots, where the bit i describes the slot i */
+		unsigned int active_contacts;
+};
+
+/** @brief Defines the whole-body state of a quadruped with three joints per leg (e.g. HyQ) */
+typedef FixedWholeBodyState<12, 4> QuadrupedWholeBodyState;
+
+} //@namespace dwl
+
+#include <dwl/impl/FixedWholeBodyState.hpp>
+
+#endif
@@ -1,4 +1,5 @@
 #include <dwl/ReducedBodyState.h>
+#include <dwl/utils/MemoryUsage.h>
 
 
 namespace dwl
@@ -11,8 +12,8 @@ ReducedBodyState::ReducedBodyState() : time(0.),
 		angular_vel(Eigen::Vector3d::Zero()),
 		com_acc(Eigen::Vector3d::Zero()),
 		angular_acc(Eigen::Vector3d::Zero()),
-		cop(Eigen::Vector3d::Zero())
-
+		cop(Eigen::Vector3d::Zero()),
+		valid_rotations_(false)
 {
 
 }
@@ -54,17 +55,36 @@ const Eigen::Vector3d& ReducedBodyState::getCoMVelocity_W() const
 }
 
 
+const Eigen::Matrix3d& ReducedBodyState::getBaseToWorldRotation() const
+{
+	updateRotations();
+	return W_rot_B_;
+}
+
+
+const Eigen::Matrix3d& ReducedBodyState::getHorizontalToWorldRotation() const
+{
+	updateRotations();
+	return W_rot_H_;
+}
+
+
+const Eigen::Matrix3d& ReducedBodyState::getBaseToHorizontalRotation() const
+{
+	updateRotations();
+	return H_rot_B_;
+}
+
+
 Eigen::Vector3d ReducedBodyState::getCoMVelocity_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getCoMVelocity_W(),
-										  getOrientation());
+	return getBaseToWorldRotation().transpose() * getCoMVelocity_W();
 }
 
 
 Eigen::Vector3d ReducedBodyState::getCoMVelocity_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getCoMVelocity_W(),
-												getRPY());
+	return getHorizontalToWorldRotation().transpose() * getCoMVelocity_W();
 }
 
 
@@ -76,15 +96,13 @@ const Eigen::Vector3d& ReducedBodyState::getAngularVelocity_W() const
 
 Eigen::Vector3d ReducedBodyState::getAngularVelocity_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getAngularVelocity_W(),
-										  getOrientation());
+	return getBaseToWorldRotation().transpose() * getAngularVelocity_W();
 }
 
 
 Eigen::Vector3d ReducedBodyState::getAngularVelocity_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getAngularVelocity_W(),
-												getRPY());
+	return getHorizontalToWorldRotation().transpose() * getAngularVelocity_W();
 }
 
 
@@ -105,15 +123,13 @@ const Eigen::Vector3d& ReducedBodyState::getCoMAcceleration_W() const
 
 Eigen::Vector3d ReducedBodyState::getCoMAcceleration_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getCoMAcceleration_W(),
-										  getOrientation());
+	return getBaseToWorldRotation().transpose() * getCoMAcceleration_W();
 }
 
 
 Eigen::Vector3d ReducedBodyState::getCoMAcceleration_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getCoMAcceleration_W(),
-												getRPY());
+	return getHorizontalToWorldRotation().transpose() * getCoMAcceleration_W();
 }
 
 
@@ -125,15 +141,13 @@ const Eigen::Vector3d& ReducedBodyState::getAngularAcceleration_W() const
 
 Eigen::Vector3d ReducedBodyState::getAngularAcceleration_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getAngularAcceleration_W(),
-										  getOrientation());
+	return getBaseToWorldRotation().transpose() * getAngularAcceleration_W();
 }
 
 
 Eigen::Vector3d ReducedBodyState::getAngularAcceleration_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getAngularAcceleration_W(),
-												getRPY());
+	return getHorizontalToWorldRotation().transpose() * getAngularAcceleration_W();
 }
 
 
@@ -157,7 +171,7 @@ const Eigen::Vector3d& ReducedBodyState::getCoPPosition_W() const
 Eigen::Vector3d ReducedBodyState::getFootPosition_W(FootIterator pos_it) const
 {
 	return getCoMPosition() +
-			frame_tf_.fromBaseToWorldFrame(pos_it->second, getRPY());
+			getBaseToWorldRotation() * pos_it->second;
 }
 
 
@@ -181,6 +195,18 @@ rbd::BodyVector3d ReducedBodyState::getFootPosition_W() const
 }
 
 
+void ReducedBodyState::getFootPosition_W(rbd::BodyContainer3d& pos_W) const
+{
+	for (unsigned int i = 0; i < pos_W.size(); i++) {
+		FootIterator foot_it = foot_pos.find(pos_W.getName(i));
+		if (foot_it == foot_pos.end())
+			pos_W[i].setZero();
+		else
+			pos_W[i] = getFootPosition_W(foot_it);
+	}
+}
+
+
 const Eigen::Vector3d& ReducedBodyState::getFootPosition_B(FootIterator pos_it) const
 {
 	return pos_it->second;
@@ -203,7 +229,7 @@ const rbd::BodyVector3d& ReducedBodyState::getFootPosition_B() const
 Eigen::Vector3d ReducedBodyState::getFootPosition_H(FootIterator pos_it) const
 {
 	// Note that the horizontal and base frame have the same origin
-	return frame_tf_.fromBaseToHorizontalFrame(pos_it->second, getRPY());
+	return getBaseToHorizontalRotation() * pos_it->second;
 }
 
 
@@ -227,12 +253,24 @@ rbd::BodyVector3d ReducedBodyState::getFootPosition_H() const
 }
 
 
+void ReducedBodyState::getFootPosition_H(rbd::BodyContainer3d& pos_H) const
+{
+	for (unsigned int i = 0; i < pos_H.size(); i++) {
+		FootIterator foot_it = foot_pos.find(pos_H.getName(i));
+		if (foot_it == foot_pos.end())
+			pos_H[i].setZero();
+		else
+			pos_H[i] = getFootPosition_H(foot_it);
+	}
+}
+
+
 Eigen::Vector3d ReducedBodyState::getFootVelocity_W(FootIterator vel_it) const
 {
 	// Computing the foot velocity w.r.t. the world frame.
 	// Here we use the equation:
 	// Xd^W_foot = Xd^W_base + Xd^W_foot/base + omega_base x X^W_foot/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(vel_it->first);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getFootVelocity_B(vel_it);
 
@@ -260,6 +298,18 @@ rbd::BodyVector3d ReducedBodyState::getFootVelocity_W() const
 }
 
 
+void ReducedBodyState::getFootVelocity_W(rbd::BodyContainer3d& vel_W) const
+{
+	for (unsigned int i = 0; i < vel_W.size(); i++) {
+		FootIterator foot_it = foot_vel.find(vel_W.getName(i));
+		if (foot_it == foot_vel.end())
+			vel_W[i].setZero();
+		else
+			vel_W[i] = getFootVelocity_W(foot_it);
+	}
+}
+
+
 const Eigen::Vector3d& ReducedBodyState::getFootVelocity_B(FootIterator vel_it) const
 {
 	return vel_it->second;
@@ -285,7 +335,7 @@ Eigen::Vector3d ReducedBodyState::getFootVelocity_H(FootIterator vel_it) const
 	// Here we use the equation:
 	// Xd^W_foot = Xd^W_base + Xd^W_foot/base + omega^W_base x X^W_foot/base
 	std::string name = vel_it->first;
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getFootVelocity_B(vel_it);
 	Eigen::Vector3d vel_W = getCoMVelocity_W() + vel_fb_W +
@@ -296,7 +346,7 @@ Eigen::Vector3d ReducedBodyState::getFootVelocity_H(FootIterator vel_it) const
 	// Xd^W_foot = Xd^W_hor + Xd^W_foot/hor + omega^W_hor x X^W_foot/hor
 	Eigen::Vector3d omega_hor_W(0., 0., getAngularVelocity_W()(rbd::Z));
 	Eigen::Vector3d pos_fh_W =
-			frame_tf_.fromHorizontalToWorldFrame(getFootPosition_H(name), getRPY());
+			getHorizontalToWorldRotation() * getFootPosition_H(name);
 	return vel_W - getCoMVelocity_W() - omega_hor_W.cross(pos_fh_W);
 }
 
@@ -321,6 +371,18 @@ rbd::BodyVector3d ReducedBodyState::getFootVelocity_H() const
 }
 
 
+void ReducedBodyState::getFootVelocity_H(rbd::BodyContainer3d& vel_H) const
+{
+	for (unsigned int i = 0; i < vel_H.size(); i++) {
+		FootIterator foot_it = foot_vel.find(vel_H.getName(i));
+		if (foot_it == foot_vel.end())
+			vel_H[i].setZero();
+		else
+			vel_H[i] = getFootVelocity_H(foot_it);
+	}
+}
+
+
 Eigen::Vector3d ReducedBodyState::getFootAcceleration_W(FootIterator acc_it) const
 {
 	// Computing the skew symmetric matrixes
@@ -334,7 +396,7 @@ Eigen::Vector3d ReducedBodyState::getFootAcceleration_W(FootIterator acc_it) con
 	// Xdd^W_foot = Xdd^W_base + [C(wd^W) + C(w^W) * C(w^W)] X^W_foot/base
 	// + 2 C(w^W) Xd^W_foot/base
 	std::string name = acc_it->first;
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getFootVelocity_B(name);
 	return getCoMAcceleration_W() +
@@ -362,6 +424,18 @@ rbd::BodyVector3d ReducedBodyState::getFootAcceleration_W() const
 }
 
 
+void ReducedBodyState::getFootAcceleration_W(rbd::BodyContainer3d& acc_W) const
+{
+	for (unsigned int i = 0; i < acc_W.size(); i++) {
+		FootIterator foot_it = foot_acc.find(acc_W.getName(i));
+		if (foot_it == foot_acc.end())
+			acc_W[i].setZero();
+		else
+			acc_W[i] = getFootAcceleration_W(foot_it);
+	}
+}
+
+
 const Eigen::Vector3d& ReducedBodyState::getFootAcceleration_B(FootIterator acc_it) const
 {
 	return acc_it->second;
@@ -401,7 +475,7 @@ Eigen::Vector3d ReducedBodyState::getFootAcceleration_H(FootIterator acc_it) con
 	// Here we use the equation:
 	// Xdd^W_foot = Xdd^W_base + [C(wd^W_base) + C(w^W_base) * C(w^W_base)] X^W_foot/base
 	// + 2 C(w^W_base) Xd^W_foot/base + Xdd^W_foot/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getFootVelocity_B(name);
 	Eigen::Vector3d acc_W = getCoMVelocity_W() +
@@ -412,7 +486,7 @@ Eigen::Vector3d ReducedBodyState::getFootAcceleration_H(FootIterator acc_it) con
 	// Here we use the equation:
 	// Xdd^W_foot = Xdd^W_hor + [C(wd^W_hor) + C(w^W_hor) * C(w^W_hor)] X^W_foot/hor
 	// + 2 C(w^W_hor) Xd^W_foot/hor + Xdd^W_foot/hor
-	Eigen::Matrix3d W_rot_H = frame_tf_.getHorizontalToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_H = getHorizontalToWorldRotation();
 	Eigen::Vector3d pos_fh_W = W_rot_H * getFootPosition_H(name);
 	Eigen::Vector3d vel_fh_W = W_rot_H * getFootVelocity_H(name);
 	return acc_W - getCoMAcceleration_W() -
@@ -441,6 +515,18 @@ rbd::BodyVector3d ReducedBodyState::getFootAcceleration_H() const
 }
 
 
+void ReducedBodyState::getFootAcceleration_H(rbd::BodyContainer3d& acc_H) const
+{
+	for (unsigned int i = 0; i < acc_H.size(); i++) {
+		FootIterator foot_it = foot_acc.find(acc_H.getName(i));
+		if (foot_it == foot_acc.end())
+			acc_H[i].setZero();
+		else
+			acc_H[i] = getFootAcceleration_H(foot_it);
+	}
+}
+
+
 void ReducedBodyState::setTime(const double& _time)
 {
 	time = _time;
@@ -456,12 +542,14 @@ void ReducedBodyState::setCoMPosition(const Eigen::Vector3d& pos_W)
 void ReducedBodyState::setOrientation(const Eigen::Quaterniond& orient_W)
 {
 	angular_pos = math::getRPY(orient_W);
+	valid_rotations_ = false;
 }
 
 
 void ReducedBodyState::setRPY(const Eigen::Vector3d& rpy_W)
 {
 	angular_pos = rpy_W;
+	valid_rotations_ = false;
 }
 
 
@@ -473,13 +561,13 @@ void ReducedBodyState::setCoMVelocity_W(const Eigen::Vector3d& vel_W)
 
 void ReducedBodyState::setCoMVelocity_B(const Eigen::Vector3d& vel_B)
 {
-	com_vel = frame_tf_.fromBaseToWorldFrame(vel_B, getOrientation());
+	com_vel = getBaseToWorldRotation() * vel_B;
 }
 
 
 void ReducedBodyState::setCoMVelocity_H(const Eigen::Vector3d& vel_H)
 {
-	com_vel = frame_tf_.fromHorizontalToWorldFrame(vel_H, getRPY());
+	com_vel = getHorizontalToWorldRotation() * vel_H;
 }
 
 
@@ -491,13 +579,13 @@ void ReducedBodyState::setAngularVelocity_W(const Eigen::Vector3d& rate_W)
 
 void ReducedBodyState::setAngularVelocity_B(const Eigen::Vector3d& rate_B)
 {
-	angular_vel = frame_tf_.fromBaseToWorldFrame(rate_B, getOrientation());
+	angular_vel = getBaseToWorldRotation() * rate_B;
 }
 
 
 void ReducedBodyState::setAngularVelocity_H(const Eigen::Vector3d& rate_H)
 {
-	angular_vel = frame_tf_.fromHorizontalToWorldFrame(rate_H, getRPY());
+	angular_vel = getHorizontalToWorldRotation() * rate_H;
 }
 
 
@@ -515,13 +603,13 @@ void ReducedBodyState::setCoMAcceleration_W(const Eigen::Vector3d& acc_W)
 
 void ReducedBodyState::setCoMAcceleration_B(const Eigen::Vector3d& acc_B)
 {
-	com_acc = frame_tf_.fromBaseToWorldFrame(acc_B, getOrientation());
+	com_acc = getBaseToWorldRotation() * acc_B;
 }
 
 
 void ReducedBodyState::setCoMAcceleration_H(const Eigen::Vector3d& acc_H)
 {
-	com_acc = frame_tf_.fromHorizontalToWorldFrame(acc_H, getRPY());
+	com_acc = getHorizontalToWorldRotation() * acc_H;
 }
 
 
@@ -533,13 +621,13 @@ void ReducedBodyState::setAngularAcceleration_W(const Eigen::Vector3d& rotacc_W)
 
 void ReducedBodyState::setAngularAcceleration_B(const Eigen::Vector3d& rotacc_B)
 {
-	angular_acc = frame_tf_.fromBaseToWorldFrame(rotacc_B, getOrientation());
+	angular_acc = getBaseToWorldRotation() * rotacc_B;
 }
 
 
 void ReducedBodyState::setAngularAcceleration_H(const Eigen::Vector3d& rotacc_H)
 {
-	angular_acc = frame_tf_.fromHorizontalToWorldFrame(rotacc_H, getRPY());
+	angular_acc = getHorizontalToWorldRotation() * rotacc_H;
 }
 
 
@@ -569,8 +657,7 @@ void ReducedBodyState::setFootPosition_W(const std::string& name,
 										 const Eigen::Vector3d& pos_W)
 {
 	foot_pos[name] =
-			frame_tf_.fromWorldToBaseFrame(pos_W - getCoMPosition(),
-										   getRPY());
+			getBaseToWorldRotation().transpose() * (pos_W - getCoMPosition());
 }
 
 
@@ -612,7 +699,7 @@ void ReducedBodyState::setFootPosition_H(const std::string& name,
 {
 	// Note that the horizontal and base frames have the same origin
 	foot_pos[name] =
-			frame_tf_.fromHorizontalToBaseFrame(pos_H, getRPY());
+			getBaseToHorizontalRotation().transpose() * pos_H;
 }
 
 
@@ -636,7 +723,7 @@ void ReducedBodyState::setFootVelocity_W(const std::string& name,
 	// Computing the foot velocity w.r.t. the base but expressed in the world
 	// frame. Here we use the equation:
 	// Xd^W_foot = Xd^W_base + Xd^W_foot/base + omega_base x X^W_foot/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(name);
 	Eigen::Vector3d vel_fb_W = vel_W - getCoMVelocity_W() -
 			getAngularVelocity_W().cross(pos_fb_W);
@@ -685,7 +772,7 @@ void ReducedBodyState::setFootVelocity_H(const std::string& name,
 	// Computing the foot velocity w.r.t. the world frame.
 	// Here we use the equation:
 	// Xd^W_foot = Xd^W_hor + Xd^W_foot/hor + omega^W_hor x X^W_foot/hor
-	Eigen::Matrix3d W_rot_H = frame_tf_.getHorizontalToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_H = getHorizontalToWorldRotation();
 	Eigen::Vector3d pos_fh_W = W_rot_H * getFootPosition_H(name);
 	Eigen::Vector3d vel_fh_W = W_rot_H * vel_H;
 	Eigen::Vector3d omega_h_W(0., 0., getAngularVelocity_W()(rbd::Z));
@@ -694,7 +781,7 @@ void ReducedBodyState::setFootVelocity_H(const std::string& name,
 	// Computing the foot velocity w.r.t. the base but expressed in the world
 	// frame. Here we use the equation:
 	// Xd^W_foot = Xd^W_base + Xd^W_foot/base + omega^W_base x X^W_foot/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(name);
 	Eigen::Vector3d vel_fb_W = vel_W - getCoMVelocity_W() -
 			getAngularVelocity_W().cross(pos_fb_W);
@@ -731,7 +818,7 @@ void ReducedBodyState::setFootAcceleration_W(const std::string& name,
 	// world frame. Here we use the equation:
 	// Xdd^W_foot = Xdd^W_base + [C(wd^W) + C(w^W) * C(w^W)] X^W_foot/base
 	// + 2 C(w^W) Xd^W_foot/base + Xdd^W_foot/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getFootVelocity_B(name);
 	Eigen::Vector3d acc_fb_W = acc_W - getCoMAcceleration_W() -
@@ -796,7 +883,7 @@ void ReducedBodyState::setFootAcceleration_H(const std::string& name,
 	// Here we use the equation:
 	// Xdd^W_foot = Xdd^W_hor + [C(wd^W_hor) + C(w^W_hor) * C(w^W_hor)] X^W_foot/hor
 	// + 2 C(w^W_hor) Xd^W_foot/hor + Xdd^W_foot/hor
-	Eigen::Matrix3d W_rot_H = frame_tf_.getHorizontalToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_H = getHorizontalToWorldRotation();
 	Eigen::Vector3d pos_fh_W = W_rot_H * getFootPosition_H(name);
 	Eigen::Vector3d vel_fh_W = W_rot_H * getFootVelocity_H(name);
 	Eigen::Vector3d acc_fh_W = W_rot_H * acc_H;
@@ -809,7 +896,7 @@ void ReducedBodyState::setFootAcceleration_H(const std::string& name,
 	// world frame. Here we use the equation:
 	// Xdd^W_foot = Xdd^W_base + [C(wd^W) + C(w^W) * C(w^W)] X^W_foot/base
 	// + 2 C(w^W) Xd^W_foot/base + Xdd^W_foot/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getFootPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getFootVelocity_B(name);
 	Eigen::Vector3d acc_fb_W =
@@ -831,4 +918,28 @@ void ReducedBodyState::setFootAcceleration_H(const rbd::BodyVector3d& acc_H)
 	}
 }
 
+
+std::size_t ReducedBodyState::getHeapBytes() const
+{
+	return utils::getHeapBytes(support_region) + utils::getHeapBytes(foot_pos) +
+			utils::getHeapBytes(foot_vel) + utils::getHeapBytes(foot_acc);
+}
+
+
+void ReducedBodyState::updateRotations() const
+{
+	// Note that the states are public, so the cache is also checked against the RPY
+	// angles
+	if (valid_rotations_ && angular_pos == rotation_rpy_)
+		return;
+
+	rotation_rpy_ = angular_pos;
+	// Note that the horizontal rotation is extracted from the base one, so the
+	// trigonometric functions are computed once
+	W_rot_B_ = math::getRotationMatrix(angular_pos);
+	W_rot_H_ = math::getYawRotationMatrix(angular_pos(2));
+	H_rot_B_.noalias() = W_rot_H_.transpose() * W_rot_B_;
+	valid_rotations_ = true;
+}
+
 } //@namespace dwl
@@ -70,6 +70,15 @@ class ReducedBodyState
 		/** @brief Destructor function */
 		~ReducedBodyState();
 
+		/**
+		 * @brief Copy and move functions. Note that the declared destructor suppresses the
+		 * implicit moves, so they are defaulted explicitly
+		 */
+		ReducedBodyState(const ReducedBodyState& other) = default;
+		ReducedBodyState(ReducedBodyState&& other) = default;
+		ReducedBodyState& operator=(const ReducedBodyState& other) = default;
+		ReducedBodyState& operator=(ReducedBodyState&& other) = default;
+
 		// Time getter function
 		/** @brief Gets the time value
 		 * @return The time value
@@ -92,6 +101,23 @@ class ReducedBodyState
 		 */
 		const Eigen::Vector3d& getRPY() const;
 
+		/** @brief Gets the rotation matrix from the CoM to the world frame.
+		 * The rotations are cached while the RPY angles don't change, so the
+		 * const getters shouldn't be called concurrently on the same state
+		 * @return The rotation matrix from the CoM to the world frame
+		 */
+		const Eigen::Matrix3d& getBaseToWorldRotation() const;
+
+		/** @brief Gets the rotation matrix from the horizontal to the world frame
+		 * @return The rotation matrix from the horizontal to the world frame
+		 */
+		const Eigen::Matrix3d& getHorizontalToWorldRotation() const;
+
+		/** @brief Gets the rotation matrix from the CoM to the horizontal frame
+		 * @return The rotation matrix from the CoM to the horizontal frame
+		 */
+		const Eigen::Matrix3d& getBaseToHorizontalRotation() const;
+
 		/** @brief Gets the CoM velocity expressed in the world frame
 		 * @return The CoM velocity expressed in the world frame
 		 */
@@ -188,6 +214,12 @@ class ReducedBodyState
 		 */
 		rbd::BodyVector3d getFootPosition_W() const;
 
+		/** @brief Gets the foot positions expressed in the world frame
+		 * @param[out] pos_W The foot positions indexed by a body container.
+		 * The container has to be reset with the foot names beforehand
+		 */
+		void getFootPosition_W(rbd::BodyContainer3d& pos_W) const;
+
 		/** @brief Gets the foot position expressed the CoM frame
 		 * @param[in] pos_it The foot position iterator
 		 * @return The foot position expressed in the CoM frame
@@ -222,6 +254,12 @@ class ReducedBodyState
 		 */
 		rbd::BodyVector3d getFootPosition_H() const;
 
+		/** @brief Gets the foot positions expressed in the horizontal frame
+		 * @param[out] pos_H The foot positions indexed by a body container.
+		 * The container has to be reset with the foot names beforehand
+		 */
+		void getFootPosition_H(rbd::BodyContainer3d& pos_H) const;
+
 		/** @brief Gets the foot velocity expressed the world frame
 		 * @param[in] vel_it The foot velocity iterator
 		 * @return The foot velocity expressed in the world frame
@@ -239,6 +277,12 @@ class ReducedBodyState
 		 */
 		rbd::BodyVector3d getFootVelocity_W() const;
 
+		/** @brief Gets the foot velocitys expressed in the world frame
+		 * @param[out] vel_W The foot velocitys indexed by a body container.
+		 * The container has to be reset with the foot names beforehand
+		 */
+		void getFootVelocity_W(rbd::BodyContainer3d& vel_W) const;
+
 		/** @brief Gets the foot velocity expressed the base frame
 		 * @param[in] vel_it The foot velocity iterator
 		 * @return The foot velocity expressed in the base frame
@@ -273,6 +317,12 @@ class ReducedBodyState
 		 */
 		rbd::BodyVector3d getFootVelocity_H() const;
 
+		/** @brief Gets the foot velocitys expressed in the horizontal frame
+		 * @param[out] vel_H The foot velocitys indexed by a body container.
+		 * The container has to be reset with the foot names beforehand
+		 */
+		void getFootVelocity_H(rbd::BodyContainer3d& vel_H) const;
+
 		/** @brief Gets the foot acceleration expressed the world frame
 		 * @param[in] acc_it The foot acceleration iterator
 		 * @return The foot acceleration expressed in the world frame
@@ -290,6 +340,12 @@ class ReducedBodyState
 		 */
 		rbd::BodyVector3d getFootAcceleration_W() const;
 
+		/** @brief Gets the foot accelerations expressed in the world frame
+		 * @param[out] acc_W The foot accelerations indexed by a body container.
+		 * The container has to be reset with the foot names beforehand
+		 */
+		void getFootAcceleration_W(rbd::BodyContainer3d& acc_W) const;
+
 		/** @brief Gets the foot acceleration expressed the base frame
 		 * @param[in] acc_it The foot acceleration iterator
 		 * @return The foot acceleration expressed in the base frame
@@ -324,6 +380,12 @@ class ReducedBodyState
 		 */
 		rbd::BodyVector3d getFootAcceleration_H() const;
 
+		/** @brief Gets the foot accelerations expressed in the horizontal frame
+		 * @param[out] acc_H The foot accelerations indexed by a body container.
+		 * The container has to be reset with the foot names beforehand
+		 */
+		void getFootAcceleration_H(rbd::BodyContainer3d& acc_H) const;
+
 
 		// Time setter function
 		/** @brief Sets the time value
@@ -579,6 +641,12 @@ class ReducedBodyState
 		 */
 		void setFootAcceleration_H(const rbd::BodyVector3d& acc_H);
 
+		/**
+		 * @brief Gets the heap bytes of the state, i.e. of its foot states
+		 * @return std::size_t Heap bytes
+		 */
+		std::size_t getHeapBytes() const;
+
 
 		double time;
 		Eigen::Vector3d com_pos;
@@ -595,8 +663,17 @@ class ReducedBodyState
 
 
 	private:
-		/** @brief Frame transformations */
-		math::FrameTF frame_tf_;
+		/** @brief Updates the cached rotations if the RPY angles changed */
+		void updateRotations() const;
+
+		/** @brief Cached rotations of the CoM and horizontal frames, and the
+		 * RPY angles used for computing them. Note that the states could be
+		 * modified directly, so the cache is also checked against the angles */
+		mutable Eigen::Vector3d rotation_rpy_;
+		mutable Eigen::Matrix3d W_rot_B_;
+		mutable Eigen::Matrix3d W_rot_H_;
+		mutable Eigen::Matrix3d H_rot_B_;
+		mutable bool valid_rotations_;
 };
 
 /** @brief Defines a reduced-body trajectory */
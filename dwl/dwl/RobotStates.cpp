@@ -1,10 +1,13 @@
 #include <dwl/RobotStates.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <algorithm>
 
 
 namespace dwl
 {
 
-RobotStates::RobotStates() : num_joints_(0), num_feet_(0), force_threshold_(0.)
+RobotStates::RobotStates() : num_joints_(0), num_feet_(0), force_threshold_(0.),
+		num_threads_(1)
 {
 
 }
@@ -31,19 +34,39 @@ void RobotStates::reset(const model::WholeBodyDynamics& dynamics)
 	// Getting the default position of the CoM system w.r.t. the base frame
 	Eigen::VectorXd q0 = fbs_.getDefaultPosture();
 	com_pos_B_ = fbs_.getSystemCoM(rbd::Vector6d::Zero(), q0);
+
+	// The models of the extra threads are copied again in the next conversion
+	thread_states_.clear();
 }
 
 
 void RobotStates::setForceThreshold(double force_threshold)
 {
 	force_threshold_ = force_threshold;
+	for (unsigned int t = 0; t < thread_states_.size(); t++)
+		thread_states_[t]->force_threshold_ = force_threshold;
+}
+
+
+void RobotStates::setNumberOfThreads(unsigned int num_threads)
+{
+	num_threads_ = num_threads;
 }
 
 
 const WholeBodyState& RobotStates::getWholeBodyState(const ReducedBodyState& state)
+{
+	computeWholeBodyState(ws_, state, NULL);
+	return ws_;
+}
+
+
+void RobotStates::computeWholeBodyState(WholeBodyState& ws,
+										const ReducedBodyState& state,
+										const Eigen::VectorXd* joint_pos_init)
 {
 	// Adding the time
-	ws_.time = state.time;
+	ws.time = state.time;
 
 	// From the reduced-body state we do not know the joint states, so we neglect
 	// the joint-related components of the CoM. Therefore, we transform the
@@ -51,13 +74,13 @@ const WholeBodyState& RobotStates::getWholeBodyState(const ReducedBodyState& sta
 	Eigen::Vector3d com_pos_W =
 			frame_tf_.fromBaseToWorldFrame(com_pos_B_,
 										   state.getRPY());
-	ws_.setBasePosition(state.getCoMPosition() - com_pos_W);
-	ws_.setBaseVelocity_W(computeBaseVelocity_W(state, com_pos_W));
-	ws_.setBaseAcceleration_W(computeBaseAcceleration_W(state, com_pos_W));
+	ws.setBasePosition(state.getCoMPosition() - com_pos_W);
+	ws.setBaseVelocity_W(computeBaseVelocity_W(state, com_pos_W));
+	ws.setBaseAcceleration_W(computeBaseAcceleration_W(state, com_pos_W));
 
-	ws_.setBaseRPY(state.getRPY());
-	ws_.setBaseAngularVelocity_W(state.getAngularVelocity_W());
-	ws_.setBaseAngularAcceleration_W(state.getAngularAcceleration_W());
+	ws.setBaseRPY(state.getRPY());
+	ws.setBaseAngularVelocity_W(state.getAngularVelocity_W());
+	ws.setBaseAngularAcceleration_W(state.getAngularAcceleration_W());
 
 
 	// Adding the contact positions, velocities, accelerations and condition
@@ -68,50 +91,53 @@ const WholeBodyState& RobotStates::getWholeBodyState(const ReducedBodyState& sta
 
 		// Setting up the contact position
 		Eigen::Vector3d contact_pos_B =	state.getFootPosition_B(name) + com_pos_B_;
-		ws_.setContactPosition_B(name, contact_pos_B);
+		ws.setContactPosition_B(name, contact_pos_B);
 		feet_pos[name] = contact_pos_B; // for IK computation
 
 		// Setting up the contact velocity
-		ws_.setContactVelocity_W(name, state.getFootVelocity_W(name));
+		ws.setContactVelocity_W(name, state.getFootVelocity_W(name));
 
 		// Setting up the contact acceleration
-		ws_.setContactAcceleration_W(name, state.getFootAcceleration_W(name));
+		ws.setContactAcceleration_W(name, state.getFootAcceleration_W(name));
 
 		// Setting up the contact condition
 		rbd::BodyVector3d::const_iterator support_it = state.support_region.find(name);
 		if (support_it != state.support_region.end())
-			ws_.setContactCondition(name, true);
+			ws.setContactCondition(name, true);
 		else
-			ws_.setContactCondition(name, false);
+			ws.setContactCondition(name, false);
 	}
 
 	// Adding the joint positions, velocities and accelerations
-	ws_.setJointPosition(Eigen::VectorXd::Zero(num_joints_));
-	ws_.setJointVelocity(Eigen::VectorXd::Zero(num_joints_));
-	ws_.setJointAcceleration(Eigen::VectorXd::Zero(num_joints_));
-
-	// Computing the joint positions
-	wkin_.computeJointPosition(ws_.joint_pos,
-							   feet_pos);
+	ws.setJointPosition(Eigen::VectorXd::Zero(num_joints_));
+	ws.setJointVelocity(Eigen::VectorXd::Zero(num_joints_));
+	ws.setJointAcceleration(Eigen::VectorXd::Zero(num_joints_));
+
+	// Computing the joint positions, where the IK starts from the initial joint position
+	// if it's given
+	if (joint_pos_init != NULL)
+		wkin_.computeJointPosition(ws.joint_pos,
+								   feet_pos,
+								   *joint_pos_init);
+	else
+		wkin_.computeJointPosition(ws.joint_pos,
+								   feet_pos);
 
 	// Computing the joint velocities
-	wkin_.computeJointVelocity(ws_.joint_vel,
-							   ws_.joint_pos,
-							   ws_.contact_vel,
+	wkin_.computeJointVelocity(ws.joint_vel,
+							   ws.joint_pos,
+							   ws.contact_vel,
 							   feet_);
 
 	// Computing the joint accelerations
-	wkin_.computeJointAcceleration(ws_.joint_acc,
-								   ws_.joint_pos,
-								   ws_.joint_vel,
-								   ws_.contact_vel,
+	wkin_.computeJointAcceleration(ws.joint_acc,
+								   ws.joint_pos,
+								   ws.joint_vel,
+								   ws.contact_vel,
 								   feet_);
 
 	// Setting up the desired joint efforts equals to zero
-	ws_.joint_eff = Eigen::VectorXd::Zero(num_joints_);
-
-
-	return ws_;
+	ws.joint_eff = Eigen::VectorXd::Zero(num_joints_);
 }
 
 
@@ -179,18 +205,53 @@ const ReducedBodyState& RobotStates::getReducedBodyState(const WholeBodyState& s
 
 const WholeBodyTrajectory& RobotStates::getWholeBodyTrajectory(const ReducedBodyTrajectory& trajectory)
 {
-	// Getting the number of points defined in the reduced-body trajectory
-	unsigned int num_points = trajectory.size();
+	getWholeBodyTrajectory(wt_, trajectory, 1);
+	return wt_;
+}
 
-	// Resizing the full trajectory vector
-	wt_.clear();
-	wt_.resize(num_points);
 
-	// Getting the full trajectory
-	for (unsigned int k = 0; k < num_points; k++)
-		wt_[k] = getWholeBodyState(trajectory[k]);
+void RobotStates::getWholeBodyTrajectory(WholeBodyTrajectory& full_traj,
+										 const ReducedBodyTrajectory& trajectory,
+										 unsigned int stride)
+{
+	// Getting the converted samples, i.e. every stride-th sample and the last one
+	unsigned int num_points = trajectory.size();
+	if (stride == 0)
+		stride = 1;
+	samples_.clear();
+	for (unsigned int k = 0; k < num_points; k += stride)
+		samples_.push_back(k);
+	if (num_points > 0 && samples_.back() != num_points - 1)
+		samples_.push_back(num_points - 1);
+
+	// Resizing the full trajectory, where its states are reused
+	unsigned int num_samples = samples_.size();
+	full_traj.resize(num_samples);
+	if (num_samples == 0)
+		return;
+
+	// Copying the models of the extra threads only once, since they aren't modified by
+	// the conversion
+	unsigned int num_threads = num_threads_;
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	unsigned int num_chunks = std::max(std::min(num_threads, num_samples), 1u);
+	while (thread_states_.size() < num_chunks - 1) {
+		std::shared_ptr<RobotStates> states = std::make_shared<RobotStates>(*this);
+		states->thread_states_.clear();
+		thread_states_.push_back(states);
+	}
 
-	return wt_;
+	// Converting the samples in contiguous chunks with the task scheduler, where the first
+	// chunk uses these states. Note that the IK warm start is broken only at the chunk
+	// boundaries
+	unsigned int chunk_size = (num_samples + num_chunks - 1) / num_chunks;
+	utils::TaskScheduler::getDefault().parallelFor(num_chunks, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_samples);
+		unsigned int last = std::min(first + chunk_size, num_samples);
+		RobotStates* states = (t == 0) ? this : thread_states_[t-1].get();
+		states->convertChunk(full_traj, trajectory, samples_, first, last);
+	});
 }
 
 
@@ -212,6 +273,20 @@ const ReducedBodyTrajectory& RobotStates::getReducedBodyTrajectory(const WholeBo
 }
 
 
+void RobotStates::convertChunk(WholeBodyTrajectory& full_traj,
+							   const ReducedBodyTrajectory& trajectory,
+							   const std::vector<unsigned int>& samples,
+							   unsigned int first,
+							   unsigned int last)
+{
+	for (unsigned int k = first; k < last; k++) {
+		const Eigen::VectorXd* joint_pos_init =
+				(k > first) ? &full_traj[k-1].joint_pos : NULL;
+		computeWholeBodyState(full_traj[k], trajectory[samples[k]], joint_pos_init);
+	}
+}
+
+
 Eigen::Vector3d RobotStates::computeBaseVelocity_W(const ReducedBodyState& state,
 												   const Eigen::Vector3d& com_pos_W)
 {
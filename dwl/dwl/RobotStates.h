@@ -6,6 +6,7 @@
 #include <dwl/model/WholeBodyKinematics.h>
 #include <dwl/model/WholeBodyDynamics.h>
 #include <dwl/utils/FrameTF.h>
+#include <memory>
 
 
 namespace dwl
@@ -28,6 +29,13 @@ class RobotStates
 		/** @brief Set the force threshold for getting active contacts */
 		void setForceThreshold(double force_threshold);
 
+		/**
+		 * @brief Sets the number of threads of the trajectory conversion, where zero uses the
+		 * hardware concurrency (default is one)
+		 * @param unsigned int Number of threads
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
 		/**
 		 * @brief Converts the reduced-body state to whole-body one
 		 * @param const ReducedBodyStated& Reduced-body state
@@ -50,8 +58,48 @@ class RobotStates
 		const WholeBodyTrajectory& getWholeBodyTrajectory(const ReducedBodyTrajectory& trajectory);
 		const ReducedBodyTrajectory& getReducedBodyTrajectory(const WholeBodyTrajectory& trajectory);
 
+		/**
+		 * @brief Converts a reduced-body trajectory to a whole-body one in place, where the IK
+		 * of every sample starts from the joint position of the previous one. The samples are
+		 * split in contiguous chunks that are converted in parallel (see setNumberOfThreads).
+		 * The stride skips the samples that the consumer interpolates anyway, i.e. it converts
+		 * every stride-th sample and the last one
+		 * @param WholeBodyTrajectory& Whole-body trajectory
+		 * @param const ReducedBodyTrajectory& Reduced-body trajectory
+		 * @param unsigned int Stride of the converted samples
+		 */
+		void getWholeBodyTrajectory(WholeBodyTrajectory& full_traj,
+									const ReducedBodyTrajectory& trajectory,
+									unsigned int stride = 1);
+
 
 	private:
+		/**
+		 * @brief Converts the reduced-body state to a whole-body one
+		 * @param WholeBodyState& Whole-body state
+		 * @param const ReducedBodyState& Reduced-body state
+		 * @param const Eigen::VectorXd* Initial joint position of the IK (NULL uses the
+		 * default one of the kinematics)
+		 */
+		void computeWholeBodyState(WholeBodyState& full_state,
+								   const ReducedBodyState& state,
+								   const Eigen::VectorXd* joint_pos_init);
+
+		/**
+		 * @brief Converts a chunk of samples of a reduced-body trajectory, where the IK is
+		 * warm-started from the previous sample of the chunk
+		 * @param WholeBodyTrajectory& Whole-body trajectory
+		 * @param const ReducedBodyTrajectory& Reduced-body trajectory
+		 * @param const std::vector<unsigned int>& Indexes of the converted samples
+		 * @param unsigned int First converted sample of the chunk
+		 * @param unsigned int Last converted sample of the chunk (not included)
+		 */
+		void convertChunk(WholeBodyTrajectory& full_traj,
+						  const ReducedBodyTrajectory& trajectory,
+						  const std::vector<unsigned int>& samples,
+						  unsigned int first,
+						  unsigned int last);
+
 		/**
 		 * @brief Computes the base velocity in the world frame from the
 		 * CoM acceleration
@@ -104,6 +152,13 @@ class RobotStates
 
 		/** @brief Force threshold */
 		double force_threshold_;
+
+		/** @brief Number of threads, and the copies of the models used by the extra threads */
+		unsigned int num_threads_;
+		std::vector<std::shared_ptr<RobotStates> > thread_states_;
+
+		/** @brief Indexes of the converted samples of the trajectory */
+		std::vector<unsigned int> samples_;
 };
 
 } //@namespace
@@ -0,0 +1,626 @@
+#include <dwl/SharedState.h>
+#include <dwl/utils/Macros.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace dwl
+{
+
+namespace shared_state
+{
+/** @brief Number of retries of a read while the record is written */
+static const unsigned int MaxReadRetries = 1000;
+
+/** @brief Rounds up a size to 8 bytes, so the record is aligned to doubles */
+inline uint64_t align(uint64_t size)
+{
+	return (size + 7) & ~((uint64_t) 7);
+}
+
+/** @brief Copies a vector in a record, where the missing values are set to zero */
+template<typename TVector>
+inline void copyVector(double* record,
+					   const Eigen::MatrixBase<TVector>& vector,
+					   unsigned int size)
+{
+	unsigned int num_values = std::min((unsigned int) vector.size(), size);
+	for (unsigned int i = 0; i < num_values; i++)
+		record[i] = vector(i);
+	std::fill(record + num_values, record + size, 0.);
+}
+
+/** @brief Copies the quantity of a contact in a record, and sets its flag if it's defined */
+template<typename TMap>
+inline void copyContact(double* record,
+						double& flags,
+						const TMap& body_map,
+						const std::string& name,
+						unsigned int size,
+						int quantity)
+{
+	typename TMap::const_iterator it = body_map.find(name);
+	if (it != body_map.end()) {
+		copyVector(record, it->second, size);
+		flags = (double) ((int) flags | quantity);
+	} else
+		std::fill(record, record + size, 0.);
+}
+
+/** @brief Reads the quantity of a contact from a record, or removes it if it's undefined */
+template<typename TMap>
+inline void readContact(TMap& body_map,
+						const double* record,
+						double flags,
+						const std::string& name,
+						int quantity)
+{
+	typedef typename TMap::mapped_type Vector;
+	if ((int) flags & quantity) {
+		Vector& value = body_map[name];
+		if (value.size() != 3)
+			value.resize(3);
+		value = Eigen::Map<const Eigen::Vector3d>(record);
+	} else
+		body_map.erase(name);
+}
+} //@namespace shared_state
+
+
+StateSchema::StateSchema() : num_joints_(0)
+{
+
+}
+
+
+StateSchema::StateSchema(unsigned int num_joints,
+						 const rbd::BodySelector& names)
+{
+	reset(num_joints, names);
+}
+
+
+StateSchema::~StateSchema()
+{
+
+}
+
+
+void StateSchema::reset(unsigned int num_joints,
+						const rbd::BodySelector& names)
+{
+	num_joints_ = num_joints;
+	names_ = names;
+}
+
+
+void StateSchema::reset(const model::FloatingBaseSystem& system)
+{
+	reset(system.getJointDoF(), system.getEndEffectorNames());
+}
+
+
+unsigned int StateSchema::getJointDoF() const
+{
+	return num_joints_;
+}
+
+
+const rbd::BodySelector& StateSchema::getNames() const
+{
+	return names_;
+}
+
+
+unsigned int StateSchema::getRecordSize(shared_state::StateKind kind) const
+{
+	unsigned int num_names = names_.size();
+	if (kind == shared_state::WholeBodyKind)
+		return 26 + 4 * num_joints_ + 16 * num_names;
+	else
+		return 22 + 13 * num_names;
+}
+
+
+void StateSchema::toRecord(double* record,
+						   const WholeBodyState& state) const
+{
+	// Writing the base and joint quantities
+	unsigned int n = num_joints_;
+	record[0] = state.time;
+	record[1] = state.duration;
+	Eigen::Map<rbd::Vector6d>(record + 2) = state.base_pos;
+	Eigen::Map<rbd::Vector6d>(record + 8) = state.base_vel;
+	Eigen::Map<rbd::Vector6d>(record + 14) = state.base_acc;
+	Eigen::Map<rbd::Vector6d>(record + 20) = state.base_eff;
+	shared_state::copyVector(record + 26, state.joint_pos, n);
+	shared_state::copyVector(record + 26 + n, state.joint_vel, n);
+	shared_state::copyVector(record + 26 + 2 * n, state.joint_acc, n);
+	shared_state::copyVector(record + 26 + 3 * n, state.joint_eff, n);
+
+	// Writing the contact quantities and their flags
+	unsigned int c = names_.size();
+	double* pos = record + 26 + 4 * n;
+	double* vel = pos + 3 * c;
+	double* acc = vel + 3 * c;
+	double* eff = acc + 3 * c;
+	double* flags = eff + 6 * c;
+	for (unsigned int i = 0; i < c; i++) {
+		const std::string& name = names_[i];
+		flags[i] = 0.;
+		shared_state::copyContact(pos + 3 * i, flags[i], state.contact_pos, name, 3,
+								  WholeBodyTrajectoryContainer::POSITION);
+		shared_state::copyContact(vel + 3 * i, flags[i], state.contact_vel, name, 3,
+								  WholeBodyTrajectoryContainer::VELOCITY);
+		shared_state::copyContact(acc + 3 * i, flags[i], state.contact_acc, name, 3,
+								  WholeBodyTrajectoryContainer::ACCELERATION);
+
+		rbd::BodyVector6d::const_iterator eff_it = state.contact_eff.find(name);
+		if (eff_it != state.contact_eff.end()) {
+			Eigen::Map<rbd::Vector6d>(eff + 6 * i) = eff_it->second;
+			flags[i] = (double) ((int) flags[i] | WholeBodyTrajectoryContainer::EFFORT);
+		} else
+			Eigen::Map<rbd::Vector6d>(eff + 6 * i).setZero();
+	}
+}
+
+
+void StateSchema::toRecord(double* record,
+						   const ReducedBodyState& state) const
+{
+	// Writing the CoM quantities
+	record[0] = state.time;
+	Eigen::Map<Eigen::Vector3d>(record + 1) = state.com_pos;
+	Eigen::Map<Eigen::Vector3d>(record + 4) = state.angular_pos;
+	Eigen::Map<Eigen::Vector3d>(record + 7) = state.com_vel;
+	Eigen::Map<Eigen::Vector3d>(record + 10) = state.angular_vel;
+	Eigen::Map<Eigen::Vector3d>(record + 13) = state.com_acc;
+	Eigen::Map<Eigen::Vector3d>(record + 16) = state.angular_acc;
+	Eigen::Map<Eigen::Vector3d>(record + 19) = state.cop;
+
+	// Writing the foot quantities and their flags
+	unsigned int c = names_.size();
+	double* support = record + 22;
+	double* pos = support + 3 * c;
+	double* vel = pos + 3 * c;
+	double* acc = vel + 3 * c;
+	double* flags = acc + 3 * c;
+	for (unsigned int i = 0; i < c; i++) {
+		const std::string& name = names_[i];
+		flags[i] = 0.;
+		shared_state::copyContact(support + 3 * i, flags[i], state.support_region, name, 3,
+								  ReducedBodyTrajectoryContainer::SUPPORT);
+		shared_state::copyContact(pos + 3 * i, flags[i], state.foot_pos, name, 3,
+								  ReducedBodyTrajectoryContainer::POSITION);
+		shared_state::copyContact(vel + 3 * i, flags[i], state.foot_vel, name, 3,
+								  ReducedBodyTrajectoryContainer::VELOCITY);
+		shared_state::copyContact(acc + 3 * i, flags[i], state.foot_acc, name, 3,
+								  ReducedBodyTrajectoryContainer::ACCELERATION);
+	}
+}
+
+
+void StateSchema::fromRecord(WholeBodyState& state,
+							 const double* record) const
+{
+	// Reading the base and joint quantities. Note that the joint vectors are resized only
+	// if the number of joints changed
+	unsigned int n = num_joints_;
+	if (state.getJointDoF() != n || state.joint_pos.size() != n)
+		state.setJointDoF(n);
+	state.time = record[0];
+	state.duration = record[1];
+	state.base_pos = Eigen::Map<const rbd::Vector6d>(record + 2);
+	state.base_vel = Eigen::Map<const rbd::Vector6d>(record + 8);
+	state.base_acc = Eigen::Map<const rbd::Vector6d>(record + 14);
+	state.base_eff = Eigen::Map<const rbd::Vector6d>(record + 20);
+	state.joint_pos = Eigen::Map<const Eigen::VectorXd>(record + 26, n);
+	state.joint_vel = Eigen::Map<const Eigen::VectorXd>(record + 26 + n, n);
+	state.joint_acc = Eigen::Map<const Eigen::VectorXd>(record + 26 + 2 * n, n);
+	state.joint_eff = Eigen::Map<const Eigen::VectorXd>(record + 26 + 3 * n, n);
+
+	// Reading the defined contact quantities
+	unsigned int c = names_.size();
+	const double* pos = record + 26 + 4 * n;
+	const double* vel = pos + 3 * c;
+	const double* acc = vel + 3 * c;
+	const double* eff = acc + 3 * c;
+	const double* flags = eff + 6 * c;
+	for (unsigned int i = 0; i < c; i++) {
+		const std::string& name = names_[i];
+		shared_state::readContact(state.contact_pos, pos + 3 * i, flags[i], name,
+								  WholeBodyTrajectoryContainer::POSITION);
+		shared_state::readContact(state.contact_vel, vel + 3 * i, flags[i], name,
+								  WholeBodyTrajectoryContainer::VELOCITY);
+		shared_state::readContact(state.contact_acc, acc + 3 * i, flags[i], name,
+								  WholeBodyTrajectoryContainer::ACCELERATION);
+		if ((int) flags[i] & WholeBodyTrajectoryContainer::EFFORT)
+			state.contact_eff[name] = Eigen::Map<const rbd::Vector6d>(eff + 6 * i);
+		else
+			state.contact_eff.erase(name);
+	}
+}
+
+
+void StateSchema::fromRecord(ReducedBodyState& state,
+							 const double* record) const
+{
+	// Reading the CoM quantities
+	state.time = record[0];
+	state.com_pos = Eigen::Map<const Eigen::Vector3d>(record + 1);
+	state.angular_pos = Eigen::Map<const Eigen::Vector3d>(record + 4);
+	state.com_vel = Eigen::Map<const Eigen::Vector3d>(record + 7);
+	state.angular_vel = Eigen::Map<const Eigen::Vector3d>(record + 10);
+	state.com_acc = Eigen::Map<const Eigen::Vector3d>(record + 13);
+	state.angular_acc = Eigen::Map<const Eigen::Vector3d>(record + 16);
+	state.cop = Eigen::Map<const Eigen::Vector3d>(record + 19);
+
+	// Reading the defined foot quantities
+	unsigned int c = names_.size();
+	const double* support = record + 22;
+	const double* pos = support + 3 * c;
+	const double* vel = pos + 3 * c;
+	const double* acc = vel + 3 * c;
+	const double* flags = acc + 3 * c;
+	for (unsigned int i = 0; i < c; i++) {
+		const std::string& name = names_[i];
+		shared_state::readContact(state.support_region, support + 3 * i, flags[i], name,
+								  ReducedBodyTrajectoryContainer::SUPPORT);
+		shared_state::readContact(state.foot_pos, pos + 3 * i, flags[i], name,
+								  ReducedBodyTrajectoryContainer::POSITION);
+		shared_state::readContact(state.foot_vel, vel + 3 * i, flags[i], name,
+								  ReducedBodyTrajectoryContainer::VELOCITY);
+		shared_state::readContact(state.foot_acc, acc + 3 * i, flags[i], name,
+								  ReducedBodyTrajectoryContainer::ACCELERATION);
+	}
+}
+
+
+
+SharedStatePublisher::SharedStatePublisher() : data_(NULL), size_(0), header_(NULL),
+		record_(NULL)
+{
+
+}
+
+
+SharedStatePublisher::~SharedStatePublisher()
+{
+	close();
+}
+
+
+bool SharedStatePublisher::create(const std::string& name,
+								  const StateSchema& schema,
+								  shared_state::StateKind kind)
+{
+	close();
+
+	if (!std::atomic<uint64_t>().is_lock_free()) {
+		printf(RED "FATAL: the sequence number isn't lock-free, so it cannot be shared between"
+				" processes\n" COLOR_RESET);
+		return false;
+	}
+
+	// Computing the layout of the segment
+	const rbd::BodySelector& names = schema.getNames();
+	uint64_t names_offset = shared_state::align(sizeof(shared_state::SegmentHeader));
+	uint64_t names_size = 0;
+	for (unsigned int i = 0; i < names.size(); i++)
+		names_size += sizeof(uint32_t) + names[i].size();
+	uint64_t record_offset = shared_state::align(names_offset + names_size);
+	uint64_t record_size = schema.getRecordSize(kind);
+	size_t size = record_offset + record_size * sizeof(double);
+
+	// Creating and mapping the segment
+	shm_unlink(name.c_str());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) {
+		printf(RED "FATAL: the %s shared-memory segment cannot be created\n" COLOR_RESET,
+				name.c_str());
+		return false;
+	}
+	if (ftruncate(fd, size) != 0) {
+		printf(RED "FATAL: the %s shared-memory segment cannot be sized\n" COLOR_RESET,
+				name.c_str());
+		::close(fd);
+		shm_unlink(name.c_str());
+		return false;
+	}
+	void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		printf(RED "FATAL: the %s shared-memory segment cannot be mapped\n" COLOR_RESET,
+				name.c_str());
+		shm_unlink(name.c_str());
+		return false;
+	}
+	data_ = (unsigned char*) data;
+	size_ = size;
+	name_ = name;
+	schema_ = schema;
+
+	// Writing the names and the header. Note that the magic number is written at the end,
+	// so the subscribers don't open an incomplete segment
+	unsigned char* names_data = data_ + names_offset;
+	for (unsigned int i = 0; i < names.size(); i++) {
+		uint32_t length = names[i].size();
+		memcpy(names_data, &length, sizeof(uint32_t));
+		memcpy(names_data + sizeof(uint32_t), names[i].data(), length);
+		names_data += sizeof(uint32_t) + length;
+	}
+	header_ = new (data_) shared_state::SegmentHeader();
+	header_->version = shared_state::Version;
+	header_->kind = kind;
+	header_->num_joints = schema.getJointDoF();
+	header_->num_names = names.size();
+	header_->names_offset = names_offset;
+	header_->record_offset = record_offset;
+	header_->record_size = record_size;
+	header_->sequence.store(0, std::memory_order_relaxed);
+	record_ = (double*) (data_ + record_offset);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(header_->magic, shared_state::Magic, sizeof(shared_state::Magic));
+
+	return true;
+}
+
+
+bool SharedStatePublisher::publish(const WholeBodyState& state)
+{
+	if (!isPublishable(shared_state::WholeBodyKind))
+		return false;
+
+	beginWrite();
+	schema_.toRecord(record_, state);
+	endWrite();
+	return true;
+}
+
+
+bool SharedStatePublisher::publish(const ReducedBodyState& state)
+{
+	if (!isPublishable(shared_state::ReducedBodyKind))
+		return false;
+
+	beginWrite();
+	schema_.toRecord(record_, state);
+	endWrite();
+	return true;
+}
+
+
+void SharedStatePublisher::close()
+{
+	if (data_ != NULL) {
+		munmap(data_, size_);
+		shm_unlink(name_.c_str());
+	}
+
+	data_ = NULL;
+	size_ = 0;
+	header_ = NULL;
+	record_ = NULL;
+}
+
+
+bool SharedStatePublisher::isOpen() const
+{
+	return data_ != NULL;
+}
+
+
+uint64_t SharedStatePublisher::getNumberOfPublications() const
+{
+	if (header_ == NULL)
+		return 0;
+
+	return header_->sequence.load(std::memory_order_relaxed) / 2;
+}
+
+
+bool SharedStatePublisher::isPublishable(shared_state::StateKind kind) const
+{
+	if (header_ == NULL) {
+		printf(YELLOW "Warning: the shared-memory segment wasn't created\n" COLOR_RESET);
+		return false;
+	}
+	if (header_->kind != (uint32_t) kind) {
+		printf(YELLOW "Warning: the kind of state isn't the one of the shared-memory segment\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	return true;
+}
+
+
+void SharedStatePublisher::beginWrite()
+{
+	// Marking the record as under writing, i.e. an odd sequence number. The fence orders the
+	// writes of the record after it
+	uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+	header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+
+void SharedStatePublisher::endWrite()
+{
+	uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+	header_->sequence.store(sequence + 1, std::memory_order_release);
+}
+
+
+
+SharedStateSubscriber::SharedStateSubscriber() : data_(NULL), size_(0), header_(NULL),
+		record_(NULL), last_sequence_(0)
+{
+
+}
+
+
+SharedStateSubscriber::~SharedStateSubscriber()
+{
+	close();
+}
+
+
+bool SharedStateSubscriber::open(const std::string& name)
+{
+	close();
+
+	// Mapping the segment
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		printf(RED "FATAL: the %s shared-memory segment cannot be opened\n" COLOR_RESET,
+				name.c_str());
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(shared_state::SegmentHeader)) {
+		printf(RED "FATAL: the %s shared-memory segment isn't valid\n" COLOR_RESET,
+				name.c_str());
+		::close(fd);
+		return false;
+	}
+	void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		printf(RED "FATAL: the %s shared-memory segment cannot be mapped\n" COLOR_RESET,
+				name.c_str());
+		return false;
+	}
+	data_ = (const unsigned char*) data;
+	size_ = st.st_size;
+	header_ = (const shared_state::SegmentHeader*) data_;
+
+	// Checking the header and the layout
+	if (memcmp(header_->magic, shared_state::Magic, sizeof(shared_state::Magic)) != 0 ||
+			header_->version != shared_state::Version) {
+		printf(RED "FATAL: the %s shared-memory segment isn't a dwl state, or it has a"
+				" different version\n" COLOR_RESET, name.c_str());
+		close();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (header_->record_offset + header_->record_size * sizeof(double) > size_) {
+		printf(RED "FATAL: the %s shared-memory segment is truncated\n" COLOR_RESET,
+				name.c_str());
+		close();
+		return false;
+	}
+
+	// Reading the names of the schema
+	rbd::BodySelector names;
+	const unsigned char* names_data = data_ + header_->names_offset;
+	for (unsigned int i = 0; i < header_->num_names; i++) {
+		uint32_t length;
+		memcpy(&length, names_data, sizeof(uint32_t));
+		names.push_back(std::string((const char*) names_data + sizeof(uint32_t), length));
+		names_data += sizeof(uint32_t) + length;
+	}
+	schema_.reset(header_->num_joints, names);
+	record_ = (const double*) (data_ + header_->record_offset);
+	buffer_.assign(header_->record_size, 0.);
+	last_sequence_ = 0;
+
+	return true;
+}
+
+
+bool SharedStateSubscriber::read(WholeBodyState& state)
+{
+	if (!copyRecord(shared_state::WholeBodyKind))
+		return false;
+
+	schema_.fromRecord(state, buffer_.data());
+	return true;
+}
+
+
+bool SharedStateSubscriber::read(ReducedBodyState& state)
+{
+	if (!copyRecord(shared_state::ReducedBodyKind))
+		return false;
+
+	schema_.fromRecord(state, buffer_.data());
+	return true;
+}
+
+
+bool SharedStateSubscriber::hasNewState() const
+{
+	if (header_ == NULL)
+		return false;
+
+	uint64_t sequence = header_->sequence.load(std::memory_order_acquire);
+	return sequence > 0 && (sequence & ~((uint64_t) 1)) != last_sequence_;
+}
+
+
+void SharedStateSubscriber::close()
+{
+	if (data_ != NULL)
+		munmap((void*) data_, size_);
+
+	data_ = NULL;
+	size_ = 0;
+	header_ = NULL;
+	record_ = NULL;
+}
+
+
+bool SharedStateSubscriber::isOpen() const
+{
+	return data_ != NULL;
+}
+
+
+const StateSchema& SharedStateSubscriber::getSchema() const
+{
+	return schema_;
+}
+
+
+shared_state::StateKind SharedStateSubscriber::getKind() const
+{
+	if (header_ == NULL)
+		return shared_state::WholeBodyKind;
+
+	return (shared_state::StateKind) header_->kind;
+}
+
+
+bool SharedStateSubscriber::copyRecord(shared_state::StateKind kind)
+{
+	if (header_ == NULL || header_->kind != (uint32_t) kind)
+		return false;
+
+	// Copying the record with the seqlock, i.e. it's retried if the publisher wrote it
+	// during the copy
+	for (unsigned int k = 0; k < shared_state::MaxReadRetries; k++) {
+		uint64_t start = header_->sequence.load(std::memory_order_acquire);
+		if (start == 0)
+			return false; // nothing was published
+		if (start & 1)
+			continue;
+
+		memcpy(buffer_.data(), record_, buffer_.size() * sizeof(double));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (header_->sequence.load(std::memory_order_relaxed) == start) {
+			last_sequence_ = start;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+} //@namespace dwl
@@ -0,0 +1,307 @@
+#ifndef DWL__SHARED_STATE__H
+#define DWL__SHARED_STATE__H
+
+#include <dwl/TrajectoryContainer.h>
+#include <dwl/model/FloatingBaseSystem.h>
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+namespace dwl
+{
+
+/**
+ * @brief Layout of the shared-memory segments (version 1). A segment starts with a header,
+ * which defines the kind of state, its number of joints and contacts (or feet) and the
+ * sequence number of the publications, followed by the names of the contacts (a list of
+ * length-prefixed strings padded to 8 bytes) and a flat record of doubles. The record is the
+ * concatenation of the quantities of the state (see StateSchema), where the contact quantities
+ * are stacked in the order of the names, and every contact has a value with its defined
+ * quantities (see WholeBodyTrajectoryContainer::ContactQuantity and
+ * ReducedBodyTrajectoryContainer::FootQuantity). The record is published with a seqlock, i.e.
+ * the sequence number is odd while it's written, so the readers retry if it changed during
+ * their copy and they never block the writer
+ */
+namespace shared_state
+{
+/** @brief Magic number of the segments, i.e. "DWLSHMS" */
+static const char Magic[8] = {'D', 'W', 'L', 'S', 'H', 'M', 'S', '\0'};
+
+/** @brief Version of the format */
+static const uint32_t Version = 1;
+
+/** @brief Kinds of states */
+enum StateKind {WholeBodyKind = 1, ReducedBodyKind = 2};
+
+/** @brief Header of the segments */
+struct SegmentHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t kind;
+	uint32_t num_joints;
+	uint32_t num_names;
+	uint64_t names_offset;
+	uint64_t record_offset;
+	uint64_t record_size;
+
+	/** @brief Sequence number of the publications, which is in its own cache line */
+	alignas(64) std::atomic<uint64_t> sequence;
+};
+} //@namespace shared_state
+
+
+/**
+ * @brief The StateSchema class
+ * This class defines the flat record of a whole-body or reduced-body state, i.e. the number of
+ * joints and the names of the contacts (or feet). The whole-body record is [time, duration,
+ * base_pos, base_vel, base_acc, base_eff, joint_pos, joint_vel, joint_acc, joint_eff,
+ * contact_pos, contact_vel, contact_acc, contact_eff, contact_flags], and the reduced-body one
+ * is [time, com_pos, angular_pos, com_vel, angular_vel, com_acc, angular_acc, cop,
+ * support_region, foot_pos, foot_vel, foot_acc, foot_flags]. Note that the conversions don't
+ * allocate memory once the contacts of the state are defined
+ */
+class StateSchema
+{
+	public:
+		/** @brief Constructor function */
+		StateSchema();
+
+		/**
+		 * @brief Constructor function
+		 * @param unsigned int Number of joints
+		 * @param const rbd::BodySelector& Names of the contacts (or feet)
+		 */
+		StateSchema(unsigned int num_joints,
+					const rbd::BodySelector& names);
+
+		/** @brief Destructor function */
+		~StateSchema();
+
+		/**
+		 * @brief Resets the schema
+		 * @param unsigned int Number of joints
+		 * @param const rbd::BodySelector& Names of the contacts (or feet)
+		 */
+		void reset(unsigned int num_joints,
+				   const rbd::BodySelector& names);
+
+		/**
+		 * @brief Resets the schema from a floating-base system, i.e. its joints and
+		 * end-effectors
+		 * @param const model::FloatingBaseSystem& Floating-base system
+		 */
+		void reset(const model::FloatingBaseSystem& system);
+
+		/** @brief Gets the number of joints */
+		unsigned int getJointDoF() const;
+
+		/** @brief Gets the names of the contacts (or feet) */
+		const rbd::BodySelector& getNames() const;
+
+		/**
+		 * @brief Gets the size of the record, in doubles
+		 * @param shared_state::StateKind Kind of state
+		 */
+		unsigned int getRecordSize(shared_state::StateKind kind) const;
+
+		/**
+		 * @brief Writes a whole-body state in a record, where the contacts that aren't in
+		 * the schema are ignored
+		 * @param double* Record
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void toRecord(double* record,
+					  const WholeBodyState& state) const;
+
+		/**
+		 * @brief Writes a reduced-body state in a record
+		 * @param double* Record
+		 * @param const ReducedBodyState& Reduced-body state
+		 */
+		void toRecord(double* record,
+					  const ReducedBodyState& state) const;
+
+		/**
+		 * @brief Reads a whole-body state from a record, where the undefined contact
+		 * quantities are removed from the state
+		 * @param WholeBodyState& Whole-body state
+		 * @param const double* Record
+		 */
+		void fromRecord(WholeBodyState& state,
+						const double* record) const;
+
+		/**
+		 * @brief Reads a reduced-body state from a record
+		 * @param ReducedBodyState& Reduced-body state
+		 * @param const double* Record
+		 */
+		void fromRecord(ReducedBodyState& state,
+						const double* record) const;
+
+
+	private:
+		/** @brief Number of joints */
+		unsigned int num_joints_;
+
+		/** @brief Names of the contacts (or feet) */
+		rbd::BodySelector names_;
+};
+
+
+/**
+ * @brief The SharedStatePublisher class
+ * This class creates a shared-memory segment (POSIX) and publishes the states of a schema in
+ * it. A publication writes the state directly in the segment, so it doesn't serialize nor
+ * allocate memory. It has to be called from a single thread (e.g. the control thread)
+ */
+class SharedStatePublisher
+{
+	public:
+		/** @brief Constructor function */
+		SharedStatePublisher();
+
+		/** @brief Destructor function, which closes the segment */
+		~SharedStatePublisher();
+
+		/**
+		 * @brief Creates the shared-memory segment, which replaces an existing one
+		 * @param const std::string& Name of the segment (e.g. "/dwl_state")
+		 * @param const StateSchema& Schema of the states
+		 * @param shared_state::StateKind Kind of state
+		 * @return True if the segment was created
+		 */
+		bool create(const std::string& name,
+					const StateSchema& schema,
+					shared_state::StateKind kind);
+
+		/**
+		 * @brief Publishes a whole-body state
+		 * @param const WholeBodyState& Whole-body state
+		 * @return False if the segment isn't a whole-body one
+		 */
+		bool publish(const WholeBodyState& state);
+
+		/**
+		 * @brief Publishes a reduced-body state
+		 * @param const ReducedBodyState& Reduced-body state
+		 * @return False if the segment isn't a reduced-body one
+		 */
+		bool publish(const ReducedBodyState& state);
+
+		/** @brief Unmaps and removes the segment */
+		void close();
+
+		/** @brief Indicates if the segment is created */
+		bool isOpen() const;
+
+		/** @brief Gets the number of publications */
+		uint64_t getNumberOfPublications() const;
+
+
+	private:
+		/**
+		 * @brief Checks the kind of the segment before a publication
+		 * @param shared_state::StateKind Kind of the state
+		 */
+		bool isPublishable(shared_state::StateKind kind) const;
+
+		/** @brief Starts and finishes the writing of the record, i.e. the seqlock */
+		void beginWrite();
+		void endWrite();
+
+		/** @brief Schema of the states */
+		StateSchema schema_;
+
+		/** @brief Mapped segment, its header and record */
+		unsigned char* data_;
+		size_t size_;
+		shared_state::SegmentHeader* header_;
+		double* record_;
+
+		/** @brief Name of the segment */
+		std::string name_;
+};
+
+
+/**
+ * @brief The SharedStateSubscriber class
+ * This class maps a shared-memory segment of a SharedStatePublisher, and reads its schema and
+ * states. The record is copied with the seqlock in a preallocated buffer, so reading a state
+ * doesn't lock the publisher nor allocate memory
+ */
+class SharedStateSubscriber
+{
+	public:
+		/** @brief Constructor function */
+		SharedStateSubscriber();
+
+		/** @brief Destructor function, which unmaps the segment */
+		~SharedStateSubscriber();
+
+		/**
+		 * @brief Maps the shared-memory segment, and reads its schema
+		 * @param const std::string& Name of the segment
+		 * @return True if it's a valid segment
+		 */
+		bool open(const std::string& name);
+
+		/**
+		 * @brief Reads the last whole-body state
+		 * @param WholeBodyState& Whole-body state
+		 * @return False if there isn't a consistent whole-body state
+		 */
+		bool read(WholeBodyState& state);
+
+		/**
+		 * @brief Reads the last reduced-body state
+		 * @param ReducedBodyState& Reduced-body state
+		 * @return False if there isn't a consistent reduced-body state
+		 */
+		bool read(ReducedBodyState& state);
+
+		/** @brief Indicates if there is a publication that wasn't read */
+		bool hasNewState() const;
+
+		/** @brief Unmaps the segment */
+		void close();
+
+		/** @brief Indicates if the segment is mapped */
+		bool isOpen() const;
+
+		/** @brief Gets the schema of the states */
+		const StateSchema& getSchema() const;
+
+		/** @brief Gets the kind of the states */
+		shared_state::StateKind getKind() const;
+
+
+	private:
+		/**
+		 * @brief Copies the record in the buffer with the seqlock
+		 * @param shared_state::StateKind Expected kind of state
+		 * @return False if there isn't a consistent record
+		 */
+		bool copyRecord(shared_state::StateKind kind);
+
+		/** @brief Schema of the states */
+		StateSchema schema_;
+
+		/** @brief Mapped segment, its header and record */
+		const unsigned char* data_;
+		size_t size_;
+		const shared_state::SegmentHeader* header_;
+		const double* record_;
+
+		/** @brief Copy of the last consistent record */
+		std::vector<double> buffer_;
+
+		/** @brief Sequence number of the last read */
+		uint64_t last_sequence_;
+};
+
+} //@namespace dwl
+
+#endif
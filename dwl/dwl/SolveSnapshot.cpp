@@ -0,0 +1,565 @@
+#include <dwl/SolveSnapshot.h>
+#include <dwl/simulation/PreviewLocomotion.h>
+#include <dwl/utils/Macros.h>
+#include <cstring>
+
+
+namespace dwl
+{
+
+SnapshotEncoder::SnapshotEncoder()
+{
+
+}
+
+
+SnapshotEncoder::~SnapshotEncoder()
+{
+
+}
+
+
+void SnapshotEncoder::clear()
+{
+	data_.clear();
+}
+
+
+void SnapshotEncoder::writeDouble(double value)
+{
+	append(&value, sizeof(value));
+}
+
+
+void SnapshotEncoder::writeUnsigned(unsigned int value)
+{
+	uint32_t encoded = value;
+	append(&encoded, sizeof(encoded));
+}
+
+
+void SnapshotEncoder::writeBool(bool value)
+{
+	writeUnsigned(value ? 1 : 0);
+}
+
+
+void SnapshotEncoder::writeString(const std::string& value)
+{
+	writeUnsigned(value.size());
+	append(value.data(), value.size());
+}
+
+
+void SnapshotEncoder::writePose(const Pose& pose)
+{
+	writeVector(pose.position);
+	writeVector(pose.orientation.coeffs());
+}
+
+
+void SnapshotEncoder::writeState(const WholeBodyState& state)
+{
+	writeDouble(state.time);
+	writeDouble(state.duration);
+	writeUnsigned(state.getJointDoF());
+	writeVector(state.base_pos);
+	writeVector(state.base_vel);
+	writeVector(state.base_acc);
+	writeVector(state.base_eff);
+	writeVector(state.joint_pos);
+	writeVector(state.joint_vel);
+	writeVector(state.joint_acc);
+	writeVector(state.joint_eff);
+	writeVectorMap(state.contact_pos);
+	writeVectorMap(state.contact_vel);
+	writeVectorMap(state.contact_acc);
+	writeVectorMap(state.contact_eff);
+}
+
+
+void SnapshotEncoder::writeState(const ReducedBodyState& state)
+{
+	writeDouble(state.time);
+	writeVector(state.com_pos);
+	writeVector(state.angular_pos);
+	writeVector(state.com_vel);
+	writeVector(state.angular_vel);
+	writeVector(state.com_acc);
+	writeVector(state.angular_acc);
+	writeVector(state.cop);
+	writeVectorMap(state.support_region);
+	writeVectorMap(state.foot_pos);
+	writeVectorMap(state.foot_vel);
+	writeVectorMap(state.foot_acc);
+}
+
+
+void SnapshotEncoder::writePreviewControl(const simulation::PreviewControl& control)
+{
+	writeUnsigned(control.params.size());
+	for (unsigned int p = 0; p < control.params.size(); p++) {
+		const simulation::PreviewParams& params = control.params[p];
+		writeUnsigned(params.id);
+		writeDouble(params.duration);
+		writeVector(params.cop_shift);
+
+		// The phase is written with its swing feet and their shifts
+		const simulation::PreviewPhase& phase = params.phase;
+		writeUnsigned(phase.type);
+		writeUnsigned(phase.feet.size());
+		for (unsigned int f = 0; f < phase.feet.size(); f++)
+			writeString(phase.feet[f]);
+		writeUnsigned(phase.swing_feet.size());
+		for (std::map<std::string,bool>::const_iterator it = phase.swing_feet.begin();
+				it != phase.swing_feet.end(); ++it) {
+			writeString(it->first);
+			writeBool(it->second);
+		}
+		writeVectorMap(phase.feet_shift);
+		writeBool(phase.step_);
+	}
+}
+
+
+void SnapshotEncoder::writeVelocityCommand(const simulation::VelocityCommand& command)
+{
+	writeVector(command.linear);
+	writeDouble(command.angular);
+}
+
+
+const std::vector<unsigned char>& SnapshotEncoder::getData() const
+{
+	return data_;
+}
+
+
+void SnapshotEncoder::append(const void* data,
+							 std::size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*) data;
+	data_.insert(data_.end(), bytes, bytes + size);
+}
+
+
+
+SnapshotDecoder::SnapshotDecoder(const unsigned char* data,
+								 std::size_t size) : data_(data), size_(size), offset_(0),
+										 valid_(true)
+{
+
+}
+
+
+SnapshotDecoder::~SnapshotDecoder()
+{
+
+}
+
+
+bool SnapshotDecoder::readDouble(double& value)
+{
+	return read(&value, sizeof(value));
+}
+
+
+bool SnapshotDecoder::readUnsigned(unsigned int& value)
+{
+	uint32_t encoded = 0;
+	if (!read(&encoded, sizeof(encoded)))
+		return false;
+
+	value = encoded;
+	return true;
+}
+
+
+bool SnapshotDecoder::readBool(bool& value)
+{
+	unsigned int encoded = 0;
+	if (!readUnsigned(encoded))
+		return false;
+
+	value = encoded != 0;
+	return true;
+}
+
+
+bool SnapshotDecoder::readString(std::string& value)
+{
+	unsigned int size = 0;
+	if (!readUnsigned(size))
+		return false;
+
+	if (size > getRemainingBytes()) {
+		valid_ = false;
+		return false;
+	}
+	value.assign((const char*) data_ + offset_, size);
+	offset_ += size;
+
+	return true;
+}
+
+
+bool SnapshotDecoder::readPose(Pose& pose)
+{
+	Eigen::Vector4d coeffs;
+	if (!readVector(pose.position) || !readVector(coeffs))
+		return false;
+
+	pose.orientation.coeffs() = coeffs;
+	return true;
+}
+
+
+bool SnapshotDecoder::readState(WholeBodyState& state)
+{
+	unsigned int num_joints = 0;
+	readDouble(state.time);
+	readDouble(state.duration);
+	if (!readUnsigned(num_joints))
+		return false;
+
+	state.setJointDoF(num_joints);
+	readVector(state.base_pos);
+	readVector(state.base_vel);
+	readVector(state.base_acc);
+	readVector(state.base_eff);
+	readVector(state.joint_pos);
+	readVector(state.joint_vel);
+	readVector(state.joint_acc);
+	readVector(state.joint_eff);
+	readVectorMap(state.contact_pos);
+	readVectorMap(state.contact_vel);
+	readVectorMap(state.contact_acc);
+	readVectorMap(state.contact_eff);
+
+	return valid_;
+}
+
+
+bool SnapshotDecoder::readState(ReducedBodyState& state)
+{
+	readDouble(state.time);
+	readVector(state.com_pos);
+	readVector(state.angular_pos);
+	readVector(state.com_vel);
+	readVector(state.angular_vel);
+	readVector(state.com_acc);
+	readVector(state.angular_acc);
+	readVector(state.cop);
+	readVectorMap(state.support_region);
+	readVectorMap(state.foot_pos);
+	readVectorMap(state.foot_vel);
+	readVectorMap(state.foot_acc);
+
+	return valid_;
+}
+
+
+bool SnapshotDecoder::readPreviewControl(simulation::PreviewControl& control)
+{
+	unsigned int num_phases = 0;
+	if (!readUnsigned(num_phases))
+		return false;
+
+	// Every phase has at least its identifier, duration, CoP shift and type
+	if (num_phases > getRemainingBytes()) {
+		valid_ = false;
+		return false;
+	}
+	control.params.assign(num_phases, simulation::PreviewParams());
+	for (unsigned int p = 0; p < num_phases && valid_; p++) {
+		simulation::PreviewParams& params = control.params[p];
+		readUnsigned(params.id);
+		readDouble(params.duration);
+		readVector(params.cop_shift);
+
+		simulation::PreviewPhase& phase = params.phase;
+		unsigned int type = 0, num_feet = 0, num_swings = 0;
+		readUnsigned(type);
+		phase.type = type == simulation::FLIGHT ? simulation::FLIGHT : simulation::STANCE;
+		if (!readUnsigned(num_feet) || num_feet > getRemainingBytes()) {
+			valid_ = false;
+			break;
+		}
+		phase.feet.resize(num_feet);
+		for (unsigned int f = 0; f < num_feet; f++)
+			readString(phase.feet[f]);
+		if (!readUnsigned(num_swings) || num_swings > getRemainingBytes()) {
+			valid_ = false;
+			break;
+		}
+		std::string name;
+		for (unsigned int f = 0; f < num_swings && valid_; f++) {
+			bool swing = false;
+			readString(name);
+			readBool(swing);
+			phase.swing_feet[name] = swing;
+		}
+		readVectorMap(phase.feet_shift);
+		readBool(phase.step_);
+	}
+
+	return valid_;
+}
+
+
+bool SnapshotDecoder::readVelocityCommand(simulation::VelocityCommand& command)
+{
+	readVector(command.linear);
+	readDouble(command.angular);
+
+	return valid_;
+}
+
+
+bool SnapshotDecoder::isValid() const
+{
+	return valid_;
+}
+
+
+std::size_t SnapshotDecoder::getRemainingBytes() const
+{
+	return size_ - offset_;
+}
+
+
+bool SnapshotDecoder::read(void* data,
+						   std::size_t size)
+{
+	if (!valid_ || size > getRemainingBytes()) {
+		valid_ = false;
+		return false;
+	}
+
+	memcpy(data, data_ + offset_, size);
+	offset_ += size;
+	return true;
+}
+
+
+
+SnapshotRecorder::SnapshotRecorder() : file_(NULL), num_records_(0), max_records_(0),
+		session_(0)
+{
+
+}
+
+
+SnapshotRecorder::~SnapshotRecorder()
+{
+	close();
+}
+
+
+bool SnapshotRecorder::open(const std::string& filename)
+{
+	close();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	file_ = fopen(filename.c_str(), "wb");
+	if (file_ == NULL) {
+		printf(RED "FATAL: the %s snapshot file could not be opened\n" COLOR_RESET,
+				filename.c_str());
+		return false;
+	}
+
+	solve_snapshot::FileHeader header;
+	memcpy(header.magic, solve_snapshot::Magic, sizeof(header.magic));
+	header.version = solve_snapshot::Version;
+	header.reserved = 0;
+	if (fwrite(&header, sizeof(header), 1, file_) != 1 || fflush(file_) != 0) {
+		printf(RED "FATAL: the %s snapshot file could not be written\n" COLOR_RESET,
+				filename.c_str());
+		fclose(file_);
+		file_ = NULL;
+		return false;
+	}
+
+	opening_time_ = std::chrono::steady_clock::now();
+	num_records_ = 0;
+	session_++;
+	return true;
+}
+
+
+void SnapshotRecorder::close()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_ != NULL)
+		fclose(file_);
+	file_ = NULL;
+}
+
+
+void SnapshotRecorder::setMaxRecords(unsigned int max_records)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	max_records_ = max_records;
+}
+
+
+bool SnapshotRecorder::record(solve_snapshot::SnapshotKind kind,
+							  const SnapshotEncoder& encoder)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_ == NULL || (max_records_ != 0 && num_records_ >= max_records_))
+		return false;
+
+	const std::vector<unsigned char>& payload = encoder.getData();
+	solve_snapshot::RecordHeader header;
+	header.kind = kind;
+	header.sequence = num_records_;
+	header.payload_size = payload.size();
+	header.wall_time = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - opening_time_).count();
+
+	// Flushing every record, so the written records survive a crash
+	bool written = fwrite(&header, sizeof(header), 1, file_) == 1;
+	written &= fwrite(payload.data(), 1, payload.size(), file_) == payload.size();
+	written &= fflush(file_) == 0;
+	if (!written) {
+		printf(YELLOW "Warning: the snapshot record could not be written, so the recording"
+				" stops\n" COLOR_RESET);
+		fclose(file_);
+		file_ = NULL;
+		return false;
+	}
+
+	num_records_++;
+	return true;
+}
+
+
+bool SnapshotRecorder::isRecording() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return file_ != NULL && (max_records_ == 0 || num_records_ < max_records_);
+}
+
+
+unsigned int SnapshotRecorder::getNumberOfRecords() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return num_records_;
+}
+
+
+unsigned int SnapshotRecorder::getSession() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return session_;
+}
+
+
+
+SnapshotReader::SnapshotReader() : truncated_(false)
+{
+
+}
+
+
+SnapshotReader::~SnapshotReader()
+{
+
+}
+
+
+bool SnapshotReader::open(const std::string& filename)
+{
+	close();
+
+	// Reading the whole file, since the snapshots are compact
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (file == NULL) {
+		printf(RED "FATAL: the %s snapshot file could not be opened\n" COLOR_RESET,
+				filename.c_str());
+		return false;
+	}
+	unsigned char buffer[65536];
+	std::size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		data_.insert(data_.end(), buffer, buffer + size);
+	fclose(file);
+
+	solve_snapshot::FileHeader header;
+	if (data_.size() < sizeof(header)) {
+		printf(RED "FATAL: the %s file is not a snapshot file\n" COLOR_RESET,
+				filename.c_str());
+		close();
+		return false;
+	}
+	memcpy(&header, data_.data(), sizeof(header));
+	if (memcmp(header.magic, solve_snapshot::Magic, sizeof(header.magic)) != 0 ||
+			header.version != solve_snapshot::Version) {
+		printf(RED "FATAL: the %s file is not a snapshot file of version %u\n"
+				COLOR_RESET, filename.c_str(), solve_snapshot::Version);
+		close();
+		return false;
+	}
+
+	// Indexing the records, where a truncated last record is ignored
+	std::size_t offset = sizeof(header);
+	while (offset < data_.size()) {
+		solve_snapshot::RecordHeader record;
+		if (data_.size() - offset < sizeof(record)) {
+			truncated_ = true;
+			break;
+		}
+		memcpy(&record, data_.data() + offset, sizeof(record));
+		offset += sizeof(record);
+		if (record.payload_size > data_.size() - offset) {
+			truncated_ = true;
+			break;
+		}
+
+		headers_.push_back(record);
+		offsets_.push_back(offset);
+		offset += record.payload_size;
+	}
+	if (truncated_)
+		printf(YELLOW "Warning: the last record of the %s snapshot file is truncated\n"
+				COLOR_RESET, filename.c_str());
+
+	return true;
+}
+
+
+void SnapshotReader::close()
+{
+	std::vector<unsigned char> empty_data;
+	data_.swap(empty_data);
+	headers_.clear();
+	offsets_.clear();
+	truncated_ = false;
+}
+
+
+unsigned int SnapshotReader::getNumberOfRecords() const
+{
+	return headers_.size();
+}
+
+
+const solve_snapshot::RecordHeader& SnapshotReader::getHeader(unsigned int record) const
+{
+	return headers_[record];
+}
+
+
+SnapshotDecoder SnapshotReader::getPayload(unsigned int record) const
+{
+	return SnapshotDecoder(data_.data() + offsets_[record], headers_[record].payload_size);
+}
+
+
+bool SnapshotReader::isTruncated() const
+{
+	return truncated_;
+}
+
+} //@namespace dwl
@@ -0,0 +1,349 @@
+#ifndef DWL__SOLVE_SNAPSHOT__H
+#define DWL__SOLVE_SNAPSHOT__H
+
+#include <dwl/WholeBodyState.h>
+#include <dwl/ReducedBodyState.h>
+#include <dwl/utils/DynamicLocomotion.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <stdint.h>
+
+
+namespace dwl
+{
+
+namespace simulation
+{
+struct PreviewControl;
+struct VelocityCommand;
+} //@namespace simulation
+
+
+/**
+ * @brief Layout of the solve snapshot files (version 1). A file starts with a header followed
+ * by a sequence of records, where every record is the exact inputs of a planner solve (e.g. a
+ * HierarchicalPlanning or WholeBodyTrajectoryOptimization compute call). Every record has a
+ * header, which defines the kind of planner, its sequence number, the wall time since the
+ * file was opened and the size of its payload. The payload is a flat sequence of values
+ * (little-endian doubles and 32-bit unsigned integers, length-prefixed strings, vectors and
+ * maps) written by the planner and read back in the same order when it's replayed. The
+ * records are flushed after writing them, so a crashed process leaves a readable prefix
+ */
+namespace solve_snapshot
+{
+/** @brief Magic number of the files, i.e. "DWLSNAP" */
+static const char Magic[8] = {'D', 'W', 'L', 'S', 'N', 'A', 'P', '\0'};
+
+/** @brief Version of the format */
+static const uint32_t Version = 1;
+
+/**
+ * @brief Kinds of planner solves. The payload of a preview optimization is its actual
+ * whole-body and reduced-body states, the starting preview control, the velocity command and
+ * the allowed computation time, in this order
+ */
+enum SnapshotKind {HierarchicalPlanningKind = 1,
+				   PreviewOptimizationKind = 2,
+				   WholeBodyTrajectoryOptimizationKind = 3};
+
+/** @brief Header of the files */
+struct FileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+};
+
+/** @brief Header of the records, which is followed by their payload */
+struct RecordHeader
+{
+	uint32_t kind;
+	uint32_t sequence;
+	uint64_t payload_size;
+	double wall_time;
+};
+} //@namespace solve_snapshot
+
+
+/**
+ * @class SnapshotEncoder
+ * @brief Encodes the payload of a snapshot record, i.e. the inputs of a planner solve. The
+ * buffer is reused between records, so clearing it doesn't release its memory
+ */
+class SnapshotEncoder
+{
+	public:
+		/** @brief Constructor function */
+		SnapshotEncoder();
+
+		/** @brief Destructor function */
+		~SnapshotEncoder();
+
+		/** @brief Clears the payload */
+		void clear();
+
+		/** @brief Writes the basic values */
+		void writeDouble(double value);
+		void writeUnsigned(unsigned int value);
+		void writeBool(bool value);
+		void writeString(const std::string& value);
+
+		/**
+		 * @brief Writes a vector (or matrix) as its number of coefficients followed by its
+		 * coefficients, in column-major order
+		 * @param const Eigen::MatrixBase<Derived>& Vector
+		 */
+		template<typename Derived>
+		void writeVector(const Eigen::MatrixBase<Derived>& vector);
+
+		/**
+		 * @brief Writes a map of named vectors (e.g. the contact states) as its number of
+		 * entries followed by the names and vectors
+		 * @param const std::map<std::string,T>& Map of named vectors
+		 */
+		template<typename T>
+		void writeVectorMap(const std::map<std::string,T>& map);
+
+		/** @brief Writes a pose, i.e. its position and quaternion */
+		void writePose(const Pose& pose);
+
+		/** @brief Writes a whole-body state, including its number of joints */
+		void writeState(const WholeBodyState& state);
+
+		/** @brief Writes a reduced-body state */
+		void writeState(const ReducedBodyState& state);
+
+		/** @brief Writes a preview control, i.e. the parameters and phase of its phases */
+		void writePreviewControl(const simulation::PreviewControl& control);
+
+		/** @brief Writes a velocity command */
+		void writeVelocityCommand(const simulation::VelocityCommand& command);
+
+		/** @brief Gets the payload */
+		const std::vector<unsigned char>& getData() const;
+
+
+	private:
+		/** @brief Appends raw bytes to the payload */
+		void append(const void* data,
+					std::size_t size);
+
+		/** @brief Payload of the record */
+		std::vector<unsigned char> data_;
+};
+
+
+/**
+ * @class SnapshotDecoder
+ * @brief Decodes the payload of a snapshot record in the order of its encoding. Every read is
+ * bounds-checked, and a failed read invalidates the decoder, so the replays check the result
+ * once after decoding all the values
+ */
+class SnapshotDecoder
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param const unsigned char* Payload
+		 * @param std::size_t Size of the payload
+		 */
+		SnapshotDecoder(const unsigned char* data,
+						std::size_t size);
+
+		/** @brief Destructor function */
+		~SnapshotDecoder();
+
+		/** @brief Reads the basic values */
+		bool readDouble(double& value);
+		bool readUnsigned(unsigned int& value);
+		bool readBool(bool& value);
+		bool readString(std::string& value);
+
+		/**
+		 * @brief Reads a vector (or matrix), which fails if the fixed-size vectors don't have
+		 * its number of coefficients. The dynamic-size matrices are read as column vectors
+		 * @param Eigen::PlainObjectBase<Derived>& Vector
+		 * @return True if it was read
+		 */
+		template<typename Derived>
+		bool readVector(Eigen::PlainObjectBase<Derived>& vector);
+
+		/**
+		 * @brief Reads a map of named vectors
+		 * @param std::map<std::string,T>& Map of named vectors
+		 * @return True if it was read
+		 */
+		template<typename T>
+		bool readVectorMap(std::map<std::string,T>& map);
+
+		/** @brief Reads a pose */
+		bool readPose(Pose& pose);
+
+		/** @brief Reads a whole-body state, which sets its number of joints */
+		bool readState(WholeBodyState& state);
+
+		/** @brief Reads a reduced-body state */
+		bool readState(ReducedBodyState& state);
+
+		/** @brief Reads a preview control */
+		bool readPreviewControl(simulation::PreviewControl& control);
+
+		/** @brief Reads a velocity command */
+		bool readVelocityCommand(simulation::VelocityCommand& command);
+
+		/** @brief Indicates if all the reads succeeded */
+		bool isValid() const;
+
+		/** @brief Gets the number of bytes that weren't read */
+		std::size_t getRemainingBytes() const;
+
+
+	private:
+		/** @brief Reads raw bytes, which invalidates the decoder if there aren't enough */
+		bool read(void* data,
+				  std::size_t size);
+
+		/** @brief Payload and its size */
+		const unsigned char* data_;
+		std::size_t size_;
+
+		/** @brief Offset of the next value */
+		std::size_t offset_;
+
+		/** @brief Indicates if all the reads succeeded */
+		bool valid_;
+};
+
+
+/**
+ * @class SnapshotRecorder
+ * @brief Records the inputs of the planner solves in a snapshot file, so they can be replayed
+ * offline (e.g. by the replay benchmark with the instrumentation enabled). The planners record
+ * from their compute calls, which could run in different threads, so the records are
+ * serialized by a mutex. The recording stops after a maximum number of records, if defined
+ */
+class SnapshotRecorder
+{
+	public:
+		/** @brief Constructor function */
+		SnapshotRecorder();
+
+		/** @brief Destructor function, which closes the file */
+		~SnapshotRecorder();
+
+		/**
+		 * @brief Opens the file and writes its header
+		 * @param const std::string& File name
+		 * @return True if the file was opened
+		 */
+		bool open(const std::string& filename);
+
+		/** @brief Closes the file */
+		void close();
+
+		/**
+		 * @brief Sets the maximum number of records of a file
+		 * @param unsigned int Maximum number of records (zero for unlimited)
+		 */
+		void setMaxRecords(unsigned int max_records);
+
+		/**
+		 * @brief Writes a record and flushes it
+		 * @param solve_snapshot::SnapshotKind Kind of planner solve
+		 * @param const SnapshotEncoder& Payload of the record
+		 * @return True if the record was written
+		 */
+		bool record(solve_snapshot::SnapshotKind kind,
+					const SnapshotEncoder& encoder);
+
+		/**
+		 * @brief Indicates if the next record will be written, so the planners only encode
+		 * their inputs while recording
+		 */
+		bool isRecording() const;
+
+		/** @brief Gets the number of records of the file */
+		unsigned int getNumberOfRecords() const;
+
+		/**
+		 * @brief Gets the session of the recorder, i.e. the number of opened files. The
+		 * planners use it for knowing the inputs already written in the current file (e.g.
+		 * an unchanged terrain map)
+		 */
+		unsigned int getSession() const;
+
+
+	private:
+		/** @brief File of the records */
+		FILE* file_;
+
+		/** @brief Opening time of the file */
+		std::chrono::steady_clock::time_point opening_time_;
+
+		/** @brief Number of records and its maximum */
+		unsigned int num_records_;
+		unsigned int max_records_;
+
+		/** @brief Number of opened files */
+		unsigned int session_;
+
+		/** @brief Serializes the records and the file changes */
+		mutable std::mutex mutex_;
+};
+
+
+/**
+ * @class SnapshotReader
+ * @brief Reads a snapshot file and indexes its records. A truncated last record (e.g. of a
+ * crashed process) is ignored
+ */
+class SnapshotReader
+{
+	public:
+		/** @brief Constructor function */
+		SnapshotReader();
+
+		/** @brief Destructor function */
+		~SnapshotReader();
+
+		/**
+		 * @brief Reads a snapshot file
+		 * @param const std::string& File name
+		 * @return True if it's a valid snapshot file
+		 */
+		bool open(const std::string& filename);
+
+		/** @brief Discards the read file */
+		void close();
+
+		/** @brief Gets the number of records */
+		unsigned int getNumberOfRecords() const;
+
+		/** @brief Gets the header of a record */
+		const solve_snapshot::RecordHeader& getHeader(unsigned int record) const;
+
+		/** @brief Gets a decoder of the payload of a record */
+		SnapshotDecoder getPayload(unsigned int record) const;
+
+		/** @brief Indicates if the last record was truncated */
+		bool isTruncated() const;
+
+
+	private:
+		/** @brief Content of the file */
+		std::vector<unsigned char> data_;
+
+		/** @brief Headers and offsets of the payloads of the records */
+		std::vector<solve_snapshot::RecordHeader> headers_;
+		std::vector<std::size_t> offsets_;
+
+		/** @brief Indicates if the last record was truncated */
+		bool truncated_;
+};
+
+} //@namespace dwl
+
+#include <dwl/impl/SolveSnapshot.hpp>
+
+#endif
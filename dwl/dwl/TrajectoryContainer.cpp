@@ -0,0 +1,596 @@
+#include <dwl/TrajectoryContainer.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <set>
+
+
+namespace dwl
+{
+
+WholeBodyTrajectoryContainer::WholeBodyTrajectoryContainer() : num_joints_(0)
+{
+
+}
+
+
+WholeBodyTrajectoryContainer::~WholeBodyTrajectoryContainer()
+{
+
+}
+
+
+void WholeBodyTrajectoryContainer::resize(unsigned int num_points,
+										  unsigned int num_joints,
+										  const std::vector<std::string>& contact_names)
+{
+	num_joints_ = num_joints;
+	contact_names_ = contact_names;
+	unsigned int num_contacts = contact_names_.size();
+
+	time.setZero(num_points);
+	duration.setZero(num_points);
+	base_pos.setZero(6, num_points);
+	base_vel.setZero(6, num_points);
+	base_acc.setZero(6, num_points);
+	base_eff.setZero(6, num_points);
+	joint_pos.setZero(num_joints_, num_points);
+	joint_vel.setZero(num_joints_, num_points);
+	joint_acc.setZero(num_joints_, num_points);
+	joint_eff.setZero(num_joints_, num_points);
+	contact_pos.setZero(3 * num_contacts, num_points);
+	contact_vel.setZero(3 * num_contacts, num_points);
+	contact_acc.setZero(3 * num_contacts, num_points);
+	contact_eff.setZero(6 * num_contacts, num_points);
+	contact_flags_.assign(num_contacts * num_points, 0);
+}
+
+
+void WholeBodyTrajectoryContainer::clear()
+{
+	resize(0, 0, std::vector<std::string>());
+}
+
+
+unsigned int WholeBodyTrajectoryContainer::size() const
+{
+	return time.size();
+}
+
+
+unsigned int WholeBodyTrajectoryContainer::getJointDoF() const
+{
+	return num_joints_;
+}
+
+
+const std::vector<std::string>& WholeBodyTrajectoryContainer::getContactNames() const
+{
+	return contact_names_;
+}
+
+
+int WholeBodyTrajectoryContainer::getContactIndex(const std::string& name) const
+{
+	for (unsigned int c = 0; c < contact_names_.size(); c++) {
+		if (contact_names_[c] == name)
+			return c;
+	}
+
+	return -1;
+}
+
+
+bool WholeBodyTrajectoryContainer::hasContact(unsigned int index,
+											  unsigned int contact,
+											  ContactQuantity quantity) const
+{
+	return (contact_flags_[index * contact_names_.size() + contact] & quantity) != 0;
+}
+
+
+WholeBodyTrajectoryContainer::StateView
+WholeBodyTrajectoryContainer::getView(unsigned int index)
+{
+	return StateView(*this, index);
+}
+
+
+void WholeBodyTrajectoryContainer::setState(unsigned int index,
+											const WholeBodyState& state)
+{
+	time(index) = state.time;
+	duration(index) = state.duration;
+	base_pos.col(index) = state.base_pos;
+	base_vel.col(index) = state.base_vel;
+	base_acc.col(index) = state.base_acc;
+	base_eff.col(index) = state.base_eff;
+	if (num_joints_ != 0) {
+		joint_pos.col(index) = state.joint_pos;
+		joint_vel.col(index) = state.joint_vel;
+		joint_acc.col(index) = state.joint_acc;
+		joint_eff.col(index) = state.joint_eff;
+	}
+
+	// Setting the contact quantities, where the undefined ones are marked
+	unsigned int num_contacts = contact_names_.size();
+	for (unsigned int c = 0; c < num_contacts; c++) {
+		const std::string& name = contact_names_[c];
+		unsigned char& flags = contact_flags_[index * num_contacts + c];
+		flags = 0;
+
+		rbd::BodyVectorXd::const_iterator it;
+		if ((it = state.contact_pos.find(name)) != state.contact_pos.end()) {
+			contact_pos.block<3,1>(3 * c, index) = it->second.head<3>();
+			flags |= POSITION;
+		}
+		if ((it = state.contact_vel.find(name)) != state.contact_vel.end()) {
+			contact_vel.block<3,1>(3 * c, index) = it->second.head<3>();
+			flags |= VELOCITY;
+		}
+		if ((it = state.contact_acc.find(name)) != state.contact_acc.end()) {
+			contact_acc.block<3,1>(3 * c, index) = it->second.head<3>();
+			flags |= ACCELERATION;
+		}
+		rbd::BodyVector6d::const_iterator eff_it = state.contact_eff.find(name);
+		if (eff_it != state.contact_eff.end()) {
+			contact_eff.block<6,1>(6 * c, index) = eff_it->second;
+			flags |= EFFORT;
+		}
+	}
+}
+
+
+void WholeBodyTrajectoryContainer::getState(WholeBodyState& state,
+											unsigned int index) const
+{
+	state.setJointDoF(num_joints_);
+	state.time = time(index);
+	state.duration = duration(index);
+	state.base_pos = base_pos.col(index);
+	state.base_vel = base_vel.col(index);
+	state.base_acc = base_acc.col(index);
+	state.base_eff = base_eff.col(index);
+	state.joint_pos = joint_pos.col(index);
+	state.joint_vel = joint_vel.col(index);
+	state.joint_acc = joint_acc.col(index);
+	state.joint_eff = joint_eff.col(index);
+
+	// Getting the defined contact quantities
+	state.contact_pos.clear();
+	state.contact_vel.clear();
+	state.contact_acc.clear();
+	state.contact_eff.clear();
+	for (unsigned int c = 0; c < contact_names_.size(); c++) {
+		const std::string& name = contact_names_[c];
+		if (hasContact(index, c, POSITION))
+			state.contact_pos[name] = contact_pos.block<3,1>(3 * c, index);
+		if (hasContact(index, c, VELOCITY))
+			state.contact_vel[name] = contact_vel.block<3,1>(3 * c, index);
+		if (hasContact(index, c, ACCELERATION))
+			state.contact_acc[name] = contact_acc.block<3,1>(3 * c, index);
+		if (hasContact(index, c, EFFORT))
+			state.contact_eff[name] = contact_eff.block<6,1>(6 * c, index);
+	}
+}
+
+
+void WholeBodyTrajectoryContainer::fromTrajectory(const WholeBodyTrajectory& trajectory)
+{
+	// Getting the contact names of the whole trajectory
+	std::set<std::string> names;
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		const WholeBodyState& state = trajectory[k];
+		for (WholeBodyState::ContactIterator it = state.contact_pos.begin();
+				it != state.contact_pos.end(); it++)
+			names.insert(it->first);
+		for (WholeBodyState::ContactIterator it = state.contact_vel.begin();
+				it != state.contact_vel.end(); it++)
+			names.insert(it->first);
+		for (WholeBodyState::ContactIterator it = state.contact_acc.begin();
+				it != state.contact_acc.end(); it++)
+			names.insert(it->first);
+		for (rbd::BodyVector6d::const_iterator it = state.contact_eff.begin();
+				it != state.contact_eff.end(); it++)
+			names.insert(it->first);
+	}
+
+	unsigned int num_joints = trajectory.empty() ? 0 : trajectory[0].joint_pos.size();
+	resize(trajectory.size(), num_joints,
+		   std::vector<std::string>(names.begin(), names.end()));
+	for (unsigned int k = 0; k < trajectory.size(); k++)
+		setState(k, trajectory[k]);
+}
+
+
+void WholeBodyTrajectoryContainer::toTrajectory(WholeBodyTrajectory& trajectory) const
+{
+	trajectory.resize(size());
+	for (unsigned int k = 0; k < size(); k++)
+		getState(trajectory[k], k);
+}
+
+
+const std::vector<unsigned char>& WholeBodyTrajectoryContainer::getContactFlags() const
+{
+	return contact_flags_;
+}
+
+
+std::size_t WholeBodyTrajectoryContainer::getHeapBytes() const
+{
+	return utils::getHeapBytes(time) + utils::getHeapBytes(duration) +
+			utils::getHeapBytes(base_pos) + utils::getHeapBytes(base_vel) +
+			utils::getHeapBytes(base_acc) + utils::getHeapBytes(base_eff) +
+			utils::getHeapBytes(joint_pos) + utils::getHeapBytes(joint_vel) +
+			utils::getHeapBytes(joint_acc) + utils::getHeapBytes(joint_eff) +
+			utils::getHeapBytes(contact_pos) + utils::getHeapBytes(contact_vel) +
+			utils::getHeapBytes(contact_acc) + utils::getHeapBytes(contact_eff) +
+			utils::getHeapBytes(contact_names_) + utils::getHeapBytes(contact_flags_);
+}
+
+
+void WholeBodyTrajectoryContainer::setContactFlag(unsigned int index,
+												  unsigned int contact,
+												  ContactQuantity quantity)
+{
+	contact_flags_[index * contact_names_.size() + contact] |= quantity;
+}
+
+
+
+/** @brief Erases the contacts of a map that aren't in the reference one */
+template<typename ContactMap>
+static void eraseMissingContacts(ContactMap& contacts,
+								 const ContactMap& reference)
+{
+	for (typename ContactMap::iterator it = contacts.begin(); it != contacts.end();) {
+		if (reference.count(it->first) == 0)
+			contacts.erase(it++);
+		else
+			++it;
+	}
+}
+
+
+WholeBodyTrajectoryQuery::WholeBodyTrajectoryQuery() : trajectory_(NULL)
+{
+
+}
+
+
+WholeBodyTrajectoryQuery::~WholeBodyTrajectoryQuery()
+{
+
+}
+
+
+void WholeBodyTrajectoryQuery::reset(const WholeBodyTrajectory& trajectory)
+{
+	trajectory_ = &trajectory;
+	Eigen::VectorXd times(trajectory.size());
+	for (unsigned int k = 0; k < trajectory.size(); k++)
+		times(k) = trajectory[k].time;
+	index_.reset(times);
+}
+
+
+bool WholeBodyTrajectoryQuery::getState(WholeBodyState& state,
+										double time) const
+{
+	if (trajectory_ == NULL || trajectory_->empty())
+		return false;
+
+	// Holding the first or last state outside the trajectory
+	const WholeBodyTrajectory& trajectory = *trajectory_;
+	unsigned int num_points = trajectory.size();
+	if (num_points == 1 || time <= trajectory.front().time) {
+		state = trajectory.front();
+		return time == trajectory.front().time;
+	}
+	if (time >= trajectory.back().time) {
+		state = trajectory.back();
+		return time == trajectory.back().time;
+	}
+
+	// Computing the cubic Hermite basis of the segment, and their first and second
+	// derivatives
+	unsigned int k = index_.getSegment(time);
+	const WholeBodyState& start = trajectory[k];
+	const WholeBodyState& end = trajectory[k+1];
+	double h = end.time - start.time;
+	double s = (time - start.time) / h;
+	double s2 = s * s, s3 = s2 * s;
+	double h00 = 2 * s3 - 3 * s2 + 1, h10 = (s3 - 2 * s2 + s) * h;
+	double h01 = -2 * s3 + 3 * s2, h11 = (s3 - s2) * h;
+	double dh00 = (6 * s2 - 6 * s) / h, dh10 = 3 * s2 - 4 * s + 1;
+	double dh01 = (-6 * s2 + 6 * s) / h, dh11 = 3 * s2 - 2 * s;
+	double ddh00 = (12 * s - 6) / (h * h), ddh10 = (6 * s - 4) / h;
+	double ddh01 = (-12 * s + 6) / (h * h), ddh11 = (6 * s - 2) / h;
+
+	// Interpolating the base and joint states
+	if (state.getJointDoF() != start.getJointDoF())
+		state.setJointDoF(start.getJointDoF());
+	state.time = time;
+	state.duration = time - start.time;
+	state.base_pos = h00 * start.base_pos + h10 * start.base_vel +
+			h01 * end.base_pos + h11 * end.base_vel;
+	state.base_vel = dh00 * start.base_pos + dh10 * start.base_vel +
+			dh01 * end.base_pos + dh11 * end.base_vel;
+	state.base_acc = ddh00 * start.base_pos + ddh10 * start.base_vel +
+			ddh01 * end.base_pos + ddh11 * end.base_vel;
+	state.joint_pos = h00 * start.joint_pos + h10 * start.joint_vel +
+			h01 * end.joint_pos + h11 * end.joint_vel;
+	state.joint_vel = dh00 * start.joint_pos + dh10 * start.joint_vel +
+			dh01 * end.joint_pos + dh11 * end.joint_vel;
+	state.joint_acc = ddh00 * start.joint_pos + ddh10 * start.joint_vel +
+			ddh01 * end.joint_pos + ddh11 * end.joint_vel;
+	state.base_eff = (1 - s) * start.base_eff + s * end.base_eff;
+	state.joint_eff = (1 - s) * start.joint_eff + s * end.joint_eff;
+
+	// Interpolating the contacts of the starting state, where the entries of the state are
+	// reused
+	eraseMissingContacts(state.contact_pos, start.contact_pos);
+	eraseMissingContacts(state.contact_vel, start.contact_vel);
+	eraseMissingContacts(state.contact_acc, start.contact_acc);
+	eraseMissingContacts(state.contact_eff, start.contact_eff);
+	for (rbd::BodyVectorXd::const_iterator pos_it = start.contact_pos.begin();
+			pos_it != start.contact_pos.end(); pos_it++) {
+		rbd::BodyVectorXd::const_iterator end_it = end.contact_pos.find(pos_it->first);
+		state.contact_pos[pos_it->first] = (end_it == end.contact_pos.end()) ?
+				pos_it->second : (1 - s) * pos_it->second + s * end_it->second;
+	}
+	for (rbd::BodyVectorXd::const_iterator vel_it = start.contact_vel.begin();
+			vel_it != start.contact_vel.end(); vel_it++) {
+		rbd::BodyVectorXd::const_iterator end_it = end.contact_vel.find(vel_it->first);
+		state.contact_vel[vel_it->first] = (end_it == end.contact_vel.end()) ?
+				vel_it->second : (1 - s) * vel_it->second + s * end_it->second;
+	}
+	for (rbd::BodyVectorXd::const_iterator acc_it = start.contact_acc.begin();
+			acc_it != start.contact_acc.end(); acc_it++) {
+		rbd::BodyVectorXd::const_iterator end_it = end.contact_acc.find(acc_it->first);
+		state.contact_acc[acc_it->first] = (end_it == end.contact_acc.end()) ?
+				acc_it->second : (1 - s) * acc_it->second + s * end_it->second;
+	}
+	for (rbd::BodyVector6d::const_iterator eff_it = start.contact_eff.begin();
+			eff_it != start.contact_eff.end(); eff_it++) {
+		rbd::BodyVector6d::const_iterator end_it = end.contact_eff.find(eff_it->first);
+		state.contact_eff[eff_it->first] = (end_it == end.contact_eff.end()) ?
+				eff_it->second : (rbd::Vector6d) ((1 - s) * eff_it->second + s * end_it->second);
+	}
+
+	return true;
+}
+
+
+unsigned int WholeBodyTrajectoryQuery::getSegment(double time) const
+{
+	return index_.getSegment(time);
+}
+
+
+const math::TimeIndex& WholeBodyTrajectoryQuery::getTimeIndex() const
+{
+	return index_;
+}
+
+
+ReducedBodyTrajectoryContainer::ReducedBodyTrajectoryContainer()
+{
+
+}
+
+
+ReducedBodyTrajectoryContainer::~ReducedBodyTrajectoryContainer()
+{
+
+}
+
+
+void ReducedBodyTrajectoryContainer::resize(unsigned int num_points,
+											const std::vector<std::string>& feet_names)
+{
+	feet_names_ = feet_names;
+	unsigned int num_feet = feet_names_.size();
+
+	time.setZero(num_points);
+	com_pos.setZero(3, num_points);
+	angular_pos.setZero(3, num_points);
+	com_vel.setZero(3, num_points);
+	angular_vel.setZero(3, num_points);
+	com_acc.setZero(3, num_points);
+	angular_acc.setZero(3, num_points);
+	cop.setZero(3, num_points);
+	support_region.setZero(3 * num_feet, num_points);
+	foot_pos.setZero(3 * num_feet, num_points);
+	foot_vel.setZero(3 * num_feet, num_points);
+	foot_acc.setZero(3 * num_feet, num_points);
+	foot_flags_.assign(num_feet * num_points, 0);
+}
+
+
+void ReducedBodyTrajectoryContainer::clear()
+{
+	resize(0, std::vector<std::string>());
+}
+
+
+unsigned int ReducedBodyTrajectoryContainer::size() const
+{
+	return time.size();
+}
+
+
+const std::vector<std::string>& ReducedBodyTrajectoryContainer::getFeetNames() const
+{
+	return feet_names_;
+}
+
+
+int ReducedBodyTrajectoryContainer::getFootIndex(const std::string& name) const
+{
+	for (unsigned int f = 0; f < feet_names_.size(); f++) {
+		if (feet_names_[f] == name)
+			return f;
+	}
+
+	return -1;
+}
+
+
+bool ReducedBodyTrajectoryContainer::hasFoot(unsigned int index,
+											 unsigned int foot,
+											 FootQuantity quantity) const
+{
+	return (foot_flags_[index * feet_names_.size() + foot] & quantity) != 0;
+}
+
+
+ReducedBodyTrajectoryContainer::StateView
+ReducedBodyTrajectoryContainer::getView(unsigned int index)
+{
+	return StateView(*this, index);
+}
+
+
+void ReducedBodyTrajectoryContainer::setState(unsigned int index,
+											  const ReducedBodyState& state)
+{
+	time(index) = state.time;
+	com_pos.col(index) = state.com_pos;
+	angular_pos.col(index) = state.angular_pos;
+	com_vel.col(index) = state.com_vel;
+	angular_vel.col(index) = state.angular_vel;
+	com_acc.col(index) = state.com_acc;
+	angular_acc.col(index) = state.angular_acc;
+	cop.col(index) = state.cop;
+
+	// Setting the foot quantities, where the undefined ones are marked
+	unsigned int num_feet = feet_names_.size();
+	for (unsigned int f = 0; f < num_feet; f++) {
+		const std::string& name = feet_names_[f];
+		unsigned char& flags = foot_flags_[index * num_feet + f];
+		flags = 0;
+
+		FootIterator it;
+		if ((it = state.support_region.find(name)) != state.support_region.end()) {
+			support_region.block<3,1>(3 * f, index) = it->second;
+			flags |= SUPPORT;
+		}
+		if ((it = state.foot_pos.find(name)) != state.foot_pos.end()) {
+			foot_pos.block<3,1>(3 * f, index) = it->second;
+			flags |= POSITION;
+		}
+		if ((it = state.foot_vel.find(name)) != state.foot_vel.end()) {
+			foot_vel.block<3,1>(3 * f, index) = it->second;
+			flags |= VELOCITY;
+		}
+		if ((it = state.foot_acc.find(name)) != state.foot_acc.end()) {
+			foot_acc.block<3,1>(3 * f, index) = it->second;
+			flags |= ACCELERATION;
+		}
+	}
+}
+
+
+void ReducedBodyTrajectoryContainer::getState(ReducedBodyState& state,
+											  unsigned int index) const
+{
+	state.time = time(index);
+	state.com_pos = com_pos.col(index);
+	state.angular_pos = angular_pos.col(index);
+	state.com_vel = com_vel.col(index);
+	state.angular_vel = angular_vel.col(index);
+	state.com_acc = com_acc.col(index);
+	state.angular_acc = angular_acc.col(index);
+	state.cop = cop.col(index);
+
+	// Getting the defined foot quantities
+	state.support_region.clear();
+	state.foot_pos.clear();
+	state.foot_vel.clear();
+	state.foot_acc.clear();
+	for (unsigned int f = 0; f < feet_names_.size(); f++) {
+		const std::string& name = feet_names_[f];
+		if (hasFoot(index, f, SUPPORT))
+			state.support_region[name] = support_region.block<3,1>(3 * f, index);
+		if (hasFoot(index, f, POSITION))
+			state.foot_pos[name] = foot_pos.block<3,1>(3 * f, index);
+		if (hasFoot(index, f, VELOCITY))
+			state.foot_vel[name] = foot_vel.block<3,1>(3 * f, index);
+		if (hasFoot(index, f, ACCELERATION))
+			state.foot_acc[name] = foot_acc.block<3,1>(3 * f, index);
+	}
+}
+
+
+void ReducedBodyTrajectoryContainer::fromTrajectory(const ReducedBodyTrajectory& trajectory)
+{
+	// Getting the feet names of the whole trajectory
+	std::set<std::string> names;
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		const ReducedBodyState& state = trajectory[k];
+		for (FootIterator it = state.support_region.begin();
+				it != state.support_region.end(); it++)
+			names.insert(it->first);
+		for (FootIterator it = state.foot_pos.begin();
+				it != state.foot_pos.end(); it++)
+			names.insert(it->first);
+		for (FootIterator it = state.foot_vel.begin();
+				it != state.foot_vel.end(); it++)
+			names.insert(it->first);
+		for (FootIterator it = state.foot_acc.begin();
+				it != state.foot_acc.end(); it++)
+			names.insert(it->first);
+	}
+
+	resize(trajectory.size(), std::vector<std::string>(names.begin(), names.end()));
+	for (unsigned int k = 0; k < trajectory.size(); k++)
+		setState(k, trajectory[k]);
+}
+
+
+void ReducedBodyTrajectoryContainer::toTrajectory(ReducedBodyTrajectory& trajectory) const
+{
+	trajectory.resize(size());
+	for (unsigned int k = 0; k < size(); k++)
+		getState(trajectory[k], k);
+}
+
+
+const std::vector<unsigned char>& ReducedBodyTrajectoryContainer::getFootFlags() const
+{
+	return foot_flags_;
+}
+
+
+std::size_t ReducedBodyTrajectoryContainer::getHeapBytes() const
+{
+	return utils::getHeapBytes(time) + utils::getHeapBytes(com_pos) +
+			utils::getHeapBytes(angular_pos) + utils::getHeapBytes(com_vel) +
+			utils::getHeapBytes(angular_vel) + utils::getHeapBytes(com_acc) +
+			utils::getHeapBytes(angular_acc) + utils::getHeapBytes(cop) +
+			utils::getHeapBytes(support_region) + utils::getHeapBytes(foot_pos) +
+			utils::getHeapBytes(foot_vel) + utils::getHeapBytes(foot_acc) +
+			utils::getHeapBytes(feet_names_) + utils::getHeapBytes(foot_flags_);
+}
+
+
+void ReducedBodyTrajectoryContainer::setFootFlag(unsigned int index,
+												 unsigned int foot,
+												 FootQuantity quantity)
+{
+	foot_flags_[index * feet_names_.size() + foot] |= quantity;
+}
+
+
+std::size_t getHeapBytes(const WholeBodyTrajectory& trajectory)
+{
+	return utils::getHeapBytes(trajectory);
+}
+
+
+std::size_t getHeapBytes(const ReducedBodyTrajectory& trajectory)
+{
+	return utils::getHeapBytes(trajectory);
+}
+
+} //@namespace dwl
@@ -0,0 +1,468 @@
+#ifndef DWL__TRAJECTORY_CONTAINER__H
+#define DWL__TRAJECTORY_CONTAINER__H
+
+#include <dwl/WholeBodyState.h>
+#include <dwl/ReducedBodyState.h>
+#include <dwl/utils/TimeIndex.h>
+#include <string>
+#include <vector>
+
+
+namespace dwl
+{
+
+/**
+ * @brief The WholeBodyTrajectoryContainer class
+ * This class stores a whole-body trajectory as a structure of arrays, i.e.
+ * each state quantity is a contiguous matrix where every column is a point of
+ * the trajectory:
+ * <ul>
+ *   <li>time, duration [1 x K]</li>
+ *   <li>base_pos, base_vel, base_acc, base_eff [6 x K]</li>
+ *   <li>joint_pos, joint_vel, joint_acc, joint_eff [N x K]</li>
+ *   <li>contact_pos, contact_vel, contact_acc [3P x K]</li>
+ *   <li>contact_eff [6P x K]</li>
+ * </ul>
+ * where K, N and P are the number of points, DoF and contacts, respectively.
+ * The contacts are ordered as the contact names given in the resize function.
+ * Contrary to the WholeBodyTrajectory (std::vector<WholeBodyState>), there is
+ * only one allocation per quantity, so long trajectories are cheaply iterated,
+ * interpolated and serialized. The points are accessed without copies through
+ * lightweight state views.
+ * @author Carlos Mastalli
+ * @copyright BSD 3-Clause License
+ */
+class WholeBodyTrajectoryContainer
+{
+	public:
+		/** @brief Quantities of a contact that are defined in a point */
+		enum ContactQuantity {POSITION = 1, VELOCITY = 2, ACCELERATION = 4, EFFORT = 8};
+
+		/**
+		 * @brief The StateView class
+		 * This class is a lightweight view of a point of the trajectory, where
+		 * every quantity is a block of the container matrices, so it doesn't
+		 * copy any value. Note that a view is invalidated when the container
+		 * is resized.
+		 */
+		class StateView
+		{
+			public:
+				StateView(WholeBodyTrajectoryContainer& trajectory,
+						  unsigned int index) : trajectory_(trajectory), index_(index) {}
+
+				double& time() { return trajectory_.time(index_); }
+				double& duration() { return trajectory_.duration(index_); }
+				Eigen::MatrixXd::ColXpr base_pos() { return trajectory_.base_pos.col(index_); }
+				Eigen::MatrixXd::ColXpr base_vel() { return trajectory_.base_vel.col(index_); }
+				Eigen::MatrixXd::ColXpr base_acc() { return trajectory_.base_acc.col(index_); }
+				Eigen::MatrixXd::ColXpr base_eff() { return trajectory_.base_eff.col(index_); }
+				Eigen::MatrixXd::ColXpr joint_pos() { return trajectory_.joint_pos.col(index_); }
+				Eigen::MatrixXd::ColXpr joint_vel() { return trajectory_.joint_vel.col(index_); }
+				Eigen::MatrixXd::ColXpr joint_acc() { return trajectory_.joint_acc.col(index_); }
+				Eigen::MatrixXd::ColXpr joint_eff() { return trajectory_.joint_eff.col(index_); }
+				Eigen::Block<Eigen::MatrixXd,3,1> contact_pos(unsigned int contact) {
+					trajectory_.setContactFlag(index_, contact, POSITION);
+					return trajectory_.contact_pos.block<3,1>(3 * contact, index_);
+				}
+				Eigen::Block<Eigen::MatrixXd,3,1> contact_vel(unsigned int contact) {
+					trajectory_.setContactFlag(index_, contact, VELOCITY);
+					return trajectory_.contact_vel.block<3,1>(3 * contact, index_);
+				}
+				Eigen::Block<Eigen::MatrixXd,3,1> contact_acc(unsigned int contact) {
+					trajectory_.setContactFlag(index_, contact, ACCELERATION);
+					return trajectory_.contact_acc.block<3,1>(3 * contact, index_);
+				}
+				Eigen::Block<Eigen::MatrixXd,6,1> contact_eff(unsigned int contact) {
+					trajectory_.setContactFlag(index_, contact, EFFORT);
+					return trajectory_.contact_eff.block<6,1>(6 * contact, index_);
+				}
+
+			private:
+				WholeBodyTrajectoryContainer& trajectory_;
+				unsigned int index_;
+		};
+
+		/** @brief Constructor function */
+		WholeBodyTrajectoryContainer();
+
+		/** @brief Destructor function */
+		~WholeBodyTrajectoryContainer();
+
+		/**
+		 * @brief Resizes the container, where all the values are set to zero and
+		 * the contacts are undefined
+		 * @param unsigned int Number of points
+		 * @param unsigned int Number of joints
+		 * @param const std::vector<std::string>& Names of the contacts
+		 */
+		void resize(unsigned int num_points,
+					unsigned int num_joints,
+					const std::vector<std::string>& contact_names);
+
+		/** @brief Clears the container */
+		void clear();
+
+		/** @brief Gets the number of points */
+		unsigned int size() const;
+
+		/** @brief Gets the number of joints */
+		unsigned int getJointDoF() const;
+
+		/** @brief Gets the names of the contacts */
+		const std::vector<std::string>& getContactNames() const;
+
+		/**
+		 * @brief Gets the index of a contact
+		 * @param const std::string& Contact name
+		 * @return int Contact index, or -1 if the contact doesn't exist
+		 */
+		int getContactIndex(const std::string& name) const;
+
+		/**
+		 * @brief Indicates if a quantity of a contact is defined in a point
+		 * @param unsigned int Point index
+		 * @param unsigned int Contact index
+		 * @param ContactQuantity Contact quantity
+		 */
+		bool hasContact(unsigned int index,
+						unsigned int contact,
+						ContactQuantity quantity) const;
+
+		/**
+		 * @brief Gets a view of a point of the trajectory
+		 * @param unsigned int Point index
+		 * @return StateView View of the point
+		 */
+		StateView getView(unsigned int index);
+
+		/**
+		 * @brief Sets a point of the trajectory from a whole-body state. Note
+		 * that the contacts that aren't in the container are ignored
+		 * @param unsigned int Point index
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void setState(unsigned int index,
+					  const WholeBodyState& state);
+
+		/**
+		 * @brief Gets a point of the trajectory as a whole-body state
+		 * @param WholeBodyState& Whole-body state
+		 * @param unsigned int Point index
+		 */
+		void getState(WholeBodyState& state,
+					  unsigned int index) const;
+
+		/**
+		 * @brief Sets the container from a whole-body trajectory, where the
+		 * contacts are the ones defined in any point of the trajectory
+		 * @param const WholeBodyTrajectory& Whole-body trajectory
+		 */
+		void fromTrajectory(const WholeBodyTrajectory& trajectory);
+
+		/**
+		 * @brief Gets the container as a whole-body trajectory
+		 * @param WholeBodyTrajectory& Whole-body trajectory
+		 */
+		void toTrajectory(WholeBodyTrajectory& trajectory) const;
+
+		/** @brief Gets the defined contact quantities, indexed by point and then contact */
+		const std::vector<unsigned char>& getContactFlags() const;
+
+		/** @brief Gets the heap bytes of the container, i.e. of its quantities and flags */
+		std::size_t getHeapBytes() const;
+
+		/** @brief Whole-body quantities, where every column is a point */
+		Eigen::VectorXd time;
+		Eigen::VectorXd duration;
+		Eigen::MatrixXd base_pos;
+		Eigen::MatrixXd base_vel;
+		Eigen::MatrixXd base_acc;
+		Eigen::MatrixXd base_eff;
+		Eigen::MatrixXd joint_pos;
+		Eigen::MatrixXd joint_vel;
+		Eigen::MatrixXd joint_acc;
+		Eigen::MatrixXd joint_eff;
+		Eigen::MatrixXd contact_pos;
+		Eigen::MatrixXd contact_vel;
+		Eigen::MatrixXd contact_acc;
+		Eigen::MatrixXd contact_eff;
+
+
+	private:
+		friend class MappedWholeBodyTrajectory;
+
+		/** @brief Marks a quantity of a contact as defined in a point */
+		void setContactFlag(unsigned int index,
+							unsigned int contact,
+							ContactQuantity quantity);
+
+		/** @brief Number of joints */
+		unsigned int num_joints_;
+
+		/** @brief Names of the contacts */
+		std::vector<std::string> contact_names_;
+
+		/** @brief Defined contact quantities, indexed by point and then contact */
+		std::vector<unsigned char> contact_flags_;
+};
+
+
+/**
+ * @brief The WholeBodyTrajectoryQuery class
+ * This class interpolates a whole-body trajectory at arbitrary times without resampling it,
+ * e.g. a control loop that samples a plan. The segment of a time is found in constant time for
+ * uniformly sampled trajectories, and with a binary search otherwise (see math::TimeIndex).
+ * The base and joint positions are interpolated with cubic Hermite splines of their positions
+ * and velocities (as the interpolation of WholeBodyTrajectoryOptimization), which also define
+ * the velocities and accelerations. The efforts and the contact quantities are interpolated
+ * linearly, where a contact quantity that isn't defined in the end of the segment is held.
+ * Note that the trajectory isn't copied, so it has to outlive the query
+ * @author Carlos Mastalli
+ * @copyright BSD 3-Clause License
+ */
+class WholeBodyTrajectoryQuery
+{
+	public:
+		/** @brief Constructor function */
+		WholeBodyTrajectoryQuery();
+
+		/** @brief Destructor function */
+		~WholeBodyTrajectoryQuery();
+
+		/**
+		 * @brief Resets the queried trajectory, which has to be called every time that its
+		 * times change
+		 * @param const WholeBodyTrajectory& Whole-body trajectory
+		 */
+		void reset(const WholeBodyTrajectory& trajectory);
+
+		/**
+		 * @brief Gets the interpolated whole-body state of a time. The state is only resized
+		 * if its dimension changed
+		 * @param WholeBodyState& Interpolated whole-body state
+		 * @param double Time
+		 * @return False if the time is outside the trajectory, where the state is the first
+		 * or last one
+		 */
+		bool getState(WholeBodyState& state,
+					  double time) const;
+
+		/**
+		 * @brief Gets the segment of a time, i.e. the index of the trajectory point that starts
+		 * it
+		 * @param double Time
+		 */
+		unsigned int getSegment(double time) const;
+
+		/** @brief Gets the time index of the trajectory */
+		const math::TimeIndex& getTimeIndex() const;
+
+
+	private:
+		/** @brief Queried trajectory */
+		const WholeBodyTrajectory* trajectory_;
+
+		/** @brief Time index of the trajectory */
+		math::TimeIndex index_;
+};
+
+
+/**
+ * @brief The ReducedBodyTrajectoryContainer class
+ * This class stores a reduced-body trajectory as a structure of arrays, i.e.
+ * each state quantity is a contiguous matrix where every column is a point of
+ * the trajectory:
+ * <ul>
+ *   <li>time [1 x K]</li>
+ *   <li>com_pos, angular_pos, com_vel, angular_vel, com_acc, angular_acc,
+ *   cop [3 x K]</li>
+ *   <li>support_region, foot_pos, foot_vel, foot_acc [3P x K]</li>
+ * </ul>
+ * where K and P are the number of points and feet, respectively. The feet
+ * are ordered as the feet names given in the resize function.
+ * @author Carlos Mastalli
+ * @copyright BSD 3-Clause License
+ */
+class ReducedBodyTrajectoryContainer
+{
+	public:
+		/** @brief Quantities of a foot that are defined in a point */
+		enum FootQuantity {SUPPORT = 1, POSITION = 2, VELOCITY = 4, ACCELERATION = 8};
+
+		/**
+		 * @brief The StateView class
+		 * This class is a lightweight view of a point of the trajectory, where
+		 * every quantity is a block of the container matrices, so it doesn't
+		 * copy any value. Note that a view is invalidated when the container
+		 * is resized.
+		 */
+		class StateView
+		{
+			public:
+				StateView(ReducedBodyTrajectoryContainer& trajectory,
+						  unsigned int index) : trajectory_(trajectory), index_(index) {}
+
+				double& time() { return trajectory_.time(index_); }
+				Eigen::MatrixXd::ColXpr com_pos() { return trajectory_.com_pos.col(index_); }
+				Eigen::MatrixXd::ColXpr angular_pos() { return trajectory_.angular_pos.col(index_); }
+				Eigen::MatrixXd::ColXpr com_vel() { return trajectory_.com_vel.col(index_); }
+				Eigen::MatrixXd::ColXpr angular_vel() { return trajectory_.angular_vel.col(index_); }
+				Eigen::MatrixXd::ColXpr com_acc() { return trajectory_.com_acc.col(index_); }
+				Eigen::MatrixXd::ColXpr angular_acc() { return trajectory_.angular_acc.col(index_); }
+				Eigen::MatrixXd::ColXpr cop() { return trajectory_.cop.col(index_); }
+				Eigen::Block<Eigen::MatrixXd,3,1> support_region(unsigned int foot) {
+					trajectory_.setFootFlag(index_, foot, SUPPORT);
+					return trajectory_.support_region.block<3,1>(3 * foot, index_);
+				}
+				Eigen::Block<Eigen::MatrixXd,3,1> foot_pos(unsigned int foot) {
+					trajectory_.setFootFlag(index_, foot, POSITION);
+					return trajectory_.foot_pos.block<3,1>(3 * foot, index_);
+				}
+				Eigen::Block<Eigen::MatrixXd,3,1> foot_vel(unsigned int foot) {
+					trajectory_.setFootFlag(index_, foot, VELOCITY);
+					return trajectory_.foot_vel.block<3,1>(3 * foot, index_);
+				}
+				Eigen::Block<Eigen::MatrixXd,3,1> foot_acc(unsigned int foot) {
+					trajectory_.setFootFlag(index_, foot, ACCELERATION);
+					return trajectory_.foot_acc.block<3,1>(3 * foot, index_);
+				}
+
+			private:
+				ReducedBodyTrajectoryContainer& trajectory_;
+				unsigned int index_;
+		};
+
+		/** @brief Constructor function */
+		ReducedBodyTrajectoryContainer();
+
+		/** @brief Destructor function */
+		~ReducedBodyTrajectoryContainer();
+
+		/**
+		 * @brief Resizes the container, where all the values are set to zero and
+		 * the feet are undefined
+		 * @param unsigned int Number of points
+		 * @param const std::vector<std::string>& Names of the feet
+		 */
+		void resize(unsigned int num_points,
+					const std::vector<std::string>& feet_names);
+
+		/** @brief Clears the container */
+		void clear();
+
+		/** @brief Gets the number of points */
+		unsigned int size() const;
+
+		/** @brief Gets the names of the feet */
+		const std::vector<std::string>& getFeetNames() const;
+
+		/**
+		 * @brief Gets the index of a foot
+		 * @param const std::string& Foot name
+		 * @return int Foot index, or -1 if the foot doesn't exist
+		 */
+		int getFootIndex(const std::string& name) const;
+
+		/**
+		 * @brief Indicates if a quantity of a foot is defined in a point
+		 * @param unsigned int Point index
+		 * @param unsigned int Foot index
+		 * @param FootQuantity Foot quantity
+		 */
+		bool hasFoot(unsigned int index,
+					 unsigned int foot,
+					 FootQuantity quantity) const;
+
+		/**
+		 * @brief Gets a view of a point of the trajectory
+		 * @param unsigned int Point index
+		 * @return StateView View of the point
+		 */
+		StateView getView(unsigned int index);
+
+		/**
+		 * @brief Sets a point of the trajectory from a reduced-body state. Note
+		 * that the feet that aren't in the container are ignored
+		 * @param unsigned int Point index
+		 * @param const ReducedBodyState& Reduced-body state
+		 */
+		void setState(unsigned int index,
+					  const ReducedBodyState& state);
+
+		/**
+		 * @brief Gets a point of the trajectory as a reduced-body state
+		 * @param ReducedBodyState& Reduced-body state
+		 * @param unsigned int Point index
+		 */
+		void getState(ReducedBodyState& state,
+					  unsigned int index) const;
+
+		/**
+		 * @brief Sets the container from a reduced-body trajectory, where the
+		 * feet are the ones defined in any point of the trajectory
+		 * @param const ReducedBodyTrajectory& Reduced-body trajectory
+		 */
+		void fromTrajectory(const ReducedBodyTrajectory& trajectory);
+
+		/**
+		 * @brief Gets the container as a reduced-body trajectory
+		 * @param ReducedBodyTrajectory& Reduced-body trajectory
+		 */
+		void toTrajectory(ReducedBodyTrajectory& trajectory) const;
+
+		/** @brief Gets the defined foot quantities, indexed by point and then foot */
+		const std::vector<unsigned char>& getFootFlags() const;
+
+		/** @brief Gets the heap bytes of the container, i.e. of its quantities and flags */
+		std::size_t getHeapBytes() const;
+
+		/** @brief Reduced-body quantities, where every column is a point */
+		Eigen::VectorXd time;
+		Eigen::MatrixXd com_pos;
+		Eigen::MatrixXd angular_pos;
+		Eigen::MatrixXd com_vel;
+		Eigen::MatrixXd angular_vel;
+		Eigen::MatrixXd com_acc;
+		Eigen::MatrixXd angular_acc;
+		Eigen::MatrixXd cop;
+		Eigen::MatrixXd support_region;
+		Eigen::MatrixXd foot_pos;
+		Eigen::MatrixXd foot_vel;
+		Eigen::MatrixXd foot_acc;
+
+
+	private:
+		friend class MappedReducedBodyTrajectory;
+
+		/** @brief Marks a quantity of a foot as defined in a point */
+		void setFootFlag(unsigned int index,
+						 unsigned int foot,
+						 FootQuantity quantity);
+
+		/** @brief Names of the feet */
+		std::vector<std::string> feet_names_;
+
+		/** @brief Defined foot quantities, indexed by point and then foot */
+		std::vector<unsigned char> foot_flags_;
+};
+
+
+/**
+ * @brief Gets the heap bytes of a trajectory, i.e. of its states, in order to compare them
+ * with the ones of the containers
+ * @param const WholeBodyTrajectory& Whole-body trajectory
+ * @return std::size_t Heap bytes
+ */
+std::size_t getHeapBytes(const WholeBodyTrajectory& trajectory);
+
+/**
+ * @brief Gets the heap bytes of a trajectory, i.e. of its states
+ * @param const ReducedBodyTrajectory& Reduced-body trajectory
+ * @return std::size_t Heap bytes
+ */
+std::size_t getHeapBytes(const ReducedBodyTrajectory& trajectory);
+
+} //@namespace dwl
+
+#endif
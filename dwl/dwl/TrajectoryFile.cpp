@@ -0,0 +1,781 @@
+#include <dwl/TrajectoryFile.h>
+#include <dwl/utils/Macros.h>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace dwl
+{
+
+namespace trajectory_file
+{
+/** @brief Alignment of the columns inside the file */
+static const uint64_t ColumnAlignment = 64;
+
+/** @brief Column to be written */
+struct Column
+{
+	Column(const std::string& _name,
+		   unsigned int _rows,
+		   ColumnType _type,
+		   const void* _data,
+		   uint64_t _size) : name(_name), rows(_rows), type(_type), data(_data), size(_size) {}
+
+	std::string name;
+	unsigned int rows;
+	ColumnType type;
+	const void* data;
+	uint64_t size;
+};
+
+/** @brief Rounds up an offset to the alignment of the columns */
+inline uint64_t align(uint64_t offset)
+{
+	return (offset + ColumnAlignment - 1) & ~(ColumnAlignment - 1);
+}
+
+/** @brief Names of the whole-body columns */
+static const char* WholeBodyColumns[] = {"time", "duration", "base_pos", "base_vel",
+		"base_acc", "base_eff", "joint_pos", "joint_vel", "joint_acc", "joint_eff",
+		"contact_pos", "contact_vel", "contact_acc", "contact_eff", "contact_flags"};
+enum WholeBodyColumn {TIME, DURATION, BASE_POS, BASE_VEL, BASE_ACC, BASE_EFF, JOINT_POS,
+		JOINT_VEL, JOINT_ACC, JOINT_EFF, CONTACT_POS, CONTACT_VEL, CONTACT_ACC, CONTACT_EFF,
+		CONTACT_FLAGS, NUM_WHOLE_BODY_COLUMNS};
+
+/** @brief Names of the reduced-body columns */
+static const char* ReducedBodyColumns[] = {"time", "com_pos", "angular_pos", "com_vel",
+		"angular_vel", "com_acc", "angular_acc", "cop", "support_region", "foot_pos",
+		"foot_vel", "foot_acc", "foot_flags"};
+enum ReducedBodyColumn {RB_TIME, COM_POS, ANGULAR_POS, COM_VEL, ANGULAR_VEL, COM_ACC,
+		ANGULAR_ACC, COP, SUPPORT_REGION, FOOT_POS, FOOT_VEL, FOOT_ACC, FOOT_FLAGS,
+		NUM_REDUCED_BODY_COLUMNS};
+
+/** @brief Adds a matrix column, i.e. a column of values per point */
+inline void addColumn(std::vector<Column>& columns,
+					  const char* name,
+					  const Eigen::MatrixXd& matrix)
+{
+	columns.push_back(Column(name, matrix.rows(), DoubleColumn, matrix.data(),
+							 matrix.size() * sizeof(double)));
+}
+
+/** @brief Adds a vector column, i.e. a value per point */
+inline void addColumn(std::vector<Column>& columns,
+					  const char* name,
+					  const Eigen::VectorXd& vector)
+{
+	columns.push_back(Column(name, 1, DoubleColumn, vector.data(),
+							 vector.size() * sizeof(double)));
+}
+
+/**
+ * @brief Writes a trajectory file, i.e. the header, the table of columns, the names and the
+ * aligned columns
+ */
+bool writeFile(const std::string& filename,
+			   TrajectoryKind kind,
+			   unsigned int num_points,
+			   unsigned int num_joints,
+			   const std::vector<std::string>& names,
+			   const std::vector<Column>& columns)
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+	if (file == NULL) {
+		printf(RED "FATAL: the %s trajectory file could not be opened\n" COLOR_RESET,
+				filename.c_str());
+		return false;
+	}
+
+	// Computing the layout of the file
+	std::vector<unsigned char> names_data;
+	for (unsigned int i = 0; i < names.size(); i++) {
+		uint32_t length = names[i].size();
+		names_data.insert(names_data.end(), (unsigned char*) &length,
+						  (unsigned char*) &length + sizeof(length));
+		names_data.insert(names_data.end(), names[i].begin(), names[i].end());
+	}
+	FileHeader header;
+	memcpy(header.magic, Magic, sizeof(header.magic));
+	header.version = Version;
+	header.kind = kind;
+	header.num_points = num_points;
+	header.num_joints = num_joints;
+	header.num_names = names.size();
+	header.num_columns = columns.size();
+	header.columns_offset = sizeof(FileHeader);
+	header.names_offset = header.columns_offset + columns.size() * sizeof(ColumnHeader);
+
+	std::vector<ColumnHeader> table(columns.size());
+	uint64_t offset = align(header.names_offset + names_data.size());
+	for (unsigned int i = 0; i < columns.size(); i++) {
+		memset(table[i].name, 0, sizeof(table[i].name));
+		strncpy(table[i].name, columns[i].name.c_str(), sizeof(table[i].name) - 1);
+		table[i].rows = columns[i].rows;
+		table[i].type = columns[i].type;
+		table[i].offset = offset;
+		table[i].size = columns[i].size;
+		offset = align(offset + columns[i].size);
+	}
+
+	// Writing the file, where the columns are padded to their alignment
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+	written &= fwrite(table.data(), sizeof(ColumnHeader), table.size(), file) == table.size();
+	written &= fwrite(names_data.data(), 1, names_data.size(), file) == names_data.size();
+	std::vector<unsigned char> padding(ColumnAlignment, 0);
+	uint64_t position = header.names_offset + names_data.size();
+	for (unsigned int i = 0; i < columns.size(); i++) {
+		written &= fwrite(padding.data(), 1, table[i].offset - position, file) ==
+				table[i].offset - position;
+		written &= fwrite(columns[i].data, 1, columns[i].size, file) == columns[i].size;
+		position = table[i].offset + columns[i].size;
+	}
+	written &= fclose(file) == 0;
+
+	if (!written)
+		printf(RED "FATAL: the %s trajectory file could not be written\n" COLOR_RESET,
+				filename.c_str());
+
+	return written;
+}
+} //@namespace trajectory_file
+
+
+MappedTrajectoryFile::MappedTrajectoryFile() : data_(NULL), size_(0)
+{
+	memset(&header_, 0, sizeof(header_));
+}
+
+
+MappedTrajectoryFile::~MappedTrajectoryFile()
+{
+	close();
+}
+
+
+void MappedTrajectoryFile::close()
+{
+	if (data_ != NULL)
+		munmap((void*) data_, size_);
+
+	data_ = NULL;
+	size_ = 0;
+	memset(&header_, 0, sizeof(header_));
+	names_.clear();
+	columns_.clear();
+	filename_.clear();
+}
+
+
+bool MappedTrajectoryFile::isOpen() const
+{
+	return data_ != NULL;
+}
+
+
+unsigned int MappedTrajectoryFile::size() const
+{
+	return header_.num_points;
+}
+
+
+bool MappedTrajectoryFile::map(const std::string& filename,
+							   trajectory_file::TrajectoryKind kind)
+{
+	close();
+
+	// Mapping the file
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		printf(RED "FATAL: the %s trajectory file could not be opened\n" COLOR_RESET,
+				filename.c_str());
+		return false;
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 ||
+			file_stat.st_size < (off_t) sizeof(trajectory_file::FileHeader)) {
+		printf(RED "FATAL: the %s file is not a trajectory file\n" COLOR_RESET,
+				filename.c_str());
+		::close(fd);
+		return false;
+	}
+	void* data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		printf(RED "FATAL: the %s trajectory file could not be mapped\n" COLOR_RESET,
+				filename.c_str());
+		return false;
+	}
+	data_ = (const unsigned char*) data;
+	size_ = file_stat.st_size;
+
+	// Reading the header
+	memcpy(&header_, data_, sizeof(header_));
+	if (memcmp(header_.magic, trajectory_file::Magic, sizeof(header_.magic)) != 0 ||
+			header_.version != trajectory_file::Version) {
+		printf(RED "FATAL: the %s file is not a trajectory file of version %u\n"
+				COLOR_RESET, filename.c_str(), trajectory_file::Version);
+		close();
+		return false;
+	}
+	if (header_.kind != (uint32_t) kind) {
+		printf(RED "FATAL: the %s file is not a %s trajectory file\n" COLOR_RESET,
+				filename.c_str(),
+				kind == trajectory_file::WholeBodyKind ? "whole-body" : "reduced-body");
+		close();
+		return false;
+	}
+	uint64_t table_end = header_.columns_offset +
+			(uint64_t) header_.num_columns * sizeof(trajectory_file::ColumnHeader);
+	if (table_end > size_ || header_.names_offset > size_) {
+		printf(RED "FATAL: the %s trajectory file is truncated\n" COLOR_RESET,
+				filename.c_str());
+		close();
+		return false;
+	}
+
+	// Reading the names
+	uint64_t offset = header_.names_offset;
+	for (unsigned int i = 0; i < header_.num_names; i++) {
+		uint32_t length = 0;
+		if (offset + sizeof(length) <= size_)
+			memcpy(&length, data_ + offset, sizeof(length));
+		offset += sizeof(length);
+		if (offset + length > size_) {
+			printf(RED "FATAL: the names of the %s trajectory file are truncated\n"
+					COLOR_RESET, filename.c_str());
+			close();
+			return false;
+		}
+		names_.push_back(std::string((const char*) data_ + offset, length));
+		offset += length;
+	}
+	filename_ = filename;
+
+	return true;
+}
+
+
+bool MappedTrajectoryFile::mapColumns(const char* const* columns,
+									  const unsigned int* rows,
+									  unsigned int num_columns)
+{
+	// Finding the expected columns, and checking their dimensions
+	const trajectory_file::ColumnHeader* table =
+			(const trajectory_file::ColumnHeader*) (data_ + header_.columns_offset);
+	columns_.assign(num_columns, NULL);
+	for (unsigned int c = 0; c < num_columns; c++) {
+		for (unsigned int i = 0; i < header_.num_columns; i++) {
+			if (strncmp(table[i].name, columns[c], sizeof(table[i].name)) != 0)
+				continue;
+
+			uint64_t element_size =
+					table[i].type == trajectory_file::DoubleColumn ? sizeof(double) : 1;
+			if (table[i].rows != rows[c] ||
+					table[i].size != element_size * rows[c] * header_.num_points ||
+					table[i].offset + table[i].size > size_) {
+				printf(RED "FATAL: the %s column of the %s trajectory file is corrupted\n"
+						COLOR_RESET, columns[c], filename_.c_str());
+				close();
+				return false;
+			}
+			columns_[c] = data_ + table[i].offset;
+		}
+
+		if (columns_[c] == NULL) {
+			printf(RED "FATAL: the %s trajectory file doesn't have the %s column\n"
+					COLOR_RESET, filename_.c_str(), columns[c]);
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+const void* MappedTrajectoryFile::getColumn(unsigned int column) const
+{
+	return columns_[column];
+}
+
+
+
+MappedWholeBodyTrajectory::MappedWholeBodyTrajectory()
+{
+
+}
+
+
+MappedWholeBodyTrajectory::~MappedWholeBodyTrajectory()
+{
+
+}
+
+
+bool MappedWholeBodyTrajectory::open(const std::string& filename)
+{
+	using namespace trajectory_file;
+
+	if (!map(filename, WholeBodyKind))
+		return false;
+
+	// Finding the columns, whose dimensions depend on the number of joints and contacts
+	unsigned int num_joints = header_.num_joints;
+	unsigned int num_contacts = header_.num_names;
+	unsigned int rows[NUM_WHOLE_BODY_COLUMNS] = {1, 1, 6, 6, 6, 6, num_joints, num_joints,
+			num_joints, num_joints, 3 * num_contacts, 3 * num_contacts, 3 * num_contacts,
+			6 * num_contacts, num_contacts};
+	return mapColumns(WholeBodyColumns, rows, NUM_WHOLE_BODY_COLUMNS);
+}
+
+
+unsigned int MappedWholeBodyTrajectory::getJointDoF() const
+{
+	return header_.num_joints;
+}
+
+
+const std::vector<std::string>& MappedWholeBodyTrajectory::getContactNames() const
+{
+	return names_;
+}
+
+
+bool MappedWholeBodyTrajectory::hasContact(unsigned int index,
+										   unsigned int contact,
+										   WholeBodyTrajectoryContainer::ContactQuantity quantity) const
+{
+	const unsigned char* flags =
+			(const unsigned char*) getColumn(trajectory_file::CONTACT_FLAGS);
+	return (flags[index * names_.size() + contact] & quantity) != 0;
+}
+
+
+MappedWholeBodyTrajectory::VectorMap MappedWholeBodyTrajectory::time() const
+{
+	return VectorMap((const double*) getColumn(trajectory_file::TIME), size());
+}
+
+
+MappedWholeBodyTrajectory::VectorMap MappedWholeBodyTrajectory::duration() const
+{
+	return VectorMap((const double*) getColumn(trajectory_file::DURATION), size());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::base_pos() const
+{
+	return getMatrix(trajectory_file::BASE_POS, 6);
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::base_vel() const
+{
+	return getMatrix(trajectory_file::BASE_VEL, 6);
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::base_acc() const
+{
+	return getMatrix(trajectory_file::BASE_ACC, 6);
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::base_eff() const
+{
+	return getMatrix(trajectory_file::BASE_EFF, 6);
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::joint_pos() const
+{
+	return getMatrix(trajectory_file::JOINT_POS, getJointDoF());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::joint_vel() const
+{
+	return getMatrix(trajectory_file::JOINT_VEL, getJointDoF());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::joint_acc() const
+{
+	return getMatrix(trajectory_file::JOINT_ACC, getJointDoF());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::joint_eff() const
+{
+	return getMatrix(trajectory_file::JOINT_EFF, getJointDoF());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::contact_pos() const
+{
+	return getMatrix(trajectory_file::CONTACT_POS, 3 * names_.size());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::contact_vel() const
+{
+	return getMatrix(trajectory_file::CONTACT_VEL, 3 * names_.size());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::contact_acc() const
+{
+	return getMatrix(trajectory_file::CONTACT_ACC, 3 * names_.size());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::contact_eff() const
+{
+	return getMatrix(trajectory_file::CONTACT_EFF, 6 * names_.size());
+}
+
+
+void MappedWholeBodyTrajectory::getState(WholeBodyState& state,
+										 unsigned int index) const
+{
+	state.setJointDoF(getJointDoF());
+	state.time = time()(index);
+	state.duration = duration()(index);
+	state.base_pos = base_pos().col(index);
+	state.base_vel = base_vel().col(index);
+	state.base_acc = base_acc().col(index);
+	state.base_eff = base_eff().col(index);
+	state.joint_pos = joint_pos().col(index);
+	state.joint_vel = joint_vel().col(index);
+	state.joint_acc = joint_acc().col(index);
+	state.joint_eff = joint_eff().col(index);
+
+	// Getting the defined contact quantities
+	state.contact_pos.clear();
+	state.contact_vel.clear();
+	state.contact_acc.clear();
+	state.contact_eff.clear();
+	for (unsigned int c = 0; c < names_.size(); c++) {
+		const std::string& name = names_[c];
+		if (hasContact(index, c, WholeBodyTrajectoryContainer::POSITION))
+			state.contact_pos[name] = contact_pos().block<3,1>(3 * c, index);
+		if (hasContact(index, c, WholeBodyTrajectoryContainer::VELOCITY))
+			state.contact_vel[name] = contact_vel().block<3,1>(3 * c, index);
+		if (hasContact(index, c, WholeBodyTrajectoryContainer::ACCELERATION))
+			state.contact_acc[name] = contact_acc().block<3,1>(3 * c, index);
+		if (hasContact(index, c, WholeBodyTrajectoryContainer::EFFORT))
+			state.contact_eff[name] = contact_eff().block<6,1>(6 * c, index);
+	}
+}
+
+
+void MappedWholeBodyTrajectory::toContainer(WholeBodyTrajectoryContainer& trajectory) const
+{
+	trajectory.resize(size(), getJointDoF(), names_);
+	trajectory.time = time();
+	trajectory.duration = duration();
+	trajectory.base_pos = base_pos();
+	trajectory.base_vel = base_vel();
+	trajectory.base_acc = base_acc();
+	trajectory.base_eff = base_eff();
+	trajectory.joint_pos = joint_pos();
+	trajectory.joint_vel = joint_vel();
+	trajectory.joint_acc = joint_acc();
+	trajectory.joint_eff = joint_eff();
+	trajectory.contact_pos = contact_pos();
+	trajectory.contact_vel = contact_vel();
+	trajectory.contact_acc = contact_acc();
+	trajectory.contact_eff = contact_eff();
+
+	const unsigned char* flags =
+			(const unsigned char*) getColumn(trajectory_file::CONTACT_FLAGS);
+	trajectory.contact_flags_.assign(flags, flags + names_.size() * size());
+}
+
+
+MappedWholeBodyTrajectory::MatrixMap MappedWholeBodyTrajectory::getMatrix(unsigned int column,
+																		  unsigned int rows) const
+{
+	return MatrixMap((const double*) getColumn(column), rows, size());
+}
+
+
+
+MappedReducedBodyTrajectory::MappedReducedBodyTrajectory()
+{
+
+}
+
+
+MappedReducedBodyTrajectory::~MappedReducedBodyTrajectory()
+{
+
+}
+
+
+bool MappedReducedBodyTrajectory::open(const std::string& filename)
+{
+	using namespace trajectory_file;
+
+	if (!map(filename, ReducedBodyKind))
+		return false;
+
+	// Finding the columns, whose dimensions depend on the number of feet
+	unsigned int num_feet = header_.num_names;
+	unsigned int rows[NUM_REDUCED_BODY_COLUMNS] = {1, 3, 3, 3, 3, 3, 3, 3, 3 * num_feet,
+			3 * num_feet, 3 * num_feet, 3 * num_feet, num_feet};
+	return mapColumns(ReducedBodyColumns, rows, NUM_REDUCED_BODY_COLUMNS);
+}
+
+
+const std::vector<std::string>& MappedReducedBodyTrajectory::getFeetNames() const
+{
+	return names_;
+}
+
+
+bool MappedReducedBodyTrajectory::hasFoot(unsigned int index,
+										  unsigned int foot,
+										  ReducedBodyTrajectoryContainer::FootQuantity quantity) const
+{
+	const unsigned char* flags =
+			(const unsigned char*) getColumn(trajectory_file::FOOT_FLAGS);
+	return (flags[index * names_.size() + foot] & quantity) != 0;
+}
+
+
+MappedReducedBodyTrajectory::VectorMap MappedReducedBodyTrajectory::time() const
+{
+	return VectorMap((const double*) getColumn(trajectory_file::RB_TIME), size());
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::com_pos() const
+{
+	return getMatrix(trajectory_file::COM_POS, 3);
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::angular_pos() const
+{
+	return getMatrix(trajectory_file::ANGULAR_POS, 3);
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::com_vel() const
+{
+	return getMatrix(trajectory_file::COM_VEL, 3);
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::angular_vel() const
+{
+	return getMatrix(trajectory_file::ANGULAR_VEL, 3);
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::com_acc() const
+{
+	return getMatrix(trajectory_file::COM_ACC, 3);
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::angular_acc() const
+{
+	return getMatrix(trajectory_file::ANGULAR_ACC, 3);
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::cop() const
+{
+	return getMatrix(trajectory_file::COP, 3);
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::support_region() const
+{
+	return getMatrix(trajectory_file::SUPPORT_REGION, 3 * names_.size());
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::foot_pos() const
+{
+	return getMatrix(trajectory_file::FOOT_POS, 3 * names_.size());
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::foot_vel() const
+{
+	return getMatrix(trajectory_file::FOOT_VEL, 3 * names_.size());
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::foot_acc() const
+{
+	return getMatrix(trajectory_file::FOOT_ACC, 3 * names_.size());
+}
+
+
+void MappedReducedBodyTrajectory::getState(ReducedBodyState& state,
+										   unsigned int index) const
+{
+	state.time = time()(index);
+	state.com_pos = com_pos().col(index);
+	state.angular_pos = angular_pos().col(index);
+	state.com_vel = com_vel().col(index);
+	state.angular_vel = angular_vel().col(index);
+	state.com_acc = com_acc().col(index);
+	state.angular_acc = angular_acc().col(index);
+	state.cop = cop().col(index);
+
+	// Getting the defined foot quantities
+	state.support_region.clear();
+	state.foot_pos.clear();
+	state.foot_vel.clear();
+	state.foot_acc.clear();
+	for (unsigned int f = 0; f < names_.size(); f++) {
+		const std::string& name = names_[f];
+		if (hasFoot(index, f, ReducedBodyTrajectoryContainer::SUPPORT))
+			state.support_region[name] = support_region().block<3,1>(3 * f, index);
+		if (hasFoot(index, f, ReducedBodyTrajectoryContainer::POSITION))
+			state.foot_pos[name] = foot_pos().block<3,1>(3 * f, index);
+		if (hasFoot(index, f, ReducedBodyTrajectoryContainer::VELOCITY))
+			state.foot_vel[name] = foot_vel().block<3,1>(3 * f, index);
+		if (hasFoot(index, f, ReducedBodyTrajectoryContainer::ACCELERATION))
+			state.foot_acc[name] = foot_acc().block<3,1>(3 * f, index);
+	}
+}
+
+
+void MappedReducedBodyTrajectory::toContainer(ReducedBodyTrajectoryContainer& trajectory) const
+{
+	trajectory.resize(size(), names_);
+	trajectory.time = time();
+	trajectory.com_pos = com_pos();
+	trajectory.angular_pos = angular_pos();
+	trajectory.com_vel = com_vel();
+	trajectory.angular_vel = angular_vel();
+	trajectory.com_acc = com_acc();
+	trajectory.angular_acc = angular_acc();
+	trajectory.cop = cop();
+	trajectory.support_region = support_region();
+	trajectory.foot_pos = foot_pos();
+	trajectory.foot_vel = foot_vel();
+	trajectory.foot_acc = foot_acc();
+
+	const unsigned char* flags =
+			(const unsigned char*) getColumn(trajectory_file::FOOT_FLAGS);
+	trajectory.foot_flags_.assign(flags, flags + names_.size() * size());
+}
+
+
+MappedReducedBodyTrajectory::MatrixMap MappedReducedBodyTrajectory::getMatrix(unsigned int column,
+																			  unsigned int rows) const
+{
+	return MatrixMap((const double*) getColumn(column), rows, size());
+}
+
+
+
+bool saveTrajectory(const std::string& filename,
+					const WholeBodyTrajectoryContainer& trajectory)
+{
+	using namespace trajectory_file;
+
+	std::vector<Column> columns;
+	addColumn(columns, WholeBodyColumns[TIME], trajectory.time);
+	addColumn(columns, WholeBodyColumns[DURATION], trajectory.duration);
+	addColumn(columns, WholeBodyColumns[BASE_POS], trajectory.base_pos);
+	addColumn(columns, WholeBodyColumns[BASE_VEL], trajectory.base_vel);
+	addColumn(columns, WholeBodyColumns[BASE_ACC], trajectory.base_acc);
+	addColumn(columns, WholeBodyColumns[BASE_EFF], trajectory.base_eff);
+	addColumn(columns, WholeBodyColumns[JOINT_POS], trajectory.joint_pos);
+	addColumn(columns, WholeBodyColumns[JOINT_VEL], trajectory.joint_vel);
+	addColumn(columns, WholeBodyColumns[JOINT_ACC], trajectory.joint_acc);
+	addColumn(columns, WholeBodyColumns[JOINT_EFF], trajectory.joint_eff);
+	addColumn(columns, WholeBodyColumns[CONTACT_POS], trajectory.contact_pos);
+	addColumn(columns, WholeBodyColumns[CONTACT_VEL], trajectory.contact_vel);
+	addColumn(columns, WholeBodyColumns[CONTACT_ACC], trajectory.contact_acc);
+	addColumn(columns, WholeBodyColumns[CONTACT_EFF], trajectory.contact_eff);
+	const std::vector<unsigned char>& flags = trajectory.getContactFlags();
+	columns.push_back(Column(WholeBodyColumns[CONTACT_FLAGS], trajectory.getContactNames().size(),
+							 ByteColumn, flags.data(), flags.size()));
+
+	return writeFile(filename, WholeBodyKind, trajectory.size(), trajectory.getJointDoF(),
+					 trajectory.getContactNames(), columns);
+}
+
+
+bool saveTrajectory(const std::string& filename,
+					const WholeBodyTrajectory& trajectory)
+{
+	WholeBodyTrajectoryContainer container;
+	container.fromTrajectory(trajectory);
+	return saveTrajectory(filename, container);
+}
+
+
+bool saveTrajectory(const std::string& filename,
+					const ReducedBodyTrajectoryContainer& trajectory)
+{
+	using namespace trajectory_file;
+
+	std::vector<Column> columns;
+	addColumn(columns, ReducedBodyColumns[RB_TIME], trajectory.time);
+	addColumn(columns, ReducedBodyColumns[COM_POS], trajectory.com_pos);
+	addColumn(columns, ReducedBodyColumns[ANGULAR_POS], trajectory.angular_pos);
+	addColumn(columns, ReducedBodyColumns[COM_VEL], trajectory.com_vel);
+	addColumn(columns, ReducedBodyColumns[ANGULAR_VEL], trajectory.angular_vel);
+	addColumn(columns, ReducedBodyColumns[COM_ACC], trajectory.com_acc);
+	addColumn(columns, ReducedBodyColumns[ANGULAR_ACC], trajectory.angular_acc);
+	addColumn(columns, ReducedBodyColumns[COP], trajectory.cop);
+	addColumn(columns, ReducedBodyColumns[SUPPORT_REGION], trajectory.support_region);
+	addColumn(columns, ReducedBodyColumns[FOOT_POS], trajectory.foot_pos);
+	addColumn(columns, ReducedBodyColumns[FOOT_VEL], trajectory.foot_vel);
+	addColumn(columns, ReducedBodyColumns[FOOT_ACC], trajectory.foot_acc);
+	const std::vector<unsigned char>& flags = trajectory.getFootFlags();
+	columns.push_back(Column(ReducedBodyColumns[FOOT_FLAGS], trajectory.getFeetNames().size(),
+							 ByteColumn, flags.data(), flags.size()));
+
+	return writeFile(filename, ReducedBodyKind, trajectory.size(), 0,
+					 trajectory.getFeetNames(), columns);
+}
+
+
+bool saveTrajectory(const std::string& filename,
+					const ReducedBodyTrajectory& trajectory)
+{
+	ReducedBodyTrajectoryContainer container;
+	container.fromTrajectory(trajectory);
+	return saveTrajectory(filename, container);
+}
+
+
+bool loadTrajectory(WholeBodyTrajectoryContainer& trajectory,
+					const std::string& filename)
+{
+	MappedWholeBodyTrajectory file;
+	if (!file.open(filename))
+		return false;
+
+	file.toContainer(trajectory);
+	return true;
+}
+
+
+bool loadTrajectory(ReducedBodyTrajectoryContainer& trajectory,
+					const std::string& filename)
+{
+	MappedReducedBodyTrajectory file;
+	if (!file.open(filename))
+		return false;
+
+	file.toContainer(trajectory);
+	return true;
+}
+
+} //@namespace dwl
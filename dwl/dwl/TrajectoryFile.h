@@ -0,0 +1,336 @@
+#ifndef DWL__TRAJECTORY_FILE__H
+#define DWL__TRAJECTORY_FILE__H
+
+#include <dwl/TrajectoryContainer.h>
+#include <stdint.h>
+
+
+namespace dwl
+{
+
+/**
+ * @brief Layout of the trajectory files (version 1). A file starts with a header, which
+ * defines the kind of trajectory, its number of points, joints and contacts (or feet), followed
+ * by a table of columns. Every column is a quantity of the structure of arrays, i.e. a matrix
+ * [rows x K] stored column-major (as the Eigen matrices), so a point is contiguous in every
+ * column, and it's aligned to 64 bytes inside the file. The names of the contacts (or feet) are
+ * a list of length-prefixed strings, and their defined quantities are a column of bytes
+ * [P x K]. So the file is self-described, and it can be read by mapping it in memory, e.g. with
+ * numpy.memmap in Python
+ */
+namespace trajectory_file
+{
+/** @brief Magic number of the files, i.e. "DWLTRAJ" */
+static const char Magic[8] = {'D', 'W', 'L', 'T', 'R', 'A', 'J', '\0'};
+
+/** @brief Version of the format */
+static const uint32_t Version = 1;
+
+/** @brief Kinds of trajectories */
+enum TrajectoryKind {WholeBodyKind = 1, ReducedBodyKind = 2};
+
+/** @brief Types of the column values */
+enum ColumnType {DoubleColumn = 0, ByteColumn = 1};
+
+/** @brief Header of the files */
+struct FileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t kind;
+	uint32_t num_points;
+	uint32_t num_joints;
+	uint32_t num_names;
+	uint32_t num_columns;
+	uint64_t names_offset;
+	uint64_t columns_offset;
+};
+
+/** @brief Entry of the table of columns */
+struct ColumnHeader
+{
+	char name[24];
+	uint32_t rows;
+	uint32_t type;
+	uint64_t offset;
+	uint64_t size;
+};
+} //@namespace trajectory_file
+
+
+/**
+ * @brief The MappedTrajectoryFile class
+ * This class maps a trajectory file in memory, and reads its header, names and table of
+ * columns. The columns are accessed without copying them
+ */
+class MappedTrajectoryFile
+{
+	public:
+		/** @brief Constructor function */
+		MappedTrajectoryFile();
+
+		/** @brief Destructor function, which unmaps the file */
+		virtual ~MappedTrajectoryFile();
+
+		/** @brief Unmaps the file */
+		void close();
+
+		/** @brief Indicates if a file is mapped */
+		bool isOpen() const;
+
+		/** @brief Gets the number of points */
+		unsigned int size() const;
+
+
+	protected:
+		/**
+		 * @brief Maps a file, and reads its header and names
+		 * @param const std::string& File name
+		 * @param trajectory_file::TrajectoryKind Expected kind of trajectory
+		 * @return True if it's a valid trajectory file
+		 */
+		bool map(const std::string& filename,
+				 trajectory_file::TrajectoryKind kind);
+
+		/**
+		 * @brief Finds the expected columns in the mapped file, and checks their dimensions
+		 * @param const char* const* Names of the expected columns
+		 * @param const unsigned int* Rows of the expected columns
+		 * @param unsigned int Number of expected columns
+		 * @return True if all the columns were found
+		 */
+		bool mapColumns(const char* const* columns,
+						const unsigned int* rows,
+						unsigned int num_columns);
+
+		/** @brief Gets a mapped column, in the order of the expected columns */
+		const void* getColumn(unsigned int column) const;
+
+		/** @brief File header */
+		trajectory_file::FileHeader header_;
+
+		/** @brief Names of the contacts or feet */
+		std::vector<std::string> names_;
+
+
+	private:
+		/** @brief Mapped file and its size */
+		const unsigned char* data_;
+		size_t size_;
+
+		/** @brief Mapped columns, in the order of the expected columns */
+		std::vector<const void*> columns_;
+
+		/** @brief Name of the mapped file */
+		std::string filename_;
+};
+
+
+/**
+ * @brief The MappedWholeBodyTrajectory class
+ * This class is a read-only view of a whole-body trajectory file. The quantities are Eigen maps
+ * of the mapped file, so loading a trajectory doesn't copy nor parse its values
+ */
+class MappedWholeBodyTrajectory : public MappedTrajectoryFile
+{
+	public:
+		typedef Eigen::Map<const Eigen::VectorXd> VectorMap;
+		typedef Eigen::Map<const Eigen::MatrixXd> MatrixMap;
+
+		/** @brief Constructor function */
+		MappedWholeBodyTrajectory();
+
+		/** @brief Destructor function */
+		~MappedWholeBodyTrajectory();
+
+		/**
+		 * @brief Maps a whole-body trajectory file
+		 * @param const std::string& File name
+		 * @return True if it's a valid whole-body trajectory file
+		 */
+		bool open(const std::string& filename);
+
+		/** @brief Gets the number of joints */
+		unsigned int getJointDoF() const;
+
+		/** @brief Gets the names of the contacts */
+		const std::vector<std::string>& getContactNames() const;
+
+		/**
+		 * @brief Indicates if a quantity of a contact is defined in a point
+		 * @param unsigned int Point index
+		 * @param unsigned int Contact index
+		 * @param WholeBodyTrajectoryContainer::ContactQuantity Contact quantity
+		 */
+		bool hasContact(unsigned int index,
+						unsigned int contact,
+						WholeBodyTrajectoryContainer::ContactQuantity quantity) const;
+
+		/** @brief Whole-body quantities, where every column is a point */
+		VectorMap time() const;
+		VectorMap duration() const;
+		MatrixMap base_pos() const;
+		MatrixMap base_vel() const;
+		MatrixMap base_acc() const;
+		MatrixMap base_eff() const;
+		MatrixMap joint_pos() const;
+		MatrixMap joint_vel() const;
+		MatrixMap joint_acc() const;
+		MatrixMap joint_eff() const;
+		MatrixMap contact_pos() const;
+		MatrixMap contact_vel() const;
+		MatrixMap contact_acc() const;
+		MatrixMap contact_eff() const;
+
+		/**
+		 * @brief Gets a point of the trajectory as a whole-body state
+		 * @param WholeBodyState& Whole-body state
+		 * @param unsigned int Point index
+		 */
+		void getState(WholeBodyState& state,
+					  unsigned int index) const;
+
+		/**
+		 * @brief Copies the trajectory to a container
+		 * @param WholeBodyTrajectoryContainer& Whole-body trajectory container
+		 */
+		void toContainer(WholeBodyTrajectoryContainer& trajectory) const;
+
+
+	private:
+		/** @brief Gets a mapped matrix */
+		MatrixMap getMatrix(unsigned int column,
+							unsigned int rows) const;
+};
+
+
+/**
+ * @brief The MappedReducedBodyTrajectory class
+ * This class is a read-only view of a reduced-body trajectory file. The quantities are Eigen
+ * maps of the mapped file, so loading a trajectory doesn't copy nor parse its values
+ */
+class MappedReducedBodyTrajectory : public MappedTrajectoryFile
+{
+	public:
+		typedef Eigen::Map<const Eigen::VectorXd> VectorMap;
+		typedef Eigen::Map<const Eigen::MatrixXd> MatrixMap;
+
+		/** @brief Constructor function */
+		MappedReducedBodyTrajectory();
+
+		/** @brief Destructor function */
+		~MappedReducedBodyTrajectory();
+
+		/**
+		 * @brief Maps a reduced-body trajectory file
+		 * @param const std::string& File name
+		 * @return True if it's a valid reduced-body trajectory file
+		 */
+		bool open(const std::string& filename);
+
+		/** @brief Gets the names of the feet */
+		const std::vector<std::string>& getFeetNames() const;
+
+		/**
+		 * @brief Indicates if a quantity of a foot is defined in a point
+		 * @param unsigned int Point index
+		 * @param unsigned int Foot index
+		 * @param ReducedBodyTrajectoryContainer::FootQuantity Foot quantity
+		 */
+		bool hasFoot(unsigned int index,
+					 unsigned int foot,
+					 ReducedBodyTrajectoryContainer::FootQuantity quantity) const;
+
+		/** @brief Reduced-body quantities, where every column is a point */
+		VectorMap time() const;
+		MatrixMap com_pos() const;
+		MatrixMap angular_pos() const;
+		MatrixMap com_vel() const;
+		MatrixMap angular_vel() const;
+		MatrixMap com_acc() const;
+		MatrixMap angular_acc() const;
+		MatrixMap cop() const;
+		MatrixMap support_region() const;
+		MatrixMap foot_pos() const;
+		MatrixMap foot_vel() const;
+		MatrixMap foot_acc() const;
+
+		/**
+		 * @brief Gets a point of the trajectory as a reduced-body state
+		 * @param ReducedBodyState& Reduced-body state
+		 * @param unsigned int Point index
+		 */
+		void getState(ReducedBodyState& state,
+					  unsigned int index) const;
+
+		/**
+		 * @brief Copies the trajectory to a container
+		 * @param ReducedBodyTrajectoryContainer& Reduced-body trajectory container
+		 */
+		void toContainer(ReducedBodyTrajectoryContainer& trajectory) const;
+
+
+	private:
+		/** @brief Gets a mapped matrix */
+		MatrixMap getMatrix(unsigned int column,
+							unsigned int rows) const;
+};
+
+
+/**
+ * @brief Saves a whole-body trajectory in the binary trajectory format
+ * @param const std::string& File name
+ * @param const WholeBodyTrajectoryContainer& Whole-body trajectory container
+ * @return True if the file was written
+ */
+bool saveTrajectory(const std::string& filename,
+					const WholeBodyTrajectoryContainer& trajectory);
+
+/**
+ * @brief Saves a whole-body trajectory in the binary trajectory format
+ * @param const std::string& File name
+ * @param const WholeBodyTrajectory& Whole-body trajectory
+ * @return True if the file was written
+ */
+bool saveTrajectory(const std::string& filename,
+					const WholeBodyTrajectory& trajectory);
+
+/**
+ * @brief Saves a reduced-body trajectory in the binary trajectory format
+ * @param const std::string& File name
+ * @param const ReducedBodyTrajectoryContainer& Reduced-body trajectory container
+ * @return True if the file was written
+ */
+bool saveTrajectory(const std::string& filename,
+					const ReducedBodyTrajectoryContainer& trajectory);
+
+/**
+ * @brief Saves a reduced-body trajectory in the binary trajectory format
+ * @param const std::string& File name
+ * @param const ReducedBodyTrajectory& Reduced-body trajectory
+ * @return True if the file was written
+ */
+bool saveTrajectory(const std::string& filename,
+					const ReducedBodyTrajectory& trajectory);
+
+/**
+ * @brief Loads a whole-body trajectory file into a container
+ * @param WholeBodyTrajectoryContainer& Whole-body trajectory container
+ * @param const std::string& File name
+ * @return True if the file was loaded
+ */
+bool loadTrajectory(WholeBodyTrajectoryContainer& trajectory,
+					const std::string& filename);
+
+/**
+ * @brief Loads a reduced-body trajectory file into a container
+ * @param ReducedBodyTrajectoryContainer& Reduced-body trajectory container
+ * @param const std::string& File name
+ * @return True if the file was loaded
+ */
+bool loadTrajectory(ReducedBodyTrajectoryContainer& trajectory,
+					const std::string& filename);
+
+} //@namespace dwl
+
+#endif
@@ -1,11 +1,17 @@
 #include <dwl/WholeBodyState.h>
+#include <dwl/utils/MemoryUsage.h>
 
 
 namespace dwl
 {
 
+const Eigen::VectorXd WholeBodyState::null_3dvector_ = Eigen::Vector3d::Zero();
+const rbd::Vector6d WholeBodyState::null_6dvector_ = NO_WRENCH;
+
+
 WholeBodyState::WholeBodyState(unsigned int num_joints) :
-		time(0.), duration(0.), num_joints_(num_joints), default_joint_value_(0.)
+		time(0.), duration(0.), num_joints_(num_joints), default_joint_value_(0.),
+		valid_rotations_(false)
 {
 	base_pos.setZero();
 	base_vel.setZero();
@@ -18,9 +24,6 @@ WholeBodyState::WholeBodyState(unsigned int num_joints) :
 		joint_acc.setZero(num_joints_);
 		joint_eff.setZero(num_joints_);
 	}
-
-	null_3dvector_ = Eigen::Vector3d::Zero();
-	null_6dvector_ = NO_WRENCH;
 }
 
 
@@ -66,6 +69,27 @@ Eigen::Vector3d WholeBodyState::getHorizontalRPY() const
 }
 
 
+const Eigen::Matrix3d& WholeBodyState::getBaseToWorldRotation() const
+{
+	updateRotations();
+	return W_rot_B_;
+}
+
+
+const Eigen::Matrix3d& WholeBodyState::getHorizontalToWorldRotation() const
+{
+	updateRotations();
+	return W_rot_H_;
+}
+
+
+const Eigen::Matrix3d& WholeBodyState::getBaseToHorizontalRotation() const
+{
+	updateRotations();
+	return H_rot_B_;
+}
+
+
 Eigen::Vector3d WholeBodyState::getBaseVelocity_W() const
 {
 	return base_vel.segment<3>(rbd::LX);
@@ -74,15 +98,13 @@ Eigen::Vector3d WholeBodyState::getBaseVelocity_W() const
 
 Eigen::Vector3d WholeBodyState::getBaseVelocity_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getBaseVelocity_W(),
-										  getBaseOrientation());
+	return getBaseToWorldRotation().transpose() * getBaseVelocity_W();
 }
 
 
 Eigen::Vector3d WholeBodyState::getBaseVelocity_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getBaseVelocity_W(),
-												getBaseRPY());
+	return getHorizontalToWorldRotation().transpose() * getBaseVelocity_W();
 }
 
 
@@ -94,15 +116,13 @@ Eigen::Vector3d WholeBodyState::getBaseAngularVelocity_W() const
 
 Eigen::Vector3d WholeBodyState::getBaseAngularVelocity_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getBaseAngularVelocity_W(),
-										  getBaseOrientation());
+	return getBaseToWorldRotation().transpose() * getBaseAngularVelocity_W();
 }
 
 
 Eigen::Vector3d WholeBodyState::getBaseAngularVelocity_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getBaseAngularVelocity_W(),
-												getBaseRPY());
+	return getHorizontalToWorldRotation().transpose() * getBaseAngularVelocity_W();
 }
 
 
@@ -122,15 +142,13 @@ Eigen::Vector3d WholeBodyState::getBaseAcceleration_W() const
 
 Eigen::Vector3d WholeBodyState::getBaseAcceleration_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getBaseAcceleration_W(),
-										  getBaseOrientation());
+	return getBaseToWorldRotation().transpose() * getBaseAcceleration_W();
 }
 
 
 Eigen::Vector3d WholeBodyState::getBaseAcceleration_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getBaseAcceleration_W(),
-												getBaseRPY());
+	return getHorizontalToWorldRotation().transpose() * getBaseAcceleration_W();
 }
 
 
@@ -142,15 +160,13 @@ Eigen::Vector3d WholeBodyState::getBaseAngularAcceleration_W() const
 
 Eigen::Vector3d WholeBodyState::getBaseAngularAcceleration_B() const
 {
-	return frame_tf_.fromWorldToBaseFrame(getBaseAngularAcceleration_W(),
-										  getBaseOrientation());
+	return getBaseToWorldRotation().transpose() * getBaseAngularAcceleration_W();
 }
 
 
 Eigen::Vector3d WholeBodyState::getBaseAngularAcceleration_H() const
 {
-	return frame_tf_.fromWorldToHorizontalFrame(getBaseAngularAcceleration_W(),
-												getBaseRPY());
+	return getHorizontalToWorldRotation().transpose() * getBaseAngularAcceleration_W();
 }
 
 
@@ -249,10 +265,40 @@ const unsigned int WholeBodyState::getJointDoF() const
 }
 
 
+void WholeBodyState::getGeneralizedPosition(Eigen::VectorXd& q) const
+{
+	// Note that RBDL defines the floating base state as [linear states, angular states]
+	q.resize(6 + joint_pos.size());
+	q.head<3>() = base_pos.segment<3>(rbd::LX);
+	q.segment<3>(3) = base_pos.segment<3>(rbd::AX);
+	q.tail(joint_pos.size()) = joint_pos;
+}
+
+
+void WholeBodyState::getGeneralizedVelocity(Eigen::VectorXd& qd) const
+{
+	// Note that RBDL defines the floating base state as [linear states, angular states]
+	qd.resize(6 + joint_vel.size());
+	qd.head<3>() = base_vel.segment<3>(rbd::LX);
+	qd.segment<3>(3) = base_vel.segment<3>(rbd::AX);
+	qd.tail(joint_vel.size()) = joint_vel;
+}
+
+
+void WholeBodyState::getGeneralizedAcceleration(Eigen::VectorXd& qdd) const
+{
+	// Note that RBDL defines the floating base state as [linear states, angular states]
+	qdd.resize(6 + joint_acc.size());
+	qdd.head<3>() = base_acc.segment<3>(rbd::LX);
+	qdd.segment<3>(3) = base_acc.segment<3>(rbd::AX);
+	qdd.tail(joint_acc.size()) = joint_acc;
+}
+
+
 Eigen::VectorXd WholeBodyState::getContactPosition_W(ContactIterator pos_it) const
 {
 	return getBasePosition() +
-			frame_tf_.fromBaseToWorldFrame(pos_it->second, getBaseRPY());
+			getBaseToWorldRotation() * pos_it->second;
 }
 
 
@@ -279,6 +325,19 @@ rbd::BodyVectorXd WholeBodyState::getContactPosition_W() const
 }
 
 
+void WholeBodyState::getContactPosition_W(rbd::BodyContainer3d& pos_W) const
+{
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
+	for (unsigned int i = 0; i < pos_W.size(); i++) {
+		ContactIterator contact_it = contact_pos.find(pos_W.getName(i));
+		if (contact_it == contact_pos.end())
+			pos_W[i].setZero();
+		else
+			pos_W[i].noalias() = W_rot_B * contact_it->second + getBasePosition();
+	}
+}
+
+
 const Eigen::VectorXd& WholeBodyState::getContactPosition_B(ContactIterator pos_it) const
 {
 	return pos_it->second;
@@ -301,9 +360,16 @@ const rbd::BodyVectorXd& WholeBodyState::getContactPosition_B() const
 }
 
 
+void WholeBodyState::getContactPosition_B(rbd::BodyContainer3d& pos_B) const
+{
+	for (unsigned int i = 0; i < pos_B.size(); i++)
+		pos_B[i] = getContactPosition_B(pos_B.getName(i));
+}
+
+
 Eigen::VectorXd WholeBodyState::getContactPosition_H(ContactIterator pos_it) const
 {
-	return frame_tf_.fromBaseToHorizontalFrame(pos_it->second, getBaseRPY());
+	return getBaseToHorizontalRotation() * pos_it->second;
 }
 
 
@@ -330,12 +396,25 @@ rbd::BodyVectorXd WholeBodyState::getContactPosition_H() const
 }
 
 
+void WholeBodyState::getContactPosition_H(rbd::BodyContainer3d& pos_H) const
+{
+	const Eigen::Matrix3d& H_rot_B = getBaseToHorizontalRotation();
+	for (unsigned int i = 0; i < pos_H.size(); i++) {
+		ContactIterator contact_it = contact_pos.find(pos_H.getName(i));
+		if (contact_it == contact_pos.end())
+			pos_H[i].setZero();
+		else
+			pos_H[i].noalias() = H_rot_B * contact_it->second;
+	}
+}
+
+
 Eigen::VectorXd WholeBodyState::getContactVelocity_W(ContactIterator vel_it) const
 {
 	// Computing the contact velocity w.r.t. the world frame.
 	// Here we use the equation:
 	// Xd^W_contact = Xd^W_base + Xd^W_contact/base + omega_base x X^W_contact/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(vel_it->first);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getContactVelocity_B(vel_it);
 
@@ -366,6 +445,27 @@ rbd::BodyVectorXd WholeBodyState::getContactVelocity_W() const
 }
 
 
+void WholeBodyState::getContactVelocity_W(rbd::BodyContainer3d& vel_W) const
+{
+	// Computing the contact velocities w.r.t. the world frame as in
+	// getContactVelocity_W(vel_it), where the base quantities are computed once
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
+	Eigen::Vector3d base_vel_W = getBaseVelocity_W();
+	Eigen::Vector3d omega_W = getBaseAngularVelocity_W();
+	for (unsigned int i = 0; i < vel_W.size(); i++) {
+		ContactIterator contact_it = contact_vel.find(vel_W.getName(i));
+		if (contact_it == contact_vel.end()) {
+			vel_W[i].setZero();
+			continue;
+		}
+
+		Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(contact_it->first);
+		vel_W[i].noalias() = base_vel_W + W_rot_B * contact_it->second +
+				omega_W.cross(pos_fb_W);
+	}
+}
+
+
 const Eigen::VectorXd& WholeBodyState::getContactVelocity_B(ContactIterator vel_it) const
 {
 	return vel_it->second;
@@ -394,7 +494,7 @@ Eigen::VectorXd WholeBodyState::getContactVelocity_H(ContactIterator vel_it) con
 	// Here we use the equation:
 	// Xd^W_contact = Xd^W_base + Xd^W_contact/base + omega^W_base x X^W_contact/base
 	std::string name = vel_it->first;
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getContactVelocity_B(vel_it);
 	Eigen::Vector3d vel_W = getBaseVelocity_W() + vel_fb_W +
@@ -405,7 +505,7 @@ Eigen::VectorXd WholeBodyState::getContactVelocity_H(ContactIterator vel_it) con
 	// Xd^W_contact = Xd^W_hor + Xd^W_contact/hor + omega^W_hor x X^W_contact/hor
 	Eigen::Vector3d omega_hor_W(0., 0., getBaseAngularVelocity_W()(rbd::Z));
 	Eigen::Vector3d pos_fh_W =
-			frame_tf_.fromHorizontalToWorldFrame(getContactPosition_H(name), getBaseRPY());
+			getHorizontalToWorldRotation() * getContactPosition_H(name);
 	return vel_W - getBaseVelocity_W() - omega_hor_W.cross(pos_fh_W);
 }
 
@@ -430,6 +530,18 @@ rbd::BodyVectorXd WholeBodyState::getContactVelocity_H() const
 }
 
 
+void WholeBodyState::getContactVelocity_H(rbd::BodyContainer3d& vel_H) const
+{
+	for (unsigned int i = 0; i < vel_H.size(); i++) {
+		ContactIterator contact_it = contact_vel.find(vel_H.getName(i));
+		if (contact_it == contact_vel.end())
+			vel_H[i].setZero();
+		else
+			vel_H[i] = getContactVelocity_H(contact_it);
+	}
+}
+
+
 Eigen::VectorXd WholeBodyState::getContactAcceleration_W(ContactIterator acc_it) const
 {
 	// Computing the skew symmetric matrixes
@@ -443,7 +555,7 @@ Eigen::VectorXd WholeBodyState::getContactAcceleration_W(ContactIterator acc_it)
 	// Xdd^W_contact = Xdd^W_base + [C(wd^W) + C(w^W) * C(w^W)] X^W_contact/base
 	// + 2 C(w^W) Xd^W_contact/base
 	std::string name = acc_it->first;
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getContactVelocity_B(name);
 	return getBaseAcceleration_W() +
@@ -474,6 +586,31 @@ rbd::BodyVectorXd WholeBodyState::getContactAcceleration_W() const
 }
 
 
+void WholeBodyState::getContactAcceleration_W(rbd::BodyContainer3d& acc_W) const
+{
+	// Computing the contact accelerations w.r.t. the world frame as in
+	// getContactAcceleration_W(acc_it), where the base quantities are computed once
+	Eigen::Matrix3d C_omega =
+			math::skewSymmetricMatrixFromVector(getBaseAngularVelocity_W());
+	Eigen::Matrix3d C_omega_dot =
+			math::skewSymmetricMatrixFromVector(getBaseAngularAcceleration_W());
+	Eigen::Matrix3d C_pos = C_omega_dot + C_omega * C_omega;
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
+	Eigen::Vector3d base_acc_W = getBaseAcceleration_W();
+	for (unsigned int i = 0; i < acc_W.size(); i++) {
+		const std::string& name = acc_W.getName(i);
+		if (contact_acc.find(name) == contact_acc.end()) {
+			acc_W[i].setZero();
+			continue;
+		}
+
+		Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
+		Eigen::Vector3d vel_fb_W = W_rot_B * getContactVelocity_B(name);
+		acc_W[i].noalias() = base_acc_W + C_pos * pos_fb_W + 2 * C_omega * vel_fb_W;
+	}
+}
+
+
 const Eigen::VectorXd& WholeBodyState::getContactAcceleration_B(ContactIterator acc_it) const
 {
 	return acc_it->second;
@@ -516,7 +653,7 @@ Eigen::VectorXd WholeBodyState::getContactAcceleration_H(ContactIterator acc_it)
 	// Here we use the equation:
 	// Xdd^W_contact = Xdd^W_base + [C(wd^W_base) + C(w^W_base) * C(w^W_base)] X^W_contact/base
 	// + 2 C(w^W_base) Xd^W_contact/base + Xdd^W_contact/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getContactVelocity_B(name);
 	Eigen::Vector3d acc_W = getBaseVelocity_W() +
@@ -527,7 +664,7 @@ Eigen::VectorXd WholeBodyState::getContactAcceleration_H(ContactIterator acc_it)
 	// Here we use the equation:
 	// Xdd^W_contact = Xdd^W_hor + [C(wd^W_hor) + C(w^W_hor) * C(w^W_hor)] X^W_contact/hor
 	// + 2 C(w^W_hor) Xd^W_contact/hor + Xdd^W_contact/hor
-	Eigen::Matrix3d W_rot_H = frame_tf_.getHorizontalToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_H = getHorizontalToWorldRotation();
 	Eigen::Vector3d pos_fh_W = W_rot_H * getContactPosition_H(name);
 	Eigen::Vector3d vel_fh_W = W_rot_H * getContactVelocity_H(name);
 	return acc_W - getBaseAcceleration_W() -
@@ -559,12 +696,31 @@ rbd::BodyVectorXd WholeBodyState::getContactAcceleration_H() const
 }
 
 
+void WholeBodyState::getContactAcceleration_H(rbd::BodyContainer3d& acc_H) const
+{
+	for (unsigned int i = 0; i < acc_H.size(); i++) {
+		ContactIterator contact_it = contact_acc.find(acc_H.getName(i));
+		if (contact_it == contact_acc.end())
+			acc_H[i].setZero();
+		else
+			acc_H[i] = getContactAcceleration_H(contact_it);
+	}
+}
+
+
 const rbd::BodyVector6d& WholeBodyState::getContactWrench_B() const
 {
 	return contact_eff;
 }
 
 
+void WholeBodyState::getContactWrench_B(rbd::BodyContainer6d& eff_B) const
+{
+	for (unsigned int i = 0; i < eff_B.size(); i++)
+		eff_B[i] = getContactWrench_B(eff_B.getName(i));
+}
+
+
 const rbd::Vector6d& WholeBodyState::getContactWrench_B(const std::string& name) const
 {
 	rbd::BodyVector6d::const_iterator it = contact_eff.find(name);
@@ -619,12 +775,14 @@ void WholeBodyState::setBasePosition(const Eigen::Vector3d& pos)
 void WholeBodyState::setBaseOrientation(const Eigen::Quaterniond& orient)
 {
 	base_pos.topRows<3>() = math::getRPY(orient);
+	valid_rotations_ = false;
 }
 
 
 void WholeBodyState::setBaseRPY(const Eigen::Vector3d& rpy)
 {
 	base_pos.topRows<3>() = rpy;
+	valid_rotations_ = false;
 }
 
 
@@ -637,14 +795,14 @@ void WholeBodyState::setBaseVelocity_W(const Eigen::Vector3d& vel_W)
 void WholeBodyState::setBaseVelocity_B(const Eigen::Vector3d& vel_B)
 {
 	base_vel.topRows<3>() =
-			frame_tf_.fromBaseToWorldFrame(vel_B, getBaseOrientation());
+			getBaseToWorldRotation() * vel_B;
 }
 
 
 void WholeBodyState::setBaseVelocity_H(const Eigen::Vector3d& vel_H)
 {
 	base_vel.bottomRows<3>() =
-			frame_tf_.fromHorizontalToWorldFrame(vel_H, getBaseRPY());
+			getHorizontalToWorldRotation() * vel_H;
 }
 
 
@@ -657,14 +815,14 @@ void WholeBodyState::setBaseAngularVelocity_W(const Eigen::Vector3d& rate_W)
 void WholeBodyState::setBaseAngularVelocity_B(const Eigen::Vector3d& rate_B)
 {
 	base_vel.topRows<3>() =
-			frame_tf_.fromBaseToWorldFrame(rate_B, getBaseOrientation());
+			getBaseToWorldRotation() * rate_B;
 }
 
 
 void WholeBodyState::setBaseAngularVelocity_H(const Eigen::Vector3d& rate_H)
 {
 	base_vel.topRows<3>() =
-			frame_tf_.fromHorizontalToWorldFrame(rate_H, getBaseRPY());
+			getHorizontalToWorldRotation() * rate_H;
 }
 
 
@@ -684,14 +842,14 @@ void WholeBodyState::setBaseAcceleration_W(const Eigen::Vector3d& acc_W)
 void WholeBodyState::setBaseAcceleration_B(const Eigen::Vector3d& acc_B)
 {
 	base_acc.bottomRows<3>() =
-			frame_tf_.fromBaseToWorldFrame(acc_B, getBaseOrientation());
+			getBaseToWorldRotation() * acc_B;
 }
 
 
 void WholeBodyState::setBaseAcceleration_H(const Eigen::Vector3d& acc_H)
 {
 	base_acc.bottomRows<3>() =
-			frame_tf_.fromHorizontalToWorldFrame(acc_H, getBaseRPY());
+			getHorizontalToWorldRotation() * acc_H;
 }
 
 
@@ -704,14 +862,14 @@ void WholeBodyState::setBaseAngularAcceleration_W(const Eigen::Vector3d& rotacc_
 void WholeBodyState::setBaseAngularAcceleration_B(const Eigen::Vector3d& rotacc_B)
 {
 	base_acc.topRows<3>() =
-			frame_tf_.fromBaseToWorldFrame(rotacc_B, getBaseOrientation());
+			getBaseToWorldRotation() * rotacc_B;
 }
 
 
 void WholeBodyState::setBaseAngularAcceleration_H(const Eigen::Vector3d& rotacc_H)
 {
 	base_acc.topRows<3>() =
-			frame_tf_.fromHorizontalToWorldFrame(rotacc_H, getBaseRPY());
+			getHorizontalToWorldRotation() * rotacc_H;
 }
 
 
@@ -816,6 +974,33 @@ void WholeBodyState::setJointEffort(const Eigen::VectorXd& eff)
 }
 
 
+void WholeBodyState::setGeneralizedPosition(const Eigen::VectorXd& q)
+{
+	assert(q.size() >= 6);
+	base_pos.segment<3>(rbd::LX) = q.head<3>();
+	base_pos.segment<3>(rbd::AX) = q.segment<3>(3);
+	joint_pos = q.tail(q.size() - 6);
+}
+
+
+void WholeBodyState::setGeneralizedVelocity(const Eigen::VectorXd& qd)
+{
+	assert(qd.size() >= 6);
+	base_vel.segment<3>(rbd::LX) = qd.head<3>();
+	base_vel.segment<3>(rbd::AX) = qd.segment<3>(3);
+	joint_vel = qd.tail(qd.size() - 6);
+}
+
+
+void WholeBodyState::setGeneralizedAcceleration(const Eigen::VectorXd& qdd)
+{
+	assert(qdd.size() >= 6);
+	base_acc.segment<3>(rbd::LX) = qdd.head<3>();
+	base_acc.segment<3>(rbd::AX) = qdd.segment<3>(3);
+	joint_acc = qdd.tail(qdd.size() - 6);
+}
+
+
 void WholeBodyState::setContactPosition_W(ContactIterator it)
 {
 	setContactPosition_W(it->first, it->second);
@@ -826,8 +1011,7 @@ void WholeBodyState::setContactPosition_W(const std::string& name,
 										  const Eigen::VectorXd& pos_W)
 {
 	contact_pos[name] =
-			frame_tf_.fromWorldToBaseFrame(pos_W - getBasePosition(),
-										   getBaseRPY());
+			getBaseToWorldRotation().transpose() * (pos_W - getBasePosition());
 }
 
 
@@ -858,6 +1042,13 @@ void WholeBodyState::setContactPosition_B(const rbd::BodyVectorXd& pos_B)
 }
 
 
+void WholeBodyState::setContactPosition_B(const rbd::BodyContainer3d& pos_B)
+{
+	for (unsigned int i = 0; i < pos_B.size(); i++)
+		contact_pos[pos_B.getName(i)] = pos_B[i];
+}
+
+
 void WholeBodyState::setContactPosition_H(ContactIterator it)
 {
 	setContactPosition_H(it->first, it->second);
@@ -868,7 +1059,7 @@ void WholeBodyState::setContactPosition_H(const std::string& name,
 										  const Eigen::VectorXd& pos_H)
 {
 	contact_pos[name] =
-			frame_tf_.fromHorizontalToBaseFrame(pos_H, getBaseRPY());
+			getBaseToHorizontalRotation().transpose() * pos_H;
 }
 
 
@@ -892,7 +1083,7 @@ void WholeBodyState::setContactVelocity_W(const std::string& name,
 	// Computing the contact velocity w.r.t. the base but expressed in the world
 	// frame. Here we use the equation:
 	// Xd^W_contact = Xd^W_base + Xd^W_contact/base + omega_base x X^W_contact/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
 	Eigen::Vector3d vel_fb_W = vel_W - getBaseVelocity_W() -
 			getBaseAngularVelocity_W().cross(pos_fb_W);
@@ -929,6 +1120,13 @@ void WholeBodyState::setContactVelocity_B(const rbd::BodyVectorXd& vel_B)
 }
 
 
+void WholeBodyState::setContactVelocity_B(const rbd::BodyContainer3d& vel_B)
+{
+	for (unsigned int i = 0; i < vel_B.size(); i++)
+		contact_vel[vel_B.getName(i)] = vel_B[i];
+}
+
+
 void WholeBodyState::setContactVelocity_H(ContactIterator it)
 {
 	setContactVelocity_H(it->first, it->second);
@@ -941,7 +1139,7 @@ void WholeBodyState::setContactVelocity_H(const std::string& name,
 	// Computing the contact velocity w.r.t. the world frame.
 	// Here we use the equation:
 	// Xd^W_contact = Xd^W_hor + Xd^W_contact/hor + omega^W_hor x X^W_contact/hor
-	Eigen::Matrix3d W_rot_H = frame_tf_.getHorizontalToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_H = getHorizontalToWorldRotation();
 	Eigen::Vector3d pos_fh_W = W_rot_H * getContactPosition_H(name);
 	Eigen::Vector3d vel_fh_W = W_rot_H * vel_H;
 	Eigen::Vector3d omega_h_W(0., 0., getBaseAngularVelocity_W()(rbd::Z));
@@ -950,7 +1148,7 @@ void WholeBodyState::setContactVelocity_H(const std::string& name,
 	// Computing the contact velocity w.r.t. the base but expressed in the world
 	// frame. Here we use the equation:
 	// Xd^W_contact = Xd^W_base + Xd^W_contact/base + omega^W_base x X^W_contact/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
 	Eigen::Vector3d vel_fb_W = vel_W - getBaseVelocity_W() -
 			getBaseAngularVelocity_W().cross(pos_fb_W);
@@ -987,7 +1185,7 @@ void WholeBodyState::setContactAcceleration_W(const std::string& name,
 	// world frame. Here we use the equation:
 	// Xdd^W_contact = Xdd^W_base + [C(wd^W) + C(w^W) * C(w^W)] X^W_contact/base
 	// + 2 C(w^W) Xd^W_contact/base + Xdd^W_contact/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getContactVelocity_B(name);
 	Eigen::Vector3d acc_fb_W = acc_W - getBaseAcceleration_W() -
@@ -1027,6 +1225,13 @@ void WholeBodyState::setContactAcceleration_B(const rbd::BodyVectorXd& acc_B)
 }
 
 
+void WholeBodyState::setContactAcceleration_B(const rbd::BodyContainer3d& acc_B)
+{
+	for (unsigned int i = 0; i < acc_B.size(); i++)
+		contact_acc[acc_B.getName(i)] = acc_B[i];
+}
+
+
 void WholeBodyState::setContactAcceleration_H(ContactIterator acc_it)
 {
 	setContactAcceleration_H(acc_it->first, acc_it->second);
@@ -1052,7 +1257,7 @@ void WholeBodyState::setContactAcceleration_H(const std::string& name,
 	// Here we use the equation:
 	// Xdd^W_contact = Xdd^W_hor + [C(wd^W_hor) + C(w^W_hor) * C(w^W_hor)] X^W_contact/hor
 	// + 2 C(w^W_hor) Xd^W_contact/hor + Xdd^W_contact/hor
-	Eigen::Matrix3d W_rot_H = frame_tf_.getHorizontalToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_H = getHorizontalToWorldRotation();
 	Eigen::Vector3d pos_fh_W = W_rot_H * getContactPosition_H(name);
 	Eigen::Vector3d vel_fh_W = W_rot_H * getContactVelocity_H(name);
 	Eigen::Vector3d acc_fh_W = W_rot_H * acc_H;
@@ -1065,7 +1270,7 @@ void WholeBodyState::setContactAcceleration_H(const std::string& name,
 	// world frame. Here we use the equation:
 	// Xdd^W_contact = Xdd^W_base + [C(wd^W) + C(w^W) * C(w^W)] X^W_contact/base
 	// + 2 C(w^W) Xd^W_contact/base + Xdd^W_contact/base
-	Eigen::Matrix3d W_rot_B = frame_tf_.getBaseToWorldRotation(getBaseRPY());
+	const Eigen::Matrix3d& W_rot_B = getBaseToWorldRotation();
 	Eigen::Vector3d pos_fb_W = W_rot_B * getContactPosition_B(name);
 	Eigen::Vector3d vel_fb_W = W_rot_B * getContactVelocity_B(name);
 	Eigen::Vector3d acc_fb_W =
@@ -1094,6 +1299,13 @@ void WholeBodyState::setContactWrench_B(const rbd::BodyVector6d& eff)
 }
 
 
+void WholeBodyState::setContactWrench_B(const rbd::BodyContainer6d& eff)
+{
+	for (unsigned int i = 0; i < eff.size(); i++)
+		contact_eff[eff.getName(i)] = eff[i];
+}
+
+
 void WholeBodyState::setContactWrench_B(const std::string& name,
 									    const rbd::Vector6d& eff)
 {
@@ -1110,4 +1322,31 @@ void WholeBodyState::setContactCondition(const std::string& name,
 		contact_eff[name] = INACTIVE_CONTACT;
 }
 
+
+std::size_t WholeBodyState::getHeapBytes() const
+{
+	return utils::getHeapBytes(joint_pos) + utils::getHeapBytes(joint_vel) +
+			utils::getHeapBytes(joint_acc) + utils::getHeapBytes(joint_eff) +
+			utils::getHeapBytes(contact_pos) + utils::getHeapBytes(contact_vel) +
+			utils::getHeapBytes(contact_acc) + utils::getHeapBytes(contact_eff);
+}
+
+
+void WholeBodyState::updateRotations() const
+{
+	// Note that the base states are public, so the cache is also checked against the
+	// RPY angles
+	Eigen::Vector3d rpy = getBaseRPY();
+	if (valid_rotations_ && rpy == rotation_rpy_)
+		return;
+
+	rotation_rpy_ = rpy;
+	// Note that the horizontal rotation is extracted from the base one, so the
+	// trigonometric functions are computed once
+	W_rot_B_ = math::getRotationMatrix(rpy);
+	W_rot_H_ = math::getYawRotationMatrix(rpy(2));
+	H_rot_B_.noalias() = W_rot_H_.transpose() * W_rot_B_;
+	valid_rotations_ = true;
+}
+
 } //@namespace dwl
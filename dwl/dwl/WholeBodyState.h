@@ -80,6 +80,16 @@ class WholeBodyState
 		/** @brief Destructor function */
 		~WholeBodyState();
 
+		/**
+		 * @brief Copy and move functions. Note that the declared destructor suppresses the
+		 * implicit moves, so they are defaulted explicitly, i.e. moving a state (e.g. when a
+		 * trajectory grows) doesn't allocate memory
+		 */
+		WholeBodyState(const WholeBodyState& other) = default;
+		WholeBodyState(WholeBodyState&& other) = default;
+		WholeBodyState& operator=(const WholeBodyState& other) = default;
+		WholeBodyState& operator=(WholeBodyState&& other) = default;
+
 		// Time getter function
 		/** @brief Gets the time value
 		 * @return The time value
@@ -112,6 +122,23 @@ class WholeBodyState
 		 */
 		Eigen::Vector3d getHorizontalRPY() const;
 
+		/** @brief Gets the rotation matrix from the base to the world frame.
+		 * The rotations are cached while the base RPY angles don't change, so
+		 * the const getters shouldn't be called concurrently on the same state
+		 * @return The rotation matrix from the base to the world frame
+		 */
+		const Eigen::Matrix3d& getBaseToWorldRotation() const;
+
+		/** @brief Gets the rotation matrix from the horizontal to the world frame
+		 * @return The rotation matrix from the horizontal to the world frame
+		 */
+		const Eigen::Matrix3d& getHorizontalToWorldRotation() const;
+
+		/** @brief Gets the rotation matrix from the base to the horizontal frame
+		 * @return The rotation matrix from the base to the horizontal frame
+		 */
+		const Eigen::Matrix3d& getBaseToHorizontalRotation() const;
+
 		/** @brief Gets the base velocity expressed in the world frame
 		 * @return The base velocity expressed in the world frame
 		 */
@@ -233,6 +260,23 @@ class WholeBodyState
 		 */
 		const unsigned int getJointDoF() const;
 
+		/** @brief Gets the generalized position of a fully floating-base system, i.e.
+		 * with the RBDL order [linear base, angular base, joint]. It's written in a
+		 * caller-owned buffer, which isn't reallocated if it has the same dimension
+		 * @param[out] q The generalized position
+		 */
+		void getGeneralizedPosition(Eigen::VectorXd& q) const;
+
+		/** @brief Gets the generalized velocity of a fully floating-base system
+		 * @param[out] qd The generalized velocity
+		 */
+		void getGeneralizedVelocity(Eigen::VectorXd& qd) const;
+
+		/** @brief Gets the generalized acceleration of a fully floating-base system
+		 * @param[out] qdd The generalized acceleration
+		 */
+		void getGeneralizedAcceleration(Eigen::VectorXd& qdd) const;
+
 
 		// Contact state getter functions
 		/** @brief Gets the contact position expressed the world frame
@@ -252,6 +296,12 @@ class WholeBodyState
 		 */
 		rbd::BodyVectorXd getContactPosition_W() const;
 
+		/** @brief Gets the contact positions expressed in the world frame
+		 * @param[out] pos_W The contact positions indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactPosition_W(rbd::BodyContainer3d& pos_W) const;
+
 		/** @brief Gets the contact position expressed the base frame
 		 * @param[in] pos_it The contact position iterator
 		 * @return The contact position expressed in the base frame
@@ -269,6 +319,12 @@ class WholeBodyState
 		 */
 		const rbd::BodyVectorXd& getContactPosition_B() const;
 
+		/** @brief Gets the contact positions expressed in the base frame
+		 * @param[out] pos_B The contact positions indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactPosition_B(rbd::BodyContainer3d& pos_B) const;
+
 		/** @brief Gets the contact position expressed the horizontal frame
 		 * @param[in] pos_it The contact position iterator
 		 * @return The contact position expressed in the horizontal frame
@@ -286,6 +342,12 @@ class WholeBodyState
 		 */
 		rbd::BodyVectorXd getContactPosition_H() const;
 
+		/** @brief Gets the contact positions expressed in the horizontal frame
+		 * @param[out] pos_H The contact positions indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactPosition_H(rbd::BodyContainer3d& pos_H) const;
+
 		/** @brief Gets the contact velocity expressed the world frame
 		 * @param[in] vel_it The contact velocity iterator
 		 * @return The contact velocity expressed in the world frame
@@ -303,6 +365,12 @@ class WholeBodyState
 		 */
 		rbd::BodyVectorXd getContactVelocity_W() const;
 
+		/** @brief Gets the contact velocitys expressed in the world frame
+		 * @param[out] vel_W The contact velocitys indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactVelocity_W(rbd::BodyContainer3d& vel_W) const;
+
 		/** @brief Gets the contact velocity expressed the base frame
 		 * @param[in] vel_it The contact velocity iterator
 		 * @return The contact velocity expressed in the base frame
@@ -337,6 +405,12 @@ class WholeBodyState
 		 */
 		rbd::BodyVectorXd getContactVelocity_H() const;
 
+		/** @brief Gets the contact velocitys expressed in the horizontal frame
+		 * @param[out] vel_H The contact velocitys indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactVelocity_H(rbd::BodyContainer3d& vel_H) const;
+
 		/** @brief Gets the contact acceleration expressed the world frame
 		 * @param[in] acc_it The contact acceleration iterator
 		 * @return The contact acceleration expressed in the world frame
@@ -354,6 +428,12 @@ class WholeBodyState
 		 */
 		rbd::BodyVectorXd getContactAcceleration_W() const;
 
+		/** @brief Gets the contact accelerations expressed in the world frame
+		 * @param[out] acc_W The contact accelerations indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactAcceleration_W(rbd::BodyContainer3d& acc_W) const;
+
 		/** @brief Gets the contact acceleration expressed the base frame
 		 * @param[in] acc_it The contact acceleration iterator
 		 * @return The contact acceleration expressed in the base frame
@@ -388,6 +468,12 @@ class WholeBodyState
 		 */
 		rbd::BodyVectorXd getContactAcceleration_H() const;
 
+		/** @brief Gets the contact accelerations expressed in the horizontal frame
+		 * @param[out] acc_H The contact accelerations indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactAcceleration_H(rbd::BodyContainer3d& acc_H) const;
+
 		/** @brief Gets the contact wrench expressed the base frame
 		 * @param[in] name The contact name
 		 * @return The contact wrench expressed in the base frame
@@ -399,6 +485,12 @@ class WholeBodyState
 		 */
 		const rbd::BodyVector6d& getContactWrench_B() const;
 
+		/** @brief Gets the contact wrenches expressed in the base frame
+		 * @param[out] eff_B The contact wrenches indexed by a body container.
+		 * The container has to be reset with the contact names beforehand
+		 */
+		void getContactWrench_B(rbd::BodyContainer6d& eff_B) const;
+
 		/** @brief Gets the contact condition (active or inactive)
 		 * @param[in] name The contact name
 		 * @param[in] threshold Force threshold for detecting contact condition
@@ -554,6 +646,24 @@ class WholeBodyState
 		void setJointEffort(const double& eff,
 							const unsigned int& index);
 
+		/** @brief Sets the base and joint positions from the generalized position of a
+		 * fully floating-base system
+		 * @param[in] q The generalized position
+		 */
+		void setGeneralizedPosition(const Eigen::VectorXd& q);
+
+		/** @brief Sets the base and joint velocities from the generalized velocity of a
+		 * fully floating-base system
+		 * @param[in] qd The generalized velocity
+		 */
+		void setGeneralizedVelocity(const Eigen::VectorXd& qd);
+
+		/** @brief Sets the base and joint accelerations from the generalized acceleration
+		 * of a fully floating-base system
+		 * @param[in] qdd The generalized acceleration
+		 */
+		void setGeneralizedAcceleration(const Eigen::VectorXd& qdd);
+
 		/** @brief Sets the number of joints
 		 * @param[in] num_joints Number of joints
 		 */
@@ -594,6 +704,11 @@ class WholeBodyState
 		 * @param[in] pos_B All contact positions
 		 */
 		void setContactPosition_B(const rbd::BodyVectorXd& pos_B);
+
+		/** @brief Sets all contact positions expressed the base frame
+		 * @param[in] pos_B All contact positions indexed by a body container
+		 */
+		void setContactPosition_B(const rbd::BodyContainer3d& pos_B);
 		
 		/** @brief Sets the contact position expressed the horizontal frame
 		 * @param[in] pos_it The contact position iterator
@@ -646,6 +761,11 @@ class WholeBodyState
 		 */
 		void setContactVelocity_B(const rbd::BodyVectorXd& vel_B);
 
+		/** @brief Sets all contact velocities expressed the base frame
+		 * @param[in] vel_B All contact velocities indexed by a body container
+		 */
+		void setContactVelocity_B(const rbd::BodyContainer3d& vel_B);
+
 		/** @brief Sets the contact velocity expressed the horizontal frame
 		 * @param[in] vel_it The contact velocity
 		 */
@@ -697,6 +817,11 @@ class WholeBodyState
 		 */
 		void setContactAcceleration_B(const rbd::BodyVectorXd& acc_B);
 
+		/** @brief Sets all contact accelerations expressed the base frame
+		 * @param[in] acc_B All contact accelerations indexed by a body container
+		 */
+		void setContactAcceleration_B(const rbd::BodyContainer3d& acc_B);
+
 		/** @brief Sets the contact acceleration expressed the horizontal frame
 		 * @param[in] acc_it The contact acceleration iterator
 		 */
@@ -726,6 +851,11 @@ class WholeBodyState
 		 */
 		void setContactWrench_B(const rbd::BodyVector6d& eff_B);
 
+		/** @brief Sets all contact wrenches expressed the base frame
+		 * @param[in] eff_B All contact wrenches indexed by a body container
+		 */
+		void setContactWrench_B(const rbd::BodyContainer6d& eff_B);
+
 		/** @brief Sets the contact condition (active or inactive)
 		 * @param name The contact name
 		 * @param condition True for active conditions, and false for inactive
@@ -733,6 +863,12 @@ class WholeBodyState
 		void setContactCondition(const std::string& name,
 								 const bool& condition);
 
+		/**
+		 * @brief Gets the heap bytes of the state, i.e. of its joint and contact states
+		 * @return std::size_t Heap bytes
+		 */
+		std::size_t getHeapBytes() const;
+
 		/** @brief Internal whole-body state variables expressed with the
 		 * above mentioned convention */
 		double time;
@@ -755,15 +891,24 @@ class WholeBodyState
 		/** @brief Number of joints */
 		unsigned int num_joints_;
 
-		/** @brief Frame transformations */
-		math::FrameTF frame_tf_;
-
 		/** @brief Default value for joint states that don't exist */
 		double default_joint_value_;
 
-		/** @brief Null vectors for missed contact states */
-		Eigen::VectorXd null_3dvector_;
-		rbd::Vector6d null_6dvector_;
+		/** @brief Null vectors for missed contact states, which are shared by all the states */
+		static const Eigen::VectorXd null_3dvector_;
+		static const rbd::Vector6d null_6dvector_;
+
+		/** @brief Updates the cached rotations if the base RPY angles changed */
+		void updateRotations() const;
+
+		/** @brief Cached rotations of the base and horizontal frames, and the
+		 * RPY angles used for computing them. Note that the base states could be
+		 * modified directly, so the cache is also checked against the angles */
+		mutable Eigen::Vector3d rotation_rpy_;
+		mutable Eigen::Matrix3d W_rot_B_;
+		mutable Eigen::Matrix3d W_rot_H_;
+		mutable Eigen::Matrix3d H_rot_B_;
+		mutable bool valid_rotations_;
 };
 
 /** @brief Defines a whole-body trajectory */
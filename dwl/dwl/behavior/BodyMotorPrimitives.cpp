@@ -46,6 +46,10 @@ void BodyMotorPrimitives::read(std::string filename)
 void BodyMotorPrimitives::generateActions(std::vector<Action3d>& actions,
 										  Pose3d state)
 {
+	// The rotation is the same for every action
+	double cos_yaw = cos(state.orientation);
+	double sin_yaw = sin(state.orientation);
+	actions.reserve(actions.size() + actions_.size());
 	for (unsigned int i = 0; i < actions_.size(); i++) {
 		// Computing the motor action
 		double delta_x = actions_[i].action(rbd::X);
@@ -55,11 +59,9 @@ void BodyMotorPrimitives::generateActions(std::vector<Action3d>& actions,
 		// Computing the current action
 		Action3d current_action;
 		current_action.pose.position(rbd::X) = state.position(rbd::X)
-				+ delta_x * cos(state.orientation)
-				- delta_y * sin(state.orientation);
+				+ delta_x * cos_yaw - delta_y * sin_yaw;
 		current_action.pose.position(rbd::Y) = state.position(rbd::Y)
-				+ delta_x * sin(state.orientation)
-				+ delta_y * cos(state.orientation);
+				+ delta_x * sin_yaw + delta_y * cos_yaw;
 		current_action.pose.orientation = state.orientation + delta_th;
 		current_action.cost = actions_[i].cost;
 
@@ -0,0 +1,202 @@
+#include <dwl/environment/CostToGoField.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <dwl/utils/IndexedHeap.h>
+#include <dwl/utils/RadixHeap.h>
+#include <algorithm>
+#include <limits.h>
+#include <limits>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+CostToGoField::CostToGoField() : space_discretization_(NULL), size_x_(0), size_y_(0),
+		margin_(1.), cost_quantum_(0.)
+{
+
+}
+
+
+CostToGoField::~CostToGoField()
+{
+
+}
+
+
+void CostToGoField::setMargin(double margin)
+{
+	margin_ = margin;
+}
+
+
+void CostToGoField::setCostQuantum(double quantum)
+{
+	cost_quantum_ = std::max(quantum, 0.);
+}
+
+
+void CostToGoField::compute(const TerrainMap& terrain,
+							const Eigen::Vector2d& goal,
+							const Eigen::Vector2d& start,
+							double unknown_cost,
+							double cost_offset)
+{
+	clear();
+	space_discretization_ = &terrain.getTerrainSpaceModel();
+	double resolution = space_discretization_->getEnvironmentResolution(true);
+
+	// Computing the region of the terrain cells, the goal and the start
+	Key goal_key, start_key;
+	if (!space_discretization_->coordToKeyChecked(goal_key.x, goal(rbd::X), true) ||
+			!space_discretization_->coordToKeyChecked(goal_key.y, goal(rbd::Y), true)) {
+		printf(YELLOW "Warning: could not compute the cost-to-go field because the goal is"
+				" outside the environment\n" COLOR_RESET);
+		return;
+	}
+
+	CellRegion region;
+	region.add(goal_key);
+	if (space_discretization_->coordToKeyChecked(start_key.x, start(rbd::X), true) &&
+			space_discretization_->coordToKeyChecked(start_key.y, start(rbd::Y), true))
+		region.add(start_key);
+
+	const TerrainDataMap& terrain_map = terrain.getTerrainDataMap();
+	for (TerrainDataMap::const_iterator cell_it = terrain_map.begin();
+			cell_it != terrain_map.end(); cell_it++) {
+		Key key;
+		space_discretization_->vertexToKey(key, cell_it->first, true);
+		region.add(key);
+	}
+
+	int padding = (int) ceil(margin_ / resolution);
+	region.add(Key(std::max((int) region.min_key.x - padding, 0),
+				   std::max((int) region.min_key.y - padding, 0), 0));
+	region.add(Key(std::min((int) region.max_key.x + padding, USHRT_MAX),
+				   std::min((int) region.max_key.y + padding, USHRT_MAX), 0));
+
+	region_ = region;
+	size_x_ = region_.max_key.x - region_.min_key.x + 1;
+	size_y_ = region_.max_key.y - region_.min_key.y + 1;
+	unsigned int num_cells = size_x_ * size_y_;
+
+	// Getting the cost of every cell, i.e. its cost per meter
+	std::vector<double> cell_cost(num_cells);
+	for (unsigned int y = 0; y < size_y_; y++) {
+		for (unsigned int x = 0; x < size_x_; x++) {
+			Vertex vertex;
+			Key key(region_.min_key.x + x, region_.min_key.y + y, 0);
+			space_discretization_->keyToVertex(vertex, key, true);
+
+			Weight cost;
+			if (!terrain.getTerrainCost(cost, vertex))
+				cost = unknown_cost;
+			cell_cost[y * size_x_ + x] = cost + cost_offset;
+		}
+	}
+
+	// Computing the backward search from the goal. Note that the edge from a cell to its
+	// neighbor has the cost of the neighbor, so the search relaxes the predecessors. In the
+	// quantized-cost mode, the decreased costs are queued again and the outdated entries are
+	// skipped
+	bool quantized = cost_quantum_ > 0.;
+	cost_to_go_.assign(num_cells, std::numeric_limits<double>::max());
+	IndexedHeap<> heap(quantized ? 0 : num_cells);
+	RadixHeap<std::pair<unsigned int,double> > bucket_heap;
+	unsigned int goal_idx = (goal_key.y - region_.min_key.y) * size_x_ +
+			(goal_key.x - region_.min_key.x);
+	cost_to_go_[goal_idx] = 0.;
+	if (quantized)
+		bucket_heap.push(0, std::make_pair(goal_idx, 0.));
+	else
+		heap.push(goal_idx, 0.);
+
+	const int dx[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+	const int dy[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+	const double length[8] = {resolution, resolution, resolution, resolution,
+			sqrt(2.) * resolution, sqrt(2.) * resolution,
+			sqrt(2.) * resolution, sqrt(2.) * resolution};
+	while (quantized ? !bucket_heap.empty() : !heap.empty()) {
+		unsigned int current;
+		double current_cost;
+		if (quantized) {
+			current = bucket_heap.top().first;
+			current_cost = bucket_heap.top().second;
+			bucket_heap.pop();
+			if (current_cost != cost_to_go_[current])
+				continue;
+		} else {
+			current = heap.top();
+			current_cost = heap.topPriority();
+			heap.pop();
+		}
+
+		int x = current % size_x_, y = current / size_x_;
+		for (unsigned int i = 0; i < 8; i++) {
+			int nx = x + dx[i], ny = y + dy[i];
+			if (nx < 0 || ny < 0 || nx >= (int) size_x_ || ny >= (int) size_y_)
+				continue;
+
+			unsigned int neighbor = ny * size_x_ + nx;
+			double cost = current_cost + length[i] * cell_cost[current];
+			if (cost < cost_to_go_[neighbor]) {
+				cost_to_go_[neighbor] = cost;
+				if (quantized)
+					bucket_heap.push((RadixHeap<std::pair<unsigned int,double> >::Key)
+							(cost / cost_quantum_ + 0.5), std::make_pair(neighbor, cost));
+				else
+					heap.push(neighbor, cost);
+			}
+		}
+	}
+}
+
+
+void CostToGoField::clear()
+{
+	cost_to_go_.clear();
+	region_ = CellRegion();
+	size_x_ = size_y_ = 0;
+}
+
+
+bool CostToGoField::getCost(double& cost,
+							const Eigen::Vector2d& position) const
+{
+	int index = getIndex(position);
+	if (index < 0)
+		return false;
+
+	cost = cost_to_go_[index];
+	return true;
+}
+
+
+bool CostToGoField::isComputed() const
+{
+	return !cost_to_go_.empty();
+}
+
+
+int CostToGoField::getIndex(const Eigen::Vector2d& position) const
+{
+	Key key;
+	if (cost_to_go_.empty() ||
+			!space_discretization_->coordToKeyChecked(key.x, position(rbd::X), true) ||
+			!space_discretization_->coordToKeyChecked(key.y, position(rbd::Y), true) ||
+			!region_.contains(key))
+		return -1;
+
+	return (key.y - region_.min_key.y) * size_x_ + (key.x - region_.min_key.x);
+}
+
+
+std::size_t CostToGoField::getHeapBytes() const
+{
+	return utils::getHeapBytes(cost_to_go_);
+}
+
+} //@namespace environment
+} //@namespace dwl
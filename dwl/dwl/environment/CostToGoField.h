@@ -0,0 +1,110 @@
+#ifndef DWL__ENVIRONMENT__COST_TO_GO_FIELD__H
+#define DWL__ENVIRONMENT__COST_TO_GO_FIELD__H
+
+#include <dwl/environment/TerrainMap.h>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class CostToGoField
+ * @brief CostToGoField computes the cost-to-go of every terrain cell to a goal, i.e. a backward
+ * Dijkstra search over the 8-connected terrain cost grid. The weight of an edge is its length
+ * times the cost of the target cell (plus an offset), where the unknown cells have a constant
+ * cost. The field covers the region of the terrain cells, the goal and the start, and it's
+ * padded by a margin, so it's a dense grid that is computed once per goal, e.g. for the
+ * heuristic of the lattice planners. Note that the terrain map has to outlive the field
+ */
+class CostToGoField
+{
+	public:
+		/** @brief Constructor function */
+		CostToGoField();
+
+		/** @brief Destructor function */
+		~CostToGoField();
+
+		/**
+		 * @brief Sets the margin around the terrain cells, the goal and the start
+		 * @param double Margin distance
+		 */
+		void setMargin(double margin);
+
+		/**
+		 * @brief Sets the quantized-cost mode of the backward search, where the open set is a
+		 * radix heap of the costs rounded to the quantum instead of the indexed heap. The
+		 * decreased costs are expanded again, so the cost-to-go is exact and only the order
+		 * of expansion is quantized. It's faster for the full-map fields, e.g. for refreshing
+		 * them with every map update. A zero quantum disables it
+		 * @param double Cost quantum
+		 */
+		void setCostQuantum(double quantum);
+
+		/**
+		 * @brief Computes the cost-to-go of every cell to the goal
+		 * @param const TerrainMap& Terrain map
+		 * @param const Eigen::Vector2d& Goal position
+		 * @param const Eigen::Vector2d& Start position
+		 * @param double Cost of the unknown cells
+		 * @param double Offset of the cell costs, i.e. the cost per meter of free cells
+		 */
+		void compute(const TerrainMap& terrain,
+					 const Eigen::Vector2d& goal,
+					 const Eigen::Vector2d& start,
+					 double unknown_cost,
+					 double cost_offset);
+
+		/** @brief Clears the field */
+		void clear();
+
+		/**
+		 * @brief Gets the cost-to-go of a position
+		 * @param double& Cost-to-go
+		 * @param const Eigen::Vector2d& Position
+		 * @return False if the position is outside the field
+		 */
+		bool getCost(double& cost,
+					 const Eigen::Vector2d& position) const;
+
+		/** @brief Indicates if the field was computed */
+		bool isComputed() const;
+
+		/** @brief Gets the heap bytes of the cost-to-go values */
+		std::size_t getHeapBytes() const;
+
+
+	private:
+		/**
+		 * @brief Gets the index of a position within the field
+		 * @param const Eigen::Vector2d& Position
+		 * @return The index, or -1 if the position is outside the field
+		 */
+		int getIndex(const Eigen::Vector2d& position) const;
+
+		/** @brief Space discretization of the terrain cells (of the last terrain map) */
+		const SpaceDiscretization* space_discretization_;
+
+		/** @brief Region and size of the field */
+		CellRegion region_;
+		unsigned int size_x_;
+		unsigned int size_y_;
+
+		/** @brief Margin distance */
+		double margin_;
+
+		/** @brief Cost quantum of the quantized-cost mode (zero for disabling it) */
+		double cost_quantum_;
+
+		/** @brief Cost-to-go of every cell of the region */
+		std::vector<double> cost_to_go_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
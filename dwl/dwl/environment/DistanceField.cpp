@@ -0,0 +1,269 @@
+#include <dwl/environment/DistanceField.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <algorithm>
+#include <limits.h>
+#include <limits>
+#include <math.h>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+DistanceField::DistanceField() : size_x_(0), size_y_(0), resolution_(0.04),
+		max_distance_(1.), max_distance_sq_(625), padding_(25), num_obstacles_(0)
+{
+
+}
+
+
+DistanceField::~DistanceField()
+{
+
+}
+
+
+void DistanceField::reset(double resolution,
+						  double max_distance)
+{
+	// Keeping the old values if they aren't valid, e.g. an undefined resolution
+	if (resolution > 0. && max_distance > 0.) {
+		resolution_ = resolution;
+		max_distance_ = max_distance;
+		padding_ = (unsigned int) ceil(max_distance / resolution);
+		max_distance_sq_ = padding_ * padding_;
+	}
+
+	distance_sq_.clear();
+	obstacle_.clear();
+	region_ = CellRegion();
+	size_x_ = size_y_ = 0;
+	num_obstacles_ = 0;
+}
+
+
+void DistanceField::compute(const std::vector<Key>& obstacles)
+{
+	reset(resolution_, max_distance_);
+	if (obstacles.empty())
+		return;
+
+	// Computing the region of the obstacles and its padding
+	CellRegion region;
+	for (unsigned int i = 0; i < obstacles.size(); i++)
+		region.add(obstacles[i]);
+	region.add(Key(std::max((int) region.min_key.x - (int) padding_, 0),
+				   std::max((int) region.min_key.y - (int) padding_, 0), 0));
+	region.add(Key(std::min((int) region.max_key.x + (int) padding_, USHRT_MAX),
+				   std::min((int) region.max_key.y + (int) padding_, USHRT_MAX), 0));
+
+	region_ = region;
+	size_x_ = region_.max_key.x - region_.min_key.x + 1;
+	size_y_ = region_.max_key.y - region_.min_key.y + 1;
+	obstacle_.assign(size_x_ * size_y_, 0);
+	for (unsigned int i = 0; i < obstacles.size(); i++) {
+		int index = getIndex(obstacles[i]);
+		if (obstacle_[index] == 0) {
+			obstacle_[index] = 1;
+			num_obstacles_++;
+		}
+	}
+
+	recompute();
+}
+
+
+void DistanceField::addObstacle(const Key& key)
+{
+	growRegion(key);
+
+	int index = getIndex(key);
+	if (obstacle_[index] != 0)
+		return;
+	obstacle_[index] = 1;
+	num_obstacles_++;
+
+	// Updating the cells of the neighborhood, which are the only ones that can be closer to
+	// the new obstacle than the maximum distance
+	int x = key.x - region_.min_key.x, y = key.y - region_.min_key.y;
+	int radius = padding_;
+	for (int dy = -radius; dy <= radius; dy++) {
+		int ny = y + dy;
+		if (ny < 0 || ny >= (int) size_y_)
+			continue;
+
+		for (int dx = -radius; dx <= radius; dx++) {
+			int nx = x + dx;
+			if (nx < 0 || nx >= (int) size_x_)
+				continue;
+
+			int& distance_sq = distance_sq_[ny * size_x_ + nx];
+			distance_sq = std::min(distance_sq, dx * dx + dy * dy);
+		}
+	}
+}
+
+
+void DistanceField::removeObstacles(const std::vector<Key>& keys)
+{
+	bool removed = false;
+	for (unsigned int i = 0; i < keys.size(); i++) {
+		int index = getIndex(keys[i]);
+		if (index >= 0 && obstacle_[index] != 0) {
+			obstacle_[index] = 0;
+			num_obstacles_--;
+			removed = true;
+		}
+	}
+
+	// The cells of the removed obstacles could have any obstacle as closest one, so the
+	// field is recomputed once for all of them
+	if (removed)
+		recompute();
+}
+
+
+double DistanceField::getDistance(const Key& key) const
+{
+	int index = getIndex(key);
+	if (index < 0 || distance_sq_[index] > max_distance_sq_)
+		return max_distance_;
+
+	return std::min(sqrt((double) distance_sq_[index]) * resolution_, max_distance_);
+}
+
+
+double DistanceField::getMaxDistance() const
+{
+	return max_distance_;
+}
+
+
+bool DistanceField::isEmpty() const
+{
+	return num_obstacles_ == 0;
+}
+
+
+void DistanceField::growRegion(const Key& key)
+{
+	// Computing the padded region of the key
+	Key min_key(std::max((int) key.x - (int) padding_, 0),
+				std::max((int) key.y - (int) padding_, 0), 0);
+	Key max_key(std::min((int) key.x + (int) padding_, USHRT_MAX),
+				std::min((int) key.y + (int) padding_, USHRT_MAX), 0);
+	if (region_.contains(min_key) && region_.contains(max_key))
+		return;
+
+	// Getting the old obstacles
+	std::vector<Key> obstacles;
+	for (unsigned int i = 0; i < obstacle_.size(); i++) {
+		if (obstacle_[i] != 0)
+			obstacles.push_back(Key(region_.min_key.x + i % size_x_,
+									region_.min_key.y + i / size_x_, 0));
+	}
+
+	// Growing the region with an extra padding, so a sequence of close obstacles doesn't
+	// resize it every time
+	CellRegion region = region_;
+	region.add(Key(std::max((int) min_key.x - (int) padding_, 0),
+				   std::max((int) min_key.y - (int) padding_, 0), 0));
+	region.add(Key(std::min((int) max_key.x + (int) padding_, USHRT_MAX),
+				   std::min((int) max_key.y + (int) padding_, USHRT_MAX), 0));
+
+	region_ = region;
+	size_x_ = region_.max_key.x - region_.min_key.x + 1;
+	size_y_ = region_.max_key.y - region_.min_key.y + 1;
+	obstacle_.assign(size_x_ * size_y_, 0);
+	for (unsigned int i = 0; i < obstacles.size(); i++)
+		obstacle_[getIndex(obstacles[i])] = 1;
+
+	recompute();
+}
+
+
+void DistanceField::recompute()
+{
+	// Initializing the sampled function, i.e. zero in the obstacles. Note that the cells far from
+	// the obstacles have a big (instead of an infinite) value to avoid overflows
+	int far_sq = (size_x_ + size_y_) * (size_x_ + size_y_);
+	distance_sq_.resize(size_x_ * size_y_);
+	for (unsigned int i = 0; i < obstacle_.size(); i++)
+		distance_sq_[i] = obstacle_[i] != 0 ? 0 : far_sq;
+
+	// Transforming the columns and then the rows
+	for (unsigned int x = 0; x < size_x_; x++)
+		transform(&distance_sq_[x], size_y_, size_x_);
+	for (unsigned int y = 0; y < size_y_; y++)
+		transform(&distance_sq_[y * size_x_], size_x_, 1);
+
+	// Truncating the distances
+	for (unsigned int i = 0; i < distance_sq_.size(); i++)
+		distance_sq_[i] = std::min(distance_sq_[i], max_distance_sq_ + 1);
+}
+
+
+void DistanceField::transform(int* function,
+							  unsigned int size,
+							  unsigned int stride)
+{
+	samples_.resize(size);
+	roots_.resize(size);
+	boundaries_.resize(size + 1);
+	for (unsigned int q = 0; q < size; q++)
+		samples_[q] = function[q * stride];
+
+	// Computing the lower envelope of the parabolas
+	int k = 0;
+	roots_[0] = 0;
+	boundaries_[0] = -std::numeric_limits<double>::max();
+	boundaries_[1] = std::numeric_limits<double>::max();
+	for (int q = 1; q < (int) size; q++) {
+		// Removing the parabolas that are hidden by the new one. Note that the first boundary
+		// is minus infinity, so the first parabola is never removed
+		double s;
+		while (true) {
+			int r = roots_[k];
+			s = ((samples_[q] + q * q) - (samples_[r] + r * r)) / (2. * (q - r));
+			if (s > boundaries_[k])
+				break;
+			k--;
+		}
+
+		k++;
+		roots_[k] = q;
+		boundaries_[k] = s;
+		boundaries_[k + 1] = std::numeric_limits<double>::max();
+	}
+
+	// Evaluating the lower envelope
+	k = 0;
+	for (int q = 0; q < (int) size; q++) {
+		while (boundaries_[k + 1] < q)
+			k++;
+		int r = roots_[k];
+		function[q * stride] = (q - r) * (q - r) + samples_[r];
+	}
+}
+
+
+int DistanceField::getIndex(const Key& key) const
+{
+	if (!region_.contains(key))
+		return -1;
+
+	return (key.y - region_.min_key.y) * size_x_ + (key.x - region_.min_key.x);
+}
+
+
+std::size_t DistanceField::getHeapBytes() const
+{
+	return utils::getHeapBytes(distance_sq_) + utils::getHeapBytes(obstacle_) +
+			utils::getHeapBytes(samples_) + utils::getHeapBytes(roots_) +
+			utils::getHeapBytes(boundaries_);
+}
+
+} //@namespace environment
+} //@namespace dwl
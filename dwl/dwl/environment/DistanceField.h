@@ -0,0 +1,135 @@
+#ifndef DWL__ENVIRONMENT__DISTANCE_FIELD__H
+#define DWL__ENVIRONMENT__DISTANCE_FIELD__H
+
+#include <dwl/utils/EnvironmentRepresentation.h>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class DistanceField
+ * @brief DistanceField maintains the Euclidean distance of every cell to its closest obstacle,
+ * i.e. the clearance of a cell is a single lookup. The distances are truncated to a maximum
+ * distance, so a new obstacle only updates the cells of its neighborhood (disk). The field is
+ * recomputed with the exact linear-time transform of Felzenszwalb and Huttenlocher (2012:
+ * "Distance Transforms of Sampled Functions") when obstacles are removed. The region of the
+ * field grows with the obstacles, and it's padded by the maximum distance
+ */
+class DistanceField
+{
+	public:
+		/** @brief Constructor function */
+		DistanceField();
+
+		/** @brief Destructor function */
+		~DistanceField();
+
+		/**
+		 * @brief Resets the field without obstacles. The non-positive values are ignored
+		 * @param double Resolution of the cells
+		 * @param double Maximum distance
+		 */
+		void reset(double resolution,
+				   double max_distance);
+
+		/**
+		 * @brief Computes the field of a set of obstacles, where the old ones are removed
+		 * @param const std::vector<Key>& Keys of the obstacles (only the x and y keys are used)
+		 */
+		void compute(const std::vector<Key>& obstacles);
+
+		/**
+		 * @brief Adds an obstacle, where only the cells closer to it than the maximum distance
+		 * are updated
+		 * @param const Key& Key of the obstacle
+		 */
+		void addObstacle(const Key& key);
+
+		/**
+		 * @brief Removes a set of obstacles, which recomputes the field of the remaining ones
+		 * @param const std::vector<Key>& Keys of the obstacles
+		 */
+		void removeObstacles(const std::vector<Key>& keys);
+
+		/**
+		 * @brief Gets the distance of a cell to its closest obstacle, where the distance of the
+		 * cells without a closer obstacle than the maximum distance is the maximum distance
+		 * @param const Key& Key of the cell
+		 * @return The distance to the closest obstacle
+		 */
+		double getDistance(const Key& key) const;
+
+		/** @brief Gets the maximum distance */
+		double getMaxDistance() const;
+
+		/** @brief Indicates if the field doesn't have obstacles */
+		bool isEmpty() const;
+
+		/** @brief Gets the heap bytes of the field, i.e. of its distances and buffers */
+		std::size_t getHeapBytes() const;
+
+
+	private:
+		/**
+		 * @brief Resizes the region for containing a key and its padding, and recomputes the
+		 * field if it changed
+		 * @param const Key& Key of the obstacle
+		 */
+		void growRegion(const Key& key);
+
+		/** @brief Recomputes the distances of all the cells from the obstacles */
+		void recompute();
+
+		/**
+		 * @brief Computes the 1d squared distance transform of a sampled function, i.e. the
+		 * lower envelope of the parabolas rooted at every sample
+		 * @param int* Sampled function and its transform
+		 * @param unsigned int Number of samples
+		 * @param unsigned int Stride between the samples
+		 */
+		void transform(int* function,
+					   unsigned int size,
+					   unsigned int stride);
+
+		/** @brief Gets the index of a cell given its key, or -1 if it's outside the region */
+		int getIndex(const Key& key) const;
+
+		/** @brief Squared distance (in cells) of every cell to its closest obstacle */
+		std::vector<int> distance_sq_;
+
+		/** @brief Indicates the obstacle cells */
+		std::vector<unsigned char> obstacle_;
+
+		/** @brief Workspace of the 1d transform, i.e. samples, parabola roots and boundaries */
+		std::vector<int> samples_;
+		std::vector<int> roots_;
+		std::vector<double> boundaries_;
+
+		/** @brief Region of the field */
+		CellRegion region_;
+		unsigned int size_x_;
+		unsigned int size_y_;
+
+		/** @brief Resolution of the cells */
+		double resolution_;
+
+		/** @brief Maximum distance and its squared value in cells */
+		double max_distance_;
+		int max_distance_sq_;
+
+		/** @brief Padding of the region in cells */
+		unsigned int padding_;
+
+		/** @brief Number of obstacles */
+		unsigned int num_obstacles_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
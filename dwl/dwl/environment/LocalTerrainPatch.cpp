@@ -0,0 +1,123 @@
+#include <dwl/environment/LocalTerrainPatch.h>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+LocalTerrainPatch::LocalTerrainPatch() : origin_(Eigen::Vector2d::Zero()), resolution_(0.),
+		size_x_(0), size_y_(0)
+{
+
+}
+
+
+LocalTerrainPatch::~LocalTerrainPatch()
+{
+
+}
+
+
+void LocalTerrainPatch::build(const TerrainMap& terrain,
+							  const Eigen::Vector2d& center,
+							  double half_size)
+{
+	clear();
+	const SpaceDiscretization& space_discretization = terrain.getTerrainSpaceModel();
+	resolution_ = space_discretization.getEnvironmentResolution(true);
+	if (resolution_ <= 0.) {
+		printf(YELLOW "Warning: could not build the terrain patch because the terrain"
+				" resolution isn't defined\n" COLOR_RESET);
+		return;
+	}
+
+	// Getting the center of the first cell, so the samples are the centers of the cells
+	Vertex vertex;
+	Eigen::Vector2d corner = center - Eigen::Vector2d::Constant(half_size);
+	space_discretization.coordToVertex(vertex, corner);
+	space_discretization.vertexToCoord(origin_, vertex);
+	size_x_ = std::max((unsigned int) ceil(2 * half_size / resolution_) + 1, 2u);
+	size_y_ = size_x_;
+
+	// Sampling the terrain cells
+	cost_.resize(size_x_ * size_y_);
+	height_.resize(size_x_ * size_y_);
+	Eigen::Vector2d position;
+	for (unsigned int y = 0; y < size_y_; y++) {
+		position(rbd::Y) = origin_(rbd::Y) + y * resolution_;
+		for (unsigned int x = 0; x < size_x_; x++) {
+			position(rbd::X) = origin_(rbd::X) + x * resolution_;
+			unsigned int idx = y * size_x_ + x;
+			cost_[idx] = terrain.getTerrainCost(position);
+			height_[idx] = terrain.getTerrainHeight(position);
+		}
+	}
+}
+
+
+void LocalTerrainPatch::clear()
+{
+	size_x_ = 0;
+	size_y_ = 0;
+	cost_.clear();
+	height_.clear();
+}
+
+
+double LocalTerrainPatch::getCost(const Eigen::Vector2d& position) const
+{
+	return interpolate(cost_, position);
+}
+
+
+double LocalTerrainPatch::getHeight(const Eigen::Vector2d& position) const
+{
+	return interpolate(height_, position);
+}
+
+
+bool LocalTerrainPatch::isInside(const Eigen::Vector2d& position) const
+{
+	if (!isBuilt())
+		return false;
+
+	Eigen::Vector2d cell = (position - origin_) / resolution_;
+	return cell(rbd::X) >= 0. && cell(rbd::X) <= size_x_ - 1 &&
+			cell(rbd::Y) >= 0. && cell(rbd::Y) <= size_y_ - 1;
+}
+
+
+bool LocalTerrainPatch::isBuilt() const
+{
+	return !cost_.empty();
+}
+
+
+double LocalTerrainPatch::interpolate(const std::vector<double>& values,
+									  const Eigen::Vector2d& position) const
+{
+	if (!isBuilt())
+		return 0.;
+
+	// Getting the cell of the position, which is clamped to the patch
+	double cell_x = std::min(std::max((position(rbd::X) - origin_(rbd::X)) / resolution_, 0.),
+							 (double) (size_x_ - 1));
+	double cell_y = std::min(std::max((position(rbd::Y) - origin_(rbd::Y)) / resolution_, 0.),
+							 (double) (size_y_ - 1));
+	unsigned int x = std::min((unsigned int) cell_x, size_x_ - 2);
+	unsigned int y = std::min((unsigned int) cell_y, size_y_ - 2);
+	double tx = cell_x - x;
+	double ty = cell_y - y;
+
+	// Interpolating the four neighbor cells
+	const double* row = &values[y * size_x_ + x];
+	double bottom = (1 - tx) * row[0] + tx * row[1];
+	double top = (1 - tx) * row[size_x_] + tx * row[size_x_ + 1];
+
+	return (1 - ty) * bottom + ty * top;
+}
+
+} //@namespace environment
+} //@namespace dwl
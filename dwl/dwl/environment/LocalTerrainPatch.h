@@ -0,0 +1,92 @@
+#ifndef DWL__ENVIRONMENT__LOCAL_TERRAIN_PATCH__H
+#define DWL__ENVIRONMENT__LOCAL_TERRAIN_PATCH__H
+
+#include <dwl/environment/TerrainMap.h>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class LocalTerrainPatch
+ * @brief LocalTerrainPatch samples the terrain costs and heights of the cells around a position
+ * (e.g. the robot) into small dense row-major arrays, so the costs and heights of footholds are
+ * bilinearly interpolated without querying the terrain map. The patch is built once per solve,
+ * and it's small enough to stay in the cache during the evaluations of the optimizer. The
+ * positions outside the patch are clamped to its border
+ */
+class LocalTerrainPatch
+{
+	public:
+		/** @brief Constructor function */
+		LocalTerrainPatch();
+
+		/** @brief Destructor function */
+		~LocalTerrainPatch();
+
+		/**
+		 * @brief Samples the terrain cells of a square region around a position, where the
+		 * unknown cells have the default values of the terrain map
+		 * @param const TerrainMap& Terrain map
+		 * @param const Eigen::Vector2d& Center of the patch
+		 * @param double Half size of the patch
+		 */
+		void build(const TerrainMap& terrain,
+				   const Eigen::Vector2d& center,
+				   double half_size);
+
+		/** @brief Clears the patch */
+		void clear();
+
+		/**
+		 * @brief Gets the interpolated terrain cost of a position
+		 * @param const Eigen::Vector2d& Position
+		 * @return double Terrain cost
+		 */
+		double getCost(const Eigen::Vector2d& position) const;
+
+		/**
+		 * @brief Gets the interpolated terrain height of a position
+		 * @param const Eigen::Vector2d& Position
+		 * @return double Terrain height
+		 */
+		double getHeight(const Eigen::Vector2d& position) const;
+
+		/** @brief Indicates if a position is inside the patch */
+		bool isInside(const Eigen::Vector2d& position) const;
+
+		/** @brief Indicates if the patch was built */
+		bool isBuilt() const;
+
+
+	private:
+		/**
+		 * @brief Interpolates bilinearly the values of the cells
+		 * @param const std::vector<double>& Values of the cells
+		 * @param const Eigen::Vector2d& Position
+		 * @return double Interpolated value
+		 */
+		double interpolate(const std::vector<double>& values,
+						   const Eigen::Vector2d& position) const;
+
+		/** @brief Position of the center of the first cell, and resolution of the cells */
+		Eigen::Vector2d origin_;
+		double resolution_;
+
+		/** @brief Size of the patch */
+		unsigned int size_x_;
+		unsigned int size_y_;
+
+		/** @brief Costs and heights of the cells, indexed by row */
+		std::vector<double> cost_;
+		std::vector<double> height_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
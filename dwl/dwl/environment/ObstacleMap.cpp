@@ -1,4 +1,6 @@
 #include <dwl/environment/ObstacleMap.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <atomic>
 
 
 namespace dwl
@@ -25,6 +27,8 @@ ObstacleMap::~ObstacleMap()
 void ObstacleMap::reset()
 {
 	obstacle_map_.clear();
+	distance_field_.reset(space_discretization_.getEnvironmentResolution(true),
+						  distance_field_.getMaxDistance());
 }
 
 
@@ -39,7 +43,11 @@ void ObstacleMap::compute(octomap::OcTree* octomap,
 		is_added_search_area_ = true;
 	}
 
-	double yaw = robot_state(3);
+	// Getting the 2d pose of the robot, i.e. its position and yaw
+	Eigen::Vector3d robot_2dpose;
+	robot_2dpose(0) = robot_state(0);
+	robot_2dpose(1) = robot_state(1);
+	robot_2dpose(2) = robot_state(3);
 
 	// Setting the depth of the octomap message according to the resolution
 	double octomap_resolution = octomap->getResolution();
@@ -47,80 +55,46 @@ void ObstacleMap::compute(octomap::OcTree* octomap,
 
 	// Computing obstacle map for several search areas
 	unsigned int num_area = search_areas_.size();
+	unsigned int num_threads = std::max(utils::TaskScheduler::getDefault().getMaxParallelism(), 1u);
+	std::vector<std::vector<Cell> > tile_cells(num_threads);
 	for (unsigned int n = 0; n < num_area; n++) {
-		// Computing the boundary of the gridmap
-		Eigen::Vector2d boundary_min, boundary_max;
-
-		boundary_min(0) = search_areas_[n].min_x + robot_state(0);
-		boundary_min(1) = search_areas_[n].min_y + robot_state(1);
-		boundary_max(0) = search_areas_[n].max_x + robot_state(0);
-		boundary_max(1) = search_areas_[n].max_y + robot_state(1);
-
-		double resolution = search_areas_[n].resolution;
-		for (double y = boundary_min(1); y < boundary_max(1); y += resolution) {
-			for (double x = boundary_min(0); x < boundary_max(0); x += resolution) {
-				// Computing the rotated coordinate of the point inside the search area
-				double xr = (x - robot_state(0)) * cos(yaw) - (y - robot_state(1)) * sin(yaw) +
-						robot_state(0);
-				double yr = (x - robot_state(0)) * sin(yaw) + (y - robot_state(1)) * cos(yaw) +
-						robot_state(1);
-
-				// Checking if the cell belongs to dimensions of the map, and also getting the key
-				// of this cell
-				double z = search_areas_[n].max_z + robot_state(2);
-				octomap::OcTreeKey init_key;
-				if (!octomap->coordToKeyChecked(xr, yr, z, depth_, init_key)) {
-					printf(RED "Cell out of bounds \n" COLOR_RESET);
-
-					return;
-				}
-
-				// Finding the cell of the surface
-				int r = 0;
-				while (z >= search_areas_[n].min_z + robot_state(2)) {
-					octomap::OcTreeKey heightmap_key;
-					octomap::OcTreeNode* heightmap_node = octomap->search(init_key, depth_);
-					heightmap_key[0] = init_key[0];
-					heightmap_key[1] = init_key[1];
-					heightmap_key[2] = init_key[2] - r;
-
-					heightmap_node = octomap->search(heightmap_key, depth_);
-					octomap::point3d height_point = octomap->keyToCoord(heightmap_key, depth_);
-					z = height_point(2);
-					if (heightmap_node) {
-						// Computation of the heightmap
-						if (octomap->isNodeOccupied(heightmap_node)) {
-							// Setting the obstacle cell sizes
-							Cell obstacle_cell;
-							obstacle_cell.plane_size = space_discretization_.getEnvironmentResolution(true);
-							obstacle_cell.height_size = space_discretization_.getEnvironmentResolution(false);
-
-							// Getting position of the occupied cell
-							Eigen::Vector3d cell_position;
-							cell_position(0) = height_point(0);
-							cell_position(1) = height_point(1);
-							cell_position(2) = height_point(2);
-							space_discretization_.coordToKeyChecked(obstacle_cell.key, cell_position);
-
-							// Adding the obstacle to map
-							addCellToObstacleMap(obstacle_cell);
-
-							break;
-						}
-					}
-					r++;
-				}
+		// Computing the rows of the gridmap, which are split in tiles
+		std::vector<double> rows;
+		double boundary_min_y = search_areas_[n].min_y + robot_state(1);
+		double boundary_max_y = search_areas_[n].max_y + robot_state(1);
+		for (double y = boundary_min_y; y < boundary_max_y; y += search_areas_[n].resolution)
+			rows.push_back(y);
+
+		// Searching the obstacles of every tile in parallel, where the octomap is only read
+		unsigned int tile_size = (rows.size() + num_threads - 1) / num_threads;
+		std::atomic<bool> out_of_bounds(false);
+		utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+			tile_cells[t].clear();
+			unsigned int first = std::min(t * tile_size, (unsigned int) rows.size());
+			unsigned int last = std::min(first + tile_size, (unsigned int) rows.size());
+			for (unsigned int i = first; i < last && !out_of_bounds; i++) {
+				if (!computeObstacleRow(tile_cells[t], octomap, search_areas_[n],
+										robot_state, robot_2dpose, rows[i]))
+					out_of_bounds = true;
 			}
+		});
+
+		if (out_of_bounds) {
+			printf(RED "Cell out of bounds \n" COLOR_RESET);
+			return;
 		}
-	}
 
+		// Adding the obstacles in the order of the tiles
+		for (unsigned int t = 0; t < num_threads; t++) {
+			for (unsigned int i = 0; i < tile_cells[t].size(); i++)
+				addCellToObstacleMap(tile_cells[t][i]);
+		}
+	}
 
-	// Removing the points that doesn't belong to interest area
-	Eigen::Vector3d robot_2dpose;
-	robot_2dpose(0) = robot_state(0);
-	robot_2dpose(1) = robot_state(1);
-	robot_2dpose(2) = robot_state(3);
+	// Removing the previous obstacles that doesn't belong to interest area, and updating the
+	// occupancy grid
 	removeObstacleOutsideInterestRegion(robot_2dpose);
+	updateOccupancyGrid();
 }
 
 
@@ -143,6 +117,7 @@ void ObstacleMap::addSearchArea(double min_x, double max_x,
 	if (grid_resolution < space_discretization_.getEnvironmentResolution(true)) {
 		space_discretization_.setEnvironmentResolution(grid_resolution, true);
 		space_discretization_.setEnvironmentResolution(grid_resolution, false);
+		distance_field_.reset(grid_resolution, distance_field_.getMaxDistance());
 		resolution_ = grid_resolution;
 	}
 
@@ -152,28 +127,38 @@ void ObstacleMap::addSearchArea(double min_x, double max_x,
 
 void ObstacleMap::removeObstacleOutsideInterestRegion(const Eigen::Vector3d& robot_state)
 {
-	// Getting the orientation of the body
-	double yaw = robot_state(2);
-
-	for (std::map<Vertex,Cell>::iterator vertex_iter = obstacle_map_.begin();
-			vertex_iter != obstacle_map_.end();
-			vertex_iter++)
-	{
+	std::vector<Key> removed_keys;
+	std::map<Vertex,Cell>::iterator vertex_iter = obstacle_map_.begin();
+	while (vertex_iter != obstacle_map_.end()) {
 		Vertex v = vertex_iter->first;
 		Eigen::Vector2d point;
 		space_discretization_.vertexToCoord(point, v);
 
-		double xc = point(0) - robot_state(0);
-		double yc = point(1) - robot_state(1);
-		if (xc * cos(yaw) + yc * sin(yaw) >= 0.0) {
-			if (pow(xc * cos(yaw) + yc * sin(yaw), 2) / pow(interest_radius_y_, 2) +
-					pow(xc * sin(yaw) - yc * cos(yaw), 2) / pow(interest_radius_x_, 2) > 1)
-				obstacle_map_.erase(v);
-		} else {
-			if (pow(xc, 2) + pow(yc, 2) > pow(interest_radius_x_, 2))
-				obstacle_map_.erase(v);
-		}
+		if (!isInsideInterestRegion(point, robot_state)) {
+			removed_keys.push_back(vertex_iter->second.key);
+			obstacle_map_.erase(vertex_iter++);
+		} else
+			vertex_iter++;
 	}
+
+	// Updating the distance field once for all the removed obstacles
+	distance_field_.removeObstacles(removed_keys);
+}
+
+
+bool ObstacleMap::isInsideInterestRegion(const Eigen::Vector2d& point,
+										 const Eigen::Vector3d& robot_state) const
+{
+	// Getting the orientation of the body
+	double yaw = robot_state(2);
+
+	double xc = point(0) - robot_state(0);
+	double yc = point(1) - robot_state(1);
+	if (xc * cos(yaw) + yc * sin(yaw) >= 0.0) {
+		return pow(xc * cos(yaw) + yc * sin(yaw), 2) / pow(interest_radius_y_, 2) +
+				pow(xc * sin(yaw) - yc * cos(yaw), 2) / pow(interest_radius_x_, 2) <= 1;
+	} else
+		return pow(xc, 2) + pow(yc, 2) <= pow(interest_radius_x_, 2);
 }
 
 
@@ -182,6 +167,7 @@ void ObstacleMap::addCellToObstacleMap(Cell& cell)
 	Vertex vertex_id;
 	space_discretization_.keyToVertex(vertex_id, cell.key, true);
 	obstacle_map_[vertex_id] = cell;
+	distance_field_.addObstacle(Key(cell.key.x, cell.key.y, 0));
 }
 
 
@@ -203,6 +189,10 @@ void ObstacleMap::setResolution(double resolution,
 								bool plane)
 {
 	space_discretization_.setEnvironmentResolution(resolution, plane);
+
+	// The keys of the distance field depend on the resolution
+	if (plane)
+		distance_field_.reset(resolution, distance_field_.getMaxDistance());
 }
 
 
@@ -211,5 +201,116 @@ const std::map<Vertex,Cell>& ObstacleMap::getObstacleMap() const
 	return obstacle_map_;
 }
 
+
+const DistanceField& ObstacleMap::getDistanceField() const
+{
+	return distance_field_;
+}
+
+
+const OccupancyGrid& ObstacleMap::getOccupancyGrid() const
+{
+	return occupancy_grid_;
+}
+
+
+utils::MemoryUsage ObstacleMap::getMemoryUsage() const
+{
+	utils::MemoryUsage usage("obstacle_map");
+	usage.add("cells", utils::getHeapBytes(obstacle_map_));
+	usage.add("distance_field", distance_field_.getHeapBytes());
+	usage.add("occupancy_grid", occupancy_grid_.getHeapBytes());
+	usage.add("search_areas", utils::getHeapBytes(search_areas_));
+
+	return usage;
+}
+
+
+bool ObstacleMap::computeObstacleRow(std::vector<Cell>& cells,
+									 octomap::OcTree* octomap,
+									 const SearchArea& search_area,
+									 const Eigen::Vector4d& robot_state,
+									 const Eigen::Vector3d& robot_2dpose,
+									 double y) const
+{
+	double yaw = robot_state(3);
+	double boundary_min_x = search_area.min_x + robot_state(0);
+	double boundary_max_x = search_area.max_x + robot_state(0);
+	for (double x = boundary_min_x; x < boundary_max_x; x += search_area.resolution) {
+		// Computing the rotated coordinate of the point inside the search area
+		Eigen::Vector2d point;
+		point(0) = (x - robot_state(0)) * cos(yaw) - (y - robot_state(1)) * sin(yaw) +
+				robot_state(0);
+		point(1) = (x - robot_state(0)) * sin(yaw) + (y - robot_state(1)) * cos(yaw) +
+				robot_state(1);
+
+		// Cropping the points outside the interest region before searching in the octomap
+		if (!isInsideInterestRegion(point, robot_2dpose))
+			continue;
+
+		// Checking if the cell belongs to dimensions of the map, and also getting the key
+		// of this cell
+		double z = search_area.max_z + robot_state(2);
+		octomap::OcTreeKey init_key;
+		if (!octomap->coordToKeyChecked(point(0), point(1), z, depth_, init_key))
+			return false;
+
+		// Finding the cell of the surface
+		int r = 0;
+		while (z >= search_area.min_z + robot_state(2)) {
+			octomap::OcTreeKey heightmap_key;
+			heightmap_key[0] = init_key[0];
+			heightmap_key[1] = init_key[1];
+			heightmap_key[2] = init_key[2] - r;
+
+			octomap::OcTreeNode* heightmap_node = octomap->search(heightmap_key, depth_);
+			octomap::point3d height_point = octomap->keyToCoord(heightmap_key, depth_);
+			z = height_point(2);
+			if (heightmap_node) {
+				// Computation of the heightmap
+				if (octomap->isNodeOccupied(heightmap_node)) {
+					// Setting the obstacle cell sizes
+					Cell obstacle_cell;
+					obstacle_cell.plane_size = space_discretization_.getEnvironmentResolution(true);
+					obstacle_cell.height_size = space_discretization_.getEnvironmentResolution(false);
+
+					// Getting position of the occupied cell
+					Eigen::Vector3d cell_position;
+					cell_position(0) = height_point(0);
+					cell_position(1) = height_point(1);
+					cell_position(2) = height_point(2);
+					space_discretization_.coordToKeyChecked(obstacle_cell.key, cell_position);
+					cells.push_back(obstacle_cell);
+
+					break;
+				}
+			}
+			r++;
+		}
+	}
+
+	return true;
+}
+
+
+void ObstacleMap::updateOccupancyGrid()
+{
+	// Computing the region of the obstacles, where the grid has only one layer
+	CellRegion region;
+	for (std::map<Vertex,Cell>::const_iterator it = obstacle_map_.begin();
+			it != obstacle_map_.end(); it++)
+		region.add(it->second.key);
+
+	if (region.empty) {
+		occupancy_grid_.clear();
+		return;
+	}
+
+	occupancy_grid_.reset(region);
+	for (std::map<Vertex,Cell>::const_iterator it = obstacle_map_.begin();
+			it != obstacle_map_.end(); it++)
+		occupancy_grid_.setOccupied(Key(it->second.key.x, it->second.key.y, 0));
+}
+
 } //@namespace environment
 } //@namespace dwl
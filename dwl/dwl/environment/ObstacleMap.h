@@ -2,6 +2,9 @@
 #define DWL__ENVIRONMENT__OBSTACLE_MAP__H
 
 #include <dwl/environment/SpaceDiscretization.h>
+#include <dwl/environment/DistanceField.h>
+#include <dwl/environment/OccupancyGrid.h>
+#include <dwl/utils/MemoryUsage.h>
 #include <dwl/utils/utils.h>
 
 #include <octomap/octomap.h>
@@ -93,14 +96,68 @@ class ObstacleMap
 		 */
 		const std::map<Vertex,Cell>& getObstacleMap() const;
 
+		/**
+		 * @brief Gets the distance field of the obstacles, which is updated incrementally with
+		 * the added cells
+		 * @return The distance field
+		 */
+		const DistanceField& getDistanceField() const;
+
+		/**
+		 * @brief Gets the bit-packed occupancy grid of the obstacles (one layer), which is
+		 * updated by every computation
+		 * @return The occupancy grid
+		 */
+		const OccupancyGrid& getOccupancyGrid() const;
+
+		/** @brief Gets the memory usage of the obstacle cells, distance field and grid */
+		utils::MemoryUsage getMemoryUsage() const;
+
 
 	private:
+		/**
+		 * @brief Searches the surface obstacles of a row of a search area, where the points
+		 * outside the interest region are cropped before the search. It only reads the octomap
+		 * and the obstacle map, so the rows are searched in parallel
+		 * @param std::vector<Cell>& Found obstacle cells, which are appended
+		 * @param octomap::OcTree* Octomap model of the environment
+		 * @param const SearchArea& Search area
+		 * @param const Eigen::Vector4d& The position of the robot and the yaw angle
+		 * @param const Eigen::Vector3d& 2d pose of the robot, i.e. 2D position and yaw
+		 * @param double Coordinate of the row along the y-axis (before the rotation)
+		 * @return False if a cell is out of the bounds of the octomap
+		 */
+		bool computeObstacleRow(std::vector<Cell>& cells,
+								octomap::OcTree* octomap,
+								const SearchArea& search_area,
+								const Eigen::Vector4d& robot_state,
+								const Eigen::Vector3d& robot_2dpose,
+								double y) const;
+
+		/**
+		 * @brief Indicates if a point is inside the interest region
+		 * @param const Eigen::Vector2d& Cartesian position of the point
+		 * @param const Eigen::Vector3d& State of the robot, i.e. 2D position and yaw orientation
+		 * @return True if it's inside
+		 */
+		bool isInsideInterestRegion(const Eigen::Vector2d& point,
+									const Eigen::Vector3d& robot_state) const;
+
+		/** @brief Updates the occupancy grid from the obstacle map */
+		void updateOccupancyGrid();
+
 		/** @brief Object of the SpaceDiscretization class for defining the grid routines */
 		SpaceDiscretization space_discretization_;
 
 		/** @brief Reward values mapped using vertex id */
 		std::map<Vertex,Cell> obstacle_map_;
 
+		/** @brief Distance of every cell to its closest obstacle */
+		DistanceField distance_field_;
+
+		/** @brief Bit-packed occupancy of the obstacles */
+		OccupancyGrid occupancy_grid_;
+
 		/** @brief Vector of search areas */
 		std::vector<SearchArea> search_areas_;
 
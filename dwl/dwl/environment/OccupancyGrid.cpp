@@ -0,0 +1,227 @@
+#include <dwl/environment/OccupancyGrid.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <algorithm>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/** @brief Counts the set bits of a word, which is a single instruction with POPCNT */
+inline unsigned int countBits(uint64_t word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(word);
+#else
+	unsigned int count = 0;
+	for (; word != 0; count++)
+		word &= word - 1;
+	return count;
+#endif
+}
+
+
+OccupancyGrid::OccupancyGrid() : size_x_(0), size_y_(0), size_z_(0), words_per_row_(0)
+{
+
+}
+
+
+OccupancyGrid::~OccupancyGrid()
+{
+
+}
+
+
+void OccupancyGrid::reset(const CellRegion& region,
+						  unsigned short int min_z,
+						  unsigned short int num_layers)
+{
+	clear();
+	if (region.empty || num_layers == 0)
+		return;
+
+	min_key_ = Key(region.min_key.x, region.min_key.y, min_z);
+	size_x_ = region.max_key.x - region.min_key.x + 1;
+	size_y_ = region.max_key.y - region.min_key.y + 1;
+	size_z_ = num_layers;
+	words_per_row_ = (size_x_ + 63) / 64;
+	words_.assign(words_per_row_ * size_y_ * size_z_, 0);
+}
+
+
+void OccupancyGrid::clear()
+{
+	std::vector<uint64_t> empty_words;
+	words_.swap(empty_words);
+	min_key_ = Key();
+	size_x_ = size_y_ = size_z_ = 0;
+	words_per_row_ = 0;
+}
+
+
+void OccupancyGrid::setOccupied(const Key& key,
+								bool occupied)
+{
+	if (key.x < min_key_.x || key.y < min_key_.y || key.z < min_key_.z)
+		return;
+	unsigned int x = key.x - min_key_.x;
+	unsigned int y = key.y - min_key_.y;
+	unsigned int z = key.z - min_key_.z;
+	if (x >= size_x_ || y >= size_y_ || z >= size_z_)
+		return;
+
+	uint64_t& word = words_[getRowIndex(y, z) + (x >> 6)];
+	uint64_t bit = (uint64_t) 1 << (x & 63);
+	if (occupied)
+		word |= bit;
+	else
+		word &= ~bit;
+}
+
+
+bool OccupancyGrid::isOccupied(const Key& key) const
+{
+	if (key.x < min_key_.x || key.y < min_key_.y || key.z < min_key_.z)
+		return false;
+	unsigned int x = key.x - min_key_.x;
+	unsigned int y = key.y - min_key_.y;
+	unsigned int z = key.z - min_key_.z;
+	if (x >= size_x_ || y >= size_y_ || z >= size_z_)
+		return false;
+
+	return (words_[getRowIndex(y, z) + (x >> 6)] >> (x & 63)) & 1;
+}
+
+
+bool OccupancyGrid::isAnyOccupied(const Key& min_key,
+								  const Key& max_key) const
+{
+	unsigned int first_word, last_word;
+	uint64_t first_mask, last_mask;
+	if (!getSpanMasks(first_word, last_word, first_mask, last_mask, min_key.x, max_key.x))
+		return false;
+
+	// Clipping the y and z keys to the grid
+	int min_y = std::max((int) min_key.y - (int) min_key_.y, 0);
+	int max_y = std::min((int) max_key.y - (int) min_key_.y, (int) size_y_ - 1);
+	int min_z = std::max((int) min_key.z - (int) min_key_.z, 0);
+	int max_z = std::min((int) max_key.z - (int) min_key_.z, (int) size_z_ - 1);
+
+	// Or-reducing the words of every row, i.e. 64 cells per operation
+	for (int z = min_z; z <= max_z; z++) {
+		for (int y = min_y; y <= max_y; y++) {
+			const uint64_t* row = &words_[getRowIndex(y, z)];
+			if (first_word == last_word) {
+				if (row[first_word] & first_mask & last_mask)
+					return true;
+				continue;
+			}
+
+			uint64_t occupied = (row[first_word] & first_mask) | (row[last_word] & last_mask);
+			for (unsigned int w = first_word + 1; w < last_word; w++)
+				occupied |= row[w];
+			if (occupied != 0)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool OccupancyGrid::isAnyOccupied(const std::vector<RowSpan>& footprint) const
+{
+	for (unsigned int i = 0; i < footprint.size(); i++) {
+		const RowSpan& span = footprint[i];
+		Key min_key(span.min_x, span.y, min_key_.z);
+		Key max_key(span.max_x, span.y, min_key_.z + size_z_ - 1);
+		if (isAnyOccupied(min_key, max_key))
+			return true;
+	}
+
+	return false;
+}
+
+
+unsigned int OccupancyGrid::countOccupied(const Key& min_key,
+										  const Key& max_key) const
+{
+	unsigned int first_word, last_word;
+	uint64_t first_mask, last_mask;
+	if (!getSpanMasks(first_word, last_word, first_mask, last_mask, min_key.x, max_key.x))
+		return 0;
+
+	// Clipping the y and z keys to the grid
+	int min_y = std::max((int) min_key.y - (int) min_key_.y, 0);
+	int max_y = std::min((int) max_key.y - (int) min_key_.y, (int) size_y_ - 1);
+	int min_z = std::max((int) min_key.z - (int) min_key_.z, 0);
+	int max_z = std::min((int) max_key.z - (int) min_key_.z, (int) size_z_ - 1);
+
+	unsigned int count = 0;
+	for (int z = min_z; z <= max_z; z++) {
+		for (int y = min_y; y <= max_y; y++) {
+			const uint64_t* row = &words_[getRowIndex(y, z)];
+			if (first_word == last_word) {
+				count += countBits(row[first_word] & first_mask & last_mask);
+				continue;
+			}
+
+			count += countBits(row[first_word] & first_mask) +
+					countBits(row[last_word] & last_mask);
+			for (unsigned int w = first_word + 1; w < last_word; w++)
+				count += countBits(row[w]);
+		}
+	}
+
+	return count;
+}
+
+
+bool OccupancyGrid::isEmpty() const
+{
+	return words_.empty();
+}
+
+
+bool OccupancyGrid::getSpanMasks(unsigned int& first_word,
+								 unsigned int& last_word,
+								 uint64_t& first_mask,
+								 uint64_t& last_mask,
+								 unsigned short int min_x,
+								 unsigned short int max_x) const
+{
+	if (words_.empty() || min_x > max_x)
+		return false;
+
+	// Clipping the span to the grid
+	int first = std::max((int) min_x - (int) min_key_.x, 0);
+	int last = std::min((int) max_x - (int) min_key_.x, (int) size_x_ - 1);
+	if (first > last)
+		return false;
+
+	first_word = first >> 6;
+	last_word = last >> 6;
+	first_mask = ~(uint64_t) 0 << (first & 63);
+	last_mask = ~(uint64_t) 0 >> (63 - (last & 63));
+
+	return true;
+}
+
+
+unsigned int OccupancyGrid::getRowIndex(unsigned int y,
+										unsigned int z) const
+{
+	return (z * size_y_ + y) * words_per_row_;
+}
+
+
+std::size_t OccupancyGrid::getHeapBytes() const
+{
+	return utils::getHeapBytes(words_);
+}
+
+} //@namespace environment
+} //@namespace dwl
@@ -0,0 +1,152 @@
+#ifndef DWL__ENVIRONMENT__OCCUPANCY_GRID__H
+#define DWL__ENVIRONMENT__OCCUPANCY_GRID__H
+
+#include <dwl/utils/EnvironmentRepresentation.h>
+#include <stdint.h>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @brief Struct that defines a row span of cells, i.e. the cells between the min_x and max_x
+ * keys of the y row. A body footprint is described by its row spans
+ */
+struct RowSpan
+{
+	RowSpan() : y(0), min_x(0), max_x(0) {}
+	RowSpan(unsigned short int _y,
+			unsigned short int _min_x,
+			unsigned short int _max_x) : y(_y), min_x(_min_x), max_x(_max_x) {}
+
+	unsigned short int y;
+	unsigned short int min_x;
+	unsigned short int max_x;
+};
+
+/**
+ * @class OccupancyGrid
+ * @brief OccupancyGrid stores the occupancy of a bounded region of cells with one bit per
+ * cell. The cells of a row (x axis) of every layer (z axis) are packed in 64-bit words, so the
+ * rectangle and footprint queries test a whole word (64 cells) per operation instead of every
+ * cell. The cells outside the region are free
+ */
+class OccupancyGrid
+{
+	public:
+		/** @brief Constructor function */
+		OccupancyGrid();
+
+		/** @brief Destructor function */
+		~OccupancyGrid();
+
+		/**
+		 * @brief Resets the region of the grid, where all the cells are free
+		 * @param const CellRegion& Region of the (x,y) keys
+		 * @param unsigned short int Minimum z key
+		 * @param unsigned short int Number of layers (z keys)
+		 */
+		void reset(const CellRegion& region,
+				   unsigned short int min_z = 0,
+				   unsigned short int num_layers = 1);
+
+		/** @brief Clears the grid, and releases its memory */
+		void clear();
+
+		/**
+		 * @brief Sets the occupancy of a cell. The cells outside the region are ignored
+		 * @param const Key& Key of the cell
+		 * @param bool Occupancy of the cell
+		 */
+		void setOccupied(const Key& key,
+						 bool occupied = true);
+
+		/**
+		 * @brief Indicates if a cell is occupied
+		 * @param const Key& Key of the cell
+		 * @return True if it's occupied
+		 */
+		bool isOccupied(const Key& key) const;
+
+		/**
+		 * @brief Indicates if there is any occupied cell inside a box of keys
+		 * @param const Key& Minimum key of the box
+		 * @param const Key& Maximum key of the box
+		 * @return True if there is an occupied cell
+		 */
+		bool isAnyOccupied(const Key& min_key,
+						   const Key& max_key) const;
+
+		/**
+		 * @brief Indicates if there is any occupied cell inside a footprint, which is checked
+		 * in all the layers
+		 * @param const std::vector<RowSpan>& Row spans of the footprint
+		 * @return True if there is an occupied cell
+		 */
+		bool isAnyOccupied(const std::vector<RowSpan>& footprint) const;
+
+		/**
+		 * @brief Counts the occupied cells inside a box of keys
+		 * @param const Key& Minimum key of the box
+		 * @param const Key& Maximum key of the box
+		 * @return The number of occupied cells
+		 */
+		unsigned int countOccupied(const Key& min_key,
+								   const Key& max_key) const;
+
+		/** @brief Indicates if the grid doesn't have a region */
+		bool isEmpty() const;
+
+		/** @brief Gets the heap bytes of the grid, i.e. of its bit words */
+		std::size_t getHeapBytes() const;
+
+
+	private:
+		/**
+		 * @brief Clips a x span to the grid and computes its word masks
+		 * @param unsigned int& First word of the span
+		 * @param unsigned int& Last word of the span
+		 * @param uint64_t& Mask of the first word
+		 * @param uint64_t& Mask of the last word
+		 * @param unsigned short int Minimum x key
+		 * @param unsigned short int Maximum x key
+		 * @return False if the span is outside the grid
+		 */
+		bool getSpanMasks(unsigned int& first_word,
+						  unsigned int& last_word,
+						  uint64_t& first_mask,
+						  uint64_t& last_mask,
+						  unsigned short int min_x,
+						  unsigned short int max_x) const;
+
+		/**
+		 * @brief Gets the first word of a row
+		 * @param unsigned int Local y index
+		 * @param unsigned int Local z index
+		 */
+		unsigned int getRowIndex(unsigned int y,
+								 unsigned int z) const;
+
+		/** @brief Occupancy bits, where every row has words_per_row_ words */
+		std::vector<uint64_t> words_;
+
+		/** @brief Minimum keys of the grid */
+		Key min_key_;
+
+		/** @brief Number of cells per axis */
+		unsigned int size_x_;
+		unsigned int size_y_;
+		unsigned int size_z_;
+
+		/** @brief Number of words per row */
+		unsigned int words_per_row_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
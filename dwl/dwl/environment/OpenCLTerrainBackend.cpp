@@ -0,0 +1,254 @@
+#include <dwl/environment/OpenCLTerrainBackend.h>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/** @brief Number of outputs of every cell, i.e. the gradients, the features and the cost */
+static const unsigned int NUM_CELL_OUTPUTS = NumTerrainFeatures + 3;
+
+/** @brief Kernel of the terrain stencils, where the parameters are the weights and the inverse
+ * saturations of the features (the slope one as a tangent) */
+static const char* TERRAIN_FEATURES_KERNEL =
+	"#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+	"__kernel void computeTerrainFeatures(__global const double* p,\n"
+	"                                     __constant double* parameters,\n"
+	"                                     const int rows,\n"
+	"                                     const int cols,\n"
+	"                                     const int k,\n"
+	"                                     const double resolution,\n"
+	"                                     const double max_cost,\n"
+	"                                     __global double* output)\n"
+	"{\n"
+	"    int i = get_global_id(0), j = get_global_id(1);\n"
+	"    if (i >= rows || j >= cols)\n"
+	"        return;\n"
+	"\n"
+	"    int pr = rows + 2 * k;\n"
+	"    int c = (i + k) + (j + k) * pr;\n"
+	"    double gx = (p[c + 1] - p[c - 1]) / (2 * resolution);\n"
+	"    double gy = (p[c + pr] - p[c - pr]) / (2 * resolution);\n"
+	"    double slope = sqrt(gx * gx + gy * gy);\n"
+	"    double curvature = fabs((p[c + 1] + p[c - 1] + p[c + pr] + p[c - pr] - 4 * p[c]) /\n"
+	"                            (resolution * resolution));\n"
+	"\n"
+	"    double sum = 0., square_sum = 0.;\n"
+	"    for (int b = -k; b <= k; b++) {\n"
+	"        for (int a = -k; a <= k; a++) {\n"
+	"            double h = p[c + a + b * pr];\n"
+	"            sum += h;\n"
+	"            square_sum += h * h;\n"
+	"        }\n"
+	"    }\n"
+	"    double num_cells = (2 * k + 1) * (2 * k + 1);\n"
+	"    double mean = sum / num_cells;\n"
+	"    double position_variance = resolution * resolution * k * (k + 1) / 3.;\n"
+	"    double variance = square_sum / num_cells - mean * mean -\n"
+	"            slope * slope * position_variance;\n"
+	"    double roughness = sqrt(fmax(variance, 0.));\n"
+	"    double deviation = fabs(p[c] - mean);\n"
+	"\n"
+	"    int n = rows * cols, cell = i + j * rows;\n"
+	"    output[cell] = gx;\n"
+	"    output[n + cell] = gy;\n"
+	"    output[2 * n + cell] = slope;\n"
+	"    output[3 * n + cell] = curvature;\n"
+	"    output[4 * n + cell] = roughness;\n"
+	"    output[5 * n + cell] = deviation;\n"
+	"    output[6 * n + cell] = max_cost *\n"
+	"            (parameters[0] * fmin(slope * parameters[4], 1.) +\n"
+	"            parameters[1] * fmin(curvature * parameters[5], 1.) +\n"
+	"            parameters[2] * fmin(roughness * parameters[6], 1.) +\n"
+	"            parameters[3] * fmin(deviation * parameters[7], 1.));\n"
+	"}\n";
+
+
+OpenCLTerrainBackend::OpenCLTerrainBackend() : context_(NULL), queue_(NULL), program_(NULL),
+		kernel_(NULL), height_buffer_(NULL), parameter_buffer_(NULL), output_buffer_(NULL),
+		padded_capacity_(0), capacity_(0)
+{
+
+}
+
+
+OpenCLTerrainBackend::~OpenCLTerrainBackend()
+{
+	releaseBuffers();
+	if (parameter_buffer_ != NULL)
+		clReleaseMemObject(parameter_buffer_);
+	if (kernel_ != NULL)
+		clReleaseKernel(kernel_);
+	if (program_ != NULL)
+		clReleaseProgram(program_);
+	if (queue_ != NULL)
+		clReleaseCommandQueue(queue_);
+	if (context_ != NULL)
+		clReleaseContext(context_);
+}
+
+
+bool OpenCLTerrainBackend::init()
+{
+	// Getting the first GPU of the first platform, or any other device otherwise
+	cl_platform_id platform;
+	cl_uint num_platforms = 0;
+	if (clGetPlatformIDs(1, &platform, &num_platforms) != CL_SUCCESS || num_platforms == 0)
+		return false;
+
+	cl_device_id device;
+	cl_uint num_devices = 0;
+	if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, &num_devices) != CL_SUCCESS ||
+			num_devices == 0) {
+		if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, &num_devices) != CL_SUCCESS ||
+				num_devices == 0)
+			return false;
+	}
+
+	// The features are computed in double precision, as the CPU backend
+	cl_device_fp_config double_config = 0;
+	clGetDeviceInfo(device, CL_DEVICE_DOUBLE_FP_CONFIG, sizeof(double_config),
+					&double_config, NULL);
+	if (double_config == 0) {
+		printf(YELLOW "Warning: the OpenCL device doesn't support double precision\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	cl_int error;
+	context_ = clCreateContext(NULL, 1, &device, NULL, NULL, &error);
+	if (error != CL_SUCCESS)
+		return false;
+
+	queue_ = clCreateCommandQueue(context_, device, 0, &error);
+	if (error != CL_SUCCESS)
+		return false;
+
+	program_ = clCreateProgramWithSource(context_, 1, &TERRAIN_FEATURES_KERNEL, NULL, &error);
+	if (error != CL_SUCCESS)
+		return false;
+
+	if (clBuildProgram(program_, 1, &device, NULL, NULL, NULL) != CL_SUCCESS) {
+		printf(YELLOW "Warning: the OpenCL kernel of the terrain features wasn't built\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	kernel_ = clCreateKernel(program_, "computeTerrainFeatures", &error);
+	if (error != CL_SUCCESS)
+		return false;
+
+	parameter_buffer_ = clCreateBuffer(context_, CL_MEM_READ_ONLY,
+									   2 * NumTerrainFeatures * sizeof(double), NULL, &error);
+	return error == CL_SUCCESS;
+}
+
+
+bool OpenCLTerrainBackend::compute(Eigen::ArrayXXd& cost,
+								   Eigen::ArrayXXd& gradient_x,
+								   Eigen::ArrayXXd& gradient_y,
+								   Eigen::ArrayXXd* features,
+								   const Eigen::ArrayXXd& padded_height,
+								   unsigned int window_radius,
+								   double resolution,
+								   const double* weights,
+								   const double* saturations,
+								   double max_cost)
+{
+	int k = window_radius;
+	int rows = padded_height.rows() - 2 * k, cols = padded_height.cols() - 2 * k;
+	if (kernel_ == NULL || rows <= 0 || cols <= 0)
+		return false;
+
+	unsigned int num_cells = rows * cols;
+	if (!reserve(padded_height.size(), num_cells))
+		return false;
+
+	// Uploading the heights and the parameters of the features
+	double parameters[2 * NumTerrainFeatures];
+	for (unsigned int i = 0; i < NumTerrainFeatures; i++) {
+		parameters[i] = weights[i];
+		parameters[NumTerrainFeatures + i] = 1. / saturations[i];
+	}
+	parameters[NumTerrainFeatures + SlopeFeature] = 1. / tan(saturations[SlopeFeature]);
+	if (clEnqueueWriteBuffer(queue_, height_buffer_, CL_FALSE, 0,
+							 padded_height.size() * sizeof(double), padded_height.data(),
+							 0, NULL, NULL) != CL_SUCCESS ||
+			clEnqueueWriteBuffer(queue_, parameter_buffer_, CL_FALSE, 0, sizeof(parameters),
+								 parameters, 0, NULL, NULL) != CL_SUCCESS)
+		return false;
+
+	// Running a work-item per cell
+	cl_int error = clSetKernelArg(kernel_, 0, sizeof(cl_mem), &height_buffer_);
+	error |= clSetKernelArg(kernel_, 1, sizeof(cl_mem), &parameter_buffer_);
+	error |= clSetKernelArg(kernel_, 2, sizeof(int), &rows);
+	error |= clSetKernelArg(kernel_, 3, sizeof(int), &cols);
+	error |= clSetKernelArg(kernel_, 4, sizeof(int), &k);
+	error |= clSetKernelArg(kernel_, 5, sizeof(double), &resolution);
+	error |= clSetKernelArg(kernel_, 6, sizeof(double), &max_cost);
+	error |= clSetKernelArg(kernel_, 7, sizeof(cl_mem), &output_buffer_);
+	size_t global_size[2] = {(size_t) rows, (size_t) cols};
+	if (error != CL_SUCCESS ||
+			clEnqueueNDRangeKernel(queue_, kernel_, 2, NULL, global_size, NULL,
+								   0, NULL, NULL) != CL_SUCCESS)
+		return false;
+
+	// Reading the outputs directly into the arrays, where the last read blocks
+	Eigen::ArrayXXd* outputs[NUM_CELL_OUTPUTS] = {&gradient_x, &gradient_y,
+												  &features[SlopeFeature],
+												  &features[CurvatureFeature],
+												  &features[RoughnessFeature],
+												  &features[HeightDeviationFeature], &cost};
+	for (unsigned int i = 0; i < NUM_CELL_OUTPUTS; i++) {
+		outputs[i]->resize(rows, cols);
+		cl_bool blocking = (i == NUM_CELL_OUTPUTS - 1) ? CL_TRUE : CL_FALSE;
+		if (clEnqueueReadBuffer(queue_, output_buffer_, blocking,
+								i * num_cells * sizeof(double), num_cells * sizeof(double),
+								outputs[i]->data(), 0, NULL, NULL) != CL_SUCCESS) {
+			clFinish(queue_);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool OpenCLTerrainBackend::reserve(unsigned int num_padded_cells,
+								   unsigned int num_cells)
+{
+	if (num_padded_cells <= padded_capacity_ && num_cells <= capacity_)
+		return true;
+
+	releaseBuffers();
+	cl_int height_error, output_error;
+	height_buffer_ = clCreateBuffer(context_, CL_MEM_READ_ONLY,
+									num_padded_cells * sizeof(double), NULL, &height_error);
+	output_buffer_ = clCreateBuffer(context_, CL_MEM_WRITE_ONLY,
+									NUM_CELL_OUTPUTS * num_cells * sizeof(double), NULL,
+									&output_error);
+	if (height_error != CL_SUCCESS || output_error != CL_SUCCESS) {
+		releaseBuffers();
+		return false;
+	}
+
+	padded_capacity_ = num_padded_cells;
+	capacity_ = num_cells;
+	return true;
+}
+
+
+void OpenCLTerrainBackend::releaseBuffers()
+{
+	if (height_buffer_ != NULL)
+		clReleaseMemObject(height_buffer_);
+	if (output_buffer_ != NULL)
+		clReleaseMemObject(output_buffer_);
+	height_buffer_ = output_buffer_ = NULL;
+	padded_capacity_ = capacity_ = 0;
+}
+
+} //@namespace environment
+} //@namespace dwl
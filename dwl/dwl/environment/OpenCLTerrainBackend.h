@@ -0,0 +1,103 @@
+#ifndef DWL__ENVIRONMENT__OPENCL_TERRAIN_BACKEND__H
+#define DWL__ENVIRONMENT__OPENCL_TERRAIN_BACKEND__H
+
+#include <dwl/environment/TerrainFeaturePipeline.h>
+#define CL_TARGET_OPENCL_VERSION 120
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class OpenCLTerrainBackend
+ * @brief OpenCLTerrainBackend computes the stencils of the terrain feature pipeline on an
+ * OpenCL device. Every work-item computes the gradient, the features and the cost of a cell
+ * from the padded heights, i.e. the moments of the neighboring area are summed directly
+ * instead of using summed-area tables. The device buffers are reused between grids and only
+ * grow. Note that it requires double precision in the device (cl_khr_fp64). It's only built
+ * with DWL_WITH_OPENCL
+ */
+class OpenCLTerrainBackend
+{
+	public:
+		/** @brief Constructor function */
+		OpenCLTerrainBackend();
+
+		/** @brief Destructor function */
+		~OpenCLTerrainBackend();
+
+		/**
+		 * @brief Initializes the context, command queue and kernel of the first GPU (or any
+		 * other device) of the first platform
+		 * @return False if there isn't a device with double precision
+		 */
+		bool init();
+
+		/**
+		 * @brief Computes the stencils of a padded height grid
+		 * @param Eigen::ArrayXXd& Cost of the cells
+		 * @param Eigen::ArrayXXd& Height gradient along the x axis
+		 * @param Eigen::ArrayXXd& Height gradient along the y axis
+		 * @param Eigen::ArrayXXd* Features of the cells (NumTerrainFeatures arrays)
+		 * @param const Eigen::ArrayXXd& Heights padded by the radius of the neighboring area
+		 * @param unsigned int Radius of the neighboring area in cells
+		 * @param double Resolution of the plane
+		 * @param const double* Weight of every feature
+		 * @param const double* Saturation of every feature
+		 * @param double Maximum cost of a feature
+		 * @return False if the device failed
+		 */
+		bool compute(Eigen::ArrayXXd& cost,
+					 Eigen::ArrayXXd& gradient_x,
+					 Eigen::ArrayXXd& gradient_y,
+					 Eigen::ArrayXXd* features,
+					 const Eigen::ArrayXXd& padded_height,
+					 unsigned int window_radius,
+					 double resolution,
+					 const double* weights,
+					 const double* saturations,
+					 double max_cost);
+
+
+	private:
+		/**
+		 * @brief Reserves the device buffers
+		 * @param unsigned int Number of padded cells
+		 * @param unsigned int Number of cells
+		 * @return False if the buffers weren't allocated
+		 */
+		bool reserve(unsigned int num_padded_cells,
+					 unsigned int num_cells);
+
+		/** @brief Releases the device buffers */
+		void releaseBuffers();
+
+		/** @brief OpenCL objects */
+		cl_context context_;
+		cl_command_queue queue_;
+		cl_program program_;
+		cl_kernel kernel_;
+
+		/** @brief Device buffers of the padded heights, the parameters and the outputs (the
+		 * gradients, features and cost of every cell) */
+		cl_mem height_buffer_;
+		cl_mem parameter_buffer_;
+		cl_mem output_buffer_;
+
+		/** @brief Capacity of the device buffers in cells */
+		unsigned int padded_capacity_;
+		unsigned int capacity_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
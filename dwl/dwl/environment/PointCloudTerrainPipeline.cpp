@@ -0,0 +1,250 @@
+#include <dwl/environment/PointCloudTerrainPipeline.h>
+#include <dwl/utils/TaskScheduler.h>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+PointCloudTerrainPipeline::PointCloudTerrainPipeline() : space_discretization_(0.04),
+		num_threads_(1), min_points_(1), max_cells_(1 << 22), num_discarded_points_(0)
+{
+
+}
+
+
+PointCloudTerrainPipeline::~PointCloudTerrainPipeline()
+{
+
+}
+
+
+void PointCloudTerrainPipeline::setResolution(double plane_resolution,
+											  double height_resolution)
+{
+	space_discretization_.setEnvironmentResolution(plane_resolution, true);
+	space_discretization_.setEnvironmentResolution(height_resolution, false);
+	feature_pipeline_.setResolution(plane_resolution, height_resolution);
+}
+
+
+void PointCloudTerrainPipeline::setNumberOfThreads(unsigned int num_threads)
+{
+	num_threads_ = num_threads;
+}
+
+
+void PointCloudTerrainPipeline::setMinimumPoints(unsigned int min_points)
+{
+	min_points_ = std::max(min_points, 1u);
+}
+
+
+void PointCloudTerrainPipeline::setMaximumCells(unsigned int max_cells)
+{
+	max_cells_ = max_cells;
+}
+
+
+TerrainFeaturePipeline& PointCloudTerrainPipeline::getFeaturePipeline()
+{
+	return feature_pipeline_;
+}
+
+
+bool PointCloudTerrainPipeline::compute(TerrainData& terrain_update,
+										const Eigen::Matrix3Xd& points)
+{
+	terrain_update.plane_size = space_discretization_.getEnvironmentResolution(true);
+	terrain_update.height_size = space_discretization_.getEnvironmentResolution(false);
+	terrain_update.data.clear();
+	unsigned int num_points = points.cols();
+	num_discarded_points_ = num_points;
+	if (num_points == 0)
+		return false;
+
+	unsigned int num_threads = num_threads_;
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::max(std::min(num_threads, num_points), 1u);
+
+	// Computing the bounding box of the keys of every chunk
+	std::vector<CellRegion> bounds(num_threads);
+	runInParallel([&](unsigned int thread, unsigned int first, unsigned int last) {
+		Key key(0, 0, 0);
+		for (unsigned int k = first; k < last; k++) {
+			if (getPointKey(key.x, key.y, points.col(k)))
+				bounds[thread].add(key);
+		}
+	}, num_points, num_threads);
+
+	CellRegion region;
+	for (unsigned int t = 0; t < num_threads; t++) {
+		if (!bounds[t].empty) {
+			region.add(bounds[t].min_key);
+			region.add(bounds[t].max_key);
+		}
+	}
+	if (region.empty)
+		return false;
+
+	unsigned int rows = region.max_key.x - region.min_key.x + 1;
+	unsigned int cols = region.max_key.y - region.min_key.y + 1;
+	if ((unsigned long) rows * cols > max_cells_) {
+		printf(YELLOW "Warning: the point batch covers %lu cells, i.e. more than the maximum"
+				" number of cells\n" COLOR_RESET, (unsigned long) rows * cols);
+		return false;
+	}
+
+	// Binning every chunk in its own partial grid, i.e. the number of points and the highest
+	// point of every cell. The cells are indexed as the (column-major) height grid
+	unsigned int num_cells = rows * cols;
+	partial_grids_.resize(num_threads);
+	runInParallel([&](unsigned int thread, unsigned int first, unsigned int last) {
+		PartialGrid& grid = partial_grids_[thread];
+		grid.max_height.assign(num_cells, -std::numeric_limits<double>::max());
+		grid.num_points.assign(num_cells, 0);
+
+		unsigned short int key_x, key_y;
+		for (unsigned int k = first; k < last; k++) {
+			if (!getPointKey(key_x, key_y, points.col(k)))
+				continue;
+
+			unsigned int cell = (key_x - region.min_key.x) + (key_y - region.min_key.y) * rows;
+			grid.num_points[cell]++;
+			grid.max_height[cell] = std::max(grid.max_height[cell], points(rbd::Z, k));
+		}
+	}, num_points, num_threads);
+
+	// Merging the partial grids over contiguous chunks of cells
+	height_.resize(rows, cols);
+	observed_.resize(rows, cols);
+	std::vector<unsigned int> num_binned_points(num_threads, 0);
+	runInParallel([&](unsigned int thread, unsigned int first, unsigned int last) {
+		for (unsigned int cell = first; cell < last; cell++) {
+			unsigned int cell_points = 0;
+			double max_height = -std::numeric_limits<double>::max();
+			for (unsigned int t = 0; t < partial_grids_.size(); t++) {
+				cell_points += partial_grids_[t].num_points[cell];
+				max_height = std::max(max_height, partial_grids_[t].max_height[cell]);
+			}
+
+			observed_(cell) = (cell_points >= min_points_) ? 1 : 0;
+			height_(cell) = max_height;
+			if (observed_(cell) != 0)
+				num_binned_points[thread] += cell_points;
+		}
+	}, num_cells, std::min(num_threads, num_cells));
+
+	num_discarded_points_ = num_points;
+	for (unsigned int t = 0; t < num_threads; t++)
+		num_discarded_points_ -= num_binned_points[t];
+	if (num_discarded_points_ == num_points)
+		return false;
+
+	// Computing the costs and normals of the observed cells
+	fillUnobservedCells();
+	Eigen::Vector2d origin;
+	space_discretization_.keyToCoord(origin(rbd::X), region.min_key.x, true);
+	space_discretization_.keyToCoord(origin(rbd::Y), region.min_key.y, true);
+	feature_pipeline_.computeTerrainData(terrain_update, height_, origin, &observed_);
+
+	return !terrain_update.data.empty();
+}
+
+
+bool PointCloudTerrainPipeline::update(TerrainMap& terrain,
+									   const Eigen::Matrix3Xd& points)
+{
+	if (!compute(terrain_update_, points))
+		return false;
+
+	return terrain.updateTerrainMap(terrain_update_);
+}
+
+
+unsigned int PointCloudTerrainPipeline::getNumberOfDiscardedPoints() const
+{
+	return num_discarded_points_;
+}
+
+
+void PointCloudTerrainPipeline::runInParallel(const std::function<void(unsigned int,
+																	   unsigned int,
+																	   unsigned int)>& task,
+											  unsigned int size,
+											  unsigned int num_threads)
+{
+	num_threads = std::max(num_threads, 1u);
+	unsigned int chunk_size = (size + num_threads - 1) / num_threads;
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, size);
+		task(t, first, std::min(first + chunk_size, size));
+	});
+}
+
+
+bool PointCloudTerrainPipeline::getPointKey(unsigned short int& key_x,
+											unsigned short int& key_y,
+											const Eigen::Vector3d& point) const
+{
+	if (!point.allFinite())
+		return false;
+
+	return space_discretization_.coordToKeyChecked(key_x, point(rbd::X), true) &&
+			space_discretization_.coordToKeyChecked(key_y, point(rbd::Y), true);
+}
+
+
+void PointCloudTerrainPipeline::fillUnobservedCells()
+{
+	// Filling the cells of every column (x axis) with the closest observed cell of the column
+	unsigned int rows = height_.rows(), cols = height_.cols();
+	std::vector<bool> filled_cols(cols, false);
+	for (unsigned int j = 0; j < cols; j++) {
+		int last = -1;
+		for (unsigned int i = 0; i < rows; i++) {
+			if (observed_(i, j) == 0)
+				continue;
+
+			// Filling the gap up to the middle from both sides
+			unsigned int first_gap = (last < 0) ? 0 : last + 1;
+			for (unsigned int k = first_gap; k < i; k++) {
+				if (last < 0 || k - last > i - k)
+					height_(k, j) = height_(i, j);
+				else
+					height_(k, j) = height_(last, j);
+			}
+			last = i;
+		}
+		if (last < 0)
+			continue;
+
+		for (unsigned int k = last + 1; k < rows; k++)
+			height_(k, j) = height_(last, j);
+		filled_cols[j] = true;
+	}
+
+	// Filling the columns without observed cells with the closest filled column
+	int last = -1;
+	for (unsigned int j = 0; j < cols; j++) {
+		if (!filled_cols[j])
+			continue;
+
+		unsigned int first_gap = (last < 0) ? 0 : last + 1;
+		for (unsigned int k = first_gap; k < j; k++) {
+			if (last < 0 || k - last > j - k)
+				height_.col(k) = height_.col(j);
+			else
+				height_.col(k) = height_.col(last);
+		}
+		last = j;
+	}
+	for (unsigned int k = last + 1; k < cols; k++)
+		height_.col(k) = height_.col(last);
+}
+
+} //@namespace environment
+} //@namespace dwl
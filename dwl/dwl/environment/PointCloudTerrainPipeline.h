@@ -0,0 +1,158 @@
+#ifndef DWL__ENVIRONMENT__POINT_CLOUD_TERRAIN_PIPELINE__H
+#define DWL__ENVIRONMENT__POINT_CLOUD_TERRAIN_PIPELINE__H
+
+#include <dwl/environment/TerrainMap.h>
+#include <dwl/environment/TerrainFeaturePipeline.h>
+#include <functional>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class PointCloudTerrainPipeline
+ * @brief PointCloudTerrainPipeline converts batches of raw points (e.g. from depth cameras or
+ * lidars) into incremental updates of the terrain map. Every thread bins a contiguous chunk of
+ * the batch into its own partial grid of the bounding box of the batch, i.e. the number of
+ * points and the highest point of every cell are accumulated in a single pass without locks.
+ * The partial grids are merged in parallel as well, and the cells with enough points are the
+ * observed cells of the update. Their costs and normals are computed at once by the terrain
+ * feature pipeline, where the unobserved cells of the grid are filled with the closest
+ * observed height for the stencils. The non-finite points and the points outside the keys
+ * of the space discretization are discarded
+ */
+class PointCloudTerrainPipeline
+{
+	public:
+		/** @brief Constructor function */
+		PointCloudTerrainPipeline();
+
+		/** @brief Destructor function */
+		~PointCloudTerrainPipeline();
+
+		/**
+		 * @brief Sets the resolution of the terrain cells
+		 * @param double Resolution of the plane
+		 * @param double Resolution of the height
+		 */
+		void setResolution(double plane_resolution,
+						   double height_resolution);
+
+		/**
+		 * @brief Sets the number of threads of the pipeline
+		 * @param unsigned int Number of threads (0 uses the hardware concurrency)
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * @brief Sets the minimum number of points of an observed cell, which rejects the
+		 * isolated outliers. The default value is one point
+		 * @param unsigned int Minimum number of points
+		 */
+		void setMinimumPoints(unsigned int min_points);
+
+		/**
+		 * @brief Sets the maximum number of cells of the bounding box of a batch, which limits
+		 * the memory of the partial grids
+		 * @param unsigned int Maximum number of cells
+		 */
+		void setMaximumCells(unsigned int max_cells);
+
+		/** @brief Gets the feature pipeline for setting up the cost of the cells */
+		TerrainFeaturePipeline& getFeaturePipeline();
+
+		/**
+		 * @brief Computes the terrain cells observed by a batch of points
+		 * @param TerrainData& Observed terrain cells
+		 * @param const Eigen::Matrix3Xd& Points of the batch in the world frame
+		 * @return False if there isn't an observed cell or the batch is too large
+		 */
+		bool compute(TerrainData& terrain_update,
+					 const Eigen::Matrix3Xd& points);
+
+		/**
+		 * @brief Updates incrementally a terrain map with the cells observed by a batch of
+		 * points
+		 * @param TerrainMap& Terrain map
+		 * @param const Eigen::Matrix3Xd& Points of the batch in the world frame
+		 * @return True if the terrain map was updated
+		 */
+		bool update(TerrainMap& terrain,
+					const Eigen::Matrix3Xd& points);
+
+		/** @brief Gets the number of discarded points of the last batch */
+		unsigned int getNumberOfDiscardedPoints() const;
+
+
+	private:
+		/** @brief Accumulated values of the cells of a thread */
+		struct PartialGrid
+		{
+			std::vector<double> max_height;
+			std::vector<unsigned int> num_points;
+		};
+
+		/**
+		 * @brief Runs a task over contiguous chunks of a range with the task scheduler, where
+		 * the thread index is the index of the chunk
+		 * @param const std::function<void(unsigned int, unsigned int, unsigned int)>& Task of a
+		 * chunk, i.e. its thread index and first and last elements
+		 * @param unsigned int Size of the range
+		 * @param unsigned int Number of threads
+		 */
+		void runInParallel(const std::function<void(unsigned int,
+													unsigned int,
+													unsigned int)>& task,
+						   unsigned int size,
+						   unsigned int num_threads);
+
+		/**
+		 * @brief Gets the plane keys of a point
+		 * @param unsigned short int& Key of the x axis
+		 * @param unsigned short int& Key of the y axis
+		 * @param const Eigen::Vector3d& Point
+		 * @return False if the point is discarded
+		 */
+		bool getPointKey(unsigned short int& key_x,
+						 unsigned short int& key_y,
+						 const Eigen::Vector3d& point) const;
+
+		/** @brief Fills the unobserved cells with the closest observed height */
+		void fillUnobservedCells();
+
+		/** @brief Object of the SpaceDiscretization class for computing the cell keys */
+		SpaceDiscretization space_discretization_;
+
+		/** @brief Pipeline of the terrain features */
+		TerrainFeaturePipeline feature_pipeline_;
+
+		/** @brief Partial grids of the threads (reused between batches) */
+		std::vector<PartialGrid> partial_grids_;
+
+		/** @brief Heights and observed cells of the merged grid */
+		Eigen::ArrayXXd height_;
+		Eigen::ArrayXXi observed_;
+
+		/** @brief Terrain update of the last batch */
+		TerrainData terrain_update_;
+
+		/** @brief Number of threads */
+		unsigned int num_threads_;
+
+		/** @brief Minimum number of points of an observed cell */
+		unsigned int min_points_;
+
+		/** @brief Maximum number of cells of a batch */
+		unsigned int max_cells_;
+
+		/** @brief Number of discarded points of the last batch */
+		unsigned int num_discarded_points_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
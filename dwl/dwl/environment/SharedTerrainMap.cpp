@@ -0,0 +1,52 @@
+#include <dwl/environment/SharedTerrainMap.h>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+SharedTerrainMap::SharedTerrainMap() : snapshot_(std::make_shared<const TerrainMap>()),
+		num_publications_(0)
+{
+
+}
+
+
+SharedTerrainMap::~SharedTerrainMap()
+{
+
+}
+
+
+TerrainMap& SharedTerrainMap::getWriteMap()
+{
+	return working_map_;
+}
+
+
+unsigned long SharedTerrainMap::publish()
+{
+	// Copying the working map only shares its tiles and cells, which are cloned by the next
+	// modifications of the working map
+	std::shared_ptr<const TerrainMap> snapshot = std::make_shared<const TerrainMap>(working_map_);
+	std::atomic_store(&snapshot_, snapshot);
+
+	return num_publications_.fetch_add(1) + 1;
+}
+
+
+std::shared_ptr<const TerrainMap> SharedTerrainMap::acquire() const
+{
+	return std::atomic_load(&snapshot_);
+}
+
+
+unsigned long SharedTerrainMap::getNumberOfPublications() const
+{
+	return num_publications_.load();
+}
+
+} //@namespace environment
+} //@namespace dwl
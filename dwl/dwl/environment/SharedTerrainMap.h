@@ -0,0 +1,70 @@
+#ifndef DWL__ENVIRONMENT__SHARED_TERRAIN_MAP__H
+#define DWL__ENVIRONMENT__SHARED_TERRAIN_MAP__H
+
+#include <dwl/environment/TerrainMap.h>
+#include <atomic>
+#include <memory>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class SharedTerrainMap
+ * @brief SharedTerrainMap shares the terrain map between a mapping thread and planning threads
+ * with read-copy-update semantics. The mapping thread modifies its working map and publishes
+ * immutable snapshots of it, and the planners acquire the last snapshot, i.e. they read a
+ * consistent version that isn't modified while they plan, and the mapping never waits for them.
+ * A snapshot is a copy of the working map, which is cheap since its tiles and cells are shared
+ * (copy-on-write) until the mapping modifies them. The planners that need a TerrainMap* can
+ * also copy the snapshot cheaply
+ */
+class SharedTerrainMap
+{
+	public:
+		/** @brief Constructor function */
+		SharedTerrainMap();
+
+		/** @brief Destructor function */
+		~SharedTerrainMap();
+
+		/**
+		 * @brief Gets the working map of the mapping thread, which can be modified until it's
+		 * published. Note that only the mapping thread can use it
+		 */
+		TerrainMap& getWriteMap();
+
+		/**
+		 * @brief Publishes a snapshot of the working map
+		 * @return The number of publications, i.e. the version of the snapshot
+		 */
+		unsigned long publish();
+
+		/**
+		 * @brief Acquires the last published snapshot, which is kept alive while it's used
+		 * @return The snapshot of the terrain map
+		 */
+		std::shared_ptr<const TerrainMap> acquire() const;
+
+		/** @brief Gets the number of publications */
+		unsigned long getNumberOfPublications() const;
+
+
+	private:
+		/** @brief Working map of the mapping thread */
+		TerrainMap working_map_;
+
+		/** @brief Last published snapshot, which is accessed atomically */
+		std::shared_ptr<const TerrainMap> snapshot_;
+
+		/** @brief Number of publications */
+		std::atomic<unsigned long> num_publications_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
@@ -1,5 +1,10 @@
 #include <dwl/environment/SpaceDiscretization.h>
+#include <algorithm>
 #include <iostream>
+#include <stdint.h>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 
 namespace dwl
@@ -8,15 +13,88 @@ namespace dwl
 namespace environment
 {
 
+/** @brief Spreads the 16 bits of a key to the even bits of a word */
+inline uint64_t spreadBits2d(uint64_t key)
+{
+#if defined(__BMI2__)
+	return _pdep_u64(key, 0x5555555555555555ULL);
+#else
+	key &= 0xffff;
+	key = (key | (key << 8)) & 0x00ff00ffULL;
+	key = (key | (key << 4)) & 0x0f0f0f0fULL;
+	key = (key | (key << 2)) & 0x33333333ULL;
+	key = (key | (key << 1)) & 0x55555555ULL;
+	return key;
+#endif
+}
+
+
+/** @brief Compacts the even bits of a word to a 16-bit key */
+inline unsigned short int compactBits2d(uint64_t word)
+{
+#if defined(__BMI2__)
+	return (unsigned short int) _pext_u64(word, 0x5555555555555555ULL);
+#else
+	word &= 0x55555555ULL;
+	word = (word | (word >> 1)) & 0x33333333ULL;
+	word = (word | (word >> 2)) & 0x0f0f0f0fULL;
+	word = (word | (word >> 4)) & 0x00ff00ffULL;
+	word = (word | (word >> 8)) & 0x0000ffffULL;
+	return (unsigned short int) word;
+#endif
+}
+
+
+/** @brief Spreads the 16 bits of a key to every third bit of a word */
+inline uint64_t spreadBits3d(uint64_t key)
+{
+#if defined(__BMI2__)
+	return _pdep_u64(key, 0x1249249249249249ULL);
+#else
+	key &= 0xffff;
+	key = (key | (key << 32)) & 0x001f00000000ffffULL;
+	key = (key | (key << 16)) & 0x001f0000ff0000ffULL;
+	key = (key | (key << 8)) & 0x100f00f00f00f00fULL;
+	key = (key | (key << 4)) & 0x10c30c30c30c30c3ULL;
+	key = (key | (key << 2)) & 0x1249249249249249ULL;
+	return key;
+#endif
+}
+
+
+/** @brief Compacts every third bit of a word to a 16-bit key */
+inline unsigned short int compactBits3d(uint64_t word)
+{
+#if defined(__BMI2__)
+	return (unsigned short int) _pext_u64(word, 0x1249249249249249ULL);
+#else
+	word &= 0x1249249249249249ULL;
+	word = (word | (word >> 2)) & 0x10c30c30c30c30c3ULL;
+	word = (word | (word >> 4)) & 0x100f00f00f00f00fULL;
+	word = (word | (word >> 8)) & 0x001f0000ff0000ffULL;
+	word = (word | (word >> 16)) & 0x001f00000000ffffULL;
+	word = (word | (word >> 32)) & 0x000000000000ffffULL;
+	return (unsigned short int) word;
+#endif
+}
+
+
+/** @brief Number of points per block of the batched conversions */
+static const unsigned int BatchBlockSize = 256;
+
+
 SpaceDiscretization::SpaceDiscretization(double environment_resolution) :
 		plane_resolution_(environment_resolution),
 		height_resolution_(environment_resolution),
 		position_resolution_(0), angular_resolution_(0),
-		max_key_val_(32768)
+		max_key_val_(32768), ordering_(RowMajor), is_state_window_(false),
+		window_center_(Eigen::Vector2d::Zero()), window_size_(Eigen::Vector2d::Zero()),
+		window_key_x_(0), window_key_y_(0), window_count_x_(0), window_count_y_(0)
 {
 	max_key_count_ = std::numeric_limits<unsigned short int>::max() + 1;
 	max_position_count_ = std::numeric_limits<unsigned short int>::max() + 1;
 	max_angular_count_ = ceil(2 * M_PI / angular_resolution_) + 1;
+	updateReciprocalResolutions();
 }
 
 
@@ -26,11 +104,14 @@ SpaceDiscretization::SpaceDiscretization(double environment_resolution,
 		height_resolution_(environment_resolution),
 		position_resolution_(position_resolution),
 		angular_resolution_(0),
-		max_key_val_(32768)
+		max_key_val_(32768), ordering_(RowMajor), is_state_window_(false),
+		window_center_(Eigen::Vector2d::Zero()), window_size_(Eigen::Vector2d::Zero()),
+		window_key_x_(0), window_key_y_(0), window_count_x_(0), window_count_y_(0)
 {
 	max_key_count_ = std::numeric_limits<unsigned short int>::max() + 1;
 	max_position_count_ = std::numeric_limits<unsigned short int>::max() + 1;
 	max_angular_count_ = ceil(2 * M_PI / angular_resolution_) + 1;
+	updateReciprocalResolutions();
 }
 
 
@@ -41,11 +122,14 @@ SpaceDiscretization::SpaceDiscretization(double environment_resolution,
 		height_resolution_(environment_resolution),
 		position_resolution_(position_resolution),
 		angular_resolution_(angular_resolution),
-		max_key_val_(32768)
+		max_key_val_(32768), ordering_(RowMajor), is_state_window_(false),
+		window_center_(Eigen::Vector2d::Zero()), window_size_(Eigen::Vector2d::Zero()),
+		window_key_x_(0), window_key_y_(0), window_count_x_(0), window_count_y_(0)
 {
 	max_key_count_ = std::numeric_limits<unsigned short int>::max() + 1;
 	max_position_count_ = std::numeric_limits<unsigned short int>::max() + 1;
 	max_angular_count_ = ceil(2 * M_PI / angular_resolution_) + 1;
+	updateReciprocalResolutions();
 }
 
 
@@ -93,9 +177,9 @@ void SpaceDiscretization::coordToKey(unsigned short int& key,
 									 bool plane) const
 {
 	if (plane)
-		key = (unsigned short int) (floor(coordinate / plane_resolution_) + max_key_val_);
+		key = (unsigned short int) (floor(coordinate * inv_plane_resolution_) + max_key_val_);
 	else
-		key = (unsigned short int) (floor(coordinate / height_resolution_) + max_key_val_);
+		key = (unsigned short int) (floor(coordinate * inv_height_resolution_) + max_key_val_);
 }
 
 
@@ -115,9 +199,9 @@ void SpaceDiscretization::keyToVertex(Vertex& vertex,
 									  bool plane) const
 {
 	if (plane)
-		vertex = key.y + max_key_count_ * key.x;
+		vertex = encodeVertex(key.x, key.y, max_key_count_);
 	else
-		vertex = key.z + max_key_count_ * key.y + max_key_count_ * max_key_count_ * key.x;
+		vertex = encodeVertex(key.x, key.y, key.z, max_key_count_, max_key_count_);
 }
 
 
@@ -125,14 +209,10 @@ void SpaceDiscretization::vertexToKey(Key& key,
 									  const Vertex& vertex,
 									  bool plane) const
 {
-	if (plane) {
-		key.x = floor(vertex / max_key_count_);
-		key.y = vertex - max_key_count_ * key.x;
-	} else {
-		key.x = floor(vertex / (max_key_count_ * max_key_count_));
-		key.y = floor(vertex / max_key_count_) - max_key_count_ * key.x;
-		key.z = vertex - max_key_count_ * key.y - max_key_count_ * max_key_count_ * key.x;
-	}
+	if (plane)
+		decodeVertex(key.x, key.y, vertex, max_key_count_);
+	else
+		decodeVertex(key.x, key.y, key.z, vertex, max_key_count_, max_key_count_);
 }
 
 
@@ -199,7 +279,7 @@ void SpaceDiscretization::stateToKey(unsigned short int& key,
 			printf(RED "Could not get the key because it was not defined the"
 					" position resolution\n" COLOR_RESET);
 		else
-			key = (unsigned short int) (floor(state / position_resolution_) + max_key_val_);
+			key = (unsigned short int) (floor(state * inv_position_resolution_) + max_key_val_);
 	}
 	else {
 		if (angular_resolution_ == 0)
@@ -246,7 +326,7 @@ void SpaceDiscretization::stateToVertex(Vertex& vertex,
 	stateToKey(key_x, (double) state(rbd::X), true);
 	stateToKey(key_y, (double) state(rbd::Y), true);
 
-	vertex = (unsigned long int) (key_y + max_position_count_ * key_x);
+	vertex = encodeStateVertex(key_x, key_y);
 }
 
 
@@ -259,17 +339,20 @@ void SpaceDiscretization::stateToVertex(Vertex& vertex,
 	stateToKey(key_y, (double) state(rbd::Y), true);
 	stateToKey(key_yaw, (double) state(rbd::Z), false);
 
-	vertex = (unsigned long int) key_yaw + max_angular_count_ * key_y +
-			max_angular_count_ * max_position_count_ * key_x;
+	vertex = encodeStateVertex(key_x, key_y, key_yaw);
 }
 
 
 void SpaceDiscretization::vertexToState(Eigen::Vector2d& state,
 										const Vertex& vertex) const
 {
-	unsigned long int max_count = std::numeric_limits<unsigned short int>::max() + 1;
-	unsigned short int key_x = floor(vertex / (max_count));
-	unsigned short int key_y = vertex - max_count * key_x;
+	unsigned short int key_x, key_y;
+	Vertex num_window_vertices = getNumberOfWindowVertices(XY);
+	if (vertex < num_window_vertices) {
+		key_x = window_key_x_ + vertex / window_count_y_;
+		key_y = window_key_y_ + vertex % window_count_y_;
+	} else
+		decodeVertex(key_x, key_y, vertex - num_window_vertices, max_position_count_);
 
 	double x, y;
 	keyToState(x, key_x, true);
@@ -283,10 +366,17 @@ void SpaceDiscretization::vertexToState(Eigen::Vector2d& state,
 void SpaceDiscretization::vertexToState(Eigen::Vector3d& state,
 										const Vertex& vertex) const
 {
-	unsigned short int key_x = floor(vertex / (max_position_count_ * max_angular_count_));
-	unsigned short int key_y = floor(vertex / max_angular_count_) - max_position_count_ * key_x;
-	unsigned short int key_yaw = vertex - max_angular_count_ * key_y -
-			max_angular_count_ * max_position_count_ * key_x;
+	unsigned short int key_x, key_y, key_yaw;
+	Vertex num_window_vertices = getNumberOfWindowVertices(XY_Y);
+	if (vertex < num_window_vertices) {
+		unsigned long int count_yaw = getWindowAngularCount();
+		key_yaw = vertex % count_yaw;
+		Vertex position_vertex = vertex / count_yaw;
+		key_x = window_key_x_ + position_vertex / window_count_y_;
+		key_y = window_key_y_ + position_vertex % window_count_y_;
+	} else
+		decodeVertex(key_x, key_y, key_yaw, vertex - num_window_vertices,
+					 max_position_count_, max_angular_count_);
 
 	double x, y, yaw;
 	keyToState(x, key_x, true);
@@ -327,6 +417,167 @@ void SpaceDiscretization::stateVertexToEnvironmentVertex(Vertex& environment_ver
 }
 
 
+unsigned int SpaceDiscretization::coordToKeyChecked(std::vector<Key>& keys,
+													std::vector<bool>& valid,
+													const Eigen::Matrix3Xd& coordinates) const
+{
+	unsigned int num_points = coordinates.cols();
+	keys.resize(num_points);
+	valid.resize(num_points);
+
+	// Scaling the coordinates by blocks, where a key is valid if it's within the range of keys
+	// (the NaN coordinates are invalid too)
+	Eigen::Array3d scale(inv_plane_resolution_, inv_plane_resolution_, inv_height_resolution_);
+	Eigen::Array<double,3,BatchBlockSize> scaled;
+	double max_key = 2. * max_key_val_;
+	unsigned int num_valid = 0;
+	for (unsigned int first = 0; first < num_points; first += BatchBlockSize) {
+		unsigned int size = std::min(BatchBlockSize, num_points - first);
+		scaled.leftCols(size) = (coordinates.middleCols(first, size).array().colwise() *
+				scale).floor() + max_key_val_;
+		for (unsigned int i = 0; i < size; i++) {
+			bool is_valid = (scaled.col(i) >= 0.).all() && (scaled.col(i) < max_key).all();
+			valid[first + i] = is_valid;
+			if (is_valid) {
+				keys[first + i] = Key((unsigned short int) scaled(0,i),
+									  (unsigned short int) scaled(1,i),
+									  (unsigned short int) scaled(2,i));
+				num_valid++;
+			} else
+				keys[first + i] = Key();
+		}
+	}
+
+	return num_valid;
+}
+
+
+void SpaceDiscretization::coordToVertex(std::vector<Vertex>& vertices,
+										const Eigen::Matrix2Xd& coordinates) const
+{
+	unsigned int num_points = coordinates.cols();
+	vertices.resize(num_points);
+
+	Eigen::Array<double,2,BatchBlockSize> scaled;
+	for (unsigned int first = 0; first < num_points; first += BatchBlockSize) {
+		unsigned int size = std::min(BatchBlockSize, num_points - first);
+		scaled.leftCols(size) = (coordinates.middleCols(first, size).array() *
+				inv_plane_resolution_).floor() + max_key_val_;
+		for (unsigned int i = 0; i < size; i++)
+			vertices[first + i] = encodeVertex((unsigned short int) (int) scaled(0,i),
+											   (unsigned short int) (int) scaled(1,i),
+											   max_key_count_);
+	}
+}
+
+
+void SpaceDiscretization::coordToVertex(std::vector<Vertex>& vertices,
+										const Eigen::Matrix3Xd& coordinates) const
+{
+	unsigned int num_points = coordinates.cols();
+	vertices.resize(num_points);
+
+	Eigen::Array3d scale(inv_plane_resolution_, inv_plane_resolution_, inv_height_resolution_);
+	Eigen::Array<double,3,BatchBlockSize> scaled;
+	for (unsigned int first = 0; first < num_points; first += BatchBlockSize) {
+		unsigned int size = std::min(BatchBlockSize, num_points - first);
+		scaled.leftCols(size) = (coordinates.middleCols(first, size).array().colwise() *
+				scale).floor() + max_key_val_;
+		for (unsigned int i = 0; i < size; i++)
+			vertices[first + i] = encodeVertex((unsigned short int) (int) scaled(0,i),
+											   (unsigned short int) (int) scaled(1,i),
+											   (unsigned short int) (int) scaled(2,i),
+											   max_key_count_, max_key_count_);
+	}
+}
+
+
+void SpaceDiscretization::vertexToCoord(Eigen::Matrix2Xd& coordinates,
+										const std::vector<Vertex>& vertices) const
+{
+	// Decoding the keys, and scaling them to the cell centers at once
+	unsigned int num_vertices = vertices.size();
+	coordinates.resize(2, num_vertices);
+	for (unsigned int i = 0; i < num_vertices; i++) {
+		unsigned short int key_x, key_y;
+		decodeVertex(key_x, key_y, vertices[i], max_key_count_);
+		coordinates(rbd::X,i) = key_x;
+		coordinates(rbd::Y,i) = key_y;
+	}
+	coordinates = ((coordinates.array() - max_key_val_ + 0.5) * plane_resolution_).matrix();
+}
+
+
+void SpaceDiscretization::vertexToCoord(Eigen::Matrix3Xd& coordinates,
+										const std::vector<Vertex>& vertices) const
+{
+	unsigned int num_vertices = vertices.size();
+	coordinates.resize(3, num_vertices);
+	for (unsigned int i = 0; i < num_vertices; i++) {
+		unsigned short int key_x, key_y, key_z;
+		decodeVertex(key_x, key_y, key_z, vertices[i], max_key_count_, max_key_count_);
+		coordinates(rbd::X,i) = key_x;
+		coordinates(rbd::Y,i) = key_y;
+		coordinates(rbd::Z,i) = key_z;
+	}
+	Eigen::Array3d resolution(plane_resolution_, plane_resolution_, height_resolution_);
+	coordinates = ((coordinates.array() - max_key_val_ + 0.5).colwise() * resolution).matrix();
+}
+
+
+void SpaceDiscretization::stateToVertex(std::vector<Vertex>& vertices,
+										const Eigen::Matrix2Xd& states) const
+{
+	if (position_resolution_ == 0) {
+		printf(RED "Could not get the vertexes because it was not defined the"
+				" position resolution\n" COLOR_RESET);
+		return;
+	}
+
+	unsigned int num_states = states.cols();
+	vertices.resize(num_states);
+
+	Eigen::Array<double,2,BatchBlockSize> scaled;
+	for (unsigned int first = 0; first < num_states; first += BatchBlockSize) {
+		unsigned int size = std::min(BatchBlockSize, num_states - first);
+		scaled.leftCols(size) = (states.middleCols(first, size).array() *
+				inv_position_resolution_).floor() + max_key_val_;
+		for (unsigned int i = 0; i < size; i++)
+			vertices[first + i] = encodeStateVertex((unsigned short int) (int) scaled(0,i),
+													(unsigned short int) (int) scaled(1,i));
+	}
+}
+
+
+void SpaceDiscretization::stateToVertex(std::vector<Vertex>& vertices,
+										const Eigen::Matrix3Xd& states) const
+{
+	if (position_resolution_ == 0) {
+		printf(RED "Could not get the vertexes because it was not defined the"
+				" position resolution\n" COLOR_RESET);
+		return;
+	}
+
+	// Scaling the positions by blocks, where the yaw is normalized per state
+	unsigned int num_states = states.cols();
+	vertices.resize(num_states);
+
+	Eigen::Array<double,2,BatchBlockSize> scaled;
+	for (unsigned int first = 0; first < num_states; first += BatchBlockSize) {
+		unsigned int size = std::min(BatchBlockSize, num_states - first);
+		scaled.leftCols(size) = (states.block(0, first, 2, size).array() *
+				inv_position_resolution_).floor() + max_key_val_;
+		for (unsigned int i = 0; i < size; i++) {
+			unsigned short int key_yaw;
+			stateToKey(key_yaw, (double) states(rbd::Z, first + i), false);
+			vertices[first + i] = encodeStateVertex((unsigned short int) (int) scaled(0,i),
+													(unsigned short int) (int) scaled(1,i),
+													key_yaw);
+		}
+	}
+}
+
+
 double SpaceDiscretization::getEnvironmentResolution(bool plane) const
 {
 	double resolution;
@@ -358,6 +609,7 @@ void SpaceDiscretization::setEnvironmentResolution(double resolution,
 		plane_resolution_ = resolution;
 	else
 		height_resolution_ = resolution;
+	updateReciprocalResolutions();
 }
 
 
@@ -365,10 +617,209 @@ void SpaceDiscretization::setStateResolution(double position_resolution,
 											 double angular_resolution)
 {
 	position_resolution_ = position_resolution;
+	updateReciprocalResolutions();
 	if (angular_resolution != 0) {
 		angular_resolution_ = angular_resolution;
 		max_angular_count_ = ceil(2 * M_PI / angular_resolution_) + 1;
 	}
+
+	if (is_state_window_)
+		updateStateWindow();
+}
+
+void SpaceDiscretization::setVertexOrdering(VertexOrdering ordering)
+{
+	ordering_ = ordering;
+}
+
+
+VertexOrdering SpaceDiscretization::getVertexOrdering() const
+{
+	return ordering_;
+}
+
+
+bool SpaceDiscretization::setStateWindow(const Eigen::Vector2d& center,
+										 const Eigen::Vector2d& size)
+{
+	if (position_resolution_ == 0) {
+		printf(RED "FATAL: could not set the state window because it was not defined the"
+				" position resolution\n" COLOR_RESET);
+		return false;
+	}
+
+	unsigned short int last_key_x = window_key_x_, last_key_y = window_key_y_;
+	unsigned long int last_count_x = window_count_x_, last_count_y = window_count_y_;
+	bool was_state_window = is_state_window_;
+
+	window_center_ = center;
+	window_size_ = size;
+	is_state_window_ = true;
+	updateStateWindow();
+
+	return !was_state_window ||
+			last_key_x != window_key_x_ || last_key_y != window_key_y_ ||
+			last_count_x != window_count_x_ || last_count_y != window_count_y_;
+}
+
+
+void SpaceDiscretization::removeStateWindow()
+{
+	is_state_window_ = false;
+	window_count_x_ = 0;
+	window_count_y_ = 0;
+}
+
+
+bool SpaceDiscretization::hasStateWindow() const
+{
+	return is_state_window_;
+}
+
+
+Vertex SpaceDiscretization::getNumberOfWindowVertices(TypeOfState state) const
+{
+	if (!is_state_window_)
+		return 0;
+
+	Vertex num_vertices = window_count_x_ * window_count_y_;
+	if (state == XY_Y)
+		num_vertices *= getWindowAngularCount();
+
+	return num_vertices;
+}
+
+
+void SpaceDiscretization::updateStateWindow()
+{
+	// The window has an odd number of keys per axis, so the center key is in its middle
+	unsigned short int center_key_x, center_key_y;
+	stateToKey(center_key_x, window_center_(rbd::X), true);
+	stateToKey(center_key_y, window_center_(rbd::Y), true);
+
+	unsigned long int half_count_x = ceil(0.5 * fabs(window_size_(rbd::X)) / position_resolution_);
+	unsigned long int half_count_y = ceil(0.5 * fabs(window_size_(rbd::Y)) / position_resolution_);
+	half_count_x = std::min(half_count_x, (unsigned long int) center_key_x);
+	half_count_y = std::min(half_count_y, (unsigned long int) center_key_y);
+	window_key_x_ = center_key_x - half_count_x;
+	window_key_y_ = center_key_y - half_count_y;
+	window_count_x_ = std::min(2 * half_count_x + 1, max_position_count_ - window_key_x_);
+	window_count_y_ = std::min(2 * half_count_y + 1, max_position_count_ - window_key_y_);
+}
+
+
+unsigned long int SpaceDiscretization::getWindowAngularCount() const
+{
+	// Note that the yaw keys are in [0, ceil(2 pi / resolution))
+	if (angular_resolution_ == 0)
+		return 1;
+
+	return std::max(1., ceil(2 * M_PI / angular_resolution_ - 1e-9));
+}
+
+
+Vertex SpaceDiscretization::encodeStateVertex(unsigned short int key_x,
+											  unsigned short int key_y) const
+{
+	// Encoding the states of the window densely, and shifting the other ones after them
+	if (is_state_window_) {
+		unsigned long int rel_x = (unsigned short int) (key_x - window_key_x_);
+		unsigned long int rel_y = (unsigned short int) (key_y - window_key_y_);
+		if (rel_x < window_count_x_ && rel_y < window_count_y_)
+			return rel_y + window_count_y_ * rel_x;
+	}
+
+	return encodeVertex(key_x, key_y, max_position_count_) + getNumberOfWindowVertices(XY);
+}
+
+
+Vertex SpaceDiscretization::encodeStateVertex(unsigned short int key_x,
+											  unsigned short int key_y,
+											  unsigned short int key_yaw) const
+{
+	// Encoding the states of the window densely, where the yaw wraps around, and shifting the
+	// other ones after them
+	if (is_state_window_) {
+		unsigned long int rel_x = (unsigned short int) (key_x - window_key_x_);
+		unsigned long int rel_y = (unsigned short int) (key_y - window_key_y_);
+		if (rel_x < window_count_x_ && rel_y < window_count_y_) {
+			unsigned long int count_yaw = getWindowAngularCount();
+			return key_yaw % count_yaw + count_yaw * (rel_y + window_count_y_ * rel_x);
+		}
+	}
+
+	return encodeVertex(key_x, key_y, key_yaw, max_position_count_, max_angular_count_) +
+			getNumberOfWindowVertices(XY_Y);
+}
+
+
+void SpaceDiscretization::updateReciprocalResolutions()
+{
+	// The conversions multiply by the reciprocals instead of dividing, where an undefined
+	// resolution gives a zero reciprocal
+	inv_plane_resolution_ = (plane_resolution_ != 0) ? 1. / plane_resolution_ : 0.;
+	inv_height_resolution_ = (height_resolution_ != 0) ? 1. / height_resolution_ : 0.;
+	inv_position_resolution_ = (position_resolution_ != 0) ? 1. / position_resolution_ : 0.;
+}
+
+
+Vertex SpaceDiscretization::encodeVertex(unsigned short int key_0,
+										 unsigned short int key_1,
+										 unsigned long int count_1) const
+{
+	if (ordering_ == Morton)
+		return spreadBits2d(key_1) | (spreadBits2d(key_0) << 1);
+
+	return (unsigned long int) key_1 + count_1 * key_0;
+}
+
+
+Vertex SpaceDiscretization::encodeVertex(unsigned short int key_0,
+										 unsigned short int key_1,
+										 unsigned short int key_2,
+										 unsigned long int count_1,
+										 unsigned long int count_2) const
+{
+	if (ordering_ == Morton)
+		return spreadBits3d(key_2) | (spreadBits3d(key_1) << 1) | (spreadBits3d(key_0) << 2);
+
+	return (unsigned long int) key_2 + count_2 * key_1 + count_2 * count_1 * key_0;
+}
+
+
+void SpaceDiscretization::decodeVertex(unsigned short int& key_0,
+									   unsigned short int& key_1,
+									   Vertex vertex,
+									   unsigned long int count_1) const
+{
+	if (ordering_ == Morton) {
+		key_1 = compactBits2d(vertex);
+		key_0 = compactBits2d(vertex >> 1);
+		return;
+	}
+
+	key_0 = floor(vertex / count_1);
+	key_1 = vertex - count_1 * key_0;
+}
+
+
+void SpaceDiscretization::decodeVertex(unsigned short int& key_0,
+									   unsigned short int& key_1,
+									   unsigned short int& key_2,
+									   Vertex vertex,
+									   unsigned long int count_1,
+									   unsigned long int count_2) const
+{
+	if (ordering_ == Morton) {
+		key_2 = compactBits3d(vertex);
+		key_1 = compactBits3d(vertex >> 1);
+		key_0 = compactBits3d(vertex >> 2);
+		return;
+	}
+
+	key_0 = floor(vertex / (count_1 * count_2));
+	key_1 = floor(vertex / count_2) - count_1 * key_0;
+	key_2 = vertex - count_2 * key_1 - count_2 * count_1 * key_0;
 }
 
 } //@namespace environment
@@ -10,6 +10,13 @@ namespace dwl
 namespace environment
 {
 
+/**
+ * @brief Defines the ordering of the vertex ids. The row-major ordering concatenates the keys,
+ * and the Morton (Z-order) ordering interleaves their bits, so the neighbors of a vertex have
+ * close ids along every axis
+ */
+enum VertexOrdering {RowMajor, Morton};
+
 /**
  * @class SpaceDiscretization
  * @brief Class for defining the discretization of environment and states
@@ -200,6 +207,68 @@ class SpaceDiscretization
 											const Vertex& state_vertex,
 											TypeOfState state) const;
 
+		/**
+		 * @brief Converts a batch of 3d coordinates into keys with boundary checking. The
+		 * coordinates are scaled by the reciprocal resolutions in blocks of columns, so the
+		 * conversion is vectorized
+		 * @param std::vector<Key>& Keys of the points
+		 * @param std::vector<bool>& Indicates if every point is within the boundaries of the
+		 * environment, i.e. if its key is valid
+		 * @param const Eigen::Matrix3Xd& 3D coordinates (one per column)
+		 * @return The number of valid points
+		 */
+		unsigned int coordToKeyChecked(std::vector<Key>& keys,
+									   std::vector<bool>& valid,
+									   const Eigen::Matrix3Xd& coordinates) const;
+
+		/**
+		 * @brief Converts a batch of 2d coordinates to vertex ids
+		 * @param std::vector<Vertex>& Vertex ids
+		 * @param const Eigen::Matrix2Xd& 2D coordinates (one per column)
+		 */
+		void coordToVertex(std::vector<Vertex>& vertices,
+						   const Eigen::Matrix2Xd& coordinates) const;
+
+		/**
+		 * @brief Converts a batch of 3d coordinates to vertex ids
+		 * @param std::vector<Vertex>& Vertex ids
+		 * @param const Eigen::Matrix3Xd& 3D coordinates (one per column)
+		 */
+		void coordToVertex(std::vector<Vertex>& vertices,
+						   const Eigen::Matrix3Xd& coordinates) const;
+
+		/**
+		 * @brief Converts a batch of vertex ids to 2d coordinates
+		 * @param Eigen::Matrix2Xd& 2D coordinates (one per column)
+		 * @param const std::vector<Vertex>& Vertex ids
+		 */
+		void vertexToCoord(Eigen::Matrix2Xd& coordinates,
+						   const std::vector<Vertex>& vertices) const;
+
+		/**
+		 * @brief Converts a batch of vertex ids to 3d coordinates
+		 * @param Eigen::Matrix3Xd& 3D coordinates (one per column)
+		 * @param const std::vector<Vertex>& Vertex ids
+		 */
+		void vertexToCoord(Eigen::Matrix3Xd& coordinates,
+						   const std::vector<Vertex>& vertices) const;
+
+		/**
+		 * @brief Converts a batch of states (x,y) to vertexes
+		 * @param std::vector<Vertex>& Vertex ids
+		 * @param const Eigen::Matrix2Xd& States (one per column)
+		 */
+		void stateToVertex(std::vector<Vertex>& vertices,
+						   const Eigen::Matrix2Xd& states) const;
+
+		/**
+		 * @brief Converts a batch of states (x,y,yaw) to vertexes
+		 * @param std::vector<Vertex>& Vertex ids
+		 * @param const Eigen::Matrix3Xd& States (one per column)
+		 */
+		void stateToVertex(std::vector<Vertex>& vertices,
+						   const Eigen::Matrix3Xd& states) const;
+
 		/*
 		 * @brief Gets the resolution of the environment
 		 * @param bool Indicates if the key represents a plane or a height
@@ -230,8 +299,129 @@ class SpaceDiscretization
 		void setStateResolution(double position_resolution,
 								double angular_resolution = 0);
 
+		/**
+		 * @brief Sets the ordering of the environment and state vertexes. Note that the vertexes
+		 * computed with another ordering aren't valid
+		 * @param VertexOrdering Vertex ordering
+		 */
+		void setVertexOrdering(VertexOrdering ordering);
+
+		/** @brief Gets the ordering of the vertexes */
+		VertexOrdering getVertexOrdering() const;
+
+		/**
+		 * @brief Sets a bounded window of the state positions (e.g. around the robot), which
+		 * makes the state vertexes dense. The states inside the window have the vertexes
+		 * [0, getNumberOfWindowVertices), where the yaw varies fastest and wraps around, so
+		 * they can be stored in flat arrays (e.g. see SearchTreeSolver::setIndexedHeap). The
+		 * states outside the window have the vertexes of the unbounded encoding shifted after
+		 * the window ones. Note that the state vertexes computed with another window aren't
+		 * valid
+		 * @param const Eigen::Vector2d& Center of the window
+		 * @param const Eigen::Vector2d& Size of the window, in meters
+		 * @return True if the window changed, i.e. the state vertexes aren't valid anymore
+		 */
+		bool setStateWindow(const Eigen::Vector2d& center,
+							const Eigen::Vector2d& size);
+
+		/** @brief Removes the state window, i.e. it uses the unbounded encoding */
+		void removeStateWindow();
+
+		/** @brief Indicates if there is a state window */
+		bool hasStateWindow() const;
+
+		/**
+		 * @brief Gets the number of vertexes of the state window, or zero if there isn't one
+		 * @param TypeOfState Definition of the state, i.e. XY or XY_Y
+		 * @return The number of dense state vertexes
+		 */
+		Vertex getNumberOfWindowVertices(TypeOfState state) const;
+
 
 	private:
+		/** @brief Computes the keys of the state window from its center and size */
+		void updateStateWindow();
+
+		/** @brief Gets the number of yaw keys of the state window */
+		unsigned long int getWindowAngularCount() const;
+
+		/**
+		 * @brief Encodes the position keys of a state (x,y) into a vertex
+		 * @param unsigned short int Key of the x position
+		 * @param unsigned short int Key of the y position
+		 * @return The vertex
+		 */
+		Vertex encodeStateVertex(unsigned short int key_x,
+								 unsigned short int key_y) const;
+
+		/**
+		 * @brief Encodes the keys of a state (x,y,yaw) into a vertex
+		 * @param unsigned short int Key of the x position
+		 * @param unsigned short int Key of the y position
+		 * @param unsigned short int Key of the yaw
+		 * @return The vertex
+		 */
+		Vertex encodeStateVertex(unsigned short int key_x,
+								 unsigned short int key_y,
+								 unsigned short int key_yaw) const;
+
+		/** @brief Updates the reciprocal resolutions of the key conversions */
+		void updateReciprocalResolutions();
+
+		/**
+		 * @brief Encodes two keys into a vertex
+		 * @param unsigned short int First key (slowest in row-major)
+		 * @param unsigned short int Second key
+		 * @param unsigned long int Count of the second key
+		 * @return The vertex
+		 */
+		Vertex encodeVertex(unsigned short int key_0,
+							unsigned short int key_1,
+							unsigned long int count_1) const;
+
+		/**
+		 * @brief Encodes three keys into a vertex
+		 * @param unsigned short int First key (slowest in row-major)
+		 * @param unsigned short int Second key
+		 * @param unsigned short int Third key
+		 * @param unsigned long int Count of the second key
+		 * @param unsigned long int Count of the third key
+		 * @return The vertex
+		 */
+		Vertex encodeVertex(unsigned short int key_0,
+							unsigned short int key_1,
+							unsigned short int key_2,
+							unsigned long int count_1,
+							unsigned long int count_2) const;
+
+		/**
+		 * @brief Decodes a vertex into two keys
+		 * @param unsigned short int& First key
+		 * @param unsigned short int& Second key
+		 * @param Vertex Vertex
+		 * @param unsigned long int Count of the second key
+		 */
+		void decodeVertex(unsigned short int& key_0,
+						  unsigned short int& key_1,
+						  Vertex vertex,
+						  unsigned long int count_1) const;
+
+		/**
+		 * @brief Decodes a vertex into three keys
+		 * @param unsigned short int& First key
+		 * @param unsigned short int& Second key
+		 * @param unsigned short int& Third key
+		 * @param Vertex Vertex
+		 * @param unsigned long int Count of the second key
+		 * @param unsigned long int Count of the third key
+		 */
+		void decodeVertex(unsigned short int& key_0,
+						  unsigned short int& key_1,
+						  unsigned short int& key_2,
+						  Vertex vertex,
+						  unsigned long int count_1,
+						  unsigned long int count_2) const;
+
 		/** @brief The resolution of the plane of the environment */
 		double plane_resolution_;  ///< in meters
 
@@ -244,6 +434,12 @@ class SpaceDiscretization
 		/** @brief The resolution of the angular's variables of the state */
 		double angular_resolution_;  ///< in radians
 
+		/** @brief Reciprocal resolutions of the environment and position state (zero if the
+		 * resolution isn't defined) */
+		double inv_plane_resolution_;
+		double inv_height_resolution_;
+		double inv_position_resolution_;
+
 		/** @brief The maximum number of discrete key */
 		const unsigned short int max_key_val_;
 
@@ -255,6 +451,19 @@ class SpaceDiscretization
 
 		/** @brief Maximum count for angular state variables */
 		unsigned long int max_angular_count_;
+
+		/** @brief Ordering of the vertexes */
+		VertexOrdering ordering_;
+
+		/** @brief State window, i.e. its center and size, its first position keys and
+		 * its number of position keys */
+		bool is_state_window_;
+		Eigen::Vector2d window_center_;
+		Eigen::Vector2d window_size_;
+		unsigned short int window_key_x_;
+		unsigned short int window_key_y_;
+		unsigned long int window_count_x_;
+		unsigned long int window_count_y_;
 };
 
 } //@namespace environment
@@ -0,0 +1,349 @@
+#include <dwl/environment/TerrainDistanceField.h>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/** @brief Squared distance of the columns without free space or terrain */
+static const double InfiniteDistance = 1e20;
+
+
+TerrainDistanceField::TerrainDistanceField() : origin_(Eigen::Vector3d::Zero()), size_x_(0),
+		size_y_(0), size_z_(0), resolution_(0.), max_distance_(0.3), padding_(0)
+{
+
+}
+
+
+TerrainDistanceField::~TerrainDistanceField()
+{
+
+}
+
+
+void TerrainDistanceField::setMaxDistance(double max_distance)
+{
+	if (max_distance > 0.)
+		max_distance_ = max_distance;
+}
+
+
+void TerrainDistanceField::compute(const TerrainMap& terrain)
+{
+	clear();
+	const SpaceDiscretization& space_discretization = terrain.getTerrainSpaceModel();
+	resolution_ = space_discretization.getEnvironmentResolution(true);
+	if (resolution_ <= 0.) {
+		printf(YELLOW "Warning: could not compute the terrain distance field because the"
+				" terrain resolution isn't defined\n" COLOR_RESET);
+		return;
+	}
+	padding_ = (unsigned int) ceil(max_distance_ / resolution_);
+
+	// Getting the bounding box of the terrain cells and their heights
+	CellRegion terrain_region;
+	double min_height = std::numeric_limits<double>::max();
+	double max_height = -std::numeric_limits<double>::max();
+	const TerrainDataMap& terrain_map = terrain.getTerrainDataMap();
+	Key key;
+	for (TerrainDataMap::const_iterator cell_it = terrain_map.begin();
+			cell_it != terrain_map.end(); cell_it++) {
+		space_discretization.vertexToKey(key, cell_it->first, true);
+		terrain_region.add(key);
+
+		double height = terrain.getTerrainHeight(cell_it->first);
+		min_height = std::min(min_height, height);
+		max_height = std::max(max_height, height);
+	}
+	if (terrain_region.empty)
+		return;
+
+	// Setting up the voxel grid, where the voxels of the slices are the terrain cells
+	region_ = padRegion(terrain_region);
+	size_x_ = region_.max_key.x - region_.min_key.x + 1;
+	size_y_ = region_.max_key.y - region_.min_key.y + 1;
+	size_z_ = (unsigned int) ceil((max_height - min_height + 2 * max_distance_) / resolution_) + 1;
+	space_discretization.keyToCoord(origin_(rbd::X), region_.min_key.x, true);
+	space_discretization.keyToCoord(origin_(rbd::Y), region_.min_key.y, true);
+	origin_(rbd::Z) = min_height - max_distance_;
+	distance_.assign(size_x_ * size_y_ * size_z_, (float) max_distance_);
+
+	// Computing all the voxels, where there aren't terrain cells outside the region
+	std::vector<double> heights;
+	readHeights(heights, terrain, region_);
+	computeRegion(heights, region_, region_);
+}
+
+
+void TerrainDistanceField::update(const TerrainMap& terrain,
+								  const CellRegion& region)
+{
+	if (region.empty)
+		return;
+
+	// Recomputing the whole field if the changed region could be outside the field, i.e. its
+	// neighborhood isn't inside the field
+	CellRegion output_region = padRegion(region);
+	if (isEmpty() ||
+			terrain.getTerrainSpaceModel().getEnvironmentResolution(true) != resolution_ ||
+			!region_.contains(output_region.min_key) ||
+			!region_.contains(output_region.max_key)) {
+		compute(terrain);
+		return;
+	}
+
+	// Reading the columns that affect the voxels of the changed neighborhood, and checking
+	// that their heights are inside the field
+	CellRegion input_region = padRegion(output_region);
+	input_region.min_key.x = std::max(input_region.min_key.x, region_.min_key.x);
+	input_region.min_key.y = std::max(input_region.min_key.y, region_.min_key.y);
+	input_region.max_key.x = std::min(input_region.max_key.x, region_.max_key.x);
+	input_region.max_key.y = std::min(input_region.max_key.y, region_.max_key.y);
+	std::vector<double> heights;
+	readHeights(heights, terrain, input_region);
+	double min_height = origin_(rbd::Z) + max_distance_;
+	double max_height = origin_(rbd::Z) + (size_z_ - 1) * resolution_ - max_distance_;
+	for (unsigned int i = 0; i < heights.size(); i++) {
+		if (heights[i] < min_height || heights[i] > max_height) {
+			compute(terrain);
+			return;
+		}
+	}
+
+	computeRegion(heights, input_region, output_region);
+}
+
+
+void TerrainDistanceField::clear()
+{
+	distance_.clear();
+	region_ = CellRegion();
+	size_x_ = size_y_ = size_z_ = 0;
+}
+
+
+bool TerrainDistanceField::getDistance(double& distance,
+									   Eigen::Vector3d& gradient,
+									   const Eigen::Vector3d& point) const
+{
+	distance = max_distance_;
+	gradient.setZero();
+	if (isEmpty())
+		return false;
+
+	// Getting the continuous voxel coordinates of the point
+	Eigen::Vector3d voxel = (point - origin_) / resolution_;
+	if (voxel(rbd::X) < 0. || voxel(rbd::X) > size_x_ - 1 ||
+			voxel(rbd::Y) < 0. || voxel(rbd::Y) > size_y_ - 1)
+		return false;
+
+	// The points below or above the field are farther than the maximum distance
+	if (voxel(rbd::Z) < 0.) {
+		distance = -max_distance_;
+		return true;
+	} else if (voxel(rbd::Z) > size_z_ - 1)
+		return true;
+
+	// Interpolating trilinearly the eight neighbor voxels
+	unsigned int x = std::min((unsigned int) voxel(rbd::X), size_x_ - 2);
+	unsigned int y = std::min((unsigned int) voxel(rbd::Y), size_y_ - 2);
+	unsigned int z = std::min((unsigned int) voxel(rbd::Z), size_z_ - 2);
+	double tx = voxel(rbd::X) - x;
+	double ty = voxel(rbd::Y) - y;
+	double tz = voxel(rbd::Z) - z;
+	unsigned int slice_size = size_x_ * size_y_;
+	const float* d = &distance_[(z * size_y_ + y) * size_x_ + x];
+	double d000 = d[0], d100 = d[1];
+	double d010 = d[size_x_], d110 = d[size_x_ + 1];
+	double d001 = d[slice_size], d101 = d[slice_size + 1];
+	double d011 = d[slice_size + size_x_], d111 = d[slice_size + size_x_ + 1];
+
+	double d00 = (1 - tx) * d000 + tx * d100;
+	double d10 = (1 - tx) * d010 + tx * d110;
+	double d01 = (1 - tx) * d001 + tx * d101;
+	double d11 = (1 - tx) * d011 + tx * d111;
+	double d0 = (1 - ty) * d00 + ty * d10;
+	double d1 = (1 - ty) * d01 + ty * d11;
+	distance = (1 - tz) * d0 + tz * d1;
+
+	double dx0 = (1 - ty) * (d100 - d000) + ty * (d110 - d010);
+	double dx1 = (1 - ty) * (d101 - d001) + ty * (d111 - d011);
+	gradient(rbd::X) = (1 - tz) * dx0 + tz * dx1;
+	gradient(rbd::Y) = (1 - tz) * (d10 - d00) + tz * (d11 - d01);
+	gradient(rbd::Z) = d1 - d0;
+	gradient /= resolution_;
+
+	return true;
+}
+
+
+double TerrainDistanceField::getDistance(const Eigen::Vector3d& point) const
+{
+	double distance;
+	Eigen::Vector3d gradient;
+	getDistance(distance, gradient, point);
+
+	return distance;
+}
+
+
+double TerrainDistanceField::getMaxDistance() const
+{
+	return max_distance_;
+}
+
+
+unsigned int TerrainDistanceField::getNumberOfVoxels() const
+{
+	return distance_.size();
+}
+
+
+bool TerrainDistanceField::isEmpty() const
+{
+	return distance_.empty();
+}
+
+
+void TerrainDistanceField::readHeights(std::vector<double>& heights,
+									   const TerrainMap& terrain,
+									   const CellRegion& region) const
+{
+	unsigned int size_x = region.max_key.x - region.min_key.x + 1;
+	unsigned int size_y = region.max_key.y - region.min_key.y + 1;
+	heights.resize(size_x * size_y);
+
+	const SpaceDiscretization& space_discretization = terrain.getTerrainSpaceModel();
+	Key key;
+	Vertex vertex;
+	for (unsigned int y = 0; y < size_y; y++) {
+		key.y = region.min_key.y + y;
+		for (unsigned int x = 0; x < size_x; x++) {
+			key.x = region.min_key.x + x;
+			space_discretization.keyToVertex(vertex, key, true);
+
+			double height;
+			if (!terrain.getTerrainHeight(height, vertex))
+				height = std::numeric_limits<double>::quiet_NaN();
+			heights[y * size_x + x] = height;
+		}
+	}
+}
+
+
+void TerrainDistanceField::computeRegion(const std::vector<double>& heights,
+										 const CellRegion& input_region,
+										 const CellRegion& output_region)
+{
+	unsigned int size_x = input_region.max_key.x - input_region.min_key.x + 1;
+	unsigned int size_y = input_region.max_key.y - input_region.min_key.y + 1;
+	unsigned int num_columns = size_x * size_y;
+	outside_sq_.resize(num_columns);
+	inside_sq_.resize(num_columns);
+
+	for (unsigned int z = 0; z < size_z_; z++) {
+		// Computing the squared vertical distances (in voxels) to the solid and free parts of
+		// every column, where the unknown columns are free space
+		double height = origin_(rbd::Z) + z * resolution_;
+		for (unsigned int i = 0; i < num_columns; i++) {
+			if (std::isnan(heights[i])) {
+				outside_sq_[i] = InfiniteDistance;
+				inside_sq_[i] = 0.;
+			} else {
+				double vertical_distance = (height - heights[i]) / resolution_;
+				outside_sq_[i] = vertical_distance > 0. ? vertical_distance * vertical_distance : 0.;
+				inside_sq_[i] = vertical_distance < 0. ? vertical_distance * vertical_distance : 0.;
+			}
+		}
+
+		// Computing the 2d transforms of the slice, i.e. along the rows and then the columns
+		for (unsigned int y = 0; y < size_y; y++) {
+			transform(&outside_sq_[y * size_x], size_x, 1);
+			transform(&inside_sq_[y * size_x], size_x, 1);
+		}
+		for (unsigned int x = 0; x < size_x; x++) {
+			transform(&outside_sq_[x], size_y, size_x);
+			transform(&inside_sq_[x], size_y, size_x);
+		}
+
+		// Writing the signed distances of the output voxels, where the sign is given by their
+		// own column
+		for (unsigned int y = output_region.min_key.y; y <= output_region.max_key.y; y++) {
+			unsigned int input_row = (y - input_region.min_key.y) * size_x;
+			unsigned int output_row = (z * size_y_ + (y - region_.min_key.y)) * size_x_;
+			for (unsigned int x = output_region.min_key.x; x <= output_region.max_key.x; x++) {
+				unsigned int i = input_row + x - input_region.min_key.x;
+				double distance;
+				if (inside_sq_[i] == 0.)
+					distance = sqrt(outside_sq_[i]) * resolution_;
+				else
+					distance = -sqrt(inside_sq_[i]) * resolution_;
+				distance = std::min(std::max(distance, -max_distance_), max_distance_);
+				distance_[output_row + x - region_.min_key.x] = (float) distance;
+			}
+		}
+	}
+}
+
+
+void TerrainDistanceField::transform(double* function,
+									 unsigned int size,
+									 unsigned int stride)
+{
+	samples_.resize(size);
+	roots_.resize(size);
+	boundaries_.resize(size + 1);
+	for (unsigned int q = 0; q < size; q++)
+		samples_[q] = function[q * stride];
+
+	// Computing the lower envelope of the parabolas
+	int k = 0;
+	roots_[0] = 0;
+	boundaries_[0] = -std::numeric_limits<double>::max();
+	boundaries_[1] = std::numeric_limits<double>::max();
+	for (int q = 1; q < (int) size; q++) {
+		// Removing the parabolas that are hidden by the new one. Note that the first boundary
+		// is minus infinity, so the first parabola is never removed
+		double s;
+		while (true) {
+			int r = roots_[k];
+			s = ((samples_[q] + q * q) - (samples_[r] + r * r)) / (2. * (q - r));
+			if (s > boundaries_[k])
+				break;
+			k--;
+		}
+
+		k++;
+		roots_[k] = q;
+		boundaries_[k] = s;
+		boundaries_[k + 1] = std::numeric_limits<double>::max();
+	}
+
+	// Evaluating the lower envelope
+	k = 0;
+	for (int q = 0; q < (int) size; q++) {
+		while (boundaries_[k + 1] < q)
+			k++;
+		int r = roots_[k];
+		function[q * stride] = (q - r) * (q - r) + samples_[r];
+	}
+}
+
+
+CellRegion TerrainDistanceField::padRegion(const CellRegion& region) const
+{
+	CellRegion padded_region = region;
+	int padding = padding_;
+	padded_region.min_key.x = std::max((int) region.min_key.x - padding, 0);
+	padded_region.min_key.y = std::max((int) region.min_key.y - padding, 0);
+	padded_region.max_key.x = std::min((int) region.max_key.x + padding, 65535);
+	padded_region.max_key.y = std::min((int) region.max_key.y + padding, 65535);
+
+	return padded_region;
+}
+
+} //@namespace environment
+} //@namespace dwl
@@ -0,0 +1,157 @@
+#ifndef DWL__ENVIRONMENT__TERRAIN_DISTANCE_FIELD__H
+#define DWL__ENVIRONMENT__TERRAIN_DISTANCE_FIELD__H
+
+#include <dwl/environment/TerrainMap.h>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class TerrainDistanceField
+ * @brief TerrainDistanceField maintains the signed distance of 3d points to the terrain surface
+ * in a dense voxel grid, i.e. the distance and gradient of a point (e.g. a swing foot) are
+ * interpolated trilinearly from its eight neighbor voxels. The terrain is the set of height
+ * columns of the terrain cells, so the distance of the points above (below) the surface is
+ * positive (negative). Every horizontal slice of the grid is computed with the exact 2d
+ * transform of Felzenszwalb and Huttenlocher (2012: "Distance Transforms of Sampled Functions")
+ * of the vertical distances to the columns. The distances are truncated to a maximum distance,
+ * so an incremental change of the terrain only recomputes the voxels of its neighborhood. The
+ * voxels have the plane resolution of the terrain map, and the unknown cells are free space
+ */
+class TerrainDistanceField
+{
+	public:
+		/** @brief Constructor function */
+		TerrainDistanceField();
+
+		/** @brief Destructor function */
+		~TerrainDistanceField();
+
+		/**
+		 * @brief Sets the maximum distance of the field, which has to be set before computing
+		 * it. The default value is 0.3 m
+		 * @param double Maximum distance
+		 */
+		void setMaxDistance(double max_distance);
+
+		/**
+		 * @brief Computes the field of the whole terrain map, where the region of the field is
+		 * the bounding box of the terrain cells padded by the maximum distance
+		 * @param const TerrainMap& Terrain map
+		 */
+		void compute(const TerrainMap& terrain);
+
+		/**
+		 * @brief Updates incrementally the field with the changed cells of a region (e.g. the
+		 * dirty region of the terrain map), which only recomputes the voxels closer to it than
+		 * the maximum distance. The field is fully recomputed if the region or its heights are
+		 * outside the field
+		 * @param const TerrainMap& Terrain map
+		 * @param const CellRegion& Region of the changed cells
+		 */
+		void update(const TerrainMap& terrain,
+					const CellRegion& region);
+
+		/** @brief Clears the field */
+		void clear();
+
+		/**
+		 * @brief Gets the signed distance of a 3d point to the terrain surface and its gradient
+		 * @param double& Signed distance, which is truncated to the maximum distance
+		 * @param Eigen::Vector3d& Gradient of the distance (zero where it's truncated)
+		 * @param const Eigen::Vector3d& 3d point
+		 * @return False if the point is horizontally outside the field
+		 */
+		bool getDistance(double& distance,
+						 Eigen::Vector3d& gradient,
+						 const Eigen::Vector3d& point) const;
+
+		/**
+		 * @brief Gets the signed distance of a 3d point to the terrain surface
+		 * @param const Eigen::Vector3d& 3d point
+		 * @return The signed distance, or the maximum distance outside the field
+		 */
+		double getDistance(const Eigen::Vector3d& point) const;
+
+		/** @brief Gets the maximum distance */
+		double getMaxDistance() const;
+
+		/** @brief Gets the number of voxels of the field */
+		unsigned int getNumberOfVoxels() const;
+
+		/** @brief Indicates if the field wasn't computed */
+		bool isEmpty() const;
+
+
+	private:
+		/**
+		 * @brief Reads the heights of the terrain cells of a region into a row-major array
+		 * @param std::vector<double>& Heights of the cells (NaN for the unknown ones)
+		 * @param const TerrainMap& Terrain map
+		 * @param const CellRegion& Region of cells
+		 */
+		void readHeights(std::vector<double>& heights,
+						 const TerrainMap& terrain,
+						 const CellRegion& region) const;
+
+		/**
+		 * @brief Computes the signed distances of the voxels of an output region from the
+		 * columns of an input region that contains it
+		 * @param const std::vector<double>& Heights of the input region
+		 * @param const CellRegion& Input region
+		 * @param const CellRegion& Output region
+		 */
+		void computeRegion(const std::vector<double>& heights,
+						   const CellRegion& input_region,
+						   const CellRegion& output_region);
+
+		/**
+		 * @brief Computes the 1d squared distance transform of a sampled function, i.e. the
+		 * lower envelope of the parabolas rooted at every sample
+		 * @param double* Sampled function and its transform
+		 * @param unsigned int Number of samples
+		 * @param unsigned int Stride between the samples
+		 */
+		void transform(double* function,
+					   unsigned int size,
+					   unsigned int stride);
+
+		/** @brief Pads a region by the maximum distance */
+		CellRegion padRegion(const CellRegion& region) const;
+
+		/** @brief Signed distance of every voxel, indexed by slice and then by row */
+		std::vector<float> distance_;
+
+		/** @brief Squared distances of a slice, and workspace of the 1d transform */
+		std::vector<double> outside_sq_;
+		std::vector<double> inside_sq_;
+		std::vector<double> samples_;
+		std::vector<int> roots_;
+		std::vector<double> boundaries_;
+
+		/** @brief Region of the field, and its origin (center of the first voxel) */
+		CellRegion region_;
+		Eigen::Vector3d origin_;
+
+		/** @brief Number of voxels per axis */
+		unsigned int size_x_;
+		unsigned int size_y_;
+		unsigned int size_z_;
+
+		/** @brief Resolution of the voxels */
+		double resolution_;
+
+		/** @brief Maximum distance, and its value in voxels */
+		double max_distance_;
+		unsigned int padding_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,230 @@
+#include <dwl/environment/TerrainFeaturePipeline.h>
+#ifdef DWL_WITH_OPENCL
+#include <dwl/environment/OpenCLTerrainBackend.h>
+#endif
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+TerrainFeaturePipeline::TerrainFeaturePipeline() : space_discretization_(0.04),
+		backend_(CpuBackend), resolution_(0.04), window_radius_(2), max_cost_(1.)
+{
+	// Default features, i.e. 45 deg of slope, 10 m^-1 of curvature, 5 cm of roughness and
+	// 10 cm of height deviation saturate their costs
+	const double saturations[NumTerrainFeatures] = {M_PI / 4, 10., 0.05, 0.1};
+	for (unsigned int i = 0; i < NumTerrainFeatures; i++) {
+		weights_[i] = 1.;
+		saturations_[i] = saturations[i];
+	}
+}
+
+
+TerrainFeaturePipeline::~TerrainFeaturePipeline()
+{
+
+}
+
+
+void TerrainFeaturePipeline::setResolution(double plane_resolution,
+										   double height_resolution)
+{
+	resolution_ = plane_resolution;
+	space_discretization_.setEnvironmentResolution(plane_resolution, true);
+	space_discretization_.setEnvironmentResolution(height_resolution, false);
+}
+
+
+void TerrainFeaturePipeline::setNeighboringArea(double radius)
+{
+	// Note that the stencils require at least one neighbor
+	window_radius_ = std::max((int) round(radius / resolution_), 1);
+}
+
+
+void TerrainFeaturePipeline::setFeature(TerrainFeatureType feature,
+										double weight,
+										double saturation)
+{
+	if (feature >= NumTerrainFeatures)
+		return;
+
+	if (saturation <= 0.) {
+		printf(YELLOW "Warning: the saturation of the terrain feature has to be positive\n"
+				COLOR_RESET);
+		return;
+	}
+
+	weights_[feature] = weight;
+	saturations_[feature] = saturation;
+}
+
+
+bool TerrainFeaturePipeline::setBackend(TerrainProcessingBackend backend)
+{
+	if (backend == CpuBackend) {
+		backend_ = CpuBackend;
+		return true;
+	}
+
+#ifdef DWL_WITH_OPENCL
+	if (!opencl_backend_) {
+		std::shared_ptr<OpenCLTerrainBackend> opencl_backend(new OpenCLTerrainBackend());
+		if (!opencl_backend->init()) {
+			printf(YELLOW "Warning: there isn't an OpenCL device, so the CPU backend is used\n"
+					COLOR_RESET);
+			return false;
+		}
+		opencl_backend_ = opencl_backend;
+	}
+	backend_ = OpenCLBackend;
+	return true;
+#else
+	printf(YELLOW "Warning: dwl was built without OpenCL, so the CPU backend is used\n"
+			COLOR_RESET);
+	return false;
+#endif
+}
+
+
+TerrainProcessingBackend TerrainFeaturePipeline::getBackend() const
+{
+	return backend_;
+}
+
+
+void TerrainFeaturePipeline::setMaxCost(double max_cost)
+{
+	max_cost_ = max_cost;
+}
+
+
+void TerrainFeaturePipeline::compute(Eigen::ArrayXXd& cost,
+									 const Eigen::ArrayXXd& height)
+{
+	unsigned int rows = height.rows(), cols = height.cols();
+	if (rows == 0 || cols == 0) {
+		cost.resize(0, 0);
+		return;
+	}
+
+	// Padding the heights by replicating the border cells. Note that the mean height is removed
+	// for reducing the cancellation errors of the summed-area tables
+	unsigned int k = window_radius_;
+	unsigned int padded_rows = rows + 2 * k, padded_cols = cols + 2 * k;
+	padded_height_.resize(padded_rows, padded_cols);
+	padded_height_.block(k, k, rows, cols) = height - height.mean();
+	for (unsigned int i = 0; i < k; i++) {
+		padded_height_.row(i).segment(k, cols) = padded_height_.row(k).segment(k, cols);
+		padded_height_.row(padded_rows - 1 - i).segment(k, cols) =
+				padded_height_.row(k + rows - 1).segment(k, cols);
+	}
+	for (unsigned int j = 0; j < k; j++) {
+		padded_height_.col(j) = padded_height_.col(k);
+		padded_height_.col(padded_cols - 1 - j) = padded_height_.col(k + cols - 1);
+	}
+
+#ifdef DWL_WITH_OPENCL
+	// Offloading all the stencils to the OpenCL device, where a failure (e.g. out of device
+	// memory) falls back to the CPU backend
+	if (backend_ == OpenCLBackend) {
+		if (opencl_backend_->compute(cost, gradient_x_, gradient_y_, features_, padded_height_,
+									 window_radius_, resolution_, weights_, saturations_,
+									 max_cost_))
+			return;
+
+		printf(YELLOW "Warning: the OpenCL backend failed, so the CPU backend is used\n"
+				COLOR_RESET);
+		backend_ = CpuBackend;
+	}
+#endif
+
+	// Computing the slope and curvature stencils, where the slope is described by the norm of
+	// the gradient (tangent of the slope angle)
+	const Eigen::ArrayXXd& p = padded_height_;
+	gradient_x_ = (p.block(k + 1, k, rows, cols) - p.block(k - 1, k, rows, cols)) /
+			(2 * resolution_);
+	gradient_y_ = (p.block(k, k + 1, rows, cols) - p.block(k, k - 1, rows, cols)) /
+			(2 * resolution_);
+	features_[SlopeFeature] = (gradient_x_.square() + gradient_y_.square()).sqrt();
+	features_[CurvatureFeature] =
+			((p.block(k + 1, k, rows, cols) + p.block(k - 1, k, rows, cols) +
+			p.block(k, k + 1, rows, cols) + p.block(k, k - 1, rows, cols) -
+			4 * p.block(k, k, rows, cols)) / (resolution_ * resolution_)).abs();
+
+	// Computing the moments of the neighboring areas from the summed-area tables
+	unsigned int w = 2 * k + 1;
+	double num_cells = w * w;
+	Eigen::ArrayXXd mean, variance;
+	math::computeSummedArea(summed_area_, padded_height_);
+	math::computeWindowSums(mean, summed_area_, w);
+	math::computeSummedArea(summed_area_, padded_height_.square());
+	math::computeWindowSums(variance, summed_area_, w);
+	mean /= num_cells;
+	variance = variance / num_cells - mean.square();
+
+	// Removing the variance of the local plane, i.e. (gx^2 + gy^2) times the variance of the
+	// cell positions of the window, which is k(k+1)/3 cells^2 for a discrete uniform window
+	double position_variance = resolution_ * resolution_ * k * (k + 1) / 3.;
+	variance -= features_[SlopeFeature].square() * position_variance;
+	features_[RoughnessFeature] = variance.max(Eigen::ArrayXXd::Zero(rows, cols)).sqrt();
+	features_[HeightDeviationFeature] = (p.block(k, k, rows, cols) - mean).abs();
+
+	// Fusing the weighted sum of the saturated feature costs in a single pass
+	Eigen::ArrayXXd::ConstantReturnType one = Eigen::ArrayXXd::Ones(rows, cols);
+	cost = max_cost_ *
+			(weights_[SlopeFeature] *
+			(features_[SlopeFeature] / tan(saturations_[SlopeFeature])).min(one) +
+			weights_[CurvatureFeature] *
+			(features_[CurvatureFeature] / saturations_[CurvatureFeature]).min(one) +
+			weights_[RoughnessFeature] *
+			(features_[RoughnessFeature] / saturations_[RoughnessFeature]).min(one) +
+			weights_[HeightDeviationFeature] *
+			(features_[HeightDeviationFeature] / saturations_[HeightDeviationFeature]).min(one));
+}
+
+
+void TerrainFeaturePipeline::computeTerrainData(TerrainData& terrain_data,
+												const Eigen::ArrayXXd& height,
+												const Eigen::Vector2d& origin,
+												const Eigen::ArrayXXi* mask)
+{
+	Eigen::ArrayXXd cost;
+	compute(cost, height);
+
+	terrain_data.plane_size = space_discretization_.getEnvironmentResolution(true);
+	terrain_data.height_size = space_discretization_.getEnvironmentResolution(false);
+	terrain_data.data.clear();
+	terrain_data.data.reserve(height.size());
+	for (unsigned int j = 0; j < height.cols(); j++) {
+		for (unsigned int i = 0; i < height.rows(); i++) {
+			if (mask != NULL && (*mask)(i, j) == 0)
+				continue;
+
+			Eigen::Vector3d position(origin(rbd::X) + i * resolution_,
+									 origin(rbd::Y) + j * resolution_,
+									 height(i, j));
+
+			TerrainCell cell;
+			if (!space_discretization_.coordToKeyChecked(cell.key, position))
+				continue;
+			cell.cost = cost(i, j);
+			cell.height = height(i, j);
+			cell.normal << -gradient_x_(i, j), -gradient_y_(i, j), 1.;
+			cell.normal.normalize();
+			terrain_data.data.push_back(cell);
+		}
+	}
+}
+
+
+const Eigen::ArrayXXd& TerrainFeaturePipeline::getFeature(TerrainFeatureType feature) const
+{
+	return features_[feature];
+}
+
+} //@namespace environment
+} //@namespace dwl
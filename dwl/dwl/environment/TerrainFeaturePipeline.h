@@ -0,0 +1,156 @@
+#ifndef DWL__ENVIRONMENT__TERRAIN_FEATURE_PIPELINE__H
+#define DWL__ENVIRONMENT__TERRAIN_FEATURE_PIPELINE__H
+
+#include <dwl/environment/SpaceDiscretization.h>
+#include <dwl/utils/utils.h>
+#include <memory>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/** @brief Terrain features of the batched pipeline */
+enum TerrainFeatureType {SlopeFeature, CurvatureFeature, RoughnessFeature,
+	HeightDeviationFeature, NumTerrainFeatures};
+
+/** @brief Backends of the terrain processing */
+enum TerrainProcessingBackend {CpuBackend, OpenCLBackend};
+
+class OpenCLTerrainBackend;
+
+/**
+ * @class TerrainFeaturePipeline
+ * @brief TerrainFeaturePipeline computes the terrain features, and their weighted cost, of a
+ * whole elevation grid at once instead of evaluating a Feature per cell. The features are
+ * computed with stencils over the grid:
+ *  - slope: central differences of the heights
+ *  - curvature: absolute value of the Laplacian of the heights
+ *  - roughness: standard deviation of the heights of the neighboring area after removing the
+ *    local plane, where the window sums come from summed-area tables
+ *  - height deviation: absolute difference between the height and the mean of the
+ *    neighboring area
+ * Every operation is a whole-array Eigen expression, so it's vectorized (SSE/AVX) by Eigen,
+ * and the weighted sum of the features is fused in a single pass over the grid. The cost of
+ * a feature increases linearly up to its saturation value, where it's the maximum cost.
+ * The stencils can be offloaded to an OpenCL device (e.g. an embedded GPU) if dwl is built
+ * with DWL_WITH_OPENCL, where one work-item computes all the features of a cell. The CPU is
+ * the default backend, and it's used whenever the OpenCL device isn't available
+ */
+class TerrainFeaturePipeline
+{
+	public:
+		/** @brief Constructor function */
+		TerrainFeaturePipeline();
+
+		/** @brief Destructor function */
+		~TerrainFeaturePipeline();
+
+		/**
+		 * @brief Sets the resolution of the elevation grid
+		 * @param double Resolution of the plane
+		 * @param double Resolution of the height
+		 */
+		void setResolution(double plane_resolution,
+						   double height_resolution);
+
+		/**
+		 * @brief Sets the radius of the neighboring area of the roughness and height deviation
+		 * @param double Radius of the neighboring area
+		 */
+		void setNeighboringArea(double radius);
+
+		/**
+		 * @brief Sets the weight and saturation of a feature, where the zero weight disables it.
+		 * The saturation of the slope is an angle
+		 * @param TerrainFeatureType Feature
+		 * @param double Weight of the feature
+		 * @param double Saturation value of the feature
+		 */
+		void setFeature(TerrainFeatureType feature,
+						double weight,
+						double saturation);
+
+		/**
+		 * @brief Sets the backend of the stencils, where the OpenCL backend uses the first GPU
+		 * (or any other device) of the first platform
+		 * @param TerrainProcessingBackend Backend
+		 * @return False if the backend isn't available, so the CPU one is kept
+		 */
+		bool setBackend(TerrainProcessingBackend backend);
+
+		/** @brief Gets the backend of the stencils */
+		TerrainProcessingBackend getBackend() const;
+
+		/**
+		 * @brief Sets the maximum cost of every feature
+		 * @param double Maximum cost
+		 */
+		void setMaxCost(double max_cost);
+
+		/**
+		 * @brief Computes the cost of every cell of an elevation grid, where the borders are
+		 * extended by replicating the border cells
+		 * @param Eigen::ArrayXXd& Cost of the cells
+		 * @param const Eigen::ArrayXXd& Heights of the cells, indexed as (x,y)
+		 */
+		void compute(Eigen::ArrayXXd& cost,
+					 const Eigen::ArrayXXd& height);
+
+		/**
+		 * @brief Computes the terrain cells of an elevation grid, i.e. their costs and surface
+		 * normals, e.g. for updating the terrain map
+		 * @param TerrainData& Terrain cells
+		 * @param const Eigen::ArrayXXd& Heights of the cells, indexed as (x,y)
+		 * @param const Eigen::Vector2d& Position of the (0,0) cell
+		 * @param const Eigen::ArrayXXi* Non-zero for the cells that are added (all of them
+		 * by default), e.g. the observed ones
+		 */
+		void computeTerrainData(TerrainData& terrain_data,
+								const Eigen::ArrayXXd& height,
+								const Eigen::Vector2d& origin,
+								const Eigen::ArrayXXi* mask = NULL);
+
+		/** @brief Gets the feature values of the last computed grid */
+		const Eigen::ArrayXXd& getFeature(TerrainFeatureType feature) const;
+
+
+	private:
+		/** @brief Object of the SpaceDiscretization class for computing the cell keys */
+		SpaceDiscretization space_discretization_;
+
+		/** @brief Backend of the stencils, and the OpenCL one (if it's initialized) */
+		TerrainProcessingBackend backend_;
+		std::shared_ptr<OpenCLTerrainBackend> opencl_backend_;
+
+		/** @brief Resolution of the plane */
+		double resolution_;
+
+		/** @brief Radius of the neighboring area in cells */
+		unsigned int window_radius_;
+
+		/** @brief Weight and saturation of every feature */
+		double weights_[NumTerrainFeatures];
+		double saturations_[NumTerrainFeatures];
+
+		/** @brief Maximum cost of a feature */
+		double max_cost_;
+
+		/** @brief Padded heights and their summed-area table (reused between grids) */
+		Eigen::ArrayXXd padded_height_;
+		Eigen::ArrayXXd summed_area_;
+
+		/** @brief Height gradients of the last computed grid */
+		Eigen::ArrayXXd gradient_x_;
+		Eigen::ArrayXXd gradient_y_;
+
+		/** @brief Features of the last computed grid */
+		Eigen::ArrayXXd features_[NumTerrainFeatures];
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,330 @@
+#include <dwl/environment/TerrainGrid.h>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+const unsigned int TerrainGrid::TILE_BITS;
+const unsigned int TerrainGrid::TILE_SIZE;
+const unsigned int TerrainGrid::NUM_TILES;
+
+
+TerrainGrid::Tile::Tile() : num_cells(0)
+{
+	unsigned int tile_cells = TILE_SIZE * TILE_SIZE;
+	height.assign(tile_cells, 0.);
+	cost.assign(tile_cells, 0.);
+	normal.assign(tile_cells, Eigen::Vector3d::UnitZ());
+	occupied.assign(tile_cells, 0);
+}
+
+
+std::size_t TerrainGrid::Tile::getHeapBytes() const
+{
+	return utils::getHeapBytes(height) + utils::getHeapBytes(cost) +
+			utils::getHeapBytes(normal) + utils::getHeapBytes(occupied);
+}
+
+
+TerrainGrid::TerrainGrid() : num_cells_(0), window_size_(0), window_x_(0), window_y_(0)
+{
+
+}
+
+
+TerrainGrid::~TerrainGrid()
+{
+
+}
+
+
+void TerrainGrid::clear()
+{
+	// The tiles of the rolling window are kept, since they are its circular buffer
+	if (window_size_ != 0) {
+		for (unsigned int i = 0; i < tiles_.size(); i++)
+			clearTile(tiles_[i]);
+		num_cells_ = 0;
+		return;
+	}
+
+	directory_.reset();
+	std::vector<utils::CopyOnWrite<Tile> > empty_tiles;
+	tiles_.swap(empty_tiles);
+	free_tiles_.clear();
+	num_cells_ = 0;
+}
+
+
+void TerrainGrid::setRollingWindow(unsigned int num_tiles)
+{
+	window_size_ = 0;
+	clear();
+	window_size_ = std::min(num_tiles, NUM_TILES);
+	if (window_size_ == 0)
+		return;
+
+	// Allocating all the tiles of the window, and centering it in the origin of the keys
+	for (unsigned int i = 0; i < window_size_ * window_size_; i++)
+		tiles_.push_back(utils::CopyOnWrite<Tile>());
+	window_x_ = window_y_ = (NUM_TILES - window_size_) / 2;
+}
+
+
+bool TerrainGrid::recenter(std::vector<Key>& removed_keys,
+						   const Key& center)
+{
+	removed_keys.clear();
+	if (window_size_ == 0)
+		return false;
+
+	// Getting the first tile of the new window
+	unsigned int half_size = window_size_ / 2;
+	unsigned int max_tile = NUM_TILES - window_size_;
+	unsigned int window_x = std::min((unsigned int) std::max((int) (center.x >> TILE_BITS) -
+															  (int) half_size, 0), max_tile);
+	unsigned int window_y = std::min((unsigned int) std::max((int) (center.y >> TILE_BITS) -
+															  (int) half_size, 0), max_tile);
+	if (window_x == window_x_ && window_y == window_y_)
+		return false;
+
+	// Clearing the tiles that leave the window, i.e. the exposed strips, where the slots of
+	// the other tiles don't change
+	for (unsigned int ty = window_y_; ty < window_y_ + window_size_; ty++) {
+		for (unsigned int tx = window_x_; tx < window_x_ + window_size_; tx++) {
+			if (tx >= window_x && tx < window_x + window_size_ &&
+					ty >= window_y && ty < window_y + window_size_)
+				continue;
+
+			utils::CopyOnWrite<Tile>& tile = tiles_[getWindowSlot(tx, ty)];
+			if (tile.read().num_cells == 0)
+				continue;
+
+			const std::vector<unsigned char>& occupied = tile.read().occupied;
+			for (unsigned int cell = 0; cell < TILE_SIZE * TILE_SIZE; cell++) {
+				if (occupied[cell] != 0)
+					removed_keys.push_back(Key((tx << TILE_BITS) + cell / TILE_SIZE,
+											   (ty << TILE_BITS) + cell % TILE_SIZE, 0));
+			}
+			num_cells_ -= clearTile(tile);
+		}
+	}
+	window_x_ = window_x;
+	window_y_ = window_y;
+
+	return true;
+}
+
+
+bool TerrainGrid::isInsideWindow(const Key& key) const
+{
+	if (window_size_ == 0)
+		return true;
+
+	unsigned int tile_x = key.x >> TILE_BITS, tile_y = key.y >> TILE_BITS;
+	return tile_x >= window_x_ && tile_x < window_x_ + window_size_ &&
+			tile_y >= window_y_ && tile_y < window_y_ + window_size_;
+}
+
+
+bool TerrainGrid::isRollingWindow() const
+{
+	return window_size_ != 0;
+}
+
+
+CellRegion TerrainGrid::getWindowRegion() const
+{
+	CellRegion region;
+	if (window_size_ == 0)
+		return region;
+
+	region.add(Key(window_x_ << TILE_BITS, window_y_ << TILE_BITS, 0));
+	region.add(Key(((window_x_ + window_size_) << TILE_BITS) - 1,
+				   ((window_y_ + window_size_) << TILE_BITS) - 1, 0));
+
+	return region;
+}
+
+
+void TerrainGrid::setCell(const Key& key,
+						  double height,
+						  Weight cost,
+						  const Eigen::Vector3d& normal)
+{
+	unsigned int tile_id;
+	if (window_size_ != 0) {
+		// The cells outside the rolling window aren't stored
+		if (!isInsideWindow(key))
+			return;
+
+		tile_id = getWindowSlot(key.x >> TILE_BITS, key.y >> TILE_BITS);
+	} else {
+		// Allocating the directory, which happens only for the first cell
+		if (directory_.read().empty())
+			directory_.write().assign(NUM_TILES * NUM_TILES, -1);
+
+		// Allocating the tile if it doesn't exist, where the directory is modified (i.e.
+		// cloned if it's shared) only in this case
+		unsigned int tile_index = getTileIndex(key);
+		int directory_id = directory_.read()[tile_index];
+		if (directory_id < 0) {
+			if (!free_tiles_.empty()) {
+				directory_id = free_tiles_.back();
+				free_tiles_.pop_back();
+			} else {
+				directory_id = tiles_.size();
+				tiles_.push_back(utils::CopyOnWrite<Tile>());
+			}
+			directory_.write()[tile_index] = directory_id;
+		}
+		tile_id = directory_id;
+	}
+
+	// Setting the values of the cell, where the tile is cloned if it's shared
+	Tile& tile = tiles_[tile_id].write();
+	unsigned int cell = getCellIndex(key);
+	if (tile.occupied[cell] == 0) {
+		tile.occupied[cell] = 1;
+		tile.num_cells++;
+		num_cells_++;
+	}
+	tile.height[cell] = height;
+	tile.cost[cell] = cost;
+	tile.normal[cell] = normal;
+}
+
+
+void TerrainGrid::removeCell(const Key& key)
+{
+	unsigned int tile_id, tile_index = 0;
+	if (window_size_ != 0) {
+		if (!isInsideWindow(key))
+			return;
+
+		tile_id = getWindowSlot(key.x >> TILE_BITS, key.y >> TILE_BITS);
+	} else {
+		if (directory_.read().empty())
+			return;
+
+		tile_index = getTileIndex(key);
+		int directory_id = directory_.read()[tile_index];
+		if (directory_id < 0)
+			return;
+
+		tile_id = directory_id;
+	}
+
+	// Checking the cell before modifying the tile, which avoids cloning a shared tile
+	unsigned int cell = getCellIndex(key);
+	if (tiles_[tile_id].read().occupied[cell] == 0)
+		return;
+
+	Tile& tile = tiles_[tile_id].write();
+	tile.occupied[cell] = 0;
+	tile.num_cells--;
+	num_cells_--;
+
+	// Releasing the tile for reusing it later, where the tiles of the rolling window aren't
+	// released
+	if (tile.num_cells == 0 && window_size_ == 0) {
+		free_tiles_.push_back(tile_id);
+		directory_.write()[tile_index] = -1;
+	}
+}
+
+
+const TerrainGrid::Tile* TerrainGrid::findCell(unsigned int& cell,
+											   const Key& key) const
+{
+	const Tile* tile;
+	if (window_size_ != 0) {
+		if (!isInsideWindow(key))
+			return NULL;
+
+		tile = &tiles_[getWindowSlot(key.x >> TILE_BITS, key.y >> TILE_BITS)].read();
+	} else {
+		const std::vector<int>& directory = directory_.read();
+		if (directory.empty())
+			return NULL;
+
+		int tile_id = directory[getTileIndex(key)];
+		if (tile_id < 0)
+			return NULL;
+
+		tile = &tiles_[tile_id].read();
+	}
+
+	cell = getCellIndex(key);
+	if (tile->occupied[cell] == 0)
+		return NULL;
+
+	return tile;
+}
+
+
+unsigned int TerrainGrid::getNumberOfCells() const
+{
+	return num_cells_;
+}
+
+
+unsigned int TerrainGrid::getNumberOfTiles() const
+{
+	return tiles_.size() - free_tiles_.size();
+}
+
+
+utils::MemoryUsage TerrainGrid::getMemoryUsage() const
+{
+	// The released tiles are kept for reusing them, so they are also counted
+	utils::MemoryUsage usage("terrain_grid");
+	usage.add("directory", utils::getHeapBytes(directory_));
+	usage.add("tiles", utils::getHeapBytes(tiles_));
+	usage.add("free_tiles", utils::getHeapBytes(free_tiles_));
+
+	return usage;
+}
+
+
+unsigned int TerrainGrid::getTileIndex(const Key& key) const
+{
+	return (key.x >> TILE_BITS) * NUM_TILES + (key.y >> TILE_BITS);
+}
+
+
+unsigned int TerrainGrid::getCellIndex(const Key& key) const
+{
+	return (key.x & (TILE_SIZE - 1)) * TILE_SIZE + (key.y & (TILE_SIZE - 1));
+}
+
+
+unsigned int TerrainGrid::getWindowSlot(unsigned int tile_x,
+										unsigned int tile_y) const
+{
+	return (tile_x % window_size_) * window_size_ + tile_y % window_size_;
+}
+
+
+unsigned int TerrainGrid::clearTile(utils::CopyOnWrite<Tile>& tile)
+{
+	unsigned int num_cells = tile.read().num_cells;
+	if (num_cells == 0)
+		return 0;
+
+	// A shared tile is replaced instead of cloned, since its values aren't needed
+	if (tile.isShared())
+		tile.reset();
+	else {
+		std::fill(tile.write().occupied.begin(), tile.write().occupied.end(), 0);
+		tile.write().num_cells = 0;
+	}
+
+	return num_cells;
+}
+
+} //@namespace environment
+} //@namespace dwl
@@ -0,0 +1,170 @@
+#ifndef DWL__ENVIRONMENT__TERRAIN_GRID__H
+#define DWL__ENVIRONMENT__TERRAIN_GRID__H
+
+#include <dwl/utils/EnvironmentRepresentation.h>
+#include <dwl/utils/CopyOnWrite.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <Eigen/StdVector>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @class TerrainGrid
+ * @brief TerrainGrid stores the terrain cells in a dense 2d grid indexed directly by the (x,y)
+ * keys of the space discretization. The grid is divided in square tiles that are allocated only
+ * when a cell is added inside them, so sparse areas don't use memory. Every tile stores its
+ * height, cost and normal values in separated arrays (struct-of-arrays), i.e. a lookup doesn't
+ * search any tree. The grid can be also a rolling window of tiles around the robot, i.e. a
+ * circular buffer of tiles where every tile of the window has a fixed slot given by its
+ * position modulo the window size. So the memory is bounded, and recentering the window only
+ * clears the tiles of the exposed strips. The keys are always the ones of the space
+ * discretization, so the coordinate conversions don't change with the window. The tiles and
+ * the directory are copy-on-write, so a copy of the grid (e.g. a snapshot for a planner) only
+ * shares them, and the modified tiles are cloned by the grid that modifies them
+ */
+class TerrainGrid
+{
+	public:
+		/** @brief Number of bits of the key per tile axis */
+		static const unsigned int TILE_BITS = 6;
+
+		/** @brief Number of cells per tile axis */
+		static const unsigned int TILE_SIZE = 1 << TILE_BITS;
+
+		/** @brief Number of tiles per grid axis (keys are unsigned short ints) */
+		static const unsigned int NUM_TILES = (1 << 16) >> TILE_BITS;
+
+		/** @brief Terrain values of a tile, where the cells are indexed by row */
+		struct Tile
+		{
+			Tile();
+
+			std::vector<double> height;
+			std::vector<Weight> cost;
+			std::vector<Eigen::Vector3d,
+				Eigen::aligned_allocator<Eigen::Vector3d> > normal;
+			std::vector<unsigned char> occupied;
+			unsigned int num_cells;
+
+			/** @brief Gets the heap bytes of the values of the tile */
+			std::size_t getHeapBytes() const;
+		};
+
+		/** @brief Constructor function */
+		TerrainGrid();
+
+		/** @brief Destructor function */
+		~TerrainGrid();
+
+		/** @brief Clears the grid, and releases the tiles (except the ones of the window) */
+		void clear();
+
+		/**
+		 * @brief Sets the rolling window of the grid, which clears it. The window is centered
+		 * in the origin of the keys until it's recentered
+		 * @param unsigned int Number of tiles per window axis (0 for an unbounded grid)
+		 */
+		void setRollingWindow(unsigned int num_tiles);
+
+		/**
+		 * @brief Recenters the rolling window around a key, where the cells of the tiles that
+		 * leave the window are removed
+		 * @param std::vector<Key>& Keys of the removed cells
+		 * @param const Key& Key of the new center
+		 * @return True if the window was moved
+		 */
+		bool recenter(std::vector<Key>& removed_keys,
+					  const Key& center);
+
+		/** @brief Indicates if a key is inside the rolling window (always for an unbounded grid) */
+		bool isInsideWindow(const Key& key) const;
+
+		/** @brief Indicates if the grid is a rolling window */
+		bool isRollingWindow() const;
+
+		/**
+		 * @brief Gets the region of the rolling window
+		 * @return The region of the window (empty for an unbounded grid)
+		 */
+		CellRegion getWindowRegion() const;
+
+		/**
+		 * @brief Sets the values of a cell, where its tile is allocated if it's required
+		 * @param const Key& Key of the cell (only the x and y keys are used)
+		 * @param double Height of the cell
+		 * @param Weight Cost of the cell
+		 * @param const Eigen::Vector3d& Surface normal of the cell
+		 */
+		void setCell(const Key& key,
+					 double height,
+					 Weight cost,
+					 const Eigen::Vector3d& normal);
+
+		/**
+		 * @brief Removes a cell, where its tile is released if it doesn't have more cells
+		 * @param const Key& Key of the cell
+		 */
+		void removeCell(const Key& key);
+
+		/**
+		 * @brief Finds the tile of a cell
+		 * @param unsigned int& Index of the cell inside the tile
+		 * @param const Key& Key of the cell
+		 * @return const Tile* Tile of the cell, or NULL if the cell doesn't exist
+		 */
+		const Tile* findCell(unsigned int& cell,
+							 const Key& key) const;
+
+		/** @brief Gets the number of cells */
+		unsigned int getNumberOfCells() const;
+
+		/** @brief Gets the number of allocated tiles */
+		unsigned int getNumberOfTiles() const;
+
+		/** @brief Gets the memory usage of the directory and of the tiles of the grid */
+		utils::MemoryUsage getMemoryUsage() const;
+
+
+	private:
+		/** @brief Gets the directory index of the tile given a key */
+		unsigned int getTileIndex(const Key& key) const;
+
+		/** @brief Gets the index of the cell inside its tile given a key */
+		unsigned int getCellIndex(const Key& key) const;
+
+		/** @brief Gets the slot of a tile of the rolling window given its tile coordinates */
+		unsigned int getWindowSlot(unsigned int tile_x,
+								   unsigned int tile_y) const;
+
+		/** @brief Removes all the cells of a tile, and returns the number of removed cells */
+		unsigned int clearTile(utils::CopyOnWrite<Tile>& tile);
+
+		/** @brief Tile directory, i.e. position of every tile in the tile pool (-1 if it's free) */
+		utils::CopyOnWrite<std::vector<int> > directory_;
+
+		/** @brief Pool of the allocated tiles */
+		std::vector<utils::CopyOnWrite<Tile> > tiles_;
+
+		/** @brief Released tiles of the pool that can be reused */
+		std::vector<int> free_tiles_;
+
+		/** @brief Number of cells */
+		unsigned int num_cells_;
+
+		/** @brief Number of tiles per axis of the rolling window (0 for an unbounded grid), and
+		 * tile coordinates of its first tile */
+		unsigned int window_size_;
+		unsigned int window_x_;
+		unsigned int window_y_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
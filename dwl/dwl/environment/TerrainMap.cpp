@@ -7,13 +7,17 @@ namespace dwl
 namespace environment
 {
 
+/** @brief Maximum number of incremental changes of the change log */
+static const unsigned int ChangeLogSize = 64;
+
+
 TerrainMap::TerrainMap() :
 		space_discretization_(0.04, 0.04, M_PI / 200),
 		obstacle_discretization_(0.04, 0.04, M_PI / 200),
-		average_cost_(0.), max_cost_(0.),
-		min_height_(std::numeric_limits<double>::max()),
-		terrain_information_(false), obstacle_information_(false),
-		obstacle_resolution_(0.04)
+		average_cost_(0.), cost_sum_(0.), revision_(0), full_change_revision_(0),
+		max_cost_(0.), min_height_(std::numeric_limits<double>::max()),
+		terrain_information_(false),
+		obstacle_information_(false), obstacle_resolution_(0.04)
 {
 	// Setting up the default values of the cell
 	 // TODO compute the default height from robot state
@@ -31,19 +35,28 @@ TerrainMap::~TerrainMap()
 
 void TerrainMap::reset()
 {
-	terrain_map_.clear();
+	terrain_map_.reset();
+	terrain_grid_.clear();
+	terrain_pyramid_.clear();
 	terrain_heightmap_.clear();
+	average_cost_ = 0.;
+	cost_sum_ = 0.;
+	recordFullChange();
 }
 
 
 void TerrainMap::setTerrainMap(const TerrainData& terrain_map)
 {
-	// Cleaning the old information
-	TerrainDataMap empty_terrain_cost_map;
-	terrain_map_.swap(empty_terrain_cost_map);
+	// Cleaning the old information, where the old cells are also changed cells
+	addMapToDirtyRegion();
+	terrain_map_.reset();
+	terrain_grid_.clear();
+	terrain_pyramid_.clear();
 	average_cost_ = 0.;
+	cost_sum_ = 0.;
 
 	// Storing the terrain data according the vertex id
+	TerrainDataMap& cells = terrain_map_.write();
 	Vertex vertex_2d;
 	unsigned int num_cells = terrain_map.data.size();
 	if (num_cells != 0) {
@@ -52,20 +65,27 @@ void TerrainMap::setTerrainMap(const TerrainData& terrain_map)
 		setResolution(terrain_map.height_size, false);
 
 		for (unsigned int i = 0; i < num_cells; i++) {
+			// The cells outside the rolling window aren't stored
+			if (!terrain_grid_.isInsideWindow(terrain_map.data[i].key))
+				continue;
+
 			// Building a cost-map for a every 3d vertex
 			space_discretization_.keyToVertex(vertex_2d, terrain_map.data[i].key, true);
 			double cost_value = terrain_map.data[i].cost;
-			terrain_map_[vertex_2d] = terrain_map.data[i];
+			cells[vertex_2d] = terrain_map.data[i];
+			addCellToTerrainGrid(vertex_2d, terrain_map.data[i]);
+			dirty_region_.add(terrain_map.data[i].key);
 
 			// Setting up the maximum cost value
 			if (cost_value > max_cost_)
 				max_cost_ = cost_value;
 
-			average_cost_ += cost_value;
+			cost_sum_ += cost_value;
 		}
 
 		// Computing the average cost of the terrain
-		average_cost_ /= num_cells;
+		if (!cells.empty())
+			average_cost_ = cost_sum_ / cells.size();
 
 		// Setting up the values of the default cell. Note that these values
 		// are used for unperceived cells
@@ -75,12 +95,115 @@ void TerrainMap::setTerrainMap(const TerrainData& terrain_map)
 
 		terrain_information_ = true;
 	}
+	recordFullChange();
 }
 
 
 void TerrainMap::setTerrainMap(const TerrainDataMap& map)
 {
-	terrain_map_ = map;
+	addMapToDirtyRegion();
+	terrain_map_ = utils::CopyOnWrite<TerrainDataMap>(map);
+	TerrainDataMap& cells = terrain_map_.write();
+
+	// Rebuilding the terrain grid and the running sum of costs
+	terrain_grid_.clear();
+	terrain_pyramid_.clear();
+	cost_sum_ = 0.;
+	Key key;
+	for (TerrainDataMap::iterator cell_it = cells.begin(); cell_it != cells.end(); ) {
+		// The cells outside the rolling window aren't stored
+		space_discretization_.vertexToKey(key, cell_it->first, true);
+		if (!terrain_grid_.isInsideWindow(key)) {
+			cells.erase(cell_it++);
+			continue;
+		}
+
+		addCellToTerrainGrid(cell_it->first, cell_it->second);
+		cost_sum_ += cell_it->second.cost;
+		cell_it++;
+	}
+	addMapToDirtyRegion();
+
+	if (!cells.empty())
+		average_cost_ = cost_sum_ / cells.size();
+	recordFullChange();
+}
+
+
+bool TerrainMap::updateTerrainMap(const TerrainData& terrain_patch)
+{
+	unsigned int num_cells = terrain_patch.data.size();
+	if (num_cells == 0)
+		return false;
+
+	// Doing a full update if it's required
+	if (!terrain_information_) {
+		setTerrainMap(terrain_patch);
+		return true;
+	} else if (fabs(terrain_patch.plane_size - getResolution(true)) > 1e-9 ||
+			fabs(terrain_patch.height_size - getResolution(false)) > 1e-9) {
+		printf(YELLOW "The terrain patch has a different resolution, so the whole terrain"
+				" map is updated\n" COLOR_RESET);
+		setTerrainMap(terrain_patch);
+		return true;
+	}
+
+	// Updating only the cells of the patch, which are logged as one change
+	CellRegion patch_region;
+	for (unsigned int i = 0; i < num_cells; i++) {
+		setTerrainMapCell(terrain_patch.data[i]);
+		patch_region.add(terrain_patch.data[i].key);
+	}
+	recordChange(patch_region);
+
+	return true;
+}
+
+
+const CellRegion& TerrainMap::getDirtyRegion() const
+{
+	return dirty_region_;
+}
+
+
+void TerrainMap::clearDirtyRegion()
+{
+	dirty_region_ = CellRegion();
+}
+
+
+unsigned long TerrainMap::getRevision() const
+{
+	return revision_;
+}
+
+
+bool TerrainMap::isChangedRegion(const CellRegion& region,
+								 unsigned long revision) const
+{
+	if (revision >= revision_)
+		return false;
+
+	// The logged changes have to cover all the revisions after this one
+	if (full_change_revision_ > revision || change_log_.empty() ||
+			change_log_.front().first > revision + 1)
+		return true;
+
+	for (std::deque<std::pair<unsigned long, CellRegion> >::const_reverse_iterator change_it =
+			change_log_.rbegin(); change_it != change_log_.rend(); change_it++) {
+		if (change_it->first <= revision)
+			break;
+
+		const CellRegion& changed_region = change_it->second;
+		if (!region.empty && !changed_region.empty &&
+				region.min_key.x <= changed_region.max_key.x &&
+				changed_region.min_key.x <= region.max_key.x &&
+				region.min_key.y <= changed_region.max_key.y &&
+				changed_region.min_key.y <= region.max_key.y)
+			return true;
+	}
+
+	return false;
 }
 
 
@@ -89,6 +212,8 @@ void TerrainMap::setObstacleMap(const std::vector<Cell>& obstacle_map)
 	// Cleaning the old information
 	ObstacleMap empty_terrain_obstacle_map;
 	obstaclemap_.swap(empty_terrain_obstacle_map);
+	obstacle_grid_.clear();
+	obstacle_distance_.reset(obstacle_resolution_, obstacle_distance_.getMaxDistance());
 
 	//Storing the obstacle-map data according the vertex id
 	Vertex vertex_2d;
@@ -104,6 +229,22 @@ void TerrainMap::setObstacleMap(const std::vector<Cell>& obstacle_map)
 			obstaclemap_[vertex_2d] = true;
 		}
 
+		// Building the obstacle grid in the region of the obstacles
+		CellRegion obstacle_region;
+		for (unsigned int i = 0; i < obstacle_map.size(); i++)
+			obstacle_region.add(obstacle_map[i].key);
+		obstacle_grid_.reset(obstacle_region);
+		std::vector<Key> obstacle_keys(obstacle_map.size());
+		for (unsigned int i = 0; i < obstacle_map.size(); i++) {
+			const Key& key = obstacle_map[i].key;
+			obstacle_keys[i] = Key(key.x, key.y, 0);
+			obstacle_grid_.setOccupied(obstacle_keys[i]);
+		}
+
+		// Computing the distance field of the obstacles
+		obstacle_distance_.reset(obstacle_resolution_, obstacle_distance_.getMaxDistance());
+		obstacle_distance_.compute(obstacle_keys);
+
 		obstacle_information_ = true;
 	}
 }
@@ -123,15 +264,69 @@ void TerrainMap::setTerrainCell(TerrainCell& cell,
 
 void TerrainMap::addCellToTerrainMap(const TerrainCell& cell)
 {
+	setTerrainMapCell(cell);
+
+	CellRegion region;
+	region.add(cell.key);
+	recordChange(region);
+}
+
+
+void TerrainMap::setTerrainMapCell(const TerrainCell& cell)
+{
+	// The cells outside the rolling window aren't stored
+	if (!terrain_grid_.isInsideWindow(cell.key))
+		return;
+
 	Vertex vertex_id;
 	space_discretization_.keyToVertex(vertex_id, cell.key, true);
-	terrain_map_[vertex_id] = cell;
+
+	// Updating the running sum of costs, where the old cost is removed if it exists
+	TerrainDataMap& cells = terrain_map_.write();
+	TerrainDataMap::iterator cell_it = cells.find(vertex_id);
+	if (cell_it != cells.end()) {
+		cost_sum_ -= cell_it->second.cost;
+		cell_it->second = cell;
+	} else
+		cells[vertex_id] = cell;
+	cost_sum_ += cell.cost;
+	average_cost_ = cost_sum_ / cells.size();
+
+	// Setting up the maximum cost value, which is used for unperceived cells
+	if (cell.cost > max_cost_) {
+		max_cost_ = cell.cost;
+		default_cell_.cost = max_cost_;
+	}
+
+	addCellToTerrainGrid(vertex_id, cell);
+	dirty_region_.add(cell.key);
 }
 
 
 void TerrainMap::removeCellToTerrainMap(const Vertex& cell_vertex)
 {
-	terrain_map_.erase(cell_vertex);
+	if (terrain_map_.read().count(cell_vertex) == 0)
+		return;
+
+	// Updating the running sum of costs
+	TerrainDataMap& cells = terrain_map_.write();
+	TerrainDataMap::iterator cell_it = cells.find(cell_vertex);
+	cost_sum_ -= cell_it->second.cost;
+	cells.erase(cell_it);
+	if (cells.empty())
+		average_cost_ = cost_sum_ = 0.;
+	else
+		average_cost_ = cost_sum_ / cells.size();
+
+	Key key;
+	space_discretization_.vertexToKey(key, cell_vertex, true);
+	terrain_grid_.removeCell(key);
+	terrain_pyramid_.updateCell(terrain_grid_, key);
+	dirty_region_.add(key);
+
+	CellRegion region;
+	region.add(key);
+	recordChange(region);
 }
 
 
@@ -142,12 +337,24 @@ void TerrainMap::addCellToTerrainHeightMap(const Vertex& cell_vertex,
 
 	if (height < min_height_)
 		min_height_ = height;
+
+	Key key;
+	CellRegion region;
+	space_discretization_.vertexToKey(key, cell_vertex, true);
+	region.add(key);
+	recordChange(region);
 }
 
 
 void TerrainMap::removeCellToTerrainHeightMap(const Vertex& cell_vertex)
 {
 	terrain_heightmap_.erase(cell_vertex);
+
+	Key key;
+	CellRegion region;
+	space_discretization_.vertexToKey(key, cell_vertex, true);
+	region.add(key);
+	recordChange(region);
 }
 
 
@@ -167,6 +374,7 @@ void TerrainMap::setResolution(double resolution,
 							   bool plane)
 {
 	space_discretization_.setEnvironmentResolution(resolution, plane);
+	recordFullChange();
 }
 
 
@@ -177,6 +385,36 @@ void TerrainMap::setObstacleResolution(double resolution,
 }
 
 
+void TerrainMap::setVertexOrdering(VertexOrdering ordering)
+{
+	space_discretization_.setVertexOrdering(ordering);
+	obstacle_discretization_.setVertexOrdering(ordering);
+	recordFullChange();
+}
+
+
+void TerrainMap::setObstacleDistanceRange(double max_distance)
+{
+	obstacle_distance_.reset(obstacle_resolution_, max_distance);
+}
+
+
+void TerrainMap::setTerrainPyramidLevels(unsigned int num_levels)
+{
+	terrain_pyramid_.reset(num_levels);
+	if (num_levels == 0)
+		return;
+
+	Key key;
+	const TerrainDataMap& cells = terrain_map_.read();
+	for (TerrainDataMap::const_iterator cell_it = cells.begin();
+			cell_it != cells.end(); cell_it++) {
+		space_discretization_.vertexToKey(key, cell_it->first, true);
+		terrain_pyramid_.updateCell(terrain_grid_, key);
+	}
+}
+
+
 void TerrainMap::setStateResolution(double position_resolution,
 									double angular_resolution)
 {
@@ -184,12 +422,104 @@ void TerrainMap::setStateResolution(double position_resolution,
 											   angular_resolution);
 	obstacle_discretization_.setStateResolution(position_resolution,
 												angular_resolution);
+	recordFullChange();
+}
+
+
+void TerrainMap::setStateWindow(const Eigen::Vector2d& center,
+								const Eigen::Vector2d& size)
+{
+	bool changed = space_discretization_.setStateWindow(center, size);
+	obstacle_discretization_.setStateWindow(center, size);
+	if (changed)
+		recordFullChange();
+}
+
+
+void TerrainMap::removeStateWindow()
+{
+	if (!space_discretization_.hasStateWindow())
+		return;
+
+	space_discretization_.removeStateWindow();
+	obstacle_discretization_.removeStateWindow();
+	recordFullChange();
+}
+
+
+void TerrainMap::setRollingWindow(double size)
+{
+	double resolution = space_discretization_.getEnvironmentResolution(true);
+	unsigned int num_tiles = 0;
+	if (size > 0.)
+		num_tiles = (unsigned int) ceil(size / (resolution * TerrainGrid::TILE_SIZE));
+	terrain_grid_.setRollingWindow(num_tiles);
+
+	// Rebuilding the terrain grid with the cells inside the window
+	addMapToDirtyRegion();
+	Key key;
+	cost_sum_ = 0.;
+	TerrainDataMap& cells = terrain_map_.write();
+	for (TerrainDataMap::iterator cell_it = cells.begin(); cell_it != cells.end(); ) {
+		space_discretization_.vertexToKey(key, cell_it->first, true);
+		if (!terrain_grid_.isInsideWindow(key)) {
+			cells.erase(cell_it++);
+			continue;
+		}
+
+		addCellToTerrainGrid(cell_it->first, cell_it->second);
+		cost_sum_ += cell_it->second.cost;
+		cell_it++;
+	}
+	average_cost_ = cells.empty() ? 0. : cost_sum_ / cells.size();
+	setTerrainPyramidLevels(terrain_pyramid_.getNumberOfLevels());
+	recordFullChange();
+}
+
+
+bool TerrainMap::recenterRollingWindow(const Eigen::Vector2d& center)
+{
+	Key key;
+	space_discretization_.coordToKey(key.x, center(rbd::X), true);
+	space_discretization_.coordToKey(key.y, center(rbd::Y), true);
+	std::vector<Key> removed_keys;
+	if (!terrain_grid_.recenter(removed_keys, key))
+		return false;
+
+	// Removing the cells of the exposed strips, which are already removed of the grid
+	CellRegion region;
+	Vertex vertex;
+	TerrainDataMap& cells = terrain_map_.write();
+	for (unsigned int i = 0; i < removed_keys.size(); i++) {
+		space_discretization_.keyToVertex(vertex, removed_keys[i], true);
+		TerrainDataMap::iterator cell_it = cells.find(vertex);
+		if (cell_it != cells.end()) {
+			cost_sum_ -= cell_it->second.cost;
+			cells.erase(cell_it);
+		}
+		terrain_pyramid_.updateCell(terrain_grid_, removed_keys[i]);
+		dirty_region_.add(removed_keys[i]);
+		region.add(removed_keys[i]);
+	}
+	if (cells.empty())
+		average_cost_ = cost_sum_ = 0.;
+	else
+		average_cost_ = cost_sum_ / cells.size();
+	recordChange(region);
+
+	return true;
+}
+
+
+CellRegion TerrainMap::getRollingWindowRegion() const
+{
+	return terrain_grid_.getWindowRegion();
 }
 
 
 const TerrainDataMap& TerrainMap::getTerrainDataMap() const
 {
-	return terrain_map_;
+	return terrain_map_.read();
 }
 
 
@@ -205,10 +535,39 @@ const ObstacleMap& TerrainMap::getObstacleMap() const
 }
 
 
+const OccupancyGrid& TerrainMap::getObstacleGrid() const
+{
+	return obstacle_grid_;
+}
+
+
+const DistanceField& TerrainMap::getObstacleDistanceField() const
+{
+	return obstacle_distance_;
+}
+
+
+const TerrainPyramid& TerrainMap::getTerrainPyramid() const
+{
+	return terrain_pyramid_;
+}
+
+
+const TerrainAggregate* TerrainMap::getTerrainAggregate(const Eigen::Vector2d& position,
+														unsigned int level) const
+{
+	Key key;
+	space_discretization_.coordToKey(key.x, position(0), true);
+	space_discretization_.coordToKey(key.y, position(1), true);
+
+	return terrain_pyramid_.findCell(key, level);
+}
+
+
 const TerrainCell& TerrainMap::getTerrainData(const Vertex& vertex) const
 {
-	TerrainDataMap::const_iterator cell_it = terrain_map_.find(vertex);
-	if (cell_it != terrain_map_.end())
+	TerrainDataMap::const_iterator cell_it = terrain_map_.read().find(vertex);
+	if (cell_it != terrain_map_.read().end())
 		return cell_it->second;
 	else
 		return default_cell_;
@@ -228,8 +587,8 @@ const TerrainCell& TerrainMap::getTerrainData(const Eigen::Vector2d& position) c
 bool TerrainMap::getTerrainData(TerrainCell& cell,
 								const Vertex& vertex) const
 {
-	TerrainDataMap::const_iterator cell_it = terrain_map_.find(vertex);
-	if (cell_it != terrain_map_.end()) {
+	TerrainDataMap::const_iterator cell_it = terrain_map_.read().find(vertex);
+	if (cell_it != terrain_map_.read().end()) {
 		cell = cell_it->second;
 
 		space_discretization_.keyToCoord(cell.height, cell.key.z, false);
@@ -254,9 +613,13 @@ bool TerrainMap::getTerrainData(TerrainCell& cell,
 
 double TerrainMap::getTerrainHeight(const Vertex& vertex) const
 {
+	unsigned int cell;
+	const TerrainGrid::Tile* tile = findGridCell(cell, vertex);
+	if (tile != NULL)
+		return tile->height[cell];
+
 	double height;
-	Key key = getTerrainData(vertex).key;
-	space_discretization_.keyToCoord(height, key.z, false);
+	space_discretization_.keyToCoord(height, default_cell_.key.z, false);
 
 	return height;
 }
@@ -275,12 +638,15 @@ double TerrainMap::getTerrainHeight(const Eigen::Vector2d& position) const
 bool TerrainMap::getTerrainHeight(double& height,
 								  const Vertex& vertex) const
 {
-	TerrainCell cell;
-	bool data = getTerrainData(cell, vertex);
-	Key key = cell.key;
-	space_discretization_.keyToCoord(height, key.z, false);
+	unsigned int cell;
+	const TerrainGrid::Tile* tile = findGridCell(cell, vertex);
+	if (tile != NULL) {
+		height = tile->height[cell];
+		return true;
+	}
 
-	return data;
+	space_discretization_.keyToCoord(height, default_cell_.key.z, false);
+	return false;
 }
 
 
@@ -297,7 +663,12 @@ bool TerrainMap::getTerrainHeight(double& height,
 
 const Weight& TerrainMap::getTerrainCost(const Vertex& vertex) const
 {
-	return getTerrainData(vertex).cost;
+	unsigned int cell;
+	const TerrainGrid::Tile* tile = findGridCell(cell, vertex);
+	if (tile != NULL)
+		return tile->cost[cell];
+	else
+		return default_cell_.cost;
 }
 
 
@@ -314,11 +685,15 @@ const Weight& TerrainMap::getTerrainCost(const Eigen::Vector2d& position) const
 bool TerrainMap::getTerrainCost(Weight& cost,
 								const Vertex& vertex) const
 {
-	TerrainCell cell;
-	bool data = getTerrainData(cell, vertex);
-	cost = cell.cost;
+	unsigned int cell;
+	const TerrainGrid::Tile* tile = findGridCell(cell, vertex);
+	if (tile != NULL) {
+		cost = tile->cost[cell];
+		return true;
+	}
 
-	return data;
+	cost = default_cell_.cost;
+	return false;
 }
 
 
@@ -333,9 +708,29 @@ bool TerrainMap::getTerrainCost(Weight& cost,
 }
 
 
+bool TerrainMap::getTerrainCost(Weight& cost,
+								const Key& key) const
+{
+	unsigned int cell;
+	const TerrainGrid::Tile* tile = terrain_grid_.findCell(cell, key);
+	if (tile != NULL) {
+		cost = tile->cost[cell];
+		return true;
+	}
+
+	cost = default_cell_.cost;
+	return false;
+}
+
+
 const Eigen::Vector3d& TerrainMap::getTerrainNormal(const Vertex& vertex) const
 {
-	return getTerrainData(vertex).normal;
+	unsigned int cell;
+	const TerrainGrid::Tile* tile = findGridCell(cell, vertex);
+	if (tile != NULL)
+		return tile->normal[cell];
+	else
+		return default_cell_.normal;
 }
 
 
@@ -352,11 +747,15 @@ const Eigen::Vector3d& TerrainMap::getTerrainNormal(const Eigen::Vector2d& posit
 bool TerrainMap::getTerrainNormal(Eigen::Vector3d& normal,
 								  const Vertex& vertex) const
 {
-	TerrainCell cell;
-	bool data = getTerrainData(cell, vertex);
-	normal = cell.normal;
+	unsigned int cell;
+	const TerrainGrid::Tile* tile = findGridCell(cell, vertex);
+	if (tile != NULL) {
+		normal = tile->normal[cell];
+		return true;
+	}
 
-	return data;
+	normal = default_cell_.normal;
+	return false;
 }
 
 
@@ -371,6 +770,107 @@ bool TerrainMap::getTerrainNormal(Eigen::Vector3d& normal,
 }
 
 
+bool TerrainMap::getInterpolatedTerrainHeight(double& height,
+											  Eigen::Vector2d& gradient,
+											  const Eigen::Vector2d& position,
+											  TerrainInterpolation method) const
+{
+	// Getting the lower-left cell of the interpolation, i.e. the cell center that is below
+	// the position along both axes, and the position relative to its center
+	double resolution = space_discretization_.getEnvironmentResolution(true);
+	Key key;
+	Eigen::Vector2d center;
+	space_discretization_.coordToKey(key.x, position(rbd::X) - 0.5 * resolution, true);
+	space_discretization_.coordToKey(key.y, position(rbd::Y) - 0.5 * resolution, true);
+	space_discretization_.keyToCoord(center(rbd::X), key.x, true);
+	space_discretization_.keyToCoord(center(rbd::Y), key.y, true);
+	double tx = (position(rbd::X) - center(rbd::X)) / resolution;
+	double ty = (position(rbd::Y) - center(rbd::Y)) / resolution;
+
+	if (method == BilinearInterpolation) {
+		double h[4];
+		bool known = sampleGridHeights(h, key, 2);
+		height = (1 - ty) * ((1 - tx) * h[0] + tx * h[1]) + ty * ((1 - tx) * h[2] + tx * h[3]);
+		gradient(rbd::X) = ((1 - ty) * (h[1] - h[0]) + ty * (h[3] - h[2])) / resolution;
+		gradient(rbd::Y) = ((1 - tx) * (h[2] - h[0]) + tx * (h[3] - h[1])) / resolution;
+
+		return known;
+	}
+
+	// Computing the Catmull-Rom weights of the 4x4 cells and their derivatives
+	double h[16];
+	key.x--;
+	key.y--;
+	bool known = sampleGridHeights(h, key, 4);
+	double wx[4], wy[4], dwx[4], dwy[4];
+	double t[2] = {tx, ty};
+	double* w[2] = {wx, wy};
+	double* dw[2] = {dwx, dwy};
+	for (unsigned int i = 0; i < 2; i++) {
+		double t1 = t[i], t2 = t1 * t1, t3 = t2 * t1;
+		w[i][0] = 0.5 * (-t3 + 2 * t2 - t1);
+		w[i][1] = 0.5 * (3 * t3 - 5 * t2 + 2);
+		w[i][2] = 0.5 * (-3 * t3 + 4 * t2 + t1);
+		w[i][3] = 0.5 * (t3 - t2);
+		dw[i][0] = 0.5 * (-3 * t2 + 4 * t1 - 1);
+		dw[i][1] = 0.5 * (9 * t2 - 10 * t1);
+		dw[i][2] = 0.5 * (-9 * t2 + 8 * t1 + 1);
+		dw[i][3] = 0.5 * (3 * t2 - 2 * t1);
+	}
+
+	height = 0.;
+	gradient.setZero();
+	for (unsigned int y = 0; y < 4; y++) {
+		double row = 0., drow = 0.;
+		for (unsigned int x = 0; x < 4; x++) {
+			row += wx[x] * h[4 * y + x];
+			drow += dwx[x] * h[4 * y + x];
+		}
+		height += wy[y] * row;
+		gradient(rbd::X) += wy[y] * drow;
+		gradient(rbd::Y) += dwy[y] * row;
+	}
+	gradient /= resolution;
+
+	return known;
+}
+
+
+bool TerrainMap::getInterpolatedTerrainNormal(Eigen::Vector3d& normal,
+											  const Eigen::Vector2d& position,
+											  TerrainInterpolation method) const
+{
+	double height;
+	Eigen::Vector2d gradient;
+	bool known = getInterpolatedTerrainHeight(height, gradient, position, method);
+	normal << -gradient(rbd::X), -gradient(rbd::Y), 1.;
+	normal.normalize();
+
+	return known;
+}
+
+
+unsigned int TerrainMap::getInterpolatedTerrainHeights(Eigen::VectorXd& heights,
+													   Eigen::Matrix2Xd& gradients,
+													   const Eigen::Matrix2Xd& positions,
+													   TerrainInterpolation method) const
+{
+	unsigned int num_points = positions.cols();
+	heights.resize(num_points);
+	gradients.resize(2, num_points);
+
+	unsigned int num_unknown = 0;
+	Eigen::Vector2d gradient;
+	for (unsigned int i = 0; i < num_points; i++) {
+		if (!getInterpolatedTerrainHeight(heights(i), gradient, positions.col(i), method))
+			num_unknown++;
+		gradients.col(i) = gradient;
+	}
+
+	return num_unknown;
+}
+
+
 const SpaceDiscretization& TerrainMap::getTerrainSpaceModel() const
 {
 	return space_discretization_;
@@ -383,7 +883,7 @@ const SpaceDiscretization& TerrainMap::getObstacleSpaceModel() const
 }
 
 
-double TerrainMap::getAverageCostOfTerrain()
+double TerrainMap::getAverageCostOfTerrain() const
 {
 	return average_cost_;
 }
@@ -400,5 +900,128 @@ bool TerrainMap::isObstacleInformation()
 	return obstacle_information_;
 }
 
+
+utils::MemoryUsage TerrainMap::getMemoryUsage() const
+{
+	utils::MemoryUsage usage("terrain_map");
+	usage.add("terrain_cells", utils::getHeapBytes(terrain_map_));
+	usage.add(terrain_grid_.getMemoryUsage());
+	usage.add("terrain_pyramid", terrain_pyramid_.getHeapBytes());
+	usage.add("height_map", utils::getHeapBytes(terrain_heightmap_));
+	usage.add("obstacle_cells", utils::getHeapBytes(obstaclemap_));
+	usage.add("obstacle_grid", obstacle_grid_.getHeapBytes());
+	usage.add("obstacle_distance", obstacle_distance_.getHeapBytes());
+	usage.add("change_log", utils::getHeapBytes(change_log_));
+
+	return usage;
+}
+
+
+const TerrainGrid::Tile* TerrainMap::findGridCell(unsigned int& cell,
+												  const Vertex& vertex) const
+{
+	// Checking that the vertex is a valid plane vertex, i.e. it has a key
+	Key key;
+	Vertex key_vertex;
+	space_discretization_.vertexToKey(key, vertex, true);
+	space_discretization_.keyToVertex(key_vertex, key, true);
+	if (key_vertex != vertex)
+		return NULL;
+
+	return terrain_grid_.findCell(cell, key);
+}
+
+
+bool TerrainMap::sampleGridHeights(double* heights,
+								   const Key& first_key,
+								   unsigned int size) const
+{
+	// Reading the cells directly by their keys
+	unsigned int num_cells = size * size, cell;
+	std::vector<int> known_cells;
+	known_cells.reserve(num_cells);
+	Key key;
+	for (unsigned int y = 0; y < size; y++) {
+		key.y = first_key.y + y;
+		for (unsigned int x = 0; x < size; x++) {
+			key.x = first_key.x + x;
+			unsigned int idx = y * size + x;
+			const TerrainGrid::Tile* tile = terrain_grid_.findCell(cell, key);
+			if (tile != NULL) {
+				heights[idx] = tile->height[cell];
+				known_cells.push_back(idx);
+			} else
+				heights[idx] = std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+	if (known_cells.size() == num_cells)
+		return true;
+
+	// Filling the unknown cells with the closest known one, or the default height
+	double default_height;
+	space_discretization_.keyToCoord(default_height, default_cell_.key.z, false);
+	for (unsigned int idx = 0; idx < num_cells; idx++) {
+		if (!std::isnan(heights[idx]))
+			continue;
+
+		int min_distance = std::numeric_limits<int>::max();
+		heights[idx] = default_height;
+		for (unsigned int i = 0; i < known_cells.size(); i++) {
+			int known_idx = known_cells[i];
+			int dx = (int) (known_idx % size) - (int) (idx % size);
+			int dy = (int) (known_idx / size) - (int) (idx / size);
+			if (dx * dx + dy * dy < min_distance) {
+				min_distance = dx * dx + dy * dy;
+				heights[idx] = heights[known_idx];
+			}
+		}
+	}
+
+	return false;
+}
+
+
+void TerrainMap::addMapToDirtyRegion()
+{
+	Key key;
+	const TerrainDataMap& cells = terrain_map_.read();
+	for (TerrainDataMap::const_iterator cell_it = cells.begin();
+			cell_it != cells.end(); cell_it++) {
+		space_discretization_.vertexToKey(key, cell_it->first, true);
+		dirty_region_.add(key);
+	}
+}
+
+
+void TerrainMap::recordChange(const CellRegion& region)
+{
+	if (region.empty)
+		return;
+
+	change_log_.push_back(std::pair<unsigned long, CellRegion>(++revision_, region));
+	if (change_log_.size() > ChangeLogSize)
+		change_log_.pop_front();
+}
+
+
+void TerrainMap::recordFullChange()
+{
+	full_change_revision_ = ++revision_;
+	change_log_.clear();
+}
+
+
+void TerrainMap::addCellToTerrainGrid(const Vertex& vertex,
+									  const TerrainCell& cell)
+{
+	// Note that the height is defined by the height key as in getTerrainData
+	Key key;
+	double height;
+	space_discretization_.vertexToKey(key, vertex, true);
+	space_discretization_.keyToCoord(height, cell.key.z, false);
+	terrain_grid_.setCell(key, height, cell.cost, cell.normal);
+	terrain_pyramid_.updateCell(terrain_grid_, key);
+}
+
 } //@namespace environment
 } //@namespace dwl
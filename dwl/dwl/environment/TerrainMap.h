@@ -2,7 +2,13 @@
 #define DWL__ENVIRONMENT__TERRAIN_MAP__H
 
 #include <dwl/environment/SpaceDiscretization.h>
+#include <dwl/environment/TerrainGrid.h>
+#include <dwl/environment/TerrainPyramid.h>
+#include <dwl/environment/OccupancyGrid.h>
+#include <dwl/environment/DistanceField.h>
+#include <dwl/utils/MemoryUsage.h>
 #include <dwl/utils/utils.h>
+#include <deque>
 
 
 namespace dwl
@@ -11,9 +17,16 @@ namespace dwl
 namespace environment
 {
 
+/**
+ * @brief Interpolation of the terrain heights between the centers of the cells. The bilinear
+ * one is continuous, and the bicubic one (Catmull-Rom) has also continuous gradients
+ */
+enum TerrainInterpolation {BilinearInterpolation, BicubicInterpolation};
+
 /**
  * @class TerrainMap
- * @brief Class for defining the terrain information
+ * @brief Class for defining the terrain information. The terrain cells are stored in a map (for
+ * iterating them) and in a dense tiled grid, which is used by the height, cost and normal lookups
  */
 class TerrainMap
 {
@@ -31,6 +44,47 @@ class TerrainMap
 		void setTerrainMap(const TerrainData& terrain_map);
 		void setTerrainMap(const TerrainDataMap& map);
 
+		/**
+		 * @brief Updates incrementally the terrain map with a terrain patch, i.e. only the cells
+		 * of the patch are added or overwritten, and the rest of cells are kept. The average cost
+		 * is updated with a running sum, and the updated cells are added to the dirty region.
+		 * Note that a full update (setTerrainMap) is done if there isn't terrain information or
+		 * the patch has a different resolution
+		 * @param const TerrainData& Terrain patch
+		 * @return True if the terrain patch was added
+		 */
+		bool updateTerrainMap(const TerrainData& terrain_patch);
+
+		/**
+		 * @brief Gets the region of the cells changed since the last clearing of the dirty
+		 * region, e.g. for invalidating only the cached costs of this region
+		 * @return The dirty region
+		 */
+		const CellRegion& getDirtyRegion() const;
+
+		/** @brief Clears the dirty region, i.e. once the changes were processed */
+		void clearDirtyRegion();
+
+		/**
+		 * @brief Gets the revision of the terrain information, which increases with every
+		 * change of the terrain cells or the space discretization. Unlike the dirty region, it
+		 * isn't cleared by its consumers, so several caches can track the changes
+		 * @return The revision of the terrain information
+		 */
+		unsigned long getRevision() const;
+
+		/**
+		 * @brief Indicates if the cells of a region were changed after a revision, e.g. for
+		 * validating a cached cost of this region. The recent incremental changes are logged,
+		 * so it's always true after a full change (e.g. setTerrainMap) or after the changes
+		 * that were dropped from the log
+		 * @param const CellRegion& Region of cells
+		 * @param unsigned long Revision of the terrain information
+		 * @return True if the region could be changed
+		 */
+		bool isChangedRegion(const CellRegion& region,
+							 unsigned long revision) const;
+
 		/**
 		 * @brief Sets the obstacle map
 		 * @param const std::vector<Cell>& Obstacle map
@@ -101,6 +155,29 @@ class TerrainMap
 		void setObstacleResolution(double resolution,
 								   bool plane);
 
+		/**
+		 * @brief Sets the ordering of the vertexes of the terrain and obstacle models. It has to
+		 * be set before the terrain and obstacle maps
+		 * @param VertexOrdering Vertex ordering
+		 */
+		void setVertexOrdering(VertexOrdering ordering);
+
+		/**
+		 * @brief Sets the maximum distance of the obstacle distance field, i.e. the clearance
+		 * of the cells farther from the obstacles. It's applied to the next obstacle map
+		 * @param double Maximum distance
+		 */
+		void setObstacleDistanceRange(double max_distance);
+
+		/**
+		 * @brief Sets the number of coarse levels of the terrain pyramid, where the level l
+		 * aggregates 2^l x 2^l terrain cells, e.g. for evaluating the far states of long-range
+		 * searches. The pyramid is rebuilt from the current terrain map and then updated with
+		 * every cell change. It's disabled by default (zero levels)
+		 * @param unsigned int Number of coarse levels
+		 */
+		void setTerrainPyramidLevels(unsigned int num_levels);
+
 		/**
 		 * @brief Sets the state resolution of the plane or height
 		 * @param double Position resolution value
@@ -109,6 +186,44 @@ class TerrainMap
 		void setStateResolution(double position_resolution,
 								double angular_resolution);
 
+		/**
+		 * @brief Sets the bounded window of the state positions of the terrain and obstacle
+		 * models, which makes the state vertexes inside it dense (see
+		 * SpaceDiscretization::setStateWindow). A change of the window is a full change of the
+		 * terrain map, since the previous state vertexes aren't valid
+		 * @param const Eigen::Vector2d& Center of the window (e.g. the robot position)
+		 * @param const Eigen::Vector2d& Size of the window, in meters
+		 */
+		void setStateWindow(const Eigen::Vector2d& center,
+							const Eigen::Vector2d& size);
+
+		/** @brief Removes the state window of the terrain and obstacle models */
+		void removeStateWindow();
+
+		/**
+		 * @brief Sets the rolling (robot-centric) window of the terrain map, i.e. only the cells
+		 * inside a fixed-size window are stored, so its memory is bounded. The window is a
+		 * circular buffer of grid tiles, so its size is rounded up to whole tiles, and the
+		 * current cells outside it are removed
+		 * @param double Size of the window, in meters (0 for an unbounded terrain map)
+		 */
+		void setRollingWindow(double size);
+
+		/**
+		 * @brief Recenters the rolling window around a position (e.g. the robot), where only
+		 * the cells of the exposed strips are removed. It's logged as an incremental change of
+		 * the removed cells
+		 * @param const Eigen::Vector2d& Center of the window
+		 * @return True if the window was moved
+		 */
+		bool recenterRollingWindow(const Eigen::Vector2d& center);
+
+		/**
+		 * @brief Gets the region of the rolling window
+		 * @return The region of the window (empty for an unbounded terrain map)
+		 */
+		CellRegion getRollingWindowRegion() const;
+
 		/** @brief Gets the terrain map */
 		const TerrainDataMap& getTerrainDataMap() const;
 
@@ -118,6 +233,26 @@ class TerrainMap
 		/** @brief Gets the obstacle-map (using vertex id) */
 		const ObstacleMap& getObstacleMap() const;
 
+		/** @brief Gets the bit-packed obstacle grid (using the obstacle keys) */
+		const OccupancyGrid& getObstacleGrid() const;
+
+		/** @brief Gets the distance field of the obstacles (using the obstacle keys) */
+		const DistanceField& getObstacleDistanceField() const;
+
+		/** @brief Gets the terrain pyramid (using the terrain keys) */
+		const TerrainPyramid& getTerrainPyramid() const;
+
+		/**
+		 * @brief Gets the aggregated terrain values of the coarse cell that contains a 2d
+		 * position
+		 * @param const Eigen::Vector2d& 2d position
+		 * @param unsigned int Level of the terrain pyramid
+		 * @return const TerrainAggregate* Aggregated values, or NULL if there isn't terrain
+		 * information in the coarse cell
+		 */
+		const TerrainAggregate* getTerrainAggregate(const Eigen::Vector2d& position,
+													unsigned int level) const;
+
 		/**
 		 * @brief Gets the terrain data value give a vertex or 2d position
 		 * @return The cell data
@@ -151,6 +286,16 @@ class TerrainMap
 		bool getTerrainCost(Weight& cost,
 							const Eigen::Vector2d& position) const;
 
+		/**
+		 * @brief Gets the terrain cost value given the (x,y) keys of a cell, i.e. without
+		 * converting a vertex or position (e.g. for the cells of precomputed footprint masks)
+		 * @param Weight& Cost value
+		 * @param const Key& Key of the cell (only the x and y keys are used)
+		 * @return True if the cell has terrain information
+		 */
+		bool getTerrainCost(Weight& cost,
+							const Key& key) const;
+
 		/**
 		 * @brief Gets the terrain normal value give a vertex or 2d position
 		 * @return The cost value
@@ -162,6 +307,49 @@ class TerrainMap
 		bool getTerrainNormal(Eigen::Vector3d& normal,
 							  const Eigen::Vector2d& position) const;
 
+		/**
+		 * @brief Gets the interpolated terrain height of a 2d position and its gradient, i.e.
+		 * a smooth approximation of the terrain for the constraints of the optimizers (e.g.
+		 * footholds on the terrain). The cells around the position are read directly from the
+		 * terrain grid, and the unknown ones take the height of the closest known cell of the
+		 * neighborhood (or the default height)
+		 * @param double& Interpolated height
+		 * @param Eigen::Vector2d& Gradient of the height with respect to the position
+		 * @param const Eigen::Vector2d& 2d position
+		 * @param TerrainInterpolation Interpolation method
+		 * @return False if any cell of the neighborhood is unknown
+		 */
+		bool getInterpolatedTerrainHeight(double& height,
+										  Eigen::Vector2d& gradient,
+										  const Eigen::Vector2d& position,
+										  TerrainInterpolation method = BilinearInterpolation) const;
+
+		/**
+		 * @brief Gets the normal of the interpolated terrain surface of a 2d position
+		 * @param Eigen::Vector3d& Interpolated normal
+		 * @param const Eigen::Vector2d& 2d position
+		 * @param TerrainInterpolation Interpolation method
+		 * @return False if any cell of the neighborhood is unknown
+		 */
+		bool getInterpolatedTerrainNormal(Eigen::Vector3d& normal,
+										  const Eigen::Vector2d& position,
+										  TerrainInterpolation method = BilinearInterpolation) const;
+
+		/**
+		 * @brief Gets the interpolated terrain heights and gradients of a batch of 2d positions
+		 * (e.g. the footholds of every knot)
+		 * @param Eigen::VectorXd& Interpolated heights
+		 * @param Eigen::Matrix2Xd& Gradients of the heights, one per column
+		 * @param const Eigen::Matrix2Xd& 2d positions, one per column
+		 * @param TerrainInterpolation Interpolation method
+		 * @return The number of positions with an unknown cell in their neighborhood
+		 */
+		unsigned int getInterpolatedTerrainHeights(Eigen::VectorXd& heights,
+												   Eigen::Matrix2Xd& gradients,
+												   const Eigen::Matrix2Xd& positions,
+												   TerrainInterpolation method =
+														   BilinearInterpolation) const;
+
 		/**
 		 * @brief Gets the terrain discrete model of the space according
 		 * the resolution of the terrain
@@ -180,7 +368,7 @@ class TerrainMap
 		 * @brief Gets the average cost of the terrain
 		 * @return The average cost of the terrain
 		 */
-		double getAverageCostOfTerrain();
+		double getAverageCostOfTerrain() const;
 
 		/**
 		 * @brief Indicates if it was defined terrain information
@@ -194,8 +382,62 @@ class TerrainMap
 		 */
 		bool isObstacleInformation();
 
+		/**
+		 * @brief Gets the memory usage of the terrain map, i.e. of its terrain and obstacle
+		 * representations
+		 * @return The memory usage of every representation
+		 */
+		utils::MemoryUsage getMemoryUsage() const;
+
 
 	protected:
+		/**
+		 * @brief Finds a cell in the terrain grid given its vertex
+		 * @param unsigned int& Index of the cell inside the tile
+		 * @param const Vertex& Vertex id
+		 * @return const TerrainGrid::Tile* Tile of the cell, or NULL if the cell doesn't exist
+		 */
+		const TerrainGrid::Tile* findGridCell(unsigned int& cell,
+											  const Vertex& vertex) const;
+
+		/**
+		 * @brief Samples the heights of a square neighborhood of cells from the terrain grid,
+		 * where the unknown cells are filled with the closest known one
+		 * @param double* Heights of the cells, indexed by row
+		 * @param const Key& Key of the first (lower-left) cell
+		 * @param unsigned int Number of cells per axis
+		 * @return False if any cell is unknown
+		 */
+		bool sampleGridHeights(double* heights,
+							   const Key& first_key,
+							   unsigned int size) const;
+
+		/**
+		 * @brief Adds a cell to the terrain grid
+		 * @param const Vertex& Vertex id
+		 * @param const TerrainCell& Cell values
+		 */
+		void addCellToTerrainGrid(const Vertex& vertex,
+								  const TerrainCell& cell);
+
+		/** @brief Adds the cells of the terrain map to the dirty region */
+		void addMapToDirtyRegion();
+
+		/**
+		 * @brief Sets a cell of the terrain map, without logging the change
+		 * @param const TerrainCell& Cell values
+		 */
+		void setTerrainMapCell(const TerrainCell& cell);
+
+		/**
+		 * @brief Logs an incremental change of the terrain cells, i.e. a new revision
+		 * @param const CellRegion& Region of the changed cells
+		 */
+		void recordChange(const CellRegion& region);
+
+		/** @brief Logs a change of the whole terrain information, i.e. a new revision */
+		void recordFullChange();
+
 		/** @brief Object of the SpaceDiscretization class for defining the
 		 *  grid routines */
 		SpaceDiscretization space_discretization_;
@@ -205,8 +447,15 @@ class TerrainMap
 		 * conversion routines for the terrain obstacle-map */
 		environment::SpaceDiscretization obstacle_discretization_;
 
-		/** @brief Terrain values mapped using vertex id */
-		TerrainDataMap terrain_map_;
+		/** @brief Terrain values mapped using vertex id, which are shared with the copies of
+		 * the terrain map until they are modified */
+		utils::CopyOnWrite<TerrainDataMap> terrain_map_;
+
+		/** @brief Dense terrain grid with the same cells than the terrain map */
+		TerrainGrid terrain_grid_;
+
+		/** @brief Coarse levels of the terrain grid */
+		TerrainPyramid terrain_pyramid_;
 
 		/** @brief Terrain height map */
 		HeightMap terrain_heightmap_;
@@ -214,12 +463,32 @@ class TerrainMap
 		/** @brief Gathers the obstacles that are mapped using the vertex id */
 		ObstacleMap obstaclemap_;
 
+		/** @brief Bit-packed grid with the same obstacles than the obstacle map */
+		OccupancyGrid obstacle_grid_;
+
+		/** @brief Distance of every cell to its closest obstacle */
+		DistanceField obstacle_distance_;
+
 		/** @brief Default values of the cell, e.g. for unperceived cells */
 		TerrainCell default_cell_;
 
 		/** @brief Average terrain cost which is used for unknown areas */
 		double average_cost_;
 
+		/** @brief Running sum of the terrain costs for updating the average cost */
+		double cost_sum_;
+
+		/** @brief Region of the cells changed since the last clearing */
+		CellRegion dirty_region_;
+
+		/**
+		 * @brief Revision of the terrain information, revision of its last full change, and
+		 * log of the recent incremental changes (revision and region)
+		 */
+		unsigned long revision_;
+		unsigned long full_change_revision_;
+		std::deque<std::pair<unsigned long, CellRegion> > change_log_;
+
 		/** @brief Maximum cost value */
 		double max_cost_;
 
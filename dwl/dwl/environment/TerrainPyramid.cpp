@@ -0,0 +1,159 @@
+#include <dwl/environment/TerrainPyramid.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <algorithm>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+TerrainPyramid::TerrainPyramid()
+{
+
+}
+
+
+TerrainPyramid::~TerrainPyramid()
+{
+
+}
+
+
+void TerrainPyramid::reset(unsigned int num_levels)
+{
+	std::vector<LevelMap> empty_levels(num_levels);
+	levels_.swap(empty_levels);
+}
+
+
+void TerrainPyramid::clear()
+{
+	for (unsigned int l = 0; l < levels_.size(); l++)
+		levels_[l].clear();
+}
+
+
+void TerrainPyramid::updateCell(const TerrainGrid& grid,
+								const Key& key)
+{
+	unsigned int x = key.x, y = key.y;
+	for (unsigned int l = 1; l <= levels_.size(); l++) {
+		// Getting the parent cell of this level
+		x >>= 1;
+		y >>= 1;
+
+		// Aggregating the four children, which are terrain cells in the first level
+		TerrainAggregate aggregate;
+		aggregate.mean_height = aggregate.mean_cost = 0.;
+		aggregate.normal.setZero();
+		for (unsigned int j = 0; j < 2; j++) {
+			for (unsigned int i = 0; i < 2; i++) {
+				unsigned int child_x = 2 * x + i, child_y = 2 * y + j;
+				if (l == 1) {
+					unsigned int cell;
+					Key child_key(child_x, child_y, 0);
+					const TerrainGrid::Tile* tile = grid.findCell(cell, child_key);
+					if (tile == NULL)
+						continue;
+
+					TerrainAggregate child;
+					child.min_height = child.max_height = child.mean_height = tile->height[cell];
+					child.mean_cost = child.max_cost = tile->cost[cell];
+					child.normal = tile->normal[cell];
+					child.num_cells = 1;
+					addChild(aggregate, child);
+				} else {
+					const LevelMap& children = levels_[l - 2];
+					LevelMap::const_iterator child_it =
+							children.find(getIndex(child_x, child_y));
+					if (child_it != children.end())
+						addChild(aggregate, child_it->second);
+				}
+			}
+		}
+
+		// Removing the parent if it doesn't have cells, otherwise computing its means
+		LevelMap& level = levels_[l - 1];
+		if (aggregate.num_cells == 0) {
+			level.erase(getIndex(x, y));
+			continue;
+		}
+
+		aggregate.mean_height /= aggregate.num_cells;
+		aggregate.mean_cost /= aggregate.num_cells;
+		if (aggregate.normal.norm() > 0.)
+			aggregate.normal.normalize();
+		else
+			aggregate.normal = Eigen::Vector3d::UnitZ();
+		level[getIndex(x, y)] = aggregate;
+	}
+}
+
+
+const TerrainAggregate* TerrainPyramid::findCell(const Key& key,
+												 unsigned int level) const
+{
+	if (level == 0 || level > levels_.size())
+		return NULL;
+
+	const LevelMap& cells = levels_[level - 1];
+	LevelMap::const_iterator cell_it = cells.find(getIndex(key.x >> level, key.y >> level));
+	if (cell_it == cells.end())
+		return NULL;
+
+	return &cell_it->second;
+}
+
+
+unsigned int TerrainPyramid::getNumberOfLevels() const
+{
+	return levels_.size();
+}
+
+
+unsigned int TerrainPyramid::getNumberOfCells(unsigned int level) const
+{
+	if (level == 0 || level > levels_.size())
+		return 0;
+
+	return levels_[level - 1].size();
+}
+
+
+void TerrainPyramid::addChild(TerrainAggregate& aggregate,
+							  const TerrainAggregate& child) const
+{
+	if (aggregate.num_cells == 0) {
+		aggregate.min_height = child.min_height;
+		aggregate.max_height = child.max_height;
+		aggregate.max_cost = child.max_cost;
+	} else {
+		aggregate.min_height = std::min(aggregate.min_height, child.min_height);
+		aggregate.max_height = std::max(aggregate.max_height, child.max_height);
+		aggregate.max_cost = std::max(aggregate.max_cost, child.max_cost);
+	}
+
+	// Summing the values weighted by the number of cells, which are averaged by the parent
+	aggregate.mean_height += child.num_cells * child.mean_height;
+	aggregate.mean_cost += child.num_cells * child.mean_cost;
+	aggregate.normal += child.num_cells * child.normal;
+	aggregate.num_cells += child.num_cells;
+}
+
+
+unsigned int TerrainPyramid::getIndex(unsigned int x,
+									  unsigned int y) const
+{
+	return (y << 16) | x;
+}
+
+
+std::size_t TerrainPyramid::getHeapBytes() const
+{
+	return utils::getHeapBytes(levels_);
+}
+
+} //@namespace environment
+} //@namespace dwl
@@ -0,0 +1,115 @@
+#ifndef DWL__ENVIRONMENT__TERRAIN_PYRAMID__H
+#define DWL__ENVIRONMENT__TERRAIN_PYRAMID__H
+
+#include <dwl/environment/TerrainGrid.h>
+#include <unordered_map>
+
+
+namespace dwl
+{
+
+namespace environment
+{
+
+/**
+ * @brief Struct that defines the aggregated terrain values of a coarse cell, i.e. of the terrain
+ * cells inside it
+ */
+struct TerrainAggregate
+{
+	TerrainAggregate() : min_height(0.), max_height(0.), mean_height(0.), mean_cost(0.),
+			max_cost(0.), normal(Eigen::Vector3d::UnitZ()), num_cells(0) {}
+
+	double min_height;
+	double max_height;
+	double mean_height;
+	Weight mean_cost;
+	Weight max_cost;
+	Eigen::Vector3d normal;
+	unsigned int num_cells;
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * @class TerrainPyramid
+ * @brief TerrainPyramid is a mip-map of the terrain grid for long-range planning. The cell of
+ * the level l covers 2^l x 2^l terrain cells, and it aggregates their height (minimum, maximum
+ * and mean), cost (mean and maximum) and normal (mean). The level 0 is the terrain grid itself,
+ * so it isn't stored. Every level is computed from the four children of its cells, so changing
+ * a terrain cell only updates its ancestors, i.e. four lookups per level
+ */
+class TerrainPyramid
+{
+	public:
+		/** @brief Constructor function */
+		TerrainPyramid();
+
+		/** @brief Destructor function */
+		~TerrainPyramid();
+
+		/**
+		 * @brief Resets the pyramid without cells
+		 * @param unsigned int Number of coarse levels (0 disables the pyramid)
+		 */
+		void reset(unsigned int num_levels);
+
+		/** @brief Clears the cells of every level, where the number of levels is kept */
+		void clear();
+
+		/**
+		 * @brief Updates the ancestors of a terrain cell from the terrain grid, e.g. after
+		 * adding, changing or removing the cell
+		 * @param const TerrainGrid& Terrain grid
+		 * @param const Key& Key of the terrain cell (only the x and y keys are used)
+		 */
+		void updateCell(const TerrainGrid& grid,
+						const Key& key);
+
+		/**
+		 * @brief Finds the aggregate of the coarse cell that contains a terrain cell
+		 * @param const Key& Key of the terrain cell
+		 * @param unsigned int Level of the coarse cell, from 1 to the number of levels
+		 * @return const TerrainAggregate* Aggregate of the cell, or NULL if it doesn't exist
+		 */
+		const TerrainAggregate* findCell(const Key& key,
+										 unsigned int level) const;
+
+		/** @brief Gets the number of coarse levels */
+		unsigned int getNumberOfLevels() const;
+
+		/** @brief Gets the number of cells of a level */
+		unsigned int getNumberOfCells(unsigned int level) const;
+
+		/** @brief Gets the heap bytes of the aggregates of all the levels */
+		std::size_t getHeapBytes() const;
+
+
+	private:
+		typedef std::unordered_map<unsigned int, TerrainAggregate> LevelMap;
+
+		/**
+		 * @brief Adds a child to an aggregate, where the means are weighted by the number of
+		 * cells of the child
+		 * @param TerrainAggregate& Aggregate of the parent
+		 * @param const TerrainAggregate& Aggregate of the child
+		 */
+		void addChild(TerrainAggregate& aggregate,
+					  const TerrainAggregate& child) const;
+
+		/**
+		 * @brief Gets the index of a coarse cell within its level
+		 * @param unsigned int Coarse x key
+		 * @param unsigned int Coarse y key
+		 */
+		unsigned int getIndex(unsigned int x,
+							  unsigned int y) const;
+
+		/** @brief Cells of every coarse level, where the level l is stored in l - 1 */
+		std::vector<LevelMap> levels_;
+};
+
+} //@namespace environment
+} //@namespace dwl
+
+#endif
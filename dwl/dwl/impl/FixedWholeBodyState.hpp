@@ -0,0 +1,251 @@
+#ifndef DWL__FIXED_WHOLE_BODY_STATE__IMPL_H
+#define DWL__FIXED_WHOLE_BODY_STATE__IMPL_H
+
+#include <dwl/utils/Orientation.h>
+#include <dwl/utils/Macros.h>
+#include <cstdio>
+
+
+namespace dwl
+{
+
+template<int JointDoF, int NumContacts>
+FixedWholeBodyState<JointDoF,NumContacts>::FixedWholeBodyState() :
+		time(0.), duration(0.), base_pos(rbd::Vector6d::Zero()),
+		base_vel(rbd::Vector6d::Zero()), base_acc(rbd::Vector6d::Zero()),
+		base_eff(rbd::Vector6d::Zero()), joint_pos(JointVector::Zero()),
+		joint_vel(JointVector::Zero()), joint_acc(JointVector::Zero()),
+		joint_eff(JointVector::Zero()), contact_pos(ContactMatrix3d::Zero()),
+		contact_vel(ContactMatrix3d::Zero()), contact_acc(ContactMatrix3d::Zero()),
+		contact_eff(ContactMatrix6d::Zero()), active_contacts((1u << NumContacts) - 1)
+{
+	static_assert(NumContacts < 32, "the contact bitmask supports up to 31 contacts");
+}
+
+
+template<int JointDoF, int NumContacts>
+FixedWholeBodyState<JointDoF,NumContacts>::~FixedWholeBodyState()
+{
+
+}
+
+
+template<int JointDoF, int NumContacts>
+bool FixedWholeBodyState<JointDoF,NumContacts>::fromWholeBodyState(const WholeBodyState& state,
+																   const rbd::BodySelector& contact_names)
+{
+	if (state.getJointDoF() != JointDoF || contact_names.size() != NumContacts) {
+		printf(RED "FATAL: the state has %u joints and %u contacts instead of %i and %i\n"
+				COLOR_RESET, state.getJointDoF(), (unsigned int) contact_names.size(),
+				JointDoF, NumContacts);
+		return false;
+	}
+
+	time = state.time;
+	duration = state.duration;
+	base_pos = state.base_pos;
+	base_vel = state.base_vel;
+	base_acc = state.base_acc;
+	base_eff = state.base_eff;
+	joint_pos = state.joint_pos;
+	joint_vel = state.joint_vel;
+	joint_acc = state.joint_acc;
+	joint_eff = state.joint_eff;
+
+	// Copying the contact quantities in the order of the names, where a contact is active if
+	// the state has any of its quantities, and the missing ones are zero
+	contact_pos.setZero();
+	contact_vel.setZero();
+	contact_acc.setZero();
+	contact_eff.setZero();
+	active_contacts = 0;
+	for (unsigned int i = 0; i < NumContacts; i++) {
+		const std::string& name = contact_names[i];
+		bool active = false;
+		rbd::BodyVectorXd::const_iterator pos_it = state.contact_pos.find(name);
+		if (pos_it != state.contact_pos.end()) {
+			contact_pos.col(i) = pos_it->second;
+			active = true;
+		}
+		rbd::BodyVectorXd::const_iterator vel_it = state.contact_vel.find(name);
+		if (vel_it != state.contact_vel.end()) {
+			contact_vel.col(i) = vel_it->second;
+			active = true;
+		}
+		rbd::BodyVectorXd::const_iterator acc_it = state.contact_acc.find(name);
+		if (acc_it != state.contact_acc.end()) {
+			contact_acc.col(i) = acc_it->second;
+			active = true;
+		}
+		rbd::BodyVector6d::const_iterator eff_it = state.contact_eff.find(name);
+		if (eff_it != state.contact_eff.end()) {
+			contact_eff.col(i) = eff_it->second;
+			active = true;
+		}
+		if (active)
+			active_contacts |= 1u << i;
+	}
+
+	return true;
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::toWholeBodyState(WholeBodyState& state,
+																 const rbd::BodySelector& contact_names) const
+{
+	state.setJointDoF(JointDoF);
+	state.time = time;
+	state.duration = duration;
+	state.base_pos = base_pos;
+	state.base_vel = base_vel;
+	state.base_acc = base_acc;
+	state.base_eff = base_eff;
+	state.joint_pos = joint_pos;
+	state.joint_vel = joint_vel;
+	state.joint_acc = joint_acc;
+	state.joint_eff = joint_eff;
+	// Writing only the active contacts, so the inactive ones aren't allocated (or are removed
+	// from a reused state)
+	for (unsigned int i = 0; i < NumContacts && i < contact_names.size(); i++) {
+		const std::string& name = contact_names[i];
+		if (!isActiveContact(i)) {
+			state.contact_pos.erase(name);
+			state.contact_vel.erase(name);
+			state.contact_acc.erase(name);
+			state.contact_eff.erase(name);
+			continue;
+		}
+
+		state.contact_pos[name] = contact_pos.col(i);
+		state.contact_vel[name] = contact_vel.col(i);
+		state.contact_acc[name] = contact_acc.col(i);
+		state.contact_eff[name] = contact_eff.col(i);
+	}
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::getGeneralizedPosition(Eigen::Ref<GeneralizedVector> q) const
+{
+	// Note that RBDL defines the floating base state as [linear states, angular states]
+	q.template head<3>() = base_pos.template segment<3>(rbd::LX);
+	q.template segment<3>(3) = base_pos.template segment<3>(rbd::AX);
+	q.template tail<JointDoF>() = joint_pos;
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::getGeneralizedVelocity(Eigen::Ref<GeneralizedVector> qd) const
+{
+	// Note that RBDL defines the floating base state as [linear states, angular states]
+	qd.template head<3>() = base_vel.template segment<3>(rbd::LX);
+	qd.template segment<3>(3) = base_vel.template segment<3>(rbd::AX);
+	qd.template tail<JointDoF>() = joint_vel;
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::getGeneralizedAcceleration(Eigen::Ref<GeneralizedVector> qdd) const
+{
+	// Note that RBDL defines the floating base state as [linear states, angular states]
+	qdd.template head<3>() = base_acc.template segment<3>(rbd::LX);
+	qdd.template segment<3>(3) = base_acc.template segment<3>(rbd::AX);
+	qdd.template tail<JointDoF>() = joint_acc;
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::setGeneralizedPosition(const GeneralizedVector& q)
+{
+	base_pos.template segment<3>(rbd::LX) = q.template head<3>();
+	base_pos.template segment<3>(rbd::AX) = q.template segment<3>(3);
+	joint_pos = q.template tail<JointDoF>();
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::setGeneralizedVelocity(const GeneralizedVector& qd)
+{
+	base_vel.template segment<3>(rbd::LX) = qd.template head<3>();
+	base_vel.template segment<3>(rbd::AX) = qd.template segment<3>(3);
+	joint_vel = qd.template tail<JointDoF>();
+}
+
+
+template<int JointDoF, int NumContacts>
+bool FixedWholeBodyState<JointDoF,NumContacts>::isActiveContact(unsigned int index) const
+{
+	return (active_contacts >> index) & 1u;
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::setActiveContact(unsigned int index,
+																 bool active)
+{
+	if (index >= NumContacts)
+		return;
+
+	if (active)
+		active_contacts |= 1u << index;
+	else {
+		active_contacts &= ~(1u << index);
+		contact_pos.col(index).setZero();
+		contact_vel.col(index).setZero();
+		contact_acc.col(index).setZero();
+		contact_eff.col(index).setZero();
+	}
+}
+
+
+template<int JointDoF, int NumContacts>
+unsigned int FixedWholeBodyState<JointDoF,NumContacts>::getNumberOfActiveContacts() const
+{
+	unsigned int num_active = 0;
+	for (unsigned int mask = active_contacts; mask != 0; mask &= mask - 1)
+		num_active++;
+	return num_active;
+}
+
+
+template<int JointDoF, int NumContacts>
+Eigen::Matrix3d FixedWholeBodyState<JointDoF,NumContacts>::getBaseRotation() const
+{
+	return math::getRotationMatrix((Eigen::Vector3d) base_pos.template segment<3>(rbd::AX));
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::getContactPosition_W(ContactMatrix3d& pos_W) const
+{
+	pos_W.noalias() = getBaseRotation() * contact_pos;
+	pos_W.colwise() += base_pos.template segment<3>(rbd::LX);
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::getContactVelocity_W(ContactMatrix3d& vel_W) const
+{
+	// Computing the contact velocities w.r.t. the world frame as in WholeBodyState, i.e.
+	// Xd^W_contact = Xd^W_base + Xd^W_contact/base + omega_base x X^W_contact/base
+	Eigen::Matrix3d W_rot_B = getBaseRotation();
+	ContactMatrix3d pos_fb_W = W_rot_B * contact_pos;
+	vel_W.noalias() = W_rot_B * contact_vel;
+	Eigen::Vector3d rate_W = base_vel.template segment<3>(rbd::AX);
+	for (unsigned int i = 0; i < NumContacts; i++)
+		vel_W.col(i) += base_vel.template segment<3>(rbd::LX) + rate_W.cross(pos_fb_W.col(i));
+}
+
+
+template<int JointDoF, int NumContacts>
+void FixedWholeBodyState<JointDoF,NumContacts>::setContactPosition_W(const ContactMatrix3d& pos_W)
+{
+	ContactMatrix3d pos_rel_W = pos_W;
+	pos_rel_W.colwise() -= base_pos.template segment<3>(rbd::LX);
+	contact_pos.noalias() = getBaseRotation().transpose() * pos_rel_W;
+}
+
+} //@namespace dwl
+
+#endif
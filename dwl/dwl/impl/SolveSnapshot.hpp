@@ -0,0 +1,74 @@
+#ifndef DWL__SOLVE_SNAPSHOT__IMPL_H
+#define DWL__SOLVE_SNAPSHOT__IMPL_H
+
+
+namespace dwl
+{
+
+template<typename Derived>
+void SnapshotEncoder::writeVector(const Eigen::MatrixBase<Derived>& vector)
+{
+	writeUnsigned(vector.size());
+	for (unsigned int j = 0; j < vector.cols(); j++) {
+		for (unsigned int i = 0; i < vector.rows(); i++)
+			writeDouble(vector(i,j));
+	}
+}
+
+
+template<typename T>
+void SnapshotEncoder::writeVectorMap(const std::map<std::string,T>& map)
+{
+	writeUnsigned(map.size());
+	for (typename std::map<std::string,T>::const_iterator it = map.begin();
+			it != map.end(); ++it) {
+		writeString(it->first);
+		writeVector(it->second);
+	}
+}
+
+
+template<typename Derived>
+bool SnapshotDecoder::readVector(Eigen::PlainObjectBase<Derived>& vector)
+{
+	unsigned int size = 0;
+	if (!readUnsigned(size))
+		return false;
+
+	// The fixed-size vectors have to match the encoded size
+	if ((Derived::SizeAtCompileTime != Eigen::Dynamic &&
+			size != (unsigned int) Derived::SizeAtCompileTime) ||
+			size * sizeof(double) > getRemainingBytes()) {
+		valid_ = false;
+		return false;
+	}
+
+	if (Derived::SizeAtCompileTime == Eigen::Dynamic)
+		vector.resize(size, 1);
+	for (unsigned int i = 0; i < size; i++)
+		readDouble(vector.data()[i]);
+
+	return valid_;
+}
+
+
+template<typename T>
+bool SnapshotDecoder::readVectorMap(std::map<std::string,T>& map)
+{
+	map.clear();
+	unsigned int size = 0;
+	if (!readUnsigned(size))
+		return false;
+
+	std::string name;
+	for (unsigned int i = 0; i < size; i++) {
+		if (!readString(name) || !readVector(map[name]))
+			return false;
+	}
+
+	return true;
+}
+
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,318 @@
+#include <dwl/locomotion/CentroidalModelPredictiveControl.h>
+#include <dwl/utils/Algebra.h>
+#include <dwl/utils/Geometry.h>
+#include <limits>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+/** @brief Indexes of the state vector of the MPC */
+enum CentroidalStates {RPY = 0, COM_POS = 3, ANGULAR_VEL = 6, COM_VEL = 9};
+
+/** @brief Number of friction and normal force constraints per foot */
+static const unsigned int FOOT_CONSTRAINTS = 5;
+
+CentroidalModelPredictiveControl::CentroidalModelPredictiveControl() : solver_(NULL),
+		num_feet_(0), num_states_(12), num_inputs_(0), horizon_(0), step_time_(0.),
+		mass_(0.), inertia_(Eigen::Matrix3d::Identity()), gravity_(0., 0., -9.81),
+		friction_coeff_(0.6), max_normal_force_(0.), start_time_(0.)
+{
+
+}
+
+
+CentroidalModelPredictiveControl::~CentroidalModelPredictiveControl()
+{
+
+}
+
+
+bool CentroidalModelPredictiveControl::reset(solver::RiccatiInteriorPoint* solver,
+											 const rbd::BodySelector& feet,
+											 double mass,
+											 const Eigen::Matrix3d& inertia,
+											 unsigned int horizon,
+											 double step_time)
+{
+	if (solver == NULL || mass <= 0. || step_time <= 0.) {
+		printf(RED "Error: the centroidal MPC requires a solver, a positive mass and a"
+				" positive step time\n" COLOR_RESET);
+		return false;
+	}
+
+	solver_ = solver;
+	feet_ = feet;
+	num_feet_ = feet_.size();
+	num_inputs_ = 3 * num_feet_;
+	horizon_ = horizon;
+	step_time_ = step_time;
+	mass_ = mass;
+	inertia_ = inertia;
+	max_normal_force_ = mass_ * gravity_.norm();
+	if (!solver_->init(num_states_, num_inputs_, horizon_, FOOT_CONSTRAINTS * num_feet_))
+		return false;
+
+	// Setting the default weights, where the state errors are more important than the
+	// forces
+	Eigen::VectorXd state_weights(num_states_);
+	state_weights << 10., 10., 10., 10., 10., 50., 0.1, 0.1, 0.1, 1., 1., 1.;
+	setWeights(state_weights, 1e-5);
+
+	// All the feet are in stance by default
+	swing_masks_.assign(horizon_, 0);
+
+	// Preallocating the stage matrices, where the friction pyramid and normal force rows of
+	// every foot are constant, i.e. [fx - mu fz; fx + mu fz; fy - mu fz; fy + mu fz; fz]
+	A_ = Eigen::MatrixXd::Identity(num_states_, num_states_);
+	B_ = Eigen::MatrixXd::Zero(num_states_, num_inputs_);
+	S_ = Eigen::MatrixXd::Zero(num_inputs_, num_states_);
+	b_ = Eigen::VectorXd::Zero(num_states_);
+	q_ = Eigen::VectorXd::Zero(num_states_);
+	r_ = Eigen::VectorXd::Zero(num_inputs_);
+	C_ = Eigen::MatrixXd::Zero(FOOT_CONSTRAINTS * num_feet_, num_states_);
+	D_ = Eigen::MatrixXd::Zero(FOOT_CONSTRAINTS * num_feet_, num_inputs_);
+	lower_bound_ = Eigen::VectorXd::Zero(FOOT_CONSTRAINTS * num_feet_);
+	upper_bound_ = Eigen::VectorXd::Zero(FOOT_CONSTRAINTS * num_feet_);
+	initial_state_ = Eigen::VectorXd::Zero(num_states_);
+	reference_state_ = Eigen::VectorXd::Zero(num_states_);
+	setContactProperties(friction_coeff_, max_normal_force_);
+
+	contact_forces_.clear();
+	for (unsigned int f = 0; f < num_feet_; f++)
+		contact_forces_[feet_[f]] = Eigen::Vector3d::Zero();
+
+	return true;
+}
+
+
+void CentroidalModelPredictiveControl::setGravityVector(const Eigen::Vector3d& gravity)
+{
+	gravity_ = gravity;
+}
+
+
+void CentroidalModelPredictiveControl::setWeights(const Eigen::VectorXd& state_weights,
+												  double force_weight)
+{
+	if (state_weights.size() != num_states_) {
+		printf(YELLOW "Warning: the state weights have to be %i\n" COLOR_RESET, num_states_);
+		return;
+	}
+
+	state_weights_ = state_weights.asDiagonal();
+	force_weights_ = force_weight * Eigen::MatrixXd::Identity(num_inputs_, num_inputs_);
+}
+
+
+void CentroidalModelPredictiveControl::setContactProperties(double friction_coeff,
+															double max_normal_force)
+{
+	friction_coeff_ = friction_coeff;
+	max_normal_force_ = max_normal_force;
+
+	for (unsigned int f = 0; f < num_feet_; f++) {
+		unsigned int row = FOOT_CONSTRAINTS * f;
+		unsigned int col = 3 * f;
+		for (unsigned int i = 0; i < 2; i++) {
+			D_(row + 2 * i, col + i) = 1.;
+			D_(row + 2 * i, col + rbd::Z) = -friction_coeff_;
+			D_(row + 2 * i + 1, col + i) = 1.;
+			D_(row + 2 * i + 1, col + rbd::Z) = friction_coeff_;
+		}
+		D_(row + 4, col + rbd::Z) = 1.;
+	}
+}
+
+
+void CentroidalModelPredictiveControl::setContactSchedule(simulation::PreviewSchedule& schedule,
+														  const std::vector<double>& durations,
+														  double phase_time)
+{
+	unsigned int num_phases = schedule.getNumberPhases();
+	double cycle_duration = 0.;
+	for (unsigned int p = 0; p < durations.size(); p++)
+		cycle_duration += durations[p];
+	if (num_phases == 0 || durations.size() != num_phases || cycle_duration <= 0.) {
+		printf(YELLOW "Warning: the gait schedule requires a positive duration per phase\n"
+				COLOR_RESET);
+		return;
+	}
+
+	// Walking the phases of the schedule, where a stage uses the phase of its start time
+	unsigned int phase = schedule.actual_phase_;
+	double phase_end = durations[phase] - phase_time;
+	for (unsigned int k = 0; k < horizon_; k++) {
+		double time = k * step_time_;
+		while (time >= phase_end) {
+			phase = (phase + 1) % num_phases;
+			phase_end += durations[phase];
+		}
+
+		unsigned int mask = 0;
+		const simulation::PreviewPhase& preview_phase = schedule.getPhase(phase);
+		for (unsigned int f = 0; f < num_feet_; f++) {
+			if (preview_phase.isSwingFoot(feet_[f]))
+				mask |= 1 << f;
+		}
+		swing_masks_[k] = mask;
+	}
+}
+
+
+bool CentroidalModelPredictiveControl::compute(const ReducedBodyState& state,
+											   const ReducedBodyTrajectory& reference)
+{
+	if (solver_ == NULL || reference.empty()) {
+		printf(RED "Error: the centroidal MPC requires a reset and a reference"
+				" trajectory\n" COLOR_RESET);
+		return false;
+	}
+
+	// Setting the stages of the horizon, where the last reference state is held
+	unsigned int last = reference.size() - 1;
+	for (unsigned int k = 0; k < horizon_; k++)
+		setStage(k, state, reference[std::min(k, last)]);
+
+	toStateVector(reference_state_, reference[std::min(horizon_, last)]);
+	reference_state_(RPY + rbd::Z) = unwrapYaw(reference_state_(RPY + rbd::Z), state);
+	solver_->setTerminalCost(state_weights_, -state_weights_ * reference_state_);
+
+	// Solving the problem from the actual state
+	start_time_ = state.time;
+	toStateVector(initial_state_, state);
+	if (!solver_->compute(initial_state_))
+		return false;
+
+	const Eigen::VectorXd& forces = solver_->getOptimalInput(0);
+	for (unsigned int f = 0; f < num_feet_; f++) {
+		if (swing_masks_[0] & (1 << f))
+			contact_forces_[feet_[f]].setZero();
+		else
+			contact_forces_[feet_[f]] = forces.segment<3>(3 * f);
+	}
+
+	return true;
+}
+
+
+const rbd::BodyVector3d& CentroidalModelPredictiveControl::getContactForces() const
+{
+	return contact_forces_;
+}
+
+
+void CentroidalModelPredictiveControl::getPredictedTrajectory(ReducedBodyTrajectory& trajectory) const
+{
+	trajectory.resize(horizon_ + 1);
+	for (unsigned int k = 0; k < horizon_ + 1; k++) {
+		const Eigen::VectorXd& x = solver_->getOptimalState(k);
+		ReducedBodyState& point = trajectory[k];
+		point.time = start_time_ + k * step_time_;
+		point.angular_pos = x.segment<3>(RPY);
+		point.com_pos = x.segment<3>(COM_POS);
+		point.angular_vel = x.segment<3>(ANGULAR_VEL);
+		point.com_vel = x.segment<3>(COM_VEL);
+	}
+}
+
+
+unsigned int CentroidalModelPredictiveControl::getHorizon() const
+{
+	return horizon_;
+}
+
+
+void CentroidalModelPredictiveControl::setStage(unsigned int stage,
+												const ReducedBodyState& state,
+												const ReducedBodyState& reference)
+{
+	// Linearizing around the nominal yaw, where the yaw of the reference is unwrapped around
+	// the actual one
+	toStateVector(reference_state_, reference);
+	double yaw = unwrapYaw(reference.angular_pos(rbd::Z), state);
+	reference_state_(RPY + rbd::Z) = yaw;
+	Eigen::Matrix3d rot_z =
+			Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+	Eigen::Matrix3d inv_inertia_W = (rot_z * inertia_ * rot_z.transpose()).inverse();
+
+	// Computing the discrete dynamics with forward Euler, where the swing feet don't act on
+	// the CoM
+	A_.block<3,3>(RPY, ANGULAR_VEL) = rot_z.transpose() * step_time_;
+	A_.block<3,3>(COM_POS, COM_VEL) = Eigen::Matrix3d::Identity() * step_time_;
+	B_.setZero();
+	b_.segment<3>(COM_VEL) = gravity_ * step_time_;
+
+	// Counting the stance feet, whose nominal forces compensate the gravity
+	unsigned int num_stance = 0;
+	for (unsigned int f = 0; f < num_feet_; f++) {
+		if (!(swing_masks_[stage] & (1 << f)))
+			++num_stance;
+	}
+	Eigen::Vector3d nominal_force = Eigen::Vector3d::Zero();
+	if (num_stance != 0)
+		nominal_force = -mass_ * gravity_ / num_stance;
+
+	const double inf = std::numeric_limits<double>::max();
+	r_.setZero();
+	for (unsigned int f = 0; f < num_feet_; f++) {
+		const std::string& name = feet_[f];
+		unsigned int row = FOOT_CONSTRAINTS * f;
+		bool stance = !(swing_masks_[stage] & (1 << f));
+
+		// Getting the nominal foot position, i.e. of the reference or actual state
+		Eigen::Vector3d foot_pos;
+		if (reference.foot_pos.count(name) != 0)
+			foot_pos = reference.getFootPosition_W(name);
+		else if (state.foot_pos.count(name) != 0)
+			foot_pos = state.getFootPosition_W(name);
+		else
+			stance = false;
+
+		if (stance) {
+			Eigen::Vector3d lever = foot_pos - reference.com_pos;
+			B_.block<3,3>(ANGULAR_VEL, 3 * f) = inv_inertia_W *
+					math::skewSymmetricMatrixFromVector(lever) * step_time_;
+			B_.block<3,3>(COM_VEL, 3 * f) = Eigen::Matrix3d::Identity() * step_time_ / mass_;
+			r_.segment<3>(3 * f) = -force_weights_.block<3,3>(3 * f, 3 * f) * nominal_force;
+
+			lower_bound_.segment<5>(row) << -inf, 0., -inf, 0., 0.;
+			upper_bound_.segment<5>(row) << 0., inf, 0., inf, max_normal_force_;
+		} else {
+			lower_bound_.segment<5>(row).setConstant(-inf);
+			upper_bound_.segment<5>(row).setConstant(inf);
+		}
+	}
+
+	// Tracking the reference state and the nominal forces, i.e. 1/2 (x - x_ref)' Q (x - x_ref)
+	// + 1/2 (u - u_nom)' R (u - u_nom)
+	q_ = -state_weights_ * reference_state_;
+	solver_->setDynamics(stage, A_, B_, b_);
+	solver_->setCost(stage, state_weights_, force_weights_, S_, q_, r_);
+	solver_->setConstraints(stage, C_, D_, lower_bound_, upper_bound_);
+}
+
+
+double CentroidalModelPredictiveControl::unwrapYaw(double yaw,
+												   const ReducedBodyState& state) const
+{
+	double yaw_error = yaw - state.angular_pos(rbd::Z);
+	math::normalizeAngle(yaw_error, MinusPiToPi);
+	return state.angular_pos(rbd::Z) + yaw_error;
+}
+
+
+void CentroidalModelPredictiveControl::toStateVector(Eigen::VectorXd& x,
+													 const ReducedBodyState& state) const
+{
+	x.segment<3>(RPY) = state.angular_pos;
+	x.segment<3>(COM_POS) = state.com_pos;
+	x.segment<3>(ANGULAR_VEL) = state.angular_vel;
+	x.segment<3>(COM_VEL) = state.com_vel;
+}
+
+} //@namespace locomotion
+} //@namespace dwl
@@ -0,0 +1,201 @@
+#ifndef DWL__LOCOMOTION__CENTROIDAL_MODEL_PREDICTIVE_CONTROL__H
+#define DWL__LOCOMOTION__CENTROIDAL_MODEL_PREDICTIVE_CONTROL__H
+
+#include <dwl/ReducedBodyState.h>
+#include <dwl/simulation/PreviewLocomotion.h>
+#include <dwl/solver/RiccatiInteriorPoint.h>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+/**
+ * @class CentroidalModelPredictiveControl
+ * @brief Convex MPC of the contact forces with the centroidal dynamics, i.e. the single
+ * rigid-body model of the ocp::CentroidalDynamicalSystem (linear and angular momentum at the
+ * CoM), in the spirit of Di Carlo et al. "Dynamic Locomotion in the MIT Cheetah 3 Through
+ * Convex Model-Predictive Control". The state is x = [rpy; com_pos; angular_vel; com_vel]
+ * (world frame) and the input is the linear force of every foot, where the dynamics is
+ * linearized around the nominal yaw and foot positions of the reference trajectory, i.e. a LTV
+ * model per stage:
+ * \f{eqnarray*}{
+ * 	\dot{\mathbf{\theta}} \approx \mathbf{R}_z(\psi)^T \mathbf{\omega}, \quad
+ * 	\dot{\mathbf{\omega}} \approx \mathbf{I}_W^{-1} \sum_i \mathbf{r}_i \times \mathbf{f}_i, \quad
+ * 	\dot{\mathbf{v}} = \frac{1}{m} \sum_i \mathbf{f}_i + \mathbf{g}
+ * \f}
+ * The contact sequence of the horizon comes from a gait schedule (simulation::PreviewSchedule),
+ * where the stance forces are constrained by the linearized friction pyramids and the normal
+ * force limits, and the swing forces don't act on the dynamics. The resulting QP is sparse
+ * (uncondensed), so it's solved with a Riccati recursion (solver::RiccatiInteriorPoint), i.e.
+ * the cost scales linearly with the horizon
+ */
+class CentroidalModelPredictiveControl
+{
+	public:
+		/** @brief Constructor function */
+		CentroidalModelPredictiveControl();
+
+		/** @brief Destructor function */
+		~CentroidalModelPredictiveControl();
+
+		/**
+		 * @brief Resets the MPC, i.e. it sizes the problem of the horizon
+		 * @param solver::RiccatiInteriorPoint* Structure-exploiting solver
+		 * @param const rbd::BodySelector& Feet of the robot, i.e. the order of the inputs
+		 * @param double Total mass of the robot
+		 * @param const Eigen::Matrix3d& Rotational inertia at the CoM in the base frame (e.g.
+		 * the angular block of WholeBodyDynamics::computeCentroidalInertiaMatrix at the nominal
+		 * posture)
+		 * @param unsigned int Horizon, i.e. number of stages
+		 * @param double Step time of the stages
+		 * @return bool Label that indicates if the MPC was reset
+		 */
+		bool reset(solver::RiccatiInteriorPoint* solver,
+				   const rbd::BodySelector& feet,
+				   double mass,
+				   const Eigen::Matrix3d& inertia,
+				   unsigned int horizon,
+				   double step_time);
+
+		/**
+		 * @brief Sets the gravity vector. The default value is [0 0 -9.81]
+		 * @param const Eigen::Vector3d& Gravity vector
+		 */
+		void setGravityVector(const Eigen::Vector3d& gravity);
+
+		/**
+		 * @brief Sets the weights of the state errors and of the contact forces, where the
+		 * force errors are relative to the nominal forces, i.e. the weight of the robot shared by
+		 * the stance feet
+		 * @param const Eigen::VectorXd& Weights of the state errors, i.e. [rpy; com_pos;
+		 * angular_vel; com_vel]
+		 * @param double Weight of the contact forces
+		 */
+		void setWeights(const Eigen::VectorXd& state_weights,
+						double force_weight);
+
+		/**
+		 * @brief Sets the contact properties. The default values are 0.6 and the weight of the
+		 * robot
+		 * @param double Friction coefficient
+		 * @param double Maximum normal force of a foot
+		 */
+		void setContactProperties(double friction_coeff,
+								  double max_normal_force);
+
+		/**
+		 * @brief Sets the contact sequence of the horizon from a gait schedule. The horizon
+		 * starts in the actual phase of the schedule, and the schedule is repeated until the
+		 * end of the horizon
+		 * @param simulation::PreviewSchedule& Gait schedule
+		 * @param const std::vector<double>& Duration of every phase of the schedule
+		 * @param double Elapsed time of the actual phase
+		 */
+		void setContactSchedule(simulation::PreviewSchedule& schedule,
+								const std::vector<double>& durations,
+								double phase_time = 0.);
+
+		/**
+		 * @brief Computes the contact forces that track a reference trajectory. The reference
+		 * state of a stage defines its nominal yaw and foot positions (the actual foot positions
+		 * are used otherwise), and the last state is held until the end of the horizon
+		 * @param const ReducedBodyState& Actual state
+		 * @param const ReducedBodyTrajectory& Reference trajectory of the stages (the first one
+		 * is the actual time)
+		 * @return bool Label that indicates if a solution was computed
+		 */
+		bool compute(const ReducedBodyState& state,
+					 const ReducedBodyTrajectory& reference);
+
+		/** @brief Gets the contact forces of the first stage (world frame) */
+		const rbd::BodyVector3d& getContactForces() const;
+
+		/**
+		 * @brief Gets the predicted trajectory of the last computation, i.e. the CoM and
+		 * angular states of the stages
+		 * @param ReducedBodyTrajectory& Predicted trajectory
+		 */
+		void getPredictedTrajectory(ReducedBodyTrajectory& trajectory) const;
+
+		/** @brief Gets the horizon of the MPC */
+		unsigned int getHorizon() const;
+
+
+	private:
+		/**
+		 * @brief Sets the dynamics, cost and constraints of a stage
+		 * @param unsigned int Stage index
+		 * @param const ReducedBodyState& Actual state
+		 * @param const ReducedBodyState& Reference state of the stage
+		 */
+		void setStage(unsigned int stage,
+					  const ReducedBodyState& state,
+					  const ReducedBodyState& reference);
+
+		/**
+		 * @brief Unwraps a reference yaw around the yaw of the actual state
+		 * @param double Reference yaw
+		 * @param const ReducedBodyState& Actual state
+		 * @return double The unwrapped yaw
+		 */
+		double unwrapYaw(double yaw,
+						 const ReducedBodyState& state) const;
+
+		/**
+		 * @brief Converts a reduced-body state to the state vector of the MPC
+		 * @param Eigen::VectorXd& State vector
+		 * @param const ReducedBodyState& Reduced-body state
+		 */
+		void toStateVector(Eigen::VectorXd& x,
+						   const ReducedBodyState& state) const;
+
+		/** @brief Structure-exploiting solver */
+		solver::RiccatiInteriorPoint* solver_;
+
+		/** @brief Feet of the robot */
+		rbd::BodySelector feet_;
+
+		/** @brief Dimensions of the problem */
+		unsigned int num_feet_;
+		unsigned int num_states_;
+		unsigned int num_inputs_;
+		unsigned int horizon_;
+		double step_time_;
+
+		/** @brief Centroidal properties of the robot */
+		double mass_;
+		Eigen::Matrix3d inertia_;
+		Eigen::Vector3d gravity_;
+
+		/** @brief Contact properties */
+		double friction_coeff_;
+		double max_normal_force_;
+
+		/** @brief Swing feet (bitmask) of every stage */
+		std::vector<unsigned int> swing_masks_;
+
+		/** @brief Weights of the problem */
+		Eigen::MatrixXd state_weights_;
+		Eigen::MatrixXd force_weights_;
+
+		/** @brief Preallocated matrices and vectors of a stage */
+		Eigen::MatrixXd A_, B_, S_;
+		Eigen::VectorXd b_, q_, r_;
+		Eigen::MatrixXd C_, D_;
+		Eigen::VectorXd lower_bound_, upper_bound_;
+		Eigen::VectorXd initial_state_, reference_state_;
+
+		/** @brief Start time of the last computation */
+		double start_time_;
+
+		/** @brief Contact forces of the first stage */
+		rbd::BodyVector3d contact_forces_;
+};
+
+} //@namespace locomotion
+} //@namespace dwl
+
+#endif
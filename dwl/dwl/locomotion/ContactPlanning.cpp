@@ -1,4 +1,7 @@
 #include <dwl/locomotion/ContactPlanning.h>
+#include <dwl/utils/Orientation.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -8,7 +11,8 @@ namespace locomotion
 {
 
 ContactPlanning::ContactPlanning() : terrain_(NULL), robot_(NULL),
-		computation_time_(std::numeric_limits<double>::max()), contact_horizon_(0)
+		computation_time_(std::numeric_limits<double>::max()), contact_horizon_(0),
+		cost_to_go_weight_(0.), foothold_cache_size_(1 << 16), num_cache_hits_(0)
 {
 
 }
@@ -30,6 +34,7 @@ void ContactPlanning::reset(robot::Robot* robot,
 	printf(BLUE "Setting the terrain information in the %s contact"
 			" planner \n" COLOR_RESET, name_.c_str());
 	terrain_ = terrain;
+	foothold_cache_.clear();
 
 	for (int i = 0; i < (int) features_.size(); i++)
 		features_[i]->reset(robot);
@@ -47,6 +52,180 @@ void ContactPlanning::addFeature(environment::Feature* feature)
 }
 
 
+void ContactPlanning::scoreFootholdCandidates(FootholdCandidateMap& candidates,
+											  const Pose& body_pose,
+											  const Eigen::Vector3d& action,
+											  unsigned int num_threads)
+{
+	candidates.clear();
+	if (robot_ == NULL || terrain_ == NULL) {
+		printf(RED "FATAL: the robot and terrain information weren't reset\n" COLOR_RESET);
+		return;
+	}
+
+	// Getting the cells of the footstep search area of every leg, which are rotated according
+	// to the yaw of the body by the robot (precomputed for its headings)
+	Eigen::Matrix3d rotation = math::getRotationMatrix(body_pose.orientation);
+	double yaw = math::getRPY(body_pose.orientation)(2);
+	Eigen::Vector2d body_pos = body_pose.position.head<2>();
+	const SearchAreaCells& search_cells = robot_->getFootstepSearchCells(action, yaw);
+	const SearchAreaMap& workspaces = robot_->getPredefinedLegWorkspaces();
+	std::vector<unsigned int> legs;
+	std::vector<Eigen::Vector2d> cells;
+	std::vector<Eigen::Vector3d> lower_bounds, upper_bounds;
+	unsigned int cell_idx = 0;
+	for (unsigned int n = 0; n < search_cells.ids.size(); n++) {
+		unsigned int leg_id = search_cells.ids[n];
+
+		// Getting the workspace of the leg, which is unbounded if it wasn't defined
+		Eigen::Vector3d lower_bound =
+				-std::numeric_limits<double>::max() * Eigen::Vector3d::Ones();
+		Eigen::Vector3d upper_bound = -lower_bound;
+		SearchAreaMap::const_iterator workspace_it = workspaces.find(leg_id);
+		if (workspace_it != workspaces.end()) {
+			const SearchArea& workspace = workspace_it->second;
+			lower_bound << workspace.min_x, workspace.min_y, workspace.min_z;
+			upper_bound << workspace.max_x, workspace.max_y, workspace.max_z;
+		}
+
+		unsigned int end_idx = cell_idx + search_cells.sizes[n];
+		for (; cell_idx < end_idx; cell_idx++) {
+			legs.push_back(leg_id);
+			cells.push_back(body_pos + search_cells.points.col(cell_idx));
+			lower_bounds.push_back(lower_bound);
+			upper_bounds.push_back(upper_bound);
+		}
+	}
+
+	unsigned int num_cells = cells.size();
+	if (num_cells == 0)
+		return;
+
+	// Looking up the terrain samples of the cells in the foothold cache, where the cells that
+	// weren't cached, or whose terrain changed, are sampled again
+	unsigned long revision = terrain_->getRevision();
+	const environment::SpaceDiscretization& space_model = terrain_->getTerrainSpaceModel();
+	std::vector<Vertex> vertices(num_cells);
+	std::vector<FootholdSample> samples(num_cells);
+	std::vector<unsigned int> missed_cells;
+	num_cache_hits_ = 0;
+	for (unsigned int i = 0; i < num_cells; i++) {
+		space_model.coordToVertex(vertices[i], cells[i]);
+		if (findFootholdSample(samples[i], vertices[i], revision))
+			num_cache_hits_++;
+		else
+			missed_cells.push_back(i);
+	}
+
+	// Sampling the terrain of the missed cells, where the unknown cells are discarded
+	auto sampleCells = [&](unsigned int first, unsigned int last) {
+		for (unsigned int k = first; k < last; k++) {
+			unsigned int i = missed_cells[k];
+			FootholdSample& sample = samples[i];
+			sample.is_known = terrain_->getTerrainHeight(sample.height, vertices[i]) &&
+					terrain_->getTerrainCost(sample.cost, vertices[i]);
+			terrain_->getTerrainNormal(sample.normal, vertices[i]);
+			sample.revision = revision;
+		}
+	};
+
+	// Distributing contiguous chunks of missed cells across the threads of the task scheduler.
+	// Note that the terrain lookups are read-only
+	unsigned int num_missed = missed_cells.size();
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::max(std::min(num_threads, num_missed), 1u);
+	unsigned int chunk_size = (num_missed + num_threads - 1) / num_threads;
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_missed);
+		sampleCells(first, std::min(first + chunk_size, num_missed));
+	});
+
+	// Caching the new samples, where the cache is cleared once it's full
+	if (foothold_cache_size_ > 0) {
+		for (unsigned int k = 0; k < num_missed; k++) {
+			if (foothold_cache_.size() >= foothold_cache_size_)
+				foothold_cache_.clear();
+			foothold_cache_[vertices[missed_cells[k]]] = samples[missed_cells[k]];
+		}
+	}
+
+	Eigen::Matrix3Xd positions(3, num_cells);
+	for (unsigned int i = 0; i < num_cells; i++) {
+		if (samples[i].is_known)
+			positions.col(i) << cells[i], samples[i].height;
+		else
+			positions.col(i) << cells[i], body_pose.position(2);
+	}
+
+	// Checking the kinematic reachability of all the candidates at once, i.e. they are
+	// transformed to the body frame and compared with the workspace bounds of their legs
+	Eigen::Matrix3Xd body_positions =
+			rotation.transpose() * (positions.colwise() - body_pose.position);
+	Eigen::Map<Eigen::Matrix3Xd> lower(lower_bounds[0].data(), 3, num_cells);
+	Eigen::Map<Eigen::Matrix3Xd> upper(upper_bounds[0].data(), 3, num_cells);
+	Eigen::Array<bool, 1, Eigen::Dynamic> reachable =
+			((body_positions.array() >= lower.array()) &&
+			(body_positions.array() <= upper.array())).colwise().all();
+	for (unsigned int i = 0; i < num_cells; i++) {
+		if (samples[i].is_known && reachable(i))
+			candidates[legs[i]].push_back(FootholdCandidate(positions.col(i), samples[i].cost,
+															samples[i].normal));
+	}
+
+	// Sorting the candidates of every leg by cost
+	for (FootholdCandidateMap::iterator leg_it = candidates.begin();
+			leg_it != candidates.end(); leg_it++) {
+		std::stable_sort(leg_it->second.begin(), leg_it->second.end(),
+						 [](const FootholdCandidate& a, const FootholdCandidate& b) {
+							 return a.cost < b.cost;
+						 });
+	}
+}
+
+
+void ContactPlanning::setFootholdCacheSize(unsigned int max_cells)
+{
+	foothold_cache_size_ = max_cells;
+	if (foothold_cache_.size() > foothold_cache_size_)
+		foothold_cache_.clear();
+}
+
+
+unsigned int ContactPlanning::getNumberOfFootholdCacheHits() const
+{
+	return num_cache_hits_;
+}
+
+
+bool ContactPlanning::findFootholdSample(FootholdSample& sample,
+										 Vertex vertex,
+										 unsigned long revision)
+{
+	if (foothold_cache_size_ == 0)
+		return false;
+
+	const FootholdSample* cached_sample = foothold_cache_.find(vertex);
+	if (cached_sample == NULL)
+		return false;
+
+	// Validating the sample with the changes of its cell since its last validation
+	if (cached_sample->revision != revision) {
+		Key key;
+		terrain_->getTerrainSpaceModel().vertexToKey(key, vertex, true);
+		CellRegion region;
+		region.add(key);
+		if (terrain_->isChangedRegion(region, cached_sample->revision))
+			return false;
+
+		foothold_cache_[vertex].revision = revision;
+	}
+
+	sample = *cached_sample;
+	return true;
+}
+
+
 void ContactPlanning::setComputationTime(double computation_time)
 {
 	printf("Setting the allowed computation time of the contact solver"
@@ -61,6 +240,18 @@ void ContactPlanning::setContactHorizon(int horizon)
 }
 
 
+void ContactPlanning::setCostToGoField(std::shared_ptr<const environment::CostToGoField> cost_to_go)
+{
+	cost_to_go_ = cost_to_go;
+}
+
+
+void ContactPlanning::setCostToGoWeight(double weight)
+{
+	cost_to_go_weight_ = weight;
+}
+
+
 std::vector<ContactSearchRegion> ContactPlanning::getContactSearchRegions()
 {
 	std::vector<ContactSearchRegion> contact_search_regions;
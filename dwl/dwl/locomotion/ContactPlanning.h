@@ -2,9 +2,11 @@
 #define DWL__LOCOMOTION__CONTACT_PLANNING__H
 
 #include <dwl/environment/TerrainMap.h>
+#include <dwl/environment/CostToGoField.h>
 #include <dwl/environment/Feature.h>
 #include <dwl/robot/Robot.h>
 #include <dwl/utils/utils.h>
+#include <dwl/utils/VertexTable.h>
 
 
 namespace dwl
@@ -13,6 +15,45 @@ namespace dwl
 namespace locomotion
 {
 
+/**
+ * @brief Struct that defines a scored foothold candidate
+ */
+struct FootholdCandidate
+{
+	FootholdCandidate() : position(Eigen::Vector3d::Zero()), cost(0.),
+			normal(Eigen::Vector3d::UnitZ()) {}
+	FootholdCandidate(const Eigen::Vector3d& _position,
+					  double _cost) : position(_position), cost(_cost),
+							  normal(Eigen::Vector3d::UnitZ()) {}
+	FootholdCandidate(const Eigen::Vector3d& _position,
+					  double _cost,
+					  const Eigen::Vector3d& _normal) : position(_position), cost(_cost),
+							  normal(_normal) {}
+
+	Eigen::Vector3d position;
+	double cost;
+	Eigen::Vector3d normal;
+};
+
+/**
+ * @brief Struct that defines the terrain sample of a foothold cell, i.e. its height, cost and
+ * normal, and the terrain revision of its validation
+ */
+struct FootholdSample
+{
+	FootholdSample() : height(0.), cost(0.), normal(Eigen::Vector3d::UnitZ()),
+			revision(0), is_known(false) {}
+
+	double height;
+	Weight cost;
+	Eigen::Vector3d normal;
+	unsigned long revision;
+	bool is_known;
+};
+
+/** @brief Defines the foothold candidates of every leg */
+typedef std::map<unsigned int, std::vector<FootholdCandidate> > FootholdCandidateMap;
+
 /**
  * @class ContactPlanning
  * @brief Abstract class for computing contact sequence.
@@ -48,6 +89,37 @@ class ContactPlanning
 		virtual bool computeContactSequence(std::vector<Contact>& contact_sequence,
 											const std::vector<Pose>& pose_trajectory) = 0;
 
+		/**
+		 * @brief Scores the foothold candidates of every leg, i.e. the terrain cells of its
+		 * footstep search area, against the terrain costs. The candidates are prefiltered
+		 * by the kinematic reachability, i.e. they have to be inside the predefined workspace of
+		 * the leg, where the whole set of candidates is transformed to the body frame and
+		 * checked at once. The terrain samples of the cells are cached between calls (see
+		 * setFootholdCacheSize), and the terrain lookups of the missed cells are distributed in
+		 * contiguous chunks across the threads
+		 * @param FootholdCandidateMap& Reachable candidates of every leg, sorted by cost
+		 * @param const Pose& Pose of the body
+		 * @param const Eigen::Vector3d& Action of the body (x,y,yaw)
+		 * @param unsigned int Number of threads (0 uses the hardware concurrency)
+		 */
+		void scoreFootholdCandidates(FootholdCandidateMap& candidates,
+									 const Pose& body_pose,
+									 const Eigen::Vector3d& action,
+									 unsigned int num_threads = 1);
+
+		/**
+		 * @brief Sets the maximum number of cells of the foothold cache, which is cleared when
+		 * it's full. The cells are hashed by their terrain vertex, and their samples are
+		 * validated with the terrain changes (see environment::TerrainMap::isChangedRegion).
+		 * Note that the kinematic reachability depends on the body pose, so it isn't cached.
+		 * A zero size disables the cache
+		 * @param unsigned int Maximum number of cells
+		 */
+		void setFootholdCacheSize(unsigned int max_cells);
+
+		/** @brief Gets the number of cells of the last scoring that were in the cache */
+		unsigned int getNumberOfFootholdCacheHits() const;
+
 		/**
 		 * @brief Sets the allowed computation time for the contact planner
 		 * @param double Allowed computation time
@@ -60,6 +132,23 @@ class ContactPlanning
 		 */
 		void setContactHorizon(int horizon);
 
+		/**
+		 * @brief Sets the cost-to-go field of the body path planner, e.g. the backward heuristic
+		 * of the path solver (see MotionPlanning::getCostToGoField). It's the terminal cost of
+		 * the last foothold of the contact horizon, so the footholds lead to the cheaper body
+		 * paths beyond the horizon. Note that the field isn't copied
+		 * @param std::shared_ptr<const environment::CostToGoField> Cost-to-go field (NULL
+		 * removes it)
+		 */
+		void setCostToGoField(std::shared_ptr<const environment::CostToGoField> cost_to_go);
+
+		/**
+		 * @brief Sets the weight of the terminal cost-to-go, where the zero weight (default)
+		 * disables it
+		 * @param double Weight of the cost-to-go
+		 */
+		void setCostToGoWeight(double weight);
+
 		/**
 		 * @brief Gets the contact search regions
 		 * @return std::vector<ContactSearchRegion> Contact search regions
@@ -91,6 +180,32 @@ class ContactPlanning
 
 		/** @brief Contact search regions */
 		std::vector<ContactSearchRegion> contact_search_regions_;
+
+		/** @brief Cost-to-go field of the body path planner, and its weight */
+		std::shared_ptr<const environment::CostToGoField> cost_to_go_;
+		double cost_to_go_weight_;
+
+
+	private:
+		/**
+		 * @brief Finds the valid terrain sample of a cell in the foothold cache
+		 * @param FootholdSample& Terrain sample
+		 * @param Vertex Terrain vertex of the cell
+		 * @param unsigned long Current terrain revision
+		 * @return True if the cell is in the cache, and its terrain didn't change
+		 */
+		bool findFootholdSample(FootholdSample& sample,
+								Vertex vertex,
+								unsigned long revision);
+
+		/** @brief Cache of the terrain samples of the foothold cells */
+		VertexTable<FootholdSample> foothold_cache_;
+
+		/** @brief Maximum number of cells of the foothold cache */
+		unsigned int foothold_cache_size_;
+
+		/** @brief Number of cache hits of the last scoring */
+		unsigned int num_cache_hits_;
 };
 
 } //@namespace locomotion
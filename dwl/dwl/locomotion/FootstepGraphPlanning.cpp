@@ -0,0 +1,387 @@
+#include <dwl/locomotion/FootstepGraphPlanning.h>
+#include <dwl/utils/Orientation.h>
+#include <algorithm>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+FootstepGraph::FootstepGraph(const FootstepGraphPlanning* planner) : planner_(planner)
+{
+	name_ = "Footstep graph";
+	is_lazy_ = true;
+}
+
+
+FootstepGraph::~FootstepGraph()
+{
+
+}
+
+
+void FootstepGraph::getSuccessors(EdgeList& successors,
+								  Vertex state_vertex)
+{
+	unsigned int stage, candidate;
+	if (!planner_->decodeVertex(stage, candidate, state_vertex))
+		return;
+
+	// The candidates of the last stage are connected to the terminal vertex
+	if (stage + 1 == planner_->stages_.size()) {
+		successors.push_back(Edge(planner_->terminal_vertex_,
+								  planner_->terminal_costs_[candidate]));
+		return;
+	}
+
+	const FootstepGraphPlanning::FootstepStage& next_stage = planner_->stages_[stage + 1];
+	for (unsigned int i = 0; i < next_stage.candidates.size(); i++)
+		successors.push_back(Edge(next_stage.first_vertex + i,
+								  planner_->computeEdgeWeight(stage, candidate, i)));
+}
+
+
+double FootstepGraph::heuristicCost(Vertex source,
+									Vertex target)
+{
+	unsigned int stage, candidate;
+	if (!planner_->decodeVertex(stage, candidate, source))
+		return 0.;
+
+	return planner_->min_cost_to_go_[stage];
+}
+
+
+FootstepGraphPlanning::FootstepGraphPlanning() : solver_(NULL),
+		planned_cost_to_go_weight_(0.), terminal_vertex_(0), num_dense_vertices_(0),
+		swing_foot_(0), max_candidates_(16), displacement_weight_(1.), num_reused_stages_(0),
+		is_reused_plan_(false)
+{
+	name_ = "Footstep graph";
+}
+
+
+FootstepGraphPlanning::~FootstepGraphPlanning()
+{
+	delete solver_;
+}
+
+
+void FootstepGraphPlanning::reset(solver::SearchTreeSolver* solver)
+{
+	printf(BLUE "Setting the %s solver in the %s contact planner\n" COLOR_RESET,
+			solver->getName().c_str(), name_.c_str());
+	solver_ = solver;
+	solver_->setAdjacencyModel(new FootstepGraph(this));
+	solver_->init();
+	num_dense_vertices_ = 0;
+	stages_.clear();
+}
+
+
+bool FootstepGraphPlanning::computeContactSequence(std::vector<Contact>& contact_sequence,
+												   const std::vector<Pose>& pose_trajectory)
+{
+	contact_sequence.clear();
+	num_reused_stages_ = 0;
+	is_reused_plan_ = false;
+	if (solver_ == NULL) {
+		printf(RED "FATAL: the %s contact planner doesn't have a search-tree solver\n"
+				COLOR_RESET, name_.c_str());
+		return false;
+	} else if (robot_ == NULL || terrain_ == NULL) {
+		printf(RED "FATAL: the robot and terrain information weren't reset\n" COLOR_RESET);
+		return false;
+	}
+	if (pose_trajectory.size() < 2)
+		return false;
+
+	// Getting the number of stages given the contact horizon
+	unsigned int num_steps = pose_trajectory.size() - 1;
+	if (contact_horizon_ > 0)
+		num_steps = std::min(num_steps, (unsigned int) contact_horizon_);
+
+	// The first stage is the current foothold, i.e. the contact of the previous foot of the
+	// pattern, or its nominal foothold if the contact isn't defined
+	PatternOfLocomotionMap pattern = robot_->getPatternOfLocomotion();
+	FootstepStage current_stage;
+	current_stage.pose = pose_trajectory[0];
+	current_stage.action.setZero();
+	current_stage.foot = swing_foot_;
+	for (PatternOfLocomotionMap::iterator pattern_it = pattern.begin();
+			pattern_it != pattern.end(); pattern_it++) {
+		if (pattern_it->second == swing_foot_)
+			current_stage.foot = pattern_it->first;
+	}
+	Vector3dMap stance = robot_->getStance(current_stage.action);
+	current_stage.nominal_foothold = current_stage.pose.position +
+			math::getRotationMatrix(current_stage.pose.orientation) * stance[current_stage.foot];
+	FootholdCandidate current_foothold(current_stage.nominal_foothold, 0.);
+	std::vector<Contact> current_contacts = robot_->getCurrentContacts();
+	for (unsigned int i = 0; i < current_contacts.size(); i++) {
+		if (current_contacts[i].end_effector == (int) current_stage.foot)
+			current_foothold.position = current_contacts[i].position;
+	}
+	current_stage.candidates.push_back(current_foothold);
+	current_stage.chosen = 0;
+	std::vector<FootstepStage> stages(1, current_stage);
+
+	// Building the stages, where the old stages with the same body motion and terrain are
+	// reused. The candidates of the new stages are scored
+	std::vector<int> old_index(1, -1);
+	unsigned int old_cursor = 1;
+	for (unsigned int k = 1; k <= num_steps; k++) {
+		FootstepStage stage;
+		const Pose& last_pose = pose_trajectory[k-1];
+		stage.pose = pose_trajectory[k];
+		Eigen::Vector3d displacement =
+				math::getRotationMatrix(last_pose.orientation).transpose() *
+				(stage.pose.position - last_pose.position);
+		stage.action << displacement(rbd::X), displacement(rbd::Y),
+				math::getRPY(stage.pose.orientation)(2) - math::getRPY(last_pose.orientation)(2);
+		if (k == 1)
+			stage.foot = swing_foot_;
+		else {
+			PatternOfLocomotionMap::iterator pattern_it = pattern.find(stages.back().foot);
+			if (pattern_it == pattern.end())
+				break;
+			stage.foot = pattern_it->second;
+		}
+
+		int index = -1;
+		for (unsigned int j = old_cursor; j < stages_.size(); j++) {
+			if (isReusableStage(stages_[j], stage)) {
+				index = j;
+				old_cursor = j + 1;
+				break;
+			}
+		}
+
+		if (index >= 0) {
+			stage = stages_[index];
+			num_reused_stages_++;
+		} else {
+			stance = robot_->getStance(stage.action);
+			stage.nominal_foothold = stage.pose.position +
+					math::getRotationMatrix(stage.pose.orientation) * stance[stage.foot];
+			scoreStage(stage);
+		}
+
+		// The horizon finishes before the stages without reachable candidates
+		if (stage.candidates.empty()) {
+			printf(YELLOW "Warning: the footstep %i doesn't have reachable candidates, so the"
+					" contact horizon finishes before it\n" COLOR_RESET, k);
+			break;
+		}
+		stages.push_back(stage);
+		old_index.push_back(index);
+	}
+	num_steps = stages.size() - 1;
+	if (num_steps == 0)
+		return false;
+
+	// Reusing the previous plan if the current foothold is one of its footholds, and the
+	// remaining stages are the same, i.e. the suffix of the previous optimal plan is still
+	// optimal
+	int offset = old_index[1] - 1;
+	bool reuse_plan = offset >= 0 && offset + num_steps + 1 == stages_.size();
+	for (unsigned int k = 1; reuse_plan && k <= num_steps; k++)
+		reuse_plan = old_index[k] == offset + (int) k && stages[k].chosen >= 0;
+	reuse_plan = reuse_plan && planned_cost_to_go_ == cost_to_go_ &&
+			planned_cost_to_go_weight_ == cost_to_go_weight_;
+	if (reuse_plan) {
+		const FootstepStage& old_stage = stages_[offset];
+		reuse_plan = old_stage.foot == current_stage.foot && old_stage.chosen >= 0 &&
+				(old_stage.candidates[old_stage.chosen].position -
+						current_foothold.position).norm() < 1e-3;
+	}
+	stages_.swap(stages);
+
+	if (reuse_plan)
+		is_reused_plan_ = true;
+	else {
+		// Numbering the vertices of the candidates, and computing the lowest cost to the
+		// terminal vertex
+		Vertex num_vertices = 0;
+		for (unsigned int k = 0; k <= num_steps; k++) {
+			stages_[k].first_vertex = num_vertices;
+			stages_[k].chosen = -1;
+			num_vertices += stages_[k].candidates.size();
+		}
+		terminal_vertex_ = num_vertices;
+
+		// Computing the terminal cost-to-go of the last candidates, where the candidates
+		// outside the field don't have terminal cost
+		const FootstepStage& last_stage = stages_[num_steps];
+		terminal_costs_.assign(last_stage.candidates.size(), 0.);
+		if (cost_to_go_ && cost_to_go_weight_ > 0.) {
+			for (unsigned int i = 0; i < last_stage.candidates.size(); i++) {
+				double cost_to_go;
+				Eigen::Vector2d position = last_stage.candidates[i].position.head<2>();
+				if (cost_to_go_->getCost(cost_to_go, position))
+					terminal_costs_[i] = cost_to_go_weight_ * cost_to_go;
+			}
+		}
+		planned_cost_to_go_ = cost_to_go_;
+		planned_cost_to_go_weight_ = cost_to_go_weight_;
+
+		min_cost_to_go_.assign(num_steps + 1, 0.);
+		min_cost_to_go_[num_steps] =
+				*std::min_element(terminal_costs_.begin(), terminal_costs_.end());
+		for (int k = num_steps - 1; k >= 0; k--)
+			min_cost_to_go_[k] = min_cost_to_go_[k+1] + stages_[k+1].candidates.front().cost;
+
+		// Searching the footstep graph, where the vertex tables are dense
+		if (terminal_vertex_ + 1 > num_dense_vertices_) {
+			num_dense_vertices_ = terminal_vertex_ + 1;
+			solver_->setIndexedHeap(true, num_dense_vertices_);
+		}
+		solver_->compute(0, terminal_vertex_, computation_time_);
+		if (solver_->getMinimumCost() >= std::numeric_limits<Weight>::max()) {
+			printf(YELLOW "Warning: the %s contact planner couldn't find a contact sequence\n"
+					COLOR_RESET, name_.c_str());
+			return false;
+		}
+
+		std::vector<Vertex> path;
+		solver_->getShortestPath(path, 0, terminal_vertex_);
+		for (unsigned int i = 0; i < path.size(); i++) {
+			unsigned int stage, candidate;
+			if (decodeVertex(stage, candidate, path[i]))
+				stages_[stage].chosen = candidate;
+		}
+	}
+
+	// Getting the contact sequence
+	for (unsigned int k = 1; k <= num_steps; k++) {
+		const FootstepStage& stage = stages_[k];
+		if (stage.chosen < 0)
+			break;
+
+		Contact contact;
+		contact.end_effector = stage.foot;
+		contact.position = stage.candidates[stage.chosen].position;
+		contact_sequence.push_back(contact);
+	}
+
+	return !contact_sequence.empty();
+}
+
+
+void FootstepGraphPlanning::setSwingFoot(unsigned int foot)
+{
+	swing_foot_ = foot;
+}
+
+
+void FootstepGraphPlanning::setMaximumCandidates(unsigned int num_candidates)
+{
+	max_candidates_ = std::max(num_candidates, 1u);
+	stages_.clear();
+}
+
+
+void FootstepGraphPlanning::setDisplacementWeight(double weight)
+{
+	displacement_weight_ = weight;
+	stages_.clear();
+}
+
+
+unsigned int FootstepGraphPlanning::getNumberOfReusedStages() const
+{
+	return num_reused_stages_;
+}
+
+
+bool FootstepGraphPlanning::isReusedPlan() const
+{
+	return is_reused_plan_;
+}
+
+
+void FootstepGraphPlanning::scoreStage(FootstepStage& stage)
+{
+	// Getting the best candidates of the swing foot
+	FootholdCandidateMap candidates;
+	scoreFootholdCandidates(candidates, stage.pose, stage.action);
+	stage.candidates = candidates[stage.foot];
+	if (stage.candidates.size() > max_candidates_)
+		stage.candidates.resize(max_candidates_);
+
+	// Recording the terrain region of the footstep search area, i.e. the bounding box of its
+	// rotated corners. Note that a foot without search area only has the body cell
+	double yaw = math::getRPY(stage.pose.orientation)(2);
+	const SearchAreaCells& search_cells = robot_->getFootstepSearchCells(stage.action, yaw);
+	std::vector<unsigned int>::const_iterator id_it =
+			std::find(search_cells.ids.begin(), search_cells.ids.end(), stage.foot);
+	Eigen::Matrix2Xd corners = Eigen::Matrix2Xd::Zero(2, 4);
+	if (id_it != search_cells.ids.end())
+		corners = search_cells.corners.middleCols(4 * (id_it - search_cells.ids.begin()), 4);
+	const environment::SpaceDiscretization& space_model = terrain_->getTerrainSpaceModel();
+	stage.region = CellRegion();
+	for (unsigned int i = 0; i < 4; i++) {
+		Eigen::Vector2d position = stage.pose.position.head<2>() + corners.col(i);
+		Key key;
+		space_model.coordToKey(key.x, position(rbd::X), true);
+		space_model.coordToKey(key.y, position(rbd::Y), true);
+		stage.region.add(key);
+	}
+	stage.revision = terrain_->getRevision();
+	stage.chosen = -1;
+}
+
+
+bool FootstepGraphPlanning::isReusableStage(const FootstepStage& old_stage,
+											const FootstepStage& new_stage) const
+{
+	double tolerance = 1e-6;
+	return old_stage.foot == new_stage.foot &&
+			(old_stage.pose.position - new_stage.pose.position).norm() < tolerance &&
+			(old_stage.pose.orientation.coeffs() -
+					new_stage.pose.orientation.coeffs()).norm() < tolerance &&
+			(old_stage.action - new_stage.action).norm() < tolerance &&
+			!terrain_->isChangedRegion(old_stage.region, old_stage.revision);
+}
+
+
+bool FootstepGraphPlanning::decodeVertex(unsigned int& stage,
+										 unsigned int& candidate,
+										 Vertex vertex) const
+{
+	if (vertex >= terminal_vertex_ || stages_.empty())
+		return false;
+
+	// Finding the last stage whose first vertex isn't bigger than the vertex
+	std::vector<FootstepStage>::const_iterator stage_it =
+			std::upper_bound(stages_.begin(), stages_.end(), vertex,
+							 [](Vertex v, const FootstepStage& s) {
+								 return v < s.first_vertex;
+							 });
+	stage = (stage_it - stages_.begin()) - 1;
+	candidate = vertex - stages_[stage].first_vertex;
+	return true;
+}
+
+
+Weight FootstepGraphPlanning::computeEdgeWeight(unsigned int stage,
+												unsigned int candidate,
+												unsigned int next_candidate) const
+{
+	// Terrain cost of the new foothold plus the deviation of the displacement between the
+	// footholds from the nominal displacement
+	const FootstepStage& current_stage = stages_[stage];
+	const FootstepStage& next_stage = stages_[stage + 1];
+	const FootholdCandidate& next_foothold = next_stage.candidates[next_candidate];
+	Eigen::Vector3d displacement =
+			next_foothold.position - current_stage.candidates[candidate].position;
+	Eigen::Vector3d nominal_displacement =
+			next_stage.nominal_foothold - current_stage.nominal_foothold;
+
+	return next_foothold.cost + displacement_weight_ * (displacement - nominal_displacement).norm();
+}
+
+} //@namespace locomotion
+} //@namespace dwl
@@ -0,0 +1,226 @@
+#ifndef DWL__LOCOMOTION__FOOTSTEP_GRAPH_PLANNING__H
+#define DWL__LOCOMOTION__FOOTSTEP_GRAPH_PLANNING__H
+
+#include <dwl/locomotion/ContactPlanning.h>
+#include <dwl/solver/SearchTreeSolver.h>
+#include <dwl/model/AdjacencyModel.h>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+class FootstepGraphPlanning;
+
+/**
+ * @class FootstepGraph
+ * @brief Adjacency model of the footstep graph of a FootstepGraphPlanning, i.e. its vertices
+ * are the foothold candidates of the footstep stages, and the edges connect the candidates of
+ * consecutive stages. The last stage is connected to a terminal vertex, whose weight is the
+ * terminal cost-to-go of the candidate (zero without a cost-to-go field)
+ */
+class FootstepGraph : public model::AdjacencyModel
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param const FootstepGraphPlanning* Planner that defines the footstep stages
+		 */
+		FootstepGraph(const FootstepGraphPlanning* planner);
+
+		/** @brief Destructor function */
+		~FootstepGraph();
+
+		/**
+		 * @brief Gets the candidates of the next stage of a vertex
+		 * @param EdgeList& The successors of a certain vertex
+		 * @param Vertex Current vertex
+		 */
+		void getSuccessors(EdgeList& successors,
+						   Vertex state_vertex);
+
+		/**
+		 * @brief Estimates the cost to the terminal vertex, i.e. the sum of the lowest
+		 * candidate costs of the remaining stages and the lowest terminal cost-to-go, which is
+		 * a consistent heuristic
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 */
+		double heuristicCost(Vertex source,
+							 Vertex target);
+
+
+	private:
+		/** @brief Planner that defines the footstep stages */
+		const FootstepGraphPlanning* planner_;
+};
+
+
+/**
+ * @class FootstepGraphPlanning
+ * @brief Contact planner that searches the footstep graph of a body path with a search-tree
+ * solver, instead of choosing the best candidate per step. Every pose of the body path is a
+ * footstep stage that moves the next foot of the pattern of locomotion, and its candidates are
+ * the best scored footholds of its footstep search area (see scoreFootholdCandidates). The
+ * weight of an edge is the terrain cost of the new foothold plus the deviation of the
+ * displacement between the consecutive footholds from the nominal one (e.g. the height jumps
+ * on stairs). The depth of the search is the contact horizon (zero uses the whole body path).
+ * The stages are kept between plans, so a replan reuses the scored stages that didn't move
+ * and whose search area didn't change in the terrain map. It also reuses the previous plan,
+ * without searching, if the current foothold is on it and the remaining stages and the
+ * cost-to-go field are the same. The cost-to-go field of the body planner (see
+ * setCostToGoField) is the terminal cost of the last stage, which matters when the contact
+ * horizon is shorter than the body path
+ */
+class FootstepGraphPlanning : public ContactPlanning
+{
+	friend class FootstepGraph;
+
+	public:
+		/** @brief Constructor function */
+		FootstepGraphPlanning();
+
+		/** @brief Destructor function */
+		~FootstepGraphPlanning();
+
+		using ContactPlanning::reset;
+
+		/**
+		 * @brief Sets the search-tree solver of the footstep graph, which owns the graph
+		 * @param solver::SearchTreeSolver* Search-tree solver
+		 */
+		void reset(solver::SearchTreeSolver* solver);
+
+		/**
+		 * @brief Computes the contact sequence of a body path
+		 * @param std::vector<Contact>& contact_sequence Set of contacts
+		 * @param const std::vector<Pose>& pose_trajectory Body path, where the first pose is
+		 * the current one
+		 * @return True if it was found a contact sequence
+		 */
+		bool computeContactSequence(std::vector<Contact>& contact_sequence,
+									const std::vector<Pose>& pose_trajectory);
+
+		/**
+		 * @brief Sets the next swing foot, i.e. the foot of the first stage. The current
+		 * foothold is the contact of the previous foot in the pattern of locomotion
+		 * @param unsigned int Foot id
+		 */
+		void setSwingFoot(unsigned int foot);
+
+		/**
+		 * @brief Sets the maximum number of candidates per stage, i.e. the branching factor
+		 * @param unsigned int Number of candidates
+		 */
+		void setMaximumCandidates(unsigned int num_candidates);
+
+		/**
+		 * @brief Sets the weight of the deviation from the nominal displacement between the
+		 * consecutive footholds
+		 * @param double Weight of the displacement
+		 */
+		void setDisplacementWeight(double weight);
+
+		/** @brief Gets the number of stages reused in the last plan */
+		unsigned int getNumberOfReusedStages() const;
+
+		/** @brief Indicates if the last plan reused the previous one without searching */
+		bool isReusedPlan() const;
+
+
+	private:
+		/** @brief Footstep stage, i.e. a body pose and the candidates of its swing foot */
+		struct FootstepStage
+		{
+			FootstepStage() : foot(0), revision(0), first_vertex(0), chosen(-1) {}
+
+			Pose pose;
+			Eigen::Vector3d action;
+			unsigned int foot;
+			Eigen::Vector3d nominal_foothold;
+			std::vector<FootholdCandidate> candidates;
+			CellRegion region;
+			unsigned long revision;
+			Vertex first_vertex;
+			int chosen;
+		};
+
+		/**
+		 * @brief Scores the candidates of a stage, and records its terrain region
+		 * @param FootstepStage& Footstep stage
+		 */
+		void scoreStage(FootstepStage& stage);
+
+		/**
+		 * @brief Indicates if an old stage can be reused for a new one, i.e. they have the same
+		 * swing foot and body motion, and the terrain of its search area didn't change
+		 * @param const FootstepStage& Old stage
+		 * @param const FootstepStage& New stage
+		 */
+		bool isReusableStage(const FootstepStage& old_stage,
+							 const FootstepStage& new_stage) const;
+
+		/**
+		 * @brief Gets the stage and candidate of a vertex
+		 * @param unsigned int& Stage index
+		 * @param unsigned int& Candidate index
+		 * @param Vertex Vertex
+		 * @return False if it's the terminal vertex
+		 */
+		bool decodeVertex(unsigned int& stage,
+						  unsigned int& candidate,
+						  Vertex vertex) const;
+
+		/**
+		 * @brief Computes the weight of the edge to a candidate of the next stage
+		 * @param unsigned int Stage index
+		 * @param unsigned int Candidate index in the stage
+		 * @param unsigned int Candidate index in the next stage
+		 */
+		Weight computeEdgeWeight(unsigned int stage,
+								 unsigned int candidate,
+								 unsigned int next_candidate) const;
+
+		/** @brief Search-tree solver of the footstep graph */
+		solver::SearchTreeSolver* solver_;
+
+		/** @brief Footstep stages of the last plan, where the first one is the current
+		 * foothold */
+		std::vector<FootstepStage> stages_;
+
+		/** @brief Lowest cost from every stage to the terminal vertex (heuristic) */
+		std::vector<double> min_cost_to_go_;
+
+		/** @brief Terminal cost-to-go of the candidates of the last stage */
+		std::vector<Weight> terminal_costs_;
+
+		/** @brief Cost-to-go field and weight of the last plan */
+		std::shared_ptr<const environment::CostToGoField> planned_cost_to_go_;
+		double planned_cost_to_go_weight_;
+
+		/** @brief Terminal vertex of the footstep graph */
+		Vertex terminal_vertex_;
+
+		/** @brief Number of dense vertices of the solver */
+		Vertex num_dense_vertices_;
+
+		/** @brief Next swing foot */
+		unsigned int swing_foot_;
+
+		/** @brief Maximum number of candidates per stage */
+		unsigned int max_candidates_;
+
+		/** @brief Weight of the displacement deviation */
+		double displacement_weight_;
+
+		/** @brief Statistics of the last plan */
+		unsigned int num_reused_stages_;
+		bool is_reused_plan_;
+};
+
+} //@namespace locomotion
+} //@namespace dwl
+
+#endif
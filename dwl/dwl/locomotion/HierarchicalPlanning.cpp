@@ -1,5 +1,7 @@
 #include <dwl/locomotion/HierarchicalPlanning.h>
 #include <dwl/utils/Orientation.h>
+#include <dwl/utils/Instrumentation.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -8,7 +10,11 @@ namespace dwl
 namespace locomotion
 {
 
-HierarchicalPlanning::HierarchicalPlanning()
+HierarchicalPlanning::HierarchicalPlanning() : path_version_(0), path_done_(true),
+		plan_version_(0), anytime_running_(false), segment_motions_(4),
+		segment_queue_capacity_(2), num_streamed_segments_(0), is_streaming_failed_(false),
+		latest_request_(0), num_pending_(0), snapshot_recorder_(NULL), snapshot_session_(0),
+		snapshot_revision_(0)
 {
 	name_ = "Hierarchical";
 }
@@ -16,7 +22,9 @@ HierarchicalPlanning::HierarchicalPlanning()
 
 HierarchicalPlanning::~HierarchicalPlanning()
 {
-
+	cancel();
+	waitAsync();
+	waitAnytime();
 }
 
 
@@ -32,10 +40,18 @@ bool HierarchicalPlanning::init()
 
 bool HierarchicalPlanning::compute(Pose current_pose)
 {
+	if (anytime_running_) {
+		printf(YELLOW "Could not compute the plan because there is an anytime computation"
+				" running\n" COLOR_RESET);
+		return false;
+	}
+
 	// Setting the pose in the robot properties
 	robot_->setCurrentPose(current_pose);
 
 	if (terrain_->isTerrainInformation()) {
+		recordSnapshot(BlockingMode, current_pose);
+
 		// Cleaning global variables
 		std::vector<Pose> empty_body_trajectory;
 		body_path_.swap(empty_body_trajectory);
@@ -48,6 +64,9 @@ bool HierarchicalPlanning::compute(Pose current_pose)
 			return false;
 		}
 
+		// Sharing the cost-to-go of the body path planner, which is computed once per goal,
+		// as the terminal cost of the contact planner
+		contact_planner_->setCostToGoField(motion_planner_->getCostToGoField());
 		if (!contact_planner_->computeContactSequence(contacts_sequence_, body_path_)) {
 			printf(YELLOW "Could not computed the foothold sequence \n" COLOR_RESET);
 			return false;
@@ -58,5 +77,511 @@ bool HierarchicalPlanning::compute(Pose current_pose)
 	return true;
 }
 
+
+bool HierarchicalPlanning::computeAnytime(Pose current_pose)
+{
+	if (!terrain_->isTerrainInformation())
+		return false;
+
+	if (anytime_running_) {
+		printf(YELLOW "Could not start the anytime computation because there is one running\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	// Joining the threads of the last computation
+	waitAnytime();
+	recordSnapshot(AnytimeMode, current_pose);
+
+	// Setting the pose in the robot properties
+	robot_->setCurrentPose(current_pose);
+
+	// Starting the pipeline, where the path stage publishes every improved path
+	latest_path_.clear();
+	path_version_ = 0;
+	path_done_ = false;
+	anytime_running_ = true;
+	motion_planner_->setPathCallback([this](const std::vector<Pose>& path) {
+		std::lock_guard<std::mutex> lock(path_mutex_);
+		latest_path_ = path;
+		path_version_++;
+		path_condition_.notify_one();
+	});
+	contact_thread_ = std::thread(&HierarchicalPlanning::computeAnytimeContacts, this);
+	path_thread_ = std::thread(&HierarchicalPlanning::computeAnytimePath, this, current_pose);
+
+	return true;
+}
+
+
+std::shared_future<bool> HierarchicalPlanning::computeAsync(Pose current_pose,
+															utils::WorkerPool* pool)
+{
+	if (pool == NULL)
+		pool = &utils::WorkerPool::getDefault();
+
+	// Queuing the request, which supersedes the older ones
+	uint64_t request = ++latest_request_;
+	std::shared_ptr<std::promise<bool> > promise = std::make_shared<std::promise<bool> >();
+	std::shared_future<bool> result = promise->get_future().share();
+	{
+		std::lock_guard<std::mutex> lock(request_mutex_);
+		num_pending_++;
+	}
+	pool->submit([this, promise, request, current_pose] {
+		promise->set_value(computeRequest(request, current_pose));
+
+		std::lock_guard<std::mutex> lock(request_mutex_);
+		num_pending_--;
+		request_condition_.notify_all();
+	});
+
+	return result;
+}
+
+
+bool HierarchicalPlanning::computeStreaming(Pose current_pose)
+{
+	std::lock_guard<std::mutex> compute_lock(compute_mutex_);
+	if (anytime_running_) {
+		printf(YELLOW "Could not compute the plan because there is an anytime computation"
+				" running\n" COLOR_RESET);
+		return false;
+	}
+
+	if (!terrain_->isTerrainInformation())
+		return false;
+
+	recordSnapshot(StreamingMode, current_pose);
+
+	// Setting the pose in the robot properties
+	robot_->setCurrentPose(current_pose);
+
+	// Computing the body path using a search tree algorithm
+	std::vector<Pose> path;
+	if (!motion_planner_->computePath(path, current_pose, goal_pose_)) {
+		printf(YELLOW "Could not found an approximated body path\n" COLOR_RESET);
+		return false;
+	}
+	if (path.empty())
+		return false;
+	contact_planner_->setCostToGoField(motion_planner_->getCostToGoField());
+
+	// Starting the contact and segment stages
+	path_segments_.reset(segment_queue_capacity_);
+	plan_segments_.reset(segment_queue_capacity_);
+	streamed_contacts_.clear();
+	num_streamed_segments_ = 0;
+	is_streaming_failed_ = false;
+	std::thread contact_thread(&HierarchicalPlanning::computeStreamingContacts, this, &path);
+	std::thread segment_thread(&HierarchicalPlanning::runStreamingSegments, this);
+
+	// Splitting the body path in segments, where consecutive segments share their boundary
+	// pose. Note that the push waits while the contact stage is behind
+	PathSegment segment;
+	unsigned int last_pose = path.size() - 1;
+	do {
+		segment.first = segment.last;
+		segment.last = std::min(segment.first + segment_motions_, last_pose);
+		if (!path_segments_.push(segment))
+			break;
+	} while (segment.last < last_pose);
+	path_segments_.close();
+
+	contact_thread.join();
+	segment_thread.join();
+	if (is_streaming_failed_)
+		return false;
+
+	publishPlan(path, streamed_contacts_);
+
+	return true;
+}
+
+
+void HierarchicalPlanning::setStreamingSegments(unsigned int num_motions,
+												unsigned int queue_capacity)
+{
+	segment_motions_ = std::max(num_motions, 1u);
+	segment_queue_capacity_ = std::max(queue_capacity, 1u);
+}
+
+
+void HierarchicalPlanning::setSegmentCallback(const PlanCallback& callback)
+{
+	segment_callback_ = callback;
+}
+
+
+unsigned int HierarchicalPlanning::getNumberOfStreamedSegments() const
+{
+	return num_streamed_segments_;
+}
+
+
+void HierarchicalPlanning::cancel()
+{
+	++latest_request_;
+}
+
+
+void HierarchicalPlanning::waitAsync()
+{
+	std::unique_lock<std::mutex> lock(request_mutex_);
+	request_condition_.wait(lock, [this] { return num_pending_ == 0; });
+}
+
+
+void HierarchicalPlanning::setPlanCallback(const PlanCallback& callback)
+{
+	plan_callback_ = callback;
+}
+
+
+bool HierarchicalPlanning::getLatestPlan(std::vector<Pose>& body_path,
+										 std::vector<Contact>& contact_sequence,
+										 unsigned int& version)
+{
+	// Checking the version without locking, so the controller doesn't wait for the planners
+	if (plan_version_ == version)
+		return false;
+
+	std::lock_guard<std::mutex> lock(plan_mutex_);
+	body_path = body_path_;
+	contact_sequence = contacts_sequence_;
+	version = plan_version_;
+
+	return true;
+}
+
+
+unsigned int HierarchicalPlanning::getPlanVersion() const
+{
+	return plan_version_;
+}
+
+
+bool HierarchicalPlanning::isAnytimeRunning() const
+{
+	return anytime_running_;
+}
+
+
+void HierarchicalPlanning::waitAnytime()
+{
+	if (path_thread_.joinable())
+		path_thread_.join();
+	if (contact_thread_.joinable())
+		contact_thread_.join();
+}
+
+
+void HierarchicalPlanning::setSnapshotRecorder(SnapshotRecorder* recorder)
+{
+	std::lock_guard<std::mutex> lock(snapshot_mutex_);
+	snapshot_recorder_ = recorder;
+	snapshot_session_ = 0;
+}
+
+
+bool HierarchicalPlanning::replay(SnapshotDecoder& snapshot)
+{
+	Pose current_pose, goal_pose;
+	unsigned int mode = BlockingMode;
+	bool is_corrupted = false;
+	{
+		DWL_SCOPED_TIMER("HierarchicalPlanning::restoreSnapshot");
+		snapshot.readUnsigned(mode);
+		snapshot.readPose(current_pose);
+		snapshot.readPose(goal_pose);
+
+		// Reading the terrain map, which isn't recorded if it didn't change. Every cell has
+		// its key and 5 values
+		TerrainData terrain_map;
+		unsigned int num_cells = 0;
+		bool with_terrain = false;
+		snapshot.readBool(with_terrain);
+		if (with_terrain) {
+			snapshot.readDouble(terrain_map.plane_size);
+			snapshot.readDouble(terrain_map.height_size);
+			snapshot.readUnsigned(num_cells);
+			if (num_cells > snapshot.getRemainingBytes() / (3 * sizeof(uint32_t) +
+					5 * sizeof(double)))
+				is_corrupted = true;
+			else
+				terrain_map.data.resize(num_cells);
+			for (unsigned int i = 0; i < terrain_map.data.size(); i++) {
+				TerrainCell& cell = terrain_map.data[i];
+				unsigned int x = 0, y = 0, z = 0;
+				snapshot.readUnsigned(x);
+				snapshot.readUnsigned(y);
+				snapshot.readUnsigned(z);
+				cell.key = Key(x, y, z);
+				snapshot.readDouble(cell.cost);
+				snapshot.readDouble(cell.height);
+				snapshot.readDouble(cell.normal(0));
+				snapshot.readDouble(cell.normal(1));
+				snapshot.readDouble(cell.normal(2));
+			}
+		}
+
+		// Reading the obstacle map, where every obstacle has its plane key
+		std::vector<Cell> obstacle_map;
+		double obstacle_resolution = 0.;
+		unsigned int num_obstacles = 0;
+		snapshot.readDouble(obstacle_resolution);
+		snapshot.readUnsigned(num_obstacles);
+		if (num_obstacles > snapshot.getRemainingBytes() / (2 * sizeof(uint32_t)))
+			is_corrupted = true;
+		else
+			obstacle_map.resize(num_obstacles);
+		for (unsigned int i = 0; i < obstacle_map.size(); i++) {
+			unsigned int x = 0, y = 0;
+			snapshot.readUnsigned(x);
+			snapshot.readUnsigned(y);
+			obstacle_map[i] = Cell(Key(x, y, 0), obstacle_resolution, obstacle_resolution);
+		}
+
+		if (is_corrupted || !snapshot.isValid() || mode > StreamingMode) {
+			printf(YELLOW "Warning: the snapshot of the hierarchical planning is corrupted\n"
+					COLOR_RESET);
+			return false;
+		}
+
+		// Restoring the inputs, where an unchanged terrain map is kept from the previous
+		// records
+		if (with_terrain)
+			terrain_->setTerrainMap(terrain_map);
+		terrain_->setObstacleMap(obstacle_map);
+		resetGoal(goal_pose);
+	}
+
+	// Computing the plan in the recorded mode
+	switch (mode) {
+		case AnytimeMode:
+			if (!computeAnytime(current_pose))
+				return false;
+			waitAnytime();
+			return true;
+		case AsyncMode:
+			return computeAsync(current_pose).get();
+		case StreamingMode:
+			return computeStreaming(current_pose);
+		default:
+			return compute(current_pose);
+	}
+}
+
+
+void HierarchicalPlanning::recordSnapshot(ComputeMode mode,
+										  const Pose& current_pose)
+{
+	std::lock_guard<std::mutex> lock(snapshot_mutex_);
+	if (snapshot_recorder_ == NULL || !snapshot_recorder_->isRecording())
+		return;
+
+	DWL_SCOPED_TIMER("HierarchicalPlanning::recordSnapshot");
+	snapshot_.clear();
+	snapshot_.writeUnsigned(mode);
+	snapshot_.writePose(current_pose);
+	snapshot_.writePose(goal_pose_);
+
+	// Writing the terrain map if it changed since the last record of the file
+	unsigned int session = snapshot_recorder_->getSession();
+	unsigned long revision = terrain_->getRevision();
+	bool with_terrain = session != snapshot_session_ || revision != snapshot_revision_;
+	snapshot_.writeBool(with_terrain);
+	if (with_terrain) {
+		const TerrainDataMap& terrain_map = terrain_->getTerrainDataMap();
+		snapshot_.writeDouble(terrain_->getResolution(true));
+		snapshot_.writeDouble(terrain_->getResolution(false));
+		snapshot_.writeUnsigned(terrain_map.size());
+		for (TerrainDataMap::const_iterator it = terrain_map.begin();
+				it != terrain_map.end(); ++it) {
+			const TerrainCell& cell = it->second;
+			snapshot_.writeUnsigned(cell.key.x);
+			snapshot_.writeUnsigned(cell.key.y);
+			snapshot_.writeUnsigned(cell.key.z);
+			snapshot_.writeDouble(cell.cost);
+			snapshot_.writeDouble(cell.height);
+			snapshot_.writeDouble(cell.normal(0));
+			snapshot_.writeDouble(cell.normal(1));
+			snapshot_.writeDouble(cell.normal(2));
+		}
+	}
+
+	// Writing the obstacle map, whose changes aren't tracked by the terrain revision
+	const ObstacleMap& obstacle_map = terrain_->getObstacleMap();
+	snapshot_.writeDouble(terrain_->getObstacleResolution());
+	snapshot_.writeUnsigned(obstacle_map.size());
+	Key key;
+	for (ObstacleMap::const_iterator it = obstacle_map.begin(); it != obstacle_map.end(); ++it) {
+		terrain_->getObstacleSpaceModel().vertexToKey(key, it->first, true);
+		snapshot_.writeUnsigned(key.x);
+		snapshot_.writeUnsigned(key.y);
+	}
+
+	if (snapshot_recorder_->record(solve_snapshot::HierarchicalPlanningKind, snapshot_) &&
+			with_terrain) {
+		snapshot_session_ = session;
+		snapshot_revision_ = revision;
+	}
+}
+
+
+bool HierarchicalPlanning::computeRequest(uint64_t request,
+										  Pose current_pose)
+{
+	std::lock_guard<std::mutex> compute_lock(compute_mutex_);
+	if (request != latest_request_)
+		return false;
+
+	if (anytime_running_) {
+		printf(YELLOW "Could not compute the plan because there is an anytime computation"
+				" running\n" COLOR_RESET);
+		return false;
+	}
+
+	if (!terrain_->isTerrainInformation())
+		return false;
+
+	recordSnapshot(AsyncMode, current_pose);
+
+	// Setting the pose in the robot properties
+	robot_->setCurrentPose(current_pose);
+
+	// Computing the body path, and then the contacts if the request wasn't superseded
+	std::vector<Pose> path;
+	if (!motion_planner_->computePath(path, current_pose, goal_pose_)) {
+		printf(YELLOW "Could not found an approximated body path\n" COLOR_RESET);
+		return false;
+	}
+	if (request != latest_request_)
+		return false;
+
+	std::vector<Contact> contacts;
+	contact_planner_->setCostToGoField(motion_planner_->getCostToGoField());
+	if (!contact_planner_->computeContactSequence(contacts, path)) {
+		printf(YELLOW "Could not computed the foothold sequence \n" COLOR_RESET);
+		return false;
+	}
+	if (request != latest_request_)
+		return false;
+
+	publishPlan(path, contacts);
+
+	return true;
+}
+
+
+void HierarchicalPlanning::publishPlan(const std::vector<Pose>& body_path,
+									   const std::vector<Contact>& contact_sequence)
+{
+	{
+		std::lock_guard<std::mutex> lock(plan_mutex_);
+		body_path_ = body_path;
+		contacts_sequence_ = contact_sequence;
+		plan_version_++;
+	}
+	if (plan_callback_)
+		plan_callback_(body_path, contact_sequence);
+}
+
+
+void HierarchicalPlanning::computeStreamingContacts(const std::vector<Pose>* path)
+{
+	unsigned int num_committed = 0;
+	PathSegment segment;
+	while (path_segments_.pop(segment)) {
+		// Planning the contacts of the path prefix that ends with the segment
+		std::vector<Pose> prefix(path->begin(), path->begin() + segment.last + 1);
+		std::vector<Contact> contacts;
+		if (!contact_planner_->computeContactSequence(contacts, prefix)) {
+			printf(YELLOW "Could not computed the foothold sequence \n" COLOR_RESET);
+			is_streaming_failed_ = true;
+			path_segments_.close();
+			break;
+		}
+
+		// Passing the segment and its new contacts to the segment stage
+		PlanSegment plan_segment;
+		plan_segment.body_path.assign(path->begin() + segment.first,
+									  path->begin() + segment.last + 1);
+		if (contacts.size() > num_committed) {
+			plan_segment.contacts.assign(contacts.begin() + num_committed, contacts.end());
+			num_committed = contacts.size();
+		}
+		if (!plan_segments_.push(plan_segment))
+			break;
+	}
+	plan_segments_.close();
+}
+
+
+void HierarchicalPlanning::runStreamingSegments()
+{
+	PlanSegment segment;
+	while (plan_segments_.pop(segment)) {
+		streamed_contacts_.insert(streamed_contacts_.end(),
+								  segment.contacts.begin(), segment.contacts.end());
+		num_streamed_segments_++;
+		if (segment_callback_)
+			segment_callback_(segment.body_path, segment.contacts);
+	}
+}
+
+
+void HierarchicalPlanning::computeAnytimePath(Pose current_pose)
+{
+	std::vector<Pose> path;
+	bool found = motion_planner_->computePath(path, current_pose, goal_pose_);
+	motion_planner_->setPathCallback(MotionPlanning::PathCallback());
+	if (!found)
+		printf(YELLOW "Could not found an approximated body path\n" COLOR_RESET);
+
+	// Publishing the final path, and finishing the contact stage
+	std::lock_guard<std::mutex> lock(path_mutex_);
+	if (found) {
+		latest_path_ = path;
+		path_version_++;
+	}
+	path_done_ = true;
+	path_condition_.notify_one();
+}
+
+
+void HierarchicalPlanning::computeAnytimeContacts()
+{
+	unsigned int planned_version = 0;
+	while (true) {
+		// Waiting for a newer body path or the end of the path stage
+		std::vector<Pose> path;
+		{
+			std::unique_lock<std::mutex> lock(path_mutex_);
+			path_condition_.wait(lock, [&] {
+				return path_version_ != planned_version || path_done_;
+			});
+			if (path_version_ == planned_version)
+				break;
+
+			path = latest_path_;
+			planned_version = path_version_;
+		}
+
+		// Planning the contacts of the latest path, and publishing the plan. Note that the
+		// cost-to-go field is computed before the first path
+		std::vector<Contact> contacts;
+		contact_planner_->setCostToGoField(motion_planner_->getCostToGoField());
+		if (!contact_planner_->computeContactSequence(contacts, path)) {
+			printf(YELLOW "Could not computed the foothold sequence \n" COLOR_RESET);
+			continue;
+		}
+
+		publishPlan(path, contacts);
+	}
+
+	anytime_running_ = false;
+}
+
 } //@namespace locomotion
 } //@namespace dwl
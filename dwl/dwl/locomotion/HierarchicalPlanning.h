@@ -2,6 +2,14 @@
 #define DWL__LOCOMOTION__HIERARCHICAL_PLANNING__H
 
 #include <dwl/locomotion/PlanningOfMotionSequence.h>
+#include <dwl/SolveSnapshot.h>
+#include <dwl/utils/WorkerPool.h>
+#include <dwl/utils/BoundedQueue.h>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
 
 
 namespace dwl
@@ -19,6 +27,10 @@ namespace locomotion
 class HierarchicalPlanning : public PlanningOfMotionSequence
 {
 	public:
+		/** @brief Function that receives the improved plans, i.e. the body path and contacts */
+		typedef std::function<void(const std::vector<Pose>&,
+								   const std::vector<Contact>&)> PlanCallback;
+
 		/** @brief Constructor function */
 		HierarchicalPlanning();
 
@@ -37,6 +49,249 @@ class HierarchicalPlanning : public PlanningOfMotionSequence
 		 * @return True if it was computed the plan
 		 */
 		bool compute(Pose current_pose);
+
+		/**
+		 * @brief Starts an anytime computation of the plan, and returns without waiting for it.
+		 * The body path search and the contact planning run concurrently as the stages of a
+		 * pipeline: every improved body path of the path solver (e.g. ARA*) is passed to the
+		 * contact planning thread, which always plans the latest one (the older ones are
+		 * skipped). Every plan is published as soon as its contacts are found, through the
+		 * plan callback and the latest plan. Both stages are bounded by their computation times.
+		 * Note that the planners run in their own threads, so they shouldn't modify the robot
+		 * and terrain information during the computation
+		 * @param Pose current_pose Current pose
+		 * @return False if there isn't terrain information or a computation is running
+		 */
+		bool computeAnytime(Pose current_pose);
+
+		/**
+		 * @brief Starts the computation of the plan in a worker pool, and returns without
+		 * waiting for it. A newer request supersedes the older ones, i.e. the queued ones aren't
+		 * computed and the running one stops after its current stage (body path or contacts)
+		 * without publishing its plan. The plan is published through the plan callback and the
+		 * latest plan. Note that the robot and terrain information shouldn't be modified while
+		 * there is a pending request
+		 * @param Pose current_pose Current pose
+		 * @param utils::WorkerPool* Worker pool (NULL for the default one)
+		 * @return std::shared_future<bool> Result of the request, i.e. false if the plan
+		 * wasn't computed or it was superseded
+		 */
+		std::shared_future<bool> computeAsync(Pose current_pose,
+											  utils::WorkerPool* pool = NULL);
+
+		/**
+		 * @brief Computes the plan as a streaming pipeline, where the stages run in their own
+		 * threads and are connected by bounded queues. The body path is split in segments
+		 * (see setStreamingSegments), the contact stage plans the contacts of the path prefix
+		 * that ends with every segment, and the segment stage passes every segment and its
+		 * new contacts to the segment callback (e.g. a whole-body planner) as soon as they are
+		 * planned, so the first steps can be executed before the whole sequence is planned.
+		 * The contacts of a segment are committed, i.e. a longer prefix only adds the new
+		 * ones. Note that the contact planners that keep their scored stages (e.g.
+		 * FootstepGraphPlanning) or cache the terrain samples only plan the new part of every
+		 * prefix. The committed plan is published at the end through the plan callback and the
+		 * latest plan
+		 * @param Pose current_pose Current pose
+		 * @return True if it was computed the plan
+		 */
+		bool computeStreaming(Pose current_pose);
+
+		/**
+		 * @brief Sets the segments of the streaming computation
+		 * @param unsigned int Number of body motions (pose transitions) per segment
+		 * @param unsigned int Maximum number of queued segments between consecutive stages
+		 */
+		void setStreamingSegments(unsigned int num_motions,
+								  unsigned int queue_capacity);
+
+		/**
+		 * @brief Sets the function that receives every segment of the streaming computation,
+		 * i.e. its body poses and new contacts. Note that it's called from the segment thread
+		 * @param const PlanCallback& Segment callback (an empty function disables it)
+		 */
+		void setSegmentCallback(const PlanCallback& callback);
+
+		/** @brief Gets the number of segments of the last streaming computation */
+		unsigned int getNumberOfStreamedSegments() const;
+
+		/** @brief Cancels the pending asynchronous requests, i.e. the queued and running ones */
+		void cancel();
+
+		/** @brief Waits for the end of the pending asynchronous requests */
+		void waitAsync();
+
+		/**
+		 * @brief Sets the function that receives every plan of the anytime and asynchronous
+		 * computations. Note that it's called from the contact planning thread (or the worker)
+		 * @param const PlanCallback& Plan callback (an empty function disables it)
+		 */
+		void setPlanCallback(const PlanCallback& callback);
+
+		/**
+		 * @brief Gets the latest plan of the anytime computation if it's newer than a version
+		 * @param std::vector<Pose>& Body path
+		 * @param std::vector<Contact>& Contact sequence
+		 * @param unsigned int& Version of the known plan, which is updated with the new one
+		 * @return True if there is a newer plan
+		 */
+		bool getLatestPlan(std::vector<Pose>& body_path,
+						   std::vector<Contact>& contact_sequence,
+						   unsigned int& version);
+
+		/** @brief Gets the version of the latest plan, i.e. the number of published plans */
+		unsigned int getPlanVersion() const;
+
+		/** @brief Indicates if the anytime computation is running */
+		bool isAnytimeRunning() const;
+
+		/** @brief Waits for the end of the anytime computation */
+		void waitAnytime();
+
+		/**
+		 * @brief Sets the recorder of the snapshots, i.e. the exact inputs of every computation
+		 * (its mode, the current and goal poses, and the terrain and obstacle maps), so they
+		 * can be replayed offline. The terrain map is only written if it changed since the last
+		 * record of the file, so the records of a file have to be replayed in order
+		 * @param SnapshotRecorder* Snapshot recorder (NULL disables the recording)
+		 */
+		void setSnapshotRecorder(SnapshotRecorder* recorder);
+
+		/**
+		 * @brief Replays a recorded computation, i.e. it restores the terrain and obstacle maps
+		 * and the goal pose, and computes the plan in the recorded mode (the anytime and
+		 * asynchronous computations are waited for). Note that the robot and planners have to
+		 * be set up as in the recorded process
+		 * @param SnapshotDecoder& Payload of the record
+		 * @return True if it was computed the plan
+		 */
+		bool replay(SnapshotDecoder& snapshot);
+
+
+	private:
+		/** @brief Modes of the computations, which are recorded in the snapshots */
+		enum ComputeMode {BlockingMode, AnytimeMode, AsyncMode, StreamingMode};
+
+		/** @brief Segment of the body path, i.e. the indexes of its first and last poses */
+		struct PathSegment
+		{
+			PathSegment() : first(0), last(0) {}
+
+			unsigned int first;
+			unsigned int last;
+		};
+
+		/** @brief Planned segment, i.e. its body poses and new contacts */
+		struct PlanSegment
+		{
+			std::vector<Pose> body_path;
+			std::vector<Contact> contacts;
+		};
+
+		/**
+		 * @brief Plans the contacts of the path prefixes of the queued segments
+		 * @param const std::vector<Pose>* Body path
+		 */
+		void computeStreamingContacts(const std::vector<Pose>* path);
+
+		/** @brief Passes the planned segments to the segment callback */
+		void runStreamingSegments();
+
+		/**
+		 * @brief Computes the body path and publishes its improvements to the contact stage
+		 * @param Pose Current pose
+		 */
+		void computeAnytimePath(Pose current_pose);
+
+		/** @brief Computes the contacts of the latest body paths and publishes the plans */
+		void computeAnytimeContacts();
+
+		/**
+		 * @brief Computes an asynchronous request if it's the latest one, and publishes its plan
+		 * @param uint64_t Identifier of the request
+		 * @param Pose Current pose
+		 * @return False if the plan wasn't computed or the request was superseded
+		 */
+		bool computeRequest(uint64_t request,
+							Pose current_pose);
+
+		/**
+		 * @brief Records the inputs of a computation if there is a snapshot recorder
+		 * @param ComputeMode Mode of the computation
+		 * @param const Pose& Current pose
+		 */
+		void recordSnapshot(ComputeMode mode,
+							const Pose& current_pose);
+
+		/**
+		 * @brief Publishes a plan, i.e. the body path and contact sequence
+		 * @param const std::vector<Pose>& Body path
+		 * @param const std::vector<Contact>& Contact sequence
+		 */
+		void publishPlan(const std::vector<Pose>& body_path,
+						 const std::vector<Contact>& contact_sequence);
+
+		/** @brief Threads of the body path and contact stages */
+		std::thread path_thread_;
+		std::thread contact_thread_;
+
+		/** @brief Latest body path of the path stage and its version */
+		std::mutex path_mutex_;
+		std::condition_variable path_condition_;
+		std::vector<Pose> latest_path_;
+		unsigned int path_version_;
+		bool path_done_;
+
+		/** @brief Guards the published plan, i.e. the body path and contact sequence */
+		std::mutex plan_mutex_;
+
+		/** @brief Version of the published plan */
+		std::atomic<unsigned int> plan_version_;
+
+		/** @brief Indicates if the anytime computation is running */
+		std::atomic<bool> anytime_running_;
+
+		/** @brief Function that receives the plans */
+		PlanCallback plan_callback_;
+
+		/** @brief Queues between the stages of the streaming computation */
+		utils::BoundedQueue<PathSegment> path_segments_;
+		utils::BoundedQueue<PlanSegment> plan_segments_;
+
+		/** @brief Segments of the streaming computation */
+		unsigned int segment_motions_;
+		unsigned int segment_queue_capacity_;
+
+		/** @brief Function that receives the planned segments */
+		PlanCallback segment_callback_;
+
+		/** @brief Committed contacts of the streaming computation, which are owned by the
+		 * segment thread until it's joined */
+		std::vector<Contact> streamed_contacts_;
+
+		/** @brief Number of streamed segments */
+		std::atomic<unsigned int> num_streamed_segments_;
+
+		/** @brief Indicates if the contact stage failed */
+		bool is_streaming_failed_;
+
+		/** @brief Serializes the asynchronous and streaming computations */
+		std::mutex compute_mutex_;
+
+		/** @brief Latest asynchronous request */
+		std::atomic<uint64_t> latest_request_;
+
+		/** @brief Number of pending asynchronous requests, which is guarded by the mutex */
+		std::mutex request_mutex_;
+		std::condition_variable request_condition_;
+		unsigned int num_pending_;
+
+		/** @brief Snapshot recorder, and the session and revision of the last recorded
+		 * terrain map */
+		SnapshotRecorder* snapshot_recorder_;
+		SnapshotEncoder snapshot_;
+		unsigned int snapshot_session_;
+		unsigned long snapshot_revision_;
+		std::mutex snapshot_mutex_;
 };
 
 } //@namespace locomotion
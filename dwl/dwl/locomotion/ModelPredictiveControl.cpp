@@ -1,4 +1,6 @@
 #include <dwl/locomotion/ModelPredictiveControl.h>
+#include <dwl/utils/Macros.h>
+#include <limits>
 
 
 
@@ -8,7 +10,8 @@ namespace dwl
 namespace locomotion
 {
 
-ModelPredictiveControl::ModelPredictiveControl() : model_(NULL), optimizer_(NULL)
+ModelPredictiveControl::ModelPredictiveControl() : model_(NULL), optimizer_(NULL),
+		riccati_(NULL), move_blocking_(false), precomputed_gains_(false), new_qp_matrices_(true), cputime_(0.008)
 {
 	enable_record_ = true;
 }
@@ -45,9 +48,21 @@ bool ModelPredictiveControl::reset(model::LinearDynamicalSystem* model,
 	variables_ = horizon_ * inputs_;
 	constraints_ = optimizer_->getConstraintNumber();
 
+	// Reading the move-blocking of the inputs, i.e. the number of steps of each block
+	std::vector<int> move_blocks;
+	if (nh_.getParam("move_blocking", move_blocks))
+		setMoveBlocking(move_blocks);
 
-	// Initializing the QP solver
-	if (!optimizer_->init(inputs_ * horizon_, constraints_ * horizon_))
+	// Initializing the QP solver, where the variables are the parameters of the inputs, and
+	// the input bounds of a basis are constraints
+	unsigned int qp_variables = inputs_ * horizon_;
+	unsigned int qp_constraints = constraints_ * horizon_;
+	if (input_map_.size() != 0) {
+		qp_variables = input_map_.cols();
+		if (!move_blocking_)
+			qp_constraints += variables_;
+	}
+	if (!optimizer_->init(qp_variables, qp_constraints))
 		return false;
 
 	printf("Reset successful. States = %d \n Inputs = %d \n Outputs = %d \n Constraints = %d \n",
@@ -217,84 +232,12 @@ bool ModelPredictiveControl::init()
 void ModelPredictiveControl::update(WholeBodyState& current_state,
 									WholeBodyState& reference_state)
 {
-	Eigen::Map<Eigen::VectorXd> x_measured_eigen(x_measured, states_, 1);// current_state
-	Eigen::Map<Eigen::VectorXd> x_reference_eigen(x_reference, states_, 1);// reference state
-
-	// Update of the model parameters
-	Eigen::MatrixXd A, B;
-	if (model_->getModelType()) {
-		model_->computeLinearSystem(A, B);
-	}
-	
-	// Compute steady state control based on updated system matrices
-	Eigen::JacobiSVD<Eigen::MatrixXd> SVD_B(B, Eigen::ComputeThinU | Eigen::ComputeThinV);
-	u_reference_ = SVD_B.solve(x_reference_eigen - A * x_reference_eigen);
-	
-	// Creation of the base vector
-	std::vector<Eigen::MatrixXd> A_pow;
-	A_pow.push_back(Eigen::MatrixXd::Identity(states_, states_));
-	for (int i = 1; i < horizon_ + 1; i++) {
-		Eigen::MatrixXd A_pow_i = A_pow[i-1] * A;
-		A_pow.push_back(A_pow_i);
-	}
-
-	// Computing the extended state and input matrixes for the predefined horizon
-	Eigen::MatrixXd A_bar = Eigen::MatrixXd::Zero((horizon_ + 1) * states_, states_);
-	Eigen::MatrixXd B_bar = Eigen::MatrixXd::Zero((horizon_ + 1) * states_, horizon_ * inputs_);
-	Eigen::MatrixXd x_ref_bar = Eigen::MatrixXd::Zero((horizon_ + 1) * states_, 1);
-	for (int i = 0; i < horizon_ + 1; i++) {
-		for (int j = 0; j < horizon_; j++) {
-			if (i == horizon_) {
-				if (j == 0) {
-					A_bar.block(i * states_, 0, states_, states_) = A_pow[i];
-					x_ref_bar.block(i * states_, 0, states_, 1) = x_reference_eigen;
-				}
-				if (i > j)
-					B_bar.block(i * states_, j * inputs_, states_, inputs_) = A_pow[i-j-1] * B;
-			} else {
-				if (j == 0) {
-					A_bar.block(i * states_, 0, states_, states_) = A_pow[i];
-					x_ref_bar.block(i * states_, 0, states_, 1) = x_reference_eigen;
-				}
-				if (i > j)
-					B_bar.block(i * states_, j * inputs_, states_, inputs_) = A_pow[i-j-1] * B;
-			}
-		}
-	}
-	
-	// Computing the values of the Hessian matrix and Gradient vector
-	Eigen::MatrixXd hessian = Eigen::Matrix::Zero(horizon_ * inputs_, horizon_ * inputs_);
-	Eigen::VectorXd gradient = Eigen::VectorXd::Zero(horizon_ * inputs_);
-	hessian = B_bar.transpose() * Q_bar_ * B_bar + R_bar_;
-	gradient = B_bar.transpose() * Q_bar_ * (A_bar * x_measured_eigen - x_ref_bar);
-	
-	// Computing the constraint and state bounds for the predefined horizon;
-	Eigen::VectorXd lbG_bar = Eigen::VectorXd::Zero(horizon_ * constraints_);
-	Eigen::VectorXd ubG_bar = Eigen::VectorXd::Zero(horizon_ * constraints_);
-	Eigen::VectorXd lb_bar = Eigen::VectorXd::Zero(horizon_ * inputs_);
-	Eigen::VectorXd ub_bar = Eigen::VectorXd::Zero(horizon_ * inputs_);
-	model_->getConstraintsBounds(lbG_bar, ubG_bar);
-	model_->getStateBounds(lb_bar, ub_bar);
-	lbG_bar = lbG_bar - M_bar_ * A_bar * x_measured_eigen;
-	ubG_bar = ubG_bar - M_bar_ * A_bar * x_measured_eigen;
-
-	// Computing the extended constraint matrix
-	Eigen::MatrixXd constraint_matrix = Eigen::MatrixXd::Zero(horizon_ * constraints_,
-															  horizon_ * inputs_);
-	constraint_matrix = M_bar_ * B_bar;
-	
-	// Solving the QP problem
-	double cputime = 0.008;//1.0;//NULL;
-	bool success = false;
-	success = optimizer_->compute(hessian, gradient,
-								  constraint_matrix,
-								  lb_bar, ub_bar,
-								  lbG_bar, ubG_bar,
-								  cputime);
-	if (success) {
-		mpc_solution_ = optimizer_->getOptimalSolution();
+	// Running both phases of the real-time iteration in the same cycle
+	prepare(reference_state);
+	bool success = feedback(current_state);
+	if (success)
 		infeasibility_counter_ = 0;
-	} else {
+	else {
 		infeasibility_counter_++;
 		printf("Warning: an optimal solution could not be obtained.");
 	}
@@ -313,5 +256,313 @@ void ModelPredictiveControl::update(WholeBodyState& current_state,
 	}
 }
 
+
+void ModelPredictiveControl::prepare(WholeBodyState& reference_state)
+{
+	Eigen::Map<Eigen::VectorXd> x_reference_eigen(x_reference, states_, 1);// reference state
+
+	// Update of the model parameters. Note that the condensed matrices of a LTI model are
+	// computed only once
+	if (model_->getModelType() || (riccati_ == NULL && qp_hessian_.size() == 0)) {
+		model_->computeLinearSystem(A_, B_);
+		new_qp_matrices_ = true;
+	}
+
+	// Compute steady state control based on updated system matrices
+	Eigen::JacobiSVD<Eigen::MatrixXd> SVD_B(B_, Eigen::ComputeThinU | Eigen::ComputeThinV);
+	u_reference_ = SVD_B.solve(x_reference_eigen - A_ * x_reference_eigen);
+
+	if (riccati_ != NULL) {
+		prepareRiccati(x_reference_eigen);
+		return;
+	}
+
+	if (new_qp_matrices_) {
+		// Creation of the base vector
+		std::vector<Eigen::MatrixXd> A_pow;
+		A_pow.push_back(Eigen::MatrixXd::Identity(states_, states_));
+		for (int i = 1; i < horizon_ + 1; i++) {
+			Eigen::MatrixXd A_pow_i = A_pow[i-1] * A_;
+			A_pow.push_back(A_pow_i);
+		}
+
+		// Computing the extended state and input matrixes for the predefined horizon
+		Eigen::MatrixXd A_bar = Eigen::MatrixXd::Zero((horizon_ + 1) * states_, states_);
+		Eigen::MatrixXd B_bar = Eigen::MatrixXd::Zero((horizon_ + 1) * states_, horizon_ * inputs_);
+		for (int i = 0; i < horizon_ + 1; i++) {
+			A_bar.block(i * states_, 0, states_, states_) = A_pow[i];
+			for (int j = 0; j < i && j < horizon_; j++)
+				B_bar.block(i * states_, j * inputs_, states_, inputs_) = A_pow[i-j-1] * B_;
+		}
+
+		// Condensing the Hessian matrix and the extended constraint matrix, and the linear
+		// maps of the measured state
+		gradient_reference_map_ = B_bar.transpose() * Q_bar_;
+		qp_hessian_ = gradient_reference_map_ * B_bar + R_bar_;
+		qp_constraint_mat_ = M_bar_ * B_bar;
+		gradient_state_map_ = gradient_reference_map_ * A_bar;
+		constraint_state_map_ = M_bar_ * A_bar;
+
+		// Projecting the condensed QP in the parameters of the inputs
+		if (input_map_.size() != 0)
+			parameterizeInputs();
+
+		// Computing the gains of the unconstrained solution, i.e. U = -H^-1 g, where the
+		// condensed Hessian is positive definite
+		if (precomputed_gains_ && !model_->getModelType()) {
+			Eigen::LLT<Eigen::MatrixXd> hessian_llt(qp_hessian_);
+			explicit_state_gain_ = -hessian_llt.solve(gradient_state_map_);
+			explicit_reference_gain_ = hessian_llt.solve(gradient_reference_map_);
+		}
+	}
+
+	// Computing the gradient offset of the reference state
+	Eigen::VectorXd x_ref_bar = x_reference_eigen.replicate(horizon_ + 1, 1);
+	gradient_offset_ = -gradient_reference_map_ * x_ref_bar;
+	if (precomputed_gains_ && explicit_reference_gain_.cols() == x_ref_bar.size())
+		explicit_offset_ = explicit_reference_gain_ * x_ref_bar;
+
+	// Computing the constraint and state bounds for the predefined horizon
+	lbG_prepared_ = Eigen::VectorXd::Zero(horizon_ * constraints_);
+	ubG_prepared_ = Eigen::VectorXd::Zero(horizon_ * constraints_);
+	lb_prepared_ = Eigen::VectorXd::Zero(horizon_ * inputs_);
+	ub_prepared_ = Eigen::VectorXd::Zero(horizon_ * inputs_);
+	model_->getConstraintsBounds(lbG_prepared_, ubG_prepared_);
+	model_->getStateBounds(lb_prepared_, ub_prepared_);
+	if (input_map_.size() != 0)
+		parameterizeBounds();
+}
+
+
+bool ModelPredictiveControl::feedback(WholeBodyState& measured_state)
+{
+	Eigen::Map<Eigen::VectorXd> x_measured_eigen(x_measured, states_, 1);// current_state
+
+	// Solving the uncondensed problem with the Riccati recursion
+	if (riccati_ != NULL) {
+		bool success = riccati_->compute(x_measured_eigen, cputime_);
+		if (success) {
+			mpc_solution_ = riccati_->getOptimalInputs();
+			new_qp_matrices_ = false;
+		}
+
+		return success;
+	}
+
+	// Updating the vectors of the QP with the measured state, i.e. only matrix-vector products
+	Eigen::VectorXd state_constraint = constraint_state_map_ * x_measured_eigen;
+	Eigen::VectorXd lbG_bar = lbG_prepared_ - state_constraint;
+	Eigen::VectorXd ubG_bar = ubG_prepared_ - state_constraint;
+
+	// Using the unconstrained solution of the precomputed gains if it's feasible, otherwise
+	// the QP is solved (i.e. some constraints are active)
+	if (precomputed_gains_ && explicit_state_gain_.rows() == qp_hessian_.rows() &&
+			explicit_offset_.size() == qp_hessian_.rows()) {
+		Eigen::VectorXd solution = explicit_state_gain_ * x_measured_eigen + explicit_offset_;
+		Eigen::VectorXd constraint = qp_constraint_mat_ * solution;
+		if ((solution.array() >= lb_prepared_.array()).all() &&
+				(solution.array() <= ub_prepared_.array()).all() &&
+				(constraint.array() >= lbG_bar.array()).all() &&
+				(constraint.array() <= ubG_bar.array()).all()) {
+			mpc_solution_ = (input_map_.size() != 0) ? input_map_ * solution : solution;
+			new_qp_matrices_ = false;
+			return true;
+		}
+	}
+
+	Eigen::VectorXd gradient = gradient_state_map_ * x_measured_eigen + gradient_offset_;
+
+	// Solving the QP problem. The QP is hotstarted with the new vectors if the condensed
+	// matrices didn't change in the preparation phase, otherwise it's hotstarted with the new
+	// matrices (or initialized in the first computation)
+	bool success = false;
+	if (!new_qp_matrices_ && optimizer_->isInitialized())
+		success = optimizer_->hotstart(gradient,
+									   lb_prepared_, ub_prepared_,
+									   lbG_bar, ubG_bar,
+									   cputime_);
+	else
+		success = optimizer_->hotstart(qp_hessian_, gradient,
+									   qp_constraint_mat_,
+									   lb_prepared_, ub_prepared_,
+									   lbG_bar, ubG_bar,
+									   cputime_);
+	if (success) {
+		// Recovering the inputs of the horizon from their parameters
+		if (input_map_.size() != 0)
+			mpc_solution_ = input_map_ * optimizer_->getOptimalSolution();
+		else
+			mpc_solution_ = optimizer_->getOptimalSolution();
+		new_qp_matrices_ = false;
+	}
+
+	return success;
+}
+
+
+void ModelPredictiveControl::setCPUTime(double cputime)
+{
+	cputime_ = cputime;
+}
+
+
+void ModelPredictiveControl::setRiccatiSolver(solver::RiccatiInteriorPoint* riccati)
+{
+	riccati_ = riccati;
+	new_qp_matrices_ = true;
+}
+
+
+void ModelPredictiveControl::setPrecomputedGains(bool enable)
+{
+	precomputed_gains_ = enable;
+	new_qp_matrices_ = true;
+	explicit_state_gain_.resize(0, 0);
+	explicit_reference_gain_.resize(0, 0);
+	explicit_offset_.resize(0);
+}
+
+
+void ModelPredictiveControl::setMoveBlocking(const std::vector<int>& blocks)
+{
+	input_map_.resize(0, 0);
+	move_blocking_ = false;
+	new_qp_matrices_ = true;
+	if (blocks.empty())
+		return;
+
+	// Each block selects its input for all its steps
+	std::vector<int> steps;
+	for (unsigned int j = 0; j < blocks.size() && (int) steps.size() < horizon_; j++) {
+		for (int k = 0; k < blocks[j] && (int) steps.size() < horizon_; k++)
+			steps.push_back(j);
+	}
+	int num_blocks = steps.empty() ? 0 : steps.back() + 1;
+	while ((int) steps.size() < horizon_)
+		steps.push_back(num_blocks - 1);
+
+	input_map_ = Eigen::MatrixXd::Zero(horizon_ * inputs_, num_blocks * inputs_);
+	for (int k = 0; k < horizon_; k++)
+		input_map_.block(k * inputs_, steps[k] * inputs_, inputs_, inputs_).setIdentity();
+	move_blocking_ = true;
+}
+
+
+void ModelPredictiveControl::setInputBasis(const Eigen::MatrixXd& basis)
+{
+	input_map_.resize(0, 0);
+	move_blocking_ = false;
+	new_qp_matrices_ = true;
+	if (basis.rows() != horizon_) {
+		printf(YELLOW "Warning: the basis has %d samples instead of the horizon %d\n"
+				COLOR_RESET, (int) basis.rows(), horizon_);
+		return;
+	}
+
+	// The basis is applied to every input, i.e. T = basis (x) I
+	unsigned int num_functions = basis.cols();
+	input_map_ = Eigen::MatrixXd::Zero(horizon_ * inputs_, num_functions * inputs_);
+	for (int k = 0; k < horizon_; k++) {
+		for (unsigned int j = 0; j < num_functions; j++)
+			input_map_.block(k * inputs_, j * inputs_, inputs_, inputs_) =
+					basis(k, j) * Eigen::MatrixXd::Identity(inputs_, inputs_);
+	}
+}
+
+
+void ModelPredictiveControl::parameterizeInputs()
+{
+	// Projecting the Hessian, the gradient maps and the constraint matrix, i.e.
+	// H_z = T^T H T, g_z = T^T g and G_z = G T
+	qp_hessian_ = input_map_.transpose() * qp_hessian_ * input_map_;
+	gradient_reference_map_ = input_map_.transpose() * gradient_reference_map_;
+	gradient_state_map_ = input_map_.transpose() * gradient_state_map_;
+	qp_constraint_mat_ = qp_constraint_mat_ * input_map_;
+
+	// The input bounds of a basis are constraints of the parameters, i.e. lb <= T z <= ub,
+	// which don't depend on the measured state
+	if (!move_blocking_) {
+		unsigned int num_constraints = qp_constraint_mat_.rows();
+		Eigen::MatrixXd constraint_mat(num_constraints + variables_, input_map_.cols());
+		constraint_mat << qp_constraint_mat_, input_map_;
+		qp_constraint_mat_ = constraint_mat;
+
+		Eigen::MatrixXd state_map = Eigen::MatrixXd::Zero(num_constraints + variables_, states_);
+		state_map.topRows(num_constraints) = constraint_state_map_;
+		constraint_state_map_ = state_map;
+	}
+}
+
+
+void ModelPredictiveControl::parameterizeBounds()
+{
+	unsigned int num_parameters = input_map_.cols();
+	const double inf = std::numeric_limits<double>::infinity();
+	if (move_blocking_) {
+		// The bounds of a block are the intersection of the bounds of its steps
+		Eigen::VectorXd lb = Eigen::VectorXd::Constant(num_parameters, -inf);
+		Eigen::VectorXd ub = Eigen::VectorXd::Constant(num_parameters, inf);
+		for (unsigned int i = 0; i < input_map_.rows(); i++) {
+			for (unsigned int j = 0; j < num_parameters; j++) {
+				if (input_map_(i,j) != 0.) {
+					lb(j) = std::max(lb(j), lb_prepared_(i));
+					ub(j) = std::min(ub(j), ub_prepared_(i));
+				}
+			}
+		}
+		lb_prepared_ = lb;
+		ub_prepared_ = ub;
+	} else {
+		// Moving the input bounds to the constraints, so the parameters are unbounded
+		unsigned int num_constraints = lbG_prepared_.size();
+		Eigen::VectorXd lbG(num_constraints + variables_), ubG(num_constraints + variables_);
+		lbG << lbG_prepared_, lb_prepared_;
+		ubG << ubG_prepared_, ub_prepared_;
+		lbG_prepared_ = lbG;
+		ubG_prepared_ = ubG;
+		lb_prepared_ = Eigen::VectorXd::Constant(num_parameters, -inf);
+		ub_prepared_ = Eigen::VectorXd::Constant(num_parameters, inf);
+	}
+}
+
+
+void ModelPredictiveControl::prepareRiccati(const Eigen::VectorXd& reference_state)
+{
+	// Computing the constraint and input bounds for the predefined horizon
+	lbG_prepared_ = Eigen::VectorXd::Zero(horizon_ * constraints_);
+	ubG_prepared_ = Eigen::VectorXd::Zero(horizon_ * constraints_);
+	lb_prepared_ = Eigen::VectorXd::Zero(horizon_ * inputs_);
+	ub_prepared_ = Eigen::VectorXd::Zero(horizon_ * inputs_);
+	model_->getConstraintsBounds(lbG_prepared_, ubG_prepared_);
+	model_->getStateBounds(lb_prepared_, ub_prepared_);
+
+	// Every stage constraints its state (M x_k) and bounds its input, i.e. C = [M; 0] and
+	// D = [0; I]
+	if (new_qp_matrices_) {
+		if (riccati_->getHorizon() != (unsigned int) horizon_)
+			riccati_->init(states_, inputs_, horizon_, constraints_ + inputs_);
+		riccati_->setDynamics(A_, B_);
+	}
+	Eigen::MatrixXd C = Eigen::MatrixXd::Zero(constraints_ + inputs_, states_);
+	Eigen::MatrixXd D = Eigen::MatrixXd::Zero(constraints_ + inputs_, inputs_);
+	C.topRows(constraints_) = M_bar_.block(0, 0, constraints_, states_);
+	D.bottomRows(inputs_).setIdentity();
+	Eigen::VectorXd lb(constraints_ + inputs_), ub(constraints_ + inputs_);
+	for (int k = 0; k < horizon_; k++) {
+		lb << lbG_prepared_.segment(k * constraints_, constraints_),
+				lb_prepared_.segment(k * inputs_, inputs_);
+		ub << ubG_prepared_.segment(k * constraints_, constraints_),
+				ub_prepared_.segment(k * inputs_, inputs_);
+		riccati_->setConstraints(k, C, D, lb, ub);
+
+		// Tracking the reference state
+		riccati_->setCost(k, Q_, R_,
+						  Eigen::MatrixXd::Zero(inputs_, states_),
+						  -Q_ * reference_state,
+						  Eigen::VectorXd::Zero(inputs_));
+	}
+	riccati_->setTerminalCost(P_, -P_ * reference_state);
+}
+
 } //@namespace locomotion
 } //@namespace dwl
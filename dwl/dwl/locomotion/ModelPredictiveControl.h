@@ -3,10 +3,12 @@
 
 #include <dwl/model/LinearDynamicalSystem.h>
 #include <dwl/solver/QuadraticProgram.h>
+#include <dwl/solver/RiccatiInteriorPoint.h>
 
 #include <Eigen/Dense>
 
 #include <fstream>
+#include <vector>
 
 
 namespace dwl
@@ -65,6 +67,67 @@ class ModelPredictiveControl
 		virtual void update(WholeBodyState& measured_state,
 							WholeBodyState& current_state) = 0;
 
+		/**
+		 @brief Preparation phase of the real-time iteration (RTI) scheme. It linearizes the
+		 model and condenses the QP of the prediction horizon before the measurement arrives, i.e.
+		 everything that doesn't depend on the current state
+		 @param WholeBodyState Reference state
+		 */
+		virtual void prepare(WholeBodyState& reference_state);
+
+		/**
+		 @brief Feedback phase of the real-time iteration (RTI) scheme. It updates the
+		 gradient and constraint bounds with the measured state, and hotstarts the QP solver
+		 reusing the condensed matrices of the preparation phase
+		 @param WholeBodyState Measured state
+		 @return Label that indicates if a solution was computed
+		 */
+		virtual bool feedback(WholeBodyState& measured_state);
+
+		/**
+		 @brief Sets the allowed CPU time of the QP solver per cycle
+		 @param double CPU time in seconds
+		 */
+		void setCPUTime(double cputime);
+
+		/**
+		 @brief Sets a structure-exploiting solver of the uncondensed problem. If it's defined,
+		 the preparation phase doesn't condense the QP and the feedback phase solves it with a
+		 Riccati recursion, i.e. the cost scales linearly with the horizon
+		 @param solver::RiccatiInteriorPoint* Riccati solver
+		 */
+		void setRiccatiSolver(solver::RiccatiInteriorPoint* riccati);
+
+		/**
+		 @brief Enables/disables the precomputed (explicit) gains of a LTI model. The
+		 preparation phase computes the gains of the unconstrained solution once, i.e. the
+		 finite-horizon LQR of the condensed QP, so the feedback phase is a matrix-vector
+		 product. The QP is solved only if the unconstrained solution violates the constraints
+		 @param bool True for enabling the precomputed gains
+		 */
+		void setPrecomputedGains(bool enable);
+
+		/**
+		 @brief Sets a move-blocking of the inputs, i.e. the inputs are piecewise constant
+		 over blocks of steps. The QP optimizes one input per block, where the bounds of a
+		 block are the intersection of the ones of its steps. It's read from the move_blocking
+		 parameter of the configuration, otherwise it has to be set after the reset. Note that
+		 the Riccati solver optimizes every input
+		 @param const std::vector<int>& Number of steps of each block, where the last one is
+		 extended (or truncated) until the end of the horizon. An empty vector removes the
+		 parameterization
+		 */
+		void setMoveBlocking(const std::vector<int>& blocks);
+
+		/**
+		 @brief Sets a basis-function parameterization of the inputs (e.g. sampled splines),
+		 i.e. u_k = sum_j basis(k,j) z_j for every input. The QP optimizes the coefficients z,
+		 and the input bounds become constraints of the QP. It has to be set after the reset
+		 @param const Eigen::MatrixXd& Basis functions sampled at the steps [horizon x
+		 number of functions]
+		 */
+		void setInputBasis(const Eigen::MatrixXd& basis);
+
 		/**
 		 @brief Function to get the control signal generated for the MPC. As the MPC algorithm
 		 states, the optimization process yields the control signals for a range of times defined
@@ -76,12 +139,31 @@ class ModelPredictiveControl
 
 			
 	protected:
+		/**
+		 @brief Sets the stages of the uncondensed problem in the Riccati solver, i.e. the
+		 dynamics, the tracking cost of the reference state and the constraints
+		 @param const Eigen::VectorXd& Reference state
+		 */
+		void prepareRiccati(const Eigen::VectorXd& reference_state);
+
+		/**
+		 @brief Condenses the QP in the parameters of the inputs, i.e. U = T z, where the
+		 Hessian, gradient maps and constraint matrix are projected by T
+		 */
+		void parameterizeInputs();
+
+		/** @brief Converts the input bounds of the horizon to the bounds of the parameters */
+		void parameterizeBounds();
+
 		/** @brief Pointer of linear dynamical model of the system */
 		model::LinearDynamicalSystem* model_;
 
 		/** @brief Pointer of the optimizer of the MPC */
 		solver::QuadraticProgram* optimizer_;
 
+		/** @brief Pointer of the structure-exploiting solver of the uncondensed MPC */
+		solver::RiccatiInteriorPoint* riccati_;
+
 		/** @brief Number of states of the dynamic model */
 		int states_;
 
@@ -126,6 +208,48 @@ class ModelPredictiveControl
 
 		/** @brief Stationary control signal for the reference state vector */
 		Eigen::MatrixXd u_reference_;
+
+		/** @brief Condensed Hessian and constraint matrix of the QP */
+		Eigen::MatrixXd qp_hessian_;
+		Eigen::MatrixXd qp_constraint_mat_;
+
+		/** @brief Linear maps from the measured and reference states to the QP vectors */
+		Eigen::MatrixXd gradient_state_map_;
+		Eigen::MatrixXd gradient_reference_map_;
+		Eigen::MatrixXd constraint_state_map_;
+
+		/** @brief Parts of the QP vectors that don't depend on the measured state */
+		Eigen::VectorXd gradient_offset_;
+		Eigen::VectorXd lbG_prepared_;
+		Eigen::VectorXd ubG_prepared_;
+		Eigen::VectorXd lb_prepared_;
+		Eigen::VectorXd ub_prepared_;
+
+		/**
+		 @brief Gains of the unconstrained solution, i.e. U = K_x x + K_r x_ref, where the
+		 reference term is computed in the preparation phase
+		 */
+		Eigen::MatrixXd explicit_state_gain_;
+		Eigen::MatrixXd explicit_reference_gain_;
+		Eigen::VectorXd explicit_offset_;
+
+		/**
+		 @brief Parameterization of the inputs of the horizon, i.e. U = T z [variables x
+		 parameters], which is empty without parameterization
+		 */
+		Eigen::MatrixXd input_map_;
+
+		/** @brief Label that indicates if the parameterization is a move-blocking */
+		bool move_blocking_;
+
+		/** @brief Label that indicates if the precomputed gains are enabled */
+		bool precomputed_gains_;
+
+		/** @brief Label that indicates if the condensed matrices changed in the preparation */
+		bool new_qp_matrices_;
+
+		/** @brief Allowed CPU time of the QP solver per cycle */
+		double cputime_;
 };
 
 } //@namespace locomotion
@@ -0,0 +1,101 @@
+#include <dwl/locomotion/MotionLibrary.h>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+void computeStateFeatures(Eigen::VectorXd& features,
+						  const WholeBodyState& state)
+{
+	// The base velocities are expressed in the horizontal frame, so they don't depend on the
+	// heading
+	Eigen::Matrix3d horizontal_rot =
+			Eigen::AngleAxisd(-state.base_pos(rbd::AZ), Eigen::Vector3d::UnitZ()).toRotationMatrix();
+	unsigned int num_joints = state.joint_pos.size();
+	features.resize(9 + 2 * num_joints);
+	features << state.base_pos(rbd::LZ), state.base_pos(rbd::AX), state.base_pos(rbd::AY),
+			horizontal_rot * state.base_vel.segment<3>(rbd::AX),
+			horizontal_rot * state.base_vel.segment<3>(rbd::LX),
+			state.joint_pos, state.joint_vel;
+}
+
+
+uint64_t computeTerrainHash(const environment::TerrainMap& terrain,
+							const Eigen::Vector2d& position,
+							double yaw,
+							double patch_size,
+							double grid_resolution,
+							double height_resolution)
+{
+	if (grid_resolution <= 0. || height_resolution <= 0.) {
+		printf(YELLOW "Warning: the resolutions of the terrain patch have to be positive\n"
+				COLOR_RESET);
+		return 0;
+	}
+
+	// The heights are relative to the height of the center, which is zero if it's unknown
+	double center_height;
+	if (!terrain.getTerrainHeight(center_height, position))
+		center_height = 0.;
+
+	// Hashing the quantized heights of the grid (FNV-1a), where the cells are sampled in the
+	// horizontal frame of the patch
+	uint64_t hash = 14695981039346656037ULL;
+	int num_cells = std::max(1, (int) floor(patch_size / grid_resolution + 0.5));
+	double offset = 0.5 * (num_cells - 1) * grid_resolution;
+	Eigen::Matrix2d rot = Eigen::Rotation2Dd(yaw).toRotationMatrix();
+	for (int i = 0; i < num_cells; i++) {
+		for (int j = 0; j < num_cells; j++) {
+			Eigen::Vector2d cell_pos = position +
+					rot * Eigen::Vector2d(i * grid_resolution - offset,
+										  j * grid_resolution - offset);
+
+			double height;
+			int32_t level = std::numeric_limits<int32_t>::min();
+			if (terrain.getTerrainHeight(height, cell_pos))
+				level = (int32_t) floor((height - center_height) / height_resolution + 0.5);
+
+			for (unsigned int b = 0; b < sizeof(level); b++) {
+				hash ^= (unsigned char) (((uint32_t) level) >> (8 * b));
+				hash *= 1099511628211ULL;
+			}
+		}
+	}
+
+	return hash;
+}
+
+
+void alignTrajectory(WholeBodyTrajectory& trajectory,
+					 const WholeBodyState& state)
+{
+	if (trajectory.empty())
+		return;
+
+	// Computing the horizontal transformation of the first state
+	double first_yaw = trajectory[0].base_pos(rbd::AZ);
+	Eigen::Vector3d first_pos = trajectory[0].base_pos.segment<3>(rbd::LX);
+	double first_time = trajectory[0].time;
+	Eigen::Matrix3d rot = Eigen::AngleAxisd(state.base_pos(rbd::AZ) - first_yaw,
+											Eigen::Vector3d::UnitZ()).toRotationMatrix();
+
+	// Moving every state, where the base quantities are expressed in the world frame
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		WholeBodyState& point = trajectory[k];
+		Eigen::Vector3d relative_pos = rot * (point.base_pos.segment<3>(rbd::LX) - first_pos);
+		point.base_pos(rbd::LX) = state.base_pos(rbd::LX) + relative_pos(rbd::X);
+		point.base_pos(rbd::LY) = state.base_pos(rbd::LY) + relative_pos(rbd::Y);
+		point.base_pos(rbd::AZ) += state.base_pos(rbd::AZ) - first_yaw;
+		point.base_vel.segment<3>(rbd::AX) = rot * point.base_vel.segment<3>(rbd::AX);
+		point.base_vel.segment<3>(rbd::LX) = rot * point.base_vel.segment<3>(rbd::LX);
+		point.base_acc.segment<3>(rbd::AX) = rot * point.base_acc.segment<3>(rbd::AX);
+		point.base_acc.segment<3>(rbd::LX) = rot * point.base_acc.segment<3>(rbd::LX);
+		point.time += state.time - first_time;
+	}
+}
+
+} //@namespace locomotion
+} //@namespace dwl
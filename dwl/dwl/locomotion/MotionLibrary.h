@@ -0,0 +1,212 @@
+#ifndef DWL__LOCOMOTION__MOTION_LIBRARY__H
+#define DWL__LOCOMOTION__MOTION_LIBRARY__H
+
+#include <dwl/WholeBodyState.h>
+#include <dwl/environment/TerrainMap.h>
+#include <unordered_map>
+#include <limits>
+#include <stdint.h>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+/**
+ * @brief Descriptor of a planning problem, i.e. the features of its initial state, the hash
+ * of the terrain patch and the command (e.g. the desired velocity or step)
+ */
+struct MotionDescriptor
+{
+	MotionDescriptor() : terrain_hash(0) {}
+	MotionDescriptor(const Eigen::VectorXd& _state_features,
+					 uint64_t _terrain_hash,
+					 const Eigen::VectorXd& _command) : state_features(_state_features),
+							 terrain_hash(_terrain_hash), command(_command) {}
+
+	Eigen::VectorXd state_features;
+	uint64_t terrain_hash;
+	Eigen::VectorXd command;
+};
+
+/**
+ * @brief Computes the features of a whole-body state that don't depend on its horizontal
+ * placement, i.e. the base height, roll and pitch, the base velocities in the horizontal
+ * frame and the joint positions and velocities
+ * @param Eigen::VectorXd& State features
+ * @param const WholeBodyState& Whole-body state
+ */
+void computeStateFeatures(Eigen::VectorXd& features,
+						  const WholeBodyState& state);
+
+/**
+ * @brief Computes the hash of a terrain patch around a horizontal pose, i.e. the heights of
+ * a square grid in the horizontal frame, which are relative to the height of its center and
+ * quantized by the height resolution. So the same patch (e.g. a stair step) has the same hash
+ * in different places and headings. The unknown cells are also hashed
+ * @param const environment::TerrainMap& Terrain map
+ * @param const Eigen::Vector2d& Horizontal position of the patch center
+ * @param double Yaw of the patch
+ * @param double Size of the patch
+ * @param double Resolution of the grid of the patch
+ * @param double Resolution of the heights
+ * @return The hash of the patch
+ */
+uint64_t computeTerrainHash(const environment::TerrainMap& terrain,
+							const Eigen::Vector2d& position,
+							double yaw,
+							double patch_size,
+							double grid_resolution,
+							double height_resolution);
+
+/**
+ * @brief Aligns a whole-body trajectory to a whole-body state, i.e. it's moved in the
+ * horizontal plane (position and yaw) and in time so its first state has the horizontal pose
+ * and time of the given state. The contact quantities are expressed in the base frame, so they
+ * aren't changed
+ * @param WholeBodyTrajectory& Whole-body trajectory
+ * @param const WholeBodyState& Whole-body state
+ */
+void alignTrajectory(WholeBodyTrajectory& trajectory,
+					 const WholeBodyState& state);
+
+/**
+ * @class MotionLibrary
+ * @brief Library of solved motions (e.g. whole-body trajectories or preview controls) of
+ * repeated planning problems, such as standard gaits or stair steps. The motions are stored
+ * with the descriptors of their problems, and the nearest one of a new problem warm-starts its
+ * optimization (e.g. WholeBodyTrajectoryOptimization::setNominalTrajectory or
+ * ocp::PreviewOptimization::setStartingPreviewControl). The motions of a different terrain
+ * patch aren't retrieved, and the distance between descriptors is the weighted Euclidean
+ * distance of their state features and commands. The library has a maximum number of motions,
+ * where the least recently used motion is removed first
+ */
+template<typename TMotion>
+class MotionLibrary
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param unsigned int Maximum number of motions (0 for unbounded)
+		 */
+		MotionLibrary(unsigned int capacity = 0);
+
+		/** @brief Destructor function */
+		~MotionLibrary();
+
+		/**
+		 * @brief Sets the weights of the distance between descriptors. The default values are 1
+		 * @param double Weight of the state features
+		 * @param double Weight of the commands
+		 */
+		void setWeights(double state_weight,
+						double command_weight);
+
+		/**
+		 * @brief Sets the maximum distance of a retrieved motion, i.e. a farther motion isn't a
+		 * good warm start. The default value is unbounded
+		 * @param double Maximum distance
+		 */
+		void setMaximumDistance(double distance);
+
+		/**
+		 * @brief Sets the minimum distance between motions, i.e. a motion closer to a stored
+		 * one replaces it. The default value is zero, i.e. only equal descriptors are replaced
+		 * @param double Minimum distance
+		 */
+		void setMinimumSpacing(double spacing);
+
+		/**
+		 * @brief Adds a solved motion of a problem
+		 * @param const MotionDescriptor& Descriptor of the problem
+		 * @param const TMotion& Solved motion
+		 */
+		void add(const MotionDescriptor& descriptor,
+				 const TMotion& motion);
+
+		/**
+		 * @brief Retrieves the nearest motion of a problem, i.e. of the same terrain patch and
+		 * within the maximum distance
+		 * @param TMotion& Retrieved motion
+		 * @param const MotionDescriptor& Descriptor of the problem
+		 * @param double* Distance of the retrieved motion
+		 * @return False if there isn't a near motion
+		 */
+		bool lookup(TMotion& motion,
+					const MotionDescriptor& descriptor,
+					double* distance = NULL);
+
+		/** @brief Removes all the motions */
+		void clear();
+
+		/** @brief Gets the number of stored motions */
+		unsigned int size() const;
+
+		/** @brief Gets the number of successful and failed lookups */
+		unsigned int getNumberOfHits() const;
+		unsigned int getNumberOfMisses() const;
+
+
+	private:
+		/** @brief Stored motion, and the last time (i.e. counter) it was used */
+		struct Entry
+		{
+			MotionDescriptor descriptor;
+			TMotion motion;
+			uint64_t last_use;
+		};
+		typedef std::vector<Entry> EntryList;
+
+		/**
+		 * @brief Finds the nearest motion of a descriptor in the motions of its terrain patch
+		 * @param double& Distance of the nearest motion
+		 * @param const MotionDescriptor& Descriptor of the problem
+		 * @return Pointer of the nearest entry (NULL if there isn't any)
+		 */
+		Entry* findNearest(double& distance,
+						   const MotionDescriptor& descriptor);
+
+		/**
+		 * @brief Computes the distance between descriptors of the same terrain patch
+		 * @param const MotionDescriptor& First descriptor
+		 * @param const MotionDescriptor& Second descriptor
+		 * @return The distance (infinite if the dimensions are different)
+		 */
+		double computeDistance(const MotionDescriptor& descriptor1,
+							   const MotionDescriptor& descriptor2) const;
+
+		/** @brief Removes the least recently used motion */
+		void removeLeastRecentlyUsed();
+
+		/** @brief Stored motions per terrain hash */
+		std::unordered_map<uint64_t, EntryList> entries_;
+
+		/** @brief Number of stored motions and the maximum one */
+		unsigned int num_motions_;
+		unsigned int capacity_;
+
+		/** @brief Weights of the distance */
+		double state_weight_;
+		double command_weight_;
+
+		/** @brief Maximum distance of the retrieved motions and minimum distance of the stored
+		 * ones */
+		double max_distance_;
+		double min_spacing_;
+
+		/** @brief Counter of the uses of the motions */
+		uint64_t use_counter_;
+
+		/** @brief Number of successful and failed lookups */
+		unsigned int num_hits_;
+		unsigned int num_misses_;
+};
+
+} //@namespace locomotion
+} //@namespace dwl
+
+#include <dwl/locomotion/impl/MotionLibrary.hpp>
+
+#endif
@@ -1,4 +1,6 @@
 #include <dwl/locomotion/MotionPlanning.h>
+#include <dwl/utils/Orientation.h>
+#include <climits>
 
 
 namespace dwl
@@ -9,7 +11,9 @@ namespace locomotion
 
 MotionPlanning::MotionPlanning() : terrain_(NULL), robot_(NULL), path_solver_(NULL),
 		pose_solver_(NULL), path_computation_time_(std::numeric_limits<double>::max()),
-		pose_computation_time_(std::numeric_limits<double>::max())
+		pose_computation_time_(std::numeric_limits<double>::max()), path_smoothing_(false),
+		smoothing_cost_tolerance_(0.), state_window_size_(Eigen::Vector2d::Zero()),
+		num_window_vertices_(0)
 {
 
 }
@@ -44,6 +48,7 @@ void MotionPlanning::reset(solver::SearchTreeSolver* solver)
 			solver->getName().c_str(), name_.c_str());
 	path_solver_ = solver;
 	path_solver_->init();
+	connectPathCallback();
 }
 
 
@@ -62,5 +67,184 @@ void MotionPlanning::setComputationTime(double computation_time,
 	}
 }
 
+
+void MotionPlanning::setPathCallback(const PathCallback& callback)
+{
+	path_callback_ = callback;
+	connectPathCallback();
+}
+
+
+void MotionPlanning::setPathSmoothing(bool enable,
+									  double cost_tolerance)
+{
+	path_smoothing_ = enable;
+	smoothing_cost_tolerance_ = cost_tolerance;
+}
+
+
+void MotionPlanning::setStateWindow(const Eigen::Vector2d& size)
+{
+	state_window_size_ = size;
+	if (size.isZero() && terrain_ != NULL) {
+		terrain_->removeStateWindow();
+		num_window_vertices_ = 0;
+		if (path_solver_ != NULL)
+			path_solver_->setIndexedHeap(true);
+	}
+}
+
+
+std::shared_ptr<const environment::CostToGoField> MotionPlanning::getCostToGoField() const
+{
+	if (path_solver_ == NULL || path_solver_->getAdjacencyModel() == NULL)
+		return std::shared_ptr<const environment::CostToGoField>();
+
+	return path_solver_->getAdjacencyModel()->getCostToGoField();
+}
+
+
+void MotionPlanning::centerStateWindow(const Eigen::Vector2d& center)
+{
+	if (state_window_size_.isZero())
+		return;
+
+	terrain_->setStateWindow(center, state_window_size_);
+	Vertex num_vertices = terrain_->getTerrainSpaceModel().getNumberOfWindowVertices(XY_Y);
+	if (num_vertices != num_window_vertices_) {
+		path_solver_->setIndexedHeap(true, num_vertices);
+		num_window_vertices_ = num_vertices;
+	}
+}
+
+
+void MotionPlanning::getBodyPath(std::vector<Pose>& path,
+								 Vertex start_vertex,
+								 Vertex goal_vertex,
+								 double height)
+{
+	path_solver_->getShortestPath(vertex_path_, start_vertex, goal_vertex);
+	convertPath(path, vertex_path_, height);
+	if (path_smoothing_)
+		smoothPath(path);
+}
+
+
+void MotionPlanning::convertPath(std::vector<Pose>& path,
+								 const std::list<Vertex>& vertex_path,
+								 double height)
+{
+	path.clear();
+	path.reserve(vertex_path.size());
+	for (std::list<Vertex>::const_iterator vertex_it = vertex_path.begin();
+			vertex_it != vertex_path.end(); vertex_it++) {
+		Eigen::Vector3d state;
+		terrain_->getTerrainSpaceModel().vertexToState(state, *vertex_it);
+
+		Pose pose;
+		pose.position << state(0), state(1), height;
+		pose.orientation = math::getQuaternion(Eigen::Vector3d(0., 0., state(2)));
+		path.push_back(pose);
+	}
+}
+
+
+void MotionPlanning::convertPath(std::vector<Pose>& path,
+								 const std::vector<Vertex>& vertex_path,
+								 double height)
+{
+	path.resize(vertex_path.size());
+	for (unsigned int k = 0; k < vertex_path.size(); k++) {
+		Eigen::Vector3d state;
+		terrain_->getTerrainSpaceModel().vertexToState(state, vertex_path[k]);
+
+		path[k].position << state(0), state(1), height;
+		path[k].orientation = math::getQuaternion(Eigen::Vector3d(0., 0., state(2)));
+	}
+}
+
+
+void MotionPlanning::smoothPath(std::vector<Pose>& path)
+{
+	if (path.size() < 3)
+		return;
+
+	// Extending the segment of every kept waypoint up to the farthest waypoint in
+	// line-of-sight, where the kept waypoints are moved to the front of the path
+	unsigned int num_kept = 1;
+	unsigned int anchor = 0;
+	while (anchor < path.size() - 1) {
+		Weight max_cost = 0., cost;
+		terrain_->getTerrainCost(max_cost, (Eigen::Vector2d) path[anchor].position.head<2>());
+		unsigned int next = anchor + 1;
+		if (terrain_->getTerrainCost(cost, (Eigen::Vector2d) path[next].position.head<2>()))
+			max_cost = std::max(max_cost, cost);
+		while (next + 1 < path.size()) {
+			if (terrain_->getTerrainCost(cost, (Eigen::Vector2d) path[next + 1].position.head<2>()))
+				max_cost = std::max(max_cost, cost);
+			if (!isLineOfSight(path[anchor], path[next + 1], max_cost + smoothing_cost_tolerance_))
+				break;
+			++next;
+		}
+
+		path[num_kept++] = path[next];
+		anchor = next;
+	}
+	path.resize(num_kept);
+}
+
+
+bool MotionPlanning::isLineOfSight(const Pose& initial_pose,
+								   const Pose& final_pose,
+								   double max_cost)
+{
+	Eigen::Vector2d initial_pos = initial_pose.position.head<2>();
+	Eigen::Vector2d segment = final_pose.position.head<2>() - initial_pos;
+	double resolution = terrain_->getResolution(true);
+	unsigned int num_samples = ceil(segment.norm() / resolution);
+
+	const environment::SpaceDiscretization& obstacle_space = terrain_->getObstacleSpaceModel();
+	bool obstacle_information = terrain_->isObstacleInformation();
+	for (unsigned int k = 1; k < num_samples; k++) {
+		Eigen::Vector2d position = initial_pos + segment * ((double) k / num_samples);
+
+		// Checking the terrain cost of the cell
+		Weight cost;
+		if (!terrain_->getTerrainCost(cost, position) || cost > max_cost)
+			return false;
+
+		// Checking the obstacles of the cell in all the layers
+		Key key;
+		if (obstacle_information &&
+				obstacle_space.coordToKeyChecked(key.x, position(0), true) &&
+				obstacle_space.coordToKeyChecked(key.y, position(1), true) &&
+				terrain_->getObstacleGrid().isAnyOccupied(Key(key.x, key.y, 0),
+														  Key(key.x, key.y, USHRT_MAX)))
+			return false;
+	}
+
+	return true;
+}
+
+
+void MotionPlanning::connectPathCallback()
+{
+	if (path_solver_ == NULL)
+		return;
+
+	if (!path_callback_) {
+		path_solver_->setSolutionCallback(solver::SearchTreeSolver::SolutionCallback());
+		return;
+	}
+
+	path_solver_->setSolutionCallback([this](const std::list<Vertex>& vertex_path, double cost) {
+		std::vector<Pose> path;
+		convertPath(path, vertex_path, robot_->getCurrentPose().position(2));
+		if (path_smoothing_)
+			smoothPath(path);
+		path_callback_(path);
+	});
+}
+
 } //@namespace locomotion
 } //@namespace dwl
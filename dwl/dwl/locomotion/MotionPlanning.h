@@ -21,6 +21,9 @@ namespace locomotion
 class MotionPlanning
 {
 	public:
+		/** @brief Function that receives the improved body paths */
+		typedef std::function<void(const std::vector<Pose>&)> PathCallback;
+
 		/** @brief Constructor function */
 		MotionPlanning();
 
@@ -59,8 +62,100 @@ class MotionPlanning
 		void setComputationTime(double computation_time,
 								bool path_solver);
 
+		/**
+		 * @brief Sets the function that receives every improved body path of the path solver as
+		 * soon as it's found, i.e. before computePath returns. The vertices of the path are
+		 * converted to poses at the height of the current pose of the robot. Note that it's
+		 * called from the thread that computes the path
+		 * @param const PathCallback& Path callback (an empty function disables it)
+		 */
+		void setPathCallback(const PathCallback& callback);
+
+		/**
+		 * @brief Enables/disables the shortcut smoothing of the body paths. A waypoint is
+		 * removed if the straight segment between its neighbors is in line-of-sight, i.e. its
+		 * cells have terrain information, they aren't obstacles, and their cost isn't bigger
+		 * than the maximum cost of the replaced waypoints plus a tolerance. So the contact
+		 * planner gets fewer and straighter waypoints
+		 * @param bool True for enabling the smoothing
+		 * @param double Tolerance of the terrain cost
+		 */
+		void setPathSmoothing(bool enable,
+							  double cost_tolerance = 0.);
+
+		/**
+		 * @brief Sets the size of the state window of the path searches, which is centered at
+		 * the start pose (see centerStateWindow). The states inside it are stored in the flat
+		 * arrays of the path solver, and a zero size removes the window
+		 * @param const Eigen::Vector2d& Size of the window, in meters
+		 */
+		void setStateWindow(const Eigen::Vector2d& size);
+
+		/**
+		 * @brief Gets the cost-to-go field of the backward heuristic of the path solver (see
+		 * model::AdjacencyModel::setBackwardHeuristic), which is computed once per goal
+		 * @return The cost-to-go field, or NULL if it wasn't computed
+		 */
+		std::shared_ptr<const environment::CostToGoField> getCostToGoField() const;
+
 
 	protected:
+		/**
+		 * @brief Gets the shortest path of the path solver as poses, which is smoothed if it's
+		 * enabled (see setPathSmoothing)
+		 * @param std::vector<Pose>& Path of poses
+		 * @param Vertex Start vertex
+		 * @param Vertex Goal vertex
+		 * @param double Height of the poses
+		 */
+		void getBodyPath(std::vector<Pose>& path,
+						 Vertex start_vertex,
+						 Vertex goal_vertex,
+						 double height);
+
+		/**
+		 * @brief Converts a path of state vertices (x,y,yaw) to a path of poses
+		 * @param std::vector<Pose>& Path of poses
+		 * @param const std::list<Vertex>& Path of state vertices
+		 * @param double Height of the poses
+		 */
+		void convertPath(std::vector<Pose>& path,
+						 const std::list<Vertex>& vertex_path,
+						 double height);
+		void convertPath(std::vector<Pose>& path,
+						 const std::vector<Vertex>& vertex_path,
+						 double height);
+
+		/**
+		 * @brief Removes the waypoints of a path that can be shortcut (see setPathSmoothing).
+		 * The first and last poses are kept
+		 * @param std::vector<Pose>& Path of poses
+		 */
+		void smoothPath(std::vector<Pose>& path);
+
+		/**
+		 * @brief Indicates if the segment between two poses is in line-of-sight, by sampling
+		 * it at the terrain resolution
+		 * @param const Pose& Initial pose of the segment
+		 * @param const Pose& Final pose of the segment
+		 * @param double Maximum terrain cost of the segment cells
+		 * @return True if the segment is in line-of-sight
+		 */
+		bool isLineOfSight(const Pose& initial_pose,
+						   const Pose& final_pose,
+						   double max_cost);
+
+		/**
+		 * @brief Centers the state window at a position, and allocates the flat arrays of the
+		 * path solver if the number of window states changed. It has to be called before
+		 * computing the start and goal vertices
+		 * @param const Eigen::Vector2d& Center of the window (e.g. the start position)
+		 */
+		void centerStateWindow(const Eigen::Vector2d& center);
+
+		/** @brief Connects the path callback to the solution callback of the path solver */
+		void connectPathCallback();
+
 		/** @brief Name of the motion planner */
 		std::string name_;
 
@@ -81,6 +176,20 @@ class MotionPlanning
 
 		/** @brief Computation time for the pose solver */
 		double pose_computation_time_;
+
+		/** @brief Function that receives the improved body paths */
+		PathCallback path_callback_;
+
+		/** @brief Path of state vertices, which is reused between computations */
+		std::vector<Vertex> vertex_path_;
+
+		/** @brief Indicates if the body paths are smoothed, and its cost tolerance */
+		bool path_smoothing_;
+		double smoothing_cost_tolerance_;
+
+		/** @brief Size of the state window, and its number of states in the path solver */
+		Eigen::Vector2d state_window_size_;
+		Vertex num_window_vertices_;
 };
 
 } //@namespace locomotion
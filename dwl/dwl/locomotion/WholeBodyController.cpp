@@ -0,0 +1,306 @@
+#include <dwl/locomotion/WholeBodyController.h>
+#include <dwl/utils/Geometry.h>
+#include <limits>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+WholeBodyController::WholeBodyController() : dynamics_(NULL), optimizer_(NULL),
+		num_dof_(0), base_dof_(0), num_joints_(0), num_feet_(0), num_vars_(0),
+		num_constraints_(0), joint_stiffness_(0.), joint_damping_(0.), base_weight_(1.),
+		joint_weight_(0.1), force_weight_(1e-4), friction_coeff_(0.7), force_threshold_(0.)
+{
+	base_stiffness_.setZero();
+	base_damping_.setZero();
+	base_acc_.setZero();
+}
+
+
+WholeBodyController::~WholeBodyController()
+{
+
+}
+
+
+void WholeBodyController::reset(model::WholeBodyDynamics* dynamics,
+								solver::QuadraticProgram* optimizer)
+{
+	dynamics_ = NULL;
+	optimizer_ = optimizer;
+
+	// Getting the dimensions of the system, where all the feet have force variables
+	model::FloatingBaseSystem& system = dynamics->getFloatingBaseSystem();
+	if (!system.isFullyFloatingBase()) {
+		printf(RED "Error: the whole-body controller requires a fully floating-base"
+				" system\n" COLOR_RESET);
+		return;
+	}
+	dynamics_ = dynamics;
+	num_dof_ = system.getSystemDoF();
+	num_joints_ = system.getJointDoF();
+	base_dof_ = num_dof_ - num_joints_;
+	feet_ = system.getEndEffectorNames(model::FOOT);
+	num_feet_ = feet_.size();
+	no_forces_.reset(system.getEndEffectorNames());
+
+	// Getting the joint torque limits, where the undefined ones are unbounded
+	effort_limits_ = Eigen::VectorXd::Constant(num_joints_, std::numeric_limits<double>::max());
+	const urdf_model::JointLimits& limits = system.getJointLimits();
+	for (urdf_model::JointLimits::const_iterator it = limits.begin(); it != limits.end(); it++) {
+		double effort = system.getEffortLimit(it->second);
+		if (effort > 0.)
+			effort_limits_(system.getJointId(it->first)) = effort;
+	}
+
+	// Sizing the QP, i.e. the floating-base dynamics, contact, friction and torque rows
+	num_vars_ = num_dof_ + 3 * num_feet_;
+	num_constraints_ = base_dof_ + 3 * num_feet_ + 4 * num_feet_ + num_joints_;
+	hessian_.setZero(num_vars_, num_vars_);
+	gradient_.setZero(num_vars_);
+	constraint_mat_.setZero(num_constraints_, num_vars_);
+	lower_bound_.setZero(num_vars_);
+	upper_bound_.setZero(num_vars_);
+	lower_constraint_.setZero(num_constraints_);
+	upper_constraint_.setZero(num_constraints_);
+	contact_jac_.setZero(3 * num_feet_, num_dof_);
+	jacd_qd_.setZero(3 * num_feet_);
+	base_nonlinear_.setZero();
+	joint_nonlinear_.setZero(num_joints_);
+	zero_joint_acc_.setZero(num_joints_);
+	base_acc_.setZero();
+	joint_acc_.setZero(num_joints_);
+	joint_forces_.setZero(num_joints_);
+	contact_forces_.setZero(3 * num_feet_);
+	updateHessian();
+
+	// The friction pyramids only depend on the friction coefficient, i.e. their rows are
+	// constant
+	unsigned int friction_row = base_dof_ + 3 * num_feet_;
+	for (unsigned int k = 0; k < num_feet_; k++) {
+		unsigned int col = num_dof_ + 3 * k;
+		for (unsigned int i = 0; i < 2; i++) {
+			unsigned int row = friction_row + 4 * k + 2 * i;
+			constraint_mat_(row, col + i) = 1.;
+			constraint_mat_(row, col + rbd::Z) = -friction_coeff_;
+			constraint_mat_(row + 1, col + i) = -1.;
+			constraint_mat_(row + 1, col + rbd::Z) = -friction_coeff_;
+		}
+	}
+
+	optimizer_->init(num_vars_, num_constraints_);
+	optimizer_->reset();
+}
+
+
+void WholeBodyController::setBaseGains(const rbd::Vector6d& stiffness,
+									   const rbd::Vector6d& damping)
+{
+	base_stiffness_ = stiffness;
+	base_damping_ = damping;
+}
+
+
+void WholeBodyController::setJointGains(double stiffness,
+										double damping)
+{
+	joint_stiffness_ = stiffness;
+	joint_damping_ = damping;
+}
+
+
+void WholeBodyController::setTaskWeights(double base_weight,
+										 double joint_weight,
+										 double force_weight)
+{
+	base_weight_ = base_weight;
+	joint_weight_ = joint_weight;
+	force_weight_ = force_weight;
+	updateHessian();
+}
+
+
+void WholeBodyController::setContactProperties(double friction_coeff,
+											   double force_threshold)
+{
+	friction_coeff_ = friction_coeff;
+	force_threshold_ = force_threshold;
+
+	// Updating the friction pyramids
+	if (dynamics_ != NULL) {
+		unsigned int friction_row = base_dof_ + 3 * num_feet_;
+		for (unsigned int k = 0; k < 4 * num_feet_; k++)
+			constraint_mat_(friction_row + k, num_dof_ + 3 * (k / 4) + rbd::Z) = -friction_coeff_;
+	}
+}
+
+
+bool WholeBodyController::compute(const WholeBodyState& actual,
+								  const WholeBodyState& desired)
+{
+	if (dynamics_ == NULL || optimizer_ == NULL) {
+		printf(RED "Error: the whole-body controller has to be reset before computing\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	buildProblem(actual, desired);
+
+	// Hotstarting the QP from the active set of the last tick, where a failed tick is
+	// discarded so the next one starts from scratch
+	if (!optimizer_->hotstart(hessian_, gradient_, constraint_mat_,
+							  lower_bound_, upper_bound_,
+							  lower_constraint_, upper_constraint_, 0.)) {
+		optimizer_->reset();
+		return false;
+	}
+
+	// Recovering the joint torques from the joint rows of the equation of motion, i.e.
+	// tau = M_j qdd + h_j - J_j^T f
+	const Eigen::VectorXd& solution = optimizer_->getOptimalSolution();
+	base_acc_ = solution.head<6>();
+	joint_acc_ = solution.segment(base_dof_, num_joints_);
+	contact_forces_ = solution.tail(3 * num_feet_);
+	unsigned int torque_row = base_dof_ + 7 * num_feet_;
+	joint_forces_.noalias() = constraint_mat_.middleRows(torque_row, num_joints_) * solution;
+	joint_forces_ += joint_nonlinear_;
+
+	return true;
+}
+
+
+const Eigen::VectorXd& WholeBodyController::getJointForces() const
+{
+	return joint_forces_;
+}
+
+
+const rbd::Vector6d& WholeBodyController::getBaseAcceleration() const
+{
+	return base_acc_;
+}
+
+
+const Eigen::VectorXd& WholeBodyController::getJointAcceleration() const
+{
+	return joint_acc_;
+}
+
+
+const Eigen::VectorXd& WholeBodyController::getContactForces() const
+{
+	return contact_forces_;
+}
+
+
+void WholeBodyController::buildProblem(const WholeBodyState& actual,
+									   const WholeBodyState& desired)
+{
+	// Computing the joint-space inertia matrix and the nonlinear effects (Coriolis,
+	// centrifugal and gravity) at zero acceleration. Note that both invalidate the kinematics
+	const Eigen::MatrixXd& inertia_mat =
+			dynamics_->computeJointSpaceInertiaMatrix(actual.base_pos, actual.joint_pos);
+	dynamics_->computeInverseDynamics(base_nonlinear_, joint_nonlinear_,
+									  actual.base_pos, actual.joint_pos,
+									  actual.base_vel, actual.joint_vel,
+									  rbd::Vector6d::Zero(), zero_joint_acc_,
+									  no_forces_);
+
+	// Computing the contact jacobian and J_d*q_d of all the feet in a single kinematics
+	// update, which stays as the kinematics snapshot of the actual state
+	dynamics_->getWholeBodyKinematics().computeContactJacobian(contact_jac_, jacd_qd_,
+															   actual.base_pos,
+															   actual.joint_pos,
+															   actual.base_vel,
+															   actual.joint_vel,
+															   feet_);
+
+	// Floating-base dynamics, i.e. M_b qdd - J_b^T f = -h_b
+	unsigned int force_col = num_dof_;
+	constraint_mat_.topLeftCorner(base_dof_, num_dof_) = inertia_mat.topRows(base_dof_);
+	constraint_mat_.block(0, force_col, base_dof_, 3 * num_feet_) =
+			-contact_jac_.leftCols(base_dof_).transpose();
+	lower_constraint_.head(base_dof_) = -base_nonlinear_;
+	upper_constraint_.head(base_dof_) = lower_constraint_.head(base_dof_);
+
+	// Joint torques, i.e. M_j qdd - J_j^T f within the limits minus h_j
+	unsigned int torque_row = base_dof_ + 7 * num_feet_;
+	constraint_mat_.block(torque_row, 0, num_joints_, num_dof_) =
+			inertia_mat.bottomRows(num_joints_);
+	constraint_mat_.block(torque_row, force_col, num_joints_, 3 * num_feet_) =
+			-contact_jac_.rightCols(num_joints_).transpose();
+	for (unsigned int j = 0; j < num_joints_; j++) {
+		double limit = effort_limits_(j);
+		bool bounded = limit < std::numeric_limits<double>::max();
+		lower_constraint_(torque_row + j) = bounded ? -limit - joint_nonlinear_(j) : -limit;
+		upper_constraint_(torque_row + j) = bounded ? limit - joint_nonlinear_(j) : limit;
+	}
+
+	// Contact constraints and force bounds, where the swing feet have zero forces and
+	// released contact rows. Note that the contact rows are kept, so the QP dimensions don't
+	// change with the active contacts
+	const double inf = std::numeric_limits<double>::max();
+	lower_bound_.head(num_dof_).setConstant(-inf);
+	upper_bound_.head(num_dof_).setConstant(inf);
+	unsigned int friction_row = base_dof_ + 3 * num_feet_;
+	Eigen::Vector3d force_ref;
+	for (unsigned int k = 0; k < num_feet_; k++) {
+		const std::string& name = feet_[k];
+		unsigned int row = base_dof_ + 3 * k;
+		unsigned int col = force_col + 3 * k;
+		constraint_mat_.block(row, 0, 3, num_dof_) = contact_jac_.middleRows<3>(3 * k);
+		if (desired.getContactCondition(name, force_threshold_)) {
+			lower_constraint_.segment<3>(row) = -jacd_qd_.segment<3>(3 * k);
+			upper_constraint_.segment<3>(row) = -jacd_qd_.segment<3>(3 * k);
+			lower_bound_.segment<3>(col) << -inf, -inf, 0.;
+			upper_bound_.segment<3>(col).setConstant(inf);
+
+			// Tracking the planned contact force, which is expressed in the base frame
+			force_ref = desired.getBaseToWorldRotation() *
+					desired.contact_eff.find(name)->second.tail<3>();
+		} else {
+			lower_constraint_.segment<3>(row).setConstant(-inf);
+			upper_constraint_.segment<3>(row).setConstant(inf);
+			lower_bound_.segment<3>(col).setZero();
+			upper_bound_.segment<3>(col).setZero();
+			force_ref.setZero();
+		}
+		lower_constraint_.segment<4>(friction_row + 4 * k).setConstant(-inf);
+		upper_constraint_.segment<4>(friction_row + 4 * k).setZero();
+		gradient_.segment<3>(col) = -force_weight_ * force_ref;
+	}
+
+	// Base task with PD feedback, where the angular error is the RPY one
+	rbd::Vector6d base_error = desired.base_pos - actual.base_pos;
+	for (unsigned int i = rbd::AX; i <= rbd::AZ; i++)
+		math::normalizeAngle(base_error(i), MinusPiToPi);
+	rbd::Vector6d base_ref = desired.base_acc +
+			base_stiffness_.cwiseProduct(base_error) +
+			base_damping_.cwiseProduct(desired.base_vel - actual.base_vel);
+	gradient_.head(base_dof_) = -base_weight_ * base_ref;
+
+	// Joint task with PD feedback
+	gradient_.segment(base_dof_, num_joints_) = -joint_weight_ *
+			(desired.joint_acc +
+			 joint_stiffness_ * (desired.joint_pos - actual.joint_pos) +
+			 joint_damping_ * (desired.joint_vel - actual.joint_vel));
+}
+
+
+void WholeBodyController::updateHessian()
+{
+	// The tasks are weighted least squares of the decision variables, so the Hessian is
+	// diagonal and constant
+	if (num_vars_ == 0)
+		return;
+
+	hessian_.diagonal().head(base_dof_).setConstant(base_weight_);
+	hessian_.diagonal().segment(base_dof_, num_joints_).setConstant(joint_weight_);
+	hessian_.diagonal().tail(3 * num_feet_).setConstant(force_weight_);
+}
+
+} //@namespace locomotion
+} //@namespace dwl
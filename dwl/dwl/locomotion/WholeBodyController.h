@@ -0,0 +1,191 @@
+#ifndef DWL__LOCOMOTION__WHOLE_BODY_CONTROLLER__H
+#define DWL__LOCOMOTION__WHOLE_BODY_CONTROLLER__H
+
+#include <dwl/model/WholeBodyDynamics.h>
+#include <dwl/solver/QuadraticProgram.h>
+#include <dwl/WholeBodyState.h>
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+/**
+ * @class WholeBodyController
+ * @brief Task-space inverse dynamics controller that tracks whole-body plans (e.g. the
+ * WholeBodyTrajectory of WholeBodyTrajectoryOptimization) at the control rate. Every control
+ * tick solves a QP in the reduced decision space x = [qdd; f], i.e. the generalized
+ * accelerations and the linear forces of all the feet (world frame), where the joint torques
+ * are eliminated with the joint rows of the equation of motion and recovered after the
+ * solution, i.e. tau = M_j qdd + h_j - J_j^T f. The cost tracks the desired base and joint
+ * accelerations (with PD feedback of the actual state) and the planned contact forces, and the
+ * constraints are:
+ * <ul>
+ *    <li>the floating-base dynamics, M_b qdd + h_b = J_b^T f</li>
+ *    <li>the static contacts, J_c qdd + Jd_c qd = 0</li>
+ *    <li>the linearized friction pyramids and the unilateral normal forces</li>
+ *    <li>the joint torque limits (the effort limits of the URDF)</li>
+ * </ul>
+ * The QP has the same dimensions for any set of active contacts, i.e. the forces of the swing
+ * feet are bounded to zero and their contact constraints are released. So, the QP is
+ * hotstarted in every tick (e.g. the active set of qpOASES is reused), and the matrices are
+ * preallocated when the controller is reset. The model computations are done with the
+ * dynamics and kinematics of the given WholeBodyDynamics, so they share its kinematics
+ * snapshot (see model::KinematicsCache), and the kinematics stays updated with the actual
+ * state after a computation, i.e. the host can query it without traversing the tree again.
+ * Note that the contact normals are aligned with the z-axis of the world frame, and the base
+ * orientation error is the difference of the RPY angles
+ */
+class WholeBodyController
+{
+	public:
+		/** @brief Constructor function */
+		WholeBodyController();
+
+		/** @brief Destructor function */
+		~WholeBodyController();
+
+		/**
+		 * @brief Resets the controller, i.e. it sizes the QP and its matrices for the feet of
+		 * the floating-base system, which has to be fully floating
+		 * @param model::WholeBodyDynamics* Whole-body dynamics, which is shared with the host
+		 * @param solver::QuadraticProgram* QP solver (e.g. solver::qpOASES)
+		 */
+		void reset(model::WholeBodyDynamics* dynamics,
+				   solver::QuadraticProgram* optimizer);
+
+		/**
+		 * @brief Sets the PD gains of the base task, where the angular errors are the RPY ones
+		 * @param const rbd::Vector6d& Stiffness gains
+		 * @param const rbd::Vector6d& Damping gains
+		 */
+		void setBaseGains(const rbd::Vector6d& stiffness,
+						  const rbd::Vector6d& damping);
+
+		/**
+		 * @brief Sets the PD gains of the joint task
+		 * @param double Stiffness gain
+		 * @param double Damping gain
+		 */
+		void setJointGains(double stiffness,
+						   double damping);
+
+		/**
+		 * @brief Sets the weights of the base, joint and contact force tasks. The default
+		 * values are 1, 0.1 and 1e-4
+		 * @param double Weight of the base acceleration task
+		 * @param double Weight of the joint acceleration task
+		 * @param double Weight of the contact force task
+		 */
+		void setTaskWeights(double base_weight,
+							double joint_weight,
+							double force_weight);
+
+		/**
+		 * @brief Sets the contact properties. The default values are 0.7 and 0 N
+		 * @param double Friction coefficient
+		 * @param double Force threshold of the active contacts of the desired state
+		 */
+		void setContactProperties(double friction_coeff,
+								  double force_threshold = 0.);
+
+		/**
+		 * @brief Computes the joint torques that track a desired whole-body state. The active
+		 * contacts are the ones of the desired state (see WholeBodyState::getContactCondition)
+		 * @param const WholeBodyState& Actual whole-body state
+		 * @param const WholeBodyState& Desired whole-body state (e.g. of the plan)
+		 * @return bool Label that indicates if the QP was solved
+		 */
+		bool compute(const WholeBodyState& actual,
+					 const WholeBodyState& desired);
+
+		/** @brief Gets the joint torques of the last computation */
+		const Eigen::VectorXd& getJointForces() const;
+
+		/** @brief Gets the base and joint accelerations of the last computation */
+		const rbd::Vector6d& getBaseAcceleration() const;
+		const Eigen::VectorXd& getJointAcceleration() const;
+
+		/**
+		 * @brief Gets the linear contact forces of the last computation (world frame), which
+		 * are stacked in the order of the foot names of the floating-base system
+		 */
+		const Eigen::VectorXd& getContactForces() const;
+
+
+	private:
+		/**
+		 * @brief Builds the QP matrices and vectors of a control tick
+		 * @param const WholeBodyState& Actual whole-body state
+		 * @param const WholeBodyState& Desired whole-body state
+		 */
+		void buildProblem(const WholeBodyState& actual,
+						  const WholeBodyState& desired);
+
+		/** @brief Sets the constant Hessian of the task weights */
+		void updateHessian();
+
+		/** @brief Whole-body dynamics and QP solver */
+		model::WholeBodyDynamics* dynamics_;
+		solver::QuadraticProgram* optimizer_;
+
+		/** @brief Feet of the floating-base system, and their (zero) external forces */
+		rbd::BodySelector feet_;
+		rbd::BodyContainer6d no_forces_;
+
+		/** @brief Dimensions of the system and of the QP */
+		unsigned int num_dof_;
+		unsigned int base_dof_;
+		unsigned int num_joints_;
+		unsigned int num_feet_;
+		unsigned int num_vars_;
+		unsigned int num_constraints_;
+
+		/** @brief PD gains of the tasks */
+		rbd::Vector6d base_stiffness_;
+		rbd::Vector6d base_damping_;
+		double joint_stiffness_;
+		double joint_damping_;
+
+		/** @brief Weights of the tasks */
+		double base_weight_;
+		double joint_weight_;
+		double force_weight_;
+
+		/** @brief Contact properties */
+		double friction_coeff_;
+		double force_threshold_;
+
+		/** @brief Joint torque limits */
+		Eigen::VectorXd effort_limits_;
+
+		/** @brief Preallocated model quantities, i.e. the contact jacobian, its J_d*q_d vector
+		 * and the nonlinear effects */
+		Eigen::MatrixXd contact_jac_;
+		Eigen::VectorXd jacd_qd_;
+		rbd::Vector6d base_nonlinear_;
+		Eigen::VectorXd joint_nonlinear_;
+		Eigen::VectorXd zero_joint_acc_;
+
+		/** @brief Preallocated QP matrices and vectors */
+		Eigen::MatrixXd hessian_;
+		Eigen::VectorXd gradient_;
+		Eigen::MatrixXd constraint_mat_;
+		Eigen::VectorXd lower_bound_;
+		Eigen::VectorXd upper_bound_;
+		Eigen::VectorXd lower_constraint_;
+		Eigen::VectorXd upper_constraint_;
+
+		/** @brief Solution of the last computation */
+		rbd::Vector6d base_acc_;
+		Eigen::VectorXd joint_acc_;
+		Eigen::VectorXd joint_forces_;
+		Eigen::VectorXd contact_forces_;
+};
+
+} //@namespace locomotion
+} //@namespace dwl
+
+#endif
@@ -1,4 +1,6 @@
 #include <dwl/locomotion/WholeBodyTrajectoryOptimization.h>
+#include <dwl/ocp/ComplementaryConstraint.h>
+#include <chrono>
 
 
 namespace dwl
@@ -7,7 +9,12 @@ namespace dwl
 namespace locomotion
 {
 
-WholeBodyTrajectoryOptimization::WholeBodyTrajectoryOptimization() : solver_(NULL)
+WholeBodyTrajectoryOptimization::WholeBodyTrajectoryOptimization() : solver_(NULL),
+		warm_start_(false), max_refinements_(0), refinement_tolerance_(0.),
+		refinement_min_duration_(0.), num_refinements_(0), global_interpolation_(false),
+		with_sensitivity_(false),
+		is_uniform_coarse_mesh_(true),
+		latest_request_(0), num_pending_(0), snapshot_recorder_(NULL)
 {
 
 }
@@ -15,7 +22,9 @@ WholeBodyTrajectoryOptimization::WholeBodyTrajectoryOptimization() : solver_(NUL
 
 WholeBodyTrajectoryOptimization::~WholeBodyTrajectoryOptimization()
 {
-
+	// The pending requests use this optimizer, so they are cancelled and waited for
+	cancel();
+	waitAsync();
 }
 
 void WholeBodyTrajectoryOptimization::init(solver::OptimizationSolver* solver,
@@ -69,12 +78,16 @@ void WholeBodyTrajectoryOptimization::removeCost(std::string name)
 
 void WholeBodyTrajectoryOptimization::setHorizon(unsigned int horizon)
 {
+	// The new horizon defines the coarse mesh
+	coarse_knot_durations_.clear();
+	coarse_solution_.resize(0);
 	oc_model_.setHorizon(horizon);
 }
 
 
 void WholeBodyTrajectoryOptimization::setStepIntegrationTime(const double& step_time)
 {
+	restoreCoarseMesh();
 	oc_model_.getDynamicalSystem()->setStepIntegrationTime(step_time);
 }
 
@@ -85,10 +98,189 @@ void WholeBodyTrajectoryOptimization::setNominalTrajectory(std::vector<WholeBody
 }
 
 
+void WholeBodyTrajectoryOptimization::setWarmStart(bool warm_start)
+{
+	warm_start_ = warm_start;
+}
+
+
+void WholeBodyTrajectoryOptimization::setProblemTemplate(bool enable)
+{
+	oc_model_.setProblemTemplate(enable);
+}
+
+
+void WholeBodyTrajectoryOptimization::setMeshRefinement(unsigned int max_refinements,
+														double tolerance,
+														double min_duration)
+{
+	if (tolerance <= 0. && max_refinements != 0) {
+		printf(YELLOW "Warning: the tolerance of the mesh refinement has to be positive, so"
+				" it is disabled\n" COLOR_RESET);
+		max_refinements = 0;
+	}
+
+	restoreCoarseMesh();
+	max_refinements_ = max_refinements;
+	refinement_tolerance_ = tolerance;
+	refinement_min_duration_ = min_duration;
+}
+
+
+unsigned int WholeBodyTrajectoryOptimization::getNumberOfRefinements() const
+{
+	return num_refinements_;
+}
+
+
+void WholeBodyTrajectoryOptimization::setGlobalInterpolation(bool enable)
+{
+	global_interpolation_ = enable;
+}
+
+
+void WholeBodyTrajectoryOptimization::setSensitivity(bool enable)
+{
+	with_sensitivity_ = enable;
+	if (!enable)
+		sensitivity_.reset();
+}
+
+
+bool WholeBodyTrajectoryOptimization::predictSolution(Eigen::VectorXd& solution,
+													  const WholeBodyState& current_state)
+{
+	return sensitivity_.predict(solution, current_state);
+}
+
+
+const WholeBodyTrajectory&
+WholeBodyTrajectoryOptimization::getPredictedWholeBodyTrajectory(const WholeBodyState& current_state)
+{
+	Eigen::VectorXd solution;
+	if (!predictSolution(solution, current_state))
+		return getWholeBodyTrajectory();
+
+	oc_model_.getDynamicalSystem()->setInitialState(current_state);
+	return oc_model_.evaluateSolution(solution);
+}
+
+
 bool WholeBodyTrajectoryOptimization::compute(const WholeBodyState& current_state,
 											  const WholeBodyState& desired_state,
 											  double computation_time)
 {
+	return computeRequest(issueRequest(),
+						  current_state, desired_state,
+						  computation_time);
+}
+
+
+std::shared_future<bool>
+WholeBodyTrajectoryOptimization::computeAsync(const WholeBodyState& current_state,
+											  const WholeBodyState& desired_state,
+											  double computation_time,
+											  utils::WorkerPool* pool)
+{
+	if (pool == NULL)
+		pool = &utils::WorkerPool::getDefault();
+
+	// Queuing the request, which has copies of the states
+	uint64_t request = issueRequest();
+	std::shared_ptr<std::promise<bool> > promise = std::make_shared<std::promise<bool> >();
+	std::shared_future<bool> result = promise->get_future().share();
+	{
+		std::lock_guard<std::mutex> lock(request_mutex_);
+		num_pending_++;
+	}
+	pool->submit([this, promise, request, current_state, desired_state, computation_time] {
+		promise->set_value(computeRequest(request,
+										  current_state, desired_state,
+										  computation_time));
+
+		std::lock_guard<std::mutex> lock(request_mutex_);
+		num_pending_--;
+		request_condition_.notify_all();
+	});
+
+	return result;
+}
+
+
+void WholeBodyTrajectoryOptimization::cancel()
+{
+	issueRequest();
+}
+
+
+void WholeBodyTrajectoryOptimization::waitAsync()
+{
+	std::unique_lock<std::mutex> lock(request_mutex_);
+	request_condition_.wait(lock, [this] { return num_pending_ == 0; });
+}
+
+
+uint64_t WholeBodyTrajectoryOptimization::issueRequest()
+{
+	// Cancelling the running computation, which is an older request
+	std::lock_guard<std::mutex> lock(request_mutex_);
+	if (solver_ != NULL)
+		solver_->requestCancellation();
+
+	return ++latest_request_;
+}
+
+
+void WholeBodyTrajectoryOptimization::setSnapshotRecorder(SnapshotRecorder* recorder)
+{
+	std::lock_guard<std::mutex> compute_lock(compute_mutex_);
+	snapshot_recorder_ = recorder;
+}
+
+
+bool WholeBodyTrajectoryOptimization::replay(SnapshotDecoder& snapshot)
+{
+	WholeBodyState current_state, desired_state;
+	double computation_time = 0.;
+	bool with_starting_point = false;
+	Eigen::VectorXd starting_point;
+	snapshot.readState(current_state);
+	snapshot.readState(desired_state);
+	snapshot.readDouble(computation_time);
+	snapshot.readBool(with_starting_point);
+	if (with_starting_point)
+		snapshot.readVector(starting_point);
+	if (!snapshot.isValid()) {
+		printf(YELLOW "Warning: the snapshot of the whole-body trajectory optimization is"
+				" corrupted\n" COLOR_RESET);
+		return false;
+	}
+
+	return computeRequest(issueRequest(),
+						  current_state, desired_state,
+						  computation_time,
+						  with_starting_point ? &starting_point : NULL);
+}
+
+
+bool WholeBodyTrajectoryOptimization::computeRequest(uint64_t request,
+													 const WholeBodyState& current_state,
+													 const WholeBodyState& desired_state,
+													 double computation_time,
+													 const Eigen::VectorXd* starting_point)
+{
+	std::lock_guard<std::mutex> compute_lock(compute_mutex_);
+
+	// Skipping the superseded requests. Note that the cancellation is reset under the request
+	// lock, so a newer request always cancels this computation
+	{
+		std::lock_guard<std::mutex> lock(request_mutex_);
+		if (request != latest_request_)
+			return false;
+
+		solver_->resetCancellation();
+	}
+
 	// Setting the current state, terminal and the starting state for the optimization
 	oc_model_.getDynamicalSystem()->setInitialState(current_state);
 	oc_model_.getDynamicalSystem()->setTerminalState(desired_state);
@@ -98,7 +290,109 @@ bool WholeBodyTrajectoryOptimization::compute(const WholeBodyState& current_stat
 	for (unsigned int i = 0; i < num_cost; i++)
 		oc_model_.getCosts()[i]->setDesiredState(desired_state);
 
-	return solver_->compute(computation_time);
+	// Starting from the previous solution shifted by one knot in case of warm start. The
+	// refined meshes change the problem dimensions, so only the coarse solution is shifted
+	// and the solver doesn't reuse its multipliers
+	restoreCoarseMesh();
+	const Eigen::VectorXd& last_solution = (starting_point != NULL) ? *starting_point :
+			(max_refinements_ != 0) ? coarse_solution_ : solver_->getSolution();
+	recordSnapshot(current_state, desired_state, computation_time, last_solution);
+	solver_->setWarmStart(warm_start_ && max_refinements_ == 0);
+	if (warm_start_ && last_solution.size() != 0)
+		oc_model_.setShiftedStartingPoint(last_solution);
+
+	// A cancelled solve doesn't tighten the relaxation
+	std::chrono::steady_clock::time_point started_time = std::chrono::steady_clock::now();
+	bool solved = solver_->compute(computation_time);
+	if (!solved && solver_->isCancellationRequested())
+		return false;
+
+	// Refining the knots of the coarse mesh with bigger integration errors, where every
+	// refined problem starts from the interpolation of the previous solution
+	num_refinements_ = 0;
+	if (solved && max_refinements_ != 0 && !oc_model_.isTemplateBuilt()) {
+		coarse_solution_ = solver_->getSolution();
+		oc_model_.getKnotDurations(coarse_knot_durations_);
+		double step_time = getDynamicalSystem()->getFixedStepTime();
+		is_uniform_coarse_mesh_ = true;
+		for (unsigned int k = 0; k < coarse_knot_durations_.size(); k++) {
+			if (coarse_knot_durations_[k] != step_time)
+				is_uniform_coarse_mesh_ = false;
+		}
+
+		while (solved && num_refinements_ < max_refinements_) {
+			double elapsed_time = std::chrono::duration<double>(
+					std::chrono::steady_clock::now() - started_time).count();
+			if (elapsed_time >= computation_time ||
+					!oc_model_.refineKnotMesh(solver_->getSolution(),
+											  refinement_tolerance_,
+											  refinement_min_duration_))
+				break;
+
+			num_refinements_++;
+			solved = solver_->compute(computation_time - elapsed_time);
+			if (!solved && solver_->isCancellationRequested())
+				return false;
+		}
+	}
+
+	// Computing the sensitivity of the solution with the bounds of this solve, i.e. before
+	// tightening the relaxation
+	sensitivity_.reset();
+	if (solved && with_sensitivity_)
+		sensitivity_.compute(oc_model_, solver_->getSolution());
+
+	// Tightening the relaxation of the complementary constraints for the next solve
+	std::vector<ocp::Constraint<WholeBodyState>*> constraints = oc_model_.getConstraints();
+	for (unsigned int i = 0; i < constraints.size(); i++) {
+		ocp::ComplementaryConstraint* complementary =
+				dynamic_cast<ocp::ComplementaryConstraint*>(constraints[i]);
+		if (complementary != NULL)
+			complementary->updateRelaxation();
+	}
+
+	// Publishing the solved trajectory as the next plan. Note that the back buffer isn't
+	// read by the control thread
+	if (solved) {
+		plan_.getWriteBuffer() = oc_model_.evaluateSolution(solver_->getSolution());
+		plan_.publish();
+	}
+
+	return solved;
+}
+
+
+void WholeBodyTrajectoryOptimization::recordSnapshot(const WholeBodyState& current_state,
+													 const WholeBodyState& desired_state,
+													 double computation_time,
+													 const Eigen::VectorXd& starting_point)
+{
+	if (snapshot_recorder_ == NULL || !snapshot_recorder_->isRecording())
+		return;
+
+	// The warm-start point is only recorded if it's used
+	snapshot_.clear();
+	snapshot_.writeState(current_state);
+	snapshot_.writeState(desired_state);
+	snapshot_.writeDouble(computation_time);
+	snapshot_.writeBool(warm_start_);
+	if (warm_start_)
+		snapshot_.writeVector(starting_point);
+	snapshot_recorder_->record(solve_snapshot::WholeBodyTrajectoryOptimizationKind, snapshot_);
+}
+
+
+void WholeBodyTrajectoryOptimization::restoreCoarseMesh()
+{
+	if (coarse_knot_durations_.empty())
+		return;
+
+	// The uniform mesh follows the fixed-step time
+	if (is_uniform_coarse_mesh_)
+		oc_model_.setHorizon(coarse_knot_durations_.size());
+	else
+		oc_model_.setKnotDurations(coarse_knot_durations_);
+	coarse_knot_durations_.clear();
 }
 
 
@@ -120,22 +414,52 @@ const WholeBodyTrajectory& WholeBodyTrajectoryOptimization::getInterpolatedWhole
 	interpolated_trajectory_.clear();
 
 	// Getting the whole-body trajectory
-	WholeBodyTrajectory trajectory = getWholeBodyTrajectory();
+	const WholeBodyTrajectory& trajectory = getWholeBodyTrajectory();
 
 	// Getting the number of joints and end-effectors
 	unsigned int num_joints = getDynamicalSystem()->getFloatingBaseSystem().getJointDoF();
-	unsigned int num_contacts = getDynamicalSystem()->getFloatingBaseSystem().getNumberOfEndEffectors();
-
-	// Defining splines //TODO for the time being only cubic interpolation is OK
-	std::vector<math::CubicSpline> base_spline, joint_spline, control_spline;
-	std::vector<std::vector<math::CubicSpline> > contact_force_spline;
-	base_spline.resize(6);
-	joint_spline.resize(num_joints);
-	control_spline.resize(num_joints);
-	contact_force_spline.resize(num_contacts);
+	rbd::BodySelector end_effector_names =
+			getDynamicalSystem()->getFloatingBaseSystem().getEndEffectorNames();
+
+	// Defining the splines, where the motion spline interpolates the base and joint channels
+	// together, and the control spline interpolates the joint efforts.
+	// TODO for the time being only cubic interpolation is OK
+	math::MultiCubicSpline motion_spline, control_spline;
+	unsigned int num_channels = 6 + num_joints;
+	Eigen::VectorXd starting_pos(num_channels), starting_vel(num_channels);
+	Eigen::VectorXd ending_pos(num_channels), ending_vel(num_channels);
+	Eigen::VectorXd motion_pos, motion_vel, motion_acc;
+
+	// Reserving the interpolated trajectory, i.e. the knots and their interpolated states
+	unsigned int horizon = oc_model_.getHorizon();
+	unsigned int num_knots = horizon + 1;
+	unsigned int num_states = num_knots;
+	for (unsigned int k = 0; k < horizon; k++) {
+		unsigned int index = floor(trajectory[k+1].duration / interpolation_time);
+		num_states += (index > 1) ? index - 1 : 0;
+	}
+	interpolated_trajectory_.reserve(num_states);
+
+	// Fitting the global splines of all the knots in one pass, where the per-knot splines are
+	// used if the knot times aren't increasing
+	math::MultiKnotCubicSpline global_motion_spline, global_control_spline;
+	bool global = false;
+	if (global_interpolation_) {
+		Eigen::VectorXd knot_times(num_knots);
+		Eigen::MatrixXd knot_motion(num_channels, num_knots);
+		Eigen::MatrixXd knot_control(num_joints, num_knots);
+		for (unsigned int k = 0; k < num_knots; k++) {
+			knot_times(k) = trajectory[k].time;
+			knot_motion.col(k) << trajectory[k].base_pos, trajectory[k].joint_pos;
+			knot_control.col(k) = trajectory[k].joint_eff;
+		}
+		starting_vel << trajectory[0].base_vel, trajectory[0].joint_vel;
+		ending_vel << trajectory[horizon].base_vel, trajectory[horizon].joint_vel;
+		global = global_motion_spline.fit(knot_times, knot_motion, starting_vel, ending_vel) &&
+				global_control_spline.fit(knot_times, knot_control);
+	}
 
 	// Computing the interpolation of the whole-body trajectory
-	unsigned int horizon = oc_model_.getHorizon();
 	for (unsigned int k = 0; k < horizon; k++) {
 		// Adding the starting state
 		interpolated_trajectory_.push_back(trajectory[k]);
@@ -144,90 +468,53 @@ const WholeBodyTrajectory& WholeBodyTrajectoryOptimization::getInterpolatedWhole
 		double starting_time = trajectory[k].time;
 		double duration = trajectory[k+1].duration;
 
+		// Initialization of the motion and control splines
+		if (!global) {
+			starting_pos << trajectory[k].base_pos, trajectory[k].joint_pos;
+			starting_vel << trajectory[k].base_vel, trajectory[k].joint_vel;
+			ending_pos << trajectory[k+1].base_pos, trajectory[k+1].joint_pos;
+			ending_vel << trajectory[k+1].base_vel, trajectory[k+1].joint_vel;
+			motion_spline.setBoundary(starting_time, duration,
+									  starting_pos, starting_vel,
+									  ending_pos, ending_vel);
+			control_spline.setBoundary(starting_time, duration,
+									   trajectory[k].joint_eff, trajectory[k+1].joint_eff);
+		}
+
 		// Interpolating the current state
 		WholeBodyState current_state(num_joints);
-		math::Spline::Point current_point;
 		unsigned int index = floor(duration / interpolation_time);
-		for (unsigned int t = 0; t < index; t++) {
+		for (unsigned int t = 1; t < index; t++) {
 			double time = starting_time + t * interpolation_time;
 
-			// Base interpolation
-			for (unsigned int base_idx = 0; base_idx < 6; base_idx++) {
-				if (t == 0) {
-					// Initialization of the base motion splines
-					math::Spline::Point starting(trajectory[k].base_pos(base_idx),
-											 	 trajectory[k].base_vel(base_idx),
-												 trajectory[k].base_acc(base_idx));
-					math::Spline::Point ending(trajectory[k+1].base_pos(base_idx),
-											   trajectory[k+1].base_vel(base_idx),
-											   trajectory[k+1].base_acc(base_idx));
-					base_spline[base_idx].setBoundary(starting_time, duration, starting, ending);
-				} else {
-					// Getting and setting the interpolated point
-					base_spline[base_idx].getPoint(time, current_point);
-					current_state.base_pos(base_idx) = current_point.x;
-					current_state.base_vel(base_idx) = current_point.xd;
-					current_state.base_acc(base_idx) = current_point.xdd;
-				}
-			}
-
-			// Joint interpolations
-			for (unsigned int joint_idx = 0; joint_idx < num_joints; joint_idx++) {
-				if (t == 0) {
-					// Initialization of the joint motion splines
-					math::Spline::Point motion_starting(trajectory[k].joint_pos(joint_idx),
-														trajectory[k].joint_vel(joint_idx),
-														trajectory[k].joint_acc(joint_idx));
-					math::Spline::Point motion_ending(trajectory[k+1].joint_pos(joint_idx),
-													  trajectory[k+1].joint_vel(joint_idx),
-													  trajectory[k+1].joint_acc(joint_idx));
-					joint_spline[joint_idx].setBoundary(starting_time, duration,
-														motion_starting, motion_ending);
-
-					// Initialization of the joint control splines
-					math::Spline::Point control_starting(trajectory[k].joint_eff(joint_idx));
-					math::Spline::Point control_ending(trajectory[k+1].joint_eff(joint_idx));
-					control_spline[joint_idx].setBoundary(starting_time, duration,
-														  control_starting, control_ending);
-				} else {
-					// Getting and setting the joint motion interpolated point
-					joint_spline[joint_idx].getPoint(time, current_point);
-					current_state.joint_pos(joint_idx) = current_point.x;
-					current_state.joint_vel(joint_idx) = current_point.xd;
-					current_state.joint_acc(joint_idx) = current_point.xdd;
-
-					// Getting and setting the joint motion interpolated point
-					control_spline[joint_idx].getPoint(time, current_point);
-					current_state.joint_eff(joint_idx) = current_point.x;
-				}
-			}
-
-			// Compute the contact information
-			// Computing the contact positions
-			rbd::BodySelector end_effector_names = getDynamicalSystem()->getFloatingBaseSystem().getEndEffectorNames();
-			getDynamicalSystem()->getKinematics().computeForwardKinematics(current_state.contact_pos,
+			// Getting and setting the interpolated point of all the channels
+			if (global)
+				global_motion_spline.getPoint(time, motion_pos, motion_vel, motion_acc);
+			else
+				motion_spline.getPoint(time, motion_pos, motion_vel, motion_acc);
+			current_state.base_pos = motion_pos.head<6>();
+			current_state.base_vel = motion_vel.head<6>();
+			current_state.base_acc = motion_acc.head<6>();
+			current_state.joint_pos = motion_pos.tail(num_joints);
+			current_state.joint_vel = motion_vel.tail(num_joints);
+			current_state.joint_acc = motion_acc.tail(num_joints);
+			if (global)
+				global_control_spline.getPoint(time, current_state.joint_eff);
+			else
+				control_spline.getPoint(time, current_state.joint_eff);
+
+			// Computing the contact positions, velocities and accelerations in one kinematic
+			// update
+			getDynamicalSystem()->getKinematics().computeContactKinematics(current_state.contact_pos,
+																		   current_state.contact_vel,
+																		   current_state.contact_acc,
 																		   current_state.base_pos,
 																		   current_state.joint_pos,
-																		   end_effector_names,
-																		   dwl::rbd::Linear);
-			// Computing the contact velocities
-			getDynamicalSystem()->getKinematics().computeVelocity(current_state.contact_vel,
-																  current_state.base_pos,
-																  current_state.joint_pos,
-																  current_state.base_vel,
-																  current_state.joint_vel,
-																  end_effector_names,
-																  dwl::rbd::Linear);
-			// Computing the contact accelerations
-			getDynamicalSystem()->getKinematics().computeAcceleration(current_state.contact_acc,
-																	  current_state.base_pos,
-																	  current_state.joint_pos,
-																	  current_state.base_vel,
-																	  current_state.joint_vel,
-																	  current_state.base_acc,
-																	  current_state.joint_acc,
-																	  end_effector_names,
-																	  dwl::rbd::Linear);
+																		   current_state.base_vel,
+																		   current_state.joint_vel,
+																		   current_state.base_acc,
+																		   current_state.joint_acc,
+																		   end_effector_names);
 			// Computing the contact forces
 			getDynamicalSystem()->getDynamics().estimateContactForces(current_state.contact_eff,
 																	 current_state.base_pos,
@@ -240,12 +527,8 @@ const WholeBodyTrajectory& WholeBodyTrajectoryOptimization::getInterpolatedWhole
 																	 end_effector_names);
 
 			// Adding the current state
-			if (t != 0) {
-				// Setting the current time
-				current_state.time = time;
-
-				interpolated_trajectory_.push_back(current_state);
-			}
+			current_state.time = time;
+			interpolated_trajectory_.push_back(current_state);
 		}
 	}
 
@@ -256,5 +539,29 @@ const WholeBodyTrajectory& WholeBodyTrajectoryOptimization::getInterpolatedWhole
 }
 
 
+void WholeBodyTrajectoryOptimization::getInterpolatedWholeBodyTrajectory(WholeBodyTrajectoryContainer& trajectory,
+																		 const double& interpolation_time)
+{
+	trajectory.fromTrajectory(getInterpolatedWholeBodyTrajectory(interpolation_time));
+}
+
+
+const WholeBodyTrajectory& WholeBodyTrajectoryOptimization::acquirePlan(bool* updated)
+{
+	return plan_.acquire(updated);
+}
+
+
+uint64_t WholeBodyTrajectoryOptimization::getPlanVersion() const
+{
+	return plan_.getReadVersion();
+}
+
+
+uint64_t WholeBodyTrajectoryOptimization::getPublishedPlanVersion() const
+{
+	return plan_.getPublishedVersion();
+}
+
 } //@namespace locomotion
 } //@namespace dwl
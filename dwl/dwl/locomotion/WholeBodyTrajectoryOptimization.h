@@ -2,8 +2,14 @@
 #define DWL__LOCOMOTION__WHOLE_BODY_TRAJECTORY_OPTIMIZATION__H
 
 #include <dwl/ocp/OptimalControl.h>
+#include <dwl/ocp/SolutionSensitivity.h>
+#include <dwl/TrajectoryContainer.h>
+#include <dwl/SolveSnapshot.h>
 #include <dwl/solver/OptimizationSolver.h>
 #include <dwl/utils/SplineInterpolation.h>
+#include <dwl/utils/TripleBuffer.h>
+#include <dwl/utils/WorkerPool.h>
+#include <future>
 
 
 namespace dwl
@@ -86,7 +92,86 @@ class WholeBodyTrajectoryOptimization
 		void setNominalTrajectory(WholeBodyTrajectory& nom_trajectory);
 
 		/**
-		 * @brief Computes a whole-body trajectory
+		 * @brief Enables/disables the warm start for receding-horizon use. In this mode, each
+		 * compute call starts from the previous solution shifted by one knot, and the solver
+		 * reuses its multipliers and the problem structure (the optimal control problem is not
+		 * re-initialized). Note that the horizon and the constraints should not change
+		 * @param bool True for enabling the warm start
+		 */
+		void setWarmStart(bool warm_start);
+
+		/**
+		 * @brief Enables/disables the problem template of the optimal control problem, i.e.
+		 * its structure is built once and the compute calls update only the initial and desired
+		 * states. Note that the horizon is frozen after the first compute call
+		 * @param bool True for enabling the problem template
+		 */
+		void setProblemTemplate(bool enable);
+
+		/**
+		 * @brief Sets the refinement of the knot mesh, i.e. every compute call solves the
+		 * problem in the coarse mesh (see setHorizon and setStepIntegrationTime), and then it
+		 * splits the knots with an integration error bigger than the tolerance and re-solves
+		 * from the interpolated solution. The refinements stop when every knot fulfills the
+		 * tolerance, and they share the allowed computation time. It requires fixed-step
+		 * integration, and it's disabled by the problem template
+		 * @param unsigned int Maximum number of refinements (0 disables it)
+		 * @param double Tolerance of the integration error of the generalized positions
+		 * @param double Minimum duration of the refined knots
+		 */
+		void setMeshRefinement(unsigned int max_refinements,
+							   double tolerance,
+							   double min_duration = 0.);
+
+		/** @brief Gets the number of refinements of the last compute call */
+		unsigned int getNumberOfRefinements() const;
+
+		/**
+		 * @brief Enables/disables the global interpolation of the whole-body trajectory, i.e.
+		 * the base and joint states are fitted with a C2 spline over all the knots (see
+		 * math::MultiKnotCubicSpline) instead of one cubic spline per knot. The velocities of
+		 * the first and last knots are the boundaries of the fit, and the joint efforts are
+		 * fitted with a natural spline. Note that the velocities of the interior knots are
+		 * smoothed, i.e. they aren't interpolated
+		 * @param bool True for enabling the global interpolation
+		 */
+		void setGlobalInterpolation(bool enable);
+
+		/**
+		 * @brief Enables/disables the sensitivity of the solution with respect to the current
+		 * state, which is computed after every solved compute call (see
+		 * ocp::SolutionSensitivity). It allows fast approximate re-solves between full solves
+		 * (see predictSolution)
+		 * @param bool True for enabling the sensitivity
+		 */
+		void setSensitivity(bool enable);
+
+		/**
+		 * @brief Predicts the solution of the last computed problem for a perturbed current
+		 * state, i.e. the first-order update of the solution from its sensitivity. It's only a
+		 * matrix-vector product, so it can be used as a feedback policy between the full
+		 * solves. Note that it shouldn't be called while there is a pending request
+		 * @param Eigen::VectorXd& Predicted solution vector
+		 * @param const WholeBodyState& Perturbed current whole-body state
+		 * @return False if the sensitivity wasn't computed
+		 */
+		bool predictSolution(Eigen::VectorXd& solution,
+							 const WholeBodyState& current_state);
+
+		/**
+		 * @brief Gets the predicted whole-body trajectory for a perturbed current state. It
+		 * sets the current state of the optimal control problem
+		 * @param const WholeBodyState& Perturbed current whole-body state
+		 * @return const WholeBodyTrajectory& Predicted whole-body trajectory, which is the
+		 * last solution if the sensitivity wasn't computed
+		 */
+		const WholeBodyTrajectory& getPredictedWholeBodyTrajectory(const WholeBodyState& current_state);
+
+		/**
+		 * @brief Computes a whole-body trajectory. The relaxation of the complementary
+		 * constraints is tightened after every solve, and the trajectory is published as the
+		 * next plan if it was solved (see acquirePlan). It supersedes the pending asynchronous
+		 * requests (see computeAsync)
 		 * @param const WholeBodyState& Current whole-body state
 		 * @param const WholeBodyState& Desired whole-body state
 		 * @param double Allowed computation time
@@ -95,6 +180,51 @@ class WholeBodyTrajectoryOptimization
 					 const WholeBodyState& desired_state,
 					 double computation_time);
 
+		/**
+		 * @brief Starts the computation of a whole-body trajectory in a worker pool, and
+		 * returns without waiting for it. A newer request (or compute call) supersedes the
+		 * older ones, i.e. the queued ones aren't computed and the running one is cancelled
+		 * between the solver iterations. The solved trajectory is published as the next plan
+		 * (see acquirePlan). Note that the optimization problem shouldn't be modified while
+		 * there is a pending request
+		 * @param const WholeBodyState& Current whole-body state
+		 * @param const WholeBodyState& Desired whole-body state
+		 * @param double Allowed computation time
+		 * @param utils::WorkerPool* Worker pool (NULL for the default one)
+		 * @return std::shared_future<bool> Result of the request, i.e. false if it wasn't
+		 * solved or it was superseded
+		 */
+		std::shared_future<bool> computeAsync(const WholeBodyState& current_state,
+											  const WholeBodyState& desired_state,
+											  double computation_time,
+											  utils::WorkerPool* pool = NULL);
+
+		/** @brief Cancels the pending requests, i.e. the queued and running ones */
+		void cancel();
+
+		/** @brief Waits for the end of the pending requests */
+		void waitAsync();
+
+		/**
+		 * @brief Sets the recorder of the snapshots, i.e. the exact inputs of every computed
+		 * request (the current and desired states, the allowed computation time and the
+		 * warm-start point), so they can be replayed offline. Note that it shouldn't be
+		 * changed while there is a pending request
+		 * @param SnapshotRecorder* Snapshot recorder (NULL disables the recording)
+		 */
+		void setSnapshotRecorder(SnapshotRecorder* recorder);
+
+		/**
+		 * @brief Replays a recorded computation, which starts from the recorded warm-start
+		 * point. The relaxation of the complementary constraints is tightened by every solve,
+		 * so the records of a file have to be replayed in order, and the optimization problem
+		 * has to be set up as in the recorded process. Note that the multipliers of the
+		 * warm-started solver aren't recorded
+		 * @param SnapshotDecoder& Payload of the record
+		 * @return True if it was solved
+		 */
+		bool replay(SnapshotDecoder& snapshot);
+
 		/** @brief Gets the dynamical system constraint */
 		ocp::DynamicalSystem* getDynamicalSystem();
 
@@ -111,8 +241,68 @@ class WholeBodyTrajectoryOptimization
 		 */
 		const WholeBodyTrajectory& getInterpolatedWholeBodyTrajectory(const double& interpolation_time);
 
+		/**
+		 * @brief Gets the interpolated whole-body trajectory stored as structure of arrays
+		 * @param WholeBodyTrajectoryContainer& Whole-body trajectory container
+		 * @param const double Time of interpolation
+		 */
+		void getInterpolatedWholeBodyTrajectory(WholeBodyTrajectoryContainer& trajectory,
+												const double& interpolation_time);
+
+		/**
+		 * @brief Gets the last published plan, i.e. the trajectory of the last solved
+		 * computation. It's wait-free, so it can be called by a control thread while the
+		 * planning thread computes the next plan. The plan isn't modified until the next call,
+		 * which has to be done from the same thread
+		 * @param bool* Indicates if there is a new plan since the last call
+		 * @return const WholeBodyTrajectory& Last published plan
+		 */
+		const WholeBodyTrajectory& acquirePlan(bool* updated = NULL);
+
+		/** @brief Gets the version of the last acquired plan (zero for none) */
+		uint64_t getPlanVersion() const;
+
+		/** @brief Gets the version of the last published plan */
+		uint64_t getPublishedPlanVersion() const;
+
 
 	private:
+		/**
+		 * @brief Issues a request, which supersedes the older ones
+		 * @return uint64_t Identifier of the request
+		 */
+		uint64_t issueRequest();
+
+		/**
+		 * @brief Computes a request if it's the latest one
+		 * @param uint64_t Identifier of the request
+		 * @param const WholeBodyState& Current whole-body state
+		 * @param const WholeBodyState& Desired whole-body state
+		 * @param double Allowed computation time
+		 * @param const Eigen::VectorXd* Warm-start point (NULL for the last solution)
+		 * @return False if it wasn't solved or it was superseded
+		 */
+		bool computeRequest(uint64_t request,
+							const WholeBodyState& current_state,
+							const WholeBodyState& desired_state,
+							double computation_time,
+							const Eigen::VectorXd* starting_point = NULL);
+
+		/**
+		 * @brief Records the inputs of a computation if there is a snapshot recorder
+		 * @param const WholeBodyState& Current whole-body state
+		 * @param const WholeBodyState& Desired whole-body state
+		 * @param double Allowed computation time
+		 * @param const Eigen::VectorXd& Warm-start point
+		 */
+		void recordSnapshot(const WholeBodyState& current_state,
+							const WholeBodyState& desired_state,
+							double computation_time,
+							const Eigen::VectorXd& starting_point);
+
+		/** @brief Restores the coarse knot mesh of the last refinement */
+		void restoreCoarseMesh();
+
 		/** @brief Optimization solver */
 		solver::OptimizationSolver* solver_;
 
@@ -121,6 +311,48 @@ class WholeBodyTrajectoryOptimization
 
 		/** @brief Interpolated whole-body trajectory */
 		WholeBodyTrajectory interpolated_trajectory_;
+
+		/** @brief Published plans, which are handed off to the control thread */
+		utils::TripleBuffer<WholeBodyTrajectory> plan_;
+
+		/** @brief Label that indicates if the optimization is warm-started */
+		bool warm_start_;
+
+		/** @brief Maximum number of refinements, tolerance and minimum knot duration */
+		unsigned int max_refinements_;
+		double refinement_tolerance_;
+		double refinement_min_duration_;
+
+		/** @brief Number of refinements of the last compute call */
+		unsigned int num_refinements_;
+
+		/** @brief Label that indicates if the interpolation is global */
+		bool global_interpolation_;
+
+		/** @brief Sensitivity of the solution, and a label that indicates if it's enabled */
+		ocp::SolutionSensitivity sensitivity_;
+		bool with_sensitivity_;
+
+		/** @brief Knot durations and solution of the coarse mesh, and a label that indicates if
+		 * the coarse mesh is uniform */
+		std::vector<double> coarse_knot_durations_;
+		Eigen::VectorXd coarse_solution_;
+		bool is_uniform_coarse_mesh_;
+
+		/** @brief Serializes the computations, since they share the optimization problem */
+		std::mutex compute_mutex_;
+
+		/** @brief Latest request and the number of pending ones, which are guarded by the
+		 * mutex */
+		std::mutex request_mutex_;
+		std::condition_variable request_condition_;
+		uint64_t latest_request_;
+		unsigned int num_pending_;
+
+		/** @brief Snapshot recorder and the encoder of its records, which are guarded by the
+		 * computation mutex */
+		SnapshotRecorder* snapshot_recorder_;
+		SnapshotEncoder snapshot_;
 };
 
 } //@namespace locomotion
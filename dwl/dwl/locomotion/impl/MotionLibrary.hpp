@@ -0,0 +1,202 @@
+#ifndef DWL__LOCOMOTION__MOTION_LIBRARY__IMPL_H
+#define DWL__LOCOMOTION__MOTION_LIBRARY__IMPL_H
+
+
+namespace dwl
+{
+
+namespace locomotion
+{
+
+template <typename TMotion>
+MotionLibrary<TMotion>::MotionLibrary(unsigned int capacity) : num_motions_(0),
+		capacity_(capacity), state_weight_(1.), command_weight_(1.),
+		max_distance_(std::numeric_limits<double>::max()), min_spacing_(0.),
+		use_counter_(0), num_hits_(0), num_misses_(0)
+{
+
+}
+
+
+template <typename TMotion>
+MotionLibrary<TMotion>::~MotionLibrary()
+{
+
+}
+
+
+template <typename TMotion>
+void MotionLibrary<TMotion>::setWeights(double state_weight,
+										double command_weight)
+{
+	state_weight_ = state_weight;
+	command_weight_ = command_weight;
+}
+
+
+template <typename TMotion>
+void MotionLibrary<TMotion>::setMaximumDistance(double distance)
+{
+	max_distance_ = distance;
+}
+
+
+template <typename TMotion>
+void MotionLibrary<TMotion>::setMinimumSpacing(double spacing)
+{
+	min_spacing_ = spacing;
+}
+
+
+template <typename TMotion>
+void MotionLibrary<TMotion>::add(const MotionDescriptor& descriptor,
+								 const TMotion& motion)
+{
+	// Replacing the stored motion that is too close, which keeps the library compact
+	double distance;
+	Entry* nearest = findNearest(distance, descriptor);
+	if (nearest != NULL && distance <= min_spacing_) {
+		nearest->descriptor = descriptor;
+		nearest->motion = motion;
+		nearest->last_use = ++use_counter_;
+		return;
+	}
+
+	if (capacity_ != 0 && num_motions_ >= capacity_)
+		removeLeastRecentlyUsed();
+
+	Entry entry;
+	entry.descriptor = descriptor;
+	entry.motion = motion;
+	entry.last_use = ++use_counter_;
+	entries_[descriptor.terrain_hash].push_back(entry);
+	num_motions_++;
+}
+
+
+template <typename TMotion>
+bool MotionLibrary<TMotion>::lookup(TMotion& motion,
+									const MotionDescriptor& descriptor,
+									double* distance)
+{
+	double nearest_distance;
+	Entry* nearest = findNearest(nearest_distance, descriptor);
+	if (nearest == NULL || nearest_distance > max_distance_) {
+		num_misses_++;
+		return false;
+	}
+
+	motion = nearest->motion;
+	nearest->last_use = ++use_counter_;
+	if (distance != NULL)
+		*distance = nearest_distance;
+	num_hits_++;
+
+	return true;
+}
+
+
+template <typename TMotion>
+void MotionLibrary<TMotion>::clear()
+{
+	entries_.clear();
+	num_motions_ = 0;
+	num_hits_ = num_misses_ = 0;
+}
+
+
+template <typename TMotion>
+unsigned int MotionLibrary<TMotion>::size() const
+{
+	return num_motions_;
+}
+
+
+template <typename TMotion>
+unsigned int MotionLibrary<TMotion>::getNumberOfHits() const
+{
+	return num_hits_;
+}
+
+
+template <typename TMotion>
+unsigned int MotionLibrary<TMotion>::getNumberOfMisses() const
+{
+	return num_misses_;
+}
+
+
+template <typename TMotion>
+typename MotionLibrary<TMotion>::Entry*
+MotionLibrary<TMotion>::findNearest(double& distance,
+									const MotionDescriptor& descriptor)
+{
+	// Only the motions of the same terrain patch are searched
+	distance = std::numeric_limits<double>::max();
+	typename std::unordered_map<uint64_t, EntryList>::iterator list_it =
+			entries_.find(descriptor.terrain_hash);
+	if (list_it == entries_.end())
+		return NULL;
+
+	Entry* nearest = NULL;
+	EntryList& entries = list_it->second;
+	for (unsigned int i = 0; i < entries.size(); i++) {
+		double current_distance = computeDistance(entries[i].descriptor, descriptor);
+		if (current_distance < distance) {
+			distance = current_distance;
+			nearest = &entries[i];
+		}
+	}
+
+	return nearest;
+}
+
+
+template <typename TMotion>
+double MotionLibrary<TMotion>::computeDistance(const MotionDescriptor& descriptor1,
+											   const MotionDescriptor& descriptor2) const
+{
+	if (descriptor1.state_features.size() != descriptor2.state_features.size() ||
+			descriptor1.command.size() != descriptor2.command.size())
+		return std::numeric_limits<double>::max();
+
+	double state_distance =
+			(descriptor1.state_features - descriptor2.state_features).squaredNorm();
+	double command_distance = (descriptor1.command - descriptor2.command).squaredNorm();
+
+	return sqrt(state_weight_ * state_distance + command_weight_ * command_distance);
+}
+
+
+template <typename TMotion>
+void MotionLibrary<TMotion>::removeLeastRecentlyUsed()
+{
+	typename std::unordered_map<uint64_t, EntryList>::iterator oldest_list = entries_.end();
+	unsigned int oldest_index = 0;
+	uint64_t oldest_use = std::numeric_limits<uint64_t>::max();
+	for (typename std::unordered_map<uint64_t, EntryList>::iterator list_it = entries_.begin();
+			list_it != entries_.end(); list_it++) {
+		for (unsigned int i = 0; i < list_it->second.size(); i++) {
+			if (list_it->second[i].last_use < oldest_use) {
+				oldest_use = list_it->second[i].last_use;
+				oldest_list = list_it;
+				oldest_index = i;
+			}
+		}
+	}
+	if (oldest_list == entries_.end())
+		return;
+
+	// The order of the motions doesn't matter, so the last one fills the removed one
+	EntryList& entries = oldest_list->second;
+	entries[oldest_index] = entries.back();
+	entries.pop_back();
+	if (entries.empty())
+		entries_.erase(oldest_list);
+	num_motions_--;
+}
+
+} //@namespace locomotion
+} //@namespace dwl
+
+#endif
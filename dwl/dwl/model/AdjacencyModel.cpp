@@ -1,4 +1,5 @@
 #include <dwl/model/AdjacencyModel.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -8,7 +9,8 @@ namespace model
 {
 
 AdjacencyModel::AdjacencyModel() :	robot_(NULL), terrain_(NULL), is_lattice_(false),
-		is_added_feature_(false), uncertainty_factor_(1.15)
+		is_lazy_(false), is_added_feature_(false), heuristic_target_(0),
+		is_backward_heuristic_(false), backward_cost_quantum_(0.), uncertainty_factor_(1.15)
 {
 
 }
@@ -20,6 +22,12 @@ AdjacencyModel::~AdjacencyModel()
 }
 
 
+AdjacencyModel* AdjacencyModel::clone() const
+{
+	return NULL;
+}
+
+
 void AdjacencyModel::reset(robot::Robot* robot,
 						   environment::TerrainMap* environment)
 {
@@ -45,6 +53,39 @@ void AdjacencyModel::computeAdjacencyMap(AdjacencyMap& adjacency_map,
 }
 
 
+void AdjacencyModel::getPredecessors(EdgeList& predecessors,
+									 Vertex state_vertex)
+{
+	// The temporary lists use the allocator of the predecessors, e.g. the search pool
+	EdgeList neighbors(predecessors.get_allocator());
+	getSuccessors(neighbors, state_vertex);
+	for (EdgeList::iterator neighbor_iter = neighbors.begin();
+			neighbor_iter != neighbors.end();
+			neighbor_iter++)
+	{
+		// Getting the weight of the edge from the neighbor to the current vertex
+		EdgeList successors(predecessors.get_allocator());
+		getSuccessors(successors, neighbor_iter->target);
+		for (EdgeList::iterator edge_iter = successors.begin();
+				edge_iter != successors.end();
+				edge_iter++) {
+			if (edge_iter->target == state_vertex) {
+				predecessors.push_back(Edge(neighbor_iter->target, edge_iter->weight));
+				break;
+			}
+		}
+	}
+}
+
+
+bool AdjacencyModel::getGridNeighbor(Edge& neighbor,
+									 Vertex state_vertex,
+									 int dx, int dy)
+{
+	return false;
+}
+
+
 void AdjacencyModel::getTheClosestStartAndGoalVertex(Vertex& closest_source,
 													 Vertex& closest_target,
 													 Vertex source,
@@ -54,8 +95,8 @@ void AdjacencyModel::getTheClosestStartAndGoalVertex(Vertex& closest_source,
 	bool is_there_start_vertex, is_there_goal_vertex = false;
 	std::vector<Vertex> vertex_map;
 	if (terrain_->isTerrainInformation()) {
-		TerrainDataMap terrain_map = terrain_->getTerrainDataMap();
-		for (TerrainDataMap::iterator vertex_iter = terrain_map.begin();
+		const TerrainDataMap& terrain_map = terrain_->getTerrainDataMap();
+		for (TerrainDataMap::const_iterator vertex_iter = terrain_map.begin();
 				vertex_iter != terrain_map.end(); vertex_iter++) {
 			Vertex current_vertex = vertex_iter->first;
 			if (source == current_vertex) {
@@ -158,8 +199,8 @@ void AdjacencyModel::getTheClosestVertex(Vertex& closest_vertex,
 	// Checking if the  vertex is part of the terrain information
 	std::vector<Vertex> vertex_map;
 	if (terrain_->isTerrainInformation()) {
-		TerrainDataMap terrain_map = terrain_->getTerrainDataMap();
-		for (TerrainDataMap::iterator vertex_iter = terrain_map.begin();
+		const TerrainDataMap& terrain_map = terrain_->getTerrainDataMap();
+		for (TerrainDataMap::const_iterator vertex_iter = terrain_map.begin();
 				vertex_iter != terrain_map.end(); vertex_iter++) {
 			Vertex current_vertex = vertex_iter->first;
 			if (vertex == current_vertex) {
@@ -219,13 +260,54 @@ double AdjacencyModel::heuristicCost(Vertex source,
 	double dist_orientation = sqrt(
 			pow(((double) target_state(2) - (double) source_state(2)), 2));
 
+	double average_cost = terrain_->getAverageCostOfTerrain() + 0.1;
+	if (is_backward_heuristic_) {
+		// Computing the cost-to-go of the target once. Note that the unknown cells have the
+		// average cost, so the cost-to-go of the unknown areas is the weighted distance
+		if (!cost_to_go_ || heuristic_target_ != target) {
+			std::shared_ptr<environment::CostToGoField> cost_to_go(
+					new environment::CostToGoField());
+			cost_to_go->setCostQuantum(backward_cost_quantum_);
+			cost_to_go->compute(*terrain_, target_state.head(2), source_state.head(2),
+								terrain_->getAverageCostOfTerrain(), 0.1);
+			cost_to_go_ = cost_to_go;
+			heuristic_target_ = target;
+		}
+
+		double cost_to_go;
+		if (cost_to_go_->getCost(cost_to_go, source_state.head(2)))
+			return (5 * cost_to_go + 2.5 * dist_orientation * average_cost) * uncertainty_factor_;
+	}
+
 	double heuristic = (5 * distance + 2.5 * dist_orientation)
-			* uncertainty_factor_ * (terrain_->getAverageCostOfTerrain() + 0.1);
+			* uncertainty_factor_ * average_cost;
 
 	return heuristic;
 }
 
 
+void AdjacencyModel::setBackwardHeuristic(bool enable,
+										  double cost_quantum)
+{
+	is_backward_heuristic_ = enable;
+	if (backward_cost_quantum_ != cost_quantum)
+		cost_to_go_.reset();
+	backward_cost_quantum_ = cost_quantum;
+}
+
+
+void AdjacencyModel::resetBackwardHeuristic()
+{
+	cost_to_go_.reset();
+}
+
+
+std::shared_ptr<const environment::CostToGoField> AdjacencyModel::getCostToGoField() const
+{
+	return cost_to_go_;
+}
+
+
 bool AdjacencyModel::isReachedGoal(Vertex target,
 								   Vertex current)
 {
@@ -288,6 +370,58 @@ bool AdjacencyModel::isLatticeRepresentation()
 }
 
 
+void AdjacencyModel::setLazyEvaluation(bool lazy)
+{
+	is_lazy_ = lazy;
+}
+
+
+bool AdjacencyModel::isLazyEvaluation()
+{
+	return is_lazy_;
+}
+
+
+void AdjacencyModel::clearMemoizedCosts()
+{
+
+}
+
+
+bool AdjacencyModel::computeStanceCost(double& cost,
+									   std::vector<Weight>& cell_costs,
+									   unsigned int num_lowest) const
+{
+	if (cell_costs.empty())
+		return false;
+
+	// Averaging the lowest distinct costs, which is sorted in the workspace of the cell costs
+	// instead of an ordered set
+	std::sort(cell_costs.begin(), cell_costs.end());
+	unsigned int num_costs = std::unique(cell_costs.begin(), cell_costs.end()) -
+			cell_costs.begin();
+	num_lowest = std::min(num_lowest, num_costs);
+	cost = 0.;
+	for (unsigned int i = 0; i < num_lowest; i++)
+		cost += cell_costs[i];
+	cost /= num_lowest;
+
+	return true;
+}
+
+
+utils::MemoryUsage AdjacencyModel::getMemoryUsage() const
+{
+	utils::MemoryUsage usage("adjacency");
+	usage.add("features", utils::getHeapBytes(features_));
+	if (cost_to_go_)
+		usage.add("cost_to_go", sizeof(environment::CostToGoField) +
+				cost_to_go_->getHeapBytes());
+
+	return usage;
+}
+
+
 std::string AdjacencyModel::getName()
 {
 	return name_;
@@ -2,9 +2,11 @@
 #define DWL__MODEL__ADJACENCY_MODEL__H
 
 #include <dwl/environment/TerrainMap.h>
+#include <dwl/environment/CostToGoField.h>
 #include <dwl/environment/Feature.h>
 #include <dwl/robot/Robot.h>
 #include <dwl/utils/utils.h>
+#include <memory>
 
 
 namespace dwl
@@ -27,6 +29,15 @@ class AdjacencyModel
 		/** @brief Destructor function */
 		virtual ~AdjacencyModel();
 
+		/**
+		 * @brief Clones the adjacency model, e.g. for getting the successors in another thread
+		 * of a parallel search. The clone shares the robot, terrain and features with this
+		 * model, but it has its own copy of the memoized costs. The default implementation
+		 * returns NULL, which means that the model cannot be cloned
+		 * @return AdjacencyModel* A new copy of the model
+		 */
+		virtual AdjacencyModel* clone() const;
+
 		/**
 		 * @brief Defines the settings of all components within AdjacencyModel class
 		 * @param robot::Robot* The robot defines all the properties of the robot
@@ -49,12 +60,38 @@ class AdjacencyModel
 
 		/**
 		 * @brief Abstract method that gets the successors of a certain vertex
-		 * @param std::list<Edge>& The successors of a certain vertex
+		 * @param EdgeList& The successors of a certain vertex
 		 * @param Vertex Current state vertex
 		 */
-		virtual void getSuccessors(std::list<Edge>& successors,
+		virtual void getSuccessors(EdgeList& successors,
 								   Vertex state_vertex) = 0;
 
+		/**
+		 * @brief Gets the predecessors of a certain vertex, which is required by backward
+		 * searches such as D* Lite. The default implementation assumes a symmetric neighborhood,
+		 * i.e. the predecessors are the successors, and the edge weight is taken from the
+		 * successors of every predecessor. Note that the edges are rooted in the predecessor
+		 * @param EdgeList& The predecessors of a certain vertex, as (predecessor, weight)
+		 * @param Vertex Current state vertex
+		 */
+		virtual void getPredecessors(EdgeList& predecessors,
+									 Vertex state_vertex);
+
+		/**
+		 * @brief Gets the neighbor of a vertex in a direction of the grid, i.e. one of its
+		 * 8-connected neighbors, which is required by the jump point search. The default
+		 * implementation doesn't define a grid (e.g. lattice-based models), so the solvers
+		 * only use the successors
+		 * @param Edge& Neighbor vertex and the weight of its edge
+		 * @param Vertex Current state vertex
+		 * @param int Direction in the x-axis (-1, 0 or 1)
+		 * @param int Direction in the y-axis (-1, 0 or 1)
+		 * @return True if the neighbor is part of the grid
+		 */
+		virtual bool getGridNeighbor(Edge& neighbor,
+									 Vertex state_vertex,
+									 int dx, int dy);
+
 		/**
 		 * @brief Gets the closest start and goal vertex if it is not belong to
 		 * the terrain information
@@ -84,6 +121,33 @@ class AdjacencyModel
 		virtual double heuristicCost(Vertex source,
 									 Vertex target);
 
+		/**
+		 * @brief Enables/disables the backward heuristic. The distance of the heuristic is
+		 * replaced by the cost-to-go of a backward Dijkstra search over the terrain cost grid,
+		 * which is computed once per target (i.e. the replans of the same target reuse it).
+		 * So the search avoids expanding the areas behind the high-cost terrain
+		 * @param bool True for enabling the backward heuristic
+		 * @param double Cost quantum of the backward search (see CostToGoField::setCostQuantum),
+		 * or zero for the indexed heap
+		 */
+		void setBackwardHeuristic(bool enable,
+								  double cost_quantum = 0.);
+
+		/**
+		 * @brief Clears the cost-to-go of the backward heuristic, e.g. after a big change of the
+		 * terrain information. It's recomputed in the next heuristic evaluation
+		 */
+		void resetBackwardHeuristic();
+
+		/**
+		 * @brief Gets the cost-to-go of the backward heuristic of the last target, e.g. for
+		 * reusing it as terminal cost of the footstep search. A new target computes a new
+		 * field, so the returned one isn't modified and it can be shared with other planning
+		 * stages
+		 * @return The cost-to-go field, or NULL if it wasn't computed
+		 */
+		std::shared_ptr<const environment::CostToGoField> getCostToGoField() const;
+
 		/**
 		 * @brief Indicates if it is reached the goal
 		 * @param Vertex Goal vertex
@@ -116,14 +180,55 @@ class AdjacencyModel
 		 */
 		bool isLatticeRepresentation();
 
+		/**
+		 * @brief Enables/disables the lazy evaluation of the graph. In lazy evaluation, the whole
+		 * adjacency map is never built, i.e. the solvers get the successors of the expanded
+		 * vertices on demand, and the adjacency model can memoize the vertex costs
+		 * @param bool True for enabling the lazy evaluation
+		 */
+		void setLazyEvaluation(bool lazy);
+
+		/**
+		 * @brief Indicates if the graph is lazily evaluated
+		 * @return True if the graph is lazily evaluated
+		 */
+		bool isLazyEvaluation();
+
+		/**
+		 * @brief Clears the vertex costs memoized during the lazy evaluation, e.g. after
+		 * changing the features. Note that the memoized costs are kept between searches, so
+		 * the adjacency models validate them with the terrain changes (see
+		 * environment::TerrainMap::isChangedRegion)
+		 */
+		virtual void clearMemoizedCosts();
+
 		/**
 		 * @brief Gets the name of the adjacency model
 		 * @return The name of the adjacency model
 		 */
 		std::string getName();
 
+		/**
+		 * @brief Gets the memory report of the adjacency model, i.e. the bytes of its caches
+		 * (e.g. the memoized costs and the precomputed stance areas)
+		 * @return The memory report
+		 */
+		virtual utils::MemoryUsage getMemoryUsage() const;
+
 
 	protected:
+		/**
+		 * @brief Computes the stance cost of a stance area, i.e. the average of its lowest
+		 * distinct cell costs. Note that the cell costs are sorted in place
+		 * @param double& Stance cost
+		 * @param std::vector<Weight>& Cell costs of the stance area
+		 * @param unsigned int Number of lowest costs
+		 * @return False if the stance area doesn't have cells with terrain information
+		 */
+		bool computeStanceCost(double& cost,
+							   std::vector<Weight>& cell_costs,
+							   unsigned int num_lowest) const;
+
 		/** @brief Name of the adjacency model */
 		std::string name_;
 
@@ -139,9 +244,22 @@ class AdjacencyModel
 		/** @brief Indicates if it is a lattice-based graph */
 		bool is_lattice_;
 
+		/** @brief Indicates if the graph is lazily evaluated */
+		bool is_lazy_;
+
 		/** @brief Indicates if it was added a feature */
 		bool is_added_feature_;
 
+		/** @brief Cost-to-go of the backward heuristic, and its target */
+		std::shared_ptr<environment::CostToGoField> cost_to_go_;
+		Vertex heuristic_target_;
+
+		/** @brief Indicates if the backward heuristic is enabled */
+		bool is_backward_heuristic_;
+
+		/** @brief Cost quantum of the backward heuristic */
+		double backward_cost_quantum_;
+
 		/** @brief Uncertainty factor which is applied in unperceived environment */
 		double uncertainty_factor_; // For unknown (non-perceive) areas
 };
@@ -0,0 +1,141 @@
+#ifndef DWL__MODEL__AUTO_DIFF_OPTIMIZATION_MODEL__H
+#define DWL__MODEL__AUTO_DIFF_OPTIMIZATION_MODEL__H
+
+#include <dwl/model/OptimizationModel.h>
+#include <unsupported/Eigen/AutoDiff>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class AutoDiffOptimizationModel
+ * @brief AutoDiffOptimizationModel is an optional automatic differentiation layer for
+ * optimization models. The derived class (CRTP) only describes its cost and constraint functions
+ * templated on the scalar type, and this class computes the exact cost gradient, constraint
+ * Jacobian and Lagrangian Hessian with forward-mode automatic differentiation (Eigen's
+ * AutoDiffScalar). With exact Hessians, the NLP solver doesn't need the limited-memory
+ * approximation. The derived class has to implement:
+ *
+ *   template<typename Scalar>
+ *   Scalar computeCost(const Eigen::Matrix<Scalar,Eigen::Dynamic,1>& decision);
+ *
+ *   template<typename Scalar>
+ *   void computeConstraints(Eigen::Matrix<Scalar,Eigen::Dynamic,1>& constraint,
+ *                           const Eigen::Matrix<Scalar,Eigen::Dynamic,1>& decision);
+ *
+ * Note that the Jacobian and Hessian are described as dense, and the Hessian is computed by
+ * forward-over-forward differentiation, so this layer is suitable for small and medium problems
+ */
+template<class TDerived>
+class AutoDiffOptimizationModel : public OptimizationModel
+{
+	public:
+		/** @brief First-order scalar, i.e. value and gradient */
+		typedef Eigen::AutoDiffScalar<Eigen::VectorXd> ADScalar;
+		typedef Eigen::Matrix<ADScalar,Eigen::Dynamic,1> ADVector;
+
+		/** @brief Second-order scalar, i.e. value, gradient and Hessian */
+		typedef Eigen::AutoDiffScalar<ADVector> AD2Scalar;
+		typedef Eigen::Matrix<AD2Scalar,Eigen::Dynamic,1> AD2Vector;
+
+		/** @brief Constructor function */
+		AutoDiffOptimizationModel();
+
+		/** @brief Destructor function */
+		virtual ~AutoDiffOptimizationModel();
+
+		/**
+		 * @brief Initializes the number of nonzero values of the Jacobian and Hessian, which
+		 * are dense. The derived class has to set the state and constraint dimensions before
+		 * calling this function
+		 * @param bool Imposes the constraints as soft (not used)
+		 */
+		virtual void init(bool only_soft_constraints = false);
+
+		/**
+		 * @brief Evaluates the cost function given a current decision state
+		 * @param double& Value of the objective function ($f(x)$).
+		 * @param const double* Array of the decision variables, $x$
+		 * @param int Number of decision variables (dimension of $x$)
+		 */
+		void evaluateCosts(double& cost,
+						   const double* decision, int decision_dim);
+
+		/**
+		 * @brief Evaluates the exact gradient of the cost function
+		 * @param double* Array of values for the gradient of the objective function ($\nabla f(x)$)
+		 * @param int Number of decision variables (dimension of $x$)
+		 * @param const double* Array for the decision variables, $x$
+		 * @param int Number of decision variables (dimension of $x$)
+		 */
+		void evaluateCostGradient(double* gradient, int grad_dim,
+								  const double* decision, int decision_dim);
+
+		/**
+		 * @brief Evaluates the constraint function given a current decision state
+		 * @param double* Array of constraint function values, $g(x)$
+		 * @param int Number of constraint variables (dimension of $g(x)$)
+		 * @param const double* Array of the decision variables, $x$
+		 * @param int Number of decision variables (dimension of $x$)
+		 */
+		void evaluateConstraints(double* constraint, int constraint_dim,
+								 const double* decision, int decision_dim);
+
+		/**
+		 * @brief Evaluates the exact Jacobian of the constraint function (dense structure)
+		 * @param double* Values of the entries in the Jacobian of the constraints
+		 * @param int Number of nonzero elements in the Jacobian (dimension of values)
+		 * @param int* Row indices of entries in the Jacobian of the constraints
+		 * @param int Number of nonzero elements in the Jacobian (dimension of row_entries)
+		 * @param int* Column indices of entries in the Jacobian of the constraints
+		 * @param int Number of nonzero elements in the Jacobian (dimension of col_entries)
+		 * @param const double* Array for the decision variables, $x$
+		 * @param int Number of decision variables (dimension of $x$)
+		 * @param bool True if it's only required the structure of the Jacobian
+		 */
+		void evaluateConstraintJacobian(double* jacobian_values, int nonzero_dim1,
+										int* row_entries, int nonzero_dim2,
+										int* col_entries, int nonzero_dim3,
+										const double* decision, int decision_dim, bool flag);
+
+		/**
+		 * @brief Evaluates the exact Hessian of the Lagrangian, i.e.
+		 * $\sigma_f \nabla^2 f(x) + \sum_i \lambda_i \nabla^2 g_i(x)$. The structure is the
+		 * dense lower-left triangle
+		 * @param double* Values of the entries in the Hessian
+		 * @param int Number of nonzero elements in the Hessian (dimension of values)
+		 * @param int* Row indices of entries in the Hessian
+		 * @param int Number of nonzero elements in the Hessian (dimension of row_entries)
+		 * @param int* Column indices of entries in the Hessian
+		 * @param int Number of nonzero elements in the Hessian (dimension of col_entries)
+		 * @param double Factor in front of the objective term in the Hessian, $\sigma_f$
+		 * @param const double* Values for the constraint multipliers, $\lambda$
+		 * @param int Number of constraint variables (dimension of $g(x)$)
+		 * @param const double* Values for the primal variables, $x$
+		 * @param int Number of decision variables (dimension of $x$)
+		 * @param bool True if it's only required the structure of the Hessian
+		 */
+		void evaluateLagrangianHessian(double* hessian_values, int nonzero_dim1,
+									   int* row_entries, int nonzero_dim2,
+									   int* col_entries, int nonzero_dim3,
+									   double obj_factor,
+									   const double* lagrange, int constraint_dim,
+									   const double* decision, int decision_dim,
+									   bool flag);
+
+
+	private:
+		/** @brief Gets the derived optimization model */
+		TDerived& derived();
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#include <dwl/model/impl/AutoDiffOptimizationModel.hpp>
+
+#endif
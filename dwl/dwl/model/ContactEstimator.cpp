@@ -0,0 +1,244 @@
+#include <dwl/model/ContactEstimator.h>
+#include <algorithm>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+ContactEstimator::ContactEstimator() : dynamics_(NULL), activation_force_(30.),
+		deactivation_force_(15.), velocity_threshold_(0.3), debounce_ticks_(1),
+		jacobian_tol_(0.), num_factorizations_(0)
+{
+
+}
+
+
+ContactEstimator::~ContactEstimator()
+{
+
+}
+
+
+void ContactEstimator::reset(WholeBodyDynamics* dynamics,
+							 const rbd::BodySelector& contacts)
+{
+	dynamics_ = dynamics;
+
+	// Getting the branches of the contacts. Note that only the end-effectors of the
+	// floating-base system can be estimated
+	FloatingBaseSystem& system = dynamics_->getFloatingBaseSystem();
+	const rbd::BodySelector& end_effectors = system.getEndEffectorNames();
+	unsigned int base_dof = system.getSystemDoF() - system.getJointDoF();
+	contacts_.clear();
+	branch_index_.clear();
+	branch_dof_.clear();
+	end_effector_index_.clear();
+	force_map_.clear();
+	for (unsigned int i = 0; i < contacts.size(); i++) {
+		rbd::BodySelector::const_iterator ee_it =
+				std::find(end_effectors.begin(), end_effectors.end(), contacts[i]);
+		if (ee_it == end_effectors.end()) {
+			printf(YELLOW "Warning: %s isn't an end-effector, it's not estimated\n"
+					COLOR_RESET, contacts[i].c_str());
+			continue;
+		}
+
+		unsigned int q_index, num_dof;
+		system.getBranch(q_index, num_dof, contacts[i]);
+		contacts_.push_back(contacts[i]);
+		branch_index_.push_back(q_index - base_dof);
+		branch_dof_.push_back(num_dof);
+		end_effector_index_.push_back(ee_it - end_effectors.begin());
+		force_map_.push_back(Eigen::MatrixXd::Zero(3, num_dof));
+	}
+
+	// Allocating the workspace of the update
+	unsigned int num_contacts = contacts_.size();
+	fixed_jac_.setZero(3 * num_contacts, system.getJointDoF());
+	estimated_joint_forces_.setZero(system.getJointDoF());
+	joint_force_error_.setZero(system.getJointDoF());
+	factorized_joint_pos_.setZero(system.getJointDoF());
+	ext_force_.reset(end_effectors);
+	end_effector_vel_.reset(end_effectors);
+	contact_forces_.reset(contacts_);
+
+	// Resetting the contact states
+	is_factorized_.assign(num_contacts, false);
+	active_.assign(num_contacts, false);
+	evidence_ticks_.assign(num_contacts, 0);
+	num_factorizations_ = 0;
+}
+
+
+void ContactEstimator::setForceThresholds(double activation,
+										  double deactivation)
+{
+	if (deactivation > activation) {
+		printf(YELLOW "Warning: the deactivation threshold is bigger than the activation one,"
+				" so it's set equals to the activation one\n" COLOR_RESET);
+		deactivation = activation;
+	}
+
+	activation_force_ = activation;
+	deactivation_force_ = deactivation;
+}
+
+
+void ContactEstimator::setVelocityThreshold(double velocity)
+{
+	velocity_threshold_ = velocity;
+}
+
+
+void ContactEstimator::setDebounceTicks(unsigned int ticks)
+{
+	debounce_ticks_ = ticks;
+}
+
+
+void ContactEstimator::setJacobianTolerance(double tolerance)
+{
+	jacobian_tol_ = tolerance;
+}
+
+
+bool ContactEstimator::update(const rbd::Vector6d& base_pos,
+							  const Eigen::VectorXd& joint_pos,
+							  const rbd::Vector6d& base_vel,
+							  const Eigen::VectorXd& joint_vel,
+							  const rbd::Vector6d& base_acc,
+							  const Eigen::VectorXd& joint_acc,
+							  const Eigen::VectorXd& joint_forces)
+{
+	if (dynamics_ == NULL) {
+		printf(RED "FATAL: the contact estimator wasn't reset\n" COLOR_RESET);
+		return false;
+	}
+
+	// Computing the joint force error with respect to the inverse dynamics without contact
+	// forces. Note that this overload uses the preallocated workspace of the dynamics
+	dynamics_->computeInverseDynamics(base_wrench_, estimated_joint_forces_,
+									  base_pos, joint_pos,
+									  base_vel, joint_vel,
+									  base_acc, joint_acc,
+									  ext_force_);
+	joint_force_error_ = estimated_joint_forces_ - joint_forces;
+
+	// Detecting the branches that moved more than the tolerance since the computation of
+	// their force maps
+	unsigned int num_contacts = contacts_.size();
+	bool update_jacobian = false;
+	for (unsigned int i = 0; i < num_contacts; i++) {
+		if (is_factorized_[i]) {
+			unsigned int first = branch_index_[i], num_dof = branch_dof_[i];
+			double displacement = (joint_pos.segment(first, num_dof) -
+					factorized_joint_pos_.segment(first, num_dof)).cwiseAbs().maxCoeff();
+			if (displacement > jacobian_tol_)
+				is_factorized_[i] = false;
+		}
+		update_jacobian = update_jacobian || !is_factorized_[i];
+	}
+
+	// Computing the stacked fixed-base jacobian (w.r.t. the base frame) once, and the force
+	// maps of the moved branches, i.e. f = (J J^T)^-1 J tau. Note that the 3-row block has a
+	// fixed-size Gram matrix
+	if (update_jacobian) {
+		dynamics_->getWholeBodyKinematics().computeContactJacobian(fixed_jac_,
+																   rbd::Vector6d::Zero(),
+																   joint_pos,
+																   contacts_, true);
+		for (unsigned int i = 0; i < num_contacts; i++) {
+			if (is_factorized_[i])
+				continue;
+
+			math::dampedPseudoInverse(force_map_[i],
+									  fixed_jac_.block<3,Eigen::Dynamic>(3 * i, branch_index_[i],
+																		 3, branch_dof_[i]).transpose());
+			factorized_joint_pos_.segment(branch_index_[i], branch_dof_[i]) =
+					joint_pos.segment(branch_index_[i], branch_dof_[i]);
+			is_factorized_[i] = true;
+			++num_factorizations_;
+		}
+	}
+
+	// Computing the end-effector velocities for the kinematic evidence
+	bool kinematic_evidence = velocity_threshold_ > 0.;
+	if (kinematic_evidence)
+		dynamics_->getWholeBodyKinematics().computeVelocity(end_effector_vel_,
+															base_pos, joint_pos,
+															base_vel, joint_vel);
+
+	// Computing the contact forces and updating the contact states
+	for (unsigned int i = 0; i < num_contacts; i++) {
+		contact_forces_[i].head<3>().setZero();
+		contact_forces_[i].tail<3>().noalias() = force_map_[i] *
+				joint_force_error_.segment(branch_index_[i], branch_dof_[i]);
+
+		double speed = 0.;
+		if (kinematic_evidence)
+			speed = end_effector_vel_[end_effector_index_[i]].norm();
+		updateContactState(i, contact_forces_[i].norm(), speed);
+	}
+
+	return true;
+}
+
+
+const rbd::BodyContainer6d& ContactEstimator::getContactForces() const
+{
+	return contact_forces_;
+}
+
+
+void ContactEstimator::getActiveContacts(rbd::BodySelector& active_contacts) const
+{
+	active_contacts.clear();
+	for (unsigned int i = 0; i < contacts_.size(); i++) {
+		if (active_[i])
+			active_contacts.push_back(contacts_[i]);
+	}
+}
+
+
+bool ContactEstimator::isActive(unsigned int index) const
+{
+	return active_[index];
+}
+
+
+unsigned int ContactEstimator::getNumberOfFactorizations() const
+{
+	return num_factorizations_;
+}
+
+
+void ContactEstimator::updateContactState(unsigned int index,
+										  double force,
+										  double speed)
+{
+	// Fusing the force and kinematic evidence. A swinging end-effector has a small force, so
+	// a fast one only deactivates the contact with weak force evidence
+	bool fast = velocity_threshold_ > 0. && speed > velocity_threshold_;
+	bool switching = false;
+	if (active_[index])
+		switching = force < deactivation_force_ || (fast && force < activation_force_);
+	else
+		switching = force > activation_force_ && !fast;
+
+	// Switching the contact state after the debounce ticks
+	if (switching)
+		++evidence_ticks_[index];
+	else
+		evidence_ticks_[index] = 0;
+
+	if (evidence_ticks_[index] >= debounce_ticks_ && switching) {
+		active_[index] = !active_[index];
+		evidence_ticks_[index] = 0;
+	}
+}
+
+} //@namespace model
+} //@namespace dwl
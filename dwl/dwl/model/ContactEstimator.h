@@ -0,0 +1,176 @@
+#ifndef DWL__MODEL__CONTACT_ESTIMATOR__H
+#define DWL__MODEL__CONTACT_ESTIMATOR__H
+
+#include <dwl/model/WholeBodyDynamics.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class ContactEstimator
+ * @brief Stateful estimator of the contact states and forces of a set of end-effectors, i.e.
+ * the incremental counterpart of WholeBodyDynamics::estimateActiveContactsAndForces. The
+ * contact forces are computed from the joint-force error of the inverse dynamics as in
+ * WholeBodyDynamics::estimateContactForces, but the branch force map, i.e. (J J^T)^-1 J, is
+ * kept between updates and it's only recomputed for the branches that moved more than a
+ * tolerance. The contact state fuses the force evidence with the end-effector velocity
+ * (kinematic evidence), and it has hysteresis (activation/deactivation thresholds) and a
+ * debounce of consecutive ticks. The workspace is allocated in reset, so an update doesn't
+ * allocate heap memory (except for rank-deficient branches)
+ */
+class ContactEstimator
+{
+	public:
+		/** @brief Constructor function */
+		ContactEstimator();
+
+		/** @brief Destructor function */
+		~ContactEstimator();
+
+		/**
+		 * @brief Resets the estimator, i.e. the whole-body dynamics, the set of contacts,
+		 * their workspace and their states (inactive)
+		 * @param WholeBodyDynamics* Whole-body dynamics
+		 * @param const rbd::BodySelector& Set of end-effectors (bodies)
+		 */
+		void reset(WholeBodyDynamics* dynamics,
+				   const rbd::BodySelector& contacts);
+
+		/**
+		 * @brief Sets the force thresholds of the hysteresis, i.e. a contact is activated
+		 * above the first one and deactivated below the second one
+		 * @param double Activation force threshold
+		 * @param double Deactivation force threshold
+		 */
+		void setForceThresholds(double activation,
+								double deactivation);
+
+		/**
+		 * @brief Sets the velocity threshold of the kinematic evidence, i.e. a contact isn't
+		 * activated while its end-effector moves faster, and it's deactivated if its force is
+		 * below the activation threshold too. A non-positive value disables the kinematic
+		 * evidence, and then the end-effector velocities aren't computed
+		 * @param double Velocity threshold
+		 */
+		void setVelocityThreshold(double velocity);
+
+		/**
+		 * @brief Sets the number of consecutive ticks that the evidence has to hold before
+		 * switching the contact state
+		 * @param unsigned int Number of ticks
+		 */
+		void setDebounceTicks(unsigned int ticks);
+
+		/**
+		 * @brief Sets the tolerance of the branch joint positions for reusing the force map,
+		 * i.e. it's recomputed when the maximum change since its computation is bigger. Note
+		 * that the force error is first order in this tolerance, and a zero value recomputes
+		 * the force map whenever the branch moves
+		 * @param double Tolerance of the joint positions
+		 */
+		void setJacobianTolerance(double tolerance);
+
+		/**
+		 * @brief Updates the contact forces and states given the measured joint forces
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const rbd::Vector6d& Base acceleration with respect to a
+		 * gravity field
+		 * @param const Eigen::VectorXd& Joint acceleration
+		 * @param const Eigen::VectorXd& Joint forces
+		 * @return bool False if the estimator wasn't reset
+		 */
+		bool update(const rbd::Vector6d& base_pos,
+					const Eigen::VectorXd& joint_pos,
+					const rbd::Vector6d& base_vel,
+					const Eigen::VectorXd& joint_vel,
+					const rbd::Vector6d& base_acc,
+					const Eigen::VectorXd& joint_acc,
+					const Eigen::VectorXd& joint_forces);
+
+		/**
+		 * @brief Gets the estimated contact forces (in the base frame), which are indexed as
+		 * the set of contacts
+		 */
+		const rbd::BodyContainer6d& getContactForces() const;
+
+		/**
+		 * @brief Gets the active contacts
+		 * @param rbd::BodySelector& Active contacts
+		 */
+		void getActiveContacts(rbd::BodySelector& active_contacts) const;
+
+		/**
+		 * @brief Indicates if a contact is active
+		 * @param unsigned int Index of the contact in the set of contacts
+		 */
+		bool isActive(unsigned int index) const;
+
+		/** @brief Gets the number of force-map computations since the last reset */
+		unsigned int getNumberOfFactorizations() const;
+
+
+	private:
+		/**
+		 * @brief Updates the state of a contact with the hysteresis and debounce
+		 * @param unsigned int Index of the contact
+		 * @param double Contact force magnitude
+		 * @param double End-effector speed
+		 */
+		void updateContactState(unsigned int index,
+								double force,
+								double speed);
+
+		/** @brief Whole-body dynamics */
+		WholeBodyDynamics* dynamics_;
+
+		/** @brief Set of contacts, their branches, i.e. first joint and number of joints,
+		 * and their end-effector indexes */
+		rbd::BodySelector contacts_;
+		std::vector<unsigned int> branch_index_;
+		std::vector<unsigned int> branch_dof_;
+		std::vector<unsigned int> end_effector_index_;
+
+		/** @brief Force maps of the branches, i.e. (J J^T)^-1 J, and the joint positions of
+		 * their computation */
+		std::vector<Eigen::MatrixXd> force_map_;
+		Eigen::VectorXd factorized_joint_pos_;
+		std::vector<bool> is_factorized_;
+
+		/** @brief Workspace of the update */
+		Eigen::MatrixXd fixed_jac_;
+		Eigen::MatrixXd branch_jac_;
+		Eigen::VectorXd estimated_joint_forces_;
+		Eigen::VectorXd joint_force_error_;
+		rbd::Vector6d base_wrench_;
+		rbd::BodyContainer6d ext_force_;
+		rbd::BodyContainer3d end_effector_vel_;
+
+		/** @brief Estimated contact forces */
+		rbd::BodyContainer6d contact_forces_;
+
+		/** @brief Contact states and the number of consecutive ticks of switching evidence */
+		std::vector<bool> active_;
+		std::vector<unsigned int> evidence_ticks_;
+
+		/** @brief Parameters of the estimator */
+		double activation_force_;
+		double deactivation_force_;
+		double velocity_threshold_;
+		unsigned int debounce_ticks_;
+		double jacobian_tol_;
+
+		/** @brief Number of force-map computations */
+		unsigned int num_factorizations_;
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
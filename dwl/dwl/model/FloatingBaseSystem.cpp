@@ -1,4 +1,6 @@
 #include <dwl/model/FloatingBaseSystem.h>
+#include <dwl/model/ModelRegistry.h>
+#include <dwl/model/GeneratedModel.h>
 
 
 namespace dwl
@@ -7,12 +9,19 @@ namespace dwl
 namespace model
 {
 
+FloatingBaseDescription::FloatingBaseDescription(bool full, unsigned int _num_joints) :
+		num_system_joints(0), num_floating_joints(6 * full),
+		num_joints(_num_joints), floating_ax(full), floating_ay(full),
+		floating_az(full), floating_lx(full), floating_ly(full),
+		floating_lz(full), total_mass(0.), type_of_system(FixedBase), num_end_effectors(0),
+		num_feet(0), grav_acc(0.)
+{
+
+}
+
+
 FloatingBaseSystem::FloatingBaseSystem(bool full, unsigned int _num_joints) :
-		num_system_joints_(0), num_floating_joints_(6 * full),
-		num_joints_(_num_joints), floating_ax_(full), floating_ay_(full),
-		floating_az_(full), floating_lx_(full), floating_ly_(full),
-		floating_lz_(full), type_of_system_(FixedBase), num_end_effectors_(0),
-		num_feet_(0), grav_acc_(0.)
+		description_(new FloatingBaseDescription(full, _num_joints))
 {
 
 }
@@ -34,29 +43,48 @@ void FloatingBaseSystem::resetFromURDFFile(const std::string& urdf_file,
 void FloatingBaseSystem::resetFromURDFModel(const std::string& urdf_model,
 											const std::string& system_file)
 {
+	// Copying the registered system, which is parsed in the first request of these models
+	*this = *ModelRegistry::getFloatingBaseSystem(urdf_model, system_file);
+	kinematics_cache_.invalidate();
+
+	// Using the generated kinematics and dynamics of this model, if there are
+	kinematics_cache_.setGeneratedModel(GeneratedModelRegistry::find(rbd_model_));
+}
+
+
+void FloatingBaseSystem::parseURDFModel(const std::string& urdf_model,
+										const std::string& system_file)
+{
+	// Getting the mutable description. Note that the registry parses the models in a new
+	// system, so the description isn't shared
+	FloatingBaseDescription& description = getMutableDescription();
+
 	// Getting the RBDL model from URDF model
 	RigidBodyDynamics::Model rbd;
 	RigidBodyDynamics::Addons::URDFReadFromString(urdf_model.c_str(), &rbd, false);
 	rbd_model_ = rbd;
-	urdf_ = urdf_model;
-	yarf_ = system_file;
+	kinematics_cache_.invalidate();
+	description.urdf = urdf_model;
+	description.yarf = system_file;
+
+	// Parsing the URDF-XML once for all the tables of the model
+	urdf_model::ModelTables tables;
+	urdf_model::getModelTables(tables, urdf::parseURDF(urdf_model));
 
 	// Getting information about the floating-base joints
-	urdf_model::JointID floating_joint_names;
-	urdf_model::getJointNames(floating_joint_names, urdf_model, urdf_model::floating);
-	num_floating_joints_ = floating_joint_names.size();
-
-	urdf_model::JointID floating_joint_motions;
-	if (num_floating_joints_ > 0) {
-		urdf_model::getFloatingBaseJointMotion(floating_joint_motions, urdf_model);
-		for (urdf_model::JointID::iterator jnt_it = floating_joint_motions.begin();
+	const urdf_model::JointID& floating_joint_names = tables.floating_joints;
+	description.num_floating_joints = floating_joint_names.size();
+
+	const urdf_model::JointID& floating_joint_motions = tables.floating_joint_motions;
+	if (description.num_floating_joints > 0) {
+		for (urdf_model::JointID::const_iterator jnt_it = floating_joint_motions.begin();
 				jnt_it != floating_joint_motions.end(); jnt_it++) {
 			std::string joint_name = jnt_it->first;
 			unsigned int joint_motion = jnt_it->second;
 			unsigned int joint_id = floating_joint_names.find(joint_name)->second;
 
 			// Setting the floating-base joint names
-			floating_joint_names_.push_back(joint_name);
+			description.floating_joint_names.push_back(joint_name);
 
 			// Setting the floating joint information
 			FloatingBaseJoint joint(true, joint_id, joint_name);
@@ -75,27 +103,26 @@ void FloatingBaseSystem::resetFromURDFModel(const std::string& urdf_model,
 		base_id = 6;
 	else
 		base_id = getFloatingBaseDoF();
-	floating_body_name_ = rbd_model_.GetBodyName(base_id);
+	description.floating_body_name = rbd_model_.GetBodyName(base_id);
 
 	// Getting the information about the actuated joints
-	urdf_model::JointID free_joint_names;
-	urdf_model::getJointNames(free_joint_names, urdf_model, urdf_model::free);
-	urdf_model::getJointLimits(joint_limits_, urdf_model);
+	const urdf_model::JointID& free_joint_names = tables.free_joints;
+	description.joint_limits = tables.joint_limits;
 	unsigned int num_free_joints = free_joint_names.size();
-	num_joints_ = num_free_joints - num_floating_joints_;
-	for (urdf_model::JointID::iterator jnt_it = free_joint_names.begin();
+	description.num_joints = num_free_joints - description.num_floating_joints;
+	for (urdf_model::JointID::const_iterator jnt_it = free_joint_names.begin();
 			jnt_it != free_joint_names.end(); jnt_it++) {
 		std::string joint_name = jnt_it->first;
-		unsigned int joint_id = jnt_it->second - num_floating_joints_;
+		unsigned int joint_id = jnt_it->second - description.num_floating_joints;
 
 		// Checking if it's a virtual floating-base joint
-		if (num_floating_joints_ > 0) {
+		if (description.num_floating_joints > 0) {
 			if (floating_joint_names.find(joint_name) == floating_joint_names.end()) {
 				// Setting the actuated joint information
 				Joint joint(joint_id, joint_name);
 				setJoint(joint);
 			}
-		} else if (num_floating_joints_ == 0) {
+		} else if (description.num_floating_joints == 0) {
 			// Setting the actuated joint information
 			Joint joint(joint_id, joint_name);
 			setJoint(joint);
@@ -107,46 +134,71 @@ void FloatingBaseSystem::resetFromURDFModel(const std::string& urdf_model,
 	for (dwl::urdf_model::JointID::const_iterator joint_it = joints.begin();
 			joint_it != joints.end(); joint_it++) {
 		std::string joint_name = joint_it->first;
-		joint_names_.push_back(joint_name);
+		description.joint_names.push_back(joint_name);
+		description.joint_ids.push_back(joint_it->second);
 	}
 
 	// Getting the floating-base system information
-	num_system_joints_ = num_floating_joints_ + num_joints_;
+	description.num_system_joints = description.num_floating_joints + description.num_joints;
 	if (isFullyFloatingBase()) {
-		num_system_joints_ = 6 + num_joints_;
+		description.num_system_joints = 6 + description.num_joints;
 		if (hasFloatingBaseConstraints())
-			type_of_system_ = ConstrainedFloatingBase;
+			description.type_of_system = ConstrainedFloatingBase;
 		else
-			type_of_system_ = FloatingBase;
-	} else if (num_floating_joints_ > 0)
-		type_of_system_ = VirtualFloatingBase;
+			description.type_of_system = FloatingBase;
+	} else if (description.num_floating_joints > 0)
+		description.type_of_system = VirtualFloatingBase;
 	else
-		type_of_system_ = FixedBase;
+		description.type_of_system = FixedBase;
 
 	// Getting the end-effectors information
-	urdf_model::getEndEffectors(end_effectors_, urdf_model);
+	description.end_effectors = tables.end_effectors;
 
 	// Getting the end-effector name list
-	for (dwl::urdf_model::LinkID::const_iterator ee_it = end_effectors_.begin();
-			ee_it != end_effectors_.end(); ee_it++) {
+	for (dwl::urdf_model::LinkID::const_iterator ee_it = description.end_effectors.begin();
+			ee_it != description.end_effectors.end(); ee_it++) {
 		std::string name = ee_it->first;
-		end_effector_names_.push_back(name);
+		description.end_effector_names.push_back(name);
 	}
 
 	// Resetting the system description
-	default_joint_pos_ = Eigen::VectorXd::Zero(num_joints_);
+	description.default_joint_pos = Eigen::VectorXd::Zero(description.num_joints);
 	if (!system_file.empty())
 		resetSystemDescription(system_file);
 
 	// Defining the number of end-effectors
-	num_end_effectors_ = end_effectors_.size();
+	description.num_end_effectors = description.end_effectors.size();
+
+	// Resolving the body ids, indexes and branches of the end-effectors, so the inner loops
+	// don't walk the kinematic tree
+	description.end_effector_body_ids.clear();
+	description.end_effector_indexes.clear();
+	description.branch_pos_indexes.clear();
+	description.branch_num_dofs.clear();
+	description.branch_body_ids.clear();
+	description.branch_subtree_ids.clear();
+	for (unsigned int i = 0; i < description.end_effector_names.size(); i++) {
+		std::string name = description.end_effector_names[i];
+		unsigned int body_id = rbd_model_.GetBodyId(name.c_str());
+		unsigned int pos_idx = 0, num_dof = 0;
+		computeBranch(pos_idx, num_dof, body_id);
+		description.end_effector_body_ids.push_back(body_id);
+		description.end_effector_indexes[name] = i;
+		description.branch_pos_indexes.push_back(pos_idx);
+		description.branch_num_dofs.push_back(num_dof);
+
+		std::vector<unsigned int> branch_bodies, subtree_bodies;
+		computeBranchBodies(branch_bodies, subtree_bodies, body_id);
+		description.branch_body_ids.push_back(branch_bodies);
+		description.branch_subtree_ids.push_back(subtree_bodies);
+	}
 
-	if (num_feet_ == 0) {
+	if (description.num_feet == 0) {
 		printf(YELLOW "Warning: setting up all the end-effectors are feet\n"
 				COLOR_RESET);
-		num_feet_ = num_end_effectors_;
-		foot_names_ = end_effector_names_;
-		feet_ = end_effectors_;
+		description.num_feet = description.num_end_effectors;
+		description.foot_names = description.end_effector_names;
+		description.feet = description.end_effectors;
 	}
 
 	// Resizing the state vectors
@@ -161,14 +213,21 @@ void FloatingBaseSystem::resetFromURDFModel(const std::string& urdf_model,
 	}
 	joint_state_.resize(getJointDoF());
 
+	// Getting the total mass
+	description.total_mass = 0.;
+	for (unsigned int i = 0; i < rbd_model_.mBodies.size(); i++)
+		description.total_mass += rbd_model_.mBodies[i].mMass;
+
 	// Getting gravity information
-	grav_acc_ = rbd_model_.gravity.norm();
-	grav_dir_ = rbd_model_.gravity / grav_acc_;
+	description.grav_acc = rbd_model_.gravity.norm();
+	description.grav_dir = rbd_model_.gravity / description.grav_acc;
 }
 
 
 void FloatingBaseSystem::resetSystemDescription(const std::string& filename)
 {
+	FloatingBaseDescription& description = getMutableDescription();
+
 	// Yaml reader
 	YamlWrapper yaml_reader(filename);
 
@@ -178,34 +237,34 @@ void FloatingBaseSystem::resetSystemDescription(const std::string& filename)
 	YamlNamespace pose_ns = {robot, "default_pose"};
 
 	// Reading and setting up the foot names
-	if (yaml_reader.read(foot_names_, "feet", robot_ns)) {
+	if (yaml_reader.read(description.foot_names, "feet", robot_ns)) {
 		// Ordering the foot names
 		using namespace std::placeholders;
-		std::sort(foot_names_.begin(),
-				  foot_names_.end(),
+		std::sort(description.foot_names.begin(),
+				  description.foot_names.end(),
 				  std::bind(&FloatingBaseSystem::compareString, this, _1, _2)); 
 
 		// Getting the number of foot
-		num_feet_ = foot_names_.size();
+		description.num_feet = description.foot_names.size();
 
 		// Adding to the feet to the end-effector lists if it doesn't exist
-		for (unsigned int i = 0; i < foot_names_.size(); i++) {
-			std::string name = foot_names_[i];
-			if (end_effectors_.count(name) == 0) {
-				unsigned int id = end_effectors_.size() + 1;
-				end_effectors_[name] = id;
-				end_effector_names_.push_back(name);
+		for (unsigned int i = 0; i < description.foot_names.size(); i++) {
+			std::string name = description.foot_names[i];
+			if (description.end_effectors.count(name) == 0) {
+				unsigned int id = description.end_effectors.size() + 1;
+				description.end_effectors[name] = id;
+				description.end_effector_names.push_back(name);
 			}
 		}
 	}
 
 	// Reading the default posture of the robot
-	for (unsigned int j = 0; j < num_joints_; j++) {
-		std::string name = joint_names_[j];
+	for (unsigned int j = 0; j < description.num_joints; j++) {
+		std::string name = description.joint_names[j];
 
 		double joint_pos = 0.;
 		if (yaml_reader.read(joint_pos, name, pose_ns)) {
-			default_joint_pos_(j) = joint_pos;
+			description.default_joint_pos(j) = joint_pos;
 		}
 	}
 }
@@ -213,95 +272,118 @@ void FloatingBaseSystem::resetSystemDescription(const std::string& filename)
 
 void FloatingBaseSystem::setFloatingBaseJoint(const FloatingBaseJoint& joint)
 {
+	FloatingBaseDescription& description = getMutableDescription();
 	FloatingBaseJoint new_joint = joint;
 	new_joint.id = rbd::AX;
-	floating_ax_ = new_joint;
+	description.floating_ax = new_joint;
 
 	new_joint.id = rbd::AY;
-	floating_ay_ = new_joint;
+	description.floating_ay = new_joint;
 
 	new_joint.id = rbd::AZ;
-	floating_az_ = new_joint;
+	description.floating_az = new_joint;
 
 	new_joint.id = rbd::LX;
-	floating_lx_ = new_joint;
+	description.floating_lx = new_joint;
 
 	new_joint.id = rbd::LY;
-	floating_ly_ = new_joint;
+	description.floating_ly = new_joint;
 
 	new_joint.id = rbd::LZ;
-	floating_lz_ = new_joint;
+	description.floating_lz = new_joint;
 }
 
 
 void FloatingBaseSystem::setFloatingBaseJoint(const FloatingBaseJoint& joint,
 											  rbd::Coords6d joint_coord)
 {
+	FloatingBaseDescription& description = getMutableDescription();
 	if (joint_coord == rbd::AX)
-		floating_ax_ = joint;
+		description.floating_ax = joint;
 	else if (joint_coord == rbd::AY)
-		floating_ay_ = joint;
+		description.floating_ay = joint;
 	else if (joint_coord == rbd::AZ)
-		floating_az_ = joint;
+		description.floating_az = joint;
 	else if (joint_coord == rbd::LX)
-		floating_lx_ = joint;
+		description.floating_lx = joint;
 	else if (joint_coord == rbd::LY)
-		floating_ly_ = joint;
+		description.floating_ly = joint;
 	else
-		floating_lz_ = joint;
+		description.floating_lz = joint;
 }
 
 
 void FloatingBaseSystem::setJoint(const Joint& joint)
 {
-	joints_[joint.name] = joint.id;
+	FloatingBaseDescription& description = getMutableDescription();
+	description.joints[joint.name] = joint.id;
 }
 
 
 void FloatingBaseSystem::setFloatingBaseConstraint(rbd::Coords6d joint_id)
 {
+	FloatingBaseDescription& description = getMutableDescription();
 	if (joint_id == rbd::AX)
-		floating_ax_.constrained = true;
+		description.floating_ax.constrained = true;
 	else if (joint_id == rbd::AY)
-		floating_ay_.constrained = true;
+		description.floating_ay.constrained = true;
 	else if (joint_id == rbd::AZ)
-		floating_az_.constrained = true;
+		description.floating_az.constrained = true;
 	else if (joint_id == rbd::LX)
-		floating_lx_.constrained = true;
+		description.floating_lx.constrained = true;
 	else if (joint_id == rbd::LY)
-		floating_ly_.constrained = true;
+		description.floating_ly.constrained = true;
 	else
-		floating_lz_.constrained = true;
+		description.floating_lz.constrained = true;
 }
 
 
 void FloatingBaseSystem::setTypeOfDynamicSystem(enum TypeOfSystem type_of_system)
 {
-	type_of_system_ = type_of_system;
+	FloatingBaseDescription& description = getMutableDescription();
+	description.type_of_system = type_of_system;
 }
 
 
 void FloatingBaseSystem::setSystemDoF(unsigned int num_dof)
 {
-	num_system_joints_ = num_dof;
+	FloatingBaseDescription& description = getMutableDescription();
+	description.num_system_joints = num_dof;
 }
 
 
 void FloatingBaseSystem::setJointDoF(unsigned int num_joints)
 {
-	num_joints_ = num_joints;
+	FloatingBaseDescription& description = getMutableDescription();
+	description.num_joints = num_joints;
+}
+
+
+const FloatingBaseDescription& FloatingBaseSystem::getDescription() const
+{
+	return *description_;
+}
+
+
+FloatingBaseDescription& FloatingBaseSystem::getMutableDescription()
+{
+	// Copying the description if it's shared with other systems (copy-on-write)
+	if (description_.use_count() > 1)
+		description_ = std::make_shared<FloatingBaseDescription>(*description_);
+
+	return *description_;
 }
 
 
 const std::string& FloatingBaseSystem::getURDFModel() const
 {
-	return urdf_;
+	return description_->urdf;
 }
 
 
 const std::string& FloatingBaseSystem::getYARFModel() const
 {
-	return yarf_;
+	return description_->yarf;
 }
 
 
@@ -311,14 +393,54 @@ RigidBodyDynamics::Model& FloatingBaseSystem::getRBDModel()
 }
 
 
-double FloatingBaseSystem::getTotalMass()
+const RigidBodyDynamics::Model& FloatingBaseSystem::getRBDModel() const
 {
-	double mass = 0.;
-	unsigned int num_bodies = rbd_model_.mBodies.size();
-	for (unsigned int i = 0; i < num_bodies; i++)
-		mass += rbd_model_.mBodies[i].mMass;
+	return rbd_model_;
+}
+
+
+const GeneratedModel* FloatingBaseSystem::getGeneratedModel() const
+{
+	return kinematics_cache_.getGeneratedModel();
+}
+
+
+void FloatingBaseSystem::updateKinematics(const Eigen::VectorXd& q,
+										  const Eigen::VectorXd* qd,
+										  const Eigen::VectorXd* qdd)
+{
+	kinematics_cache_.update(rbd_model_, q, qd, qdd);
+}
+
 
-	return mass;
+void FloatingBaseSystem::invalidateKinematics()
+{
+	kinematics_cache_.invalidate();
+}
+
+
+void FloatingBaseSystem::updateBranchKinematics(const Eigen::VectorXd& q,
+												unsigned int end_effector,
+												const Eigen::VectorXd* qd)
+{
+	if (qd == NULL && kinematics_cache_.isUpdated(q))
+		return;
+
+	assert(end_effector < description_->branch_body_ids.size());
+	if (qd == NULL) {
+		if (zero_velocity_.size() != rbd_model_.qdot_size)
+			zero_velocity_ = Eigen::VectorXd::Zero(rbd_model_.qdot_size);
+		qd = &zero_velocity_;
+	}
+	rbd::updateBranchKinematics(rbd_model_, q, *qd,
+								description_->branch_body_ids[end_effector]);
+	kinematics_cache_.invalidate();
+}
+
+
+double FloatingBaseSystem::getTotalMass() const
+{
+	return description_->total_mass;
 }
 
 
@@ -337,26 +459,34 @@ const Eigen::Vector3d& FloatingBaseSystem::getGravityVector() const
 
 const double& FloatingBaseSystem::getGravityAcceleration() const
 {
-	return grav_acc_;
+	return description_->grav_acc;
 }
 
 
 const Eigen::Vector3d& FloatingBaseSystem::getGravityDirection() const
 {
-	return grav_dir_;
+	return description_->grav_dir;
 }
 
 
 const Eigen::Vector3d& FloatingBaseSystem::getSystemCoM(const rbd::Vector6d& base_pos,
 														const Eigen::VectorXd& joint_pos)
 {
-	Eigen::VectorXd q = toGeneralizedJointState(base_pos, joint_pos);
-	Eigen::VectorXd qd = Eigen::VectorXd::Zero(num_system_joints_);
+	const Eigen::VectorXd& q = toGeneralizedJointState(base_pos, joint_pos);
 
-	double mass;
-	RigidBodyDynamics::Utils::CalcCenterOfMass(rbd_model_,
-											   q, qd, mass,
-											   com_system_);
+	// Averaging the body CoMs, where only the body transforms are updated, so the cached
+	// velocity isn't reset. Note that the body rotation is the transpose of the
+	// world-to-body one
+	kinematics_cache_.update(rbd_model_, q);
+	double mass = 0.;
+	com_system_.setZero();
+	for (unsigned int i = 1; i < rbd_model_.mBodies.size(); i++) {
+		const RigidBodyDynamics::Body& body = rbd_model_.mBodies[i];
+		mass += body.mMass;
+		com_system_ += body.mMass * (rbd_model_.X_base[i].r +
+				rbd_model_.X_base[i].E.transpose() * body.mCenterOfMass);
+	}
+	com_system_ /= mass;
 
 	return com_system_;
 }
@@ -371,17 +501,47 @@ const Eigen::Vector3d& FloatingBaseSystem::getSystemCoMRate(const rbd::Vector6d&
 	Eigen::VectorXd qd = toGeneralizedJointState(base_vel, joint_vel);
 
 	double mass;
+	kinematics_cache_.update(rbd_model_, q, &qd);
 	RigidBodyDynamics::Utils::CalcCenterOfMass(rbd_model_,
 											   q, qd, mass,
-											   com_system_, &comd_system_);
+											   com_system_, &comd_system_,
+											   NULL, false);
 
 	return comd_system_;
 }
 
 
+void FloatingBaseSystem::computeSystemCoMKinematics(Eigen::Vector3d& com_pos,
+													Eigen::Vector3d& com_vel,
+													Eigen::MatrixXd& com_jac,
+													Eigen::Vector3d& com_jacd_qd,
+													const rbd::Vector6d& base_pos,
+													const Eigen::VectorXd& joint_pos,
+													const rbd::Vector6d& base_vel,
+													const Eigen::VectorXd& joint_vel)
+{
+	// Note that the generalized position is copied since the generalized joint state is an
+	// internal buffer
+	Eigen::VectorXd q = toGeneralizedJointState(base_pos, joint_pos);
+	full_velocity_ = toGeneralizedJointState(base_vel, joint_vel);
+
+	kinematics_cache_.update(rbd_model_, q, &full_velocity_);
+	rbd::computeCoMKinematics(rbd_model_, q, full_velocity_,
+							  com_pos, com_vel, com_jac, com_jacd_qd, false);
+
+	if (isFullyFloatingBase()) {
+		// RBDL defines floating joints as (linear, angular)^T which is
+		// not consistent with our DWL standard, i.e. (angular, linear)^T
+		Eigen::Matrix3d linear_cols = com_jac.leftCols<3>();
+		com_jac.leftCols<3>() = com_jac.middleCols<3>(3);
+		com_jac.middleCols<3>(3) = linear_cols;
+	}
+}
+
+
 const Eigen::Vector3d& FloatingBaseSystem::getFloatingBaseCoM() const
 {
-	unsigned int body_id = rbd_model_.GetBodyId(floating_body_name_.c_str());
+	unsigned int body_id = rbd_model_.GetBodyId(description_->floating_body_name.c_str());
 	return rbd_model_.mBodies[body_id].mCenterOfMass;
 }
 
@@ -395,52 +555,52 @@ const Eigen::Vector3d& FloatingBaseSystem::getBodyCoM(const std::string& body_na
 
 const unsigned int& FloatingBaseSystem::getSystemDoF() const
 {
-	return num_system_joints_;
+	return description_->num_system_joints;
 }
 
 
 const unsigned int& FloatingBaseSystem::getFloatingBaseDoF() const
 {
-	return num_floating_joints_;
+	return description_->num_floating_joints;
 }
 
 
 const unsigned int& FloatingBaseSystem::getJointDoF() const
 {
-	return num_joints_;
+	return description_->num_joints;
 }
 
 
 const FloatingBaseJoint& FloatingBaseSystem::getFloatingBaseJoint(rbd::Coords6d joint) const
 {
 	if (joint == rbd::AX)
-		return floating_ax_;
+		return description_->floating_ax;
 	else if (joint == rbd::AY)
-		return floating_ay_;
+		return description_->floating_ay;
 	else if (joint == rbd::AZ)
-		return floating_az_;
+		return description_->floating_az;
 	else if (joint == rbd::LX)
-		return floating_lx_;
+		return description_->floating_lx;
 	else if (joint == rbd::LY)
-		return floating_ly_;
+		return description_->floating_ly;
 	else
-		return floating_lz_;
+		return description_->floating_lz;
 }
 
 
 unsigned int FloatingBaseSystem::getFloatingBaseJointCoordinate(unsigned int id)
 {
-	if (floating_ax_.active && floating_ax_.id == id)
+	if (description_->floating_ax.active && description_->floating_ax.id == id)
 		return rbd::AX;
-	else if (floating_ay_.active && floating_ay_.id == id)
+	else if (description_->floating_ay.active && description_->floating_ay.id == id)
 		return rbd::AY;
-	else if (floating_az_.active && floating_az_.id == id)
+	else if (description_->floating_az.active && description_->floating_az.id == id)
 		return rbd::AZ;
-	else if (floating_lx_.active && floating_lx_.id == id)
+	else if (description_->floating_lx.active && description_->floating_lx.id == id)
 		return rbd::LX;
-	else if (floating_ly_.active && floating_ly_.id == id)
+	else if (description_->floating_ly.active && description_->floating_ly.id == id)
 		return rbd::LY;
-	else if (floating_lz_.active && floating_lz_.id == id)
+	else if (description_->floating_lz.active && description_->floating_lz.id == id)
 		return rbd::LZ;
 	else {
 		printf(RED "ERROR: the %i id doesn't bellow to floating-base joint\n"
@@ -452,31 +612,37 @@ unsigned int FloatingBaseSystem::getFloatingBaseJointCoordinate(unsigned int id)
 
 const std::string& FloatingBaseSystem::getFloatingBaseName() const
 {
-	return floating_body_name_;
+	return description_->floating_body_name;
 }
 
 
 const unsigned int& FloatingBaseSystem::getJointId(const std::string& joint_name) const
 {
-	return joints_.find(joint_name)->second;
+	return description_->joints.find(joint_name)->second;
+}
+
+
+const std::vector<unsigned int>& FloatingBaseSystem::getJointIds() const
+{
+	return description_->joint_ids;
 }
 
 
 const urdf_model::JointID& FloatingBaseSystem::getJoints() const
 {
-	return joints_;
+	return description_->joints;
 }
 
 
 const urdf_model::JointLimits& FloatingBaseSystem::getJointLimits() const
 {
-	return joint_limits_;
+	return description_->joint_limits;
 }
 
 
 const urdf::JointLimits& FloatingBaseSystem::getJointLimit(const std::string& name) const
 {
-	return joint_limits_.find(name)->second;
+	return description_->joint_limits.find(name)->second;
 }
 
 
@@ -530,84 +696,115 @@ const double& FloatingBaseSystem::getEffortLimit(const urdf::JointLimits& joint)
 
 const rbd::BodySelector& FloatingBaseSystem::getFloatingJointNames() const
 {
-	return floating_joint_names_;
+	return description_->floating_joint_names;
 }
 
 
 const rbd::BodySelector& FloatingBaseSystem::getJointNames() const
 {
-	return joint_names_;
+	return description_->joint_names;
 }
 
 
 const std::string& FloatingBaseSystem::getFloatingBaseBody() const
 {
-	return floating_body_name_;
+	return description_->floating_body_name;
 }
 
 
 const enum TypeOfSystem& FloatingBaseSystem::getTypeOfDynamicSystem() const
 {
-	return type_of_system_;
+	return description_->type_of_system;
 }
 
 
 const unsigned int& FloatingBaseSystem::getNumberOfEndEffectors(enum TypeOfEndEffector type) const
 {
 	if (type == ALL)
-		return num_end_effectors_;
+		return description_->num_end_effectors;
 	else
-		return num_feet_;
+		return description_->num_feet;
 }
 
 
 const unsigned int& FloatingBaseSystem::getEndEffectorId(const std::string& contact_name) const
 {
-	return end_effectors_.find(contact_name)->second;
+	return description_->end_effectors.find(contact_name)->second;
+}
+
+
+unsigned int FloatingBaseSystem::getEndEffectorIndex(const std::string& contact_name) const
+{
+	urdf_model::LinkID::const_iterator index_it =
+			description_->end_effector_indexes.find(contact_name);
+	if (index_it == description_->end_effector_indexes.end())
+		return description_->end_effector_names.size();
+	else
+		return index_it->second;
 }
 
 
 const urdf_model::LinkID& FloatingBaseSystem::getEndEffectors(enum TypeOfEndEffector type) const
 {
 	if (type == ALL)
-		return end_effectors_;
+		return description_->end_effectors;
 	else
-		return feet_;
+		return description_->feet;
 }
 
 
 const rbd::BodySelector& FloatingBaseSystem::getEndEffectorNames(enum TypeOfEndEffector type) const
 {
 	if (type == ALL)
-		return end_effector_names_;
+		return description_->end_effector_names;
 	else
-		return foot_names_;
+		return description_->foot_names;
+}
+
+
+const std::vector<unsigned int>& FloatingBaseSystem::getEndEffectorBodyIds() const
+{
+	return description_->end_effector_body_ids;
+}
+
+
+const std::vector<unsigned int>& FloatingBaseSystem::getBranchBodyIds(unsigned int end_effector) const
+{
+	assert(end_effector < description_->branch_body_ids.size());
+	return description_->branch_body_ids[end_effector];
 }
 
 
-bool FloatingBaseSystem::isFullyFloatingBase()
+const std::vector<unsigned int>& FloatingBaseSystem::getBranchSubtreeIds(unsigned int end_effector) const
 {
-	if (floating_ax_.active && floating_ay_.active &&
-			floating_az_.active	&& floating_lx_.active &&
-			floating_ly_.active && floating_lz_.active)
+	assert(end_effector < description_->branch_subtree_ids.size());
+	return description_->branch_subtree_ids[end_effector];
+}
+
+
+bool FloatingBaseSystem::isFullyFloatingBase() const
+{
+	if (description_->floating_ax.active && description_->floating_ay.active &&
+			description_->floating_az.active	&& description_->floating_lx.active &&
+			description_->floating_ly.active && description_->floating_lz.active)
 		return true;
 	else
 		return false;
 }
 
 
-bool FloatingBaseSystem::isVirtualFloatingBaseRobot()
+bool FloatingBaseSystem::isVirtualFloatingBaseRobot() const
 {
-	if (type_of_system_ == VirtualFloatingBase)
+	if (description_->type_of_system == VirtualFloatingBase)
 		return true;
 	else
 		return false;
 }
 
 
-bool FloatingBaseSystem::isConstrainedFloatingBaseRobot()
+bool FloatingBaseSystem::isConstrainedFloatingBaseRobot() const
 {
-	if (type_of_system_ == ConstrainedFloatingBase)
+	if (description_->type_of_system == ConstrainedFloatingBase)
 		return true;
 	else
 		return false;
@@ -616,9 +813,9 @@ bool FloatingBaseSystem::isConstrainedFloatingBaseRobot()
 
 bool FloatingBaseSystem::hasFloatingBaseConstraints()
 {
-	if (floating_ax_.constrained || floating_ay_.constrained ||
-			floating_az_.constrained ||	floating_lx_.constrained ||
-			floating_ly_.constrained || floating_lz_.constrained)
+	if (description_->floating_ax.constrained || description_->floating_ay.constrained ||
+			description_->floating_az.constrained ||	description_->floating_lx.constrained ||
+			description_->floating_ly.constrained || description_->floating_lz.constrained)
 		return true;
 	else
 		return false;
@@ -627,47 +824,63 @@ bool FloatingBaseSystem::hasFloatingBaseConstraints()
 
 const Eigen::VectorXd& FloatingBaseSystem::toGeneralizedJointState(const rbd::Vector6d& base_state,
 																   const Eigen::VectorXd& joint_state)
+{
+	toGeneralizedJointState(full_state_, base_state, joint_state);
+	return full_state_;
+}
+
+
+void FloatingBaseSystem::toGeneralizedJointState(Eigen::VectorXd& generalized_state,
+												 const rbd::Vector6d& base_state,
+												 const Eigen::VectorXd& joint_state) const
 {
 	// Getting the number of joints
 	assert(joint_state.size() == getJointDoF());
 
+	// Resizing the generalized state. Note that it doesn't allocate memory if it has
+	// already the system dimension
+	unsigned int num_joints = getJointDoF();
+	unsigned int base_dof = 0;
+	if (getTypeOfDynamicSystem() == FloatingBase ||
+			getTypeOfDynamicSystem() == ConstrainedFloatingBase)
+		base_dof = 6;
+	else if (getTypeOfDynamicSystem() == VirtualFloatingBase)
+		base_dof = getFloatingBaseDoF();
+	generalized_state.resize(base_dof + num_joints);
+
 	// Note that RBDL defines the floating base state as
 	// [linear states, angular states]
 	if (getTypeOfDynamicSystem() == FloatingBase ||
 			getTypeOfDynamicSystem() == ConstrainedFloatingBase) {
-		rbd::Vector6d _base_state = base_state;
-		full_state_ << rbd::linearPart(_base_state),
-					   rbd::angularPart(_base_state),
-					   joint_state;
+		generalized_state.segment<3>(0) = base_state.segment<3>(rbd::LX);
+		generalized_state.segment<3>(3) = base_state.segment<3>(rbd::AX);
+		generalized_state.segment(6, num_joints) = joint_state;
 	} else if (getTypeOfDynamicSystem() == VirtualFloatingBase) {
-		unsigned int base_dof = getFloatingBaseDoF();
-
-		Eigen::VectorXd virtual_base(base_dof);
-		if (floating_ax_.active)
-			virtual_base(floating_ax_.id) = base_state(rbd::AX);
-		if (floating_ay_.active)
-			virtual_base(floating_ay_.id) = base_state(rbd::AY);
-		if (floating_az_.active)
-			virtual_base(floating_az_.id) = base_state(rbd::AZ);
-		if (floating_lx_.active)
-			virtual_base(floating_lx_.id) = base_state(rbd::LX);
-		if (floating_ly_.active)
-			virtual_base(floating_ly_.id) = base_state(rbd::LY);
-		if (floating_lz_.active)
-			virtual_base(floating_lz_.id) = base_state(rbd::LZ);
-
-		full_state_ << virtual_base, joint_state;
+		// Writing directly the virtual floating-base state in order to avoid
+		// temporary vectors
+		if (description_->floating_ax.active)
+			generalized_state(description_->floating_ax.id) = base_state(rbd::AX);
+		if (description_->floating_ay.active)
+			generalized_state(description_->floating_ay.id) = base_state(rbd::AY);
+		if (description_->floating_az.active)
+			generalized_state(description_->floating_az.id) = base_state(rbd::AZ);
+		if (description_->floating_lx.active)
+			generalized_state(description_->floating_lx.id) = base_state(rbd::LX);
+		if (description_->floating_ly.active)
+			generalized_state(description_->floating_ly.id) = base_state(rbd::LY);
+		if (description_->floating_lz.active)
+			generalized_state(description_->floating_lz.id) = base_state(rbd::LZ);
+
+		generalized_state.segment(base_dof, num_joints) = joint_state;
 	} else {
-		full_state_ = joint_state;
+		generalized_state = joint_state;
 	}
-
-	return full_state_;
 }
 
 
 void FloatingBaseSystem::fromGeneralizedJointState(rbd::Vector6d& base_state,
 												   Eigen::VectorXd& joint_state,
-												   const Eigen::VectorXd& generalized_state)
+												   const Eigen::Ref<const Eigen::VectorXd>& generalized_state) const
 {
 	// Resizing the joint state
 	joint_state.resize(getJointDoF());
@@ -682,7 +895,7 @@ void FloatingBaseSystem::fromGeneralizedJointState(rbd::Vector6d& base_state,
 	} else if (getTypeOfDynamicSystem() == VirtualFloatingBase) {
 		for (unsigned int base_idx = 0; base_idx < 6; base_idx++) {
 			rbd::Coords6d base_coord = rbd::Coords6d(base_idx);
-			FloatingBaseJoint joint = getFloatingBaseJoint(base_coord);
+			const FloatingBaseJoint& joint = getFloatingBaseJoint(base_coord);
 
 			if (joint.active)
 				base_state(base_coord) = generalized_state(joint.id);
@@ -706,10 +919,7 @@ void FloatingBaseSystem::setBranchState(Eigen::VectorXd& new_joint_state,
 	getBranch(q_index, num_dof, body_name);
 
 	// Removing the base index
-	if (isFullyFloatingBase())
-		q_index -= 6;
-	else
-		q_index -= getFloatingBaseDoF();
+	q_index = toJointIndex(q_index);
 
 	if (branch_state.size() != num_dof) {
 		printf(RED "FATAL: the branch state dimension is not consistent\n" COLOR_RESET);
@@ -720,6 +930,23 @@ void FloatingBaseSystem::setBranchState(Eigen::VectorXd& new_joint_state,
 }
 
 
+void FloatingBaseSystem::setBranchState(Eigen::VectorXd& new_joint_state,
+										const Eigen::VectorXd& branch_state,
+										unsigned int end_effector) const
+{
+	// Getting the branch properties
+	unsigned int q_index, num_dof;
+	getBranch(q_index, num_dof, end_effector);
+
+	if (branch_state.size() != num_dof) {
+		printf(RED "FATAL: the branch state dimension is not consistent\n" COLOR_RESET);
+		exit(EXIT_FAILURE);
+	}
+
+	new_joint_state.segment(toJointIndex(q_index), num_dof) = branch_state;
+}
+
+
 Eigen::VectorXd FloatingBaseSystem::getBranchState(Eigen::VectorXd& joint_state,
 												   const std::string& body_name)
 {
@@ -728,10 +955,7 @@ Eigen::VectorXd FloatingBaseSystem::getBranchState(Eigen::VectorXd& joint_state,
 	getBranch(q_index, num_dof, body_name);
 
 	// Removing the base index
-	if (isFullyFloatingBase())
-		q_index -= 6;
-	else
-		q_index -= getFloatingBaseDoF();
+	q_index = toJointIndex(q_index);
 
 	Eigen::VectorXd branch_state(num_dof);
 	branch_state = joint_state.segment(q_index, num_dof);
@@ -740,13 +964,48 @@ Eigen::VectorXd FloatingBaseSystem::getBranchState(Eigen::VectorXd& joint_state,
 }
 
 
+Eigen::VectorXd FloatingBaseSystem::getBranchState(const Eigen::VectorXd& joint_state,
+												   unsigned int end_effector) const
+{
+	// Getting the branch properties
+	unsigned int q_index, num_dof;
+	getBranch(q_index, num_dof, end_effector);
+
+	return joint_state.segment(toJointIndex(q_index), num_dof);
+}
+
+
 void FloatingBaseSystem::getBranch(unsigned int& pos_idx,
 		   	   	   	   	   	   	   unsigned int& num_dof,
 								   const std::string& body_name)
 {
-	// Getting the body id
-	unsigned int body_id = rbd_model_.GetBodyId(body_name.c_str());
+	// Getting the precomputed branch of the end-effectors
+	urdf_model::LinkID::const_iterator index_it =
+			description_->end_effector_indexes.find(body_name);
+	if (index_it != description_->end_effector_indexes.end()) {
+		getBranch(pos_idx, num_dof, index_it->second);
+		return;
+	}
+
+	computeBranch(pos_idx, num_dof, rbd_model_.GetBodyId(body_name.c_str()));
+}
+
+
+void FloatingBaseSystem::getBranch(unsigned int& pos_idx,
+								   unsigned int& num_dof,
+								   unsigned int end_effector) const
+{
+	assert(end_effector < description_->branch_num_dofs.size());
+	num_dof = description_->branch_num_dofs[end_effector];
+	if (num_dof > 0)
+		pos_idx = description_->branch_pos_indexes[end_effector];
+}
 
+
+void FloatingBaseSystem::computeBranch(unsigned int& pos_idx,
+									   unsigned int& num_dof,
+									   unsigned int body_id) const
+{
 	// Getting the base joint id. Note that the floating-base starts the
 	// kinematic-tree
 	unsigned int base_id = 0;
@@ -777,9 +1036,63 @@ void FloatingBaseSystem::getBranch(unsigned int& pos_idx,
 }
 
 
+void FloatingBaseSystem::computeBranchBodies(std::vector<unsigned int>& branch_bodies,
+											 std::vector<unsigned int>& subtree_bodies,
+											 unsigned int body_id) const
+{
+	unsigned int base_id = 0;
+	if (isFullyFloatingBase()) {
+		base_id = 6;
+	} else {
+		base_id = getFloatingBaseDoF();
+	}
+
+	unsigned int parent_id = body_id;
+	if (rbd_model_.IsFixedBodyId(body_id)) {
+		unsigned int fixed_idx = rbd_model_.fixed_body_discriminator;
+		parent_id = rbd_model_.mFixedBodies[body_id - fixed_idx].mMovableParent;
+	}
+
+	// Walking the chain to the root, where the first branch body is the child of the
+	// base one
+	branch_bodies.clear();
+	unsigned int first_id = 0;
+	for (unsigned int id = parent_id; id != 0; id = rbd_model_.lambda[id]) {
+		branch_bodies.insert(branch_bodies.begin(), id);
+		if (rbd_model_.lambda[id] == base_id)
+			first_id = id;
+	}
+
+	// Getting the descendants of the first branch body, which have a higher id than
+	// their parents
+	subtree_bodies.clear();
+	if (first_id == 0)
+		return;
+
+	std::vector<bool> is_subtree(rbd_model_.mBodies.size(), false);
+	is_subtree[first_id] = true;
+	subtree_bodies.push_back(first_id);
+	for (unsigned int id = first_id + 1; id < rbd_model_.mBodies.size(); id++) {
+		if (is_subtree[rbd_model_.lambda[id]]) {
+			is_subtree[id] = true;
+			subtree_bodies.push_back(id);
+		}
+	}
+}
+
+
+unsigned int FloatingBaseSystem::toJointIndex(unsigned int pos_idx) const
+{
+	if (isFullyFloatingBase())
+		return pos_idx - 6;
+	else
+		return pos_idx - getFloatingBaseDoF();
+}
+
+
 const Eigen::VectorXd& FloatingBaseSystem::getDefaultPosture() const
 {
-	return default_joint_pos_;
+	return description_->default_joint_pos;
 }
 
 
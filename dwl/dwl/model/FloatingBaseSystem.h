@@ -3,11 +3,13 @@
 
 #include <rbdl/rbdl.h>
 #include <rbdl/addons/urdfreader/urdfreader.h>
+#include <dwl/model/KinematicsCache.h>
 #include <dwl/utils/RigidBodyDynamics.h>
 #include <dwl/utils/URDF.h>
 #include <dwl/utils/Math.h>
 #include <dwl/utils/YamlWrapper.h>
 #include <fstream>
+#include <memory>
 
 
 namespace dwl
@@ -41,11 +43,87 @@ struct Joint {
 /** @brief Defines the type of end-effectors */
 enum TypeOfEndEffector {ALL, FOOT};
 
+/**
+ * @brief Defines the description of a floating-base system, i.e. its topology, joints,
+ * end-effectors and default posture. It doesn't change during the evaluation of the system,
+ * so it's shared between the copies of a system (e.g. the per-thread copies of the kinematics
+ * and dynamics)
+ */
+struct FloatingBaseDescription {
+	FloatingBaseDescription(bool full = false, unsigned int _num_joints = 0);
+
+	/** @brief Robot models (urdf and yarf) */
+	std::string urdf;
+	std::string yarf;
+
+	/** @brief System name */
+	std::string system_name;
+
+	/** @brief Number of DoFs */
+	unsigned int num_system_joints;
+	unsigned int num_floating_joints;
+	unsigned int num_joints;
+
+	/** @brief System joints */
+	FloatingBaseJoint floating_ax;
+	FloatingBaseJoint floating_ay;
+	FloatingBaseJoint floating_az;
+	FloatingBaseJoint floating_lx;
+	FloatingBaseJoint floating_ly;
+	FloatingBaseJoint floating_lz;
+	rbd::BodySelector floating_joint_names;
+	urdf_model::JointID joints;
+	urdf_model::JointLimits joint_limits;
+	rbd::BodySelector joint_names;
+	std::vector<unsigned int> joint_ids;
+	Eigen::VectorXd default_joint_pos;
+
+	/** @brief Total mass of the bodies */
+	double total_mass;
+
+	/** @brief System bodies */
+	std::string floating_body_name;
+
+	/** @brief Type of system */
+	enum TypeOfSystem type_of_system;
+
+	/** @brief End-effector information */
+	urdf_model::LinkID end_effectors;
+	unsigned int num_end_effectors;
+	rbd::BodySelector end_effector_names;
+	std::vector<unsigned int> end_effector_body_ids;
+	urdf_model::LinkID end_effector_indexes;
+
+	/**
+	 * @brief Branches of the end-effectors, i.e. the generalized position index and number
+	 * of DoF of their joints, which are ordered as the end-effector names
+	 */
+	std::vector<unsigned int> branch_pos_indexes;
+	std::vector<unsigned int> branch_num_dofs;
+
+	/**
+	 * @brief Bodies of the end-effector branches, i.e. the movable bodies of the chain
+	 * from the root, and the ones of the subtree of the first branch joint
+	 */
+	std::vector<std::vector<unsigned int> > branch_body_ids;
+	std::vector<std::vector<unsigned int> > branch_subtree_ids;
+
+	urdf_model::LinkID feet;
+	unsigned int num_feet;
+	rbd::BodySelector foot_names;
+
+	/** @brief Gravity information */
+	double grav_acc;
+	Eigen::Vector3d grav_dir;
+};
+
 /**
  * @class FloatingBaseSystem
  * @brief FloatingBaseSystem class read the floating-base system information from an URDF file.
  * Additionally, it has methods that allows us easily to manipulate joint states which depends on
- * the floating-base system kinematic-tree
+ * the floating-base system kinematic-tree. The description of the system is shared between its
+ * copies, and only the RBDL model and the evaluation buffers are copied, so a copy per thread
+ * doesn't duplicate the description
  */
 class FloatingBaseSystem
 {
@@ -65,7 +143,8 @@ class FloatingBaseSystem
 							   const std::string& system_file = std::string());
 
 		/**
-		 * @brief Resets the system information from URDF model
+		 * @brief Resets the system information from URDF model. The models are parsed once
+		 * per process, and the next resets are copied from the model registry
 		 * @param const std::string& URDF model
 		 * @param const std::string& Semantic system description filename
 		 */
@@ -123,6 +202,12 @@ class FloatingBaseSystem
 		 */
 		void setJointDoF(unsigned int _num_joints);
 
+		/**
+		 * @brief Gets the description of the system, which is shared between its copies
+		 * @return const FloatingBaseDescription& Description of the system
+		 */
+		const FloatingBaseDescription& getDescription() const;
+
 		/**
 		 * @brief Gets the URDF model
 		 * @return const std::string& URDF model
@@ -140,12 +225,51 @@ class FloatingBaseSystem
 		 * @return const RigidBodyDynamics::Model& Rigid body dynamics model
 		 */
 		RigidBodyDynamics::Model& getRBDModel();
+		const RigidBodyDynamics::Model& getRBDModel() const;
+
+		/**
+		 * @brief Gets the generated kinematics and dynamics of the rigid body model (see
+		 * GeneratedModelRegistry), which are found when the system is reset
+		 * @return const GeneratedModel* Generated model, or NULL if there isn't one
+		 */
+		const GeneratedModel* getGeneratedModel() const;
+
+		/**
+		 * @brief Updates the kinematics of the rigid body model, where the model is updated
+		 * only if the state is different to the cached one. So, any kinematic query at this
+		 * state can read the model without updating it again
+		 * @param const Eigen::VectorXd& Generalized position
+		 * @param const Eigen::VectorXd* Generalized velocity (it isn't updated if it's NULL)
+		 * @param const Eigen::VectorXd* Generalized acceleration (it isn't updated if it's NULL)
+		 */
+		void updateKinematics(const Eigen::VectorXd& q,
+							  const Eigen::VectorXd* qd = NULL,
+							  const Eigen::VectorXd* qdd = NULL);
+
+		/**
+		 * @brief Invalidates the cached kinematics state. It has to be called after any RBDL
+		 * routine that updates the model by itself (e.g. the dynamics algorithms)
+		 */
+		void invalidateKinematics();
+
+		/**
+		 * @brief Updates the kinematics of the branch of an end-effector, i.e. only the
+		 * chain from the base to it is traversed. The cached kinematics is used if it has
+		 * the same position (and no velocity is given), otherwise it's invalidated
+		 * @param const Eigen::VectorXd& Generalized position
+		 * @param unsigned int Index of the end-effector
+		 * @param const Eigen::VectorXd* Generalized velocity (zero if it's NULL)
+		 */
+		void updateBranchKinematics(const Eigen::VectorXd& q,
+									unsigned int end_effector,
+									const Eigen::VectorXd* qd = NULL);
 
 		/**
-		 * @brief Gets the total mass of the rigid body system
+		 * @brief Gets the total mass of the rigid body system, which is computed once the
+		 * model is parsed
 		 * @return double The total mass of the rigid body system
 		 */
-		double getTotalMass();
+		double getTotalMass() const;
 
 		/**
 		 * @brief Gets the body mass
@@ -164,7 +288,8 @@ class FloatingBaseSystem
 		const Eigen::Vector3d& getGravityDirection() const;
 
 		/**
-		 * @brief Gets the Center of Mass (CoM) of the floating-base system
+		 * @brief Gets the Center of Mass (CoM) of the floating-base system, which only
+		 * requires the position kinematics
 		 * @param const rbd::Vector6d& Base position
 		 * @param const Eigen::VectorXd& Joint position
 		 * @return const Eigen::Vector3d& The CoM of the floating-base system
@@ -185,6 +310,31 @@ class FloatingBaseSystem
 												const rbd::Vector6d& base_vel,
 												const Eigen::VectorXd& joint_vel);
 
+		/**
+		 * @brief Computes the CoM position, velocity, Jacobian and its bias acceleration
+		 * (i.e. Jdot * qd) of the floating-base system in a single pass over the bodies.
+		 * The kinematics is updated through the kinematics cache, so the kinematic queries
+		 * of WholeBodyKinematics at the same state don't traverse the tree again. The
+		 * Jacobian columns follow the DWL order of the generalized velocity, i.e. the
+		 * floating-base columns are (angular, linear)
+		 * @param Eigen::Vector3d& CoM position
+		 * @param Eigen::Vector3d& CoM velocity
+		 * @param Eigen::MatrixXd& CoM Jacobian
+		 * @param Eigen::Vector3d& CoM bias acceleration
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 */
+		void computeSystemCoMKinematics(Eigen::Vector3d& com_pos,
+										Eigen::Vector3d& com_vel,
+										Eigen::MatrixXd& com_jac,
+										Eigen::Vector3d& com_jacd_qd,
+										const rbd::Vector6d& base_pos,
+										const Eigen::VectorXd& joint_pos,
+										const rbd::Vector6d& base_vel,
+										const Eigen::VectorXd& joint_vel);
+
 		/**
 		 * @brief Gets the Center of Mass (CoM) of floating-base
 		 * @return double The CoM of the floating-base
@@ -243,6 +393,12 @@ class FloatingBaseSystem
 		 */
 		const unsigned int& getJointId(const std::string& joint_name) const;
 
+		/**
+		 * @brief Gets the joint ids, which are ordered as the joint names
+		 * @return const std::vector<unsigned int>& Joint ids
+		 */
+		const std::vector<unsigned int>& getJointIds() const;
+
 		/**
 		 * @brief Gets actuated joint information
 		 * @return const urdf_model::JointID& Joint names and Ids
@@ -315,6 +471,15 @@ class FloatingBaseSystem
 		 */
 		const unsigned int& getEndEffectorId(const std::string& contact_name) const;
 
+		/**
+		 * @brief Gets the index of an end-effector in the end-effector names, which can be
+		 * used by the index-based accessors (e.g. getBranch) inside the loops
+		 * @param const std::string& End-effector name
+		 * @return unsigned int Index of the end-effector (the number of end-effectors if
+		 * it doesn't exist)
+		 */
+		unsigned int getEndEffectorIndex(const std::string& contact_name) const;
+
 		/**
 		 * @brief Gets the end-effectors names
 		 * @return const urdf_model::LinkID& Names and ids of the end-effectors
@@ -328,20 +493,46 @@ class FloatingBaseSystem
 		 */
 		const rbd::BodySelector& getEndEffectorNames(enum TypeOfEndEffector type = ALL) const;
 
+		/**
+		 * @brief Gets the RBDL body ids of the end-effectors. The ids are
+		 * ordered as the end-effector names, so they can be used together with
+		 * body containers (i.e. rbd::BodyContainer3d)
+		 * @return const std::vector<unsigned int>& End-effector body ids
+		 */
+		const std::vector<unsigned int>& getEndEffectorBodyIds() const;
+
+		/**
+		 * @brief Gets the movable bodies of the branch of an end-effector, i.e. of the chain
+		 * from the root (the floating-base bodies included)
+		 * @param unsigned int Index of the end-effector
+		 * @return const std::vector<unsigned int>& Branch body ids
+		 */
+		const std::vector<unsigned int>& getBranchBodyIds(unsigned int end_effector) const;
+
+		/**
+		 * @brief Gets the movable bodies of the subtree of the first branch joint of an
+		 * end-effector, i.e. the bodies moved by its branch
+		 * @param unsigned int Index of the end-effector
+		 * @return const std::vector<unsigned int>& Subtree body ids
+		 */
+		const std::vector<unsigned int>& getBranchSubtreeIds(unsigned int end_effector) const;
+
 		/** @brief Returns true if the system has fully floating-base */
-		bool isFullyFloatingBase();
+		bool isFullyFloatingBase() const;
 
 		/** @brief Returns true if the system has a virtual floating-base */
-		bool isVirtualFloatingBaseRobot();
+		bool isVirtualFloatingBaseRobot() const;
 
 		/** @brief Returns true if the system has a physical constraint with a fully floating-base */
-		bool isConstrainedFloatingBaseRobot();
+		bool isConstrainedFloatingBaseRobot() const;
 
 		/** @brief Returns true if there are a physical constraint in the floating-base */
 		bool hasFloatingBaseConstraints();
 
 		/**
-		 * @brief Converts the base and joint states to a generalized joint state
+		 * @brief Converts the base and joint states to a generalized joint state. Note that
+		 * it returns an internal buffer, which is overwritten by the next conversion, so two
+		 * conversions can't be used in the same expression (see the in-place version)
 		 * @param const Vector6d& Base state
 		 * @param const Eigen::VectorXd& Joint state
 		 * @return Eigen::VectorXd& Generalized joint state
@@ -349,15 +540,27 @@ class FloatingBaseSystem
 		const Eigen::VectorXd& toGeneralizedJointState(const rbd::Vector6d& base_state,
 													   const Eigen::VectorXd& joint_state);
 
+		/**
+		 * @brief Converts the base and joint states to a generalized joint state written in
+		 * a caller-owned buffer. It doesn't allocate memory if the buffer has already the
+		 * system dimension
+		 * @param Eigen::VectorXd& Generalized joint state
+		 * @param const Vector6d& Base state
+		 * @param const Eigen::VectorXd& Joint state
+		 */
+		void toGeneralizedJointState(Eigen::VectorXd& generalized_state,
+									 const rbd::Vector6d& base_state,
+									 const Eigen::VectorXd& joint_state) const;
+
 		/**
 		 * @brief Converts the generalized joint state to base and joint states
 		 * @param Vector6d& Base state
 		 * @param Eigen::VectorXd& Joint state
-		 * @param const Eigen::VectorXd Generalized joint state
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Generalized joint state
 		 */
 		void fromGeneralizedJointState(rbd::Vector6d& base_state,
 									   Eigen::VectorXd& joint_state,
-									   const Eigen::VectorXd& generalized_state);
+									   const Eigen::Ref<const Eigen::VectorXd>& generalized_state) const;
 
 		/**
 		 * @brief Sets the joint state given a branch values
@@ -379,7 +582,26 @@ class FloatingBaseSystem
 									   const std::string& body_name);
 
 		/**
-		 * @brief Gets the position index and number of DOF of certain branch
+		 * @brief Sets the joint state given the branch values of an end-effector
+		 * @param Eigen::VectorXd& Joint state vector
+		 * @param cons Eigen::VectorXd& Branch state
+		 * @param unsigned int End-effector index (see getEndEffectorIndex)
+		 */
+		void setBranchState(Eigen::VectorXd& new_joint_state,
+							const Eigen::VectorXd& branch_state,
+							unsigned int end_effector) const;
+
+		/**
+		 * @brief Gets the branch values of an end-effector given a joint state
+		 * @param Eigen::VectorXd& Joint state vector
+		 * @param unsigned int End-effector index (see getEndEffectorIndex)
+		 */
+		Eigen::VectorXd getBranchState(const Eigen::VectorXd& joint_state,
+									   unsigned int end_effector) const;
+
+		/**
+		 * @brief Gets the position index and number of DOF of certain branch. The branches of
+		 * the end-effectors are precomputed, and the other bodies walk the kinematic tree
 		 * @param unsigned int& Position index of the body branch
 		 * @param unsigned int& Degrees of freedom of the body branch
 		 * @param const std::string& Name of the body branch (end-effector name)
@@ -388,6 +610,17 @@ class FloatingBaseSystem
 					   unsigned int& num_dof,
 					   const std::string& body_name);
 
+		/**
+		 * @brief Gets the precomputed position index and number of DOF of the branch of an
+		 * end-effector
+		 * @param unsigned int& Position index of the body branch
+		 * @param unsigned int& Degrees of freedom of the body branch
+		 * @param unsigned int End-effector index (see getEndEffectorIndex)
+		 */
+		void getBranch(unsigned int& pos_idx,
+					   unsigned int& num_dof,
+					   unsigned int end_effector) const;
+
 		/**
 		 * @brief Gets the default posture defined in the system file
 		 * @return const Eigen::VectorXd& Default joint position
@@ -396,60 +629,73 @@ class FloatingBaseSystem
 
 
 	private:
+		/**
+		 * @brief Parses the system information from URDF model and system file, which is done
+		 * by the model registry
+		 * @param const std::string& URDF model
+		 * @param const std::string& Semantic system description filename
+		 */
+		void parseURDFModel(const std::string& urdf_model,
+							const std::string& system_file);
+
+		/**
+		 * @brief Gets the description for modifying it, which is copied if it's shared with
+		 * other systems
+		 * @return FloatingBaseDescription& Description of this system
+		 */
+		FloatingBaseDescription& getMutableDescription();
+
+		/**
+		 * @brief Computes the branch of a body by walking the kinematic tree
+		 * @param unsigned int& Position index of the body branch
+		 * @param unsigned int& Degrees of freedom of the body branch
+		 * @param unsigned int Body id
+		 */
+		void computeBranch(unsigned int& pos_idx,
+						   unsigned int& num_dof,
+						   unsigned int body_id) const;
+
+		/**
+		 * @brief Computes the movable bodies of the branch of a body, and the ones of the
+		 * subtree of its first branch joint
+		 * @param std::vector<unsigned int>& Bodies of the chain from the root
+		 * @param std::vector<unsigned int>& Bodies of the subtree
+		 * @param unsigned int Body id
+		 */
+		void computeBranchBodies(std::vector<unsigned int>& branch_bodies,
+								 std::vector<unsigned int>& subtree_bodies,
+								 unsigned int body_id) const;
+
+		/**
+		 * @brief Gets the index of the branch in the joint state, i.e. without the base
+		 * @param unsigned int Position index of the body branch
+		 */
+		unsigned int toJointIndex(unsigned int pos_idx) const;
+
 		/** @brief Compared string function */
 		bool compareString(std::string a, std::string b);
 
-		/** @brief Robot models (urdf and yarf) */
-		std::string urdf_;
-		std::string yarf_;
+		friend class ModelRegistry;
 
-		/** @brief Rigid-body dynamic model */
+		/**
+		 * @brief Read-only description of the system, which is shared between the copies of
+		 * the system, and copied when it's modified
+		 */
+		std::shared_ptr<FloatingBaseDescription> description_;
+
+		/**
+		 * @brief Rigid-body dynamic model and evaluation workspace of this system. Note that
+		 * RBDL stores the evaluation buffers inside its model, so every copy owns it
+		 */
 		RigidBodyDynamics::Model rbd_model_;
+		KinematicsCache kinematics_cache_;
 		RigidBodyDynamics::Math::Vector3d com_system_;
 		RigidBodyDynamics::Math::Vector3d comd_system_;
-
-		/** @brief System name */
-		std::string system_name_;
-
-		/** @brief Number of DoFs */
-		unsigned int num_system_joints_;
-		unsigned int num_floating_joints_;
-		unsigned int num_joints_;
-
-		/** @brief System joints */
-		FloatingBaseJoint floating_ax_;
-		FloatingBaseJoint floating_ay_;
-		FloatingBaseJoint floating_az_;
-		FloatingBaseJoint floating_lx_;
-		FloatingBaseJoint floating_ly_;
-		FloatingBaseJoint floating_lz_;
-		rbd::BodySelector floating_joint_names_;
-		urdf_model::JointID joints_;
-		urdf_model::JointLimits joint_limits_;
-		rbd::BodySelector joint_names_;
-		Eigen::VectorXd default_joint_pos_;
 		Eigen::VectorXd full_state_;
+		Eigen::VectorXd full_velocity_;
+		Eigen::VectorXd zero_velocity_;
 		rbd::Vector6d base_state_;
 		Eigen::VectorXd joint_state_;
-
-		/** @brief System bodies */
-		std::string floating_body_name_;
-
-		/** @brief Type of system */
-		enum TypeOfSystem type_of_system_;
-
-		/** @brief End-effector information */
-		urdf_model::LinkID end_effectors_;
-		unsigned int num_end_effectors_;
-		rbd::BodySelector end_effector_names_;
-
-		urdf_model::LinkID feet_;
-		unsigned int num_feet_;
-		rbd::BodySelector foot_names_;
-
-		/** @brief Gravity information */
-		double grav_acc_;
-		Eigen::Vector3d grav_dir_;
 };
 
 } //@namespace
@@ -0,0 +1,147 @@
+#include <dwl/model/GeneratedModel.h>
+#include <dwl/model/ModelRegistry.h>
+#include <dwl/utils/Macros.h>
+#include <dlfcn.h>
+#include <map>
+#include <mutex>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/** @brief Generated models, keyed by the hash of their RBDL model */
+struct GeneratedModels
+{
+	std::mutex mutex;
+	std::map<uint64_t, const GeneratedModel*> models;
+};
+
+
+static GeneratedModels& getGeneratedModels()
+{
+	// The models are never destroyed, since they could be used during the exit of the process
+	static GeneratedModels* models = new GeneratedModels();
+	return *models;
+}
+
+
+/** @brief Appends the bytes of a value to a string */
+template<typename T>
+static void appendBytes(std::string& data,
+						const T& value)
+{
+	data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+void GeneratedModelRegistry::add(const GeneratedModel* model)
+{
+	if (model == NULL)
+		return;
+
+	GeneratedModels& models = getGeneratedModels();
+	std::lock_guard<std::mutex> lock(models.mutex);
+	models.models[model->hash] = model;
+}
+
+
+bool GeneratedModelRegistry::load(const std::string& library,
+								  const std::string& name)
+{
+	// Note that the plugin is never unloaded, since its model is kept in the registry
+	void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (handle == NULL) {
+		printf(YELLOW "Warning: the plugin %s couldn't be loaded: %s\n" COLOR_RESET,
+			   library.c_str(), dlerror());
+		return false;
+	}
+
+	typedef const GeneratedModel* (*LoadFunction)();
+	LoadFunction load_model =
+			reinterpret_cast<LoadFunction>(dlsym(handle, getSymbolName(name).c_str()));
+	if (load_model == NULL) {
+		printf(YELLOW "Warning: the plugin %s doesn't have the model %s\n" COLOR_RESET,
+			   library.c_str(), name.c_str());
+		return false;
+	}
+
+	add(load_model());
+	return true;
+}
+
+
+const GeneratedModel* GeneratedModelRegistry::find(const RigidBodyDynamics::Model& model)
+{
+	GeneratedModels& models = getGeneratedModels();
+	std::lock_guard<std::mutex> lock(models.mutex);
+	if (models.models.empty())
+		return NULL;
+
+	std::map<uint64_t, const GeneratedModel*>::const_iterator model_it =
+			models.models.find(computeHash(model));
+	if (model_it == models.models.end())
+		return NULL;
+
+	// Checking the dimensions as a guard against hash collisions
+	const GeneratedModel* generated = model_it->second;
+	if (generated->num_bodies != model.mBodies.size() ||
+			generated->dof_count != model.dof_count)
+		return NULL;
+
+	return generated;
+}
+
+
+void GeneratedModelRegistry::clear()
+{
+	GeneratedModels& models = getGeneratedModels();
+	std::lock_guard<std::mutex> lock(models.mutex);
+	models.models.clear();
+}
+
+
+uint64_t GeneratedModelRegistry::computeHash(const RigidBodyDynamics::Model& model)
+{
+	// Serializing the tree, the joint axes, the joint placements and the inertias of the
+	// movable bodies
+	std::string data;
+	appendBytes(data, (unsigned int) model.mBodies.size());
+	appendBytes(data, model.dof_count);
+	for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+		appendBytes(data, model.lambda[i]);
+		appendBytes(data, model.mJoints[i].q_index);
+		appendBytes(data, model.mJoints[i].mDoFCount);
+		appendBytes(data, model.mBodies[i].mIsVirtual);
+		for (unsigned int k = 0; k < 6; k++)
+			appendBytes(data, model.S[i](k));
+		for (unsigned int k = 0; k < 9; k++)
+			appendBytes(data, model.X_T[i].E(k));
+		for (unsigned int k = 0; k < 3; k++)
+			appendBytes(data, model.X_T[i].r(k));
+
+		const RigidBodyDynamics::Math::SpatialRigidBodyInertia& inertia = model.I[i];
+		appendBytes(data, inertia.m);
+		for (unsigned int k = 0; k < 3; k++)
+			appendBytes(data, inertia.h(k));
+		appendBytes(data, inertia.Ixx);
+		appendBytes(data, inertia.Iyx);
+		appendBytes(data, inertia.Iyy);
+		appendBytes(data, inertia.Izx);
+		appendBytes(data, inertia.Izy);
+		appendBytes(data, inertia.Izz);
+	}
+
+	return ModelRegistry::computeHash(data);
+}
+
+
+std::string GeneratedModelRegistry::getSymbolName(const std::string& name)
+{
+	return "dwl_generated_model_" + name;
+}
+
+} //@namespace model
+} //@namespace dwl
@@ -0,0 +1,115 @@
+#ifndef DWL__MODEL__GENERATED_MODEL__H
+#define DWL__MODEL__GENERATED_MODEL__H
+
+#include <rbdl/rbdl.h>
+#include <stdint.h>
+#include <string>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @brief Defines the specialized kinematics and dynamics of a robot, which are generated by
+ * the ModelCodeGenerator from its RBDL model. The functions follow the conventions of RBDL,
+ * i.e. they take the generalized states in the RBDL order, and they replace the generic
+ * traversals when the model of a system matches the hash of the generated one:
+ * <ul>
+ *   <li>updatePositions: the transforms of the bodies (X_lambda and X_base) as
+ *   UpdateKinematicsCustom with only the position</li>
+ *   <li>computeInverseDynamics: the RNEA as InverseDynamics, where the external forces are
+ *   optional (NULL) and expressed in the base frame</li>
+ *   <li>computeJointSpaceInertiaMatrix: the CRBA as CompositeRigidBodyAlgorithm, where the
+ *   matrix is column-major [dof x dof]</li>
+ * </ul>
+ */
+struct GeneratedModel
+{
+	typedef void (*UpdatePositions)(RigidBodyDynamics::Model& model,
+									const double* q);
+	typedef void (*InverseDynamics)(double* tau,
+									const double* q,
+									const double* qd,
+									const double* qdd,
+									const double* gravity,
+									const RigidBodyDynamics::Math::SpatialVector* f_ext);
+	typedef void (*JointSpaceInertiaMatrix)(double* H,
+											const double* q);
+
+	/** @brief Name of the generated model */
+	const char* name;
+
+	/** @brief Hash of the RBDL model (see GeneratedModelRegistry::computeHash) */
+	uint64_t hash;
+
+	/** @brief Number of bodies and DoF of the RBDL model */
+	unsigned int num_bodies;
+	unsigned int dof_count;
+
+	/** @brief Generated functions */
+	UpdatePositions updatePositions;
+	InverseDynamics computeInverseDynamics;
+	JointSpaceInertiaMatrix computeJointSpaceInertiaMatrix;
+};
+
+
+/**
+ * @class GeneratedModelRegistry
+ * @brief Process-wide registry of the generated models, which are found by the hash of the RBDL
+ * model of a system (e.g. in FloatingBaseSystem::resetFromURDFModel). So a generated model is
+ * used only by the systems whose model is the one used for generating it. The generated models
+ * are added directly when they are compiled in the application, or loaded from plugins (shared
+ * libraries). Note that the models have to be added before resetting the systems
+ */
+class GeneratedModelRegistry
+{
+	public:
+		/**
+		 * @brief Adds a generated model, which replaces the one of the same hash
+		 * @param const GeneratedModel* Generated model, which has to outlive the registry
+		 */
+		static void add(const GeneratedModel* model);
+
+		/**
+		 * @brief Loads a generated model from a plugin, i.e. a shared library with the
+		 * generated code of the model
+		 * @param const std::string& Filename of the shared library
+		 * @param const std::string& Name of the generated model
+		 * @return bool False if the plugin or the model couldn't be loaded
+		 */
+		static bool load(const std::string& library,
+						 const std::string& name);
+
+		/**
+		 * @brief Finds the generated model of a RBDL model
+		 * @param const RigidBodyDynamics::Model& RBDL model
+		 * @return The generated model, or NULL if there isn't one
+		 */
+		static const GeneratedModel* find(const RigidBodyDynamics::Model& model);
+
+		/** @brief Removes the generated models */
+		static void clear();
+
+		/**
+		 * @brief Computes the hash of the kinematic tree and inertias of a RBDL model, i.e.
+		 * the data that are constant-folded in the generated code
+		 * @param const RigidBodyDynamics::Model& RBDL model
+		 * @return The hash of the model
+		 */
+		static uint64_t computeHash(const RigidBodyDynamics::Model& model);
+
+		/**
+		 * @brief Gets the name of the loading function of a generated model in a plugin
+		 * @param const std::string& Name of the generated model
+		 * @return The symbol of the loading function
+		 */
+		static std::string getSymbolName(const std::string& name);
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
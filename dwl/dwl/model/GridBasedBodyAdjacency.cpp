@@ -1,4 +1,6 @@
 #include <dwl/model/GridBasedBodyAdjacency.h>
+#include <algorithm>
+#include <climits>
 
 
 namespace dwl
@@ -8,7 +10,8 @@ namespace model
 {
 
 GridBasedBodyAdjacency::GridBasedBodyAdjacency() : is_stance_adjacency_(true),
-		neighboring_definition_(3), number_top_cost_(5), uncertainty_factor_(1.15)
+		mask_resolution_(0.), mask_angular_resolution_(0.), neighboring_definition_(3),
+		number_top_cost_(5), uncertainty_factor_(1.15)
 {
 	name_ = "Grid-based Body";
 	is_lattice_ = false;
@@ -21,6 +24,12 @@ GridBasedBodyAdjacency::~GridBasedBodyAdjacency()
 }
 
 
+AdjacencyModel* GridBasedBodyAdjacency::clone() const
+{
+	return new GridBasedBodyAdjacency(*this);
+}
+
+
 void GridBasedBodyAdjacency::computeAdjacencyMap(AdjacencyMap& adjacency_map,
 												 Vertex source,
 												 Vertex target)
@@ -28,6 +37,8 @@ void GridBasedBodyAdjacency::computeAdjacencyMap(AdjacencyMap& adjacency_map,
 	// Computing a default stance areas
 	Eigen::Vector3d full_action = Eigen::Vector3d::Zero();
 	stance_areas_ = robot_->getFootstepSearchAreas(full_action);
+	stance_masks_.clear();
+	body_cost_table_.clear();
 
 	// Getting the body orientation
 	Eigen::Vector3d initial_state;
@@ -49,8 +60,8 @@ void GridBasedBodyAdjacency::computeAdjacencyMap(AdjacencyMap& adjacency_map,
 		}
 
 		// Computing the adjacency map given the terrain information
-		TerrainDataMap terrain_map = terrain_->getTerrainDataMap();
-		for (TerrainDataMap::iterator vertex_iter = terrain_map.begin();
+		const TerrainDataMap& terrain_map = terrain_->getTerrainDataMap();
+		for (TerrainDataMap::const_iterator vertex_iter = terrain_map.begin();
 				vertex_iter != terrain_map.end();
 				vertex_iter++)
 		{
@@ -89,7 +100,7 @@ void GridBasedBodyAdjacency::computeAdjacencyMap(AdjacencyMap& adjacency_map,
 }
 
 
-void GridBasedBodyAdjacency::getSuccessors(std::list<Edge>& successors,
+void GridBasedBodyAdjacency::getSuccessors(EdgeList& successors,
 										   Vertex state_vertex)
 {
 	Eigen::Vector3d state;
@@ -98,8 +109,8 @@ void GridBasedBodyAdjacency::getSuccessors(std::list<Edge>& successors,
 	std::vector<Vertex> neighbor_actions;
 	searchNeighbors(neighbor_actions, state_vertex);
 	if (terrain_->isTerrainInformation()) {
-		// Getting the terrain map
-		TerrainDataMap terrain_map = terrain_->getTerrainDataMap();
+		// Computing a default stance areas
+		computeDefaultStanceAreas();
 
 		unsigned int action_size = neighbor_actions.size();
 		for (unsigned int i = 0; i < action_size; i++) {
@@ -124,6 +135,52 @@ void GridBasedBodyAdjacency::getSuccessors(std::list<Edge>& successors,
 }
 
 
+bool GridBasedBodyAdjacency::getGridNeighbor(Edge& neighbor,
+											 Vertex state_vertex,
+											 int dx, int dy)
+{
+	if (!terrain_->isTerrainInformation())
+		return false;
+
+	// Getting the key of yaw and the keys of x and y axis
+	Eigen::Vector3d state;
+	terrain_->getTerrainSpaceModel().vertexToState(state, state_vertex);
+	unsigned short int key_yaw;
+	terrain_->getTerrainSpaceModel().stateToKey(key_yaw, (double) state(2), false);
+	Key terrain_key;
+	Vertex terrain_vertex;
+	terrain_->getTerrainSpaceModel().stateVertexToEnvironmentVertex(terrain_vertex, state_vertex, XY_Y);
+	terrain_->getTerrainSpaceModel().vertexToKey(terrain_key, terrain_vertex, true);
+
+	// Checking if the neighbor cell has terrain information
+	Key neighbor_key;
+	neighbor_key.x = terrain_key.x + dx;
+	neighbor_key.y = terrain_key.y + dy;
+	Vertex neighbor_vertex;
+	terrain_->getTerrainSpaceModel().keyToVertex(neighbor_vertex, neighbor_key, true);
+	if (terrain_->getTerrainDataMap().count(neighbor_vertex) == 0)
+		return false;
+
+	// Getting the state vertex of the neighbor
+	double x, y, yaw;
+	terrain_->getTerrainSpaceModel().keyToState(x, neighbor_key.x, true);
+	terrain_->getTerrainSpaceModel().keyToState(y, neighbor_key.y, true);
+	terrain_->getTerrainSpaceModel().keyToState(yaw, key_yaw, false);
+	state << x, y, yaw;
+	terrain_->getTerrainSpaceModel().stateToVertex(neighbor.target, state);
+
+	// Computing the weight of the edge
+	if (!isStanceAdjacency())
+		neighbor.weight = terrain_->getTerrainCost(neighbor_vertex);
+	else {
+		computeDefaultStanceAreas();
+		computeBodyCost(neighbor.weight, neighbor.target);
+	}
+
+	return true;
+}
+
+
 void GridBasedBodyAdjacency::searchNeighbors(std::vector<Vertex>& neighbor_states,
 											 Vertex state_vertex)
 {
@@ -146,7 +203,7 @@ void GridBasedBodyAdjacency::searchNeighbors(std::vector<Vertex>& neighbor_state
 	bool is_found_neighbor_positive_yx = false, is_found_neighbor_negative_yx = false;
 	if (terrain_->isTerrainInformation()) {
 		// Getting the terrain map
-		TerrainDataMap terrain_map = terrain_->getTerrainDataMap();
+		const TerrainDataMap& terrain_map = terrain_->getTerrainDataMap();
 
 		double x, y, yaw;
 
@@ -292,81 +349,88 @@ void GridBasedBodyAdjacency::searchNeighbors(std::vector<Vertex>& neighbor_state
 void GridBasedBodyAdjacency::computeBodyCost(double& cost,
 											 Vertex state_vertex)
 {
-	// Converting the vertex to state (x,y,yaw)
+	// Converting the vertex to state (x,y,yaw), and getting the key of the body cell
+	const environment::SpaceDiscretization& space_model = terrain_->getTerrainSpaceModel();
 	Eigen::Vector3d state;
-	terrain_->getTerrainSpaceModel().vertexToState(state, state_vertex);
+	space_model.vertexToState(state, state_vertex);
+	Key body_key;
+	space_model.coordToKey(body_key.x, state(0), true);
+	space_model.coordToKey(body_key.y, state(1), true);
+	const StanceMask& mask = getStanceMask(state(2));
+
+	// Getting the memoized cost in lazy evaluation, which is valid while the cells of its
+	// stance areas aren't changed. Note that the costs of the unperceived stance areas depend
+	// on the average cost, i.e. on every cell
+	unsigned long revision = terrain_->getRevision();
+	if (is_lazy_) {
+		const MemoizedCost* memoized = body_cost_table_.find(state_vertex);
+		if (memoized != NULL) {
+			if (memoized->revision == revision) {
+				cost = memoized->cost;
+				return;
+			}
 
-	// Getting the terrain map
-	TerrainDataMap terrain_map = terrain_->getTerrainDataMap();
+			CellRegion region;
+			region.add(Key(std::max((int) body_key.x + mask.min_offset_x, 0),
+						   std::max((int) body_key.y + mask.min_offset_y, 0), 0));
+			region.add(Key(std::min((int) body_key.x + mask.max_offset_x, USHRT_MAX),
+						   std::min((int) body_key.y + mask.max_offset_y, USHRT_MAX), 0));
+			if (!memoized->is_unperceived &&
+					!terrain_->isChangedRegion(region, memoized->revision)) {
+				cost = memoized->cost;
+				body_cost_table_[state_vertex].revision = revision;
+				return;
+			}
+		}
+	}
 
-	// Computing the terrain cost
+	// Computing the terrain cost from the precomputed cells of the stance areas, i.e. a key
+	// offset and a grid lookup per cell
+	bool is_unperceived = false;
 	double terrain_cost = 0;
-	unsigned int area_size = stance_areas_.size();
+	unsigned int area_size = mask.area_sizes.size();
+	unsigned int cell_idx = 0;
 	for (unsigned int n = 0; n < area_size; n++) {
-		// Computing the boundary of stance area
-		Eigen::Vector2d boundary_min, boundary_max;
-		boundary_min(0) = stance_areas_[n].min_x + state(0);
-		boundary_min(1) = stance_areas_[n].min_y + state(1);
-		boundary_max(0) = stance_areas_[n].max_x + state(0);
-		boundary_max(1) = stance_areas_[n].max_y + state(1);
-
-		// Computing the stance cost
-		std::set< std::pair<Weight, Vertex>, pair_first_less<Weight, Vertex> > stance_cost_queue;
-		double stance_cost = 0;
-		double resolution = stance_areas_[n].resolution;
-		for (double y = boundary_min(1); y <= boundary_max(1); y += resolution ) {
-			for (double x = boundary_min(0); x <= boundary_max(0); x += resolution) {
-				// Computing the rotated coordinate according to the orientation of the body
-				Eigen::Vector2d point_position;
-				point_position(0) = (x - state(0)) * cos((double) state(2)) -
-						(y - state(1)) * sin((double) state(2)) + state(0);
-				point_position(1) = (x - state(0)) * sin((double) state(2)) +
-						(y - state(1)) * cos((double) state(2)) + state(1);
-
-				Vertex current_2d_vertex;
-				terrain_->getTerrainSpaceModel().coordToVertex(current_2d_vertex, point_position);
-
-				// Inserts the element in an organized vertex queue, according to the maximum value
-				if (terrain_map.count(current_2d_vertex) > 0)
-					stance_cost_queue.insert(std::pair<Weight, Vertex>(
-							terrain_->getTerrainCost(current_2d_vertex),
-							current_2d_vertex));
-			}
+		stance_costs_.clear();
+		unsigned int end_idx = cell_idx + mask.area_sizes[n];
+		for (; cell_idx < end_idx; cell_idx++) {
+			int key_x = (int) body_key.x + mask.offset_x[cell_idx];
+			int key_y = (int) body_key.y + mask.offset_y[cell_idx];
+			if (key_x < 0 || key_y < 0 || key_x > USHRT_MAX || key_y > USHRT_MAX)
+				continue;
+
+			Weight cell_cost;
+			if (terrain_->getTerrainCost(cell_cost, Key(key_x, key_y, 0)))
+				stance_costs_.push_back(cell_cost);
 		}
 
 		// Averaging the 5-best (lowest) cost
-		unsigned int number_top_cost = number_top_cost_;
-		if (stance_cost_queue.size() < number_top_cost)
-			number_top_cost = stance_cost_queue.size();
-
-		if (number_top_cost == 0) {
-			stance_cost += uncertainty_factor_ * terrain_->getAverageCostOfTerrain();
-		} else {
-			for (unsigned int i = 0; i < number_top_cost; i++) {
-				stance_cost += stance_cost_queue.begin()->first;
-				stance_cost_queue.erase(stance_cost_queue.begin());
-			}
-
-			stance_cost /= number_top_cost;
+		double stance_cost;
+		if (!computeStanceCost(stance_cost, stance_costs_, number_top_cost_)) {
+			stance_cost = uncertainty_factor_ * terrain_->getAverageCostOfTerrain();
+			is_unperceived = true;
 		}
 
 		terrain_cost += stance_cost;
 	}
 	terrain_cost /= stance_areas_.size();
 
-	// Getting robot and terrain information
+	// Getting robot and terrain information, which is only required by the body features.
+	// Note that the features are assumed to evaluate the terrain inside the stance areas
+	cost = terrain_cost;
+	unsigned int feature_size = features_.size();
 	RobotAndTerrain info;
-	Eigen::Vector3d default_action;
-	default_action << 1, 0, 0;
-	info.body_action = default_action;
-	info.pose.position = (Eigen::Vector2d) state.head(2);
-	info.pose.orientation = (double) state(2);
-	info.height_map = terrain_->getTerrainHeightMap();
-	info.resolution = terrain_->getResolution(true);
+	if (feature_size != 0) {
+		Eigen::Vector3d default_action;
+		default_action << 1, 0, 0;
+		info.body_action = default_action;
+		info.pose.position = (Eigen::Vector2d) state.head(2);
+		info.pose.orientation = (double) state(2);
+		info.height_map = terrain_->getTerrainHeightMap();
+		info.resolution = terrain_->getResolution(true);
+	}
 
 	// Computing the cost of the body features
-	cost = terrain_cost;
-	unsigned int feature_size = features_.size();
 	for (unsigned int i = 0; i < feature_size; i++) {
 		// Computing the cost associated with body path features
 		double feature_cost, weight;
@@ -376,6 +440,114 @@ void GridBasedBodyAdjacency::computeBodyCost(double& cost,
 		// Computing the cost of the body feature
 		cost += weight * feature_cost;
 	}
+
+	// Memoizing the cost in lazy evaluation
+	if (is_lazy_)
+		body_cost_table_[state_vertex] = MemoizedCost(cost, revision, is_unperceived);
+}
+
+
+void GridBasedBodyAdjacency::clearMemoizedCosts()
+{
+	body_cost_table_.clear();
+}
+
+
+utils::MemoryUsage GridBasedBodyAdjacency::getMemoryUsage() const
+{
+	utils::MemoryUsage usage = AdjacencyModel::getMemoryUsage();
+	usage.add("stance_areas", utils::getHeapBytes(stance_areas_));
+	usage.add("stance_masks", utils::getHeapBytes(stance_masks_));
+	usage.add("stance_costs", utils::getHeapBytes(stance_costs_));
+	usage.add("body_costs", body_cost_table_.getHeapBytes());
+
+	return usage;
+}
+
+
+const GridBasedBodyAdjacency::StanceMask& GridBasedBodyAdjacency::getStanceMask(double yaw)
+{
+	// Clearing the masks if the resolutions were changed
+	const environment::SpaceDiscretization& space_model = terrain_->getTerrainSpaceModel();
+	double resolution = space_model.getEnvironmentResolution(true);
+	double angular_resolution = space_model.getStateResolution(false);
+	if (resolution != mask_resolution_ || angular_resolution != mask_angular_resolution_) {
+		stance_masks_.clear();
+		body_cost_table_.clear();
+		mask_resolution_ = resolution;
+		mask_angular_resolution_ = angular_resolution;
+	}
+
+	// Getting the heading of the body. Note that the states are multiples of the angular
+	// resolution
+	math::normalizeAngle(yaw, ZeroTo2Pi);
+	unsigned int heading = (unsigned int) round(yaw / angular_resolution);
+	if (heading >= stance_masks_.size())
+		stance_masks_.resize(heading + 1);
+	StanceMask& mask = stance_masks_[heading];
+	if (mask.is_computed)
+		return mask;
+
+	// Discretizing the rotated stance areas around the center of a reference cell, where the
+	// cells rotated according to the orientation of the body are precomputed by the robot
+	const unsigned short int ref_key = 32768;
+	double ref_coord;
+	space_model.keyToCoord(ref_coord, ref_key, true);
+	double heading_yaw = heading * angular_resolution;
+	const SearchAreaCells& stance_cells =
+			robot_->getFootstepSearchCells(Eigen::Vector3d::Zero(), heading_yaw);
+	std::vector<std::pair<int,int> > offsets;
+	mask.offset_x.clear();
+	mask.offset_y.clear();
+	mask.area_sizes.clear();
+	unsigned int cell_idx = 0;
+	for (unsigned int n = 0; n < stance_cells.sizes.size(); n++) {
+		offsets.clear();
+		unsigned int end_idx = cell_idx + stance_cells.sizes[n];
+		for (; cell_idx < end_idx; cell_idx++) {
+			double point_x = stance_cells.points(0, cell_idx) + ref_coord;
+			double point_y = stance_cells.points(1, cell_idx) + ref_coord;
+
+			unsigned short int key_x, key_y;
+			space_model.coordToKey(key_x, point_x, true);
+			space_model.coordToKey(key_y, point_y, true);
+			offsets.push_back(std::pair<int,int>((int) key_x - ref_key,
+												 (int) key_y - ref_key));
+		}
+
+		// Removing the repeated cells, which don't change the distinct lowest costs
+		std::sort(offsets.begin(), offsets.end());
+		offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+		for (unsigned int i = 0; i < offsets.size(); i++) {
+			mask.offset_x.push_back(offsets[i].first);
+			mask.offset_y.push_back(offsets[i].second);
+		}
+		mask.area_sizes.push_back(offsets.size());
+	}
+
+	// Computing the bounding box of the cells
+	mask.min_offset_x = mask.min_offset_y = 0;
+	mask.max_offset_x = mask.max_offset_y = 0;
+	if (!mask.offset_x.empty()) {
+		mask.min_offset_x = *std::min_element(mask.offset_x.begin(), mask.offset_x.end());
+		mask.max_offset_x = *std::max_element(mask.offset_x.begin(), mask.offset_x.end());
+		mask.min_offset_y = *std::min_element(mask.offset_y.begin(), mask.offset_y.end());
+		mask.max_offset_y = *std::max_element(mask.offset_y.begin(), mask.offset_y.end());
+	}
+	mask.is_computed = true;
+
+	return mask;
+}
+
+
+void GridBasedBodyAdjacency::computeDefaultStanceAreas()
+{
+	if (stance_areas_.empty()) {
+		Eigen::Vector3d full_action = Eigen::Vector3d::Zero();
+		stance_areas_ = robot_->getFootstepSearchAreas(full_action);
+		stance_masks_.clear();
+		body_cost_table_.clear();
+	}
 }
 
 
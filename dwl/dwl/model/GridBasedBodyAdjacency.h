@@ -2,6 +2,7 @@
 #define DWL__MODEL__GRID_BASED_BODY_ADJACENCY__H
 
 #include <dwl/model/AdjacencyModel.h>
+#include <dwl/utils/VertexTable.h>
 
 
 namespace dwl
@@ -24,6 +25,12 @@ class GridBasedBodyAdjacency : public AdjacencyModel
 		/** @brief Destructor function */
 		~GridBasedBodyAdjacency();
 
+		/**
+		 * @brief Clones the grid-based body adjacency model
+		 * @return AdjacencyModel* A new copy of the model
+		 */
+		AdjacencyModel* clone() const;
+
 		/**
 		 * @brief Computes the whole adjacency map
 		 * @param AdjacencyMap& Adjacency map
@@ -36,14 +43,93 @@ class GridBasedBodyAdjacency : public AdjacencyModel
 
 		/**
 		 * @brief Gets the successors of the current vertex
-		 * @param std::list<Edge>& List of successors
+		 * @param EdgeList& List of successors
 		 * @param Vertex Current state vertex
 		 */
-		void getSuccessors(std::list<Edge>& successors,
+		void getSuccessors(EdgeList& successors,
 						   Vertex state_vertex);
 
+		/**
+		 * @brief Gets the 8-connected neighbor of the current vertex in a direction of the
+		 * terrain grid, where the yaw is kept. The weight is defined as in the successors
+		 * @param Edge& Neighbor vertex and the weight of its edge
+		 * @param Vertex Current state vertex
+		 * @param int Direction in the x-axis (-1, 0 or 1)
+		 * @param int Direction in the y-axis (-1, 0 or 1)
+		 * @return True if the neighbor cell has terrain information
+		 */
+		bool getGridNeighbor(Edge& neighbor,
+							 Vertex state_vertex,
+							 int dx, int dy);
+
+		/**
+		 * @brief Clears the body costs memoized during the lazy evaluation. Note that the
+		 * memoized costs of the changed terrain cells are recomputed without clearing them
+		 */
+		void clearMemoizedCosts();
+
+		/**
+		 * @brief Gets the memory report of the adjacency model, i.e. the bytes of its caches
+		 * @return The memory report
+		 */
+		utils::MemoryUsage getMemoryUsage() const;
+
 
 	private:
+		/**
+		 * @brief Key offsets of the cells of the stance areas for a heading of the body, i.e.
+		 * relative to the key of the body cell
+		 */
+		struct StanceMask
+		{
+			StanceMask() : min_offset_x(0), min_offset_y(0), max_offset_x(0), max_offset_y(0),
+					is_computed(false) {}
+
+			/** @brief Key offsets of the cells, which are stacked per stance area */
+			std::vector<int> offset_x;
+			std::vector<int> offset_y;
+
+			/** @brief Number of cells of every stance area */
+			std::vector<unsigned int> area_sizes;
+
+			/** @brief Bounding box of the key offsets */
+			int min_offset_x, min_offset_y;
+			int max_offset_x, max_offset_y;
+
+			/** @brief Indicates if the mask was computed */
+			bool is_computed;
+
+			/** @brief Gets the heap bytes of the key offsets */
+			std::size_t getHeapBytes() const {
+				return utils::getHeapBytes(offset_x) + utils::getHeapBytes(offset_y) +
+						utils::getHeapBytes(area_sizes);
+			}
+		};
+
+		/**
+		 * @brief Memoized body cost, i.e. the cost, the terrain revision of its last validation
+		 * and if it uses the average cost of the terrain (unperceived stance areas)
+		 */
+		struct MemoizedCost
+		{
+			MemoizedCost() : cost(0.), revision(0), is_unperceived(false) {}
+			MemoizedCost(Weight cost, unsigned long revision, bool is_unperceived) :
+				cost(cost), revision(revision), is_unperceived(is_unperceived) {}
+
+			Weight cost;
+			unsigned long revision;
+			bool is_unperceived;
+		};
+
+		/**
+		 * @brief Gets the stance mask of a heading, which is computed if it wasn't before. The
+		 * rotated stance areas are discretized around the center of a reference cell, and their
+		 * repeated cells are removed
+		 * @param double Yaw of the body
+		 * @return const StanceMask& Stance mask of the heading
+		 */
+		const StanceMask& getStanceMask(double yaw);
+
 		/**
 		 * @brief Searches the neighbors of a current vertex
 		 * @param std::vector<Vertex>& The set of states neighbors
@@ -59,6 +145,9 @@ class GridBasedBodyAdjacency : public AdjacencyModel
 		void computeBodyCost(double& cost,
 							 Vertex state_vertex);
 
+		/** @brief Computes the default stance areas if they weren't computed before */
+		void computeDefaultStanceAreas();
+
 		/** @brief Asks if it is requested a stance adjacency */
 		bool isStanceAdjacency();
 
@@ -68,6 +157,20 @@ class GridBasedBodyAdjacency : public AdjacencyModel
 		/** @brief A Map of search areas */
 		SearchAreaMap stance_areas_;
 
+		/** @brief Stance masks per heading, and the resolutions of their computation */
+		std::vector<StanceMask> stance_masks_;
+		double mask_resolution_;
+		double mask_angular_resolution_;
+
+		/** @brief Workspace of the cell costs of a stance area */
+		std::vector<Weight> stance_costs_;
+
+		/**
+		 * @brief Body costs per state vertex memoized during the lazy evaluation, which are
+		 * kept between searches and validated with the terrain changes
+		 */
+		VertexTable<MemoizedCost> body_cost_table_;
+
 		/** @brief Definition of the neighboring area (number of neighbors per size) */
 		int neighboring_definition_;
 
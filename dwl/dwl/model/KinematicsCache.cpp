@@ -0,0 +1,103 @@
+#include <dwl/model/KinematicsCache.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+KinematicsCache::KinematicsCache() : valid_pos_(false), valid_vel_(false), valid_acc_(false),
+		generated_(NULL)
+{
+
+}
+
+
+KinematicsCache::~KinematicsCache()
+{
+
+}
+
+
+void KinematicsCache::update(RigidBodyDynamics::Model& model,
+							 const Eigen::VectorXd& q,
+							 const Eigen::VectorXd* qd,
+							 const Eigen::VectorXd* qdd)
+{
+	// Checking which levels of the cached state are still valid. Note that a new position
+	// invalidates the velocity, and a new velocity invalidates the acceleration
+	bool same_pos = isUpdated(q);
+	bool same_vel = same_pos && valid_vel_ &&
+			(qd == NULL || (qd->size() == qd_.size() && *qd == qd_));
+	bool same_acc = same_vel && valid_acc_ &&
+			(qdd == NULL || (qdd->size() == qdd_.size() && *qdd == qdd_));
+
+	if (qdd != NULL && qd == NULL && !same_vel) {
+		// The acceleration can't be updated without a valid velocity
+		qdd = NULL;
+	}
+
+	const Eigen::VectorXd* pos_update = same_pos ? NULL : &q;
+	const Eigen::VectorXd* vel_update = (qd == NULL || same_vel) ? NULL : qd;
+	const Eigen::VectorXd* acc_update = (qdd == NULL || same_acc) ? NULL : qdd;
+	if (pos_update == NULL && vel_update == NULL && acc_update == NULL)
+		return;
+
+	// Note that the velocity and acceleration passes of RBDL read the joint position, so
+	// it's always passed for them (the position pass doesn't change the model if the
+	// position is the cached one)
+	if (generated_ != NULL && vel_update == NULL && acc_update == NULL)
+		generated_->updatePositions(model, q.data());
+	else if (vel_update != NULL || acc_update != NULL)
+		RigidBodyDynamics::UpdateKinematicsCustom(model, &q, vel_update, acc_update);
+	else
+		RigidBodyDynamics::UpdateKinematicsCustom(model, pos_update, NULL, NULL);
+
+	// Updating the cached state
+	if (pos_update != NULL) {
+		q_ = q;
+		valid_pos_ = true;
+		valid_vel_ = false;
+		valid_acc_ = false;
+	}
+	if (vel_update != NULL) {
+		qd_ = *qd;
+		valid_vel_ = true;
+		valid_acc_ = false;
+	}
+	if (acc_update != NULL) {
+		qdd_ = *qdd;
+		valid_acc_ = true;
+	}
+}
+
+
+void KinematicsCache::invalidate()
+{
+	valid_pos_ = false;
+	valid_vel_ = false;
+	valid_acc_ = false;
+}
+
+
+bool KinematicsCache::isUpdated(const Eigen::VectorXd& q) const
+{
+	return valid_pos_ && q.size() == q_.size() && q == q_;
+}
+
+
+void KinematicsCache::setGeneratedModel(const GeneratedModel* generated)
+{
+	generated_ = generated;
+	invalidate();
+}
+
+
+const GeneratedModel* KinematicsCache::getGeneratedModel() const
+{
+	return generated_;
+}
+
+} //@namespace model
+} //@namespace dwl
@@ -0,0 +1,86 @@
+#ifndef DWL__MODEL__KINEMATICS_CACHE__H
+#define DWL__MODEL__KINEMATICS_CACHE__H
+
+#include <dwl/model/GeneratedModel.h>
+#include <rbdl/rbdl.h>
+#include <Eigen/Dense>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class KinematicsCache
+ * @brief Snapshot of the kinematics state of a RBDL model, i.e. the generalized position,
+ * velocity and acceleration used in its last update. The model is only updated (with
+ * UpdateKinematicsCustom) for the levels whose state changed, so a sequence of kinematic
+ * queries at the same state traverses the tree once. Any RBDL call that updates the model
+ * by itself (e.g. the dynamics algorithms) has to invalidate the cache. The position-only
+ * updates use the generated transforms of the model, if there are (see GeneratedModel)
+ */
+class KinematicsCache
+{
+	public:
+		/** @brief Constructor function */
+		KinematicsCache();
+
+		/** @brief Destructor function */
+		~KinematicsCache();
+
+		/**
+		 * @brief Updates the kinematics of the model if the state is different to the cached
+		 * one. Note that the acceleration update requires the velocity
+		 * @param RigidBodyDynamics::Model& Rigid-body dynamic model
+		 * @param const Eigen::VectorXd& Generalized position
+		 * @param const Eigen::VectorXd* Generalized velocity (it isn't updated if it's NULL)
+		 * @param const Eigen::VectorXd* Generalized acceleration (it isn't updated if it's NULL)
+		 */
+		void update(RigidBodyDynamics::Model& model,
+					const Eigen::VectorXd& q,
+					const Eigen::VectorXd* qd = NULL,
+					const Eigen::VectorXd* qdd = NULL);
+
+		/** @brief Invalidates the cached state, i.e. the next update traverses the tree */
+		void invalidate();
+
+		/**
+		 * @brief Indicates if the model is updated with a generalized position
+		 * @param const Eigen::VectorXd& Generalized position
+		 */
+		bool isUpdated(const Eigen::VectorXd& q) const;
+
+		/**
+		 * @brief Sets the generated kinematics and dynamics of the model
+		 * @param const GeneratedModel* Generated model (it isn't used if it's NULL)
+		 */
+		void setGeneratedModel(const GeneratedModel* generated);
+
+		/**
+		 * @brief Gets the generated kinematics and dynamics of the model
+		 * @return const GeneratedModel* Generated model, or NULL if there isn't one
+		 */
+		const GeneratedModel* getGeneratedModel() const;
+
+
+	private:
+		/** @brief Cached generalized position, velocity and acceleration */
+		Eigen::VectorXd q_;
+		Eigen::VectorXd qd_;
+		Eigen::VectorXd qdd_;
+
+		/** @brief Labels that indicate if the model is updated with the cached state */
+		bool valid_pos_;
+		bool valid_vel_;
+		bool valid_acc_;
+
+		/** @brief Generated kinematics and dynamics of the model */
+		const GeneratedModel* generated_;
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
@@ -1,4 +1,5 @@
 #include <dwl/model/LatticeBasedBodyAdjacency.h>
+#include <climits>
 
 
 namespace dwl
@@ -8,7 +9,8 @@ namespace model
 {
 
 LatticeBasedBodyAdjacency::LatticeBasedBodyAdjacency() : is_stance_adjacency_(true),
-		number_top_cost_(10)
+		lattice_resolution_(0.), number_top_cost_(10), obstacle_weight_(0.),
+		obstacle_inflation_(0.), fine_radius_(0.)
 {
 	name_ = "Lattice-based Body";
 	is_lattice_ = true;
@@ -21,29 +23,22 @@ LatticeBasedBodyAdjacency::~LatticeBasedBodyAdjacency()
 }
 
 
-void LatticeBasedBodyAdjacency::getSuccessors(std::list<Edge>& successors,
+void LatticeBasedBodyAdjacency::getSuccessors(EdgeList& successors,
 											  Vertex state_vertex)
 {
 	// Getting the 3d pose for generating the actions
-	std::vector<Action3d> actions;
 	Eigen::Vector3d current_state;
 	terrain_->getTerrainSpaceModel().vertexToState(current_state, state_vertex);
 
-	// Converting state to pose
-	Pose3d current_pose;
-	current_pose.position = current_state.head(2);
-	current_pose.orientation = current_state(2);
-
-	// Gets actions according the defined body motor primitives
-	robot_->getBodyMotorPrimitive().generateActions(actions, current_pose);
-
 	// Evaluating every action (body motor primitives)
 	if (terrain_->isTerrainInformation()) {
+		// Gets the precomputed actions of the heading of the state
+		const std::vector<LatticeAction>& actions = getLatticeActions(current_state(2));
+
 		unsigned int action_size = actions.size();
 		for (unsigned int i = 0; i < action_size; i++) {
 			// Converting the action to current vertex
-			Eigen::Vector3d action_state;
-			action_state << actions[i].pose.position, actions[i].pose.orientation;
+			Eigen::Vector3d action_state = current_state + actions[i].action;
 			Vertex current_action_vertex, terrain_vertex;
 			terrain_->getTerrainSpaceModel().stateToVertex(current_action_vertex, action_state);
 
@@ -52,7 +47,7 @@ void LatticeBasedBodyAdjacency::getSuccessors(std::list<Edge>& successors,
 					current_action_vertex, XY_Y);
 
 			// Computing the current action
-			current_action_ = action_state - current_state;
+			current_action_ = actions[i].action;
 
 			// Checks if there is an obstacle
 			if (isFreeOfObstacle(current_action_vertex, XY_Y, true)) {
@@ -67,7 +62,7 @@ void LatticeBasedBodyAdjacency::getSuccessors(std::list<Edge>& successors,
 				} else {
 					// Computing the body cost
 					double body_cost;
-					computeBodyCost(body_cost, action_state);
+					computeBodyCost(body_cost, action_state, actions[i]);
 					body_cost += actions[i].cost;
 					successors.push_back(Edge(current_action_vertex, body_cost));
 				}
@@ -79,70 +74,76 @@ void LatticeBasedBodyAdjacency::getSuccessors(std::list<Edge>& successors,
 }
 
 
-void LatticeBasedBodyAdjacency::computeBodyCost(double& cost,
-												Eigen::Vector3d state)
+void LatticeBasedBodyAdjacency::resetLatticeActions()
+{
+	lattice_.clear();
+}
+
+
+void LatticeBasedBodyAdjacency::setObstacleCost(double weight,
+												double inflation_distance)
+{
+	obstacle_weight_ = weight;
+	obstacle_inflation_ = inflation_distance;
+}
+
+
+void LatticeBasedBodyAdjacency::setMultiResolution(double fine_radius)
+{
+	fine_radius_ = fine_radius;
+}
+
+
+utils::MemoryUsage LatticeBasedBodyAdjacency::getMemoryUsage() const
 {
-	// Getting the stance areas according to the action
-	stance_areas_ = robot_->getFootstepSearchAreas(current_action_);
+	utils::MemoryUsage usage = AdjacencyModel::getMemoryUsage();
+	usage.add("lattice_actions", utils::getHeapBytes(lattice_));
+	usage.add("footprint", utils::getHeapBytes(footprint_keys_) +
+			utils::getHeapBytes(footprint_));
+	usage.add("stance_costs", utils::getHeapBytes(stance_costs_));
+
+	return usage;
+}
 
-	// Computing the terrain cost
+
+void LatticeBasedBodyAdjacency::computeBodyCost(double& cost,
+												Eigen::Vector3d state,
+												const LatticeAction& action)
+{
+	// Computing the terrain cost, where the far states use the terrain pyramid instead of
+	// the cells of the stance areas
 	double terrain_cost = 0;
-	unsigned int area_size = stance_areas_.size();
+	unsigned int area_size = action.stance_sizes.size();
+	if (getCoarseTerrainCost(terrain_cost, state))
+		area_size = 0;
+	unsigned int point_idx = 0;
+	const environment::SpaceDiscretization& space_model = terrain_->getTerrainSpaceModel();
 	for (unsigned int n = 0; n < area_size; n++) {
-		// Computing the boundary of stance area
-		Eigen::Vector2d boundary_min, boundary_max;
-		boundary_min(0) = stance_areas_[n].min_x + state(0);
-		boundary_min(1) = stance_areas_[n].min_y + state(1);
-		boundary_max(0) = stance_areas_[n].max_x + state(0);
-		boundary_max(1) = stance_areas_[n].max_y + state(1);
-
-		// Computing the stance cost
-		std::set< std::pair<Weight, Vertex>, pair_first_less<Weight, Vertex> > stance_cost_queue;
-		double stance_cost = 0;
-		double resolution = stance_areas_[n].resolution;
-		for (double y = boundary_min(1); y <= boundary_max(1); y += resolution) {
-			for (double x = boundary_min(0); x <= boundary_max(0); x += resolution) {
-				// Computing the rotated coordinate according to the orientation of the body
-				Eigen::Vector2d point_position;
-				double current_x = state(0);
-				double current_y = state(1);
-				double current_yaw = state(2);
-				point_position(0) = (x - current_x) * cos(current_yaw) -
-						(y - current_y) * sin(current_yaw) + current_x;
-				point_position(1) = (x - current_x) * sin(current_yaw) +
-						(y - current_y) * cos(current_yaw) + current_y;
-
-				Vertex current_2d_vertex;
-				terrain_->getTerrainSpaceModel().coordToVertex(current_2d_vertex, point_position);
-
-				// Inserts the element in an organized vertex queue, according to the maximum value
-				if (terrain_->getTerrainDataMap().count(current_2d_vertex) > 0) {
-					stance_cost_queue.insert(std::pair<Weight, Vertex>(
-							terrain_->getTerrainCost(current_2d_vertex),
-							current_2d_vertex));
-				}
-			}
+		// Computing the stance cost from the precomputed points of the stance area, which are
+		// already rotated according to the orientation of the body. The cells are looked up in
+		// the terrain grid by their keys
+		stance_costs_.clear();
+		unsigned int end_idx = point_idx + action.stance_sizes[n];
+		for (; point_idx < end_idx; point_idx++) {
+			Eigen::Vector2d point_position = state.head(2) + action.stance_points.col(point_idx);
+
+			Key key;
+			Weight cell_cost;
+			if (space_model.coordToKeyChecked(key.x, point_position(0), true) &&
+					space_model.coordToKeyChecked(key.y, point_position(1), true) &&
+					terrain_->getTerrainCost(cell_cost, key))
+				stance_costs_.push_back(cell_cost);
 		}
 
 		// Averaging the 5-best (lowest) cost
-		unsigned int number_top_cost = number_top_cost_;
-		if (stance_cost_queue.size() < number_top_cost)
-			number_top_cost = stance_cost_queue.size();
-
-		if (number_top_cost == 0) {
-			stance_cost += uncertainty_factor_ * terrain_->getAverageCostOfTerrain();
-		} else {
-			for (unsigned int i = 0; i < number_top_cost; i++) {
-				stance_cost += stance_cost_queue.begin()->first;
-				stance_cost_queue.erase(stance_cost_queue.begin());
-			}
-
-			stance_cost /= number_top_cost;
-		}
+		double stance_cost;
+		if (!computeStanceCost(stance_cost, stance_costs_, number_top_cost_))
+			stance_cost = uncertainty_factor_ * terrain_->getAverageCostOfTerrain();
 
 		terrain_cost += stance_cost;
 	}
-	terrain_cost /= stance_areas_.size();
+	if (area_size != 0)
+		terrain_cost /= area_size;
 
 
 	// Getting robot and terrain information
@@ -165,6 +166,87 @@ void LatticeBasedBodyAdjacency::computeBodyCost(double& cost,
 		// Computing the cost of the body feature
 		cost += weight * feature_cost;
 	}
+
+	// Computing the obstacle cost from the clearance of the body
+	double obstacle_distance;
+	if (obstacle_weight_ > 0. && obstacle_inflation_ > 0. &&
+			getObstacleDistance(obstacle_distance, state(0), state(1))) {
+		double clearance = std::max(obstacle_distance - getBodyRadius(), 0.);
+		if (clearance < obstacle_inflation_)
+			cost += obstacle_weight_ * pow(1. - clearance / obstacle_inflation_, 2);
+	}
+}
+
+
+const std::vector<LatticeBasedBodyAdjacency::LatticeAction>&
+LatticeBasedBodyAdjacency::getLatticeActions(double yaw)
+{
+	// Clearing the table if the angular resolution was changed
+	double angular_resolution = terrain_->getTerrainSpaceModel().getStateResolution(false);
+	if (angular_resolution != lattice_resolution_) {
+		lattice_.clear();
+		lattice_resolution_ = angular_resolution;
+	}
+
+	// Getting the heading of the state. Note that the lattice states are multiples of the
+	// angular resolution
+	math::normalizeAngle(yaw, ZeroTo2Pi);
+	unsigned int heading = (unsigned int) round(yaw / angular_resolution);
+	if (heading >= lattice_.size())
+		lattice_.resize(heading + 1);
+	LatticeHeading& lattice_heading = lattice_[heading];
+	if (lattice_heading.is_computed)
+		return lattice_heading.actions;
+
+	// Generating the actions from the origin, i.e. their displacements in the world frame
+	Pose3d heading_pose;
+	heading_pose.position.setZero();
+	heading_pose.orientation = heading * angular_resolution;
+	std::vector<Action3d> actions;
+	robot_->getBodyMotorPrimitive().generateActions(actions, heading_pose);
+
+	lattice_heading.actions.resize(actions.size());
+	for (unsigned int i = 0; i < actions.size(); i++) {
+		LatticeAction& action = lattice_heading.actions[i];
+		action.action << actions[i].pose.position,
+				actions[i].pose.orientation - heading_pose.orientation;
+		action.cost = actions[i].cost;
+
+		// Getting the points of the stance areas relative to the action state, and rotated
+		// according to its orientation
+		const SearchAreaCells& stance_cells =
+				robot_->getFootstepSearchCells(action.action, actions[i].pose.orientation);
+		action.stance_points = stance_cells.points;
+		action.stance_sizes = stance_cells.sizes;
+	}
+	lattice_heading.is_computed = true;
+
+	return lattice_heading.actions;
+}
+
+
+bool LatticeBasedBodyAdjacency::getCoarseTerrainCost(double& cost,
+													 const Eigen::Vector3d& state)
+{
+	unsigned int num_levels = terrain_->getTerrainPyramid().getNumberOfLevels();
+	if (fine_radius_ <= 0. || num_levels == 0)
+		return false;
+
+	// Choosing the level from the distance to the robot, i.e. one level per doubling
+	Eigen::Vector2d robot_pos = robot_->getCurrentPose().position.head(2);
+	double distance = (state.head(2) - robot_pos).norm();
+	if (distance <= fine_radius_)
+		return false;
+	unsigned int level = std::min((unsigned int) floor(log2(distance / fine_radius_)) + 1,
+								  num_levels);
+
+	const environment::TerrainAggregate* aggregate =
+			terrain_->getTerrainAggregate((Eigen::Vector2d) state.head(2), level);
+	if (aggregate == NULL)
+		return false;
+
+	cost = aggregate->mean_cost;
+	return true;
 }
 
 
@@ -172,20 +254,21 @@ bool LatticeBasedBodyAdjacency::isFreeOfObstacle(Vertex state_vertex,
 												 TypeOfState state_representation,
 												 bool body)
 {
-	// Getting the terrain obstacle map
-	ObstacleMap obstacle_map = terrain_->getObstacleMap();
+	// Getting the terrain obstacle grid
+	const environment::OccupancyGrid& obstacle_grid = terrain_->getObstacleGrid();
+	const environment::SpaceDiscretization& obstacle_space = terrain_->getObstacleSpaceModel();
 
 	// Converting the vertex to state (x,y,yaw)
 	Eigen::Vector3d state_3d;
 	Eigen::Vector2d state_2d;
 	double current_x, current_y, current_yaw;
 	if (state_representation == XY) {
-		terrain_->getObstacleSpaceModel().vertexToState(state_2d, state_vertex);
+		obstacle_space.vertexToState(state_2d, state_vertex);
 		current_x = state_2d(0);
 		current_y = state_2d(1);
 		current_yaw = 0;
 	} else {
-		terrain_->getObstacleSpaceModel().vertexToState(state_3d, state_vertex);
+		obstacle_space.vertexToState(state_3d, state_vertex);
 		current_x = state_3d(0);
 		current_y = state_3d(1);
 		current_yaw = state_3d(2);
@@ -195,7 +278,7 @@ bool LatticeBasedBodyAdjacency::isFreeOfObstacle(Vertex state_vertex,
 	if (terrain_->isObstacleInformation()) {
 		if (body) {
 			// Getting the body area of the robot
-			SearchArea body_workspace = robot_->getPredefinedBodyWorkspace();
+			const SearchArea& body_workspace = robot_->getPredefinedBodyWorkspace();
 
 			// Computing the boundary of stance area
 			Eigen::Vector2d boundary_min, boundary_max;
@@ -209,45 +292,104 @@ bool LatticeBasedBodyAdjacency::isFreeOfObstacle(Vertex state_vertex,
 			if (body_workspace.resolution > obstacle_resolution)
 				obstacle_resolution = body_workspace.resolution;
 
+			// The body is free if the closest obstacle is outside its circumscribed circle. Note
+			// that the margin accounts for the discretization of the body and obstacle positions
+			double obstacle_distance;
+			double body_radius = getBodyRadius() + sqrt(2.) * terrain_->getObstacleResolution();
+			if (getObstacleDistance(obstacle_distance, current_x, current_y) &&
+					body_radius < terrain_->getObstacleDistanceField().getMaxDistance() &&
+					obstacle_distance > body_radius)
+				return true;
+
+			// Computing the keys of the rotated body area. Note that the rotated area is
+			// convex, so the keys of every row are a span
+			double cos_yaw = cos(current_yaw);
+			double sin_yaw = sin(current_yaw);
+			footprint_keys_.clear();
 			for (double y = boundary_min(1); y <= boundary_max(1); y += obstacle_resolution) {
 				for (double x = boundary_min(0); x <= boundary_max(0); x += obstacle_resolution) {
 					// Computing the rotated coordinate according to the orientation of the body
-					Eigen::Vector2d point_position;
-					point_position(0) = (x - current_x) * cos(current_yaw) -
-							(y - current_y) * sin(current_yaw) + current_x;
-					point_position(1) = (x - current_x) * sin(current_yaw) +
-							(y - current_y) * cos(current_yaw) + current_y;
-
-					Vertex current_2d_vertex;
-					terrain_->getObstacleSpaceModel().coordToVertex(current_2d_vertex, point_position);
-
-					// Checking if there is an obstacle
-					if (obstacle_map.count(current_2d_vertex) > 0) {
-						if (obstacle_map.find(current_2d_vertex)->second) {
-							is_free = false;
-							goto found_obstacle;
-						}
-					}
+					double point_x = (x - current_x) * cos_yaw -
+							(y - current_y) * sin_yaw + current_x;
+					double point_y = (x - current_x) * sin_yaw +
+							(y - current_y) * cos_yaw + current_y;
+
+					Key key;
+					if (obstacle_space.coordToKeyChecked(key.x, point_x, true) &&
+							obstacle_space.coordToKeyChecked(key.y, point_y, true))
+						footprint_keys_.push_back(key);
+				}
+			}
+
+			// Building the row spans of the footprint
+			footprint_.clear();
+			if (!footprint_keys_.empty()) {
+				unsigned short int min_y = footprint_keys_[0].y, max_y = min_y;
+				for (unsigned int i = 1; i < footprint_keys_.size(); i++) {
+					min_y = std::min(min_y, footprint_keys_[i].y);
+					max_y = std::max(max_y, footprint_keys_[i].y);
+				}
+
+				footprint_.resize(max_y - min_y + 1,
+								  environment::RowSpan(0, USHRT_MAX, 0));
+				for (unsigned int i = 0; i < footprint_keys_.size(); i++) {
+					const Key& key = footprint_keys_[i];
+					environment::RowSpan& span = footprint_[key.y - min_y];
+					span.y = key.y;
+					span.min_x = std::min(span.min_x, key.x);
+					span.max_x = std::max(span.max_x, key.x);
 				}
 			}
+
+			// Checking if there is an obstacle. Note that the rows without keys have an empty
+			// span
+			is_free = !obstacle_grid.isAnyOccupied(footprint_);
 		} else {
 			// Converting the state vertex to terrain vertex
 			Vertex terrain_vertex;
-			terrain_->getObstacleSpaceModel().stateVertexToEnvironmentVertex(terrain_vertex,
+			obstacle_space.stateVertexToEnvironmentVertex(terrain_vertex,
 					state_vertex, state_representation);
 
-			if (obstacle_map.count(terrain_vertex) > 0) {
-				if (obstacle_map.find(terrain_vertex)->second)
-					is_free = false;
-			}
+			Key terrain_key;
+			obstacle_space.vertexToKey(terrain_key, terrain_vertex, true);
+			if (obstacle_grid.isOccupied(terrain_key))
+				is_free = false;
 		}
 	}
 
-	found_obstacle:
 	return is_free;
 }
 
 
+double LatticeBasedBodyAdjacency::getBodyRadius()
+{
+	const SearchArea& body_workspace = robot_->getPredefinedBodyWorkspace();
+	double max_x = std::max(fabs(body_workspace.min_x), fabs(body_workspace.max_x));
+	double max_y = std::max(fabs(body_workspace.min_y), fabs(body_workspace.max_y));
+
+	return sqrt(max_x * max_x + max_y * max_y);
+}
+
+
+bool LatticeBasedBodyAdjacency::getObstacleDistance(double& distance,
+													double x,
+													double y)
+{
+	const environment::DistanceField& distance_field = terrain_->getObstacleDistanceField();
+	if (!terrain_->isObstacleInformation() || distance_field.isEmpty())
+		return false;
+
+	Key key;
+	const environment::SpaceDiscretization& obstacle_space = terrain_->getObstacleSpaceModel();
+	if (!obstacle_space.coordToKeyChecked(key.x, x, true) ||
+			!obstacle_space.coordToKeyChecked(key.y, y, true))
+		return false;
+
+	distance = distance_field.getDistance(key);
+	return true;
+}
+
+
 bool LatticeBasedBodyAdjacency::isStanceAdjacency()
 {
 	return is_stance_adjacency_;
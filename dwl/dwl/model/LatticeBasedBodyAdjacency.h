@@ -26,14 +26,84 @@ class LatticeBasedBodyAdjacency : public AdjacencyModel
 
 		/**
 		 * @brief Gets the successors of the current vertex
-		 * @param std::list<Edge>& List of successors
+		 * @param EdgeList& List of successors
 		 * @param Vertex Current state vertex
 		 */
-		void getSuccessors(std::list<Edge>& successors,
+		void getSuccessors(EdgeList& successors,
 						   Vertex state_vertex);
 
+		/**
+		 * @brief Sets the obstacle cost of the body, which increases quadratically when the
+		 * clearance of the body (distance of the obstacles to its circumscribed circle) is
+		 * smaller than the inflation distance
+		 * @param double Weight of the obstacle cost
+		 * @param double Inflation distance
+		 */
+		void setObstacleCost(double weight,
+							 double inflation_distance);
+
+		/**
+		 * @brief Sets the multi-resolution evaluation of the terrain cost. The stance areas are
+		 * evaluated with the terrain cells only near the robot (inside the fine radius), and the
+		 * farther states use the mean cost of a coarser level of the terrain pyramid, i.e. the
+		 * level increases by one every time the distance doubles. It requires the terrain
+		 * pyramid levels (see TerrainMap::setTerrainPyramidLevels)
+		 * @param double Fine radius around the current pose of the robot (0 disables it)
+		 */
+		void setMultiResolution(double fine_radius);
+
+		/**
+		 * @brief Resets the precomputed actions, e.g. after changing the body motor primitives
+		 * or the footstep search areas of the robot
+		 */
+		void resetLatticeActions();
+
+		/**
+		 * @brief Gets the memory report of the adjacency model, i.e. the bytes of its caches
+		 * @return The memory report
+		 */
+		utils::MemoryUsage getMemoryUsage() const;
+
 
 	private:
+		/**
+		 * @brief Struct that defines a precomputed action of a heading, i.e. its displacement
+		 * in the world frame and the points of its stance areas
+		 */
+		struct LatticeAction
+		{
+			/** @brief Displacement (x,y,yaw) in the world frame */
+			Eigen::Vector3d action;
+
+			/** @brief Cost of the motor primitive */
+			Weight cost;
+
+			/** @brief Points of the stance areas relative to the action state */
+			Eigen::Matrix2Xd stance_points;
+
+			/** @brief Number of points of every stance area */
+			std::vector<unsigned int> stance_sizes;
+
+			/** @brief Gets the heap bytes of the stance areas */
+			std::size_t getHeapBytes() const {
+				return utils::getHeapBytes(stance_points) + utils::getHeapBytes(stance_sizes);
+			}
+		};
+
+		/** @brief Struct that defines the precomputed actions of a heading */
+		struct LatticeHeading
+		{
+			LatticeHeading() : is_computed(false) {}
+
+			std::vector<LatticeAction> actions;
+			bool is_computed;
+
+			/** @brief Gets the heap bytes of the actions */
+			std::size_t getHeapBytes() const {
+				return utils::getHeapBytes(actions);
+			}
+		};
+
 		/**
 		 * @brief Searches the neighbors of a current vertex
 		 * @param std::vector<Vertex>& The set of neighbors
@@ -44,10 +114,31 @@ class LatticeBasedBodyAdjacency : public AdjacencyModel
 
 		/**
 		 * @brief Computes the body cost of a current vertex
+		 * @param double& Body cost
 		 * @param Eigen::Vector3d Current robot state (x,y,yaw)
+		 * @param const LatticeAction& Precomputed action that reaches the state
 		 */
 		void computeBodyCost(double& cost,
-							 Eigen::Vector3d state);
+							 Eigen::Vector3d state,
+							 const LatticeAction& action);
+
+		/**
+		 * @brief Gets the precomputed actions of a heading, which are computed the first time
+		 * that the heading is expanded. So the generation of successors is a lookup instead of
+		 * transforming the motor primitives and computing the stance areas every expansion
+		 * @param double Orientation of the lattice state
+		 * @return The precomputed actions of the heading
+		 */
+		const std::vector<LatticeAction>& getLatticeActions(double yaw);
+
+		/**
+		 * @brief Gets the terrain cost of a far state from the terrain pyramid
+		 * @param double& Terrain cost
+		 * @param const Eigen::Vector3d& Robot state (x,y,yaw)
+		 * @return False if the state is near the robot or there isn't coarse information
+		 */
+		bool getCoarseTerrainCost(double& cost,
+								  const Eigen::Vector3d& state);
 
 		/**
 		 * @brief Indicates if the free of obstacle
@@ -60,6 +151,23 @@ class LatticeBasedBodyAdjacency : public AdjacencyModel
 							  TypeOfState state_representation,
 							  bool body=false);
 
+		/**
+		 * @brief Computes the circumscribed radius of the body area around the body state
+		 * @return The circumscribed radius
+		 */
+		double getBodyRadius();
+
+		/**
+		 * @brief Gets the distance of a position to its closest obstacle
+		 * @param double& Distance to the closest obstacle
+		 * @param double Position along the x-axis
+		 * @param double Position along the y-axis
+		 * @return False if there isn't obstacle distance information
+		 */
+		bool getObstacleDistance(double& distance,
+								 double x,
+								 double y);
+
 		/**
 		 * @brief Indicates if it is requested a stance adjacency
 		 * @return True it is requested a stance adjacency (body cost), false otherwise
@@ -72,11 +180,26 @@ class LatticeBasedBodyAdjacency : public AdjacencyModel
 		/** @brief Indicates it was requested a stance or terrain adjacency */
 		bool is_stance_adjacency_;
 
-		/** @brief Map of search areas */
-		SearchAreaMap stance_areas_;
+		/** @brief Precomputed actions of every heading, and the angular resolution of them */
+		std::vector<LatticeHeading> lattice_;
+		double lattice_resolution_;
 
 		/** @brief Number of top cost for computing the stance cost */
 		int number_top_cost_;
+
+		/** @brief Weight and inflation distance of the obstacle cost */
+		double obstacle_weight_;
+		double obstacle_inflation_;
+
+		/** @brief Fine radius of the multi-resolution evaluation */
+		double fine_radius_;
+
+		/** @brief Keys and row spans of the body footprint (reused between queries) */
+		std::vector<Key> footprint_keys_;
+		std::vector<environment::RowSpan> footprint_;
+
+		/** @brief Workspace of the cell costs of a stance area */
+		std::vector<Weight> stance_costs_;
 };
 
 } //@namespace model
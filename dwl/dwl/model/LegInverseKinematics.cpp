@@ -0,0 +1,167 @@
+#include <dwl/model/LegInverseKinematics.h>
+#include <dwl/utils/Geometry.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+LegInverseKinematics::LegInverseKinematics()
+{
+
+}
+
+
+LegInverseKinematics::~LegInverseKinematics()
+{
+
+}
+
+
+std::shared_ptr<LegInverseKinematics> LegInverseKinematics::create(const std::string& type)
+{
+	if (type == "haa_hfe_kfe")
+		return std::make_shared<HAAHFEKFELegInverseKinematics>();
+
+	return std::shared_ptr<LegInverseKinematics>();
+}
+
+
+HAAHFEKFELegInverseKinematics::HAAHFEKFELegInverseKinematics() :
+		sagittal_offset_(0.), kfe_sense_(1.)
+{
+
+}
+
+
+HAAHFEKFELegInverseKinematics::~HAAHFEKFELegInverseKinematics()
+{
+
+}
+
+
+bool HAAHFEKFELegInverseKinematics::reset(const Eigen::MatrixXd& branch_jac,
+										  const Eigen::Vector3d& foot_pos,
+										  const Eigen::VectorXd& lower_limit,
+										  const Eigen::VectorXd& upper_limit)
+{
+	if (branch_jac.rows() != 6 || branch_jac.cols() != 3)
+		return false;
+
+	// Getting the joint axes and a point of every joint axis. Note that the linear Jacobian of
+	// a revolute joint is J = a x (p_foot - p), so the point p_foot + a x J is on the axis
+	Eigen::Vector3d axis[3], point[3];
+	for (unsigned int i = 0; i < 3; i++) {
+		Eigen::Vector3d angular_jac = branch_jac.block<3,1>(0,i);
+		Eigen::Vector3d linear_jac = branch_jac.block<3,1>(3,i);
+		if (angular_jac.norm() < 1e-9)
+			return false; // it isn't a revolute joint
+		axis[i] = angular_jac.normalized();
+		point[i] = foot_pos + axis[i].cross(linear_jac);
+	}
+
+	// Checking the leg structure, i.e. the HFE and KFE axes are parallel and perpendicular to
+	// the HAA axis
+	if (fabs(axis[0].dot(axis[1])) > 1e-6 || axis[1].cross(axis[2]).norm() > 1e-6)
+		return false;
+
+	haa_axis_ = axis[0];
+	haa_point_ = point[0];
+	hfe_axis_ = axis[1];
+	hfe_point_ = point[1];
+	kfe_sense_ = axis[1].dot(axis[2]) > 0. ? 1. : -1.;
+
+	// Plane perpendicular to the HAA axis, where the sagittal plane has a constant offset
+	haa_u_ = hfe_axis_;
+	haa_w_ = haa_axis_.cross(haa_u_);
+	sagittal_offset_ = hfe_axis_.dot(foot_pos - haa_point_);
+
+	// Projecting the thigh and shin onto the sagittal plane
+	Eigen::Vector3d thigh = point[2] - hfe_point_;
+	thigh -= hfe_axis_.dot(thigh) * hfe_axis_;
+	if (thigh.norm() < 1e-9)
+		return false;
+	sagittal_e1_ = thigh.normalized();
+	sagittal_e2_ = hfe_axis_.cross(sagittal_e1_);
+	Eigen::Vector3d shin = foot_pos - point[2];
+	thigh_ << sagittal_e1_.dot(thigh), sagittal_e2_.dot(thigh);
+	shin_ << sagittal_e1_.dot(shin), sagittal_e2_.dot(shin);
+	if (shin_.norm() < 1e-9)
+		return false;
+
+	lower_limit_ = lower_limit;
+	upper_limit_ = upper_limit;
+
+	return true;
+}
+
+
+bool HAAHFEKFELegInverseKinematics::compute(Eigen::VectorXd& branch_pos,
+											const Eigen::Vector3d& foot_pos,
+											const Eigen::VectorXd& branch_pos_init)
+{
+	branch_pos.resize(3);
+
+	// Computing the HAA angle that aligns the sagittal plane with the foot, i.e. the foot
+	// rotated by -q_haa has the offset of the sagittal plane
+	Eigen::Vector3d haa_foot = foot_pos - haa_point_;
+	double y = haa_u_.dot(haa_foot);
+	double z = haa_w_.dot(haa_foot);
+	double radius = sqrt(y * y + z * z);
+	if (radius < fabs(sagittal_offset_))
+		return false;
+	double phi = atan2(z, y);
+	double gamma = acos(sagittal_offset_ / radius);
+	branch_pos(0) = closestAngle(phi - gamma, phi + gamma, branch_pos_init(0));
+
+	// Expressing the foot position in the sagittal plane with zero HAA angle
+	Eigen::Vector3d sagittal_foot =
+			Eigen::AngleAxisd(-branch_pos(0), haa_axis_) * haa_foot + haa_point_ - hfe_point_;
+	Eigen::Vector2d foot_2d(sagittal_e1_.dot(sagittal_foot), sagittal_e2_.dot(sagittal_foot));
+
+	// Computing the KFE angle from the law of cosines
+	double l1 = thigh_.norm(), l2 = shin_.norm();
+	double cos_knee = (foot_2d.squaredNorm() - l1 * l1 - l2 * l2) / (2 * l1 * l2);
+	if (fabs(cos_knee) > 1.)
+		return false;
+	double knee = acos(cos_knee);
+	double knee_zero = atan2(thigh_(0) * shin_(1) - thigh_(1) * shin_(0), thigh_.dot(shin_));
+	branch_pos(2) = closestAngle(kfe_sense_ * (knee - knee_zero),
+								 kfe_sense_ * (-knee - knee_zero),
+								 branch_pos_init(2));
+
+	// Computing the HFE angle that rotates the 2R chain towards the foot
+	double knee_angle = kfe_sense_ * branch_pos(2);
+	Eigen::Vector2d chain = thigh_ + Eigen::Rotation2Dd(knee_angle) * shin_;
+	double hip = atan2(foot_2d(1), foot_2d(0)) - atan2(chain(1), chain(0));
+	branch_pos(1) = closestAngle(hip, hip, branch_pos_init(1));
+
+	// Checking the joint limits
+	for (unsigned int i = 0; i < 3; i++) {
+		if (branch_pos(i) < lower_limit_(i) || branch_pos(i) > upper_limit_(i))
+			return false;
+	}
+
+	return true;
+}
+
+
+double HAAHFEKFELegInverseKinematics::closestAngle(double angle1,
+												   double angle2,
+												   double reference) const
+{
+	double diff1 = angle1 - reference;
+	double diff2 = angle2 - reference;
+	math::normalizeAngle(diff1, MinusPiToPi);
+	math::normalizeAngle(diff2, MinusPiToPi);
+
+	if (fabs(diff1) <= fabs(diff2))
+		return reference + diff1;
+	else
+		return reference + diff2;
+}
+
+} //@namespace model
+} //@namespace dwl
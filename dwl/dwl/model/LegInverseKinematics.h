@@ -0,0 +1,159 @@
+#ifndef DWL__MODEL__LEG_INVERSE_KINEMATICS__H
+#define DWL__MODEL__LEG_INVERSE_KINEMATICS__H
+
+#include <Eigen/Dense>
+#include <memory>
+#include <string>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class LegInverseKinematics
+ * @brief Abstract class of analytic (closed-form) inverse kinematics of a leg, i.e. the branch
+ * of a foot. The leg geometry is defined from the kinematic model at the zero joint position,
+ * so a solver is defined by its kinematic structure and not by a specific robot. The
+ * dwl::model::WholeBodyKinematics class uses the registered solvers before its numerical IK,
+ * which is used as fallback if the analytic one fails
+ */
+class LegInverseKinematics
+{
+	public:
+		/** @brief Constructor function */
+		LegInverseKinematics();
+
+		/** @brief Destructor function */
+		virtual ~LegInverseKinematics();
+
+		/**
+		 * @brief Creates an analytic leg IK from its type name, i.e. the name used in the
+		 * system file (YARF)
+		 * @param const std::string& Type name of the leg IK
+		 * @return std::shared_ptr<LegInverseKinematics> Leg IK, or null if the type isn't
+		 * defined
+		 */
+		static std::shared_ptr<LegInverseKinematics> create(const std::string& type);
+
+		/**
+		 * @brief Resets the leg geometry from the kinematic model at the zero joint position
+		 * @param const Eigen::MatrixXd& Branch Jacobian (angular and linear rows) of the foot
+		 * w.r.t. the base
+		 * @param const Eigen::Vector3d& Foot position w.r.t. the base
+		 * @param const Eigen::VectorXd& Lower joint limits of the branch
+		 * @param const Eigen::VectorXd& Upper joint limits of the branch
+		 * @return bool True if the leg structure is supported by the solver
+		 */
+		virtual bool reset(const Eigen::MatrixXd& branch_jac,
+						   const Eigen::Vector3d& foot_pos,
+						   const Eigen::VectorXd& lower_limit,
+						   const Eigen::VectorXd& upper_limit) = 0;
+
+		/**
+		 * @brief Computes the branch joint position of a desired foot position. Among the
+		 * analytic solutions, it's chosen the closest one to the initial joint position
+		 * @param Eigen::VectorXd& Branch joint position
+		 * @param const Eigen::Vector3d& Foot position w.r.t. the base
+		 * @param const Eigen::VectorXd& Initial branch joint position
+		 * @return bool True if the foot position is reachable within the joint limits
+		 */
+		virtual bool compute(Eigen::VectorXd& branch_pos,
+							 const Eigen::Vector3d& foot_pos,
+							 const Eigen::VectorXd& branch_pos_init) = 0;
+};
+
+
+/**
+ * @class HAAHFEKFELegInverseKinematics
+ * @brief Analytic IK of a leg with hip abduction/adduction (HAA), hip flexion/extension (HFE)
+ * and knee flexion/extension (KFE) joints, e.g. the HyQ legs. The HFE and KFE axes are
+ * parallel, and perpendicular to the HAA axis. So, the HAA angle aligns the sagittal plane of
+ * the leg with the foot, and the HFE and KFE angles are solved as a planar 2R chain
+ */
+class HAAHFEKFELegInverseKinematics : public LegInverseKinematics
+{
+	public:
+		/** @brief Constructor function */
+		HAAHFEKFELegInverseKinematics();
+
+		/** @brief Destructor function */
+		~HAAHFEKFELegInverseKinematics();
+
+		/**
+		 * @brief Resets the leg geometry, i.e. axes and link vectors, from the kinematic model
+		 * at the zero joint position
+		 * @param const Eigen::MatrixXd& Branch Jacobian (angular and linear rows) of the foot
+		 * w.r.t. the base
+		 * @param const Eigen::Vector3d& Foot position w.r.t. the base
+		 * @param const Eigen::VectorXd& Lower joint limits of the branch
+		 * @param const Eigen::VectorXd& Upper joint limits of the branch
+		 * @return bool True if it's a HAA-HFE-KFE leg
+		 */
+		bool reset(const Eigen::MatrixXd& branch_jac,
+				   const Eigen::Vector3d& foot_pos,
+				   const Eigen::VectorXd& lower_limit,
+				   const Eigen::VectorXd& upper_limit);
+
+		/**
+		 * @brief Computes the HAA, HFE and KFE positions of a desired foot position
+		 * @param Eigen::VectorXd& Branch joint position
+		 * @param const Eigen::Vector3d& Foot position w.r.t. the base
+		 * @param const Eigen::VectorXd& Initial branch joint position
+		 * @return bool True if the foot position is reachable within the joint limits
+		 */
+		bool compute(Eigen::VectorXd& branch_pos,
+					 const Eigen::Vector3d& foot_pos,
+					 const Eigen::VectorXd& branch_pos_init);
+
+
+	private:
+		/**
+		 * @brief Chooses the angle, between two solutions, that is closest to a reference
+		 * angle, and expresses it w.r.t. the reference (i.e. without 2*pi jumps)
+		 * @param double First solution
+		 * @param double Second solution
+		 * @param double Reference angle
+		 * @return double Closest solution
+		 */
+		double closestAngle(double angle1,
+							double angle2,
+							double reference) const;
+
+		/** @brief HAA axis and a point on it */
+		Eigen::Vector3d haa_axis_;
+		Eigen::Vector3d haa_point_;
+
+		/** @brief HFE axis and a point on it */
+		Eigen::Vector3d hfe_axis_;
+		Eigen::Vector3d hfe_point_;
+
+		/** @brief Orthonormal basis of the plane perpendicular to the HAA axis */
+		Eigen::Vector3d haa_u_;
+		Eigen::Vector3d haa_w_;
+
+		/** @brief Orthonormal basis of the sagittal plane, i.e. perpendicular to the HFE axis */
+		Eigen::Vector3d sagittal_e1_;
+		Eigen::Vector3d sagittal_e2_;
+
+		/** @brief Offset of the sagittal plane w.r.t. the HAA axis */
+		double sagittal_offset_;
+
+		/** @brief Thigh (HFE to KFE) and shin (KFE to foot) vectors in the sagittal plane */
+		Eigen::Vector2d thigh_;
+		Eigen::Vector2d shin_;
+
+		/** @brief Rotation sense of the KFE w.r.t. the HFE axis (1 or -1) */
+		double kfe_sense_;
+
+		/** @brief Joint limits of the branch */
+		Eigen::VectorXd lower_limit_;
+		Eigen::VectorXd upper_limit_;
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
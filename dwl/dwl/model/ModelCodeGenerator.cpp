@@ -0,0 +1,532 @@
+#include <dwl/model/ModelCodeGenerator.h>
+#include <fstream>
+#include <cstdio>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+ModelCodeGenerator::ModelCodeGenerator()
+{
+
+}
+
+
+ModelCodeGenerator::~ModelCodeGenerator()
+{
+
+}
+
+
+bool ModelCodeGenerator::generate(std::string& code,
+								  const FloatingBaseSystem& system,
+								  const std::string& name)
+{
+	return generate(code, system.getRBDModel(), name);
+}
+
+
+bool ModelCodeGenerator::generate(std::string& code,
+								  const RigidBodyDynamics::Model& model,
+								  const std::string& name)
+{
+	// Checking that all the joints have a single DoF, i.e. revolute or prismatic
+	unsigned int num_bodies = model.mBodies.size();
+	for (unsigned int i = 1; i < num_bodies; i++) {
+		bool revolute = !model.S[i].head<3>().isZero(0.);
+		bool prismatic = !model.S[i].tail<3>().isZero(0.);
+		if (model.mJoints[i].mDoFCount != 1 || revolute == prismatic) {
+			printf(YELLOW "Warning: the code of the model %s couldn't be generated because the"
+				   " joint of the body %s isn't revolute or prismatic\n" COLOR_RESET,
+				   name.c_str(), model.GetBodyName(i).c_str());
+			return false;
+		}
+	}
+
+	std::stringstream out;
+	out << "// Kinematics and dynamics of the model " << name << ", which are generated by\n"
+		<< "// dwl::model::ModelCodeGenerator. Don't edit this file, but generate it again\n"
+		<< "// when the model changes. The model is added to the GeneratedModelRegistry by\n"
+		<< "// loading this file as plugin, or by adding the model returned by\n"
+		<< "// " << GeneratedModelRegistry::getSymbolName(name) << "()\n"
+		<< "#include <dwl/model/GeneratedModel.h>\n"
+		<< "#include <cmath>\n\n\n"
+		<< "namespace dwl\n{\n\nnamespace model\n{\n\n"
+		<< "namespace generated_" << name << "\n{\n\n"
+		<< "typedef Eigen::Vector3d Vector3d;\n"
+		<< "typedef Eigen::Matrix3d Matrix3d;\n"
+		<< "typedef Eigen::Matrix<double,6,1> Vector6d;\n"
+		<< "typedef Eigen::Matrix<double,6,6> Matrix6d;\n\n"
+		<< "static const unsigned int NUM_BODIES = " << num_bodies << ";\n"
+		<< "static const unsigned int DOF_COUNT = " << model.dof_count << ";\n\n\n";
+
+	// Spatial algebra of the generated code, which follows the conventions of RBDL
+	out << "static inline void applyMotion(Vector3d& w_out, Vector3d& v_out,\n"
+		<< "\t\t\t\t\t\t\t   const Matrix3d& E, const Vector3d& r,\n"
+		<< "\t\t\t\t\t\t\t   const Vector3d& w, const Vector3d& v)\n{\n"
+		<< "\tw_out.noalias() = E * w;\n"
+		<< "\tv_out.noalias() = E * (v - r.cross(w));\n}\n\n\n"
+		<< "static inline void addForce(Vector3d& n_out, Vector3d& f_out,\n"
+		<< "\t\t\t\t\t\t\tconst Matrix3d& E, const Vector3d& r,\n"
+		<< "\t\t\t\t\t\t\tconst Vector3d& n, const Vector3d& f)\n{\n"
+		<< "\tVector3d f_parent = E.transpose() * f;\n"
+		<< "\tn_out += E.transpose() * n + r.cross(f_parent);\n"
+		<< "\tf_out += f_parent;\n}\n\n\n"
+		<< "static inline void subtractExternalForce(Vector3d& n, Vector3d& f,\n"
+		<< "\t\t\t\t\t\t\t\t\t\t const Matrix3d& E_base, const Vector3d& r_base,\n"
+		<< "\t\t\t\t\t\t\t\t\t\t const RigidBodyDynamics::Math::SpatialVector& f_ext)\n{\n"
+		<< "\tVector3d n_ext = f_ext.head<3>(), f_ext_lin = f_ext.tail<3>();\n"
+		<< "\tn -= E_base * (n_ext - r_base.cross(f_ext_lin));\n"
+		<< "\tf -= E_base * f_ext_lin;\n}\n\n\n"
+		<< "static inline void transposeForce(Vector6d& F,\n"
+		<< "\t\t\t\t\t\t\t\t  const Matrix3d& E, const Vector3d& r)\n{\n"
+		<< "\tVector3d f_parent = E.transpose() * F.tail<3>();\n"
+		<< "\tF.head<3>() = E.transpose() * F.head<3>() + r.cross(f_parent);\n"
+		<< "\tF.tail<3>() = f_parent;\n}\n\n\n"
+		<< "static inline void addInertia(Matrix6d& Ic_parent,\n"
+		<< "\t\t\t\t\t\t\t  const Matrix3d& E, const Vector3d& r,\n"
+		<< "\t\t\t\t\t\t\t  const Matrix6d& Ic)\n{\n"
+		<< "\tMatrix3d rx;\n"
+		<< "\trx << 0., -r(2), r(1), r(2), 0., -r(0), -r(1), r(0), 0.;\n"
+		<< "\tMatrix6d X;\n"
+		<< "\tX.topLeftCorner<3,3>() = E;\n"
+		<< "\tX.topRightCorner<3,3>().setZero();\n"
+		<< "\tX.bottomLeftCorner<3,3>() = -E * rx;\n"
+		<< "\tX.bottomRightCorner<3,3>() = E;\n"
+		<< "\tIc_parent.noalias() += X.transpose() * Ic * X;\n}\n\n\n";
+
+	generateTransforms(out, model);
+	generateInverseDynamics(out, model);
+	generateJointSpaceInertiaMatrix(out, model);
+
+	// Description of the generated model and its loading function
+	out << "static const GeneratedModel model = {\"" << name << "\", "
+		<< GeneratedModelRegistry::computeHash(model) << "ULL, NUM_BODIES, DOF_COUNT,\n"
+		<< "\t\t&updatePositions, &computeInverseDynamics, &computeJointSpaceInertiaMatrix};\n\n"
+		<< "} //@namespace generated_" << name << "\n"
+		<< "} //@namespace model\n"
+		<< "} //@namespace dwl\n\n\n"
+		<< "extern \"C\" const dwl::model::GeneratedModel* "
+		<< GeneratedModelRegistry::getSymbolName(name) << "()\n{\n"
+		<< "\treturn &dwl::model::generated_" << name << "::model;\n}\n";
+
+	code = out.str();
+	return true;
+}
+
+
+bool ModelCodeGenerator::generateFile(const std::string& filename,
+									  const FloatingBaseSystem& system,
+									  const std::string& name)
+{
+	std::string code;
+	if (!generate(code, system, name))
+		return false;
+
+	std::ofstream file(filename.c_str());
+	if (!file.is_open()) {
+		printf(YELLOW "Warning: the file %s couldn't be opened\n" COLOR_RESET,
+			   filename.c_str());
+		return false;
+	}
+	file << code;
+
+	return true;
+}
+
+
+std::string ModelCodeGenerator::toLiteral(double value) const
+{
+	char literal[32];
+	snprintf(literal, sizeof(literal), "%.17g", value);
+
+	// Keeping the literals as doubles
+	std::string str(literal);
+	if (str.find_first_of(".e") == std::string::npos)
+		str += ".";
+
+	return str;
+}
+
+
+std::string ModelCodeGenerator::combine(const std::vector<Term>& terms) const
+{
+	std::string expression;
+	for (unsigned int t = 0; t < terms.size(); t++) {
+		double coeff = terms[t].first;
+		const std::string& variable = terms[t].second;
+		if (coeff == 0.)
+			continue;
+
+		// Adding the sign, where the first term doesn't have a positive one
+		if (expression.empty()) {
+			if (coeff < 0.)
+				expression += "-";
+		} else
+			expression += (coeff < 0.) ? " - " : " + ";
+
+		// Adding the term, where an empty variable is a constant
+		double abs_coeff = fabs(coeff);
+		if (variable.empty())
+			expression += toLiteral(abs_coeff);
+		else if (abs_coeff == 1.)
+			expression += variable;
+		else
+			expression += toLiteral(abs_coeff) + " * " + variable;
+	}
+
+	if (expression.empty())
+		return "0.";
+
+	return expression;
+}
+
+
+std::string ModelCodeGenerator::scaleVector(const Eigen::Vector3d& vector,
+											const std::string& variable) const
+{
+	return "Vector3d(" +
+			combine(std::vector<Term>(1, Term(vector(0), variable))) + ", " +
+			combine(std::vector<Term>(1, Term(vector(1), variable))) + ", " +
+			combine(std::vector<Term>(1, Term(vector(2), variable))) + ")";
+}
+
+
+std::string ModelCodeGenerator::dot(const Eigen::Vector3d& vector,
+									const std::string& variable) const
+{
+	std::vector<Term> terms;
+	for (unsigned int k = 0; k < 3; k++) {
+		std::stringstream component;
+		component << variable << "(" << k << ")";
+		terms.push_back(Term(vector(k), component.str()));
+	}
+
+	return combine(terms);
+}
+
+
+void ModelCodeGenerator::generateTransforms(std::stringstream& code,
+											const RigidBodyDynamics::Model& model) const
+{
+	code << "static inline void computeTransforms(Matrix3d* E, Vector3d* r,\n"
+		 << "\t\t\t\t\t\t\t\t\t Matrix3d* E_base, Vector3d* r_base,\n"
+		 << "\t\t\t\t\t\t\t\t\t const double* q)\n{\n";
+
+	for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+		unsigned int lambda = model.lambda[i];
+		unsigned int q_index = model.mJoints[i].q_index;
+		const Eigen::Matrix3d& E_T = model.X_T[i].E;
+		const Eigen::Vector3d& r_T = model.X_T[i].r;
+		std::stringstream q_var;
+		q_var << "q[" << q_index << "]";
+
+		code << "\t// " << model.GetBodyName(i) << "\n\t{\n";
+		Eigen::Vector3d axis = model.S[i].head<3>();
+		if (!axis.isZero(0.)) {
+			// Folding the joint placement in the rotation of the revolute joint, i.e.
+			// E = (K0 + Kc cos(q) + Ks sin(q)) E_T, as the rotation of RBDL (Xrot). Note
+			// that the translation of the joint placement doesn't change
+			Eigen::Matrix3d K0 = axis * axis.transpose();
+			Eigen::Matrix3d Kc = Eigen::Matrix3d::Identity() - K0;
+			Eigen::Matrix3d Ks;
+			Ks << 0., axis(2), -axis(1),
+				  -axis(2), 0., axis(0),
+				  axis(1), -axis(0), 0.;
+			K0 = K0 * E_T;
+			Kc = Kc * E_T;
+			Ks = Ks * E_T;
+
+			code << "\t\tconst double s = std::sin(" << q_var.str() << ");\n"
+				 << "\t\tconst double c = std::cos(" << q_var.str() << ");\n"
+				 << "\t\tE[" << i << "] <<";
+			for (unsigned int row = 0; row < 3; row++) {
+				for (unsigned int col = 0; col < 3; col++) {
+					std::vector<Term> terms;
+					terms.push_back(Term(K0(row, col), ""));
+					terms.push_back(Term(Kc(row, col), "c"));
+					terms.push_back(Term(Ks(row, col), "s"));
+					code << ((col != 0) ? ", " : ((row == 0) ? " " : ",\n\t\t\t\t"))
+						 << combine(terms);
+				}
+			}
+			code << ";\n\t\tr[" << i << "] << " << toLiteral(r_T(0)) << ", "
+				 << toLiteral(r_T(1)) << ", " << toLiteral(r_T(2)) << ";\n";
+		} else {
+			// The rotation of the prismatic joint is the one of the joint placement, and its
+			// translation is r_T + E_T^T axis q
+			Eigen::Vector3d axis_T = E_T.transpose() * (Eigen::Vector3d) model.S[i].tail<3>();
+			code << "\t\tE[" << i << "] <<";
+			for (unsigned int k = 0; k < 9; k++)
+				code << ((k == 0) ? " " : ", ") << toLiteral(E_T(k / 3, k % 3));
+			code << ";\n\t\tr[" << i << "] <<";
+			for (unsigned int k = 0; k < 3; k++) {
+				std::vector<Term> terms;
+				terms.push_back(Term(r_T(k), ""));
+				terms.push_back(Term(axis_T(k), q_var.str()));
+				code << ((k == 0) ? " " : ", ") << combine(terms);
+			}
+			code << ";\n";
+		}
+
+		// Composing the transform of the parent
+		if (lambda == 0) {
+			code << "\t\tE_base[" << i << "] = E[" << i << "];\n"
+				 << "\t\tr_base[" << i << "] = r[" << i << "];\n";
+		} else if (axis.isZero(0.) && E_T.isIdentity(0.)) {
+			// The rotation of a prismatic joint without rotated placement is the identity
+			code << "\t\tE_base[" << i << "] = E_base[" << lambda << "];\n"
+				 << "\t\tr_base[" << i << "] = r_base[" << lambda << "] + E_base["
+				 << lambda << "].transpose() * r[" << i << "];\n";
+		} else {
+			code << "\t\tE_base[" << i << "].noalias() = E[" << i << "] * E_base["
+				 << lambda << "];\n"
+				 << "\t\tr_base[" << i << "] = r_base[" << lambda << "] + E_base["
+				 << lambda << "].transpose() * r[" << i << "];\n";
+		}
+		code << "\t}\n";
+	}
+	code << "}\n\n\n";
+
+	code << "void updatePositions(RigidBodyDynamics::Model& model,\n"
+		 << "\t\t\t\t\t const double* q)\n{\n"
+		 << "\tMatrix3d E[NUM_BODIES], E_base[NUM_BODIES];\n"
+		 << "\tVector3d r[NUM_BODIES], r_base[NUM_BODIES];\n"
+		 << "\tcomputeTransforms(E, r, E_base, r_base, q);\n"
+		 << "\tfor (unsigned int i = 1; i < NUM_BODIES; i++) {\n"
+		 << "\t\tmodel.X_lambda[i].E = E[i];\n"
+		 << "\t\tmodel.X_lambda[i].r = r[i];\n"
+		 << "\t\tmodel.X_base[i].E = E_base[i];\n"
+		 << "\t\tmodel.X_base[i].r = r_base[i];\n"
+		 << "\t}\n}\n\n\n";
+}
+
+
+void ModelCodeGenerator::generateInverseDynamics(std::stringstream& code,
+												 const RigidBodyDynamics::Model& model) const
+{
+	code << "void computeInverseDynamics(double* tau,\n"
+		 << "\t\t\t\t\t\t\tconst double* q,\n"
+		 << "\t\t\t\t\t\t\tconst double* qd,\n"
+		 << "\t\t\t\t\t\t\tconst double* qdd,\n"
+		 << "\t\t\t\t\t\t\tconst double* gravity,\n"
+		 << "\t\t\t\t\t\t\tconst RigidBodyDynamics::Math::SpatialVector* f_ext)\n{\n"
+		 << "\tMatrix3d E[NUM_BODIES], E_base[NUM_BODIES];\n"
+		 << "\tVector3d r[NUM_BODIES], r_base[NUM_BODIES];\n"
+		 << "\tcomputeTransforms(E, r, E_base, r_base, q);\n\n"
+		 << "\t// Forward pass: velocity, acceleration and forces of the bodies\n"
+		 << "\tVector3d w[NUM_BODIES], v[NUM_BODIES], aw[NUM_BODIES], al[NUM_BODIES];\n"
+		 << "\tVector3d n[NUM_BODIES], f[NUM_BODIES];\n"
+		 << "\tw[0].setZero();\n"
+		 << "\tv[0].setZero();\n"
+		 << "\taw[0].setZero();\n"
+		 << "\tal[0] = -Vector3d(gravity[0], gravity[1], gravity[2]);\n";
+
+	unsigned int num_bodies = model.mBodies.size();
+	for (unsigned int i = 1; i < num_bodies; i++) {
+		unsigned int lambda = model.lambda[i];
+		unsigned int q_index = model.mJoints[i].q_index;
+		Eigen::Vector3d axis = model.S[i].head<3>();
+		bool revolute = !axis.isZero(0.);
+		if (!revolute)
+			axis = model.S[i].tail<3>();
+
+		std::stringstream id, qd_var, qdd_var;
+		id << i;
+		qd_var << "qd[" << q_index << "]";
+		qdd_var << "qdd[" << q_index << "]";
+		std::string w = "w[" + id.str() + "]", v = "v[" + id.str() + "]";
+		std::string aw = "aw[" + id.str() + "]", al = "al[" + id.str() + "]";
+		std::string n = "n[" + id.str() + "]", f = "f[" + id.str() + "]";
+
+		code << "\t// " << model.GetBodyName(i) << "\n\t{\n"
+			 << "\t\tapplyMotion(" << w << ", " << v << ", E[" << i << "], r[" << i
+			 << "], w[" << lambda << "], v[" << lambda << "]);\n"
+			 << "\t\tapplyMotion(" << aw << ", " << al << ", E[" << i << "], r[" << i
+			 << "], aw[" << lambda << "], al[" << lambda << "]);\n"
+			 << "\t\tconst Vector3d s_qd = " << scaleVector(axis, qd_var.str()) << ";\n";
+		if (revolute) {
+			code << "\t\t" << w << " += s_qd;\n"
+				 << "\t\t" << aw << " += " << w << ".cross(s_qd) + "
+				 << scaleVector(axis, qdd_var.str()) << ";\n"
+				 << "\t\t" << al << " += " << v << ".cross(s_qd);\n";
+		} else {
+			code << "\t\t" << v << " += s_qd;\n"
+				 << "\t\t" << al << " += " << w << ".cross(s_qd) + "
+				 << scaleVector(axis, qdd_var.str()) << ";\n";
+		}
+
+		// Computing the forces of the body motion, i.e. f = I a + v x* I v, where the
+		// inertia is folded. Note that RBDL doesn't compute these forces for virtual bodies
+		if (model.mBodies[i].mIsVirtual) {
+			code << "\t\t" << n << ".setZero();\n"
+				 << "\t\t" << f << ".setZero();\n";
+		} else {
+			const RigidBodyDynamics::Math::SpatialRigidBodyInertia& inertia = model.I[i];
+			Eigen::Matrix3d I_bar;
+			I_bar << inertia.Ixx, inertia.Iyx, inertia.Izx,
+					 inertia.Iyx, inertia.Iyy, inertia.Izy,
+					 inertia.Izx, inertia.Izy, inertia.Izz;
+			const Eigen::Vector3d& h = inertia.h;
+			std::string vars[2][2] = {{aw, al}, {w, v}};
+			std::string outs[2][2] = {{n, f}, {"h_n", "h_f"}};
+			for (unsigned int p = 0; p < 2; p++) {
+				const std::string& ang = vars[p][0];
+				const std::string& lin = vars[p][1];
+				std::string comp_n[3], comp_f[3];
+				for (unsigned int k = 0; k < 3; k++) {
+					// Angular part: I_bar ang + h x lin
+					unsigned int k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+					std::stringstream ang_k[3], lin_k[3];
+					for (unsigned int j = 0; j < 3; j++) {
+						ang_k[j] << ang << "(" << j << ")";
+						lin_k[j] << lin << "(" << j << ")";
+					}
+					std::vector<Term> terms_n, terms_f;
+					for (unsigned int j = 0; j < 3; j++)
+						terms_n.push_back(Term(I_bar(k, j), ang_k[j].str()));
+					terms_n.push_back(Term(h(k1), lin_k[k2].str()));
+					terms_n.push_back(Term(-h(k2), lin_k[k1].str()));
+					comp_n[k] = combine(terms_n);
+
+					// Linear part: m lin - h x ang
+					terms_f.push_back(Term(inertia.m, lin_k[k].str()));
+					terms_f.push_back(Term(-h(k1), ang_k[k2].str()));
+					terms_f.push_back(Term(h(k2), ang_k[k1].str()));
+					comp_f[k] = combine(terms_f);
+				}
+
+				std::string prefix = (p == 0) ? "\t\t" : "\t\tconst Vector3d ";
+				code << prefix << outs[p][0] << " = Vector3d(" << comp_n[0] << ",\n\t\t\t\t"
+					 << comp_n[1] << ",\n\t\t\t\t" << comp_n[2] << ");\n"
+					 << prefix << outs[p][1] << " = Vector3d(" << comp_f[0] << ",\n\t\t\t\t"
+					 << comp_f[1] << ",\n\t\t\t\t" << comp_f[2] << ");\n";
+			}
+			code << "\t\t" << n << " += " << w << ".cross(h_n) + " << v << ".cross(h_f);\n"
+				 << "\t\t" << f << " += " << w << ".cross(h_f);\n";
+		}
+		code << "\t\tif (f_ext != NULL)\n"
+			 << "\t\t\tsubtractExternalForce(" << n << ", " << f << ", E_base[" << i
+			 << "], r_base[" << i << "], f_ext[" << i << "]);\n"
+			 << "\t}\n";
+	}
+
+	// Backward pass: joint forces, and propagation of the forces to the parents
+	code << "\n\t// Backward pass: joint forces of the bodies\n";
+	for (unsigned int i = num_bodies - 1; i > 0; i--) {
+		unsigned int lambda = model.lambda[i];
+		Eigen::Vector3d axis = model.S[i].head<3>();
+		std::stringstream force;
+		if (!axis.isZero(0.))
+			force << "n[" << i << "]";
+		else {
+			axis = model.S[i].tail<3>();
+			force << "f[" << i << "]";
+		}
+
+		code << "\ttau[" << model.mJoints[i].q_index << "] = "
+			 << dot(axis, force.str()) << ";\n";
+		if (lambda != 0) {
+			code << "\taddForce(n[" << lambda << "], f[" << lambda << "], E[" << i << "], r["
+				 << i << "], n[" << i << "], f[" << i << "]);\n";
+		}
+	}
+	code << "}\n\n\n";
+}
+
+
+void ModelCodeGenerator::generateJointSpaceInertiaMatrix(std::stringstream& code,
+														 const RigidBodyDynamics::Model& model) const
+{
+	code << "void computeJointSpaceInertiaMatrix(double* H,\n"
+		 << "\t\t\t\t\t\t\t\t\tconst double* q)\n{\n"
+		 << "\tMatrix3d E[NUM_BODIES], E_base[NUM_BODIES];\n"
+		 << "\tVector3d r[NUM_BODIES], r_base[NUM_BODIES];\n"
+		 << "\tcomputeTransforms(E, r, E_base, r_base, q);\n\n"
+		 << "\t// Composite inertias of the bodies, which are initialized with the ones of the"
+		 << " bodies\n"
+		 << "\tMatrix6d Ic[NUM_BODIES];\n";
+
+	unsigned int num_bodies = model.mBodies.size();
+	std::vector<Eigen::Matrix<double,6,1> > motion_axes(num_bodies);
+	for (unsigned int i = 1; i < num_bodies; i++) {
+		const RigidBodyDynamics::Math::SpatialRigidBodyInertia& inertia = model.I[i];
+		const Eigen::Vector3d& h = inertia.h;
+		Eigen::Matrix3d h_cross;
+		h_cross << 0., -h(2), h(1),
+				   h(2), 0., -h(0),
+				   -h(1), h(0), 0.;
+		Eigen::Matrix<double,6,6> inertia_mat;
+		inertia_mat.topLeftCorner<3,3>() << inertia.Ixx, inertia.Iyx, inertia.Izx,
+											inertia.Iyx, inertia.Iyy, inertia.Izy,
+											inertia.Izx, inertia.Izy, inertia.Izz;
+		inertia_mat.topRightCorner<3,3>() = h_cross;
+		inertia_mat.bottomLeftCorner<3,3>() = -h_cross;
+		inertia_mat.bottomRightCorner<3,3>() = inertia.m * Eigen::Matrix3d::Identity();
+
+		code << "\tIc[" << i << "] <<";
+		for (unsigned int k = 0; k < 36; k++)
+			code << ((k == 0) ? " " : ((k % 6 == 0) ? ",\n\t\t\t " : ", "))
+				 << toLiteral(inertia_mat(k / 6, k % 6));
+		code << ";\n";
+
+		for (unsigned int k = 0; k < 6; k++)
+			motion_axes[i](k) = model.S[i](k);
+	}
+
+	for (unsigned int i = num_bodies - 1; i > 0; i--) {
+		unsigned int lambda = model.lambda[i];
+		if (lambda != 0)
+			code << "\taddInertia(Ic[" << lambda << "], E[" << i << "], r[" << i << "], Ic["
+				 << i << "]);\n";
+	}
+	code << "\n\t// Columns of the joint-space inertia matrix, i.e. the composite forces along the"
+		 << " ancestors\n"
+		 << "\tfor (unsigned int k = 0; k < DOF_COUNT * DOF_COUNT; k++)\n"
+		 << "\t\tH[k] = 0.;\n"
+		 << "\tVector6d F;\n";
+
+	for (unsigned int i = num_bodies - 1; i > 0; i--) {
+		unsigned int q_index = model.mJoints[i].q_index;
+		std::vector<Term> terms;
+		for (unsigned int k = 0; k < 6; k++) {
+			std::stringstream column;
+			column << "Ic[" << i << "].col(" << k << ")";
+			terms.push_back(Term(motion_axes[i](k), column.str()));
+		}
+		code << "\tF = " << combine(terms) << ";\n";
+
+		unsigned int j = i;
+		bool first = true;
+		while (true) {
+			unsigned int q_j = model.mJoints[j].q_index;
+			std::vector<Term> dot_terms;
+			for (unsigned int k = 0; k < 6; k++) {
+				std::stringstream component;
+				component << "F(" << k << ")";
+				dot_terms.push_back(Term(motion_axes[j](k), component.str()));
+			}
+			if (first) {
+				code << "\tH[" << q_index + q_index * model.dof_count << "] = "
+					 << combine(dot_terms) << ";\n";
+				first = false;
+			} else {
+				code << "\tH[" << q_index + q_j * model.dof_count << "] = H["
+					 << q_j + q_index * model.dof_count << "] = " << combine(dot_terms)
+					 << ";\n";
+			}
+
+			if (model.lambda[j] == 0)
+				break;
+			code << "\ttransposeForce(F, E[" << j << "], r[" << j << "]);\n";
+			j = model.lambda[j];
+		}
+	}
+	code << "}\n\n\n";
+}
+
+} //@namespace model
+} //@namespace dwl
@@ -0,0 +1,122 @@
+#ifndef DWL__MODEL__MODEL_CODE_GENERATOR__H
+#define DWL__MODEL__MODEL_CODE_GENERATOR__H
+
+#include <dwl/model/FloatingBaseSystem.h>
+#include <dwl/model/GeneratedModel.h>
+#include <sstream>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class ModelCodeGenerator
+ * @brief Generates the specialized C++ code of the kinematics and dynamics of a robot (see
+ * GeneratedModel), i.e. the transforms of the bodies, the RNEA and the CRBA. The tree of its
+ * RBDL model is unrolled, and the joint axes, joint placements and inertias are folded as
+ * constants, where the zero terms are removed. The generated code is compiled in the
+ * application or in a plugin, and it's used by the systems whose RBDL model has the same hash.
+ * Note that only the single-DoF (revolute and prismatic) joints are supported, which includes
+ * the floating-base joints of the URDF models
+ */
+class ModelCodeGenerator
+{
+	public:
+		/** @brief Constructor function */
+		ModelCodeGenerator();
+
+		/** @brief Destructor function */
+		~ModelCodeGenerator();
+
+		/**
+		 * @brief Generates the code of the RBDL model of a system
+		 * @param std::string& Generated code
+		 * @param const FloatingBaseSystem& Floating-base system
+		 * @param const std::string& Name of the generated model, which has to be a valid
+		 * C++ identifier
+		 * @return bool False if the model has unsupported joints
+		 */
+		bool generate(std::string& code,
+					  const FloatingBaseSystem& system,
+					  const std::string& name);
+
+		/**
+		 * @brief Generates the code of a RBDL model
+		 * @param std::string& Generated code
+		 * @param const RigidBodyDynamics::Model& RBDL model
+		 * @param const std::string& Name of the generated model
+		 * @return bool False if the model has unsupported joints
+		 */
+		bool generate(std::string& code,
+					  const RigidBodyDynamics::Model& model,
+					  const std::string& name);
+
+		/**
+		 * @brief Generates the code of the RBDL model of a system in a file
+		 * @param const std::string& Filename of the generated code
+		 * @param const FloatingBaseSystem& Floating-base system
+		 * @param const std::string& Name of the generated model
+		 * @return bool False if the model has unsupported joints or the file couldn't be
+		 * written
+		 */
+		bool generateFile(const std::string& filename,
+						  const FloatingBaseSystem& system,
+						  const std::string& name);
+
+
+	private:
+		/** @brief Term of a linear combination, i.e. coefficient and variable */
+		typedef std::pair<double, std::string> Term;
+
+		/**
+		 * @brief Gets the literal of a constant
+		 * @param double Constant
+		 * @return The literal, which keeps all the digits
+		 */
+		std::string toLiteral(double value) const;
+
+		/**
+		 * @brief Gets the expression of a linear combination, where the zero terms are removed
+		 * @param const std::vector<Term>& Terms of the combination
+		 * @return The expression, which is "0." if all the terms are zero
+		 */
+		std::string combine(const std::vector<Term>& terms) const;
+
+		/**
+		 * @brief Gets the expression of a vector (three components) scaled by a variable
+		 * @param const Eigen::Vector3d& Constant vector
+		 * @param const std::string& Variable
+		 * @return The expression of a Vector3d
+		 */
+		std::string scaleVector(const Eigen::Vector3d& vector,
+								const std::string& variable) const;
+
+		/**
+		 * @brief Gets the expression of the dot product of a constant vector and a variable one
+		 * @param const Eigen::Vector3d& Constant vector
+		 * @param const std::string& Variable vector
+		 * @return The expression of the dot product
+		 */
+		std::string dot(const Eigen::Vector3d& vector,
+						const std::string& variable) const;
+
+		/** @brief Generates the transforms of the bodies */
+		void generateTransforms(std::stringstream& code,
+								const RigidBodyDynamics::Model& model) const;
+
+		/** @brief Generates the RNEA */
+		void generateInverseDynamics(std::stringstream& code,
+									 const RigidBodyDynamics::Model& model) const;
+
+		/** @brief Generates the CRBA */
+		void generateJointSpaceInertiaMatrix(std::stringstream& code,
+											 const RigidBodyDynamics::Model& model) const;
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,128 @@
+#include <dwl/model/ModelRegistry.h>
+#include <dwl/model/FloatingBaseSystem.h>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+struct ModelRegistry::Registry
+{
+	Registry() : enabled(true) {}
+
+	/** @brief Registered system and the models used for building it */
+	struct Entry
+	{
+		std::string urdf_model;
+		std::string system_model;
+		std::shared_ptr<const FloatingBaseSystem> system;
+	};
+
+	std::mutex mutex;
+	std::map<uint64_t, Entry> entries;
+	bool enabled;
+};
+
+
+ModelRegistry::Registry& ModelRegistry::getRegistry()
+{
+	// The registry is never destroyed, so the systems can be requested during the exit of
+	// the process
+	static Registry* registry = new Registry();
+	return *registry;
+}
+
+
+std::shared_ptr<const FloatingBaseSystem>
+ModelRegistry::getFloatingBaseSystem(const std::string& urdf_model,
+									 const std::string& system_file)
+{
+	// Reading the content of the system file, so the changes of the file are detected
+	std::string system_model;
+	if (!system_file.empty()) {
+		std::ifstream system_stream(system_file.c_str());
+		std::stringstream system_buffer;
+		system_buffer << system_stream.rdbuf();
+		system_model = system_buffer.str();
+	}
+	uint64_t key = computeHash(system_model, computeHash(urdf_model));
+
+	Registry& registry = getRegistry();
+	std::unique_lock<std::mutex> lock(registry.mutex);
+	bool enabled = registry.enabled;
+	if (enabled) {
+		std::map<uint64_t, Registry::Entry>::const_iterator entry_it =
+				registry.entries.find(key);
+		if (entry_it != registry.entries.end() &&
+				entry_it->second.urdf_model == urdf_model &&
+				entry_it->second.system_model == system_model)
+			return entry_it->second.system;
+	}
+
+	// Parsing the models without locking the registry. Note that two threads could parse the
+	// same models, and the first registered system is kept
+	lock.unlock();
+	std::shared_ptr<FloatingBaseSystem> system(new FloatingBaseSystem());
+	system->parseURDFModel(urdf_model, system_file);
+	if (!enabled)
+		return system;
+
+	lock.lock();
+	std::map<uint64_t, Registry::Entry>::iterator entry_it = registry.entries.find(key);
+	if (entry_it == registry.entries.end()) {
+		Registry::Entry& entry = registry.entries[key];
+		entry.urdf_model = urdf_model;
+		entry.system_model = system_model;
+		entry.system = system;
+	} else if (entry_it->second.urdf_model == urdf_model &&
+			entry_it->second.system_model == system_model)
+		return entry_it->second.system;
+
+	// A hash collision keeps the registered system, and returns the parsed one
+	return system;
+}
+
+
+void ModelRegistry::setEnabled(bool enabled)
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.enabled = enabled;
+}
+
+
+void ModelRegistry::clear()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.entries.clear();
+}
+
+
+unsigned int ModelRegistry::getNumberOfSystems()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	return registry.entries.size();
+}
+
+
+uint64_t ModelRegistry::computeHash(const std::string& data,
+									uint64_t hash)
+{
+	for (unsigned int i = 0; i < data.size(); i++) {
+		hash ^= (unsigned char) data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+} //@namespace model
+} //@namespace dwl
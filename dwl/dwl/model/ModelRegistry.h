@@ -0,0 +1,72 @@
+#ifndef DWL__MODEL__MODEL_REGISTRY__H
+#define DWL__MODEL__MODEL_REGISTRY__H
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+class FloatingBaseSystem;
+
+/**
+ * @class ModelRegistry
+ * @brief Process-wide registry of the parsed floating-base systems, keyed by the hash of the
+ * URDF model and the content of the system (YARF) file. Parsing an URDF model, building its
+ * RBDL model and reading its system file is done once per process, and the next systems of the
+ * same robot are copied from the registered one, which is immutable. Note that every system
+ * keeps its own copy of the RBDL model since RBDL uses the model as workspace of its algorithms
+ */
+class ModelRegistry
+{
+	public:
+		/**
+		 * @brief Gets the floating-base system of an URDF model and system file, which is
+		 * parsed and registered if it wasn't requested before
+		 * @param const std::string& URDF model
+		 * @param const std::string& Filename of the system description (YARF)
+		 * @return The registered floating-base system
+		 */
+		static std::shared_ptr<const FloatingBaseSystem>
+		getFloatingBaseSystem(const std::string& urdf_model,
+							  const std::string& system_file);
+
+		/**
+		 * @brief Enables or disables the registry (enabled by default). A disabled registry
+		 * parses the models in every request
+		 * @param bool True for enabling the registry
+		 */
+		static void setEnabled(bool enabled);
+
+		/** @brief Removes the registered systems */
+		static void clear();
+
+		/** @brief Gets the number of registered systems */
+		static unsigned int getNumberOfSystems();
+
+		/**
+		 * @brief Computes the 64-bit FNV-1a hash of a string
+		 * @param const std::string& String
+		 * @param uint64_t Initial hash, for chaining strings
+		 * @return The hash of the string
+		 */
+		static uint64_t computeHash(const std::string& data,
+									uint64_t hash = 14695981039346656037ULL);
+
+
+	private:
+		struct Registry;
+
+		/** @brief Gets the registry, which is constructed in its first use */
+		static Registry& getRegistry();
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,208 @@
+#include <dwl/model/OperationalSpaceDynamics.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+OperationalSpaceDynamics::OperationalSpaceDynamics() : dynamics_(NULL)
+{
+
+}
+
+
+OperationalSpaceDynamics::~OperationalSpaceDynamics()
+{
+
+}
+
+
+void OperationalSpaceDynamics::reset(WholeBodyDynamics* dynamics)
+{
+	dynamics_ = dynamics;
+
+	// Getting the parent DoF of every DoF from the kinematic tree. Note that the DoFs of
+	// multi-DoF joints are a chain
+	const FloatingBaseSystem& system = dynamics_->getFloatingBaseSystem();
+	const RigidBodyDynamics::Model& model = system.getRBDModel();
+	unsigned int num_dof = system.getSystemDoF();
+	parent_.assign(num_dof, -1);
+	std::vector<int> last_dof(model.mBodies.size(), -1);
+	for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+		unsigned int q_index = model.mJoints[i].q_index;
+		unsigned int dof_count = model.mJoints[i].mDoFCount;
+		int parent_dof = last_dof[model.lambda[i]];
+		for (unsigned int k = 0; k < dof_count; k++) {
+			parent_[q_index + k] = parent_dof;
+			parent_dof = q_index + k;
+		}
+		last_dof[i] = parent_dof;
+	}
+
+	// The floating-base DoFs are reordered as [Angular, Linear]. They are a chain, and the
+	// ancestors of all the joints, so their order doesn't change the sparsity of the matrix
+	if (system.isFullyFloatingBase()) {
+		for (unsigned int i = 0; i < 6; i++)
+			parent_[i] = (int) i - 1;
+		for (unsigned int i = 6; i < num_dof; i++) {
+			if (parent_[i] < 6)
+				parent_[i] = 5;
+		}
+	}
+}
+
+
+bool OperationalSpaceDynamics::computeInertiaFactorization(const rbd::Vector6d& base_pos,
+														   const Eigen::VectorXd& joint_pos)
+{
+	if (dynamics_ == NULL) {
+		printf(RED "FATAL: the whole-body dynamics wasn't reset\n" COLOR_RESET);
+		return false;
+	}
+
+	inertia_factor_ = dynamics_->computeJointSpaceInertiaMatrix(base_pos, joint_pos);
+	return factorizeLTL(inertia_factor_);
+}
+
+
+void OperationalSpaceDynamics::computeOperationalSpaceDynamics(const Eigen::MatrixXd& jacobian)
+{
+	unsigned int num_dof = inertia_factor_.rows();
+	unsigned int num_tasks = jacobian.rows();
+
+	// Computing Y^T = L^{-T} J^T, so the inverse of the operational-space inertia is
+	// J H^{-1} J^T = Y Y^T
+	Eigen::MatrixXd jac_factor_t = jacobian.transpose();
+	for (unsigned int j = 0; j < num_tasks; j++)
+		solveLT(jac_factor_t.col(j));
+	jac_factor_ = jac_factor_t.transpose();
+
+	Eigen::MatrixXd task_inertia_inv = jac_factor_ * jac_factor_t;
+	Eigen::LLT<Eigen::MatrixXd> task_llt(task_inertia_inv);
+	if (task_llt.info() == Eigen::Success)
+		task_inertia_ = task_llt.solve(Eigen::MatrixXd::Identity(num_tasks, num_tasks));
+	else // singular task, e.g. redundant contacts
+		task_inertia_ = math::pseudoInverse(task_inertia_inv);
+
+	// Computing the dynamically consistent inverse, i.e. Jbar = L^{-1} Y^T Lambda
+	for (unsigned int j = 0; j < num_tasks; j++)
+		solveL(jac_factor_t.col(j));
+	consistent_inv_ = jac_factor_t * task_inertia_;
+
+	// Computing the null-space projector
+	null_projector_ = Eigen::MatrixXd::Identity(num_dof, num_dof) - consistent_inv_ * jacobian;
+}
+
+
+bool OperationalSpaceDynamics::computeOperationalSpaceDynamics(const rbd::Vector6d& base_pos,
+															   const Eigen::VectorXd& joint_pos,
+															   const rbd::BodySelector& contacts)
+{
+	if (!computeInertiaFactorization(base_pos, joint_pos))
+		return false;
+
+	dynamics_->getWholeBodyKinematics().computeContactJacobian(contact_jac_,
+															   base_pos, joint_pos,
+															   contacts);
+	computeOperationalSpaceDynamics(contact_jac_);
+
+	return true;
+}
+
+
+void OperationalSpaceDynamics::solveInertia(Eigen::MatrixXd& x) const
+{
+	for (unsigned int j = 0; j < x.cols(); j++) {
+		solveLT(x.col(j));
+		solveL(x.col(j));
+	}
+}
+
+
+void OperationalSpaceDynamics::solveInertia(Eigen::VectorXd& x) const
+{
+	solveLT(x);
+	solveL(x);
+}
+
+
+const Eigen::MatrixXd& OperationalSpaceDynamics::getInertiaFactor() const
+{
+	return inertia_factor_;
+}
+
+
+const Eigen::MatrixXd& OperationalSpaceDynamics::getOperationalSpaceInertia() const
+{
+	return task_inertia_;
+}
+
+
+const Eigen::MatrixXd& OperationalSpaceDynamics::getDynamicallyConsistentInverse() const
+{
+	return consistent_inv_;
+}
+
+
+const Eigen::MatrixXd& OperationalSpaceDynamics::getNullSpaceProjector() const
+{
+	return null_projector_;
+}
+
+
+const std::vector<int>& OperationalSpaceDynamics::getParentDoF() const
+{
+	return parent_;
+}
+
+
+bool OperationalSpaceDynamics::factorizeLTL(Eigen::MatrixXd& inertia) const
+{
+	// Factorizing from the leaves to the root. Note that column k only has non-zero entries
+	// in the ancestors of k, so there isn't fill-in
+	for (int k = inertia.rows() - 1; k >= 0; k--) {
+		if (inertia(k,k) <= 0.)
+			return false;
+		inertia(k,k) = sqrt(inertia(k,k));
+
+		for (int i = parent_[k]; i != -1; i = parent_[i])
+			inertia(k,i) /= inertia(k,k);
+
+		for (int i = parent_[k]; i != -1; i = parent_[i]) {
+			for (int j = i; j != -1; j = parent_[j])
+				inertia(i,j) -= inertia(k,i) * inertia(k,j);
+		}
+	}
+
+	// Cleaning the upper triangle, which isn't part of the factor
+	inertia.triangularView<Eigen::StrictlyUpper>().setZero();
+	return true;
+}
+
+
+void OperationalSpaceDynamics::solveLT(Eigen::Ref<Eigen::VectorXd> x) const
+{
+	for (int i = x.size() - 1; i >= 0; i--) {
+		x(i) /= inertia_factor_(i,i);
+		if (x(i) == 0.)
+			continue;
+
+		for (int j = parent_[i]; j != -1; j = parent_[j])
+			x(j) -= inertia_factor_(i,j) * x(i);
+	}
+}
+
+
+void OperationalSpaceDynamics::solveL(Eigen::Ref<Eigen::VectorXd> x) const
+{
+	for (int i = 0; i < x.size(); i++) {
+		for (int j = parent_[i]; j != -1; j = parent_[j])
+			x(i) -= inertia_factor_(i,j) * x(j);
+		x(i) /= inertia_factor_(i,i);
+	}
+}
+
+} //@namespace model
+} //@namespace dwl
@@ -0,0 +1,146 @@
+#ifndef DWL__MODEL__OPERATIONAL_SPACE_DYNAMICS__H
+#define DWL__MODEL__OPERATIONAL_SPACE_DYNAMICS__H
+
+#include <dwl/model/WholeBodyDynamics.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class OperationalSpaceDynamics
+ * @brief Computes the operational-space inertia matrix and the dynamically consistent
+ * null-space projector of a set of tasks (e.g. contacts) of a floating-base system. The
+ * joint-space inertia matrix is computed with the Composite Rigid Body Algorithm (see
+ * WholeBodyDynamics::computeJointSpaceInertiaMatrix) and factorized as H = L^T L, where L has
+ * the sparsity of the kinematic tree (Featherstone, 2005: "Efficient Factorization of the
+ * Joint-Space Inertia Matrix for Branched Kinematic Trees"). So, there isn't fill-in and the
+ * cost of the factorization and solves is O(n d^2) and O(n d) respectively (d is the depth of
+ * the tree), i.e. linear in the number of DoF for legged robots
+ */
+class OperationalSpaceDynamics
+{
+	public:
+		/** @brief Constructor function */
+		OperationalSpaceDynamics();
+
+		/** @brief Destructor function */
+		~OperationalSpaceDynamics();
+
+		/**
+		 * @brief Resets the whole-body dynamics, and computes the branch structure (parent DoF
+		 * of every DoF) of the joint-space inertia matrix
+		 * @param WholeBodyDynamics* Whole-body dynamics
+		 */
+		void reset(WholeBodyDynamics* dynamics);
+
+		/**
+		 * @brief Computes and factorizes the joint-space inertia matrix, i.e. H = L^T L
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @return bool False if the inertia matrix isn't positive definite
+		 */
+		bool computeInertiaFactorization(const rbd::Vector6d& base_pos,
+										 const Eigen::VectorXd& joint_pos);
+
+		/**
+		 * @brief Computes the operational-space inertia matrix, i.e.
+		 * Lambda = (J H^{-1} J^T)^{-1}, the dynamically consistent generalized inverse, i.e.
+		 * Jbar = H^{-1} J^T Lambda, and the null-space projector, i.e. N = I - Jbar J, of a task
+		 * Jacobian. It uses the last factorization of the joint-space inertia matrix
+		 * @param const Eigen::MatrixXd& Task Jacobian
+		 */
+		void computeOperationalSpaceDynamics(const Eigen::MatrixXd& jacobian);
+
+		/**
+		 * @brief Computes the operational-space dynamics of a set of contacts, where the
+		 * task Jacobian is the stacked (linear) contact Jacobian
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::BodySelector& Contacts
+		 * @return bool False if the inertia matrix isn't positive definite
+		 */
+		bool computeOperationalSpaceDynamics(const rbd::Vector6d& base_pos,
+											 const Eigen::VectorXd& joint_pos,
+											 const rbd::BodySelector& contacts);
+
+		/**
+		 * @brief Solves H x = b with the last factorization, where the right-hand side is
+		 * overwritten with the solution
+		 * @param Eigen::MatrixXd& Right-hand side (columns) and solution
+		 */
+		void solveInertia(Eigen::MatrixXd& x) const;
+		void solveInertia(Eigen::VectorXd& x) const;
+
+		/** @brief Gets the sparse factor L of the joint-space inertia matrix, i.e. H = L^T L */
+		const Eigen::MatrixXd& getInertiaFactor() const;
+
+		/** @brief Gets the operational-space inertia matrix */
+		const Eigen::MatrixXd& getOperationalSpaceInertia() const;
+
+		/** @brief Gets the dynamically consistent generalized inverse of the task Jacobian */
+		const Eigen::MatrixXd& getDynamicallyConsistentInverse() const;
+
+		/**
+		 * @brief Gets the dynamically consistent null-space projector of the task, i.e. the
+		 * accelerations (N) or the generalized forces (N^T) that don't affect it
+		 */
+		const Eigen::MatrixXd& getNullSpaceProjector() const;
+
+		/** @brief Gets the parent DoF of every DoF (-1 for the root) */
+		const std::vector<int>& getParentDoF() const;
+
+
+	private:
+		/**
+		 * @brief Factorizes the joint-space inertia matrix in place, i.e. H = L^T L where L is
+		 * stored in the lower triangle. Only the entries of the branches are visited
+		 * @param Eigen::MatrixXd& Joint-space inertia matrix and its factor
+		 * @return bool False if the matrix isn't positive definite
+		 */
+		bool factorizeLTL(Eigen::MatrixXd& inertia) const;
+
+		/**
+		 * @brief Solves L^T x = b in place by visiting the ancestors of every DoF
+		 * @param Eigen::Ref<Eigen::VectorXd> Right-hand side and solution
+		 */
+		void solveLT(Eigen::Ref<Eigen::VectorXd> x) const;
+
+		/**
+		 * @brief Solves L x = b in place by visiting the ancestors of every DoF
+		 * @param Eigen::Ref<Eigen::VectorXd> Right-hand side and solution
+		 */
+		void solveL(Eigen::Ref<Eigen::VectorXd> x) const;
+
+		/** @brief Whole-body dynamics */
+		WholeBodyDynamics* dynamics_;
+
+		/** @brief Parent DoF of every DoF */
+		std::vector<int> parent_;
+
+		/** @brief Sparse factor of the joint-space inertia matrix */
+		Eigen::MatrixXd inertia_factor_;
+
+		/** @brief Task Jacobian times L^{-1}, i.e. Y = J L^{-1} */
+		Eigen::MatrixXd jac_factor_;
+
+		/** @brief Operational-space inertia matrix */
+		Eigen::MatrixXd task_inertia_;
+
+		/** @brief Dynamically consistent generalized inverse */
+		Eigen::MatrixXd consistent_inv_;
+
+		/** @brief Null-space projector */
+		Eigen::MatrixXd null_projector_;
+
+		/** @brief Stacked contact Jacobian */
+		Eigen::MatrixXd contact_jac_;
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
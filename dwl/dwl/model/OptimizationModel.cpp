@@ -1,4 +1,7 @@
 #include <dwl/model/OptimizationModel.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <dwl/utils/Instrumentation.h>
+#include <limits>
 
 
 namespace dwl
@@ -11,7 +14,25 @@ OptimizationModel::OptimizationModel() : solution_(NULL), state_dimension_(0),
 		constraint_dimension_(0), nonzero_jacobian_(0), nonzero_hessian_(0), gradient_(true),
 		jacobian_(true), hessian_(true), bounds_(false), soft_constraints_(false),
 		first_time_(true), cost_function_(this), num_diff_mode_(Eigen::Central), epsilon_(1E-06),
-		soft_properties_(SoftConstraintProperties(10000., 0., 0.))
+		soft_properties_(SoftConstraintProperties(10000., 0., 0.)),
+		cost_cutoff_(std::numeric_limits<double>::max()), cloneable_batch_(true)
+{
+
+}
+
+
+OptimizationModel::OptimizationModel(const OptimizationModel& other) :
+		solution_(other.solution_), state_dimension_(other.state_dimension_),
+		constraint_dimension_(other.constraint_dimension_),
+		nonzero_jacobian_(other.nonzero_jacobian_), nonzero_hessian_(other.nonzero_hessian_),
+		jacobian_pattern_(other.jacobian_pattern_), hessian_pattern_(other.hessian_pattern_),
+		gradient_(other.gradient_), jacobian_(other.jacobian_), hessian_(other.hessian_),
+		bounds_(other.bounds_), soft_constraints_(other.soft_constraints_),
+		first_time_(other.first_time_), cost_function_(this),
+		num_diff_mode_(other.num_diff_mode_), epsilon_(other.epsilon_),
+		g_lbound_(other.g_lbound_), g_ubound_(other.g_ubound_),
+		soft_properties_(other.soft_properties_), cost_cutoff_(other.cost_cutoff_),
+		cloneable_batch_(other.cloneable_batch_)
 {
 
 }
@@ -22,6 +43,12 @@ OptimizationModel::~OptimizationModel()
 
 }
 
+
+OptimizationModel* OptimizationModel::clone() const
+{
+	return NULL;
+}
+
 void OptimizationModel::init(bool only_soft_constraints)
 {
 
@@ -52,6 +79,20 @@ void OptimizationModel::setNumberOfNonzeroHessian(unsigned int nonzero)
 }
 
 
+void OptimizationModel::setJacobianSparsity(const SparsityPattern& pattern)
+{
+	jacobian_pattern_ = pattern;
+	nonzero_jacobian_ = pattern.getNumberOfNonzeros();
+}
+
+
+void OptimizationModel::setHessianSparsity(const SparsityPattern& pattern)
+{
+	hessian_pattern_ = pattern;
+	nonzero_hessian_ = pattern.getNumberOfNonzeros();
+}
+
+
 void OptimizationModel::setSoftProperties(const SoftConstraintProperties& properties)
 {
 	soft_properties_ = properties;
@@ -109,6 +150,8 @@ void OptimizationModel::evaluateCosts(double& cost,
 void OptimizationModel::evaluateCostGradient(double* gradient, int grad_dim,
 											 const double* decision, int decision_dim)
 {
+	DWL_SCOPED_TIMER("OptimizationModel::evaluateCostGradient");
+
 	// Indicates that the gradient is computed using numerical differenciation
 	gradient_ = false;
 
@@ -145,20 +188,115 @@ void OptimizationModel::evaluateConstraints(double* constraint, int constraint_d
 }
 
 
+void OptimizationModel::evaluateCostsAndConstraints(double& cost,
+													double* constraint, int constraint_dim,
+													const double* decision, int decision_dim)
+{
+	evaluateCosts(cost, decision, decision_dim);
+	evaluateConstraints(constraint, constraint_dim, decision, decision_dim);
+}
+
+
+void OptimizationModel::setCostCutoff(double cutoff)
+{
+	cost_cutoff_ = cutoff;
+}
+
+
+double OptimizationModel::getCostCutoff() const
+{
+	return cost_cutoff_;
+}
+
+
+void OptimizationModel::evaluateCostsBatch(double* costs, int num_candidates,
+										   const double* decisions, int decision_dim,
+										   bool with_constraints,
+										   unsigned int num_threads)
+{
+	if (num_candidates <= 0)
+		return;
+
+	// Getting the number of threads, which cannot be bigger than the number of candidates
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::min(num_threads, (unsigned int) num_candidates);
+
+	// Creating the missing model clones. Note that the model is evaluated serially if it
+	// cannot be cloned
+	while (cloneable_batch_ && batch_clones_.size() < num_threads - 1) {
+		OptimizationModel* model = clone();
+		if (model == NULL) {
+			cloneable_batch_ = false;
+			break;
+		}
+		batch_clones_.push_back(boost::shared_ptr<OptimizationModel>(model));
+	}
+	num_threads = std::min(num_threads, (unsigned int) batch_clones_.size() + 1);
+
+	// Evaluating a contiguous chunk of candidates with a given model
+	auto evaluateCandidates = [&](OptimizationModel* model,
+								  unsigned int first, unsigned int last) {
+		for (unsigned int i = first; i < last; i++) {
+			const double* decision = decisions + i * decision_dim;
+			costs[i] = 0.;
+			if (with_constraints && model->getDimensionOfConstraints() > 0)
+				costs[i] = model->evaluateCostsAndSoftConstraints(decision, decision_dim);
+			else
+				model->evaluateCosts(costs[i], decision, decision_dim);
+		}
+	};
+
+	// The chunks are run by the task scheduler, where the first chunk uses this model
+	unsigned int chunk_size = (num_candidates + num_threads - 1) / num_threads;
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, (unsigned int) num_candidates);
+		unsigned int last = std::min(first + chunk_size, (unsigned int) num_candidates);
+		OptimizationModel* model = (t == 0) ? this : batch_clones_[t - 1].get();
+		model->setCostCutoff(cost_cutoff_);
+		evaluateCandidates(model, first, last);
+	});
+}
+
+
+void OptimizationModel::resetBatchClones()
+{
+	batch_clones_.clear();
+	cloneable_batch_ = true;
+}
+
+
 double OptimizationModel::evaluateAsSoftConstraints(
 												  const double* decision, int decision_dim)
 {
-	// Initialization of the cost value
+	// Computing the constraint
+	soft_constraint_.resize(constraint_dimension_);
+	evaluateConstraints(soft_constraint_.data(), constraint_dimension_,
+						decision, decision_dim);
+
+	return computeSoftConstraintCost(soft_constraint_, decision_dim);
+}
+
+
+double OptimizationModel::evaluateCostsAndSoftConstraints(const double* decision,
+														  int decision_dim)
+{
+	// Computing the cost and constraint in a single evaluation
 	double cost = 0.;
+	soft_constraint_.resize(constraint_dimension_);
+	evaluateCostsAndConstraints(cost,
+								soft_constraint_.data(), constraint_dimension_,
+								decision, decision_dim);
 
-	// Getting the constraint value and bounds
-	double g[constraint_dimension_];
-	Eigen::Map<Eigen::VectorXd> constraint(g, constraint_dimension_);
+	return cost + computeSoftConstraintCost(soft_constraint_, decision_dim);
+}
 
-	// Computing the constraint
-	evaluateConstraints(g, constraint_dimension_,
-						decision, decision_dim);
 
+double OptimizationModel::computeSoftConstraintCost(const Eigen::VectorXd& constraint,
+													int decision_dim)
+{
+	// Initialization of the cost value
+	double cost = 0.;
 
 	// Getting the bounds of the optimization problem just ones
 	if (!bounds_) {
@@ -272,6 +410,18 @@ unsigned int OptimizationModel::getNumberOfNonzeroHessian()
 }
 
 
+const SparsityPattern& OptimizationModel::getJacobianSparsity()
+{
+	return jacobian_pattern_;
+}
+
+
+const SparsityPattern& OptimizationModel::getHessianSparsity()
+{
+	return hessian_pattern_;
+}
+
+
 bool OptimizationModel::isCostGradientImplemented()
 {
 	return gradient_;
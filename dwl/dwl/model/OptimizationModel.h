@@ -1,8 +1,10 @@
 #ifndef DWL__MODEL__OPTIMIZATION_MODEL__H
 #define DWL__MODEL__OPTIMIZATION_MODEL__H
 
+#include <dwl/model/SparsityPattern.h>
 #include <dwl/utils/utils.h>
 #include <unsupported/Eigen/NumericalDiff>
+#include <boost/shared_ptr.hpp>
 
 #define NO_BOUND 2e19
 
@@ -92,9 +94,25 @@ class OptimizationModel
 		/** @brief Constructor function */
 		OptimizationModel();
 
+		/**
+		 * @brief Copy constructor function, where the cost functor of numerical differentiation
+		 * is bound to the new model
+		 * @param const OptimizationModel& Optimization model to copy
+		 */
+		OptimizationModel(const OptimizationModel& other);
+
 		/** @brief Destructor function */
 		virtual ~OptimizationModel();
 
+		/**
+		 * @brief Clones the optimization model, e.g. for evaluating the costs in another thread.
+		 * The clone shouldn't share mutable state (buffers, trajectories or dynamics objects)
+		 * with this model. The default implementation returns NULL, which means that the model
+		 * cannot be cloned
+		 * @return OptimizationModel* A new copy of the model
+		 */
+		virtual OptimizationModel* clone() const;
+
 		/** @brief Initializes the optimization model, i.e. the dimensions of the optimization
 		 * vectors */
 		virtual void init(bool only_soft_constraints = false);
@@ -111,6 +129,20 @@ class OptimizationModel
 		/** @brief Sets the number of nonzero values of the Hessian function */
 		void setNumberOfNonzeroHessian(unsigned int dim);
 
+		/**
+		 * @brief Sets the sparsity pattern of the constraint Jacobian. It also sets the
+		 * number of nonzero values of the Jacobian
+		 * @param const SparsityPattern& Jacobian sparsity pattern
+		 */
+		void setJacobianSparsity(const SparsityPattern& pattern);
+
+		/**
+		 * @brief Sets the sparsity pattern (lower-left triangle) of the Lagrangian Hessian. It
+		 * also sets the number of nonzero values of the Hessian
+		 * @param const SparsityPattern& Hessian sparsity pattern
+		 */
+		void setHessianSparsity(const SparsityPattern& pattern);
+
 		/** @brief Sets the constraint as soft constraint, i.e. inside the
 		 * cost function */
 		void defineAsSoftConstraint();
@@ -154,6 +186,42 @@ class OptimizationModel
 		virtual void evaluateCosts(double& cost,
 								   const double* decision, int decision_dim);
 
+		/**
+		 * @brief Sets the cost cutoff of the evaluations, i.e. the cost value above which the
+		 * solver discards a candidate (e.g. the worst cost of the CMA-ES elite of the current
+		 * generation). A model that computes its cost as a sum of non-negative terms can stop
+		 * once the partial sum reaches the cutoff, and return that partial sum, since it's
+		 * already enough for ranking the candidate. The terms should be evaluated in order of
+		 * cost-per-compute, so the cheap and discriminative ones come first
+		 * @param double Cost cutoff (infinity for complete evaluations, the default)
+		 */
+		void setCostCutoff(double cutoff);
+
+		/** @brief Gets the cost cutoff of the evaluations */
+		double getCostCutoff() const;
+
+		/**
+		 * @brief Evaluates the costs of a batch of candidates, e.g. the offsprings of a CMA-ES
+		 * generation. The candidates are split in contiguous chunks, where the first chunk is
+		 * evaluated by this model and the rest by model clones. The clones are kept between
+		 * calls, so their buffers (e.g. trajectories) are reused. The candidates are evaluated
+		 * serially if the model cannot be cloned
+		 * @param double* Cost values of the candidates
+		 * @param int Number of candidates
+		 * @param const double* Decision variables of the candidates, one after another
+		 * @param int Number of decision variables of a candidate
+		 * @param bool Adds the constraints as soft constraints, as the CMA-ES fitness
+		 * @param unsigned int Number of threads, where zero means one per hardware thread
+		 */
+		virtual void evaluateCostsBatch(double* costs, int num_candidates,
+										const double* decisions, int decision_dim,
+										bool with_constraints = false,
+										unsigned int num_threads = 0);
+
+		/** @brief Deletes the model clones of the batch evaluation, e.g. when the model
+		 * changes between computations */
+		void resetBatchClones();
+
 		/**
 		 * @brief Abstract method for evaluating the gradient of the cost function given a
 		 * current decision state
@@ -178,6 +246,22 @@ class OptimizationModel
 		virtual void evaluateConstraints(double* constraint, int constraint_dim,
 								 	 	 const double* decision, int decision_dim);
 
+		/**
+		 * @brief Evaluates the cost and constraint functions given a current decision state.
+		 * Solvers call it when they require both values at the same point, so a model can
+		 * share the computations of both evaluations (e.g. the conversion of the decision
+		 * variables or the kinematics). The default implementation evaluates them separately
+		 * @param double& Value of the objective function ($f(x)$)
+		 * @param double* Array of constraint function values, $g(x)$
+		 * @param int Number of constraint variables (dimension of $g(x)$)
+		 * @param const double* Array of the decision variables, $x$, at which $f(x)$ and $g(x)$
+		 * are evaluated
+		 * @param int Number of decision variables (dimension of $x$)
+		 */
+		virtual void evaluateCostsAndConstraints(double& cost,
+												 double* constraint, int constraint_dim,
+												 const double* decision, int decision_dim);
+
 		/**
 		 * @brief Abstract method for evaluating the constraint function as soft one
 		 * @param const double* Array of the decision variables, $x$, at which the constraint functions,
@@ -187,6 +271,16 @@ class OptimizationModel
 		 */
 		virtual double evaluateAsSoftConstraints(const double* decision, int decision_dim);
 
+		/**
+		 * @brief Evaluates the cost function plus the constraints as soft ones, i.e. the fitness
+		 * of solvers that cannot handle constraints. Both are computed in a single evaluation
+		 * of evaluateCostsAndConstraints
+		 * @param const double* Array of the decision variables, $x$
+		 * @param int Number of decision variables (dimension of $x$)
+		 * @param return The cost plus the soft-cost value
+		 */
+		double evaluateCostsAndSoftConstraints(const double* decision, int decision_dim);
+
 		/**
 		 * @brief Abstract method for evaluating the jacobian of the constraint function given a
 		 * current decision state
@@ -243,6 +337,12 @@ class OptimizationModel
 		/** @brief Gets the number of nonzero values of the Hessian */
 		unsigned int getNumberOfNonzeroHessian();
 
+		/** @brief Gets the sparsity pattern of the constraint Jacobian */
+		const SparsityPattern& getJacobianSparsity();
+
+		/** @brief Gets the sparsity pattern of the Lagrangian Hessian */
+		const SparsityPattern& getHessianSparsity();
+
 		/** @brief Returns true if the cost Gradient is implemented */
 		bool isCostGradientImplemented();
 
@@ -257,6 +357,15 @@ class OptimizationModel
 
 
 	protected:
+		/**
+		 * @brief Indicates if a partial cost reaches the cost cutoff, i.e. if the rest of the
+		 * (non-negative) cost terms can be skipped
+		 * @param double Partial cost
+		 */
+		bool isAboveCostCutoff(double partial_cost) const {
+			return partial_cost >= cost_cutoff_;
+		}
+
 		/**@brief The solution vector */
 		double* solution_;
 
@@ -272,8 +381,21 @@ class OptimizationModel
 		/** @brief Number of nonzero values of the Hessian */
 		unsigned int nonzero_hessian_;
 
+		/** @brief Sparsity patterns of the Jacobian and Hessian */
+		SparsityPattern jacobian_pattern_;
+		SparsityPattern hessian_pattern_;
+
 
 	private:
+		/**
+		 * @brief Computes the soft-cost value of an evaluated constraint vector
+		 * @param const Eigen::VectorXd& Constraint vector, $g(x)$
+		 * @param int Number of decision variables (dimension of $x$)
+		 * @param return The soft-cost value
+		 */
+		double computeSoftConstraintCost(const Eigen::VectorXd& constraint,
+										 int decision_dim);
+
 		/** @brief True if the gradient of the cost function is implemented */
 		bool gradient_;
 
@@ -306,6 +428,16 @@ class OptimizationModel
 
 		/** @brief Soft-constraints properties */
 		SoftConstraintProperties soft_properties_;
+
+		/** @brief Constraint vector of the soft-constraint evaluations, which is reused */
+		Eigen::VectorXd soft_constraint_;
+
+		/** @brief Cost cutoff of the evaluations */
+		double cost_cutoff_;
+
+		/** @brief Model clones of the batch evaluation */
+		std::vector<boost::shared_ptr<OptimizationModel> > batch_clones_;
+		bool cloneable_batch_;
 };
 
 } //@namespace model
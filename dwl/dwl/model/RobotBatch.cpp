@@ -0,0 +1,127 @@
+#include <dwl/model/RobotBatch.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+RobotBatch::RobotBatch() : num_threads_(1)
+{
+
+}
+
+
+RobotBatch::~RobotBatch()
+{
+
+}
+
+
+void RobotBatch::modelFromURDFFile(const std::string& urdf_file,
+								   const std::string& system_file)
+{
+	wdyn_.modelFromURDFFile(urdf_file, system_file);
+	states_.clear();
+}
+
+
+void RobotBatch::modelFromURDFModel(const std::string& urdf_model,
+									const std::string& system_file)
+{
+	wdyn_.modelFromURDFModel(urdf_model, system_file);
+	states_.clear();
+}
+
+
+void RobotBatch::resize(unsigned int num_instances)
+{
+	const FloatingBaseSystem& fbs = wdyn_.getFloatingBaseSystem();
+	states_.resize(num_instances, fbs.getJointDoF(), fbs.getEndEffectorNames());
+	states_.joint_pos = fbs.getDefaultPosture().replicate(1, num_instances);
+}
+
+
+unsigned int RobotBatch::getNumberOfInstances() const
+{
+	return states_.size();
+}
+
+
+void RobotBatch::setNumberOfThreads(unsigned int num_threads)
+{
+	num_threads_ = num_threads;
+}
+
+
+void RobotBatch::setState(unsigned int instance,
+						  const WholeBodyState& state)
+{
+	states_.setState(instance, state);
+}
+
+
+void RobotBatch::getState(WholeBodyState& state,
+						  unsigned int instance) const
+{
+	states_.getState(state, instance);
+}
+
+
+void RobotBatch::computeForwardKinematics(Eigen::MatrixXd& op_pos,
+										  const rbd::BodySelector& body_set,
+										  enum rbd::Component component,
+										  enum TypeOfOrientation type)
+{
+	wdyn_.getWholeBodyKinematics().computeForwardKinematics(op_pos,
+															states_.base_pos,
+															states_.joint_pos,
+															body_set, component, type,
+															num_threads_);
+}
+
+
+void RobotBatch::computeInverseDynamics()
+{
+	// Using the contact efforts as external forces only if any of them is defined, since
+	// the batched inverse dynamics skips them for an empty matrix
+	bool ext_force = false;
+	unsigned int num_contacts = states_.getContactNames().size();
+	for (unsigned int i = 0; i < states_.size() && !ext_force; i++) {
+		for (unsigned int c = 0; c < num_contacts; c++) {
+			if (states_.hasContact(i, c, WholeBodyTrajectoryContainer::EFFORT)) {
+				ext_force = true;
+				break;
+			}
+		}
+	}
+
+	wdyn_.computeInverseDynamics(states_.base_eff, states_.joint_eff,
+								 states_.base_pos, states_.joint_pos,
+								 states_.base_vel, states_.joint_vel,
+								 states_.base_acc, states_.joint_acc,
+								 ext_force ? states_.contact_eff : no_ext_force_,
+								 num_threads_);
+}
+
+
+WholeBodyTrajectoryContainer& RobotBatch::getStates()
+{
+	return states_;
+}
+
+
+const WholeBodyTrajectoryContainer& RobotBatch::getStates() const
+{
+	return states_;
+}
+
+
+WholeBodyDynamics& RobotBatch::getWholeBodyDynamics()
+{
+	return wdyn_;
+}
+
+} //@namespace model
+} //@namespace dwl
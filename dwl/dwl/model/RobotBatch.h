@@ -0,0 +1,127 @@
+#ifndef DWL__MODEL__ROBOT_BATCH__H
+#define DWL__MODEL__ROBOT_BATCH__H
+
+#include <dwl/model/WholeBodyDynamics.h>
+#include <dwl/TrajectoryContainer.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class RobotBatch
+ * @brief Batch of instances of the same robot (e.g. of a fleet simulation or of the data
+ * generation for learning), which are evaluated together. The states of the instances are
+ * stored as a structure of arrays (see WholeBodyTrajectoryContainer), where the column i of
+ * every quantity is the instance i, and the contacts are the end-effectors of the robot. So
+ * the kinematics and dynamics of all the instances are evaluated by the batched routines,
+ * which split the instances in parallel chunks, without any per-instance object. The model is
+ * built once from the model registry
+ */
+class RobotBatch
+{
+	public:
+		/** @brief Constructor function */
+		RobotBatch();
+
+		/** @brief Destructor function */
+		~RobotBatch();
+
+		/**
+		 * @brief Builds the model of the instances from an URDF file
+		 * @param const std::string& URDF filename
+		 * @param const std::string& Semantic system description filename
+		 */
+		void modelFromURDFFile(const std::string& urdf_file,
+							   const std::string& system_file = std::string());
+
+		/**
+		 * @brief Builds the model of the instances from an URDF model (xml)
+		 * @param const std::string& URDF model
+		 * @param const std::string& Semantic system description filename
+		 */
+		void modelFromURDFModel(const std::string& urdf_model,
+								const std::string& system_file = std::string());
+
+		/**
+		 * @brief Resizes the batch, where the instances are in the default posture and without
+		 * motion
+		 * @param unsigned int Number of instances
+		 */
+		void resize(unsigned int num_instances);
+
+		/** @brief Gets the number of instances */
+		unsigned int getNumberOfInstances() const;
+
+		/**
+		 * @brief Sets the number of threads of the evaluations (default is one)
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * @brief Sets the state of an instance
+		 * @param unsigned int Instance index
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void setState(unsigned int instance,
+					  const WholeBodyState& state);
+
+		/**
+		 * @brief Gets the state of an instance
+		 * @param WholeBodyState& Whole-body state
+		 * @param unsigned int Instance index
+		 */
+		void getState(WholeBodyState& state,
+					  unsigned int instance) const;
+
+		/**
+		 * @brief Computes the forward kinematics of all the instances, where the positions of
+		 * the bodies of an instance are stacked in the order of the body set
+		 * @param Eigen::MatrixXd& Operational position of the bodies per instance
+		 * @param const rbd::BodySelector& A predefined set of bodies
+		 * @param enum rbd::Component There are three different important kind of jacobian
+		 * such as: linear, angular and full
+		 * @param enum TypeOfOrientation Desired type of orientation
+		 */
+		void computeForwardKinematics(Eigen::MatrixXd& op_pos,
+									  const rbd::BodySelector& body_set,
+									  enum rbd::Component component = rbd::Full,
+									  enum TypeOfOrientation type = RollPitchYaw);
+
+		/**
+		 * @brief Computes the inverse dynamics of all the instances, which are written in the
+		 * base and joint efforts of the states. The contact efforts are the external forces,
+		 * and they are ignored if none of them is defined
+		 */
+		void computeInverseDynamics();
+
+		/** @brief Gets the states of the instances */
+		WholeBodyTrajectoryContainer& getStates();
+		const WholeBodyTrajectoryContainer& getStates() const;
+
+		/** @brief Gets the whole-body dynamics of the instances */
+		WholeBodyDynamics& getWholeBodyDynamics();
+
+
+	private:
+		/** @brief Whole-body dynamics, which is shared by the instances */
+		WholeBodyDynamics wdyn_;
+
+		/** @brief States of the instances, where every column is an instance */
+		WholeBodyTrajectoryContainer states_;
+
+		/** @brief Empty external forces */
+		Eigen::MatrixXd no_ext_force_;
+
+		/** @brief Number of threads */
+		unsigned int num_threads_;
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,135 @@
+#include <dwl/model/SparsityPattern.h>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+SparsityPattern::SparsityPattern() : rows_(0), cols_(0)
+{
+
+}
+
+
+SparsityPattern::SparsityPattern(unsigned int rows,
+								 unsigned int cols) : rows_(rows), cols_(cols)
+{
+
+}
+
+
+SparsityPattern::~SparsityPattern()
+{
+
+}
+
+
+void SparsityPattern::resize(unsigned int rows,
+							 unsigned int cols)
+{
+	rows_ = rows;
+	cols_ = cols;
+	clear();
+}
+
+
+void SparsityPattern::clear()
+{
+	row_entries_.clear();
+	col_entries_.clear();
+}
+
+
+void SparsityPattern::addEntry(unsigned int row,
+							   unsigned int col)
+{
+	row_entries_.push_back(row);
+	col_entries_.push_back(col);
+}
+
+
+void SparsityPattern::addDenseBlock(unsigned int row_offset,
+									unsigned int col_offset,
+									unsigned int rows,
+									unsigned int cols)
+{
+	for (unsigned int i = 0; i < rows; i++) {
+		for (unsigned int j = 0; j < cols; j++)
+			addEntry(row_offset + i, col_offset + j);
+	}
+}
+
+
+void SparsityPattern::addDiagonalBlock(unsigned int row_offset,
+									   unsigned int col_offset,
+									   unsigned int dim)
+{
+	for (unsigned int i = 0; i < dim; i++)
+		addEntry(row_offset + i, col_offset + i);
+}
+
+
+void SparsityPattern::addLowerTriangularBlock(unsigned int offset,
+											  unsigned int dim)
+{
+	for (unsigned int i = 0; i < dim; i++) {
+		for (unsigned int j = 0; j <= i; j++)
+			addEntry(offset + i, offset + j);
+	}
+}
+
+
+void SparsityPattern::addPattern(const SparsityPattern& block,
+								 unsigned int row_offset,
+								 unsigned int col_offset)
+{
+	unsigned int num_entries = block.getNumberOfNonzeros();
+	for (unsigned int k = 0; k < num_entries; k++)
+		addEntry(row_offset + block.row_entries_[k], col_offset + block.col_entries_[k]);
+}
+
+
+void SparsityPattern::getStructure(int* row_entries,
+								   int* col_entries) const
+{
+	unsigned int num_entries = getNumberOfNonzeros();
+	for (unsigned int k = 0; k < num_entries; k++) {
+		row_entries[k] = row_entries_[k];
+		col_entries[k] = col_entries_[k];
+	}
+}
+
+
+unsigned int SparsityPattern::getNumberOfNonzeros() const
+{
+	return row_entries_.size();
+}
+
+
+unsigned int SparsityPattern::getNumberOfRows() const
+{
+	return rows_;
+}
+
+
+unsigned int SparsityPattern::getNumberOfColumns() const
+{
+	return cols_;
+}
+
+
+const std::vector<unsigned int>& SparsityPattern::getRowEntries() const
+{
+	return row_entries_;
+}
+
+
+const std::vector<unsigned int>& SparsityPattern::getColumnEntries() const
+{
+	return col_entries_;
+}
+
+} //@namespace model
+} //@namespace dwl
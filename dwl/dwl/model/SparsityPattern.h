@@ -0,0 +1,134 @@
+#ifndef DWL__MODEL__SPARSITY_PATTERN__H
+#define DWL__MODEL__SPARSITY_PATTERN__H
+
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+/**
+ * @class SparsityPattern
+ * @brief SparsityPattern describes the nonzero structure (triplet format) of
+ * the Jacobian or Hessian of an optimization model. A pattern can be composed
+ * from smaller block patterns, e.g. the per-knot blocks of a multiple-shooting
+ * problem, where each knot couples only to its neighbors
+ */
+class SparsityPattern
+{
+	public:
+		/** @brief Constructor function */
+		SparsityPattern();
+
+		/**
+		 * @brief Constructor function
+		 * @param unsigned int Number of rows
+		 * @param unsigned int Number of columns
+		 */
+		SparsityPattern(unsigned int rows,
+						unsigned int cols);
+
+		/** @brief Destructor function */
+		~SparsityPattern();
+
+		/**
+		 * @brief Resizes the pattern and removes its entries
+		 * @param unsigned int Number of rows
+		 * @param unsigned int Number of columns
+		 */
+		void resize(unsigned int rows,
+					unsigned int cols);
+
+		/** @brief Removes all the entries */
+		void clear();
+
+		/**
+		 * @brief Adds a nonzero entry
+		 * @param unsigned int Row index
+		 * @param unsigned int Column index
+		 */
+		void addEntry(unsigned int row,
+					  unsigned int col);
+
+		/**
+		 * @brief Adds a dense block in row-major order
+		 * @param unsigned int Row offset of the block
+		 * @param unsigned int Column offset of the block
+		 * @param unsigned int Number of rows of the block
+		 * @param unsigned int Number of columns of the block
+		 */
+		void addDenseBlock(unsigned int row_offset,
+						   unsigned int col_offset,
+						   unsigned int rows,
+						   unsigned int cols);
+
+		/**
+		 * @brief Adds a diagonal block
+		 * @param unsigned int Row offset of the block
+		 * @param unsigned int Column offset of the block
+		 * @param unsigned int Dimension of the block
+		 */
+		void addDiagonalBlock(unsigned int row_offset,
+							  unsigned int col_offset,
+							  unsigned int dim);
+
+		/**
+		 * @brief Adds a lower-left triangular block (diagonal included) in
+		 * row-major order, i.e. the structure of a symmetric block
+		 * @param unsigned int Row and column offset of the block
+		 * @param unsigned int Dimension of the block
+		 */
+		void addLowerTriangularBlock(unsigned int offset,
+									 unsigned int dim);
+
+		/**
+		 * @brief Adds the entries of another pattern as a block
+		 * @param const SparsityPattern& Block pattern
+		 * @param unsigned int Row offset of the block
+		 * @param unsigned int Column offset of the block
+		 */
+		void addPattern(const SparsityPattern& block,
+						unsigned int row_offset,
+						unsigned int col_offset);
+
+		/**
+		 * @brief Gets the structure in triplet format
+		 * @param int* Row indices of the nonzero entries
+		 * @param int* Column indices of the nonzero entries
+		 */
+		void getStructure(int* row_entries,
+						  int* col_entries) const;
+
+		/** @brief Gets the number of nonzero entries */
+		unsigned int getNumberOfNonzeros() const;
+
+		/** @brief Gets the number of rows */
+		unsigned int getNumberOfRows() const;
+
+		/** @brief Gets the number of columns */
+		unsigned int getNumberOfColumns() const;
+
+		/** @brief Gets the row indices of the nonzero entries */
+		const std::vector<unsigned int>& getRowEntries() const;
+
+		/** @brief Gets the column indices of the nonzero entries */
+		const std::vector<unsigned int>& getColumnEntries() const;
+
+
+	private:
+		/** @brief Dimensions of the pattern */
+		unsigned int rows_;
+		unsigned int cols_;
+
+		/** @brief Row and column indices of the nonzero entries */
+		std::vector<unsigned int> row_entries_;
+		std::vector<unsigned int> col_entries_;
+};
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
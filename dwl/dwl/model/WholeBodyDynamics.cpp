@@ -1,4 +1,6 @@
 #include <dwl/model/WholeBodyDynamics.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -7,7 +9,19 @@ namespace dwl
 namespace model
 {
 
-WholeBodyDynamics::WholeBodyDynamics()
+void DynamicsWorkspace::resize(unsigned int num_dof,
+							   unsigned int num_bodies)
+{
+	q.setZero(num_dof);
+	q_dot.setZero(num_dof);
+	q_ddot.setZero(num_dof);
+	tau.setZero(num_dof);
+	fext.resize(num_bodies, RigidBodyDynamics::Math::SpatialVector::Zero());
+}
+
+
+WholeBodyDynamics::WholeBodyDynamics() : friction_distribution_(false),
+		friction_coeff_(0.7), force_regularization_(1e-6)
 {
 
 }
@@ -47,6 +61,10 @@ void WholeBodyDynamics::modelFromURDFModel(const std::string& urdf_model,
 	// Setting up the size of the joint space inertia matrix
 	joint_inertia_mat_.resize(system_.getSystemDoF(), system_.getSystemDoF());
 	joint_inertia_mat_.setZero();
+
+	// Sizing the workspace of the allocation-free routines
+	workspace_.resize(system_.getSystemDoF(),
+					  system_.getRBDModel().mBodies.size());
 }
 
 
@@ -64,17 +82,29 @@ void WholeBodyDynamics::computeInverseDynamics(rbd::Vector6d& base_wrench,
 	joint_forces.resize(system_.getJointDoF());
 
 	// Converting base and joint states to generalized joint states
-	Eigen::VectorXd q = system_.toGeneralizedJointState(base_pos, joint_pos);
-	Eigen::VectorXd q_dot = system_.toGeneralizedJointState(base_vel, joint_vel);
-	Eigen::VectorXd q_ddot = system_.toGeneralizedJointState(base_acc, joint_acc);
-	Eigen::VectorXd tau = Eigen::VectorXd::Zero(system_.getSystemDoF());
+	Eigen::VectorXd& q = workspace_.q;
+	Eigen::VectorXd& q_dot = workspace_.q_dot;
+	Eigen::VectorXd& q_ddot = workspace_.q_ddot;
+	system_.toGeneralizedJointState(q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(q_dot, base_vel, joint_vel);
+	system_.toGeneralizedJointState(q_ddot, base_acc, joint_acc);
+	Eigen::VectorXd& tau = workspace_.tau;
+	tau.setZero();
 
 	// Computing the applied external spatial forces for every body
 	std::vector<SpatialVector_t> fext;
 	convertAppliedExternalForces(fext, ext_force, q);
 
-	// Computing the inverse dynamics with Recursive Newton-Euler Algorithm (RNEA)
-	RigidBodyDynamics::InverseDynamics(system_.getRBDModel(), q, q_dot, q_ddot, tau, &fext);
+	// Computing the inverse dynamics with Recursive Newton-Euler Algorithm (RNEA), where
+	// the generated one doesn't update the model
+	const GeneratedModel* generated = system_.getGeneratedModel();
+	if (generated != NULL) {
+		generated->computeInverseDynamics(tau.data(), q.data(), q_dot.data(), q_ddot.data(),
+										  system_.getRBDModel().gravity.data(), &fext[0]);
+	} else {
+		RigidBodyDynamics::InverseDynamics(system_.getRBDModel(), q, q_dot, q_ddot, tau, &fext);
+		system_.invalidateKinematics();
+	}
 
 	// Converting the generalized joint forces to base wrench and joint forces
 	base_wrench.setZero();
@@ -82,6 +112,233 @@ void WholeBodyDynamics::computeInverseDynamics(rbd::Vector6d& base_wrench,
 }
 
 
+void WholeBodyDynamics::computeInverseDynamics(rbd::Vector6d& base_wrench,
+											   Eigen::VectorXd& joint_forces,
+											   const rbd::Vector6d& base_pos,
+											   const Eigen::VectorXd& joint_pos,
+											   const rbd::Vector6d& base_vel,
+											   const Eigen::VectorXd& joint_vel,
+											   const rbd::Vector6d& base_acc,
+											   const Eigen::VectorXd& joint_acc,
+											   const rbd::BodyContainer6d& ext_force)
+{
+	// Setting the size of the joint forces vector. Note that it doesn't
+	// allocate memory if it has already the joint dimension
+	joint_forces.resize(system_.getJointDoF());
+
+	// Converting base and joint states to generalized joint states. Note that
+	// we use the preallocated workspace
+	system_.toGeneralizedJointState(workspace_.q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(workspace_.q_dot, base_vel, joint_vel);
+	system_.toGeneralizedJointState(workspace_.q_ddot, base_acc, joint_acc);
+	workspace_.tau.setZero();
+
+	// Computing the applied external spatial forces for every body
+	convertAppliedExternalForces(workspace_.fext, ext_force, workspace_.q);
+
+	// Computing the inverse dynamics with Recursive Newton-Euler Algorithm (RNEA), where
+	// the generated one doesn't update the model
+	const GeneratedModel* generated = system_.getGeneratedModel();
+	if (generated != NULL) {
+		generated->computeInverseDynamics(workspace_.tau.data(), workspace_.q.data(),
+										  workspace_.q_dot.data(), workspace_.q_ddot.data(),
+										  system_.getRBDModel().gravity.data(),
+										  &workspace_.fext[0]);
+	} else {
+		RigidBodyDynamics::InverseDynamics(system_.getRBDModel(),
+										   workspace_.q, workspace_.q_dot,
+										   workspace_.q_ddot, workspace_.tau,
+										   &workspace_.fext);
+		system_.invalidateKinematics();
+	}
+
+	// Converting the generalized joint forces to base wrench and joint forces
+	base_wrench.setZero();
+	system_.fromGeneralizedJointState(base_wrench, joint_forces, workspace_.tau);
+}
+
+
+void WholeBodyDynamics::computeBranchInverseDynamics(Eigen::VectorXd& branch_forces,
+													 const rbd::Vector6d& base_pos,
+													 const Eigen::VectorXd& joint_pos,
+													 const rbd::Vector6d& base_vel,
+													 const Eigen::VectorXd& joint_vel,
+													 const rbd::Vector6d& base_acc,
+													 const Eigen::VectorXd& joint_acc,
+													 unsigned int end_effector)
+{
+	// Converting base and joint states to generalized joint states
+	system_.toGeneralizedJointState(workspace_.q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(workspace_.q_dot, base_vel, joint_vel);
+	system_.toGeneralizedJointState(workspace_.q_ddot, base_acc, joint_acc);
+	workspace_.tau.setZero();
+
+	// Computing the RNEA of the branch bodies
+	rbd::computeBranchInverseDynamics(system_.getRBDModel(),
+									  workspace_.q, workspace_.q_dot, workspace_.q_ddot,
+									  system_.getBranchBodyIds(end_effector),
+									  system_.getBranchSubtreeIds(end_effector),
+									  workspace_.tau);
+	system_.invalidateKinematics();
+
+	// Getting the forces of the branch joints
+	unsigned int q_idx = 0, num_dof = 0;
+	system_.getBranch(q_idx, num_dof, end_effector);
+	branch_forces = workspace_.tau.segment(q_idx, num_dof);
+}
+
+
+void WholeBodyDynamics::computeInverseDynamics(std::vector<rbd::Vector6d>& base_wrench,
+											   std::vector<Eigen::VectorXd>& joint_forces,
+											   const WholeBodyTrajectory& trajectory,
+											   unsigned int num_threads)
+{
+	// Setting the size of the outputs
+	unsigned int num_knots = trajectory.size();
+	base_wrench.resize(num_knots);
+	joint_forces.resize(num_knots);
+	if (num_knots == 0)
+		return;
+
+	// Getting the number of threads, which cannot be bigger than the number
+	// of knots
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::min(num_threads, num_knots);
+
+	// Evaluating a contiguous chunk of knots with a given dynamic model
+	auto evaluateKnots = [&](WholeBodyDynamics& dynamics,
+							 unsigned int first, unsigned int last) {
+		for (unsigned int k = first; k < last; k++) {
+			const WholeBodyState& state = trajectory[k];
+			dynamics.computeInverseDynamics(base_wrench[k], joint_forces[k],
+											state.base_pos, state.joint_pos,
+											state.base_vel, state.joint_vel,
+											state.base_acc, state.joint_acc,
+											state.contact_eff);
+		}
+	};
+
+	// Creating the thread-local copies of the dynamic model. Note that the
+	// first chunk uses this model. The chunks are run by the task scheduler
+	unsigned int chunk_size = (num_knots + num_threads - 1) / num_threads;
+	std::vector<WholeBodyDynamics> thread_dynamics(num_threads - 1, *this);
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_knots);
+		unsigned int last = std::min(first + chunk_size, num_knots);
+		evaluateKnots((t == 0) ? *this : thread_dynamics[t - 1], first, last);
+	});
+}
+
+
+void WholeBodyDynamics::computeInverseDynamics(Eigen::MatrixXd& base_wrench,
+											   Eigen::MatrixXd& joint_forces,
+											   const Eigen::Ref<const Eigen::MatrixXd>& base_pos,
+											   const Eigen::Ref<const Eigen::MatrixXd>& joint_pos,
+											   const Eigen::Ref<const Eigen::MatrixXd>& base_vel,
+											   const Eigen::Ref<const Eigen::MatrixXd>& joint_vel,
+											   const Eigen::Ref<const Eigen::MatrixXd>& base_acc,
+											   const Eigen::Ref<const Eigen::MatrixXd>& joint_acc,
+											   const Eigen::Ref<const Eigen::MatrixXd>& ext_force,
+											   unsigned int num_threads)
+{
+	// Setting the size of the outputs
+	unsigned int num_states = base_pos.cols();
+	unsigned int num_joints = system_.getJointDoF();
+	const rbd::BodySelector& ee_names = system_.getEndEffectorNames();
+	base_wrench.setZero(6, num_states);
+	joint_forces.setZero(num_joints, num_states);
+
+	// Checking the dimensions of the batch
+	bool valid_base = base_pos.rows() == 6 && base_vel.rows() == 6 && base_acc.rows() == 6;
+	bool valid_joint = joint_pos.rows() == num_joints && joint_vel.rows() == num_joints &&
+			joint_acc.rows() == num_joints;
+	bool valid_contact = ext_force.rows() == 0 ||
+			(unsigned int) ext_force.rows() == 6 * ee_names.size();
+	bool valid_states = joint_pos.cols() == num_states && base_vel.cols() == num_states &&
+			joint_vel.cols() == num_states && base_acc.cols() == num_states &&
+			joint_acc.cols() == num_states &&
+			(ext_force.rows() == 0 || ext_force.cols() == num_states);
+	if (!valid_base || !valid_joint || !valid_contact || !valid_states) {
+		printf(RED "FATAL: the batch of states has to be [6 x N] base, [%u x N] joint and "
+				"[%u x N] (or empty) external force quantities\n" COLOR_RESET,
+				num_joints, 6 * (unsigned int) ee_names.size());
+		return;
+	}
+	if (num_states == 0)
+		return;
+
+	// Getting the number of threads, which cannot be bigger than the number
+	// of states
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::min(num_threads, num_states);
+
+	// Evaluating a contiguous chunk of states with a given dynamic model. Note
+	// that every thread uses its own buffers of the state
+	auto evaluateStates = [&](WholeBodyDynamics& dynamics,
+							  unsigned int first, unsigned int last) {
+		rbd::BodyContainer6d state_force(ee_names);
+		rbd::Vector6d state_wrench;
+		Eigen::VectorXd state_forces(num_joints);
+		for (unsigned int k = first; k < last; k++) {
+			if (ext_force.rows() != 0) {
+				for (unsigned int i = 0; i < ee_names.size(); i++)
+					state_force[i] = ext_force.block<6,1>(6 * i, k);
+			}
+			dynamics.computeInverseDynamics(state_wrench, state_forces,
+											base_pos.col(k), joint_pos.col(k),
+											base_vel.col(k), joint_vel.col(k),
+											base_acc.col(k), joint_acc.col(k),
+											state_force);
+			base_wrench.col(k) = state_wrench;
+			joint_forces.col(k) = state_forces;
+		}
+	};
+
+	// Creating the thread-local copies of the dynamic model. Note that the
+	// first chunk uses this model. The chunks are run by the task scheduler
+	unsigned int chunk_size = (num_states + num_threads - 1) / num_threads;
+	std::vector<WholeBodyDynamics> thread_dynamics(num_threads - 1, *this);
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_states);
+		unsigned int last = std::min(first + chunk_size, num_states);
+		evaluateStates((t == 0) ? *this : thread_dynamics[t - 1], first, last);
+	});
+}
+
+
+void WholeBodyDynamics::computeForwardDynamics(rbd::Vector6d& base_acc,
+											   Eigen::VectorXd& joint_acc,
+											   const rbd::Vector6d& base_pos,
+											   const Eigen::VectorXd& joint_pos,
+											   const rbd::Vector6d& base_vel,
+											   const Eigen::VectorXd& joint_vel,
+											   const Eigen::VectorXd& joint_forces,
+											   const rbd::BodyContainer6d& ext_force)
+{
+	// Converting base and joint states to generalized joint states. Note that
+	// we use the preallocated workspace, and the floating-base is unactuated
+	system_.toGeneralizedJointState(workspace_.q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(workspace_.q_dot, base_vel, joint_vel);
+	system_.toGeneralizedJointState(workspace_.tau, rbd::Vector6d::Zero(), joint_forces);
+
+	// Computing the applied external spatial forces for every body
+	convertAppliedExternalForces(workspace_.fext, ext_force, workspace_.q);
+
+	// Computing the forward dynamics with the Articulated Body Algorithm (ABA)
+	RigidBodyDynamics::ForwardDynamics(system_.getRBDModel(),
+									   workspace_.q, workspace_.q_dot,
+									   workspace_.tau, workspace_.q_ddot,
+									   &workspace_.fext);
+	system_.invalidateKinematics();
+
+	// Converting the generalized joint accelerations to base and joint
+	// accelerations
+	system_.fromGeneralizedJointState(base_acc, joint_acc, workspace_.q_ddot);
+}
+
+
 void WholeBodyDynamics::computeFloatingBaseInverseDynamics(rbd::Vector6d& base_acc,
 														   Eigen::VectorXd& joint_forces,
 														   const rbd::Vector6d& base_pos,
@@ -95,10 +352,14 @@ void WholeBodyDynamics::computeFloatingBaseInverseDynamics(rbd::Vector6d& base_a
 	joint_forces.resize(system_.getJointDoF());
 
 	// Converting base and joint states to generalized joint states
-	Eigen::VectorXd q = system_.toGeneralizedJointState(base_pos, joint_pos);
-	Eigen::VectorXd q_dot = system_.toGeneralizedJointState(base_vel, joint_vel);
-	Eigen::VectorXd q_ddot = system_.toGeneralizedJointState(base_acc, joint_acc);
-	Eigen::VectorXd tau = Eigen::VectorXd::Zero(system_.getSystemDoF());
+	Eigen::VectorXd& q = workspace_.q;
+	Eigen::VectorXd& q_dot = workspace_.q_dot;
+	Eigen::VectorXd& q_ddot = workspace_.q_ddot;
+	system_.toGeneralizedJointState(q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(q_dot, base_vel, joint_vel);
+	system_.toGeneralizedJointState(q_ddot, base_acc, joint_acc);
+	Eigen::VectorXd& tau = workspace_.tau;
+	tau.setZero();
 
 	// Computing the applied external spatial forces for every body
 	std::vector<SpatialVector_t> fext;
@@ -128,6 +389,7 @@ void WholeBodyDynamics::computeFloatingBaseInverseDynamics(rbd::Vector6d& base_a
 		} else
 			printf(YELLOW "WARNING: this is not a floating-base system\n" COLOR_RESET);
 	}
+	system_.invalidateKinematics();
 
 	// Converting the generalized joint forces to base wrench and joint forces
 	rbd::Vector6d base_wrench;
@@ -135,6 +397,53 @@ void WholeBodyDynamics::computeFloatingBaseInverseDynamics(rbd::Vector6d& base_a
 }
 
 
+void WholeBodyDynamics::computeFloatingBaseInverseDynamics(rbd::Vector6d& base_acc,
+														   Eigen::VectorXd& joint_forces,
+														   const rbd::Vector6d& base_pos,
+														   const Eigen::VectorXd& joint_pos,
+														   const rbd::Vector6d& base_vel,
+														   const Eigen::VectorXd& joint_vel,
+														   const Eigen::VectorXd& joint_acc,
+														   const rbd::BodyContainer6d& ext_force)
+{
+	// Setting the size of the joint forces vector
+	joint_forces.resize(system_.getJointDoF());
+
+	// Converting base and joint states to generalized joint states. Note that
+	// we use the preallocated workspace
+	system_.toGeneralizedJointState(workspace_.q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(workspace_.q_dot, base_vel, joint_vel);
+	system_.toGeneralizedJointState(workspace_.q_ddot, base_acc, joint_acc);
+	workspace_.tau.setZero();
+
+	// Computing the applied external spatial forces for every body
+	convertAppliedExternalForces(workspace_.fext, ext_force, workspace_.q);
+
+	// Computing the inverse dynamics with Recursive Newton-Euler Algorithm (RNEA)
+	RigidBodyDynamics::Math::SpatialVector base_ddot =
+			RigidBodyDynamics::Math::SpatialVector(base_acc);
+	if (system_.isFullyFloatingBase()) {
+		rbd::FloatingBaseInverseDynamics(system_.getRBDModel(),
+										 workspace_.q, workspace_.q_dot,
+										 workspace_.q_ddot, base_ddot,
+										 workspace_.tau, &workspace_.fext);
+		base_acc = base_ddot;
+	} else if (system_.isVirtualFloatingBaseRobot()) {
+		rbd::FloatingBaseInverseDynamics(system_.getRBDModel(), 1,
+										 workspace_.q, workspace_.q_dot,
+										 workspace_.q_ddot, base_ddot,
+										 workspace_.tau, &workspace_.fext);
+		base_acc = base_ddot;
+	} else
+		printf(YELLOW "WARNING: this is not a floating-base system\n" COLOR_RESET);
+	system_.invalidateKinematics();
+
+	// Converting the generalized joint forces to base wrench and joint forces
+	rbd::Vector6d base_wrench;
+	system_.fromGeneralizedJointState(base_wrench, joint_forces, workspace_.tau);
+}
+
+
 void WholeBodyDynamics::computeConstrainedFloatingBaseInverseDynamics(Eigen::VectorXd& joint_forces,
 																	  const rbd::Vector6d& base_pos,
 																	  const Eigen::VectorXd& joint_pos,
@@ -173,28 +482,97 @@ void WholeBodyDynamics::computeConstrainedFloatingBaseInverseDynamics(Eigen::Vec
 }
 
 
+bool WholeBodyDynamics::computeInverseDynamicsDerivatives(Eigen::MatrixXd& dtau_dq,
+														  Eigen::MatrixXd& dtau_dqd,
+														  Eigen::MatrixXd& dtau_dqdd,
+														  const rbd::Vector6d& base_pos,
+														  const Eigen::VectorXd& joint_pos,
+														  const rbd::Vector6d& base_vel,
+														  const Eigen::VectorXd& joint_vel,
+														  const rbd::Vector6d& base_acc,
+														  const Eigen::VectorXd& joint_acc,
+														  const rbd::BodyVector6d& ext_force)
+{
+	// Converting base and joint states to generalized joint states
+	Eigen::VectorXd& q = workspace_.q;
+	Eigen::VectorXd& q_dot = workspace_.q_dot;
+	Eigen::VectorXd& q_ddot = workspace_.q_ddot;
+	system_.toGeneralizedJointState(q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(q_dot, base_vel, joint_vel);
+	system_.toGeneralizedJointState(q_ddot, base_acc, joint_acc);
+	Eigen::VectorXd tau;
+
+	// Computing the applied external spatial forces for every body
+	std::vector<SpatialVector_t> fext;
+	convertAppliedExternalForces(fext, ext_force, q);
+
+	// Computing the derivatives of the Recursive Newton-Euler Algorithm (RNEA),
+	// where the external spatial forces are constant
+	RigidBodyDynamics::Model& model = system_.getRBDModel();
+	if (!rbd::computeInverseDynamicsDerivatives(model, q, q_dot, q_ddot, tau,
+												dtau_dq, dtau_dqd, dtau_dqdd, &fext)) {
+		printf(RED "FATAL: the inverse dynamics derivatives don't support multi-DoF"
+				" joints\n" COLOR_RESET);
+		system_.invalidateKinematics();
+		return false;
+	}
+
+	// Adding the variation of the moment of the external forces, i.e. the
+	// application point moves with the joints. Note that the kinematics was
+	// updated by the derivatives routine
+	for (rbd::BodyVector6d::const_iterator force_it = ext_force.begin();
+			force_it != ext_force.end(); force_it++) {
+		unsigned int body_id = model.GetBodyId(force_it->first.c_str());
+		if (!model.IsBodyId(body_id))
+			continue;
+
+		Eigen::MatrixXd jac = Eigen::MatrixXd::Zero(6, system_.getSystemDoF());
+		rbd::computePointJacobian(model, q, body_id, Eigen::Vector3d::Zero(), jac, false);
+		Eigen::Vector3d force = force_it->second.segment<3>(rbd::LX);
+		dtau_dq.noalias() += jac.topRows<3>().transpose() *
+				math::skewSymmetricMatrixFromVector(force) * jac.bottomRows<3>();
+	}
+	system_.invalidateKinematics();
+
+	// Changing the floating-base rows and columns to the order [Angular, Linear]
+	toFloatingBaseOrder(dtau_dq);
+	toFloatingBaseOrder(dtau_dqd);
+	toFloatingBaseOrder(dtau_dqdd);
+
+	return true;
+}
+
 const Eigen::MatrixXd& WholeBodyDynamics::computeJointSpaceInertiaMatrix(const rbd::Vector6d& base_pos,
 																		 const Eigen::VectorXd& joint_pos)
 {
 	// Converting base and joint states to generalized joint states
-	Eigen::VectorXd q = system_.toGeneralizedJointState(base_pos, joint_pos);
+	Eigen::VectorXd& q = workspace_.q;
+	system_.toGeneralizedJointState(q, base_pos, joint_pos);
 
 	// Computing the joint space inertia matrix using the Composite
-	// Rigid Body Algorithm
-	RigidBodyDynamics::CompositeRigidBodyAlgorithm(system_.getRBDModel(),
-												   q, joint_inertia_mat_, true);
+	// Rigid Body Algorithm, where the generated one doesn't update the model
+	const GeneratedModel* generated = system_.getGeneratedModel();
+	if (generated != NULL) {
+		unsigned int dof = system_.getRBDModel().dof_count;
+		joint_inertia_mat_.resize(dof, dof);
+		generated->computeJointSpaceInertiaMatrix(joint_inertia_mat_.data(), q.data());
+	} else {
+		RigidBodyDynamics::CompositeRigidBodyAlgorithm(system_.getRBDModel(),
+													   q, joint_inertia_mat_, true);
+		system_.invalidateKinematics();
+	}
 
 	// Changing the floating-base inertia matrix component to the order
-	// [Angular, Linear]
+	// [Angular, Linear]. Note that the rows and columns of the coupling
+	// between the base and the joints are reordered as well
 	if (system_.isFullyFloatingBase()) {
-		Eigen::MatrixXd base_lin_mat = joint_inertia_mat_.block<3,6>(0,0);
-		Eigen::MatrixXd base_ang_mat = joint_inertia_mat_.block<3,6>(3,0);
-
-		// Writing the new order
-		joint_inertia_mat_.block<3,6>(rbd::AX, 0) << base_ang_mat.rightCols(3),
-				base_ang_mat.leftCols(3);
-		joint_inertia_mat_.block<3,6>(rbd::LX, 0) << base_lin_mat.rightCols(3),
-				base_lin_mat.leftCols(3);
+		Eigen::MatrixXd base_rows = joint_inertia_mat_.topRows<6>();
+		joint_inertia_mat_.middleRows<3>(rbd::AX) = base_rows.bottomRows<3>();
+		joint_inertia_mat_.middleRows<3>(rbd::LX) = base_rows.topRows<3>();
+
+		Eigen::MatrixXd base_cols = joint_inertia_mat_.leftCols<6>();
+		joint_inertia_mat_.middleCols<3>(rbd::AX) = base_cols.rightCols<3>();
+		joint_inertia_mat_.middleCols<3>(rbd::LX) = base_cols.leftCols<3>();
 	}
 
 	return joint_inertia_mat_;
@@ -218,6 +596,37 @@ const rbd::Matrix6d& WholeBodyDynamics::computeCentroidalInertiaMatrix(const rbd
 }
 
 
+void WholeBodyDynamics::computeCentroidalMomentumMatrix(Eigen::MatrixXd& cmm,
+														rbd::Vector6d& cmm_dot_qd,
+														const rbd::Vector6d& base_pos,
+														const Eigen::VectorXd& joint_pos,
+														const rbd::Vector6d& base_vel,
+														const Eigen::VectorXd& joint_vel)
+{
+	// Converting base and joint states to generalized joint states
+	Eigen::VectorXd& q = workspace_.q;
+	Eigen::VectorXd& q_dot = workspace_.q_dot;
+	system_.toGeneralizedJointState(q, base_pos, joint_pos);
+	system_.toGeneralizedJointState(q_dot, base_vel, joint_vel);
+
+	// Computing the centroidal momentum matrix and its bias term in a single pass
+	RigidBodyDynamics::Math::SpatialVector cmm_dot_qd_rbd;
+	Eigen::Vector3d com_pos;
+	rbd::computeCentroidalMomentumMatrix(system_.getRBDModel(), q, q_dot,
+										 cmm, cmm_dot_qd_rbd, com_pos);
+	system_.invalidateKinematics();
+	cmm_dot_qd = cmm_dot_qd_rbd;
+
+	// Changing the floating-base columns to the order [Angular, Linear] as in
+	// the joint-space inertia matrix
+	if (system_.isFullyFloatingBase()) {
+		Eigen::Matrix<double,6,6> base_cols = cmm.leftCols<6>();
+		cmm.middleCols<3>(rbd::AX) = base_cols.rightCols<3>();
+		cmm.middleCols<3>(rbd::LX) = base_cols.leftCols<3>();
+	}
+}
+
+
 const rbd::Vector6d& WholeBodyDynamics::computeGravitoWrench(const Eigen::Vector3d& com_pos)
 {
 	// Computing the weight vector
@@ -234,6 +643,20 @@ const rbd::Vector6d& WholeBodyDynamics::computeGravitoWrench(const Eigen::Vector
 }
 
 
+void WholeBodyDynamics::setFrictionConeDistribution(bool active,
+													double friction_coeff,
+													double regularization)
+{
+	friction_distribution_ = active;
+	friction_coeff_ = friction_coeff;
+	force_regularization_ = regularization;
+
+	// The friction cones have to be built again
+	friction_cone_mat_.resize(0,0);
+	force_qp_.reset();
+}
+
+
 void WholeBodyDynamics::computeContactForces(rbd::BodyVector6d& contact_forces,
 											 Eigen::VectorXd& joint_forces,
 											 const rbd::Vector6d& base_pos,
@@ -247,13 +670,15 @@ void WholeBodyDynamics::computeContactForces(rbd::BodyVector6d& contact_forces,
 	// Setting the size of the joint forces vector
 	joint_forces.resize(system_.getJointDoF());
 
-	// Computing the fixed-base jacobian and base contact jacobian. These
-	// jacobians are used for computing a consistent joint acceleration, and
-	// for mapping desired base wrench to joint forces
+	// Computing the stacked contact jacobian and J_d*q_d vector in a single
+	// kinematics update. These are used for computing a consistent joint
+	// acceleration, and for mapping desired base wrench to joint forces
 	Eigen::MatrixXd full_jac;
-	kinematics_.computeJacobian(full_jac,
-								base_pos, joint_pos,
-								contacts, rbd::Linear);
+	Eigen::VectorXd jacd_qd;
+	kinematics_.computeContactJacobian(full_jac, jacd_qd,
+									   base_pos, joint_pos,
+									   base_vel, joint_vel,
+									   contacts);
 
 	// Computing the consistent joint accelerations given a desired base
 	// acceleration and contact definition. We assume that contacts are static,
@@ -264,7 +689,7 @@ void WholeBodyDynamics::computeContactForces(rbd::BodyVector6d& contact_forces,
 											 base_pos, joint_pos,
 											 base_vel, joint_vel,
 											 base_acc, joint_acc,
-											 contacts);
+											 contacts, full_jac, jacd_qd);
 
 	// Computing the desired base wrench assuming a fully actuation on the
 	// floating-base
@@ -312,8 +737,10 @@ void WholeBodyDynamics::computeContactForces(rbd::BodyVector6d& contact_forces,
 
 			// Computing the external forces from the augmented forces
 			// [contact forces; base constraint forces]
-			Eigen::VectorXd augmented_forces =
-					math::pseudoInverse((Eigen::MatrixXd) augmented_jac.transpose()) * base_wrench;
+			Eigen::VectorXd augmented_forces;
+			distributeContactForces(augmented_forces,
+									augmented_jac.transpose(), base_wrench,
+									contacts.size());
 
 			// Adding the base reaction forces in the set of external forces
 			contact_forces[system_.getRBDModel().GetBodyName(6)] =
@@ -327,8 +754,10 @@ void WholeBodyDynamics::computeContactForces(rbd::BodyVector6d& contact_forces,
 			// This is a floating-base without physical constraints. So, we
 			// don't need to augment the jacobian
 			// Computing the external forces from contact forces
-			Eigen::VectorXd endeffector_forces =
-					math::pseudoInverse((Eigen::MatrixXd) base_contact_jac.transpose()) * base_wrench;
+			Eigen::VectorXd endeffector_forces;
+			distributeContactForces(endeffector_forces,
+									base_contact_jac.transpose(), base_wrench,
+									contacts.size());
 
 			// Adding the contact forces in the set of external forces
 			unsigned int num_active_contacts = contacts.size();
@@ -352,8 +781,10 @@ void WholeBodyDynamics::computeContactForces(rbd::BodyVector6d& contact_forces,
 		// in the case of n dof floating-base, where n is less than 6. Note
 		// that we describe this floating-base as an under-actuated virtual
 		// floating-base joints
-		Eigen::VectorXd endeffector_forces =
-				math::pseudoInverse((Eigen::MatrixXd) base_contact_jac.transpose()) * virtual_base_wrench;
+		Eigen::VectorXd endeffector_forces;
+		distributeContactForces(endeffector_forces,
+								base_contact_jac.transpose(), virtual_base_wrench,
+								contacts.size());
 
 		// Adding the contact forces in the set of external forces
 		unsigned int num_active_contacts = contacts.size();
@@ -363,6 +794,66 @@ void WholeBodyDynamics::computeContactForces(rbd::BodyVector6d& contact_forces,
 }
 
 
+void WholeBodyDynamics::distributeContactForces(Eigen::VectorXd& forces,
+												const Eigen::MatrixXd& force_map,
+												const Eigen::VectorXd& wrench,
+												unsigned int num_contacts,
+												bool only_normal)
+{
+	if (!friction_distribution_) {
+		math::dampedLeastSquares(forces, force_map, wrench);
+		return;
+	}
+
+	// Building the unilateral and friction-pyramid constraints of the contact forces, i.e.
+	// f_z >= 0 and |f_x|, |f_y| <= mu f_z / sqrt(2). Note that they only change with the
+	// number of contacts
+	unsigned int num_variables = force_map.cols();
+	unsigned int contact_dim = only_normal ? 1 : 3;
+	unsigned int cone_dim = only_normal ? 1 : 5;
+	if (contact_dim * num_contacts > num_variables) {
+		printf(YELLOW "Warning: the forces are not consistent with the number of contacts\n"
+				COLOR_RESET);
+		math::dampedLeastSquares(forces, force_map, wrench);
+		return;
+	}
+	if ((unsigned int) friction_cone_mat_.rows() != cone_dim * num_contacts ||
+			(unsigned int) friction_cone_mat_.cols() != num_variables) {
+		friction_cone_mat_.setZero(cone_dim * num_contacts, num_variables);
+		double mu = friction_coeff_ / sqrt(2.);
+		for (unsigned int i = 0; i < num_contacts; i++) {
+			if (only_normal)
+				friction_cone_mat_(i,i) = 1.;
+			else {
+				friction_cone_mat_.block<5,3>(5 * i, 3 * i) << 0., 0., 1.,
+															  -1., 0., mu,
+															   1., 0., mu,
+															   0., -1., mu,
+															   0., 1., mu;
+			}
+		}
+		force_qp_.reset();
+	}
+
+	// Solving min |M f - w|^2 + eps |f|^2, where the last solution is a feasible warm-start
+	// because the constraints are homogeneous
+	Eigen::MatrixXd hessian = force_map.transpose() * force_map;
+	hessian.diagonal().array() += force_regularization_;
+	Eigen::VectorXd gradient = -force_map.transpose() * wrench;
+	Eigen::VectorXd starting_point = force_qp_.getOptimalSolution();
+	if ((unsigned int) starting_point.size() != num_variables)
+		starting_point = Eigen::VectorXd::Zero(num_variables);
+	if (!force_qp_.compute(hessian, gradient,
+						   friction_cone_mat_, Eigen::VectorXd::Zero(cone_dim * num_contacts),
+						   starting_point)) {
+		printf(YELLOW "Warning: the friction-cone distribution hasn't converged, so the last"
+				" iterate is used\n" COLOR_RESET);
+		force_qp_.reset();
+	}
+	forces = force_qp_.getOptimalSolution();
+}
+
+
 void WholeBodyDynamics::estimateContactForces(rbd::BodyVector6d& contact_forces,
 											 const rbd::Vector6d& base_pos,
 											 const Eigen::VectorXd& joint_pos,
@@ -385,22 +876,33 @@ void WholeBodyDynamics::estimateContactForces(rbd::BodyVector6d& contact_forces,
 	// Computing the joint force error
 	Eigen::VectorXd joint_force_error = estimated_joint_forces - joint_forces;
 
+	// Computing the stacked fixed-base jacobian of the contacts (w.r.t. the
+	// base frame) in a single kinematics update
+	Eigen::MatrixXd fixed_jac;
+	kinematics_.computeContactJacobian(fixed_jac,
+									   rbd::Vector6d::Zero(), joint_pos,
+									   contacts, true);
+
 	// Computing the contact forces
+	unsigned int base_dof = system_.getSystemDoF() - system_.getJointDoF();
+	unsigned int init_row = 0;
 	for (rbd::BodySelector::const_iterator contact_iter = contacts.begin();
 			contact_iter != contacts.end();
 			contact_iter++)
 	{
 		std::string body_name = *contact_iter;
-		rbd::BodySelector body(contact_iter, contact_iter + 1);
+		if (body_id_.count(body_name) == 0)
+			continue;
 
-		Eigen::MatrixXd fixed_jac;
-		kinematics_.computeFixedJacobian(fixed_jac,
-										 joint_pos,
-										 body_name, rbd::Linear);
+		unsigned int q_index, num_dof;
+		system_.getBranch(q_index, num_dof, body_name);
+		Eigen::MatrixXd branch_jac =
+				fixed_jac.block(init_row, q_index - base_dof, 3, num_dof);
+		init_row += 3;
 
-		Eigen::Vector3d force =
-				math::pseudoInverse((Eigen::MatrixXd) fixed_jac.transpose()) *
-				system_.getBranchState(joint_force_error, body_name);
+		Eigen::Vector3d force;
+		math::dampedLeastSquares(force, branch_jac.transpose(),
+								 system_.getBranchState(joint_force_error, body_name));
 
 		contact_forces[body_name] << 0, 0, 0, force;
 	}
@@ -611,7 +1113,8 @@ void WholeBodyDynamics::estimateGroundReactionForces(rbd::BodyVector6d& contact_
 
 	// Computing the normal contact forces
 	double weight = system_.getTotalMass() * system_.getGravityAcceleration();
-	Eigen::VectorXd norm_for = math::pseudoInverse(contact_mat) * cop_pos * weight;
+	Eigen::VectorXd norm_for;
+	distributeContactForces(norm_for, contact_mat, cop_pos * weight, num_contacts, true);
 
 	// Filling the contact forces vector
 	idx = 0;
@@ -680,12 +1183,24 @@ const FloatingBaseSystem& WholeBodyDynamics::getFloatingBaseSystem() const
 }
 
 
+FloatingBaseSystem& WholeBodyDynamics::getFloatingBaseSystem()
+{
+	return system_;
+}
+
+
 const WholeBodyKinematics& WholeBodyDynamics::getWholeBodyKinematics() const
 {
 	return kinematics_;
 }
 
 
+WholeBodyKinematics& WholeBodyDynamics::getWholeBodyKinematics()
+{
+	return kinematics_;
+}
+
+
 void WholeBodyDynamics::getActiveContacts(rbd::BodySelector& active_contacts,
 										  const rbd::BodyVector6d& contact_forces,
 										  double force_threshold)
@@ -702,11 +1217,26 @@ void WholeBodyDynamics::getActiveContacts(rbd::BodySelector& active_contacts,
 }
 
 
+void WholeBodyDynamics::toFloatingBaseOrder(Eigen::MatrixXd& mat)
+{
+	if (system_.isFullyFloatingBase()) {
+		Eigen::Matrix<double,6,Eigen::Dynamic> base_rows = mat.topRows<6>();
+		mat.middleRows<3>(rbd::AX) = base_rows.bottomRows<3>();
+		mat.middleRows<3>(rbd::LX) = base_rows.topRows<3>();
+
+		Eigen::Matrix<double,Eigen::Dynamic,6> base_cols = mat.leftCols<6>();
+		mat.middleCols<3>(rbd::AX) = base_cols.rightCols<3>();
+		mat.middleCols<3>(rbd::LX) = base_cols.leftCols<3>();
+	}
+}
+
 void WholeBodyDynamics::convertAppliedExternalForces(std::vector<RigidBodyDynamics::Math::SpatialVector>& fext,
 													 const rbd::BodyVector6d& ext_force,
 													 const Eigen::VectorXd& q)
 {
-	// Computing the applied external spatial forces for every body
+	// Computing the applied external spatial forces for every body. Note that the
+	// kinematics is updated only if the state changed
+	system_.updateKinematics(q);
 	fext.resize(system_.getRBDModel().mBodies.size());
 	// Searching over the movable bodies
 	for (unsigned int body_id = 0;
@@ -720,7 +1250,7 @@ void WholeBodyDynamics::convertAppliedExternalForces(std::vector<RigidBodyDynami
 			Eigen::Vector3d force_point =
 					CalcBodyToBaseCoordinates(system_.getRBDModel(),
 											  q, body_id,
-											  Eigen::Vector3d::Zero(), true);
+											  Eigen::Vector3d::Zero(), false);
 			rbd::Vector6d spatial_force =
 					rbd::convertPointForceToSpatialForce(force, force_point);
 
@@ -741,7 +1271,7 @@ void WholeBodyDynamics::convertAppliedExternalForces(std::vector<RigidBodyDynami
 			Eigen::Vector3d force_point =
 					CalcBodyToBaseCoordinates(system_.getRBDModel(),
 											  q, body_id,
-											  Eigen::Vector3d::Zero(), true);
+											  Eigen::Vector3d::Zero(), false);
 			rbd::Vector6d spatial_force =
 					rbd::convertPointForceToSpatialForce(force, force_point);
 
@@ -752,6 +1282,60 @@ void WholeBodyDynamics::convertAppliedExternalForces(std::vector<RigidBodyDynami
 }
 
 
+void WholeBodyDynamics::convertAppliedExternalForces(std::vector<RigidBodyDynamics::Math::SpatialVector>& fext,
+													 const rbd::BodyContainer6d& ext_force,
+													 const Eigen::VectorXd& q)
+{
+	// Mapping the container as the stacked wrenches of the end-effectors. Note that its
+	// values are contiguous
+	Eigen::Map<const Eigen::Matrix<double,6,Eigen::Dynamic> >
+	ext_force_mat(ext_force.size() > 0 ? ext_force.getData()[0].data() : NULL,
+				  6, ext_force.size());
+	convertAppliedExternalForces(fext, ext_force_mat, q);
+}
+
+
+void WholeBodyDynamics::convertAppliedExternalForces(std::vector<RigidBodyDynamics::Math::SpatialVector>& fext,
+													 const Eigen::Ref<const Eigen::Matrix<double,6,Eigen::Dynamic> >& ext_force,
+													 const Eigen::VectorXd& q)
+{
+	RigidBodyDynamics::Model& model = system_.getRBDModel();
+
+	// Computing the applied external spatial forces for every body. Note
+	// that it doesn't allocate memory if it was sized before
+	fext.resize(model.mBodies.size());
+	for (unsigned int body_id = 0; body_id < model.mBodies.size(); body_id++)
+		fext[body_id].setZero();
+
+	// Updating the kinematics once, and then searching over the end-effectors.
+	// Note that the columns are ordered as the end-effector names
+	const std::vector<unsigned int>& body_ids = system_.getEndEffectorBodyIds();
+	assert((unsigned int) ext_force.cols() == body_ids.size());
+	system_.updateKinematics(q);
+	for (unsigned int i = 0; i < body_ids.size(); i++) {
+		unsigned int body_id = body_ids[i];
+		if (!model.IsBodyId(body_id))
+			continue;
+
+		// Converting the applied force to spatial force vector in base
+		// coordinates
+		rbd::Vector6d force = ext_force.col(i);
+		Eigen::Vector3d force_point =
+				CalcBodyToBaseCoordinates(model, q, body_id,
+										  Eigen::Vector3d::Zero(), false);
+		rbd::Vector6d spatial_force =
+				rbd::convertPointForceToSpatialForce(force, force_point);
+
+		// Fixed bodies apply their forces to the movable parent
+		if (model.IsFixedBodyId(body_id)) {
+			unsigned int fixed_id = body_id - model.fixed_body_discriminator;
+			fext[model.mFixedBodies[fixed_id].mMovableParent] += spatial_force;
+		} else
+			fext[body_id] += spatial_force;
+	}
+}
+
+
 void WholeBodyDynamics::computeConstrainedConsistentAcceleration(rbd::Vector6d& base_feas_acc,
 																 Eigen::VectorXd& joint_feas_acc,
 																 const rbd::Vector6d& base_pos,
@@ -761,6 +1345,35 @@ void WholeBodyDynamics::computeConstrainedConsistentAcceleration(rbd::Vector6d&
 																 const rbd::Vector6d& base_acc,
 																 const Eigen::VectorXd& joint_acc,
 																 const rbd::BodySelector& contacts)
+{
+	// Computing the stacked contact jacobian and J_d*q_d vector in a single
+	// kinematics update
+	Eigen::MatrixXd full_jac;
+	Eigen::VectorXd jacd_qd;
+	kinematics_.computeContactJacobian(full_jac, jacd_qd,
+									   base_pos, joint_pos,
+									   base_vel, joint_vel,
+									   contacts);
+
+	computeConstrainedConsistentAcceleration(base_feas_acc, joint_feas_acc,
+											 base_pos, joint_pos,
+											 base_vel, joint_vel,
+											 base_acc, joint_acc,
+											 contacts, full_jac, jacd_qd);
+}
+
+
+void WholeBodyDynamics::computeConstrainedConsistentAcceleration(rbd::Vector6d& base_feas_acc,
+																 Eigen::VectorXd& joint_feas_acc,
+																 const rbd::Vector6d& base_pos,
+																 const Eigen::VectorXd& joint_pos,
+																 const rbd::Vector6d& base_vel,
+																 const Eigen::VectorXd& joint_vel,
+																 const rbd::Vector6d& base_acc,
+																 const Eigen::VectorXd& joint_acc,
+																 const rbd::BodySelector& contacts,
+																 const Eigen::MatrixXd& contact_jac,
+																 const Eigen::VectorXd& jacd_qd)
 {
 	// Computing the consistent joint accelerations given a desired base
 	// acceleration and contact definition. We assume that contacts are static,
@@ -778,18 +1391,15 @@ void WholeBodyDynamics::computeConstrainedConsistentAcceleration(rbd::Vector6d&
 	Eigen::Vector3d base_ang_acc = rbd::angularPart(base_des_acc);
 	Eigen::Vector3d base_lin_acc = rbd::linearPart(base_des_acc);
 
-	// Computing contact linear positions and the J_d*q_d component, which
-	// are used for computing the joint accelerations
-	rbd::BodyVectorXd op_pos, jacd_qd;
+	// Computing contact linear positions, which are used for computing the
+	// joint accelerations. Note that the kinematics is already updated
+	rbd::BodyVectorXd op_pos;
 	kinematics_.computeForwardKinematics(op_pos,
 										 base_pos, joint_pos,
 										 contacts, rbd::Linear);
-	kinematics_.computeJdotQdot(jacd_qd,
-								base_pos, joint_pos,
-								base_vel, joint_vel,
-								contacts, rbd::Linear);
 
 	// Computing the consistent joint acceleration given a base state
+	unsigned int init_row = 0;
 	for (rbd::BodySelector::const_iterator contact_iter = contacts.begin();
 			contact_iter != contacts.end();
 			contact_iter++)
@@ -805,16 +1415,17 @@ void WholeBodyDynamics::computeConstrainedConsistentAcceleration(rbd::Vector6d&
 					-base_lin_acc - base_ang_acc.cross(contact_pos) -
 					base_ang_vel.cross(contact_pos) - 2 * base_ang_vel.cross(contact_vel);
 
-			// Computing the fixed-base jacobian
-			Eigen::MatrixXd fixed_jac;
-			kinematics_.computeFixedJacobian(fixed_jac,
-											 joint_pos,
-											 contact_name, rbd::Linear);
+			// Getting the branch of the contact jacobian, which is expressed
+			// in the same frame than J_d*q_d
+			unsigned int q_index, num_dof;
+			system_.getBranch(q_index, num_dof, contact_name);
+			Eigen::MatrixXd fixed_jac = contact_jac.block(init_row, q_index, 3, num_dof);
 
 			// Computing the join acceleration from x_dd = J*q_dd + J_d*q_d
-			// since we are doing computation in the base frame
-			Eigen::VectorXd q_dd =
-					math::pseudoInverse(fixed_jac) * (contact_acc - jacd_qd[contact_name]);
+			Eigen::VectorXd q_dd;
+			math::dampedLeastSquares(q_dd, fixed_jac,
+									 contact_acc - jacd_qd.segment<3>(init_row));
+			init_row += 3;
 
 			// Setting up the branch joint acceleration
 			system_.setBranchState(joint_feas_acc, q_dd, contact_name);
@@ -3,6 +3,9 @@
 
 #include <dwl/model/WholeBodyKinematics.h>
 #include <dwl/model/FloatingBaseSystem.h>
+#include <dwl/WholeBodyState.h>
+#include <dwl/FixedWholeBodyState.h>
+#include <dwl/solver/ActiveSetQP.h>
 #include <dwl/utils/utils.h>
 
 
@@ -12,6 +15,31 @@ namespace dwl
 namespace model
 {
 
+/**
+ * @brief Defines the preallocated workspace used by the allocation-free
+ * (real-time) routines. It's sized when the model is built, i.e. in
+ * modelFromURDFFile or modelFromURDFModel
+ */
+struct DynamicsWorkspace
+{
+	/**
+	 * @brief Resizes the workspace
+	 * @param unsigned int Number of DoF of the floating-base system
+	 * @param unsigned int Number of bodies of the RBDL model
+	 */
+	void resize(unsigned int num_dof,
+				unsigned int num_bodies);
+
+	/** @brief Generalized joint states and forces */
+	Eigen::VectorXd q;
+	Eigen::VectorXd q_dot;
+	Eigen::VectorXd q_ddot;
+	Eigen::VectorXd tau;
+
+	/** @brief Applied external forces in RBDL format */
+	std::vector<RigidBodyDynamics::Math::SpatialVector> fext;
+};
+
 /**
  * @class WholeBodyDynamics
  * @brief WholeBodyDynamics class implements the dynamics methods for a
@@ -79,6 +107,153 @@ class WholeBodyDynamics
 									const Eigen::VectorXd& joint_acc,
 									const rbd::BodyVector6d& ext_force = rbd::BodyVector6d());
 
+		/**
+		 * @brief Computes the whole-body inverse dynamics, where the external
+		 * forces are described by an end-effector container, i.e. indexed as
+		 * the end-effector names of the floating-base system. This avoids
+		 * the string comparisons of the body maps. Additionally, this routine
+		 * uses a preallocated workspace, and it doesn't allocate heap memory
+		 * (i.e. it can be called from a real-time thread) as long as the
+		 * joint forces vector has the joint dimension
+		 * @param rbd::Vector6d& Base wrench
+		 * @param Eigen::VectorXd& Joint forces
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const rbd::Vector6d& Base acceleration with respect to a
+		 * gravity field
+		 * @param const Eigen::VectorXd& Joint acceleration
+		 * @param const rbd::BodyContainer6d& External force applied to the
+		 * end-effectors of the robot
+		 */
+		void computeInverseDynamics(rbd::Vector6d& base_wrench,
+									Eigen::VectorXd& joint_forces,
+									const rbd::Vector6d& base_pos,
+									const Eigen::VectorXd& joint_pos,
+									const rbd::Vector6d& base_vel,
+									const Eigen::VectorXd& joint_vel,
+									const rbd::Vector6d& base_acc,
+									const Eigen::VectorXd& joint_acc,
+									const rbd::BodyContainer6d& ext_force);
+
+		/**
+		 * @brief Computes the inverse dynamics of the branch of an end-effector without
+		 * external forces (e.g. a swing leg), i.e. the joint forces of the branch. The RNEA
+		 * traverses only the chain from the base and the subtree of the branch, and it
+		 * uses the preallocated workspace
+		 * @param Eigen::VectorXd& Branch joint forces
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const rbd::Vector6d& Base acceleration with respect to a
+		 * gravity field
+		 * @param const Eigen::VectorXd& Joint acceleration
+		 * @param unsigned int Index of the end-effector
+		 */
+		void computeBranchInverseDynamics(Eigen::VectorXd& branch_forces,
+										  const rbd::Vector6d& base_pos,
+										  const Eigen::VectorXd& joint_pos,
+										  const rbd::Vector6d& base_vel,
+										  const Eigen::VectorXd& joint_vel,
+										  const rbd::Vector6d& base_acc,
+										  const Eigen::VectorXd& joint_acc,
+										  unsigned int end_effector);
+
+		/**
+		 * @brief Computes the whole-body inverse dynamics of a fixed-size state, where the
+		 * number of joints and contacts are known at compile time. The contacts of the state
+		 * are the end-effectors of the floating-base system (in the order of their names),
+		 * and their wrenches are the external forces. The generalized states are written
+		 * directly in the preallocated workspace, so it doesn't allocate heap memory. Note
+		 * that it's only defined for fully floating-base systems
+		 * @param rbd::Vector6d& Base wrench
+		 * @param Eigen::Matrix<double,JointDoF,1>& Joint forces
+		 * @param const FixedWholeBodyState<JointDoF,NumContacts>& Whole-body state
+		 */
+		template<int JointDoF, int NumContacts>
+		void computeInverseDynamics(rbd::Vector6d& base_wrench,
+									Eigen::Matrix<double,JointDoF,1>& joint_forces,
+									const FixedWholeBodyState<JointDoF,NumContacts>& state);
+
+		/**
+		 * @brief Computes the whole-body inverse dynamics of a trajectory,
+		 * i.e. for every whole-body state (knot) in one call. It uses the
+		 * position, velocity, acceleration and contact forces of each state.
+		 * The knots are split in contiguous chunks that are evaluated in
+		 * parallel, where each thread uses its own copy of the dynamic model
+		 * (RBDL modifies its internal buffers). The calling thread evaluates
+		 * the first chunk with this model, so there isn't copy of the model
+		 * for a single thread
+		 * @param std::vector<rbd::Vector6d>& Base wrench per knot
+		 * @param std::vector<Eigen::VectorXd>& Joint forces per knot
+		 * @param const WholeBodyTrajectory& Whole-body trajectory
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 */
+		void computeInverseDynamics(std::vector<rbd::Vector6d>& base_wrench,
+									std::vector<Eigen::VectorXd>& joint_forces,
+									const WholeBodyTrajectory& trajectory,
+									unsigned int num_threads = 1);
+
+		/**
+		 * @brief Computes the whole-body inverse dynamics of a batch of states,
+		 * where every column of the matrices is a state, i.e. the memory layout
+		 * of a C-ordered NumPy array [N x n]. The external forces of a state are
+		 * the stacked wrenches of the end-effectors, in the order of the
+		 * end-effector names of the floating-base system, and an empty matrix
+		 * means without external forces. The states are evaluated in parallel
+		 * as the trajectory version of this routine
+		 * @param Eigen::MatrixXd& Base wrench per state [6 x N]
+		 * @param Eigen::MatrixXd& Joint forces per state [n x N]
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Base position per state
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Joint position per state
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Base velocity per state
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Joint velocity per state
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Base acceleration per
+		 * state with respect to a gravity field
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Joint acceleration per state
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& External forces per
+		 * state [6E x N] or empty
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 */
+		void computeInverseDynamics(Eigen::MatrixXd& base_wrench,
+									Eigen::MatrixXd& joint_forces,
+									const Eigen::Ref<const Eigen::MatrixXd>& base_pos,
+									const Eigen::Ref<const Eigen::MatrixXd>& joint_pos,
+									const Eigen::Ref<const Eigen::MatrixXd>& base_vel,
+									const Eigen::Ref<const Eigen::MatrixXd>& joint_vel,
+									const Eigen::Ref<const Eigen::MatrixXd>& base_acc,
+									const Eigen::Ref<const Eigen::MatrixXd>& joint_acc,
+									const Eigen::Ref<const Eigen::MatrixXd>& ext_force,
+									unsigned int num_threads = 1);
+
+		/**
+		 * @brief Computes the whole-body forward dynamics using the
+		 * Articulated Body Algorithm (ABA), where the floating-base is
+		 * unactuated. The external forces are described by an end-effector
+		 * container as in the allocation-free inverse dynamics, and they are
+		 * applied in the origin of the end-effector bodies
+		 * @param rbd::Vector6d& Base acceleration with respect to a gravity
+		 * field
+		 * @param Eigen::VectorXd& Joint acceleration
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const Eigen::VectorXd& Joint forces
+		 * @param const rbd::BodyContainer6d& External force applied to the
+		 * end-effectors of the robot
+		 */
+		void computeForwardDynamics(rbd::Vector6d& base_acc,
+									Eigen::VectorXd& joint_acc,
+									const rbd::Vector6d& base_pos,
+									const Eigen::VectorXd& joint_pos,
+									const rbd::Vector6d& base_vel,
+									const Eigen::VectorXd& joint_vel,
+									const Eigen::VectorXd& joint_forces,
+									const rbd::BodyContainer6d& ext_force);
+
 		/**
 		 * @brief Computes the whole-body inverse dynamics using the Recursive
 		 * Newton-Euler Algorithm (RNEA) for a floating-base robot
@@ -109,6 +284,30 @@ class WholeBodyDynamics
 												const Eigen::VectorXd& joint_acc,
 												const rbd::BodyVector6d& ext_force = rbd::BodyVector6d());
 
+		/**
+		 * @brief Computes the floating-base inverse dynamics, where the
+		 * external forces are described by an end-effector container. This
+		 * routine uses a preallocated workspace, and it doesn't allocate heap
+		 * memory for fully floating-base systems
+		 * @param rbd::Vector6d& Base acceleration with respect to a gravity field
+		 * @param Eigen::VectorXd& Joint forces
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const Eigen::VectorXd& Joint acceleration
+		 * @param const rbd::BodyContainer6d& External force applied to the
+		 * end-effectors of the robot
+		 */
+		void computeFloatingBaseInverseDynamics(rbd::Vector6d& base_acc,
+												Eigen::VectorXd& joint_forces,
+												const rbd::Vector6d& base_pos,
+												const Eigen::VectorXd& joint_pos,
+												const rbd::Vector6d& base_vel,
+												const Eigen::VectorXd& joint_vel,
+												const Eigen::VectorXd& joint_acc,
+												const rbd::BodyContainer6d& ext_force);
+
 		/**
 		 * @brief Computes the constrained whole-body inverse dynamics using
 		 * the Recursive Newton-Euler Algorithm (RNEA). Constrained are defined
@@ -139,6 +338,39 @@ class WholeBodyDynamics
 														   const Eigen::VectorXd& joint_acc,
 														   const rbd::BodySelector& contacts);
 
+		/**
+		 * @brief Computes the analytical partial derivatives of the whole-body
+		 * inverse dynamics with respect to the generalized position, velocity
+		 * and acceleration, i.e. dtau/dq, dtau/dqd and dtau/dqdd (the joint-space
+		 * inertia matrix). The rows and columns follow the generalized order of
+		 * the joint-space inertia matrix, i.e. [base, joints]. The external
+		 * forces are expressed in the world frame and applied at the origin of
+		 * their bodies, so their moment changes with the position of the bodies
+		 * @param Eigen::MatrixXd& Derivative with respect to the position
+		 * @param Eigen::MatrixXd& Derivative with respect to the velocity
+		 * @param Eigen::MatrixXd& Derivative with respect to the acceleration
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const rbd::Vector6d& Base acceleration with respect to a
+		 * gravity field
+		 * @param const Eigen::VectorXd& Joint acceleration
+		 * @param const rbd::BodyVector6d& External force applied to a certain
+		 * body of the robot
+		 * @return False if the rigid-body model has multi-DoF joints
+		 */
+		bool computeInverseDynamicsDerivatives(Eigen::MatrixXd& dtau_dq,
+											   Eigen::MatrixXd& dtau_dqd,
+											   Eigen::MatrixXd& dtau_dqdd,
+											   const rbd::Vector6d& base_pos,
+											   const Eigen::VectorXd& joint_pos,
+											   const rbd::Vector6d& base_vel,
+											   const Eigen::VectorXd& joint_vel,
+											   const rbd::Vector6d& base_acc,
+											   const Eigen::VectorXd& joint_acc,
+											   const rbd::BodyVector6d& ext_force = rbd::BodyVector6d());
+
 		/**
 		 * @brief Computes the joint-space inertia matrix by using the
 		 * Composite Rigid Body Algorithm
@@ -158,6 +390,27 @@ class WholeBodyDynamics
 		const rbd::Matrix6d& computeCentroidalInertiaMatrix(const rbd::Vector6d& base_pos,
 															const Eigen::VectorXd& joint_pos);
 
+		/**
+		 * @brief Computes the centroidal momentum matrix (CMM) and its bias term
+		 * (dCMM * qd) with the Centroidal Composite Rigid Body Algorithm, i.e. in a
+		 * single pass over the bodies. The centroidal momentum h = CMM * qd and its
+		 * rate hd = CMM * qdd + dCMM * qd are expressed at the CoM, parallel to the
+		 * world frame, with the order [angular, linear]. The columns follow the
+		 * generalized order of the joint-space inertia matrix, i.e. [base, joints]
+		 * @param Eigen::MatrixXd& Centroidal momentum matrix
+		 * @param rbd::Vector6d& Bias term of the rate of centroidal momentum
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 */
+		void computeCentroidalMomentumMatrix(Eigen::MatrixXd& cmm,
+											 rbd::Vector6d& cmm_dot_qd,
+											 const rbd::Vector6d& base_pos,
+											 const Eigen::VectorXd& joint_pos,
+											 const rbd::Vector6d& base_vel,
+											 const Eigen::VectorXd& joint_vel);
+
 		/**
 		 * @brief Computes the gravitational wrench in the CoM position
 		 * @param const Eigen::Vector3d& CoM position expressed in the world frame
@@ -184,6 +437,20 @@ class WholeBodyDynamics
 		 * @param const rbd::BodySelector& Bodies that are constrained to be
 		 * in contact
 		 */
+		/**
+		 * @brief Sets the friction-cone distribution of the contact forces. If it's enabled,
+		 * computeContactForces and estimateGroundReactionForces distribute the forces with a QP
+		 * that imposes the unilateral constraints and the linearized (inner) friction pyramids,
+		 * instead of the pseudo-inverse. The QP is warm-started from the last solution. Note
+		 * that the contact normals are aligned with the z-axis of the world frame
+		 * @param bool True for enabling the friction-cone distribution
+		 * @param double Friction coefficient
+		 * @param double Regularization of the contact forces
+		 */
+		void setFrictionConeDistribution(bool active,
+										 double friction_coeff = 0.7,
+										 double regularization = 1e-6);
+
 		void computeContactForces(rbd::BodyVector6d& contact_forces,
 								  Eigen::VectorXd& joint_forces,
 								  const rbd::Vector6d& base_pos,
@@ -351,9 +618,22 @@ class WholeBodyDynamics
 		/** @brief Gets the floating-base system information */
 		const FloatingBaseSystem& getFloatingBaseSystem() const;
 
+		/**
+		 * @brief Gets the floating-base system information used by the dynamics
+		 * routines, e.g. for the branch queries of estimators built on top of them
+		 */
+		FloatingBaseSystem& getFloatingBaseSystem();
+
 		/** @brief Gets the whole-body kinematics */
 		const WholeBodyKinematics& getWholeBodyKinematics() const;
 
+		/**
+		 * @brief Gets the whole-body kinematics used by the estimation routines. The kinematic
+		 * queries of this instance share its cached kinematics state, so a sequence of
+		 * queries and contact estimations at the same state updates the model only once
+		 */
+		WholeBodyKinematics& getWholeBodyKinematics();
+
 		/**
 		 * @brief Detects the active contacts
 		 * @param rbd::BodySelector& Detected active contacts
@@ -366,6 +646,13 @@ class WholeBodyDynamics
 
 
 	private:
+		/**
+		 * @brief Changes the floating-base rows and columns of a generalized
+		 * matrix from the RBDL order [Linear, Angular] to [Angular, Linear]
+		 * @param Eigen::MatrixXd& Generalized matrix
+		 */
+		void toFloatingBaseOrder(Eigen::MatrixXd& mat);
+
 		/**
 		 * @brief Converts the applied external forces to RBDL format
 		 * @param std::vector<RigidBodyDynamcis::Math::SpatialVector>& RBDL
@@ -376,6 +663,12 @@ class WholeBodyDynamics
 		void convertAppliedExternalForces(std::vector<RigidBodyDynamics::Math::SpatialVector>& f_ext,
 										  const rbd::BodyVector6d& ext_force,
 										  const Eigen::VectorXd& generalized_joint_pos);
+		void convertAppliedExternalForces(std::vector<RigidBodyDynamics::Math::SpatialVector>& f_ext,
+										  const rbd::BodyContainer6d& ext_force,
+										  const Eigen::VectorXd& generalized_joint_pos);
+		void convertAppliedExternalForces(std::vector<RigidBodyDynamics::Math::SpatialVector>& f_ext,
+										  const Eigen::Ref<const Eigen::Matrix<double,6,Eigen::Dynamic> >& ext_force,
+										  const Eigen::VectorXd& generalized_joint_pos);
 
 		/**
 		 * @brief Computes a consistent acceleration for a defined constrained
@@ -402,6 +695,52 @@ class WholeBodyDynamics
 													  const Eigen::VectorXd& joint_acc,
 													  const rbd::BodySelector& contacts);
 
+		/**
+		 * @brief Computes a consistent acceleration for a defined constrained
+		 * contact from a precomputed stacked contact jacobian and J_d*q_d
+		 * vector (see WholeBodyKinematics::computeContactJacobian)
+		 * @param rbd::Vector6d& Consistent base acceleration
+		 * @param Eigen::VectorXd& Consistent joint acceleration
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const rbd::Vector6d& Base acceleration with respect to a
+		 * gravity field
+		 * @param const Eigen::VectorXd& Joint acceleration
+		 * @param const rbd::BodySelector& Bodies that are constrained to be
+		 * in contact
+		 * @param const Eigen::MatrixXd& Stacked contact jacobian
+		 * @param const Eigen::VectorXd& Stacked J_d*q_d vector
+		 */
+		void computeConstrainedConsistentAcceleration(rbd::Vector6d& base_feas_acc,
+													  Eigen::VectorXd& joint_feas_acc,
+													  const rbd::Vector6d& base_pos,
+													  const Eigen::VectorXd& joint_pos,
+													  const rbd::Vector6d& base_vel,
+													  const Eigen::VectorXd& joint_vel,
+													  const rbd::Vector6d& base_acc,
+													  const Eigen::VectorXd& joint_acc,
+													  const rbd::BodySelector& contacts,
+													  const Eigen::MatrixXd& contact_jac,
+													  const Eigen::VectorXd& jacd_qd);
+
+		/**
+		 * @brief Computes the forces that generate a wrench, i.e. min |M f - w|, where the
+		 * first variables are the contact forces. They are computed with the pseudo-inverse,
+		 * or with the friction-cone QP if it's enabled (see setFrictionConeDistribution)
+		 * @param Eigen::VectorXd& Forces
+		 * @param const Eigen::MatrixXd& Map from the forces to the wrench
+		 * @param const Eigen::VectorXd& Wrench
+		 * @param unsigned int Number of contacts
+		 * @param bool True if the contact forces are only the normal ones
+		 */
+		void distributeContactForces(Eigen::VectorXd& forces,
+									 const Eigen::MatrixXd& force_map,
+									 const Eigen::VectorXd& wrench,
+									 unsigned int num_contacts,
+									 bool only_normal = false);
+
 		/* @brief Body ids */
 		rbd::BodyID body_id_;
 
@@ -419,9 +758,21 @@ class WholeBodyDynamics
 
 		/** @brief The centroidal inertia matrix */
 		rbd::Matrix6d com_inertia_mat_;
+
+		/** @brief Workspace of the allocation-free routines */
+		DynamicsWorkspace workspace_;
+
+		/** @brief Friction-cone distribution of the contact forces and its QP */
+		bool friction_distribution_;
+		double friction_coeff_;
+		double force_regularization_;
+		solver::ActiveSetQP force_qp_;
+		Eigen::MatrixXd friction_cone_mat_;
 };
 
 } //@namespace model
 } //@namespace dwl
 
+#include <dwl/model/impl/WholeBodyDynamics.hpp>
+
 #endif
@@ -1,4 +1,7 @@
 #include <dwl/model/WholeBodyKinematics.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <algorithm>
+#include <limits>
 
 
 namespace dwl
@@ -7,8 +10,8 @@ namespace dwl
 namespace model
 {
 
-WholeBodyKinematics::WholeBodyKinematics() : step_tol_(1.0e-12),
-		lambda_(0.01), max_iter_(50)
+WholeBodyKinematics::WholeBodyKinematics() : ik_warm_start_(true), step_tol_(1.0e-12),
+		lambda_(0.01), max_iter_(50), error_tol_(1.0e-8)
 {
 
 }
@@ -42,27 +45,102 @@ void WholeBodyKinematics::modelFromURDFModel(const std::string& urdf_model,
 	if (info)
 		rbd::printModelInfo(system_.getRBDModel());
 
-	// Computing the middle value for IK routines
-	joint_pos_middle_ = Eigen::VectorXd::Zero(system_.getJointDoF());
+	// Computing the middle value and the joint limits for IK routines
+	unsigned int num_joints = system_.getJointDoF();
+	joint_pos_middle_ = Eigen::VectorXd::Zero(num_joints);
+	joint_pos_lower_ = Eigen::VectorXd::Constant(num_joints, -std::numeric_limits<double>::max());
+	joint_pos_upper_ = Eigen::VectorXd::Constant(num_joints, std::numeric_limits<double>::max());
 	urdf_model::JointLimits joint_limits = system_.getJointLimits();
 	for (urdf_model::JointLimits::iterator it = joint_limits.begin();
 			it != joint_limits.end(); ++it) {
 		std::string name = it->first;
 		double lower_limit = it->second.lower;
 		double upper_limit = it->second.upper;
+		unsigned int id = system_.getJointId(name);
 
-		joint_pos_middle_(system_.getJointId(name)) = (upper_limit + lower_limit) / 2;
+		joint_pos_middle_(id) = (upper_limit + lower_limit) / 2;
+		joint_pos_lower_(id) = lower_limit;
+		joint_pos_upper_(id) = upper_limit;
+	}
+	joint_pos_ik_ = joint_pos_middle_;
+
+	// Registering the analytic IK of the feet defined in the system file
+	leg_ik_.clear();
+	if (!system_file.empty()) {
+		YamlWrapper yaml_reader(system_file);
+		YamlNamespace robot_ns = {"robot"};
+		std::string leg_ik_type;
+		if (yaml_reader.read(leg_ik_type, "leg_ik", robot_ns)) {
+			const rbd::BodySelector& foot_names = system_.getEndEffectorNames(FOOT);
+			for (unsigned int f = 0; f < foot_names.size(); f++) {
+				std::shared_ptr<LegInverseKinematics> leg_ik =
+						LegInverseKinematics::create(leg_ik_type);
+				if (!leg_ik) {
+					printf(YELLOW "Warning: the %s leg IK is not defined\n" COLOR_RESET,
+							leg_ik_type.c_str());
+					break;
+				}
+				setLegInverseKinematics(foot_names[f], leg_ik);
+			}
+		}
 	}
 }
 
 
 void WholeBodyKinematics::setIKSolver(double step_tol,
 						 	 	 	  double lambda,
-									  unsigned int max_iter)
+									  unsigned int max_iter,
+									  double error_tol)
 {
 	step_tol_ = step_tol;
 	lambda_ = lambda;
 	max_iter_ = max_iter;
+	error_tol_ = error_tol;
+}
+
+
+void WholeBodyKinematics::setIKWarmStart(bool warm_start)
+{
+	ik_warm_start_ = warm_start;
+	joint_pos_ik_ = joint_pos_middle_;
+}
+
+
+bool WholeBodyKinematics::setLegInverseKinematics(const std::string& foot_name,
+												  std::shared_ptr<LegInverseKinematics> leg_ik)
+{
+	if (body_id_.count(foot_name) == 0) {
+		printf(YELLOW "Warning: the %s body is not defined\n" COLOR_RESET, foot_name.c_str());
+		return false;
+	}
+
+	// Computing the branch Jacobian and the foot position at the zero joint position, which
+	// define the leg geometry
+	unsigned int base_dof = system_.isFullyFloatingBase() ? 6 : system_.getFloatingBaseDoF();
+	unsigned int q_idx, num_dof;
+	system_.getBranch(q_idx, num_dof, foot_name);
+	unsigned int idx = q_idx - base_dof;
+
+	rbd::Vector6d base_pos = rbd::Vector6d::Zero();
+	Eigen::VectorXd joint_pos = Eigen::VectorXd::Zero(system_.getJointDoF());
+	rbd::BodySelector body_set(1, foot_name);
+	Eigen::MatrixXd full_jac, fixed_jac;
+	computeJacobian(full_jac, base_pos, joint_pos, body_set, rbd::Full);
+	getFixedBaseJacobian(fixed_jac, full_jac);
+	rbd::BodyVectorXd foot_pos;
+	computeForwardKinematics(foot_pos, base_pos, joint_pos, body_set, rbd::Linear);
+
+	if (!leg_ik->reset(fixed_jac.block(0, idx, 6, num_dof),
+					   (Eigen::Vector3d) foot_pos.find(foot_name)->second,
+					   joint_pos_lower_.segment(idx, num_dof),
+					   joint_pos_upper_.segment(idx, num_dof))) {
+		printf(YELLOW "Warning: the leg IK doesn't support the %s branch, so it's used the "
+				"numerical IK\n" COLOR_RESET, foot_name.c_str());
+		return false;
+	}
+
+	leg_ik_[foot_name] = leg_ik;
+	return true;
 }
 
 
@@ -74,44 +152,12 @@ void WholeBodyKinematics::computeForwardKinematics(rbd::BodyVectorXd& op_pos,
 												   enum TypeOfOrientation type)
 {
 	// Resizing the position vector
-	int lin_vars = 0, ang_vars = 0;
-	switch(component) {
-	case rbd::Linear:
-		ang_vars = 0;
-		lin_vars = 3;
-		break;
-	case rbd::Angular:
-		switch (type) {
-		case RollPitchYaw:
-			ang_vars = 3;
-			break;
-		case Quaternion:
-			ang_vars = 4;
-			break;
-		case RotationMatrix:
-			ang_vars = 0;
-			break;
-		}
-		lin_vars = 0;
-		break;
-	case rbd::Full:
-		switch (type) {
-		case RollPitchYaw:
-			ang_vars = 3;
-			break;
-		case Quaternion:
-			ang_vars = 4;
-			break;
-		case RotationMatrix:
-			ang_vars = 0;
-			break;
-		}
-		lin_vars = 3;
-		break;
-	}
-
-	Eigen::VectorXd body_pos(ang_vars + lin_vars);
+	Eigen::VectorXd body_pos(getPositionDimension(component, type));
 
+	// Updating the kinematics of the rigid-body system only if the state changed. Then, the
+	// pose of every body is read from the cached model
+	const Eigen::VectorXd& q = system_.toGeneralizedJointState(base_pos, joint_pos);
+	system_.updateKinematics(q);
 
 	for (rbd::BodySelector::const_iterator body_iter = body_set.begin();
 			body_iter != body_set.end();
@@ -121,15 +167,13 @@ void WholeBodyKinematics::computeForwardKinematics(rbd::BodyVectorXd& op_pos,
 		if (body_id_.count(body_name) > 0) {
 			unsigned int body_id = body_id_.find(body_name)->second;
 
-			Eigen::VectorXd q = system_.toGeneralizedJointState(base_pos, joint_pos);
-
 			Eigen::Matrix3d rotation_mtx;
 			switch (component) {
 			case rbd::Linear:
 				body_pos.segment<3>(0) =
 						CalcBodyToBaseCoordinates(system_.getRBDModel(),
 												  q, body_id,
-												  Eigen::Vector3d::Zero(), true);
+												  Eigen::Vector3d::Zero(), false);
 				break;
 			case rbd::Angular:
 				rotation_mtx =
@@ -161,10 +205,10 @@ void WholeBodyKinematics::computeForwardKinematics(rbd::BodyVectorXd& op_pos,
 				}
 
 				// Computing the linear component
-				body_pos.segment<3>(ang_vars) =
+				body_pos.tail<3>() =
 						CalcBodyToBaseCoordinates(system_.getRBDModel(),
 												  q, body_id,
-												  Eigen::Vector3d::Zero(), true);
+												  Eigen::Vector3d::Zero(), false);
 				break;
 			}
 
@@ -174,6 +218,79 @@ void WholeBodyKinematics::computeForwardKinematics(rbd::BodyVectorXd& op_pos,
 }
 
 
+void WholeBodyKinematics::computeForwardKinematics(Eigen::MatrixXd& op_pos,
+												   const Eigen::Ref<const Eigen::MatrixXd>& base_pos,
+												   const Eigen::Ref<const Eigen::MatrixXd>& joint_pos,
+												   const rbd::BodySelector& body_set,
+												   enum rbd::Component component,
+												   enum TypeOfOrientation type,
+												   unsigned int num_threads)
+{
+	// Setting the size of the output, where the bodies without a model are zero
+	unsigned int num_states = base_pos.cols();
+	unsigned int body_dim = getPositionDimension(component, type);
+	op_pos.setZero(body_dim * body_set.size(), num_states);
+	if (joint_pos.cols() != base_pos.cols() || base_pos.rows() != 6 ||
+			joint_pos.rows() != system_.getJointDoF()) {
+		printf(RED "FATAL: the batch of states has to be [6 x N] base positions and [%u x N]"
+				" joint positions\n" COLOR_RESET, system_.getJointDoF());
+		return;
+	}
+	if (num_states == 0)
+		return;
+
+	// Getting the number of threads, which cannot be bigger than the number
+	// of states
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::min(num_threads, num_states);
+
+	// Evaluating a contiguous chunk of states with a given kinematic model
+	auto evaluateStates = [&](WholeBodyKinematics& kinematics,
+							  unsigned int first, unsigned int last) {
+		rbd::BodyVectorXd body_pos;
+		for (unsigned int k = first; k < last; k++) {
+			kinematics.computeForwardKinematics(body_pos,
+												(rbd::Vector6d) base_pos.col(k),
+												(Eigen::VectorXd) joint_pos.col(k),
+												body_set, component, type);
+			for (unsigned int b = 0; b < body_set.size(); b++) {
+				rbd::BodyVectorXd::const_iterator body_it = body_pos.find(body_set[b]);
+				if (body_it != body_pos.end())
+					op_pos.block(b * body_dim, k, body_dim, 1) = body_it->second;
+			}
+		}
+	};
+
+	// Creating the thread-local copies of the kinematic model. Note that the
+	// first chunk uses this model. The chunks are run by the task scheduler
+	unsigned int chunk_size = (num_states + num_threads - 1) / num_threads;
+	std::vector<WholeBodyKinematics> thread_kinematics(num_threads - 1, *this);
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_states);
+		unsigned int last = std::min(first + chunk_size, num_states);
+		evaluateStates((t == 0) ? *this : thread_kinematics[t - 1], first, last);
+	});
+}
+
+
+unsigned int WholeBodyKinematics::getPositionDimension(enum rbd::Component component,
+													   enum TypeOfOrientation type)
+{
+	unsigned int lin_vars = 0, ang_vars = 0;
+	if (component == rbd::Linear || component == rbd::Full)
+		lin_vars = 3;
+	if (component == rbd::Angular || component == rbd::Full) {
+		if (type == RollPitchYaw)
+			ang_vars = 3;
+		else if (type == Quaternion)
+			ang_vars = 4;
+	}
+
+	return lin_vars + ang_vars;
+}
+
+
 const rbd::BodyVectorXd& WholeBodyKinematics::computePosition(const rbd::Vector6d& base_pos,
 															  const Eigen::VectorXd& joint_pos,
 															  const rbd::BodySelector& body_set,
@@ -187,6 +304,66 @@ const rbd::BodyVectorXd& WholeBodyKinematics::computePosition(const rbd::Vector6
 }
 
 
+void WholeBodyKinematics::computeForwardKinematics(rbd::BodyContainer3d& op_pos,
+												   const rbd::Vector6d& base_pos,
+												   const Eigen::VectorXd& joint_pos)
+{
+	// Resetting the body container if it isn't indexed by the end-effectors
+	const std::vector<unsigned int>& body_ids = system_.getEndEffectorBodyIds();
+	if (op_pos.size() != body_ids.size())
+		op_pos.reset(system_.getEndEffectorNames());
+
+	// Updating the kinematics once, and then reading the end-effector positions
+	const Eigen::VectorXd& q = system_.toGeneralizedJointState(base_pos, joint_pos);
+	system_.updateKinematics(q);
+	for (unsigned int i = 0; i < body_ids.size(); i++) {
+		op_pos[i] = CalcBodyToBaseCoordinates(system_.getRBDModel(),
+											  q, body_ids[i],
+											  Eigen::Vector3d::Zero(), false);
+	}
+}
+
+
+void WholeBodyKinematics::computeBranchForwardKinematics(Eigen::Vector3d& op_pos,
+														 const rbd::Vector6d& base_pos,
+														 const Eigen::VectorXd& joint_pos,
+														 unsigned int end_effector)
+{
+	// Updating only the chain of the end-effector
+	const Eigen::VectorXd& q = system_.toGeneralizedJointState(base_pos, joint_pos);
+	system_.updateBranchKinematics(q, end_effector);
+	op_pos = CalcBodyToBaseCoordinates(system_.getRBDModel(),
+									   q, system_.getEndEffectorBodyIds()[end_effector],
+									   Eigen::Vector3d::Zero(), false);
+}
+
+
+void WholeBodyKinematics::computeBranchKinematics(Eigen::Vector3d& op_pos,
+												  Eigen::MatrixXd& jacobian,
+												  const rbd::Vector6d& base_pos,
+												  const Eigen::VectorXd& joint_pos,
+												  unsigned int end_effector)
+{
+	// Updating only the chain of the end-effector
+	const Eigen::VectorXd& q = system_.toGeneralizedJointState(base_pos, joint_pos);
+	system_.updateBranchKinematics(q, end_effector);
+	unsigned int body_id = system_.getEndEffectorBodyIds()[end_effector];
+	op_pos = CalcBodyToBaseCoordinates(system_.getRBDModel(),
+									   q, body_id,
+									   Eigen::Vector3d::Zero(), false);
+
+	// Getting the linear rows of the branch joints. Note that the other columns of the
+	// point jacobian are zero, and they don't need the floating-base reordering
+	unsigned int q_idx = 0, num_dof = 0;
+	system_.getBranch(q_idx, num_dof, end_effector);
+	branch_jac_.setZero(6, system_.getSystemDoF());
+	rbd::computePointJacobian(system_.getRBDModel(),
+							  q, body_id,
+							  Eigen::Vector3d::Zero(),
+							  branch_jac_, false);
+	jacobian = branch_jac_.block(3, q_idx, 3, num_dof);
+}
+
 bool WholeBodyKinematics::computeInverseKinematics(rbd::Vector6d& base_pos,
 												   Eigen::VectorXd& joint_pos,
 												   const rbd::BodyVector3d& op_pos)
@@ -232,6 +409,7 @@ bool WholeBodyKinematics::computeInverseKinematics(rbd::Vector6d& base_pos,
 														q_guess, body_id, body_point,
 														target_pos, q_res,
 														step_tol_, lambda_, max_iter_);
+	system_.invalidateKinematics();
 
 	// Converting the base and joint positions
 	system_.fromGeneralizedJointState(base_pos, joint_pos, q_res);
@@ -243,7 +421,12 @@ bool WholeBodyKinematics::computeInverseKinematics(rbd::Vector6d& base_pos,
 bool WholeBodyKinematics::computeJointPosition(Eigen::VectorXd& joint_pos,
 											   const rbd::BodyVector3d& op_pos)
 {
-	return computeJointPosition(joint_pos, op_pos, joint_pos_middle_);
+	// Starting from the last solution (if it's warm-started) since consecutive calls
+	// (e.g. the samples of a trajectory) have close solutions
+	if (ik_warm_start_ && joint_pos_ik_.size() == joint_pos_middle_.size())
+		return computeJointPosition(joint_pos, op_pos, joint_pos_ik_);
+	else
+		return computeJointPosition(joint_pos, op_pos, joint_pos_middle_);
 }
 
 
@@ -251,78 +434,153 @@ bool WholeBodyKinematics::computeJointPosition(Eigen::VectorXd& joint_pos,
 											   const rbd::BodyVector3d& op_pos,
 											   const Eigen::VectorXd& joint_pos_init)
 {
-	// Indicates if we manage to solve the IK problem
-	bool success = false;
-
 	// Setting up the guess point
 	joint_pos = joint_pos_init;
 
-	// Getting the end-effector names
+	// Getting the end-effector names and their branches, i.e. the first joint index and
+	// the number of joints of the leg
+	unsigned int base_dof = system_.isFullyFloatingBase() ? 6 : system_.getFloatingBaseDoF();
 	rbd::BodySelector body_names;
 	std::vector<Eigen::Vector3d> target_pos;
+	std::vector<unsigned int> branch_idx, branch_dof, end_effectors;
 	for (rbd::BodyVector3d::const_iterator contact_it = op_pos.begin();
 			contact_it != op_pos.end(); contact_it++) {
+		if (body_id_.count(contact_it->first) == 0)
+			continue;
+
+		unsigned int q_idx, num_dof;
+		system_.getBranch(q_idx, num_dof, contact_it->first);
 		body_names.push_back(contact_it->first);
 		target_pos.push_back(contact_it->second);
+		branch_idx.push_back(q_idx - base_dof);
+		branch_dof.push_back(num_dof);
+		end_effectors.push_back(system_.getEndEffectorIndex(contact_it->first));
+	}
+	unsigned int num_bodies = body_names.size();
+
+	// Solving the branches that have an analytic leg IK. Note that the numerical IK solves
+	// the branches where it fails, e.g. out of the workspace or joint limits
+	for (unsigned int f = 0; f < num_bodies; ++f) {
+		std::map<std::string, std::shared_ptr<LegInverseKinematics> >::iterator ik_it =
+				leg_ik_.find(body_names[f]);
+		if (ik_it != leg_ik_.end()) {
+			Eigen::VectorXd branch_pos;
+			if (ik_it->second->compute(branch_pos, target_pos[f],
+									   joint_pos.segment(branch_idx[f], branch_dof[f])))
+				joint_pos.segment(branch_idx[f], branch_dof[f]) = branch_pos;
+		}
 	}
 
-	// Defining the residual error
-	Eigen::VectorXd e = Eigen::VectorXd::Zero(3 * body_names.size());
+	// Computing the initial error of every branch. Note that the end-effectors traverse
+	// only their own branch
+	Eigen::Vector3d fk_pos;
+	std::vector<Eigen::Vector3d> error(num_bodies);
+	std::vector<double> damping(num_bodies, lambda_);
+	std::vector<bool> converged(num_bodies, false);
+	for (unsigned int f = 0; f < num_bodies; ++f) {
+		computeIKBranch(fk_pos, NULL, joint_pos, body_names[f], end_effectors[f]);
+		error[f] = target_pos[f] - fk_pos;
+		converged[f] = error[f].norm() < error_tol_;
+	}
 
-	// Iterating until a satisfied the desired tolerance or reach the maximum
-	// number of iterations
-	Eigen::MatrixXd full_jac, fixed_jac, JJTe_lambda2_I;
-	rbd::Vector6d base_pos = rbd::Vector6d::Zero();
+	// Iterating until every branch satisfies the desired tolerance or reach the maximum
+	// number of iterations. Note that the branches don't share joints, so they are
+	// independent subproblems with 3 x num_dof Jacobians
+	Eigen::MatrixXd branch_jac;
+	Eigen::VectorXd joint_pos_trial;
+	std::vector<unsigned int> active;
 	for (unsigned int k = 0; k < max_iter_; ++k) {
-		// Computing the Jacobian
-		computeJacobian(full_jac, base_pos, joint_pos, body_names, rbd::Linear);
-		getFixedBaseJacobian(fixed_jac, full_jac);
-
-		// Computing the forward kinematics
-		rbd::BodyVectorXd fk_pos;
-		computeForwardKinematics(fk_pos, base_pos, joint_pos, body_names, rbd::Linear);
-
-		// Computing the error
-		for (unsigned int f = 0; f < body_names.size(); ++f) {
-			e.segment<3>(3 * f) = target_pos[f] -
-					(Eigen::Vector3d) fk_pos.find(body_names[f])->second;
+		active.clear();
+		for (unsigned int f = 0; f < num_bodies; ++f) {
+			if (!converged[f])
+				active.push_back(f);
 		}
+		if (active.empty())
+			break;
 
-		// Computing the weighted fixed jacobian
-		JJTe_lambda2_I = fixed_jac * fixed_jac.transpose() +
-				lambda_ * lambda_ * Eigen::MatrixXd::Identity(e.size(), e.size());
-
-		// Solving the linear system
-		Eigen::VectorXd z;
-		math::GaussianEliminationPivot(z, JJTe_lambda2_I, e);
-
-		Eigen::VectorXd delta_theta = fixed_jac.transpose() * z; //math::pseudoInverse(fixed_jac) * e;
-		joint_pos = joint_pos + delta_theta;
-
-		// Checking if the IK solution is in the joint limits
-		dwl::urdf_model::JointLimits joint_limits = system_.getJointLimits();
-		for (dwl::urdf_model::JointLimits::iterator jnt_it = joint_limits.begin();
-				jnt_it != joint_limits.end(); ++jnt_it) {
-			std::string name = jnt_it->first;
-			urdf::JointLimits limits = jnt_it->second;
-			unsigned int id = system_.getJointId(name);
-
-			if (joint_pos(id) > limits.upper)
-				joint_pos(id) = limits.upper;
-			else if (joint_pos(id) < limits.lower)
-				joint_pos(id) = limits.lower;
+		// Computing the damped Gauss-Newton step of every active branch, i.e.
+		// dq = J^T (J J^T + lambda^2 I)^-1 e, and projecting it onto the joint limits
+		joint_pos_trial = joint_pos;
+		std::vector<double> step_norm(active.size());
+		for (unsigned int i = 0; i < active.size(); ++i) {
+			unsigned int f = active[i];
+			unsigned int idx = branch_idx[f], dof = branch_dof[f];
+			computeIKBranch(fk_pos, &branch_jac, joint_pos, body_names[f], end_effectors[f]);
+			Eigen::Matrix3d JJT_lambda2_I = branch_jac * branch_jac.transpose() +
+					damping[f] * damping[f] * Eigen::Matrix3d::Identity();
+			Eigen::VectorXd delta_theta =
+					branch_jac.transpose() * JJT_lambda2_I.ldlt().solve(error[f]);
+
+			joint_pos_trial.segment(idx, dof) =
+					(joint_pos.segment(idx, dof) + delta_theta).cwiseMax(
+							joint_pos_lower_.segment(idx, dof)).cwiseMin(
+									joint_pos_upper_.segment(idx, dof));
+			step_norm[i] = delta_theta.norm();
 		}
 
-		if (delta_theta.norm() < step_tol_) {
-			success = true;
-			return success;
+		// Accepting the steps that reduce the error (decreasing the damping), and rejecting
+		// the other ones (increasing the damping)
+		for (unsigned int i = 0; i < active.size(); ++i) {
+			unsigned int f = active[i];
+			unsigned int idx = branch_idx[f], dof = branch_dof[f];
+			computeIKBranch(fk_pos, NULL, joint_pos_trial, body_names[f], end_effectors[f]);
+			Eigen::Vector3d new_error = target_pos[f] - fk_pos;
+			if (new_error.norm() < error[f].norm()) {
+				joint_pos.segment(idx, dof) = joint_pos_trial.segment(idx, dof);
+				error[f] = new_error;
+				damping[f] = std::max(0.5 * damping[f], 1e-3 * lambda_);
+				converged[f] = error[f].norm() < error_tol_;
+			} else
+				damping[f] = std::min(4. * damping[f], 1e3);
+
+			// A step smaller than the tolerance means that the branch cannot be improved
+			if (step_norm[i] < step_tol_)
+				converged[f] = true;
 		}
 	}
 
+	// Checking that all the branches converged
+	bool success = true;
+	for (unsigned int f = 0; f < num_bodies; ++f)
+		success &= converged[f];
+	if (success)
+		joint_pos_ik_ = joint_pos;
+
 	return success;
 }
 
 
+void WholeBodyKinematics::computeIKBranch(Eigen::Vector3d& position,
+										  Eigen::MatrixXd* jacobian,
+										  const Eigen::VectorXd& joint_pos,
+										  const std::string& body_name,
+										  unsigned int end_effector)
+{
+	rbd::Vector6d base_pos = rbd::Vector6d::Zero();
+	if (end_effector < system_.getNumberOfEndEffectors()) {
+		if (jacobian != NULL)
+			computeBranchKinematics(position, *jacobian, base_pos, joint_pos, end_effector);
+		else
+			computeBranchForwardKinematics(position, base_pos, joint_pos, end_effector);
+		return;
+	}
+
+	rbd::BodySelector body_set(1, body_name);
+	rbd::BodyVectorXd fk_pos;
+	computeForwardKinematics(fk_pos, base_pos, joint_pos, body_set, rbd::Linear);
+	position = fk_pos.find(body_name)->second;
+	if (jacobian != NULL) {
+		Eigen::MatrixXd full_jac, fixed_jac;
+		computeJacobian(full_jac, base_pos, joint_pos, body_set, rbd::Linear);
+		getFixedBaseJacobian(fixed_jac, full_jac);
+
+		unsigned int q_idx = 0, num_dof = 0;
+		system_.getBranch(q_idx, num_dof, body_name);
+		unsigned int base_dof = system_.isFullyFloatingBase() ? 6 : system_.getFloatingBaseDoF();
+		*jacobian = fixed_jac.block(0, q_idx - base_dof, 3, num_dof);
+	}
+}
+
 void WholeBodyKinematics::computeJointVelocity(Eigen::VectorXd& joint_vel,
 											   const Eigen::VectorXd& joint_pos,
 											   const rbd::BodyVectorXd& op_vel,
@@ -342,8 +600,8 @@ void WholeBodyKinematics::computeJointVelocity(Eigen::VectorXd& joint_vel,
 			computeFixedJacobian(branch_jac, joint_pos, body_name, rbd::Linear);
 
 			// Computing the branch joint velocity
-			Eigen::VectorXd branch_joint_vel =
-					math::pseudoInverse(branch_jac) * body_vel;
+			Eigen::VectorXd branch_joint_vel;
+			math::dampedLeastSquares(branch_joint_vel, branch_jac, body_vel);
 
 			// Setting up the branch joint velocity
 			system_.setBranchState(joint_vel, branch_joint_vel, body_name);
@@ -381,9 +639,9 @@ void WholeBodyKinematics::computeJointAcceleration(Eigen::VectorXd& joint_acc,
 			computeFixedJacobian(branch_jac, joint_pos, body_name, rbd::Linear);
 
 			// Computing the branch joint acceleration
-			Eigen::VectorXd branch_joint_acc =
-					math::pseudoInverse(branch_jac) * (body_acc -
-							jacd_qd.find(body_name)->second);
+			Eigen::VectorXd branch_joint_acc;
+			math::dampedLeastSquares(branch_joint_acc, branch_jac,
+									 body_acc - jacd_qd.find(body_name)->second);
 
 			// Setting up the branch joint velocity
 			system_.setBranchState(joint_acc, branch_joint_acc, body_name);
@@ -420,6 +678,9 @@ void WholeBodyKinematics::computeJacobian(Eigen::MatrixXd& jacobian,
 	jacobian.resize(num_vars * num_body_set, system_.getSystemDoF());
 	jacobian.setZero();
 
+	// Converting the state once, i.e. the kinematics is only updated if it changed
+	const Eigen::VectorXd& q = system_.toGeneralizedJointState(base_pos, joint_pos);
+
 	// Adding the jacobian only for the active end-effectors
 	int body_counter = 0;
 	for (rbd::BodySelector::const_iterator body_iter = body_set.begin();
@@ -432,20 +693,13 @@ void WholeBodyKinematics::computeJacobian(Eigen::MatrixXd& jacobian,
 		if (body_id_.count(body_name) > 0) {
 			int body_id = body_id_.find(body_name)->second;
 
-			Eigen::VectorXd q = system_.toGeneralizedJointState(base_pos, joint_pos);
+			system_.updateKinematics(q);
 
 			Eigen::MatrixXd jac(Eigen::MatrixXd::Zero(6, system_.getSystemDoF()));
-			if (body_counter == 0) {
-				rbd::computePointJacobian(system_.getRBDModel(),
-										  q, body_id,
-										  Eigen::Vector3d::Zero(),
-										  jac, true);
-			} else {
-				rbd::computePointJacobian(system_.getRBDModel(),
-										  q, body_id,
-										  Eigen::Vector3d::Zero(),
-										  jac, false);
-			}
+			rbd::computePointJacobian(system_.getRBDModel(),
+									  q, body_id,
+									  Eigen::Vector3d::Zero(),
+									  jac, false);
 			if (system_.isFullyFloatingBase()) {
 				// RBDL defines floating joints as (linear, angular)^T which is
 				// not consistent with our DWL standard, i.e. (angular, linear)^T
@@ -473,6 +727,15 @@ void WholeBodyKinematics::computeJacobian(Eigen::MatrixXd& jacobian,
 }
 
 
+void WholeBodyKinematics::computeBranchJacobian(Eigen::MatrixXd& jacobian,
+												const rbd::Vector6d& base_pos,
+												const Eigen::VectorXd& joint_pos,
+												unsigned int end_effector)
+{
+	Eigen::Vector3d op_pos;
+	computeBranchKinematics(op_pos, jacobian, base_pos, joint_pos, end_effector);
+}
+
 void WholeBodyKinematics::computeFixedJacobian(Eigen::MatrixXd& jacobian,
 											   const Eigen::VectorXd& joint_pos,
 											   const std::string& body_name,
@@ -543,6 +806,105 @@ void WholeBodyKinematics::getFixedBaseJacobian(Eigen::MatrixXd& jacobian,
 }
 
 
+void WholeBodyKinematics::computeContactJacobian(Eigen::MatrixXd& jacobian,
+												 const rbd::Vector6d& base_pos,
+												 const Eigen::VectorXd& joint_pos,
+												 const rbd::BodySelector& contacts,
+												 bool fixed_base)
+{
+	// Resizing the stacked jacobian. Note that it doesn't allocate memory if
+	// it has already the right dimension
+	unsigned int num_dof = system_.getSystemDoF();
+	unsigned int base_dof = num_dof - system_.getJointDoF();
+	unsigned int init_col = fixed_base ? base_dof : 0;
+	unsigned int num_cols = num_dof - init_col;
+	jacobian.resize(3 * getNumberOfActiveEndEffectors(contacts), num_cols);
+
+	// Updating the kinematics only if the state changed
+	system_.toGeneralizedJointState(contact_q_, base_pos, joint_pos);
+	system_.updateKinematics(contact_q_);
+
+	unsigned int init_row = 0;
+	for (rbd::BodySelector::const_iterator contact_iter = contacts.begin();
+			contact_iter != contacts.end();
+			contact_iter++)
+	{
+		rbd::BodyID::const_iterator id_it = body_id_.find(*contact_iter);
+		if (id_it == body_id_.end())
+			continue;
+
+		// Note that the point jacobian only fills the columns of its branch
+		point_jac_.setZero(6, num_dof);
+		rbd::computePointJacobian(system_.getRBDModel(),
+								  contact_q_, id_it->second,
+								  Eigen::Vector3d::Zero(),
+								  point_jac_, false);
+
+		if (!fixed_base && system_.isFullyFloatingBase()) {
+			// RBDL defines floating joints as (linear, angular)^T which is
+			// not consistent with our DWL standard, i.e. (angular, linear)^T
+			jacobian.block<3,3>(init_row, 0) = point_jac_.block<3,3>(3,3);
+			jacobian.block<3,3>(init_row, 3) = point_jac_.block<3,3>(3,0);
+			jacobian.block(init_row, 6, 3, num_cols - 6) =
+					point_jac_.block(3, 6, 3, num_cols - 6);
+		} else
+			jacobian.block(init_row, 0, 3, num_cols) =
+					point_jac_.block(3, init_col, 3, num_cols);
+
+		init_row += 3;
+	}
+}
+
+
+void WholeBodyKinematics::computeContactJacobian(Eigen::MatrixXd& jacobian,
+												 Eigen::VectorXd& jacd_qd,
+												 const rbd::Vector6d& base_pos,
+												 const Eigen::VectorXd& joint_pos,
+												 const rbd::Vector6d& base_vel,
+												 const Eigen::VectorXd& joint_vel,
+												 const rbd::BodySelector& contacts,
+												 bool fixed_base)
+{
+	// Updating the kinematics with zero acceleration once. So, the jacobian
+	// and the J_d*q_d vector are read from the same cached kinematics state
+	system_.toGeneralizedJointState(contact_qd_, base_vel, joint_vel);
+	system_.toGeneralizedJointState(contact_q_, base_pos, joint_pos);
+	contact_qdd_.setZero(system_.getSystemDoF());
+	system_.updateKinematics(contact_q_, &contact_qd_, &contact_qdd_);
+
+	computeContactJacobian(jacobian,
+						   base_pos, joint_pos,
+						   contacts, fixed_base);
+
+	// Computing the J_d*q_d from the point acceleration (with zero joint
+	// acceleration) and the point velocity, i.e. a + w x v
+	jacd_qd.resize(jacobian.rows());
+	unsigned int init_row = 0;
+	for (rbd::BodySelector::const_iterator contact_iter = contacts.begin();
+			contact_iter != contacts.end();
+			contact_iter++)
+	{
+		rbd::BodyID::const_iterator id_it = body_id_.find(*contact_iter);
+		if (id_it == body_id_.end())
+			continue;
+
+		rbd::Vector6d point_vel =
+				rbd::computePointVelocity(system_.getRBDModel(),
+										  contact_q_, contact_qd_, id_it->second,
+										  Eigen::Vector3d::Zero(), false);
+		rbd::Vector6d point_acc =
+				rbd::computePointAcceleration(system_.getRBDModel(),
+											  contact_q_, contact_qd_, contact_qdd_,
+											  id_it->second,
+											  Eigen::Vector3d::Zero(), false);
+		jacd_qd.segment<3>(init_row) = rbd::linearPart(point_acc) +
+				rbd::angularPart(point_vel).cross(rbd::linearPart(point_vel));
+
+		init_row += 3;
+	}
+}
+
+
 void WholeBodyKinematics::computeVelocity(rbd::BodyVectorXd& op_vel,
 										  const rbd::Vector6d& base_pos,
 										  const Eigen::VectorXd& joint_pos,
@@ -566,6 +928,9 @@ void WholeBodyKinematics::computeVelocity(rbd::BodyVectorXd& op_vel,
 	}
 	Eigen::VectorXd body_vel(num_vars);
 
+	// Converting the states in the workspace
+	system_.toGeneralizedJointState(contact_q_, base_pos, joint_pos);
+	system_.toGeneralizedJointState(contact_qd_, base_vel, joint_vel);
 
 	// Adding the velocity only for the active end-effectors
 	for (rbd::BodySelector::const_iterator body_iter = body_set.begin();
@@ -576,14 +941,13 @@ void WholeBodyKinematics::computeVelocity(rbd::BodyVectorXd& op_vel,
 		if (body_id_.count(body_name) > 0) {
 			int body_id = body_id_.find(body_name)->second;
 
-			Eigen::VectorXd q = system_.toGeneralizedJointState(base_pos, joint_pos);
-			Eigen::VectorXd q_dot = system_.toGeneralizedJointState(base_vel, joint_vel);
+			system_.updateKinematics(contact_q_, &contact_qd_);
 
 			// Computing the point velocity
 			rbd::Vector6d point_vel =
 					rbd::computePointVelocity(system_.getRBDModel(),
-											  q, q_dot, body_id,
-											  Eigen::Vector3d::Zero(), true);
+											  contact_q_, contact_qd_, body_id,
+											  Eigen::Vector3d::Zero(), false);
 			switch (component) {
 			case rbd::Linear:
 				body_vel.segment<3>(0) = rbd::linearPart(point_vel);
@@ -617,6 +981,34 @@ const rbd::BodyVectorXd& WholeBodyKinematics::computeVelocity(const rbd::Vector6
 }
 
 
+void WholeBodyKinematics::computeVelocity(rbd::BodyContainer3d& op_vel,
+										  const rbd::Vector6d& base_pos,
+										  const Eigen::VectorXd& joint_pos,
+										  const rbd::Vector6d& base_vel,
+										  const Eigen::VectorXd& joint_vel)
+{
+	// Resetting the body container if it isn't indexed by the end-effectors
+	const std::vector<unsigned int>& body_ids = system_.getEndEffectorBodyIds();
+	if (op_vel.size() != body_ids.size())
+		op_vel.reset(system_.getEndEffectorNames());
+
+	// Note that the generalized states are copied in the preallocated buffers since the
+	// generalized joint state is an internal buffer of the floating-base system
+	system_.toGeneralizedJointState(contact_q_, base_pos, joint_pos);
+	system_.toGeneralizedJointState(contact_qd_, base_vel, joint_vel);
+
+	// Computing the point velocities. The kinematics is updated only if the state changed
+	system_.updateKinematics(contact_q_, &contact_qd_);
+	for (unsigned int i = 0; i < body_ids.size(); i++) {
+		rbd::Vector6d point_vel =
+				rbd::computePointVelocity(system_.getRBDModel(),
+										  contact_q_, contact_qd_, body_ids[i],
+										  Eigen::Vector3d::Zero(), false);
+		op_vel[i] = rbd::linearPart(point_vel);
+	}
+}
+
+
 void WholeBodyKinematics::computeAcceleration(rbd::BodyVectorXd& op_acc,
 											  const rbd::Vector6d& base_pos,
 											  const Eigen::VectorXd& joint_pos,
@@ -643,6 +1035,11 @@ void WholeBodyKinematics::computeAcceleration(rbd::BodyVectorXd& op_acc,
 
 	Eigen::VectorXd body_acc(num_vars);
 
+	// Converting the states in the workspace
+	system_.toGeneralizedJointState(contact_q_, base_pos, joint_pos);
+	system_.toGeneralizedJointState(contact_qd_, base_vel, joint_vel);
+	system_.toGeneralizedJointState(contact_qdd_, base_acc, joint_acc);
+
 	// Adding the velocity only for the active end-effectors
 	for (rbd::BodySelector::const_iterator body_iter = body_set.begin();
 			body_iter != body_set.end();
@@ -652,16 +1049,14 @@ void WholeBodyKinematics::computeAcceleration(rbd::BodyVectorXd& op_acc,
 		if (body_id_.count(body_name) > 0) {
 			unsigned int body_id = body_id_.find(body_name)->second;
 
-			Eigen::VectorXd q = system_.toGeneralizedJointState(base_pos, joint_pos);
-			Eigen::VectorXd q_dot = system_.toGeneralizedJointState(base_vel, joint_vel);
-			Eigen::VectorXd q_ddot = system_.toGeneralizedJointState(base_acc, joint_acc);
+			system_.updateKinematics(contact_q_, &contact_qd_, &contact_qdd_);
 
 			// Computing the point acceleration
 			rbd::Vector6d point_acc =
 					rbd::computePointAcceleration(system_.getRBDModel(),
-												  q, q_dot, q_ddot,
+												  contact_q_, contact_qd_, contact_qdd_,
 												  body_id,
-												  Eigen::Vector3d::Zero(), true);
+												  Eigen::Vector3d::Zero(), false);
 			switch (component) {
 			case rbd::Linear:
 				body_acc.segment<3>(0) = rbd::linearPart(point_acc);
@@ -698,6 +1093,136 @@ const rbd::BodyVectorXd& WholeBodyKinematics::computeAcceleration(const rbd::Vec
 }
 
 
+void WholeBodyKinematics::computeContactKinematics(rbd::BodyVectorXd& op_pos,
+												   rbd::BodyVectorXd& op_vel,
+												   rbd::BodyVectorXd& op_acc,
+												   const rbd::Vector6d& base_pos,
+												   const Eigen::VectorXd& joint_pos,
+												   const rbd::Vector6d& base_vel,
+												   const Eigen::VectorXd& joint_vel,
+												   const rbd::Vector6d& base_acc,
+												   const Eigen::VectorXd& joint_acc,
+												   const rbd::BodySelector& body_set)
+{
+	// Converting the states in the workspace
+	system_.toGeneralizedJointState(contact_q_, base_pos, joint_pos);
+	system_.toGeneralizedJointState(contact_qd_, base_vel, joint_vel);
+	system_.toGeneralizedJointState(contact_qdd_, base_acc, joint_acc);
+
+	// Updating the kinematics once, and then reading the three quantities of every body
+	system_.updateKinematics(contact_q_, &contact_qd_, &contact_qdd_);
+	for (rbd::BodySelector::const_iterator body_iter = body_set.begin();
+			body_iter != body_set.end();
+			body_iter++)
+	{
+		const std::string& body_name = *body_iter;
+		rbd::BodyID::const_iterator id_it = body_id_.find(body_name);
+		if (id_it == body_id_.end())
+			continue;
+
+		unsigned int body_id = id_it->second;
+		op_pos[body_name] = CalcBodyToBaseCoordinates(system_.getRBDModel(),
+													  contact_q_, body_id,
+													  Eigen::Vector3d::Zero(), false);
+		rbd::Vector6d point_vel =
+				rbd::computePointVelocity(system_.getRBDModel(),
+										  contact_q_, contact_qd_, body_id,
+										  Eigen::Vector3d::Zero(), false);
+		op_vel[body_name] = rbd::linearPart(point_vel);
+		rbd::Vector6d point_acc =
+				rbd::computePointAcceleration(system_.getRBDModel(),
+											  contact_q_, contact_qd_, contact_qdd_,
+											  body_id,
+											  Eigen::Vector3d::Zero(), false);
+		op_acc[body_name] = rbd::linearPart(point_acc);
+	}
+}
+
+
+void WholeBodyKinematics::computeContactKinematics(WholeBodyTrajectoryContainer& trajectory,
+												   unsigned int num_threads)
+{
+	unsigned int num_points = trajectory.size();
+	if (num_points == 0)
+		return;
+	if (trajectory.getJointDoF() != system_.getJointDoF()) {
+		printf(RED "FATAL: the trajectory has to have %u joints\n" COLOR_RESET,
+				system_.getJointDoF());
+		return;
+	}
+
+	// Getting the body ids of the contacts of the trajectory, where the contacts without a
+	// body are skipped
+	const std::vector<std::string>& contact_names = trajectory.getContactNames();
+	std::vector<unsigned int> contacts, body_ids;
+	for (unsigned int c = 0; c < contact_names.size(); c++) {
+		rbd::BodyID::const_iterator id_it = body_id_.find(contact_names[c]);
+		if (id_it != body_id_.end()) {
+			contacts.push_back(c);
+			body_ids.push_back(id_it->second);
+		}
+	}
+	if (contacts.empty())
+		return;
+
+	// Getting the number of threads, which cannot be bigger than the number of points
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::min(num_threads, num_points);
+
+	// Evaluating a contiguous chunk of points with a given kinematic model. Note that every
+	// point is written only by its chunk
+	auto evaluatePoints = [&](WholeBodyKinematics& kinematics,
+							  unsigned int first, unsigned int last) {
+		FloatingBaseSystem& system = kinematics.system_;
+		for (unsigned int k = first; k < last; k++) {
+			WholeBodyTrajectoryContainer::StateView view = trajectory.getView(k);
+			system.toGeneralizedJointState(kinematics.contact_q_,
+										   (rbd::Vector6d) view.base_pos(),
+										   (Eigen::VectorXd) view.joint_pos());
+			system.toGeneralizedJointState(kinematics.contact_qd_,
+										   (rbd::Vector6d) view.base_vel(),
+										   (Eigen::VectorXd) view.joint_vel());
+			system.toGeneralizedJointState(kinematics.contact_qdd_,
+										   (rbd::Vector6d) view.base_acc(),
+										   (Eigen::VectorXd) view.joint_acc());
+			system.updateKinematics(kinematics.contact_q_,
+									&kinematics.contact_qd_,
+									&kinematics.contact_qdd_);
+
+			for (unsigned int i = 0; i < contacts.size(); i++) {
+				view.contact_pos(contacts[i]) =
+						CalcBodyToBaseCoordinates(system.getRBDModel(),
+												  kinematics.contact_q_, body_ids[i],
+												  Eigen::Vector3d::Zero(), false);
+				rbd::Vector6d point_vel =
+						rbd::computePointVelocity(system.getRBDModel(),
+												  kinematics.contact_q_,
+												  kinematics.contact_qd_, body_ids[i],
+												  Eigen::Vector3d::Zero(), false);
+				view.contact_vel(contacts[i]) = rbd::linearPart(point_vel);
+				rbd::Vector6d point_acc =
+						rbd::computePointAcceleration(system.getRBDModel(),
+													  kinematics.contact_q_,
+													  kinematics.contact_qd_,
+													  kinematics.contact_qdd_, body_ids[i],
+													  Eigen::Vector3d::Zero(), false);
+				view.contact_acc(contacts[i]) = rbd::linearPart(point_acc);
+			}
+		}
+	};
+
+	// Creating the thread-local copies of the kinematic model. Note that the first chunk
+	// uses this model. The chunks are run by the task scheduler
+	unsigned int chunk_size = (num_points + num_threads - 1) / num_threads;
+	std::vector<WholeBodyKinematics> thread_kinematics(num_threads - 1, *this);
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_points);
+		unsigned int last = std::min(first + chunk_size, num_points);
+		evaluatePoints((t == 0) ? *this : thread_kinematics[t - 1], first, last);
+	});
+}
+
 
 void WholeBodyKinematics::computeJdotQdot(rbd::BodyVectorXd& jacd_qd,
 										  const rbd::Vector6d& base_pos,
@@ -2,6 +2,8 @@
 #define DWL__MODEL__WHOLE_BODY_KINEMATICS__H
 
 #include <dwl/model/FloatingBaseSystem.h>
+#include <dwl/model/LegInverseKinematics.h>
+#include <dwl/TrajectoryContainer.h>
 #include <dwl/utils/utils.h>
 
 
@@ -48,12 +50,32 @@ class WholeBodyKinematics
 		/**
 		 * @brief Sets the Ik solver properties
 		 * @param double Step tolerance
-		 * @param double Lambda value for singularities
+		 * @param double Lambda value for singularities, i.e. the initial damping
 		 * @param unsigned int Maximum number of iterations
+		 * @param double Tolerance of the position error of the bodies
 		 */
 		void setIKSolver(double step_tol,
 						 double lambda,
-						 unsigned int max_iter);
+						 unsigned int max_iter,
+						 double error_tol = 1e-8);
+
+		/**
+		 * @brief Sets if the joint position IK starts from the last solution instead of the
+		 * middle joint position, when a initial joint position isn't given
+		 * @param bool Label that indicates if the IK is warm-started
+		 */
+		void setIKWarmStart(bool warm_start);
+
+		/**
+		 * @brief Registers an analytic IK for the branch of a foot, which is used before the
+		 * numerical IK in the joint position computation. Note that the leg IKs are also
+		 * registered from the system file (leg_ik field, e.g. haa_hfe_kfe)
+		 * @param const std::string& Foot name
+		 * @param std::shared_ptr<LegInverseKinematics> Analytic leg IK
+		 * @return bool True if the leg IK supports the branch of the foot
+		 */
+		bool setLegInverseKinematics(const std::string& foot_name,
+									 std::shared_ptr<LegInverseKinematics> leg_ik);
 
 		/**
 		 * @brief Computes the forward kinematics for a predefined set of bodies
@@ -77,6 +99,84 @@ class WholeBodyKinematics
 												 enum rbd::Component component = rbd::Full,
 												 enum TypeOfOrientation type = RollPitchYaw);
 
+		/**
+		 * @brief Computes the forward kinematics of a batch of states, where every
+		 * column of the matrices is a state, i.e. the memory layout of a C-ordered
+		 * NumPy array [N x n]. The positions of the bodies are stacked in the order
+		 * of the body set, where every body has the angular (3 for RPY, 4 for
+		 * quaternion) and linear (3) values of its component. The states are split
+		 * in contiguous chunks that are evaluated in parallel, where each thread
+		 * uses its own copy of the kinematic model. The calling thread evaluates the
+		 * first chunk with this model
+		 * @param Eigen::MatrixXd& Operational position of the bodies per state
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Base position per state [6 x N]
+		 * @param const Eigen::Ref<const Eigen::MatrixXd>& Joint position per state [n x N]
+		 * @param const rbd::BodySelector& A predefined set of bodies
+		 * @param enum rbd::Component There are three different important
+		 * kind of jacobian such as: linear, angular and full
+		 * @param enum TypeOfOrientation Desired type of orientation
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 */
+		void computeForwardKinematics(Eigen::MatrixXd& op_pos,
+									  const Eigen::Ref<const Eigen::MatrixXd>& base_pos,
+									  const Eigen::Ref<const Eigen::MatrixXd>& joint_pos,
+									  const rbd::BodySelector& body_set,
+									  enum rbd::Component component = rbd::Full,
+									  enum TypeOfOrientation type = RollPitchYaw,
+									  unsigned int num_threads = 1);
+
+		/**
+		 * @brief Gets the number of values of the operational position of a body
+		 * @param enum rbd::Component Component of the position
+		 * @param enum TypeOfOrientation Type of orientation
+		 * @return The number of values, i.e. the angular and linear ones
+		 */
+		static unsigned int getPositionDimension(enum rbd::Component component,
+												 enum TypeOfOrientation type);
+
+		/**
+		 * @brief Computes the forward kinematics (linear component) of all the
+		 * end-effectors. The body container is indexed as the end-effector names
+		 * of the floating-base system, and it's reset if it's not the case
+		 * @param rbd::BodyContainer3d& Operational position of end-effectors
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 */
+		void computeForwardKinematics(rbd::BodyContainer3d& op_pos,
+									  const rbd::Vector6d& base_pos,
+									  const Eigen::VectorXd& joint_pos);
+
+		/**
+		 * @brief Computes the forward kinematics (linear component) of an end-effector,
+		 * where only the chain from the base to it is traversed (see
+		 * FloatingBaseSystem::updateBranchKinematics)
+		 * @param Eigen::Vector3d& Operational position of the end-effector
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param unsigned int Index of the end-effector
+		 */
+		void computeBranchForwardKinematics(Eigen::Vector3d& op_pos,
+											const rbd::Vector6d& base_pos,
+											const Eigen::VectorXd& joint_pos,
+											unsigned int end_effector);
+
+		/**
+		 * @brief Computes the forward kinematics and the branch jacobian (linear
+		 * component) of an end-effector with a single traversal of its chain. The
+		 * branch jacobian has the columns of the branch joints, i.e. it's a
+		 * 3 x num_dof matrix of the swing leg
+		 * @param Eigen::Vector3d& Operational position of the end-effector
+		 * @param Eigen::MatrixXd& Branch jacobian
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param unsigned int Index of the end-effector
+		 */
+		void computeBranchKinematics(Eigen::Vector3d& op_pos,
+									 Eigen::MatrixXd& jacobian,
+									 const rbd::Vector6d& base_pos,
+									 const Eigen::VectorXd& joint_pos,
+									 unsigned int end_effector);
+
 
 		/**
 		 * @brief Computes the inverse kinematics for a predefined set of
@@ -103,7 +203,11 @@ class WholeBodyKinematics
 		 * @brief Computes the joint position from a predefined set of
 		 * body positions w.r.t the base.
 		 * This inverse kinematics algorithm uses an operational position which
-		 * consists of the desired 3d position for each body
+		 * consists of the desired 3d position for each body. Every branch (leg) is
+		 * solved independently with a Levenberg-Marquardt iteration, which adapts its
+		 * damping, and it stops once its position error is below the error tolerance.
+		 * The branches with an analytic leg IK are solved in closed form, and the
+		 * numerical IK is only the fallback
 		 * @param const Eigen::VectorXd& Joint position
 		 * @param const rbd::BodyPosition& Operational position of bodies
 		 * @param const Eigen::VectorXd& Initial joint position for the iteration
@@ -163,6 +267,20 @@ class WholeBodyKinematics
 							 const rbd::BodySelector& body_set,
 							 enum rbd::Component component = rbd::Full);
 
+		/**
+		 * @brief Computes the branch jacobian (linear component) of an end-effector,
+		 * i.e. the 3 x num_dof jacobian of its branch joints, where only the chain from
+		 * the base to it is traversed
+		 * @param Eigen::MatrixXd& Branch jacobian
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param unsigned int Index of the end-effector
+		 */
+		void computeBranchJacobian(Eigen::MatrixXd& jacobian,
+								   const rbd::Vector6d& base_pos,
+								   const Eigen::VectorXd& joint_pos,
+								   unsigned int end_effector);
+
 		/**
 		 * @brief Computes the fixed jacobian, without the floating-base
 		 * component, for a certain body.
@@ -199,6 +317,46 @@ class WholeBodyKinematics
 		void getFixedBaseJacobian(Eigen::MatrixXd& jacobian,
 								  const Eigen::MatrixXd& full_jacobian);
 
+		/**
+		 * @brief Computes the stacked (linear) contact jacobian of a set of
+		 * contacts, i.e. a (3 nc)x(n) matrix. The kinematics is updated once
+		 * for all the contacts and the jacobian is filled in place, so it
+		 * doesn't allocate memory if it has already the right dimension
+		 * @param Eigen::MatrixXd& Stacked contact jacobian
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::BodySelector& A predefined set of contacts
+		 * @param bool Label that indicates if the floating-base columns are
+		 * skipped, i.e. the fixed-base jacobian as in getFixedBaseJacobian
+		 */
+		void computeContactJacobian(Eigen::MatrixXd& jacobian,
+									const rbd::Vector6d& base_pos,
+									const Eigen::VectorXd& joint_pos,
+									const rbd::BodySelector& contacts,
+									bool fixed_base = false);
+
+		/**
+		 * @brief Computes the stacked (linear) contact jacobian and J_d*q_d
+		 * vector of a set of contacts in a single kinematics update
+		 * @param Eigen::MatrixXd& Stacked contact jacobian
+		 * @param Eigen::VectorXd& Stacked J_d*q_d vector
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const rbd::BodySelector& A predefined set of contacts
+		 * @param bool Label that indicates if the floating-base columns are
+		 * skipped, i.e. the fixed-base jacobian as in getFixedBaseJacobian
+		 */
+		void computeContactJacobian(Eigen::MatrixXd& jacobian,
+									Eigen::VectorXd& jacd_qd,
+									const rbd::Vector6d& base_pos,
+									const Eigen::VectorXd& joint_pos,
+									const rbd::Vector6d& base_vel,
+									const Eigen::VectorXd& joint_vel,
+									const rbd::BodySelector& contacts,
+									bool fixed_base = false);
+
 		/**
 		 * @brief Computes the operational velocity from the joint space for a
 		 * predefined set of bodies of the robot
@@ -225,6 +383,22 @@ class WholeBodyKinematics
 												 const rbd::BodySelector& body_set,
 												 enum rbd::Component component = rbd::Full);
 
+		/**
+		 * @brief Computes the operational velocity (linear component) of all
+		 * the end-effectors. The body container is indexed as the end-effector
+		 * names of the floating-base system, and it's reset if it's not the case
+		 * @param rbd::BodyContainer3d& Operational velocity of end-effectors
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 */
+		void computeVelocity(rbd::BodyContainer3d& op_vel,
+							 const rbd::Vector6d& base_pos,
+							 const Eigen::VectorXd& joint_pos,
+							 const rbd::Vector6d& base_vel,
+							 const Eigen::VectorXd& joint_vel);
+
 		/**
 		 * @brief Computes the operational acceleration from the joint space
 		 * for a predefined set of bodies of the robot
@@ -257,6 +431,46 @@ class WholeBodyKinematics
 													 const rbd::BodySelector& body_set,
 													 enum rbd::Component component = rbd::Full);
 
+		/**
+		 * @brief Computes the operational position, velocity and acceleration (linear
+		 * component) of a predefined set of bodies, where the kinematics of the rigid-body
+		 * system is updated once for the three quantities
+		 * @param rbd::BodyVectorXd& Operational position of the bodies
+		 * @param rbd::BodyVectorXd& Operational velocity of the bodies
+		 * @param rbd::BodyVectorXd& Operational acceleration of the bodies
+		 * @param const rbd::Vector6d& Base position
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const rbd::Vector6d& Base velocity
+		 * @param const Eigen::VectorXd& Joint velocity
+		 * @param const rbd::Vector6d& Base acceleration
+		 * @param const Eigen::VectorXd& Joint acceleration
+		 * @param const rbd::BodySelector& A predefined set of bodies
+		 */
+		void computeContactKinematics(rbd::BodyVectorXd& op_pos,
+									  rbd::BodyVectorXd& op_vel,
+									  rbd::BodyVectorXd& op_acc,
+									  const rbd::Vector6d& base_pos,
+									  const Eigen::VectorXd& joint_pos,
+									  const rbd::Vector6d& base_vel,
+									  const Eigen::VectorXd& joint_vel,
+									  const rbd::Vector6d& base_acc,
+									  const Eigen::VectorXd& joint_acc,
+									  const rbd::BodySelector& body_set);
+
+		/**
+		 * @brief Computes the contact positions, velocities and accelerations (linear
+		 * component) of every point of a whole-body trajectory from its base and joint
+		 * states, where the kinematics is updated once per point. The contacts of the
+		 * trajectory without a body in the model are left as they are. The points are split
+		 * in contiguous chunks that are evaluated in parallel, where each thread uses its own
+		 * copy of the kinematic model, and the calling thread evaluates the first chunk with
+		 * this model
+		 * @param WholeBodyTrajectoryContainer& Whole-body trajectory
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 */
+		void computeContactKinematics(WholeBodyTrajectoryContainer& trajectory,
+									  unsigned int num_threads = 1);
+
 		/**
 		 * @brief Computes the operational acceleration contribution from the
 		 * joint velocity for a predefined set of bodies of the robot, i.e.
@@ -296,6 +510,23 @@ class WholeBodyKinematics
 
 
 	private:
+		/**
+		 * @brief Computes the position of an IK body w.r.t. the base and, optionally, the
+		 * jacobian of its branch joints. The end-effectors traverse only their branch,
+		 * and the other bodies the whole tree
+		 * @param Eigen::Vector3d& Position of the body
+		 * @param Eigen::MatrixXd* Branch jacobian (it isn't computed if it's NULL)
+		 * @param const Eigen::VectorXd& Joint position
+		 * @param const std::string& Body name
+		 * @param unsigned int Index of the end-effector (the number of end-effectors if
+		 * the body isn't an end-effector)
+		 */
+		void computeIKBranch(Eigen::Vector3d& position,
+							 Eigen::MatrixXd* jacobian,
+							 const Eigen::VectorXd& joint_pos,
+							 const std::string& body_name,
+							 unsigned int end_effector);
+
 		/** @brief Fixed body ids */
 		rbd::BodyID body_id_;
 
@@ -305,15 +536,37 @@ class WholeBodyKinematics
 		/** @brief Middle joint position */
 		Eigen::VectorXd joint_pos_middle_;
 
+		/** @brief Analytic IK of the legs, indexed by the foot names */
+		std::map<std::string, std::shared_ptr<LegInverseKinematics> > leg_ik_;
+
+		/** @brief Lower and upper joint limits */
+		Eigen::VectorXd joint_pos_lower_;
+		Eigen::VectorXd joint_pos_upper_;
+
+		/** @brief Last joint position solution of the IK and a label that indicates if it's
+		 * used as initial joint position */
+		Eigen::VectorXd joint_pos_ik_;
+		bool ik_warm_start_;
+
 		rbd::BodyVectorXd body_pos_;
 		rbd::BodyVectorXd body_vel_;
 		rbd::BodyVectorXd body_acc_;
 		rbd::BodyVectorXd jdot_qdot_;
 
+		/** @brief Workspace of the branch jacobians */
+		Eigen::MatrixXd branch_jac_;
+
+		/** @brief Workspace of the generalized states and the stacked contact jacobian */
+		Eigen::MatrixXd point_jac_;
+		Eigen::VectorXd contact_q_;
+		Eigen::VectorXd contact_qd_;
+		Eigen::VectorXd contact_qdd_;
+
 		/** @brief IK solver */
 		double step_tol_;
 		double lambda_;
 		unsigned int max_iter_;
+		double error_tol_;
 };
 
 } //@namespace model
@@ -0,0 +1,189 @@
+#ifndef DWL__MODEL__AUTO_DIFF_OPTIMIZATION_MODEL__IMPL_H
+#define DWL__MODEL__AUTO_DIFF_OPTIMIZATION_MODEL__IMPL_H
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+template<class TDerived>
+AutoDiffOptimizationModel<TDerived>::AutoDiffOptimizationModel()
+{
+
+}
+
+
+template<class TDerived>
+AutoDiffOptimizationModel<TDerived>::~AutoDiffOptimizationModel()
+{
+
+}
+
+
+template<class TDerived>
+void AutoDiffOptimizationModel<TDerived>::init(bool only_soft_constraints)
+{
+	// The Jacobian and the lower-left triangle of the Hessian are dense
+	SparsityPattern jacobian_pattern(constraint_dimension_, state_dimension_);
+	jacobian_pattern.addDenseBlock(0, 0, constraint_dimension_, state_dimension_);
+	setJacobianSparsity(jacobian_pattern);
+
+	SparsityPattern hessian_pattern(state_dimension_, state_dimension_);
+	hessian_pattern.addLowerTriangularBlock(0, state_dimension_);
+	setHessianSparsity(hessian_pattern);
+}
+
+
+template<class TDerived>
+void AutoDiffOptimizationModel<TDerived>::evaluateCosts(double& cost,
+														const double* decision,
+														int decision_dim)
+{
+	const Eigen::Map<const Eigen::VectorXd> decision_var(decision, decision_dim);
+	cost = derived().computeCost((Eigen::VectorXd) decision_var);
+}
+
+
+template<class TDerived>
+void AutoDiffOptimizationModel<TDerived>::evaluateCostGradient(double* gradient, int grad_dim,
+															   const double* decision,
+															   int decision_dim)
+{
+	// Seeding the decision variables with the unit directions
+	ADVector decision_var(decision_dim);
+	for (int i = 0; i < decision_dim; i++)
+		decision_var(i) = ADScalar(decision[i], decision_dim, i);
+
+	// Computing the cost and its gradient
+	ADScalar cost = derived().computeCost(decision_var);
+
+	Eigen::Map<Eigen::VectorXd> full_gradient(gradient, grad_dim);
+	if (cost.derivatives().size() == 0) // the cost doesn't depend on the decision variables
+		full_gradient.setZero();
+	else
+		full_gradient = cost.derivatives();
+}
+
+
+template<class TDerived>
+void AutoDiffOptimizationModel<TDerived>::evaluateConstraints(double* constraint,
+															  int constraint_dim,
+															  const double* decision,
+															  int decision_dim)
+{
+	const Eigen::Map<const Eigen::VectorXd> decision_var(decision, decision_dim);
+	Eigen::Map<Eigen::VectorXd> full_constraint(constraint, constraint_dim);
+
+	Eigen::VectorXd constraint_var;
+	derived().computeConstraints(constraint_var, (Eigen::VectorXd) decision_var);
+	full_constraint = constraint_var;
+}
+
+
+template<class TDerived>
+void AutoDiffOptimizationModel<TDerived>::evaluateConstraintJacobian(double* jacobian_values,
+																	 int nonzero_dim1,
+																	 int* row_entries,
+																	 int nonzero_dim2,
+																	 int* col_entries,
+																	 int nonzero_dim3,
+																	 const double* decision,
+																	 int decision_dim,
+																	 bool flag)
+{
+	// Returning the (dense) structure of the Jacobian
+	if (flag) {
+		jacobian_pattern_.getStructure(row_entries, col_entries);
+		return;
+	}
+
+	// Seeding the decision variables with the unit directions
+	ADVector decision_var(decision_dim);
+	for (int i = 0; i < decision_dim; i++)
+		decision_var(i) = ADScalar(decision[i], decision_dim, i);
+
+	// Computing the constraints and their Jacobian
+	ADVector constraint_var;
+	derived().computeConstraints(constraint_var, decision_var);
+
+	unsigned int idx = 0;
+	for (unsigned int i = 0; i < constraint_dimension_; i++) {
+		const Eigen::VectorXd& gradient = constraint_var(i).derivatives();
+		for (int j = 0; j < decision_dim; j++) {
+			jacobian_values[idx] = (gradient.size() == 0) ? 0. : gradient(j);
+			++idx;
+		}
+	}
+}
+
+
+template<class TDerived>
+void AutoDiffOptimizationModel<TDerived>::evaluateLagrangianHessian(double* hessian_values,
+																	int nonzero_dim1,
+																	int* row_entries,
+																	int nonzero_dim2,
+																	int* col_entries,
+																	int nonzero_dim3,
+																	double obj_factor,
+																	const double* lagrange,
+																	int constraint_dim,
+																	const double* decision,
+																	int decision_dim,
+																	bool flag)
+{
+	// Returning the structure, i.e. the lower-left triangle of the symmetric matrix
+	if (flag) {
+		hessian_pattern_.getStructure(row_entries, col_entries);
+		return;
+	}
+
+	// Seeding the decision variables for forward-over-forward differentiation, i.e. both the
+	// value and the first derivatives carry the unit directions
+	AD2Vector decision_var(decision_dim);
+	for (int i = 0; i < decision_dim; i++) {
+		decision_var(i).value() = ADScalar(decision[i], decision_dim, i);
+		decision_var(i).derivatives().resize(decision_dim);
+		for (int j = 0; j < decision_dim; j++) {
+			decision_var(i).derivatives()(j) =
+					ADScalar((i == j) ? 1. : 0., Eigen::VectorXd::Zero(decision_dim));
+		}
+	}
+
+	// Computing the Lagrangian
+	AD2Scalar lagrangian = obj_factor * derived().computeCost(decision_var);
+	if (constraint_dim != 0) {
+		AD2Vector constraint_var;
+		derived().computeConstraints(constraint_var, decision_var);
+		for (int i = 0; i < constraint_dim; i++)
+			lagrangian += lagrange[i] * constraint_var(i);
+	}
+
+	// Getting the Hessian values
+	unsigned int idx = 0;
+	for (int row = 0; row < decision_dim; row++) {
+		for (int col = 0; col <= row; col++) {
+			double value = 0.;
+			if (lagrangian.derivatives().size() != 0) {
+				const Eigen::VectorXd& second = lagrangian.derivatives()(row).derivatives();
+				if (second.size() != 0)
+					value = second(col);
+			}
+			hessian_values[idx] = value;
+			++idx;
+		}
+	}
+}
+
+
+template<class TDerived>
+TDerived& AutoDiffOptimizationModel<TDerived>::derived()
+{
+	return *static_cast<TDerived*>(this);
+}
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef DWL__MODEL__WHOLE_BODY_DYNAMICS__IMPL_H
+#define DWL__MODEL__WHOLE_BODY_DYNAMICS__IMPL_H
+
+
+namespace dwl
+{
+
+namespace model
+{
+
+template<int JointDoF, int NumContacts>
+void WholeBodyDynamics::computeInverseDynamics(rbd::Vector6d& base_wrench,
+											   Eigen::Matrix<double,JointDoF,1>& joint_forces,
+											   const FixedWholeBodyState<JointDoF,NumContacts>& state)
+{
+	typedef typename FixedWholeBodyState<JointDoF,NumContacts>::GeneralizedVector GeneralizedVector;
+	if (!system_.isFullyFloatingBase() || system_.getJointDoF() != JointDoF ||
+			system_.getNumberOfEndEffectors() != NumContacts) {
+		printf(RED "FATAL: the fixed-size state (%i joints and %i contacts) doesn't describe"
+				" the floating-base system\n" COLOR_RESET, JointDoF, NumContacts);
+		return;
+	}
+
+	// Writing the generalized joint states in the preallocated workspace
+	Eigen::Map<GeneralizedVector> q(workspace_.q.data());
+	Eigen::Map<GeneralizedVector> q_dot(workspace_.q_dot.data());
+	Eigen::Map<GeneralizedVector> q_ddot(workspace_.q_ddot.data());
+	state.getGeneralizedPosition(q);
+	state.getGeneralizedVelocity(q_dot);
+	state.getGeneralizedAcceleration(q_ddot);
+	workspace_.tau.setZero();
+
+	// Computing the applied external spatial forces for every body
+	convertAppliedExternalForces(workspace_.fext, state.contact_eff, workspace_.q);
+
+	// Computing the inverse dynamics with Recursive Newton-Euler Algorithm (RNEA)
+	RigidBodyDynamics::InverseDynamics(system_.getRBDModel(),
+									   workspace_.q, workspace_.q_dot,
+									   workspace_.q_ddot, workspace_.tau,
+									   &workspace_.fext);
+	system_.invalidateKinematics();
+
+	// Converting the generalized joint forces to base wrench and joint forces. Note that
+	// RBDL defines the floating base state as [linear states, angular states]
+	base_wrench.segment<3>(rbd::LX) = workspace_.tau.head<3>();
+	base_wrench.segment<3>(rbd::AX) = workspace_.tau.segment<3>(3);
+	joint_forces = workspace_.tau.tail<JointDoF>();
+}
+
+} //@namespace model
+} //@namespace dwl
+
+#endif
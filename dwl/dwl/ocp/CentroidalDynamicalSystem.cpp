@@ -26,6 +26,12 @@ CentroidalDynamicalSystem::~CentroidalDynamicalSystem()
 }
 
 
+CentroidalDynamicalSystem* CentroidalDynamicalSystem::clone() const
+{
+	return new CentroidalDynamicalSystem(*this);
+}
+
+
 void CentroidalDynamicalSystem::initDynamicalSystem()
 {
 	// Getting the end-effector names
@@ -46,7 +52,9 @@ void CentroidalDynamicalSystem::computeDynamicalConstraint(Eigen::VectorXd& cons
 	double step_time = state.time - state_buffer_[0].time;
 
 	// Computing the joint acceleration from velocities
-	Eigen::VectorXd base_acc = (state.base_vel - state_buffer_[0].base_vel) / step_time;
+	EvaluationArena::Scope scope(arena_);
+	Eigen::VectorXd& base_acc = scope.getVector();
+	base_acc = (state.base_vel - state_buffer_[0].base_vel) / step_time;
 
 
 	// Computing the centroidal dynamics
@@ -64,7 +72,7 @@ void CentroidalDynamicalSystem::computeDynamicalConstraint(Eigen::VectorXd& cons
 
 
 	// Computing the contact position
-	rbd::BodyVectorXd contact_pos;
+	rbd::BodyVectorXd& contact_pos = scope.getBodyVector();
 	kinematics_.computeForwardKinematics(contact_pos,
 										 state.base_pos, state.joint_pos,
 										 end_effector_names_, rbd::Linear);
@@ -28,6 +28,9 @@ class CentroidalDynamicalSystem : public DynamicalSystem
 		/** @brief Destructor function */
 		~CentroidalDynamicalSystem();
 
+		/** @brief Clones the dynamical system, e.g. for evaluating it in another thread */
+		CentroidalDynamicalSystem* clone() const;
+
 		/** @brief Initializes the centroidal dynamical system constraint */
 		void initDynamicalSystem();
 
@@ -7,7 +7,8 @@ namespace dwl
 namespace ocp
 {
 
-ComplementaryConstraint::ComplementaryConstraint() : complementary_dimension_(0)
+ComplementaryConstraint::ComplementaryConstraint() : complementary_dimension_(0),
+		relaxation_(new double(0.)), bound_relaxation_(0.)
 {
 
 }
@@ -34,6 +35,21 @@ void ComplementaryConstraint::compute(Eigen::VectorXd& constraint,
 	computeFirstComplement(first_constraint, state);
 	computeSecondComplement(second_constraint, state);
 
+	// The relaxation is shared with the clones, so the change of the bounds is detected here
+	if (bound_relaxation_ != *relaxation_) {
+		bound_relaxation_ = *relaxation_;
+		invalidateBounds();
+	}
+
+	// The smoothed formulation condenses every complementary pair in a single equality, i.e.
+	// the Fischer-Burmeister function a + b - sqrt(a^2 + b^2 + 2 epsilon)
+	if (complementary_properties_.formulation == Smoothed) {
+		constraint = first_constraint + second_constraint -
+				(first_constraint.array().square() + second_constraint.array().square() +
+						2 * (*relaxation_)).sqrt().matrix();
+		return;
+	}
+
 	// Resizing the constraint vector
 	constraint.resize(2 * complementary_dimension_ + 1);
 
@@ -49,6 +65,13 @@ void ComplementaryConstraint::compute(Eigen::VectorXd& constraint,
 void ComplementaryConstraint::getBounds(Eigen::VectorXd& lower_bound,
 										Eigen::VectorXd& upper_bound)
 {
+	// The smoothed complementary constraints are equalities
+	if (complementary_properties_.formulation == Smoothed) {
+		lower_bound = Eigen::VectorXd::Zero(complementary_dimension_);
+		upper_bound = Eigen::VectorXd::Zero(complementary_dimension_);
+		return;
+	}
+
 	// Resizing the bounds
 	lower_bound.resize(2 * complementary_dimension_ + 1);
 	upper_bound.resize(2 * complementary_dimension_ + 1);
@@ -59,9 +82,34 @@ void ComplementaryConstraint::getBounds(Eigen::VectorXd& lower_bound,
 	upper_bound.segment(0, 2 * complementary_dimension_) =
 			NO_BOUND * Eigen::VectorXd::Ones(2 * complementary_dimension_);
 
-	// Computing the inner product bounds
+	// Computing the inner product bounds. The relaxed formulation allows an inner product
+	// up to the relaxation, which avoids the degenerate constraints of the strict one
 	lower_bound(2 * complementary_dimension_) = -NO_BOUND;
-	upper_bound(2 * complementary_dimension_) = 0.0;
+	if (complementary_properties_.formulation == Relaxed)
+		upper_bound(2 * complementary_dimension_) = *relaxation_;
+	else
+		upper_bound(2 * complementary_dimension_) = 0.0;
+}
+
+
+void ComplementaryConstraint::setComplementaryProperties(const ComplementaryProperties& properties)
+{
+	complementary_properties_ = properties;
+	*relaxation_ = properties.relaxation;
+	invalidateBounds();
+}
+
+
+void ComplementaryConstraint::updateRelaxation()
+{
+	*relaxation_ = std::max(complementary_properties_.min_relaxation,
+							complementary_properties_.factor * (*relaxation_));
+}
+
+
+double ComplementaryConstraint::getRelaxation() const
+{
+	return *relaxation_;
 }
 
 } //@namespace ocp
@@ -10,6 +10,37 @@ namespace dwl
 namespace ocp
 {
 
+/**
+ * @brief Defines the formulations of the complementary constraints, i.e. 0 <= a _|_ b >= 0:
+ * Strict (a, b >= 0 and a'b <= 0), Relaxed (a, b >= 0 and a'b <= epsilon) and Smoothed
+ * (per-complement Fischer-Burmeister equality a + b - sqrt(a^2 + b^2 + 2 epsilon) = 0)
+ */
+enum ComplementaryFormulation {Strict, Relaxed, Smoothed};
+
+/**
+ * @brief Properties of the formulation of the complementary constraints, and of the homotopy
+ * schedule of its relaxation, i.e. the relaxation is multiplied by the tightening factor after
+ * every solve until it reaches the minimum relaxation
+ */
+struct ComplementaryProperties
+{
+	ComplementaryProperties() : formulation(Strict), relaxation(0.), factor(1.),
+			min_relaxation(0.) {}
+	ComplementaryProperties(enum ComplementaryFormulation _formulation,
+							double _relaxation,
+							double _factor = 1.,
+							double _min_relaxation = 0.) :
+								formulation(_formulation),
+								relaxation(_relaxation),
+								factor(_factor),
+								min_relaxation(_min_relaxation) {}
+
+	enum ComplementaryFormulation formulation;
+	double relaxation;
+	double factor;
+	double min_relaxation;
+};
+
 class ComplementaryConstraint : public Constraint<WholeBodyState>
 {
 	public:
@@ -43,6 +74,23 @@ class ComplementaryConstraint : public Constraint<WholeBodyState>
 		void getBounds(Eigen::VectorXd& lower_bound,
 					   Eigen::VectorXd& upper_bound);
 
+		/**
+		 * @brief Sets the formulation of the complementary constraints and its relaxation
+		 * schedule. Note that the optimal control problem has to be initialized again if the
+		 * formulation changes, since the Smoothed one has fewer rows
+		 * @param const ComplementaryProperties& Complementary properties
+		 */
+		void setComplementaryProperties(const ComplementaryProperties& properties);
+
+		/**
+		 * @brief Tightens the relaxation following its schedule, e.g. after every solve. The
+		 * relaxation is shared with the clones of the constraint
+		 */
+		void updateRelaxation();
+
+		/** @brief Gets the current relaxation of the complementary constraints */
+		double getRelaxation() const;
+
 		/**
 		 * @brief Computes the first complement constraint vector given a certain state
 		 * @param Eigen::VectorXd& Evaluated constraint function
@@ -63,6 +111,15 @@ class ComplementaryConstraint : public Constraint<WholeBodyState>
 	protected:
 		/** @brief Dimension of the complementary constraints */
 		unsigned int complementary_dimension_;
+
+		/** @brief Formulation and relaxation schedule of the complementary constraints */
+		ComplementaryProperties complementary_properties_;
+
+		/** @brief Current relaxation, which is shared with the clones */
+		boost::shared_ptr<double> relaxation_;
+
+		/** @brief Relaxation of the cached bounds of the soft-constraint */
+		double bound_relaxation_;
 };
 
 } //@namespace ocp
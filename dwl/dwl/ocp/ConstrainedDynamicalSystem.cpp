@@ -25,6 +25,12 @@ ConstrainedDynamicalSystem::~ConstrainedDynamicalSystem()
 }
 
 
+ConstrainedDynamicalSystem* ConstrainedDynamicalSystem::clone() const
+{
+	return new ConstrainedDynamicalSystem(*this);
+}
+
+
 void ConstrainedDynamicalSystem::setActiveEndEffectors(const rbd::BodySelector& active_set)
 {
 	active_endeffectors_ = active_set;
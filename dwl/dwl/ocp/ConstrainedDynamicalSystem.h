@@ -27,6 +27,9 @@ class ConstrainedDynamicalSystem : public DynamicalSystem
 		/** @brief Destructor function */
 		~ConstrainedDynamicalSystem();
 
+		/** @brief Clones the dynamical system, e.g. for evaluating it in another thread */
+		ConstrainedDynamicalSystem* clone() const;
+
 		/**
 		 * @brief Sets the active end-effectors, i.e. end-effectors in contact
 		 * @param const rbd::BodySelector& Set of active end-effectors
@@ -3,10 +3,10 @@
 
 #include <dwl/model/WholeBodyKinematics.h>
 #include <dwl/model/WholeBodyDynamics.h>
+#include <dwl/ocp/EvaluationArena.h>
 #include <dwl/utils/URDF.h>
 #include <dwl/utils/utils.h>
 #include <boost/shared_ptr.hpp>
-#include <boost/circular_buffer.hpp>
 
 #define NO_BOUND 2e19
 
@@ -38,6 +38,71 @@ struct SoftConstraintProperties
 	enum SoftConstraintFamily family;
 };
 
+/**
+ * @class StateHistory
+ * @brief Ring buffer of the last states of a constraint. It stores views of the states instead
+ * of copies, so the states have to be alive until the buffer is reset (e.g. the knot states of
+ * the evaluated trajectory). An empty slot is a default state
+ */
+template <class TState>
+class StateHistory
+{
+	public:
+		/** @brief Constructor function */
+		StateHistory() : states_(4, (const TState*) NULL), head_(0), size_(0) {}
+
+		/**
+		 * @brief Sets the capacity of the history, which resets it
+		 * @param unsigned int Capacity
+		 */
+		void set_capacity(unsigned int capacity) {
+			states_.assign(capacity, (const TState*) NULL);
+			clear();
+		}
+
+		/**
+		 * @brief Pushes a state in the front of the history, i.e. the last state
+		 * @param const TState& State, which is not copied
+		 */
+		void push_front(const TState& state) {
+			head_ = (head_ + states_.size() - 1) % states_.size();
+			states_[head_] = &state;
+			size_ = std::min(size_ + 1, (unsigned int) states_.size());
+		}
+
+		/** @brief Clears the history */
+		void clear() {
+			head_ = size_ = 0;
+		}
+
+		/** @brief Gets the number of states in the history */
+		unsigned int size() const {
+			return size_;
+		}
+
+		/**
+		 * @brief Gets a state of the history, where 0 is the last one
+		 * @param unsigned int Index of the state
+		 * @return const TState& State
+		 */
+		const TState& operator[](unsigned int i) const {
+			if (i >= size_) {
+				static const TState empty_state = TState();
+				return empty_state;
+			}
+			return *states_[(head_ + i) % states_.size()];
+		}
+
+
+	private:
+		/** @brief Views of the states */
+		std::vector<const TState*> states_;
+
+		/** @brief Front index and number of states */
+		unsigned int head_;
+		unsigned int size_;
+};
+
 /**
  * @class Constraint
  * @brief Abstract class for defining constraints used in an
@@ -88,13 +153,27 @@ class Constraint
 		virtual void init(bool info = false);
 
 		/**
-		 * @brief Computes the soft-value of the constraint given a certain state
+		 * @brief Clones the constraint, e.g. for evaluating it in another thread. The default
+		 * implementation returns NULL, which means that the constraint cannot be cloned
+		 * @return Constraint<TState>* A new copy of the constraint
+		 */
+		virtual Constraint<TState>* clone() const;
+
+		/**
+		 * @brief Computes the soft-value of the constraint given a certain state. The bounds
+		 * are cached, and the evaluation doesn't allocate memory after the first call
 		 * @param double& Soft-value or the associated cost to the constraint
 		 * @param const TState& Whole-body state
 		 */
 		void computeSoft(double& constraint_cost,
 						 const TState& state);
 
+		/**
+		 * @brief Invalidates the cached bounds of the soft-constraint. It has to be called if
+		 * the bounds change without changing the dimension of the constraint
+		 */
+		void invalidateBounds();
+
 		/**
 		 * @brief Computes the constraint vector given a certain state
 		 * @param Eigen::VectorXd& Evaluated constraint function
@@ -122,14 +201,22 @@ class Constraint
 		void setSoftProperties(const SoftConstraintProperties& properties);
 
 		/**
-		 * @brief Sets the last state that could be used for the constraint
-		 * @param TState& Last whole-body state
+		 * @brief Sets the last state that could be used for the constraint. Note that the
+		 * state isn't copied, so the caller's state has to outlive the next compute call,
+		 * and the caller has to reset the state buffer before the state is destroyed
+		 * @param const TState& Last whole-body state
 		 */
-		void setLastState(TState& last_state);
+		void setLastState(const TState& last_state);
 
 		/** @brief Resets the state buffer */
 		void resetStateBuffer();
 
+		/**
+		 * @brief Gets the arena of the temporaries of the constraint evaluations, which is
+		 * reset at the beginning of every evaluation of the optimal control problem
+		 */
+		EvaluationArena& getEvaluationArena();
+
 		/** @brief Gets the dimension of the constraint */
 		unsigned int getConstraintDimension();
 
@@ -153,8 +240,8 @@ class Constraint
 		/** @brief Soft-constraints properties */
 		SoftConstraintProperties soft_properties_;
 
-		/** @brief Sets the last state */
-		boost::circular_buffer<TState> state_buffer_;
+		/** @brief Views of the last states */
+		StateHistory<TState> state_buffer_;
 
 		/** @brief A floating-base system definition */
 		model::FloatingBaseSystem system_;
@@ -164,6 +251,22 @@ class Constraint
 
 		/** @brief Whole-body dynamical model */
 		model::WholeBodyDynamics dynamics_;
+
+		/** @brief Arena of the temporaries of the evaluations */
+		EvaluationArena arena_;
+
+
+	private:
+		/** @brief Preallocated constraint and violation of the soft-constraint */
+		Eigen::VectorXd soft_constraint_;
+		Eigen::ArrayXd soft_violation_;
+
+		/** @brief Cached bounds of the soft-constraint, without and with the threshold */
+		Eigen::ArrayXd soft_lower_bound_, soft_upper_bound_;
+		Eigen::ArrayXd soft_lower_threshold_, soft_upper_threshold_;
+
+		/** @brief Label that indicates if the bounds of the soft-constraint are cached */
+		bool is_soft_bound_;
 };
 
 } //@namespace ocp
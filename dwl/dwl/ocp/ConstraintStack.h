@@ -0,0 +1,115 @@
+#ifndef DWL__OCP__CONSTRAINT_STACK__H
+#define DWL__OCP__CONSTRAINT_STACK__H
+
+#include <dwl/ocp/Constraint.h>
+#include <tuple>
+#include <type_traits>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+/**
+ * @class ConstraintStack
+ * @brief Compile-time composition of a fixed set of constraints, which is added to the optimal
+ * control problem as a single constraint. The constraints are stored by value (already
+ * initialized, e.g. with their models) and evaluated with non-virtual calls, so a knot
+ * evaluates all of them with one virtual call. The constraint vector and bounds are the
+ * concatenation of the composed ones, and the stack is soft or hard as a whole. The last state
+ * is forwarded to every constraint before its evaluation
+ */
+template <typename... TConstraints>
+class ConstraintStack : public Constraint<WholeBodyState>
+{
+	public:
+		/** @brief Constructor function */
+		ConstraintStack();
+
+		/**
+		 * @brief Constructor function from copies of the constraints
+		 * @param const TConstraints&... Constraints
+		 */
+		ConstraintStack(const TConstraints&... constraints);
+
+		/** @brief Destructor function */
+		~ConstraintStack();
+
+		/**
+		 * @brief Initializes the dimension of the stack from the composed constraints. It has
+		 * to be called if a constraint changes its dimension through get<I>()
+		 * @param Print model information
+		 */
+		void init(bool info = false);
+
+		/** @brief Clones the stack and its constraints, e.g. for evaluating it in another
+		 * thread */
+		ConstraintStack<TConstraints...>* clone() const;
+
+		/**
+		 * @brief Computes the concatenated constraint vector given a certain state
+		 * @param Eigen::VectorXd& Evaluated constraint function
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void compute(Eigen::VectorXd& constraint,
+					 const WholeBodyState& state);
+
+		/**
+		 * @brief Gets the concatenated lower and upper bounds of the constraints
+		 * @param Eigen::VectorXd& Lower constraint bound
+		 * @param Eigen::VectorXd& Upper constraint bound
+		 */
+		void getBounds(Eigen::VectorXd& lower_bound,
+					   Eigen::VectorXd& upper_bound);
+
+		/** @brief Gets the I-th constraint of the stack */
+		template <std::size_t I>
+		typename std::tuple_element<I, std::tuple<TConstraints...> >::type& get();
+
+
+	private:
+		typedef std::integral_constant<std::size_t, sizeof...(TConstraints)> EndIndex;
+
+		/** @brief Sums the dimensions of the constraints from the I-th one */
+		template <std::size_t I>
+		unsigned int getTermsDimension(std::integral_constant<std::size_t, I>);
+		unsigned int getTermsDimension(EndIndex) { return 0; }
+
+		/** @brief Computes the constraints from the I-th one, which start at the index */
+		template <std::size_t I>
+		void computeTerms(Eigen::VectorXd& constraint,
+						  const WholeBodyState& state,
+						  unsigned int index,
+						  std::integral_constant<std::size_t, I>);
+		void computeTerms(Eigen::VectorXd& constraint,
+						  const WholeBodyState& state,
+						  unsigned int index,
+						  EndIndex) {}
+
+		/** @brief Gets the bounds of the constraints from the I-th one, which start at the
+		 * index */
+		template <std::size_t I>
+		void getTermsBounds(Eigen::VectorXd& lower_bound,
+							Eigen::VectorXd& upper_bound,
+							unsigned int index,
+							std::integral_constant<std::size_t, I>);
+		void getTermsBounds(Eigen::VectorXd& lower_bound,
+							Eigen::VectorXd& upper_bound,
+							unsigned int index,
+							EndIndex) {}
+
+		/** @brief Constraints of the stack */
+		std::tuple<TConstraints...> constraints_;
+
+		/** @brief Preallocated vector of a composed constraint */
+		Eigen::VectorXd term_constraint_;
+};
+
+} //@namespace ocp
+} //@namespace dwl
+
+#include <dwl/ocp/impl/ConstraintStack.hpp>
+
+#endif
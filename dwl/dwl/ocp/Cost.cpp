@@ -19,6 +19,12 @@ Cost::~Cost()
 }
 
 
+Cost* Cost::clone() const
+{
+	return NULL;
+}
+
+
 void Cost::setWeights(const WholeBodyState& weights)
 {
 	// Checking the cost variables
@@ -76,6 +82,12 @@ void Cost::setDesiredState(const WholeBodyState& desired_state)
 }
 
 
+const WholeBodyState& Cost::getDesiredState() const
+{
+	return desired_state_;
+}
+
+
 std::string Cost::getName()
 {
 	return name_;
@@ -52,6 +52,13 @@ class Cost
 		virtual void compute(double& cost,
 							 const WholeBodyState& state) = 0;
 
+		/**
+		 * @brief Clones the cost, e.g. for evaluating it in another thread. The default
+		 * implementation returns NULL, which means that the cost cannot be cloned
+		 * @return Cost* A new copy of the cost
+		 */
+		virtual Cost* clone() const;
+
 		/**
 		 * @brief Sets the whole-body state weights which are used by specific cost function
 		 * @param WholeBodyState& Whole-body weights
@@ -59,10 +66,16 @@ class Cost
 		void setWeights(const WholeBodyState& weights);
 
 		/**
-		 * @brief Sets the desired whole-body state
+		 * @brief Sets the desired whole-body state, which is forwarded by the composed costs
 		 * @param const WholeBodyState& Desired whole-body state
 		 */
-		void setDesiredState(const WholeBodyState& desired_state);
+		virtual void setDesiredState(const WholeBodyState& desired_state);
+
+		/**
+		 * @brief Gets the desired whole-body state
+		 * @return const WholeBodyState& Desired whole-body state
+		 */
+		const WholeBodyState& getDesiredState() const;
 
 		/**
 		 * @brief Gets the name of the cost
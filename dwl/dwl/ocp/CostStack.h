@@ -0,0 +1,89 @@
+#ifndef DWL__OCP__COST_STACK__H
+#define DWL__OCP__COST_STACK__H
+
+#include <dwl/ocp/Cost.h>
+#include <tuple>
+#include <type_traits>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+/**
+ * @class CostStack
+ * @brief Compile-time composition of a fixed set of costs, which is added to the optimal
+ * control problem as a single cost. The costs are stored by value and evaluated with
+ * non-virtual calls, so a knot evaluates all of them with one virtual call and the terms are
+ * contiguous in memory. The desired state is forwarded to every cost, and the rest of their
+ * properties (e.g. the weights) are set through get<I>()
+ */
+template <typename... TCosts>
+class CostStack : public Cost
+{
+	public:
+		/** @brief Constructor function */
+		CostStack();
+
+		/**
+		 * @brief Constructor function from copies of the costs
+		 * @param const TCosts&... Costs
+		 */
+		CostStack(const TCosts&... costs);
+
+		/** @brief Destructor function */
+		~CostStack();
+
+		/** @brief Clones the stack and its costs, e.g. for evaluating it in another thread */
+		CostStack<TCosts...>* clone() const;
+
+		/**
+		 * @brief Computes the sum of the costs given a certain state
+		 * @param double& Cost value
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void compute(double& cost,
+					 const WholeBodyState& state);
+
+		/**
+		 * @brief Sets the desired whole-body state of the stack and its costs
+		 * @param const WholeBodyState& Desired whole-body state
+		 */
+		void setDesiredState(const WholeBodyState& desired_state);
+
+		/** @brief Gets the I-th cost of the stack */
+		template <std::size_t I>
+		typename std::tuple_element<I, std::tuple<TCosts...> >::type& get();
+
+
+	private:
+		typedef std::integral_constant<std::size_t, sizeof...(TCosts)> EndIndex;
+
+		/** @brief Computes the costs from the I-th one */
+		template <std::size_t I>
+		void computeTerms(double& cost,
+						  const WholeBodyState& state,
+						  std::integral_constant<std::size_t, I>);
+		void computeTerms(double& cost,
+						  const WholeBodyState& state,
+						  EndIndex) {}
+
+		/** @brief Sets the desired state of the costs from the I-th one */
+		template <std::size_t I>
+		void setTermsDesiredState(const WholeBodyState& desired_state,
+								  std::integral_constant<std::size_t, I>);
+		void setTermsDesiredState(const WholeBodyState& desired_state,
+								  EndIndex) {}
+
+		/** @brief Costs of the stack */
+		std::tuple<TCosts...> costs_;
+};
+
+} //@namespace ocp
+} //@namespace dwl
+
+#include <dwl/ocp/impl/CostStack.hpp>
+
+#endif
@@ -1,4 +1,5 @@
 #include <dwl/ocp/DynamicalSystem.h>
+#include <dwl/utils/Instrumentation.h>
 
 
 namespace dwl
@@ -8,7 +9,8 @@ namespace ocp
 {
 
 DynamicalSystem::DynamicalSystem() : state_dimension_(0), terminal_constraint_dimension_(0),
-		system_variables_(false), integration_method_(Fixed), step_time_(0.1),
+		system_variables_(false), integration_method_(Fixed),
+		integration_scheme_(EulerBackward), integration_substeps_(1), step_time_(0.1),
 		is_full_trajectory_optimization_(false)
 {
 
@@ -49,6 +51,12 @@ void DynamicalSystem::initDynamicalSystem()
 }
 
 
+DynamicalSystem* DynamicalSystem::clone() const
+{
+	return NULL;
+}
+
+
 void DynamicalSystem::jointLimitsFromURDF()
 {
 	// Initializing the joint limits
@@ -79,12 +87,15 @@ void DynamicalSystem::jointLimitsFromURDF()
 void DynamicalSystem::compute(Eigen::VectorXd& constraint,
 							  const WholeBodyState& state)
 {
+	DWL_SCOPED_TIMER("DynamicalSystem::compute");
+
 	// Evaluating the numerical integration
-	Eigen::VectorXd time_constraint;
+	EvaluationArena::Scope scope(arena_);
+	Eigen::VectorXd& time_constraint = scope.getVector();
 	numericalIntegration(time_constraint, state);
 
 	// Computing the dynamical constraint
-	Eigen::VectorXd dynamical_constraint;
+	Eigen::VectorXd& dynamical_constraint = scope.getVector();
 	computeDynamicalConstraint(dynamical_constraint, state);
 
 	// Adding both constraints
@@ -103,18 +114,30 @@ void DynamicalSystem::computeDynamicalConstraint(Eigen::VectorXd& constraint,
 }
 
 
+bool DynamicalSystem::computeDynamicalJacobian(Eigen::MatrixXd& state_jacobian,
+											   Eigen::MatrixXd& last_state_jacobian,
+											   const WholeBodyState& state)
+{
+	return false;
+}
+
+
 void DynamicalSystem::computeTerminalConstraint(Eigen::VectorXd& constraint,
 												const WholeBodyState& state)
 {
 	constraint.resize(system_.getFloatingBaseDoF());
 
-	// Computing the position error
-	Eigen::VectorXd position_error =
-			system_.toGeneralizedJointState(terminal_state_.base_pos, terminal_state_.joint_pos) -
-			system_.toGeneralizedJointState(state.base_pos, state.joint_pos);
+	// Computing the position error. Note that the generalized states are converted in
+	// different buffers, since the returned one is shared by every conversion
+	EvaluationArena::Scope scope(arena_);
+	Eigen::VectorXd& terminal_pos = scope.getVector();
+	Eigen::VectorXd& state_pos = scope.getVector();
+	system_.toGeneralizedJointState(terminal_pos,
+									terminal_state_.base_pos, terminal_state_.joint_pos);
+	system_.toGeneralizedJointState(state_pos, state.base_pos, state.joint_pos);
 
 	// Adding the terminal constraint
-	constraint = position_error.head(system_.getFloatingBaseDoF());
+	constraint = (terminal_pos - state_pos).head(system_.getFloatingBaseDoF());
 }
 
 
@@ -124,16 +147,217 @@ void DynamicalSystem::numericalIntegration(Eigen::VectorXd& constraint,
 	// Resizing the constraint vector
 	constraint.resize(system_.getSystemDoF());
 
-	// Transcription of the constrained inverse dynamic equation using Euler-backward integration.
-	// This integration method adds numerical stability
-	Eigen::VectorXd base_int = state_buffer_[0].base_pos - state.base_pos + state.duration * state.base_vel;
-	Eigen::VectorXd joint_int = state_buffer_[0].joint_pos - state.joint_pos + state.duration * state.joint_vel;
+	// Transcription of the constrained inverse dynamic equation with the integration scheme,
+	// i.e. q_{k-1} - q_k + dt * (w0 * qd_{k-1} + w1 * qd_k) + dt^2 * (u0 * qdd_{k-1} + u1 * qdd_k).
+	// The default Euler-backward integration (w = [0 1], u = [0 0]) adds numerical stability,
+	// and the higher-order schemes allow coarser time discretizations
+	const WholeBodyState& last_state = state_buffer_[0];
+	Eigen::Vector2d w, u;
+	getIntegrationWeights(w, u);
+	double dt = state.duration;
+	EvaluationArena::Scope scope(arena_);
+	Eigen::VectorXd& base_int = scope.getVector();
+	Eigen::VectorXd& joint_int = scope.getVector();
+	base_int = last_state.base_pos - state.base_pos +
+			dt * (w(0) * last_state.base_vel + w(1) * state.base_vel);
+	joint_int = last_state.joint_pos - state.joint_pos +
+			dt * (w(0) * last_state.joint_vel + w(1) * state.joint_vel);
+	if (system_variables_.acceleration) {
+		base_int += dt * dt * (u(0) * last_state.base_acc + u(1) * state.base_acc);
+		joint_int += dt * dt * (u(0) * last_state.joint_acc + u(1) * state.joint_acc);
+	}
 
 	// Adding the time integration constraint
 	constraint = system_.toGeneralizedJointState(base_int, joint_int);
 }
 
 
+void DynamicalSystem::estimateIntegrationError(Eigen::VectorXd& error,
+											   const WholeBodyState& state)
+{
+	// The solved states fulfill the integration with the defined substeps, so the residual
+	// with twice the substeps is the local error of the step. Both residuals are subtracted,
+	// so the estimation doesn't depend on the tolerance of the solver
+	Eigen::VectorXd constraint, refined_constraint;
+	numericalIntegration(constraint, state);
+
+	unsigned int num_substeps = integration_substeps_;
+	integration_substeps_ = 2 * num_substeps;
+	numericalIntegration(refined_constraint, state);
+	integration_substeps_ = num_substeps;
+
+	error = refined_constraint - constraint;
+}
+
+
+void DynamicalSystem::computeIntegrationJacobian(Eigen::MatrixXd& state_jacobian,
+												 Eigen::MatrixXd& last_state_jacobian,
+												 const WholeBodyState& state)
+{
+	// Resizing the Jacobian matrices
+	unsigned int system_dof = system_.getSystemDoF();
+	state_jacobian.setZero(system_dof, state_dimension_);
+	last_state_jacobian.setZero(system_dof, state_dimension_);
+
+	// Filling the Jacobians following the order of the generalized state vector. Note that
+	// the integration constraint is q_{k-1} - q_k + dt_k * (w0 * qd_{k-1} + w1 * qd_k) +
+	// dt_k^2 * (u0 * qdd_{k-1} + u1 * qdd_k)
+	const WholeBodyState& last_state = state_buffer_[0];
+	Eigen::Vector2d w, u;
+	getIntegrationWeights(w, u);
+	double dt = state.duration;
+	Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(system_dof, system_dof);
+	unsigned int idx = 0;
+	if (system_variables_.time) {
+		// Converting the states in different buffers, since they are used in the same
+		// expression
+		Eigen::VectorXd last_gen_state, gen_state;
+		system_.toGeneralizedJointState(last_gen_state, last_state.base_vel, last_state.joint_vel);
+		system_.toGeneralizedJointState(gen_state, state.base_vel, state.joint_vel);
+		state_jacobian.col(idx) = w(0) * last_gen_state + w(1) * gen_state;
+		if (system_variables_.acceleration) {
+			system_.toGeneralizedJointState(last_gen_state,
+											last_state.base_acc, last_state.joint_acc);
+			system_.toGeneralizedJointState(gen_state, state.base_acc, state.joint_acc);
+			state_jacobian.col(idx) += 2 * dt * (u(0) * last_gen_state + u(1) * gen_state);
+		}
+		++idx;
+	}
+	if (system_variables_.position) {
+		state_jacobian.block(0, idx, system_dof, system_dof) = -identity;
+		last_state_jacobian.block(0, idx, system_dof, system_dof) = identity;
+		idx += system_dof;
+	}
+	if (system_variables_.velocity) {
+		state_jacobian.block(0, idx, system_dof, system_dof) = dt * w(1) * identity;
+		last_state_jacobian.block(0, idx, system_dof, system_dof) = dt * w(0) * identity;
+		idx += system_dof;
+	}
+	if (system_variables_.acceleration) {
+		state_jacobian.block(0, idx, system_dof, system_dof) = dt * dt * u(1) * identity;
+		last_state_jacobian.block(0, idx, system_dof, system_dof) = dt * dt * u(0) * identity;
+	}
+}
+
+void DynamicalSystem::computeCollocationConstraint(Eigen::VectorXd& constraint,
+												   const WholeBodyTrajectory& support_states,
+												   const Eigen::VectorXd& diff_weights,
+												   double phase_duration,
+												   const WholeBodyState& state)
+{
+	// The derivative of the interpolating polynomial at the node is D_i * q / (T/2), so the
+	// constraint T * qd_i - 2 * D_i * q follows the sign of the Euler-backward integration
+	constraint = phase_duration * system_.toGeneralizedJointState(state.base_vel,
+																  state.joint_vel);
+	for (unsigned int j = 0; j < support_states.size(); j++) {
+		constraint -= 2 * diff_weights(j) *
+				system_.toGeneralizedJointState(support_states[j].base_pos,
+												support_states[j].joint_pos);
+	}
+}
+
+
+void DynamicalSystem::computeCollocationJacobian(Eigen::MatrixXd& support_jacobian,
+												 double diff_weight,
+												 double phase_duration,
+												 bool is_knot)
+{
+	// Resizing the Jacobian matrix
+	unsigned int system_dof = system_.getSystemDoF();
+	support_jacobian.setZero(system_dof, state_dimension_);
+
+	// Filling the Jacobian following the order of the generalized state vector
+	Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(system_dof, system_dof);
+	unsigned int idx = system_variables_.time;
+	if (system_variables_.position) {
+		support_jacobian.block(0, idx, system_dof, system_dof) = -2 * diff_weight * identity;
+		idx += system_dof;
+	}
+	if (system_variables_.velocity && is_knot)
+		support_jacobian.block(0, idx, system_dof, system_dof) = phase_duration * identity;
+}
+
+
+
+void DynamicalSystem::computeTerminalJacobian(Eigen::MatrixXd& jacobian,
+											  const WholeBodyState& state)
+{
+	// Resizing the Jacobian matrix
+	unsigned int base_dof = system_.getFloatingBaseDoF();
+	jacobian.setZero(base_dof, state_dimension_);
+
+	// The terminal constraint is the floating-base position error, so its Jacobian is a
+	// negative identity in the floating-base position of the generalized state
+	if (system_variables_.position) {
+		unsigned int idx = system_variables_.time;
+		jacobian.block(0, idx, base_dof, base_dof) =
+				-Eigen::MatrixXd::Identity(base_dof, base_dof);
+	}
+}
+
+
+void DynamicalSystem::getIntegrationSparsity(model::SparsityPattern& state_pattern,
+											 model::SparsityPattern& last_state_pattern)
+{
+	unsigned int system_dof = system_.getSystemDoF();
+	state_pattern.resize(system_dof, state_dimension_);
+	last_state_pattern.resize(system_dof, state_dimension_);
+
+	// Following the same structure than computeIntegrationJacobian
+	Eigen::Vector2d w, u;
+	getIntegrationWeights(w, u);
+	unsigned int idx = 0;
+	if (system_variables_.time) {
+		state_pattern.addDenseBlock(0, idx, system_dof, 1);
+		++idx;
+	}
+	if (system_variables_.position) {
+		state_pattern.addDiagonalBlock(0, idx, system_dof);
+		last_state_pattern.addDiagonalBlock(0, idx, system_dof);
+		idx += system_dof;
+	}
+	if (system_variables_.velocity) {
+		if (w(1) != 0.)
+			state_pattern.addDiagonalBlock(0, idx, system_dof);
+		if (w(0) != 0.)
+			last_state_pattern.addDiagonalBlock(0, idx, system_dof);
+		idx += system_dof;
+	}
+	if (system_variables_.acceleration) {
+		if (u(1) != 0.)
+			state_pattern.addDiagonalBlock(0, idx, system_dof);
+		if (u(0) != 0.)
+			last_state_pattern.addDiagonalBlock(0, idx, system_dof);
+	}
+}
+
+void DynamicalSystem::getCollocationSparsity(model::SparsityPattern& support_pattern,
+											 bool is_knot)
+{
+	unsigned int system_dof = system_.getSystemDoF();
+	support_pattern.resize(system_dof, state_dimension_);
+
+	// Following the same structure than computeCollocationJacobian
+	unsigned int idx = system_variables_.time;
+	if (system_variables_.position) {
+		support_pattern.addDiagonalBlock(0, idx, system_dof);
+		idx += system_dof;
+	}
+	if (system_variables_.velocity && is_knot)
+		support_pattern.addDiagonalBlock(0, idx, system_dof);
+}
+
+
+
+void DynamicalSystem::getTerminalSparsity(model::SparsityPattern& pattern)
+{
+	unsigned int base_dof = system_.getFloatingBaseDoF();
+	pattern.resize(base_dof, state_dimension_);
+	if (system_variables_.position)
+		pattern.addDiagonalBlock(0, system_variables_.time, base_dof);
+}
+
+
 void DynamicalSystem::getBounds(Eigen::VectorXd& lower_bound,
 								Eigen::VectorXd& upper_bound)
 {
@@ -183,6 +407,23 @@ void DynamicalSystem::setStepIntegrationMethod(StepIntegrationMethod method)
 }
 
 
+void DynamicalSystem::setIntegrationScheme(IntegrationScheme scheme)
+{
+	integration_scheme_ = scheme;
+}
+
+
+void DynamicalSystem::setIntegrationSubsteps(unsigned int num_substeps)
+{
+	if (num_substeps == 0) {
+		printf(YELLOW "Warning: the number of integration substeps has to be positive, so it"
+				" is set to 1\n" COLOR_RESET);
+		num_substeps = 1;
+	}
+	integration_substeps_ = num_substeps;
+}
+
+
 void DynamicalSystem::setStepIntegrationTime(const double& step_time)
 {
 	step_time_ = step_time;
@@ -253,6 +494,12 @@ unsigned int DynamicalSystem::getTerminalConstraintDimension()
 }
 
 
+unsigned int DynamicalSystem::getIntegrationDimension()
+{
+	return system_.getSystemDoF();
+}
+
+
 model::FloatingBaseSystem& DynamicalSystem::getFloatingBaseSystem()
 {
 	return system_;
@@ -272,68 +519,59 @@ void DynamicalSystem::setFullTrajectoryOptimization()
 
 
 void DynamicalSystem::toWholeBodyState(WholeBodyState& system_state,
-									   const Eigen::VectorXd& generalized_state)
+									   const Eigen::Ref<const Eigen::VectorXd>& generalized_state)
 {
-	// Resizing the joint dimensions
-	system_state.joint_pos = Eigen::VectorXd::Zero(system_.getJointDoF());
-	system_state.joint_vel = Eigen::VectorXd::Zero(system_.getJointDoF());
-	system_state.joint_acc = Eigen::VectorXd::Zero(system_.getJointDoF());
-	system_state.joint_eff = Eigen::VectorXd::Zero(system_.getJointDoF());
-
-	// Converting the generalized state vector to locomotion state
-	unsigned int idx = 0;
-	if (system_variables_.time) {
-		system_state.duration = generalized_state(idx);
-		++idx;
-	}
-	if (system_variables_.position) {
+	// Resizing the joint dimensions. Note that the vectors aren't reallocated when the
+	// whole-body state is reused
+	unsigned int num_joints = system_.getJointDoF();
+	unsigned int num_dofs = system_.getSystemDoF();
+	system_state.joint_pos.setZero(num_joints);
+	system_state.joint_vel.setZero(num_joints);
+	system_state.joint_acc.setZero(num_joints);
+	system_state.joint_eff.setZero(num_joints);
+	system_state.base_pos.setZero();
+	system_state.base_vel.setZero();
+	system_state.base_acc.setZero();
+	system_state.base_eff.setZero();
+
+	// Converting the generalized state vector to locomotion state from the segments of the
+	// decision state layout
+	const DecisionStateLayout& layout = state_layout_;
+	if (layout.time >= 0)
+		system_state.duration = generalized_state(layout.time);
+	if (layout.position >= 0)
 		system_.fromGeneralizedJointState(system_state.base_pos,
 										  system_state.joint_pos,
-										  (Eigen::VectorXd) generalized_state.segment(idx, system_.getSystemDoF()));
-		idx += system_.getSystemDoF();
-	}
-	if (system_variables_.velocity) {
+										  generalized_state.segment(layout.position, num_dofs));
+	if (layout.velocity >= 0)
 		system_.fromGeneralizedJointState(system_state.base_vel,
 										  system_state.joint_vel,
-										  (Eigen::VectorXd) generalized_state.segment(idx, system_.getSystemDoF()));
-		idx += system_.getSystemDoF();
-	}
-	if (system_variables_.acceleration) {
+										  generalized_state.segment(layout.velocity, num_dofs));
+	if (layout.acceleration >= 0)
 		system_.fromGeneralizedJointState(system_state.base_acc,
 										  system_state.joint_acc,
-										  (Eigen::VectorXd) generalized_state.segment(idx, system_.getSystemDoF()));
-		idx += system_.getSystemDoF();
-	}
-	if (system_variables_.effort) {
-		// Defining a fake floating-base system (fixed-base) for converting only joint effort
-		model::FloatingBaseSystem fake_system(false, system_.getJointDoF());
-		fake_system.fromGeneralizedJointState(system_state.base_eff,
-											  system_state.joint_eff,
-											  (Eigen::VectorXd) generalized_state.segment(idx, system_.getJointDoF()));
-		idx += system_.getJointDoF();
-	}
-	if (system_variables_.contact_pos || system_variables_.contact_vel ||
-			system_variables_.contact_acc || system_variables_.contact_for) {
-		urdf_model::LinkID contact_links = system_.getEndEffectors();
-		for (urdf_model::LinkID::const_iterator contact_it = contact_links.begin();
-				contact_it != contact_links.end(); contact_it++) {
-			std::string name = contact_it->first;
-
-			if (system_variables_.contact_pos) {
-				system_state.contact_pos[name] = generalized_state.segment<3>(idx);
-				idx += 3;
-			}
-			if (system_variables_.contact_vel) {
-				system_state.contact_vel[name] = generalized_state.segment<3>(idx);
-				idx += 3;
-			}
-			if (system_variables_.contact_acc) {
-				system_state.contact_acc[name] = generalized_state.segment<3>(idx);
-				idx += 3;
-			}
-			if (system_variables_.contact_for) {
-				system_state.contact_eff[name] << 0, 0, 0, generalized_state.segment<3>(idx);
-				idx += 3;
+										  generalized_state.segment(layout.acceleration, num_dofs));
+	if (layout.effort >= 0)
+		system_state.joint_eff = generalized_state.segment(layout.effort, num_joints);
+	if (layout.contact >= 0) {
+		for (unsigned int i = 0; i < layout.contact_names.size(); i++) {
+			const std::string& name = layout.contact_names[i];
+			unsigned int idx = layout.contact + i * layout.contact_dim;
+
+			if (layout.contact_pos >= 0)
+				system_state.contact_pos[name] =
+						generalized_state.segment<3>(idx + layout.contact_pos);
+			if (layout.contact_vel >= 0)
+				system_state.contact_vel[name] =
+						generalized_state.segment<3>(idx + layout.contact_vel);
+			if (layout.contact_acc >= 0)
+				system_state.contact_acc[name] =
+						generalized_state.segment<3>(idx + layout.contact_acc);
+			if (layout.contact_for >= 0) {
+				rbd::Vector6d& contact_eff = system_state.contact_eff[name];
+				contact_eff.segment<3>(rbd::AX).setZero();
+				contact_eff.segment<3>(rbd::LX) =
+						generalized_state.segment<3>(idx + layout.contact_for);
 			}
 		}
 	}
@@ -406,6 +644,18 @@ void DynamicalSystem::fromWholeBodyState(Eigen::VectorXd& generalized_state,
 }
 
 
+const WholeBodyVariables& DynamicalSystem::getDecisionVariables()
+{
+	return system_variables_;
+}
+
+
+const DecisionStateLayout& DynamicalSystem::getDecisionStateLayout()
+{
+	return state_layout_;
+}
+
+
 bool DynamicalSystem::isFixedStepIntegration()
 {
 	return !system_variables_.time;
@@ -427,6 +677,111 @@ void DynamicalSystem::computeStateDimension()
 			(system_variables_.contact_pos + system_variables_.contact_vel +
 					system_variables_.contact_acc + system_variables_.contact_for) *
 					system_.getNumberOfEndEffectors();
+
+	// Computing the offsets of the whole-body variables in the decision state
+	state_layout_ = DecisionStateLayout();
+	int idx = 0;
+	if (system_variables_.time)
+		state_layout_.time = idx++;
+	if (system_variables_.position) {
+		state_layout_.position = idx;
+		idx += system_.getSystemDoF();
+	}
+	if (system_variables_.velocity) {
+		state_layout_.velocity = idx;
+		idx += system_.getSystemDoF();
+	}
+	if (system_variables_.acceleration) {
+		state_layout_.acceleration = idx;
+		idx += system_.getSystemDoF();
+	}
+	if (system_variables_.effort) {
+		state_layout_.effort = idx;
+		idx += system_.getJointDoF();
+	}
+	if (system_variables_.contact_pos || system_variables_.contact_vel ||
+			system_variables_.contact_acc || system_variables_.contact_for) {
+		state_layout_.contact = idx;
+		if (system_variables_.contact_pos) {
+			state_layout_.contact_pos = state_layout_.contact_dim;
+			state_layout_.contact_dim += 3;
+		}
+		if (system_variables_.contact_vel) {
+			state_layout_.contact_vel = state_layout_.contact_dim;
+			state_layout_.contact_dim += 3;
+		}
+		if (system_variables_.contact_acc) {
+			state_layout_.contact_acc = state_layout_.contact_dim;
+			state_layout_.contact_dim += 3;
+		}
+		if (system_variables_.contact_for) {
+			state_layout_.contact_for = state_layout_.contact_dim;
+			state_layout_.contact_dim += 3;
+		}
+
+		const urdf_model::LinkID& contact_links = system_.getEndEffectors();
+		for (urdf_model::LinkID::const_iterator contact_it = contact_links.begin();
+				contact_it != contact_links.end(); contact_it++)
+			state_layout_.contact_names.push_back(contact_it->first);
+	}
+}
+
+
+void DynamicalSystem::getIntegrationWeights(Eigen::Vector2d& vel_weights,
+											Eigen::Vector2d& acc_weights) const
+{
+	// Weights of the scheme in a single substep
+	Eigen::Vector2d w, u;
+	switch (integration_scheme_) {
+	case EulerBackward:
+		w << 0., 1.;
+		u << 0., 0.;
+		break;
+	case ImplicitMidpoint:
+		w << 0.5, 0.5;
+		u << 0., 0.;
+		break;
+	case RungeKutta4:
+		// RK4 of the positions and velocities with a linear acceleration along the step
+		w << 1., 0.;
+		u << 1. / 3., 1. / 6.;
+		break;
+	case HermiteSimpson:
+		// Simpson quadrature with the velocity of the Hermite interpolation at the midpoint
+		w << 0.5, 0.5;
+		u << 1. / 12., -1. / 12.;
+		break;
+	}
+
+	// The scheme is applied in every substep of the cubic Hermite interpolation of the
+	// velocities of the knots, or of their linear interpolation without acceleration variables
+	// (i.e. the acceleration is the velocity difference along the step). The interpolation is
+	// linear in the knot variables, so the substeps only change the weights and they don't add
+	// decision variables. A single substep gives the weights of the scheme
+	vel_weights.setZero();
+	acc_weights.setZero();
+	double h = 1. / integration_substeps_;
+	for (unsigned int j = 0; j < integration_substeps_; j++) {
+		for (unsigned int i = 0; i < 2; i++) {
+			// Coefficients of the velocity and dt * acceleration at the substep point with
+			// respect to the last and current velocities and dt * accelerations
+			double s = (j + i) * h;
+			Eigen::Vector4d vel_coeff, acc_coeff;
+			if (system_variables_.acceleration) {
+				vel_coeff << 2 * s * s * s - 3 * s * s + 1, -2 * s * s * s + 3 * s * s,
+						s * s * s - 2 * s * s + s, s * s * s - s * s;
+				acc_coeff << 6 * s * s - 6 * s, -6 * s * s + 6 * s,
+						3 * s * s - 4 * s + 1, 3 * s * s - 2 * s;
+			} else {
+				vel_coeff << 1 - s, s, 0., 0.;
+				acc_coeff << -1., 1., 0., 0.;
+			}
+
+			Eigen::Vector4d coeff = h * w(i) * vel_coeff + h * h * u(i) * acc_coeff;
+			vel_weights += coeff.head<2>();
+			acc_weights += coeff.tail<2>();
+		}
+	}
 }
 
 
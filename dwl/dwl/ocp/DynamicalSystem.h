@@ -2,6 +2,7 @@
 #define DWL__OCP__DYNAMICAL_SYSTEM__H
 
 #include <dwl/ocp/Constraint.h>
+#include <dwl/model/SparsityPattern.h>
 
 
 namespace dwl
@@ -28,9 +29,43 @@ struct WholeBodyVariables
 	bool contact_for;
 };
 
+/**
+ * @brief Defines the offsets of the whole-body variables in the decision state of a knot,
+ * i.e. the segments that are mapped without copies. A negative offset means that the variable
+ * isn't part of the decision state. The contact variables are stacked per end-effector, in the
+ * order of the contact names, with a block of contact_dim entries each
+ */
+struct DecisionStateLayout
+{
+	DecisionStateLayout() : time(-1), position(-1), velocity(-1), acceleration(-1),
+			effort(-1), contact(-1), contact_dim(0), contact_pos(-1), contact_vel(-1),
+			contact_acc(-1), contact_for(-1) {}
+	int time;
+	int position;
+	int velocity;
+	int acceleration;
+	int effort;
+	int contact;
+	int contact_dim;
+	int contact_pos;
+	int contact_vel;
+	int contact_acc;
+	int contact_for;
+	std::vector<std::string> contact_names;
+};
+
 /** @brief Defines the different methods for step-time integration */
 enum StepIntegrationMethod {Fixed, Variable};
 
+/**
+ * @brief Defines the transcription schemes of the time integration of the positions, i.e.
+ * q_k = q_{k-1} + dt * (w0 * qd_{k-1} + w1 * qd_k) + dt^2 * (u0 * qdd_{k-1} + u1 * qdd_k).
+ * The Runge-Kutta (RK4) and Hermite-Simpson schemes use the accelerations of the knots when
+ * they are decision variables. Otherwise, the acceleration is constant along the step (i.e.
+ * the velocity difference) and both schemes are equivalent to the implicit midpoint one
+ */
+enum IntegrationScheme {EulerBackward, ImplicitMidpoint, RungeKutta4, HermiteSimpson};
+
 /**
  * @class DynamicalSystem
  * @brief This abstract class defines common methods for implementing dynamical system constraint.
@@ -56,6 +91,13 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		/** @brief Initializes the dynamical system properties */
 		virtual void initDynamicalSystem();
 
+		/**
+		 * @brief Clones the dynamical system, e.g. for evaluating it in another thread. The
+		 * default implementation returns NULL, which means that it cannot be cloned
+		 * @return DynamicalSystem* A new copy of the dynamical system
+		 */
+		virtual DynamicalSystem* clone() const;
+
 		/** @brief Reads and sets the joint limit from an URDF model */
 		void jointLimitsFromURDF();
 
@@ -77,6 +119,20 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		virtual void computeDynamicalConstraint(Eigen::VectorXd& constraint,
 				 	 	 	 	 	 	 	 	const WholeBodyState& state);
 
+		/**
+		 * @brief Computes the Jacobian of the dynamical constraint (computeDynamicalConstraint())
+		 * with respect to the decision state of the current and last knots, where the last state
+		 * is defined by setLastState(). The default implementation doesn't define it, and then
+		 * the Jacobian is computed by central differences
+		 * @param Eigen::MatrixXd& Jacobian with respect to the current decision state
+		 * @param Eigen::MatrixXd& Jacobian with respect to the last decision state
+		 * @param const WholeBodyState& Whole-body state
+		 * @return True if the Jacobian is computed analytically
+		 */
+		virtual bool computeDynamicalJacobian(Eigen::MatrixXd& state_jacobian,
+											  Eigen::MatrixXd& last_state_jacobian,
+											  const WholeBodyState& state);
+
 		/**
 		 * @brief Computes the terminal constraint vector given a certain state
 		 * @param Eigen::VectorXd& Evaluated the terminal constraint function
@@ -95,6 +151,92 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		void numericalIntegration(Eigen::VectorXd& constraint,
 								  const WholeBodyState& state);
 
+		/**
+		 * @brief Estimates the local error of the time integration of a step by step doubling,
+		 * i.e. the difference between the integration constraints with twice the substeps and
+		 * with the defined ones. It's used for refining the steps of a solved trajectory. Note
+		 * that the last state is defined by setLastState()
+		 * @param Eigen::VectorXd& Estimated integration error of the generalized positions
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void estimateIntegrationError(Eigen::VectorXd& error,
+									  const WholeBodyState& state);
+
+		/**
+		 * @brief Computes the Jacobian of the time integration constraint with respect to the
+		 * decision state of the current and last knots. The time integration is linear in the
+		 * positions and velocities, so the Jacobian is computed analytically
+		 * @param Eigen::MatrixXd& Jacobian with respect to the current decision state
+		 * @param Eigen::MatrixXd& Jacobian with respect to the last decision state
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void computeIntegrationJacobian(Eigen::MatrixXd& state_jacobian,
+										Eigen::MatrixXd& last_state_jacobian,
+										const WholeBodyState& state);
+
+		/**
+		 * @brief Computes the collocation constraint of a knot inside a pseudospectral phase,
+		 * i.e. T * qd_i - 2 * sum_j D_ij * q_j, where the support states are the state before
+		 * the phase and its collocation nodes, and D_i is the row of the differentiation matrix
+		 * of the knot. A phase with a single node is the Euler-backward integration
+		 * @param Eigen::VectorXd& Evaluated collocation constraint
+		 * @param const WholeBodyTrajectory& Support states of the phase
+		 * @param const Eigen::VectorXd& Differentiation weights of the knot
+		 * @param double Duration of the phase
+		 * @param const WholeBodyState& Whole-body state of the knot
+		 */
+		void computeCollocationConstraint(Eigen::VectorXd& constraint,
+										  const WholeBodyTrajectory& support_states,
+										  const Eigen::VectorXd& diff_weights,
+										  double phase_duration,
+										  const WholeBodyState& state);
+
+		/**
+		 * @brief Computes the Jacobian of the collocation constraint with respect to the
+		 * decision state of one support state of the phase
+		 * @param Eigen::MatrixXd& Jacobian with respect to the support decision state
+		 * @param double Differentiation weight of the support state
+		 * @param double Duration of the phase
+		 * @param bool Indicates if the support state is the knot itself
+		 */
+		void computeCollocationJacobian(Eigen::MatrixXd& support_jacobian,
+										double diff_weight,
+										double phase_duration,
+										bool is_knot);
+
+		/**
+		 * @brief Computes the Jacobian of the terminal constraint with respect to the decision
+		 * state of the last knot
+		 * @param Eigen::MatrixXd& Jacobian of the terminal constraint
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void computeTerminalJacobian(Eigen::MatrixXd& jacobian,
+									 const WholeBodyState& state);
+
+		/**
+		 * @brief Gets the sparsity patterns of the time integration Jacobians, i.e. with respect
+		 * to the decision state of the current and last knots
+		 * @param model::SparsityPattern& Pattern with respect to the current decision state
+		 * @param model::SparsityPattern& Pattern with respect to the last decision state
+		 */
+		void getIntegrationSparsity(model::SparsityPattern& state_pattern,
+									model::SparsityPattern& last_state_pattern);
+
+		/**
+		 * @brief Gets the sparsity pattern of the collocation Jacobian with respect to the
+		 * decision state of one support state of the phase
+		 * @param model::SparsityPattern& Pattern with respect to the support decision state
+		 * @param bool Indicates if the support state is the knot itself
+		 */
+		void getCollocationSparsity(model::SparsityPattern& support_pattern,
+									bool is_knot);
+
+		/**
+		 * @brief Gets the sparsity pattern of the terminal constraint Jacobian
+		 * @param model::SparsityPattern& Pattern with respect to the last decision state
+		 */
+		void getTerminalSparsity(model::SparsityPattern& pattern);
+
 		/**
 		 * @brief Gets the bounds of the dynamical system constraint which included the time
 		 * integration bounds
@@ -148,6 +290,22 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		 */
 		void setStepIntegrationMethod(StepIntegrationMethod method);
 
+		/**
+		 * @brief Sets the integration scheme of the positions. The default value is the
+		 * Euler-backward one, which is numerically stable but only first-order accurate
+		 * @param IntegrationScheme Integration scheme
+		 */
+		void setIntegrationScheme(IntegrationScheme scheme);
+
+		/**
+		 * @brief Sets the number of substeps of the time integration of every step, i.e. the
+		 * integration scheme is applied along the interpolation of the knot velocities (and
+		 * accelerations) in the substeps. It reduces the integration error of coarse time
+		 * discretizations without adding decision variables. The default value is 1
+		 * @param unsigned int Number of substeps
+		 */
+		void setIntegrationSubsteps(unsigned int num_substeps);
+
 		/**
 		 * @brief Sets the fixed-step integration time
 		 * @param const double& Fixed-step integration time
@@ -180,6 +338,13 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		/** @brief Gets the dimension of the terminal constraint */
 		unsigned int getTerminalConstraintDimension();
 
+		/**
+		 * @brief Gets the dimension of the time integration constraint, i.e. the first rows of
+		 * the constraint vector. It should return zero if the compute() function is overridden
+		 * without time integration
+		 */
+		virtual unsigned int getIntegrationDimension();
+
 		/** @brief Gets the floating-base system information */
 		model::FloatingBaseSystem& getFloatingBaseSystem();
 
@@ -191,12 +356,14 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		void setFullTrajectoryOptimization();
 
 		/**
-		 * @brief Converts the generalized state vector to whole-body state
+		 * @brief Converts the generalized state vector to whole-body state. The segments of the
+		 * vector are mapped with the offsets of the decision state layout, so the conversion
+		 * doesn't allocate when the whole-body state is reused
 		 * @param WholeBodyState& Whole-body state
-		 * @param const Eigen::VectorXd& Generalized state vector
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Generalized state vector
 		 */
 		void toWholeBodyState(WholeBodyState& system_state,
-							  const Eigen::VectorXd& generalized_state);
+							  const Eigen::Ref<const Eigen::VectorXd>& generalized_state);
 
 		/**
 		 * @brief Converts the whole-body state to generalized state vector
@@ -206,6 +373,12 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		void fromWholeBodyState(Eigen::VectorXd& generalized_state,
 								const WholeBodyState& system_state);
 
+		/** @brief Gets the whole-body variables that define the decision state */
+		const WholeBodyVariables& getDecisionVariables();
+
+		/** @brief Gets the offsets of the whole-body variables in the decision state */
+		const DecisionStateLayout& getDecisionStateLayout();
+
 		/** @brief Returns true if it's a fixed-step integration */
 		bool isFixedStepIntegration();
 
@@ -235,20 +408,39 @@ class DynamicalSystem : public Constraint<WholeBodyState>
 		/** @brief Whole-body variables defined given a dynamical system constraint */
 		WholeBodyVariables system_variables_;
 
+		/** @brief Offsets of the whole-body variables in the decision state */
+		DecisionStateLayout state_layout_;
+
 		/** @brief Step integration method */
 		StepIntegrationMethod integration_method_;
 
+		/** @brief Integration scheme of the positions */
+		IntegrationScheme integration_scheme_;
+
+		/** @brief Number of substeps of the time integration */
+		unsigned int integration_substeps_;
+
 		/** @brief Fixed-step time value [in seconds] */
 		double step_time_;
 
 
 	private:
-		/** @brief Computes the state dimension of the dynamical constraint */
+		/** @brief Computes the state dimension and layout of the dynamical constraint */
 		void computeStateDimension();
 
 		/** @brief Initializes conditions of the dynamical constraint */
 		void initialConditions();
 
+		/**
+		 * @brief Gets the weights of the velocities and accelerations of the last and current
+		 * knots in the integration scheme and its substeps. The acceleration weights are
+		 * folded into the velocity ones when the accelerations aren't decision variables
+		 * @param Eigen::Vector2d& Weights of the last and current velocities
+		 * @param Eigen::Vector2d& Weights of the last and current accelerations
+		 */
+		void getIntegrationWeights(Eigen::Vector2d& vel_weights,
+								   Eigen::Vector2d& acc_weights) const;
+
 		/** @brief Indicates if it's a full-trajectory optimization */
 		bool is_full_trajectory_optimization_;
 };
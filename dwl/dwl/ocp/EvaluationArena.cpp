@@ -0,0 +1,138 @@
+#include <dwl/ocp/EvaluationArena.h>
+#include <dwl/utils/MemoryUsage.h>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+EvaluationArena::Scope::Scope(EvaluationArena& arena) : arena_(arena),
+		num_vectors_(arena.num_vectors_), num_matrices_(arena.num_matrices_),
+		num_states_(arena.num_states_), num_body_vectors_(arena.num_body_vectors_)
+{
+
+}
+
+
+EvaluationArena::Scope::~Scope()
+{
+	arena_.num_vectors_ = num_vectors_;
+	arena_.num_matrices_ = num_matrices_;
+	arena_.num_states_ = num_states_;
+	arena_.num_body_vectors_ = num_body_vectors_;
+}
+
+
+Eigen::VectorXd& EvaluationArena::Scope::getVector()
+{
+	return arena_.take(arena_.vectors_, arena_.num_vectors_);
+}
+
+
+Eigen::VectorXd& EvaluationArena::Scope::getVector(unsigned int size)
+{
+	// Note that the resizing doesn't allocate memory if the size doesn't change
+	Eigen::VectorXd& vector = getVector();
+	vector.resize(size);
+	return vector;
+}
+
+
+Eigen::MatrixXd& EvaluationArena::Scope::getMatrix()
+{
+	return arena_.take(arena_.matrices_, arena_.num_matrices_);
+}
+
+
+Eigen::MatrixXd& EvaluationArena::Scope::getMatrix(unsigned int rows,
+												   unsigned int cols)
+{
+	Eigen::MatrixXd& matrix = getMatrix();
+	matrix.resize(rows, cols);
+	return matrix;
+}
+
+
+WholeBodyState& EvaluationArena::Scope::getState()
+{
+	return arena_.take(arena_.states_, arena_.num_states_);
+}
+
+
+rbd::BodyVectorXd& EvaluationArena::Scope::getBodyVector()
+{
+	return arena_.take(arena_.body_vectors_, arena_.num_body_vectors_);
+}
+
+
+EvaluationArena::EvaluationArena() : num_vectors_(0), num_matrices_(0), num_states_(0),
+		num_body_vectors_(0)
+{
+
+}
+
+
+EvaluationArena::EvaluationArena(const EvaluationArena& other) : num_vectors_(0),
+		num_matrices_(0), num_states_(0), num_body_vectors_(0)
+{
+
+}
+
+
+EvaluationArena& EvaluationArena::operator=(const EvaluationArena& other)
+{
+	return *this;
+}
+
+
+EvaluationArena::~EvaluationArena()
+{
+
+}
+
+
+void EvaluationArena::reset()
+{
+	num_vectors_ = num_matrices_ = num_states_ = num_body_vectors_ = 0;
+}
+
+
+unsigned int EvaluationArena::getNumberOfTemporaries() const
+{
+	return vectors_.size() + matrices_.size() + states_.size() + body_vectors_.size();
+}
+
+
+/** @brief Heap bytes of a list of temporaries, i.e. the temporaries and their memory */
+template<typename T>
+static std::size_t getTemporariesBytes(const std::vector<std::unique_ptr<T> >& temporaries)
+{
+	std::size_t bytes = temporaries.capacity() * sizeof(std::unique_ptr<T>);
+	for (unsigned int i = 0; i < temporaries.size(); i++)
+		bytes += sizeof(T) + utils::getHeapBytes(*temporaries[i]);
+
+	return bytes;
+}
+
+
+std::size_t EvaluationArena::getHeapBytes() const
+{
+	return getTemporariesBytes(vectors_) + getTemporariesBytes(matrices_) +
+			getTemporariesBytes(states_) + getTemporariesBytes(body_vectors_);
+}
+
+
+template<typename T>
+T& EvaluationArena::take(std::vector<std::unique_ptr<T> >& temporaries,
+						 unsigned int& num_taken)
+{
+	if (num_taken == temporaries.size())
+		temporaries.push_back(std::unique_ptr<T>(new T()));
+
+	return *temporaries[num_taken++];
+}
+
+} //@namespace ocp
+} //@namespace dwl
@@ -0,0 +1,143 @@
+#ifndef DWL__OCP__EVALUATION_ARENA__H
+#define DWL__OCP__EVALUATION_ARENA__H
+
+#include <dwl/WholeBodyState.h>
+#include <memory>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+/**
+ * @class EvaluationArena
+ * @brief Arena of the temporaries of an evaluation of the optimal control problem (e.g. the
+ * vectors, matrices and whole-body states of a constraint evaluation). The temporaries are
+ * taken in order, and they keep their memory when the arena is reset, so the evaluations
+ * don't allocate memory once the temporaries have their sizes. Every model has its own arena,
+ * so the models of different threads (or optimizers) don't contend on the heap. Note that the
+ * temporaries are valid until the arena is reset or the scope that took them is closed
+ */
+class EvaluationArena
+{
+	public:
+		/**
+		 * @class Scope
+		 * @brief Scope of the temporaries of a function, which returns them to the arena when
+		 * it's destroyed. So the nested functions (e.g. the dynamical constraint of the dynamical
+		 * system) reuse the same temporaries in every call
+		 */
+		class Scope
+		{
+			public:
+				/** @brief Constructor function, which records the taken temporaries */
+				Scope(EvaluationArena& arena);
+
+				/** @brief Destructor function, which returns the temporaries of the scope */
+				~Scope();
+
+				/**
+				 * @brief Gets a vector of the scope, which has the last size (e.g. for an output
+				 * argument that is resized by the callee)
+				 * @return The vector, whose values aren't initialized
+				 */
+				Eigen::VectorXd& getVector();
+
+				/**
+				 * @brief Gets a vector of the scope
+				 * @param unsigned int Size of the vector
+				 * @return The vector, whose values aren't initialized
+				 */
+				Eigen::VectorXd& getVector(unsigned int size);
+
+				/**
+				 * @brief Gets a matrix of the scope, which has the last size
+				 * @return The matrix, whose values aren't initialized
+				 */
+				Eigen::MatrixXd& getMatrix();
+
+				/**
+				 * @brief Gets a matrix of the scope
+				 * @param unsigned int Number of rows
+				 * @param unsigned int Number of columns
+				 * @return The matrix, whose values aren't initialized
+				 */
+				Eigen::MatrixXd& getMatrix(unsigned int rows,
+										   unsigned int cols);
+
+				/** @brief Gets a whole-body state of the scope, which has the last values */
+				WholeBodyState& getState();
+
+				/** @brief Gets a body vector of the scope, which has the last values */
+				rbd::BodyVectorXd& getBodyVector();
+
+
+			private:
+				/** @brief Scope isn't copyable */
+				Scope(const Scope&);
+				Scope& operator=(const Scope&);
+
+				/** @brief Arena of the scope */
+				EvaluationArena& arena_;
+
+				/** @brief Number of taken temporaries before the scope */
+				unsigned int num_vectors_;
+				unsigned int num_matrices_;
+				unsigned int num_states_;
+				unsigned int num_body_vectors_;
+		};
+
+		/** @brief Constructor function */
+		EvaluationArena();
+
+		/**
+		 * @brief Copy constructor and assignment, which don't copy the temporaries, i.e. a cloned
+		 * model has its own arena
+		 */
+		EvaluationArena(const EvaluationArena& other);
+		EvaluationArena& operator=(const EvaluationArena& other);
+
+		/** @brief Destructor function */
+		~EvaluationArena();
+
+		/** @brief Returns all the temporaries, which keep their memory */
+		void reset();
+
+		/** @brief Gets the number of allocated temporaries */
+		unsigned int getNumberOfTemporaries() const;
+
+		/** @brief Gets the heap bytes of the allocated temporaries */
+		std::size_t getHeapBytes() const;
+
+
+	private:
+		/**
+		 * @brief Takes the next temporary of a list, where it's allocated if it's the first time
+		 * @param std::vector<std::unique_ptr<T> >& List of temporaries
+		 * @param unsigned int& Number of taken temporaries
+		 * @return The temporary
+		 */
+		template<typename T>
+		T& take(std::vector<std::unique_ptr<T> >& temporaries,
+				unsigned int& num_taken);
+
+		/** @brief Temporaries of the arena, which have stable addresses */
+		std::vector<std::unique_ptr<Eigen::VectorXd> > vectors_;
+		std::vector<std::unique_ptr<Eigen::MatrixXd> > matrices_;
+		std::vector<std::unique_ptr<WholeBodyState> > states_;
+		std::vector<std::unique_ptr<rbd::BodyVectorXd> > body_vectors_;
+
+		/** @brief Number of taken temporaries */
+		unsigned int num_vectors_;
+		unsigned int num_matrices_;
+		unsigned int num_states_;
+		unsigned int num_body_vectors_;
+};
+
+} //@namespace ocp
+} //@namespace dwl
+
+#endif
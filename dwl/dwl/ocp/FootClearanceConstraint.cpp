@@ -0,0 +1,103 @@
+#include <dwl/ocp/FootClearanceConstraint.h>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+FootClearanceConstraint::FootClearanceConstraint() : distance_field_(NULL), clearance_(0.02),
+		force_threshold_(0.)
+{
+	// Setting the name of the constraint
+	name_ = "foot clearance";
+}
+
+
+FootClearanceConstraint::~FootClearanceConstraint()
+{
+
+}
+
+
+FootClearanceConstraint* FootClearanceConstraint::clone() const
+{
+	return new FootClearanceConstraint(*this);
+}
+
+
+void FootClearanceConstraint::init(bool info)
+{
+	// Getting the end-effector names
+	end_effector_names_.clear();
+	urdf_model::LinkID end_effector = system_.getEndEffectors();
+	for (urdf_model::LinkID::iterator endeffector_it = end_effector.begin();
+			endeffector_it != end_effector.end(); endeffector_it++)
+		end_effector_names_.push_back(endeffector_it->first);
+
+	// Setting the constraint dimension
+	constraint_dimension_ = system_.getNumberOfEndEffectors();
+
+	if (distance_field_ == NULL)
+		printf(YELLOW "Warning: the terrain distance field of the %s constraint isn't defined\n"
+				COLOR_RESET, name_.c_str());
+}
+
+
+void FootClearanceConstraint::setTerrainDistanceField(const environment::TerrainDistanceField* field)
+{
+	distance_field_ = field;
+}
+
+
+void FootClearanceConstraint::setClearance(double clearance)
+{
+	clearance_ = clearance;
+	invalidateBounds();
+}
+
+
+void FootClearanceConstraint::setForceThreshold(double force_threshold)
+{
+	force_threshold_ = force_threshold;
+}
+
+
+void FootClearanceConstraint::compute(Eigen::VectorXd& constraint,
+									  const WholeBodyState& state)
+{
+	// Resizing the constraint dimension
+	constraint.setConstant(system_.getNumberOfEndEffectors(), clearance_);
+	if (distance_field_ == NULL || distance_field_->isEmpty())
+		return;
+
+	// Computing the contact positions
+	rbd::BodyVectorXd contact_pos;
+	kinematics_.computeForwardKinematics(contact_pos,
+										 state.base_pos, state.joint_pos,
+										 end_effector_names_, rbd::Linear);
+
+	// Adding the distance to the terrain of the swing feet
+	for (rbd::BodyVectorXd::const_iterator contact_it = contact_pos.begin();
+			contact_it != contact_pos.end(); contact_it++) {
+		std::string name = contact_it->first;
+		if (state.getContactCondition(name, force_threshold_))
+			continue;
+
+		unsigned int id = system_.getEndEffectors().find(name)->second;
+		Eigen::Vector3d position = contact_it->second.head<3>();
+		constraint(id) = distance_field_->getDistance(position);
+	}
+}
+
+
+void FootClearanceConstraint::getBounds(Eigen::VectorXd& lower_bound,
+										Eigen::VectorXd& upper_bound)
+{
+	lower_bound = clearance_ * Eigen::VectorXd::Ones(system_.getNumberOfEndEffectors());
+	upper_bound = NO_BOUND * Eigen::VectorXd::Ones(system_.getNumberOfEndEffectors());
+}
+
+} //@namespace ocp
+} //@namespace dwl
@@ -0,0 +1,94 @@
+#ifndef DWL__OCP__FOOT_CLEARANCE_CONSTRAINT__H
+#define DWL__OCP__FOOT_CLEARANCE_CONSTRAINT__H
+
+#include <dwl/ocp/Constraint.h>
+#include <dwl/environment/TerrainDistanceField.h>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+/**
+ * @class FootClearanceConstraint
+ * @brief This is specialization class for imposing a minimum clearance of the swing feet to
+ * the terrain, i.e. the signed distance of every end-effector to the terrain surface, which is
+ * a single interpolation of the terrain distance field per knot. The end-effectors in contact
+ * (i.e. with a contact force above a threshold) aren't constrained, so their constraint value is
+ * the clearance
+ */
+class FootClearanceConstraint : public Constraint<WholeBodyState>
+{
+	public:
+		/** @brief Constructor function */
+		FootClearanceConstraint();
+
+		/** @brief Destructor function */
+		~FootClearanceConstraint();
+
+		/** @brief Clones the constraint, e.g. for evaluating it in another thread. Note that
+		 * the clones share the terrain distance field */
+		FootClearanceConstraint* clone() const;
+
+		/**
+		 * @brief Initializes the foot clearance constraint given an URDF model (xml)
+		 * @param Print model information
+		 */
+		void init(bool info);
+
+		/**
+		 * @brief Sets the terrain distance field, which isn't copied, so it has to be alive
+		 * while the constraint is evaluated
+		 * @param const environment::TerrainDistanceField* Terrain distance field
+		 */
+		void setTerrainDistanceField(const environment::TerrainDistanceField* field);
+
+		/**
+		 * @brief Sets the minimum clearance of the swing feet. The default value is 0.02 m
+		 * @param double Minimum clearance
+		 */
+		void setClearance(double clearance);
+
+		/**
+		 * @brief Sets the force threshold of the contact condition. The default value is 0 N
+		 * @param double Force threshold
+		 */
+		void setForceThreshold(double force_threshold);
+
+		/**
+		 * @brief Computes the constraint vector given a certain state
+		 * @param Eigen::VectorXd& Evaluated constraint function
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void compute(Eigen::VectorXd& constraint,
+					 const WholeBodyState& state);
+
+		/**
+		 * @brief Gets the lower and upper bounds of the constraint
+		 * @param Eigen::VectorXd& Lower constraint bound
+		 * @param Eigen::VectorXd& Upper constraint bound
+		 */
+		void getBounds(Eigen::VectorXd& lower_bound,
+					   Eigen::VectorXd& upper_bound);
+
+
+	private:
+		/** @brief End-effector names */
+		std::vector<std::string> end_effector_names_;
+
+		/** @brief Terrain distance field */
+		const environment::TerrainDistanceField* distance_field_;
+
+		/** @brief Minimum clearance of the swing feet */
+		double clearance_;
+
+		/** @brief Force threshold of the contact condition */
+		double force_threshold_;
+};
+
+} //@namespace ocp
+} //@namespace dwl
+
+#endif
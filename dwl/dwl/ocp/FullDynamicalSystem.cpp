@@ -26,6 +26,12 @@ FullDynamicalSystem::~FullDynamicalSystem()
 }
 
 
+FullDynamicalSystem* FullDynamicalSystem::clone() const
+{
+	return new FullDynamicalSystem(*this);
+}
+
+
 void FullDynamicalSystem::initDynamicalSystem()
 {
 	// Getting the end-effector names
@@ -50,14 +56,17 @@ void FullDynamicalSystem::computeDynamicalConstraint(Eigen::VectorXd& constraint
 	double step_time = state.time - state_buffer_[0].time;
 
 	// Computing the joint acceleration from velocities
-	Eigen::VectorXd base_acc = (state.base_vel - state_buffer_[0].base_vel) / step_time;
-	Eigen::VectorXd joint_acc = (state.joint_vel - state_buffer_[0].joint_vel) / step_time;
+	EvaluationArena::Scope scope(arena_);
+	Eigen::VectorXd& base_acc = scope.getVector();
+	Eigen::VectorXd& joint_acc = scope.getVector();
+	base_acc = (state.base_vel - state_buffer_[0].base_vel) / step_time;
+	joint_acc = (state.joint_vel - state_buffer_[0].joint_vel) / step_time;
 
 	// Computing the full inverse dynamics. In real-cases, the floating-base effort (state.base_eff)
 	// is always equals to zero, which implicates that we are imposing that the base_wrench equals
 	// to null vector. TODO Another implementation could be posed as floating-base inverse dynamics
 	rbd::Vector6d estimated_base_wrench;
-	Eigen::VectorXd estimated_joint_forces;
+	Eigen::VectorXd& estimated_joint_forces = scope.getVector();
 	dynamics_.computeInverseDynamics(estimated_base_wrench, estimated_joint_forces,
 									 state.base_pos, state.joint_pos,
 									 state.base_vel, state.joint_vel,
@@ -67,6 +76,76 @@ void FullDynamicalSystem::computeDynamicalConstraint(Eigen::VectorXd& constraint
 }
 
 
+bool FullDynamicalSystem::computeDynamicalJacobian(Eigen::MatrixXd& state_jacobian,
+												   Eigen::MatrixXd& last_state_jacobian,
+												   const WholeBodyState& state)
+{
+	// Computing the joint acceleration from velocities as in the dynamical constraint
+	double step_time = state.time - state_buffer_[0].time;
+	Eigen::VectorXd base_acc = (state.base_vel - state_buffer_[0].base_vel) / step_time;
+	Eigen::VectorXd joint_acc = (state.joint_vel - state_buffer_[0].joint_vel) / step_time;
+
+	// Computing the partial derivatives of the inverse dynamics
+	Eigen::MatrixXd dtau_dq, dtau_dqd, dtau_dqdd;
+	if (!dynamics_.computeInverseDynamicsDerivatives(dtau_dq, dtau_dqd, dtau_dqdd,
+													 state.base_pos, state.joint_pos,
+													 state.base_vel, state.joint_vel,
+													 base_acc, joint_acc, state.contact_eff))
+		return false;
+
+	// Resizing the Jacobian matrices
+	unsigned int system_dof = system_.getSystemDoF();
+	unsigned int base_dof = system_.getFloatingBaseDoF();
+	unsigned int joint_dof = system_.getJointDoF();
+	state_jacobian.setZero(system_dof, state_dimension_);
+	last_state_jacobian.setZero(system_dof, state_dimension_);
+
+	// Filling the Jacobians following the order of the generalized state vector. Note that
+	// the acceleration is (qd_k - qd_{k-1}) / dt_k
+	unsigned int idx = 0;
+	if (system_variables_.time) {
+		Eigen::VectorXd q_ddot = system_.toGeneralizedJointState(base_acc, joint_acc);
+		state_jacobian.col(idx) = -dtau_dqdd * q_ddot / step_time;
+		++idx;
+	}
+	if (system_variables_.position) {
+		state_jacobian.block(0, idx, system_dof, system_dof) = dtau_dq;
+		idx += system_dof;
+	}
+	if (system_variables_.velocity) {
+		state_jacobian.block(0, idx, system_dof, system_dof) = dtau_dqd + dtau_dqdd / step_time;
+		last_state_jacobian.block(0, idx, system_dof, system_dof) = -dtau_dqdd / step_time;
+		idx += system_dof;
+	}
+	if (system_variables_.acceleration)
+		idx += system_dof;
+	if (system_variables_.effort) {
+		state_jacobian.block(base_dof, idx, joint_dof, joint_dof) =
+				-Eigen::MatrixXd::Identity(joint_dof, joint_dof);
+		idx += joint_dof;
+	}
+	if (system_variables_.contact_pos || system_variables_.contact_vel ||
+			system_variables_.contact_acc || system_variables_.contact_for) {
+		// The contact forces are applied at the contact points, so their generalized forces
+		// are J_c^T * f_c. Note that the end-effector names follow the order of the state
+		Eigen::MatrixXd contact_jac;
+		if (system_variables_.contact_for)
+			kinematics_.computeJacobian(contact_jac, state.base_pos, state.joint_pos,
+										end_effector_names_, rbd::Linear);
+		for (unsigned int i = 0; i < end_effector_names_.size(); i++) {
+			idx += 3 * (system_variables_.contact_pos + system_variables_.contact_vel +
+					system_variables_.contact_acc);
+			if (system_variables_.contact_for) {
+				state_jacobian.block(0, idx, system_dof, 3) =
+						-contact_jac.block(3 * i, 0, 3, system_dof).transpose();
+				idx += 3;
+			}
+		}
+	}
+
+	return true;
+}
+
 void FullDynamicalSystem::getDynamicalBounds(Eigen::VectorXd& lower_bound,
 											 Eigen::VectorXd& upper_bound)
 {
@@ -25,6 +25,9 @@ class FullDynamicalSystem : public DynamicalSystem
 		/** @brief Destructor function */
 		~FullDynamicalSystem();
 
+		/** @brief Clones the dynamical system, e.g. for evaluating it in another thread */
+		FullDynamicalSystem* clone() const;
+
 		/** @brief Initializes the full dynamical system constraint */
 		void initDynamicalSystem();
 
@@ -36,6 +39,19 @@ class FullDynamicalSystem : public DynamicalSystem
 		void computeDynamicalConstraint(Eigen::VectorXd& constraint,
 										const WholeBodyState& state);
 
+		/**
+		 * @brief Computes analytically the Jacobian of the dynamic constraint, i.e. from the
+		 * partial derivatives of the inverse dynamics, where the acceleration is the velocity
+		 * difference with respect to the last state
+		 * @param Eigen::MatrixXd& Jacobian with respect to the current decision state
+		 * @param Eigen::MatrixXd& Jacobian with respect to the last decision state
+		 * @param const WholeBodyState& Whole-body state
+		 * @return False if the inverse dynamics derivatives aren't available for the system
+		 */
+		bool computeDynamicalJacobian(Eigen::MatrixXd& state_jacobian,
+									  Eigen::MatrixXd& last_state_jacobian,
+									  const WholeBodyState& state);
+
 		/**
 		 * @brief Gets the bounds of the dynamical system constraint
 		 * @param Eigen::VectorXd& Lower bounds
@@ -20,6 +20,12 @@ InelasticContactModelConstraint::~InelasticContactModelConstraint()
 }
 
 
+InelasticContactModelConstraint* InelasticContactModelConstraint::clone() const
+{
+	return new InelasticContactModelConstraint(*this);
+}
+
+
 void InelasticContactModelConstraint::init(bool info)
 {
 	// Getting the end-effector names
@@ -61,7 +67,8 @@ void InelasticContactModelConstraint::computeSecondComplement(Eigen::VectorXd& c
 	constraint.resize(system_.getNumberOfEndEffectors());
 
 	// Computing the contact position
-	rbd::BodyVectorXd contact_pos;
+	EvaluationArena::Scope scope(arena_);
+	rbd::BodyVectorXd& contact_pos = scope.getBodyVector();
 	kinematics_.computeForwardKinematics(contact_pos,
 										 state.base_pos, state.joint_pos,
 										 end_effector_names_, rbd::Linear);
@@ -73,7 +80,7 @@ void InelasticContactModelConstraint::computeSecondComplement(Eigen::VectorXd& c
 	for (rbd::BodyVectorXd::const_iterator contact_it = state.contact_pos.begin();
 			contact_it != state.contact_pos.end(); contact_it++) {
 		std::string name = contact_it->first;
-		Eigen::VectorXd position = contact_it->second;
+		const Eigen::VectorXd& position = contact_it->second;
 		unsigned int id = system_.getEndEffectors().find(name)->second;
 
 		if (position(rbd::X) < 0.125)
@@ -19,6 +19,9 @@ class InelasticContactVelocityConstraint : public ComplementaryConstraint
 		/** @brief Destructor function */
 		~InelasticContactVelocityConstraint();
 
+		/** @brief Clones the constraint, e.g. for evaluating it in another thread */
+		InelasticContactVelocityConstraint* clone() const;
+
 		/**
 		 * @brief Initializes the ineslatic contact velocity constraint given an URDF model (xml)
 		 * @param Print model information
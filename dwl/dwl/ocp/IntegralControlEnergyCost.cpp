@@ -19,6 +19,12 @@ IntegralControlEnergyCost::~IntegralControlEnergyCost()
 }
 
 
+IntegralControlEnergyCost* IntegralControlEnergyCost::clone() const
+{
+	return new IntegralControlEnergyCost(*this);
+}
+
+
 void IntegralControlEnergyCost::compute(double& cost,
 										const WholeBodyState& state)
 {
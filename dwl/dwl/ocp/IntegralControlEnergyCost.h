@@ -23,6 +23,9 @@ class IntegralControlEnergyCost : public Cost
 		/** @brief Destructor function */
 		~IntegralControlEnergyCost();
 
+		/** @brief Clones the cost, e.g. for evaluating it in another thread */
+		IntegralControlEnergyCost* clone() const;
+
 		/**
 		 * @brief Computes the control energy cost, i.e. joint efforts energy, given a locomotion
 		 * state. The control energy is defined as quadratic cost function
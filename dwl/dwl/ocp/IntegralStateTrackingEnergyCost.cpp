@@ -19,6 +19,12 @@ IntegralStateTrackingEnergyCost::~IntegralStateTrackingEnergyCost()
 }
 
 
+IntegralStateTrackingEnergyCost* IntegralStateTrackingEnergyCost::clone() const
+{
+	return new IntegralStateTrackingEnergyCost(*this);
+}
+
+
 void IntegralStateTrackingEnergyCost::compute(double& cost,
 											  const WholeBodyState& state)
 {
@@ -23,6 +23,9 @@ class IntegralStateTrackingEnergyCost : public Cost
 		/** @brief Destructor function */
 		~IntegralStateTrackingEnergyCost();
 
+		/** @brief Clones the cost, e.g. for evaluating it in another thread */
+		IntegralStateTrackingEnergyCost* clone() const;
+
 		/**
 		 * @brief Computes the state-tracking energy cost given a locomotion state. The
 		 * state-tracking energy is defined as quadratic cost function
@@ -1,4 +1,11 @@
 #include <dwl/ocp/OptimalControl.h>
+#include <dwl/utils/Instrumentation.h>
+#include <dwl/utils/Collocation.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <dwl/utils/Log.h>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
 
 
 namespace dwl
@@ -7,9 +14,49 @@ namespace dwl
 namespace ocp
 {
 
+/**
+ * @class ScopedTermAccount
+ * @brief Accounts a call of a term during its scope, which doesn't read the clock if the
+ * accounting is disabled
+ */
+class ScopedTermAccount
+{
+	public:
+		ScopedTermAccount(TermStatistics* statistics) : statistics_(statistics)
+		{
+			if (statistics_ != NULL)
+				start_ = std::chrono::steady_clock::now();
+		}
+
+		~ScopedTermAccount()
+		{
+			if (statistics_ != NULL) {
+				statistics_->calls++;
+				statistics_->total_time += std::chrono::duration<double>(
+						std::chrono::steady_clock::now() - start_).count();
+			}
+		}
+
+	private:
+		TermStatistics* statistics_;
+		std::chrono::steady_clock::time_point start_;
+};
+
+
+/** @brief Formats a vector in a row for the log */
+static std::string toString(const Eigen::VectorXd& vector)
+{
+	std::ostringstream stream;
+	stream << vector.transpose();
+	return stream.str();
+}
+
+
 OptimalControl::OptimalControl() : dynamical_system_(NULL),
 		is_added_dynamic_system_(false), is_added_constraint_(false), is_added_cost_(false),
-		terminal_constraint_dimension_(0), horizon_(1)
+		terminal_constraint_dimension_(0), horizon_(1), is_solution_completed_(false),
+		collocation_(false), knot_mesh_(false), jacobian_epsilon_(1E-06), num_threads_(1),
+		problem_template_(false), is_template_built_(false), term_accounting_(true)
 {
 
 }
@@ -17,6 +64,7 @@ OptimalControl::OptimalControl() : dynamical_system_(NULL),
 
 OptimalControl::~OptimalControl()
 {
+	deleteThreadModels();
 	delete dynamical_system_;
 
 	typedef std::vector<Constraint<WholeBodyState>*>::iterator ConstraintItr;
@@ -35,6 +83,10 @@ OptimalControl::~OptimalControl()
 
 void OptimalControl::init(bool only_soft_constraints)
 {
+	// Reusing the structure of the problem template, which was built by a previous call
+	if (is_template_built_)
+		return;
+
 	// Reading the state dimension
 	state_dimension_ = dynamical_system_->getDimensionOfState();
 
@@ -60,6 +112,109 @@ void OptimalControl::init(bool only_soft_constraints)
 		for (unsigned int i = 0; i < constraints_.size(); i++)
 			constraints_[i]->defineAsSoftConstraint();
 	}
+
+	// The collocation phases define the duration of the knots
+	if (collocation_ && !dynamical_system_->isFixedStepIntegration()) {
+		printf(YELLOW "Warning: the collocation phases require fixed-step integration, so it"
+				" will be used the knot-to-knot integration\n" COLOR_RESET);
+		collocation_ = false;
+	}
+
+	// The non-uniform mesh defines the duration of the knots
+	if (knot_mesh_ && !dynamical_system_->isFixedStepIntegration()) {
+		printf(YELLOW "Warning: the knot mesh requires fixed-step integration, so it will be"
+				" used the step time of the decision variables\n" COLOR_RESET);
+		knot_mesh_ = false;
+	}
+
+	// Composing the sparsity pattern of the constraint Jacobian from the knot blocks. The
+	// constraints of a knot depend only on its state and the previous one (time integration),
+	// and the terminal constraint depends only on the last knot. Instead, the collocation
+	// constraints depend on the states of the entire phase and the one before it
+	unsigned int integration_dim = 0;
+	model::SparsityPattern integration_pattern, last_integration_pattern;
+	model::SparsityPattern support_pattern, knot_support_pattern;
+	if (constraint_dimension_ != 0 && !dynamical_system_->isSoftConstraint()) {
+		integration_dim = dynamical_system_->getIntegrationDimension();
+		if (integration_dim != 0) {
+			dynamical_system_->getIntegrationSparsity(integration_pattern,
+													  last_integration_pattern);
+			dynamical_system_->getCollocationSparsity(support_pattern, false);
+			dynamical_system_->getCollocationSparsity(knot_support_pattern, true);
+		}
+	}
+	unsigned int knot_dim = constraint_dimension_ - integration_dim;
+
+	model::SparsityPattern jacobian_pattern(horizon_ * constraint_dimension_ +
+											terminal_constraint_dimension_,
+											horizon_ * state_dimension_);
+	for (unsigned int k = 0; k < horizon_ && constraint_dimension_ != 0; k++) {
+		unsigned int row = k * constraint_dimension_;
+		if (collocation_ && integration_dim != 0) {
+			// The initial state isn't a decision variable, so there isn't its support block
+			unsigned int first_knot = phase_first_knots_[knot_phases_[k]];
+			unsigned int last_knot = first_knot + phase_diff_matrices_[knot_phases_[k]].rows();
+			for (unsigned int j = (first_knot == 0) ? 1 : 0; j <= last_knot - first_knot; j++) {
+				unsigned int support_col = (first_knot + j - 1) * state_dimension_;
+				if (first_knot + j - 1 == k)
+					jacobian_pattern.addPattern(knot_support_pattern, row, support_col);
+				else
+					jacobian_pattern.addPattern(support_pattern, row, support_col);
+			}
+		}
+		if (k != 0) {
+			unsigned int last_col = (k - 1) * state_dimension_;
+			if (!collocation_)
+				jacobian_pattern.addPattern(last_integration_pattern, row, last_col);
+			jacobian_pattern.addDenseBlock(row + integration_dim, last_col,
+										   knot_dim, state_dimension_);
+		}
+		unsigned int col = k * state_dimension_;
+		if (!collocation_)
+			jacobian_pattern.addPattern(integration_pattern, row, col);
+		jacobian_pattern.addDenseBlock(row + integration_dim, col,
+									   knot_dim, state_dimension_);
+	}
+	if (terminal_constraint_dimension_ != 0) {
+		model::SparsityPattern terminal_pattern;
+		dynamical_system_->getTerminalSparsity(terminal_pattern);
+		jacobian_pattern.addPattern(terminal_pattern,
+									horizon_ * constraint_dimension_,
+									(horizon_ - 1) * state_dimension_);
+	}
+	setJacobianSparsity(jacobian_pattern);
+
+	// Cloning the models used by the extra threads, so they are created once per problem
+	cloneThreadModels();
+
+#ifdef DWL_WITH_INSTRUMENTATION
+	// Registering a probe per constraint and cost, which are shared with their clones
+	constraint_probes_.clear();
+	for (unsigned int i = 0; i < constraints_.size(); i++)
+		constraint_probes_.push_back(utils::Instrumentation::registerProbe(
+				"Constraint::compute/" + constraints_[i]->getName()));
+	cost_probes_.clear();
+	for (unsigned int i = 0; i < costs_.size(); i++)
+		cost_probes_.push_back(utils::Instrumentation::registerProbe(
+				"Cost::compute/" + costs_[i]->getName()));
+#endif
+
+	// Allocating the accounting counters of every chunk
+	constraint_names_.clear();
+	constraint_names_.push_back(dynamical_system_->getName());
+	for (unsigned int i = 0; i < constraints_.size(); i++)
+		constraint_names_.push_back(constraints_[i]->getName());
+	cost_names_.clear();
+	for (unsigned int i = 0; i < costs_.size(); i++)
+		cost_names_.push_back(costs_[i]->getName());
+	term_statistics_.assign(thread_dynamical_systems_.size() + 1,
+			std::vector<TermStatistics>(constraint_names_.size() + cost_names_.size()));
+
+	// Freezing the structure of the problem template. Its state bounds are cached in the
+	// first evaluation
+	is_template_built_ = problem_template_;
+	template_state_lower_bound_.resize(0);
+	template_state_upper_bound_.resize(0);
 }
 
 
@@ -67,6 +222,25 @@ void OptimalControl::setStartingTrajectory(WholeBodyTrajectory& initial_trajecto
 {
 	//TODO should convert to the defined horizon and time step integration
 	motion_solution_ = initial_trajectory;
+	is_solution_completed_ = true;
+	shifted_starting_point_.resize(0);
+}
+
+
+void OptimalControl::setShiftedStartingPoint(const Eigen::Ref<const Eigen::VectorXd>& solution)
+{
+	if (solution.size() != horizon_ * state_dimension_) {
+		printf(YELLOW "Warning: the solution dimension is not consistent, so it cannot be used as"
+				" starting point\n" COLOR_RESET);
+		shifted_starting_point_.resize(0);
+		return;
+	}
+
+	// Shifting the knots, where the last knot is repeated
+	unsigned int shifted_dim = (horizon_ - 1) * state_dimension_;
+	shifted_starting_point_.resize(solution.size());
+	shifted_starting_point_.head(shifted_dim) = solution.tail(shifted_dim);
+	shifted_starting_point_.tail(state_dimension_) = solution.tail(state_dimension_);
 }
 
 
@@ -75,50 +249,35 @@ void OptimalControl::getStartingPoint(double* decision, int decision_dim)
 	// Eigen interfacing to raw buffers
 	Eigen::Map<Eigen::VectorXd> full_initial_point(decision, decision_dim);
 
-	if (motion_solution_.size() == 0) {
+	if (shifted_starting_point_.size() == decision_dim) {
+		// Defining the shifted solution as starting point
+		full_initial_point = shifted_starting_point_;
+	} else if (motion_solution_.size() == 0) {
 		// Getting the initial and ending locomotion state
 		WholeBodyState starting_system_state = dynamical_system_->getInitialState();
 		WholeBodyState ending_system_state = dynamical_system_->getTerminalState();
 
-		// Defining splines //TODO for the time being only cubic interpolation is OK
+		// Defining the spline of the base and joint channels
+		// TODO for the time being only cubic interpolation is OK
 		unsigned int num_joints = dynamical_system_->getFloatingBaseSystem().getJointDoF();
-		std::vector<math::CubicSpline> base_spline, joint_spline;
-		base_spline.resize(6);
-		joint_spline.resize(num_joints);
+		Eigen::VectorXd starting_pos(6 + num_joints), ending_pos(6 + num_joints);
+		starting_pos << starting_system_state.base_pos, starting_system_state.joint_pos;
+		ending_pos << ending_system_state.base_pos, ending_system_state.joint_pos;
+		math::MultiCubicSpline motion_spline;
+		motion_spline.setBoundary(0, 1, starting_pos, ending_pos);
 
 		// Computing a starting point from interpolation of the starting and ending states
 		WholeBodyState current_system_state = starting_system_state;
-		math::Spline::Point current_point;
+		Eigen::VectorXd current_pos;
 		current_system_state.duration = 1. / horizon_;
 		for (unsigned int k = 0; k < horizon_; k++) {
 			current_system_state.time = k * current_system_state.duration;
 
-			// Base interpolation
-			for (unsigned int base_idx = 0; base_idx < 6; base_idx++) {
-				if (k == 0) {
-					// Initialization of the base spline
-					math::Spline::Point starting_base(starting_system_state.base_pos(base_idx));
-					math::Spline::Point ending_base(ending_system_state.base_pos(base_idx));
-					base_spline[base_idx].setBoundary(0, 1, starting_base, ending_base);
-				} else {
-					// Getting and setting the interpolated point
-					base_spline[base_idx].getPoint(current_system_state.time, current_point);
-					current_system_state.base_pos(base_idx) = current_point.x;
-				}
-			}
-
-			// Joint interpolations
-			for (unsigned int joint_idx = 0; joint_idx < num_joints; joint_idx++) {
-				if (k == 0) {
-					// Initialization of the joint spline
-					math::Spline::Point starting_joint(starting_system_state.joint_pos(joint_idx));
-					math::Spline::Point ending_joint(ending_system_state.joint_pos(joint_idx));
-					joint_spline[joint_idx].setBoundary(0, 1, starting_joint, ending_joint);
-				} else {
-					// Getting and setting the interpolated point
-					joint_spline[joint_idx].getPoint(current_system_state.time, current_point);
-					current_system_state.joint_pos(joint_idx) = current_point.x;
-				}
+			// Getting and setting the interpolated point of the base and joints
+			if (k != 0) {
+				motion_spline.getPoint(current_system_state.time, current_pos);
+				current_system_state.base_pos = current_pos.head<6>();
+				current_system_state.joint_pos = current_pos.tail(num_joints);
 			}
 
 			// Getting the current state vector
@@ -129,11 +288,16 @@ void OptimalControl::getStartingPoint(double* decision, int decision_dim)
 			full_initial_point.segment(k * state_dimension_, state_dimension_) = current_state;
 		}
 	} else {
-		// Defining the current locomotion solution as starting point
+		// Defining the current locomotion solution as starting point. A solution starts with
+		// the initial state (see evaluateSolution), which isn't a knot, and the last state is
+		// repeated if the trajectory is shorter than the horizon
 		unsigned int state_dimension = dynamical_system_->getDimensionOfState();
+		unsigned int first_knot = (motion_solution_.size() > horizon_) ? 1 : 0;
 		for (unsigned int k = 0; k < horizon_; k++) {
+			unsigned int index = std::min(k + first_knot,
+										  (unsigned int) motion_solution_.size() - 1);
 			Eigen::VectorXd current_state;
-			dynamical_system_->fromWholeBodyState(current_state, motion_solution_[k]);
+			dynamical_system_->fromWholeBodyState(current_state, motion_solution_[index]);
 
 			full_initial_point.segment(k * state_dimension, state_dimension) = current_state;
 		}
@@ -153,15 +317,6 @@ void OptimalControl::evaluateBounds(double* decision_lbound, int decision_dim1,
 	Eigen::Map<Eigen::VectorXd> full_constraint_upper_bound(constraint_ubound, constraint_dim2);
 
 
-	// Getting the lower and upper bound of the locomotion state
-	WholeBodyState locomotion_lower_bound, locomotion_upper_bound;
-	dynamical_system_->getStateBounds(locomotion_lower_bound, locomotion_upper_bound);
-
-	// Converting locomotion state bounds to state bounds
-	Eigen::VectorXd state_lower_bound, state_upper_bound;
-	dynamical_system_->fromWholeBodyState(state_lower_bound, locomotion_lower_bound);
-	dynamical_system_->fromWholeBodyState(state_upper_bound, locomotion_upper_bound);
-
 	// Getting the lower and upper constraint bounds for a certain time
 	if (constraint_dimension_ != 0) {
 		unsigned int index = 0;
@@ -214,11 +369,31 @@ void OptimalControl::evaluateBounds(double* decision_lbound, int decision_dim1,
 		}
 	}
 
-	// Setting the full-state lower and upper bounds for the predefined horizon
-	for (unsigned int k = 0; k < horizon_; k++) {
-		// Setting state bounds
-		full_state_lower_bound.segment(k * state_dimension_, state_dimension_) = state_lower_bound;
-		full_state_upper_bound.segment(k * state_dimension_, state_dimension_) = state_upper_bound;
+	// Setting the full-state lower and upper bounds for the predefined horizon, which are
+	// frozen by the problem template
+	if (is_template_built_ && template_state_lower_bound_.size() == decision_dim1) {
+		full_state_lower_bound = template_state_lower_bound_;
+		full_state_upper_bound = template_state_upper_bound_;
+	} else {
+		// Getting the lower and upper bound of the locomotion state
+		WholeBodyState locomotion_lower_bound, locomotion_upper_bound;
+		dynamical_system_->getStateBounds(locomotion_lower_bound, locomotion_upper_bound);
+
+		// Converting locomotion state bounds to state bounds
+		Eigen::VectorXd state_lower_bound, state_upper_bound;
+		dynamical_system_->fromWholeBodyState(state_lower_bound, locomotion_lower_bound);
+		dynamical_system_->fromWholeBodyState(state_upper_bound, locomotion_upper_bound);
+
+		for (unsigned int k = 0; k < horizon_; k++) {
+			// Setting state bounds
+			full_state_lower_bound.segment(k * state_dimension_, state_dimension_) = state_lower_bound;
+			full_state_upper_bound.segment(k * state_dimension_, state_dimension_) = state_upper_bound;
+		}
+
+		if (is_template_built_) {
+			template_state_lower_bound_ = full_state_lower_bound;
+			template_state_upper_bound_ = full_state_upper_bound;
+		}
 	}
 
 	// Computing the terminal bounds in case of full trajectory optimization
@@ -245,99 +420,148 @@ void OptimalControl::evaluateBounds(double* decision_lbound, int decision_dim1,
 void OptimalControl::evaluateConstraints(double* constraint, int constraint_dim,
 										 const double* decision, int decision_dim)
 {
+	DWL_SCOPED_TIMER("OptimalControl::evaluateConstraints");
+
 	// Eigen interfacing to raw buffers
 	const Eigen::Map<const Eigen::VectorXd> decision_var(decision, decision_dim);
-	Eigen::Map<Eigen::VectorXd> full_constraint(constraint, constraint_dim);
-	full_constraint.setZero();
 
 	if (state_dimension_ != (decision_var.size() / horizon_)) {
 		printf(RED "FATAL: the state and decision dimensions are not consistent\n" COLOR_RESET);
 		exit(EXIT_FAILURE);
 	}
 
-	// Getting the initial conditions of the locomotion state
-	WholeBodyState locomotion_initial_cond = dynamical_system_->getInitialState();
-
-	// Setting the initial state
-	unsigned int num_constraints = constraints_.size();
-	for (unsigned int j = 0; j < num_constraints + 1; j++) {
-		if (j == 0) // dynamic system constraint
-			dynamical_system_->setLastState(locomotion_initial_cond);
-		else
-			constraints_[j-1]->setLastState(locomotion_initial_cond);
-	}
+	// Converting the decision variables to whole-body states
+	resetEvaluationArenas();
+	toKnotStates(knot_states_, decision_var);
 
 	// Computing the active and inactive constraints for a predefined horizon
-	WholeBodyState system_state(dynamical_system_->getFloatingBaseSystem().getJointDoF());
-	Eigen::VectorXd decision_state = Eigen::VectorXd::Zero(state_dimension_);
-	unsigned int index = 0;
-	for (unsigned int k = 0; k < horizon_; k++) {
-		// Converting the decision variable for a certain time to a robot state
-		decision_state = decision_var.segment(k * state_dimension_, state_dimension_);
-		dynamical_system_->toWholeBodyState(system_state, decision_state);
+	evaluateHorizon(NULL, constraint, constraint_dim, knot_states_);
+}
 
-		// Adding the time information in cases that time is not a decision variable
-		if (dynamical_system_->isFixedStepIntegration())
-			system_state.duration = dynamical_system_->getFixedStepTime();
-		system_state.time += system_state.duration;
-
-		// Computing the constraints for a certain time
-		if (constraint_dimension_ != 0) {
-			for (unsigned int j = 0; j < num_constraints + 1; j++) {
-				Eigen::VectorXd constraint;
-				unsigned int current_constraint_dim = 0;
-				if (j == 0) {// dynamic system constraint
-					// Evaluating the dynamical constraint
-					if (!dynamical_system_->isSoftConstraint()) {
-						dynamical_system_->compute(constraint, system_state);
-						dynamical_system_->setLastState(system_state);
-
-						// Checking the constraint dimension
-						current_constraint_dim = dynamical_system_->getConstraintDimension();
-						if (current_constraint_dim != (unsigned) constraint.size()) {
-							printf(RED "FATAL: the constraint dimension of %s constraint is not consistent\n"
-									COLOR_RESET, dynamical_system_->getName().c_str());
-							exit(EXIT_FAILURE);
-						}
-					}
-				} else {
-					// Evaluating the constraints
-					if (!constraints_[j-1]->isSoftConstraint()) {
-						constraints_[j-1]->compute(constraint, system_state);
-						constraints_[j-1]->setLastState(system_state);
-
-						// Checking the constraint dimension
-						current_constraint_dim = constraints_[j-1]->getConstraintDimension();
-						if (current_constraint_dim != (unsigned) constraint.size()) {
-							printf(RED "FATAL: the constraint dimension of %s constraint is not consistent\n"
-									COLOR_RESET, constraints_[j-1]->getName().c_str());
-							exit(EXIT_FAILURE);
-						}
-					}
-				}
 
-				// Setting in the full constraint vector
-				full_constraint.segment(index, current_constraint_dim) = constraint;
+void OptimalControl::evaluateConstraintJacobian(double* jacobian_values, int nonzero_dim1,
+												int* row_entries, int nonzero_dim2,
+												int* col_entries, int nonzero_dim3,
+												const double* decision, int decision_dim, bool flag)
+{
+	DWL_SCOPED_TIMER("OptimalControl::evaluateConstraintJacobian");
 
-				index += current_constraint_dim;
-			}
-		}
+	if ((unsigned) nonzero_dim1 != nonzero_jacobian_) {
+		printf(RED "FATAL: the number of nonzero values of the Jacobian is not consistent\n"
+				COLOR_RESET);
+		exit(EXIT_FAILURE);
+	}
 
-		// Computing the terminal constraint in case of full trajectory optimization
-		if (dynamical_system_->isFullTrajectoryOptimization()) {
-			if (k == horizon_ - 1) {
-				Eigen::VectorXd constraint;
-				dynamical_system_->computeTerminalConstraint(constraint, system_state);
+	// Returning the block-banded structure of the Jacobian
+	if (flag) {
+		jacobian_pattern_.getStructure(row_entries, col_entries);
+		return;
+	}
 
-				// Setting in the full constraint vector
-				full_constraint.segment(index, terminal_constraint_dimension_) = constraint;
+	// Eigen interfacing to raw buffers
+	const Eigen::Map<const Eigen::VectorXd> decision_var(decision, decision_dim);
+	if (state_dimension_ != (decision_var.size() / horizon_)) {
+		printf(RED "FATAL: the state and decision dimensions are not consistent\n" COLOR_RESET);
+		exit(EXIT_FAILURE);
+	}
+
+	// Converting the decision variables to whole-body states. Note that the time of the
+	// knots is accumulated as in the constraint evaluation
+	resetEvaluationArenas();
+	toKnotStates(knot_states_, decision_var);
+	const WholeBodyTrajectory& knot_states = knot_states_;
+
+	// Computing the Jacobian blocks of every knot
+	unsigned int integration_dim = (dynamical_system_->isSoftConstraint()) ? 0 :
+			dynamical_system_->getIntegrationDimension();
+	if (integration_dim > constraint_dimension_) {
+		printf(RED "FATAL: the integration dimension of %s constraint is not consistent\n"
+				COLOR_RESET, dynamical_system_->getName().c_str());
+		exit(EXIT_FAILURE);
+	}
+	Eigen::MatrixXd state_jac, last_state_jac, collocation_jac, support_jac;
+	Eigen::MatrixXd integration_jac, last_integration_jac;
+	EvaluationArena::Scope scope(dynamical_system_->getEvaluationArena());
+	Eigen::VectorXd& decision_state = scope.getVector(state_dimension_);
+	Eigen::VectorXd& last_decision_state = scope.getVector();
+	const std::vector<unsigned int>& rows = jacobian_pattern_.getRowEntries();
+	const std::vector<unsigned int>& cols = jacobian_pattern_.getColumnEntries();
+	unsigned int idx = 0;
+	for (unsigned int k = 0; k < horizon_ && constraint_dimension_ != 0; k++) {
+		const WholeBodyState& state = knot_states[k];
+		const WholeBodyState& last_state =
+				(k == 0) ? dynamical_system_->getInitialState() : knot_states[k-1];
+		double second_last_time = (k < 2) ? 0. : knot_states[k-2].time;
+		decision_state = decision_var.segment(k * state_dimension_, state_dimension_);
 
-				index += terminal_constraint_dimension_;
+		state_jac.setZero(constraint_dimension_, state_dimension_);
+		last_state_jac.setZero(constraint_dimension_, state_dimension_);
+
+		// Computing analytically the time integration Jacobian. The collocation Jacobian spans
+		// the support states of the phase, i.e. from the knot before the phase
+		unsigned int first_knot = k;
+		if (collocation_ && integration_dim != 0) {
+			unsigned int phase = knot_phases_[k];
+			first_knot = phase_first_knots_[phase];
+			unsigned int num_support = phase_diff_matrices_[phase].cols();
+			collocation_jac.setZero(integration_dim, num_support * state_dimension_);
+			for (unsigned int j = 0; j < num_support; j++) {
+				dynamical_system_->computeCollocationJacobian(support_jac,
+															  phase_diff_matrices_[phase](k - first_knot, j),
+															  phase_durations_[phase],
+															  first_knot + j == k + 1);
+				collocation_jac.middleCols(j * state_dimension_, state_dimension_) = support_jac;
 			}
+		} else if (integration_dim != 0) {
+			dynamical_system_->setLastState(last_state);
+			dynamical_system_->computeIntegrationJacobian(integration_jac,
+														  last_integration_jac,
+														  state);
+			state_jac.topRows(integration_dim) = integration_jac;
+			last_state_jac.topRows(integration_dim) = last_integration_jac;
 		}
+
+		// Computing the rest of the knot Jacobian, i.e. the dynamical and the other constraints
+		// Note that the last decision state isn't used in the first knot
+		if (k != 0)
+			last_decision_state = decision_var.segment((k - 1) * state_dimension_,
+													   state_dimension_);
+		computeKnotJacobian(state_jac, last_state_jac,
+							state, last_state,
+							decision_state, last_decision_state,
+							second_last_time, k);
+
+		// Setting the values of the knot entries, which are contiguous in the pattern. Note
+		// that the collocation columns start in the support state before the phase
+		unsigned int first_row = k * constraint_dimension_;
+		unsigned int last_row = first_row + constraint_dimension_;
+		while (idx < nonzero_jacobian_ && rows[idx] < last_row) {
+			unsigned int block = cols[idx] / state_dimension_;
+			unsigned int i = rows[idx] - first_row;
+			unsigned int j = cols[idx] - block * state_dimension_;
+			if (collocation_ && i < integration_dim)
+				jacobian_values[idx] =
+						collocation_jac(i, cols[idx] + state_dimension_ - first_knot * state_dimension_);
+			else if (block == k)
+				jacobian_values[idx] = state_jac(i,j);
+			else
+				jacobian_values[idx] = last_state_jac(i,j);
+			++idx;
+		}
+	}
+
+	// Computing analytically the terminal constraint Jacobian
+	if (terminal_constraint_dimension_ != 0) {
+		Eigen::MatrixXd terminal_jac;
+		dynamical_system_->computeTerminalJacobian(terminal_jac, knot_states[horizon_ - 1]);
+		unsigned int first_row = horizon_ * constraint_dimension_;
+		unsigned int first_col = (horizon_ - 1) * state_dimension_;
+		for (; idx < nonzero_jacobian_; idx++)
+			jacobian_values[idx] = terminal_jac(rows[idx] - first_row, cols[idx] - first_col);
 	}
 
 	// Resetting the state buffer
+	unsigned int num_constraints = constraints_.size();
 	for (unsigned int j = 0; j < num_constraints + 1; j++) {
 		if (j == 0) // dynamic system constraint
 			dynamical_system_->resetStateBuffer();
@@ -350,6 +574,8 @@ void OptimalControl::evaluateConstraints(double* constraint, int constraint_dim,
 void OptimalControl::evaluateCosts(double& cost,
 								   const double* decision, int decision_dim)
 {
+	DWL_SCOPED_TIMER("OptimalControl::evaluateCosts");
+
 	// Eigen interfacing to raw buffers
 	const Eigen::Map<const Eigen::VectorXd> decision_var(decision, decision_dim);
 
@@ -358,74 +584,54 @@ void OptimalControl::evaluateCosts(double& cost,
 		exit(EXIT_FAILURE);
 	}
 
-	// Initializing the cost value
-	cost = 0;
+	// Converting the decision variables to whole-body states
+	resetEvaluationArenas();
+	toKnotStates(knot_states_, decision_var);
 
-	// Getting the initial conditions of the locomotion state
-	WholeBodyState locomotion_initial_cond = dynamical_system_->getInitialState();
+	// Computing the cost for predefined horizon
+	evaluateHorizon(&cost, NULL, 0, knot_states_);
+}
 
-	// Setting the initial state
-	unsigned int num_constraints = constraints_.size();
-	for (unsigned int j = 0; j < num_constraints + 1; j++) {
-		if (j == 0) // dynamic system constraint
-			dynamical_system_->setLastState(locomotion_initial_cond);
-		else
-			constraints_[j-1]->setLastState(locomotion_initial_cond);
-	}
 
-	// Computing the cost for predefined horizon
-	WholeBodyState system_state(dynamical_system_->getFloatingBaseSystem().getJointDoF());
-	for (unsigned int k = 0; k < horizon_; k++) {
-		// Converting the decision variable for a certain time to a robot state
-		Eigen::VectorXd decision_state = decision_var.segment(k * state_dimension_, state_dimension_);
-		dynamical_system_->toWholeBodyState(system_state, decision_state);
+void OptimalControl::evaluateCostsAndConstraints(double& cost,
+												 double* constraint, int constraint_dim,
+												 const double* decision, int decision_dim)
+{
+	DWL_SCOPED_TIMER("OptimalControl::evaluateCostsAndConstraints");
 
-		// Adding the time information in cases that time is not a decision variable
-		if (dynamical_system_->isFixedStepIntegration())
-			system_state.duration = dynamical_system_->getFixedStepTime();
-		system_state.time += system_state.duration;
-
-		// Computing the cost function for a certain time
-		double simple_cost;
-		unsigned int num_cost_functions = costs_.size();
-		for (unsigned int j = 0; j < num_cost_functions; j++) {
-			costs_[j]->compute(simple_cost, system_state);
-			cost += simple_cost;
-		}
+	// Eigen interfacing to raw buffers
+	const Eigen::Map<const Eigen::VectorXd> decision_var(decision, decision_dim);
 
-		// Computing the soft-constraints for a certain time
-		for (unsigned int j = 0; j < num_constraints + 1; j++) {
-			if (j == 0) {// dynamic system constraint
-				if (dynamical_system_->isSoftConstraint()) {
-					dynamical_system_->computeSoft(simple_cost, system_state);
-					dynamical_system_->setLastState(system_state);
-					cost += simple_cost;
-				}
-			} else if (constraints_[j-1]->isSoftConstraint()) {
-				constraints_[j-1]->computeSoft(simple_cost, system_state);
-				constraints_[j-1]->setLastState(system_state);
-				cost += simple_cost;
-			}
-		}
+	if (state_dimension_ != (decision_var.size() / horizon_)) {
+		printf(RED "FATAL: the state and decision dimensions are not consistent\n" COLOR_RESET);
+		exit(EXIT_FAILURE);
 	}
 
-	// Resetting the state buffer
-	for (unsigned int j = 0; j < num_constraints + 1; j++) {
-		if (j == 0) // dynamic system constraint
-			dynamical_system_->resetStateBuffer();
-		else
-			constraints_[j-1]->resetStateBuffer();
-	}
+	// Converting the decision variables to whole-body states only once
+	resetEvaluationArenas();
+	toKnotStates(knot_states_, decision_var);
+
+	// Computing the cost and constraints in a single pass over the horizon
+	evaluateHorizon(&cost, constraint, constraint_dim, knot_states_);
 }
 
 
 WholeBodyTrajectory& OptimalControl::evaluateSolution(const Eigen::Ref<const Eigen::VectorXd>& solution)
+{
+	decodeSolution(solution);
+	return completeSolution();
+}
+
+
+const WholeBodyTrajectory& OptimalControl::decodeSolution(const Eigen::Ref<const Eigen::VectorXd>& solution)
 {
 	// Getting the state dimension
 	unsigned int state_dim = dynamical_system_->getDimensionOfState();
 
-	// Recording the solution
+	// Recording the solution, where the trajectory is reserved for the initial state and the
+	// knots
 	motion_solution_.clear();
+	motion_solution_.reserve(horizon_ + 1);
 	motion_solution_.push_back(dynamical_system_->getInitialState());
 	Eigen::VectorXd decision_state = Eigen::VectorXd::Zero(state_dim);
 	double current_time = dynamical_system_->getInitialState().time;
@@ -434,24 +640,19 @@ WholeBodyTrajectory& OptimalControl::evaluateSolution(const Eigen::Ref<const Eig
 		WholeBodyState system_state;
 		decision_state = solution.segment(k * state_dim, state_dim);
 		dynamical_system_->toWholeBodyState(system_state, decision_state);
+		if (utils::Log::isEnabled(utils::LogDebug))
+			DWL_LOG_DEBUG("ocp", "knot %u: x = %s", k, toString(decision_state).c_str());
 
 		// Setting the time information in cases where time is not a decision variable
 		if (dynamical_system_->isFixedStepIntegration())
-			system_state.duration = dynamical_system_->getFixedStepTime();
+			system_state.duration = getKnotDuration(k);
 		current_time += system_state.duration;
 		system_state.time = current_time;
 
 
 		// Setting the acceleration information in cases where the accelerations are not decision
-		// variables
-		WholeBodyState last_system_state;
-		if (k == 0)
-			last_system_state = dynamical_system_->getInitialState();
-		else {
-			Eigen::VectorXd last_decision_state = solution.segment((k - 1) * state_dim, state_dim);
-			dynamical_system_->toWholeBodyState(last_system_state, last_decision_state);
-		}
-
+		// variables. Note that the last state is the previous one of the solution
+		const WholeBodyState& last_system_state = motion_solution_.back();
 		if (system_state.base_acc.isZero() && system_state.joint_acc.isZero()) {
 			// Computing (estimating) the accelerations
 			system_state.base_acc = (system_state.base_vel - last_system_state.base_vel) /
@@ -461,83 +662,670 @@ WholeBodyTrajectory& OptimalControl::evaluateSolution(const Eigen::Ref<const Eig
 		}
 
 
-		// Setting the contact information in cases where time is not a decision variable
-		urdf_model::LinkID contacts = dynamical_system_->getFloatingBaseSystem().getEndEffectors();
-		rbd::BodySelector contact_names = dynamical_system_->getFloatingBaseSystem().getEndEffectorNames();
-		for (urdf_model::LinkID::const_iterator contact_it = contacts.begin();
-				contact_it != contacts.end(); contact_it++) {
-			std::string name = contact_it->first;
-
-			// Defining the contact iterators
-			dwl::rbd::BodyVectorXd::const_iterator pos_it, vel_it, acc_it;
-			dwl::rbd::BodyVector6d::const_iterator eff_it;
-
-			// Filling the desired contact state
-			pos_it = system_state.contact_pos.find(name);
-			vel_it = system_state.contact_vel.find(name);
-			acc_it = system_state.contact_acc.find(name);
-			eff_it = system_state.contact_eff.find(name);
-			if (pos_it != system_state.contact_pos.end()) {
-				if (system_state.contact_pos[name].isZero()) {
-					dynamical_system_->getKinematics().computeForwardKinematics(system_state.contact_pos,
-																				system_state.base_pos,
-																				system_state.joint_pos,
-																				contact_names, rbd::Linear);
+		// Pushing the current state
+		motion_solution_.push_back(system_state);
+	}
+
+	// The contact information is computed on demand
+	is_solution_completed_ = false;
+	return motion_solution_;
+}
+
+
+WholeBodyTrajectory& OptimalControl::completeSolution()
+{
+	if (is_solution_completed_ || motion_solution_.size() != horizon_ + 1)
+		return motion_solution_;
+
+	// Setting the contact information in cases where time is not a decision variable. Note
+	// that only the contacts of the states are filled (i.e. the inactive ones aren't added),
+	// and the three quantities are computed in one kinematic update per knot. The knots are
+	// split in contiguous chunks, which are evaluated by the task scheduler, where the first
+	// chunk uses the original dynamical system
+	unsigned int num_chunks = std::max(getNumberOfChunks(), 1u);
+	unsigned int chunk_size = (horizon_ + num_chunks - 1) / num_chunks;
+	utils::TaskScheduler::getDefault().parallelFor(num_chunks, [&](unsigned int t) {
+		unsigned int first_knot = std::min(t * chunk_size, horizon_);
+		unsigned int last_knot = std::min(first_knot + chunk_size, horizon_);
+		DynamicalSystem* system = (t == 0) ? dynamical_system_ : thread_dynamical_systems_[t-1];
+		for (unsigned int k = first_knot; k < last_knot; k++)
+			computeContactState(motion_solution_[k+1], system->getKinematics());
+	});
+	is_solution_completed_ = true;
+
+	if (utils::Log::isEnabled(utils::LogDebug))
+		logSolution();
+
+	return motion_solution_;
+}
+
+
+void OptimalControl::logSolution() const
+{
+	for (unsigned int k = 1; k < motion_solution_.size(); k++) {
+		const WholeBodyState& state = motion_solution_[k];
+		DWL_LOG_DEBUG("ocp", "knot %u: time = %f, duration = %f", k - 1,
+					  state.time, state.duration);
+		DWL_LOG_DEBUG("ocp", "knot %u: base_pos = %s", k - 1, toString(state.base_pos).c_str());
+		DWL_LOG_DEBUG("ocp", "knot %u: joint_pos = %s", k - 1, toString(state.joint_pos).c_str());
+		DWL_LOG_DEBUG("ocp", "knot %u: base_vel = %s", k - 1, toString(state.base_vel).c_str());
+		DWL_LOG_DEBUG("ocp", "knot %u: joint_vel = %s", k - 1, toString(state.joint_vel).c_str());
+		DWL_LOG_DEBUG("ocp", "knot %u: base_acc = %s", k - 1, toString(state.base_acc).c_str());
+		DWL_LOG_DEBUG("ocp", "knot %u: joint_acc = %s", k - 1, toString(state.joint_acc).c_str());
+		DWL_LOG_DEBUG("ocp", "knot %u: joint_eff = %s", k - 1, toString(state.joint_eff).c_str());
+		for (rbd::BodyVectorXd::const_iterator pos_it = state.contact_pos.begin();
+				pos_it != state.contact_pos.end(); pos_it++)
+			DWL_LOG_DEBUG("ocp", "knot %u: contact_pos[%s] = %s", k - 1, pos_it->first.c_str(),
+						  toString(pos_it->second).c_str());
+		for (rbd::BodyVectorXd::const_iterator vel_it = state.contact_vel.begin();
+				vel_it != state.contact_vel.end(); vel_it++)
+			DWL_LOG_DEBUG("ocp", "knot %u: contact_vel[%s] = %s", k - 1, vel_it->first.c_str(),
+						  toString(vel_it->second).c_str());
+		for (rbd::BodyVectorXd::const_iterator acc_it = state.contact_acc.begin();
+				acc_it != state.contact_acc.end(); acc_it++)
+			DWL_LOG_DEBUG("ocp", "knot %u: contact_acc[%s] = %s", k - 1, acc_it->first.c_str(),
+						  toString(acc_it->second).c_str());
+		for (rbd::BodyVector6d::const_iterator eff_it = state.contact_eff.begin();
+				eff_it != state.contact_eff.end(); eff_it++)
+			DWL_LOG_DEBUG("ocp", "knot %u: contact_eff[%s] = %s", k - 1, eff_it->first.c_str(),
+						  toString(eff_it->second).c_str());
+	}
+}
+
+
+void OptimalControl::computeContactState(WholeBodyState& state,
+										 model::WholeBodyKinematics& kinematics)
+{
+	// Getting the contacts of the state with an undefined quantity
+	bool compute = false;
+	for (rbd::BodyVectorXd::const_iterator pos_it = state.contact_pos.begin();
+			pos_it != state.contact_pos.end() && !compute; pos_it++)
+		compute = pos_it->second.isZero();
+	for (rbd::BodyVectorXd::const_iterator vel_it = state.contact_vel.begin();
+			vel_it != state.contact_vel.end() && !compute; vel_it++)
+		compute = vel_it->second.isZero();
+	for (rbd::BodyVectorXd::const_iterator acc_it = state.contact_acc.begin();
+			acc_it != state.contact_acc.end() && !compute; acc_it++)
+		compute = acc_it->second.isZero();
+	if (!compute)
+		return;
+
+	rbd::BodySelector contact_names;
+	const rbd::BodySelector& end_effectors =
+			kinematics.getFloatingBaseSystem().getEndEffectorNames();
+	for (unsigned int i = 0; i < end_effectors.size(); i++) {
+		const std::string& name = end_effectors[i];
+		if (state.contact_pos.count(name) > 0 ||
+				state.contact_vel.count(name) > 0 ||
+				state.contact_acc.count(name) > 0)
+			contact_names.push_back(name);
+	}
+
+	// Computing the three quantities in one kinematic update, and then filling the undefined
+	// ones
+	rbd::BodyVectorXd contact_pos, contact_vel, contact_acc;
+	kinematics.computeContactKinematics(contact_pos, contact_vel, contact_acc,
+										state.base_pos, state.joint_pos,
+										state.base_vel, state.joint_vel,
+										state.base_acc, state.joint_acc,
+										contact_names);
+	for (rbd::BodyVectorXd::iterator pos_it = state.contact_pos.begin();
+			pos_it != state.contact_pos.end(); pos_it++) {
+		if (pos_it->second.isZero() && contact_pos.count(pos_it->first) > 0)
+			pos_it->second = contact_pos[pos_it->first];
+	}
+	for (rbd::BodyVectorXd::iterator vel_it = state.contact_vel.begin();
+			vel_it != state.contact_vel.end(); vel_it++) {
+		if (vel_it->second.isZero() && contact_vel.count(vel_it->first) > 0)
+			vel_it->second = contact_vel[vel_it->first];
+	}
+	for (rbd::BodyVectorXd::iterator acc_it = state.contact_acc.begin();
+			acc_it != state.contact_acc.end(); acc_it++) {
+		if (acc_it->second.isZero() && contact_acc.count(acc_it->first) > 0)
+			acc_it->second = contact_acc[acc_it->first];
+	}
+}
+
+
+void OptimalControl::toKnotStates(WholeBodyTrajectory& knot_states,
+								  const Eigen::Ref<const Eigen::VectorXd>& decision_var)
+{
+	// Note that the time of the knots is accumulated along the horizon. The whole-body states
+	// are reused between evaluations, so they are only allocated when the horizon changes
+	if (knot_states.size() != horizon_) {
+		unsigned int num_joints = dynamical_system_->getFloatingBaseSystem().getJointDoF();
+		knot_states.assign(horizon_, WholeBodyState(num_joints));
+	}
+	for (unsigned int k = 0; k < horizon_; k++) {
+		double last_time = (k == 0) ? 0. : knot_states[k-1].time;
+		toKnotState(knot_states[k],
+					decision_var.segment(k * state_dimension_, state_dimension_),
+					last_time, k);
+	}
+}
+
+
+void OptimalControl::evaluateHorizon(double* cost,
+									 double* constraint, int constraint_dim,
+									 const WholeBodyTrajectory& knot_states)
+{
+	// Note that the constraint of the knots are evaluated only if there are hard constraints
+	bool with_knot_constraints = (constraint != NULL && constraint_dimension_ != 0);
+	if (constraint != NULL) {
+		Eigen::Map<Eigen::VectorXd> full_constraint(constraint, constraint_dim);
+		full_constraint.setZero();
+	} else
+		constraint_dim = 0;
+
+	// Computing the costs and constraints of the knots. The knots are split in contiguous
+	// chunks, which are evaluated by the task scheduler, where the first chunk uses the
+	// original models
+	if (cost != NULL || with_knot_constraints) {
+		double* knot_constraint = with_knot_constraints ? constraint : NULL;
+		unsigned int num_chunks = getNumberOfChunks();
+		unsigned int chunk_size = (horizon_ + num_chunks - 1) / num_chunks;
+		std::vector<double> chunk_cost(num_chunks, 0.);
+
+		// Updating the desired state of the cloned costs, since it can change between solves
+		if (cost != NULL) {
+			for (unsigned int t = 1; t < num_chunks; t++) {
+				for (unsigned int j = 0; j < costs_.size(); j++)
+					thread_costs_[t-1][j]->setDesiredState(costs_[j]->getDesiredState());
+			}
+		}
+
+		utils::TaskScheduler::getDefault().parallelFor(num_chunks, [&](unsigned int t) {
+			unsigned int first_knot = std::min(t * chunk_size, horizon_);
+			unsigned int last_knot = std::min(first_knot + chunk_size, horizon_);
+			if (t == 0)
+				evaluateChunk((cost != NULL) ? &chunk_cost[0] : NULL,
+							  knot_constraint, knot_states, first_knot, last_knot,
+							  dynamical_system_, constraints_, costs_, 0);
+			else
+				evaluateChunk((cost != NULL) ? &chunk_cost[t] : NULL,
+							  knot_constraint, knot_states, first_knot, last_knot,
+							  thread_dynamical_systems_[t-1],
+							  thread_constraints_[t-1], thread_costs_[t-1], t);
+		});
+
+		// Reducing the cost of the chunks
+		if (cost != NULL) {
+			*cost = 0;
+			for (unsigned int t = 0; t < num_chunks; t++)
+				*cost += chunk_cost[t];
+		}
+	}
+
+	if (constraint == NULL)
+		return;
+	Eigen::Map<Eigen::VectorXd> full_constraint(constraint, constraint_dim);
+
+	// Replacing the time integration of the knots by the collocation constraints of their
+	// phases, which couple all the nodes of the phase
+	EvaluationArena::Scope scope(dynamical_system_->getEvaluationArena());
+	if (with_knot_constraints && collocation_ && !dynamical_system_->isSoftConstraint() &&
+			dynamical_system_->getIntegrationDimension() != 0) {
+		WholeBodyTrajectory support_states;
+		Eigen::VectorXd& collocation_constraint = scope.getVector();
+		for (unsigned int k = 0; k < horizon_; k++) {
+			unsigned int phase = knot_phases_[k];
+			unsigned int node = k - phase_first_knots_[phase];
+			getCollocationSupport(support_states, knot_states, k);
+			dynamical_system_->computeCollocationConstraint(collocation_constraint,
+															support_states,
+															phase_diff_matrices_[phase].row(node).transpose(),
+															phase_durations_[phase],
+															knot_states[k]);
+			full_constraint.segment(k * constraint_dimension_,
+									collocation_constraint.size()) = collocation_constraint;
+		}
+	}
+
+	// Computing the terminal constraint in case of full trajectory optimization
+	if (dynamical_system_->isFullTrajectoryOptimization()) {
+		Eigen::VectorXd& terminal_constraint = scope.getVector();
+		dynamical_system_->computeTerminalConstraint(terminal_constraint,
+													 knot_states[horizon_ - 1]);
+
+		// Setting in the full constraint vector
+		full_constraint.segment(horizon_ * constraint_dimension_,
+								terminal_constraint_dimension_) = terminal_constraint;
+	}
+}
+
+
+void OptimalControl::evaluateChunk(double* cost,
+								   double* constraint,
+								   const WholeBodyTrajectory& knot_states,
+								   unsigned int first_knot,
+								   unsigned int last_knot,
+								   DynamicalSystem* dynamical_system,
+								   std::vector<Constraint<WholeBodyState>*>& constraints,
+								   std::vector<Cost*>& costs,
+								   unsigned int chunk)
+{
+	if (cost != NULL)
+		*cost = 0;
+	if (first_knot >= last_knot)
+		return;
+
+	// Getting the accounting counters of the chunk, where the first term is the dynamical
+	// system. They are skipped if the terms changed after init()
+	unsigned int num_constraints = constraints.size();
+	TermStatistics* dynamics_account = NULL;
+	TermStatistics* constraint_accounts = NULL;
+	TermStatistics* cost_accounts = NULL;
+	if (term_accounting_ && chunk < term_statistics_.size() &&
+			term_statistics_[chunk].size() == 1 + num_constraints + costs.size()) {
+		dynamics_account = &term_statistics_[chunk][0];
+		constraint_accounts = dynamics_account + 1;
+		cost_accounts = constraint_accounts + num_constraints;
+	}
+
+	// Setting the state before the chunk, i.e. the initial state for the first chunk. The
+	// temporaries of the chunk are taken from the arena of its dynamical system
+	EvaluationArena::Scope scope(dynamical_system->getEvaluationArena());
+	WholeBodyState& last_state = scope.getState();
+	last_state = (first_knot == 0) ?
+			dynamical_system->getInitialState() : knot_states[first_knot - 1];
+	dynamical_system->setLastState(last_state);
+	for (unsigned int j = 0; j < num_constraints; j++)
+		constraints[j]->setLastState(last_state);
+
+	// The hard constraints are evaluated in the constraint pass, and the soft ones in the
+	// cost pass
+	bool is_soft_dynamics = dynamical_system->isSoftConstraint();
+	bool is_dynamics_evaluated = is_soft_dynamics ? (cost != NULL) : (constraint != NULL);
+
+	Eigen::VectorXd& current_constraint = scope.getVector();
+	double simple_cost;
+	for (unsigned int k = first_knot; k < last_knot; k++) {
+		// The models keep a view of the knot state as last state, so it isn't copied
+		const WholeBodyState& system_state = knot_states[k];
+
+		// Evaluating the hard constraints. The costs are evaluated afterwards with the same
+		// knot state, so they reuse the kinematics cached by the floating-base system
+		if (constraint != NULL) {
+			Eigen::Map<Eigen::VectorXd> knot_constraint(constraint + k * constraint_dimension_,
+														constraint_dimension_);
+
+			// Evaluating the dynamical constraint
+			unsigned int index = 0;
+			if (!is_soft_dynamics) {
+				{
+					ScopedTermAccount account(dynamics_account);
+					dynamical_system->compute(current_constraint, system_state);
 				}
+
+				// Checking the constraint dimension
+				unsigned int current_constraint_dim = dynamical_system->getConstraintDimension();
+				if (current_constraint_dim != (unsigned) current_constraint.size()) {
+					printf(RED "FATAL: the constraint dimension of %s constraint is not consistent\n"
+							COLOR_RESET, dynamical_system->getName().c_str());
+					exit(EXIT_FAILURE);
+				}
+
+				// Setting in the full constraint vector
+				knot_constraint.segment(index, current_constraint_dim) = current_constraint;
+				index += current_constraint_dim;
 			}
-			if (vel_it != system_state.contact_vel.end()) {
-				if (system_state.contact_vel[name].isZero()) {
-					dynamical_system_->getKinematics().computeVelocity(system_state.contact_vel,
-															   	   	   system_state.base_pos,
-																	   system_state.joint_pos,
-																	   system_state.base_vel,
-																	   system_state.joint_vel,
-																	   contact_names, rbd::Linear);
+
+			// Evaluating the constraints
+			for (unsigned int j = 0; j < num_constraints; j++) {
+				if (!constraints[j]->isSoftConstraint()) {
+					{
+						DWL_SCOPED_TIMER_PROBE(constraint_probes_[j]);
+						ScopedTermAccount account((constraint_accounts != NULL) ?
+								&constraint_accounts[j] : NULL);
+						constraints[j]->compute(current_constraint, system_state);
+					}
+
+					// Checking the constraint dimension
+					unsigned int current_constraint_dim = constraints[j]->getConstraintDimension();
+					if (current_constraint_dim != (unsigned) current_constraint.size()) {
+						printf(RED "FATAL: the constraint dimension of %s constraint is not consistent\n"
+								COLOR_RESET, constraints[j]->getName().c_str());
+						exit(EXIT_FAILURE);
+					}
+
+					// Setting in the full constraint vector
+					knot_constraint.segment(index, current_constraint_dim) = current_constraint;
+					index += current_constraint_dim;
 				}
 			}
-			if (acc_it != system_state.contact_acc.end()) {
-				if (system_state.contact_acc[name].isZero()) {
-					dynamical_system_->getKinematics().computeAcceleration(system_state.contact_acc,
-															   	   	   	   system_state.base_pos,
-																		   system_state.joint_pos,
-																		   system_state.base_vel,
-																		   system_state.joint_vel,
-																		   system_state.base_acc,
-																		   system_state.joint_acc,
-																		   contact_names, rbd::Linear);
+		}
+
+		if (cost != NULL) {
+			// Computing the cost function for a certain time
+			for (unsigned int j = 0; j < costs.size(); j++) {
+				DWL_SCOPED_TIMER_PROBE(cost_probes_[j]);
+				{
+					ScopedTermAccount account((cost_accounts != NULL) ? &cost_accounts[j] : NULL);
+					costs[j]->compute(simple_cost, system_state);
+				}
+				*cost += simple_cost;
+			}
+
+			// Computing the soft-constraints for a certain time
+			if (is_soft_dynamics) {
+				{
+					ScopedTermAccount account(dynamics_account);
+					dynamical_system->computeSoft(simple_cost, system_state);
+				}
+				*cost += simple_cost;
+			}
+			for (unsigned int j = 0; j < num_constraints; j++) {
+				if (constraints[j]->isSoftConstraint()) {
+					DWL_SCOPED_TIMER_PROBE(constraint_probes_[j]);
+					{
+						ScopedTermAccount account((constraint_accounts != NULL) ?
+								&constraint_accounts[j] : NULL);
+						constraints[j]->computeSoft(simple_cost, system_state);
+					}
+					*cost += simple_cost;
 				}
 			}
 		}
 
-		// Pushing the current state
-		motion_solution_.push_back(system_state);
+		// Updating the last state of the evaluated models
+		if (is_dynamics_evaluated)
+			dynamical_system->setLastState(system_state);
+		for (unsigned int j = 0; j < num_constraints; j++) {
+			bool is_soft = constraints[j]->isSoftConstraint();
+			if ((is_soft && cost != NULL) || (!is_soft && constraint != NULL))
+				constraints[j]->setLastState(system_state);
+		}
+	}
 
+	// Resetting the state buffer
+	dynamical_system->resetStateBuffer();
+	for (unsigned int j = 0; j < num_constraints; j++)
+		constraints[j]->resetStateBuffer();
+}
 
 
-		std::cout << "-------------------------------------" << std::endl;
-		std::cout << "x = " << decision_state.transpose() << std::endl;
-		std::cout << "time = " << system_state.time << std::endl;
-		std::cout << "duration = " << system_state.duration << std::endl;
-		std::cout << "base_pos = " << system_state.base_pos.transpose() << std::endl;
-		std::cout << "joint_pos = " << system_state.joint_pos.transpose() << std::endl;
-		std::cout << "base_vel = " << system_state.base_vel.transpose() << std::endl;
-		std::cout << "joint_vel = " << system_state.joint_vel.transpose() << std::endl;
-		std::cout << "base_acc = " << system_state.base_acc.transpose() << std::endl;
-		std::cout << "joint_acc = " << system_state.joint_acc.transpose() << std::endl;
-		std::cout << "joint_eff = " << system_state.joint_eff.transpose() << std::endl;
-		for (urdf_model::LinkID::const_iterator contact_it = contacts.begin();
-				contact_it != contacts.end(); contact_it++) {
-			std::string name = contact_it->first;
+void OptimalControl::cloneThreadModels()
+{
+	deleteThreadModels();
+
+	unsigned int num_threads = num_threads_;
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	if (num_threads < 2 || dynamical_system_ == NULL)
+		return;
+
+	// Cloning the models of every extra thread, note that the state of the models (e.g. the
+	// soft constraint definition) is copied as well
+	bool is_cloned = true;
+	for (unsigned int t = 1; t < num_threads && is_cloned; t++) {
+		DynamicalSystem* dynamical_system = dynamical_system_->clone();
+		thread_dynamical_systems_.push_back(dynamical_system);
+		is_cloned = (dynamical_system != NULL);
+
+		thread_constraints_.push_back(std::vector<Constraint<WholeBodyState>*>());
+		for (unsigned int j = 0; j < constraints_.size() && is_cloned; j++) {
+			Constraint<WholeBodyState>* constraint = constraints_[j]->clone();
+			thread_constraints_.back().push_back(constraint);
+			is_cloned = (constraint != NULL);
+		}
 
-			std::cout << "contact_pos[" << name << "] = " << system_state.contact_pos[name].transpose() << std::endl;
-			std::cout << "contact_vel[" << name << "] = " << system_state.contact_vel[name].transpose() << std::endl;
-			std::cout << "contact_acc[" << name << "] = " << system_state.contact_acc[name].transpose() << std::endl;
-			std::cout << "contact_for[" << name << "] = " << system_state.contact_eff[name].transpose() << std::endl;
+		thread_costs_.push_back(std::vector<Cost*>());
+		for (unsigned int j = 0; j < costs_.size() && is_cloned; j++) {
+			Cost* cost = costs_[j]->clone();
+			thread_costs_.back().push_back(cost);
+			is_cloned = (cost != NULL);
 		}
-		std::cout << "-------------------------------------" << std::endl;
 	}
 
-	return motion_solution_;
+	if (!is_cloned) {
+		printf(YELLOW "Warning: the models could not be cloned, so the horizon is evaluated"
+				" in one thread\n" COLOR_RESET);
+		deleteThreadModels();
+	}
+}
+
+
+void OptimalControl::deleteThreadModels()
+{
+	for (unsigned int t = 0; t < thread_dynamical_systems_.size(); t++)
+		delete thread_dynamical_systems_[t];
+	for (unsigned int t = 0; t < thread_constraints_.size(); t++) {
+		for (unsigned int j = 0; j < thread_constraints_[t].size(); j++)
+			delete thread_constraints_[t][j];
+	}
+	for (unsigned int t = 0; t < thread_costs_.size(); t++) {
+		for (unsigned int j = 0; j < thread_costs_[t].size(); j++)
+			delete thread_costs_[t][j];
+	}
+	thread_dynamical_systems_.clear();
+	thread_constraints_.clear();
+	thread_costs_.clear();
+}
+
+
+void OptimalControl::resetEvaluationArenas()
+{
+	if (dynamical_system_ != NULL)
+		dynamical_system_->getEvaluationArena().reset();
+	for (unsigned int j = 0; j < constraints_.size(); j++)
+		constraints_[j]->getEvaluationArena().reset();
+	for (unsigned int t = 0; t < thread_dynamical_systems_.size(); t++) {
+		thread_dynamical_systems_[t]->getEvaluationArena().reset();
+		for (unsigned int j = 0; j < thread_constraints_[t].size(); j++)
+			thread_constraints_[t][j]->getEvaluationArena().reset();
+	}
+}
+
+
+unsigned int OptimalControl::getNumberOfChunks()
+{
+	// There is one chunk per thread, i.e. the original models and its clones
+	return std::min((unsigned int) thread_dynamical_systems_.size() + 1, horizon_);
+}
+
+
+void OptimalControl::sumTermStatistics(std::map<std::string,TermStatistics>& statistics,
+									   unsigned int first_term,
+									   const std::vector<std::string>& names) const
+{
+	statistics.clear();
+	for (unsigned int i = 0; i < names.size(); i++) {
+		TermStatistics& term = statistics[names[i]];
+		for (unsigned int t = 0; t < term_statistics_.size(); t++) {
+			const TermStatistics& account = term_statistics_[t][first_term + i];
+			term.calls += account.calls;
+			term.total_time += account.total_time;
+		}
+	}
+}
+
+
+void OptimalControl::toKnotState(WholeBodyState& state,
+								 const Eigen::Ref<const Eigen::VectorXd>& decision_state,
+								 double last_time,
+								 unsigned int knot)
+{
+	// Converting the decision variable for a certain time to a robot state
+	dynamical_system_->toWholeBodyState(state, decision_state);
+
+	// Adding the time information in cases that time is not a decision variable
+	if (dynamical_system_->isFixedStepIntegration())
+		state.duration = getKnotDuration(knot);
+	state.time = last_time + state.duration;
+}
+
+
+void OptimalControl::toKnotStatePair(WholeBodyState& state,
+									 WholeBodyState& last_state,
+									 const Eigen::VectorXd& decision_state,
+									 const Eigen::VectorXd& last_decision_state,
+									 unsigned int knot)
+{
+	unsigned int num_joints = dynamical_system_->getFloatingBaseSystem().getJointDoF();
+	state = WholeBodyState(num_joints);
+	if (knot == 0) {
+		last_state = dynamical_system_->getInitialState();
+		toKnotState(state, decision_state, 0., knot);
+	} else {
+		last_state = WholeBodyState(num_joints);
+		toKnotState(last_state, last_decision_state, 0., knot - 1);
+		toKnotState(state, decision_state, last_state.time, knot);
+	}
+}
+
+
+double OptimalControl::getKnotDuration(unsigned int knot)
+{
+	if (collocation_ || knot_mesh_)
+		return knot_durations_[knot];
+	else
+		return dynamical_system_->getFixedStepTime();
+}
+
+
+void OptimalControl::getCollocationSupport(WholeBodyTrajectory& support_states,
+										   const WholeBodyTrajectory& knot_states,
+										   unsigned int knot)
+{
+	unsigned int first_knot = phase_first_knots_[knot_phases_[knot]];
+	unsigned int num_nodes = phase_diff_matrices_[knot_phases_[knot]].rows();
+	support_states.clear();
+	if (first_knot == 0)
+		support_states.push_back(dynamical_system_->getInitialState());
+	else
+		support_states.push_back(knot_states[first_knot - 1]);
+	for (unsigned int i = 0; i < num_nodes; i++)
+		support_states.push_back(knot_states[first_knot + i]);
+}
+
+
+void OptimalControl::computeKnotJacobian(Eigen::MatrixXd& state_jac,
+										 Eigen::MatrixXd& last_state_jac,
+										 const WholeBodyState& state,
+										 const WholeBodyState& last_knot_state,
+										 const Eigen::VectorXd& decision_state,
+										 const Eigen::VectorXd& last_decision_state,
+										 double second_last_time,
+										 unsigned int knot)
+{
+	unsigned int integration_dim = (dynamical_system_->isSoftConstraint()) ? 0 :
+			dynamical_system_->getIntegrationDimension();
+	unsigned int knot_dim = constraint_dimension_ - integration_dim;
+	unsigned int num_joints = dynamical_system_->getFloatingBaseSystem().getJointDoF();
+	EvaluationArena::Scope scope(dynamical_system_->getEvaluationArena());
+	WholeBodyState& last_state = scope.getState();
+	last_state = last_knot_state;
+	double last_time = (knot == 0) ? 0. : last_state.time;
+	Eigen::MatrixXd& dynamical_jac = scope.getMatrix();
+	Eigen::MatrixXd& last_dynamical_jac = scope.getMatrix();
+	Eigen::VectorXd& forward_constraint = scope.getVector();
+	Eigen::VectorXd& backward_constraint = scope.getVector();
+	Eigen::VectorXd& perturbed_decision = scope.getVector();
+	WholeBodyState perturbed_state(num_joints), perturbed_last_state(num_joints);
+
+	// Computing analytically the dynamical constraint Jacobian, if the dynamical system
+	// defines it. Note that the dynamical systems without time integration define the
+	// entire constraint in compute()
+	unsigned int dynamical_dim = 0;
+	if (integration_dim != 0 && knot_dim != 0) {
+		dynamical_system_->setLastState(last_state);
+		if (dynamical_system_->computeDynamicalJacobian(dynamical_jac,
+														last_dynamical_jac,
+														state)) {
+			dynamical_dim = dynamical_jac.rows();
+			state_jac.block(integration_dim, 0, dynamical_dim, state_dimension_) =
+					dynamical_jac;
+			if (knot != 0)
+				last_state_jac.block(integration_dim, 0, dynamical_dim, state_dimension_) =
+						last_dynamical_jac;
+		}
+	}
+
+	// Computing the rest of the knot Jacobian by central differences
+	unsigned int fd_row = integration_dim + dynamical_dim;
+	unsigned int fd_dim = knot_dim - dynamical_dim;
+	bool dynamical_constraint = (dynamical_dim == 0);
+	if (fd_dim != 0) {
+		for (unsigned int j = 0; j < state_dimension_; j++) {
+			perturbed_decision = decision_state;
+			perturbed_decision(j) += jacobian_epsilon_;
+			toKnotState(perturbed_state, perturbed_decision, last_time, knot);
+			evaluateKnotConstraints(forward_constraint, perturbed_state, last_state,
+									dynamical_constraint);
+
+			perturbed_decision(j) -= 2 * jacobian_epsilon_;
+			toKnotState(perturbed_state, perturbed_decision, last_time, knot);
+			evaluateKnotConstraints(backward_constraint, perturbed_state, last_state,
+									dynamical_constraint);
+
+			state_jac.block(fd_row, j, fd_dim, 1) =
+					(forward_constraint - backward_constraint) / (2 * jacobian_epsilon_);
+		}
+
+		// The initial state isn't a decision variable, so there isn't coupling block
+		if (knot != 0) {
+			for (unsigned int j = 0; j < state_dimension_; j++) {
+				perturbed_decision = last_decision_state;
+				perturbed_decision(j) += jacobian_epsilon_;
+				toKnotState(perturbed_last_state, perturbed_decision, second_last_time, knot - 1);
+				toKnotState(perturbed_state, decision_state, perturbed_last_state.time, knot);
+				evaluateKnotConstraints(forward_constraint, perturbed_state,
+										perturbed_last_state, dynamical_constraint);
+
+				perturbed_decision(j) -= 2 * jacobian_epsilon_;
+				toKnotState(perturbed_last_state, perturbed_decision, second_last_time, knot - 1);
+				toKnotState(perturbed_state, decision_state, perturbed_last_state.time, knot);
+				evaluateKnotConstraints(backward_constraint, perturbed_state,
+										perturbed_last_state, dynamical_constraint);
+
+				last_state_jac.block(fd_row, j, fd_dim, 1) =
+						(forward_constraint - backward_constraint) / (2 * jacobian_epsilon_);
+			}
+		}
+	}
+}
+
+
+void OptimalControl::evaluateKnotConstraints(Eigen::VectorXd& constraint,
+											 const WholeBodyState& state,
+											 WholeBodyState& last_state,
+											 bool dynamical_constraint)
+{
+	// Resizing the knot constraint vector, which doesn't include the time integration
+	unsigned int integration_dim = (dynamical_system_->isSoftConstraint()) ? 0 :
+			dynamical_system_->getIntegrationDimension();
+	constraint.resize(constraint_dimension_ - integration_dim);
+
+	unsigned int index = 0;
+	if (!dynamical_system_->isSoftConstraint() && dynamical_constraint) {
+		// Computing the dynamical constraint. Note that the dynamical systems without time
+		// integration define the entire constraint in compute()
+		Eigen::VectorXd current_constraint;
+		dynamical_system_->setLastState(last_state);
+		if (integration_dim == 0)
+			dynamical_system_->compute(current_constraint, state);
+		else
+			dynamical_system_->computeDynamicalConstraint(current_constraint, state);
+
+		unsigned int current_constraint_dim = current_constraint.size();
+		constraint.segment(index, current_constraint_dim) = current_constraint;
+		index += current_constraint_dim;
+	}
+	for (unsigned int j = 0; j < constraints_.size(); j++) {
+		if (!constraints_[j]->isSoftConstraint()) {
+			Eigen::VectorXd current_constraint;
+			constraints_[j]->setLastState(last_state);
+			constraints_[j]->compute(current_constraint, state);
+
+			unsigned int current_constraint_dim = current_constraint.size();
+			constraint.segment(index, current_constraint_dim) = current_constraint;
+			index += current_constraint_dim;
+		}
+	}
+
+	// Removing the rows of the skipped dynamical constraint
+	if (!dynamical_constraint)
+		constraint.conservativeResize(index);
 }
 
 
@@ -635,12 +1423,423 @@ void OptimalControl::removeCost(std::string cost_name)
 }
 
 
+void OptimalControl::setNumberOfThreads(unsigned int num_threads)
+{
+	num_threads_ = num_threads;
+}
+
+
+void OptimalControl::setProblemTemplate(bool enable)
+{
+	problem_template_ = enable;
+
+	// Releasing the template, so the next init() rebuilds the problem
+	if (!enable)
+		is_template_built_ = false;
+}
+
+
+bool OptimalControl::isTemplateBuilt() const
+{
+	return is_template_built_;
+}
+
+
+void OptimalControl::setTermAccounting(bool enable)
+{
+	term_accounting_ = enable;
+}
+
+
+void OptimalControl::getConstraintStatistics(std::map<std::string,TermStatistics>& statistics) const
+{
+	sumTermStatistics(statistics, 0, constraint_names_);
+}
+
+
+void OptimalControl::getCostStatistics(std::map<std::string,TermStatistics>& statistics) const
+{
+	sumTermStatistics(statistics, constraint_names_.size(), cost_names_);
+}
+
+
+void OptimalControl::resetTermStatistics()
+{
+	for (unsigned int t = 0; t < term_statistics_.size(); t++)
+		std::fill(term_statistics_[t].begin(), term_statistics_[t].end(), TermStatistics());
+}
+
+
 void OptimalControl::setHorizon(unsigned int horizon)
 {
+	if (is_template_built_) {
+		printf(YELLOW "Warning: the horizon of the problem template cannot be changed\n"
+				COLOR_RESET);
+		return;
+	}
+
 	if (horizon == 0)
 		horizon_ = 1;
 	else
 		horizon_ = horizon;
+
+	// The collocation phases and the non-uniform mesh define their own horizon
+	collocation_ = false;
+	knot_mesh_ = false;
+}
+
+
+void OptimalControl::setCollocationPhases(const std::vector<unsigned int>& num_nodes,
+										  const std::vector<double>& durations)
+{
+	if (is_template_built_) {
+		printf(YELLOW "Warning: the collocation phases of the problem template cannot be"
+				" changed\n" COLOR_RESET);
+		return;
+	}
+
+	phase_durations_.clear();
+	phase_diff_matrices_.clear();
+	phase_first_knots_.clear();
+	knot_phases_.clear();
+	knot_durations_.clear();
+	collocation_ = false;
+	knot_mesh_ = false;
+	if (num_nodes.size() != durations.size()) {
+		printf(YELLOW "Warning: the number of collocation phases and durations are not"
+				" consistent\n" COLOR_RESET);
+		return;
+	}
+
+	// Computing the nodes and the differentiation matrix of every phase, where the duration
+	// of a knot is the distance to the previous node
+	unsigned int horizon = 0;
+	for (unsigned int p = 0; p < num_nodes.size(); p++) {
+		if (num_nodes[p] == 0 || durations[p] <= 0.) {
+			printf(YELLOW "Warning: the collocation phase %i doesn't have nodes or duration\n"
+					COLOR_RESET, p);
+			continue;
+		}
+
+		Eigen::VectorXd nodes;
+		Eigen::MatrixXd diff_mat;
+		math::computeRadauNodes(nodes, num_nodes[p]);
+		math::computeRadauDifferentiationMatrix(diff_mat, nodes);
+
+		unsigned int phase = phase_durations_.size();
+		phase_durations_.push_back(durations[p]);
+		phase_diff_matrices_.push_back(diff_mat);
+		phase_first_knots_.push_back(horizon);
+		double last_node = -1.;
+		for (unsigned int i = 0; i < num_nodes[p]; i++) {
+			knot_phases_.push_back(phase);
+			knot_durations_.push_back((nodes(i) - last_node) * durations[p] / 2);
+			last_node = nodes(i);
+		}
+		horizon += num_nodes[p];
+	}
+
+	if (horizon != 0) {
+		horizon_ = horizon;
+		collocation_ = true;
+	}
+}
+
+
+void OptimalControl::setKnotDurations(const std::vector<double>& durations)
+{
+	if (is_template_built_) {
+		printf(YELLOW "Warning: the knot mesh of the problem template cannot be changed\n"
+				COLOR_RESET);
+		return;
+	}
+
+	if (durations.empty()) {
+		printf(YELLOW "Warning: the knot mesh doesn't have knots\n" COLOR_RESET);
+		return;
+	}
+	for (unsigned int k = 0; k < durations.size(); k++) {
+		if (durations[k] <= 0.) {
+			printf(YELLOW "Warning: the duration of the knot %i has to be positive\n"
+					COLOR_RESET, k);
+			return;
+		}
+	}
+
+	// The knot mesh replaces the collocation phases, which share the knot durations
+	phase_durations_.clear();
+	phase_diff_matrices_.clear();
+	phase_first_knots_.clear();
+	knot_phases_.clear();
+	collocation_ = false;
+
+	knot_durations_ = durations;
+	horizon_ = durations.size();
+	knot_mesh_ = true;
+}
+
+
+void OptimalControl::getKnotDurations(std::vector<double>& durations)
+{
+	durations.resize(horizon_);
+	for (unsigned int k = 0; k < horizon_; k++)
+		durations[k] = getKnotDuration(k);
+}
+
+
+void OptimalControl::computeIntegrationErrors(Eigen::VectorXd& errors,
+											  const Eigen::Ref<const Eigen::VectorXd>& solution)
+{
+	errors.setZero(horizon_);
+	if (solution.size() != horizon_ * state_dimension_) {
+		printf(YELLOW "Warning: the solution dimension is not consistent, so it cannot be"
+				" estimated its integration error\n" COLOR_RESET);
+		return;
+	}
+	if (collocation_)
+		return;
+
+	// Estimating the error of every knot from the previous one, where the previous state of
+	// the first knot is the initial state
+	WholeBodyTrajectory knot_states;
+	toKnotStates(knot_states, solution);
+	Eigen::VectorXd error;
+	for (unsigned int k = 0; k < horizon_; k++) {
+		if (k == 0)
+			dynamical_system_->setLastState(dynamical_system_->getInitialState());
+		else
+			dynamical_system_->setLastState(knot_states[k-1]);
+
+		dynamical_system_->estimateIntegrationError(error, knot_states[k]);
+		if (error.size() != 0)
+			errors(k) = error.cwiseAbs().maxCoeff();
+	}
+
+	// Resetting the state buffer, since it has views of the local knot states
+	dynamical_system_->resetStateBuffer();
+}
+
+
+bool OptimalControl::refineKnotMesh(const Eigen::Ref<const Eigen::VectorXd>& solution,
+									double tolerance,
+									double min_duration)
+{
+	if (!dynamical_system_->isFixedStepIntegration() || collocation_) {
+		printf(YELLOW "Warning: the knot mesh can be refined only with fixed-step integration"
+				" and without collocation phases\n" COLOR_RESET);
+		return false;
+	}
+	if (is_template_built_) {
+		printf(YELLOW "Warning: the knot mesh of the problem template cannot be refined\n"
+				COLOR_RESET);
+		return false;
+	}
+	if (solution.size() != horizon_ * state_dimension_) {
+		printf(YELLOW "Warning: the solution dimension is not consistent, so it cannot be"
+				" refined its knot mesh\n" COLOR_RESET);
+		return false;
+	}
+
+	Eigen::VectorXd errors;
+	computeIntegrationErrors(errors, solution);
+
+	// Splitting the knots with bigger errors in halves, where the new knot is the midpoint of
+	// the previous and current decision states. Note that the previous decision state of the
+	// first knot is the initial state
+	std::vector<double> durations;
+	std::vector<Eigen::VectorXd> decision_states;
+	Eigen::VectorXd last_decision_state;
+	dynamical_system_->fromWholeBodyState(last_decision_state,
+										  dynamical_system_->getInitialState());
+	for (unsigned int k = 0; k < horizon_; k++) {
+		double duration = getKnotDuration(k);
+		Eigen::VectorXd decision_state = solution.segment(k * state_dimension_, state_dimension_);
+		if (errors(k) > tolerance && duration / 2 >= min_duration) {
+			duration /= 2;
+			durations.push_back(duration);
+			decision_states.push_back(0.5 * (last_decision_state + decision_state));
+		}
+		durations.push_back(duration);
+		decision_states.push_back(decision_state);
+		last_decision_state = decision_state;
+	}
+	if (durations.size() == horizon_)
+		return false;
+
+	// Defining the refined mesh and its starting point
+	setKnotDurations(durations);
+	shifted_starting_point_.resize(horizon_ * state_dimension_);
+	for (unsigned int k = 0; k < horizon_; k++)
+		shifted_starting_point_.segment(k * state_dimension_, state_dimension_) =
+				decision_states[k];
+
+	return true;
+}
+
+
+void OptimalControl::getIntegrationBlock(unsigned int& index,
+										 unsigned int& dim)
+{
+	index = dim = 0;
+	if (dynamical_system_ == NULL || dynamical_system_->isSoftConstraint() || collocation_)
+		return;
+
+	// The positions follow the time in the decision state
+	const WholeBodyVariables& variables = dynamical_system_->getDecisionVariables();
+	if (variables.position) {
+		index = variables.time;
+		dim = dynamical_system_->getIntegrationDimension();
+	}
+}
+
+
+void OptimalControl::getKnotBounds(Eigen::VectorXd& state_lower_bound,
+								   Eigen::VectorXd& state_upper_bound,
+								   Eigen::VectorXd& constraint_lower_bound,
+								   Eigen::VectorXd& constraint_upper_bound)
+{
+	// The bounds are the same for every knot, so they are read from the first one
+	unsigned int decision_dim = horizon_ * state_dimension_;
+	unsigned int constraint_dim = horizon_ * constraint_dimension_ + terminal_constraint_dimension_;
+	Eigen::VectorXd full_state_lower(decision_dim), full_state_upper(decision_dim);
+	Eigen::VectorXd full_constraint_lower(constraint_dim), full_constraint_upper(constraint_dim);
+	evaluateBounds(full_state_lower.data(), decision_dim,
+				   full_state_upper.data(), decision_dim,
+				   full_constraint_lower.data(), constraint_dim,
+				   full_constraint_upper.data(), constraint_dim);
+
+	unsigned int integration_dim = (dynamical_system_->isSoftConstraint()) ? 0 :
+			dynamical_system_->getIntegrationDimension();
+	unsigned int knot_dim = constraint_dimension_ - integration_dim;
+	state_lower_bound = full_state_lower.head(state_dimension_);
+	state_upper_bound = full_state_upper.head(state_dimension_);
+	constraint_lower_bound = full_constraint_lower.segment(integration_dim, knot_dim);
+	constraint_upper_bound = full_constraint_upper.segment(integration_dim, knot_dim);
+}
+
+
+void OptimalControl::computeKnotTransition(Eigen::VectorXd& decision_state,
+										   Eigen::MatrixXd& state_jacobian,
+										   Eigen::MatrixXd& last_state_jacobian,
+										   const Eigen::VectorXd& last_decision_state,
+										   unsigned int knot)
+{
+	unsigned int index, dim;
+	getIntegrationBlock(index, dim);
+	if (dim == 0) {
+		printf(RED "FATAL: the %s dynamical system doesn't define a stage transition\n"
+				COLOR_RESET, dynamical_system_->getName().c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	// The time integration is linear in the positions of the knot with Jacobian -I, so its
+	// residual is the correction of the positions
+	WholeBodyState state, last_state;
+	toKnotStatePair(state, last_state, decision_state, last_decision_state, knot);
+	Eigen::VectorXd integration;
+	dynamical_system_->setLastState(last_state);
+	dynamical_system_->numericalIntegration(integration, state);
+	decision_state.segment(index, dim) += integration;
+
+	// Computing the integration Jacobians, which don't depend on the positions
+	dynamical_system_->computeIntegrationJacobian(state_jacobian, last_state_jacobian, state);
+	dynamical_system_->resetStateBuffer();
+}
+
+
+void OptimalControl::evaluateKnotConstraints(Eigen::VectorXd& constraint,
+											 const Eigen::VectorXd& decision_state,
+											 const Eigen::VectorXd& last_decision_state,
+											 unsigned int knot)
+{
+	WholeBodyState state, last_state;
+	toKnotStatePair(state, last_state, decision_state, last_decision_state, knot);
+	evaluateKnotConstraints(constraint, state, last_state);
+
+	// Resetting the state buffer
+	dynamical_system_->resetStateBuffer();
+	for (unsigned int j = 0; j < constraints_.size(); j++)
+		constraints_[j]->resetStateBuffer();
+}
+
+
+void OptimalControl::evaluateKnotConstraintJacobian(Eigen::MatrixXd& state_jacobian,
+													Eigen::MatrixXd& last_state_jacobian,
+													const Eigen::VectorXd& decision_state,
+													const Eigen::VectorXd& last_decision_state,
+													unsigned int knot)
+{
+	WholeBodyState state, last_state;
+	toKnotStatePair(state, last_state, decision_state, last_decision_state, knot);
+
+	// Computing the knot Jacobian without the time integration rows. Note that the time of
+	// the knots is relative to the one before the previous knot
+	unsigned int integration_dim = (dynamical_system_->isSoftConstraint()) ? 0 :
+			dynamical_system_->getIntegrationDimension();
+	unsigned int knot_dim = constraint_dimension_ - integration_dim;
+	Eigen::MatrixXd state_jac = Eigen::MatrixXd::Zero(constraint_dimension_, state_dimension_);
+	Eigen::MatrixXd last_state_jac = state_jac;
+	computeKnotJacobian(state_jac, last_state_jac,
+						state, last_state,
+						decision_state, last_decision_state,
+						0., knot);
+	state_jacobian = state_jac.bottomRows(knot_dim);
+	last_state_jacobian = last_state_jac.bottomRows(knot_dim);
+
+	// Resetting the state buffer
+	dynamical_system_->resetStateBuffer();
+	for (unsigned int j = 0; j < constraints_.size(); j++)
+		constraints_[j]->resetStateBuffer();
+}
+
+
+void OptimalControl::evaluateKnotCost(double& cost,
+									  const Eigen::VectorXd& decision_state,
+									  const Eigen::VectorXd& last_decision_state,
+									  unsigned int knot)
+{
+	WholeBodyState state, last_state;
+	toKnotStatePair(state, last_state, decision_state, last_decision_state, knot);
+
+	// Computing the cost functions and soft constraints as in evaluateChunk
+	double simple_cost;
+	cost = 0.;
+	for (unsigned int j = 0; j < costs_.size(); j++) {
+		costs_[j]->compute(simple_cost, state);
+		cost += simple_cost;
+	}
+	if (dynamical_system_->isSoftConstraint()) {
+		dynamical_system_->setLastState(last_state);
+		dynamical_system_->computeSoft(simple_cost, state);
+		dynamical_system_->resetStateBuffer();
+		cost += simple_cost;
+	}
+	for (unsigned int j = 0; j < constraints_.size(); j++) {
+		if (constraints_[j]->isSoftConstraint()) {
+			constraints_[j]->setLastState(last_state);
+			constraints_[j]->computeSoft(simple_cost, state);
+			constraints_[j]->resetStateBuffer();
+			cost += simple_cost;
+		}
+	}
+}
+
+
+bool OptimalControl::evaluateTerminalConstraint(Eigen::VectorXd& constraint,
+												Eigen::MatrixXd& jacobian,
+												Eigen::VectorXd& lower_bound,
+												Eigen::VectorXd& upper_bound,
+												const Eigen::VectorXd& decision_state)
+{
+	if (terminal_constraint_dimension_ == 0)
+		return false;
+
+	WholeBodyState state;
+	toKnotState(state, decision_state, 0., horizon_ - 1);
+	dynamical_system_->computeTerminalConstraint(constraint, state);
+	dynamical_system_->computeTerminalJacobian(jacobian, state);
+	dynamical_system_->getTerminalBounds(lower_bound, upper_bound);
+	return true;
 }
 
 
@@ -667,5 +1866,38 @@ const unsigned int& OptimalControl::getHorizon()
 	return horizon_;
 }
 
+
+utils::MemoryUsage OptimalControl::getMemoryUsage() const
+{
+	utils::MemoryUsage usage("optimal_control");
+	usage.add("motion_solution", getHeapBytes(motion_solution_));
+	usage.add("knot_states", getHeapBytes(knot_states_) +
+			utils::getHeapBytes(shifted_starting_point_));
+	usage.add("collocation", utils::getHeapBytes(phase_durations_) +
+			utils::getHeapBytes(phase_diff_matrices_));
+	usage.add("knot_mesh", utils::getHeapBytes(knot_phases_) +
+			utils::getHeapBytes(phase_first_knots_) + utils::getHeapBytes(knot_durations_));
+	usage.add("problem_template", utils::getHeapBytes(template_state_lower_bound_) +
+			utils::getHeapBytes(template_state_upper_bound_) +
+			utils::getHeapBytes(constraint_probes_) + utils::getHeapBytes(cost_probes_));
+	usage.add("term_statistics", utils::getHeapBytes(term_statistics_) +
+			utils::getHeapBytes(constraint_names_) + utils::getHeapBytes(cost_names_));
+
+	// The arenas of the models of every thread
+	std::size_t arena_bytes = 0;
+	if (dynamical_system_ != NULL)
+		arena_bytes += dynamical_system_->getEvaluationArena().getHeapBytes();
+	for (unsigned int j = 0; j < constraints_.size(); j++)
+		arena_bytes += constraints_[j]->getEvaluationArena().getHeapBytes();
+	for (unsigned int t = 0; t < thread_dynamical_systems_.size(); t++) {
+		arena_bytes += thread_dynamical_systems_[t]->getEvaluationArena().getHeapBytes();
+		for (unsigned int j = 0; j < thread_constraints_[t].size(); j++)
+			arena_bytes += thread_constraints_[t][j]->getEvaluationArena().getHeapBytes();
+	}
+	usage.add("evaluation_arenas", arena_bytes);
+
+	return usage;
+}
+
 } //@namespace ocp
 } //@namespace dwl
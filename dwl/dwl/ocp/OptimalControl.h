@@ -5,6 +5,8 @@
 #include <dwl/ocp/DynamicalSystem.h>
 #include <dwl/ocp/Constraint.h>
 #include <dwl/ocp/Cost.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <map>
 
 
 
@@ -14,6 +16,19 @@ namespace dwl
 namespace ocp
 {
 
+/**
+ * @struct TermStatistics
+ * @brief Number of calls and accumulated time (in seconds) of a constraint or cost
+ */
+struct TermStatistics
+{
+	TermStatistics() : calls(0), total_time(0.) {}
+
+	unsigned long calls;
+	double total_time;
+};
+
+
 /**
  * @class OptimalControl
  * @brief An optimal control problem requires information of constraints (dynamical, active or
@@ -35,11 +50,20 @@ class OptimalControl : public model::OptimizationModel
 		void init(bool only_soft_constraints);
 
 		/**
-		 * @brief Sets the initial trajectory
+		 * @brief Sets the initial trajectory, i.e. the states of the knots. A trajectory
+		 * longer than the horizon starts with the initial state (e.g. a solution)
 		 * @param WholeBodyTrajectory& Initial whole-body trajectory
 		 */
 		void setStartingTrajectory(WholeBodyTrajectory& initial_trajectory);
 
+		/**
+		 * @brief Sets the starting point from a previous solution shifted by one knot, i.e. for
+		 * warm-starting a receding-horizon problem. The last knot is repeated, and this starting
+		 * point has priority over the starting trajectory
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Previous solution
+		 */
+		void setShiftedStartingPoint(const Eigen::Ref<const Eigen::VectorXd>& solution);
+
 		/**
 		 * @brief Gets the starting point of the problem
 		 * @param double* Initial values for the decision variables, $x$
@@ -85,12 +109,69 @@ class OptimalControl : public model::OptimizationModel
 								 const double* decision, int decision_dim);
 
 		/**
-		 * @brief Evaluates the solution from an optimizer
+		 * @brief Evaluates the cost and constraint functions in a single pass over the horizon,
+		 * i.e. the decision variables are converted once and the costs of a knot are evaluated
+		 * after its constraints, so they share the kinematics of the knot state
+		 * @param double& Value of the objective function ($f(x)$)
+		 * @param double* Array of constraint function values, $g(x)$
+		 * @param int Number of constraint variables (dimension of $g(x)$)
+		 * @param const double* Array of the decision variables, $x$
+		 * @param int Number of decision variables (dimension of $x$)
+		 */
+		void evaluateCostsAndConstraints(double& cost,
+										 double* constraint, int constraint_dim,
+										 const double* decision, int decision_dim);
+
+		/**
+		 * @brief Evaluates the Jacobian of the constraint function given a current decision
+		 * state. The constraints of a knot depend only on its decision state and the previous
+		 * one (time integration), so the Jacobian has a block-banded structure over the horizon.
+		 * The time integration and terminal blocks are computed analytically, and the rest of
+		 * blocks are computed by central differences of the knot constraints, i.e. it doesn't
+		 * require evaluations of the whole horizon
+		 * @param double* Values of the entries in the Jacobian of the constraints
+		 * @param int Number of nonzero elements in the Jacobian (dimension of values)
+		 * @param int* Row indices of entries in the Jacobian of the constraints
+		 * @param int Number of nonzero elements in the Jacobian (dimension of row_entries)
+		 * @param int* Column indices of entries in the Jacobian of the constraints
+		 * @param int Number of nonzero elements in the Jacobian (dimension of col_entries)
+		 * @param const double* Array for the decision variables, $x$, at which $\nabla g(x)^T$
+		 * is evaluated
+		 * @param int Number of decision variables (dimension of $x$)
+		 * @param bool True if it's only required the structure of the Jacobian
+		 */
+		void evaluateConstraintJacobian(double* jacobian_values, int nonzero_dim1,
+										int* row_entries, int nonzero_dim2,
+										int* col_entries, int nonzero_dim3,
+										const double* decision, int decision_dim, bool flag);
+
+		/**
+		 * @brief Evaluates the solution from an optimizer, i.e. it decodes the solution and
+		 * computes its contact information (see decodeSolution and completeSolution)
 		 * @param const Eigen::Ref<const Eigen::VectorXd>& Solution vector
 		 * @return WholeBodyTrajectory& Returns the whole-body trajectory solution
 		 */
 		WholeBodyTrajectory& evaluateSolution(const Eigen::Ref<const Eigen::VectorXd>& solution);
 
+		/**
+		 * @brief Decodes the solution from an optimizer, i.e. the times and the base and
+		 * joint states of the knots, where the accelerations are estimated if they aren't
+		 * decision variables. This is the cheap step for the consumers that don't need the
+		 * contact information (e.g. intermediate callbacks), and the contacts that aren't
+		 * decision variables are computed on demand by completeSolution
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Solution vector
+		 * @return const WholeBodyTrajectory& Returns the decoded whole-body trajectory
+		 */
+		const WholeBodyTrajectory& decodeSolution(const Eigen::Ref<const Eigen::VectorXd>& solution);
+
+		/**
+		 * @brief Computes the contact positions, velocities and accelerations of the decoded
+		 * solution that aren't decision variables. They are computed once per decoded
+		 * solution, and the knots are logged at the debug level (see utils::Log)
+		 * @return WholeBodyTrajectory& Returns the whole-body trajectory solution
+		 */
+		WholeBodyTrajectory& completeSolution();
+
 		/**
 		 * @brief Adds the dynamical system (active constraints) to the optimization problem
 		 * @param DynamicalSystem* Dynamical system constraint to add it
@@ -130,6 +211,206 @@ class OptimalControl : public model::OptimizationModel
 		 */
 		void setHorizon(unsigned int horizon);
 
+		/**
+		 * @brief Sets a pseudospectral (direct-collocation) transcription, where the horizon is
+		 * split in phases (e.g. the contact phases of the preview schedule) and the knots of
+		 * every phase are its flipped Legendre-Gauss-Radau nodes. The time integration of the
+		 * knots is replaced by the collocation constraints of their phase, so the horizon is the
+		 * sum of the nodes. It requires fixed-step integration, and empty vectors return to the
+		 * knot-to-knot integration
+		 * @param const std::vector<unsigned int>& Number of nodes per phase
+		 * @param const std::vector<double>& Duration of every phase
+		 */
+		void setCollocationPhases(const std::vector<unsigned int>& num_nodes,
+								  const std::vector<double>& durations);
+
+		/**
+		 * @brief Sets a non-uniform mesh of knots, i.e. the duration of every knot instead of
+		 * the fixed-step time. The horizon is the number of knots. It requires fixed-step
+		 * integration, and setHorizon() returns to the uniform mesh
+		 * @param const std::vector<double>& Duration of every knot
+		 */
+		void setKnotDurations(const std::vector<double>& durations);
+
+		/**
+		 * @brief Gets the duration of every knot, i.e. the fixed-step time in the uniform mesh
+		 * @param std::vector<double>& Duration of every knot
+		 */
+		void getKnotDurations(std::vector<double>& durations);
+
+		/**
+		 * @brief Computes the estimated error of the time integration of every knot of a
+		 * solution, i.e. the maximum absolute value of the step-doubling error of the
+		 * generalized positions (see DynamicalSystem::estimateIntegrationError). The errors
+		 * are zero for the collocation phases, which don't use the knot-to-knot integration
+		 * @param Eigen::VectorXd& Integration error per knot
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Solution vector
+		 */
+		void computeIntegrationErrors(Eigen::VectorXd& errors,
+									  const Eigen::Ref<const Eigen::VectorXd>& solution);
+
+		/**
+		 * @brief Refines the mesh of knots of a solution, where the knots with an integration
+		 * error bigger than the tolerance are split in halves and the rest are kept. The
+		 * refined knots are linearly interpolated from the solution, and they define the
+		 * starting point of the next solve. It requires fixed-step integration
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Solution vector of the current mesh
+		 * @param double Tolerance of the integration error
+		 * @param double Minimum duration of the refined knots
+		 * @return False if none knot was refined
+		 */
+		bool refineKnotMesh(const Eigen::Ref<const Eigen::VectorXd>& solution,
+							double tolerance,
+							double min_duration = 0.);
+
+		/**
+		 * @brief Sets the number of threads used for evaluating the constraints and costs. The
+		 * knots are split in contiguous chunks, and each thread uses its own clones of the
+		 * dynamical system, constraints and costs (their state buffers would race otherwise).
+		 * The clones are created in init(), so it falls back to serial evaluation if any of them
+		 * cannot be cloned. The default value is 1, i.e. serial evaluation
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * @brief Enables/disables the problem-template mode for re-solving the same problem,
+		 * e.g. in receding-horizon loops. After the first init(), the dimensions, sparsity
+		 * pattern, thread clones and state bounds are frozen, so the next init() calls return
+		 * immediately and the horizon cannot change. Only the numeric data (initial, terminal
+		 * and desired states, and the constraint bounds) are updated per solve. Disabling it
+		 * rebuilds the problem in the next init()
+		 * @param bool True for enabling the problem template
+		 */
+		void setProblemTemplate(bool enable);
+
+		/** @brief Indicates if the problem template was built, i.e. if init() is skipped */
+		bool isTemplateBuilt() const;
+
+		/**
+		 * @brief Enables/disables the accounting of the constraints and costs, i.e. the number
+		 * of calls and time of every term in the evaluation of the horizon. Every chunk of knots
+		 * accumulates in its own counters, so it only reads the clock around the terms and it
+		 * doesn't synchronize the threads. It's enabled by default
+		 * @param bool True for enabling the accounting
+		 */
+		void setTermAccounting(bool enable);
+
+		/**
+		 * @brief Gets the accounting of the dynamical system and constraints (hard and soft)
+		 * since the last init() or reset, keyed by their names. Note that the terms with the
+		 * same name are accumulated together
+		 * @param std::map<std::string,TermStatistics>& Statistics per constraint
+		 */
+		void getConstraintStatistics(std::map<std::string,TermStatistics>& statistics) const;
+
+		/**
+		 * @brief Gets the accounting of the costs since the last init() or reset, keyed by
+		 * their names
+		 * @param std::map<std::string,TermStatistics>& Statistics per cost
+		 */
+		void getCostStatistics(std::map<std::string,TermStatistics>& statistics) const;
+
+		/** @brief Resets the accounting of the constraints and costs */
+		void resetTermStatistics();
+
+		/**
+		 * @brief Gets the time-integration block of the knot decision state, i.e. the
+		 * generalized positions that the integration rows define from the rest of the knots
+		 * (their Jacobian is -I). It defines the stage transition of shooting solvers such as
+		 * DDP. The dimension is zero if the dynamical system is soft, if it doesn't integrate
+		 * the positions or if the knots are collocation nodes
+		 * @param unsigned int& Index of the block in the knot decision state
+		 * @param unsigned int& Dimension of the block
+		 */
+		void getIntegrationBlock(unsigned int& index,
+								 unsigned int& dim);
+
+		/**
+		 * @brief Gets the bounds of the knot decision state and of the knot constraints, i.e.
+		 * without the time integration rows
+		 * @param Eigen::VectorXd& Lower bounds of the knot decision state
+		 * @param Eigen::VectorXd& Upper bounds of the knot decision state
+		 * @param Eigen::VectorXd& Lower bounds of the knot constraints
+		 * @param Eigen::VectorXd& Upper bounds of the knot constraints
+		 */
+		void getKnotBounds(Eigen::VectorXd& state_lower_bound,
+						   Eigen::VectorXd& state_upper_bound,
+						   Eigen::VectorXd& constraint_lower_bound,
+						   Eigen::VectorXd& constraint_upper_bound);
+
+		/**
+		 * @brief Computes the stage transition of a knot, i.e. it sets the integration block of
+		 * the knot decision state that fulfills the time integration from the previous knot.
+		 * It also returns the Jacobians of the time integration. Note that the previous
+		 * decision state is unused in the first knot, which starts from the initial state
+		 * @param Eigen::VectorXd& Decision state of the knot
+		 * @param Eigen::MatrixXd& Integration Jacobian with respect to the knot
+		 * @param Eigen::MatrixXd& Integration Jacobian with respect to the previous knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		void computeKnotTransition(Eigen::VectorXd& decision_state,
+								   Eigen::MatrixXd& state_jacobian,
+								   Eigen::MatrixXd& last_state_jacobian,
+								   const Eigen::VectorXd& last_decision_state,
+								   unsigned int knot);
+
+		/**
+		 * @brief Evaluates the hard constraints of a knot without the time integration
+		 * @param Eigen::VectorXd& Knot constraint vector
+		 * @param const Eigen::VectorXd& Decision state of the knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		void evaluateKnotConstraints(Eigen::VectorXd& constraint,
+									 const Eigen::VectorXd& decision_state,
+									 const Eigen::VectorXd& last_decision_state,
+									 unsigned int knot);
+
+		/**
+		 * @brief Computes the Jacobians of the hard constraints of a knot without the time
+		 * integration
+		 * @param Eigen::MatrixXd& Jacobian with respect to the knot
+		 * @param Eigen::MatrixXd& Jacobian with respect to the previous knot
+		 * @param const Eigen::VectorXd& Decision state of the knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		void evaluateKnotConstraintJacobian(Eigen::MatrixXd& state_jacobian,
+											Eigen::MatrixXd& last_state_jacobian,
+											const Eigen::VectorXd& decision_state,
+											const Eigen::VectorXd& last_decision_state,
+											unsigned int knot);
+
+		/**
+		 * @brief Evaluates the costs and soft constraints of a knot
+		 * @param double& Cost of the knot
+		 * @param const Eigen::VectorXd& Decision state of the knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		void evaluateKnotCost(double& cost,
+							  const Eigen::VectorXd& decision_state,
+							  const Eigen::VectorXd& last_decision_state,
+							  unsigned int knot);
+
+		/**
+		 * @brief Evaluates the terminal constraint, its Jacobian and bounds, which depend only
+		 * on the last knot
+		 * @param Eigen::VectorXd& Terminal constraint vector
+		 * @param Eigen::MatrixXd& Jacobian with respect to the last knot
+		 * @param Eigen::VectorXd& Lower bounds
+		 * @param Eigen::VectorXd& Upper bounds
+		 * @param const Eigen::VectorXd& Decision state of the last knot
+		 * @return False if there isn't terminal constraint
+		 */
+		bool evaluateTerminalConstraint(Eigen::VectorXd& constraint,
+										Eigen::MatrixXd& jacobian,
+										Eigen::VectorXd& lower_bound,
+										Eigen::VectorXd& upper_bound,
+										const Eigen::VectorXd& decision_state);
+
 		/** @brief Gets the dynamical system constraint */
 		DynamicalSystem* getDynamicalSystem();
 
@@ -142,6 +423,14 @@ class OptimalControl : public model::OptimizationModel
 		/** @brief Gets the horizon value of the optimization problem */
 		const unsigned int& getHorizon();
 
+		/**
+		 * @brief Gets the memory report of the buffers of the optimal control problem, i.e. the
+		 * solution and knot trajectories, the collocation and mesh data, the problem template,
+		 * the term statistics and the arenas of the evaluation temporaries (of every thread)
+		 * @return The memory report
+		 */
+		utils::MemoryUsage getMemoryUsage() const;
+
 
 	protected:
 		/** @brief Dynamical system constraint pointer */
@@ -170,6 +459,227 @@ class OptimalControl : public model::OptimizationModel
 
 		/** @brief Whole-body solution */
 		WholeBodyTrajectory motion_solution_;
+
+		/** @brief Indicates if the contact information of the solution is computed */
+		bool is_solution_completed_;
+
+		/** @brief Whole-body states of the knots, which are reused by the evaluations */
+		WholeBodyTrajectory knot_states_;
+
+		/** @brief Starting point from a previous solution, i.e. shifted or refined */
+		Eigen::VectorXd shifted_starting_point_;
+
+
+	private:
+		/**
+		 * @brief Fills the undefined (zero) contact positions, velocities and accelerations of
+		 * a solution state, where the three quantities are computed together
+		 * @param WholeBodyState& Whole-body state
+		 * @param model::WholeBodyKinematics& Kinematics of the evaluating thread
+		 */
+		void computeContactState(WholeBodyState& state,
+								 model::WholeBodyKinematics& kinematics);
+
+		/** @brief Logs the states of the solution at the debug level */
+		void logSolution() const;
+
+		/**
+		 * @brief Converts the decision variables to the whole-body states of the horizon
+		 * @param WholeBodyTrajectory& Whole-body states of the knots
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Decision variables
+		 */
+		void toKnotStates(WholeBodyTrajectory& knot_states,
+						  const Eigen::Ref<const Eigen::VectorXd>& decision_var);
+
+		/**
+		 * @brief Converts the decision state of a knot to a whole-body state
+		 * @param WholeBodyState& Whole-body state of the knot
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Decision state of the knot
+		 * @param double Time of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		void toKnotState(WholeBodyState& state,
+						 const Eigen::Ref<const Eigen::VectorXd>& decision_state,
+						 double last_time,
+						 unsigned int knot);
+
+		/**
+		 * @brief Converts the decision states of a knot and its previous one to whole-body
+		 * states, where the previous state of the first knot is the initial state. Note that
+		 * the time is relative to the previous knot
+		 * @param WholeBodyState& Whole-body state of the knot
+		 * @param WholeBodyState& Whole-body state of the previous knot
+		 * @param const Eigen::VectorXd& Decision state of the knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		void toKnotStatePair(WholeBodyState& state,
+							 WholeBodyState& last_state,
+							 const Eigen::VectorXd& decision_state,
+							 const Eigen::VectorXd& last_decision_state,
+							 unsigned int knot);
+
+		/**
+		 * @brief Gets the duration of a knot, i.e. the fixed step time, the duration of the
+		 * non-uniform mesh or the distance between collocation nodes
+		 * @param unsigned int Index of the knot
+		 */
+		double getKnotDuration(unsigned int knot);
+
+		/**
+		 * @brief Gets the support states of the collocation phase of a knot, i.e. the state
+		 * before the phase and its nodes
+		 * @param WholeBodyTrajectory& Support states of the phase
+		 * @param const WholeBodyTrajectory& Whole-body states of the knots
+		 * @param unsigned int Index of the knot
+		 */
+		void getCollocationSupport(WholeBodyTrajectory& support_states,
+								   const WholeBodyTrajectory& knot_states,
+								   unsigned int knot);
+
+		/**
+		 * @brief Evaluates the hard constraints of a knot that are not the time integration,
+		 * i.e. the dynamical constraint and the active and inactive constraints
+		 * @param Eigen::VectorXd& Knot constraint vector
+		 * @param const WholeBodyState& Whole-body state of the knot
+		 * @param WholeBodyState& Whole-body state of the previous knot
+		 * @param bool False for skipping the dynamical constraint, e.g. when its Jacobian
+		 * is computed analytically
+		 */
+		void evaluateKnotConstraints(Eigen::VectorXd& constraint,
+									 const WholeBodyState& state,
+									 WholeBodyState& last_state,
+									 bool dynamical_constraint = true);
+
+		/**
+		 * @brief Computes the Jacobian rows of a knot that are not the time integration, i.e.
+		 * analytically for the dynamical constraint (if it's defined) and by central
+		 * differences for the rest. The Jacobian matrices have the knot constraint dimension
+		 * @param Eigen::MatrixXd& Jacobian with respect to the decision state of the knot
+		 * @param Eigen::MatrixXd& Jacobian with respect to the decision state of the previous knot
+		 * @param const WholeBodyState& Whole-body state of the knot
+		 * @param const WholeBodyState& Whole-body state of the previous knot
+		 * @param const Eigen::VectorXd& Decision state of the knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot (unused in the
+		 * first knot)
+		 * @param double Time of the knot before the previous one
+		 * @param unsigned int Index of the knot
+		 */
+		void computeKnotJacobian(Eigen::MatrixXd& state_jac,
+								 Eigen::MatrixXd& last_state_jac,
+								 const WholeBodyState& state,
+								 const WholeBodyState& last_knot_state,
+								 const Eigen::VectorXd& decision_state,
+								 const Eigen::VectorXd& last_decision_state,
+								 double second_last_time,
+								 unsigned int knot);
+
+		/**
+		 * @brief Evaluates the costs and/or constraints of the horizon given the knot states
+		 * @param double* Value of the objective function, or NULL for skipping the costs
+		 * @param double* Array of constraint function values, or NULL for skipping them
+		 * @param int Number of constraint variables (dimension of $g(x)$)
+		 * @param const WholeBodyTrajectory& Whole-body states of the knots
+		 */
+		void evaluateHorizon(double* cost,
+							 double* constraint, int constraint_dim,
+							 const WholeBodyTrajectory& knot_states);
+
+		/**
+		 * @brief Evaluates the costs and soft constraints, and/or the hard constraints of a
+		 * contiguous chunk of knots
+		 * @param double* Cost of the chunk, or NULL for skipping the costs
+		 * @param double* Array of constraint function values of the horizon, or NULL for
+		 * skipping the hard constraints
+		 * @param const WholeBodyTrajectory& Whole-body states of the knots
+		 * @param unsigned int First knot of the chunk
+		 * @param unsigned int Last knot (not included) of the chunk
+		 * @param DynamicalSystem* Dynamical system used by this chunk
+		 * @param std::vector<Constraint<WholeBodyState>*>& Constraints used by this chunk
+		 * @param std::vector<Cost*>& Costs used by this chunk
+		 * @param unsigned int Index of the chunk, i.e. of its accounting counters
+		 */
+		void evaluateChunk(double* cost,
+						   double* constraint,
+						   const WholeBodyTrajectory& knot_states,
+						   unsigned int first_knot,
+						   unsigned int last_knot,
+						   DynamicalSystem* dynamical_system,
+						   std::vector<Constraint<WholeBodyState>*>& constraints,
+						   std::vector<Cost*>& costs,
+						   unsigned int chunk);
+
+		/** @brief Clones the dynamical system, constraints and costs for every extra thread */
+		void cloneThreadModels();
+
+		/** @brief Deletes the clones of the extra threads */
+		void deleteThreadModels();
+
+		/**
+		 * @brief Resets the arenas of the temporaries of the dynamical systems and constraints
+		 * (and their clones), which is done at the beginning of every evaluation
+		 */
+		void resetEvaluationArenas();
+
+		/** @brief Gets the number of chunks (threads) used for evaluating the horizon */
+		unsigned int getNumberOfChunks();
+
+		/**
+		 * @brief Sums the accounting of the chunks of a range of terms
+		 * @param std::map<std::string,TermStatistics>& Statistics per term name
+		 * @param unsigned int Index of the first term
+		 * @param const std::vector<std::string>& Names of the terms
+		 */
+		void sumTermStatistics(std::map<std::string,TermStatistics>& statistics,
+							   unsigned int first_term,
+							   const std::vector<std::string>& names) const;
+
+		/** @brief Indicates if the problem is transcribed with collocation phases */
+		bool collocation_;
+
+		/** @brief Duration and differentiation matrix of every collocation phase */
+		std::vector<double> phase_durations_;
+		std::vector<Eigen::MatrixXd> phase_diff_matrices_;
+
+		/** @brief Indicates if the knot durations define a non-uniform mesh */
+		bool knot_mesh_;
+
+		/** @brief Phase, first knot of the phase and duration of every knot */
+		std::vector<unsigned int> knot_phases_;
+		std::vector<unsigned int> phase_first_knots_;
+		std::vector<double> knot_durations_;
+
+		/** @brief Perturbation step of the Jacobian central differences */
+		double jacobian_epsilon_;
+
+		/** @brief Number of threads used for evaluating the horizon */
+		unsigned int num_threads_;
+
+		/** @brief Clones of the dynamical system, constraints and costs per extra thread */
+		std::vector<DynamicalSystem*> thread_dynamical_systems_;
+		std::vector<std::vector<Constraint<WholeBodyState>*> > thread_constraints_;
+		std::vector<std::vector<Cost*> > thread_costs_;
+
+		/** @brief Labels that indicate if the problem template is enabled and built */
+		bool problem_template_;
+		bool is_template_built_;
+
+		/** @brief Full-state bounds of the problem template */
+		Eigen::VectorXd template_state_lower_bound_;
+		Eigen::VectorXd template_state_upper_bound_;
+
+		/** @brief Instrumentation probes of every constraint and cost */
+		std::vector<unsigned int> constraint_probes_;
+		std::vector<unsigned int> cost_probes_;
+
+		/**
+		 * @brief Accounting counters per chunk, where the terms are the dynamical system, the
+		 * constraints and the costs (in this order). The names are taken in init()
+		 */
+		bool term_accounting_;
+		std::vector<std::vector<TermStatistics> > term_statistics_;
+		std::vector<std::string> constraint_names_;
+		std::vector<std::string> cost_names_;
 };
 
 } //@namespace ocp
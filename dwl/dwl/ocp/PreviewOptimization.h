@@ -61,6 +61,14 @@ class PreviewOptimization : public model::OptimizationModel
 		/** @brief Destructor function */
 		~PreviewOptimization();
 
+		/**
+		 * @brief Clones the preview optimization for evaluating the offsprings concurrently.
+		 * The clone has its own preview locomotion model (buffers, trajectories and whole-body
+		 * models), and it doesn't collect data
+		 * @return model::OptimizationModel* A new copy of the preview optimization
+		 */
+		model::OptimizationModel* clone() const;
+
 		/** @brief Initializes the optimization model, i.e. the dimensions
 		 * of the optimization vectors */
 		void init(bool only_soft_constraints);
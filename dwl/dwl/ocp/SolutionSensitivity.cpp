@@ -0,0 +1,297 @@
+#include <dwl/ocp/SolutionSensitivity.h>
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+SolutionSensitivity::SolutionSensitivity() : dynamical_system_(NULL),
+		active_tolerance_(1e-6), primal_regularization_(1e-6), dual_regularization_(1e-9),
+		fd_step_(1e-4), is_computed_(false)
+{
+
+}
+
+
+SolutionSensitivity::~SolutionSensitivity()
+{
+
+}
+
+
+bool SolutionSensitivity::compute(OptimalControl& model,
+								  const Eigen::Ref<const Eigen::VectorXd>& solution)
+{
+	is_computed_ = false;
+	unsigned int decision_dim = model.getDimensionOfState();
+	unsigned int constraint_dim = model.getDimensionOfConstraints();
+	unsigned int horizon = model.getHorizon();
+	if (decision_dim == 0 || solution.size() != decision_dim) {
+		printf(YELLOW "Warning: the solution dimension is not consistent, so it cannot be"
+				" computed its sensitivity\n" COLOR_RESET);
+		return false;
+	}
+	unsigned int state_dim = decision_dim / horizon;
+
+	// Getting the initial state, which is the parameter of the sensitivity
+	dynamical_system_ = model.getDynamicalSystem();
+	initial_state_ = dynamical_system_->getInitialState();
+	dynamical_system_->fromWholeBodyState(initial_decision_state_, initial_state_);
+	unsigned int param_dim = initial_decision_state_.size();
+
+	// Getting the active set of the solution, i.e. the decision variables on their bounds are
+	// fixed and the constraints on their bounds are equalities
+	Eigen::VectorXd constraint_lb(constraint_dim), constraint_ub(constraint_dim);
+	lower_bound_.resize(decision_dim);
+	upper_bound_.resize(decision_dim);
+	model.evaluateBounds(lower_bound_.data(), decision_dim,
+						 upper_bound_.data(), decision_dim,
+						 constraint_lb.data(), constraint_dim,
+						 constraint_ub.data(), constraint_dim);
+	std::vector<int> free_index(decision_dim, -1);
+	unsigned int num_free = 0;
+	for (unsigned int i = 0; i < decision_dim; i++) {
+		if (solution(i) - lower_bound_(i) > active_tolerance_ &&
+				upper_bound_(i) - solution(i) > active_tolerance_)
+			free_index[i] = num_free++;
+	}
+
+	Eigen::VectorXd constraint(constraint_dim);
+	model.evaluateConstraints(constraint.data(), constraint_dim,
+							  solution.data(), decision_dim);
+	std::vector<int> active_index(constraint_dim, -1);
+	unsigned int num_active = 0;
+	for (unsigned int i = 0; i < constraint_dim; i++) {
+		if (constraint(i) - constraint_lb(i) <= active_tolerance_ ||
+				constraint_ub(i) - constraint(i) <= active_tolerance_)
+			active_index[i] = num_free + num_active++;
+	}
+
+	// Adding the constraint Jacobian of the active set to the KKT system, i.e.
+	// [H + dp I, J'; J, -dd I]
+	std::vector<Eigen::Triplet<double> > triplets;
+	unsigned int nnz = model.getNumberOfNonzeroJacobian();
+	if (nnz != 0) {
+		std::vector<int> rows(nnz), cols(nnz);
+		Eigen::VectorXd values(nnz);
+		model.evaluateConstraintJacobian(values.data(), nnz,
+										 rows.data(), nnz,
+										 cols.data(), nnz,
+										 solution.data(), decision_dim, true);
+		model.evaluateConstraintJacobian(values.data(), nnz,
+										 rows.data(), nnz,
+										 cols.data(), nnz,
+										 solution.data(), decision_dim, false);
+		for (unsigned int i = 0; i < nnz; i++) {
+			int row = active_index[rows[i]];
+			int col = free_index[cols[i]];
+			if (row >= 0 && col >= 0 && values(i) != 0.) {
+				triplets.push_back(Eigen::Triplet<double>(row, col, values(i)));
+				triplets.push_back(Eigen::Triplet<double>(col, row, values(i)));
+			}
+		}
+	}
+	for (unsigned int i = 0; i < num_free; i++)
+		triplets.push_back(Eigen::Triplet<double>(i, i, primal_regularization_));
+	for (unsigned int i = 0; i < num_active; i++)
+		triplets.push_back(Eigen::Triplet<double>(num_free + i, num_free + i,
+												  -dual_regularization_));
+
+	// Adding the Hessian of the knot costs. A knot cost depends on the knot and the previous
+	// one, so the Hessian is block-banded. The previous decision state of the first knot is
+	// the initial one, which gives the cross derivatives with the parameters
+	unsigned int kkt_dim = num_free + num_active;
+	Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(kkt_dim, param_dim);
+	double h = fd_step_;
+	for (unsigned int k = 0; k < horizon; k++) {
+		unsigned int last_dim = (k == 0) ? param_dim : state_dim;
+		Eigen::VectorXd knot_pair(last_dim + state_dim);
+		if (k == 0)
+			knot_pair << initial_decision_state_, solution.head(state_dim);
+		else
+			knot_pair = solution.segment((k - 1) * state_dim, 2 * state_dim);
+
+		// Computing the Hessian by central differences
+		unsigned int pair_dim = knot_pair.size();
+		double cost = computeKnotCost(model, knot_pair, k);
+		Eigen::MatrixXd hessian(pair_dim, pair_dim);
+		for (unsigned int i = 0; i < pair_dim; i++) {
+			Eigen::VectorXd pair_i = knot_pair;
+			pair_i(i) += h;
+			double cost_fwd = computeKnotCost(model, pair_i, k);
+			pair_i(i) -= 2 * h;
+			double cost_bwd = computeKnotCost(model, pair_i, k);
+			hessian(i,i) = (cost_fwd - 2 * cost + cost_bwd) / (h * h);
+			for (unsigned int j = 0; j < i; j++) {
+				Eigen::VectorXd pair_ij = knot_pair;
+				pair_ij(i) += h; pair_ij(j) += h;
+				double cost_pp = computeKnotCost(model, pair_ij, k);
+				pair_ij(j) -= 2 * h;
+				double cost_pm = computeKnotCost(model, pair_ij, k);
+				pair_ij(i) -= 2 * h;
+				double cost_mm = computeKnotCost(model, pair_ij, k);
+				pair_ij(j) += 2 * h;
+				double cost_mp = computeKnotCost(model, pair_ij, k);
+				hessian(i,j) = hessian(j,i) =
+						(cost_pp - cost_pm - cost_mp + cost_mm) / (4 * h * h);
+			}
+		}
+
+		// Scattering the Hessian into the KKT system, where the cross derivatives with the
+		// parameters are moved to the right-hand side
+		int first_index = (k == 0) ? -((int) param_dim) : (int) ((k - 1) * state_dim);
+		for (unsigned int i = 0; i < pair_dim; i++) {
+			int var_i = first_index + (int) i;
+			if (var_i < 0 || free_index[var_i] < 0)
+				continue;
+			for (unsigned int j = 0; j < pair_dim; j++) {
+				int var_j = first_index + (int) j;
+				if (hessian(i,j) == 0.)
+					continue;
+				if (var_j < 0)
+					rhs(free_index[var_i], j) -= hessian(i,j);
+				else if (free_index[var_j] >= 0)
+					triplets.push_back(Eigen::Triplet<double>(free_index[var_i],
+															  free_index[var_j],
+															  hessian(i,j)));
+			}
+		}
+	}
+
+	// Computing the constraint Jacobian with respect to the parameters by central
+	// differences of the initial state
+	Eigen::VectorXd constraint_fwd(constraint_dim), constraint_bwd(constraint_dim);
+	for (unsigned int j = 0; j < param_dim; j++) {
+		Eigen::VectorXd param = initial_decision_state_;
+		param(j) += h;
+		setInitialDecisionState(dynamical_system_, param);
+		model.evaluateConstraints(constraint_fwd.data(), constraint_dim,
+								  solution.data(), decision_dim);
+		param(j) -= 2 * h;
+		setInitialDecisionState(dynamical_system_, param);
+		model.evaluateConstraints(constraint_bwd.data(), constraint_dim,
+								  solution.data(), decision_dim);
+		for (unsigned int i = 0; i < constraint_dim; i++) {
+			if (active_index[i] >= 0)
+				rhs(active_index[i], j) -= (constraint_fwd(i) - constraint_bwd(i)) / (2 * h);
+		}
+	}
+	dynamical_system_->setInitialState(initial_state_);
+
+	// Factorizing the KKT system once, and solving the derivatives of every parameter
+	Eigen::SparseMatrix<double> kkt(kkt_dim, kkt_dim);
+	kkt.setFromTriplets(triplets.begin(), triplets.end());
+	Eigen::SparseLU<Eigen::SparseMatrix<double> > linear_solver;
+	linear_solver.compute(kkt);
+	if (linear_solver.info() != Eigen::Success) {
+		printf(YELLOW "Warning: the KKT system of the sensitivity couldn't be factorized\n"
+				COLOR_RESET);
+		return false;
+	}
+	Eigen::MatrixXd kkt_sensitivity = linear_solver.solve(rhs);
+
+	// The fixed decision variables don't change with the parameters
+	sensitivity_.setZero(decision_dim, param_dim);
+	for (unsigned int i = 0; i < decision_dim; i++) {
+		if (free_index[i] >= 0)
+			sensitivity_.row(i) = kkt_sensitivity.row(free_index[i]);
+	}
+	solution_ = solution;
+	is_computed_ = true;
+
+	return true;
+}
+
+
+bool SolutionSensitivity::predict(Eigen::VectorXd& solution,
+								  const WholeBodyState& initial_state)
+{
+	if (!is_computed_)
+		return false;
+
+	Eigen::VectorXd initial_decision_state;
+	dynamical_system_->fromWholeBodyState(initial_decision_state, initial_state);
+	if (initial_decision_state.size() != initial_decision_state_.size())
+		return false;
+
+	// First-order update of the solution, which is saturated by its bounds
+	solution = solution_ + sensitivity_ * (initial_decision_state - initial_decision_state_);
+	solution = solution.cwiseMax(lower_bound_).cwiseMin(upper_bound_);
+
+	return true;
+}
+
+
+void SolutionSensitivity::reset()
+{
+	is_computed_ = false;
+}
+
+
+void SolutionSensitivity::setActiveTolerance(double tolerance)
+{
+	active_tolerance_ = tolerance;
+}
+
+
+void SolutionSensitivity::setRegularization(double primal,
+											double dual)
+{
+	primal_regularization_ = primal;
+	dual_regularization_ = dual;
+}
+
+
+void SolutionSensitivity::setFiniteDifferenceStep(double step)
+{
+	fd_step_ = step;
+}
+
+
+bool SolutionSensitivity::isComputed() const
+{
+	return is_computed_;
+}
+
+
+const Eigen::MatrixXd& SolutionSensitivity::getSensitivity() const
+{
+	return sensitivity_;
+}
+
+
+double SolutionSensitivity::computeKnotCost(OptimalControl& model,
+											const Eigen::VectorXd& knot_pair,
+											unsigned int knot)
+{
+	unsigned int state_dim = model.getDimensionOfState() / model.getHorizon();
+	unsigned int last_dim = knot_pair.size() - state_dim;
+	Eigen::VectorXd state = knot_pair.tail(state_dim);
+	Eigen::VectorXd last_state = knot_pair.head(last_dim);
+
+	// The first knot reads its previous state from the initial state
+	if (knot == 0)
+		setInitialDecisionState(model.getDynamicalSystem(), last_state);
+
+	double cost;
+	model.evaluateKnotCost(cost, state, last_state, knot);
+
+	return cost;
+}
+
+
+void SolutionSensitivity::setInitialDecisionState(DynamicalSystem* system,
+												  const Eigen::VectorXd& decision_state)
+{
+	// The information that isn't in the decision state (e.g. time) is kept
+	WholeBodyState initial_state = initial_state_;
+	system->toWholeBodyState(initial_state, decision_state);
+	system->setInitialState(initial_state);
+}
+
+} //@namespace ocp
+} //@namespace dwl
@@ -0,0 +1,138 @@
+#ifndef DWL__OCP__SOLUTION_SENSITIVITY__H
+#define DWL__OCP__SOLUTION_SENSITIVITY__H
+
+#include <dwl/ocp/OptimalControl.h>
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+/**
+ * @class SolutionSensitivity
+ * @brief Parametric sensitivity of a solution of the optimal control problem with respect to
+ * the initial state, i.e. the tangent predictor of the solution for a perturbed initial state.
+ * It's computed after the solve from the KKT system of the active set of the solution, where
+ * the active set is the hard constraints and bounds within a tolerance of their bounds. The
+ * Lagrangian Hessian is approximated by the Hessian of the knot costs and soft constraints
+ * (i.e. without the curvature of the hard constraints), which is computed by finite
+ * differences. Thus, the computation is much more expensive than a prediction, which is a
+ * matrix-vector product. The prediction is valid while the active set doesn't change
+ */
+class SolutionSensitivity
+{
+	public:
+		/** @brief Constructor function */
+		SolutionSensitivity();
+
+		/** @brief Destructor function */
+		~SolutionSensitivity();
+
+		/**
+		 * @brief Computes the sensitivity of a solution with respect to the initial state of
+		 * the dynamical system. Note that the model has to be initialized
+		 * @param OptimalControl& Optimal control problem of the solution
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Solution vector
+		 * @return False if the KKT system couldn't be factorized
+		 */
+		bool compute(OptimalControl& model,
+					 const Eigen::Ref<const Eigen::VectorXd>& solution);
+
+		/**
+		 * @brief Predicts the solution for a perturbed initial state, i.e. the first-order
+		 * update of the solution that is saturated by its bounds
+		 * @param Eigen::VectorXd& Predicted solution vector
+		 * @param const WholeBodyState& Perturbed initial state
+		 * @return False if the sensitivity wasn't computed
+		 */
+		bool predict(Eigen::VectorXd& solution,
+					 const WholeBodyState& initial_state);
+
+		/** @brief Invalidates the computed sensitivity */
+		void reset();
+
+		/**
+		 * @brief Sets the tolerance of the active set, i.e. the distance to the bounds of the
+		 * active constraints and decision variables. The default value is 1e-6
+		 * @param double Tolerance
+		 */
+		void setActiveTolerance(double tolerance);
+
+		/**
+		 * @brief Sets the regularization of the KKT system, i.e. the primal one of the Hessian
+		 * and the dual one of the active constraints. The default values are 1e-6 and 1e-9
+		 * @param double Primal regularization
+		 * @param double Dual regularization
+		 */
+		void setRegularization(double primal,
+							   double dual);
+
+		/**
+		 * @brief Sets the step of the finite differences. The default value is 1e-4
+		 * @param double Finite-difference step
+		 */
+		void setFiniteDifferenceStep(double step);
+
+		/** @brief Indicates if the sensitivity was computed */
+		bool isComputed() const;
+
+		/** @brief Gets the sensitivity matrix, i.e. the derivative of the solution with respect
+		 * to the decision state of the initial state */
+		const Eigen::MatrixXd& getSensitivity() const;
+
+
+	private:
+		/**
+		 * @brief Computes the cost of a knot, where the previous decision state of the first
+		 * knot is the one of the initial state
+		 * @param OptimalControl& Optimal control problem
+		 * @param const Eigen::VectorXd& Decision states of the previous knot and the knot
+		 * @param unsigned int Index of the knot
+		 */
+		double computeKnotCost(OptimalControl& model,
+							   const Eigen::VectorXd& knot_pair,
+							   unsigned int knot);
+
+		/**
+		 * @brief Sets the initial state of the dynamical system from its decision state
+		 * @param DynamicalSystem* Dynamical system
+		 * @param const Eigen::VectorXd& Decision state of the initial state
+		 */
+		void setInitialDecisionState(DynamicalSystem* system,
+									 const Eigen::VectorXd& decision_state);
+
+		/** @brief Dynamical system of the solution */
+		DynamicalSystem* dynamical_system_;
+
+		/** @brief Initial state of the solution, and its decision state */
+		WholeBodyState initial_state_;
+		Eigen::VectorXd initial_decision_state_;
+
+		/** @brief Solution and its bounds */
+		Eigen::VectorXd solution_;
+		Eigen::VectorXd lower_bound_;
+		Eigen::VectorXd upper_bound_;
+
+		/** @brief Derivative of the solution with respect to the initial decision state */
+		Eigen::MatrixXd sensitivity_;
+
+		/** @brief Tolerance of the active set */
+		double active_tolerance_;
+
+		/** @brief Primal and dual regularization of the KKT system */
+		double primal_regularization_;
+		double dual_regularization_;
+
+		/** @brief Step of the finite differences */
+		double fd_step_;
+
+		/** @brief Label that indicates if the sensitivity was computed */
+		bool is_computed_;
+};
+
+} //@namespace ocp
+} //@namespace dwl
+
+#endif
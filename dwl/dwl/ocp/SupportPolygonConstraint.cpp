@@ -7,7 +7,8 @@ namespace dwl
 namespace ocp
 {
 
-SupportPolygonConstraint::SupportPolygonConstraint() : num_lines_(10)
+SupportPolygonConstraint::SupportPolygonConstraint() : num_lines_(10),
+		ordered_vertexes_(false)
 {
 
 }
@@ -22,19 +23,16 @@ SupportPolygonConstraint::~SupportPolygonConstraint()
 void SupportPolygonConstraint::compute(Eigen::VectorXd& constraint,
 									   const PolygonState& state)
 {
-	// Ordering the polygon vertexes in order to implement the constraints
-	std::vector<Eigen::Vector3d> polygon = state.vertexes;
-	math::counterClockwiseSort(polygon);
-
-	// Getting the number of lines
-	unsigned int num_vertex = polygon.size();
-	if (num_vertex == 1)
-		num_lines_ = 0;
-	else if (num_vertex == 2)
-		num_lines_ = 1;
-	else
-		num_lines_ = num_vertex;
+	// Evaluating the ordered triangles and quadrilaterals in one fixed-size pass
+	if (useKernel(state)) {
+		computeKernel(state);
+		constraint = kernel_margins_.head(num_lines_);
+		return;
+	}
 
+	// Ordering the polygon vertexes in order to implement the constraints
+	std::vector<Eigen::Vector3d> polygon;
+	getPolygon(polygon, state);
 
 	Eigen::Vector3d extended_point(state.point(rbd::X), state.point(rbd::Y), 1.);
 	if (num_lines_ > 2) { // this is a polygon, so it's imposed an inequality
@@ -91,5 +89,136 @@ void SupportPolygonConstraint::getBounds(Eigen::VectorXd& lower_bound,
 	}
 }
 
+void SupportPolygonConstraint::computeGradient(Eigen::MatrixXd& gradient,
+											   const PolygonState& state)
+{
+	if (useKernel(state)) {
+		computeKernel(state);
+		gradient = kernel_point_gradient_.topRows(num_lines_);
+		return;
+	}
+
+	std::vector<Eigen::Vector3d> polygon;
+	getPolygon(polygon, state);
+	if (num_lines_ > 2) { // the normals of the polygon lines
+		gradient.resize(num_lines_, 2);
+		for (unsigned int j = 0; j < num_lines_; j++) {
+			math::LineCoeff2d line_coeff =
+					math::lineCoeff(polygon[j], polygon[(j + 1) % num_lines_]);
+			gradient(j,0) = line_coeff.p;
+			gradient(j,1) = line_coeff.q;
+		}
+	} else if (num_lines_ == 1) { // the normal of the support line
+		math::LineCoeff2d line_coeff = math::lineCoeff(polygon[0], polygon[1]);
+		gradient = Eigen::MatrixXd::Zero(2, 2);
+		gradient(0,0) = line_coeff.p;
+		gradient(0,1) = line_coeff.q;
+	} else { // the support point
+		gradient = Eigen::MatrixXd::Zero(2, 2);
+		gradient(0,0) = 1.;
+		gradient(0,1) = -1.;
+	}
+}
+
+
+void SupportPolygonConstraint::setOrderedVertexes(bool ordered)
+{
+	ordered_vertexes_ = ordered;
+}
+
+
+void SupportPolygonConstraint::computeMargins(Eigen::Vector4d& margins,
+											  Eigen::Matrix<double,4,2>& point_gradient,
+											  Eigen::Matrix<double,4,8>& vertex_gradient,
+											  const Eigen::Vector2d& point,
+											  const KernelVertexes& vertexes,
+											  unsigned int num_vertexes,
+											  double margin)
+{
+	assert(num_vertexes == 3 || num_vertexes == 4);
+
+	// Getting the first and last vertexes of the lines. The unused line is a unit segment
+	// from the first vertex, so the fixed-size pass doesn't divide by zero
+	KernelVertexes first = vertexes, last;
+	for (unsigned int j = 0; j < 4; j++) {
+		if (j < num_vertexes)
+			last.col(j) = vertexes.col((j + 1) % num_vertexes);
+		else {
+			first.col(j) = vertexes.col(0);
+			last.col(j) = vertexes.col(0) + Eigen::Vector2d::UnitX();
+		}
+	}
+	Eigen::Array<double,1,4> mask = Eigen::Array<double,1,4>::Ones();
+	if (num_vertexes == 3)
+		mask(3) = 0.;
+
+	// Computing the margins of all the lines, i.e. m = (e x d) / |e| - margin, where e is
+	// the edge of the line and d is the point w.r.t. its first vertex
+	Eigen::Array<double,2,4> edge = (last - first).array();
+	Eigen::Array<double,2,4> diff = ((-first).colwise() + point).array();
+	Eigen::Array<double,1,4> inv_norm = edge.matrix().colwise().norm().array().inverse();
+	Eigen::Array<double,1,4> distance =
+			(edge.row(0) * diff.row(1) - edge.row(1) * diff.row(0)) * inv_norm;
+	margins = ((distance - margin) * mask).transpose();
+
+	// Computing the gradients, i.e. the normals of the lines w.r.t. the point, and
+	// (d_y, -d_x) / |e| - m e / |e|^2 w.r.t. the edges
+	Eigen::Array<double,1,4> normal_x = -edge.row(1) * inv_norm * mask;
+	Eigen::Array<double,1,4> normal_y = edge.row(0) * inv_norm * mask;
+	Eigen::Array<double,1,4> edge_grad_x =
+			(diff.row(1) - distance * edge.row(0) * inv_norm) * inv_norm * mask;
+	Eigen::Array<double,1,4> edge_grad_y =
+			(-diff.row(0) - distance * edge.row(1) * inv_norm) * inv_norm * mask;
+	point_gradient.col(0) = normal_x.transpose();
+	point_gradient.col(1) = normal_y.transpose();
+
+	// Mapping the gradients of the edges to the ones of their vertexes
+	vertex_gradient.setZero();
+	for (unsigned int j = 0; j < num_vertexes; j++) {
+		unsigned int k = (j + 1) % num_vertexes;
+		vertex_gradient(j, 2 * j) = -normal_x(j) - edge_grad_x(j);
+		vertex_gradient(j, 2 * j + 1) = -normal_y(j) - edge_grad_y(j);
+		vertex_gradient(j, 2 * k) = edge_grad_x(j);
+		vertex_gradient(j, 2 * k + 1) = edge_grad_y(j);
+	}
+}
+
+
+void SupportPolygonConstraint::getPolygon(std::vector<Eigen::Vector3d>& polygon,
+										  const PolygonState& state)
+{
+	polygon = state.vertexes;
+	if (!ordered_vertexes_)
+		math::counterClockwiseSort(polygon);
+
+	// Getting the number of lines
+	unsigned int num_vertex = polygon.size();
+	if (num_vertex == 1)
+		num_lines_ = 0;
+	else if (num_vertex == 2)
+		num_lines_ = 1;
+	else
+		num_lines_ = num_vertex;
+}
+
+
+bool SupportPolygonConstraint::useKernel(const PolygonState& state) const
+{
+	return ordered_vertexes_ &&
+			(state.vertexes.size() == 3 || state.vertexes.size() == 4);
+}
+
+
+void SupportPolygonConstraint::computeKernel(const PolygonState& state)
+{
+	num_lines_ = state.vertexes.size();
+	KernelVertexes vertexes = KernelVertexes::Zero();
+	for (unsigned int j = 0; j < num_lines_; j++)
+		vertexes.col(j) = state.vertexes[j].head<2>();
+
+	computeMargins(kernel_margins_, kernel_point_gradient_, kernel_vertex_gradient_,
+				   state.point.head<2>(), vertexes, num_lines_, state.margin);
+}
+
 } //@namespace ocp
 } //@namespace dwl
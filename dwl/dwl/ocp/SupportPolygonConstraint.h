@@ -33,6 +33,9 @@ struct PolygonState
 class SupportPolygonConstraint : public Constraint<PolygonState>
 {
 	public:
+		/** @brief Vertexes of the polygon of the fixed-size kernel, i.e. the feet of a quadruped */
+		typedef Eigen::Matrix<double,2,4> KernelVertexes;
+
 		/** @brief Constructor function */
 		SupportPolygonConstraint();
 
@@ -55,10 +58,78 @@ class SupportPolygonConstraint : public Constraint<PolygonState>
 		void getBounds(Eigen::VectorXd& lower_bound,
 					   Eigen::VectorXd& upper_bound);
 
+		/**
+		 * @brief Computes the gradient of the constraint w.r.t. the (x,y) components of the
+		 * point, i.e. the normals of the polygon lines
+		 * @param Eigen::MatrixXd& Gradient of the constraint [num_lines x 2]
+		 * @param const PolygonState& Polygon state
+		 */
+		void computeGradient(Eigen::MatrixXd& gradient,
+							 const PolygonState& state);
+
+		/**
+		 * @brief Indicates that the vertexes of the states are already ordered counter-clockwise,
+		 * e.g. the contact order is known from the gait. So the polygons of three or four
+		 * vertexes are evaluated with the fixed-size kernel and without sorting
+		 * @param bool True if the vertexes are ordered
+		 */
+		void setOrderedVertexes(bool ordered);
+
+		/**
+		 * @brief Computes the margins of a point to the lines of a polygon of three or four
+		 * vertexes in one fixed-size pass, where the vertexes are ordered counter-clockwise.
+		 * The margin of the line j (between the vertexes j and j+1) is positive when the point
+		 * is inside, and the margins of the unused lines are zero
+		 * @param Eigen::Vector4d& Margins of the lines
+		 * @param Eigen::Matrix<double,4,2>& Gradient of the margins w.r.t. the point
+		 * @param Eigen::Matrix<double,4,8>& Gradient of the margins w.r.t. the vertexes,
+		 * i.e. [x0 y0 x1 y1 ...]
+		 * @param const Eigen::Vector2d& Point
+		 * @param const KernelVertexes& Vertexes, where the unused ones are ignored
+		 * @param unsigned int Number of vertexes (3 or 4)
+		 * @param double Polygon margin
+		 */
+		static void computeMargins(Eigen::Vector4d& margins,
+								   Eigen::Matrix<double,4,2>& point_gradient,
+								   Eigen::Matrix<double,4,8>& vertex_gradient,
+								   const Eigen::Vector2d& point,
+								   const KernelVertexes& vertexes,
+								   unsigned int num_vertexes,
+								   double margin);
+
 
 	private:
+		/**
+		 * @brief Gets the sorted polygon of a state (if the vertexes aren't ordered) and sets
+		 * the number of lines
+		 * @param std::vector<Eigen::Vector3d>& Polygon
+		 * @param const PolygonState& Polygon state
+		 */
+		void getPolygon(std::vector<Eigen::Vector3d>& polygon,
+						const PolygonState& state);
+
+		/**
+		 * @brief Indicates if the polygon is evaluated with the fixed-size kernel
+		 * @param const PolygonState& Polygon state
+		 */
+		bool useKernel(const PolygonState& state) const;
+
+		/**
+		 * @brief Evaluates the fixed-size kernel for a state
+		 * @param const PolygonState& Polygon state
+		 */
+		void computeKernel(const PolygonState& state);
+
 		/** @brief Number of polygon lines */
 		unsigned int num_lines_;
+
+		/** @brief Label that indicates if the vertexes are ordered counter-clockwise */
+		bool ordered_vertexes_;
+
+		/** @brief Margins and gradients of the last evaluation of the kernel */
+		Eigen::Vector4d kernel_margins_;
+		Eigen::Matrix<double,4,2> kernel_point_gradient_;
+		Eigen::Matrix<double,4,8> kernel_vertex_gradient_;
 };
 } //@namespace ocp
 } //@namespace dwl
@@ -19,6 +19,12 @@ TerminalStateTrackingEnergyCost::~TerminalStateTrackingEnergyCost()
 }
 
 
+TerminalStateTrackingEnergyCost* TerminalStateTrackingEnergyCost::clone() const
+{
+	return new TerminalStateTrackingEnergyCost(*this);
+}
+
+
 void TerminalStateTrackingEnergyCost::compute(double& cost,
 											  const WholeBodyState& state)
 {
@@ -23,6 +23,9 @@ class TerminalStateTrackingEnergyCost : public Cost
 		/** @brief Destructor function */
 		~TerminalStateTrackingEnergyCost();
 
+		/** @brief Clones the cost, e.g. for evaluating it in another thread */
+		TerminalStateTrackingEnergyCost* clone() const;
+
 		/**
 		 * @brief Computes the state-tracking energy cost given a locomotion state. The
 		 * state-tracking energy is defined as quadratic cost function
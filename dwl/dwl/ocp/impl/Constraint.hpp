@@ -10,7 +10,7 @@ namespace ocp
 
 template <typename TState>
 Constraint<TState>::Constraint() : constraint_dimension_(0), is_soft_(false),
-	soft_properties_(SoftConstraintProperties(10000., 0., 0.))
+	soft_properties_(SoftConstraintProperties(10000., 0., 0.)), is_soft_bound_(false)
 {
 	state_buffer_.set_capacity(4);
 }
@@ -71,60 +71,57 @@ void Constraint<TState>::init(bool info)
 
 
 template <typename TState>
-void Constraint<TState>::computeSoft(double& constraint_cost,
-									 const TState& state)
+Constraint<TState>* Constraint<TState>::clone() const
 {
-	// Initialization of the cost value
-	constraint_cost = 0.;
+	return NULL;
+}
 
-	// Getting the constraint value and bounds
-	Eigen::VectorXd constraint, lower_bound, upper_bound;
-	compute(constraint, state);
 
-	getBounds(lower_bound, upper_bound);
+template <typename TState>
+void Constraint<TState>::computeSoft(double& constraint_cost,
+									 const TState& state)
+{
+	// Getting the constraint value in the preallocated buffer
+	compute(soft_constraint_, state);
+
+	// The bounds are cached with the threshold, and they are updated if the dimension of the
+	// constraint changes (e.g. the number of active contacts)
+	unsigned int vec_dim = soft_constraint_.size();
+	if (!is_soft_bound_ || soft_lower_bound_.size() != vec_dim) {
+		Eigen::VectorXd lower_bound, upper_bound;
+		getBounds(lower_bound, upper_bound);
+		soft_lower_bound_ = lower_bound.array();
+		soft_upper_bound_ = upper_bound.array();
+		soft_lower_threshold_ = soft_lower_bound_ + soft_properties_.threshold;
+		soft_upper_threshold_ = soft_upper_bound_ - soft_properties_.threshold;
+		is_soft_bound_ = true;
+	}
 
 	// Computing the violation vector
-	double offset_cost = 0.;
-	unsigned int vec_dim = constraint.size();
-	Eigen::VectorXd violation_vec = Eigen::VectorXd::Zero(vec_dim);
-	for (unsigned int i = 0; i < vec_dim; i++) {
-		double lower_val = lower_bound(i) + soft_properties_.threshold;
-		double upper_val = upper_bound(i) - soft_properties_.threshold;
-		double const_val = constraint(i);
-		if (lower_val > const_val) {
-			switch (soft_properties_.family) {
-			case UNWEIGHTED:
-				violation_vec(i) += 1.;
-				break;
-			case QUADRATIC:
-				violation_vec(i) += lower_val - const_val;
-				break;
-			default:
-				violation_vec(i) += lower_val - const_val;
-				break;
-			}
-		}
-
-		if (upper_val < const_val) {
-			switch (soft_properties_.family) {
-			case UNWEIGHTED:
-				violation_vec(i) += 1.;
-				break;
-			case QUADRATIC:
-				violation_vec(i) += const_val - upper_val;
-				break;
-			default:
-				violation_vec(i) += const_val - upper_val;
-				break;
-			}
-		}
-
-		if (upper_bound(i) < const_val || lower_bound(i) > const_val)
-			offset_cost = soft_properties_.offset;
+	const Eigen::ArrayXd& const_val = soft_constraint_.array();
+	switch (soft_properties_.family) {
+	case UNWEIGHTED:
+		soft_violation_ = (soft_lower_threshold_ > const_val).template cast<double>() +
+				(soft_upper_threshold_ < const_val).template cast<double>();
+		break;
+	default:
+		soft_violation_ = (soft_lower_threshold_ - const_val).max(0.) +
+				(const_val - soft_upper_threshold_).max(0.);
+		break;
 	}
+	bool is_violated = (soft_upper_bound_ < const_val).any() ||
+			(soft_lower_bound_ > const_val).any();
+	double offset_cost = is_violated ? soft_properties_.offset : 0.;
 
 	// Computing a weighted quadratic cost of the constraint violation
-	constraint_cost = soft_properties_.weight * violation_vec.norm() + offset_cost;
+	constraint_cost = soft_properties_.weight * soft_violation_.matrix().norm() + offset_cost;
+}
+
+
+template <typename TState>
+void Constraint<TState>::invalidateBounds()
+{
+	is_soft_bound_ = false;
 }
 
 
@@ -139,11 +136,12 @@ template <typename TState>
 void Constraint<TState>::setSoftProperties(const SoftConstraintProperties& properties)
 {
 	soft_properties_ = properties;
+	invalidateBounds();
 }
 
 
 template <typename TState>
-void Constraint<TState>::setLastState(TState& last_state)
+void Constraint<TState>::setLastState(const TState& last_state)
 {
 	state_buffer_.push_front(last_state);
 }
@@ -152,18 +150,24 @@ void Constraint<TState>::setLastState(TState& last_state)
 template <typename TState>
 void Constraint<TState>::resetStateBuffer()
 {
-	unsigned int buffer_size = state_buffer_.size();
-	WholeBodyState empty_state(state_buffer_[0].joint_pos.size());
-	for (unsigned int i = 0; i < buffer_size; i++)
-		state_buffer_.push_back();
+	state_buffer_.clear();
+}
+
+
+template <typename TState>
+EvaluationArena& Constraint<TState>::getEvaluationArena()
+{
+	return arena_;
 }
 
 
 template <typename TState>
 unsigned int Constraint<TState>::getConstraintDimension()
 {
-	// Getting the constraint dimension given a defined constraint function.
-	Eigen::VectorXd bound;
+	// Getting the constraint dimension given a defined constraint function. Note that it's
+	// called in every knot evaluation, so the bounds are temporaries of the arena
+	EvaluationArena::Scope scope(arena_);
+	Eigen::VectorXd& bound = scope.getVector();
 	getBounds(bound, bound);
 	constraint_dimension_ = bound.size();
 
@@ -0,0 +1,133 @@
+#ifndef DWL__OCP__CONSTRAINT_STACK__IMPL_H
+#define DWL__OCP__CONSTRAINT_STACK__IMPL_H
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+template <typename... TConstraints>
+ConstraintStack<TConstraints...>::ConstraintStack()
+{
+	name_ = "constraint stack";
+	init();
+}
+
+
+template <typename... TConstraints>
+ConstraintStack<TConstraints...>::ConstraintStack(const TConstraints&... constraints) :
+		constraints_(constraints...)
+{
+	name_ = "constraint stack";
+	init();
+}
+
+
+template <typename... TConstraints>
+ConstraintStack<TConstraints...>::~ConstraintStack()
+{
+
+}
+
+
+template <typename... TConstraints>
+void ConstraintStack<TConstraints...>::init(bool info)
+{
+	constraint_dimension_ = getTermsDimension(std::integral_constant<std::size_t, 0>());
+	invalidateBounds();
+}
+
+
+template <typename... TConstraints>
+ConstraintStack<TConstraints...>* ConstraintStack<TConstraints...>::clone() const
+{
+	return new ConstraintStack<TConstraints...>(*this);
+}
+
+
+template <typename... TConstraints>
+void ConstraintStack<TConstraints...>::compute(Eigen::VectorXd& constraint,
+											   const WholeBodyState& state)
+{
+	if (constraint.size() != constraint_dimension_)
+		constraint.resize(constraint_dimension_);
+	computeTerms(constraint, state, 0, std::integral_constant<std::size_t, 0>());
+}
+
+
+template <typename... TConstraints>
+void ConstraintStack<TConstraints...>::getBounds(Eigen::VectorXd& lower_bound,
+												 Eigen::VectorXd& upper_bound)
+{
+	lower_bound.resize(constraint_dimension_);
+	upper_bound.resize(constraint_dimension_);
+	getTermsBounds(lower_bound, upper_bound, 0, std::integral_constant<std::size_t, 0>());
+}
+
+
+template <typename... TConstraints>
+template <std::size_t I>
+typename std::tuple_element<I, std::tuple<TConstraints...> >::type&
+ConstraintStack<TConstraints...>::get()
+{
+	return std::get<I>(constraints_);
+}
+
+
+template <typename... TConstraints>
+template <std::size_t I>
+unsigned int ConstraintStack<TConstraints...>::getTermsDimension(std::integral_constant<std::size_t, I>)
+{
+	return std::get<I>(constraints_).getConstraintDimension() +
+			getTermsDimension(std::integral_constant<std::size_t, I + 1>());
+}
+
+
+template <typename... TConstraints>
+template <std::size_t I>
+void ConstraintStack<TConstraints...>::computeTerms(Eigen::VectorXd& constraint,
+													const WholeBodyState& state,
+													unsigned int index,
+													std::integral_constant<std::size_t, I>)
+{
+	// The qualified call of the final type avoids the virtual dispatch. Note that the
+	// composed constraint keeps a view of the last state of the stack
+	typedef typename std::tuple_element<I, std::tuple<TConstraints...> >::type TConstraint;
+	TConstraint& term = std::get<I>(constraints_);
+	unsigned int dim = term.getConstraintDimension();
+	term.setLastState(state_buffer_[0]);
+	term.TConstraint::compute(term_constraint_, state);
+	if ((unsigned int) term_constraint_.size() != dim) {
+		printf(RED "FATAL: the constraint dimension of %s constraint is not consistent\n"
+				COLOR_RESET, term.getName().c_str());
+		exit(EXIT_FAILURE);
+	}
+	constraint.segment(index, dim) = term_constraint_;
+
+	computeTerms(constraint, state, index + dim, std::integral_constant<std::size_t, I + 1>());
+}
+
+
+template <typename... TConstraints>
+template <std::size_t I>
+void ConstraintStack<TConstraints...>::getTermsBounds(Eigen::VectorXd& lower_bound,
+													  Eigen::VectorXd& upper_bound,
+													  unsigned int index,
+													  std::integral_constant<std::size_t, I>)
+{
+	Eigen::VectorXd term_lower_bound, term_upper_bound;
+	std::get<I>(constraints_).getBounds(term_lower_bound, term_upper_bound);
+	unsigned int dim = term_lower_bound.size();
+	lower_bound.segment(index, dim) = term_lower_bound;
+	upper_bound.segment(index, dim) = term_upper_bound;
+
+	getTermsBounds(lower_bound, upper_bound, index + dim,
+				   std::integral_constant<std::size_t, I + 1>());
+}
+
+} //@namespace ocp
+} //@namespace dwl
+
+#endif
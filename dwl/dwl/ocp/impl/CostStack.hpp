@@ -0,0 +1,92 @@
+#ifndef DWL__OCP__COST_STACK__IMPL_H
+#define DWL__OCP__COST_STACK__IMPL_H
+
+
+namespace dwl
+{
+
+namespace ocp
+{
+
+template <typename... TCosts>
+CostStack<TCosts...>::CostStack()
+{
+	name_ = "cost stack";
+}
+
+
+template <typename... TCosts>
+CostStack<TCosts...>::CostStack(const TCosts&... costs) : costs_(costs...)
+{
+	name_ = "cost stack";
+}
+
+
+template <typename... TCosts>
+CostStack<TCosts...>::~CostStack()
+{
+
+}
+
+
+template <typename... TCosts>
+CostStack<TCosts...>* CostStack<TCosts...>::clone() const
+{
+	return new CostStack<TCosts...>(*this);
+}
+
+
+template <typename... TCosts>
+void CostStack<TCosts...>::compute(double& cost,
+								   const WholeBodyState& state)
+{
+	cost = 0.;
+	computeTerms(cost, state, std::integral_constant<std::size_t, 0>());
+}
+
+
+template <typename... TCosts>
+void CostStack<TCosts...>::setDesiredState(const WholeBodyState& desired_state)
+{
+	Cost::setDesiredState(desired_state);
+	setTermsDesiredState(desired_state, std::integral_constant<std::size_t, 0>());
+}
+
+
+template <typename... TCosts>
+template <std::size_t I>
+typename std::tuple_element<I, std::tuple<TCosts...> >::type& CostStack<TCosts...>::get()
+{
+	return std::get<I>(costs_);
+}
+
+
+template <typename... TCosts>
+template <std::size_t I>
+void CostStack<TCosts...>::computeTerms(double& cost,
+										const WholeBodyState& state,
+										std::integral_constant<std::size_t, I>)
+{
+	// The qualified call of the final type avoids the virtual dispatch
+	typedef typename std::tuple_element<I, std::tuple<TCosts...> >::type TCost;
+	double term_cost = 0.;
+	std::get<I>(costs_).TCost::compute(term_cost, state);
+	cost += term_cost;
+
+	computeTerms(cost, state, std::integral_constant<std::size_t, I + 1>());
+}
+
+
+template <typename... TCosts>
+template <std::size_t I>
+void CostStack<TCosts...>::setTermsDesiredState(const WholeBodyState& desired_state,
+												std::integral_constant<std::size_t, I>)
+{
+	std::get<I>(costs_).setDesiredState(desired_state);
+	setTermsDesiredState(desired_state, std::integral_constant<std::size_t, I + 1>());
+}
+
+} //@namespace ocp
+} //@namespace dwl
+
+#endif
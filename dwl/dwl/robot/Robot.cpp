@@ -9,11 +9,12 @@ namespace dwl
 namespace robot
 {
 
-Robot::Robot() : body_behavior_(NULL), num_feet_(0), num_end_effectors_(0),
+Robot::Robot() : body_behavior_(NULL), num_headings_(16), num_feet_(0), num_end_effectors_(0),
 		estimated_ground_from_body_(-0.55), last_past_foot_(1),
 		feet_lateral_offset_(0), displacement_(0)
 {
 	body_behavior_ = new behavior::BodyMotorPrimitives();
+	precomputeSearchAreas();
 }
 
 
@@ -153,6 +154,27 @@ void Robot::read(std::string filename)
 	// Reading the body work window
 	if (!yaml_reader_.read(body_workspace_, "body_workspace", properties_ns))
 		printf(YELLOW "Warning: the body workspace description was not read\n" COLOR_RESET);
+
+	// Reading the number of headings of the search cells, which is optional
+	int num_headings;
+	if (yaml_reader_.read(num_headings, "number_of_headings", properties_ns) &&
+			num_headings > 0)
+		num_headings_ = num_headings;
+
+	// Precomputing the search areas, so the planners don't build them in every expansion
+	precomputeSearchAreas();
+}
+
+
+void Robot::setNumberOfHeadings(unsigned int num_headings)
+{
+	if (num_headings == 0) {
+		printf(YELLOW "Warning: the number of headings has to be positive\n" COLOR_RESET);
+		return;
+	}
+
+	num_headings_ = num_headings;
+	precomputeSearchAreas();
 }
 
 
@@ -192,13 +214,13 @@ behavior::MotorPrimitives& Robot::getBodyMotorPrimitive()
 }
 
 
-SearchArea Robot::getPredefinedBodyWorkspace()
+const SearchArea& Robot::getPredefinedBodyWorkspace() const
 {
 	return body_workspace_;
 }
 
 
-SearchAreaMap Robot::getPredefinedLegWorkspaces()
+const SearchAreaMap& Robot::getPredefinedLegWorkspaces() const
 {
 	return foot_workspaces_;
 }
@@ -207,6 +229,19 @@ SearchAreaMap Robot::getPredefinedLegWorkspaces()
 Vector3dMap Robot::getStance(const Eigen::Vector3d& action) //TODO Virtual method
 {
 	int lateral_pattern, displacement_pattern;
+	computeStancePattern(displacement_pattern, lateral_pattern, action);
+
+	Vector3dMap stance;
+	computeStance(stance, displacement_pattern, lateral_pattern);
+
+	return stance;
+}
+
+
+void Robot::computeStancePattern(int& displacement_pattern,
+								 int& lateral_pattern,
+								 const Eigen::Vector3d& action)
+{
 	double frontal_action = action(0);
 	if (frontal_action == 0)
 		displacement_pattern = 0;
@@ -241,30 +276,38 @@ Vector3dMap Robot::getStance(const Eigen::Vector3d& action) //TODO Virtual metho
 			lateral_pattern = 1;
 	}
 	last_past_foot_ = past_foot_id;
+}
 
 
+void Robot::computeStance(Vector3dMap& stance,
+						  int displacement_pattern,
+						  int lateral_pattern) const
+{
 	// Defining the stance position per leg
-	Vector3dMap stance;
-	for (EndEffectorMap::iterator it = feet_.begin(); it != feet_.end(); ++it) {
+	stance.clear();
+	for (EndEffectorMap::const_iterator it = feet_.begin(); it != feet_.end(); ++it) {
 		unsigned int id = it->first;
 		std::string name = it->second;
 
+		Eigen::Vector3d nominal = Eigen::Vector3d::Zero();
+		Vector3dMap::const_iterator nominal_it = nominal_stance_.find(id);
+		if (nominal_it != nominal_stance_.end())
+			nominal = nominal_it->second;
+
 		Eigen::Vector3d position;
 		if ((name == "lf_foot") || (name == "lh_foot"))
-			position(0) = nominal_stance_[id](0) -
+			position(0) = nominal(0) -
 				lateral_pattern * feet_lateral_offset_ +
 				displacement_pattern * displacement_;
 		else
-			position(0) = nominal_stance_[id](0) +
+			position(0) = nominal(0) +
 				lateral_pattern * feet_lateral_offset_ +
 				displacement_pattern * displacement_;
 
-		position(1) = nominal_stance_[id](1);
+		position(1) = nominal(1);
 		position(2) = estimated_ground_from_body_;
 		stance[id] = position;
 	}
-
-	return stance;
 }
 
 
@@ -280,51 +323,44 @@ PatternOfLocomotionMap Robot::getPatternOfLocomotion()
 }
 
 
-SearchAreaMap Robot::getFootstepSearchAreas(const Eigen::Vector3d& action)
+const SearchAreaMap& Robot::getFootstepSearchAreas(const Eigen::Vector3d& action)
 {
-	// Getting the current stance
-	Vector3dMap current_stance = getStance(action);
-
-	// Getting the footstep search regions
-	SearchAreaMap footstep_areas;
-	footstep_areas = getFootstepSearchSize(action);
-
-	for (EndEffectorMap::iterator l = feet_.begin(); l != feet_.end(); l++) {
-		unsigned int leg_id = l->first;
-		footstep_areas[leg_id].max_x += current_stance[leg_id](0);
-		footstep_areas[leg_id].min_x += current_stance[leg_id](0);
-		footstep_areas[leg_id].max_y += current_stance[leg_id](1);
-		footstep_areas[leg_id].min_y += current_stance[leg_id](1);
-	}
-
-	return footstep_areas;
+	return footstep_search_areas_[getStanceIndex(action)];
 }
 
 
-SearchAreaMap Robot::getFootstepSearchSize(const Eigen::Vector3d& action)
+const SearchAreaMap& Robot::getFootstepSearchSize(const Eigen::Vector3d& action) const
 {
 	// Determining if the movements is forward or backward because the footstep search areas
 	// changes according the action
-	int displacement_pattern;
-	double frontal_action = action(0);
-	if (frontal_action >= 0)
-		displacement_pattern = 1;
+	if (action(0) >= 0)
+		return footstep_search_sizes_[0];
 	else
-		displacement_pattern = -1;
+		return footstep_search_sizes_[1];
+}
 
-	SearchAreaMap footstep_areas;
-	SearchArea footstep_area;
-	for (EndEffectorMap::iterator l = feet_.begin(); l != feet_.end(); l++) {
-		unsigned int leg_id = l->first;
-		footstep_area.resolution = footstep_window_[leg_id].resolution;
-		footstep_area.max_x = displacement_pattern * footstep_window_[leg_id].max_x;
-		footstep_area.min_x = displacement_pattern * footstep_window_[leg_id].min_x;
-		footstep_area.max_y = footstep_window_[leg_id].max_y;
-		footstep_area.min_y = footstep_window_[leg_id].min_y;
-		footstep_areas[leg_id] = footstep_area;
-	}
 
-	return footstep_areas;
+const SearchAreaCells& Robot::getFootstepSearchCells(const Eigen::Vector3d& action,
+													 double yaw)
+{
+	unsigned int stance_idx = getStanceIndex(action);
+
+	// Returning the precomputed cells if the yaw is a heading
+	double heading_resolution = 2 * M_PI / num_headings_;
+	double heading_yaw = yaw;
+	math::normalizeAngle(heading_yaw, ZeroTo2Pi);
+	double heading = round(heading_yaw / heading_resolution);
+	if (fabs(heading_yaw - heading * heading_resolution) < 1e-9)
+		return footstep_search_cells_[(unsigned int) heading % num_headings_][stance_idx];
+
+	computeSearchCells(rotated_search_cells_, footstep_search_areas_[stance_idx], yaw);
+	return rotated_search_cells_;
+}
+
+
+unsigned int Robot::getNumberOfHeadings() const
+{
+	return num_headings_;
 }
 
 
@@ -351,5 +387,109 @@ EndEffectorMap Robot::getLegMap()
 	return feet_;
 }
 
+
+unsigned int Robot::getStanceIndex(const Eigen::Vector3d& action)
+{
+	int displacement_pattern, lateral_pattern;
+	computeStancePattern(displacement_pattern, lateral_pattern, action);
+
+	return 3 * (displacement_pattern + 1) + (lateral_pattern + 1);
+}
+
+
+void Robot::computeSearchCells(SearchAreaCells& cells,
+							   const SearchAreaMap& areas,
+							   double yaw) const
+{
+	double cos_yaw = cos(yaw);
+	double sin_yaw = sin(yaw);
+	std::vector<double> points;
+	cells.ids.clear();
+	cells.sizes.clear();
+	cells.corners.resize(2, 4 * areas.size());
+	unsigned int area_idx = 0;
+	for (SearchAreaMap::const_iterator area_it = areas.begin();
+			area_it != areas.end(); area_it++, area_idx++) {
+		const SearchArea& area = area_it->second;
+
+		// Computing the rotated points of the grid of the area, where the areas without
+		// resolution don't have cells
+		unsigned int num_points = points.size();
+		if (area.resolution > 0.) {
+			for (double y = area.min_y; y <= area.max_y; y += area.resolution) {
+				for (double x = area.min_x; x <= area.max_x; x += area.resolution) {
+					points.push_back(x * cos_yaw - y * sin_yaw);
+					points.push_back(x * sin_yaw + y * cos_yaw);
+				}
+			}
+		}
+		cells.ids.push_back(area_it->first);
+		cells.sizes.push_back((points.size() - num_points) / 2);
+
+		// Computing the rotated corners of the area
+		for (unsigned int i = 0; i < 4; i++) {
+			double x = (i % 2 == 0) ? area.min_x : area.max_x;
+			double y = (i < 2) ? area.min_y : area.max_y;
+			cells.corners.col(4 * area_idx + i) << x * cos_yaw - y * sin_yaw,
+					x * sin_yaw + y * cos_yaw;
+		}
+	}
+	cells.points = Eigen::Map<Eigen::Matrix2Xd>(points.data(), 2, points.size() / 2);
+}
+
+
+void Robot::precomputeSearchAreas()
+{
+	// Computing the footstep search sizes of the forward and backward actions
+	footstep_search_sizes_.assign(2, SearchAreaMap());
+	for (unsigned int k = 0; k < 2; k++) {
+		int displacement_pattern = (k == 0) ? 1 : -1;
+		for (EndEffectorMap::iterator l = feet_.begin(); l != feet_.end(); l++) {
+			unsigned int leg_id = l->first;
+			SearchArea window = SearchArea();
+			SearchAreaMap::const_iterator window_it = footstep_window_.find(leg_id);
+			if (window_it != footstep_window_.end())
+				window = window_it->second;
+
+			SearchArea footstep_area = window;
+			footstep_area.max_x = displacement_pattern * window.max_x;
+			footstep_area.min_x = displacement_pattern * window.min_x;
+			footstep_search_sizes_[k][leg_id] = footstep_area;
+		}
+	}
+
+	// Computing the footstep search areas of every stance pattern, i.e. the search sizes
+	// around the stance positions. Note that the backward actions have a positive
+	// displacement pattern
+	footstep_search_areas_.assign(9, SearchAreaMap());
+	for (int displacement_pattern = -1; displacement_pattern <= 1; displacement_pattern++) {
+		for (int lateral_pattern = -1; lateral_pattern <= 1; lateral_pattern++) {
+			Vector3dMap stance;
+			computeStance(stance, displacement_pattern, lateral_pattern);
+
+			unsigned int stance_idx = 3 * (displacement_pattern + 1) + (lateral_pattern + 1);
+			SearchAreaMap& footstep_areas = footstep_search_areas_[stance_idx];
+			footstep_areas = footstep_search_sizes_[displacement_pattern == 1 ? 1 : 0];
+			for (SearchAreaMap::iterator area_it = footstep_areas.begin();
+					area_it != footstep_areas.end(); area_it++) {
+				const Eigen::Vector3d& position = stance[area_it->first];
+				area_it->second.max_x += position(0);
+				area_it->second.min_x += position(0);
+				area_it->second.max_y += position(1);
+				area_it->second.min_y += position(1);
+			}
+		}
+	}
+
+	// Computing the cells of every heading and stance pattern
+	double heading_resolution = 2 * M_PI / num_headings_;
+	footstep_search_cells_.assign(num_headings_, std::vector<SearchAreaCells>(9));
+	for (unsigned int h = 0; h < num_headings_; h++) {
+		for (unsigned int k = 0; k < 9; k++)
+			computeSearchCells(footstep_search_cells_[h][k], footstep_search_areas_[k],
+							   h * heading_resolution);
+	}
+}
+
 } //@namespace robot
 } //@namespace dwl
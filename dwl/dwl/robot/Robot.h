@@ -31,11 +31,20 @@ class Robot
 		~Robot();
 
 		/**
-		 * @brief Reads the robot properties from a yaml file
+		 * @brief Reads the robot properties from a yaml file, and precomputes the search areas
+		 * of every stance and their cells in the robot frame (see getFootstepSearchCells)
 		 * @param std::string File name of the yaml
 		 */
 		void read(std::string filename);
 
+		/**
+		 * @brief Sets the number of headings of the precomputed cells of the footstep search
+		 * areas, i.e. their angular resolution is 2 pi / num_headings. The default value is 16,
+		 * or the number_of_headings of the yaml
+		 * @param unsigned int Number of headings
+		 */
+		void setNumberOfHeadings(unsigned int num_headings);
+
 		/**
 		 * @brief Sets the current pose of the robot
 		 * @param const Pose& Current pose
@@ -71,14 +80,14 @@ class Robot
 		 * potential collisions
 		 * @return The predefined body workspace
 		 */
-		SearchArea getPredefinedBodyWorkspace();
+		const SearchArea& getPredefinedBodyWorkspace() const;
 
 		/**
 		 * @brief Gets the predefined leg workspace for evaluation of
 		 * potential collisions
 		 * @return The predefined leg workspaces
 		 */
-		SearchAreaMap getPredefinedLegWorkspaces();
+		const SearchAreaMap& getPredefinedLegWorkspaces() const;
 
 		/**
 		 * @brief Gets the current stance of the robot
@@ -100,18 +109,32 @@ class Robot
 		PatternOfLocomotionMap getPatternOfLocomotion();
 
 		/**
-		 * @brief Gets the stance areas
+		 * @brief Gets the stance areas, which are precomputed for every stance of the actions
 		 * @param const Eigen::Vector3d& action Action to execute
 		 * @return The stance areas
 		 */
-		SearchAreaMap getFootstepSearchAreas(const Eigen::Vector3d& action = Eigen::Vector3d::Zero());
+		const SearchAreaMap& getFootstepSearchAreas(const Eigen::Vector3d& action = Eigen::Vector3d::Zero());
 
 		/**
 		 * @brief Gets the footstep search region given an action
 		 * @param const Eigen::Vector3d& action Action to execute
 		 * @return The footstep search regions
 		 */
-		SearchAreaMap getFootstepSearchSize(const Eigen::Vector3d& action = Eigen::Vector3d::Zero());
+		const SearchAreaMap& getFootstepSearchSize(const Eigen::Vector3d& action = Eigen::Vector3d::Zero()) const;
+
+		/**
+		 * @brief Gets the cells and corners of the stance areas rotated by a body yaw, i.e.
+		 * relative to the body position. The cells of the headings are precomputed, so the
+		 * other yaws are rotated from the robot frame in every call
+		 * @param const Eigen::Vector3d& action Action to execute
+		 * @param double Yaw of the body
+		 * @return The cells of the stance areas, which are valid until the next call
+		 */
+		const SearchAreaCells& getFootstepSearchCells(const Eigen::Vector3d& action,
+													  double yaw = 0.);
+
+		/** @brief Gets the number of headings of the precomputed cells */
+		unsigned int getNumberOfHeadings() const;
 
 		/**
 		 * @brief Gets the expected ground according to the nominal stance
@@ -164,8 +187,20 @@ class Robot
 		/** @brief Vector of the body workspace */
 		SearchArea body_workspace_;
 
-		/** @brief Vector of footstep search areas */
-		std::vector<SearchArea> footstep_search_areas_;
+		/** @brief Footstep search sizes of the forward and backward actions */
+		std::vector<SearchAreaMap> footstep_search_sizes_;
+
+		/** @brief Footstep search areas of every stance pattern */
+		std::vector<SearchAreaMap> footstep_search_areas_;
+
+		/** @brief Cells of the footstep search areas of every heading and stance pattern */
+		std::vector<std::vector<SearchAreaCells> > footstep_search_cells_;
+
+		/** @brief Cells of the last query of a yaw between the headings */
+		SearchAreaCells rotated_search_cells_;
+
+		/** @brief Number of headings of the precomputed cells */
+		unsigned int num_headings_;
 
 		/** @brief Pattern of locomotion */
 		PatternOfLocomotionMap pattern_locomotion_;
@@ -187,6 +222,49 @@ class Robot
 
 		/** @brief Body displacement */
 		double displacement_;
+
+
+	private:
+		/**
+		 * @brief Computes the stance pattern of an action, i.e. the frontal and lateral
+		 * displacements of the feet, and updates the last past foot
+		 * @param int& Displacement pattern, i.e. -1, 0 or 1
+		 * @param int& Lateral pattern, i.e. -1, 0 or 1
+		 * @param const Eigen::Vector3d& Action to execute
+		 */
+		void computeStancePattern(int& displacement_pattern,
+								  int& lateral_pattern,
+								  const Eigen::Vector3d& action);
+
+		/**
+		 * @brief Computes the stance of a stance pattern
+		 * @param Vector3dMap& Stance of the robot
+		 * @param int Displacement pattern
+		 * @param int Lateral pattern
+		 */
+		void computeStance(Vector3dMap& stance,
+						   int displacement_pattern,
+						   int lateral_pattern) const;
+
+		/**
+		 * @brief Gets the index of the precomputed stance of an action
+		 * @param const Eigen::Vector3d& Action to execute
+		 * @return unsigned int Index of the stance pattern
+		 */
+		unsigned int getStanceIndex(const Eigen::Vector3d& action);
+
+		/**
+		 * @brief Computes the cells and corners of a set of search areas rotated by a yaw
+		 * @param SearchAreaCells& Cells of the search areas
+		 * @param const SearchAreaMap& Search areas
+		 * @param double Yaw of the rotation
+		 */
+		void computeSearchCells(SearchAreaCells& cells,
+								const SearchAreaMap& areas,
+								double yaw) const;
+
+		/** @brief Precomputes the search areas and cells of every stance and heading */
+		void precomputeSearchAreas();
 };
 
 } //@namespace robot
@@ -1,4 +1,5 @@
 #include <dwl/simulation/FootSplinePatternGenerator.h>
+#include <limits>
 
 
 namespace dwl
@@ -41,23 +42,24 @@ void FootSplinePatternGenerator::setParameters(const double& initial_time,
 		target_appex = initial_pos(rbd::Z) + params.height * cos(step_theta);
 
 	// Setting the spline boundaries
-	foot_spliner_x_.setBoundary(initial_time,
-								params.duration,
-								(double) initial_pos(rbd::X),
-								(double) target_pos(rbd::X));
-	foot_spliner_y_.setBoundary(initial_time,
-								params.duration,
-								(double) initial_pos(rbd::Y),
-								(double) target_pos(rbd::Y));
+	typedef dwl::math::FifthOrderPolySplineN<2>::Point Point2d;
+	typedef dwl::math::FifthOrderPolySplineN<1>::Point Point1d;
+	Point1d initial_z, appex_z, target_z;
+	initial_z.x(0) = initial_pos(rbd::Z);
+	appex_z.x(0) = target_appex;
+	target_z.x(0) = target_pos(rbd::Z) - params.penetration;
+	foot_spliner_xy_.setBoundary(initial_time,
+								 params.duration,
+								 Point2d(initial_pos.head<2>()),
+								 Point2d(target_pos.head<2>()));
 	foot_spliner_up_z_.setBoundary(initial_time,
 								   params.duration / 2,
-								   (double) initial_pos(rbd::Z),
-								   target_appex);
+								   initial_z,
+								   appex_z);
 	foot_spliner_down_z_.setBoundary(initial_time + params.duration / 2,
 									 params.duration / 2,
-									 target_appex,
-									 (double) target_pos(rbd::Z) -
-									 params.penetration);
+									 appex_z,
+									 target_z);
 }
 
 
@@ -71,10 +73,10 @@ bool FootSplinePatternGenerator::generateTrajectory(Eigen::Vector3d& foot_pos,
 					  // is bigger than the sample time
 
 	// Computing the time that allows us to discriminate the swing-up or swing-down phase
-	dwl::math::Spline::Point swing_traj_x, swing_traj_y, swing_traj_z;
+	dwl::math::FifthOrderPolySplineN<2>::Point swing_traj_xy;
+	dwl::math::FifthOrderPolySplineN<1>::Point swing_traj_z;
 	double dt = time - initial_time_;
-	foot_spliner_x_.getPoint(time, swing_traj_x);
-	foot_spliner_y_.getPoint(time, swing_traj_y);
+	foot_spliner_xy_.getPoint(time, swing_traj_xy);
 
 	if (dt <= (duration_ / 2))
 		foot_spliner_up_z_.getPoint(time, swing_traj_z);
@@ -82,9 +84,9 @@ bool FootSplinePatternGenerator::generateTrajectory(Eigen::Vector3d& foot_pos,
 		foot_spliner_down_z_.getPoint(time, swing_traj_z);
 
 	// Setting the foot state
-	foot_pos << swing_traj_x.x, swing_traj_y.x, swing_traj_z.x;
-	foot_vel << swing_traj_x.xd, swing_traj_y.xd, swing_traj_z.xd;
-	foot_acc << swing_traj_x.xdd, swing_traj_y.xdd, swing_traj_z.xdd;
+	foot_pos << swing_traj_xy.x, swing_traj_z.x;
+	foot_vel << swing_traj_xy.xd, swing_traj_z.xd;
+	foot_acc << swing_traj_xy.xdd, swing_traj_z.xdd;
 
 	if (time >= initial_time_ + duration_)
 		return false;
@@ -93,6 +95,187 @@ bool FootSplinePatternGenerator::generateTrajectory(Eigen::Vector3d& foot_pos,
 }
 
 
+MultiFootSplinePatternGenerator::MultiFootSplinePatternGenerator() : initial_time_(0.),
+		duration_(0.)
+{
+
+}
+
+
+MultiFootSplinePatternGenerator::~MultiFootSplinePatternGenerator()
+{
+
+}
+
+
+void MultiFootSplinePatternGenerator::setParameters(const double& initial_time,
+													const rbd::BodyVector3d& initial_pos,
+													const rbd::BodyVector3d& target_pos,
+													const StepParameters& params)
+{
+	// Setting the initial time and duration of the swing movements
+	initial_time_ = initial_time;
+	duration_ = params.duration;
+
+	// Getting the boundaries of the swing feet. The z row of the start and end points are the
+	// boundaries of the swing-up half, and the apex row of the swing-down one
+	unsigned int num_feet = target_pos.size();
+	feet_names_.clear();
+	Eigen::Matrix3Xd start(3, num_feet), end(3, num_feet);
+	Eigen::RowVectorXd appex(num_feet);
+	unsigned int i = 0;
+	for (rbd::BodyVector3d::const_iterator target_it = target_pos.begin();
+			target_it != target_pos.end(); ++target_it, ++i) {
+		std::string name = target_it->first;
+		rbd::BodyVector3d::const_iterator initial_it = initial_pos.find(name);
+		if (initial_it == initial_pos.end()) {
+			printf(RED "FATAL: there is not the initial position of the %s foot\n"
+					COLOR_RESET, name.c_str());
+			exit(EXIT_FAILURE);
+		}
+		feet_names_.push_back(name);
+		start.col(i) = initial_it->second;
+		end.col(i) = target_it->second;
+
+		// Computing the appex of the swing movement
+		Eigen::Vector3d step_delta = end.col(i) - start.col(i);
+		double height_dist = fabs((double) step_delta(rbd::Z));
+		double step2d_dist = fabs(step_delta.head<2>().norm());
+		double step_theta = atan(height_dist / step2d_dist);
+		if (end(rbd::Z,i) >= start(rbd::Z,i))
+			appex(i) = end(rbd::Z,i) + params.height * cos(step_theta);
+		else
+			appex(i) = start(rbd::Z,i) + params.height * cos(step_theta);
+	}
+	end.row(rbd::Z).array() -= params.penetration;
+
+	// Recording the boundaries of the swing halves. Note that the horizontal splines are at
+	// the middle of the step in the apex, since they are symmetric
+	start_pos_ = start;
+	end_pos_ = end;
+	apex_pos_.resize(3, num_feet);
+	apex_pos_.topRows<2>() = 0.5 * (start.topRows<2>() + end.topRows<2>());
+	apex_pos_.row(rbd::Z) = appex;
+
+	// Computing the coefficients of the fifth-order splines with zero velocities and
+	// accelerations in the boundaries, i.e. the ones of FifthOrderPolySplineN
+	Eigen::Array3d duration(params.duration, params.duration, params.duration / 2);
+	Eigen::Array3Xd up_delta(3, num_feet), down_delta(3, num_feet);
+	up_delta.topRows<2>() = (end.topRows<2>() - start.topRows<2>()).array();
+	up_delta.row(rbd::Z) = (appex - start.row(rbd::Z)).array();
+	down_delta.topRows<2>() = up_delta.topRows<2>();
+	down_delta.row(rbd::Z) = (end.row(rbd::Z) - appex).array();
+	up_coeffs_[0] = start.array();
+	down_coeffs_[0] = start.array();
+	down_coeffs_[0].row(rbd::Z) = appex.array();
+	for (unsigned int k = 1; k < 4; k++) {
+		up_coeffs_[k].setZero(3, num_feet);
+		down_coeffs_[k].setZero(3, num_feet);
+	}
+	if (params.duration == 0.)
+		return;
+
+	Eigen::Array3d T3 = duration * duration * duration;
+	Eigen::Array3d T4 = duration * T3;
+	Eigen::Array3d T5 = duration * T4;
+	up_coeffs_[1] = up_delta.colwise() * (10 / T3);
+	up_coeffs_[2] = up_delta.colwise() * (-15 / T4);
+	up_coeffs_[3] = up_delta.colwise() * (6 / T5);
+	down_coeffs_[1] = down_delta.colwise() * (10 / T3);
+	down_coeffs_[2] = down_delta.colwise() * (-15 / T4);
+	down_coeffs_[3] = down_delta.colwise() * (6 / T5);
+}
+
+
+bool MultiFootSplinePatternGenerator::generateTrajectory(Eigen::Matrix3Xd& feet_pos,
+														 Eigen::Matrix3Xd& feet_vel,
+														 Eigen::Matrix3Xd& feet_acc,
+														 const double& time) const
+{
+	if (time < initial_time_)
+		return false;
+
+	// Computing the elapsed time of every row, where the vertical row discriminates the
+	// swing-up or swing-down phase. Note that the elapsed times are saturated by the
+	// duration of the splines
+	double dt = std::min(time - initial_time_, duration_);
+	bool swing_up = dt <= (duration_ / 2);
+	const Eigen::Array3Xd* coeffs = swing_up ? up_coeffs_ : down_coeffs_;
+	Eigen::Array3d t1(dt, dt, swing_up ? dt : dt - duration_ / 2);
+	Eigen::Array3d t2 = t1 * t1;
+	Eigen::Array3d t3 = t1 * t2;
+	Eigen::Array3d t4 = t1 * t3;
+	Eigen::Array3d t5 = t1 * t4;
+
+	// Setting the feet states
+	unsigned int num_feet = feet_names_.size();
+	feet_pos.resize(3, num_feet);
+	feet_vel.resize(3, num_feet);
+	feet_acc.resize(3, num_feet);
+	feet_pos.array() = coeffs[0] + coeffs[1].colwise() * t3 +
+			coeffs[2].colwise() * t4 + coeffs[3].colwise() * t5;
+	feet_vel.array() = coeffs[1].colwise() * (3 * t2) +
+			coeffs[2].colwise() * (4 * t3) + coeffs[3].colwise() * (5 * t4);
+	feet_acc.array() = coeffs[1].colwise() * (6 * t1) +
+			coeffs[2].colwise() * (12 * t2) + coeffs[3].colwise() * (20 * t3);
+
+	if (time >= initial_time_ + duration_)
+		return false;
+
+	return true;
+}
+
+
+void MultiFootSplinePatternGenerator::computePositionBounds(Eigen::Matrix3Xd& lower_pos,
+															 Eigen::Matrix3Xd& upper_pos) const
+{
+	lower_pos = start_pos_.cwiseMin(apex_pos_).cwiseMin(end_pos_);
+	upper_pos = start_pos_.cwiseMax(apex_pos_).cwiseMax(end_pos_);
+}
+
+
+void MultiFootSplinePatternGenerator::computeReachBounds(Eigen::VectorXd& min_reach,
+														 Eigen::VectorXd& max_reach,
+														 const Eigen::Matrix3Xd& origins) const
+{
+	unsigned int num_feet = feet_names_.size();
+	assert(origins.cols() == num_feet);
+	min_reach.resize(num_feet);
+	max_reach.resize(num_feet);
+	for (unsigned int i = 0; i < num_feet; i++) {
+		const Eigen::Vector3d& origin = origins.col(i);
+		min_reach(i) = std::numeric_limits<double>::max();
+		max_reach(i) = 0.;
+
+		// Computing the nearest and farthest points of the boxes of the swing-up and
+		// swing-down halves
+		for (unsigned int h = 0; h < 2; h++) {
+			Eigen::Vector3d first = (h == 0) ? start_pos_.col(i) : apex_pos_.col(i);
+			Eigen::Vector3d second = (h == 0) ? apex_pos_.col(i) : end_pos_.col(i);
+			Eigen::Vector3d lower = first.cwiseMin(second) - origin;
+			Eigen::Vector3d upper = first.cwiseMax(second) - origin;
+
+			Eigen::Vector3d nearest = lower.cwiseMax(upper.cwiseMin(0.));
+			Eigen::Vector3d farthest = lower.cwiseAbs().cwiseMax(upper.cwiseAbs());
+			min_reach(i) = std::min(min_reach(i), nearest.norm());
+			max_reach(i) = std::max(max_reach(i), farthest.norm());
+		}
+	}
+}
+
+
+const std::vector<std::string>& MultiFootSplinePatternGenerator::getSwingFeet() const
+{
+	return feet_names_;
+}
+
+
+unsigned int MultiFootSplinePatternGenerator::getNumberOfFeet() const
+{
+	return feet_names_.size();
+}
+
+
 //bool FootSplinePatternGenerator::hapticSwingStopCondition(const Eigen::Matrix3d& Jac,
 //														  const Eigen::Vector3d& grforce_base,
 //														  double force_th)
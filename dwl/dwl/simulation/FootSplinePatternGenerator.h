@@ -4,6 +4,7 @@
 #include <dwl/utils/SplineInterpolation.h>
 #include <dwl/utils/RigidBodyDynamics.h>
 #include <Eigen/Dense>
+#include <vector>
 
 
 namespace dwl
@@ -74,21 +75,127 @@ class FootSplinePatternGenerator
 */
 
 	protected:
-		/** @brief Spliners for the different axis of the foot movement */
-		dwl::math::FifthOrderPolySpline foot_spliner_x_;
-		dwl::math::FifthOrderPolySpline foot_spliner_y_;
-		dwl::math::FifthOrderPolySpline foot_spliner_up_z_;
-		dwl::math::FifthOrderPolySpline foot_spliner_down_z_;
+		/**
+		 * @brief Spliners of the foot movement, where the horizontal axes share the same
+		 * time interval so they are interpolated together
+		 */
+		dwl::math::FifthOrderPolySplineN<2> foot_spliner_xy_;
+		dwl::math::FifthOrderPolySplineN<1> foot_spliner_up_z_;
+		dwl::math::FifthOrderPolySplineN<1> foot_spliner_down_z_;
 
 		/** @brief Initial time of the swing trajectory */
 		double initial_time_;
 
 		/** @brief Duration of the swing trajectory */
 		double duration_;
+
+	public:
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
 typedef std::map<std::string, FootSplinePatternGenerator> FootSplinerMap;
 
+
+/**
+ * @class MultiFootSplinePatternGenerator
+ * @brief Generates the swing trajectories of all the swing feet of a phase. The feet share the
+ * initial time and the step parameters, so the coefficients of their splines are computed once
+ * per phase and stored as 3 x num_feet arrays (one column per foot). Every sample is evaluated
+ * for all the feet together with array operations, and written into preallocated matrices. The
+ * trajectory of each foot is the same as FootSplinePatternGenerator
+ */
+class MultiFootSplinePatternGenerator
+{
+	public:
+		/** @brief Constructor function */
+		MultiFootSplinePatternGenerator();
+
+		/** @brief Destructor function */
+		~MultiFootSplinePatternGenerator();
+
+		/**
+		 * @brief Sets the parameters of the swing trajectories of the feet. The swing feet
+		 * are the ones of the target positions, and they are ordered by name
+		 * This methods assumes that there is not an obstacle in the trajectory.
+		 * @param const double& Initial time
+		 * @param const rbd::BodyVector3d& Initial positions of the feet
+		 * @param const rbd::BodyVector3d& Target positions of the swing feet
+		 * @param const StepParameters Step parameters
+		 */
+		void setParameters(const double& initial_time,
+						   const rbd::BodyVector3d& initial_pos,
+						   const rbd::BodyVector3d& target_pos,
+						   const StepParameters& params);
+
+		/**
+		 * @brief Generates the swing trajectories of all the feet for a given time, where
+		 * every column is a foot. The matrices are only resized if the number of feet changed
+		 * @param Eigen::Matrix3Xd& Instantaneous feet positions
+		 * @param Eigen::Matrix3Xd& Instantaneous feet velocities
+		 * @param Eigen::Matrix3Xd& Instantaneous feet accelerations
+		 * @param const double& Current time
+		 * @return False if the time is outside the swing interval
+		 */
+		bool generateTrajectory(Eigen::Matrix3Xd& feet_pos,
+								Eigen::Matrix3Xd& feet_vel,
+								Eigen::Matrix3Xd& feet_acc,
+								const double& time) const;
+
+		/**
+		 * @brief Computes the bounds of the feet positions over the whole swing interval
+		 * without sampling. Every coordinate of a fifth-order spline with rest boundaries is
+		 * monotone, so the extrema of each half of the swing are its boundaries (i.e. the
+		 * initial, apex and target positions), and the bounds are exact
+		 * @param Eigen::Matrix3Xd& Lower bounds of the feet positions (one column per foot)
+		 * @param Eigen::Matrix3Xd& Upper bounds of the feet positions (one column per foot)
+		 */
+		void computePositionBounds(Eigen::Matrix3Xd& lower_pos,
+								   Eigen::Matrix3Xd& upper_pos) const;
+
+		/**
+		 * @brief Computes the bounds of the distances of the feet to reference points (e.g.
+		 * the hips) over the whole swing interval without sampling. Each half of the swing
+		 * stays inside the box of its boundaries, so the bounds are the nearest and farthest
+		 * points of the boxes, which are conservative
+		 * @param Eigen::VectorXd& Lower bounds of the distances (reach)
+		 * @param Eigen::VectorXd& Upper bounds of the distances (reach)
+		 * @param const Eigen::Matrix3Xd& Reference points (one column per foot)
+		 */
+		void computeReachBounds(Eigen::VectorXd& min_reach,
+								Eigen::VectorXd& max_reach,
+								const Eigen::Matrix3Xd& origins) const;
+
+		/** @brief Gets the names of the swing feet, i.e. the order of the columns */
+		const std::vector<std::string>& getSwingFeet() const;
+
+		/** @brief Gets the number of swing feet */
+		unsigned int getNumberOfFeet() const;
+
+
+	private:
+		/**
+		 * @brief Spline coefficients (a0, a3, a4, a5) of the swing-up and swing-down halves of
+		 * the feet, where the horizontal rows span the whole swing and the vertical row only its
+		 * half. Note that a1 and a2 are zero since the boundaries are at rest
+		 */
+		Eigen::Array3Xd up_coeffs_[4];
+		Eigen::Array3Xd down_coeffs_[4];
+
+		/** @brief Initial, apex (middle of the swing) and target positions of the feet */
+		Eigen::Matrix3Xd start_pos_;
+		Eigen::Matrix3Xd apex_pos_;
+		Eigen::Matrix3Xd end_pos_;
+
+		/** @brief Names of the swing feet */
+		std::vector<std::string> feet_names_;
+
+		/** @brief Initial time of the swing trajectory */
+		double initial_time_;
+
+		/** @brief Duration of the swing trajectory */
+		double duration_;
+};
+
 /*
 
 inline bool FootSplinePatternGenerator::isTimeElapsed(double& t)
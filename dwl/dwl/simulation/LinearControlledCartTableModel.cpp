@@ -8,7 +8,8 @@ namespace simulation
 {
 
 LinearControlledCartTableModel::LinearControlledCartTableModel() :
-		init_model_(false),	init_response_(false), height_(0.), omega_(0.)
+		init_model_(false),	init_response_(false), height_(0.), omega_(0.),
+		sample_time_(0.)
 {
 
 }
@@ -27,6 +28,12 @@ void LinearControlledCartTableModel::setModelProperties(CartTableProperties mode
 }
 
 
+void LinearControlledCartTableModel::setSampleTime(double sample_time)
+{
+	sample_time_ = sample_time;
+}
+
+
 void LinearControlledCartTableModel::initResponse(const ReducedBodyState& state,
 											 	  const CartTableControlParams& params_H)
 {
@@ -57,6 +64,8 @@ void LinearControlledCartTableModel::initCoMResponse(const ReducedBodyState& sta
 	params_W_.cop_shift =
 			frame_tf_.fromHorizontalToWorldFrame(params_H.cop_shift,
 												 initial_state_.getRPY());
+	cop_rot_W_ =
+			frame_tf_.getHorizontalToWorldRotation(initial_state_.getRPY()).topLeftCorner<2,2>();
 
 	// Computing the coefficients of the cart-table response
 	height_ = initial_state_.getCoMPosition()(rbd::Z) -
@@ -72,6 +81,26 @@ void LinearControlledCartTableModel::initCoMResponse(const ReducedBodyState& sta
 	beta_2_ = hor_proj / 2 -
 			(hor_disp - params_W_.cop_shift.head<2>()) / alpha;
 	cop_T_ = params_W_.cop_shift.head<2>() / params_W_.duration;
+
+	// Tabulating the exponential terms of the phase samples with the recurrence
+	// exp(w*(k+1)*dt) = exp(w*k*dt) * exp(w*dt), which requires only one exponential per
+	// phase. Note that the table isn't released between phases
+	if (sample_time_ > 0.) {
+		unsigned int num_samples = floor(params_W_.duration / sample_time_) + 1;
+		exp_table_.resize(num_samples + 1);
+		inv_exp_table_.resize(num_samples + 1);
+		double exp_step = exp(omega_ * sample_time_);
+		double inv_exp_step = 1. / exp_step;
+		exp_table_(0) = 1.;
+		inv_exp_table_(0) = 1.;
+		for (unsigned int k = 1; k <= num_samples; k++) {
+			exp_table_(k) = exp_table_(k-1) * exp_step;
+			inv_exp_table_(k) = inv_exp_table_(k-1) * inv_exp_step;
+		}
+	} else {
+		exp_table_.resize(0);
+		inv_exp_table_.resize(0);
+	}
 }
 
 
@@ -205,10 +234,23 @@ void LinearControlledCartTableModel::computeCoMResponse(ReducedBodyState& state,
 	Eigen::Vector3d delta_cop = (dt / params_W_.duration) * params_W_.cop_shift;
 	state.setCoPPosition_W(initial_state_.getCoPPosition_W() + delta_cop);
 
+	// Getting the exponential terms from the table of the phase samples. The times that
+	// aren't samples are evaluated directly
+	double exp_dt, inv_exp_dt;
+	double sample = (sample_time_ > 0.) ? dt / sample_time_ : -1.;
+	unsigned int k = (sample >= 0.) ? (unsigned int) (sample + 0.5) : 0;
+	if (sample >= 0. && k < exp_table_.size() && fabs(sample - k) < 1e-6) {
+		exp_dt = exp_table_(k);
+		inv_exp_dt = inv_exp_table_(k);
+	} else {
+		exp_dt = exp(omega_ * dt);
+		inv_exp_dt = exp(-omega_ * dt);
+	}
+
 	// Computing the horizontal motion of the CoM according to
 	// the cart-table system
-	Eigen::Vector2d beta_exp_1 = beta_1_ * exp(omega_ * dt);
-	Eigen::Vector2d beta_exp_2 = beta_2_ * exp(-omega_ * dt);
+	Eigen::Vector2d beta_exp_1 = beta_1_ * exp_dt;
+	Eigen::Vector2d beta_exp_2 = beta_2_ * inv_exp_dt;
 	state.com_pos.head<2>() =
 			beta_exp_1 + beta_exp_2 +
 			cop_T_ * dt +
@@ -260,6 +302,67 @@ void LinearControlledCartTableModel::computeAttitudeResponse(ReducedBodyState& s
 }
 
 
+void LinearControlledCartTableModel::computeResponseDerivatives(CartTableResponseDerivatives& derivatives,
+																double time,
+																bool terminal)
+{
+	// Computing the terms of the response, where the derivatives with respect to the CoP
+	// shift are computed in the world frame and then rotated to the horizontal one
+	double dt = time - initial_state_.time;
+	double duration = params_W_.duration;
+	double sinh_dt = sinh(omega_ * dt);
+	double cosh_dt = cosh(omega_ * dt);
+	Eigen::Vector2d cop_shift = params_W_.cop_shift.head<2>();
+
+	// The CoM positions, velocities and accelerations are linear in the CoP shift (i.e.
+	// beta_1 and beta_2 depend on -shift/(2wT) and +shift/(2wT), and cop_T on shift/T)
+	double pos_shift = (dt - sinh_dt / omega_) / duration;
+	double vel_shift = (1 - cosh_dt) / duration;
+	double acc_shift = -omega_ * sinh_dt / duration;
+	double cop_shift_factor = dt / duration;
+
+	// The derivatives with respect to the duration for a fixed time
+	Eigen::Vector2d pos_duration = -pos_shift / duration * cop_shift;
+	Eigen::Vector2d vel_duration = -vel_shift / duration * cop_shift;
+	Eigen::Vector2d acc_duration = -acc_shift / duration * cop_shift;
+	Eigen::Vector2d cop_duration = -cop_shift_factor / duration * cop_shift;
+
+	// Setting the horizontal derivatives
+	derivatives.com_pos.setZero();
+	derivatives.com_vel.setZero();
+	derivatives.com_acc.setZero();
+	derivatives.cop.setZero();
+	derivatives.com_pos.block<2,1>(0,0) = pos_duration;
+	derivatives.com_vel.block<2,1>(0,0) = vel_duration;
+	derivatives.com_acc.block<2,1>(0,0) = acc_duration;
+	derivatives.cop.block<2,1>(0,0) = cop_duration;
+	derivatives.com_pos.block<2,2>(0,1) = pos_shift * cop_rot_W_;
+	derivatives.com_vel.block<2,2>(0,1) = vel_shift * cop_rot_W_;
+	derivatives.com_acc.block<2,2>(0,1) = acc_shift * cop_rot_W_;
+	derivatives.cop.block<2,2>(0,1) = cop_shift_factor * cop_rot_W_;
+
+	// The vertical components follow the support plane, i.e. z = -n_xy * delta_cop / n_z,
+	// and the vertical velocity depends on cop_T
+	Eigen::RowVector2d normal_2d = support_normal_.head<2>().transpose() / support_normal_(rbd::Z);
+	derivatives.com_pos.row(rbd::Z) = -normal_2d * derivatives.cop.topRows<2>();
+	derivatives.cop.row(rbd::Z) = derivatives.com_pos.row(rbd::Z);
+	derivatives.com_vel(rbd::Z,0) = normal_2d.dot(cop_shift) / (duration * duration);
+	derivatives.com_vel.block<1,2>(rbd::Z,1) = -normal_2d * cop_rot_W_ / duration;
+
+	// Adding the time derivative of the response for the end of the phase
+	if (terminal) {
+		ReducedBodyState state;
+		computeCoMResponse(state, time);
+		derivatives.com_pos.col(0) += state.com_vel;
+		derivatives.com_vel.col(0) += state.com_acc;
+		derivatives.com_acc.col(0).head<2>() +=
+				omega_ * omega_ * (state.com_vel.head<2>() - cop_T_);
+		derivatives.cop.col(0).head<2>() += cop_T_;
+		derivatives.cop(rbd::Z,0) += state.com_vel(rbd::Z);
+	}
+}
+
+
 double LinearControlledCartTableModel::getPendulumHeight()
 {
 	return height_;
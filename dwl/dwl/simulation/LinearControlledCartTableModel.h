@@ -41,6 +41,26 @@ struct CartTableControlParams
 	Eigen::Vector3d cop_shift;
 };
 
+/**
+ * @brief Derivatives of the cart-table response with respect to the control parameters of the
+ * phase. The columns are the derivatives with respect to the duration and the x and y CoP
+ * shift (horizontal frame), i.e. the order of the preview variables
+ */
+struct CartTableResponseDerivatives
+{
+	CartTableResponseDerivatives() {
+		com_pos.setZero();
+		com_vel.setZero();
+		com_acc.setZero();
+		cop.setZero();
+	}
+
+	Eigen::Matrix3d com_pos;
+	Eigen::Matrix3d com_vel;
+	Eigen::Matrix3d com_acc;
+	Eigen::Matrix3d cop;
+};
+
 /**
  * @class LinearControlledCartTableModel
  * @brief Describes the response of linear-controlled cart-table model
@@ -65,6 +85,15 @@ class LinearControlledCartTableModel
 		 */
 		void setModelProperties(CartTableProperties model);
 
+		/**
+		 * @brief Sets the sample time of the response queries. The exponential terms of the
+		 * CoM response are tabulated per phase for the times that are multiple of the sample
+		 * time, so each sample doesn't evaluate transcendental functions. A zero sample time
+		 * disables the table
+		 * @param double Sample time
+		 */
+		void setSampleTime(double sample_time);
+
 		/**
 		 * @brief Initializes the parameters for the computing the response
 		 * @param const ReducedBodyState& Initial reduced state
@@ -90,6 +119,19 @@ class LinearControlledCartTableModel
 		void computeAttitudeResponse(ReducedBodyState& state,
 									 double time);
 
+		/**
+		 * @brief Computes the analytic derivatives of the CoM and CoP response with respect to
+		 * the duration and the CoP shift of the phase. The pendulum frequency doesn't depend
+		 * on them, so the derivatives are closed-form as the response
+		 * @param CartTableResponseDerivatives& Derivatives of the response
+		 * @param double Current time
+		 * @param bool Indicates that the time is the end of the phase, i.e. it changes with
+		 * the duration
+		 */
+		void computeResponseDerivatives(CartTableResponseDerivatives& derivatives,
+										double time,
+										bool terminal = false);
+
 		/** @brief Gets the pendulum height */
 		double getPendulumHeight();
 
@@ -120,9 +162,16 @@ class LinearControlledCartTableModel
 		Eigen::Vector2d beta_1_;
 		Eigen::Vector2d beta_2_;
 		Eigen::Vector2d cop_T_;
+		Eigen::Matrix2d cop_rot_W_;
 		Eigen::Vector3d support_normal_;
 		Eigen::Vector3d support_rpy_;
 
+		/** @brief Sample time and exponential terms of the phase samples, i.e. exp(w*k*dt)
+		 * and exp(-w*k*dt) of the k-th sample */
+		double sample_time_;
+		Eigen::ArrayXd exp_table_;
+		Eigen::ArrayXd inv_exp_table_;
+
 		/** @brief System energy coefficients */
 		Eigen::Vector2d c_1_;
 		Eigen::Vector2d c_2_;
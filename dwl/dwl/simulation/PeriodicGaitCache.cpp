@@ -0,0 +1,249 @@
+#include <dwl/simulation/PeriodicGaitCache.h>
+
+
+namespace dwl
+{
+
+namespace simulation
+{
+
+/** @brief Adds a value to a FNV-1a hash */
+static void hashValue(uint64_t& hash,
+					  uint32_t value)
+{
+	for (unsigned int b = 0; b < sizeof(value); b++) {
+		hash ^= (unsigned char) (value >> (8 * b));
+		hash *= 1099511628211ULL;
+	}
+}
+
+
+/** @brief Quantizes a value by a resolution */
+static uint32_t quantize(double value,
+						 double resolution)
+{
+	return (uint32_t) (int32_t) floor(value / resolution + 0.5);
+}
+
+
+void alignTrajectory(ReducedBodyTrajectory& trajectory,
+					 const ReducedBodyState& state)
+{
+	if (trajectory.empty())
+		return;
+
+	// Computing the transformation of the first state
+	double yaw_shift = state.angular_pos(rbd::Z) - trajectory[0].angular_pos(rbd::Z);
+	Eigen::Vector3d first_pos = trajectory[0].com_pos;
+	double first_time = trajectory[0].time;
+	Eigen::Matrix3d rot =
+			Eigen::AngleAxisd(yaw_shift, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+
+	// Moving every state, where the CoM, CoP and support quantities are expressed in the
+	// world frame
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		ReducedBodyState& point = trajectory[k];
+		point.com_pos = state.com_pos + rot * (point.com_pos - first_pos);
+		point.cop = state.com_pos + rot * (point.cop - first_pos);
+		for (rbd::BodyVector3d::iterator it = point.support_region.begin();
+				it != point.support_region.end(); it++)
+			it->second = state.com_pos + rot * (it->second - first_pos);
+		point.com_vel = rot * point.com_vel;
+		point.com_acc = rot * point.com_acc;
+		point.angular_vel = rot * point.angular_vel;
+		point.angular_acc = rot * point.angular_acc;
+		point.angular_pos(rbd::Z) += yaw_shift;
+		point.time += state.time - first_time;
+	}
+}
+
+
+PeriodicGaitCache::PeriodicGaitCache(unsigned int capacity) : capacity_(capacity),
+		linear_resolution_(0.05), angular_resolution_(0.05), position_tolerance_(0.01),
+		velocity_tolerance_(0.05), use_counter_(0), num_hits_(0), num_misses_(0)
+{
+
+}
+
+
+PeriodicGaitCache::~PeriodicGaitCache()
+{
+
+}
+
+
+void PeriodicGaitCache::setCommandResolution(double linear_resolution,
+											 double angular_resolution)
+{
+	if (linear_resolution <= 0. || angular_resolution <= 0.) {
+		printf(YELLOW "Warning: the resolutions of the velocity commands have to be"
+				" positive\n" COLOR_RESET);
+		return;
+	}
+
+	// The keys of the cached cycles aren't valid for other resolutions
+	linear_resolution_ = linear_resolution;
+	angular_resolution_ = angular_resolution;
+	clear();
+}
+
+
+void PeriodicGaitCache::setStateTolerance(double position_tolerance,
+										  double velocity_tolerance)
+{
+	position_tolerance_ = position_tolerance;
+	velocity_tolerance_ = velocity_tolerance;
+}
+
+
+uint64_t PeriodicGaitCache::computeKey(const VelocityCommand& command,
+									   const PreviewSchedule& schedule) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	hashValue(hash, quantize(command.linear(rbd::X), linear_resolution_));
+	hashValue(hash, quantize(command.linear(rbd::Y), linear_resolution_));
+	hashValue(hash, quantize(command.angular, angular_resolution_));
+
+	// Hashing the gait schedule, i.e. the type and swing feet of every phase and the actual
+	// phase, since the cycle starts in it
+	hashValue(hash, schedule.schedule.size());
+	hashValue(hash, schedule.actual_phase_);
+	for (unsigned int p = 0; p < schedule.schedule.size(); p++) {
+		const PreviewPhase& phase = schedule.schedule[p];
+		hashValue(hash, phase.type);
+		hashValue(hash, phase.feet.size());
+		for (unsigned int f = 0; f < phase.feet.size(); f++) {
+			const std::string& name = phase.feet[f];
+			for (unsigned int c = 0; c < name.size(); c++)
+				hashValue(hash, (unsigned char) name[c]);
+		}
+	}
+
+	return hash;
+}
+
+
+void PeriodicGaitCache::add(const VelocityCommand& command,
+							const PreviewSchedule& schedule,
+							const ReducedBodyState& state,
+							const PreviewControl& control,
+							const ReducedBodyTrajectory& rollout)
+{
+	uint64_t key = computeKey(command, schedule);
+	if (capacity_ != 0 && entries_.size() >= capacity_ && entries_.count(key) == 0)
+		removeLeastRecentlyUsed();
+
+	Entry& entry = entries_[key];
+	entry.state = PreviewState(state);
+	entry.control = control;
+	entry.rollout = rollout;
+	entry.last_use = ++use_counter_;
+}
+
+
+bool PeriodicGaitCache::lookup(PreviewControl& control,
+							   const VelocityCommand& command,
+							   const PreviewSchedule& schedule)
+{
+	Entry* entry = find(command, schedule);
+	if (entry == NULL) {
+		num_misses_++;
+		return false;
+	}
+
+	control = entry->control;
+	entry->last_use = ++use_counter_;
+	num_hits_++;
+	return true;
+}
+
+
+bool PeriodicGaitCache::lookupCycle(PreviewControl& control,
+									ReducedBodyTrajectory& rollout,
+									const VelocityCommand& command,
+									const PreviewSchedule& schedule,
+									const ReducedBodyState& state)
+{
+	Entry* entry = find(command, schedule);
+	if (entry == NULL || !isNearState(PreviewState(state), entry->state)) {
+		num_misses_++;
+		return false;
+	}
+
+	control = entry->control;
+	rollout = entry->rollout;
+	alignTrajectory(rollout, state);
+	entry->last_use = ++use_counter_;
+	num_hits_++;
+	return true;
+}
+
+
+void PeriodicGaitCache::clear()
+{
+	entries_.clear();
+}
+
+
+unsigned int PeriodicGaitCache::size() const
+{
+	return entries_.size();
+}
+
+
+unsigned int PeriodicGaitCache::getNumberOfHits() const
+{
+	return num_hits_;
+}
+
+
+unsigned int PeriodicGaitCache::getNumberOfMisses() const
+{
+	return num_misses_;
+}
+
+
+PeriodicGaitCache::Entry* PeriodicGaitCache::find(const VelocityCommand& command,
+												  const PreviewSchedule& schedule)
+{
+	std::unordered_map<uint64_t, Entry>::iterator it =
+			entries_.find(computeKey(command, schedule));
+	if (it == entries_.end())
+		return NULL;
+
+	return &it->second;
+}
+
+
+bool PeriodicGaitCache::isNearState(const PreviewState& state,
+									const PreviewState& start_state) const
+{
+	// The cycle starts with a given support, so it isn't valid for other ones
+	if (state.support.size() != start_state.support.size())
+		return false;
+	for (SupportIterator it = state.support.begin(); it != state.support.end(); it++) {
+		if (start_state.support.count(it->first) == 0)
+			return false;
+	}
+
+	return fabs(state.height - start_state.height) <= position_tolerance_ &&
+			(state.com_pos - start_state.com_pos).norm() <= position_tolerance_ &&
+			(state.com_vel - start_state.com_vel).norm() <= velocity_tolerance_;
+}
+
+
+void PeriodicGaitCache::removeLeastRecentlyUsed()
+{
+	std::unordered_map<uint64_t, Entry>::iterator oldest = entries_.end();
+	for (std::unordered_map<uint64_t, Entry>::iterator it = entries_.begin();
+			it != entries_.end(); it++) {
+		if (oldest == entries_.end() || it->second.last_use < oldest->second.last_use)
+			oldest = it;
+	}
+
+	if (oldest != entries_.end())
+		entries_.erase(oldest);
+}
+
+} //@namespace simulation
+} //@namespace dwl
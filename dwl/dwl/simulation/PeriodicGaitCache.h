@@ -0,0 +1,185 @@
+#ifndef DWL__SIMULATION__PERIODIC_GAIT_CACHE__H
+#define DWL__SIMULATION__PERIODIC_GAIT_CACHE__H
+
+#include <dwl/simulation/PreviewLocomotion.h>
+#include <unordered_map>
+#include <stdint.h>
+
+
+namespace dwl
+{
+
+namespace simulation
+{
+
+/**
+ * @brief Aligns a reduced-body trajectory to a reduced-body state, i.e. it's moved (position
+ * and yaw) and in time so its first state has the CoM position, yaw and time of the given
+ * state. The foot quantities are expressed in the CoM frame, so they aren't changed
+ * @param ReducedBodyTrajectory& Reduced-body trajectory
+ * @param const ReducedBodyState& Reduced-body state
+ */
+void alignTrajectory(ReducedBodyTrajectory& trajectory,
+					 const ReducedBodyState& state);
+
+/**
+ * @class PeriodicGaitCache
+ * @brief Cache of converged periodic preview controls and their rollouts. Under a constant
+ * velocity command, the preview solution of a gait is the same cycle after cycle, so it's
+ * stored with the quantized command and the gait schedule (phases and actual phase). A
+ * cached control warm-starts the optimization of the same key (e.g. the initial mean of
+ * CMA-ES, see ocp::PreviewOptimization::setStartingPreviewControl), and it's reused without
+ * optimization if the actual state is near the start state of the cycle. The start states are
+ * compared as preview states, i.e. in the horizontal frame and relative to the CoP, so a cycle
+ * is reused in different places and headings. The cache has a maximum number of cycles, where
+ * the least recently used cycle is removed first
+ */
+class PeriodicGaitCache
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param unsigned int Maximum number of cycles (0 for unbounded)
+		 */
+		PeriodicGaitCache(unsigned int capacity = 0);
+
+		/** @brief Destructor function */
+		~PeriodicGaitCache();
+
+		/**
+		 * @brief Sets the quantization of the velocity commands, i.e. the commands of the same
+		 * cell share a cycle. The default values are 0.05 m/s and 0.05 rad/s
+		 * @param double Resolution of the linear velocities
+		 * @param double Resolution of the angular velocity
+		 */
+		void setCommandResolution(double linear_resolution,
+								  double angular_resolution);
+
+		/**
+		 * @brief Sets the tolerances of a state near the start state of a cycle. The default
+		 * values are 0.01 m and 0.05 m/s
+		 * @param double Tolerance of the CoM height and position (relative to the CoP)
+		 * @param double Tolerance of the CoM velocity
+		 */
+		void setStateTolerance(double position_tolerance,
+							   double velocity_tolerance);
+
+		/**
+		 * @brief Computes the key of a velocity command and a gait schedule
+		 * @param const VelocityCommand& Velocity command
+		 * @param const PreviewSchedule& Gait schedule
+		 * @return The key of the cycle
+		 */
+		uint64_t computeKey(const VelocityCommand& command,
+							const PreviewSchedule& schedule) const;
+
+		/**
+		 * @brief Adds a converged periodic cycle, where a cycle of the same key is replaced
+		 * @param const VelocityCommand& Velocity command
+		 * @param const PreviewSchedule& Gait schedule
+		 * @param const ReducedBodyState& Start state of the cycle
+		 * @param const PreviewControl& Converged preview control
+		 * @param const ReducedBodyTrajectory& Rollout of the preview control
+		 */
+		void add(const VelocityCommand& command,
+				 const PreviewSchedule& schedule,
+				 const ReducedBodyState& state,
+				 const PreviewControl& control,
+				 const ReducedBodyTrajectory& rollout);
+
+		/**
+		 * @brief Retrieves the cached control of a command and gait schedule, e.g. as the
+		 * initial mean of the optimization
+		 * @param PreviewControl& Cached preview control
+		 * @param const VelocityCommand& Velocity command
+		 * @param const PreviewSchedule& Gait schedule
+		 * @return False if there isn't a cached cycle
+		 */
+		bool lookup(PreviewControl& control,
+					const VelocityCommand& command,
+					const PreviewSchedule& schedule);
+
+		/**
+		 * @brief Retrieves the cached cycle of a command and gait schedule if the actual state
+		 * is near its start state, i.e. the fast path that skips the optimization. The rollout
+		 * is aligned to the actual state
+		 * @param PreviewControl& Cached preview control
+		 * @param ReducedBodyTrajectory& Cached rollout, aligned to the actual state
+		 * @param const VelocityCommand& Velocity command
+		 * @param const PreviewSchedule& Gait schedule
+		 * @param const ReducedBodyState& Actual state
+		 * @return False if there isn't a cached cycle or the state isn't near it
+		 */
+		bool lookupCycle(PreviewControl& control,
+						 ReducedBodyTrajectory& rollout,
+						 const VelocityCommand& command,
+						 const PreviewSchedule& schedule,
+						 const ReducedBodyState& state);
+
+		/** @brief Removes all the cycles */
+		void clear();
+
+		/** @brief Gets the number of cached cycles */
+		unsigned int size() const;
+
+		/** @brief Gets the number of successful and failed lookups */
+		unsigned int getNumberOfHits() const;
+		unsigned int getNumberOfMisses() const;
+
+
+	private:
+		/** @brief Cached cycle, and the last time (i.e. counter) it was used */
+		struct Entry
+		{
+			PreviewState state;
+			PreviewControl control;
+			ReducedBodyTrajectory rollout;
+			uint64_t last_use;
+		};
+
+		/**
+		 * @brief Finds the cycle of a command and gait schedule
+		 * @param const VelocityCommand& Velocity command
+		 * @param const PreviewSchedule& Gait schedule
+		 * @return Pointer of the entry (NULL if there isn't any)
+		 */
+		Entry* find(const VelocityCommand& command,
+					const PreviewSchedule& schedule);
+
+		/**
+		 * @brief Indicates if a preview state is near the start state of a cycle
+		 * @param const PreviewState& Preview state
+		 * @param const PreviewState& Start state of the cycle
+		 */
+		bool isNearState(const PreviewState& state,
+						 const PreviewState& start_state) const;
+
+		/** @brief Removes the least recently used cycle */
+		void removeLeastRecentlyUsed();
+
+		/** @brief Cached cycles per key */
+		std::unordered_map<uint64_t, Entry> entries_;
+
+		/** @brief Maximum number of cycles */
+		unsigned int capacity_;
+
+		/** @brief Resolutions of the velocity commands */
+		double linear_resolution_;
+		double angular_resolution_;
+
+		/** @brief Tolerances of the start states */
+		double position_tolerance_;
+		double velocity_tolerance_;
+
+		/** @brief Counter of the uses of the cycles */
+		uint64_t use_counter_;
+
+		/** @brief Number of successful and failed lookups */
+		unsigned int num_hits_;
+		unsigned int num_misses_;
+};
+
+} //@namespace simulation
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,362 @@
+#include <dwl/simulation/PlanValidation.h>
+#include <dwl/utils/Geometry.h>
+#include <dwl/utils/TaskScheduler.h>
+#include <random>
+#include <limits>
+
+
+namespace dwl
+{
+
+namespace simulation
+{
+
+PlanValidation::PlanValidation() : simulation_(NULL), force_threshold_(1.)
+{
+
+}
+
+
+PlanValidation::~PlanValidation()
+{
+
+}
+
+
+void PlanValidation::reset(WholeBodySimulation* simulation)
+{
+	simulation_ = simulation;
+}
+
+
+void PlanValidation::setPerturbation(const RolloutPerturbation& perturbation)
+{
+	perturbation_ = perturbation;
+}
+
+
+void PlanValidation::setPreviewPerturbation(const PreviewPerturbation& perturbation)
+{
+	preview_perturbation_ = perturbation;
+}
+
+
+void PlanValidation::setForceThreshold(double force_threshold)
+{
+	force_threshold_ = force_threshold;
+}
+
+
+bool PlanValidation::validate(std::vector<RolloutStatistics>& statistics,
+							  const WholeBodyTrajectory& plan,
+							  unsigned int num_rollouts,
+							  unsigned int num_threads,
+							  unsigned int seed)
+{
+	if (simulation_ == NULL) {
+		printf(RED "FATAL: the whole-body simulation wasn't reset\n" COLOR_RESET);
+		return false;
+	}
+
+	if (plan.size() == 0) {
+		printf(YELLOW "Warning: there isn't a plan to validate\n" COLOR_RESET);
+		return false;
+	}
+
+	// Perturbing the initial state of every rollout. Note that every rollout has its own
+	// seed, so the perturbations don't depend on the number of threads
+	references_.assign(num_rollouts, plan);
+	for (unsigned int r = 0; r < num_rollouts; r++) {
+		std::mt19937 generator(seed + r);
+		std::normal_distribution<double> normal(0., 1.);
+		WholeBodyState& state = references_[r][0];
+		for (unsigned int i = 0; i < 6; i++) {
+			state.base_pos(i) += perturbation_.base_pos * normal(generator);
+			state.base_vel(i) += perturbation_.base_vel * normal(generator);
+		}
+		for (unsigned int j = 0; j < state.joint_pos.size(); j++)
+			state.joint_pos(j) += perturbation_.joint_pos * normal(generator);
+		for (unsigned int j = 0; j < state.joint_vel.size(); j++)
+			state.joint_vel(j) += perturbation_.joint_vel * normal(generator);
+	}
+
+	// Simulating the rollouts in parallel
+	simulation_->simulate(trajectories_, references_, num_threads);
+
+	// Computing the statistics against the nominal plan
+	statistics.resize(num_rollouts);
+	for (unsigned int r = 0; r < num_rollouts; r++)
+		computeStatistics(statistics[r], trajectories_[r], plan);
+
+	return true;
+}
+
+
+bool PlanValidation::validate(std::vector<RolloutStatistics>& statistics,
+							  const std::vector<WholeBodyTrajectory>& plans,
+							  unsigned int num_threads)
+{
+	if (simulation_ == NULL) {
+		printf(RED "FATAL: the whole-body simulation wasn't reset\n" COLOR_RESET);
+		return false;
+	}
+
+	// Simulating the plan variants in parallel
+	simulation_->simulate(trajectories_, plans, num_threads);
+
+	statistics.resize(plans.size());
+	for (unsigned int r = 0; r < plans.size(); r++)
+		computeStatistics(statistics[r], trajectories_[r], plans[r]);
+
+	return true;
+}
+
+
+bool PlanValidation::validatePreview(std::vector<RolloutStatistics>& statistics,
+									 const PreviewLocomotion& preview,
+									 const ReducedBodyState& state,
+									 const PreviewControl& control,
+									 unsigned int num_rollouts,
+									 unsigned int num_threads,
+									 unsigned int seed)
+{
+	if (control.params.size() == 0) {
+		printf(YELLOW "Warning: there isn't a preview control to validate\n" COLOR_RESET);
+		return false;
+	}
+
+	statistics.resize(num_rollouts);
+	if (num_rollouts == 0)
+		return true;
+
+	// Perturbing the CoM state of every rollout. Note that every rollout has its own seed,
+	// which is also the seed of its terrain noise, so the perturbations don't depend on the
+	// number of threads
+	std::vector<ReducedBodyState> initial_states(num_rollouts, state);
+	for (unsigned int r = 0; r < num_rollouts; r++) {
+		std::mt19937 generator(seed + r);
+		std::normal_distribution<double> normal(0., 1.);
+		ReducedBodyState& initial_state = initial_states[r];
+		for (unsigned int i = 0; i < 3; i++) {
+			initial_state.com_pos(i) += preview_perturbation_.com_pos * normal(generator);
+			initial_state.com_vel(i) += preview_perturbation_.com_vel * normal(generator);
+		}
+	}
+
+	// Getting the number of threads, which cannot be bigger than the number of rollouts
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::min(num_threads, num_rollouts);
+
+	// Creating the thread-local copies of the preview, which modifies its internal buffers
+	std::vector<PreviewLocomotion> thread_previews(num_threads, preview);
+
+	// Computing the nominal preview, i.e. without perturbations
+	ReducedBodyTrajectory nominal;
+	thread_previews[0].setFootholdHeightNoise(0.);
+	thread_previews[0].multiPhasePreview(nominal, state, control);
+
+	// Previewing a contiguous chunk of rollouts with a given preview
+	auto previewRollouts = [&](PreviewLocomotion& thread_preview,
+							   unsigned int first, unsigned int last) {
+		ReducedBodyTrajectory trajectory;
+		for (unsigned int r = first; r < last; r++) {
+			thread_preview.setFootholdHeightNoise(preview_perturbation_.terrain_height,
+												  seed + r);
+			thread_preview.multiPhasePreview(trajectory, initial_states[r], control);
+			computeStatistics(statistics[r], trajectory, nominal);
+		}
+	};
+
+	// Note that the chunks are previewed by the task scheduler
+	unsigned int chunk_size = (num_rollouts + num_threads - 1) / num_threads;
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_rollouts);
+		unsigned int last = std::min(first + chunk_size, num_rollouts);
+		previewRollouts(thread_previews[t], first, last);
+	});
+
+	return true;
+}
+
+
+void PlanValidation::computeStatistics(RolloutStatistics& statistics,
+									   const ReducedBodyTrajectory& trajectory,
+									   const ReducedBodyTrajectory& nominal) const
+{
+	statistics = RolloutStatistics();
+	if (trajectory.size() == 0)
+		return;
+
+	// Computing the CoP margins, where the flight phases are skipped
+	double margin_sum = 0.;
+	unsigned int num_margins = 0;
+	statistics.min_cop_margin = std::numeric_limits<double>::max();
+	math::ConvexHull support;
+	for (unsigned int k = 1; k < trajectory.size(); k++) {
+		double margin;
+		if (computeCoPMargin(margin, support, trajectory[k])) {
+			statistics.min_cop_margin = std::min(statistics.min_cop_margin, margin);
+			margin_sum += margin;
+			num_margins++;
+		}
+	}
+
+	if (num_margins == 0)
+		statistics.min_cop_margin = 0.;
+	else
+		statistics.mean_cop_margin = margin_sum / num_margins;
+
+	// Computing the CoM position error at the end of the nominal preview
+	if (nominal.size() != 0)
+		statistics.final_base_error =
+				(trajectory.back().com_pos - nominal.back().com_pos).norm();
+}
+
+
+double
+PlanValidation::computeViolationProbability(const std::vector<RolloutStatistics>& statistics,
+											double min_cop_margin) const
+{
+	if (statistics.size() == 0)
+		return 0.;
+
+	unsigned int num_violations = 0;
+	for (unsigned int r = 0; r < statistics.size(); r++) {
+		if (statistics[r].min_cop_margin < min_cop_margin)
+			num_violations++;
+	}
+
+	return (double) num_violations / statistics.size();
+}
+
+
+void PlanValidation::computeStatistics(RolloutStatistics& statistics,
+									   const WholeBodyTrajectory& trajectory,
+									   const WholeBodyTrajectory& plan) const
+{
+	statistics = RolloutStatistics();
+	if (trajectory.size() == 0)
+		return;
+
+	// Position of every end-effector when its contact was made
+	rbd::BodyVector3d touchdown_pos;
+
+	double margin_sum = 0.;
+	unsigned int num_margins = 0;
+	statistics.min_cop_margin = std::numeric_limits<double>::max();
+	math::ConvexHull support;
+	for (unsigned int k = 1; k < trajectory.size(); k++) {
+		const WholeBodyState& state = trajectory[k];
+
+		// Computing the CoP margin, where the flight phases are skipped
+		double margin;
+		if (computeCoPMargin(margin, support, state)) {
+			statistics.min_cop_margin = std::min(statistics.min_cop_margin, margin);
+			margin_sum += margin;
+			num_margins++;
+		}
+
+		// Computing the slippage of the active contacts
+		for (rbd::BodyVector6d::const_iterator eff_it = state.contact_eff.begin();
+				eff_it != state.contact_eff.end(); eff_it++) {
+			const std::string& name = eff_it->first;
+			Eigen::Vector3d force_W =
+					frame_tf_.fromBaseToWorldFrame((Eigen::Vector3d) eff_it->second.segment<3>(rbd::LX),
+												   state.getBaseRPY());
+			if (force_W(rbd::Z) < force_threshold_) {
+				touchdown_pos.erase(name);
+				continue;
+			}
+
+			Eigen::Vector3d pos_W = state.getContactPosition_W(name);
+			rbd::BodyVector3d::iterator touchdown_it = touchdown_pos.find(name);
+			if (touchdown_it == touchdown_pos.end()) {
+				touchdown_pos[name] = pos_W;
+				continue;
+			}
+
+			double slippage = (pos_W - touchdown_it->second).head<2>().norm();
+			statistics.max_slippage = std::max(statistics.max_slippage, slippage);
+		}
+	}
+
+	if (num_margins == 0)
+		statistics.min_cop_margin = 0.;
+	else
+		statistics.mean_cop_margin = margin_sum / num_margins;
+
+	// Computing the base position error at the end of the plan
+	statistics.final_base_error =
+			(trajectory.back().getBasePosition() - plan.back().getBasePosition()).norm();
+}
+
+
+RolloutStatistics
+PlanValidation::computeWorstCase(const std::vector<RolloutStatistics>& statistics) const
+{
+	RolloutStatistics worst_case;
+	if (statistics.size() == 0)
+		return worst_case;
+
+	worst_case = statistics[0];
+	for (unsigned int r = 1; r < statistics.size(); r++) {
+		const RolloutStatistics& stat = statistics[r];
+		worst_case.min_cop_margin = std::min(worst_case.min_cop_margin, stat.min_cop_margin);
+		worst_case.mean_cop_margin = std::min(worst_case.mean_cop_margin, stat.mean_cop_margin);
+		worst_case.max_slippage = std::max(worst_case.max_slippage, stat.max_slippage);
+		worst_case.final_base_error = std::max(worst_case.final_base_error,
+											   stat.final_base_error);
+	}
+
+	return worst_case;
+}
+
+
+const std::vector<WholeBodyTrajectory>& PlanValidation::getTrajectories() const
+{
+	return trajectories_;
+}
+
+
+bool PlanValidation::computeCoPMargin(double& margin,
+									  math::ConvexHull& support,
+									  const WholeBodyState& state) const
+{
+	// Getting the active contacts and computing the CoP on the ground
+	rbd::BodyVector3d contact_pos;
+	Eigen::Vector3d cop_pos = Eigen::Vector3d::Zero();
+	double normal_sum = 0.;
+	for (rbd::BodyVector6d::const_iterator eff_it = state.contact_eff.begin();
+			eff_it != state.contact_eff.end(); eff_it++) {
+		Eigen::Vector3d force_W =
+				frame_tf_.fromBaseToWorldFrame((Eigen::Vector3d) eff_it->second.segment<3>(rbd::LX),
+											   state.getBaseRPY());
+		if (force_W(rbd::Z) < force_threshold_)
+			continue;
+
+		Eigen::Vector3d pos_W = state.getContactPosition_W(eff_it->first);
+		contact_pos[eff_it->first] = pos_W;
+		cop_pos += force_W(rbd::Z) * pos_W;
+		normal_sum += force_W(rbd::Z);
+	}
+
+	support.setPoints(contact_pos);
+	if (contact_pos.size() == 0)
+		return false;
+	cop_pos /= normal_sum;
+
+	return support.computeMargin(margin, cop_pos);
+}
+
+
+bool PlanValidation::computeCoPMargin(double& margin,
+									  math::ConvexHull& support,
+									  const ReducedBodyState& state) const
+{
+	support.setPoints(state.support_region);
+	return support.computeMargin(margin, state.getCoPPosition_W());
+}
+
+} //@namespace simulation
+} //@namespace dwl
@@ -0,0 +1,247 @@
+#ifndef DWL__SIMULATION__PLAN_VALIDATION__H
+#define DWL__SIMULATION__PLAN_VALIDATION__H
+
+#include <dwl/simulation/WholeBodySimulation.h>
+#include <dwl/simulation/PreviewLocomotion.h>
+#include <dwl/utils/ConvexHull.h>
+
+
+namespace dwl
+{
+
+namespace simulation
+{
+
+/**
+ * @brief Defines the standard deviations of the Gaussian perturbations of the initial state
+ * of a rollout
+ */
+struct RolloutPerturbation
+{
+	RolloutPerturbation() : base_pos(0.), base_vel(0.), joint_pos(0.), joint_vel(0.) {}
+	RolloutPerturbation(double _base_pos,
+						double _base_vel,
+						double _joint_pos,
+						double _joint_vel) : base_pos(_base_pos), base_vel(_base_vel),
+								joint_pos(_joint_pos), joint_vel(_joint_vel) {}
+
+	double base_pos;
+	double base_vel;
+	double joint_pos;
+	double joint_vel;
+};
+
+/**
+ * @brief Defines the standard deviations of the Gaussian perturbations of a preview rollout,
+ * i.e. of the CoM state of its initial state and of the terrain height of its footholds
+ */
+struct PreviewPerturbation
+{
+	PreviewPerturbation() : com_pos(0.), com_vel(0.), terrain_height(0.) {}
+	PreviewPerturbation(double _com_pos,
+						double _com_vel,
+						double _terrain_height) : com_pos(_com_pos), com_vel(_com_vel),
+								terrain_height(_terrain_height) {}
+
+	double com_pos;
+	double com_vel;
+	double terrain_height;
+};
+
+/**
+ * @brief Defines the robustness statistics of a rollout. The CoP margin is the signed distance
+ * of the CoP to the support polygon (negative outside or with less than three contacts), and
+ * the slippage is the horizontal displacement of an end-effector while it's in contact
+ */
+struct RolloutStatistics
+{
+	RolloutStatistics() : min_cop_margin(0.), mean_cop_margin(0.), max_slippage(0.),
+			final_base_error(0.) {}
+
+	double min_cop_margin;
+	double mean_cop_margin;
+	double max_slippage;
+	double final_base_error;
+};
+
+/**
+ * @class PlanValidation
+ * @brief Validates a plan (e.g. from the trajectory optimization or the preview locomotion)
+ * by rolling out Monte-Carlo perturbations of its initial state, or a set of plan variants,
+ * with the whole-body simulation. The rollouts are simulated in parallel (see
+ * WholeBodySimulation::simulate), and the robustness statistics are computed from the
+ * simulated knots. The preview controls are validated in the same way with perturbed preview
+ * rollouts (see validatePreview). The perturbations are drawn with a seed per rollout, so the
+ * results don't depend on the number of threads
+ */
+class PlanValidation
+{
+	public:
+		/** @brief Constructor function */
+		PlanValidation();
+
+		/** @brief Destructor function */
+		~PlanValidation();
+
+		/**
+		 * @brief Resets the whole-body simulation
+		 * @param WholeBodySimulation* Whole-body simulation
+		 */
+		void reset(WholeBodySimulation* simulation);
+
+		/**
+		 * @brief Sets the perturbation of the initial state
+		 * @param const RolloutPerturbation& Perturbation
+		 */
+		void setPerturbation(const RolloutPerturbation& perturbation);
+
+		/**
+		 * @brief Sets the perturbation of the preview rollouts
+		 * @param const PreviewPerturbation& Perturbation
+		 */
+		void setPreviewPerturbation(const PreviewPerturbation& perturbation);
+
+		/**
+		 * @brief Sets the normal force threshold for detecting the active contacts
+		 * @param double Force threshold
+		 */
+		void setForceThreshold(double force_threshold);
+
+		/**
+		 * @brief Validates a plan with a number of perturbed rollouts
+		 * @param std::vector<RolloutStatistics>& Statistics of every rollout
+		 * @param const WholeBodyTrajectory& Plan
+		 * @param unsigned int Number of rollouts
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 * @param unsigned int Seed of the first rollout
+		 * @return bool False if it couldn't be validated
+		 */
+		bool validate(std::vector<RolloutStatistics>& statistics,
+					  const WholeBodyTrajectory& plan,
+					  unsigned int num_rollouts,
+					  unsigned int num_threads = 1,
+					  unsigned int seed = 0);
+
+		/**
+		 * @brief Validates a set of plan variants, where every variant is a rollout
+		 * @param std::vector<RolloutStatistics>& Statistics of every rollout
+		 * @param const std::vector<WholeBodyTrajectory>& Plans
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 * @return bool False if it couldn't be validated
+		 */
+		bool validate(std::vector<RolloutStatistics>& statistics,
+					  const std::vector<WholeBodyTrajectory>& plans,
+					  unsigned int num_threads = 1);
+
+		/**
+		 * @brief Validates a preview control with a number of perturbed preview rollouts. The
+		 * previews are computed in parallel, where every thread has its own copy of the preview
+		 * locomotion. The final base error is the CoM error w.r.t. the nominal preview, and
+		 * there isn't slippage since the footholds of the preview are fixed
+		 * @param std::vector<RolloutStatistics>& Statistics of every rollout
+		 * @param const PreviewLocomotion& Preview locomotion
+		 * @param const ReducedBodyState& Initial reduced-body state
+		 * @param const PreviewControl& Preview control
+		 * @param unsigned int Number of rollouts
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 * @param unsigned int Seed of the first rollout
+		 * @return bool False if it couldn't be validated
+		 */
+		bool validatePreview(std::vector<RolloutStatistics>& statistics,
+							 const PreviewLocomotion& preview,
+							 const ReducedBodyState& state,
+							 const PreviewControl& control,
+							 unsigned int num_rollouts,
+							 unsigned int num_threads = 1,
+							 unsigned int seed = 0);
+
+		/**
+		 * @brief Computes the robustness statistics of a preview trajectory
+		 * @param RolloutStatistics& Statistics
+		 * @param const ReducedBodyTrajectory& Preview trajectory
+		 * @param const ReducedBodyTrajectory& Nominal preview trajectory
+		 */
+		void computeStatistics(RolloutStatistics& statistics,
+							   const ReducedBodyTrajectory& trajectory,
+							   const ReducedBodyTrajectory& nominal) const;
+
+		/**
+		 * @brief Computes the probability of violating a CoP margin, i.e. the fraction of the
+		 * rollouts whose minimum CoP margin is smaller than it
+		 * @param const std::vector<RolloutStatistics>& Statistics of every rollout
+		 * @param double Minimum CoP margin
+		 * @return The probability of violation
+		 */
+		double computeViolationProbability(const std::vector<RolloutStatistics>& statistics,
+										   double min_cop_margin = 0.) const;
+
+		/**
+		 * @brief Computes the robustness statistics of a simulated trajectory
+		 * @param RolloutStatistics& Statistics
+		 * @param const WholeBodyTrajectory& Simulated trajectory
+		 * @param const WholeBodyTrajectory& Plan
+		 */
+		void computeStatistics(RolloutStatistics& statistics,
+							   const WholeBodyTrajectory& trajectory,
+							   const WholeBodyTrajectory& plan) const;
+
+		/**
+		 * @brief Computes the worst case of a set of statistics, i.e. the minimum CoP margins
+		 * and the maximum slippage and final base error
+		 * @param const std::vector<RolloutStatistics>& Statistics of every rollout
+		 * @return The worst-case statistics
+		 */
+		RolloutStatistics computeWorstCase(const std::vector<RolloutStatistics>& statistics) const;
+
+		/** @brief Gets the simulated trajectories of the last validation */
+		const std::vector<WholeBodyTrajectory>& getTrajectories() const;
+
+
+	private:
+		/**
+		 * @brief Computes the CoP margin of a state
+		 * @param double& CoP margin
+		 * @param math::ConvexHull& Support polygon, which is updated with the active contacts
+		 * @param const WholeBodyState& Whole-body state
+		 * @return bool False if there isn't any active contact
+		 */
+		bool computeCoPMargin(double& margin,
+							  math::ConvexHull& support,
+							  const WholeBodyState& state) const;
+
+		/**
+		 * @brief Computes the CoP margin of a reduced-body state. Note that the support polygon
+		 * is only updated with the changes of the support region, e.g. between phases
+		 * @param double& CoP margin
+		 * @param math::ConvexHull& Support polygon, which is updated with the support region
+		 * @param const ReducedBodyState& Reduced-body state
+		 * @return bool False if there isn't any support (i.e. a flight phase)
+		 */
+		bool computeCoPMargin(double& margin,
+							  math::ConvexHull& support,
+							  const ReducedBodyState& state) const;
+
+		/** @brief Whole-body simulation */
+		WholeBodySimulation* simulation_;
+
+		/** @brief Perturbation of the initial state */
+		RolloutPerturbation perturbation_;
+
+		/** @brief Perturbation of the preview rollouts */
+		PreviewPerturbation preview_perturbation_;
+
+		/** @brief Normal force threshold of the active contacts */
+		double force_threshold_;
+
+		/** @brief Perturbed plans and simulated trajectories */
+		std::vector<WholeBodyTrajectory> references_;
+		std::vector<WholeBodyTrajectory> trajectories_;
+
+		/** @brief Frame transformations */
+		math::FrameTF frame_tf_;
+};
+
+} //@namespace simulation
+} //@namespace dwl
+
+#endif
@@ -9,9 +9,9 @@ namespace simulation
 
 PreviewLocomotion::PreviewLocomotion() : robot_model_(false),
 		sample_time_(0.001), gravity_(9.81), mass_(0.), num_feet_(0),
-		step_height_(0.1)
+		step_height_(0.1), foothold_height_noise_(0.)
 {
-
+	cart_table_.setSampleTime(sample_time_);
 }
 
 
@@ -211,6 +211,7 @@ void PreviewLocomotion::readPreviewSequence(VelocityCommand& command,
 void PreviewLocomotion::setSampleTime(double sample_time)
 {
 	sample_time_ = sample_time;
+	cart_table_.setSampleTime(sample_time_);
 }
 
 
@@ -226,6 +227,14 @@ void PreviewLocomotion::setForceThreshold(double force_threshold)
 }
 
 
+void PreviewLocomotion::setFootholdHeightNoise(double std_dev,
+											   unsigned int seed)
+{
+	foothold_height_noise_ = std_dev;
+	foothold_generator_.seed(seed);
+}
+
+
 void PreviewLocomotion::multiPhasePreview(ReducedBodyTrajectory& trajectory,
 										  const ReducedBodyState& state,
 										  const PreviewControl& control,
@@ -243,24 +252,26 @@ void PreviewLocomotion::multiPhasePreview(ReducedBodyTrajectory& trajectory,
 	// Clearing the trajectory
 	trajectory.clear();
 
+	// Compiling the phases once, so the rollout indexes them directly
+	phase_table_.compile(control, feet_names_);
+
 	// Computing the preview for multi-phase
 	ReducedBodyState initial_state = state;
-	unsigned int num_phases = control.params.size();
+	unsigned int num_phases = phase_table_.getNumberPhases();
 	for (unsigned int k = 0; k < num_phases; ++k) {
 		ReducedBodyTrajectory phase_traj;
 
-		// Getting the preview params of the actual phase
-		const PreviewParams& preview_params = control.params[k];
-
 		// Computing the preview of the actual phase
-		if (preview_params.phase.type == STANCE) {
-			stancePreview(phase_traj, initial_state, preview_params, full);
+		if (phase_table_.types[k] == STANCE) {
+			computeStancePreview(phase_traj, initial_state, k, full);
 		} else {
-			flightPreview(phase_traj, initial_state, preview_params, full);
+			computeFlightPreview(phase_traj, initial_state, k, full);
 		}
 
-		// Appending the actual phase trajectory
-		trajectory.insert(trajectory.end(), phase_traj.begin(), phase_traj.end());
+		// Appending the actual phase trajectory, where its states are moved
+		trajectory.insert(trajectory.end(),
+						  std::make_move_iterator(phase_traj.begin()),
+						  std::make_move_iterator(phase_traj.end()));
 
 		// Sanity action: defining the actual state if there isn't a trajectory
 		if (trajectory.size() == 0)
@@ -276,9 +287,20 @@ void PreviewLocomotion::stancePreview(ReducedBodyTrajectory& trajectory,
 									  const ReducedBodyState& state,
 									  const PreviewParams& params,
 									  bool full)
+{
+	phase_table_.compile(params, feet_names_);
+	computeStancePreview(trajectory, state, 0, full);
+}
+
+
+void PreviewLocomotion::computeStancePreview(ReducedBodyTrajectory& trajectory,
+											 const ReducedBodyState& state,
+											 unsigned int phase,
+											 bool full)
 {
 	// Checking the preview duration
-	if (full && params.duration < sample_time_)
+	double duration = phase_table_.durations[phase];
+	if (full && duration < sample_time_)
 		return; // duration it's always positive, and makes sense when
 				// is bigger than the sample time
 
@@ -286,27 +308,25 @@ void PreviewLocomotion::stancePreview(ReducedBodyTrajectory& trajectory,
 	// remains constant during this phase
 	ReducedBodyState current_state = state;
 	for (unsigned int f = 0; f < num_feet_; ++f) {
-		std::string name = feet_names_[f];
-
 		// Removing the swing foot of the actual phase
-		if (params.phase.isSwingFoot(name))
-			current_state.support_region.erase(name);
+		if (phase_table_.isSwingFoot(phase, f))
+			current_state.support_region.erase(feet_names_[f]);
 	}
 
 	// Initialization of the Linear Controlled SLIP model
-	CartTableControlParams model_params(params.duration,
-										params.cop_shift);
+	CartTableControlParams model_params(duration,
+										(Eigen::Vector2d) phase_table_.cop_shifts.col(phase));
 	cart_table_.initResponse(current_state, model_params);
 
 	// Computing the number of samples and initial index
-	unsigned int num_samples = floor(params.duration / sample_time_);
+	unsigned int num_samples = floor(duration / sample_time_);
 	unsigned int idx;
 	if (full) {
 		idx = 0;
 		trajectory.resize(num_samples + 1);
 
 		// Initialization of the swing generator
-		initSwing(current_state, params);
+		initPhaseSwing(current_state, phase);
 	} else {
 		idx = num_samples;
 		trajectory.resize(2);
@@ -317,7 +337,7 @@ void PreviewLocomotion::stancePreview(ReducedBodyTrajectory& trajectory,
 	for (unsigned int k = idx; k < num_samples + 1; ++k) {
 		// Computing the current time of the preview trajectory
 		if (k == num_samples)
-			time = params.duration;
+			time = duration;
 		else
 			time = sample_time_ * (k + 1);
 		current_state.time = state.time + time;
@@ -337,36 +357,81 @@ void PreviewLocomotion::stancePreview(ReducedBodyTrajectory& trajectory,
 
 	// Adding the foothold target of the previous phase
 	trajectory[1] = trajectory[0];
-	for (unsigned int f = 0; f < num_feet_; ++f) {
-		std::string name = feet_names_[f];
-		if (params.phase.isSwingFoot(name)) {
-			Eigen::Vector3d stance_H =
-					stance_posture_H_.find(name)->second;
+	addFootholds(trajectory.back(), phase);
+}
 
-			// Getting the footshift control parameter
-			Eigen::Vector2d footshift_2d =
-					params.phase.getFootShift(name);
-			Eigen::Vector3d footshift_H(footshift_2d(rbd::X),
-										footshift_2d(rbd::Y),
-										0.);
 
-			// Computing the foothold position w.r.t. the world.
-			// Note that the footshift is always expressed in the
-			// horizontal frame
-			Eigen::Vector3d foothold =
-					trajectory.back().com_pos + stance_H + footshift_H;
+void PreviewLocomotion::multiPhaseSummaryPreview(ReducedBodyTrajectory& summary,
+												 const ReducedBodyState& state,
+												 const PreviewControl& control,
+												 unsigned int num_intermediates)
+{
+	// Checking that the robot model was initialized
+	if (!robot_model_) {
+		printf(RED "Error: the robot model was not initialized\n" COLOR_RESET);
+		return;
+	}
 
-			if (terrain_.isTerrainInformation()) {
-				// Adding the terrain height given the terrain
-				// height-map
-				Eigen::Vector2d foothold_2d = foothold.head<2>();
-				foothold(rbd::Z) = terrain_.getTerrainHeight(foothold_2d);
-			} else {
-				foothold(rbd::Z) = actual_state_.com_pos(rbd::Z) -
-					cart_table_.getPendulumHeight();
+	// Updating the actual state
+	actual_state_ = state;
+
+	// Resizing the summary, note that it doesn't release the memory of previous
+	// evaluations
+	unsigned int num_phases = control.params.size();
+	unsigned int phase_points = num_intermediates + 1;
+	summary.resize(num_phases * phase_points);
+
+	// Setting the gravity vector
+	Eigen::Vector3d gravity_vec = Eigen::Vector3d::Zero();
+	gravity_vec(rbd::Z) = -gravity_;
+
+	// Evaluating the closed-form response of every phase only at the intermediate
+	// points and at its terminal time. Note that the phases are compiled once
+	phase_table_.compile(control, feet_names_);
+	for (unsigned int k = 0; k < num_phases; ++k) {
+		double duration = phase_table_.durations[k];
+		const ReducedBodyState& initial_state =
+				(k == 0) ? state : summary[k * phase_points - 1];
+		unsigned int idx = k * phase_points;
+
+		if (phase_table_.types[k] == STANCE) {
+			// Removing the swing feet of the actual phase from the support region
+			summary_state_ = initial_state;
+			for (unsigned int f = 0; f < num_feet_; ++f) {
+				if (phase_table_.isSwingFoot(k, f))
+					summary_state_.support_region.erase(feet_names_[f]);
+			}
+
+			// Initialization of the Linear Controlled SLIP model
+			CartTableControlParams model_params(duration,
+												(Eigen::Vector2d) phase_table_.cop_shifts.col(k));
+			cart_table_.initResponse(summary_state_, model_params);
+
+			for (unsigned int i = 0; i < phase_points; ++i) {
+				ReducedBodyState& point = summary[idx + i];
+				point = summary_state_;
+				double time = duration * (i + 1) / phase_points;
+				cart_table_.computeResponse(point, summary_state_.time + time);
 			}
 
-			trajectory.back().support_region[name] = foothold;
+			// Adding the foothold target of the previous phase
+			addFootholds(summary[idx + num_intermediates], k);
+		} else {
+			// Computing the CoM motion according to the projectile EoM
+			double initial_time = initial_state.time;
+			Eigen::Vector3d initial_pos = initial_state.com_pos;
+			Eigen::Vector3d initial_vel = initial_state.com_vel;
+			for (unsigned int i = 0; i < phase_points; ++i) {
+				ReducedBodyState& point = summary[idx + i];
+				point = ReducedBodyState();
+
+				double time = duration * (i + 1) / phase_points;
+				point.time = initial_time + time;
+				point.com_pos = initial_pos + initial_vel * time +
+						0.5 * gravity_vec * time * time;
+				point.com_vel = initial_vel + gravity_vec * time;
+				point.com_acc = gravity_vec;
+			}
 		}
 	}
 }
@@ -376,9 +441,20 @@ void PreviewLocomotion::flightPreview(ReducedBodyTrajectory& trajectory,
 						   	   	   	  const ReducedBodyState& state,
 									  const PreviewParams& params,
 									  bool full)
+{
+	phase_table_.compile(params, feet_names_);
+	computeFlightPreview(trajectory, state, 0, full);
+}
+
+
+void PreviewLocomotion::computeFlightPreview(ReducedBodyTrajectory& trajectory,
+											 const ReducedBodyState& state,
+											 unsigned int phase,
+											 bool full)
 {
 	// Checking the preview duration
-	if (full && params.duration < sample_time_)
+	double duration = phase_table_.durations[phase];
+	if (full && duration < sample_time_)
 		return; // duration it's always positive, and makes sense when
 				// is bigger than the sample time
 
@@ -387,14 +463,14 @@ void PreviewLocomotion::flightPreview(ReducedBodyTrajectory& trajectory,
 	gravity_vec(rbd::Z) = -gravity_;
 
 	// Computing the number of samples and initial index
-	unsigned int num_samples = floor(params.duration / sample_time_);
+	unsigned int num_samples = floor(duration / sample_time_);
 	unsigned int idx;
 	if (full) {
 		idx = 0;
 		trajectory.resize(num_samples);
 
 		// Initialization of the swing generator
-		initSwing(state, params);
+		initPhaseSwing(state, phase);
 	} else {
 		idx = num_samples;
 		trajectory.resize(1);
@@ -405,7 +481,7 @@ void PreviewLocomotion::flightPreview(ReducedBodyTrajectory& trajectory,
 	for (unsigned int k = idx; k < num_samples + 1; ++k) {
 		// Computing the current time of the preview trajectory
 		if (k == num_samples)
-			time = params.duration;
+			time = duration;
 		else
 			time = sample_time_ * (k + 1);
 
@@ -431,25 +507,85 @@ void PreviewLocomotion::flightPreview(ReducedBodyTrajectory& trajectory,
 
 
 
+void PreviewLocomotion::addFootholds(ReducedBodyState& state,
+									 unsigned int phase)
+{
+	for (unsigned int f = 0; f < num_feet_; ++f) {
+		if (phase_table_.isSwingFoot(phase, f)) {
+			const std::string& name = feet_names_[f];
+			Eigen::Vector3d stance_H =
+					stance_posture_H_.find(name)->second;
+
+			// Getting the footshift control parameter
+			Eigen::Vector2d footshift_2d =
+					phase_table_.getFootShift(phase, f);
+			Eigen::Vector3d footshift_H(footshift_2d(rbd::X),
+										footshift_2d(rbd::Y),
+										0.);
+
+			// Computing the foothold position w.r.t. the world.
+			// Note that the footshift is always expressed in the
+			// horizontal frame
+			Eigen::Vector3d foothold =
+					state.com_pos + stance_H + footshift_H;
+
+			if (terrain_.isTerrainInformation()) {
+				// Adding the terrain height given the terrain
+				// height-map
+				Eigen::Vector2d foothold_2d = foothold.head<2>();
+				foothold(rbd::Z) = terrain_.getTerrainHeight(foothold_2d);
+			} else {
+				foothold(rbd::Z) = actual_state_.com_pos(rbd::Z) -
+					cart_table_.getPendulumHeight();
+			}
+
+			// Perturbing the terrain height of the foothold
+			if (foothold_height_noise_ > 0.) {
+				std::normal_distribution<double> noise(0., foothold_height_noise_);
+				foothold(rbd::Z) += noise(foothold_generator_);
+			}
+
+			state.support_region[name] = foothold;
+		}
+	}
+}
+
+
 void PreviewLocomotion::initSwing(const ReducedBodyState& state,
 								  const PreviewParams& params)
+{
+	phase_table_.compile(params, feet_names_);
+	initPhaseSwing(state, 0);
+}
+
+
+void PreviewLocomotion::initPhaseSwing(const ReducedBodyState& state,
+									   unsigned int phase)
 {
 	// Updating the phase state
 	phase_state_ = state;
+	double duration = phase_table_.durations[phase];
 
 	// Computing the terminal CoM state for getting the foothold position
 	ReducedBodyState terminal_state;
 	cart_table_.computeResponse(terminal_state,
-								state.time + params.duration);
+								state.time + duration);
+
+	// Getting the rotations of the terminal state once for all the feet
+	Eigen::Matrix3d H_rot_W = terminal_state.getHorizontalToWorldRotation().transpose();
+	Eigen::Matrix3d B_rot_H = terminal_state.getBaseToHorizontalRotation().transpose();
 
 	// Getting the swing shift per foot
 	rbd::BodyVector3d swing_shift_B;
-	for (unsigned int j = 0; j < params.phase.feet.size(); ++j) {
-		std::string name = params.phase.feet[j];
+	for (unsigned int f = 0; f < num_feet_; ++f) {
+		if (!phase_table_.isSwingFoot(phase, f))
+			continue;
+
+		const std::string& name = feet_names_[f];
 		Eigen::Vector3d stance_H = stance_posture_H_.find(name)->second;
 
 		// Getting the footshift control parameter
-		Eigen::Vector2d footshift_2d = params.phase.getFootShift(name);
+		Eigen::Vector2d footshift_2d = phase_table_.getFootShift(phase, f);
 		Eigen::Vector3d footshift_H(footshift_2d(rbd::X),
 									footshift_2d(rbd::Y),
 									0.);
@@ -466,8 +602,7 @@ void PreviewLocomotion::initSwing(const ReducedBodyState& state,
 		if (terrain_.isTerrainInformation()) {
 			// Getting the terminal CoM position in the horizontal frame
 			Eigen::Vector3d terminal_com_pos_H =
-					frame_tf_.fromWorldToHorizontalFrame(terminal_state.getCoMPosition(),
-														 terminal_state.getRPY());
+					H_rot_W * terminal_state.getCoMPosition();
 
 			// Adding the terrain height given the terrain height-map
 			Eigen::Vector2d foothold_2d = foothold.head<2>();
@@ -478,49 +613,87 @@ void PreviewLocomotion::initSwing(const ReducedBodyState& state,
 			Eigen::Vector3d height(0., 0., cart_table_.getPendulumHeight());
 			Eigen::Vector3d nominal_com_pos =
 					height + (terminal_state.com_pos - actual_state_.com_pos);
-			double nominal_com_height =
-					frame_tf_.fromWorldToHorizontalFrame(nominal_com_pos,
-														 terminal_state.getRPY())(rbd::Z);
+			double nominal_com_height = H_rot_W.row(rbd::Z).dot(nominal_com_pos);
 			footshift_H(rbd::Z) = -(nominal_com_height + stance_H(rbd::Z));
 		}
 
-		swing_shift_B[name] =
-				frame_tf_.fromHorizontalToBaseFrame(footshift_H,
-													terminal_state.getRPY());
+		swing_shift_B[name] = B_rot_H * footshift_H;
 	}
 
 	// Adding the swing pattern expressed in the CoM frame
-	swing_params_ = SwingParams(params.duration, swing_shift_B);
+	swing_params_ = SwingParams(duration, swing_shift_B);
 
-	// Generating the actual state for every feet
-	feet_spline_generator_.clear();
-	for (rbd::BodyVector3d::const_iterator foot_it = state.foot_pos.begin();
-			foot_it != state.foot_pos.end(); ++foot_it) {
+	// Generating the actual state for every feet, and recording the stance feet of the
+	// phase for the swing generation
+	rbd::BodyVector3d actual_pos_B, target_pos_B;
+	stance_feet_.clear();
+	for (rbd::BodyVector3d::const_iterator foot_it = phase_state_.foot_pos.begin();
+			foot_it != phase_state_.foot_pos.end(); ++foot_it) {
 		std::string name = foot_it->first;
 
 		// Checking the feet that swing
 		rbd::BodyVector3d::const_iterator swing_it = swing_params_.feet_shift.find(name);
-		if (swing_it != swing_params_.feet_shift.end()) {
+		if (swing_it == swing_params_.feet_shift.end())
+			stance_feet_.push_back(foot_it);
+		else {
 			// Getting the actual position of the contact w.r.t the CoM frame
-			Eigen::Vector3d actual_pos_B = state.getFootPosition_B(foot_it);
+			actual_pos_B[name] = phase_state_.getFootPosition_B(foot_it);
 
 			// Getting the target position of the contact w.r.t the CoM frame
 			Eigen::Vector3d footshift_B = (Eigen::Vector3d) swing_it->second;
 			Eigen::Vector3d stance_pos_H = stance_posture_H_.find(name)->second.head<3>();
-			Eigen::Vector3d stance_pos_B =
-					frame_tf_.fromHorizontalToBaseFrame(stance_pos_H,
-														terminal_state.getRPY());
-			Eigen::Vector3d target_pos_B = stance_pos_B + footshift_B;
-
-			// Initializing the foot pattern generator
-			double penetration = 0.;
-			simulation::StepParameters step_params(params.duration,//num_samples * sample_time_,
-												   step_height_, penetration);// TODO read it
-			feet_spline_generator_[name].setParameters(state.time,
-													   actual_pos_B,
-													   target_pos_B,
-													   step_params);
+			Eigen::Vector3d stance_pos_B = B_rot_H * stance_pos_H;
+			target_pos_B[name] = stance_pos_B + footshift_B;
+		}
+	}
+
+	// Initializing the feet pattern generator, which computes the splines of all the swing
+	// feet of the phase
+	double penetration = 0.;
+	simulation::StepParameters step_params(duration,//num_samples * sample_time_,
+										   step_height_, penetration);// TODO read it
+	feet_spline_generator_.setParameters(state.time,
+										 actual_pos_B,
+										 target_pos_B,
+										 step_params);
+}
+
+
+void PreviewLocomotion::computeSwingBounds(SwingBoundsMap& bounds,
+										   const ReducedBodyState& state,
+										   const PreviewParams& params)
+{
+	// Initializing the swing generator as in the preview of the phase, where the stance
+	// phases need the response of the cart-table model for the footholds
+	phase_table_.compile(params, feet_names_);
+	if (phase_table_.types[0] == STANCE) {
+		ReducedBodyState current_state = state;
+		for (unsigned int f = 0; f < num_feet_; ++f) {
+			if (phase_table_.isSwingFoot(0, f))
+				current_state.support_region.erase(feet_names_[f]);
 		}
+
+		CartTableControlParams model_params(params.duration,
+											params.cop_shift);
+		cart_table_.initResponse(current_state, model_params);
+		initPhaseSwing(current_state, 0);
+	} else
+		initPhaseSwing(state, 0);
+
+	// Computing the bounds of the swing splines, where the reach is the distance to the
+	// CoM (i.e. the origin of the CoM frame)
+	unsigned int num_swings = feet_spline_generator_.getNumberOfFeet();
+	Eigen::Matrix3Xd lower_pos, upper_pos;
+	Eigen::VectorXd min_reach, max_reach;
+	feet_spline_generator_.computePositionBounds(lower_pos, upper_pos);
+	feet_spline_generator_.computeReachBounds(min_reach, max_reach,
+											  Eigen::Matrix3Xd::Zero(3, num_swings));
+
+	bounds.clear();
+	const std::vector<std::string>& swing_feet = feet_spline_generator_.getSwingFeet();
+	for (unsigned int i = 0; i < num_swings; i++) {
+		bounds[swing_feet[i]] = SwingBounds(lower_pos(rbd::Z,i), upper_pos(rbd::Z,i),
+											min_reach(i), max_reach(i));
 	}
 }
 
@@ -528,46 +701,42 @@ void PreviewLocomotion::initSwing(const ReducedBodyState& state,
 void PreviewLocomotion::generateSwing(ReducedBodyState& state,
 									  double time)
 {
-	// Generating the actual state for every feet
-	Eigen::Vector3d foot_pos_B, foot_vel_B, foot_acc_B;
-	for (rbd::BodyVector3d::const_iterator foot_it = phase_state_.foot_pos.begin();
-			foot_it != phase_state_.foot_pos.end(); ++foot_it) {
-		std::string name = foot_it->first;
+	// Computing the CoM displacement in the horizontal frame, which is the same for
+	// all the stance feet
+	Eigen::Vector3d com_disp_W = state.com_pos - phase_state_.com_pos;
+	Eigen::Vector3d com_disp_H =
+			state.getHorizontalToWorldRotation().transpose() * com_disp_W;
+
+	// Generating the swing positions, velocities and accelerations of all the swing feet
+	// expressed in the CoM frame
+	feet_spline_generator_.generateTrajectory(swing_pos_B_,
+											  swing_vel_B_,
+											  swing_acc_B_,
+											  time);
+
+	// Adding the swing states to the trajectory
+	const std::vector<std::string>& swing_feet = feet_spline_generator_.getSwingFeet();
+	for (unsigned int i = 0; i < swing_feet.size(); i++) {
+		const std::string& name = swing_feet[i];
+		state.setFootPosition_B(name, swing_pos_B_.col(i));
+		state.setFootVelocity_B(name, swing_vel_B_.col(i));
+		state.setFootAcceleration_B(name, swing_acc_B_.col(i));
+	}
 
-		// Checking the feet that swing
-		rbd::BodyVector3d::const_iterator swing_it = swing_params_.feet_shift.find(name);
-		if (swing_it != swing_params_.feet_shift.end()) {
-			// Generating the swing positions, velocities and accelerations
-			// expressed in the CoM frame
-			feet_spline_generator_[name].generateTrajectory(foot_pos_B,
-															foot_vel_B,
-															foot_acc_B,
-															time);
-
-			// Adding the swing state to the trajectory
-			state.setFootPosition_B(name, foot_pos_B);
-			state.setFootVelocity_B(name, foot_vel_B);
-			state.setFootAcceleration_B(name, foot_acc_B);
-		} else {
-			// There is not swing trajectory to generated (foot on ground).
-			// Nevertheless, we have to updated their positions w.r.t the CoM frame
-			// Getting the actual position of the foot expressed in the horizontal
-			// frame
-			Eigen::Vector3d actual_pos_H = phase_state_.getFootPosition_H(foot_it);
-
-			// Getting the CoM position of the specific time
-			Eigen::Vector3d com_pos = state.com_pos;
-			Eigen::Vector3d com_vel = state.com_vel;
-			Eigen::Vector3d com_acc = state.com_acc;
-
-			// Adding the foot states w.r.t. the CoM frame
-			Eigen::Vector3d com_disp_W = com_pos - phase_state_.com_pos;
-			Eigen::Vector3d com_disp_H =
-					frame_tf_.fromWorldToHorizontalFrame(com_disp_W, state.getRPY());
-			state.setFootPosition_H(name, actual_pos_H - com_disp_H);
-			state.setFootVelocity_H(name, -com_vel);
-			state.setFootAcceleration_H(name, -com_acc);
-		}
+	// Generating the actual state for the stance feet, which were recorded in the
+	// initialization of the swing. There is not swing trajectory to generated (foot on
+	// ground). Nevertheless, we have to updated their positions w.r.t the CoM frame
+	for (unsigned int i = 0; i < stance_feet_.size(); i++) {
+		rbd::BodyVector3d::const_iterator foot_it = stance_feet_[i];
+		const std::string& name = foot_it->first;
+
+		// Getting the actual position of the foot expressed in the horizontal frame
+		Eigen::Vector3d actual_pos_H = phase_state_.getFootPosition_H(foot_it);
+
+		// Adding the foot states w.r.t. the CoM frame
+		state.setFootPosition_H(name, actual_pos_H - com_disp_H);
+		state.setFootVelocity_H(name, -state.com_vel);
+		state.setFootAcceleration_H(name, -state.com_acc);
 	}
 }
 
@@ -610,10 +779,36 @@ void PreviewLocomotion::fromWholeBodyState(ReducedBodyState& reduced_state,
 }
 
 
+void PreviewLocomotion::setNumberOfConversionThreads(unsigned int num_threads)
+{
+	state_tf_.setNumberOfThreads(num_threads);
+}
+
+
 void PreviewLocomotion::toWholeBodyTrajectory(WholeBodyTrajectory& full_traj,
-											  const ReducedBodyTrajectory& reduced_traj)
+											  const ReducedBodyTrajectory& reduced_traj,
+											  unsigned int stride)
+{
+	state_tf_.getWholeBodyTrajectory(full_traj, reduced_traj, stride);
+}
+
+
+void PreviewLocomotion::toWholeBodyTrajectory(WholeBodyTrajectoryContainer& full_traj,
+											  const ReducedBodyTrajectory& reduced_traj,
+											  unsigned int stride)
 {
-	full_traj = state_tf_.getWholeBodyTrajectory(reduced_traj);
+	// Converting the trajectory in the workspace, and then setting every whole-body state
+	// directly in the container
+	state_tf_.getWholeBodyTrajectory(conversion_traj_, reduced_traj, stride);
+	unsigned int num_points = conversion_traj_.size();
+	if (num_points == 0) {
+		full_traj.clear();
+		return;
+	}
+
+	full_traj.resize(num_points, conversion_traj_[0].getJointDoF(), feet_names_);
+	for (unsigned int k = 0; k < num_points; k++)
+		full_traj.setState(k, conversion_traj_[k]);
 }
 
 } //@namespace simulation
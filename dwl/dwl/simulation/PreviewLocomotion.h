@@ -2,12 +2,14 @@
 #define DWL__SIMULATION__PREVIEW_LOCOMOTION__H
 
 #include <dwl/RobotStates.h>
+#include <dwl/TrajectoryContainer.h>
 #include <dwl/simulation/LinearControlledCartTableModel.h>
 #include <dwl/simulation/FootSplinePatternGenerator.h>
 #include <dwl/model/WholeBodyDynamics.h>
 #include <dwl/model/FloatingBaseSystem.h>
 #include <dwl/environment/TerrainMap.h>
 #include <dwl/utils/YamlWrapper.h>
+#include <random>
 
 
 namespace dwl
@@ -111,6 +113,89 @@ struct PreviewControl
 	std::vector<PreviewParams> params;
 };
 
+/**
+ * @brief Compiled phases of a preview control or schedule, i.e. the swing feet as a bitmask
+ * per phase and the foot shifts and durations as arrays, where the feet are indexed in the
+ * order of a list of names. Thus, the rollouts index it directly instead of searching the
+ * maps of every phase
+ */
+struct PreviewPhaseTable
+{
+	PreviewPhaseTable() : num_feet(0) {}
+
+	void compile(const PreviewControl& control,
+				 const rbd::BodySelector& feet) {
+		resize(control.params.size(), feet.size());
+		for (unsigned int p = 0; p < control.params.size(); ++p) {
+			const PreviewParams& params = control.params[p];
+			setPhase(p, params.phase, feet);
+			durations[p] = params.duration;
+			cop_shifts.col(p) = params.cop_shift;
+		}
+	}
+
+	void compile(const PreviewParams& params,
+				 const rbd::BodySelector& feet) {
+		resize(1, feet.size());
+		setPhase(0, params.phase, feet);
+		durations[0] = params.duration;
+		cop_shifts.col(0) = params.cop_shift;
+	}
+
+	void compile(const std::vector<PreviewPhase>& phases,
+				 const rbd::BodySelector& feet) {
+		resize(phases.size(), feet.size());
+		for (unsigned int p = 0; p < phases.size(); ++p)
+			setPhase(p, phases[p], feet);
+	}
+
+	bool isSwingFoot(unsigned int phase,
+					 unsigned int foot) const {
+		return (swing_masks[phase] >> foot) & 1u;
+	}
+
+	Eigen::Vector2d getFootShift(unsigned int phase,
+								 unsigned int foot) const {
+		return feet_shift.col(phase * num_feet + foot);
+	}
+
+	unsigned int getNumberPhases() const {
+		return types.size();
+	}
+
+	std::vector<TypeOfPhases> types;
+	std::vector<unsigned int> swing_masks;
+	std::vector<double> durations;
+	Eigen::Matrix2Xd cop_shifts;
+	Eigen::Matrix2Xd feet_shift;
+	unsigned int num_feet;
+
+	private:
+		void resize(unsigned int num_phases,
+					unsigned int _num_feet) {
+			// Note that it doesn't release the memory of previous compilations
+			num_feet = _num_feet;
+			types.resize(num_phases);
+			swing_masks.resize(num_phases);
+			durations.assign(num_phases, 0.);
+			cop_shifts.setZero(2, num_phases);
+			feet_shift.setZero(2, num_phases * num_feet);
+		}
+
+		void setPhase(unsigned int p,
+					  const PreviewPhase& phase,
+					  const rbd::BodySelector& feet) {
+			types[p] = phase.type;
+			swing_masks[p] = 0;
+			for (unsigned int f = 0; f < feet.size(); ++f) {
+				if (phase.isSwingFoot(feet[f])) {
+					swing_masks[p] |= 1u << f;
+					feet_shift.col(p * num_feet + f) = phase.getFootShift(feet[f]);
+				}
+			}
+		}
+};
+
 struct PreviewSchedule
 {
 	PreviewSchedule() : actual_phase_(0), next_phase_(0) {}
@@ -148,10 +233,12 @@ struct PreviewSchedule
 
 	void addPhase(const PreviewPhase& phase) {
 		schedule.push_back(phase);
+		table.compile(schedule, feet);
 	}
 
 	void setFeet(const rbd::BodySelector& _feet) {
 		feet = _feet;
+		table.compile(schedule, feet);
 	}
 
 	unsigned int getIndex() {
@@ -182,11 +269,21 @@ struct PreviewSchedule
 		return schedule[index].feet;
 	}
 
+	unsigned int getSwingMask(const unsigned int& index) const {
+		return table.swing_masks[index];
+	}
+
+	bool isSwingFoot(const unsigned int& index,
+					 const unsigned int& foot) const {
+		return table.isSwingFoot(index, foot);
+	}
+
 	unsigned int getNumberPhases() {
 		return schedule.size();
 	}
 
 	std::vector<PreviewPhase> schedule;
+	PreviewPhaseTable table;
 	rbd::BodySelector feet;
 	unsigned int actual_phase_;
 	unsigned int next_phase_;
@@ -205,6 +302,27 @@ struct SwingParams
 };
 
 
+/**
+ * @brief Bounds of a swing over its whole interval, i.e. the height and the reach (distance to
+ * the CoM) of the foot expressed in the CoM frame
+ */
+struct SwingBounds
+{
+	SwingBounds() : min_height(0.), max_height(0.), min_reach(0.), max_reach(0.) {}
+	SwingBounds(double _min_height,
+				double _max_height,
+				double _min_reach,
+				double _max_reach) : min_height(_min_height), max_height(_max_height),
+						min_reach(_min_reach), max_reach(_max_reach) {}
+
+	double min_height;
+	double max_height;
+	double min_reach;
+	double max_reach;
+};
+
+typedef std::map<std::string,SwingBounds> SwingBoundsMap;
+
 struct VelocityCommand
 {
 	VelocityCommand() : linear(Eigen::Vector2d::Zero()), angular(0.) {}
@@ -353,6 +471,16 @@ class PreviewLocomotion
 		 */
 		void setForceThreshold(double force_threshold);
 
+		/**
+		 * @brief Sets the Gaussian noise of the terrain height of the footholds, e.g. for
+		 * evaluating the robustness of a preview control. The noise is drawn from its own
+		 * generator, so the previews are repeatable for a given seed
+		 * @param double Standard deviation of the terrain height (zero disables the noise)
+		 * @param unsigned int Seed of the noise generator
+		 */
+		void setFootholdHeightNoise(double std_dev,
+									unsigned int seed = 0);
+
 		/**
 		 * @brief Computes the multi-phase preview trajectory
 		 * @param ReducedBodyTrajectory& Reduced-body trajectory
@@ -366,6 +494,24 @@ class PreviewLocomotion
 							   const PreviewControl& control,
 							   bool full = true);
 
+		/**
+		 * @brief Computes a summary of the multi-phase preview, which is used for cost
+		 * evaluation (e.g. in the preview optimization). Instead of sampling the phases at the
+		 * sample time, the closed-form response of every phase is evaluated only at a number of
+		 * equally-spaced intermediate points and at its terminal time. Thus, the summary has
+		 * (num_intermediates + 1) states per phase, where the last state of a stance phase
+		 * contains the footholds of its swing feet. The summary is overwritten in place, so
+		 * reusing it between evaluations avoids per-sample allocations
+		 * @param ReducedBodyTrajectory& Summary of the reduced-body trajectory
+		 * @param const ReducedBodyState& Actual reduced-body state
+		 * @param const PreviewControl& Preview control
+		 * @param unsigned int Number of intermediate points per phase
+		 */
+		void multiPhaseSummaryPreview(ReducedBodyTrajectory& summary,
+									  const ReducedBodyState& state,
+									  const PreviewControl& control,
+									  unsigned int num_intermediates = 0);
+
 		/**
 		 * @brief Computes the preview of a stance phase
 		 * The preview is computed according a Spring Loaded Linear
@@ -409,6 +555,19 @@ class PreviewLocomotion
 		void initSwing(const ReducedBodyState& state,
 					   const PreviewParams& params);
 
+		/**
+		 * @brief Computes the bounds of the swings of a phase without sampling, so they don't
+		 * depend on the sample time (e.g. for collision and workspace costs). The swing
+		 * splines are initialized as in the preview of the phase, and their bounds are
+		 * computed analytically over the whole swing interval
+		 * @param SwingBoundsMap& Bounds of the swing feet
+		 * @param const ReducedBodyState& Initial low-dimensional state
+		 * @param const PreviewParams& Preview control parameters
+		 */
+		void computeSwingBounds(SwingBoundsMap& bounds,
+								const ReducedBodyState& state,
+								const PreviewParams& params);
+
 		/**
 		 * @brief Generates the swing trajectory of the contact
 		 * @param ReducedBodyState& Desired preview state
@@ -446,22 +605,99 @@ class PreviewLocomotion
 								const WholeBodyState& full_state);
 
 		/**
-		 * @brief Converts a reduced-body trajectory to a whole-body one
+		 * @brief Sets the number of threads of the trajectory conversions, where zero uses
+		 * the hardware concurrency (default is one)
+		 * @param unsigned int Number of threads
+		 */
+		void setNumberOfConversionThreads(unsigned int num_threads);
+
+		/**
+		 * @brief Converts a reduced-body trajectory to a whole-body one. The IK of every
+		 * sample starts from the previous one, and the samples are converted in parallel
+		 * chunks. The stride skips the samples that the consumer interpolates anyway, i.e.
+		 * it converts every stride-th sample and the last one
 		 * @param WholeBodyTrajectory& Whole-body trajectory
 		 * @param const ReducedBodyTrajectory& Reduced-body trajectory
+		 * @param unsigned int Stride of the converted samples
 		 */
 		void toWholeBodyTrajectory(WholeBodyTrajectory& full_traj,
-								   const ReducedBodyTrajectory& reduced_traj);
+								   const ReducedBodyTrajectory& reduced_traj,
+								   unsigned int stride = 1);
+
+		/**
+		 * @brief Converts a reduced-body trajectory to a whole-body one stored as
+		 * structure of arrays
+		 * @param WholeBodyTrajectoryContainer& Whole-body trajectory container
+		 * @param const ReducedBodyTrajectory& Reduced-body trajectory
+		 * @param unsigned int Stride of the converted samples
+		 */
+		void toWholeBodyTrajectory(WholeBodyTrajectoryContainer& full_traj,
+								   const ReducedBodyTrajectory& reduced_traj,
+								   unsigned int stride = 1);
 
 
 	private:
+		/**
+		 * @brief Computes the preview of a stance phase of the phase table
+		 * @param ReducedTrajectory& Reduced-body trajectory at the predefined
+		 * sample time
+		 * @param const ReducedBodyState& Initial low-dimensional state
+		 * @param unsigned int Phase index in the phase table
+		 * @param bool Label that indicates full preview or just the
+		 * terminal state
+		 */
+		void computeStancePreview(ReducedBodyTrajectory& trajectory,
+								  const ReducedBodyState& state,
+								  unsigned int phase,
+								  bool full);
+
+		/**
+		 * @brief Computes the preview of a flight phase of the phase table
+		 * @param ReducedBodyTrajectory& Reduced-body trajectory at the predefined
+		 * sample time
+		 * @param const ReducedBodyState& Initial low-dimensional state
+		 * @param unsigned int Phase index in the phase table
+		 * @param bool Label that indicates full preview or just the
+		 * terminal state
+		 */
+		void computeFlightPreview(ReducedBodyTrajectory& trajectory,
+								  const ReducedBodyState& state,
+								  unsigned int phase,
+								  bool full);
+
+		/**
+		 * @brief Initializes the swing trajectory generator of a phase of the phase table
+		 * @param const ReducedBodyState& Initial low-dimensional state
+		 * @param unsigned int Phase index in the phase table
+		 */
+		void initPhaseSwing(const ReducedBodyState& state,
+							unsigned int phase);
+
+		/**
+		 * @brief Adds the footholds of the swing feet of the phase to the support region
+		 * @param ReducedBodyState& Terminal state of the stance phase
+		 * @param unsigned int Phase index in the phase table
+		 */
+		void addFootholds(ReducedBodyState& state,
+						  unsigned int phase);
+
+		/** @brief Compiled phases of the last preview, which are indexed by the rollouts */
+		PreviewPhaseTable phase_table_;
+
 		/** @brief Actual reduced-body state */
 		ReducedBodyState actual_state_;
 
-		/** @brief Feet spline generator */
-		FootSplinerMap feet_spline_generator_;
+		/** @brief Initial state of the phase for the summary preview */
+		ReducedBodyState summary_state_;
+
+		/** @brief Feet spline generator and its preallocated swing states */
+		MultiFootSplinePatternGenerator feet_spline_generator_;
+		Eigen::Matrix3Xd swing_pos_B_;
+		Eigen::Matrix3Xd swing_vel_B_;
+		Eigen::Matrix3Xd swing_acc_B_;
 		SwingParams swing_params_;
 		ReducedBodyState phase_state_;
+		std::vector<rbd::BodyVector3d::const_iterator> stance_feet_;
 
 		/** @brief Floating-base system information */
 		model::FloatingBaseSystem fbs_;
@@ -472,8 +708,9 @@ class PreviewLocomotion
 		/** @brief Whole-body kinematics */
 		model::WholeBodyKinematics wkin_;
 
-		/** @brief Robot state converter */
+		/** @brief Robot state converter, and its workspace of the trajectory conversions */
 		RobotStates state_tf_;
+		WholeBodyTrajectory conversion_traj_;
 
 		/** @brief Terrain map */
 		environment::TerrainMap terrain_;
@@ -506,6 +743,10 @@ class PreviewLocomotion
 		/** @brief Step height for the swing generation */
 		double step_height_;
 
+		/** @brief Noise of the terrain height of the footholds, and its generator */
+		double foothold_height_noise_;
+		std::mt19937 foothold_generator_;
+
 		/** @ brief Stance posture position w.r.t. the horizontal frame */
 		rbd::BodyVectorXd stance_posture_H_;
 };
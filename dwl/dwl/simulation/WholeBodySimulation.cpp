@@ -0,0 +1,223 @@
+#include <dwl/simulation/WholeBodySimulation.h>
+#include <dwl/utils/TaskScheduler.h>
+
+
+namespace dwl
+{
+
+namespace simulation
+{
+
+WholeBodySimulation::WholeBodySimulation() : time_step_(1e-4), kp_(0.), kd_(0.)
+{
+
+}
+
+
+WholeBodySimulation::~WholeBodySimulation()
+{
+
+}
+
+
+void WholeBodySimulation::resetFromURDFFile(std::string urdf_file,
+											std::string system_file)
+{
+	resetFromURDFModel(urdf_model::fileToXml(urdf_file), system_file);
+}
+
+
+void WholeBodySimulation::resetFromURDFModel(std::string urdf_model,
+											 std::string system_file)
+{
+	// Initializing the dynamics from the URDF model
+	wdyn_.modelFromURDFModel(urdf_model, system_file);
+
+	// Resetting the containers, which are indexed by the end-effectors
+	const rbd::BodySelector& names = wdyn_.getFloatingBaseSystem().getEndEffectorNames();
+	contact_pos_.reset(names);
+	contact_vel_.reset(names);
+	contact_forces_.reset(names);
+	contact_forces_.setZero();
+	joint_forces_.setZero(wdyn_.getFloatingBaseSystem().getJointDoF());
+}
+
+
+void WholeBodySimulation::setContactModel(const ContactModel& contact_model)
+{
+	contact_model_ = contact_model;
+}
+
+
+void WholeBodySimulation::setTimeStep(double time_step)
+{
+	if (time_step <= 0.) {
+		printf(YELLOW "Warning: the time step has to be positive\n" COLOR_RESET);
+		return;
+	}
+
+	time_step_ = time_step;
+}
+
+
+void WholeBodySimulation::setPDGains(double stiffness,
+									 double damping)
+{
+	kp_ = stiffness;
+	kd_ = damping;
+}
+
+
+void WholeBodySimulation::step(WholeBodyState& state)
+{
+	// Computing the contact forces of the current state
+	computeContactForces(state);
+
+	// Computing the forward dynamics. Note that the joint efforts of the state are the
+	// commanded joint forces
+	unsigned int num_joints = wdyn_.getFloatingBaseSystem().getJointDoF();
+	if (state.joint_eff.size() == num_joints)
+		joint_forces_ = state.joint_eff;
+	else
+		joint_forces_.setZero(num_joints);
+	wdyn_.computeForwardDynamics(state.base_acc, state.joint_acc,
+								 state.base_pos, state.joint_pos,
+								 state.base_vel, state.joint_vel,
+								 joint_forces_, contact_forces_);
+
+	// Setting the contact positions and wrenches (of the beginning of the step) expressed
+	// in the base frame
+	Eigen::Matrix3d world_to_base =
+			frame_tf_.getWorldToBaseRotation((Eigen::Vector3d) rbd::angularPart(state.base_pos));
+	for (unsigned int i = 0; i < contact_forces_.size(); i++) {
+		const std::string& name = contact_forces_.getName(i);
+		state.setContactPosition_W(name, contact_pos_[i]);
+
+		rbd::Vector6d wrench_B;
+		wrench_B << world_to_base * rbd::angularPart(contact_forces_[i]),
+				world_to_base * rbd::linearPart(contact_forces_[i]);
+		state.contact_eff[name] = wrench_B;
+	}
+
+	// Integrating the generalized state with the semi-implicit Euler method
+	state.base_vel += time_step_ * state.base_acc;
+	state.joint_vel += time_step_ * state.joint_acc;
+	state.base_pos += time_step_ * state.base_vel;
+	state.joint_pos += time_step_ * state.joint_vel;
+	state.time += time_step_;
+}
+
+
+void WholeBodySimulation::simulate(WholeBodyTrajectory& trajectory,
+								   const WholeBodyTrajectory& reference)
+{
+	trajectory.resize(reference.size());
+	if (reference.size() == 0)
+		return;
+
+	// Simulating from the first state of the plan
+	WholeBodyState state = reference[0];
+	trajectory[0] = state;
+	for (unsigned int k = 1; k < reference.size(); k++) {
+		// Holding the reference of the last knot until the time of the current one. Note that
+		// the number of steps is rounded to the fixed time step
+		const WholeBodyState& ref = reference[k - 1];
+		unsigned int num_steps =
+				std::max(1., floor((reference[k].time - ref.time) / time_step_ + 0.5));
+		for (unsigned int s = 0; s < num_steps; s++) {
+			state.joint_eff = ref.joint_eff +
+					kp_ * (ref.joint_pos - state.joint_pos) +
+					kd_ * (ref.joint_vel - state.joint_vel);
+			step(state);
+		}
+
+		trajectory[k] = state;
+	}
+}
+
+
+void WholeBodySimulation::simulate(std::vector<WholeBodyTrajectory>& trajectories,
+								   const std::vector<WholeBodyTrajectory>& references,
+								   unsigned int num_threads)
+{
+	unsigned int num_rollouts = references.size();
+	trajectories.resize(num_rollouts);
+	if (num_rollouts == 0)
+		return;
+
+	// Getting the number of threads, which cannot be bigger than the number
+	// of rollouts
+	if (num_threads == 0)
+		num_threads = utils::TaskScheduler::getDefault().getMaxParallelism();
+	num_threads = std::min(num_threads, num_rollouts);
+
+	// Simulating a contiguous chunk of rollouts with a given simulator
+	auto simulateRollouts = [&](WholeBodySimulation& simulation,
+								unsigned int first, unsigned int last) {
+		for (unsigned int r = first; r < last; r++)
+			simulation.simulate(trajectories[r], references[r]);
+	};
+
+	// Creating the thread-local copies of the simulator (RBDL modifies its
+	// internal buffers). Note that the first chunk is simulated with this
+	// simulator, and the chunks are run by the task scheduler
+	unsigned int chunk_size = (num_rollouts + num_threads - 1) / num_threads;
+	std::vector<WholeBodySimulation> thread_simulations(num_threads - 1, *this);
+	utils::TaskScheduler::getDefault().parallelFor(num_threads, [&](unsigned int t) {
+		unsigned int first = std::min(t * chunk_size, num_rollouts);
+		unsigned int last = std::min(first + chunk_size, num_rollouts);
+		simulateRollouts((t == 0) ? *this : thread_simulations[t - 1], first, last);
+	});
+}
+
+
+const rbd::BodyContainer6d& WholeBodySimulation::getContactForces() const
+{
+	return contact_forces_;
+}
+
+
+model::WholeBodyDynamics& WholeBodySimulation::getWholeBodyDynamics()
+{
+	return wdyn_;
+}
+
+
+void WholeBodySimulation::computeContactForces(const WholeBodyState& state)
+{
+	// Computing the end-effector positions and velocities in the world frame. Note that both
+	// share the same kinematics update
+	model::WholeBodyKinematics& wkin = wdyn_.getWholeBodyKinematics();
+	wkin.computeForwardKinematics(contact_pos_,
+								  state.base_pos, state.joint_pos);
+	wkin.computeVelocity(contact_vel_,
+						 state.base_pos, state.joint_pos,
+						 state.base_vel, state.joint_vel);
+
+	for (unsigned int i = 0; i < contact_pos_.size(); i++) {
+		contact_forces_[i].setZero();
+
+		// There isn't force without penetration
+		double penetration = contact_model_.ground_height - contact_pos_[i](rbd::Z);
+		if (penetration <= 0.)
+			continue;
+
+		// Computing the normal force, which cannot pull the end-effector
+		const Eigen::Vector3d& vel = contact_vel_[i];
+		double normal_force = contact_model_.stiffness * penetration -
+				contact_model_.damping * vel(rbd::Z);
+		if (normal_force <= 0.)
+			continue;
+
+		// Computing the tangential force, which is bounded by the friction cone
+		Eigen::Vector2d tangential_force = -contact_model_.damping * vel.head<2>();
+		double max_tangential_force = contact_model_.friction_coeff * normal_force;
+		if (tangential_force.norm() > max_tangential_force)
+			tangential_force *= max_tangential_force / tangential_force.norm();
+
+		contact_forces_[i].segment<3>(rbd::LX) << tangential_force, normal_force;
+	}
+}
+
+} //@namespace simulation
+} //@namespace dwl
@@ -0,0 +1,166 @@
+#ifndef DWL__SIMULATION__WHOLE_BODY_SIMULATION__H
+#define DWL__SIMULATION__WHOLE_BODY_SIMULATION__H
+
+#include <dwl/WholeBodyState.h>
+#include <dwl/model/WholeBodyDynamics.h>
+#include <dwl/utils/FrameTF.h>
+#include <dwl/utils/Macros.h>
+
+
+namespace dwl
+{
+
+namespace simulation
+{
+
+/**
+ * @brief Defines the compliant contact model between the end-effectors and a flat ground.
+ * The normal force is a spring-damper of the penetration, and the tangential force is a
+ * viscous friction bounded by the friction cone
+ */
+struct ContactModel
+{
+	ContactModel() : stiffness(2e4), damping(1e3), friction_coeff(0.7), ground_height(0.) {}
+	ContactModel(double _stiffness,
+				 double _damping,
+				 double _friction_coeff = 0.7,
+				 double _ground_height = 0.) : stiffness(_stiffness),
+						 damping(_damping), friction_coeff(_friction_coeff),
+						 ground_height(_ground_height) {}
+
+	double stiffness;
+	double damping;
+	double friction_coeff;
+	double ground_height;
+};
+
+/**
+ * @class WholeBodySimulation
+ * @brief Simulates the whole-body dynamics of a floating-base system with a fixed-step
+ * integrator. Every step computes the forward dynamics with the Articulated Body Algorithm
+ * (see model::WholeBodyDynamics::computeForwardDynamics), where the contact forces are
+ * computed from a compliant contact model, and integrates the generalized state with the
+ * semi-implicit Euler method. A plan (e.g. from the preview or trajectory optimization) is
+ * validated by tracking it with its feedforward joint efforts and a joint PD controller. Several
+ * plans can be rolled out in parallel, where each thread uses its own copy of the model
+ */
+class WholeBodySimulation
+{
+	public:
+		/** @brief Constructor function */
+		WholeBodySimulation();
+
+		/** @brief Destructor function */
+		~WholeBodySimulation();
+
+		/**
+		 * @brief Resets the system information from an URDF file
+		 * @param std::string URDF filename
+		 * @param std::string Semantic system description filename
+		 */
+		void resetFromURDFFile(std::string urdf_file,
+							   std::string system_file = std::string());
+
+		/**
+		 * @brief Resets the system information from URDF model
+		 * @param std::string URDF model
+		 * @param std::string Semantic system description filename
+		 */
+		void resetFromURDFModel(std::string urdf_model,
+								std::string system_file = std::string());
+
+		/**
+		 * @brief Sets the contact model
+		 * @param const ContactModel& Contact model
+		 */
+		void setContactModel(const ContactModel& contact_model);
+
+		/**
+		 * @brief Sets the time step of the integrator
+		 * @param double Time step
+		 */
+		void setTimeStep(double time_step);
+
+		/**
+		 * @brief Sets the gains of the joint PD controller used for tracking a plan
+		 * @param double Proportional gain
+		 * @param double Derivative gain
+		 */
+		void setPDGains(double stiffness,
+						double damping);
+
+		/**
+		 * @brief Integrates the whole-body state one time step, where the joint efforts of the
+		 * state are the commanded joint forces. It updates the base and joint accelerations,
+		 * and the contact positions and wrenches (expressed in the base frame) of the state
+		 * @param WholeBodyState& Whole-body state
+		 */
+		void step(WholeBodyState& state);
+
+		/**
+		 * @brief Simulates the tracking of a plan from its first state. The reference of every
+		 * knot is hold until the next one, and the simulated state is recorded in every knot
+		 * @param WholeBodyTrajectory& Simulated trajectory
+		 * @param const WholeBodyTrajectory& Reference trajectory (plan)
+		 */
+		void simulate(WholeBodyTrajectory& trajectory,
+					  const WholeBodyTrajectory& reference);
+
+		/**
+		 * @brief Simulates a batch of plans (rollouts). The rollouts are split in contiguous
+		 * chunks that are simulated in parallel, where the calling thread simulates the first
+		 * chunk with this model
+		 * @param std::vector<WholeBodyTrajectory>& Simulated trajectories
+		 * @param const std::vector<WholeBodyTrajectory>& Reference trajectories (plans)
+		 * @param unsigned int Number of threads (0 uses the number of cores)
+		 */
+		void simulate(std::vector<WholeBodyTrajectory>& trajectories,
+					  const std::vector<WholeBodyTrajectory>& references,
+					  unsigned int num_threads = 1);
+
+		/** @brief Gets the contact forces of the last step, expressed in the world frame */
+		const rbd::BodyContainer6d& getContactForces() const;
+
+		/** @brief Gets the whole-body dynamics */
+		model::WholeBodyDynamics& getWholeBodyDynamics();
+
+
+	private:
+		/**
+		 * @brief Computes the contact forces of the end-effectors from the compliant contact
+		 * model
+		 * @param const WholeBodyState& Whole-body state
+		 */
+		void computeContactForces(const WholeBodyState& state);
+
+		/** @brief Whole-body dynamics */
+		model::WholeBodyDynamics wdyn_;
+
+		/** @brief Contact model */
+		ContactModel contact_model_;
+
+		/** @brief Time step of the integrator */
+		double time_step_;
+
+		/** @brief Joint PD gains */
+		double kp_;
+		double kd_;
+
+		/** @brief End-effector positions and velocities expressed in the world frame */
+		rbd::BodyContainer3d contact_pos_;
+		rbd::BodyContainer3d contact_vel_;
+
+		/** @brief Contact forces expressed in the world frame */
+		rbd::BodyContainer6d contact_forces_;
+
+		/** @brief Commanded joint forces */
+		Eigen::VectorXd joint_forces_;
+
+		/** @brief Frame transformations */
+		math::FrameTF frame_tf_;
+};
+
+} //@namespace simulation
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,270 @@
+#include <dwl/solver/ADMMQP.h>
+#include <dwl/utils/Macros.h>
+#include <time.h>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+ADMMQP::ADMMQP() : rho_(0.1), sigma_(1e-6), alpha_(1.6), max_iter_(4000),
+		eps_abs_(1e-4), eps_rel_(1e-4), iterations_(0), warm_start_(false)
+{
+
+}
+
+
+ADMMQP::~ADMMQP()
+{
+
+}
+
+
+bool ADMMQP::init(unsigned int num_variables,
+				  unsigned int num_constraints)
+{
+	variables_ = num_variables;
+	constraints_ = num_constraints;
+	warm_start_ = false;
+
+	return true;
+}
+
+
+bool ADMMQP::compute(const Eigen::MatrixXd& hessian,
+					 const Eigen::VectorXd& gradient,
+					 const Eigen::MatrixXd& constraint_mat,
+					 const Eigen::VectorXd& lower_bound,
+					 const Eigen::VectorXd& upper_bound,
+					 const Eigen::VectorXd& lower_constraint,
+					 const Eigen::VectorXd& upper_constraint,
+					 double cputime)
+{
+	return compute(Eigen::SparseMatrix<double>(hessian.sparseView()), gradient,
+				   Eigen::SparseMatrix<double>(constraint_mat.sparseView()),
+				   lower_bound, upper_bound,
+				   lower_constraint, upper_constraint,
+				   cputime);
+}
+
+
+bool ADMMQP::compute(const Eigen::SparseMatrix<double>& hessian,
+					 const Eigen::VectorXd& gradient,
+					 const Eigen::SparseMatrix<double>& constraint_mat,
+					 const Eigen::VectorXd& lower_bound,
+					 const Eigen::VectorXd& upper_bound,
+					 const Eigen::VectorXd& lower_constraint,
+					 const Eigen::VectorXd& upper_constraint,
+					 double cputime)
+{
+	// The last solution is a starting point only if the dimensions don't change
+	if ((unsigned int) hessian.rows() != variables_ ||
+			(unsigned int) constraint_mat.rows() != constraints_) {
+		variables_ = hessian.rows();
+		constraints_ = constraint_mat.rows();
+		warm_start_ = false;
+	}
+
+	if (!factorize(hessian, constraint_mat,
+				   lower_bound, upper_bound,
+				   lower_constraint, upper_constraint))
+		return false;
+
+	initialized_solver_ = true;
+	return solve(gradient, cputime);
+}
+
+
+bool ADMMQP::hotstart(const Eigen::VectorXd& gradient,
+					  const Eigen::VectorXd& lower_bound,
+					  const Eigen::VectorXd& upper_bound,
+					  const Eigen::VectorXd& lower_constraint,
+					  const Eigen::VectorXd& upper_constraint,
+					  double cputime)
+{
+	if (!initialized_solver_) {
+		printf(RED "Error: the QP has to be solved with its matrices before hotstarting the"
+				" vectors\n" COLOR_RESET);
+		return false;
+	}
+
+	// Updating the bounds, where the factorization is recomputed only if the equality
+	// constraints changed
+	Eigen::VectorXd old_rho = rho_vec_;
+	setBounds(lower_bound, upper_bound, lower_constraint, upper_constraint);
+	if (old_rho.size() != rho_vec_.size() || old_rho != rho_vec_) {
+		Eigen::SparseMatrix<double> hessian = hessian_;
+		Eigen::SparseMatrix<double> constraint_mat = constraint_mat_;
+		if (!factorize(hessian, constraint_mat,
+					   lower_bound, upper_bound,
+					   lower_constraint, upper_constraint))
+			return false;
+	}
+
+	return solve(gradient, cputime);
+}
+
+
+void ADMMQP::setParameters(double rho,
+						   double alpha,
+						   unsigned int max_iterations)
+{
+	rho_ = rho;
+	alpha_ = alpha;
+	max_iter_ = max_iterations;
+	rho_vec_.resize(0);
+}
+
+
+void ADMMQP::setTolerances(double absolute,
+						   double relative)
+{
+	eps_abs_ = absolute;
+	eps_rel_ = relative;
+}
+
+
+unsigned int ADMMQP::getNumberOfIterations() const
+{
+	return iterations_;
+}
+
+
+bool ADMMQP::factorize(const Eigen::SparseMatrix<double>& hessian,
+					   const Eigen::SparseMatrix<double>& constraint_mat,
+					   const Eigen::VectorXd& lower_bound,
+					   const Eigen::VectorXd& upper_bound,
+					   const Eigen::VectorXd& lower_constraint,
+					   const Eigen::VectorXd& upper_constraint)
+{
+	// Stacking the constraint matrix and the identity of the bounds, i.e. C = [G; I]
+	unsigned int num_stacked = constraints_ + variables_;
+	std::vector<Eigen::Triplet<double> > triplets;
+	triplets.reserve(constraint_mat.nonZeros() + variables_);
+	for (int k = 0; k < constraint_mat.outerSize(); ++k) {
+		for (Eigen::SparseMatrix<double>::InnerIterator it(constraint_mat, k); it; ++it)
+			triplets.push_back(Eigen::Triplet<double>(it.row(), it.col(), it.value()));
+	}
+	for (unsigned int i = 0; i < variables_; i++)
+		triplets.push_back(Eigen::Triplet<double>(constraints_ + i, i, 1.));
+	Eigen::SparseMatrix<double> stacked_mat(num_stacked, variables_);
+	stacked_mat.setFromTriplets(triplets.begin(), triplets.end());
+	stacked_mat_ = stacked_mat;
+	stacked_mat_t_ = stacked_mat_.transpose();
+	hessian_ = hessian;
+	constraint_mat_ = constraint_mat;
+
+	// Setting the bounds and the penalty of every constraint
+	setBounds(lower_bound, upper_bound, lower_constraint, upper_constraint);
+
+	// Factorizing the reduced linear system (H + sigma I + C' diag(rho) C), which is positive
+	// definite
+	Eigen::SparseMatrix<double> identity(variables_, variables_);
+	identity.setIdentity();
+	Eigen::SparseMatrix<double> kkt_mat = hessian_ + sigma_ * identity +
+			Eigen::SparseMatrix<double>(stacked_mat_t_ * rho_vec_.asDiagonal() * stacked_mat_);
+	linear_solver_.compute(kkt_mat);
+	if (linear_solver_.info() != Eigen::Success) {
+		printf(RED "Error: the linear system of the ADMM QP could not be factorized\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	return true;
+}
+
+
+void ADMMQP::setBounds(const Eigen::VectorXd& lower_bound,
+					   const Eigen::VectorXd& upper_bound,
+					   const Eigen::VectorXd& lower_constraint,
+					   const Eigen::VectorXd& upper_constraint)
+{
+	unsigned int num_stacked = constraints_ + variables_;
+	stacked_lower_.resize(num_stacked);
+	stacked_upper_.resize(num_stacked);
+	stacked_lower_ << lower_constraint, lower_bound;
+	stacked_upper_ << upper_constraint, upper_bound;
+
+	// Setting a larger penalty for the equality constraints
+	rho_vec_.resize(num_stacked);
+	for (unsigned int i = 0; i < num_stacked; i++) {
+		if (stacked_upper_(i) - stacked_lower_(i) < 1e-9)
+			rho_vec_(i) = 1e3 * rho_;
+		else
+			rho_vec_(i) = rho_;
+	}
+}
+
+
+bool ADMMQP::solve(const Eigen::VectorXd& gradient,
+				   double cputime)
+{
+	// Getting the initial time
+	clock_t started_time = clock();
+	double allocated_time = cputime * (double) CLOCKS_PER_SEC;
+
+	// Initializing the primal-dual variables if there isn't a previous solution
+	unsigned int num_stacked = constraints_ + variables_;
+	if (!warm_start_) {
+		x_.setZero(variables_);
+		z_.setZero(num_stacked);
+		y_.setZero(num_stacked);
+	}
+	z_ = z_.cwiseMax(stacked_lower_).cwiseMin(stacked_upper_);
+
+	// ADMM iterations
+	Eigen::VectorXd x_tilde, z_tilde, z_relaxed, z_new, rhs;
+	Eigen::VectorXd stacked_x, hessian_x, stacked_y;
+	bool converged = false;
+	for (iterations_ = 1; iterations_ <= max_iter_; iterations_++) {
+		// Solving the equality-constrained QP of the iterate
+		rhs = sigma_ * x_ - gradient +
+				stacked_mat_t_ * (rho_vec_.cwiseProduct(z_) - y_);
+		x_tilde = linear_solver_.solve(rhs);
+		z_tilde = stacked_mat_ * x_tilde;
+
+		// Updating the relaxed primal variables, the projection onto the bounds and the dual
+		// variables
+		x_ = alpha_ * x_tilde + (1 - alpha_) * x_;
+		z_relaxed = alpha_ * z_tilde + (1 - alpha_) * z_;
+		z_new = (z_relaxed + y_.cwiseQuotient(rho_vec_)).cwiseMax(stacked_lower_).cwiseMin(stacked_upper_);
+		y_ += rho_vec_.cwiseProduct(z_relaxed - z_new);
+		z_ = z_new;
+
+		// Checking the primal and dual residuals
+		stacked_x = stacked_mat_ * x_;
+		hessian_x = hessian_ * x_;
+		stacked_y = stacked_mat_t_ * y_;
+		double prim_res = (stacked_x - z_).lpNorm<Eigen::Infinity>();
+		double dual_res = (hessian_x + gradient + stacked_y).lpNorm<Eigen::Infinity>();
+		double eps_prim = eps_abs_ + eps_rel_ *
+				std::max(stacked_x.lpNorm<Eigen::Infinity>(), z_.lpNorm<Eigen::Infinity>());
+		double eps_dual = eps_abs_ + eps_rel_ *
+				std::max(std::max(hessian_x.lpNorm<Eigen::Infinity>(),
+								  stacked_y.lpNorm<Eigen::Infinity>()),
+						 gradient.lpNorm<Eigen::Infinity>());
+		if (prim_res <= eps_prim && dual_res <= eps_dual) {
+			converged = true;
+			break;
+		}
+
+		if (cputime > 0. && (clock() - started_time) > allocated_time)
+			break;
+	}
+
+	// The primal-dual solution is the starting point of the next computation
+	warm_start_ = true;
+	solution_ = x_;
+	if (!converged) {
+		printf(YELLOW "Warning: the ADMM QP didn't converge after %i iterations\n"
+				COLOR_RESET, iterations_ > max_iter_ ? max_iter_ : iterations_);
+		return false;
+	}
+
+	return true;
+}
+
+} //@namespace solver
+} //@namespace dwl
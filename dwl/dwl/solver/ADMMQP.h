@@ -0,0 +1,224 @@
+#ifndef DWL__SOLVER__ADMM_QP__H
+#define DWL__SOLVER__ADMM_QP__H
+
+#include <dwl/solver/QuadraticProgram.h>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/**
+ * @class ADMMQP
+ * @brief Implementation of a sparse QP solver based on the Alternating Direction Method of
+ * Multipliers (ADMM), following the operator splitting of OSQP (Stellato et al., 2017: "OSQP: An
+ * Operator Splitting Solver for Quadratic Programs"). It solves QPs of the following form
+ * \f[
+ * 	\min_{\mathbf{x}} \frac{1}{2}\mathbf{x}^T\mathbf{H}\mathbf{x} + \mathbf{x}^T\mathbf{g}
+ * \f]
+ * suject to
+ * \f{eqnarray*}{
+ *	lbG \leq &\mathbf{Gx}& \leq ubG \\
+ *	lb   \leq &\mathbf{x}&  \leq ub
+ * \f}
+ * Every iteration solves a linear system with a sparse Cholesky factorization, which is computed
+ * only when the matrices change. So, the block-banded matrices of uncondensed MPC problems are
+ * solved without dense factorizations, and the hotstart with new vectors reuses both the
+ * factorization and the last primal-dual solution
+ */
+class ADMMQP : public QuadraticProgram
+{
+	public:
+		using QuadraticProgram::init;
+		using QuadraticProgram::compute;
+		using QuadraticProgram::hotstart;
+
+		/** @brief Constructor function */
+		ADMMQP();
+
+		/** @brief Destructor function */
+		~ADMMQP();
+
+		/**
+		 * @brief Initialization of the ADMM solver
+		 * @param unsigned int Number of variables of the QP problem
+	 	 * @param unsigned int Number of constraints of the QP problem
+		 * @return True if was initialized
+		 */
+		bool init(unsigned int num_variables,
+				  unsigned int num_constraints);
+
+		/**
+	 	 * @brief Function to compute the QP solution with dense matrices, which are converted
+	 	 * to sparse ones
+	 	 * @param const Eigen::MatrixXd& Hessian matrix
+	 	 * @param const Eigen::VectorXd Gradient vector
+	 	 * @param const Eigen::MatrixXd& Constraint matrix
+	 	 * @param const Eigen::VectorXd Low bound vector
+	 	 * @param const Eigen::VectorXd Upper bound vector
+	 	 * @param const Eigen::VectorXd Low constraint vector
+	 	 * @param const Eigen::VectorXd Upper constraint vector
+	 	 * @param double CPU-time for computing the optimization
+	 	 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool compute(const Eigen::MatrixXd& hessian,
+					 const Eigen::VectorXd& gradient,
+					 const Eigen::MatrixXd& constraint_mat,
+					 const Eigen::VectorXd& lower_bound,
+					 const Eigen::VectorXd& upper_bound,
+					 const Eigen::VectorXd& lower_constraint,
+					 const Eigen::VectorXd& upper_constraint,
+					 double cputime);
+
+		/**
+	 	 * @brief Function to compute the QP solution with sparse matrices, where the last
+	 	 * primal-dual solution is used as starting point if the dimensions don't change
+	 	 * @param const Eigen::SparseMatrix<double>& Hessian matrix
+	 	 * @param const Eigen::VectorXd Gradient vector
+	 	 * @param const Eigen::SparseMatrix<double>& Constraint matrix
+	 	 * @param const Eigen::VectorXd Low bound vector
+	 	 * @param const Eigen::VectorXd Upper bound vector
+	 	 * @param const Eigen::VectorXd Low constraint vector
+	 	 * @param const Eigen::VectorXd Upper constraint vector
+	 	 * @param double CPU-time for computing the optimization
+	 	 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool compute(const Eigen::SparseMatrix<double>& hessian,
+					 const Eigen::VectorXd& gradient,
+					 const Eigen::SparseMatrix<double>& constraint_mat,
+					 const Eigen::VectorXd& lower_bound,
+					 const Eigen::VectorXd& upper_bound,
+					 const Eigen::VectorXd& lower_constraint,
+					 const Eigen::VectorXd& upper_constraint,
+					 double cputime);
+
+		/**
+		 * @brief Function to compute the QP solution with new vectors, where the factorization
+		 * and the primal-dual solution of the last computation are reused
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool hotstart(const Eigen::VectorXd& gradient,
+					  const Eigen::VectorXd& lower_bound,
+					  const Eigen::VectorXd& upper_bound,
+					  const Eigen::VectorXd& lower_constraint,
+					  const Eigen::VectorXd& upper_constraint,
+					  double cputime);
+
+		/**
+		 * @brief Sets the ADMM parameters
+		 * @param double Penalty parameter (rho) of the inequality constraints
+		 * @param double Relaxation parameter (alpha), which is between 0 and 2
+		 * @param unsigned int Maximum number of iterations
+		 */
+		void setParameters(double rho,
+						   double alpha,
+						   unsigned int max_iterations);
+
+		/**
+		 * @brief Sets the absolute and relative tolerances of the primal and dual residuals
+		 * @param double Absolute tolerance
+		 * @param double Relative tolerance
+		 */
+		void setTolerances(double absolute,
+						   double relative);
+
+		/** @brief Gets the number of iterations of the last computation */
+		unsigned int getNumberOfIterations() const;
+
+
+	private:
+		/**
+		 * @brief Sets the stacked constraints, i.e. the constraint matrix and the identity of
+		 * the bounds, and factorizes the linear system of the ADMM iterations
+		 * @param const Eigen::SparseMatrix<double>& Hessian matrix
+		 * @param const Eigen::SparseMatrix<double>& Constraint matrix
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @return bool Label that indicates if the factorization is successful
+		 */
+		bool factorize(const Eigen::SparseMatrix<double>& hessian,
+					   const Eigen::SparseMatrix<double>& constraint_mat,
+					   const Eigen::VectorXd& lower_bound,
+					   const Eigen::VectorXd& upper_bound,
+					   const Eigen::VectorXd& lower_constraint,
+					   const Eigen::VectorXd& upper_constraint);
+
+		/**
+		 * @brief Sets the stacked bounds of the constraints
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 */
+		void setBounds(const Eigen::VectorXd& lower_bound,
+					   const Eigen::VectorXd& upper_bound,
+					   const Eigen::VectorXd& lower_constraint,
+					   const Eigen::VectorXd& upper_constraint);
+
+		/**
+		 * @brief Runs the ADMM iterations from the current primal-dual point
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the iterations converged
+		 */
+		bool solve(const Eigen::VectorXd& gradient,
+				   double cputime);
+
+		/** @brief Hessian matrix */
+		Eigen::SparseMatrix<double> hessian_;
+
+		/** @brief Constraint matrix */
+		Eigen::SparseMatrix<double> constraint_mat_;
+
+		/** @brief Stacked constraint matrix, i.e. the constraint matrix and the identity */
+		Eigen::SparseMatrix<double> stacked_mat_;
+
+		/** @brief Transpose of the stacked constraint matrix */
+		Eigen::SparseMatrix<double> stacked_mat_t_;
+
+		/** @brief Sparse Cholesky factorization of the linear system */
+		Eigen::SimplicialLLT<Eigen::SparseMatrix<double> > linear_solver_;
+
+		/** @brief Stacked lower and upper bounds */
+		Eigen::VectorXd stacked_lower_;
+		Eigen::VectorXd stacked_upper_;
+
+		/** @brief Penalty of every stacked constraint (larger for equalities) */
+		Eigen::VectorXd rho_vec_;
+
+		/** @brief Primal and dual variables of the ADMM iterations */
+		Eigen::VectorXd x_;
+		Eigen::VectorXd z_;
+		Eigen::VectorXd y_;
+
+		/** @brief ADMM parameters */
+		double rho_;
+		double sigma_;
+		double alpha_;
+		unsigned int max_iter_;
+
+		/** @brief Tolerances of the residuals */
+		double eps_abs_;
+		double eps_rel_;
+
+		/** @brief Number of iterations of the last computation */
+		unsigned int iterations_;
+
+		/** @brief Indicates if the primal-dual variables can warm-start the iterations */
+		bool warm_start_;
+};
+
+} //@namespace solver
+} //@namespace dwl
+
+#endif
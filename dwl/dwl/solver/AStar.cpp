@@ -1,4 +1,5 @@
 #include <dwl/solver/AStar.h>
+#include <dwl/utils/Instrumentation.h>
 
 
 namespace dwl
@@ -7,7 +8,13 @@ namespace dwl
 namespace solver
 {
 
-AStar::AStar() : expansions_(0)
+/** @brief Directions of the 8-connected grid, where the diagonal ones are odd */
+static const int GridDx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int GridDy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const unsigned char NoDirection = 8;
+
+
+AStar::AStar() : direction_table_(NoDirection), jump_point_search_(false), expansions_(0)
 {
 	name_ = "A-star";
 }
@@ -29,25 +36,54 @@ bool AStar::compute(Vertex source,
 					Vertex target,
 					double computation_time)
 {
+	DWL_SCOPED_TIMER("AStar::compute");
+
 	if (!is_set_adjacency_model_) {
 		printf(RED "Could not computed the shortest path because "
 				"it is required to defined an adjacency model\n" COLOR_RESET);
 		return false;
 	}
 
+	// Freeing the search structures of the previous query
+	search_pool_.reset();
+
+	if (jump_point_search_ && !indexed_heap_)
+		printf(YELLOW "Warning: the jump point search requires the indexed heap, so it isn't"
+				" used\n" COLOR_RESET);
+
 	// Computing the shortest path
-	findShortestPath(source, target);
+	if (indexed_heap_ && jump_point_search_)
+		findShortestPathWithJumps(source, target);
+	else if (indexed_heap_)
+		findShortestPathWithHeap(source, target);
+	else
+		findShortestPath(source, target);
 
 	return true;
 }
 
 
+void AStar::setJumpPointSearch(bool enable)
+{
+	jump_point_search_ = enable;
+}
+
+
+int AStar::getNumberOfExpansions() const
+{
+	return expansions_;
+}
+
+
 void AStar::findShortestPath(Vertex source,
 							 Vertex target)
 {
-	// Defining the f_cost and g_cost
-	CostMap f_cost;
-	CostMap g_cost;
+	// Defining the f_cost and g_cost, where the nodes of the containers are allocated from
+	// the search pool
+	typedef std::map<Vertex, Weight, std::less<Vertex>,
+			utils::PoolAllocator<std::pair<const Vertex, Weight> > > PoolCostMap;
+	PoolCostMap f_cost(PoolCostMap::key_compare(), edge_allocator_);
+	PoolCostMap g_cost(PoolCostMap::key_compare(), edge_allocator_);
 
 	// Setting the initial time
 	time_started_ = clock();
@@ -57,9 +93,13 @@ void AStar::findShortestPath(Vertex source,
 
 	// Defining the set of nodes already evaluated (openset), the set of
 	// tentative nodes to be evaluated (openset), and ordered openset queue
-	std::set< std::pair<Weight, Vertex>, pair_first_less<Weight, Vertex> > openset_queue;
-	std::map<Vertex, bool> openset;
-	std::map<Vertex, bool> closedset;
+	typedef std::set<std::pair<Weight, Vertex>, pair_first_less<Weight, Vertex>,
+			utils::PoolAllocator<std::pair<Weight, Vertex> > > PoolSetQueue;
+	typedef std::map<Vertex, bool, std::less<Vertex>,
+			utils::PoolAllocator<std::pair<const Vertex, bool> > > PoolSet;
+	PoolSetQueue openset_queue(PoolSetQueue::key_compare(), edge_allocator_);
+	PoolSet openset(PoolSet::key_compare(), edge_allocator_);
+	PoolSet closedset(PoolSet::key_compare(), edge_allocator_);
 
 	// Cost from start along best known path.
 	g_cost[source] = 0;
@@ -89,9 +129,12 @@ void AStar::findShortestPath(Vertex source,
 		closedset[current] = true;
 
 		// Visit each edge exiting in the current vertex
-		std::list<Edge> successors;
-		adjacency_->getSuccessors(successors, current);
-		for (std::list<Edge>::iterator edge_iter = successors.begin();
+		EdgeList successors(edge_allocator_);
+		{
+			DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+			adjacency_->getSuccessors(successors, current);
+		}
+		for (EdgeList::iterator edge_iter = successors.begin();
 						edge_iter != successors.end();
 						edge_iter++)
 		{
@@ -114,6 +157,7 @@ void AStar::findShortestPath(Vertex source,
 			}
 		}
 		expansions_++;
+		DWL_COUNT_EVENTS("AStar::expansions", 1);
 
 		// Computing the minimum f cost
 		Vertex current_vertex = openset_queue.begin()->second;
@@ -124,6 +168,271 @@ void AStar::findShortestPath(Vertex source,
 	total_cost_ = g_cost[target];
 }
 
+
+void AStar::findShortestPathWithHeap(Vertex source,
+									 Vertex target)
+{
+	// Setting the initial time
+	time_started_ = clock();
+
+	// Number of expansions
+	expansions_ = 0;
+
+	// Clearing the previous search, note that only the touched vertices are reset
+	openset_heap_.clear();
+	g_cost_table_.clear();
+	closedset_table_.clear();
+	policy_table_.clear();
+
+	// Cost from start along best known path, and adding the start vertex to the openset
+	// with its estimated total cost
+	g_cost_table_[source] = 0;
+	openset_heap_.push(source, adjacency_->heuristicCost(source, target));
+	while (!openset_heap_.empty()) {
+		Vertex current = openset_heap_.top();
+
+		// Checking if it is getted the target
+		if (adjacency_->isReachedGoal(target, current)) {
+			if (current != target) {
+				policy_table_[target] = current;
+				g_cost_table_[target] = g_cost_table_.get(current);
+			}
+			break;
+		}
+
+		// Moving the current vertex from the openset to the closedset
+		openset_heap_.pop();
+		closedset_table_[current] = 1;
+
+		// Visit each edge exiting in the current vertex
+		EdgeList successors(edge_allocator_);
+		{
+			DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+			adjacency_->getSuccessors(successors, current);
+		}
+		Weight current_g_cost = g_cost_table_.get(current);
+		for (EdgeList::iterator edge_iter = successors.begin();
+				edge_iter != successors.end();
+				edge_iter++)
+		{
+			Vertex neighbor = edge_iter->target;
+			if (closedset_table_.count(neighbor) > 0)
+				continue;
+
+			// Updating the neighbor, where its queue priority is decreased in place
+			Weight tentative_g_cost = current_g_cost + edge_iter->weight;
+			Weight& neighbor_g_cost = g_cost_table_[neighbor];
+			if (tentative_g_cost < neighbor_g_cost) {
+				neighbor_g_cost = tentative_g_cost;
+				policy_table_[neighbor] = current;
+				openset_heap_.push(neighbor, tentative_g_cost +
+								   adjacency_->heuristicCost(neighbor, target));
+			}
+		}
+		expansions_++;
+		DWL_COUNT_EVENTS("AStar::expansions", 1);
+	}
+
+	total_cost_ = g_cost_table_.get(target);
+}
+
+
+void AStar::findShortestPathWithJumps(Vertex source,
+									  Vertex target)
+{
+	// Setting the initial time
+	time_started_ = clock();
+
+	// Number of expansions
+	expansions_ = 0;
+
+	// Clearing the previous search, note that only the touched vertices are reset
+	openset_heap_.clear();
+	g_cost_table_.clear();
+	closedset_table_.clear();
+	policy_table_.clear();
+	direction_table_.clear();
+
+	g_cost_table_[source] = 0;
+	openset_heap_.push(source, adjacency_->heuristicCost(source, target));
+	Edge neighbors[8];
+	bool in_grid[8];
+	while (!openset_heap_.empty()) {
+		Vertex current = openset_heap_.top();
+
+		// Checking if it is getted the target
+		if (adjacency_->isReachedGoal(target, current)) {
+			if (current != target) {
+				policy_table_[target] = current;
+				g_cost_table_[target] = g_cost_table_.get(current);
+			}
+			break;
+		}
+
+		// Moving the current vertex from the openset to the closedset
+		openset_heap_.pop();
+		closedset_table_[current] = 1;
+
+		Weight current_g_cost = g_cost_table_.get(current);
+		if (getGridNeighbors(neighbors, in_grid, current)) {
+			// Jumping in the natural directions of the uniform cell, i.e. all the directions
+			// if it wasn't reached by a jump, the jump direction if it's straight, and the
+			// jump direction and its components if it's diagonal
+			unsigned int arrival = direction_table_.get(current);
+			for (unsigned int direction = 0; direction < 8; direction++) {
+				if (arrival != NoDirection && direction != arrival &&
+						!(arrival % 2 == 1 && (direction == (arrival + 1) % 8 ||
+											   direction == (arrival + 7) % 8)))
+					continue;
+
+				Vertex jump_point;
+				Weight jump_cost;
+				unsigned int steps;
+				if (!jump(jump_point, jump_cost, steps, current, direction, target) ||
+						closedset_table_.count(jump_point) > 0)
+					continue;
+
+				Weight tentative_g_cost = current_g_cost + jump_cost;
+				Weight& jump_g_cost = g_cost_table_[jump_point];
+				if (tentative_g_cost < jump_g_cost) {
+					jump_g_cost = tentative_g_cost;
+					policy_table_[jump_point] = recordJump(current, current_g_cost,
+														   direction, steps);
+					direction_table_[jump_point] = direction;
+					openset_heap_.push(jump_point, tentative_g_cost +
+									   adjacency_->heuristicCost(jump_point, target));
+				}
+			}
+		} else {
+			// Visit each edge exiting in the current vertex, as in A*
+			EdgeList successors(edge_allocator_);
+			{
+				DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+				adjacency_->getSuccessors(successors, current);
+			}
+			for (EdgeList::iterator edge_iter = successors.begin();
+					edge_iter != successors.end();
+					edge_iter++)
+			{
+				Vertex neighbor = edge_iter->target;
+				if (closedset_table_.count(neighbor) > 0)
+					continue;
+
+				Weight tentative_g_cost = current_g_cost + edge_iter->weight;
+				Weight& neighbor_g_cost = g_cost_table_[neighbor];
+				if (tentative_g_cost < neighbor_g_cost) {
+					neighbor_g_cost = tentative_g_cost;
+					policy_table_[neighbor] = current;
+					direction_table_.erase(neighbor);
+					openset_heap_.push(neighbor, tentative_g_cost +
+									   adjacency_->heuristicCost(neighbor, target));
+				}
+			}
+		}
+		expansions_++;
+		DWL_COUNT_EVENTS("AStar::expansions", 1);
+	}
+
+	total_cost_ = g_cost_table_.get(target);
+}
+
+
+bool AStar::jump(Vertex& jump_point,
+				 Weight& cost,
+				 unsigned int& steps,
+				 Vertex vertex,
+				 unsigned int direction,
+				 Vertex target)
+{
+	cost = 0.;
+	steps = 0;
+	Edge neighbors[8];
+	bool in_grid[8];
+	Edge next;
+	next.target = vertex;
+	while (true) {
+		// Stepping in the direction until the end of the grid
+		if (!adjacency_->getGridNeighbor(next, next.target,
+										 GridDx[direction], GridDy[direction]))
+			return false;
+		cost += next.weight;
+		steps++;
+		jump_point = next.target;
+
+		// The goal and the cells near cost changes are jump points, where the latter are
+		// expanded with the successors of the adjacency model
+		if (adjacency_->isReachedGoal(target, jump_point))
+			return true;
+
+		getGridNeighbors(neighbors, in_grid, jump_point);
+		for (unsigned int i = 0; i < 8; i++) {
+			if (in_grid[i] && neighbors[i].weight != next.weight)
+				return true;
+		}
+
+		// The cells with forced neighbors are jump points, i.e. a neighbor that is only
+		// reached optimally through this cell because of the cells out of the grid
+		if (direction % 2 == 0) {
+			if ((!in_grid[(direction + 2) % 8] && in_grid[(direction + 1) % 8]) ||
+					(!in_grid[(direction + 6) % 8] && in_grid[(direction + 7) % 8]))
+				return true;
+		} else {
+			if ((!in_grid[(direction + 3) % 8] && in_grid[(direction + 2) % 8]) ||
+					(!in_grid[(direction + 5) % 8] && in_grid[(direction + 6) % 8]))
+				return true;
+
+			// A diagonal scan stops where the straight scans of its components find a jump
+			// point
+			Vertex straight_point;
+			Weight straight_cost;
+			unsigned int straight_steps;
+			if (jump(straight_point, straight_cost, straight_steps,
+					 jump_point, (direction + 1) % 8, target) ||
+					jump(straight_point, straight_cost, straight_steps,
+						 jump_point, (direction + 7) % 8, target))
+				return true;
+		}
+	}
+}
+
+
+bool AStar::getGridNeighbors(Edge* neighbors,
+							 bool* in_grid,
+							 Vertex vertex)
+{
+	bool uniform = true;
+	for (unsigned int i = 0; i < 8; i++) {
+		in_grid[i] = adjacency_->getGridNeighbor(neighbors[i], vertex, GridDx[i], GridDy[i]);
+		uniform = uniform && in_grid[i] && neighbors[i].weight == neighbors[0].weight;
+	}
+
+	return uniform;
+}
+
+
+Vertex AStar::recordJump(Vertex vertex,
+						 Weight cost,
+						 unsigned int direction,
+						 unsigned int steps)
+{
+	// Recording the cells before the jump point, where their costs are only improved
+	Edge next;
+	next.target = vertex;
+	Vertex previous = vertex;
+	for (unsigned int k = 1; k < steps; k++) {
+		adjacency_->getGridNeighbor(next, previous, GridDx[direction], GridDy[direction]);
+		cost += next.weight;
+		Weight& next_cost = g_cost_table_[next.target];
+		if (cost < next_cost) {
+			next_cost = cost;
+			policy_table_[next.target] = previous;
+		}
+		previous = next.target;
+	}
+
+	return previous;
+}
+
 } //@namespace solver
 } //@namespace dwl
 
@@ -41,6 +41,21 @@ class AStar : public SearchTreeSolver
 					 Vertex target,
 					 double computation_time);
 
+		/**
+		 * @brief Enables/disables the jump point search (JPS) on the uniform-cost regions of the
+		 * grid-based adjacency models. A cell whose 8 neighbors have its cost is expanded with
+		 * jumps, i.e. straight and diagonal scans in its natural directions that stop at the
+		 * cells near cost changes or obstacles (forced neighbors) and at the goal, so the scanned
+		 * cells aren't queued. The rest of cells are expanded with the successors of the
+		 * adjacency model. Note that it requires the indexed heap (see setIndexedHeap), and the
+		 * models without grid (see AdjacencyModel::getGridNeighbor) are searched as in A*
+		 * @param bool True for enabling the jump point search
+		 */
+		void setJumpPointSearch(bool enable);
+
+		/** @brief Gets the number of expansions of the last computation */
+		int getNumberOfExpansions() const;
+
 
 	private:
 		/**
@@ -51,6 +66,72 @@ class AStar : public SearchTreeSolver
 		void findShortestPath(Vertex source,
 							  Vertex target);
 
+		/**
+		 * @brief Computes the minimum cost and previous vertex according to the shortest A* path
+		 * using the indexed heap and vertex tables
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 */
+		void findShortestPathWithHeap(Vertex source,
+									  Vertex target);
+
+		/**
+		 * @brief Computes the minimum cost and previous vertex according to the shortest A* path
+		 * with the jump point search on the uniform-cost regions
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 */
+		void findShortestPathWithJumps(Vertex source,
+									   Vertex target);
+
+		/**
+		 * @brief Scans the grid from a vertex in a direction until a jump point
+		 * @param Vertex& Jump point
+		 * @param Weight& Cost from the vertex to the jump point
+		 * @param unsigned int& Number of steps to the jump point
+		 * @param Vertex Current vertex
+		 * @param unsigned int Direction of the scan
+		 * @param Vertex Target vertex
+		 * @return True if there is a jump point
+		 */
+		bool jump(Vertex& jump_point,
+				  Weight& cost,
+				  unsigned int& steps,
+				  Vertex vertex,
+				  unsigned int direction,
+				  Vertex target);
+
+		/**
+		 * @brief Gets the 8-connected neighbors of a vertex
+		 * @param Edge* Neighbors in the order of the directions
+		 * @param bool* Indicates if the neighbors are part of the grid
+		 * @param Vertex Current vertex
+		 * @return True if the neighbors are part of the grid and they have the same cost
+		 */
+		bool getGridNeighbors(Edge* neighbors,
+							  bool* in_grid,
+							  Vertex vertex);
+
+		/**
+		 * @brief Records the previous vertices and costs of the cells of a jump, so the path
+		 * has every cell
+		 * @param Vertex Vertex of the jump
+		 * @param Weight Cost of the vertex
+		 * @param unsigned int Direction of the jump
+		 * @param unsigned int Number of steps of the jump
+		 * @return Vertex Previous vertex of the jump point
+		 */
+		Vertex recordJump(Vertex vertex,
+						Weight cost,
+						unsigned int direction,
+						unsigned int steps);
+
+		/** @brief Directions of the jumps that reached the vertices */
+		VertexTable<unsigned char> direction_table_;
+
+		/** @brief Label that indicates if the jump point search is enabled */
+		bool jump_point_search_;
+
 		/** @brief number of expansions */
 		int expansions_;
 };
@@ -0,0 +1,190 @@
+#include <dwl/solver/ActiveSetQP.h>
+#include <dwl/utils/Macros.h>
+#include <stdio.h>
+#include <cmath>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+ActiveSetQP::ActiveSetQP() : max_iter_(100), tolerance_(1e-9), iterations_(0)
+{
+
+}
+
+
+ActiveSetQP::~ActiveSetQP()
+{
+
+}
+
+
+bool ActiveSetQP::compute(const Eigen::MatrixXd& hessian,
+						  const Eigen::VectorXd& gradient,
+						  const Eigen::MatrixXd& constraint_mat,
+						  const Eigen::VectorXd& lower_constraint,
+						  const Eigen::VectorXd& starting_point)
+{
+	unsigned int num_variables = hessian.rows();
+	unsigned int num_constraints = constraint_mat.rows();
+	iterations_ = 0;
+
+	// Checking the feasibility of the starting point
+	solution_ = starting_point;
+	Eigen::VectorXd slack = constraint_mat * solution_ - lower_constraint;
+	if (num_constraints > 0 && slack.minCoeff() < -tolerance_) {
+		printf(YELLOW "Warning: the starting point of the active-set QP is infeasible\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	// The initial working set is composed by the constraints of the last working set that are
+	// active in the starting point and linearly independent
+	std::vector<unsigned int> last_working_set;
+	if (is_working_.size() == num_constraints)
+		last_working_set.swap(working_set_);
+	working_set_.clear();
+	is_working_.assign(num_constraints, false);
+	for (unsigned int i = 0; i < last_working_set.size(); i++) {
+		unsigned int index = last_working_set[i];
+		if (std::fabs(slack(index)) > tolerance_ || working_set_.size() >= num_variables)
+			continue;
+
+		Eigen::MatrixXd working_mat(working_set_.size() + 1, num_variables);
+		for (unsigned int j = 0; j < working_set_.size(); j++)
+			working_mat.row(j) = constraint_mat.row(working_set_[j]);
+		working_mat.row(working_set_.size()) = constraint_mat.row(index);
+		if ((unsigned int) Eigen::FullPivLU<Eigen::MatrixXd>(working_mat).rank() ==
+				working_set_.size() + 1) {
+			working_set_.push_back(index);
+			is_working_[index] = true;
+		}
+	}
+
+	Eigen::VectorXd step, multipliers;
+	while (iterations_ < max_iter_) {
+		iterations_++;
+
+		// Computing the step of the working set
+		solveWorkingSet(step, multipliers,
+						hessian, hessian * solution_ + gradient, constraint_mat);
+
+		// Note that the tolerances are relative to the scale of the solution and multipliers
+		double step_tolerance = tolerance_ * (1. + solution_.lpNorm<Eigen::Infinity>());
+		if (step.lpNorm<Eigen::Infinity>() <= step_tolerance) {
+			// The point is optimal if all the multipliers are non-negative. Otherwise, a
+			// constraint with negative multiplier leaves the working set. Note that the lowest
+			// index is chosen (Bland's rule), since the friction pyramids are degenerate in
+			// the origin and the most negative multiplier could cycle
+			int leaving = -1;
+			double multiplier_tolerance = (working_set_.empty()) ? tolerance_ :
+					tolerance_ * (1. + multipliers.lpNorm<Eigen::Infinity>());
+			for (unsigned int i = 0; i < working_set_.size(); i++) {
+				if (multipliers(i) < -multiplier_tolerance &&
+						(leaving < 0 || working_set_[i] < working_set_[leaving]))
+					leaving = i;
+			}
+			if (leaving < 0)
+				return true;
+
+			is_working_[working_set_[leaving]] = false;
+			working_set_.erase(working_set_.begin() + leaving);
+		} else {
+			// Computing the step length, where the first blocking constraint enters the
+			// working set
+			double step_length = 1.;
+			int blocking = -1;
+			for (unsigned int i = 0; i < num_constraints; i++) {
+				if (is_working_[i])
+					continue;
+
+				double direction = constraint_mat.row(i).dot(step);
+				if (direction < -1e-12) {
+					double distance = lower_constraint(i) - constraint_mat.row(i).dot(solution_);
+					double length = std::max(distance / direction, 0.);
+					if (length < step_length) {
+						step_length = length;
+						blocking = i;
+					}
+				}
+			}
+
+			solution_ += step_length * step;
+			if (blocking >= 0) {
+				working_set_.push_back(blocking);
+				is_working_[blocking] = true;
+			}
+		}
+	}
+
+	printf(YELLOW "Warning: the active-set QP reached the maximum number of iterations\n"
+			COLOR_RESET);
+	return false;
+}
+
+
+void ActiveSetQP::setParameters(unsigned int max_iterations,
+								double tolerance)
+{
+	max_iter_ = max_iterations;
+	tolerance_ = tolerance;
+}
+
+
+void ActiveSetQP::reset()
+{
+	working_set_.clear();
+	is_working_.clear();
+}
+
+
+const Eigen::VectorXd& ActiveSetQP::getOptimalSolution() const
+{
+	return solution_;
+}
+
+
+const std::vector<unsigned int>& ActiveSetQP::getActiveSet() const
+{
+	return working_set_;
+}
+
+
+unsigned int ActiveSetQP::getNumberOfIterations() const
+{
+	return iterations_;
+}
+
+
+void ActiveSetQP::solveWorkingSet(Eigen::VectorXd& step,
+								  Eigen::VectorXd& multipliers,
+								  const Eigen::MatrixXd& hessian,
+								  const Eigen::VectorXd& gradient,
+								  const Eigen::MatrixXd& constraint_mat)
+{
+	// Composing the KKT system, i.e. [H A_W'; A_W 0] [p; -lambda] = [-(H x + g); 0]
+	unsigned int num_variables = hessian.rows();
+	unsigned int num_working = working_set_.size();
+	kkt_mat_.setZero(num_variables + num_working, num_variables + num_working);
+	kkt_mat_.topLeftCorner(num_variables, num_variables) = hessian;
+	for (unsigned int i = 0; i < num_working; i++) {
+		kkt_mat_.block(num_variables + i, 0, 1, num_variables) =
+				constraint_mat.row(working_set_[i]);
+		kkt_mat_.block(0, num_variables + i, num_variables, 1) =
+				constraint_mat.row(working_set_[i]).transpose();
+	}
+	kkt_vec_.setZero(num_variables + num_working);
+	kkt_vec_.head(num_variables) = -gradient;
+
+	// Solving the KKT system, which is nonsingular because the working set is linearly
+	// independent and the Hessian is positive definite
+	kkt_sol_ = kkt_mat_.partialPivLu().solve(kkt_vec_);
+	step = kkt_sol_.head(num_variables);
+	multipliers = -kkt_sol_.tail(num_working);
+}
+
+} //@namespace solver
+} //@namespace dwl
@@ -0,0 +1,117 @@
+#ifndef DWL__SOLVER__ACTIVE_SET_QP__H
+#define DWL__SOLVER__ACTIVE_SET_QP__H
+
+#include <Eigen/Dense>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/**
+ * @class ActiveSetQP
+ * @brief Primal active-set solver of small and dense QPs with inequality constraints (Nocedal
+ * and Wright, 2006, Section 16.5), e.g. the distribution of contact forces with friction
+ * pyramids. It solves QPs of the following form
+ * \f[
+ * 	\min_{\mathbf{x}} \frac{1}{2}\mathbf{x}^T\mathbf{H}\mathbf{x} + \mathbf{x}^T\mathbf{g}
+ * \f]
+ * suject to
+ * \f[
+ * 	\mathbf{Ax} \geq \mathbf{b}
+ * \f]
+ * where the Hessian is positive definite. The working set of the last computation is reused
+ * in the next one, so a sequence of similar problems (e.g. the ticks of a controller) usually
+ * converges in one or two iterations. It isn't derived from QuadraticProgram, since it doesn't
+ * allocate memory for the two-sided bounds of that interface
+ */
+class ActiveSetQP
+{
+	public:
+		/** @brief Constructor function */
+		ActiveSetQP();
+
+		/** @brief Destructor function */
+		~ActiveSetQP();
+
+		/**
+		 * @brief Computes the QP solution from a feasible starting point. The constraints of
+		 * the last working set that are active in the starting point define the initial
+		 * working set
+		 * @param const Eigen::MatrixXd& Hessian matrix
+		 * @param const Eigen::VectorXd& Gradient vector
+		 * @param const Eigen::MatrixXd& Constraint matrix
+		 * @param const Eigen::VectorXd& Lower constraint vector
+		 * @param const Eigen::VectorXd& Feasible starting point
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool compute(const Eigen::MatrixXd& hessian,
+					 const Eigen::VectorXd& gradient,
+					 const Eigen::MatrixXd& constraint_mat,
+					 const Eigen::VectorXd& lower_constraint,
+					 const Eigen::VectorXd& starting_point);
+
+		/**
+		 * @brief Sets the solver parameters
+		 * @param unsigned int Maximum number of iterations
+		 * @param double Tolerance of the step, multipliers and active constraints
+		 */
+		void setParameters(unsigned int max_iterations,
+						   double tolerance);
+
+		/** @brief Discards the working set, so the next computation starts from scratch */
+		void reset();
+
+		/** @brief Gets the solution of the last computation */
+		const Eigen::VectorXd& getOptimalSolution() const;
+
+		/** @brief Gets the active constraints of the last computation */
+		const std::vector<unsigned int>& getActiveSet() const;
+
+		/** @brief Gets the number of iterations of the last computation */
+		unsigned int getNumberOfIterations() const;
+
+
+	private:
+		/**
+		 * @brief Solves the equality-constrained QP of the working set for the step, i.e.
+		 * min 0.5 p' H p + (H x + g)' p s.t. A_W p = 0, and its multipliers
+		 * @param Eigen::VectorXd& Step
+		 * @param Eigen::VectorXd& Multipliers of the working set
+		 * @param const Eigen::MatrixXd& Hessian matrix
+		 * @param const Eigen::VectorXd& Gradient in the current point, i.e. H x + g
+		 * @param const Eigen::MatrixXd& Constraint matrix
+		 */
+		void solveWorkingSet(Eigen::VectorXd& step,
+							 Eigen::VectorXd& multipliers,
+							 const Eigen::MatrixXd& hessian,
+							 const Eigen::VectorXd& gradient,
+							 const Eigen::MatrixXd& constraint_mat);
+
+		/** @brief Solution of the last computation */
+		Eigen::VectorXd solution_;
+
+		/** @brief Working set, i.e. the constraints that are imposed as equalities */
+		std::vector<unsigned int> working_set_;
+		std::vector<bool> is_working_;
+
+		/** @brief KKT system of the working set */
+		Eigen::MatrixXd kkt_mat_;
+		Eigen::VectorXd kkt_vec_;
+		Eigen::VectorXd kkt_sol_;
+
+		/** @brief Parameters of the solver */
+		unsigned int max_iter_;
+		double tolerance_;
+
+		/** @brief Number of iterations of the last computation */
+		unsigned int iterations_;
+};
+
+} //@namespace solver
+} //@namespace dwl
+
+#endif
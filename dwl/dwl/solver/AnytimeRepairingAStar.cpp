@@ -1,4 +1,5 @@
 #include <dwl/solver/AnytimeRepairingAStar.h>
+#include <dwl/utils/Instrumentation.h>
 #include <time.h>
 
 
@@ -33,16 +34,22 @@ bool AnytimeRepairingAStar::compute(Vertex source,
 									Vertex target,
 									double computation_time)
 {
+	DWL_SCOPED_TIMER("AnytimeRepairingAStar::compute");
+
 	if (!is_set_adjacency_model_) {
 		printf(RED "Could not computed the shortest path because "
 				"it is required to defined an adjacency model\n" COLOR_RESET);
 		return false;
 	}
 
+	// Freeing the search structures of the previous query
+	search_pool_.reset();
+
 	// Defining the set of nodes already evaluated (openset), the set of tentative nodes
 	// to be evaluated (openset), and ordered openset queue
-	SetQueue openset_queue;
-	Set openset, visitedset;
+	SetQueue openset_queue(SetQueue::key_compare(), edge_allocator_);
+	Set openset(Set::key_compare(), edge_allocator_);
+	Set visitedset(Set::key_compare(), edge_allocator_);
 
 	// Setting the initial time
 	time_started_ = clock();
@@ -56,6 +63,41 @@ bool AnytimeRepairingAStar::compute(Vertex source,
 	// Getting the allocated time for computing a solution
 	double allocated_time_secs = computation_time * (double) CLOCKS_PER_SEC;
 
+	if (indexed_heap_) {
+		// Clearing the previous search, note that the g cost of the unvisited vertices is
+		// infinity by default
+		openset_heap_.clear();
+		g_cost_table_.clear();
+		policy_table_.clear();
+
+		// Adding the start vertex to the openset with its estimated total cost
+		g_cost_table_[source] = 0;
+		double f_cost = satisfied_inflation_ * adjacency_->heuristicCost(source, target);
+		openset_heap_.push(source, f_cost);
+
+		// Computing the minimum f cost
+		min_f_cost_ = f_cost + satisfied_inflation_ * adjacency_->heuristicCost(source, target);
+
+		while ((satisfied_inflation_ > 1) && ((clock() - time_started_) < allocated_time_secs)) {
+			// Computing a path with reuse of states values
+			if (improvePathWithHeap(target, computation_time)) {
+				// Decreasing the current inflation gain
+				double next_inflation = min_f_cost_ / g_cost_table_.get(target);
+				if (current_inflation > next_inflation)
+					current_inflation = next_inflation;
+
+				if (current_inflation < 1)
+					current_inflation = 1;
+				satisfied_inflation_ = current_inflation;
+
+				total_cost_ = g_cost_table_.get(target);
+				publishSolution(source, target);
+			}
+		}
+
+		return true;
+	}
+
 	// Setting the g cost of the start and goal state
 	g_cost_[source] = 0;
 	g_cost_[target] = std::numeric_limits<double>::max();
@@ -87,6 +129,7 @@ bool AnytimeRepairingAStar::compute(Vertex source,
 			satisfied_inflation_ = current_inflation;
 
 			total_cost_ = g_cost_[target];
+			publishSolution(source, target);
 		}
 	}
 
@@ -100,8 +143,8 @@ bool AnytimeRepairingAStar::improvePath(SetQueue& openset_queue,
 										double computation_time)
 {
 	// Setting an empty closed set and inconsistent set
-	Set closedset;
-	SetQueue inconsistentset_queue;
+	Set closedset(Set::key_compare(), edge_allocator_);
+	SetQueue inconsistentset_queue(SetQueue::key_compare(), edge_allocator_);
 
 	double allocated_time_secs = computation_time * (double) CLOCKS_PER_SEC;
 	while ((!openset_queue.empty()) && ((clock() - time_started_) < allocated_time_secs)
@@ -115,9 +158,12 @@ bool AnytimeRepairingAStar::improvePath(SetQueue& openset_queue,
 		closedset[current] = true;
 
 		// Visit each edge exiting in the current vertex
-		std::list<Edge> successors;
-		adjacency_->getSuccessors(successors, current);
-		for (std::list<Edge>::iterator edge_iter = successors.begin();
+		EdgeList successors(edge_allocator_);
+		{
+			DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+			adjacency_->getSuccessors(successors, current);
+		}
+		for (EdgeList::iterator edge_iter = successors.begin();
 				edge_iter != successors.end();
 				edge_iter++)
 		{
@@ -144,6 +190,7 @@ bool AnytimeRepairingAStar::improvePath(SetQueue& openset_queue,
 		}
 
 		expansions_++;
+		DWL_COUNT_EVENTS("AnytimeRepairingAStar::expansions", 1);
 	}
 
 	// Setting open set with all over consistent states
@@ -156,10 +203,76 @@ bool AnytimeRepairingAStar::improvePath(SetQueue& openset_queue,
 	}
 
 	// Computing the minimum f cost
-	Vertex current_vertex = openset_queue.begin()->second;
-	double current_f_cost = openset_queue.begin()->first;
-	min_f_cost_ = current_f_cost +
-			satisfied_inflation_ * adjacency_->heuristicCost(current_vertex, target);
+	if (!openset_queue.empty()) {
+		Vertex current_vertex = openset_queue.begin()->second;
+		double current_f_cost = openset_queue.begin()->first;
+		min_f_cost_ = current_f_cost +
+				satisfied_inflation_ * adjacency_->heuristicCost(current_vertex, target);
+	}
+
+	return true;
+}
+
+
+
+bool AnytimeRepairingAStar::improvePathWithHeap(Vertex target,
+												double computation_time)
+{
+	// Setting an empty closed set and inconsistent set
+	closedset_table_.clear();
+	std::vector<std::pair<Weight, Vertex> > inconsistentset;
+
+	double allocated_time_secs = computation_time * (double) CLOCKS_PER_SEC;
+	while ((!openset_heap_.empty()) && ((clock() - time_started_) < allocated_time_secs)
+			&& (g_cost_table_.get(target) > min_f_cost_)) {
+		Vertex current = openset_heap_.top();
+
+		// Moving the current vertex from the openset to the closedset
+		openset_heap_.pop();
+		closedset_table_[current] = 1;
+
+		// Visit each edge exiting in the current vertex
+		EdgeList successors(edge_allocator_);
+		{
+			DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+			adjacency_->getSuccessors(successors, current);
+		}
+		Weight current_g_cost = g_cost_table_.get(current);
+		for (EdgeList::iterator edge_iter = successors.begin();
+				edge_iter != successors.end();
+				edge_iter++)
+		{
+			Vertex neighbor = edge_iter->target;
+
+			Weight tentative_g_cost = current_g_cost + edge_iter->weight;
+			Weight& neighbor_g_cost = g_cost_table_[neighbor];
+			if (tentative_g_cost < neighbor_g_cost) {
+				policy_table_[neighbor] = current;
+				neighbor_g_cost = tentative_g_cost;
+				double f_cost = tentative_g_cost +
+						satisfied_inflation_ * adjacency_->heuristicCost(neighbor, target);
+				if (closedset_table_.count(neighbor) == 0)
+					openset_heap_.push(neighbor, f_cost);
+				else
+					inconsistentset.push_back(std::pair<Weight, Vertex>(f_cost, neighbor));
+			}
+		}
+
+		expansions_++;
+		DWL_COUNT_EVENTS("AnytimeRepairingAStar::expansions", 1);
+	}
+
+	// Setting open set with all over consistent states
+	for (unsigned int i = 0; i < inconsistentset.size(); i++)
+		openset_heap_.push(inconsistentset[i].second, inconsistentset[i].first);
+
+	// Computing the minimum f cost
+	if (!openset_heap_.empty()) {
+		Vertex current_vertex = openset_heap_.top();
+		double current_f_cost = openset_heap_.topPriority();
+		min_f_cost_ = current_f_cost +
+				satisfied_inflation_ * adjacency_->heuristicCost(current_vertex, target);
+	}
 
 	return true;
 }
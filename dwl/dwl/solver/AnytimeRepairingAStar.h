@@ -41,11 +41,17 @@ class AnytimeRepairingAStar : public SearchTreeSolver
 					 Vertex target,
 					 double computation_time);
 
-		/** @brief Defines a ordered queue according to the less weight */
-		typedef std::set< std::pair<Weight, Vertex>, pair_first_less<Weight, Vertex> > SetQueue;
+		/**
+		 * @brief Defines a ordered queue according to the less weight, where the ties are broken
+		 * by the vertex so vertices with the same weight aren't dropped. Its nodes are
+		 * allocated from the search pool
+		 */
+		typedef std::set<std::pair<Weight, Vertex>, std::less<std::pair<Weight, Vertex> >,
+				utils::PoolAllocator<std::pair<Weight, Vertex> > > SetQueue;
 
-		/** @brief Defines a set of known vertex */
-		typedef std::map<Vertex, bool> Set;
+		/** @brief Defines a set of known vertex, whose nodes are allocated from the search pool */
+		typedef std::map<Vertex, bool, std::less<Vertex>,
+				utils::PoolAllocator<std::pair<const Vertex, bool> > > Set;
 
 
 	private:
@@ -61,6 +67,15 @@ class AnytimeRepairingAStar : public SearchTreeSolver
 						 Vertex target,
 						 double computation_time);
 
+		/**
+		 * @brief Improves the path according to inflation gain using the indexed heap and vertex
+		 * tables, where the openset is the openset heap of the solver
+		 * @param Vertex target Target vertex
+		 * @return True if the path was improved
+		 */
+		bool improvePathWithHeap(Vertex target,
+								 double computation_time);
+
 		/** @brief Initial inflation */
 		double initial_inflation_;
 
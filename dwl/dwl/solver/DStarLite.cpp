@@ -0,0 +1,321 @@
+#include <dwl/solver/DStarLite.h>
+#include <dwl/utils/Instrumentation.h>
+#include <time.h>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+DStarLite::DStarLite() : g_table_(std::numeric_limits<Weight>::infinity()),
+		rhs_table_(std::numeric_limits<Weight>::infinity()), visited_table_(0),
+		source_(0), target_(0), key_modifier_(0.), change_margin_(5),
+		is_initialized_search_(false), expansions_(0)
+{
+	name_ = "D* Lite";
+}
+
+
+DStarLite::~DStarLite()
+{
+	policy_.clear();
+}
+
+
+bool DStarLite::init()
+{
+	return true;
+}
+
+
+bool DStarLite::compute(Vertex source,
+						Vertex target,
+						double computation_time)
+{
+	DWL_SCOPED_TIMER("DStarLite::compute");
+
+	if (!is_set_adjacency_model_) {
+		printf(RED "Could not computed the shortest path because "
+				"it is required to defined an adjacency model\n" COLOR_RESET);
+		return false;
+	} else if (adjacency_->isLatticeRepresentation()) {
+		printf(RED "Could not computed the shortest path because it is lattice representation\n"
+				COLOR_RESET);
+		return false;
+	}
+
+	// Freeing the search structures of the previous query
+	search_pool_.reset();
+
+	// Setting the initial time
+	time_started_ = clock();
+
+	// Reusing the search tree if the target is the same, otherwise starting a new one
+	if (!is_initialized_search_ || target != target_)
+		initializeSearch(source, target);
+	else {
+		// Moving the source vertex, where the key modifier keeps the queue keys as lower
+		// bounds
+		if (source != source_) {
+			key_modifier_ += adjacency_->heuristicCost(source_, source);
+			source_ = source;
+		}
+
+		// Repairing the vertices affected by the terrain changes
+		repairChangedVertices();
+	}
+
+	// Computing the shortest path
+	expansions_ = 0;
+	bool is_consistent = computeShortestPath(computation_time);
+	extractPath();
+
+	return is_consistent && (total_cost_ < std::numeric_limits<Weight>::infinity());
+}
+
+
+void DStarLite::setChangeMargin(unsigned int margin)
+{
+	change_margin_ = margin;
+}
+
+
+void DStarLite::resetSearch()
+{
+	is_initialized_search_ = false;
+}
+
+
+void DStarLite::initializeSearch(Vertex source,
+								 Vertex target)
+{
+	// Clearing the previous search, note that only the touched vertices are reset
+	queue_.clear();
+	g_table_.clear();
+	rhs_table_.clear();
+	visited_table_.clear();
+	visited_.clear();
+
+	source_ = source;
+	target_ = target;
+	key_modifier_ = 0.;
+
+	// The search tree is rooted in the target vertex
+	touchVertex(target_);
+	rhs_table_[target_] = 0.;
+	queue_.push(target_, computeKey(target_));
+
+	// The whole terrain is considered in the current search
+	if (terrain_ != NULL)
+		terrain_->clearDirtyRegion();
+
+	is_initialized_search_ = true;
+}
+
+
+bool DStarLite::computeShortestPath(double computation_time)
+{
+	// Getting the allocated time for computing a solution
+	double allocated_time_secs = computation_time * (double) CLOCKS_PER_SEC;
+
+	while (!queue_.empty() && ((queue_.topPriority() < computeKey(source_)) ||
+			(rhs_table_.get(source_) > g_table_.get(source_)))) {
+		if ((clock() - time_started_) > allocated_time_secs)
+			return false;
+
+		Vertex current = queue_.top();
+		SearchKey old_key = queue_.topPriority();
+		SearchKey new_key = computeKey(current);
+		if (old_key < new_key) {
+			// The key is outdated because the source vertex moved
+			queue_.push(current, new_key);
+		} else if (g_table_.get(current) > rhs_table_.get(current)) {
+			// The vertex is overconsistent, so its cost is fixed and propagated
+			Weight current_cost = rhs_table_.get(current);
+			g_table_[current] = current_cost;
+			queue_.pop();
+
+			EdgeList predecessors(edge_allocator_);
+			adjacency_->getPredecessors(predecessors, current);
+			for (EdgeList::iterator edge_iter = predecessors.begin();
+					edge_iter != predecessors.end();
+					edge_iter++)
+			{
+				Vertex predecessor = edge_iter->target;
+				if (predecessor == target_)
+					continue;
+
+				touchVertex(predecessor);
+				Weight& predecessor_rhs = rhs_table_[predecessor];
+				if (edge_iter->weight + current_cost < predecessor_rhs)
+					predecessor_rhs = edge_iter->weight + current_cost;
+				updateVertex(predecessor);
+			}
+		} else {
+			// The vertex is underconsistent, so its predecessors that depended on it are
+			// recomputed
+			Weight old_cost = g_table_.get(current);
+			g_table_[current] = std::numeric_limits<Weight>::infinity();
+
+			EdgeList predecessors(edge_allocator_);
+			adjacency_->getPredecessors(predecessors, current);
+			for (EdgeList::iterator edge_iter = predecessors.begin();
+					edge_iter != predecessors.end();
+					edge_iter++)
+			{
+				Vertex predecessor = edge_iter->target;
+				if (predecessor == target_)
+					continue;
+
+				touchVertex(predecessor);
+				if (rhs_table_.get(predecessor) == edge_iter->weight + old_cost)
+					rhs_table_[predecessor] = computeLookaheadCost(predecessor);
+				updateVertex(predecessor);
+			}
+
+			if (current != target_)
+				rhs_table_[current] = computeLookaheadCost(current);
+			updateVertex(current);
+		}
+		expansions_++;
+		DWL_COUNT_EVENTS("DStarLite::expansions", 1);
+	}
+
+	return true;
+}
+
+
+void DStarLite::repairChangedVertices()
+{
+	if (terrain_ == NULL)
+		return;
+
+	const CellRegion& dirty_region = terrain_->getDirtyRegion();
+	if (dirty_region.empty)
+		return;
+
+	// Adding the margin to the dirty region
+	CellRegion region = dirty_region;
+	unsigned int max_key = std::numeric_limits<unsigned short int>::max();
+	region.min_key.x = (region.min_key.x > change_margin_) ? region.min_key.x - change_margin_ : 0;
+	region.min_key.y = (region.min_key.y > change_margin_) ? region.min_key.y - change_margin_ : 0;
+	region.max_key.x = (max_key - region.max_key.x > change_margin_) ?
+			region.max_key.x + change_margin_ : max_key;
+	region.max_key.y = (max_key - region.max_key.y > change_margin_) ?
+			region.max_key.y + change_margin_ : max_key;
+
+	// Getting the vertices of the search tree inside the region
+	const environment::SpaceDiscretization& space_model = terrain_->getTerrainSpaceModel();
+	std::vector<Vertex> changed_vertices;
+	for (unsigned int i = 0; i < visited_.size(); i++) {
+		Key key;
+		Vertex terrain_vertex;
+		space_model.stateVertexToEnvironmentVertex(terrain_vertex, visited_[i], XY_Y);
+		space_model.vertexToKey(key, terrain_vertex, true);
+		if (region.contains(key))
+			changed_vertices.push_back(visited_[i]);
+	}
+
+	// Recomputing the lookahead cost of the changed vertices with the new edge weights. Note
+	// that the adjacency model recomputes only the memoized costs of the changed cells
+	for (unsigned int i = 0; i < changed_vertices.size(); i++) {
+		Vertex vertex = changed_vertices[i];
+		if (vertex != target_)
+			rhs_table_[vertex] = computeLookaheadCost(vertex);
+		updateVertex(vertex);
+	}
+
+	terrain_->clearDirtyRegion();
+}
+
+
+void DStarLite::extractPath()
+{
+	policy_.clear();
+	policy_table_.clear();
+	total_cost_ = rhs_table_.get(source_);
+	if (total_cost_ == std::numeric_limits<Weight>::infinity())
+		return;
+
+	// Following the successors with the minimum cost, where the number of steps is bounded by
+	// the size of the search tree
+	Vertex current = source_;
+	for (unsigned int i = 0; (i < visited_.size()) && (current != target_); i++) {
+		EdgeList successors(edge_allocator_);
+		adjacency_->getSuccessors(successors, current);
+
+		Vertex next = current;
+		Weight min_cost = std::numeric_limits<Weight>::infinity();
+		for (EdgeList::iterator edge_iter = successors.begin();
+				edge_iter != successors.end();
+				edge_iter++)
+		{
+			Weight cost = edge_iter->weight + g_table_.get(edge_iter->target);
+			if (cost < min_cost) {
+				min_cost = cost;
+				next = edge_iter->target;
+			}
+		}
+		if (next == current)
+			break;
+
+		if (indexed_heap_)
+			policy_table_[next] = current;
+		else
+			policy_[next] = current;
+		current = next;
+	}
+}
+
+
+DStarLite::SearchKey DStarLite::computeKey(Vertex vertex)
+{
+	Weight min_cost = std::min(g_table_.get(vertex), rhs_table_.get(vertex));
+	return SearchKey(min_cost + adjacency_->heuristicCost(source_, vertex) + key_modifier_,
+					 min_cost);
+}
+
+
+Weight DStarLite::computeLookaheadCost(Vertex vertex)
+{
+	EdgeList successors(edge_allocator_);
+	{
+		DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+		adjacency_->getSuccessors(successors, vertex);
+	}
+
+	Weight min_cost = std::numeric_limits<Weight>::infinity();
+	for (EdgeList::iterator edge_iter = successors.begin();
+			edge_iter != successors.end();
+			edge_iter++)
+	{
+		Weight cost = edge_iter->weight + g_table_.get(edge_iter->target);
+		if (cost < min_cost)
+			min_cost = cost;
+	}
+
+	return min_cost;
+}
+
+
+void DStarLite::updateVertex(Vertex vertex)
+{
+	if (g_table_.get(vertex) != rhs_table_.get(vertex))
+		queue_.push(vertex, computeKey(vertex));
+	else
+		queue_.erase(vertex);
+}
+
+
+void DStarLite::touchVertex(Vertex vertex)
+{
+	if (visited_table_.count(vertex) == 0) {
+		visited_table_[vertex] = 1;
+		visited_.push_back(vertex);
+	}
+}
+
+} //@namespace solver
+} //@namespace dwl
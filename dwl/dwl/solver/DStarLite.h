@@ -0,0 +1,134 @@
+#ifndef DWL__SOLVER__DSTAR_LITE__H
+#define DWL__SOLVER__DSTAR_LITE__H
+
+#include <dwl/solver/SearchTreeSolver.h>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/**
+ * @class DStarLite
+ * @brief Class for solving a shortest-search problem using the D* Lite algorithm. D* Lite
+ * searches backward from the target, so its search tree is reused when the source vertex
+ * moves along the path, or when the terrain cells change. The changed cells are given by the
+ * dirty region of the terrain map, and only the vertices around this region are repaired.
+ * A new search is started if the target changes. This class derives from the SearchTreeSolver
+ * class
+ */
+class DStarLite : public SearchTreeSolver
+{
+	public:
+		/** @brief Constructor function */
+		DStarLite();
+
+		/** @brief Destructor function */
+		~DStarLite();
+
+		/**
+		 * @brief Initializes the D* Lite algorithm
+		 * @return True if D* Lite algorithm was initialized
+		 */
+		bool init();
+
+		/**
+		 * @brief Computes (or repairs) a shortest-path using D* Lite algorithm
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 * @param double Allowed time for computing a solution (in seconds)
+		 * @return True if it was computed a solution
+		 */
+		bool compute(Vertex source,
+					 Vertex target,
+					 double computation_time);
+
+		/**
+		 * @brief Sets the margin (number of cells) that is added to the dirty region of the
+		 * terrain. The vertices inside this margin are repaired because the cost of their
+		 * edges depends on the changed cells, e.g. the stance areas of the body adjacency
+		 * @param unsigned int Margin in number of cells
+		 */
+		void setChangeMargin(unsigned int margin);
+
+		/** @brief Discards the search tree, so the next computation starts from scratch */
+		void resetSearch();
+
+
+	private:
+		/** @brief Lexicographic key of the D* Lite queue */
+		typedef std::pair<Weight, Weight> SearchKey;
+
+		/**
+		 * @brief Starts a new search tree rooted in the target vertex
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 */
+		void initializeSearch(Vertex source,
+							  Vertex target);
+
+		/**
+		 * @brief Computes the shortest path until the source vertex is consistent
+		 * @param double Allowed time for computing a solution (in seconds)
+		 * @return True if the source vertex is consistent, and false if the time is over
+		 */
+		bool computeShortestPath(double computation_time);
+
+		/**
+		 * @brief Repairs the vertices of the search tree that are inside the dirty region of
+		 * the terrain
+		 */
+		void repairChangedVertices();
+
+		/**
+		 * @brief Computes the shortest path from the search tree, i.e. following the
+		 * successors with the minimum cost from the source vertex
+		 */
+		void extractPath();
+
+		/** @brief Computes the queue key of a vertex */
+		SearchKey computeKey(Vertex vertex);
+
+		/** @brief Computes the one-step lookahead cost (rhs) of a vertex */
+		Weight computeLookaheadCost(Vertex vertex);
+
+		/** @brief Updates the queue according to the consistency of a vertex */
+		void updateVertex(Vertex vertex);
+
+		/** @brief Registers a vertex in the search tree if it wasn't before */
+		void touchVertex(Vertex vertex);
+
+		/** @brief Openset queue ordered by the lexicographic keys */
+		IndexedHeap<4, SearchKey> queue_;
+
+		/** @brief Cost-to-target (g) and one-step lookahead cost (rhs) of the vertices */
+		VertexTable<Weight> g_table_;
+		VertexTable<Weight> rhs_table_;
+
+		/** @brief Vertices of the search tree */
+		std::vector<Vertex> visited_;
+		VertexTable<unsigned char> visited_table_;
+
+		/** @brief Current source and target vertices */
+		Vertex source_;
+		Vertex target_;
+
+		/** @brief Key modifier that accumulates the motion of the source vertex */
+		Weight key_modifier_;
+
+		/** @brief Margin of the dirty region in number of cells */
+		unsigned int change_margin_;
+
+		/** @brief Indicates if there is a search tree */
+		bool is_initialized_search_;
+
+		/** @brief number of expansions */
+		int expansions_;
+};
+
+} //@namespace solver
+} //@namespace dwl
+
+#endif
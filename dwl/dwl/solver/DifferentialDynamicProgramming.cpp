@@ -0,0 +1,705 @@
+#include <dwl/solver/DifferentialDynamicProgramming.h>
+#include <dwl/utils/Macros.h>
+#include <time.h>
+#include <cmath>
+#include <limits>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/** @brief Bounds of the regularization of the control Hessian, and its increase factor */
+static const double MIN_REGULARIZATION = 1e-9;
+static const double MAX_REGULARIZATION = 1e9;
+static const double REGULARIZATION_FACTOR = 10.;
+
+/** @brief Smallest step length of the line search */
+static const double MIN_STEP = 1e-3;
+
+/** @brief Acceptance ratios of the line search for positive and negative expected improvements */
+static const double ACCEPT_RATIO = 0.1;
+static const double NEGATIVE_ACCEPT_RATIO = 2.;
+
+/** @brief Largest penalty of the augmented Lagrangian */
+static const double MAX_PENALTY = 1e8;
+
+DifferentialDynamicProgramming::DifferentialDynamicProgramming() : oc_model_(NULL),
+		horizon_(0), state_dim_(0), control_dim_(0), knot_dim_(0), integration_index_(0),
+		integration_dim_(0), regularization_(MIN_REGULARIZATION), penalty_(10.),
+		initial_penalty_(10.), last_violation_(std::numeric_limits<double>::max()),
+		cost_epsilon_(1e-4), max_iter_(100), tolerance_(1e-6), constraint_tolerance_(1e-4),
+		feasibility_driven_(true), is_feasible_(false), initialized_model_(false),
+		iterations_(0)
+{
+	name_ = "DDP";
+}
+
+
+DifferentialDynamicProgramming::~DifferentialDynamicProgramming()
+{
+
+}
+
+
+void DifferentialDynamicProgramming::setFromConfigFile(std::string filename)
+{
+	// Yaml reader
+	YamlWrapper yaml_reader(filename);
+
+	// Parsing the configuration file
+	std::string ddp_ns = "ddp";
+	printf(BLUE "Reading the configuration parameters from the %s namespace.\n" COLOR_RESET,
+			ddp_ns.c_str());
+
+	// Reading and setting up the termination parameters
+	YamlNamespace termination_ns = {ddp_ns, "termination"};
+	int max_iter;
+	if (yaml_reader.read(max_iter, "max_iter", termination_ns))
+		setMaximumIterations(max_iter);
+	double tolerance;
+	if (yaml_reader.read(tolerance, "tol", termination_ns))
+		setConvergenceTolerance(tolerance);
+	double constraint_tolerance;
+	if (yaml_reader.read(constraint_tolerance, "constr_tol", termination_ns))
+		setConstraintTolerance(constraint_tolerance);
+
+	// Reading and setting up the algorithm parameters
+	YamlNamespace algorithm_ns = {ddp_ns, "algorithm"};
+	bool feasibility_driven;
+	if (yaml_reader.read(feasibility_driven, "feasibility_driven", algorithm_ns))
+		setFeasibilityDriven(feasibility_driven);
+	double penalty;
+	if (yaml_reader.read(penalty, "penalty", algorithm_ns))
+		initial_penalty_ = penalty;
+	double cost_epsilon;
+	if (yaml_reader.read(cost_epsilon, "cost_epsilon", algorithm_ns))
+		cost_epsilon_ = cost_epsilon;
+}
+
+
+bool DifferentialDynamicProgramming::init()
+{
+	initialized_model_ = false;
+	return true;
+}
+
+
+bool DifferentialDynamicProgramming::compute(double allocated_time_secs)
+{
+	// Getting the initial time
+	clock_t started_time = clock();
+	double allocated_time = allocated_time_secs * (double) CLOCKS_PER_SEC;
+
+	// The stagewise structure is only defined by optimal control problems
+	oc_model_ = dynamic_cast<ocp::OptimalControl*>(model_);
+	if (oc_model_ == NULL) {
+		printf(RED "Error: the DDP solver only solves optimal control problems\n" COLOR_RESET);
+		return false;
+	}
+
+	// Initializing the optimal control problem, which isn't needed for warm-starting
+	bool warm_start = warm_start_ && initialized_model_;
+	if (!warm_start) {
+		model_->init(false);
+		initialized_model_ = true;
+	}
+
+	// Getting the stage transition, i.e. the integrated positions are defined from the
+	// previous knot, and the rest of the knot variables are the controls
+	oc_model_->getIntegrationBlock(integration_index_, integration_dim_);
+	if (integration_dim_ == 0) {
+		printf(RED "Error: the DDP solver needs a hard dynamical system that integrates the"
+				" positions, and it doesn't support collocation\n" COLOR_RESET);
+		return false;
+	}
+	horizon_ = oc_model_->getHorizon();
+	state_dim_ = model_->getDimensionOfState();
+	control_index_.clear();
+	for (unsigned int j = 0; j < state_dim_; j++) {
+		if (j < integration_index_ || j >= integration_index_ + integration_dim_)
+			control_index_.push_back(j);
+	}
+	control_dim_ = control_index_.size();
+
+	// Getting the bounds. Note that the position bounds are handled with the augmented
+	// Lagrangian, since the positions aren't decision variables of the stages
+	Eigen::VectorXd state_lb, state_ub, constraint_lb, constraint_ub;
+	oc_model_->getKnotBounds(state_lb, state_ub, constraint_lb, constraint_ub);
+	control_lb_.resize(control_dim_);
+	control_ub_.resize(control_dim_);
+	for (unsigned int j = 0; j < control_dim_; j++) {
+		control_lb_(j) = state_lb(control_index_[j]);
+		control_ub_(j) = state_ub(control_index_[j]);
+	}
+	unsigned int constraint_dim = constraint_lb.size();
+	knot_dim_ = constraint_dim + integration_dim_;
+	knot_lb_.resize(knot_dim_);
+	knot_ub_.resize(knot_dim_);
+	knot_lb_ << constraint_lb, state_lb.segment(integration_index_, integration_dim_);
+	knot_ub_ << constraint_ub, state_ub.segment(integration_index_, integration_dim_);
+
+	// Getting the starting point. Note that the first state is a dummy one, the first knot
+	// starts from the initial state of the problem
+	unsigned int decision_dim = horizon_ * state_dim_;
+	Eigen::VectorXd starting_point(decision_dim);
+	model_->getStartingPoint(starting_point.data(), decision_dim);
+	states_.assign(horizon_ + 1, Eigen::VectorXd::Zero(state_dim_));
+	controls_.assign(horizon_, Eigen::VectorXd::Zero(control_dim_));
+	for (unsigned int k = 0; k < horizon_; k++) {
+		states_[k+1] = starting_point.segment(k * state_dim_, state_dim_);
+		for (unsigned int j = 0; j < control_dim_; j++)
+			controls_[k](j) = states_[k+1](control_index_[j]);
+		controls_[k] = controls_[k].cwiseMax(control_lb_).cwiseMin(control_ub_);
+	}
+	new_states_ = states_;
+	new_controls_ = controls_;
+
+	// Allocating the quadratic model and the policy
+	gaps_.assign(horizon_, Eigen::VectorXd::Zero(state_dim_));
+	Fx_.assign(horizon_, Eigen::MatrixXd::Zero(state_dim_, state_dim_));
+	Fu_.assign(horizon_, Eigen::MatrixXd::Zero(state_dim_, control_dim_));
+	lx_.assign(horizon_, Eigen::VectorXd::Zero(state_dim_));
+	lu_.assign(horizon_, Eigen::VectorXd::Zero(control_dim_));
+	lxx_.assign(horizon_, Eigen::MatrixXd::Zero(state_dim_, state_dim_));
+	lux_.assign(horizon_, Eigen::MatrixXd::Zero(control_dim_, state_dim_));
+	luu_.assign(horizon_, Eigen::MatrixXd::Zero(control_dim_, control_dim_));
+	Vx_.assign(horizon_ + 1, Eigen::VectorXd::Zero(state_dim_));
+	Vxx_.assign(horizon_ + 1, Eigen::MatrixXd::Zero(state_dim_, state_dim_));
+	k_.assign(horizon_, Eigen::VectorXd::Zero(control_dim_));
+	K_.assign(horizon_, Eigen::MatrixXd::Zero(control_dim_, state_dim_));
+
+	// Initializing the multipliers. A warm start shifts the multipliers of the previous
+	// solution by one knot, and it keeps the penalty
+	if (warm_start && multipliers_.size() == horizon_ &&
+			multipliers_[0].size() == knot_dim_) {
+		for (unsigned int k = 0; k < horizon_ - 1; k++)
+			multipliers_[k] = multipliers_[k+1];
+	} else {
+		multipliers_.assign(horizon_, Eigen::VectorXd::Zero(knot_dim_));
+		terminal_multiplier_.resize(0);
+		penalty_ = initial_penalty_;
+	}
+	last_violation_ = std::numeric_limits<double>::max();
+	regularization_ = MIN_REGULARIZATION;
+
+	// The classical DDP starts from the rollout of the initial guess, i.e. without gaps
+	if (!feasibility_driven_) {
+		for (unsigned int k = 0; k < horizon_; k++)
+			computeTransition(states_[k+1], NULL, NULL, states_[k], controls_[k], k);
+	}
+
+	bool solved = false;
+	iterations_ = 0;
+	while (iterations_ < max_iter_) {
+		if ((clock() - started_time) > allocated_time || isCancellationRequested())
+			break;
+
+		// Computing the quadratic model and the policy. The regularization is increased
+		// until the control Hessians are positive definite
+		double merit = computeDerivatives();
+		bool backward = backwardPass();
+		while (!backward && regularization_ < MAX_REGULARIZATION) {
+			regularization_ *= REGULARIZATION_FACTOR;
+			backward = backwardPass();
+		}
+		if (!backward) {
+			printf(YELLOW "Warning: the DDP backward pass failed with the maximum"
+					" regularization\n" COLOR_RESET);
+			break;
+		}
+		++iterations_;
+
+		// Line search of the forward pass
+		double expected, full_expected = 0.;
+		bool accepted = false;
+		for (double step = 1.; step >= MIN_STEP; step *= 0.5) {
+			double new_merit = forwardPass(expected, step);
+			if (step == 1.)
+				full_expected = expected;
+
+			double reduction = merit - new_merit;
+			if (std::isfinite(new_merit) &&
+					((expected >= 0. && reduction >= ACCEPT_RATIO * expected) ||
+					(expected < 0. && reduction >= NEGATIVE_ACCEPT_RATIO * expected))) {
+				accepted = true;
+				states_.swap(new_states_);
+				controls_.swap(new_controls_);
+				if (step == 1.)
+					regularization_ = std::max(regularization_ / REGULARIZATION_FACTOR,
+											   MIN_REGULARIZATION);
+				break;
+			}
+		}
+
+		// The augmented Lagrangian is updated once the stages converge without gaps
+		if (is_feasible_ && fabs(full_expected) < tolerance_) {
+			if (updateMultipliers() < constraint_tolerance_) {
+				solved = true;
+				break;
+			}
+		} else if (!accepted) {
+			regularization_ *= REGULARIZATION_FACTOR;
+			if (regularization_ > MAX_REGULARIZATION) {
+				printf(YELLOW "Warning: the DDP line search failed with the maximum"
+						" regularization\n" COLOR_RESET);
+				break;
+			}
+		}
+	}
+
+	// Getting the solution, i.e. the decision states of the knots
+	solution_.resize(decision_dim);
+	for (unsigned int k = 0; k < horizon_; k++)
+		solution_.segment(k * state_dim_, state_dim_) = states_[k+1];
+
+	return solved;
+}
+
+
+void DifferentialDynamicProgramming::setMaximumIterations(unsigned int max_iter)
+{
+	max_iter_ = max_iter;
+}
+
+
+void DifferentialDynamicProgramming::setConvergenceTolerance(double tolerance)
+{
+	tolerance_ = tolerance;
+}
+
+
+void DifferentialDynamicProgramming::setConstraintTolerance(double tolerance)
+{
+	constraint_tolerance_ = tolerance;
+}
+
+
+void DifferentialDynamicProgramming::setFeasibilityDriven(bool feasibility_driven)
+{
+	feasibility_driven_ = feasibility_driven;
+}
+
+
+unsigned int DifferentialDynamicProgramming::getNumberOfIterations() const
+{
+	return iterations_;
+}
+
+
+void DifferentialDynamicProgramming::computeTransition(Eigen::VectorXd& decision_state,
+													   Eigen::MatrixXd* state_jacobian,
+													   Eigen::MatrixXd* control_jacobian,
+													   const Eigen::VectorXd& last_decision_state,
+													   const Eigen::VectorXd& control,
+													   unsigned int knot)
+{
+	// Setting the controls, and integrating the positions from the previous knot
+	decision_state = Eigen::VectorXd::Zero(state_dim_);
+	for (unsigned int j = 0; j < control_dim_; j++)
+		decision_state(control_index_[j]) = control(j);
+	Eigen::MatrixXd integration_jac, last_integration_jac;
+	oc_model_->computeKnotTransition(decision_state,
+									 integration_jac, last_integration_jac,
+									 last_decision_state, knot);
+
+	// The integrated positions depend on the controls through the integration Jacobian
+	if (state_jacobian != NULL) {
+		state_jacobian->setZero(state_dim_, state_dim_);
+		state_jacobian->middleRows(integration_index_, integration_dim_) = last_integration_jac;
+	}
+	if (control_jacobian != NULL) {
+		control_jacobian->setZero(state_dim_, control_dim_);
+		for (unsigned int j = 0; j < control_dim_; j++) {
+			(*control_jacobian)(control_index_[j], j) = 1.;
+			control_jacobian->col(j).segment(integration_index_, integration_dim_) =
+					integration_jac.col(control_index_[j]);
+		}
+	}
+}
+
+
+void DifferentialDynamicProgramming::computeKnotConstraints(Eigen::VectorXd& constraint,
+															const Eigen::VectorXd& decision_state,
+															const Eigen::VectorXd& last_decision_state,
+															unsigned int knot)
+{
+	Eigen::VectorXd knot_constraint;
+	oc_model_->evaluateKnotConstraints(knot_constraint, decision_state,
+									   last_decision_state, knot);
+
+	constraint.resize(knot_dim_);
+	constraint << knot_constraint,
+			decision_state.segment(integration_index_, integration_dim_);
+}
+
+
+double DifferentialDynamicProgramming::computeAugmentedLagrangian(Eigen::VectorXd& gradient,
+																  Eigen::VectorXd& weights,
+																  const Eigen::VectorXd& constraint,
+																  const Eigen::VectorXd& lower_bound,
+																  const Eigen::VectorXd& upper_bound,
+																  const Eigen::VectorXd& multiplier)
+{
+	// Shifting the constraint by the multipliers, and projecting it to the bounds
+	Eigen::VectorXd shifted = constraint + multiplier / penalty_;
+	Eigen::VectorXd projected = shifted.cwiseMax(lower_bound).cwiseMin(upper_bound);
+	gradient = penalty_ * (shifted - projected);
+
+	// Only the rows at the bounds are active, so equality rows are always active
+	weights.resize(constraint.size());
+	for (unsigned int i = 0; i < constraint.size(); i++) {
+		bool active = shifted(i) <= lower_bound(i) || shifted(i) >= upper_bound(i);
+		weights(i) = active ? penalty_ : 0.;
+	}
+
+	return 0.5 * penalty_ * (shifted - projected).squaredNorm();
+}
+
+
+double DifferentialDynamicProgramming::computeStageMerit(const Eigen::VectorXd& decision_state,
+														 const Eigen::VectorXd& last_decision_state,
+														 unsigned int knot)
+{
+	double cost;
+	oc_model_->evaluateKnotCost(cost, decision_state, last_decision_state, knot);
+
+	Eigen::VectorXd constraint, gradient, weights;
+	computeKnotConstraints(constraint, decision_state, last_decision_state, knot);
+	return cost + computeAugmentedLagrangian(gradient, weights, constraint,
+											 knot_lb_, knot_ub_, multipliers_[knot]);
+}
+
+
+double DifferentialDynamicProgramming::computeTerminalMerit(Eigen::VectorXd* gradient,
+															Eigen::MatrixXd* hessian,
+															const Eigen::VectorXd& decision_state)
+{
+	if (gradient != NULL)
+		gradient->setZero(state_dim_);
+	if (hessian != NULL)
+		hessian->setZero(state_dim_, state_dim_);
+
+	Eigen::VectorXd constraint, lower_bound, upper_bound;
+	Eigen::MatrixXd jacobian;
+	if (!oc_model_->evaluateTerminalConstraint(constraint, jacobian,
+											   lower_bound, upper_bound, decision_state))
+		return 0.;
+
+	if (terminal_multiplier_.size() != constraint.size())
+		terminal_multiplier_ = Eigen::VectorXd::Zero(constraint.size());
+	Eigen::VectorXd al_gradient, weights;
+	double merit = computeAugmentedLagrangian(al_gradient, weights, constraint,
+											  lower_bound, upper_bound, terminal_multiplier_);
+	if (gradient != NULL)
+		*gradient = jacobian.transpose() * al_gradient;
+	if (hessian != NULL)
+		*hessian = jacobian.transpose() * weights.asDiagonal() * jacobian;
+
+	return merit;
+}
+
+
+double DifferentialDynamicProgramming::computeDerivatives()
+{
+	double merit = 0.;
+	is_feasible_ = true;
+	for (unsigned int k = 0; k < horizon_; k++) {
+		// Computing the transition and its gap
+		Eigen::VectorXd state;
+		const Eigen::VectorXd& last_state = states_[k];
+		computeTransition(state, &Fx_[k], &Fu_[k], last_state, controls_[k], k);
+		gaps_[k] = state - states_[k+1];
+		if (gaps_[k].lpNorm<Eigen::Infinity>() > constraint_tolerance_)
+			is_feasible_ = false;
+
+		// Computing the cost derivatives by finite differences. The Hessian with respect to
+		// the previous knot is neglected
+		double cost;
+		oc_model_->evaluateKnotCost(cost, state, last_state, k);
+		Eigen::VectorXd cost_grad(state_dim_), last_cost_grad = Eigen::VectorXd::Zero(state_dim_);
+		Eigen::VectorXd forward_cost(state_dim_);
+		Eigen::MatrixXd cost_hess(state_dim_, state_dim_);
+		double h = cost_epsilon_;
+		for (unsigned int i = 0; i < state_dim_; i++) {
+			Eigen::VectorXd perturbed = state;
+			double backward_cost;
+			perturbed(i) = state(i) + h;
+			oc_model_->evaluateKnotCost(forward_cost(i), perturbed, last_state, k);
+			perturbed(i) = state(i) - h;
+			oc_model_->evaluateKnotCost(backward_cost, perturbed, last_state, k);
+			cost_grad(i) = (forward_cost(i) - backward_cost) / (2 * h);
+			cost_hess(i,i) = (forward_cost(i) - 2 * cost + backward_cost) / (h * h);
+		}
+		for (unsigned int i = 0; i < state_dim_; i++) {
+			for (unsigned int j = i + 1; j < state_dim_; j++) {
+				Eigen::VectorXd perturbed = state;
+				double perturbed_cost;
+				perturbed(i) += h;
+				perturbed(j) += h;
+				oc_model_->evaluateKnotCost(perturbed_cost, perturbed, last_state, k);
+				cost_hess(i,j) = cost_hess(j,i) =
+						(perturbed_cost - forward_cost(i) - forward_cost(j) + cost) / (h * h);
+			}
+		}
+		if (k != 0) { // the first knot starts from the initial state
+			for (unsigned int i = 0; i < state_dim_; i++) {
+				Eigen::VectorXd perturbed = last_state;
+				double forward, backward;
+				perturbed(i) = last_state(i) + h;
+				oc_model_->evaluateKnotCost(forward, state, perturbed, k);
+				perturbed(i) = last_state(i) - h;
+				oc_model_->evaluateKnotCost(backward, state, perturbed, k);
+				last_cost_grad(i) = (forward - backward) / (2 * h);
+			}
+		}
+
+		// Computing the augmented Lagrangian of the knot constraints and positions
+		Eigen::VectorXd constraint, al_gradient, weights;
+		computeKnotConstraints(constraint, state, last_state, k);
+		merit += cost + computeAugmentedLagrangian(al_gradient, weights, constraint,
+												   knot_lb_, knot_ub_, multipliers_[k]);
+		Eigen::MatrixXd knot_jac, last_knot_jac;
+		oc_model_->evaluateKnotConstraintJacobian(knot_jac, last_knot_jac,
+												  state, last_state, k);
+		unsigned int constraint_dim = knot_dim_ - integration_dim_;
+		Eigen::MatrixXd constraint_jac = Eigen::MatrixXd::Zero(knot_dim_, state_dim_);
+		Eigen::MatrixXd last_constraint_jac = Eigen::MatrixXd::Zero(knot_dim_, state_dim_);
+		constraint_jac.topRows(constraint_dim) = knot_jac;
+		constraint_jac.bottomRows(integration_dim_).middleCols(integration_index_,
+				integration_dim_).setIdentity();
+		last_constraint_jac.topRows(constraint_dim) = last_knot_jac;
+
+		// Chaining the derivatives with the transition, i.e. the stage merit is a function of
+		// the previous knot and the controls. The Hessian of the constraints is Gauss-Newton
+		Eigen::VectorXd merit_grad = cost_grad + constraint_jac.transpose() * al_gradient;
+		Eigen::VectorXd last_merit_grad =
+				last_cost_grad + last_constraint_jac.transpose() * al_gradient;
+		Eigen::MatrixXd state_jac = last_constraint_jac + constraint_jac * Fx_[k];
+		Eigen::MatrixXd control_jac = constraint_jac * Fu_[k];
+		Eigen::MatrixXd hess_state = cost_hess * Fx_[k];
+		Eigen::MatrixXd hess_control = cost_hess * Fu_[k];
+		Eigen::MatrixXd weighted_state = weights.asDiagonal() * state_jac;
+		lx_[k] = last_merit_grad + Fx_[k].transpose() * merit_grad;
+		lu_[k] = Fu_[k].transpose() * merit_grad;
+		lxx_[k] = Fx_[k].transpose() * hess_state + state_jac.transpose() * weighted_state;
+		lux_[k] = Fu_[k].transpose() * hess_state + control_jac.transpose() * weighted_state;
+		luu_[k] = Fu_[k].transpose() * hess_control +
+				control_jac.transpose() * weights.asDiagonal() * control_jac;
+	}
+
+	// Computing the terminal merit, which defines the value function of the last knot
+	merit += computeTerminalMerit(&Vx_[horizon_], &Vxx_[horizon_], states_[horizon_]);
+
+	return merit;
+}
+
+
+bool DifferentialDynamicProgramming::backwardPass()
+{
+	for (int k = horizon_ - 1; k >= 0; k--) {
+		// The value function is expanded at the transition, i.e. it includes the gap
+		const Eigen::MatrixXd& Vxx = Vxx_[k+1];
+		Eigen::VectorXd Vx = Vx_[k+1] + Vxx * gaps_[k];
+
+		// Computing the action-value function
+		Eigen::MatrixXd VxxFx = Vxx * Fx_[k];
+		Eigen::MatrixXd VxxFu = Vxx * Fu_[k];
+		Eigen::VectorXd Qx = lx_[k] + Fx_[k].transpose() * Vx;
+		Eigen::VectorXd Qu = lu_[k] + Fu_[k].transpose() * Vx;
+		Eigen::MatrixXd Qxx = lxx_[k] + Fx_[k].transpose() * VxxFx;
+		Eigen::MatrixXd Qux = lux_[k] + Fu_[k].transpose() * VxxFx;
+		Eigen::MatrixXd Quu = luu_[k] + Fu_[k].transpose() * VxxFu;
+		Quu.diagonal().array() += regularization_;
+
+		// Computing the feedforward term with the control bounds, which is warm-started from
+		// the previous iteration
+		Eigen::ArrayXi free_rows;
+		Eigen::VectorXd lower_bound = control_lb_ - controls_[k];
+		Eigen::VectorXd upper_bound = control_ub_ - controls_[k];
+		if (!solveBoxQP(k_[k], free_rows, Quu, Qu, lower_bound, upper_bound))
+			return false;
+
+		// Computing the feedback gains of the free controls, i.e. the clamped controls don't
+		// have feedback
+		K_[k].setZero(control_dim_, state_dim_);
+		std::vector<unsigned int> free_index;
+		for (unsigned int j = 0; j < control_dim_; j++) {
+			if (free_rows(j))
+				free_index.push_back(j);
+		}
+		unsigned int num_free = free_index.size();
+		if (num_free > 0) {
+			Eigen::MatrixXd Quu_free(num_free, num_free);
+			Eigen::MatrixXd Qux_free(num_free, state_dim_);
+			for (unsigned int i = 0; i < num_free; i++) {
+				Qux_free.row(i) = Qux.row(free_index[i]);
+				for (unsigned int j = 0; j < num_free; j++)
+					Quu_free(i,j) = Quu(free_index[i], free_index[j]);
+			}
+			Eigen::LLT<Eigen::MatrixXd> Quu_llt(Quu_free);
+			if (Quu_llt.info() != Eigen::Success)
+				return false;
+
+			Eigen::MatrixXd K_free = -Quu_llt.solve(Qux_free);
+			for (unsigned int i = 0; i < num_free; i++)
+				K_[k].row(free_index[i]) = K_free.row(i);
+		}
+
+		// Updating the value function
+		Eigen::MatrixXd QuuK = Quu * K_[k];
+		Vx_[k] = Qx + K_[k].transpose() * (Quu * k_[k] + Qu) + Qux.transpose() * k_[k];
+		Vxx_[k] = Qxx + K_[k].transpose() * QuuK + K_[k].transpose() * Qux +
+				Qux.transpose() * K_[k];
+		Vxx_[k] = 0.5 * (Vxx_[k] + Vxx_[k].transpose()).eval();
+	}
+
+	return true;
+}
+
+
+double DifferentialDynamicProgramming::forwardPass(double& expected,
+												   double step)
+{
+	// The expected improvement is computed from the quadratic model along the linear rollout
+	// of the policy, which also closes a (1 - alpha) fraction of the gaps
+	double merit = 0.;
+	double model_change = 0.;
+	Eigen::VectorXd model_dx = Eigen::VectorXd::Zero(state_dim_);
+	new_states_[0] = states_[0];
+	for (unsigned int k = 0; k < horizon_; k++) {
+		Eigen::VectorXd dx = new_states_[k] - states_[k];
+		new_controls_[k] = (controls_[k] + step * k_[k] + K_[k] * dx).cwiseMax(
+				control_lb_).cwiseMin(control_ub_);
+
+		Eigen::VectorXd state;
+		computeTransition(state, NULL, NULL, new_states_[k], new_controls_[k], k);
+		merit += computeStageMerit(state, new_states_[k], k);
+		new_states_[k+1] = state - (1 - step) * gaps_[k];
+
+		// Rolling out the quadratic model
+		Eigen::VectorXd model_du = (controls_[k] + step * k_[k] + K_[k] * model_dx).cwiseMax(
+				control_lb_).cwiseMin(control_ub_) - controls_[k];
+		model_change += lx_[k].dot(model_dx) + lu_[k].dot(model_du) +
+				0.5 * model_dx.dot(lxx_[k] * model_dx) + model_du.dot(lux_[k] * model_dx) +
+				0.5 * model_du.dot(luu_[k] * model_du);
+		model_dx = (Fx_[k] * model_dx + Fu_[k] * model_du + step * gaps_[k]).eval();
+	}
+	merit += computeTerminalMerit(NULL, NULL, new_states_[horizon_]);
+	model_change += Vx_[horizon_].dot(model_dx) + 0.5 * model_dx.dot(Vxx_[horizon_] * model_dx);
+	expected = -model_change;
+
+	return merit;
+}
+
+
+bool DifferentialDynamicProgramming::solveBoxQP(Eigen::VectorXd& solution,
+												Eigen::ArrayXi& free_rows,
+												const Eigen::MatrixXd& hessian,
+												const Eigen::VectorXd& gradient,
+												const Eigen::VectorXd& lower_bound,
+												const Eigen::VectorXd& upper_bound)
+{
+	unsigned int dim = gradient.size();
+	free_rows = Eigen::ArrayXi::Ones(dim);
+	if (solution.size() != dim)
+		solution = Eigen::VectorXd::Zero(dim);
+	solution = solution.cwiseMax(lower_bound).cwiseMin(upper_bound);
+
+	double value = 0.5 * solution.dot(hessian * solution) + gradient.dot(solution);
+	for (unsigned int iter = 0; iter < 100; iter++) {
+		// The clamped rows are at the bounds, where the gradient pushes outside
+		Eigen::VectorXd grad = gradient + hessian * solution;
+		std::vector<unsigned int> free_index;
+		for (unsigned int i = 0; i < dim; i++) {
+			bool clamped = (solution(i) <= lower_bound(i) && grad(i) > 0.) ||
+					(solution(i) >= upper_bound(i) && grad(i) < 0.);
+			free_rows(i) = clamped ? 0 : 1;
+			if (!clamped)
+				free_index.push_back(i);
+		}
+		unsigned int num_free = free_index.size();
+		if (num_free == 0)
+			return true;
+
+		// Computing the Newton step of the free rows
+		Eigen::MatrixXd hessian_free(num_free, num_free);
+		Eigen::VectorXd grad_free(num_free);
+		for (unsigned int i = 0; i < num_free; i++) {
+			grad_free(i) = grad(free_index[i]);
+			for (unsigned int j = 0; j < num_free; j++)
+				hessian_free(i,j) = hessian(free_index[i], free_index[j]);
+		}
+		if (grad_free.norm() < 1e-10)
+			return true;
+		Eigen::LLT<Eigen::MatrixXd> hessian_llt(hessian_free);
+		if (hessian_llt.info() != Eigen::Success)
+			return false;
+		Eigen::VectorXd step_free = -hessian_llt.solve(grad_free);
+		Eigen::VectorXd step = Eigen::VectorXd::Zero(dim);
+		for (unsigned int i = 0; i < num_free; i++)
+			step(free_index[i]) = step_free(i);
+
+		// Projected line search with the Armijo condition
+		double alpha = 1.;
+		Eigen::VectorXd candidate;
+		double new_value = value;
+		while (alpha > 1e-10) {
+			candidate = (solution + alpha * step).cwiseMax(lower_bound).cwiseMin(upper_bound);
+			new_value = 0.5 * candidate.dot(hessian * candidate) + gradient.dot(candidate);
+			if (new_value - value <= 0.1 * grad.dot(candidate - solution))
+				break;
+			alpha *= 0.5;
+		}
+		if (alpha <= 1e-10)
+			return true;
+
+		solution = candidate;
+		if (value - new_value < 1e-12 * (1. + fabs(value))) {
+			value = new_value;
+			break;
+		}
+		value = new_value;
+	}
+
+	return true;
+}
+
+
+double DifferentialDynamicProgramming::updateMultipliers()
+{
+	// Updating the multipliers from the projection of the shifted constraints
+	double violation = 0.;
+	for (unsigned int k = 0; k < horizon_; k++) {
+		Eigen::VectorXd constraint;
+		computeKnotConstraints(constraint, states_[k+1], states_[k], k);
+		Eigen::VectorXd shifted = constraint + multipliers_[k] / penalty_;
+		multipliers_[k] = penalty_ * (shifted - shifted.cwiseMax(knot_lb_).cwiseMin(knot_ub_));
+		violation = std::max(violation, (constraint -
+				constraint.cwiseMax(knot_lb_).cwiseMin(knot_ub_)).lpNorm<Eigen::Infinity>());
+	}
+	Eigen::VectorXd constraint, lower_bound, upper_bound;
+	Eigen::MatrixXd jacobian;
+	if (oc_model_->evaluateTerminalConstraint(constraint, jacobian, lower_bound, upper_bound,
+											  states_[horizon_])) {
+		if (terminal_multiplier_.size() != constraint.size())
+			terminal_multiplier_ = Eigen::VectorXd::Zero(constraint.size());
+		Eigen::VectorXd shifted = constraint + terminal_multiplier_ / penalty_;
+		terminal_multiplier_ =
+				penalty_ * (shifted - shifted.cwiseMax(lower_bound).cwiseMin(upper_bound));
+		violation = std::max(violation, (constraint -
+				constraint.cwiseMax(lower_bound).cwiseMin(upper_bound)).lpNorm<Eigen::Infinity>());
+	}
+
+	// Increasing the penalty if the violation doesn't decrease enough
+	if (violation > 0.25 * last_violation_)
+		penalty_ = std::min(REGULARIZATION_FACTOR * penalty_, MAX_PENALTY);
+	last_violation_ = violation;
+
+	return violation;
+}
+
+} //@namespace solver
+} //@namespace dwl
@@ -0,0 +1,274 @@
+#ifndef DWL__SOLVER__DIFFERENTIAL_DYNAMIC_PROGRAMMING__H
+#define DWL__SOLVER__DIFFERENTIAL_DYNAMIC_PROGRAMMING__H
+
+#include <dwl/solver/OptimizationSolver.h>
+#include <dwl/ocp/OptimalControl.h>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/**
+ * @class DifferentialDynamicProgramming
+ * @brief Feasibility-driven Differential Dynamic Programming (FDDP) solver of the optimal control
+ * problems, i.e. it exploits the stagewise structure of ocp::OptimalControl instead of solving
+ * the full NLP. The stage transition is the time integration of the knots, so the state of a
+ * stage is the decision state of the previous knot and its controls are the knot variables that
+ * are not integrated (e.g. velocities, accelerations, efforts and contact forces). The
+ * remaining hard constraints of the knots (e.g. the inverse dynamics) and the position bounds
+ * are handled with an augmented Lagrangian, and the bounds of the controls with a box-QP in the
+ * backward pass (Tassa et al., ICRA 2014). The gaps of the initial guess are closed as in
+ * Mastalli et al. (ICRA 2020): "Crocoddyl: An Efficient and Versatile Framework for Multi-Contact
+ * Optimal Control". The cost of an iteration is linear in the horizon. Note that the
+ * derivatives of the costs are computed by finite differences of the knot costs
+ */
+class DifferentialDynamicProgramming : public OptimizationSolver
+{
+	public:
+		/** @brief Constructor function */
+		DifferentialDynamicProgramming();
+
+		/** @brief Destructor function */
+		~DifferentialDynamicProgramming();
+
+		/**
+		 * @brief Sets the DDP configuration parameters from a yaml file
+		 * @param std::string Filename
+		 */
+		void setFromConfigFile(std::string filename);
+
+		/**
+		 * @brief Initializes the solver. Note that the optimal control problem is checked in
+		 * the first computation, since it's usually defined after this call
+		 * @return True if was initialized
+		 */
+		bool init();
+
+		/**
+		 * @brief Computes the optimal trajectory
+		 * @param double Allowed computation time in seconds
+		 * @return True if it was computed a solution
+		 */
+		bool compute(double allocated_time_secs = 2e19);
+
+		/**
+		 * @brief Sets the maximum number of DDP iterations
+		 * @param unsigned int Maximum number of iterations
+		 */
+		void setMaximumIterations(unsigned int max_iter);
+
+		/**
+		 * @brief Sets the convergence tolerance of the expected improvement
+		 * @param double Convergence tolerance
+		 */
+		void setConvergenceTolerance(double tolerance);
+
+		/**
+		 * @brief Sets the tolerance of the constraint violation and the gaps
+		 * @param double Constraint tolerance
+		 */
+		void setConstraintTolerance(double tolerance);
+
+		/**
+		 * @brief Enables/disables the feasibility-driven mode. Otherwise, the starting point is
+		 * rolled out before the first iteration as in the classical DDP
+		 * @param bool True for the feasibility-driven mode
+		 */
+		void setFeasibilityDriven(bool feasibility_driven);
+
+		/** @brief Gets the number of DDP iterations of the last computation */
+		unsigned int getNumberOfIterations() const;
+
+
+	private:
+		/**
+		 * @brief Computes the stage transition, i.e. the knot decision state given the previous
+		 * one and the controls, and optionally its Jacobians
+		 * @param Eigen::VectorXd& Decision state of the knot
+		 * @param Eigen::MatrixXd* Jacobian with respect to the previous decision state
+		 * @param Eigen::MatrixXd* Jacobian with respect to the controls
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param const Eigen::VectorXd& Controls of the knot
+		 * @param unsigned int Index of the knot
+		 */
+		void computeTransition(Eigen::VectorXd& decision_state,
+							   Eigen::MatrixXd* state_jacobian,
+							   Eigen::MatrixXd* control_jacobian,
+							   const Eigen::VectorXd& last_decision_state,
+							   const Eigen::VectorXd& control,
+							   unsigned int knot);
+
+		/**
+		 * @brief Computes the knot constraints of the augmented Lagrangian, i.e. the hard
+		 * constraints without time integration and the positions
+		 * @param Eigen::VectorXd& Constraint vector
+		 * @param const Eigen::VectorXd& Decision state of the knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		void computeKnotConstraints(Eigen::VectorXd& constraint,
+									const Eigen::VectorXd& decision_state,
+									const Eigen::VectorXd& last_decision_state,
+									unsigned int knot);
+
+		/**
+		 * @brief Computes the augmented Lagrangian term of constraints with bounds, i.e.
+		 * rho/2 |g + lambda/rho - P(g + lambda/rho)|^2, where P is the projection to the bounds
+		 * @param Eigen::VectorXd& Gradient with respect to the constraint
+		 * @param Eigen::VectorXd& Gauss-Newton weights of the active rows
+		 * @param const Eigen::VectorXd& Constraint vector
+		 * @param const Eigen::VectorXd& Lower bounds
+		 * @param const Eigen::VectorXd& Upper bounds
+		 * @param const Eigen::VectorXd& Multipliers
+		 * @return double Augmented Lagrangian term
+		 */
+		double computeAugmentedLagrangian(Eigen::VectorXd& gradient,
+										  Eigen::VectorXd& weights,
+										  const Eigen::VectorXd& constraint,
+										  const Eigen::VectorXd& lower_bound,
+										  const Eigen::VectorXd& upper_bound,
+										  const Eigen::VectorXd& multiplier);
+
+		/**
+		 * @brief Computes the merit of a stage, i.e. the knot cost and its augmented Lagrangian
+		 * @param const Eigen::VectorXd& Decision state of the knot
+		 * @param const Eigen::VectorXd& Decision state of the previous knot
+		 * @param unsigned int Index of the knot
+		 */
+		double computeStageMerit(const Eigen::VectorXd& decision_state,
+								 const Eigen::VectorXd& last_decision_state,
+								 unsigned int knot);
+
+		/**
+		 * @brief Computes the merit of the terminal stage, and optionally its derivatives
+		 * @param Eigen::VectorXd* Gradient
+		 * @param Eigen::MatrixXd* Gauss-Newton Hessian
+		 * @param const Eigen::VectorXd& Decision state of the last knot
+		 */
+		double computeTerminalMerit(Eigen::VectorXd* gradient,
+									Eigen::MatrixXd* hessian,
+									const Eigen::VectorXd& decision_state);
+
+		/**
+		 * @brief Computes the transition, merit and derivatives of every stage at the current
+		 * iterate, i.e. the quadratic model of the backward pass
+		 * @return double Merit of the current iterate
+		 */
+		double computeDerivatives();
+
+		/**
+		 * @brief Computes the feedback and feedforward terms with the Riccati-like recursion
+		 * @return bool False if the control Hessian isn't positive definite
+		 */
+		bool backwardPass();
+
+		/**
+		 * @brief Rolls out the feedback policy, where the gaps are reduced by (1 - alpha). The
+		 * expected improvement is computed from the same rollout of the quadratic model
+		 * @param double& Expected improvement of the merit
+		 * @param double Step length
+		 * @return double Merit of the new trajectory
+		 */
+		double forwardPass(double& expected,
+						   double step);
+
+		/**
+		 * @brief Solves the box-constrained QP of the controls with a projected Newton method,
+		 * i.e. min 0.5 x' H x + g' x s.t. lb <= x <= ub
+		 * @param Eigen::VectorXd& Solution, which is also the starting point
+		 * @param Eigen::ArrayXi& Free (not clamped) rows of the solution
+		 * @param const Eigen::MatrixXd& Hessian
+		 * @param const Eigen::VectorXd& Gradient
+		 * @param const Eigen::VectorXd& Lower bounds
+		 * @param const Eigen::VectorXd& Upper bounds
+		 * @return bool False if the Hessian of the free rows isn't positive definite
+		 */
+		bool solveBoxQP(Eigen::VectorXd& solution,
+						Eigen::ArrayXi& free_rows,
+						const Eigen::MatrixXd& hessian,
+						const Eigen::VectorXd& gradient,
+						const Eigen::VectorXd& lower_bound,
+						const Eigen::VectorXd& upper_bound);
+
+		/**
+		 * @brief Updates the multipliers and the penalty of the augmented Lagrangian
+		 * @return double Constraint violation of the current iterate
+		 */
+		double updateMultipliers();
+
+		/** @brief Optimal control problem */
+		ocp::OptimalControl* oc_model_;
+
+		/** @brief Dimensions of the problem */
+		unsigned int horizon_;
+		unsigned int state_dim_;
+		unsigned int control_dim_;
+		unsigned int knot_dim_;
+		unsigned int integration_index_;
+		unsigned int integration_dim_;
+
+		/** @brief Indexes of the controls in the knot decision state */
+		std::vector<unsigned int> control_index_;
+
+		/** @brief Bounds of the controls, positions and knot constraints */
+		Eigen::VectorXd control_lb_, control_ub_;
+		Eigen::VectorXd knot_lb_, knot_ub_;
+
+		/** @brief Current iterate, i.e. the decision states of the knots (the first one is the
+		 * state before the horizon) and the controls */
+		std::vector<Eigen::VectorXd> states_, controls_;
+
+		/** @brief Trial iterate of the forward pass */
+		std::vector<Eigen::VectorXd> new_states_, new_controls_;
+
+		/** @brief Gaps between the transitions and the knots */
+		std::vector<Eigen::VectorXd> gaps_;
+
+		/** @brief Quadratic model of the stages, i.e. transition Jacobians and merit derivatives */
+		std::vector<Eigen::MatrixXd> Fx_, Fu_;
+		std::vector<Eigen::VectorXd> lx_, lu_;
+		std::vector<Eigen::MatrixXd> lxx_, lux_, luu_;
+
+		/** @brief Value function, feedback gains and feedforward terms */
+		std::vector<Eigen::VectorXd> Vx_, k_;
+		std::vector<Eigen::MatrixXd> Vxx_, K_;
+
+		/** @brief Multipliers of the knot and terminal constraints */
+		std::vector<Eigen::VectorXd> multipliers_;
+		Eigen::VectorXd terminal_multiplier_;
+
+		/** @brief Regularization of the control Hessian and penalty of the augmented Lagrangian */
+		double regularization_;
+		double penalty_;
+		double initial_penalty_;
+
+		/** @brief Constraint violation of the last multiplier update */
+		double last_violation_;
+
+		/** @brief Step of the finite differences of the costs */
+		double cost_epsilon_;
+
+		/** @brief Parameters of the solver */
+		unsigned int max_iter_;
+		double tolerance_;
+		double constraint_tolerance_;
+		bool feasibility_driven_;
+
+		/** @brief Indicates if the iterate doesn't have gaps */
+		bool is_feasible_;
+
+		/** @brief Indicates if the optimal control problem was initialized */
+		bool initialized_model_;
+
+		/** @brief Number of iterations of the last computation */
+		unsigned int iterations_;
+};
+
+} //@namespace solver
+} //@namespace dwl
+
+#endif
@@ -1,4 +1,6 @@
 #include <dwl/solver/Dijkstrap.h>
+#include <dwl/utils/Instrumentation.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -7,9 +9,10 @@ namespace dwl
 namespace solver
 {
 
-Dijkstrap::Dijkstrap() : expansions_(0)
+Dijkstrap::Dijkstrap() : expansions_(0), cost_quantum_(0.)
 {
 	name_ = "Dijkstrap";
+	informed_search_ = false;
 }
 
 
@@ -30,6 +33,8 @@ bool Dijkstrap::compute(Vertex source,
 						Vertex target,
 						double computation_time)
 {
+	DWL_SCOPED_TIMER("Dijkstrap::compute");
+
 	if (!is_set_adjacency_model_) {
 		printf(RED "Could not computed the shortest path because it is required to defined an adjacency model\n"
 				COLOR_RESET);
@@ -39,17 +44,53 @@ bool Dijkstrap::compute(Vertex source,
 		return false;
 	}
 
+	// Freeing the search structures of the previous query
+	search_pool_.reset();
+
+	// Lazy evaluation, where the successors are generated on demand
+	if (adjacency_->isLazyEvaluation()) {
+		if (!indexed_heap_)
+			setIndexedHeap(true);
+
+		// Adding the edges of the source and target vertex if they are outside the terrain
+		// information, the rest of edges are never precomputed
+		AdjacencyMap adjacency_map;
+		Vertex closest_source, closest_target;
+		adjacency_->getTheClosestStartAndGoalVertex(closest_source, closest_target,
+													source, target);
+		if (closest_source != source)
+			adjacency_map[source].push_back(Edge(closest_source, 0));
+		if (closest_target != target)
+			adjacency_map[closest_target].push_back(Edge(target, 0));
+
+		// Computing the shortest path with the current terrain information
+		findShortestPathWithHeap(source, target, adjacency_map, true);
+
+		return true;
+	}
+
 	// Computing adjacency map
 	AdjacencyMap adjacency_map;
 	adjacency_->computeAdjacencyMap(adjacency_map, source, target);
 
 	// Computing the shortest path
-	findShortestPath(source, target, adjacency_map);
+	if (cost_quantum_ > 0. && !indexed_heap_)
+		setIndexedHeap(true);
+	if (indexed_heap_)
+		findShortestPathWithHeap(source, target, adjacency_map);
+	else
+		findShortestPath(source, target, adjacency_map);
 
 	return true;
 }
 
 
+void Dijkstrap::setCostQuantum(double quantum)
+{
+	cost_quantum_ = std::max(quantum, 0.);
+}
+
+
 void Dijkstrap::findShortestPath(Vertex source,
 								 Vertex target,
 								 AdjacencyMap adjacency_map)
@@ -87,7 +128,7 @@ void Dijkstrap::findShortestPath(Vertex source,
 		}
 
 		// Visit each edge exiting u
-		for (std::list<Edge>::iterator edge_iter = adjacency_map[current].begin();
+		for (EdgeList::iterator edge_iter = adjacency_map[current].begin();
 			edge_iter != adjacency_map[current].end();
 			edge_iter++)
 		{
@@ -105,5 +146,103 @@ void Dijkstrap::findShortestPath(Vertex source,
 	}
 }
 
+
+
+void Dijkstrap::findShortestPathWithHeap(Vertex source,
+										 Vertex target,
+										 const AdjacencyMap& adjacency_map,
+										 bool lazy)
+{
+	// Clearing the previous search, note that only the touched vertices are reset
+	openset_heap_.clear();
+	g_cost_table_.clear();
+	closedset_table_.clear();
+	policy_table_.clear();
+
+	// Adding only the source vertex, the rest of vertices are queued when they are reached
+	// (i.e. its minimum cost is infinity by default). In the quantized-cost mode, the decreased
+	// costs are queued again, so the outdated entries are skipped
+	bool quantized = cost_quantum_ > 0.;
+	bucket_heap_.clear();
+	g_cost_table_[source] = 0;
+	if (quantized)
+		bucket_heap_.push(0, std::make_pair(source, 0.));
+	else
+		openset_heap_.push(source, 0);
+	expansions_ = 0;
+	EdgeList successors(edge_allocator_);
+	while (quantized ? !bucket_heap_.empty() : !openset_heap_.empty()) {
+		Vertex current;
+		if (quantized) {
+			const std::pair<Vertex,Weight>& entry = bucket_heap_.top();
+			current = entry.first;
+			if (entry.second != g_cost_table_.get(current)) {
+				bucket_heap_.pop();
+				continue;
+			}
+		} else
+			current = openset_heap_.top();
+
+		// Checking if it is get the target
+		if (adjacency_->isReachedGoal(target, current)) {
+			if (current != target) {
+				policy_table_[target] = current;
+				g_cost_table_[target] = g_cost_table_.get(current);
+			}
+			break;
+		}
+
+		if (quantized)
+			bucket_heap_.pop();
+		else
+			openset_heap_.pop();
+		closedset_table_[current] = 1;
+
+		// Getting the edges exiting u
+		successors.clear();
+		if (lazy) {
+			DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+			adjacency_->getSuccessors(successors, current);
+		}
+		AdjacencyMap::const_iterator vertex_iter = adjacency_map.find(current);
+		if (vertex_iter != adjacency_map.end())
+			successors.insert(successors.end(),
+							  vertex_iter->second.begin(), vertex_iter->second.end());
+
+		// Visit each edge exiting u
+		Weight current_cost = g_cost_table_.get(current);
+		for (EdgeList::const_iterator edge_iter = successors.begin();
+			edge_iter != successors.end();
+			edge_iter++)
+		{
+			Vertex neighbor = edge_iter->target;
+			if (!quantized && closedset_table_.count(neighbor) > 0)
+				continue;
+
+			Weight distance_through_current = current_cost + edge_iter->weight;
+			Weight& neighbor_cost = g_cost_table_[neighbor];
+			if (distance_through_current < neighbor_cost) {
+				neighbor_cost = distance_through_current;
+				policy_table_[neighbor] = current;
+				if (quantized)
+					bucket_heap_.push(quantizeCost(distance_through_current),
+									  std::make_pair(neighbor, distance_through_current));
+				else
+					openset_heap_.push(neighbor, distance_through_current);
+			}
+		}
+		expansions_++;
+		DWL_COUNT_EVENTS("Dijkstrap::expansions", 1);
+	}
+
+	total_cost_ = g_cost_table_.get(target);
+}
+
+
+RadixHeap<std::pair<Vertex,Weight> >::Key Dijkstrap::quantizeCost(Weight cost) const
+{
+	return (RadixHeap<std::pair<Vertex,Weight> >::Key) (cost / cost_quantum_ + 0.5);
+}
+
 } //@namespace solver
 } //@namespace dwl
@@ -2,6 +2,7 @@
 #define DWL__SOLVER__DIJKSTRAP__H
 
 #include <dwl/solver/SearchTreeSolver.h>
+#include <dwl/utils/RadixHeap.h>
 
 
 namespace dwl
@@ -40,6 +41,18 @@ class Dijkstrap : public SearchTreeSolver
 					 Vertex target,
 					 double computation_time);
 
+		/**
+		 * @brief Sets the quantized-cost mode, where the open set is a radix heap of the costs
+		 * rounded to the quantum instead of the indexed heap, i.e. O(1) pushes and amortized
+		 * O(log C) pops. It uses the vertex tables of the indexed heap. Note that a closed
+		 * vertex is reopened if its cost decreases, so the search is exact if the weights are
+		 * multiples of the quantum (e.g. the resolution of the terrain costs), and otherwise
+		 * the cost of the target is within a quantum of the minimum one. A zero quantum
+		 * disables it
+		 * @param double Cost quantum
+		 */
+		void setCostQuantum(double quantum);
+
 
 	private:
 		/**
@@ -52,8 +65,37 @@ class Dijkstrap : public SearchTreeSolver
 							  Vertex target,
 							  AdjacencyMap adjacency_map);
 
+		/**
+		 * @brief Computes the minimum cost and previous vertex according to the shortest
+		 * Dijkstrap path using the indexed heap and vertex tables. In lazy evaluation, the
+		 * successors are generated by the adjacency model when a vertex is expanded, and the
+		 * adjacency map only contains the edges that connect the source and target vertices
+		 * with the terrain information
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 * @param const AdjacencyMap& Adjacency map
+		 * @param bool Indicates if the successors are lazily generated
+		 */
+		void findShortestPathWithHeap(Vertex source,
+									  Vertex target,
+									  const AdjacencyMap& adjacency_map,
+									  bool lazy = false);
+
+		/**
+		 * @brief Quantizes a cost, i.e. rounds it to the number of quanta
+		 * @param Weight Cost
+		 * @return The key of the cost in the radix heap
+		 */
+		RadixHeap<std::pair<Vertex,Weight> >::Key quantizeCost(Weight cost) const;
+
 		/** @brief number of expansions */
 		int expansions_;
+
+		/** @brief Cost quantum of the quantized-cost mode (zero for disabling it) */
+		double cost_quantum_;
+
+		/** @brief Open set of the quantized-cost mode, i.e. the vertices and queued costs */
+		RadixHeap<std::pair<Vertex,Weight> > bucket_heap_;
 };
 
 } //@namespace solver
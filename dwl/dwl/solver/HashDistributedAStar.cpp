@@ -0,0 +1,320 @@
+#include <dwl/solver/HashDistributedAStar.h>
+#include <dwl/utils/Instrumentation.h>
+#include <algorithm>
+#include <stdint.h>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+HashDistributedAStar::HashDistributedAStar(unsigned int num_workers,
+										   double inflation) : num_workers_(0),
+		inflation_(1.), source_(0), target_(0), pending_work_(0), stop_(false),
+		best_cost_(std::numeric_limits<double>::max()), best_goal_(0),
+		shared_adjacency_(false), expansions_(0)
+{
+	name_ = "HDA-star";
+	setNumberOfWorkers(num_workers);
+	setInflation(inflation);
+}
+
+
+HashDistributedAStar::~HashDistributedAStar()
+{
+	deleteWorkerModels();
+	for (unsigned int i = 0; i < workers_.size(); i++)
+		delete workers_[i];
+}
+
+
+bool HashDistributedAStar::init()
+{
+	return true;
+}
+
+
+bool HashDistributedAStar::compute(Vertex source,
+								   Vertex target,
+								   double computation_time)
+{
+	DWL_SCOPED_TIMER("HashDistributedAStar::compute");
+
+	if (!is_set_adjacency_model_) {
+		printf(RED "Could not computed the shortest path because "
+				"it is required to defined an adjacency model\n" COLOR_RESET);
+		return false;
+	}
+
+	// Setting the initial time. Note that the allowed time is a wall-clock time, and the
+	// times longer than a year don't define a deadline
+	time_started_ = clock();
+	if (computation_time < 365. * 24. * 3600.)
+		deadline_ = std::chrono::steady_clock::now() +
+				std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+						std::chrono::duration<double>(computation_time));
+	else
+		deadline_ = std::chrono::steady_clock::time_point::max();
+
+	// Creating the workers and clearing their previous search
+	while (workers_.size() < num_workers_)
+		workers_.push_back(new Worker());
+	for (unsigned int i = 0; i < num_workers_; i++) {
+		Worker& worker = *workers_[i];
+		worker.openset_heap.clear();
+		worker.g_cost_table.clear();
+		worker.policy_table.clear();
+		worker.inbox.clear();
+		worker.messages.clear();
+		worker.expansions = 0;
+	}
+	createWorkerModels();
+
+	// Sending the source vertex to its owner, and running the workers
+	source_ = source;
+	target_ = target;
+	stop_ = false;
+	best_cost_ = std::numeric_limits<double>::max();
+	best_goal_ = target;
+	pending_work_ = 0;
+	send(Message(source, source, 0.));
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < num_workers_; i++)
+		threads.push_back(std::thread(&HashDistributedAStar::search, this, i));
+	search(0);
+	for (unsigned int i = 0; i < threads.size(); i++)
+		threads[i].join();
+	deleteWorkerModels();
+
+	expansions_ = 0;
+	for (unsigned int i = 0; i < num_workers_; i++)
+		expansions_ += workers_[i]->expansions;
+	DWL_COUNT_EVENTS("HashDistributedAStar::expansions", expansions_);
+
+	// Merging the previous vertices of the path from the owners of its vertices
+	policy_.clear();
+	policy_table_.clear();
+	total_cost_ = best_cost_;
+	if (best_cost_ == std::numeric_limits<double>::max()) {
+		if (stop_)
+			printf(YELLOW "Warning: the HDA* search didn't find a solution in the allowed time"
+					"\n" COLOR_RESET);
+		return false;
+	}
+
+	Vertex vertex = best_goal_;
+	if (best_goal_ != target) {
+		if (indexed_heap_)
+			policy_table_[target] = best_goal_;
+		else
+			policy_[target] = best_goal_;
+	}
+	const Vertex* previous;
+	while (vertex != source &&
+			(previous = workers_[getOwner(vertex)]->policy_table.find(vertex)) != NULL) {
+		if (indexed_heap_)
+			policy_table_[vertex] = *previous;
+		else
+			policy_[vertex] = *previous;
+		vertex = *previous;
+	}
+
+	return true;
+}
+
+
+void HashDistributedAStar::setNumberOfWorkers(unsigned int num_workers)
+{
+	if (num_workers == 0)
+		num_workers = std::max(1u, std::thread::hardware_concurrency());
+
+	num_workers_ = num_workers;
+}
+
+
+void HashDistributedAStar::setInflation(double inflation)
+{
+	if (inflation < 1.) {
+		printf(YELLOW "Warning: the inflation has to be bigger or equals than one, so it's set"
+				" to one\n" COLOR_RESET);
+		inflation = 1.;
+	}
+
+	inflation_ = inflation;
+}
+
+
+int HashDistributedAStar::getNumberOfExpansions() const
+{
+	return expansions_;
+}
+
+
+void HashDistributedAStar::search(unsigned int index)
+{
+	Worker& worker = *workers_[index];
+
+	// The successors are allocated from a pool of the worker, since the search pool isn't
+	// thread-safe
+	utils::MemoryPool pool;
+	EdgeList successors((utils::PoolAllocator<Edge>(&pool)));
+	bool active = false;
+	while (!stop_) {
+		// Taking the received messages. Note that the worker is activated before consuming
+		// them, so the pending work never drops to zero in between
+		{
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.messages.swap(worker.inbox);
+		}
+		if (!worker.messages.empty()) {
+			if (!active) {
+				active = true;
+				++pending_work_;
+			}
+			for (unsigned int i = 0; i < worker.messages.size(); i++)
+				relax(worker, worker.messages[i]);
+			pending_work_ -= worker.messages.size();
+			worker.messages.clear();
+		}
+
+		// Waiting for messages if the openset cannot improve the best solution, i.e. the
+		// solution is bounded by the inflation times the optimal cost. The search finishes
+		// when all the workers are idle and there aren't messages
+		if (worker.openset_heap.empty() ||
+				!(worker.openset_heap.topPriority() < best_cost_.load())) {
+			if (active) {
+				active = false;
+				--pending_work_;
+			}
+			if (pending_work_ == 0)
+				break;
+
+			std::unique_lock<std::mutex> lock(worker.mutex);
+			worker.condition.wait_for(lock, std::chrono::milliseconds(1));
+			continue;
+		}
+
+		// Expanding the minimum vertex of the openset
+		Vertex current = worker.openset_heap.top();
+		worker.openset_heap.pop();
+		Weight g_cost = worker.g_cost_table.get(current);
+		if (worker.adjacency->isReachedGoal(target_, current)) {
+			std::lock_guard<std::mutex> lock(solution_mutex_);
+			if (g_cost < best_cost_) {
+				best_cost_ = g_cost;
+				best_goal_ = current;
+			}
+			continue;
+		}
+
+		successors.clear();
+		{
+			DWL_SCOPED_TIMER("SearchTreeSolver::getSuccessors");
+			if (shared_adjacency_) {
+				std::lock_guard<std::mutex> lock(adjacency_mutex_);
+				worker.adjacency->getSuccessors(successors, current);
+			} else
+				worker.adjacency->getSuccessors(successors, current);
+		}
+		for (EdgeList::iterator edge_iter = successors.begin();
+				edge_iter != successors.end(); edge_iter++) {
+			Weight tentative_g_cost = g_cost + edge_iter->weight;
+			if (tentative_g_cost >= best_cost_)
+				continue;
+
+			Message message(edge_iter->target, current, tentative_g_cost);
+			if (getOwner(message.vertex) == index)
+				relax(worker, message);
+			else
+				send(message);
+		}
+		worker.expansions++;
+
+		// Checking the allowed time
+		if ((worker.expansions & 63) == 0 &&
+				std::chrono::steady_clock::now() > deadline_)
+			stop_ = true;
+	}
+}
+
+
+void HashDistributedAStar::relax(Worker& worker,
+								 const Message& message)
+{
+	if (!(message.g_cost < worker.g_cost_table.get(message.vertex)))
+		return;
+
+	// Updating the vertex, and reopening it if it was expanded
+	worker.g_cost_table[message.vertex] = message.g_cost;
+	worker.policy_table[message.vertex] = message.previous;
+	double h_cost;
+	if (shared_adjacency_) {
+		std::lock_guard<std::mutex> lock(adjacency_mutex_);
+		h_cost = worker.adjacency->heuristicCost(message.vertex, target_);
+	} else
+		h_cost = worker.adjacency->heuristicCost(message.vertex, target_);
+	worker.openset_heap.push(message.vertex, message.g_cost + inflation_ * h_cost);
+}
+
+
+void HashDistributedAStar::send(const Message& message)
+{
+	// Counting the message before it's queued, so it's pending until it's consumed
+	++pending_work_;
+	Worker& owner = *workers_[getOwner(message.vertex)];
+	{
+		std::lock_guard<std::mutex> lock(owner.mutex);
+		owner.inbox.push_back(message);
+	}
+	owner.condition.notify_one();
+}
+
+
+unsigned int HashDistributedAStar::getOwner(Vertex vertex) const
+{
+	// Multiplicative hashing (Fibonacci), so neighbor vertices are spread over the workers
+	uint64_t hash = (uint64_t) vertex * 11400714819323198485ull;
+	return (unsigned int) ((hash >> 32) % num_workers_);
+}
+
+
+void HashDistributedAStar::createWorkerModels()
+{
+	deleteWorkerModels();
+
+	// Creating a clone of the adjacency model per worker. The workers share (and lock) the
+	// adjacency model if it cannot be cloned
+	shared_adjacency_ = false;
+	for (unsigned int i = 0; i < num_workers_; i++) {
+		model::AdjacencyModel* adjacency = NULL;
+		if (num_workers_ > 1)
+			adjacency = adjacency_->clone();
+		if (adjacency == NULL) {
+			shared_adjacency_ = num_workers_ > 1;
+			break;
+		}
+		workers_[i]->adjacency = adjacency;
+	}
+
+	if (num_workers_ == 1 || shared_adjacency_) {
+		deleteWorkerModels();
+		for (unsigned int i = 0; i < num_workers_; i++)
+			workers_[i]->adjacency = adjacency_;
+	}
+}
+
+
+void HashDistributedAStar::deleteWorkerModels()
+{
+	for (unsigned int i = 0; i < workers_.size(); i++) {
+		if (workers_[i]->adjacency != adjacency_)
+			delete workers_[i]->adjacency;
+		workers_[i]->adjacency = NULL;
+	}
+}
+
+} //@namespace solver
+} //@namespace dwl
@@ -0,0 +1,188 @@
+#ifndef DWL__SOLVER__HASH_DISTRIBUTED_ASTAR__H
+#define DWL__SOLVER__HASH_DISTRIBUTED_ASTAR__H
+
+#include <dwl/solver/SearchTreeSolver.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/**
+ * @class HashDistributedAStar
+ * @brief Class for solving a shortest-search problem using a parallel best-first search, i.e.
+ * the Hash Distributed A* (HDA*). Every vertex is owned by a worker thread given its hash, and
+ * every worker expands its own openset, where the successors of other workers are sent to
+ * their message queues (asynchronously). So the opensets aren't shared, and the workers only
+ * synchronize to exchange the messages. The heuristic is inflated as in ARA*, and the search
+ * finishes when any queued vertex can't improve the best solution, which is bounded by the
+ * inflation times the optimal cost. The workers use clones of the adjacency model (see
+ * AdjacencyModel::clone), or the adjacency model with a lock if it can't be cloned. This class
+ * derives from the SearchTreeSolver class
+ */
+class HashDistributedAStar : public SearchTreeSolver
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param unsigned int Number of workers (zero for the number of hardware threads)
+		 * @param double Inflation of the heuristic, i.e. bounded suboptimality
+		 */
+		HashDistributedAStar(unsigned int num_workers = 0,
+							 double inflation = 1.);
+
+		/** @brief Destructor function */
+		~HashDistributedAStar();
+
+		/**
+		 * @brief Initializes the HDA* algorithm
+		 * @return True if HDA* algorithm was initialized
+		 */
+		bool init();
+
+		/**
+		 * @brief Computes a shortest-path using HDA* algorithm
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 * @param double Allowed time for computing a solution (in seconds), i.e. the wall-clock
+		 * time since the workers run concurrently
+		 * @return True if it was computed a solution
+		 */
+		bool compute(Vertex source,
+					 Vertex target,
+					 double computation_time);
+
+		/**
+		 * @brief Sets the number of workers
+		 * @param unsigned int Number of workers (zero for the number of hardware threads)
+		 */
+		void setNumberOfWorkers(unsigned int num_workers);
+
+		/**
+		 * @brief Sets the inflation of the heuristic, i.e. the cost of the solution is bounded
+		 * by the inflation times the optimal cost (for admissible heuristics)
+		 * @param double Inflation (bigger or equals than one)
+		 */
+		void setInflation(double inflation);
+
+		/** @brief Gets the number of expansions of the last computation */
+		int getNumberOfExpansions() const;
+
+
+	private:
+		/** @brief Message of a vertex, i.e. its g cost and previous vertex */
+		struct Message
+		{
+			Message() : vertex(0), previous(0), g_cost(0.) {}
+			Message(Vertex vertex, Vertex previous, Weight g_cost) :
+				vertex(vertex), previous(previous), g_cost(g_cost) {}
+
+			Vertex vertex;
+			Vertex previous;
+			Weight g_cost;
+		};
+
+		/** @brief Search of a worker, i.e. the openset, g cost and policy of its vertices */
+		struct Worker
+		{
+			Worker() : g_cost_table(std::numeric_limits<Weight>::max()), adjacency(NULL),
+					expansions(0) {}
+
+			IndexedHeap<> openset_heap;
+			VertexTable<Weight> g_cost_table;
+			VertexTable<Vertex> policy_table;
+
+			/** @brief Message queue, and the messages that are processed */
+			std::vector<Message> inbox;
+			std::vector<Message> messages;
+			std::mutex mutex;
+			std::condition_variable condition;
+
+			/** @brief Adjacency model of the worker (clone or shared one) */
+			model::AdjacencyModel* adjacency;
+
+			/** @brief Number of expansions */
+			unsigned int expansions;
+		};
+
+		/**
+		 * @brief Runs the search of a worker until the termination
+		 * @param unsigned int Worker index
+		 */
+		void search(unsigned int index);
+
+		/**
+		 * @brief Relaxes a vertex in its worker
+		 * @param Worker& Owner of the vertex
+		 * @param const Message& Message of the vertex
+		 */
+		void relax(Worker& worker,
+				   const Message& message);
+
+		/**
+		 * @brief Sends a message to the owner of its vertex
+		 * @param const Message& Message of the vertex
+		 */
+		void send(const Message& message);
+
+		/**
+		 * @brief Gets the worker that owns a vertex
+		 * @param Vertex Vertex id
+		 */
+		unsigned int getOwner(Vertex vertex) const;
+
+		/** @brief Creates the adjacency models of the workers */
+		void createWorkerModels();
+
+		/** @brief Deletes the adjacency models of the workers */
+		void deleteWorkerModels();
+
+		/** @brief Workers */
+		std::vector<Worker*> workers_;
+
+		/** @brief Number of workers */
+		unsigned int num_workers_;
+
+		/** @brief Inflation of the heuristic */
+		double inflation_;
+
+		/** @brief Source and target vertices of the search */
+		Vertex source_;
+		Vertex target_;
+
+		/**
+		 * @brief Amount of pending work, i.e. the number of active workers plus the number of
+		 * messages in the queues, which is zero when the search finishes
+		 */
+		std::atomic<long> pending_work_;
+
+		/** @brief Indicates if the search has to stop (e.g. timeout) */
+		std::atomic<bool> stop_;
+
+		/** @brief Cost of the best solution, and its goal vertex */
+		std::atomic<double> best_cost_;
+		Vertex best_goal_;
+		std::mutex solution_mutex_;
+
+		/** @brief Locks the adjacency model if its shared by the workers */
+		std::mutex adjacency_mutex_;
+		bool shared_adjacency_;
+
+		/** @brief Deadline of the computation */
+		std::chrono::steady_clock::time_point deadline_;
+
+		/** @brief number of expansions */
+		int expansions_;
+};
+
+} //@namespace solver
+} //@namespace dwl
+
+#endif
@@ -1,4 +1,6 @@
 #include <dwl/solver/IpoptNLP.h>
+#include <stdlib.h>
+#include <sstream>
 
 
 namespace dwl
@@ -12,7 +14,8 @@ IpoptNLP::IpoptNLP() : initialized_(false), print_level_(5),
 		file_print_level_(5), convergence_tol_(1e-7), max_iter_(-1),
 		dual_inf_tol_(1.), constr_viol_tol_(0.0001), compl_viol_tol_(0.0001),
 		acceptable_tol_(1e-6), acceptable_iter_(15), mu_strategy_("adaptive"),
-		jac_approximation_(false), hess_approximation_(false)
+		jac_approximation_(false), hess_approximation_(false), linear_solver_("mumps"),
+		linear_solver_threads_(0), linear_solver_ordering_("auto"), real_time_deadline_(false)
 {
 	name_ = "IpoptNLP";
 }
@@ -47,6 +50,7 @@ void IpoptNLP::setFromConfigFile(std::string filename)
 	YamlNamespace termination_ns = {ipopt_ns, "termination"};
 	YamlNamespace barrier_ns = {ipopt_ns, "barrier"};
 	YamlNamespace derivatives_ns = {ipopt_ns, "derivatives"};
+	YamlNamespace linear_solver_ns = {ipopt_ns, "linear_solver"};
 
 	// Output parameters
 	// Reading and setting up the print level
@@ -59,6 +63,11 @@ void IpoptNLP::setFromConfigFile(std::string filename)
 	if (yaml_reader.read(print_frequency_iter, "print_frequency_iter", output_ns))
 		setPrintFrequencyIteration(print_frequency_iter);
 
+	// Reading and opening the telemetry stream
+	std::string telemetry_file;
+	if (yaml_reader.read(telemetry_file, "telemetry_file", output_ns))
+		setTelemetryFile(telemetry_file);
+
 	// Reading and setting up the out file parameters
 	std::string option_file_name;
 	if (yaml_reader.read(option_file_name, "option_file_name", output_file_ns)) {
@@ -105,6 +114,11 @@ void IpoptNLP::setFromConfigFile(std::string filename)
 	if (yaml_reader.read(acceptable_iter, "acceptable_iter", termination_ns))
 		setAcceptableIterations(acceptable_iter);
 
+	// Reading and setting up the real-time deadline mode
+	bool real_time_deadline;
+	if (yaml_reader.read(real_time_deadline, "real_time_deadline", termination_ns))
+		setRealTimeDeadline(real_time_deadline);
+
 	// Barrier parameters
 	// Reading and setting up the out file parameters
 	std::string mu_strategy;
@@ -120,6 +134,20 @@ void IpoptNLP::setFromConfigFile(std::string filename)
 	if (yaml_reader.read(hess_approximation_, "hessian_approximation", derivatives_ns))
 		setHessianApproximation(hess_approximation_);
 
+	// Linear solver parameters
+	// Reading and setting up the linear solver, its number of threads and ordering
+	std::string linear_solver;
+	if (yaml_reader.read(linear_solver, "linear_solver", linear_solver_ns))
+		setLinearSolver(linear_solver);
+
+	int num_threads;
+	if (yaml_reader.read(num_threads, "num_threads", linear_solver_ns))
+		setLinearSolverThreads(num_threads);
+
+	std::string ordering;
+	if (yaml_reader.read(ordering, "ordering", linear_solver_ns))
+		setLinearSolverOrdering(ordering);
+
 	// Re-initialization of the solver if it was initialized
 	if (reinit)
 		init();
@@ -197,6 +225,7 @@ void IpoptNLP::setDualInfeasibilityTolerance(double tolerance)
 void IpoptNLP::setConstraintViolationTolerance(double tolerance)
 {
 	constr_viol_tol_ = tolerance;
+	ipopt_.setFeasibilityTolerance(constr_viol_tol_);
 
 	if (initialized_)
 		app_->Options()->SetNumericValue("constr_viol_tol", constr_viol_tol_);
@@ -251,10 +280,97 @@ void IpoptNLP::setHessianApproximation(bool enable)
 }
 
 
+void IpoptNLP::setLinearSolver(std::string linear_solver)
+{
+	linear_solver_ = linear_solver;
+
+	if (initialized_ && linear_solver_ != "auto")
+		setLinearSolverOptions(linear_solver_);
+}
+
+
+void IpoptNLP::setLinearSolverThreads(int num_threads)
+{
+	linear_solver_threads_ = num_threads;
+
+	// The OpenMP runtime reads the number of threads from the environment
+	if (linear_solver_threads_ > 0) {
+		std::stringstream threads;
+		threads << linear_solver_threads_;
+		setenv("OMP_NUM_THREADS", threads.str().c_str(), 1);
+	}
+}
+
+
+void IpoptNLP::setLinearSolverOrdering(std::string ordering)
+{
+	linear_solver_ordering_ = ordering;
+
+	if (initialized_ && !selected_linear_solver_.empty())
+		setLinearSolverOptions(selected_linear_solver_);
+}
+
+
+std::string IpoptNLP::selectLinearSolver(unsigned int num_variables,
+										 unsigned int num_constraints,
+										 unsigned int nnz_jacobian,
+										 unsigned int nnz_hessian)
+{
+	// Computing the size and density of the KKT system, where the unknown sparsity patterns
+	// are dense (as in the IpoptWrapper)
+	double n = num_variables, m = num_constraints;
+	double nnz_jac = (nnz_jacobian == 0) ? n * m : nnz_jacobian;
+	double nnz_hess = (nnz_hessian == 0) ? n * (n + 1) * 0.5 : nnz_hessian;
+	double dim = n + m;
+	double density = (dim > 0.) ? 2 * (nnz_jac + nnz_hess) / (dim * dim) : 1.;
+
+	if (dim < 1000. || density > 0.1)
+		return "ma57";
+	else
+		return "ma97";
+}
+
+
+void IpoptNLP::setLinearSolverOptions(const std::string& linear_solver)
+{
+	selected_linear_solver_ = linear_solver;
+	app_->Options()->SetStringValue("linear_solver", linear_solver);
+
+	// Translating the ordering to the options of the solver
+	const std::string& ordering = linear_solver_ordering_;
+	if (ordering != "auto" && ordering != "amd" && ordering != "metis") {
+		printf(YELLOW "Warning: the %s ordering isn't supported\n" COLOR_RESET, ordering.c_str());
+		return;
+	}
+	if (linear_solver == "ma57") {
+		int order = (ordering == "amd") ? 2 : (ordering == "metis") ? 4 : 5;
+		app_->Options()->SetIntegerValue("ma57_pivot_order", order);
+	} else if (linear_solver == "ma86") {
+		app_->Options()->SetStringValue("ma86_order", ordering);
+	} else if (linear_solver == "ma97") {
+		app_->Options()->SetStringValue("ma97_order", ordering);
+	} else if (linear_solver == "pardiso") {
+		if (ordering != "auto")
+			app_->Options()->SetStringValue("pardiso_order", ordering);
+	} else if (linear_solver == "mumps") {
+		int order = (ordering == "amd") ? 0 : (ordering == "metis") ? 5 : 7;
+		app_->Options()->SetIntegerValue("mumps_pivot_order", order);
+	}
+}
+
+
+void IpoptNLP::setRealTimeDeadline(bool enable)
+{
+	real_time_deadline_ = enable;
+}
+
+
 bool IpoptNLP::init()
 {
 	// Setting the optimization model to Ipopt wrapper
 	ipopt_.setOptimizationModel(model_);
+	ipopt_.setCancellationRequest(&cancelled_);
+	ipopt_.setTelemetry(&telemetry_);
 
 	// Create a new instance of your NLP
 	nlp_ptr_ = &ipopt_;
@@ -280,6 +396,8 @@ bool IpoptNLP::init()
 	setAcceptableConvergenceTolerance(acceptable_tol_);
 	setAcceptableIterations(acceptable_iter_);
 	setMuStrategy(mu_strategy_);
+	selected_linear_solver_.clear();
+	setLinearSolver(linear_solver_);
 
 	if (!model_->isCostGradientImplemented())
 		printf(BLUE "Info: Computing the Gradient using numerical differentiation.\n" COLOR_RESET);
@@ -298,8 +416,6 @@ bool IpoptNLP::init()
 		app_->Options()->SetStringValue("hessian_approximation", "limited-memory");
 	}
 
-	app_->Options()->SetStringValue("warm_start_init_point", "yes");
-
 //	app_->Options()->SetNumericValue("dual_inf_tol", 1000);
 //	app_->Options()->SetNumericValue("constr_viol_tol", 0.1);
 //	app_->Options()->SetNumericValue("compl_inf_tol", 0.1);
@@ -318,37 +434,102 @@ bool IpoptNLP::init()
 
 bool IpoptNLP::compute(double allocated_time_secs)
 {
-	// Setting the initial time
+	// Setting the initial time, which is the wall-clock time in the deadline mode
 	clock_t started_time = clock();
+	std::chrono::steady_clock::time_point started_wall_time = std::chrono::steady_clock::now();
+	if (real_time_deadline_)
+		ipopt_.setDeadline(allocated_time_secs);
+	else
+		ipopt_.clearDeadline();
+	ipopt_.resetBestIterate();
+	telemetry_.startSolve();
 
 	// Ask Ipopt to solve the problem
 	Ipopt::ApplicationReturnStatus status;
 
+	// Warm-starting the solver from the previous solution, where the primal variables are
+	// defined by the optimization model. Note that re-optimization reuses the problem structure
+	ipopt_.setWarmStart(warm_start_);
+	bool reoptimize = warm_start_ && ipopt_.hasMultipliers();
+	if (reoptimize) {
+		app_->Options()->SetStringValue("warm_start_init_point", "yes");
+		app_->Options()->SetNumericValue("warm_start_bound_push", 1e-9);
+		app_->Options()->SetNumericValue("warm_start_mult_bound_push", 1e-9);
+	} else
+		app_->Options()->SetStringValue("warm_start_init_point", "no");
+
+	// Selecting the linear solver from the size and sparsity of the problem. Note that the
+	// dimensions are known once the model is initialized (e.g. after the first solve)
+	if (linear_solver_ == "auto") {
+		std::string linear_solver = "mumps";
+		if (model_->getDimensionOfState() > 0)
+			linear_solver = selectLinearSolver(model_->getDimensionOfState(),
+											   model_->getDimensionOfConstraints(),
+											   model_->getNumberOfNonzeroJacobian(),
+											   model_->getNumberOfNonzeroHessian());
+		if (linear_solver != selected_linear_solver_)
+			setLinearSolverOptions(linear_solver);
+	}
+
 	// Computing the optimization problem
 	bool solved = false;
 	double current_duration_secs = 0;
-	while (!solved && (current_duration_secs < allocated_time_secs)) {
+	while (!solved && (current_duration_secs < allocated_time_secs) &&
+			!isCancellationRequested()) {
 		// Setting the allowed time for this optimization loop
 		double new_allocated_time_secs = allocated_time_secs - current_duration_secs;
 		app_->Options()->SetNumericValue("max_cpu_time", new_allocated_time_secs);
-		status = app_->OptimizeTNLP(nlp_ptr_);
+		if (reoptimize)
+			status = app_->ReOptimizeTNLP(nlp_ptr_);
+		else
+			status = app_->OptimizeTNLP(nlp_ptr_);
+
+		// Falling back to MUMPS if the selected solver isn't available in the Ipopt build
+		if (status == Ipopt::Invalid_Option && linear_solver_ == "auto" &&
+				selected_linear_solver_ != "mumps") {
+			printf(YELLOW "Warning: the %s linear solver isn't available, using mumps\n"
+					COLOR_RESET, selected_linear_solver_.c_str());
+			linear_solver_ = "mumps";
+			setLinearSolverOptions(linear_solver_);
+			continue;
+		}
 
 		if (status == Ipopt::Solve_Succeeded || status == Ipopt::Solved_To_Acceptable_Level)
 			solved = true;
-		else if (status == Ipopt::Infeasible_Problem_Detected)
+		else if (status == Ipopt::Infeasible_Problem_Detected ||
+				status == Ipopt::User_Requested_Stop)
 			break;
 
 		// Computing the current time
-		clock_t current_time = clock() - started_time;
-		current_duration_secs = ((double) current_time) / CLOCKS_PER_SEC;
+		if (real_time_deadline_) {
+			current_duration_secs = std::chrono::duration<double>(
+					std::chrono::steady_clock::now() - started_wall_time).count();
+		} else {
+			clock_t current_time = clock() - started_time;
+			current_duration_secs = ((double) current_time) / CLOCKS_PER_SEC;
+		}
 	}
 
 	if (solved) {
 		solution_ = ipopt_.getSolution();
-	} else
-		printf("\n\n*** The problem FAILED!\n");
+		return true;
+	}
+
+	// Returning the best iterate in the deadline mode, unless the user cancelled the solve
+	double violation;
+	if (real_time_deadline_ && !isCancellationRequested() &&
+			ipopt_.getBestIterate(solution_, violation)) {
+		if (violation <= constr_viol_tol_)
+			printf(YELLOW "Warning: the problem wasn't solved before the deadline, returning "
+					"the best feasible iterate\n" COLOR_RESET);
+		else
+			printf(YELLOW "Warning: the problem wasn't solved before the deadline, returning "
+					"the least infeasible iterate (violation %f)\n" COLOR_RESET, violation);
+		return true;
+	}
 
-	return solved;
+	printf("\n\n*** The problem FAILED!\n");
+	return false;
 }
 
 } //@namespace solver
@@ -5,6 +5,7 @@
 #include <dwl/solver/IpoptWrapper.h>
 #include <IpIpoptApplication.hpp>
 #include <time.h>
+#include <chrono>
 
 
 namespace dwl
@@ -113,6 +114,55 @@ class IpoptNLP : public OptimizationSolver
 		 */
 		void setHessianApproximation(bool enable);
 
+		/**
+		 * @brief Sets the linear solver of the KKT systems, i.e. ma27, ma57, ma77, ma86, ma97,
+		 * pardiso or mumps (the default one). The "auto" solver is selected from the size and
+		 * sparsity of the problem at every compute call (see selectLinearSolver). Note that the
+		 * HSL and Pardiso solvers have to be available in the Ipopt build
+		 * @param std::string Linear solver
+		 */
+		void setLinearSolver(std::string linear_solver);
+
+		/**
+		 * @brief Sets the number of threads of the multithreaded linear solvers (ma86, ma97 and
+		 * pardiso), which use OpenMP. The number is set through OMP_NUM_THREADS, so it has to be
+		 * set before the first solve
+		 * @param int Number of threads (0 for the default one of OpenMP)
+		 */
+		void setLinearSolverThreads(int num_threads);
+
+		/**
+		 * @brief Sets the fill-reducing ordering of the linear solver, i.e. auto, amd or metis,
+		 * which is translated to the option of the selected solver
+		 * @param std::string Ordering
+		 */
+		void setLinearSolverOrdering(std::string ordering);
+
+		/**
+		 * @brief Selects the linear solver from the size and sparsity of the KKT system. The
+		 * small or dense systems use ma57, since the multithreaded solvers don't pay off, and
+		 * the large and sparse use ma97, where the factorization dominates the solve
+		 * @param unsigned int Number of decision variables
+		 * @param unsigned int Number of constraints
+		 * @param unsigned int Number of nonzeros of the constraint Jacobian (0 for dense)
+		 * @param unsigned int Number of nonzeros of the Lagrangian Hessian (0 for dense)
+		 * @return The selected linear solver
+		 */
+		static std::string selectLinearSolver(unsigned int num_variables,
+											  unsigned int num_constraints,
+											  unsigned int nnz_jacobian,
+											  unsigned int nnz_hessian);
+
+		/**
+		 * @brief Enables/disables the real-time deadline mode. In this mode, the allocated time
+		 * of the compute call is a wall-clock deadline, which is checked once per iteration.
+		 * If the problem isn't solved before the deadline (or Ipopt fails), the best iterate is
+		 * returned instead of failing, i.e. the feasible iterate with the lowest cost, or the
+		 * least infeasible one
+		 * @param bool True for enabling the deadline mode
+		 */
+		void setRealTimeDeadline(bool enable);
+
 		/**
 		 * @brief Initialization of the NLP solver using Ipopt
 		 * @return True if was initialized
@@ -184,6 +234,23 @@ class IpoptNLP : public OptimizationSolver
 
 		/** @brief True enables the numerical computationg using limited-memory */
 		bool hess_approximation_;
+
+		/** @brief Linear solver, number of threads and ordering */
+		std::string linear_solver_;
+		int linear_solver_threads_;
+		std::string linear_solver_ordering_;
+
+		/** @brief Linear solver used in the last compute call */
+		std::string selected_linear_solver_;
+
+		/**
+		 * @brief Sets the options of a linear solver, i.e. the solver and its ordering
+		 * @param const std::string& Linear solver
+		 */
+		void setLinearSolverOptions(const std::string& linear_solver);
+
+		/** @brief True enables the real-time deadline mode */
+		bool real_time_deadline_;
 };
 
 } //@namespace solver
@@ -1,4 +1,5 @@
 #include <dwl/solver/IpoptWrapper.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -7,7 +8,11 @@ namespace dwl
 namespace solver
 {
 
-IpoptWrapper::IpoptWrapper() : opt_model_(NULL), jacobian_(false), hessian_(false)
+IpoptWrapper::IpoptWrapper() : opt_model_(NULL), warm_start_(false),
+		cancelled_(NULL), telemetry_(NULL), has_deadline_(false), deadline_reached_(false), best_cost_(0.),
+		best_violation_(0.), has_best_iterate_(false), feasibility_tol_(0.0001),
+		initialized_model_(false), jacobian_(false), hessian_(false), cached_cost_(0.),
+		is_cost_cached_(false), is_gradient_cached_(false), is_constraint_cached_(false)
 {
 
 }
@@ -22,14 +27,105 @@ IpoptWrapper::~IpoptWrapper()
 void IpoptWrapper::setOptimizationModel(model::OptimizationModel* model)
 {
 	opt_model_ = model;
+	initialized_model_ = false;
+	invalidateCache();
+
+	// Cleaning the multipliers of the previous model
+	lower_bound_mult_.resize(0);
+	upper_bound_mult_.resize(0);
+	constraint_mult_.resize(0);
+}
+
+
+void IpoptWrapper::setWarmStart(bool warm_start)
+{
+	warm_start_ = warm_start;
+}
+
+
+void IpoptWrapper::setCancellationRequest(const std::atomic<bool>* cancelled)
+{
+	cancelled_ = cancelled;
+}
+
+
+void IpoptWrapper::setTelemetry(SolverTelemetry* telemetry)
+{
+	telemetry_ = telemetry;
+}
+
+
+void IpoptWrapper::setDeadline(double allocated_time_secs)
+{
+	// A huge budget (e.g. the default of the compute call) would overflow the clock
+	if (allocated_time_secs > 1e9) {
+		clearDeadline();
+		return;
+	}
+
+	deadline_ = std::chrono::steady_clock::now() +
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(allocated_time_secs));
+	has_deadline_ = true;
+	deadline_reached_ = false;
+}
+
+
+void IpoptWrapper::clearDeadline()
+{
+	has_deadline_ = false;
+	deadline_reached_ = false;
+}
+
+
+bool IpoptWrapper::isDeadlineReached() const
+{
+	return deadline_reached_;
+}
+
+
+void IpoptWrapper::setFeasibilityTolerance(double tolerance)
+{
+	feasibility_tol_ = tolerance;
+}
+
+
+void IpoptWrapper::resetBestIterate()
+{
+	has_best_iterate_ = false;
+}
+
+
+bool IpoptWrapper::getBestIterate(Eigen::VectorXd& iterate,
+								  double& violation) const
+{
+	if (!has_best_iterate_)
+		return false;
+
+	iterate = best_iterate_;
+	violation = best_violation_;
+	return true;
+}
+
+
+bool IpoptWrapper::hasMultipliers()
+{
+	return lower_bound_mult_.size() != 0;
 }
 
 
 bool IpoptWrapper::get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
 								Index& nnz_h_lag, IndexStyleEnum& index_style)
 {
-	// Initializing the optimization model
-	opt_model_->init();
+	// Initializing the optimization model. In warm start, the model is initialized only once,
+	// so its dimensions and sparsity structure are reused
+	if (!warm_start_ || !initialized_model_) {
+		opt_model_->init();
+		initialized_model_ = true;
+	}
+
+	// The model could change between solves, so the values of the last point aren't valid
+	invalidateCache();
 
 	// Getting the dimension of decision variables for every knots
 	n = opt_model_->getDimensionOfState();
@@ -67,6 +163,12 @@ bool IpoptWrapper::get_bounds_info(Index n, Number* x_l, Number* x_u,
 	opt_model_->evaluateBounds(x_l, n, x_u, n,
 							   g_l, m, g_u, m);
 
+	// Recording the bounds for computing the constraint violation of the iterates
+	state_lower_bound_ = Eigen::Map<const Eigen::VectorXd>(x_l, n);
+	state_upper_bound_ = Eigen::Map<const Eigen::VectorXd>(x_u, n);
+	constraint_lower_bound_ = Eigen::Map<const Eigen::VectorXd>(g_l, m);
+	constraint_upper_bound_ = Eigen::Map<const Eigen::VectorXd>(g_u, m);
+
 	return true;
 }
 
@@ -75,18 +177,58 @@ bool IpoptWrapper::get_starting_point(Index n, bool init_x, Number* x,
 									  bool init_z, Number* z_L, Number* z_U,
 									  Index m, bool init_lambda, Number* lambda)
 {
-	// Here, we assume we only have starting values for x, if you code your own NLP, you can
-	// provide starting values for the dual variables if you wish to use a warmstart option
+	// Getting the starting values for x
 	opt_model_->getStartingPoint(x, n);
 
+	// Using the multipliers of the previous solution as starting values of the dual variables,
+	// which are requested only in warm start (warm_start_init_point option)
+	if (init_z) {
+		Eigen::Map<Eigen::VectorXd> lower_bound_mult(z_L, n);
+		Eigen::Map<Eigen::VectorXd> upper_bound_mult(z_U, n);
+		if (lower_bound_mult_.size() == n) {
+			lower_bound_mult = lower_bound_mult_;
+			upper_bound_mult = upper_bound_mult_;
+		} else {
+			lower_bound_mult.setZero();
+			upper_bound_mult.setZero();
+		}
+	}
+	if (init_lambda) {
+		Eigen::Map<Eigen::VectorXd> constraint_mult(lambda, m);
+		if (constraint_mult_.size() == m)
+			constraint_mult = constraint_mult_;
+		else
+			constraint_mult.setZero();
+	}
+
 	return true;
 }
 
 
 bool IpoptWrapper::eval_f(Index n, const Number* x, bool new_x, Number& obj_value)
 {
-	// Numerical evaluation of the cost function
-	opt_model_->evaluateCosts(obj_value, x, n);
+	SolverTelemetry::ScopedEvaluation timer(telemetry_, CostEvaluation);
+
+	// Returning the cost of the last point
+	if (new_x)
+		invalidateCache();
+	if (is_cost_cached_) {
+		obj_value = cached_cost_;
+		return true;
+	}
+
+	// Numerical evaluation of the cost and constraint functions in a single pass, since Ipopt
+	// usually requires the constraints at the same point
+	unsigned int m = opt_model_->getDimensionOfConstraints();
+	if (m > 0) {
+		cached_constraint_.resize(m);
+		opt_model_->evaluateCostsAndConstraints(obj_value, cached_constraint_.data(), m, x, n);
+		is_constraint_cached_ = true;
+	} else
+		opt_model_->evaluateCosts(obj_value, x, n);
+	cached_cost_ = obj_value;
+	is_cost_cached_ = true;
+	last_point_ = Eigen::Map<const Eigen::VectorXd>(x, n);
 
 	return true;
 }
@@ -94,8 +236,21 @@ bool IpoptWrapper::eval_f(Index n, const Number* x, bool new_x, Number& obj_valu
 
 bool IpoptWrapper::eval_grad_f(Index n, const Number* x, bool new_x, Number* grad_f)
 {
+	SolverTelemetry::ScopedEvaluation timer(telemetry_, GradientEvaluation);
+
+	// Returning the gradient of the last point, where Eigen interfaces the raw buffer
+	if (new_x)
+		invalidateCache();
+	Eigen::Map<Eigen::VectorXd> gradient(grad_f, n);
+	if (is_gradient_cached_ && cached_gradient_.size() == n) {
+		gradient = cached_gradient_;
+		return true;
+	}
+
 	// Computing the gradient of the cost function
 	opt_model_->evaluateCostGradient(grad_f, n, x, n);
+	cached_gradient_ = gradient;
+	is_gradient_cached_ = true;
 
 	return true;
 }
@@ -103,8 +258,23 @@ bool IpoptWrapper::eval_grad_f(Index n, const Number* x, bool new_x, Number* gra
 
 bool IpoptWrapper::eval_g(Index n, const Number* x, bool new_x, Index m, Number* g)
 {
-	// Numerical evaluation of the constraint function
-	opt_model_->evaluateConstraints(g, m, x, n);
+	SolverTelemetry::ScopedEvaluation timer(telemetry_, ConstraintEvaluation);
+
+	// Returning the constraints of the last point, where Eigen interfaces the raw buffer
+	if (new_x)
+		invalidateCache();
+	Eigen::Map<Eigen::VectorXd> constraint(g, m);
+	if (is_constraint_cached_ && cached_constraint_.size() == m) {
+		constraint = cached_constraint_;
+		return true;
+	}
+
+	// Numerical evaluation of the constraint and cost functions in a single pass
+	opt_model_->evaluateCostsAndConstraints(cached_cost_, g, m, x, n);
+	cached_constraint_ = constraint;
+	is_cost_cached_ = true;
+	is_constraint_cached_ = true;
+	last_point_ = Eigen::Map<const Eigen::VectorXd>(x, n);
 
 	return true;
 }
@@ -114,6 +284,10 @@ bool IpoptWrapper::eval_jac_g(Index n, const Number* x, bool new_x,
 							  Index m, Index nele_jac, Index* row_entries, Index* col_entries,
 							  Number* values)
 {
+	SolverTelemetry::ScopedEvaluation timer(telemetry_, JacobianEvaluation);
+	if (new_x)
+		invalidateCache();
+
 	bool flag = false;
 	if (values == NULL) {
 		flag = true;
@@ -147,6 +321,10 @@ bool IpoptWrapper::eval_h(Index n, const Number* x, bool new_x, Number obj_facto
 						  Index m, const Number* lambda, bool new_lambda,
 						  Index nele_hess, Index* row_entries, Index* col_entries, Number* values)
 {
+	SolverTelemetry::ScopedEvaluation timer(telemetry_, HessianEvaluation);
+	if (new_x)
+		invalidateCache();
+
 	bool flag = false;
 	if (values == NULL) {
 		flag = true;
@@ -213,6 +391,49 @@ void IpoptWrapper::finalize_solution(Ipopt::SolverReturn status,
 
 	// Evaluating the solution
 	solution_ = solution;
+
+	// Recording the multipliers for warm-starting the next solution
+	lower_bound_mult_ = Eigen::Map<const Eigen::VectorXd>(z_L, n);
+	upper_bound_mult_ = Eigen::Map<const Eigen::VectorXd>(z_U, n);
+	constraint_mult_ = Eigen::Map<const Eigen::VectorXd>(lambda, m);
+}
+
+
+bool IpoptWrapper::intermediate_callback(Ipopt::AlgorithmMode mode,
+										 Index iter, Number obj_value,
+										 Number inf_pr, Number inf_du,
+										 Number mu, Number d_norm,
+										 Number regularization_size,
+										 Number alpha_du, Number alpha_pr,
+										 Index ls_trials,
+										 const Ipopt::IpoptData* ip_data,
+										 Ipopt::IpoptCalculatedQuantities* ip_cq)
+{
+	// Recording the accepted iterate, which is needed if the optimization doesn't converge
+	recordIterate();
+
+	// Recording the telemetry of the iteration
+	if (telemetry_ != NULL && telemetry_->isOpen()) {
+		TelemetryIteration iteration;
+		iteration.iteration = iter;
+		iteration.objective = obj_value;
+		iteration.violation = inf_pr;
+		iteration.dual_infeasibility = inf_du;
+		iteration.barrier = mu;
+		iteration.step_size = alpha_pr;
+		iteration.step_norm = d_norm;
+		iteration.line_search_trials = ls_trials;
+		telemetry_->recordIteration(iteration);
+	}
+
+	// Stopping the optimization if the deadline was reached
+	if (has_deadline_ && std::chrono::steady_clock::now() >= deadline_) {
+		deadline_reached_ = true;
+		return false;
+	}
+
+	// Stopping the optimization if the cancellation was requested
+	return cancelled_ == NULL || !*cancelled_;
 }
 
 
@@ -221,5 +442,57 @@ const Eigen::VectorXd& IpoptWrapper::getSolution()
 	return solution_;
 }
 
+
+void IpoptWrapper::invalidateCache()
+{
+	is_cost_cached_ = false;
+	is_gradient_cached_ = false;
+	is_constraint_cached_ = false;
+}
+
+
+void IpoptWrapper::recordIterate()
+{
+	// The cost and constraints of the last point are needed, i.e. it wasn't invalidated by
+	// a new point
+	unsigned int n = last_point_.size();
+	unsigned int m = constraint_lower_bound_.size();
+	if (!is_cost_cached_ || (m > 0 && !is_constraint_cached_) ||
+			n != state_lower_bound_.size() || (m > 0 && cached_constraint_.size() != m))
+		return;
+
+	// Computing the violation (infinity norm) of the bounds and constraints
+	double violation = 0.;
+	if (n > 0) {
+		violation = std::max(violation, (state_lower_bound_ - last_point_).maxCoeff());
+		violation = std::max(violation, (last_point_ - state_upper_bound_).maxCoeff());
+	}
+	if (m > 0) {
+		violation = std::max(violation, (constraint_lower_bound_ - cached_constraint_).maxCoeff());
+		violation = std::max(violation, (cached_constraint_ - constraint_upper_bound_).maxCoeff());
+	}
+
+	// A feasible iterate is better than an infeasible one, the feasible iterates are compared
+	// by their cost, and the infeasible ones by their violation
+	bool feasible = violation <= feasibility_tol_;
+	bool best_feasible = has_best_iterate_ && best_violation_ <= feasibility_tol_;
+	bool better;
+	if (!has_best_iterate_)
+		better = true;
+	else if (feasible != best_feasible)
+		better = feasible;
+	else if (feasible)
+		better = cached_cost_ < best_cost_;
+	else
+		better = violation < best_violation_;
+
+	if (better) {
+		best_iterate_ = last_point_;
+		best_cost_ = cached_cost_;
+		best_violation_ = violation;
+		has_best_iterate_ = true;
+	}
+}
+
 } //@namespace solver
 } //@namespace dwl
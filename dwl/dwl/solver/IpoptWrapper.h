@@ -3,6 +3,9 @@
 
 #include <IpTNLP.hpp>
 #include <dwl/model/OptimizationModel.h>
+#include <dwl/solver/SolverTelemetry.h>
+#include <atomic>
+#include <chrono>
 
 
 namespace dwl
@@ -38,6 +41,72 @@ class IpoptWrapper : public Ipopt::TNLP
 		 */
 		void setOptimizationModel(model::OptimizationModel* model);
 
+		/**
+		 * @brief Enables/disables the warm start. In this mode, the optimization model is
+		 * initialized only once (i.e. its structure is reused), and the multipliers of the
+		 * previous solution are used as starting point of the dual variables
+		 * @param bool True for enabling the warm start
+		 */
+		void setWarmStart(bool warm_start);
+
+		/**
+		 * @brief Sets the cancellation request that stops the optimization between iterations
+		 * @param const std::atomic<bool>* Cancellation request (NULL for none)
+		 */
+		void setCancellationRequest(const std::atomic<bool>* cancelled);
+
+		/**
+		 * @brief Sets the telemetry, which records the iterations and times the evaluation
+		 * callbacks
+		 * @param SolverTelemetry* Telemetry (NULL for none)
+		 */
+		void setTelemetry(SolverTelemetry* telemetry);
+
+		/**
+		 * @brief Sets the wall-clock deadline of the optimization, which is checked once per
+		 * iteration, i.e. the optimization is stopped (user requested stop) after the deadline
+		 * @param double Allocated wall-clock time in seconds from now
+		 */
+		void setDeadline(double allocated_time_secs);
+
+		/** @brief Removes the deadline of the optimization */
+		void clearDeadline();
+
+		/**
+		 * @brief Indicates if the last optimization was stopped by the deadline
+		 * @return True if the deadline was reached
+		 */
+		bool isDeadlineReached() const;
+
+		/**
+		 * @brief Sets the tolerance of the constraint violation for considering an iterate as
+		 * feasible
+		 * @param double Tolerance of the constraint violation
+		 */
+		void setFeasibilityTolerance(double tolerance);
+
+		/**
+		 * @brief Removes the best iterate, so the next optimizations track a new one. Note that
+		 * the best iterate is kept between optimizations, e.g. between the restarts of a solve
+		 */
+		void resetBestIterate();
+
+		/**
+		 * @brief Gets the best iterate of the optimizations, i.e. the feasible iterate with the
+		 * lowest cost, or the least infeasible one if no iterate was feasible
+		 * @param Eigen::VectorXd& Best iterate
+		 * @param double& Constraint violation (infinity norm) of the best iterate
+		 * @return False if there isn't an iterate
+		 */
+		bool getBestIterate(Eigen::VectorXd& iterate,
+							double& violation) const;
+
+		/**
+		 * @brief Indicates if there are multipliers from a previous solution
+		 * @return True if the multipliers are available
+		 */
+		bool hasMultipliers();
+
 		/**@name Overloaded from TNLP */
 		/**
 		 * @brief Gets the general information about the NonLinear Program (NLP)
@@ -179,6 +248,35 @@ class IpoptWrapper : public Ipopt::TNLP
 							   Number obj_value, const Ipopt::IpoptData* ip_data,
 							   Ipopt::IpoptCalculatedQuantities* ip_cq);
 
+		/**
+		 * @brief Method called once per iteration, which records the best iterate and stops the
+		 * optimization (i.e. user requested stop) if the cancellation was requested or the
+		 * deadline was reached
+		 * @param Ipopt::AlgorithmMode Mode of the algorithm (regular or restoration phase)
+		 * @param Index Current iteration count
+		 * @param Number Unscaled objective value
+		 * @param Number Scaled primal infeasibility
+		 * @param Number Scaled dual infeasibility
+		 * @param Number Barrier parameter
+		 * @param Number Infinity norm of the primal step
+		 * @param Number Regularization term of the Hessian
+		 * @param Number Stepsize for the dual variables
+		 * @param Number Stepsize for the primal variables
+		 * @param Index Number of backtracking line search steps
+		 * @param const Ipopt::IpoptData* Ipopt data
+		 * @param Ipopt::IpoptCalculatedQuatities* Ipopt calculated quantities
+		 * @return False for stopping the optimization
+		 */
+		bool intermediate_callback(Ipopt::AlgorithmMode mode,
+								   Index iter, Number obj_value,
+								   Number inf_pr, Number inf_du,
+								   Number mu, Number d_norm,
+								   Number regularization_size,
+								   Number alpha_du, Number alpha_pr,
+								   Index ls_trials,
+								   const Ipopt::IpoptData* ip_data,
+								   Ipopt::IpoptCalculatedQuantities* ip_cq);
+
 		/**
 		 * @brief Gets the solution of the optimizer
 		 * @return const Eigen::VectorXd& Reference of the solution
@@ -204,11 +302,72 @@ class IpoptWrapper : public Ipopt::TNLP
 		/** @brief Solution vector */
 		Eigen::VectorXd solution_;
 
+		/** @brief Bound and constraint multipliers of the solution */
+		Eigen::VectorXd lower_bound_mult_;
+		Eigen::VectorXd upper_bound_mult_;
+		Eigen::VectorXd constraint_mult_;
+
+		/** @brief True if the warm start is enabled */
+		bool warm_start_;
+
+		/** @brief Cancellation request of the optimization */
+		const std::atomic<bool>* cancelled_;
+
+		/** @brief Telemetry of the iterations */
+		SolverTelemetry* telemetry_;
+
+		/** @brief Wall-clock deadline of the optimization */
+		std::chrono::steady_clock::time_point deadline_;
+		bool has_deadline_;
+		bool deadline_reached_;
+
+		/** @brief Bounds of the decision variables and constraints */
+		Eigen::VectorXd state_lower_bound_;
+		Eigen::VectorXd state_upper_bound_;
+		Eigen::VectorXd constraint_lower_bound_;
+		Eigen::VectorXd constraint_upper_bound_;
+
+		/**
+		 * @brief Best iterate, its cost and constraint violation. Ipopt doesn't pass the
+		 * iterate to the intermediate callback, so the last evaluated point is used, i.e. the
+		 * point accepted by the line search, and its violation is computed from the cached
+		 * constraints (unscaled)
+		 */
+		Eigen::VectorXd last_point_;
+		Eigen::VectorXd best_iterate_;
+		double best_cost_;
+		double best_violation_;
+		bool has_best_iterate_;
+
+		/** @brief Tolerance of the constraint violation of a feasible iterate */
+		double feasibility_tol_;
+
+		/** @brief True if the optimization model was initialized */
+		bool initialized_model_;
+
 		/** @brief True if the constraint Jacobian is implemented */
 		bool jacobian_;
 
 		/** @brief True if the Lagrangian Hessian is implemented */
 		bool hessian_;
+
+		/**
+		 * @brief Cost, gradient and constraints of the last evaluated point. Ipopt evaluates
+		 * f, g and their derivatives at the same point (new_x == false), so these values are
+		 * returned without evaluating the model again
+		 */
+		double cached_cost_;
+		Eigen::VectorXd cached_gradient_;
+		Eigen::VectorXd cached_constraint_;
+		bool is_cost_cached_;
+		bool is_gradient_cached_;
+		bool is_constraint_cached_;
+
+		/** @brief Invalidates the values of the last evaluated point */
+		void invalidateCache();
+
+		/** @brief Records the last evaluated point if it's better than the best iterate */
+		void recordIterate();
 };
 
 } //@namespace solver
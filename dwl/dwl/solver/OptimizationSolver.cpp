@@ -7,7 +7,7 @@ namespace dwl
 namespace solver
 {
 
-OptimizationSolver::OptimizationSolver() : model_(NULL)
+OptimizationSolver::OptimizationSolver() : model_(NULL), warm_start_(false), cancelled_(false)
 {
 
 }
@@ -65,6 +65,42 @@ bool OptimizationSolver::compute(double computation_time)
 }
 
 
+void OptimizationSolver::setWarmStart(bool warm_start)
+{
+	warm_start_ = warm_start;
+}
+
+
+void OptimizationSolver::requestCancellation()
+{
+	cancelled_ = true;
+}
+
+
+void OptimizationSolver::resetCancellation()
+{
+	cancelled_ = false;
+}
+
+
+bool OptimizationSolver::isCancellationRequested() const
+{
+	return cancelled_;
+}
+
+
+bool OptimizationSolver::setTelemetryFile(const std::string& filename)
+{
+	return telemetry_.open(filename);
+}
+
+
+SolverTelemetry& OptimizationSolver::getTelemetry()
+{
+	return telemetry_;
+}
+
+
 model::OptimizationModel* OptimizationSolver::getOptimizationModel()
 {
 	return model_;
@@ -2,8 +2,10 @@
 #define DWL__SOLVER__OPTIMIZATION_SOLVER__H
 
 #include <dwl/model/OptimizationModel.h>
+#include <dwl/solver/SolverTelemetry.h>
 #include <dwl/utils/YamlWrapper.h>
 #include <dwl/utils/utils.h>
+#include <atomic>
 
 
 namespace dwl
@@ -51,6 +53,37 @@ class OptimizationSolver
 		 */
 		virtual bool compute(double computation_time = 2e19);
 
+		/**
+		 * @brief Enables/disables the warm start of the solver, i.e. it reuses the information of
+		 * the previous solution (e.g. dual multipliers and problem structure) in the next compute call
+		 * @param bool True for enabling the warm start
+		 */
+		void setWarmStart(bool warm_start);
+
+		/**
+		 * @brief Requests the cancellation of the current computation, which can be called from
+		 * any thread. The solvers check it between their iterations, so the compute call returns
+		 * soon without a solution. Note that the request holds until it's reset
+		 */
+		void requestCancellation();
+
+		/** @brief Resets the cancellation request before a new computation */
+		void resetCancellation();
+
+		/** @brief Indicates if the cancellation of the computation was requested */
+		bool isCancellationRequested() const;
+
+		/**
+		 * @brief Opens the telemetry stream of the solver, i.e. a binary log with a row per
+		 * iteration (see SolverTelemetry), which is written outside the solve thread
+		 * @param const std::string& File name of the stream
+		 * @return True if the stream was opened
+		 */
+		bool setTelemetryFile(const std::string& filename);
+
+		/** @brief Gets the telemetry of the solver */
+		SolverTelemetry& getTelemetry();
+
 		/**
 		 * @brief Gets the optimization model
 		 * @return the object pointer of the optimization model
@@ -79,6 +112,15 @@ class OptimizationSolver
 
 		/** @brief The solution vector */
 		Eigen::VectorXd solution_;
+
+		/** @brief Label that indicates if the solver is warm-started */
+		bool warm_start_;
+
+		/** @brief Cancellation request of the current computation */
+		std::atomic<bool> cancelled_;
+
+		/** @brief Telemetry of the iterations */
+		SolverTelemetry telemetry_;
 };
 
 } //@namespace solver
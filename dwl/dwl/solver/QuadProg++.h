@@ -73,6 +73,7 @@ along with QuadProg++. If not, see <http://www.gnu.org/licenses/>.
 
 #include <Eigen/Dense>
 #include <stdio.h>
+#include <limits>
 
 
 namespace dwl
@@ -259,19 +260,63 @@ inline void delete_constraint(Eigen::MatrixXd& R, Eigen::MatrixXd& J,
 }
 
 
-inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
+/**
+ * The factorization of the Hessian G, i.e. its Cholesky decomposition G = L L^T and the initial
+ * value J = L^-T. It's computed once per Hessian, so the solves of QPs with the same Hessian
+ * (e.g. a whole-body QP with a constant Hessian) don't factorize it again
+ */
+struct QuadProgFactorization
+{
+	Eigen::LLT<Eigen::MatrixXd, Eigen::Lower> chol;
+	Eigen::MatrixXd J;
+	/* c1 * c2 is an estimate for cond(G) */
+	double c1;
+	double c2;
+};
+
+
+inline bool factorize_quadprog(QuadProgFactorization& factorization,
+							   const Eigen::MatrixXd& G)
+{
+	/* compute the trace of the original matrix G */
+	factorization.c1 = G.trace();
+
+	/* decompose the matrix G in the form LL^T */
+	factorization.chol.compute(G);
+	if (factorization.chol.info() != Eigen::Success)
+		return false;
+
+	/* compute the inverse of the factorized matrix G^-1, this is the initial value for H */
+	// J = L^-T
+	factorization.J.setIdentity(G.rows(), G.cols());
+	factorization.J = factorization.chol.matrixU().solve(factorization.J);
+	factorization.c2 = factorization.J.trace();
+
+	return true;
+}
+
+
+/**
+ * Solves the QP with a factorized Hessian. The active set is the set of active inequality
+ * constraints of a previous solution on input (warm start), and of this solution on output.
+ * The warm start adds these constraints after the equality ones, which is a feasible point in
+ * the dual space if their multipliers are nonnegative. Otherwise the solution starts from the
+ * unconstrained minimizer
+ */
+inline double solve_quadprog(const QuadProgFactorization& factorization,
+							 const Eigen::VectorXd& g0,
 							 const Eigen::MatrixXd& CE, const Eigen::VectorXd& ce0,
 							 const Eigen::MatrixXd& CI, const Eigen::VectorXd& ci0,
-							 Eigen::VectorXd& x)
+							 Eigen::VectorXd& x, Eigen::VectorXi& active_set)
 {
 	int i, k, l; /* indices */
 	int ip, me, mi;
 	int n = g0.size();
 	int p = ce0.size();
 	int m = ci0.size();
-	Eigen::MatrixXd R(G.rows(), G.cols()), J(G.rows(), G.cols());
+	Eigen::MatrixXd R(n, n), J(n, n);
 
-	Eigen::LLT <Eigen::MatrixXd, Eigen::Lower> chol(G.cols());
+	const Eigen::LLT<Eigen::MatrixXd, Eigen::Lower>& chol = factorization.chol;
 
 	Eigen::VectorXd s(m + p), z(n), r(m + p), d(n), np(n), u(m + p);
 	Eigen::VectorXd x_old(n), u_old(m + p);
@@ -283,6 +328,7 @@ inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
 	int q;
 	int iq, iter = 0;
 	bool iaexcl[m + p];
+	bool warm_start = active_set.size() > 0;
 
 	me = p; /* number of equality constraints */
 	mi = m; /* number of inequality constraints */
@@ -291,80 +337,116 @@ inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
 	/*
 	 * Preprocessing phase
 	 */
-	/* compute the trace of the original matrix G */
-	c1 = G.trace();
+	c1 = factorization.c1;
+	c2 = factorization.c2;
 
-	/* decompose the matrix G in the form LL^T */
-	chol.compute(G);
+	for (;;) {
+		/* initialize the matrix R */
+		d.setZero();
+		R.setZero();
+		R_norm = 1.0; /* this variable will hold the norm of the matrix R */
 
-	/* initialize the matrix R */
-	d.setZero();
-	R.setZero();
-	R_norm = 1.0; /* this variable will hold the norm of the matrix R */
-
-	/* compute the inverse of the factorized matrix G^-1, this is the initial value for H */
-	// J = L^-T
-	J.setIdentity();
-	J = chol.matrixU().solve(J);
-	c2 = J.trace();
+		/* the initial value for H is J = L^-T */
+		J = factorization.J;
 
 #ifdef TRACE_SOLVER
-	print_matrix("J", J, n);
+		print_matrix("J", J, n);
 #endif
 
-	/* c1 * c2 is an estimate for cond(G) */
-
-	/*
-	 * Find the unconstrained minimizer of the quadratic form 0.5 * x G x + g0 x
-	 * this is a feasible point in the dual space
-	 * x = G^-1 * g0
-	 */
-	x = chol.solve(g0);
-	x = -x;
-	/* and compute the current solution value */
-	f_value = 0.5 * g0.dot(x);
+		/*
+		 * Find the unconstrained minimizer of the quadratic form 0.5 * x G x + g0 x
+		 * this is a feasible point in the dual space
+		 * x = G^-1 * g0
+		 */
+		x = chol.solve(g0);
+		x = -x;
+		/* and compute the current solution value */
+		f_value = 0.5 * g0.dot(x);
 
 #ifdef TRACE_SOLVER
-	::std::cerr << "Unconstrained solution: " << f_value << ::std::endl;
-	print_vector("x", x, n);
+		::std::cerr << "Unconstrained solution: " << f_value << ::std::endl;
+		print_vector("x", x, n);
 #endif
 
-	/* Add equality constraints to the working set A */
-	iq = 0;
-	for (i = 0; i < me; i++) {
-		np = CE.col(i);
-		compute_d(d, J, np);
-		update_z(z, J, d, iq);
-		update_r(R, r, d, iq);
+		/* Add equality constraints to the working set A */
+		iq = 0;
+		for (i = 0; i < me; i++) {
+			np = CE.col(i);
+			compute_d(d, J, np);
+			update_z(z, J, d, iq);
+			update_r(R, r, d, iq);
 #ifdef TRACE_SOLVER
-		print_matrix("R", R, iq);
-		print_vector("z", z, n);
-		print_vector("r", r, iq);
-		print_vector("d", d, n);
+			print_matrix("R", R, iq);
+			print_vector("z", z, n);
+			print_vector("r", r, iq);
+			print_vector("d", d, n);
 #endif
 
-		/* compute full step length t2: i.e., the minimum step in primal space s.t. the contraint
-     	 becomes feasible */
-		t2 = 0.0;
-		if (::std::abs(z.dot(z)) > ::std::numeric_limits<double>::epsilon()) // i.e. z != 0
-			t2 = (-np.dot(x) - ce0(i)) / z.dot(np);
+			/* compute full step length t2: i.e., the minimum step in primal space s.t. the contraint
+			 becomes feasible */
+			t2 = 0.0;
+			if (::std::abs(z.dot(z)) > ::std::numeric_limits<double>::epsilon()) // i.e. z != 0
+				t2 = (-np.dot(x) - ce0(i)) / z.dot(np);
 
-		x += t2 * z;
+			x += t2 * z;
 
-		/* set u = u+ */
-		u(iq) = t2;
-		u.head(iq) -= t2 * r.head(iq);
+			/* set u = u+ */
+			u(iq) = t2;
+			u.head(iq) -= t2 * r.head(iq);
 
-		/* compute the new solution value */
-		f_value += 0.5 * (t2 * t2) * z.dot(np);
-		A(i) = -i - 1;
+			/* compute the new solution value */
+			f_value += 0.5 * (t2 * t2) * z.dot(np);
+			A(i) = -i - 1;
 
-		if (!add_constraint(R, J, d, iq, R_norm)) {
-			// FIXME: it should raise an error
-			// Equality constraints are linearly dependent
-			printf("quadprog ERROR1\n");
-			return f_value;
+			if (!add_constraint(R, J, d, iq, R_norm)) {
+				// FIXME: it should raise an error
+				// Equality constraints are linearly dependent
+				printf("quadprog ERROR1\n");
+				active_set.resize(0);
+				return f_value;
+			}
 		}
+
+		if (!warm_start)
+			break;
+
+		/* Add the inequality constraints of the previous active set to the working set, as it's
+		 done for the equality ones */
+		for (k = 0; k < active_set.size() && warm_start; k++) {
+			ip = active_set(k);
+			if (ip < 0 || ip >= mi) {
+				warm_start = false;
+				break;
+			}
+
+			np = CI.col(ip);
+			compute_d(d, J, np);
+			update_z(z, J, d, iq);
+			update_r(R, r, d, iq);
+
+			t2 = 0.0;
+			if (::std::abs(z.dot(z)) > ::std::numeric_limits<double>::epsilon()) // i.e. z != 0
+				t2 = (-np.dot(x) - ci0(ip)) / z.dot(np);
+
+			x += t2 * z;
+			u(iq) = t2;
+			u.head(iq) -= t2 * r.head(iq);
+			f_value += 0.5 * (t2 * t2) * z.dot(np);
+			A(iq) = ip;
+
+			/* the constraints of the previous active set are linearly dependent */
+			if (!add_constraint(R, J, d, iq, R_norm))
+				warm_start = false;
+		}
+
+		/* the point is feasible in the dual space if the multipliers of the active inequality
+		 constraints are nonnegative, otherwise the solution starts again without warm start */
+		for (k = me; k < iq && warm_start; k++) {
+			if (u(k) < 0.0)
+				warm_start = false;
+		}
+		if (warm_start)
+			break;
 	}
 
 	/* set iai = K \ A */
@@ -399,6 +481,7 @@ inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
       	  <= mi * ::std::numeric_limits<double>::epsilon() * c1 * c2 * 100.0) {
 		/* numerically there are not infeasibilities anymore */
 		q = iq;
+		active_set = A.segment(me, iq - me);
 		return f_value;
 	}
 
@@ -416,6 +499,7 @@ inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
 	}
 	if (ss >= 0.0) {
 		q = iq;
+		active_set = A.segment(me, iq - me);
 		return f_value;
 	}
 
@@ -478,6 +562,7 @@ inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
 		// FIXME: unbounded to raise
 		printf("no step in primal or dual space\n");
 		q = iq;
+		active_set.resize(0);
 		return inf;
 	}
 	/* case (ii): step in dual space */
@@ -568,6 +653,20 @@ inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
 	goto l2a;
 }
 
+
+inline double solve_quadprog(Eigen::MatrixXd& G, Eigen::VectorXd& g0,
+							 const Eigen::MatrixXd& CE, const Eigen::VectorXd& ce0,
+							 const Eigen::MatrixXd& CI, const Eigen::VectorXd& ci0,
+							 Eigen::VectorXd& x)
+{
+	QuadProgFactorization factorization;
+	if (!factorize_quadprog(factorization, G))
+		return ::std::numeric_limits<double>::infinity();
+
+	Eigen::VectorXi active_set;
+	return solve_quadprog(factorization, g0, CE, ce0, CI, ci0, x, active_set);
+}
+
 } //@namespace solver
 } //@namespace dwl
 
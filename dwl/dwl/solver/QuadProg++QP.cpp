@@ -1,4 +1,5 @@
 #include <dwl/solver/QuadProg++QP.h>
+#include <dwl/utils/Macros.h>
 
 
 namespace dwl
@@ -7,7 +8,7 @@ namespace dwl
 namespace solver
 {
 
-QuadProgQP::QuadProgQP()
+QuadProgQP::QuadProgQP() : persistent_(false), is_factorized_(false)
 {
 
 }
@@ -35,86 +36,172 @@ bool QuadProgQP::compute(const Eigen::MatrixXd& hessian,
 						 const Eigen::VectorXd& upper_constraint,
 						 double cputime)
 {
-	// Getting the number of equality and inequality constraints
-	unsigned int num_constraints = lower_constraint.size();
-	unsigned int num_eq_constraints = 0;
-	unsigned int num_ineq_constraints = 0;
-	for (unsigned int i = 0; i < num_constraints; i++) {
-		if ((upper_constraint - lower_constraint).isZero())
-			++num_eq_constraints;
-		else
-			++num_ineq_constraints;
+	variables_ = hessian.rows();
+	constraints_ = lower_constraint.size();
+
+	// Factorizing the Hessian, unless it's the factorized one in the persistent mode. Note that
+	// comparing the Hessians is cheaper than its Cholesky, i.e. O(n^2) instead of O(n^3)
+	if (!persistent_ || !is_factorized_ ||
+			hessian.rows() != factorized_hessian_.rows() ||
+			hessian.cols() != factorized_hessian_.cols() ||
+			hessian != factorized_hessian_) {
+		is_factorized_ = factorize_quadprog(factorization_, hessian);
+		if (!is_factorized_) {
+			printf(RED "Error: the Hessian isn't positive definite\n" COLOR_RESET);
+			return false;
+		}
+		if (persistent_)
+			factorized_hessian_ = hessian;
+	}
+
+	// Converting the constraints, where the previous active set isn't valid if their partition
+	// changed
+	if (setConstraints(constraint_mat,
+					   lower_bound, upper_bound,
+					   lower_constraint, upper_constraint) || !persistent_)
+		active_set_.resize(0);
+	if (persistent_)
+		constraint_mat_ = constraint_mat;
+
+	double cost = solve_quadprog(factorization_, gradient,
+								 eq_constraint_mat_, eq_bound_,
+								 ineq_constraint_mat_, ineq_bound_,
+								 solution_, active_set_);
+	initialized_solver_ = true;
+
+	return cost < std::numeric_limits<double>::infinity();
+}
+
+
+bool QuadProgQP::init(const Eigen::MatrixXd& hessian,
+					  const Eigen::VectorXd& gradient,
+					  const Eigen::MatrixXd& constraint_mat,
+					  const Eigen::VectorXd& lower_bound,
+					  const Eigen::VectorXd& upper_bound,
+					  const Eigen::VectorXd& lower_constraint,
+					  const Eigen::VectorXd& upper_constraint,
+					  double cputime)
+{
+	reset();
+	return compute(hessian, gradient, constraint_mat,
+				   lower_bound, upper_bound,
+				   lower_constraint, upper_constraint,
+				   cputime);
+}
+
+
+bool QuadProgQP::hotstart(const Eigen::VectorXd& gradient,
+						  const Eigen::VectorXd& lower_bound,
+						  const Eigen::VectorXd& upper_bound,
+						  const Eigen::VectorXd& lower_constraint,
+						  const Eigen::VectorXd& upper_constraint,
+						  double cputime)
+{
+	if (!persistent_ || !is_factorized_) {
+		printf(RED "Error: the persistent mode is required for reusing the matrices of the last"
+				" computation.\n" COLOR_RESET);
+		return false;
 	}
 
-	// Getting the number of equality and inequality bounds
+	return compute(factorized_hessian_, gradient, constraint_mat_,
+				   lower_bound, upper_bound,
+				   lower_constraint, upper_constraint,
+				   cputime);
+}
+
+
+void QuadProgQP::reset()
+{
+	QuadraticProgram::reset();
+	is_factorized_ = false;
+	active_set_.resize(0);
+	equalities_.clear();
+}
+
+
+void QuadProgQP::setPersistentFactorization(bool persistent)
+{
+	persistent_ = persistent;
+	reset();
+}
+
+
+const Eigen::VectorXi& QuadProgQP::getActiveSet() const
+{
+	return active_set_;
+}
+
+
+bool QuadProgQP::setConstraints(const Eigen::MatrixXd& constraint_mat,
+								const Eigen::VectorXd& lower_bound,
+								const Eigen::VectorXd& upper_bound,
+								const Eigen::VectorXd& lower_constraint,
+								const Eigen::VectorXd& upper_constraint)
+{
+	// Getting the partition in equalities and inequalities of the constraints and bounds
+	unsigned int num_constraints = lower_constraint.size();
 	unsigned int num_bounds = lower_bound.size();
-	unsigned int num_eq_bounds = 0;
-	unsigned int num_ineq_bounds = 0;
+	std::vector<bool> equalities(num_constraints + num_bounds);
+	unsigned int num_eq = 0;
 	for (unsigned int i = 0; i < num_constraints; i++) {
-		if ((upper_bound - lower_bound).isZero())
-			++num_eq_bounds;
-		else
-			++num_ineq_bounds;
+		equalities[i] = upper_constraint(i) == lower_constraint(i);
+		if (equalities[i])
+			++num_eq;
 	}
-
-	// Computing the constraint in/equality matrix and in/equality bound
-	Eigen::MatrixXd eq_constraint_mat = Eigen::MatrixXd::Zero(num_eq_constraints + num_eq_bounds,
-															  num_eq_constraints + num_eq_bounds);
-	Eigen::MatrixXd ineq_constraint_mat = Eigen::MatrixXd::Zero(num_ineq_constraints + num_ineq_bounds,
-																num_ineq_constraints + num_ineq_bounds);
-	Eigen::VectorXd eq_bound = Eigen::VectorXd::Zero(num_eq_constraints);
-	Eigen::VectorXd ineq_bound = Eigen::VectorXd::Zero(num_ineq_constraints);
+	for (unsigned int i = 0; i < num_bounds; i++) {
+		equalities[num_constraints + i] = upper_bound(i) == lower_bound(i);
+		if (equalities[num_constraints + i])
+			++num_eq;
+	}
+	unsigned int num_ineq = 2 * (num_constraints + num_bounds - num_eq);
+	bool changed = equalities != equalities_;
+	equalities_.swap(equalities);
+
+	// Computing the constraint in/equality matrix and in/equality bound, where the matrices
+	// are reallocated only if their dimensions change. Note that each column of the QuadProg++
+	// matrices is a constraint
+	eq_constraint_mat_.setZero(variables_, num_eq);
+	ineq_constraint_mat_.setZero(variables_, num_ineq);
+	eq_bound_.resize(num_eq);
+	ineq_bound_.resize(num_ineq);
 	unsigned int eq_idx = 0;
 	unsigned int ineq_idx = 0;
 	for (unsigned int i = 0; i < num_constraints; i++) {
-		if ((upper_constraint - lower_constraint).isZero()) {
+		if (equalities_[i]) {
 			// Converting lbA = Ax to Ax -lbA = 0
-			eq_constraint_mat.row(eq_idx) = constraint_mat.row(i);
-			eq_bound(eq_idx) = -lower_constraint(i);
+			eq_constraint_mat_.col(eq_idx) = constraint_mat.row(i).transpose();
+			eq_bound_(eq_idx) = -lower_constraint(i);
 			++eq_idx;
 		} else {
 			// Converting lbA <= Ax <= ubA to Ax -lbA >= 0 and -Ax + ubA >= 0
-			// Setting the equality bound component
-			ineq_constraint_mat.row(ineq_idx) = constraint_mat.row(i);
-			ineq_bound(ineq_idx) = -lower_constraint(i);
+			ineq_constraint_mat_.col(ineq_idx) = constraint_mat.row(i).transpose();
+			ineq_bound_(ineq_idx) = -lower_constraint(i);
 			++ineq_idx;
 
-			// Setting the inequality bound component
-			ineq_constraint_mat.row(ineq_idx) = -constraint_mat.row(i);
-			ineq_bound(ineq_idx) = upper_constraint(i);
+			ineq_constraint_mat_.col(ineq_idx) = -constraint_mat.row(i).transpose();
+			ineq_bound_(ineq_idx) = upper_constraint(i);
 			++ineq_idx;
 		}
 	}
 	for (unsigned int i = 0; i < num_bounds; i++) {
-		Eigen::VectorXd identity_row = Eigen::VectorXd::Zero(num_bounds);
-		identity_row(i) = 1;
-		if ((upper_bound - lower_bound).isZero()) {
+		if (equalities_[num_constraints + i]) {
 			// Converting lb = x to Ix - lb = 0
-			eq_constraint_mat.row(eq_idx) = identity_row;
-			eq_bound(eq_idx) = -lower_bound(i);
+			eq_constraint_mat_(i, eq_idx) = 1.;
+			eq_bound_(eq_idx) = -lower_bound(i);
 			++eq_idx;
 		} else {
 			// Converting lb <= x <= up to Ix - lb >= 0 and -Ix + ub >= 0
-			// Setting the equality bound component
-			ineq_constraint_mat.row(ineq_idx) = identity_row;
-			ineq_bound(ineq_idx) = -lower_bound(i);
+			ineq_constraint_mat_(i, ineq_idx) = 1.;
+			ineq_bound_(ineq_idx) = -lower_bound(i);
 			++ineq_idx;
 
-			// Setting the inequality bound component
-			ineq_constraint_mat.row(ineq_idx) = -identity_row;
-			ineq_bound(ineq_idx) = upper_bound(i);
+			ineq_constraint_mat_(i, ineq_idx) = -1.;
+			ineq_bound_(ineq_idx) = upper_bound(i);
 			++ineq_idx;
 		}
 	}
 
-	Eigen::MatrixXd copy_hessian = hessian;
-	Eigen::VectorXd copy_gradient = gradient;
-	solve_quadprog(copy_hessian, copy_gradient,
-				   eq_constraint_mat, eq_bound,
-				   ineq_constraint_mat, ineq_bound,
-				   solution_);
-
-	return true;
+	return changed;
 }
 
 } //@namespace solver
@@ -4,6 +4,7 @@
 #include <dwl/solver/QuadraticProgram.h>
 #include <dwl/solver/QuadProg++.h>
 #include <time.h>
+#include <vector>
 
 
 namespace dwl
@@ -28,10 +29,17 @@ namespace solver
  *	\mathbf{CE}^T\mathbf{x} + \mathbf{ce0} = \mathbf{0} \\
  *	\mathbf{CI}^T\mathbf{x} + \mathbf{ci0} \geq \mathbf{0}
  * \f}
+ * In the persistent mode, the factorization of the Hessian is kept while the Hessian doesn't
+ * change, and each solve warm-starts from the active set of the previous one. So a QP with a
+ * constant Hessian (e.g. a whole-body QP) only factorizes it once
  */
 class QuadProgQP : public QuadraticProgram
 {
 	public:
+		using QuadraticProgram::init;
+		using QuadraticProgram::compute;
+		using QuadraticProgram::hotstart;
+
 		/** @brief Constructor function */
 		QuadProgQP();
 
@@ -68,6 +76,83 @@ class QuadProgQP : public QuadraticProgram
 					 const Eigen::VectorXd& lower_constraint,
 					 const Eigen::VectorXd& upper_constraint,
 					 double cputime);
+
+		/**
+		 * @brief Computes the QP solution from scratch, i.e. it factorizes the Hessian and
+		 * discards the previous active set
+		 */
+		bool init(const Eigen::MatrixXd& hessian,
+				  const Eigen::VectorXd& gradient,
+				  const Eigen::MatrixXd& constraint_mat,
+				  const Eigen::VectorXd& lower_bound,
+				  const Eigen::VectorXd& upper_bound,
+				  const Eigen::VectorXd& lower_constraint,
+				  const Eigen::VectorXd& upper_constraint,
+				  double cputime);
+
+		/**
+		 * @brief Computes the QP solution reusing the Hessian and constraint matrix of the last
+		 * computation, i.e. its factorization and active set. It requires the persistent mode
+		 */
+		bool hotstart(const Eigen::VectorXd& gradient,
+					  const Eigen::VectorXd& lower_bound,
+					  const Eigen::VectorXd& upper_bound,
+					  const Eigen::VectorXd& lower_constraint,
+					  const Eigen::VectorXd& upper_constraint,
+					  double cputime);
+
+		/** @brief Discards the factorization and active set of the last computation */
+		void reset();
+
+		/**
+		 * @brief Enables/disables the persistent mode, where the factorization of an unchanged
+		 * Hessian and the active set are reused between computations
+		 * @param bool True for enabling the persistent mode
+		 */
+		void setPersistentFactorization(bool persistent);
+
+		/**
+		 * @brief Gets the active inequality constraints of the last solution, which are indexes
+		 * of the inequalities of QuadProg++ (see setConstraints)
+		 * @return const Eigen::VectorXi& Active set
+		 */
+		const Eigen::VectorXi& getActiveSet() const;
+
+
+	private:
+		/**
+		 * @brief Converts the constraints and bounds to the QuadProg++ form, where an equal lower
+		 * and upper value is an equality, and the others are two inequalities (lower and upper)
+		 * @return bool True if the partition in equalities and inequalities changed
+		 */
+		bool setConstraints(const Eigen::MatrixXd& constraint_mat,
+							const Eigen::VectorXd& lower_bound,
+							const Eigen::VectorXd& upper_bound,
+							const Eigen::VectorXd& lower_constraint,
+							const Eigen::VectorXd& upper_constraint);
+
+		/** @brief True if the persistent mode is enabled */
+		bool persistent_;
+
+		/** @brief Factorization of the Hessian, and the factorized Hessian */
+		QuadProgFactorization factorization_;
+		Eigen::MatrixXd factorized_hessian_;
+		bool is_factorized_;
+
+		/** @brief Constraint matrix of the last computation (persistent mode) */
+		Eigen::MatrixXd constraint_mat_;
+
+		/** @brief Active inequality constraints of the last solution */
+		Eigen::VectorXi active_set_;
+
+		/** @brief Equality (true) and inequality partition of the bounds and constraints */
+		std::vector<bool> equalities_;
+
+		/** @brief Matrices and vectors of the constraints in the QuadProg++ form */
+		Eigen::MatrixXd eq_constraint_mat_;
+		Eigen::VectorXd eq_bound_;
+		Eigen::MatrixXd ineq_constraint_mat_;
+		Eigen::VectorXd ineq_bound_;
 };
 
 } //@namespace solver
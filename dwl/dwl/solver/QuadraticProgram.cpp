@@ -1,4 +1,5 @@
 #include <dwl/solver/QuadraticProgram.h>
+#include <dwl/utils/Macros.h>
 
 
 namespace dwl
@@ -19,6 +20,95 @@ QuadraticProgram::~QuadraticProgram()
 
 }
 
+
+bool QuadraticProgram::compute(const Eigen::SparseMatrix<double>& hessian,
+							   const Eigen::VectorXd& gradient,
+							   const Eigen::SparseMatrix<double>& constraint_mat,
+							   const Eigen::VectorXd& lower_bound,
+							   const Eigen::VectorXd& upper_bound,
+							   const Eigen::VectorXd& lower_constraint,
+							   const Eigen::VectorXd& upper_constraint,
+							   double cputime)
+{
+	return compute(Eigen::MatrixXd(hessian), gradient,
+				   Eigen::MatrixXd(constraint_mat),
+				   lower_bound, upper_bound,
+				   lower_constraint, upper_constraint,
+				   cputime);
+}
+
+
+bool QuadraticProgram::init(const Eigen::MatrixXd& hessian,
+							const Eigen::VectorXd& gradient,
+							const Eigen::MatrixXd& constraint_mat,
+							const Eigen::VectorXd& lower_bound,
+							const Eigen::VectorXd& upper_bound,
+							const Eigen::VectorXd& lower_constraint,
+							const Eigen::VectorXd& upper_constraint,
+							double cputime)
+{
+	return compute(hessian, gradient, constraint_mat,
+				   lower_bound, upper_bound,
+				   lower_constraint, upper_constraint,
+				   cputime);
+}
+
+
+bool QuadraticProgram::hotstart(const Eigen::MatrixXd& hessian,
+								const Eigen::VectorXd& gradient,
+								const Eigen::MatrixXd& constraint_mat,
+								const Eigen::VectorXd& lower_bound,
+								const Eigen::VectorXd& upper_bound,
+								const Eigen::VectorXd& lower_constraint,
+								const Eigen::VectorXd& upper_constraint,
+								double cputime)
+{
+	return compute(hessian, gradient, constraint_mat,
+				   lower_bound, upper_bound,
+				   lower_constraint, upper_constraint,
+				   cputime);
+}
+
+
+bool QuadraticProgram::hotstart(const Eigen::VectorXd& gradient,
+								const Eigen::VectorXd& lower_bound,
+								const Eigen::VectorXd& upper_bound,
+								const Eigen::VectorXd& lower_constraint,
+								const Eigen::VectorXd& upper_constraint,
+								double cputime)
+{
+	printf(RED "Error: this QP solver cannot reuse the matrices of the last computation.\n"
+			COLOR_RESET);
+	return false;
+}
+
+
+bool QuadraticProgram::compute(const Eigen::VectorXd& gradient,
+							   const Eigen::VectorXd& lower_bound,
+							   const Eigen::VectorXd& upper_bound,
+							   const Eigen::VectorXd& lower_constraint,
+							   const Eigen::VectorXd& upper_constraint,
+							   double cputime)
+{
+	return hotstart(gradient,
+					lower_bound, upper_bound,
+					lower_constraint, upper_constraint,
+					cputime);
+}
+
+
+bool QuadraticProgram::isInitialized() const
+{
+	return initialized_solver_;
+}
+
+
+void QuadraticProgram::reset()
+{
+	initialized_solver_ = false;
+}
+
+
 Eigen::VectorXd& QuadraticProgram::getOptimalSolution()
 {
 	return solution_;
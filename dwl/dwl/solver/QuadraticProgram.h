@@ -2,6 +2,7 @@
 #define DWL__SOLVER__QUADRATIC_PROGRAM__H
 
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 
 namespace dwl
 {
@@ -61,6 +62,123 @@ class QuadraticProgram
 							 const Eigen::VectorXd& lower_constraint,
 							 const Eigen::VectorXd& upper_constraint,
 							 double cputime) = 0;
+
+		/**
+		 * @brief Function to compute the QP solution with sparse Hessian and constraint
+		 * matrices (e.g. the block-banded matrices of an uncondensed MPC). The default
+		 * implementation converts the matrices to dense ones, so the solvers that exploit the
+		 * sparsity have to override it
+		 * @param const Eigen::SparseMatrix<double>& Hessian matrix
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::SparseMatrix<double>& Constraint matrix
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		virtual bool compute(const Eigen::SparseMatrix<double>& hessian,
+							 const Eigen::VectorXd& gradient,
+							 const Eigen::SparseMatrix<double>& constraint_mat,
+							 const Eigen::VectorXd& lower_bound,
+							 const Eigen::VectorXd& upper_bound,
+							 const Eigen::VectorXd& lower_constraint,
+							 const Eigen::VectorXd& upper_constraint,
+							 double cputime);
+
+		/**
+		 * @brief Function to compute the QP solution from scratch, i.e. without reusing the
+		 * factorization and active set of a previous computation. The default implementation
+		 * computes the solution, which is suitable for solvers without hotstart
+		 * @param const Eigen::MatrixXd& Hessian matrix
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::MatrixXd& Constraint matrix
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		virtual bool init(const Eigen::MatrixXd& hessian,
+						  const Eigen::VectorXd& gradient,
+						  const Eigen::MatrixXd& constraint_mat,
+						  const Eigen::VectorXd& lower_bound,
+						  const Eigen::VectorXd& upper_bound,
+						  const Eigen::VectorXd& lower_constraint,
+						  const Eigen::VectorXd& upper_constraint,
+						  double cputime);
+
+		/**
+		 * @brief Function to compute the QP solution with new matrices starting from the active
+		 * set of the last computation, which is suitable for slowly varying Hessian and
+		 * constraint matrices. The default implementation computes the solution
+		 * @param const Eigen::MatrixXd& Hessian matrix
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::MatrixXd& Constraint matrix
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		virtual bool hotstart(const Eigen::MatrixXd& hessian,
+							  const Eigen::VectorXd& gradient,
+							  const Eigen::MatrixXd& constraint_mat,
+							  const Eigen::VectorXd& lower_bound,
+							  const Eigen::VectorXd& upper_bound,
+							  const Eigen::VectorXd& lower_constraint,
+							  const Eigen::VectorXd& upper_constraint,
+							  double cputime);
+
+		/**
+		 * @brief Function to compute the QP solution reusing the Hessian and constraint matrices
+		 * of the last computation together with their factorization and active set, i.e. only
+		 * the gradient and bounds are updated (e.g. the feedback phase of a real-time iteration
+		 * scheme). The default implementation reports that the solver doesn't support it
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		virtual bool hotstart(const Eigen::VectorXd& gradient,
+							  const Eigen::VectorXd& lower_bound,
+							  const Eigen::VectorXd& upper_bound,
+							  const Eigen::VectorXd& lower_constraint,
+							  const Eigen::VectorXd& upper_constraint,
+							  double cputime);
+
+		/**
+		 * @brief Function to compute the QP solution reusing the Hessian and constraint matrices
+		 * of the last computation, i.e. only the vectors are updated. It hotstarts with the vectors
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		virtual bool compute(const Eigen::VectorXd& gradient,
+							 const Eigen::VectorXd& lower_bound,
+							 const Eigen::VectorXd& upper_bound,
+							 const Eigen::VectorXd& lower_constraint,
+							 const Eigen::VectorXd& upper_constraint,
+							 double cputime);
+
+		/**
+		 * @brief Indicates if the QP solver has been initialized with a first problem
+		 * @return bool True if the solver is initialized
+		 */
+		bool isInitialized() const;
+
+		/** @brief Discards the last computation, so the next one starts from scratch */
+		virtual void reset();
 				
 		/**
 	 	 * @brief Get the vector of optimal or sub-optimal solutions calculated by the
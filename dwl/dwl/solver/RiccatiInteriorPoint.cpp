@@ -0,0 +1,444 @@
+#include <dwl/solver/RiccatiInteriorPoint.h>
+#include <dwl/utils/Macros.h>
+#include <time.h>
+#include <cmath>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/** @brief Bound magnitude from which a bound is considered inactive */
+static const double NO_BOUND = 1e20;
+
+RiccatiInteriorPoint::RiccatiInteriorPoint() : states_(0), inputs_(0), horizon_(0),
+		max_iter_(50), tolerance_(1e-8), num_bounds_(0), iterations_(0)
+{
+
+}
+
+
+RiccatiInteriorPoint::~RiccatiInteriorPoint()
+{
+
+}
+
+
+bool RiccatiInteriorPoint::init(unsigned int num_states,
+								unsigned int num_inputs,
+								unsigned int horizon,
+								unsigned int num_constraints,
+								unsigned int num_terminal_constraints)
+{
+	if (horizon == 0) {
+		printf(RED "Error: the horizon of the Riccati solver has to be positive\n" COLOR_RESET);
+		return false;
+	}
+
+	states_ = num_states;
+	inputs_ = num_inputs;
+	horizon_ = horizon;
+
+	// Setting the default problem, i.e. zero dynamics and state weights, identity input
+	// weights and unconstrained stages. Note that the terminal stage has only states
+	A_.assign(horizon_, Eigen::MatrixXd::Zero(states_, states_));
+	B_.assign(horizon_, Eigen::MatrixXd::Zero(states_, inputs_));
+	b_.assign(horizon_, Eigen::VectorXd::Zero(states_));
+	Q_.assign(horizon_ + 1, Eigen::MatrixXd::Zero(states_, states_));
+	q_.assign(horizon_ + 1, Eigen::VectorXd::Zero(states_));
+	R_.assign(horizon_, Eigen::MatrixXd::Identity(inputs_, inputs_));
+	S_.assign(horizon_, Eigen::MatrixXd::Zero(inputs_, states_));
+	r_.assign(horizon_, Eigen::VectorXd::Zero(inputs_));
+	C_.assign(horizon_, Eigen::MatrixXd::Zero(num_constraints, states_));
+	D_.assign(horizon_, Eigen::MatrixXd::Zero(num_constraints, inputs_));
+	lb_.assign(horizon_, Eigen::VectorXd::Constant(num_constraints, -NO_BOUND));
+	ub_.assign(horizon_, Eigen::VectorXd::Constant(num_constraints, NO_BOUND));
+	C_.push_back(Eigen::MatrixXd::Zero(num_terminal_constraints, states_));
+	D_.push_back(Eigen::MatrixXd::Zero(num_terminal_constraints, inputs_));
+	lb_.push_back(Eigen::VectorXd::Constant(num_terminal_constraints, -NO_BOUND));
+	ub_.push_back(Eigen::VectorXd::Constant(num_terminal_constraints, NO_BOUND));
+
+	// Allocating the iterates and the Riccati factorization
+	x_.assign(horizon_ + 1, Eigen::VectorXd::Zero(states_));
+	u_.assign(horizon_, Eigen::VectorXd::Zero(inputs_));
+	pi_.assign(horizon_ + 1, Eigen::VectorXd::Zero(states_));
+	dx_ = x_;
+	du_ = u_;
+	pi_new_ = pi_;
+	res_dyn_.assign(horizon_, Eigen::VectorXd::Zero(states_));
+	grad_x_ = x_;
+	grad_u_ = u_;
+	P_.assign(horizon_ + 1, Eigen::MatrixXd::Zero(states_, states_));
+	K_.assign(horizon_, Eigen::MatrixXd::Zero(inputs_, states_));
+	Huu_llt_.assign(horizon_, Eigen::LLT<Eigen::MatrixXd>(inputs_));
+	p_ = x_;
+	k_ff_ = u_;
+	lb_mask_.resize(horizon_ + 1);
+	ub_mask_.resize(horizon_ + 1);
+	s_lb_.resize(horizon_ + 1);
+	s_ub_.resize(horizon_ + 1);
+	lam_lb_.resize(horizon_ + 1);
+	lam_ub_.resize(horizon_ + 1);
+	ds_lb_.resize(horizon_ + 1);
+	ds_ub_.resize(horizon_ + 1);
+	dlam_lb_.resize(horizon_ + 1);
+	dlam_ub_.resize(horizon_ + 1);
+	res_lb_.resize(horizon_ + 1);
+	res_ub_.resize(horizon_ + 1);
+
+	return true;
+}
+
+
+void RiccatiInteriorPoint::setDynamics(unsigned int stage,
+									   const Eigen::MatrixXd& A,
+									   const Eigen::MatrixXd& B,
+									   const Eigen::VectorXd& b)
+{
+	A_[stage] = A;
+	B_[stage] = B;
+	b_[stage] = b;
+}
+
+
+void RiccatiInteriorPoint::setDynamics(const Eigen::MatrixXd& A,
+									   const Eigen::MatrixXd& B)
+{
+	Eigen::VectorXd b = Eigen::VectorXd::Zero(states_);
+	for (unsigned int k = 0; k < horizon_; k++)
+		setDynamics(k, A, B, b);
+}
+
+
+void RiccatiInteriorPoint::setCost(unsigned int stage,
+								   const Eigen::MatrixXd& Q,
+								   const Eigen::MatrixXd& R,
+								   const Eigen::MatrixXd& S,
+								   const Eigen::VectorXd& q,
+								   const Eigen::VectorXd& r)
+{
+	if (stage == horizon_) {
+		setTerminalCost(Q, q);
+		return;
+	}
+
+	Q_[stage] = Q;
+	R_[stage] = R;
+	S_[stage] = S;
+	q_[stage] = q;
+	r_[stage] = r;
+}
+
+
+void RiccatiInteriorPoint::setTerminalCost(const Eigen::MatrixXd& P,
+										   const Eigen::VectorXd& p)
+{
+	Q_[horizon_] = P;
+	q_[horizon_] = p;
+}
+
+
+void RiccatiInteriorPoint::setConstraints(unsigned int stage,
+										  const Eigen::MatrixXd& C,
+										  const Eigen::MatrixXd& D,
+										  const Eigen::VectorXd& lower_bound,
+										  const Eigen::VectorXd& upper_bound)
+{
+	C_[stage] = C;
+	D_[stage] = D;
+	lb_[stage] = lower_bound;
+	ub_[stage] = upper_bound;
+}
+
+
+void RiccatiInteriorPoint::setTerminalConstraints(const Eigen::MatrixXd& C,
+												  const Eigen::VectorXd& lower_bound,
+												  const Eigen::VectorXd& upper_bound)
+{
+	setConstraints(horizon_, C,
+				   Eigen::MatrixXd::Zero(C.rows(), inputs_),
+				   lower_bound, upper_bound);
+}
+
+
+void RiccatiInteriorPoint::setParameters(unsigned int max_iterations,
+										 double tolerance)
+{
+	max_iter_ = max_iterations;
+	tolerance_ = tolerance;
+}
+
+
+bool RiccatiInteriorPoint::compute(const Eigen::VectorXd& initial_state,
+								   double cputime)
+{
+	if (horizon_ == 0) {
+		printf(RED "Error: the Riccati solver has to be initialized\n" COLOR_RESET);
+		return false;
+	}
+
+	// Getting the initial time
+	clock_t started_time = clock();
+	double allocated_time = cputime * (double) CLOCKS_PER_SEC;
+
+	// Initializing the primal variables from a rollout with zero inputs, and the slacks and
+	// multipliers of the active bounds
+	x_[0] = initial_state;
+	for (unsigned int k = 0; k < horizon_; k++) {
+		u_[k].setZero();
+		x_[k+1] = A_[k] * x_[k] + b_[k];
+		pi_[k+1].setZero();
+	}
+	num_bounds_ = 0;
+	for (unsigned int k = 0; k < horizon_ + 1; k++) {
+		Eigen::ArrayXd g = (C_[k] * x_[k]).array();
+		if (k < horizon_)
+			g += (D_[k] * u_[k]).array();
+
+		lb_mask_[k] = (lb_[k].array() > -NO_BOUND).cast<double>();
+		ub_mask_[k] = (ub_[k].array() < NO_BOUND).cast<double>();
+		s_lb_[k] = lb_mask_[k] * (g - lb_[k].array()).max(1.) + (1 - lb_mask_[k]);
+		s_ub_[k] = ub_mask_[k] * (ub_[k].array() - g).max(1.) + (1 - ub_mask_[k]);
+		lam_lb_[k] = lb_mask_[k];
+		lam_ub_[k] = ub_mask_[k];
+		ds_lb_[k].setZero(g.size());
+		ds_ub_[k].setZero(g.size());
+		dlam_lb_[k].setZero(g.size());
+		dlam_ub_[k].setZero(g.size());
+		num_bounds_ += lb_mask_[k].sum() + ub_mask_[k].sum();
+	}
+
+	// Interior point iterations
+	bool converged = false;
+	for (iterations_ = 0; iterations_ < max_iter_; iterations_++) {
+		// Computing the residuals of the slacks, dynamics and Lagrangian gradient
+		double mu = 0., max_res = 0.;
+		for (unsigned int k = 0; k < horizon_ + 1; k++) {
+			Eigen::ArrayXd g = (C_[k] * x_[k]).array();
+			Eigen::VectorXd lam = (lam_lb_[k] - lam_ub_[k]).matrix();
+			grad_x_[k] = Q_[k] * x_[k] + q_[k] - C_[k].transpose() * lam;
+			if (k < horizon_) {
+				g += (D_[k] * u_[k]).array();
+				grad_x_[k] += S_[k].transpose() * u_[k];
+				grad_u_[k] = R_[k] * u_[k] + S_[k] * x_[k] + r_[k] - D_[k].transpose() * lam;
+				res_dyn_[k] = A_[k] * x_[k] + B_[k] * u_[k] + b_[k] - x_[k+1];
+
+				Eigen::VectorXd dual_u = grad_u_[k] + B_[k].transpose() * pi_[k+1];
+				max_res = std::max(max_res, dual_u.lpNorm<Eigen::Infinity>());
+				max_res = std::max(max_res, res_dyn_[k].lpNorm<Eigen::Infinity>());
+			}
+			res_lb_[k] = lb_mask_[k] * (g - lb_[k].array() - s_lb_[k]);
+			res_ub_[k] = ub_mask_[k] * (ub_[k].array() - g - s_ub_[k]);
+			mu += (s_lb_[k] * lam_lb_[k]).sum() + (s_ub_[k] * lam_ub_[k]).sum();
+
+			// Note that the initial state is fixed, so its gradient doesn't define a residual
+			if (k > 0) {
+				Eigen::VectorXd dual_x = grad_x_[k] - pi_[k];
+				if (k < horizon_)
+					dual_x += A_[k].transpose() * pi_[k+1];
+				max_res = std::max(max_res, dual_x.lpNorm<Eigen::Infinity>());
+			}
+			if (res_lb_[k].size() > 0) {
+				max_res = std::max(max_res, res_lb_[k].abs().maxCoeff());
+				max_res = std::max(max_res, res_ub_[k].abs().maxCoeff());
+			}
+		}
+		if (num_bounds_ > 0)
+			mu /= num_bounds_;
+
+		if (max_res <= tolerance_ && mu <= tolerance_) {
+			converged = true;
+			break;
+		}
+
+		if (cputime > 0. && (clock() - started_time) > allocated_time)
+			break;
+
+		// Factorizing the Newton system with the barrier weights of the current iterate
+		if (!factorize()) {
+			printf(RED "Error: the reduced Hessian of the Riccati recursion isn't positive "
+					"definite\n" COLOR_RESET);
+			return false;
+		}
+
+		// Computing the affine (predictor) step and the centering parameter
+		solveNewtonStep(0., false);
+		double step = computeStepLength();
+		if (num_bounds_ > 0) {
+			double mu_affine = 0.;
+			for (unsigned int k = 0; k < horizon_ + 1; k++) {
+				mu_affine += ((s_lb_[k] + step * ds_lb_[k]) * (lam_lb_[k] + step * dlam_lb_[k])).sum();
+				mu_affine += ((s_ub_[k] + step * ds_ub_[k]) * (lam_ub_[k] + step * dlam_ub_[k])).sum();
+			}
+			mu_affine /= num_bounds_;
+			double sigma = pow(mu_affine / mu, 3);
+
+			// Computing the corrector step, which reuses the Riccati factorization
+			solveNewtonStep(sigma * mu, true);
+			step = std::min(1., 0.995 * computeStepLength());
+		}
+
+		// Updating the primal-dual iterate
+		for (unsigned int k = 0; k < horizon_ + 1; k++) {
+			x_[k] += step * dx_[k];
+			pi_[k] += step * (pi_new_[k] - pi_[k]);
+			if (k < horizon_)
+				u_[k] += step * du_[k];
+
+			s_lb_[k] += step * ds_lb_[k];
+			s_ub_[k] += step * ds_ub_[k];
+			lam_lb_[k] += step * dlam_lb_[k];
+			lam_ub_[k] += step * dlam_ub_[k];
+		}
+	}
+
+	if (!converged) {
+		printf(YELLOW "Warning: the Riccati interior point didn't converge after %i iterations\n"
+				COLOR_RESET, iterations_);
+		return false;
+	}
+
+	return true;
+}
+
+
+const Eigen::VectorXd& RiccatiInteriorPoint::getOptimalState(unsigned int stage) const
+{
+	return x_[stage];
+}
+
+
+const Eigen::VectorXd& RiccatiInteriorPoint::getOptimalInput(unsigned int stage) const
+{
+	return u_[stage];
+}
+
+
+Eigen::VectorXd RiccatiInteriorPoint::getOptimalInputs() const
+{
+	Eigen::VectorXd inputs(horizon_ * inputs_);
+	for (unsigned int k = 0; k < horizon_; k++)
+		inputs.segment(k * inputs_, inputs_) = u_[k];
+
+	return inputs;
+}
+
+
+unsigned int RiccatiInteriorPoint::getHorizon() const
+{
+	return horizon_;
+}
+
+
+unsigned int RiccatiInteriorPoint::getNumberOfIterations() const
+{
+	return iterations_;
+}
+
+
+bool RiccatiInteriorPoint::factorize()
+{
+	// Terminal cost-to-go with the barrier weights, i.e. Q + C' diag(lam / s) C
+	Eigen::VectorXd weight = (lam_lb_[horizon_] / s_lb_[horizon_] +
+			lam_ub_[horizon_] / s_ub_[horizon_]).matrix();
+	P_[horizon_] = Q_[horizon_] + C_[horizon_].transpose() * weight.asDiagonal() * C_[horizon_];
+
+	// Backward Riccati recursion
+	for (int k = horizon_ - 1; k >= 0; k--) {
+		weight = (lam_lb_[k] / s_lb_[k] + lam_ub_[k] / s_ub_[k]).matrix();
+		Eigen::MatrixXd weighted_D = weight.asDiagonal() * D_[k];
+		Eigen::MatrixXd PA = P_[k+1] * A_[k];
+		Eigen::MatrixXd PB = P_[k+1] * B_[k];
+
+		Eigen::MatrixXd Huu = R_[k] + D_[k].transpose() * weighted_D + B_[k].transpose() * PB;
+		Eigen::MatrixXd Hux = S_[k] + weighted_D.transpose() * C_[k] + B_[k].transpose() * PA;
+		Huu_llt_[k].compute(Huu);
+		if (Huu_llt_[k].info() != Eigen::Success)
+			return false;
+
+		K_[k] = -Huu_llt_[k].solve(Hux);
+		P_[k] = Q_[k] + C_[k].transpose() * weight.asDiagonal() * C_[k] +
+				A_[k].transpose() * PA + Hux.transpose() * K_[k];
+		P_[k] = 0.5 * (P_[k] + P_[k].transpose()).eval();
+	}
+
+	return true;
+}
+
+
+void RiccatiInteriorPoint::solveNewtonStep(double target,
+										   bool correction)
+{
+	// Computing the complementarity residuals and the modified gradients, i.e. the slacks and
+	// multipliers are eliminated from the Newton system
+	std::vector<Eigen::ArrayXd> comp_lb(horizon_ + 1), comp_ub(horizon_ + 1);
+	std::vector<Eigen::VectorXd> gx(horizon_ + 1), gu(horizon_);
+	for (unsigned int k = 0; k < horizon_ + 1; k++) {
+		comp_lb[k] = lb_mask_[k] * (s_lb_[k] * lam_lb_[k] - target);
+		comp_ub[k] = ub_mask_[k] * (s_ub_[k] * lam_ub_[k] - target);
+		if (correction) {
+			comp_lb[k] += ds_lb_[k] * dlam_lb_[k];
+			comp_ub[k] += ds_ub_[k] * dlam_ub_[k];
+		}
+
+		Eigen::VectorXd w = ((comp_lb[k] + lam_lb_[k] * res_lb_[k]) / s_lb_[k] -
+				(comp_ub[k] + lam_ub_[k] * res_ub_[k]) / s_ub_[k]).matrix();
+		gx[k] = grad_x_[k] + C_[k].transpose() * w;
+		if (k < horizon_)
+			gu[k] = grad_u_[k] + D_[k].transpose() * w;
+	}
+
+	// Backward pass of the cost-to-go gradients and feedforward terms
+	p_[horizon_] = gx[horizon_];
+	for (int k = horizon_ - 1; k >= 0; k--) {
+		Eigen::VectorXd Pb = P_[k+1] * res_dyn_[k] + p_[k+1];
+		Eigen::VectorXd ru = gu[k] + B_[k].transpose() * Pb;
+		k_ff_[k] = -Huu_llt_[k].solve(ru);
+		p_[k] = gx[k] + A_[k].transpose() * Pb + K_[k].transpose() * ru;
+	}
+
+	// Forward pass of the primal step and the new costates
+	dx_[0].setZero();
+	for (unsigned int k = 0; k < horizon_; k++) {
+		du_[k] = K_[k] * dx_[k] + k_ff_[k];
+		dx_[k+1] = A_[k] * dx_[k] + B_[k] * du_[k] + res_dyn_[k];
+		pi_new_[k+1] = P_[k+1] * dx_[k+1] + p_[k+1];
+	}
+
+	// Recovering the step of the slacks and multipliers
+	for (unsigned int k = 0; k < horizon_ + 1; k++) {
+		Eigen::ArrayXd dg = (C_[k] * dx_[k]).array();
+		if (k < horizon_)
+			dg += (D_[k] * du_[k]).array();
+
+		ds_lb_[k] = lb_mask_[k] * (dg + res_lb_[k]);
+		ds_ub_[k] = ub_mask_[k] * (res_ub_[k] - dg);
+		dlam_lb_[k] = -(comp_lb[k] + lam_lb_[k] * ds_lb_[k]) / s_lb_[k];
+		dlam_ub_[k] = -(comp_ub[k] + lam_ub_[k] * ds_ub_[k]) / s_ub_[k];
+	}
+}
+
+
+double RiccatiInteriorPoint::computeStepLength() const
+{
+	double step = 1.;
+	for (unsigned int k = 0; k < horizon_ + 1; k++) {
+		for (int i = 0; i < s_lb_[k].size(); i++) {
+			if (ds_lb_[k](i) < 0.)
+				step = std::min(step, -s_lb_[k](i) / ds_lb_[k](i));
+			if (dlam_lb_[k](i) < 0.)
+				step = std::min(step, -lam_lb_[k](i) / dlam_lb_[k](i));
+			if (ds_ub_[k](i) < 0.)
+				step = std::min(step, -s_ub_[k](i) / ds_ub_[k](i));
+			if (dlam_ub_[k](i) < 0.)
+				step = std::min(step, -lam_ub_[k](i) / dlam_ub_[k](i));
+		}
+	}
+
+	return step;
+}
+
+} //@namespace solver
+} //@namespace dwl
@@ -0,0 +1,236 @@
+#ifndef DWL__SOLVER__RICCATI_INTERIOR_POINT__H
+#define DWL__SOLVER__RICCATI_INTERIOR_POINT__H
+
+#include <Eigen/Dense>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/**
+ * @class RiccatiInteriorPoint
+ * @brief Structure-exploiting solver of linear-quadratic optimal control problems, i.e. the
+ * uncondensed QP of a MPC with a LTI or LTV model. It solves problems of the following form
+ * \f[
+ * 	\min_{\mathbf{x},\mathbf{u}} \sum_{k=0}^{N-1} \frac{1}{2}\mathbf{x}_k^T\mathbf{Q}_k\mathbf{x}_k
+ * 	+ \mathbf{u}_k^T\mathbf{S}_k\mathbf{x}_k + \frac{1}{2}\mathbf{u}_k^T\mathbf{R}_k\mathbf{u}_k
+ * 	+ \mathbf{q}_k^T\mathbf{x}_k + \mathbf{r}_k^T\mathbf{u}_k
+ * 	+ \frac{1}{2}\mathbf{x}_N^T\mathbf{Q}_N\mathbf{x}_N + \mathbf{q}_N^T\mathbf{x}_N
+ * \f]
+ * suject to
+ * \f{eqnarray*}{
+ *	\mathbf{x}_{k+1} = \mathbf{A}_k\mathbf{x}_k + \mathbf{B}_k\mathbf{u}_k + \mathbf{b}_k \\
+ *	\mathbf{lb}_k \leq \mathbf{C}_k\mathbf{x}_k + \mathbf{D}_k\mathbf{u}_k \leq \mathbf{ub}_k \\
+ *	\mathbf{x}_0 = \mathbf{\hat{x}}_0
+ * \f}
+ * The solver is a primal-dual interior point with Mehrotra's predictor-corrector, where the
+ * Newton system is solved with a discrete-time Riccati recursion (in the spirit of HPIPM,
+ * Frison and Diehl, 2020: "HPIPM: a high-performance quadratic programming framework for model
+ * predictive control"). Hence, the cost per iteration is O(N (n^3 + m^3)), i.e. linear in the
+ * horizon instead of cubic as in the condensed QP. Bounds larger than 1e20 are inactive
+ */
+class RiccatiInteriorPoint
+{
+	public:
+		/** @brief Constructor function */
+		RiccatiInteriorPoint();
+
+		/** @brief Destructor function */
+		~RiccatiInteriorPoint();
+
+		/**
+		 * @brief Initializes the dimensions of the problem. All the matrices are set to zero,
+		 * except the weights of the inputs (identity)
+		 * @param unsigned int Number of states
+		 * @param unsigned int Number of inputs
+		 * @param unsigned int Horizon, i.e. number of stages
+		 * @param unsigned int Number of constraints of every stage
+		 * @param unsigned int Number of constraints of the terminal stage
+		 * @return True if was initialized
+		 */
+		bool init(unsigned int num_states,
+				  unsigned int num_inputs,
+				  unsigned int horizon,
+				  unsigned int num_constraints,
+				  unsigned int num_terminal_constraints = 0);
+
+		/**
+		 * @brief Sets the dynamics of a stage, i.e. x_{k+1} = A x_k + B u_k + b
+		 * @param unsigned int Stage index
+		 * @param const Eigen::MatrixXd& State matrix
+		 * @param const Eigen::MatrixXd& Input matrix
+		 * @param const Eigen::VectorXd& Drift vector
+		 */
+		void setDynamics(unsigned int stage,
+						 const Eigen::MatrixXd& A,
+						 const Eigen::MatrixXd& B,
+						 const Eigen::VectorXd& b);
+
+		/**
+		 * @brief Sets the same (time-invariant) dynamics to all the stages
+		 * @param const Eigen::MatrixXd& State matrix
+		 * @param const Eigen::MatrixXd& Input matrix
+		 */
+		void setDynamics(const Eigen::MatrixXd& A,
+						 const Eigen::MatrixXd& B);
+
+		/**
+		 * @brief Sets the cost of a stage. Note that the terminal stage (horizon) only uses the
+		 * state weights
+		 * @param unsigned int Stage index
+		 * @param const Eigen::MatrixXd& State weight matrix
+		 * @param const Eigen::MatrixXd& Input weight matrix
+		 * @param const Eigen::MatrixXd& Cross weight matrix between inputs and states
+		 * @param const Eigen::VectorXd& State gradient
+		 * @param const Eigen::VectorXd& Input gradient
+		 */
+		void setCost(unsigned int stage,
+					 const Eigen::MatrixXd& Q,
+					 const Eigen::MatrixXd& R,
+					 const Eigen::MatrixXd& S,
+					 const Eigen::VectorXd& q,
+					 const Eigen::VectorXd& r);
+
+		/**
+		 * @brief Sets the cost of the terminal stage
+		 * @param const Eigen::MatrixXd& Terminal state weight matrix
+		 * @param const Eigen::VectorXd& Terminal state gradient
+		 */
+		void setTerminalCost(const Eigen::MatrixXd& P,
+							 const Eigen::VectorXd& p);
+
+		/**
+		 * @brief Sets the constraints of a stage, i.e. lb <= C x_k + D u_k <= ub
+		 * @param unsigned int Stage index
+		 * @param const Eigen::MatrixXd& State constraint matrix
+		 * @param const Eigen::MatrixXd& Input constraint matrix
+		 * @param const Eigen::VectorXd& Lower bound
+		 * @param const Eigen::VectorXd& Upper bound
+		 */
+		void setConstraints(unsigned int stage,
+							const Eigen::MatrixXd& C,
+							const Eigen::MatrixXd& D,
+							const Eigen::VectorXd& lower_bound,
+							const Eigen::VectorXd& upper_bound);
+
+		/**
+		 * @brief Sets the constraints of the terminal stage, i.e. lb <= C x_N <= ub
+		 * @param const Eigen::MatrixXd& State constraint matrix
+		 * @param const Eigen::VectorXd& Lower bound
+		 * @param const Eigen::VectorXd& Upper bound
+		 */
+		void setTerminalConstraints(const Eigen::MatrixXd& C,
+									const Eigen::VectorXd& lower_bound,
+									const Eigen::VectorXd& upper_bound);
+
+		/**
+		 * @brief Sets the interior point parameters
+		 * @param unsigned int Maximum number of iterations
+		 * @param double Tolerance of the residuals and the duality gap
+		 */
+		void setParameters(unsigned int max_iterations,
+						   double tolerance);
+
+		/**
+		 * @brief Computes the optimal trajectory from the initial state
+		 * @param const Eigen::VectorXd& Initial state
+		 * @param double CPU-time for computing the optimization (no limit if it's zero)
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool compute(const Eigen::VectorXd& initial_state,
+					 double cputime = 0.);
+
+		/** @brief Gets the optimal state of a stage */
+		const Eigen::VectorXd& getOptimalState(unsigned int stage) const;
+
+		/** @brief Gets the optimal input of a stage */
+		const Eigen::VectorXd& getOptimalInput(unsigned int stage) const;
+
+		/** @brief Gets the optimal inputs of all the stages stacked in a vector */
+		Eigen::VectorXd getOptimalInputs() const;
+
+		/** @brief Gets the horizon, i.e. number of stages, of the problem */
+		unsigned int getHorizon() const;
+
+		/** @brief Gets the number of iterations of the last computation */
+		unsigned int getNumberOfIterations() const;
+
+
+	private:
+		/**
+		 * @brief Factorizes the Riccati recursion of the Newton system with the barrier
+		 * weights of the current iterate, i.e. computes the cost-to-go matrices and the
+		 * feedback gains
+		 * @return bool False if the reduced Hessian of the inputs isn't positive definite
+		 */
+		bool factorize();
+
+		/**
+		 * @brief Solves the Newton system with the current factorization, where the
+		 * complementarity residuals are defined by the barrier parameter and the
+		 * second-order correction (if it's defined)
+		 * @param double Target complementarity, i.e. sigma * mu
+		 * @param bool Label that indicates if the affine step is used as correction
+		 */
+		void solveNewtonStep(double target,
+							 bool correction);
+
+		/** @brief Computes the maximum step length that keeps the slacks and multipliers positive */
+		double computeStepLength() const;
+
+		/** @brief Dimensions of the problem */
+		unsigned int states_;
+		unsigned int inputs_;
+		unsigned int horizon_;
+
+		/** @brief Matrices and vectors of the problem, where the stage horizon is the terminal one */
+		std::vector<Eigen::MatrixXd> A_, B_;
+		std::vector<Eigen::VectorXd> b_;
+		std::vector<Eigen::MatrixXd> Q_, R_, S_;
+		std::vector<Eigen::VectorXd> q_, r_;
+		std::vector<Eigen::MatrixXd> C_, D_;
+		std::vector<Eigen::VectorXd> lb_, ub_;
+
+		/** @brief Masks of active lower and upper bounds */
+		std::vector<Eigen::ArrayXd> lb_mask_, ub_mask_;
+
+		/** @brief Primal-dual iterate */
+		std::vector<Eigen::VectorXd> x_, u_, pi_;
+		std::vector<Eigen::ArrayXd> s_lb_, s_ub_, lam_lb_, lam_ub_;
+
+		/** @brief Newton step */
+		std::vector<Eigen::VectorXd> dx_, du_, pi_new_;
+		std::vector<Eigen::ArrayXd> ds_lb_, ds_ub_, dlam_lb_, dlam_ub_;
+
+		/** @brief Residuals of the slacks and dynamics, and gradients of the Lagrangian without
+		 * the costates */
+		std::vector<Eigen::ArrayXd> res_lb_, res_ub_;
+		std::vector<Eigen::VectorXd> res_dyn_;
+		std::vector<Eigen::VectorXd> grad_x_, grad_u_;
+
+		/** @brief Riccati factorization, i.e. cost-to-go Hessians, gains and Cholesky factors */
+		std::vector<Eigen::MatrixXd> P_, K_;
+		std::vector<Eigen::LLT<Eigen::MatrixXd> > Huu_llt_;
+
+		/** @brief Cost-to-go gradients and feedforward terms of the Newton step */
+		std::vector<Eigen::VectorXd> p_, k_ff_;
+
+		/** @brief Interior point parameters */
+		unsigned int max_iter_;
+		double tolerance_;
+
+		/** @brief Number of active bounds */
+		unsigned int num_bounds_;
+
+		/** @brief Number of iterations of the last computation */
+		unsigned int iterations_;
+};
+
+} //@namespace solver
+} //@namespace dwl
+
+#endif
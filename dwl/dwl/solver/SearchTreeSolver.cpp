@@ -1,4 +1,5 @@
 #include <dwl/solver/SearchTreeSolver.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -7,9 +8,12 @@ namespace dwl
 namespace solver
 {
 
-SearchTreeSolver::SearchTreeSolver() : adjacency_(NULL),
-		total_cost_(std::numeric_limits<double>::max()), time_started_(clock()),
-		is_set_model_(false), is_set_adjacency_model_(false)
+SearchTreeSolver::SearchTreeSolver() : adjacency_(NULL), terrain_(NULL), indexed_heap_(false),
+		g_cost_table_(std::numeric_limits<Weight>::max()),
+		backward_g_cost_table_(std::numeric_limits<Weight>::max()), reached_target_(0),
+		informed_search_(true), total_cost_(std::numeric_limits<double>::max()),
+		time_started_(clock()), is_set_model_(false), is_set_adjacency_model_(false),
+		edge_allocator_(&search_pool_)
 {
 
 }
@@ -33,6 +37,7 @@ void SearchTreeSolver::reset(robot::Robot* robot,
 		return;
 	}
 
+	terrain_ = environment;
 	adjacency_->reset(robot, environment);
 }
 
@@ -46,21 +51,280 @@ void SearchTreeSolver::setAdjacencyModel(model::AdjacencyModel* adjacency_model)
 }
 
 
+model::AdjacencyModel* SearchTreeSolver::getAdjacencyModel() const
+{
+	return adjacency_;
+}
+
+
+void SearchTreeSolver::setIndexedHeap(bool enable, Vertex num_dense_vertices)
+{
+	indexed_heap_ = enable;
+
+	// Allocating the dense part of the vertex tables
+	openset_heap_.reset(num_dense_vertices);
+	g_cost_table_.reset(std::numeric_limits<Weight>::max(), num_dense_vertices);
+	closedset_table_.reset(0, num_dense_vertices);
+	policy_table_.reset(0, num_dense_vertices);
+	backward_heap_.reset(num_dense_vertices);
+	backward_g_cost_table_.reset(std::numeric_limits<Weight>::max(), num_dense_vertices);
+	backward_closedset_table_.reset(0, num_dense_vertices);
+	successor_table_.reset(0, num_dense_vertices);
+}
+
+
+void SearchTreeSolver::setSolutionCallback(const SolutionCallback& callback)
+{
+	solution_callback_ = callback;
+}
+
+
+bool SearchTreeSolver::computeMultiGoal(Vertex source,
+										const std::vector<Vertex>& targets,
+										double computation_time)
+{
+	total_cost_ = std::numeric_limits<double>::max();
+	if (!is_set_adjacency_model_) {
+		printf(RED "Could not computed the shortest path because "
+				"it is required to defined an adjacency model\n" COLOR_RESET);
+		return false;
+	}
+	if (targets.empty())
+		return false;
+	if (!indexed_heap_)
+		setIndexedHeap(true);
+
+	// Setting the initial time
+	time_started_ = clock();
+	double allocated_time = computation_time * (double) CLOCKS_PER_SEC;
+
+	// Clearing the previous search, note that only the touched vertices are reset
+	openset_heap_.clear();
+	g_cost_table_.clear();
+	closedset_table_.clear();
+	policy_table_.clear();
+	search_pool_.reset();
+
+	// Estimating the cost to the closest target
+	unsigned int num_targets = targets.size();
+	std::function<double(Vertex)> estimateTargetCost = [&](Vertex vertex) {
+		double min_cost = std::numeric_limits<double>::max();
+		for (unsigned int i = 0; i < num_targets; i++)
+			min_cost = std::min(min_cost, estimateCost(vertex, targets[i]));
+		return min_cost;
+	};
+
+	g_cost_table_[source] = 0;
+	openset_heap_.push(source, estimateTargetCost(source));
+	while (!openset_heap_.empty()) {
+		if ((clock() - time_started_) > allocated_time)
+			return false;
+
+		// Checking if it is getted any target
+		Vertex current = openset_heap_.top();
+		for (unsigned int i = 0; i < num_targets; i++) {
+			if (adjacency_->isReachedGoal(targets[i], current)) {
+				reached_target_ = targets[i];
+				if (current != reached_target_) {
+					policy_table_[reached_target_] = current;
+					g_cost_table_[reached_target_] = g_cost_table_.get(current);
+				}
+				total_cost_ = g_cost_table_.get(reached_target_);
+				return true;
+			}
+		}
+
+		// Moving the current vertex from the openset to the closedset
+		openset_heap_.pop();
+		closedset_table_[current] = 1;
+
+		// Visit each edge exiting in the current vertex
+		EdgeList successors(edge_allocator_);
+		adjacency_->getSuccessors(successors, current);
+		Weight current_g_cost = g_cost_table_.get(current);
+		for (EdgeList::iterator edge_iter = successors.begin();
+				edge_iter != successors.end();
+				edge_iter++)
+		{
+			Vertex neighbor = edge_iter->target;
+			if (closedset_table_.count(neighbor) > 0)
+				continue;
+
+			Weight tentative_g_cost = current_g_cost + edge_iter->weight;
+			Weight& neighbor_g_cost = g_cost_table_[neighbor];
+			if (tentative_g_cost < neighbor_g_cost) {
+				neighbor_g_cost = tentative_g_cost;
+				policy_table_[neighbor] = current;
+				openset_heap_.push(neighbor, tentative_g_cost + estimateTargetCost(neighbor));
+			}
+		}
+	}
+
+	return false;
+}
+
+
+bool SearchTreeSolver::computeBidirectional(Vertex source,
+											Vertex target,
+											double computation_time)
+{
+	total_cost_ = std::numeric_limits<double>::max();
+	if (!is_set_adjacency_model_) {
+		printf(RED "Could not computed the shortest path because "
+				"it is required to defined an adjacency model\n" COLOR_RESET);
+		return false;
+	}
+	if (!indexed_heap_)
+		setIndexedHeap(true);
+
+	reached_target_ = target;
+	if (source == target) {
+		total_cost_ = 0.;
+		return true;
+	}
+
+	// Setting the initial time
+	time_started_ = clock();
+	double allocated_time = computation_time * (double) CLOCKS_PER_SEC;
+
+	// Clearing the previous searches, note that only the touched vertices are reset
+	openset_heap_.clear();
+	g_cost_table_.clear();
+	closedset_table_.clear();
+	policy_table_.clear();
+	backward_heap_.clear();
+	backward_g_cost_table_.clear();
+	backward_closedset_table_.clear();
+	successor_table_.clear();
+	search_pool_.reset();
+
+	// Defining the potential of the forward search, i.e. the average of the forward and
+	// backward heuristics, where the potential of the backward search is the opposite one.
+	// So both searches have the same reduced costs, and they stop when the sum of their keys
+	// is bigger than the best connection
+	std::function<double(Vertex)> potential = [&](Vertex vertex) {
+		return 0.5 * (estimateCost(vertex, target) - estimateCost(source, vertex));
+	};
+
+	g_cost_table_[source] = 0;
+	backward_g_cost_table_[target] = 0;
+	openset_heap_.push(source, potential(source));
+	backward_heap_.push(target, -potential(target));
+	Weight best_cost = std::numeric_limits<Weight>::max();
+	Vertex connection = source;
+	bool connected = false;
+	while (!openset_heap_.empty() && !backward_heap_.empty()) {
+		if (openset_heap_.topPriority() + backward_heap_.topPriority() >= best_cost)
+			break;
+		if ((clock() - time_started_) > allocated_time)
+			return false;
+
+		// Expanding the search with the smaller openset
+		bool forward = openset_heap_.size() <= backward_heap_.size();
+		IndexedHeap<>& openset = forward ? openset_heap_ : backward_heap_;
+		VertexTable<Weight>& g_cost = forward ? g_cost_table_ : backward_g_cost_table_;
+		VertexTable<unsigned char>& closedset = forward ? closedset_table_ : backward_closedset_table_;
+		VertexTable<Vertex>& previous = forward ? policy_table_ : successor_table_;
+		const VertexTable<Weight>& opposite_g_cost = forward ? backward_g_cost_table_ : g_cost_table_;
+		double sign = forward ? 1. : -1.;
+
+		Vertex current = openset.top();
+		openset.pop();
+		closedset[current] = 1;
+
+		// Visit each edge exiting in (or entering to) the current vertex, where the edges of the
+		// backward search are rooted in the predecessor
+		EdgeList edges(edge_allocator_);
+		if (forward)
+			adjacency_->getSuccessors(edges, current);
+		else
+			adjacency_->getPredecessors(edges, current);
+		Weight current_g_cost = g_cost.get(current);
+		for (EdgeList::iterator edge_iter = edges.begin();
+				edge_iter != edges.end();
+				edge_iter++)
+		{
+			Vertex neighbor = edge_iter->target;
+			if (closedset.count(neighbor) > 0)
+				continue;
+
+			Weight tentative_g_cost = current_g_cost + edge_iter->weight;
+			Weight& neighbor_g_cost = g_cost[neighbor];
+			if (tentative_g_cost < neighbor_g_cost) {
+				neighbor_g_cost = tentative_g_cost;
+				previous[neighbor] = current;
+				openset.push(neighbor, tentative_g_cost + sign * potential(neighbor));
+			}
+
+			// Updating the best connection of the searches
+			const Weight* opposite_cost = opposite_g_cost.find(neighbor);
+			if (opposite_cost != NULL && neighbor_g_cost + *opposite_cost < best_cost) {
+				best_cost = neighbor_g_cost + *opposite_cost;
+				connection = neighbor;
+				connected = true;
+			}
+		}
+	}
+
+	if (!connected)
+		return false;
+
+	// Recording the backward part of the path in the previous vertices
+	Vertex vertex = connection;
+	const Vertex* next;
+	while (vertex != target && (next = successor_table_.find(vertex)) != NULL) {
+		policy_table_[*next] = vertex;
+		vertex = *next;
+	}
+	total_cost_ = best_cost;
+
+	return true;
+}
+
+
 std::list<Vertex> SearchTreeSolver::getShortestPath(Vertex source,
 													Vertex target)
 {
-	std::list<Vertex> path;
-	PreviousVertex::iterator prev;
+	std::vector<Vertex> path;
+	getShortestPath(path, source, target);
+
+	return std::list<Vertex>(path.begin(), path.end());
+}
+
+
+void SearchTreeSolver::getShortestPath(std::vector<Vertex>& path,
+									   Vertex source,
+									   Vertex target)
+{
+	// Walking the previous vertices from the target, and reversing the path
+	path.clear();
 	Vertex vertex = target;
-	path.push_front(vertex);
-	while ((prev = policy_.find(vertex)) != policy_.end()) {
-		vertex = prev->second;
-		path.push_front(vertex);
-		if (vertex == source)
-			break;
+	path.push_back(vertex);
+	if (indexed_heap_) {
+		const Vertex* prev;
+		while ((prev = policy_table_.find(vertex)) != NULL) {
+			vertex = *prev;
+			path.push_back(vertex);
+			if (vertex == source)
+				break;
+		}
+	} else {
+		PreviousVertex::iterator prev;
+		while ((prev = policy_.find(vertex)) != policy_.end()) {
+			vertex = prev->second;
+			path.push_back(vertex);
+			if (vertex == source)
+				break;
+		}
 	}
 
-	return path;
+	std::reverse(path.begin(), path.end());
+}
+
+
+Vertex SearchTreeSolver::getReachedTarget() const
+{
+	return reached_target_;
 }
 
 
@@ -70,6 +334,41 @@ double SearchTreeSolver::getMinimumCost()
 }
 
 
+double SearchTreeSolver::estimateCost(Vertex source,
+									  Vertex target)
+{
+	if (!informed_search_)
+		return 0.;
+
+	return adjacency_->heuristicCost(source, target);
+}
+
+
+void SearchTreeSolver::publishSolution(Vertex source,
+									   Vertex target)
+{
+	// Note that there isn't a solution until the target is reached
+	if (solution_callback_ && total_cost_ < std::numeric_limits<double>::max())
+		solution_callback_(getShortestPath(source, target), total_cost_);
+}
+
+
+utils::MemoryUsage SearchTreeSolver::getMemoryUsage() const
+{
+	utils::MemoryUsage usage("search");
+	usage.add("policy", utils::getHeapBytes(policy_));
+	usage.add("openset", openset_heap_.getHeapBytes());
+	usage.add("vertex_tables", g_cost_table_.getHeapBytes() +
+			closedset_table_.getHeapBytes() + policy_table_.getHeapBytes());
+	usage.add("backward_search", backward_heap_.getHeapBytes() +
+			backward_g_cost_table_.getHeapBytes() +
+			backward_closedset_table_.getHeapBytes() + successor_table_.getHeapBytes());
+	usage.add("search_pool", search_pool_.getHeapBytes());
+
+	return usage;
+}
+
+
 std::string SearchTreeSolver::getName()
 {
 	return name_;
@@ -4,6 +4,8 @@
 #include <dwl/robot/Robot.h>
 #include <dwl/model/AdjacencyModel.h>
 #include <dwl/utils/utils.h>
+#include <dwl/utils/IndexedHeap.h>
+#include <functional>
 
 
 namespace dwl
@@ -20,6 +22,12 @@ namespace solver
 class SearchTreeSolver
 {
 	public:
+		/**
+		 * @brief Function that receives the improved solutions, i.e. the shortest path and its
+		 * total cost
+		 */
+		typedef std::function<void(const std::list<Vertex>&, double)> SolutionCallback;
+
 		/** @brief Constructor function */
 		SearchTreeSolver();
 
@@ -46,6 +54,27 @@ class SearchTreeSolver
 		 */
 		void setAdjacencyModel(model::AdjacencyModel* adjacency_model);
 
+		/** @brief Gets the adjacency model of the solver (NULL if it isn't set) */
+		model::AdjacencyModel* getAdjacencyModel() const;
+
+		/**
+		 * @brief Enables/disables the indexed d-ary heap (with decrease-key) and the vertex tables
+		 * instead of the node-based containers (std::set and std::map). The vertex ids below the
+		 * number of dense vertices are stored in arrays, and the rest in hash tables
+		 * @param bool True for using the indexed heap and vertex tables
+		 * @param Vertex Number of dense vertices (e.g. the number of cells of a bounded grid, or
+		 * the number of states of a state window, see SpaceDiscretization::setStateWindow)
+		 */
+		void setIndexedHeap(bool enable, Vertex num_dense_vertices = 0);
+
+		/**
+		 * @brief Sets the function that receives every improved solution as soon as it's found
+		 * by an anytime solver (e.g. ARA*), i.e. before the compute method returns. Note that
+		 * it's called from the thread that computes the solution
+		 * @param const SolutionCallback& Solution callback (an empty function disables it)
+		 */
+		void setSolutionCallback(const SolutionCallback& callback);
+
 		/**
 		 * @brief Abstract method for computing a shortest-path using graph search algorithms
 		 * such as A*
@@ -57,6 +86,38 @@ class SearchTreeSolver
 		virtual bool compute(Vertex source, Vertex target,
 							 double computation_time = std::numeric_limits<double>::max()) = 0;
 
+		/**
+		 * @brief Computes the shortest path to the best of several targets in one search (e.g.
+		 * alternative docking or stair-entry poses), i.e. the first reached target of an A*
+		 * search whose heuristic is the minimum one of the targets (or a Dijkstra search, see
+		 * informed_search_). Note that it uses the indexed heap and vertex tables, which are
+		 * enabled if they weren't
+		 * @param Vertex Source vertex
+		 * @param const std::vector<Vertex>& Target vertices
+		 * @param double Allowed time for computing a solution (in seconds)
+		 * @return True if it was reached a target (see getReachedTarget)
+		 */
+		bool computeMultiGoal(Vertex source,
+							  const std::vector<Vertex>& targets,
+							  double computation_time = std::numeric_limits<double>::max());
+
+		/**
+		 * @brief Computes the shortest path with a bidirectional search, i.e. a forward search
+		 * from the source and a backward search from the target (see
+		 * AdjacencyModel::getPredecessors) that expand the smaller openset until their sum of
+		 * keys can't improve the best connection. The searches are guided by the average of the
+		 * forward and backward heuristics (or not, see informed_search_), and the backward part
+		 * of the path is recorded in the previous vertices. Note that it uses the indexed heap
+		 * and vertex tables, which are enabled if they weren't
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 * @param double Allowed time for computing a solution (in seconds)
+		 * @return True if the searches were connected
+		 */
+		bool computeBidirectional(Vertex source,
+								  Vertex target,
+								  double computation_time = std::numeric_limits<double>::max());
+
 		/**
 		 * @brief Gets the shortest-path only for graph searching algorithms
 		 * @param Vertex target Target vertex
@@ -64,6 +125,24 @@ class SearchTreeSolver
 		 */
 		std::list<Vertex> getShortestPath(Vertex source, Vertex target);
 
+		/**
+		 * @brief Gets the shortest-path as a contiguous sequence of vertices, from the source to
+		 * the target. The path vector keeps its capacity between calls, so it doesn't allocate
+		 * memory when it's reused
+		 * @param std::vector<Vertex>& Shortest path
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 */
+		void getShortestPath(std::vector<Vertex>& path,
+							 Vertex source,
+							 Vertex target);
+
+		/**
+		 * @brief Gets the target reached by the last multi-goal or bidirectional search, which
+		 * is the target of its shortest path
+		 */
+		Vertex getReachedTarget() const;
+
 		/**
 		 * @brief Gets the minimum cost (total cost) for the computed solution
 		 * @return The total cost of the planned path
@@ -76,20 +155,77 @@ class SearchTreeSolver
 		 */
 		std::string getName();
 
+		/**
+		 * @brief Gets the memory report of the search state, i.e. the policy, the open and
+		 * closed sets of the forward and backward searches, and the memory pool of the query
+		 * @return The memory report
+		 */
+		virtual utils::MemoryUsage getMemoryUsage() const;
+
 
 	protected:
+		/**
+		 * @brief Publishes the current solution to the solution callback if it's defined
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 */
+		void publishSolution(Vertex source,
+							 Vertex target);
+
 		/** @brief Name of the solver */
 		std::string name_;
 
 		/** @brief Adjacency model of the tree */
 		model::AdjacencyModel* adjacency_;
 
+		/** @brief Terrain information of the search, e.g. for tracking its changes */
+		environment::TerrainMap* terrain_;
+
 		/** @brief Shortest previous vertex */
 		PreviousVertex policy_;
 
+		/** @brief Label that indicates if it's used the indexed heap and vertex tables */
+		bool indexed_heap_;
+
+		/** @brief Openset queue, g cost, closedset and policy of the indexed heap search */
+		IndexedHeap<> openset_heap_;
+		VertexTable<Weight> g_cost_table_;
+		VertexTable<unsigned char> closedset_table_;
+		VertexTable<Vertex> policy_table_;
+
+		/**
+		 * @brief Estimates the cost between two vertices in the multi-goal and bidirectional
+		 * searches, i.e. the heuristic cost of the adjacency model if it's an informed search
+		 * @param Vertex Source vertex
+		 * @param Vertex Target vertex
+		 */
+		double estimateCost(Vertex source,
+							Vertex target);
+
+		/**
+		 * @brief Openset queue, g cost and closedset of the backward search of the bidirectional
+		 * search, and the next vertex of the path
+		 */
+		IndexedHeap<> backward_heap_;
+		VertexTable<Weight> backward_g_cost_table_;
+		VertexTable<unsigned char> backward_closedset_table_;
+		VertexTable<Vertex> successor_table_;
+
+		/** @brief Target reached by the last multi-goal or bidirectional search */
+		Vertex reached_target_;
+
+		/**
+		 * @brief Label that indicates if the multi-goal and bidirectional searches use the
+		 * heuristic of the adjacency model (A*), or not (Dijkstra)
+		 */
+		bool informed_search_;
+
 		/** @brief Total cost of the path */
 		double total_cost_;
 
+		/** @brief Function that receives the improved solutions */
+		SolutionCallback solution_callback_;
+
 		/** @brief Initial time of computation */
 		clock_t time_started_;
 
@@ -98,6 +234,16 @@ class SearchTreeSolver
 
 		/** @brief Indicates if it was set an adjacency model */
 		bool is_set_adjacency_model_;
+
+		/**
+		 * @brief Memory pool of the search structures of a query (e.g. the successors lists
+		 * and the node-based containers), which is reset at the beginning of every query. So
+		 * the pooled containers can't outlive a query, i.e. the policy isn't pooled
+		 */
+		utils::MemoryPool search_pool_;
+
+		/** @brief Allocator of the successors lists from the search pool */
+		utils::PoolAllocator<Edge> edge_allocator_;
 };
 
 } //@namespace solver
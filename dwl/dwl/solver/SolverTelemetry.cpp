@@ -0,0 +1,150 @@
+#include <dwl/solver/SolverTelemetry.h>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/** @brief Names of the evaluation callbacks in the channels */
+static const char* EvaluationNames[NumTelemetryEvaluations] =
+		{"cost", "gradient", "constraint", "jacobian", "hessian"};
+
+/** @brief Number of channels of the iteration values (solve, time and TelemetryIteration) */
+static const unsigned int NumIterationChannels = 10;
+
+
+SolverTelemetry::SolverTelemetry() : num_solves_(0), open_(false)
+{
+	for (unsigned int i = 0; i < NumTelemetryEvaluations; i++) {
+		evaluation_time_[i] = 0;
+		evaluation_count_[i] = 0;
+	}
+}
+
+
+SolverTelemetry::~SolverTelemetry()
+{
+	close();
+}
+
+
+bool SolverTelemetry::open(const std::string& filename)
+{
+	// The channels are registered once, since the logger keeps them between files
+	if (logger_.getChannels().empty()) {
+		logger_.addChannel("solve");
+		logger_.addChannel("time");
+		logger_.addChannel("iteration");
+		logger_.addChannel("objective");
+		logger_.addChannel("constraint_violation");
+		logger_.addChannel("dual_infeasibility");
+		logger_.addChannel("barrier_parameter");
+		logger_.addChannel("step_size");
+		logger_.addChannel("step_norm");
+		logger_.addChannel("line_search_trials");
+		for (unsigned int i = 0; i < NumTelemetryEvaluations; i++) {
+			logger_.addChannel(std::string(EvaluationNames[i]) + "_time");
+			logger_.addChannel(std::string(EvaluationNames[i]) + "_count");
+		}
+	}
+	row_.resize(logger_.getChannels().size());
+
+	close();
+	if (!logger_.open(filename))
+		return false;
+
+	started_time_ = std::chrono::steady_clock::now();
+	open_ = true;
+	return true;
+}
+
+
+void SolverTelemetry::close()
+{
+	open_ = false;
+	if (logger_.isOpen())
+		logger_.close();
+}
+
+
+bool SolverTelemetry::isOpen() const
+{
+	return open_.load(std::memory_order_relaxed);
+}
+
+
+void SolverTelemetry::startSolve()
+{
+	num_solves_++;
+	started_time_ = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < NumTelemetryEvaluations; i++) {
+		evaluation_time_[i].store(0, std::memory_order_relaxed);
+		evaluation_count_[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+void SolverTelemetry::recordEvaluation(TelemetryEvaluation type,
+									   double elapsed_time)
+{
+	evaluation_time_[type].fetch_add((unsigned long) (elapsed_time * 1e9),
+									 std::memory_order_relaxed);
+	evaluation_count_[type].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+bool SolverTelemetry::recordIteration(const TelemetryIteration& iteration)
+{
+	if (!isOpen())
+		return false;
+
+	row_[0] = num_solves_;
+	row_[1] = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - started_time_).count();
+	row_[2] = iteration.iteration;
+	row_[3] = iteration.objective;
+	row_[4] = iteration.violation;
+	row_[5] = iteration.dual_infeasibility;
+	row_[6] = iteration.barrier;
+	row_[7] = iteration.step_size;
+	row_[8] = iteration.step_norm;
+	row_[9] = iteration.line_search_trials;
+
+	// Taking the evaluations since the previous iteration
+	for (unsigned int i = 0; i < NumTelemetryEvaluations; i++) {
+		row_[NumIterationChannels + 2 * i] =
+				evaluation_time_[i].exchange(0, std::memory_order_relaxed) * 1e-9;
+		row_[NumIterationChannels + 2 * i + 1] =
+				evaluation_count_[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	return logger_.append(row_.data());
+}
+
+
+unsigned long SolverTelemetry::getNumberOfDroppedRows() const
+{
+	return logger_.getNumberOfDroppedRows();
+}
+
+
+SolverTelemetry::ScopedEvaluation::ScopedEvaluation(SolverTelemetry* telemetry,
+												   TelemetryEvaluation type) :
+		telemetry_((telemetry != NULL && telemetry->isOpen()) ? telemetry : NULL), type_(type)
+{
+	if (telemetry_ != NULL)
+		start_ = std::chrono::steady_clock::now();
+}
+
+
+SolverTelemetry::ScopedEvaluation::~ScopedEvaluation()
+{
+	if (telemetry_ != NULL)
+		telemetry_->recordEvaluation(type_, std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start_).count());
+}
+
+} //@namespace solver
+} //@namespace dwl
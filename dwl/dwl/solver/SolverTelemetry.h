@@ -0,0 +1,137 @@
+#ifndef DWL__SOLVER__SOLVER_TELEMETRY__H
+#define DWL__SOLVER__SOLVER_TELEMETRY__H
+
+#include <dwl/utils/BinaryLogger.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+
+namespace dwl
+{
+
+namespace solver
+{
+
+/** @brief Evaluation callbacks of the solvers that are timed by the telemetry */
+enum TelemetryEvaluation {CostEvaluation, GradientEvaluation, ConstraintEvaluation,
+	JacobianEvaluation, HessianEvaluation, NumTelemetryEvaluations};
+
+
+/**
+ * @struct TelemetryIteration
+ * @brief Values of an iteration of a solver, where the values that don't apply to a solver
+ * are zero (e.g. the barrier parameter of CMA-ES)
+ */
+struct TelemetryIteration
+{
+	TelemetryIteration() : iteration(0), objective(0.), violation(0.),
+			dual_infeasibility(0.), barrier(0.), step_size(0.), step_norm(0.),
+			line_search_trials(0) {}
+
+	unsigned int iteration;
+	double objective;
+	double violation;
+	double dual_infeasibility;
+	double barrier;
+	double step_size;
+	double step_norm;
+	unsigned int line_search_trials;
+};
+
+
+/**
+ * @class SolverTelemetry
+ * @brief Structured telemetry of the solvers, i.e. a row per iteration with its objective,
+ * constraint violation, step size, and the time and number of the evaluation callbacks since
+ * the previous iteration. The rows are appended to a BinaryLogger, so recording an iteration
+ * doesn't lock, allocate or write in the solve thread, and its compressed blocks are written
+ * by the writer thread of the logger. The evaluations are accumulated with relaxed atomics,
+ * so they can be recorded from the threads that evaluate the model concurrently
+ */
+class SolverTelemetry
+{
+	public:
+		/** @brief Constructor function */
+		SolverTelemetry();
+
+		/** @brief Destructor function, which closes the stream */
+		~SolverTelemetry();
+
+		/**
+		 * @brief Opens the stream, i.e. a binary log file (see BinaryLogReader)
+		 * @param const std::string& File name
+		 * @return True if the file was opened
+		 */
+		bool open(const std::string& filename);
+
+		/** @brief Writes the remaining rows and closes the stream */
+		void close();
+
+		/** @brief Indicates if the stream is opened */
+		bool isOpen() const;
+
+		/** @brief Starts a solve, i.e. the solve counter and the time of its rows */
+		void startSolve();
+
+		/**
+		 * @brief Records an evaluation callback
+		 * @param TelemetryEvaluation Type of evaluation
+		 * @param double Elapsed time in seconds
+		 */
+		void recordEvaluation(TelemetryEvaluation type,
+							  double elapsed_time);
+
+		/**
+		 * @brief Records an iteration, i.e. appends its row together with the evaluations
+		 * since the previous one
+		 * @param const TelemetryIteration& Values of the iteration
+		 * @return False if the stream isn't opened or the row was dropped
+		 */
+		bool recordIteration(const TelemetryIteration& iteration);
+
+		/** @brief Gets the number of rows that were dropped because the stream was full */
+		unsigned long getNumberOfDroppedRows() const;
+
+		/**
+		 * @class ScopedEvaluation
+		 * @brief Times an evaluation callback during its scope, which doesn't read the clock
+		 * if the stream isn't opened
+		 */
+		class ScopedEvaluation
+		{
+			public:
+				ScopedEvaluation(SolverTelemetry* telemetry,
+								 TelemetryEvaluation type);
+				~ScopedEvaluation();
+
+			private:
+				SolverTelemetry* telemetry_;
+				TelemetryEvaluation type_;
+				std::chrono::steady_clock::time_point start_;
+		};
+
+
+	private:
+		/** @brief Logger of the rows */
+		utils::BinaryLogger logger_;
+
+		/** @brief Row of the last iteration, which is reused */
+		std::vector<double> row_;
+
+		/** @brief Time (in nanoseconds) and number of the evaluations since the last iteration */
+		std::atomic<unsigned long> evaluation_time_[NumTelemetryEvaluations];
+		std::atomic<unsigned long> evaluation_count_[NumTelemetryEvaluations];
+
+		/** @brief Number of solves and starting time of the current one */
+		unsigned int num_solves_;
+		std::chrono::steady_clock::time_point started_time_;
+
+		/** @brief Indicates if the stream is opened */
+		std::atomic<bool> open_;
+};
+
+} //@namespace solver
+} //@namespace dwl
+
+#endif
@@ -2,6 +2,7 @@
 #define DWL__SOLVER__CMAESSOFAMILY__H
 
 #include <dwl/solver/OptimizationSolver.h>
+#include <mutex>
 #pragma GCC system_header // This pragma turns off the warning messages in this file
 #pragma message "Turning off the warning messages of libcmaes"
 #include_next <cmaes.h>
@@ -66,7 +67,9 @@ class cmaesSOFamily : public OptimizationSolver
 		void setNumberOfRestarts(int max_restarts);
 
 		/**
-		 * @brief Sets the multi-threading option
+		 * @brief Sets the multi-threading option. The offsprings are evaluated concurrently
+		 * with per-thread clones of the optimization model (see OptimizationModel::clone()).
+		 * If the model cannot be cloned, the evaluations are serialized with a lock
 		 * @param bool True for enabling the multi-threading optimization
 		 */
 		void setMultithreading(bool multithreading);
@@ -80,6 +83,58 @@ class cmaesSOFamily : public OptimizationSolver
 		/** @brief Sets if we desire to inject the gradient information */
 		void setGradientInjection(bool with_gradient);
 
+		/**
+		 * @brief Sets the warm-start of receding-horizon computations. The distribution of a
+		 * computation is centered in the starting point of the model (i.e. the previous
+		 * solution shifted by the model), and its step-size is the final one of the previous
+		 * computation, so a replan needs fewer generations
+		 * @param bool True for enabling the warm-start
+		 * @param double Minimum step-size of the warm-start
+		 */
+		void setWarmStart(bool warm_start,
+						  double min_sigma = 0.);
+
+		/**
+		 * @brief Sets the island model, i.e. independent CMA-ES runs (islands) that are computed
+		 * concurrently within the same wall-clock budget. After every migration interval, the
+		 * islands continue from the best candidate of all of them with their own step-size.
+		 * The computation returns the best candidate of all the islands
+		 * @param unsigned int Number of islands (1 for a single run)
+		 * @param int Number of generations between migrations (-1 for independent runs)
+		 */
+		void setIslands(unsigned int num_islands,
+						int migration_interval = -1);
+
+		/**
+		 * @brief Sets the surrogate-assisted mode for expensive objectives (a simplified
+		 * lq-CMA-ES, Hansen 2019). A linear or diagonal-quadratic model of the fitness is fitted
+		 * to the recent true evaluations, and it ranks the offsprings of every generation. Only
+		 * the most promising offsprings are truly evaluated (in batches) until the rank
+		 * correlation between the model and the true fitness is good enough. Note that it uses
+		 * the CMA-ES update (no restarts) without gradient injection and islands
+		 * @param bool True for enabling the surrogate-assisted mode
+		 * @param double Kendall rank correlation that stops the true evaluations
+		 */
+		void setSurrogateAssistance(bool surrogate,
+									double rank_correlation = 0.85);
+
+		/**
+		 * @brief Sets the early abort of the fitness evaluations. The non-active families rank
+		 * the offsprings by their fitness and only the mu = lambda/2 best ones update the
+		 * distribution, so an offspring whose cost reaches the mu-th best cost evaluated in its
+		 * generation cannot change the update. This cost is passed as the cost cutoff of the
+		 * model (see OptimizationModel::setCostCutoff), which can stop its evaluation once a
+		 * partial sum of non-negative cost terms reaches it. Note that it isn't used by the
+		 * active families (negative weights of the worst offsprings), the restarts (the first
+		 * generation of a restart has a different lambda), the islands and the
+		 * surrogate-assisted mode
+		 * @param bool True for enabling the early abort
+		 */
+		void setEarlyAbort(bool early_abort);
+
+		/** @brief Gets the number of true fitness evaluations of the last computation */
+		unsigned int getNumberOfTrueEvaluations() const;
+
 		/**
 		 * @brief Initialization of the NLP solver using Ipopt
 		 * @return True if was initialized
@@ -95,6 +150,59 @@ class cmaesSOFamily : public OptimizationSolver
 
 
 	private:
+		typedef libcmaes::GenoPheno<libcmaes::pwqBoundStrategy,TScaling> GenoPheno;
+		typedef libcmaes::CMAParameters<GenoPheno> Parameters;
+		typedef libcmaes::ProgressFunc<Parameters,libcmaes::CMASolutions> ProgressFunc;
+
+		/**
+		 * @brief Runs a CMA-ES optimization, with or without gradient injection
+		 * @param libcmaes::CMASolutions& Solutions of the optimization
+		 * @param Parameters& CMA-ES parameters
+		 * @param ProgressFunc& Progress function, which stops the optimization if it returns
+		 * a nonzero value
+		 */
+		void optimize(libcmaes::CMASolutions& solutions,
+					  Parameters& params,
+					  ProgressFunc& progress);
+
+		/**
+		 * @brief Computes the islands concurrently, where the migration happens between epochs
+		 * @param double Allocated computation time in seconds
+		 * @return True if it was computed a solution
+		 */
+		bool computeIslands(double allocated_time_secs);
+
+		/**
+		 * @brief Computes a solution with the surrogate-assisted mode
+		 * @param double Allocated computation time in seconds
+		 * @return True if it was computed a solution
+		 */
+		bool computeWithSurrogate(double allocated_time_secs);
+
+		/**
+		 * @brief Fits the surrogate model to the archive of true evaluations. The model is
+		 * diagonal-quadratic if the archive has twice its number of coefficients, and linear
+		 * otherwise
+		 * @return True if there are enough samples for fitting the model
+		 */
+		bool fitSurrogate();
+
+		/**
+		 * @brief Evaluates the surrogate model
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Decision variables (phenotype)
+		 * @return double Surrogate fitness
+		 */
+		double evaluateSurrogate(const Eigen::Ref<const Eigen::VectorXd>& x);
+
+		/**
+		 * @brief Computes the Kendall rank correlation of two sets of values
+		 * @param const std::vector<double>& First values
+		 * @param const std::vector<double>& Second values
+		 * @return double Rank correlation in [-1, 1]
+		 */
+		double computeRankCorrelation(const std::vector<double>& first,
+									  const std::vector<double>& second);
+
 		/**
 		 * @brief Wraps the fitness (objective) function
 		 * @param const double* State array
@@ -103,6 +211,21 @@ class cmaesSOFamily : public OptimizationSolver
 		double fitnessFunction(const double* x,
 							   const int& n);
 
+		/**
+		 * @brief Resets the elite costs of a generation
+		 * @param unsigned int Number of elite offsprings, i.e. mu (zero for no cutoff)
+		 */
+		void resetEliteCosts(unsigned int num_elites);
+
+		/** @brief Gets the cost cutoff of the generation, i.e. its mu-th best cost so far */
+		double getEliteCutoff();
+
+		/**
+		 * @brief Records an offspring cost in the elite costs of the generation
+		 * @param double Fitness value of the offspring
+		 */
+		void recordEliteCost(double cost);
+
 		/**
 		 * @brief Wraps the gradient of the fitness function
 		 * @param const double* State array
@@ -111,6 +234,22 @@ class cmaesSOFamily : public OptimizationSolver
 		dVec gradientFitnessFunction(const double *x,
 									 const int& n);
 
+		/**
+		 * @brief Acquires a model clone that isn't used by other thread, where a new clone is
+		 * created if all of them are in use
+		 * @return model::OptimizationModel* Model clone, or NULL if the model cannot be cloned
+		 */
+		model::OptimizationModel* acquireModelClone();
+
+		/**
+		 * @brief Releases a model clone, so other thread can use it
+		 * @param model::OptimizationModel* Model clone
+		 */
+		void releaseModelClone(model::OptimizationModel* model);
+
+		/** @brief Deletes the model clones, e.g. when the model changes between computations */
+		void deleteModelClones();
+
 		/** @brief Fitness function wrapper */
 		libcmaes::FitFunc fitness_;
 
@@ -161,6 +300,48 @@ class cmaesSOFamily : public OptimizationSolver
 		 */
 		bool multithreading_;
 
+		/** @brief Clones of the optimization model and the ones that aren't in use */
+		std::vector<model::OptimizationModel*> model_clones_;
+		std::vector<model::OptimizationModel*> free_model_clones_;
+
+		/** @brief Indicates if the optimization model can be cloned */
+		bool cloneable_model_;
+
+		/** @brief Protects the model clones */
+		std::mutex clones_mutex_;
+
+		/** @brief Warm-start options and the final step-size of the last computation */
+		bool warm_start_;
+		double min_sigma_;
+		double last_sigma_;
+
+		/** @brief Number of islands and generations between migrations */
+		unsigned int num_islands_;
+		int migration_interval_;
+
+		/** @brief Surrogate-assisted mode and its rank correlation */
+		bool surrogate_;
+		double rank_correlation_;
+
+		/** @brief Archive of true evaluations of the surrogate model */
+		std::vector<Eigen::VectorXd> surrogate_points_;
+		std::vector<double> surrogate_values_;
+
+		/** @brief Coefficients, center and scale of the surrogate model */
+		Eigen::VectorXd surrogate_coeffs_;
+		Eigen::VectorXd surrogate_center_;
+		Eigen::VectorXd surrogate_scale_;
+		bool surrogate_quadratic_;
+
+		/** @brief Early-abort option, and the elite costs (max-heap) of the generation */
+		bool early_abort_;
+		unsigned int num_elites_;
+		std::vector<double> elite_costs_;
+		std::mutex elite_mutex_;
+
+		/** @brief Number of true evaluations of the last computation */
+		unsigned int true_evaluations_;
+
 		/** @brief Output file for plotting */
 		std::string output_file_;
 		bool outfile_;
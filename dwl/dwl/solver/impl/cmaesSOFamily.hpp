@@ -2,6 +2,12 @@
 #define DWL__SOLVER__CMAESSOFAMILY__IMPL_H
 
 #include <mutex>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <numeric>
+#include <algorithm>
 std::mutex fmtx;  // protects fitness function
 
 
@@ -16,7 +22,10 @@ cmaesSOFamily<TScaling>::cmaesSOFamily() : cmaes_params_(NULL),
         initialized_(false), print_(false), with_gradient_(false), ftolerance_(1e-12),
 		family_((int) CMAES), sigma_(-1.), lambda_(-1), max_iteration_(-1),
 		max_fevals_(-1), elitism_(0), max_restarts_(0), multithreading_(false),
-		outfile_(false)
+		cloneable_model_(true), warm_start_(false), min_sigma_(0.), last_sigma_(-1.),
+		num_islands_(1), migration_interval_(-1), surrogate_(false), rank_correlation_(0.85),
+		surrogate_quadratic_(false), early_abort_(false), num_elites_(0),
+		true_evaluations_(0), outfile_(false)
 {
 	name_ = "cmaes family";
 }
@@ -25,7 +34,7 @@ cmaesSOFamily<TScaling>::cmaesSOFamily() : cmaes_params_(NULL),
 template<typename TScaling>
 cmaesSOFamily<TScaling>::~cmaesSOFamily()
 {
-
+	deleteModelClones();
 }
 
 
@@ -99,6 +108,38 @@ void cmaesSOFamily<TScaling>::setFromConfigFile(std::string filename)
 	if (yaml_reader.read(multithreading, "multithreads", cmaes_ns))
 		setMultithreading(multithreading);
 
+	// Reading the warm-start options
+	YamlNamespace warm_ns = {cmaes, "warm_start"};
+	bool warm_start;
+	if (yaml_reader.read(warm_start, "activate", warm_ns)) {
+		double min_sigma = 0.;
+		yaml_reader.read(min_sigma, "min_sigma", warm_ns);
+		setWarmStart(warm_start, min_sigma);
+	}
+
+	// Reading the island model options
+	YamlNamespace islands_ns = {cmaes, "islands"};
+	int num_islands;
+	if (yaml_reader.read(num_islands, "number", islands_ns)) {
+		int migration_interval = -1;
+		yaml_reader.read(migration_interval, "migration_interval", islands_ns);
+		setIslands(std::max(num_islands, 1), migration_interval);
+	}
+
+	// Reading the surrogate-assisted options
+	YamlNamespace surrogate_ns = {cmaes, "surrogate"};
+	bool surrogate;
+	if (yaml_reader.read(surrogate, "activate", surrogate_ns)) {
+		double rank_correlation = 0.85;
+		yaml_reader.read(rank_correlation, "rank_correlation", surrogate_ns);
+		setSurrogateAssistance(surrogate, rank_correlation);
+	}
+
+	// Reading the early-abort option
+	bool early_abort;
+	if (yaml_reader.read(early_abort, "early_abort", cmaes_ns))
+		setEarlyAbort(early_abort);
+
 	// Reading the filename
 	bool active;
 	if (yaml_reader.read(active, "activate", ofile_ns)) {
@@ -255,6 +296,48 @@ void cmaesSOFamily<TScaling>::setGradientInjection(bool with_gradient)
 }
 
 
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::setWarmStart(bool warm_start,
+										   double min_sigma)
+{
+	warm_start_ = warm_start;
+	min_sigma_ = min_sigma;
+	last_sigma_ = -1.;
+}
+
+
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::setIslands(unsigned int num_islands,
+										 int migration_interval)
+{
+	num_islands_ = std::max(num_islands, 1u);
+	migration_interval_ = migration_interval;
+}
+
+
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::setSurrogateAssistance(bool surrogate,
+													 double rank_correlation)
+{
+	surrogate_ = surrogate;
+	rank_correlation_ = rank_correlation;
+}
+
+
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::setEarlyAbort(bool early_abort)
+{
+	early_abort_ = early_abort;
+}
+
+
+template<typename TScaling>
+unsigned int cmaesSOFamily<TScaling>::getNumberOfTrueEvaluations() const
+{
+	return true_evaluations_;
+}
+
+
 template<typename TScaling>
 bool cmaesSOFamily<TScaling>::init()
 {
@@ -300,8 +383,10 @@ bool cmaesSOFamily<TScaling>::init()
 															TScaling>>(x0, sigma_,
 																	   lambda_, 0, gp);
 
-	// Setting the previous parameters values
+	// Setting the previous parameters values. Note that the step-size of the warm-start
+	// isn't valid for a new problem
 	initialized_ = true;
+	last_sigma_ = -1.;
     setFtolerance(ftolerance_);
 	setFamily(CMAESFamily(family_));
 	setAllowedNumberofIterations(max_iteration_);
@@ -334,17 +419,71 @@ bool cmaesSOFamily<TScaling>::compute(double allocated_time_secs)
 	model_->getStartingPoint(warm_point_.data(), warm_point_.size());
 	cmaes_params_->set_x0(warm_point_);
 
-	// Computing the solution
+	// Reusing the step-size of the previous computation in the warm-start, where the
+	// distribution is centered in the (shifted) starting point
+	if (warm_start_) {
+		if (last_sigma_ > 0.)
+			cmaes_params_->set_sigma_init(std::max(last_sigma_, min_sigma_));
+		else if (sigma_ > 0.)
+			cmaes_params_->set_sigma_init(sigma_);
+	}
+
+	// The model clones are created again because the model could change between computations
+	// (e.g. its actual state)
+	deleteModelClones();
+	cloneable_model_ = true;
+
+	// Computing the islands concurrently
+	if (num_islands_ > 1) {
+		if (surrogate_)
+			printf(YELLOW "Warning: the surrogate-assisted mode isn't used with islands\n"
+					COLOR_RESET);
+		return computeIslands(allocated_time_secs);
+	}
+
+	// Computing with the surrogate-assisted mode
+	if (surrogate_)
+		return computeWithSurrogate(allocated_time_secs);
+
+	// Getting the number of elite offsprings of the early abort, where the active families
+	// use the worst offsprings as well, and the restarts change lambda
+	unsigned int num_elites = 0;
+	if (early_abort_) {
+		bool active = family_ == ACMAES || family_ == AIPOP || family_ == ABIPOP ||
+				family_ == SEPACMAES || family_ == SEPAIPOP || family_ == SEPABIPOP;
+		bool restarts = max_restarts_ > 0 &&
+				family_ != CMAES && family_ != SEPCMAES && family_ != VDCMA;
+		if (active || restarts)
+			printf(YELLOW "Warning: the early abort isn't used with the active families"
+					" or the restarts\n" COLOR_RESET);
+		else
+			num_elites = cmaes_params_->lambda() / 2;
+	}
+	resetEliteCosts(num_elites);
+
+	// Computing the solution, which stops between generations if the cancellation is requested
 	libcmaes::CMASolutions cmasols;
-	if (with_gradient_)
-		cmasols = libcmaes::cmaes<libcmaes::GenoPheno<libcmaes::pwqBoundStrategy,
-												TScaling>>(fitness_, *cmaes_params_,
-														libcmaes::CMAStrategy<libcmaes::CovarianceUpdate,
-																			  libcmaes::GenoPheno<libcmaes::pwqBoundStrategy,TScaling>>::_defaultPFunc,
-														 grad_fitness_);
-	else
-		cmasols = cmasols = libcmaes::cmaes<libcmaes::GenoPheno<libcmaes::pwqBoundStrategy,
-														TScaling>>(fitness_, *cmaes_params_);
+	typedef libcmaes::CMAStrategy<libcmaes::CovarianceUpdate,GenoPheno> Strategy;
+	telemetry_.startSolve();
+	ProgressFunc progress = [this, num_elites](const Parameters& params,
+											   const libcmaes::CMASolutions& solutions) {
+		// The elite costs are only valid in their generation
+		resetEliteCosts(num_elites);
+
+		// Recording the telemetry of the generation, where the step size is the sigma
+		if (telemetry_.isOpen()) {
+			TelemetryIteration iteration;
+			iteration.iteration = solutions.niter();
+			iteration.objective = solutions.best_candidate().get_fvalue();
+			iteration.step_size = solutions.sigma();
+			telemetry_.recordIteration(iteration);
+		}
+
+		return isCancellationRequested() ? 1 : Strategy::_defaultPFunc(params, solutions);
+	};
+	optimize(cmasols, *cmaes_params_, progress);
+	resetEliteCosts(0);
+	model_->setCostCutoff(std::numeric_limits<double>::max());
 
 	// Prints the solution in the terminal
 	if (print_) {
@@ -354,37 +493,435 @@ bool cmaesSOFamily<TScaling>::compute(double allocated_time_secs)
 		std::cout << cmasols.elapsed_time() / 1000.0 << " seconds\n" << std::endl;
 	}
 
+	// Saving the final step-size for the warm-start of the next computation
+	if (warm_start_)
+		last_sigma_ = cmasols.sigma();
+
 	// Evaluation of the solution
 	solution_ =
 			cmaes_params_->get_gp().pheno(cmasols.best_candidate().get_x_dvec());
 
+	if (isCancellationRequested())
+		return false;
+
 	return cmasols.run_status();
 }
 
 
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::optimize(libcmaes::CMASolutions& solutions,
+									   Parameters& params,
+									   ProgressFunc& progress)
+{
+	if (with_gradient_)
+		solutions = libcmaes::cmaes<GenoPheno>(fitness_, params, progress, grad_fitness_);
+	else
+		solutions = libcmaes::cmaes<GenoPheno>(fitness_, params, progress);
+}
+
+
+template<typename TScaling>
+bool cmaesSOFamily<TScaling>::computeIslands(double allocated_time_secs)
+{
+	// Defining the deadline of the shared wall-clock budget
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point deadline = Clock::time_point::max();
+	if (allocated_time_secs < 1e6)
+		deadline = Clock::now() +
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(allocated_time_secs));
+
+	// Every island starts from the same distribution with a different seed. Note that the
+	// offsprings of all islands are evaluated with model clones
+	std::random_device seed;
+	std::vector<Parameters> island_params(num_islands_, *cmaes_params_);
+	for (unsigned int i = 0; i < num_islands_; i++)
+		island_params[i].set_seed(seed());
+	std::vector<libcmaes::CMASolutions> solutions(num_islands_);
+
+	// The islands stop when the wall-clock budget is exceeded or the cancellation is requested
+	ProgressFunc progress = [this, &deadline](const Parameters&,
+											  const libcmaes::CMASolutions&) {
+		return (Clock::now() > deadline || isCancellationRequested()) ? 1 : 0;
+	};
+
+	// Computing the islands by epochs, i.e. the generations between migrations
+	int iterations = 0;
+	double best_fvalue = std::numeric_limits<double>::max();
+	unsigned int best_island = 0;
+	dVec best_point = warm_point_;
+	bool stop = false;
+	while (!stop) {
+		int epoch_iter = max_iteration_;
+		if (migration_interval_ > 0) {
+			epoch_iter = migration_interval_;
+			if (max_iteration_ > 0)
+				epoch_iter = std::min(epoch_iter, max_iteration_ - iterations);
+		}
+
+		std::vector<std::thread> threads;
+		for (unsigned int i = 0; i < num_islands_; i++) {
+			island_params[i].set_max_iter(epoch_iter);
+			threads.push_back(std::thread(&cmaesSOFamily<TScaling>::optimize, this,
+										  std::ref(solutions[i]),
+										  std::ref(island_params[i]),
+										  std::ref(progress)));
+		}
+		for (unsigned int i = 0; i < threads.size(); i++)
+			threads[i].join();
+		iterations += epoch_iter;
+
+		// Getting the best candidate of all the islands
+		bool converged = true;
+		for (unsigned int i = 0; i < num_islands_; i++) {
+			const libcmaes::Candidate& candidate = solutions[i].best_candidate();
+			if (candidate.get_fvalue() < best_fvalue) {
+				best_fvalue = candidate.get_fvalue();
+				best_island = i;
+				best_point = island_params[i].get_gp().pheno(candidate.get_x_dvec());
+			}
+
+			// An island converges if it's stopped by other criteria than the epoch length
+			if (solutions[i].run_status() == libcmaes::MAXITER)
+				converged = false;
+		}
+
+		// Stopping if there isn't migration, if every island converged, or if the budgets
+		// are exceeded
+		stop = migration_interval_ <= 0 || converged || Clock::now() > deadline ||
+				(max_iteration_ > 0 && iterations >= max_iteration_) ||
+				isCancellationRequested();
+
+		// Migrating the best candidate, where every island keeps its own step-size
+		if (!stop) {
+			for (unsigned int i = 0; i < num_islands_; i++) {
+				island_params[i].set_x0(best_point);
+				island_params[i].set_sigma_init(solutions[i].sigma());
+			}
+		}
+	}
+
+	// Prints the solution of the best island in the terminal
+	const libcmaes::CMASolutions& best_solutions = solutions[best_island];
+	if (print_) {
+		best_solutions.print(std::cout, false, island_params[best_island].get_gp());
+		std::cout << std::endl;
+		std::cout << "Optimization of " << num_islands_ << " islands took ";
+		std::cout << best_solutions.elapsed_time() / 1000.0 << " seconds\n" << std::endl;
+	}
+
+	// Saving the final step-size for the warm-start of the next computation
+	if (warm_start_)
+		last_sigma_ = best_solutions.sigma();
+
+	// Evaluation of the solution
+	solution_ = best_point;
+
+	if (isCancellationRequested())
+		return false;
+
+	return best_solutions.run_status();
+}
+
+
+template<typename TScaling>
+bool cmaesSOFamily<TScaling>::computeWithSurrogate(double allocated_time_secs)
+{
+	if (with_gradient_)
+		printf(YELLOW "Warning: the gradient isn't injected in the surrogate-assisted mode\n"
+				COLOR_RESET);
+
+	// Defining the deadline of the wall-clock budget
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point deadline = Clock::time_point::max();
+	if (allocated_time_secs < 1e6)
+		deadline = Clock::now() +
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(allocated_time_secs));
+
+	// The archive is cleared because the model could change between computations
+	surrogate_points_.clear();
+	surrogate_values_.clear();
+	true_evaluations_ = 0;
+	unsigned int n = warm_point_.size();
+	unsigned int archive_size = 2 * (2 * n + 1);
+
+	// The offsprings are evaluated here, so the optimizer follows the ask-tell interface
+	typedef libcmaes::ESOptimizer<libcmaes::CMAStrategy<libcmaes::CovarianceUpdate,GenoPheno>,
+								  Parameters> Optimizer;
+	Optimizer optim(fitness_, *cmaes_params_);
+
+	double best_fvalue = std::numeric_limits<double>::max();
+	dVec best_point = warm_point_;
+	Eigen::VectorXd costs;
+	Eigen::MatrixXd decisions;
+	while (!optim.stop() && Clock::now() <= deadline && !isCancellationRequested()) {
+		dMat candidates = optim.ask();
+		dMat phenotypes = cmaes_params_->get_gp().pheno(candidates);
+		int lambda = candidates.cols();
+
+		// Ranking the offsprings with the surrogate model. Without model, all the offsprings
+		// are truly evaluated
+		std::vector<unsigned int> order(lambda);
+		std::iota(order.begin(), order.end(), 0);
+		Eigen::VectorXd predictions = Eigen::VectorXd::Zero(lambda);
+		bool with_model = fitSurrogate();
+		if (with_model) {
+			for (int r = 0; r < lambda; r++)
+				predictions(r) = evaluateSurrogate(phenotypes.col(r));
+			std::sort(order.begin(), order.end(),
+					  [&predictions](unsigned int a, unsigned int b) {
+						  return predictions(a) < predictions(b); });
+		}
+
+		// Evaluating the most promising offsprings by batches until the surrogate model ranks
+		// the evaluated ones
+		int batch = with_model ? std::max(lambda / 10, 2) : lambda;
+		int num_evaluated = 0;
+		Eigen::VectorXd fvalues = Eigen::VectorXd::Zero(lambda);
+		costs.resize(batch);
+		decisions.resize(n, batch);
+		while (num_evaluated < lambda) {
+			int k = std::min(batch, lambda - num_evaluated);
+			for (int i = 0; i < k; i++)
+				decisions.col(i) = phenotypes.col(order[num_evaluated + i]);
+			model_->evaluateCostsBatch(costs.data(), k, decisions.data(), n,
+									   constraint_dim_ > 0, multithreading_ ? 0 : 1);
+
+			for (int i = 0; i < k; i++) {
+				unsigned int r = order[num_evaluated + i];
+				fvalues(r) = costs(i);
+				if (costs(i) < best_fvalue) {
+					best_fvalue = costs(i);
+					best_point = decisions.col(i);
+				}
+
+				// Updating the archive with the most recent evaluations
+				surrogate_points_.push_back(decisions.col(i));
+				surrogate_values_.push_back(costs(i));
+			}
+			num_evaluated += k;
+			if (!with_model || num_evaluated < 2)
+				continue;
+
+			// Checking the rank correlation of the evaluated offsprings
+			std::vector<double> predicted(num_evaluated), evaluated(num_evaluated);
+			for (int i = 0; i < num_evaluated; i++) {
+				predicted[i] = predictions(order[i]);
+				evaluated[i] = fvalues(order[i]);
+			}
+			if (computeRankCorrelation(predicted, evaluated) >= rank_correlation_)
+				break;
+		}
+		true_evaluations_ += num_evaluated;
+		if (surrogate_points_.size() > archive_size) {
+			unsigned int num_old = surrogate_points_.size() - archive_size;
+			surrogate_points_.erase(surrogate_points_.begin(),
+									surrogate_points_.begin() + num_old);
+			surrogate_values_.erase(surrogate_values_.begin(),
+									surrogate_values_.begin() + num_old);
+		}
+
+		// The surrogate fitness of the rest of offsprings is shifted, so they are ranked after
+		// the evaluated ones
+		if (num_evaluated < lambda) {
+			double worst_evaluated = -std::numeric_limits<double>::max();
+			for (int i = 0; i < num_evaluated; i++)
+				worst_evaluated = std::max(worst_evaluated, fvalues(order[i]));
+			double shift = worst_evaluated - predictions(order[num_evaluated]);
+			for (int i = num_evaluated; i < lambda; i++)
+				fvalues(order[i]) = predictions(order[i]) + shift;
+		}
+
+		// Updating the distribution
+		for (int r = 0; r < lambda; r++) {
+			optim.get_solutions().get_candidate(r).set_x(candidates.col(r));
+			optim.get_solutions().get_candidate(r).set_fvalue(fvalues(r));
+		}
+		optim.update_fevals(num_evaluated);
+		optim.tell();
+		optim.inc_iter();
+	}
+
+	// Prints the solution in the terminal
+	if (print_) {
+		optim.get_solutions().print(std::cout, false, cmaes_params_->get_gp());
+		std::cout << std::endl;
+		std::cout << "Optimization used " << true_evaluations_ << " true evaluations\n";
+		std::cout << std::endl;
+	}
+
+	// Saving the final step-size for the warm-start of the next computation
+	if (warm_start_)
+		last_sigma_ = optim.get_solutions().sigma();
+
+	// Evaluation of the solution, i.e. the best truly evaluated offspring
+	solution_ = best_point;
+
+	return true_evaluations_ > 0 && !isCancellationRequested();
+}
+
+
+template<typename TScaling>
+bool cmaesSOFamily<TScaling>::fitSurrogate()
+{
+	unsigned int n = warm_point_.size();
+	unsigned int num_samples = surrogate_values_.size();
+	surrogate_quadratic_ = num_samples >= 2 * (2 * n + 1);
+	unsigned int num_coeffs = surrogate_quadratic_ ? 2 * n + 1 : n + 1;
+	if (num_samples < num_coeffs + 1)
+		return false;
+
+	// Normalizing the samples for the conditioning of the least-squares problem
+	surrogate_center_ = Eigen::VectorXd::Zero(n);
+	for (unsigned int i = 0; i < num_samples; i++)
+		surrogate_center_ += surrogate_points_[i];
+	surrogate_center_ /= num_samples;
+	surrogate_scale_ = Eigen::VectorXd::Zero(n);
+	for (unsigned int i = 0; i < num_samples; i++)
+		surrogate_scale_ += (surrogate_points_[i] - surrogate_center_).cwiseAbs2();
+	surrogate_scale_ = (surrogate_scale_ / num_samples).cwiseSqrt().cwiseMax(1e-12);
+
+	// Fitting the model, i.e. c + b' z + sum(a_i z_i^2), by least-squares
+	Eigen::MatrixXd features(num_samples, num_coeffs);
+	Eigen::VectorXd values(num_samples);
+	for (unsigned int i = 0; i < num_samples; i++) {
+		Eigen::VectorXd z =
+				(surrogate_points_[i] - surrogate_center_).cwiseQuotient(surrogate_scale_);
+		features(i,0) = 1.;
+		features.block(i,1,1,n) = z.transpose();
+		if (surrogate_quadratic_)
+			features.block(i,n+1,1,n) = z.cwiseAbs2().transpose();
+		values(i) = surrogate_values_[i];
+	}
+	surrogate_coeffs_ = features.colPivHouseholderQr().solve(values);
+
+	return true;
+}
+
+
+template<typename TScaling>
+double cmaesSOFamily<TScaling>::evaluateSurrogate(const Eigen::Ref<const Eigen::VectorXd>& x)
+{
+	unsigned int n = x.size();
+	Eigen::VectorXd z = (x - surrogate_center_).cwiseQuotient(surrogate_scale_);
+	double value = surrogate_coeffs_(0) + surrogate_coeffs_.segment(1,n).dot(z);
+	if (surrogate_quadratic_)
+		value += surrogate_coeffs_.segment(n+1,n).dot(z.cwiseAbs2());
+
+	return value;
+}
+
+
+template<typename TScaling>
+double cmaesSOFamily<TScaling>::computeRankCorrelation(const std::vector<double>& first,
+													   const std::vector<double>& second)
+{
+	unsigned int num_values = first.size();
+	if (num_values < 2)
+		return 1.;
+
+	// Counting the concordant and discordant pairs
+	int balance = 0;
+	for (unsigned int i = 0; i < num_values; i++) {
+		for (unsigned int j = i + 1; j < num_values; j++) {
+			double sign = (first[i] - first[j]) * (second[i] - second[j]);
+			if (sign > 0.)
+				balance++;
+			else if (sign < 0.)
+				balance--;
+		}
+	}
+
+	return 2. * balance / (num_values * (num_values - 1));
+}
+
+
 template<typename TScaling>
 double cmaesSOFamily<TScaling>::fitnessFunction(const double* x,
 												const int& n)
 {
+	SolverTelemetry::ScopedEvaluation timer(&telemetry_, CostEvaluation);
+
+	// Getting the cost cutoff of the early abort
+	double cutoff = getEliteCutoff();
+
+	// Evaluating the offspring with a model clone in multi-threading cases
+	if (multithreading_ || num_islands_ > 1) {
+		model::OptimizationModel* model = acquireModelClone();
+		if (model != NULL) {
+			double obj_value = 0;
+			model->setCostCutoff(cutoff);
+			if (constraint_dim_ > 0)
+				obj_value = model->evaluateCostsAndSoftConstraints(x, n);
+			else
+				model->evaluateCosts(obj_value, x, n);
+
+			releaseModelClone(model);
+			recordEliteCost(obj_value);
+			return obj_value;
+		}
+	}
+
 	// Locking the thread for multi-threading cases
 	std::lock_guard<std::mutex> lck(fmtx);
 
-	// Numerical evaluation of the cost function
+	// Numerical evaluation of the cost function, where the constraints are evaluated in the same
+	// pass as soft constraints
 	double obj_value = 0;
-	model_->evaluateCosts(obj_value, x, n);
-
-	if (constraint_dim_ > 0) {
-		obj_value += model_->evaluateAsSoftConstraints(x, n);
-	}
+	model_->setCostCutoff(cutoff);
+	if (constraint_dim_ > 0)
+		obj_value = model_->evaluateCostsAndSoftConstraints(x, n);
+	else
+		model_->evaluateCosts(obj_value, x, n);
 
+	recordEliteCost(obj_value);
 	return obj_value;
 }
 
 
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::resetEliteCosts(unsigned int num_elites)
+{
+	std::lock_guard<std::mutex> lck(elite_mutex_);
+	num_elites_ = num_elites;
+	elite_costs_.clear();
+}
+
+
+template<typename TScaling>
+double cmaesSOFamily<TScaling>::getEliteCutoff()
+{
+	// The cutoff is proven once mu offsprings are evaluated, i.e. the worst of the mu best
+	std::lock_guard<std::mutex> lck(elite_mutex_);
+	if (num_elites_ == 0 || elite_costs_.size() < num_elites_)
+		return std::numeric_limits<double>::max();
+
+	return elite_costs_.front();
+}
+
+
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::recordEliteCost(double cost)
+{
+	std::lock_guard<std::mutex> lck(elite_mutex_);
+	if (num_elites_ == 0)
+		return;
+
+	if (elite_costs_.size() < num_elites_) {
+		elite_costs_.push_back(cost);
+		std::push_heap(elite_costs_.begin(), elite_costs_.end());
+	} else if (cost < elite_costs_.front()) {
+		std::pop_heap(elite_costs_.begin(), elite_costs_.end());
+		elite_costs_.back() = cost;
+		std::push_heap(elite_costs_.begin(), elite_costs_.end());
+	}
+}
+
+
 template<typename TScaling>
 dVec cmaesSOFamily<TScaling>::gradientFitnessFunction(const double *x,
 													  const int& n)
 {
+	SolverTelemetry::ScopedEvaluation timer(&telemetry_, GradientEvaluation);
 	dVec gradient(n);
 
 	// Evaluation of the gradient
@@ -393,6 +930,52 @@ dVec cmaesSOFamily<TScaling>::gradientFitnessFunction(const double *x,
 	return gradient;
 }
 
+
+template<typename TScaling>
+model::OptimizationModel* cmaesSOFamily<TScaling>::acquireModelClone()
+{
+	std::lock_guard<std::mutex> lck(clones_mutex_);
+	if (!free_model_clones_.empty()) {
+		model::OptimizationModel* model = free_model_clones_.back();
+		free_model_clones_.pop_back();
+		return model;
+	}
+
+	// Cloning the model, note that the original model isn't modified during the computation
+	if (!cloneable_model_)
+		return NULL;
+
+	model::OptimizationModel* model = model_->clone();
+	if (model == NULL) {
+		printf(YELLOW "WARNING: The optimization model cannot be cloned, so the offsprings"
+				" are evaluated serially\n" COLOR_RESET);
+		cloneable_model_ = false;
+		return NULL;
+	}
+	model_clones_.push_back(model);
+
+	return model;
+}
+
+
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::releaseModelClone(model::OptimizationModel* model)
+{
+	std::lock_guard<std::mutex> lck(clones_mutex_);
+	free_model_clones_.push_back(model);
+}
+
+
+template<typename TScaling>
+void cmaesSOFamily<TScaling>::deleteModelClones()
+{
+	std::lock_guard<std::mutex> lck(clones_mutex_);
+	for (unsigned int i = 0; i < model_clones_.size(); i++)
+		delete model_clones_[i];
+	model_clones_.clear();
+	free_model_clones_.clear();
+}
+
 } //@namespace solver
 } //@namespace dwl
 
@@ -18,6 +18,7 @@ qpOASES::qpOASES() : solver_(NULL), qpOASES_solution_(NULL), num_wsr_(10)
 qpOASES::~qpOASES()
 {
 	delete solver_;
+	delete [] qpOASES_solution_;
 }
 
 
@@ -29,10 +30,13 @@ bool qpOASES::init(unsigned int num_variables,
 	constraints_ = num_constraints;
 
 	// Initializing the qpOASES solution global variable
+	delete [] qpOASES_solution_;
 	qpOASES_solution_ = new double[variables_];
 
 	// Initializing the SQP solver of qpOASES
+	delete solver_;
 	solver_ = new SQProblem(variables_, constraints_);
+	initialized_solver_ = false;
 	
 	// Setting the options of the SQP solver
 	Options my_options;
@@ -48,6 +52,66 @@ bool qpOASES::init(unsigned int num_variables,
 }
 
 
+bool qpOASES::init(const Eigen::MatrixXd& hessian,
+				   const Eigen::VectorXd& gradient,
+				   const Eigen::MatrixXd& constraint_mat,
+				   const Eigen::VectorXd& lower_bound,
+				   const Eigen::VectorXd& upper_bound,
+				   const Eigen::VectorXd& lower_constraint,
+				   const Eigen::VectorXd& upper_constraint,
+				   double cputime)
+{
+	// Discarding the previous factorization and active set
+	reset();
+	setMatrices(hessian, constraint_mat);
+
+	// Solving first QP. Note that the number of working set recalculations is an in/out
+	// argument
+	int num_wsr = num_wsr_;
+	returnValue retval = solver_->init(hessian_.data(),
+									   gradient.data(),
+									   constraint_mat_.data(),
+									   lower_bound.data(), upper_bound.data(),
+									   lower_constraint.data(), upper_constraint.data(),
+									   num_wsr, &cputime);
+	if (retval == SUCCESSFUL_RETURN) {
+		printf("qpOASES problem successfully initialized");
+		initialized_solver_ = true;
+	}
+
+	return getSolution(retval);
+}
+
+
+bool qpOASES::hotstart(const Eigen::MatrixXd& hessian,
+					   const Eigen::VectorXd& gradient,
+					   const Eigen::MatrixXd& constraint_mat,
+					   const Eigen::VectorXd& lower_bound,
+					   const Eigen::VectorXd& upper_bound,
+					   const Eigen::VectorXd& lower_constraint,
+					   const Eigen::VectorXd& upper_constraint,
+					   double cputime)
+{
+	if (!initialized_solver_)
+		return init(hessian, gradient, constraint_mat,
+					lower_bound, upper_bound,
+					lower_constraint, upper_constraint,
+					cputime);
+
+	// Hotstarting the SQProblem with the new matrices, so the active set is kept
+	setMatrices(hessian, constraint_mat);
+	int num_wsr = num_wsr_;
+	returnValue retval = solver_->hotstart(hessian_.data(),
+										   gradient.data(),
+										   constraint_mat_.data(),
+										   lower_bound.data(), upper_bound.data(),
+										   lower_constraint.data(), upper_constraint.data(),
+										   num_wsr, &cputime);
+
+	return getSolution(retval);
+}
+
+
 bool qpOASES::compute(const Eigen::MatrixXd& hessian,
 		 	 	 	  const Eigen::VectorXd& gradient,
 		 	 	 	  const Eigen::MatrixXd& constraint_mat,
@@ -57,36 +121,60 @@ bool qpOASES::compute(const Eigen::MatrixXd& hessian,
 		 	 	 	  const Eigen::VectorXd& upper_constraint,
 		 	 	 	  double cputime)
 {
-	// Initializing the solution vector
-	solution_ = Eigen::VectorXd::Zero(variables_);
+	return hotstart(hessian, gradient, constraint_mat,
+					lower_bound, upper_bound,
+					lower_constraint, upper_constraint,
+					cputime);
+}
 
-	// Ensuring the hessian matrix is row-major storage
-	Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> hessian_rowmajor = hessian;
-	
-	// Solving first QP
-	returnValue retval;
+
+bool qpOASES::hotstart(const Eigen::VectorXd& gradient,
+					   const Eigen::VectorXd& lower_bound,
+					   const Eigen::VectorXd& upper_bound,
+					   const Eigen::VectorXd& lower_constraint,
+					   const Eigen::VectorXd& upper_constraint,
+					   double cputime)
+{
 	if (!initialized_solver_) {
-		retval = solver_->init(hessian_rowmajor.data(),
-							   gradient.data(),
-							   constraint_mat.data(),
-							   lower_bound.data(), upper_bound.data(),
-							   lower_constraint.data(), upper_constraint.data(),
-							   num_wsr_, &cputime);
-		if (retval == SUCCESSFUL_RETURN) {
-			printf("qpOASES problem successfully initialized");
-			initialized_solver_ = true;
-		}
-	} else
-		retval = solver_->hotstart(hessian_rowmajor.data(),
-				   	   	   	   	   gradient.data(),
-				   	   	   	   	   constraint_mat.data(),
-				   	   	   	   	   lower_bound.data(), upper_bound.data(),
-				   	   	   	   	   lower_constraint.data(), upper_constraint.data(),
-				   	   	   	   	   num_wsr_, &cputime);
+		printf("The QP has to be solved with its matrices before hotstarting the vectors");
+		return false;
+	}
 
+	// Hotstarting with the new vectors, so the matrices and their factorization are kept
+	int num_wsr = num_wsr_;
+	returnValue retval = solver_->QProblem::hotstart(gradient.data(),
+													 lower_bound.data(), upper_bound.data(),
+													 lower_constraint.data(),
+													 upper_constraint.data(),
+													 num_wsr, &cputime);
+
+	return getSolution(retval);
+}
+
+
+void qpOASES::reset()
+{
+	QuadraticProgram::reset();
+	if (solver_ != NULL)
+		solver_->reset();
+}
+
+
+void qpOASES::setMatrices(const Eigen::MatrixXd& hessian,
+						  const Eigen::MatrixXd& constraint_mat)
+{
+	// Ensuring the matrices are row-major storage, where the buffers are reused if the
+	// dimensions don't change
+	hessian_ = hessian;
+	constraint_mat_ = constraint_mat;
+}
+
+
+bool qpOASES::getSolution(returnValue retval)
+{
 	if (solver_->isInfeasible())
 		printf("Warning: the quadratic programming is infeasible");
-		
+
 	if (retval == SUCCESSFUL_RETURN) {
 		solver_->getPrimalSolution(qpOASES_solution_);
 		Eigen::Map<Eigen::VectorXd> sol(qpOASES_solution_, variables_, 1);
@@ -97,8 +185,8 @@ bool qpOASES::compute(const Eigen::MatrixXd& hessian,
 	} else {
 		printf("The QP could not find the solution");
 		return false;
-	}	
-	
+	}
+
 	return true;
 }
 
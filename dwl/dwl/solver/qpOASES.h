@@ -33,6 +33,8 @@ namespace solver
 class qpOASES : public QuadraticProgram
 {
 	public:
+		using QuadraticProgram::compute;
+
 		/** @brief Constructor function */
 		qpOASES();
 
@@ -49,7 +51,53 @@ class qpOASES : public QuadraticProgram
 				  unsigned int num_constraints);
 
 		/**
- 	 	 * @brief Function to solve the QP solution
+		 * @brief Function to solve the QP from scratch, i.e. it initializes the
+		 * factorization and the active set of qpOASES
+		 * @param const Eigen::MatrixXd& Hessian matrix
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::MatrixXd& Constraint matrix
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool init(const Eigen::MatrixXd& hessian,
+				  const Eigen::VectorXd& gradient,
+				  const Eigen::MatrixXd& constraint_mat,
+				  const Eigen::VectorXd& lower_bound,
+				  const Eigen::VectorXd& upper_bound,
+				  const Eigen::VectorXd& lower_constraint,
+				  const Eigen::VectorXd& upper_constraint,
+				  double cputime);
+
+		/**
+		 * @brief Function to solve the QP with new matrices by hotstarting the SQProblem of
+		 * qpOASES, i.e. the active set of the last computation is reused. It initializes
+		 * the solver if there isn't a previous computation
+		 * @param const Eigen::MatrixXd& Hessian matrix
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::MatrixXd& Constraint matrix
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool hotstart(const Eigen::MatrixXd& hessian,
+					  const Eigen::VectorXd& gradient,
+					  const Eigen::MatrixXd& constraint_mat,
+					  const Eigen::VectorXd& lower_bound,
+					  const Eigen::VectorXd& upper_bound,
+					  const Eigen::VectorXd& lower_constraint,
+					  const Eigen::VectorXd& upper_constraint,
+					  double cputime);
+
+		/**
+ 	 	 * @brief Function to solve the QP solution, i.e. it initializes qpOASES in the first
+ 	 	 * computation and hotstarts it with the new matrices in the next ones
 	 	 * @param const Eigen::MatrixXd& Hessian matrix
 	 	 * @param const Eigen::VectorXd Gradient vector
 	 	 * @param const Eigen::MatrixXd& Constraint matrix
@@ -69,6 +117,28 @@ class qpOASES : public QuadraticProgram
 					 const Eigen::VectorXd& upper_constraint,
 					 double cputime);
 
+		/**
+		 * @brief Function to solve the QP by hotstarting qpOASES with new vectors, where the
+		 * Hessian and constraint matrices (and their factorization) of the last computation
+		 * are reused
+		 * @param const Eigen::VectorXd Gradient vector
+		 * @param const Eigen::VectorXd Low bound vector
+		 * @param const Eigen::VectorXd Upper bound vector
+		 * @param const Eigen::VectorXd Low constraint vector
+		 * @param const Eigen::VectorXd Upper constraint vector
+		 * @param double CPU-time for computing the optimization
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool hotstart(const Eigen::VectorXd& gradient,
+					  const Eigen::VectorXd& lower_bound,
+					  const Eigen::VectorXd& upper_bound,
+					  const Eigen::VectorXd& lower_constraint,
+					  const Eigen::VectorXd& upper_constraint,
+					  double cputime);
+
+		/** @brief Discards the factorization and active set of qpOASES */
+		void reset();
+
 		/**
 		 * @brief Sets the number of working set recalculations used by qpOASES
 		 * @param double Number of working set recalculations
@@ -77,9 +147,31 @@ class qpOASES : public QuadraticProgram
 
 
 	private:
+		/**
+		 * @brief Copies the matrices into the row-major buffers that are used by qpOASES
+		 * @param const Eigen::MatrixXd& Hessian matrix
+		 * @param const Eigen::MatrixXd& Constraint matrix
+		 */
+		void setMatrices(const Eigen::MatrixXd& hessian,
+						 const Eigen::MatrixXd& constraint_mat);
+
+		/**
+		 * @brief Gets the solution given the return value of qpOASES
+		 * @param returnValue Return value of qpOASES
+		 * @return bool Label that indicates if the computation of the optimization is successful
+		 */
+		bool getSolution(returnValue retval);
+
 		/** @brief SQProblem object which is used to solve the quadratic problem */
 		SQProblem* solver_;
 
+		/**
+		 * @brief Row-major Hessian and constraint matrices. Note that qpOASES keeps
+		 * pointers to them, so they have to live while the solver is hotstarted
+		 */
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> hessian_;
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> constraint_mat_;
+
 		/** @brief Optimal solution obtained with the implementation of qpOASES */
 		double* qpOASES_solution_;
 
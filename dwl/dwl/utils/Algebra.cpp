@@ -6,24 +6,6 @@ namespace dwl
 
 namespace math
 {
-//template <typename T, typename D>
-//void dampedPseudoInverse(const Eigen::MatrixBase<T>& A, double damping_factor,
-//						 Eigen::MatrixBase<D>& Apinv, unsigned int computation_options)//TODO Change the arguments
-//{
-//	using namespace Eigen;
-//
-//	int m = A.rows(), n = A.cols(), k = m < n ? m : n;
-//	JacobiSVD<typename MatrixBase<T>::PlainObject> svd = A.jacobiSvd(computation_options);
-//	const typename JacobiSVD<typename T::PlainObject>::SingularValuesType& singular_values = svd.singularValues();
-//	MatrixXd sigma_damped = MatrixXd::Zero(k, k);
-//
-//	double damp = damping_factor * damping_factor;
-//	for (int idx = 0; idx < k; idx++) {
-//		sigma_damped(idx, idx) = singular_values(idx) / (singular_values(idx) * singular_values(idx) + damp);
-//	}
-//	Apinv = svd.matrixV() * sigma_damped * svd.matrixU().transpose(); // damped pseudoinverse
-//}
-
 
 Eigen::MatrixXd pseudoInverse(const Eigen::MatrixXd& A, double tolerance)
 {
@@ -45,6 +27,28 @@ Eigen::MatrixXd pseudoInverse(const Eigen::MatrixXd& A, double tolerance)
 }
 
 
+Eigen::MatrixXd dampedSVDPseudoInverse(const Eigen::MatrixXd& matrix,
+									   double damping,
+									   double tolerance)
+{
+	Eigen::JacobiSVD<Eigen::MatrixXd> svd(matrix, Eigen::ComputeThinU | Eigen::ComputeThinV);
+
+	// Damping the inverted singular values, i.e. s / (s^2 + lambda^2)
+	const Eigen::VectorXd& singular_values = svd.singularValues();
+	double threshold = 0.;
+	if (singular_values.size() > 0)
+		threshold = sqrt(tolerance) * singular_values(0);
+	Eigen::VectorXd damped_values = Eigen::VectorXd::Zero(singular_values.size());
+	for (unsigned int i = 0; i < singular_values.size(); i++) {
+		double value = singular_values(i);
+		if (value > threshold)
+			damped_values(i) = value / (value * value + damping * damping);
+	}
+
+	return svd.matrixV() * damped_values.asDiagonal() * svd.matrixU().transpose();
+}
+
+
 Eigen::Matrix3d skewSymmetricMatrixFromVector(Eigen::Vector3d vector)
 {
 	Eigen::Matrix3d skew_symmetric_matrix;
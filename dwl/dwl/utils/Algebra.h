@@ -12,9 +12,44 @@ namespace dwl
 namespace math
 {
 
-//template <typename T, typename D>
-//void dampedPseudoInverse(const Eigen::MatrixBase<T>& A, double damping_factor,
-//						 Eigen::MatrixBase<D>& Apinv, unsigned int computation_options);
+/**
+ * @brief Solves the damped least-squares problem min |A x - b|^2 + lambda^2 |x|^2 without
+ * forming the inverse, i.e. x = A' (A A' + lambda^2 I)^-1 b for wide (or square) matrices and
+ * x = (A' A + lambda^2 I)^-1 A' b for tall ones. The normal equations are solved with a LDLT
+ * factorization, whose size is fixed at compile-time for fixed-size matrices (e.g. the 3x3
+ * Gram matrix of a leg Jacobian). The SVD pseudo-inverse is used only as a fallback for
+ * rank-deficient problems. Without damping, it's the least-squares (minimum-norm) solution of
+ * the pseudo-inverse
+ * @param TSolution& Solution vector
+ * @param const Eigen::MatrixBase<TMatrix>& Matrix
+ * @param const Eigen::MatrixBase<TVector>& Right-hand side vector
+ * @param double Damping factor (lambda)
+ * @param double Relative tolerance of the factorization pivots for the rank deficiency
+ * @return True if it was solved with the factorization, and false for the SVD fallback
+ */
+template <typename TSolution, typename TMatrix, typename TVector>
+bool dampedLeastSquares(TSolution& solution,
+						const Eigen::MatrixBase<TMatrix>& matrix,
+						const Eigen::MatrixBase<TVector>& vector,
+						double damping = 0.,
+						double tolerance = 1E-12);
+
+/**
+ * @brief Computes the damped pseudo-inverse, i.e. A' (A A' + lambda^2 I)^-1 for wide matrices
+ * and (A' A + lambda^2 I)^-1 A' for tall ones, with the same LDLT factorization and SVD fallback
+ * of dampedLeastSquares. Note that it's cheaper to solve with dampedLeastSquares if the
+ * pseudo-inverse is only multiplied by a vector
+ * @param TInverse& Damped pseudo-inverse matrix
+ * @param const Eigen::MatrixBase<TMatrix>& Matrix
+ * @param double Damping factor (lambda)
+ * @param double Relative tolerance of the factorization pivots for the rank deficiency
+ * @return True if it was computed with the factorization, and false for the SVD fallback
+ */
+template <typename TInverse, typename TMatrix>
+bool dampedPseudoInverse(TInverse& inverse,
+						 const Eigen::MatrixBase<TMatrix>& matrix,
+						 double damping = 0.,
+						 double tolerance = 1E-12);
 
 /**
  * @brief Computes the pseudo inverse using Moore Penrose algorithm
@@ -25,6 +60,19 @@ namespace math
 Eigen::MatrixXd pseudoInverse(const Eigen::MatrixXd& matrix,
 							  double tolerance = 1E-9);
 
+/**
+ * @brief Computes the damped pseudo-inverse with the singular value decomposition, i.e. the
+ * fallback of dampedLeastSquares and dampedPseudoInverse for rank-deficient matrices. The
+ * singular values smaller than sqrt(tolerance) times the biggest one are discarded
+ * @param const Eigen::MatrixXd& Matrix
+ * @param double Damping factor (lambda)
+ * @param double Relative tolerance of the squared singular values
+ * @return Returns the damped pseudo-inverse matrix
+ */
+Eigen::MatrixXd dampedSVDPseudoInverse(const Eigen::MatrixXd& matrix,
+									   double damping,
+									   double tolerance);
+
 /**
  * @brief Computes the skew symmetric matrix from a 3d vector
  * @param Eigen::Vector3d 3d vector
@@ -46,4 +94,6 @@ void GaussianEliminationPivot(Eigen::VectorXd& x,
 } //@namespace math
 } //@namespace dwl
 
+#include <dwl/utils/impl/Algebra.hpp>
+
 #endif
@@ -0,0 +1,473 @@
+#include <dwl/utils/BinaryLogger.h>
+#include <dwl/utils/Macros.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+namespace binary_log
+{
+/** @brief Rounds up a size to 8 bytes, so the raw blocks are aligned to doubles */
+inline uint64_t align(uint64_t size)
+{
+	return (size + 7) & ~((uint64_t) 7);
+}
+} //@namespace binary_log
+
+
+BinaryLogger::BinaryLogger() : file_(NULL), buffer_rows_(4096), block_rows_(256),
+		compression_(true), head_(0), tail_(0), num_dropped_(0), running_(false)
+{
+
+}
+
+
+BinaryLogger::~BinaryLogger()
+{
+	close();
+}
+
+
+unsigned int BinaryLogger::addChannel(const std::string& name)
+{
+	if (isOpen()) {
+		printf(YELLOW "Warning: the %s channel cannot be added because the log file is already"
+				" opened\n" COLOR_RESET, name.c_str());
+		return channels_.size();
+	}
+
+	channels_.push_back(name);
+	return channels_.size() - 1;
+}
+
+
+void BinaryLogger::setBufferSize(unsigned int buffer_rows,
+								 unsigned int block_rows)
+{
+	if (isOpen()) {
+		printf(YELLOW "Warning: the buffer size cannot be changed because the log file is"
+				" already opened\n" COLOR_RESET);
+		return;
+	}
+
+	block_rows_ = std::max(block_rows, 1u);
+	buffer_rows_ = std::max(buffer_rows, block_rows_);
+}
+
+
+void BinaryLogger::setCompression(bool compression)
+{
+	if (isOpen()) {
+		printf(YELLOW "Warning: the compression cannot be changed because the log file is"
+				" already opened\n" COLOR_RESET);
+		return;
+	}
+
+	compression_ = compression;
+}
+
+
+bool BinaryLogger::open(const std::string& filename)
+{
+	if (isOpen()) {
+		printf(YELLOW "Warning: the log file is already opened. Note that you could open"
+				" another log file after closing the current one\n" COLOR_RESET);
+		return false;
+	}
+
+	if (channels_.empty()) {
+		printf(RED "FATAL: there isn't any channel to log\n" COLOR_RESET);
+		return false;
+	}
+
+	file_ = fopen(filename.c_str(), "wb");
+	if (file_ == NULL) {
+		printf(RED "FATAL: the %s log file could not be opened\n" COLOR_RESET,
+				filename.c_str());
+		return false;
+	}
+
+	// Writing the header and the channel names
+	std::vector<unsigned char> schema;
+	for (unsigned int i = 0; i < channels_.size(); i++) {
+		uint32_t length = channels_[i].size();
+		schema.insert(schema.end(), (unsigned char*) &length,
+					  (unsigned char*) &length + sizeof(length));
+		schema.insert(schema.end(), channels_[i].begin(), channels_[i].end());
+	}
+	binary_log::FileHeader header;
+	memcpy(header.magic, binary_log::Magic, sizeof(header.magic));
+	header.version = binary_log::Version;
+	header.num_channels = channels_.size();
+	header.data_offset = binary_log::align(sizeof(header) + schema.size());
+	schema.resize(header.data_offset - sizeof(header), 0);
+	fwrite(&header, sizeof(header), 1, file_);
+	fwrite(schema.data(), 1, schema.size(), file_);
+
+	// Allocating the ring buffer and the block, where a compressed value uses up to 9 bytes
+	buffer_.assign(buffer_rows_ * channels_.size(), 0.);
+	block_.reserve(binary_log::align(9 * block_rows_ * channels_.size()));
+	head_.store(0, std::memory_order_relaxed);
+	tail_.store(0, std::memory_order_relaxed);
+	num_dropped_.store(0, std::memory_order_relaxed);
+
+	running_.store(true);
+	writer_ = std::thread(&BinaryLogger::writerLoop, this);
+
+	return true;
+}
+
+
+bool BinaryLogger::append(const double* row)
+{
+	// Only this thread writes the head, and the tail is published by the writer thread after
+	// it has read the rows
+	uint64_t head = head_.load(std::memory_order_relaxed);
+	if (file_ == NULL || head - tail_.load(std::memory_order_acquire) >= buffer_rows_) {
+		num_dropped_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	unsigned int num_channels = channels_.size();
+	memcpy(&buffer_[(head % buffer_rows_) * num_channels], row, num_channels * sizeof(double));
+	head_.store(head + 1, std::memory_order_release);
+
+	return true;
+}
+
+
+bool BinaryLogger::append(const std::vector<double>& row)
+{
+	if (row.size() != channels_.size()) {
+		printf(YELLOW "Warning: the row has %u values but there are %u channels\n"
+				COLOR_RESET, (unsigned int) row.size(), (unsigned int) channels_.size());
+		return false;
+	}
+
+	return append(row.data());
+}
+
+
+void BinaryLogger::close()
+{
+	if (!isOpen())
+		return;
+
+	// Stopping the writer thread, and writing the remaining rows
+	running_.store(false);
+	writer_.join();
+	writeBlocks(true);
+
+	fclose(file_);
+	file_ = NULL;
+}
+
+
+const std::vector<std::string>& BinaryLogger::getChannels() const
+{
+	return channels_;
+}
+
+
+unsigned long BinaryLogger::getNumberOfDroppedRows() const
+{
+	return num_dropped_.load(std::memory_order_relaxed);
+}
+
+
+bool BinaryLogger::isOpen() const
+{
+	return file_ != NULL;
+}
+
+
+void BinaryLogger::writerLoop()
+{
+	while (running_.load()) {
+		// Waiting for new rows if the blocks were written
+		if (writeBlocks(false) == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+
+unsigned int BinaryLogger::writeBlocks(bool flush)
+{
+	uint64_t tail = tail_.load(std::memory_order_relaxed);
+	uint64_t head = head_.load(std::memory_order_acquire);
+	unsigned int num_rows = 0;
+	while (head - tail >= block_rows_ || (flush && head > tail)) {
+		unsigned int block_rows = std::min<uint64_t>(head - tail, block_rows_);
+		writeBlock(tail, block_rows);
+
+		// Releasing the rows of the block to the producer
+		tail += block_rows;
+		tail_.store(tail, std::memory_order_release);
+		num_rows += block_rows;
+	}
+
+	if (num_rows > 0)
+		fflush(file_);
+
+	return num_rows;
+}
+
+
+void BinaryLogger::writeBlock(uint64_t first_row,
+							  unsigned int num_rows)
+{
+	unsigned int num_channels = channels_.size();
+	block_.clear();
+	if (compression_) {
+		// Encoding every value XOR-ed with the previous value of its channel, where the
+		// leading zero bytes are removed
+		uint64_t last_row = 0;
+		for (unsigned int r = 0; r < num_rows; r++) {
+			uint64_t row = (first_row + r) % buffer_rows_;
+			for (unsigned int i = 0; i < num_channels; i++) {
+				uint64_t bits, last_bits = 0;
+				memcpy(&bits, &buffer_[row * num_channels + i], sizeof(bits));
+				if (r > 0)
+					memcpy(&last_bits, &buffer_[last_row * num_channels + i], sizeof(last_bits));
+
+				uint64_t value = bits ^ last_bits;
+				unsigned char num_bytes = 0;
+				for (uint64_t v = value; v != 0; v >>= 8)
+					num_bytes++;
+				block_.push_back(num_bytes);
+				for (unsigned char b = 0; b < num_bytes; b++)
+					block_.push_back((value >> (8 * b)) & 0xff);
+			}
+			last_row = row;
+		}
+	} else {
+		for (unsigned int r = 0; r < num_rows; r++) {
+			const unsigned char* row = (const unsigned char*)
+					&buffer_[((first_row + r) % buffer_rows_) * num_channels];
+			block_.insert(block_.end(), row, row + num_channels * sizeof(double));
+		}
+	}
+
+	binary_log::BlockHeader header;
+	header.num_rows = num_rows;
+	header.compressed = compression_;
+	header.payload_size = block_.size();
+	block_.resize(binary_log::align(block_.size()), 0);
+	fwrite(&header, sizeof(header), 1, file_);
+	fwrite(block_.data(), 1, block_.size(), file_);
+}
+
+
+
+BinaryLogReader::BinaryLogReader() : data_(NULL), size_(0), num_rows_(0)
+{
+
+}
+
+
+BinaryLogReader::~BinaryLogReader()
+{
+	close();
+}
+
+
+bool BinaryLogReader::open(const std::string& filename)
+{
+	close();
+
+	// Mapping the file
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		printf(RED "FATAL: the %s log file could not be opened\n" COLOR_RESET,
+				filename.c_str());
+		return false;
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 ||
+			file_stat.st_size < (off_t) sizeof(binary_log::FileHeader)) {
+		printf(RED "FATAL: the %s file is not a log file\n" COLOR_RESET, filename.c_str());
+		::close(fd);
+		return false;
+	}
+	size_ = file_stat.st_size;
+	void* data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		printf(RED "FATAL: the %s log file could not be mapped\n" COLOR_RESET,
+				filename.c_str());
+		size_ = 0;
+		return false;
+	}
+	data_ = (const unsigned char*) data;
+
+	// Reading the header and the channel names
+	const binary_log::FileHeader* header = (const binary_log::FileHeader*) data_;
+	if (memcmp(header->magic, binary_log::Magic, sizeof(header->magic)) != 0 ||
+			header->version != binary_log::Version || header->data_offset > size_) {
+		printf(RED "FATAL: the %s file is not a log file of version %u\n" COLOR_RESET,
+				filename.c_str(), binary_log::Version);
+		close();
+		return false;
+	}
+	uint64_t offset = sizeof(binary_log::FileHeader);
+	for (unsigned int i = 0; i < header->num_channels; i++) {
+		uint32_t length;
+		if (offset + sizeof(length) > header->data_offset) {
+			printf(RED "FATAL: the channels of the %s log file are corrupted\n" COLOR_RESET,
+					filename.c_str());
+			close();
+			return false;
+		}
+		memcpy(&length, data_ + offset, sizeof(length));
+		offset += sizeof(length);
+		if (offset + length > header->data_offset) {
+			printf(RED "FATAL: the channels of the %s log file are corrupted\n" COLOR_RESET,
+					filename.c_str());
+			close();
+			return false;
+		}
+		channels_.push_back(std::string((const char*) data_ + offset, length));
+		offset += length;
+	}
+
+	// Indexing the blocks, where the incomplete block is ignored
+	offset = header->data_offset;
+	while (offset + sizeof(binary_log::BlockHeader) <= size_) {
+		Block block;
+		block.header = (const binary_log::BlockHeader*) (data_ + offset);
+		block.payload = data_ + offset + sizeof(binary_log::BlockHeader);
+		block.first_row = num_rows_;
+		uint64_t payload_end = offset + sizeof(binary_log::BlockHeader) +
+				block.header->payload_size;
+		if (payload_end > size_ || (!block.header->compressed &&
+				block.header->payload_size != block.header->num_rows * channels_.size() * sizeof(double)))
+			break;
+
+		blocks_.push_back(block);
+		num_rows_ += block.header->num_rows;
+		offset = binary_log::align(payload_end);
+	}
+
+	return true;
+}
+
+
+void BinaryLogReader::close()
+{
+	if (data_ != NULL)
+		munmap((void*) data_, size_);
+
+	data_ = NULL;
+	size_ = 0;
+	channels_.clear();
+	blocks_.clear();
+	num_rows_ = 0;
+}
+
+
+const std::vector<std::string>& BinaryLogReader::getChannels() const
+{
+	return channels_;
+}
+
+
+unsigned int BinaryLogReader::getChannelIndex(const std::string& name) const
+{
+	return std::find(channels_.begin(), channels_.end(), name) - channels_.begin();
+}
+
+
+uint64_t BinaryLogReader::getNumberOfRows() const
+{
+	return num_rows_;
+}
+
+
+unsigned int BinaryLogReader::getNumberOfBlocks() const
+{
+	return blocks_.size();
+}
+
+
+unsigned int BinaryLogReader::readBlock(std::vector<double>& rows,
+										unsigned int block) const
+{
+	rows.clear();
+	if (block >= blocks_.size())
+		return 0;
+
+	const Block& log_block = blocks_[block];
+	unsigned int num_values = log_block.header->num_rows * channels_.size();
+	if (!log_block.header->compressed) {
+		const double* values = (const double*) log_block.payload;
+		rows.assign(values, values + num_values);
+		return log_block.header->num_rows;
+	}
+
+	// Decoding the values XOR-ed with the previous value of their channel
+	rows.resize(num_values);
+	const unsigned char* payload = log_block.payload;
+	const unsigned char* payload_end = payload + log_block.header->payload_size;
+	unsigned int num_channels = channels_.size();
+	for (unsigned int k = 0; k < num_values; k++) {
+		if (payload >= payload_end || payload + 1 + *payload > payload_end || *payload > 8) {
+			printf(RED "FATAL: the %u block of the log file is corrupted\n" COLOR_RESET, block);
+			rows.clear();
+			return 0;
+		}
+
+		unsigned char num_bytes = *payload++;
+		uint64_t value = 0;
+		for (unsigned char b = 0; b < num_bytes; b++)
+			value |= (uint64_t) *payload++ << (8 * b);
+
+		if (k >= num_channels) {
+			uint64_t last_bits;
+			memcpy(&last_bits, &rows[k - num_channels], sizeof(last_bits));
+			value ^= last_bits;
+		}
+		memcpy(&rows[k], &value, sizeof(value));
+	}
+
+	return log_block.header->num_rows;
+}
+
+
+const double* BinaryLogReader::getRawBlock(unsigned int block) const
+{
+	if (block >= blocks_.size() || blocks_[block].header->compressed)
+		return NULL;
+
+	return (const double*) blocks_[block].payload;
+}
+
+
+void BinaryLogReader::readChannel(std::vector<double>& values,
+								  unsigned int channel) const
+{
+	values.clear();
+	if (channel >= channels_.size())
+		return;
+
+	values.reserve(num_rows_);
+	unsigned int num_channels = channels_.size();
+	std::vector<double> rows;
+	for (unsigned int b = 0; b < blocks_.size(); b++) {
+		unsigned int num_rows = readBlock(rows, b);
+		for (unsigned int r = 0; r < num_rows; r++)
+			values.push_back(rows[r * num_channels + channel]);
+	}
+}
+
+} //@namespace utils
+} //@namespace dwl
@@ -0,0 +1,281 @@
+#ifndef DWL__UTILS__BINARY_LOGGER__H
+#define DWL__UTILS__BINARY_LOGGER__H
+
+#include <atomic>
+#include <cstdio>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @brief Layout of the binary log files. A file starts with a header (magic, version, number
+ * of channels, and the channel names as a length-prefixed list padded to 8 bytes), followed by
+ * a sequence of blocks. Every block has a header, which defines its number of rows, the size of
+ * its payload, and if it's compressed. The payload of the raw blocks are the rows of doubles,
+ * so they can be read directly from the mapped file. The compressed blocks encode every value
+ * XOR-ed with the value of the previous row of its channel (the first row of every block is
+ * XOR-ed with zero), where every value is a byte with its number of significant bytes followed
+ * by those bytes (little-endian). So the blocks are decoded independently, and the slowly
+ * changing channels use few bytes per value
+ */
+namespace binary_log
+{
+/** @brief Magic number of the files, i.e. "DWLBLOG" */
+static const char Magic[8] = {'D', 'W', 'L', 'B', 'L', 'O', 'G', '\0'};
+
+/** @brief Version of the format */
+static const uint32_t Version = 1;
+
+/** @brief Header of the files, which is followed by the channel names */
+struct FileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t num_channels;
+	uint64_t data_offset;
+};
+
+/** @brief Header of the blocks, which is followed by their payload */
+struct BlockHeader
+{
+	uint32_t num_rows;
+	uint32_t compressed;
+	uint64_t payload_size;
+};
+} //@namespace binary_log
+
+
+/**
+ * @class BinaryLogger
+ * @brief High-throughput logger of numerical channels, e.g. the signals of a controller.
+ * The channels are registered once, before opening the file, and then the rows are appended
+ * from a single producer thread (e.g. the control thread) to a lock-free ring buffer. Appending
+ * a row doesn't lock or allocate memory, and the row is dropped if the ring buffer is full.
+ * A background thread takes the rows from the ring buffer, compresses them in blocks and writes
+ * them to the file. The file is read, through memory mapping, by the BinaryLogReader class
+ */
+class BinaryLogger
+{
+	public:
+		/** @brief Constructor function */
+		BinaryLogger();
+
+		/** @brief Destructor function, which closes the file */
+		~BinaryLogger();
+
+		/**
+		 * @brief Adds a channel, which has to be done before opening the file
+		 * @param const std::string& Name of the channel
+		 * @return The index of the channel in the rows
+		 */
+		unsigned int addChannel(const std::string& name);
+
+		/**
+		 * @brief Sets the capacity of the ring buffer, in rows, and the number of rows of the
+		 * blocks. Note that it has to be done before opening the file
+		 * @param unsigned int Capacity of the ring buffer
+		 * @param unsigned int Number of rows per block
+		 */
+		void setBufferSize(unsigned int buffer_rows,
+						   unsigned int block_rows);
+
+		/**
+		 * @brief Sets if the blocks are compressed (by default) or written raw. Note that it
+		 * has to be done before opening the file
+		 * @param bool True for compressing the blocks
+		 */
+		void setCompression(bool compression);
+
+		/**
+		 * @brief Opens the file, writes the channels and starts the writer thread
+		 * @param const std::string& File name
+		 * @return True if the file was opened
+		 */
+		bool open(const std::string& filename);
+
+		/**
+		 * @brief Appends a row to the ring buffer, which doesn't lock nor allocate memory.
+		 * It has to be called from a single thread
+		 * @param const double* Values of the channels (in order of registration)
+		 * @return False if the row was dropped because the ring buffer is full
+		 */
+		bool append(const double* row);
+
+		/**
+		 * @brief Appends a row to the ring buffer
+		 * @param const std::vector<double>& Values of the channels (in order of registration)
+		 * @return False if the row was dropped
+		 */
+		bool append(const std::vector<double>& row);
+
+		/** @brief Writes the remaining rows, stops the writer thread and closes the file */
+		void close();
+
+		/** @brief Gets the channel names */
+		const std::vector<std::string>& getChannels() const;
+
+		/** @brief Gets the number of rows that were dropped because the ring buffer was full */
+		unsigned long getNumberOfDroppedRows() const;
+
+		/** @brief Indicates if the file is opened */
+		bool isOpen() const;
+
+
+	private:
+		/** @brief Loop of the writer thread */
+		void writerLoop();
+
+		/**
+		 * @brief Takes the available rows from the ring buffer and writes them in blocks
+		 * @param bool True for writing the incomplete blocks
+		 * @return The number of written rows
+		 */
+		unsigned int writeBlocks(bool flush);
+
+		/**
+		 * @brief Writes a block of consecutive rows of the ring buffer
+		 * @param uint64_t Index of the first row
+		 * @param unsigned int Number of rows
+		 */
+		void writeBlock(uint64_t first_row,
+						unsigned int num_rows);
+
+		/** @brief Channel names */
+		std::vector<std::string> channels_;
+
+		/** @brief File for recording the data */
+		FILE* file_;
+
+		/** @brief Ring buffer of rows, and its capacity in rows */
+		std::vector<double> buffer_;
+		unsigned int buffer_rows_;
+
+		/** @brief Number of rows per block */
+		unsigned int block_rows_;
+
+		/** @brief Block under encoding, which is reused */
+		std::vector<unsigned char> block_;
+
+		/** @brief Indicates if the blocks are compressed */
+		bool compression_;
+
+		/**
+		 * @brief Number of rows appended by the producer and written by the writer thread.
+		 * Every counter is written by a single thread, and they are in different cache lines
+		 */
+		alignas(64) std::atomic<uint64_t> head_;
+		alignas(64) std::atomic<uint64_t> tail_;
+
+		/** @brief Number of dropped rows */
+		alignas(64) std::atomic<unsigned long> num_dropped_;
+
+		/** @brief Writer thread */
+		std::thread writer_;
+
+		/** @brief Indicates if the writer thread is running */
+		std::atomic<bool> running_;
+};
+
+
+/**
+ * @class BinaryLogReader
+ * @brief Reads the files of the BinaryLogger by mapping them in memory. The blocks are
+ * indexed when the file is opened, so the raw blocks are read without copying, and the
+ * compressed ones are decoded independently
+ */
+class BinaryLogReader
+{
+	public:
+		/** @brief Constructor function */
+		BinaryLogReader();
+
+		/** @brief Destructor function, which unmaps the file */
+		~BinaryLogReader();
+
+		/**
+		 * @brief Maps the file, reads its channels and indexes its blocks. The incomplete
+		 * last block (e.g. of a process that crashed) is ignored
+		 * @param const std::string& File name
+		 * @return True if it's a valid log file
+		 */
+		bool open(const std::string& filename);
+
+		/** @brief Unmaps the file */
+		void close();
+
+		/** @brief Gets the channel names */
+		const std::vector<std::string>& getChannels() const;
+
+		/**
+		 * @brief Gets the index of a channel
+		 * @param const std::string& Channel name
+		 * @return The index of the channel, or the number of channels if it doesn't exist
+		 */
+		unsigned int getChannelIndex(const std::string& name) const;
+
+		/** @brief Gets the number of rows */
+		uint64_t getNumberOfRows() const;
+
+		/** @brief Gets the number of blocks */
+		unsigned int getNumberOfBlocks() const;
+
+		/**
+		 * @brief Reads the rows of a block
+		 * @param std::vector<double>& Values of the rows (row-major)
+		 * @param unsigned int Index of the block
+		 * @return The number of rows of the block
+		 */
+		unsigned int readBlock(std::vector<double>& rows,
+							   unsigned int block) const;
+
+		/**
+		 * @brief Gets the rows of a raw block inside the mapped file, without copying them
+		 * @param unsigned int Index of the block
+		 * @return The rows (row-major), or NULL if the block is compressed
+		 */
+		const double* getRawBlock(unsigned int block) const;
+
+		/**
+		 * @brief Reads all the values of a channel
+		 * @param std::vector<double>& Values of the channel
+		 * @param unsigned int Index of the channel
+		 */
+		void readChannel(std::vector<double>& values,
+						 unsigned int channel) const;
+
+
+	private:
+		/** @brief Block of the mapped file */
+		struct Block
+		{
+			const binary_log::BlockHeader* header;
+			const unsigned char* payload;
+			uint64_t first_row;
+		};
+
+		/** @brief Mapped file and its size */
+		const unsigned char* data_;
+		size_t size_;
+
+		/** @brief Channel names */
+		std::vector<std::string> channels_;
+
+		/** @brief Blocks of the file */
+		std::vector<Block> blocks_;
+
+		/** @brief Number of rows */
+		uint64_t num_rows_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
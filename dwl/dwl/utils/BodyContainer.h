@@ -0,0 +1,141 @@
+#ifndef DWL__RBD__BODY_CONTAINER__H
+#define DWL__RBD__BODY_CONTAINER__H
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <vector>
+#include <map>
+#include <string>
+
+
+namespace dwl
+{
+
+namespace rbd
+{
+
+/**
+ * @class BodyContainer
+ * @brief BodyContainer stores body quantities (e.g. positions or wrenches) in
+ * a contiguous and fixed-capacity array indexed by the end-effector index. The
+ * body names (and their indexes) are resolved once, i.e. normally from
+ * FloatingBaseSystem::getEndEffectorNames(). After that, reading and writing
+ * doesn't require string comparisons nor heap allocations
+ */
+template<typename TVector>
+class BodyContainer
+{
+	public:
+		typedef std::vector<TVector, Eigen::aligned_allocator<TVector> > DataVector;
+
+		/** @brief Constructor function */
+		BodyContainer() {}
+
+		/**
+		 * @brief Constructor function
+		 * @param const std::vector<std::string>& Body names
+		 */
+		BodyContainer(const std::vector<std::string>& names) {
+			reset(names);
+		}
+
+		/** @brief Destructor function */
+		~BodyContainer() {}
+
+		/**
+		 * @brief Resets the body names, and allocates the data. Note that this
+		 * is the only routine that allocates memory
+		 * @param const std::vector<std::string>& Body names
+		 */
+		void reset(const std::vector<std::string>& names) {
+			names_ = names;
+			data_.resize(names_.size());
+			setZero();
+		}
+
+		/** @brief Sets to zero all the body values */
+		void setZero() {
+			for (unsigned int i = 0; i < data_.size(); i++)
+				data_[i].setZero();
+		}
+
+		/** @brief Gets the number of bodies */
+		unsigned int size() const {
+			return data_.size();
+		}
+
+		/**
+		 * @brief Gets the index of a body given its name. This routine does
+		 * string comparisons, so it should be used only for resolving indexes
+		 * @param const std::string& Body name
+		 * @return int The body index, or -1 if the body doesn't exist
+		 */
+		int getIndex(const std::string& name) const {
+			for (unsigned int i = 0; i < names_.size(); i++) {
+				if (names_[i] == name)
+					return i;
+			}
+			return -1;
+		}
+
+		/** @brief Gets the body name given its index */
+		const std::string& getName(unsigned int index) const {
+			return names_[index];
+		}
+
+		/** @brief Gets the body names */
+		const std::vector<std::string>& getNames() const {
+			return names_;
+		}
+
+		/** @brief Gets the body value given its index */
+		TVector& operator[](unsigned int index) {
+			return data_[index];
+		}
+		const TVector& operator[](unsigned int index) const {
+			return data_[index];
+		}
+
+		/** @brief Gets the contiguous data */
+		const DataVector& getData() const {
+			return data_;
+		}
+
+		/**
+		 * @brief Copies the values of the body map (e.g. rbd::BodyVectorXd)
+		 * for the bodies defined in this container
+		 * @param const TMap& Body map
+		 */
+		template<typename TMap>
+		void fromMap(const TMap& body_map) {
+			for (unsigned int i = 0; i < names_.size(); i++) {
+				typename TMap::const_iterator it = body_map.find(names_[i]);
+				if (it != body_map.end())
+					data_[i] = it->second;
+			}
+		}
+
+		/**
+		 * @brief Copies the values of this container to a body map (e.g.
+		 * rbd::BodyVectorXd)
+		 * @param TMap& Body map
+		 */
+		template<typename TMap>
+		void toMap(TMap& body_map) const {
+			for (unsigned int i = 0; i < names_.size(); i++)
+				body_map[names_[i]] = data_[i];
+		}
+
+
+	private:
+		/** @brief Body names ordered by index */
+		std::vector<std::string> names_;
+
+		/** @brief Contiguous body data */
+		DataVector data_;
+};
+
+} //@namespace rbd
+} //@namespace dwl
+
+#endif
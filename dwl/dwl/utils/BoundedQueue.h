@@ -0,0 +1,123 @@
+#ifndef DWL__UTILS__BOUNDED_QUEUE__H
+#define DWL__UTILS__BOUNDED_QUEUE__H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @class BoundedQueue
+ * @brief Blocking queue with a maximum number of values, which connects the stages of a
+ * pipeline (e.g. the planners of a hierarchy). A producer waits while the queue is full, so a
+ * fast stage can't run ahead of a slow one, and a consumer waits while the queue is empty.
+ * Closing the queue wakes up both of them, i.e. the producers can't push anymore and the
+ * consumers pop the remaining values
+ */
+template<typename T>
+class BoundedQueue
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param unsigned int Maximum number of values (at least one)
+		 */
+		BoundedQueue(unsigned int capacity = 1) : capacity_(capacity > 0 ? capacity : 1),
+				closed_(false) {}
+
+		/** @brief Destructor function */
+		~BoundedQueue() {}
+
+		/**
+		 * @brief Pushes a value, and waits while the queue is full
+		 * @param const T& Value
+		 * @return False if the queue was closed
+		 */
+		bool push(const T& value) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			not_full_.wait(lock, [this] { return closed_ || values_.size() < capacity_; });
+			if (closed_)
+				return false;
+
+			values_.push_back(value);
+			not_empty_.notify_one();
+			return true;
+		}
+
+		/**
+		 * @brief Pops the oldest value, and waits while the queue is empty
+		 * @param T& Value
+		 * @return False if the queue was closed and there isn't any remaining value
+		 */
+		bool pop(T& value) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			not_empty_.wait(lock, [this] { return closed_ || !values_.empty(); });
+			if (values_.empty())
+				return false;
+
+			value = values_.front();
+			values_.pop_front();
+			not_full_.notify_one();
+			return true;
+		}
+
+		/** @brief Closes the queue, which wakes up the waiting producers and consumers */
+		void close() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+			not_full_.notify_all();
+			not_empty_.notify_all();
+		}
+
+		/**
+		 * @brief Clears and reopens the queue, which shouldn't be used by any stage
+		 * @param unsigned int Maximum number of values (at least one)
+		 */
+		void reset(unsigned int capacity) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			values_.clear();
+			capacity_ = capacity > 0 ? capacity : 1;
+			closed_ = false;
+		}
+
+		/** @brief Gets the number of queued values */
+		unsigned int size() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return values_.size();
+		}
+
+		/** @brief Indicates if the queue was closed */
+		bool isClosed() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return closed_;
+		}
+
+
+	private:
+		/** @brief Queue isn't copyable */
+		BoundedQueue(const BoundedQueue&);
+		BoundedQueue& operator=(const BoundedQueue&);
+
+		/** @brief Queued values, which are guarded by the mutex */
+		std::deque<T> values_;
+		std::mutex mutex_;
+		std::condition_variable not_full_;
+		std::condition_variable not_empty_;
+
+		/** @brief Maximum number of values */
+		unsigned int capacity_;
+
+		/** @brief Indicates if the queue was closed */
+		bool closed_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
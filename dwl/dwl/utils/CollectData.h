@@ -21,7 +21,8 @@ namespace utils
  * different tag names of your data in the initCollectData method. Then, you
  * could write sequentially as many data as you need, with the writeNewData
  * method. Note that the data has to be specified in a dictionary. When you
- * have finished to collect data, you have to call the stopCollectData method
+ * have finished to collect data, you have to call the stopCollectData method.
+ * For logging many channels at high rates, use the BinaryLogger class instead
  */
 class CollectData
 {
@@ -0,0 +1,81 @@
+#include <dwl/utils/Collocation.h>
+#include <cmath>
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+void computeRadauNodes(Eigen::VectorXd& nodes,
+					   unsigned int num_nodes)
+{
+	nodes.resize(num_nodes);
+	if (num_nodes == 0)
+		return;
+
+	// Computing the standard LGR nodes (with -1 as first node) by Newton iterations of
+	// P_{N-1} + P_N, which start from the Chebyshev-Gauss-Radau nodes
+	unsigned int n = num_nodes;
+	Eigen::VectorXd x(n), legendre(n + 1);
+	for (unsigned int i = 0; i < n; i++)
+		x(i) = -cos(2. * M_PI * i / (2. * n - 1.));
+	for (unsigned int i = 1; i < n; i++) {
+		for (unsigned int it = 0; it < 100; it++) {
+			// Evaluating the Legendre polynomials with the three-term recurrence
+			legendre(0) = 1.;
+			legendre(1) = x(i);
+			for (unsigned int k = 2; k <= n; k++)
+				legendre(k) = ((2. * k - 1.) * x(i) * legendre(k-1) -
+						(k - 1.) * legendre(k-2)) / k;
+
+			double step = ((1. - x(i)) / n) *
+					(legendre(n-1) + legendre(n)) / (legendre(n-1) - legendre(n));
+			x(i) -= step;
+			if (fabs(step) < 1e-15)
+				break;
+		}
+	}
+
+	// Flipping the nodes, so they are in the interval (-1,1]
+	for (unsigned int i = 0; i < n; i++)
+		nodes(i) = -x(n - 1 - i);
+}
+
+
+void computeRadauDifferentiationMatrix(Eigen::MatrixXd& diff_mat,
+									   const Eigen::VectorXd& nodes)
+{
+	// Defining the support points, i.e. the beginning of the phase and the nodes
+	unsigned int num_nodes = nodes.size();
+	Eigen::VectorXd points(num_nodes + 1);
+	points(0) = -1.;
+	points.tail(num_nodes) = nodes;
+
+	// Computing the barycentric weights of the Lagrange polynomials
+	unsigned int num_points = points.size();
+	Eigen::VectorXd weights = Eigen::VectorXd::Ones(num_points);
+	for (unsigned int j = 0; j < num_points; j++) {
+		for (unsigned int m = 0; m < num_points; m++) {
+			if (m != j)
+				weights(j) /= points(j) - points(m);
+		}
+	}
+
+	// Computing the derivatives of the Lagrange polynomials at the nodes, where the
+	// diagonal entries follow from the sum of the derivatives, which is zero
+	diff_mat.setZero(num_nodes, num_points);
+	for (unsigned int i = 0; i < num_nodes; i++) {
+		unsigned int p = i + 1;
+		for (unsigned int j = 0; j < num_points; j++) {
+			if (j != p) {
+				diff_mat(i,j) = (weights(j) / weights(p)) / (points(p) - points(j));
+				diff_mat(i,p) -= diff_mat(i,j);
+			}
+		}
+	}
+}
+
+} //@namespace math
+} //@namespace dwl
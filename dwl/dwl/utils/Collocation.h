@@ -0,0 +1,38 @@
+#ifndef DWL__MATH__COLLOCATION__H
+#define DWL__MATH__COLLOCATION__H
+
+#include <Eigen/Dense>
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+/**
+ * @brief Computes the flipped Legendre-Gauss-Radau (LGR) nodes, i.e. the roots of
+ * P_{N-1}(tau) - P_N(tau) in the interval (-1,1], where P_N is the Legendre polynomial of
+ * degree N. The last node is 1, so the collocation of a phase ends in its final state
+ * (i.e. the Radau IIA points)
+ * @param Eigen::VectorXd& Nodes in increasing order
+ * @param unsigned int Number of nodes
+ */
+void computeRadauNodes(Eigen::VectorXd& nodes,
+					   unsigned int num_nodes);
+
+/**
+ * @brief Computes the differentiation matrix of the Radau collocation, i.e. the derivatives
+ * of the Lagrange polynomials of the support points [-1, nodes] evaluated at the nodes.
+ * Its (N x N+1) entries D_ij define the derivative at the node i as sum_j D_ij * x_j, where
+ * x_0 is the value at the beginning of the phase
+ * @param Eigen::MatrixXd& Differentiation matrix
+ * @param const Eigen::VectorXd& Collocation nodes
+ */
+void computeRadauDifferentiationMatrix(Eigen::MatrixXd& diff_mat,
+									   const Eigen::VectorXd& nodes);
+
+} //@namespace math
+} //@namespace dwl
+
+#endif
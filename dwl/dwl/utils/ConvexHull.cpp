@@ -0,0 +1,242 @@
+#include <dwl/utils/ConvexHull.h>
+#include <algorithm>
+#include <limits>
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+/** @brief Cross product of the xy components of (b - a) and (c - a) */
+static double cross2d(const Eigen::Vector3d& a,
+					  const Eigen::Vector3d& b,
+					  const Eigen::Vector3d& c)
+{
+	return (b(X) - a(X)) * (c(Y) - a(Y)) - (b(Y) - a(Y)) * (c(X) - a(X));
+}
+
+
+/** @brief Lexicographic order of the xy components of the named points */
+static bool lessXY(const std::pair<std::string,Eigen::Vector3d>& a,
+				   const std::pair<std::string,Eigen::Vector3d>& b)
+{
+	if (a.second(X) != b.second(X))
+		return a.second(X) < b.second(X);
+
+	return a.second(Y) < b.second(Y);
+}
+
+
+ConvexHull::ConvexHull()
+{
+
+}
+
+
+ConvexHull::~ConvexHull()
+{
+
+}
+
+
+void ConvexHull::addPoint(const std::string& name,
+						  const Eigen::Vector3d& point)
+{
+	std::map<std::string,Eigen::Vector3d>::iterator point_it = points_.find(name);
+	if (point_it != points_.end()) {
+		if (point_it->second == point)
+			return;
+
+		removePoint(name);
+	}
+
+	points_[name] = point;
+	addToHull(name, point);
+}
+
+
+void ConvexHull::removePoint(const std::string& name)
+{
+	if (points_.erase(name) == 0)
+		return;
+
+	// Only the removal of a vertex changes the hull
+	if (std::find(vertex_names_.begin(), vertex_names_.end(), name) != vertex_names_.end())
+		rebuild();
+}
+
+
+void ConvexHull::setPoints(const std::map<std::string,Eigen::Vector3d>& points)
+{
+	// Removing the points that aren't in the new set
+	std::vector<std::string> removed;
+	for (std::map<std::string,Eigen::Vector3d>::const_iterator point_it = points_.begin();
+			point_it != points_.end(); point_it++) {
+		if (points.find(point_it->first) == points.end())
+			removed.push_back(point_it->first);
+	}
+	for (unsigned int i = 0; i < removed.size(); i++)
+		removePoint(removed[i]);
+
+	// Adding the new and moved points
+	for (std::map<std::string,Eigen::Vector3d>::const_iterator point_it = points.begin();
+			point_it != points.end(); point_it++)
+		addPoint(point_it->first, point_it->second);
+}
+
+
+void ConvexHull::clear()
+{
+	points_.clear();
+	vertexes_.clear();
+	vertex_names_.clear();
+	lines_.clear();
+}
+
+
+bool ConvexHull::computeMargin(double& margin,
+							   const Eigen::Vector3d& point) const
+{
+	if (vertexes_.size() == 0)
+		return false;
+
+	if (vertexes_.size() == 1) {
+		margin = -(point - vertexes_[0]).head<2>().norm();
+	} else if (vertexes_.size() == 2) {
+		const LineCoeff2d& line = lines_[0];
+		margin = -fabs(line.p * point(X) + line.q * point(Y) + line.r);
+	} else {
+		margin = std::numeric_limits<double>::max();
+		for (unsigned int i = 0; i < lines_.size(); i++) {
+			const LineCoeff2d& line = lines_[i];
+			margin = std::min(margin, line.p * point(X) + line.q * point(Y) + line.r);
+		}
+	}
+
+	return true;
+}
+
+
+const std::vector<Eigen::Vector3d>& ConvexHull::getVertexes() const
+{
+	return vertexes_;
+}
+
+
+unsigned int ConvexHull::getNumberOfPoints() const
+{
+	return points_.size();
+}
+
+
+void ConvexHull::rebuild()
+{
+	vertexes_.clear();
+	vertex_names_.clear();
+
+	// Sorting the points, and building the lower and upper chains, where the collinear
+	// points are removed
+	std::vector<std::pair<std::string,Eigen::Vector3d> > points(points_.begin(), points_.end());
+	std::sort(points.begin(), points.end(), lessXY);
+	unsigned int num_points = points.size();
+	std::vector<unsigned int> chain(2 * num_points);
+	unsigned int k = 0;
+	for (unsigned int i = 0; i < num_points; i++) {
+		while (k >= 2 &&
+				cross2d(points[chain[k - 2]].second, points[chain[k - 1]].second,
+						points[i].second) <= 0.)
+			k--;
+		chain[k++] = i;
+	}
+	for (int i = (int) num_points - 2, lower = k + 1; i >= 0; i--) {
+		while ((int) k >= lower &&
+				cross2d(points[chain[k - 2]].second, points[chain[k - 1]].second,
+						points[i].second) <= 0.)
+			k--;
+		chain[k++] = i;
+	}
+
+	// Removing the repeated first vertex, and the duplicated points
+	if (k > 1)
+		k--;
+	for (unsigned int i = 0; i < k; i++) {
+		const std::pair<std::string,Eigen::Vector3d>& point = points[chain[i]];
+		if (!vertexes_.empty() && point.second.head<2>() == vertexes_.back().head<2>())
+			continue;
+
+		vertexes_.push_back(point.second);
+		vertex_names_.push_back(point.first);
+	}
+	if (vertexes_.size() > 1 && vertexes_.front().head<2>() == vertexes_.back().head<2>()) {
+		vertexes_.pop_back();
+		vertex_names_.pop_back();
+	}
+
+	updateLines();
+}
+
+
+void ConvexHull::addToHull(const std::string& name,
+						   const Eigen::Vector3d& point)
+{
+	// The degenerated hulls are rebuilt, since they are cheap
+	unsigned int num_vertexes = vertexes_.size();
+	if (num_vertexes < 3) {
+		rebuild();
+		return;
+	}
+
+	// Searching the edges that are seen from the point, i.e. the point is on their right
+	std::vector<bool> visible(num_vertexes);
+	bool outside = false;
+	for (unsigned int i = 0; i < num_vertexes; i++) {
+		visible[i] = cross2d(vertexes_[i], vertexes_[(i + 1) % num_vertexes], point) < 0.;
+		outside = outside || visible[i];
+	}
+	if (!outside)
+		return;
+
+	// Replacing the visible chain of edges, which is contiguous for a convex hull, by the
+	// edges to the point
+	unsigned int first = 0, last = 0;
+	for (unsigned int i = 0; i < num_vertexes; i++) {
+		if (visible[i] && !visible[(i + num_vertexes - 1) % num_vertexes])
+			first = i;
+		if (visible[i] && !visible[(i + 1) % num_vertexes])
+			last = i;
+	}
+
+	std::vector<Eigen::Vector3d> vertexes;
+	std::vector<std::string> vertex_names;
+	for (unsigned int i = (last + 1) % num_vertexes; ; i = (i + 1) % num_vertexes) {
+		vertexes.push_back(vertexes_[i]);
+		vertex_names.push_back(vertex_names_[i]);
+		if (i == first)
+			break;
+	}
+	vertexes.push_back(point);
+	vertex_names.push_back(name);
+	vertexes_.swap(vertexes);
+	vertex_names_.swap(vertex_names);
+
+	updateLines();
+}
+
+
+void ConvexHull::updateLines()
+{
+	lines_.clear();
+	unsigned int num_vertexes = vertexes_.size();
+	if (num_vertexes < 2)
+		return;
+
+	// A segment has one line, and a polygon has one line per edge
+	unsigned int num_lines = (num_vertexes == 2) ? 1 : num_vertexes;
+	for (unsigned int i = 0; i < num_lines; i++)
+		lines_.push_back(lineCoeff(vertexes_[i], vertexes_[(i + 1) % num_vertexes]));
+}
+
+} //@namespace math
+} //@namespace dwl
@@ -0,0 +1,103 @@
+#ifndef DWL__MATH__CONVEX_HULL__H
+#define DWL__MATH__CONVEX_HULL__H
+
+#include <dwl/utils/Geometry.h>
+#include <map>
+#include <string>
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+/**
+ * @class ConvexHull
+ * @brief Incremental convex hull of a set of named points in the xy-plane, e.g. the contacts
+ * (or foot corners) of a support region. The hull is updated as the points are added or
+ * removed between phases: an added point only replaces the edges that it sees, and a removed
+ * point rebuilds the hull only if it was a vertex of it. The lines of the hull are cached, so
+ * the margin of a point (e.g. CoP or CoM) is a single pass over its edges without sorting
+ */
+class ConvexHull
+{
+	public:
+		/** @brief Constructor function */
+		ConvexHull();
+
+		/** @brief Destructor function */
+		~ConvexHull();
+
+		/**
+		 * @brief Adds a point, which moves the point of the same name if it exists
+		 * @param const std::string& Name of the point
+		 * @param const Eigen::Vector3d& Point, where only its xy components are used
+		 */
+		void addPoint(const std::string& name,
+					  const Eigen::Vector3d& point);
+
+		/**
+		 * @brief Removes a point
+		 * @param const std::string& Name of the point
+		 */
+		void removePoint(const std::string& name);
+
+		/**
+		 * @brief Sets the points, where only the added, removed and moved points update the
+		 * hull. So setting the same set (e.g. the support region inside a phase) is cheap
+		 * @param const std::map<std::string,Eigen::Vector3d>& Named points
+		 */
+		void setPoints(const std::map<std::string,Eigen::Vector3d>& points);
+
+		/** @brief Removes all the points */
+		void clear();
+
+		/**
+		 * @brief Computes the margin of a point, i.e. its distance to the closest edge of the
+		 * hull, which is positive inside. For a hull of one or two vertexes, the margin is the
+		 * negative distance to the vertex or the line
+		 * @param double& Margin of the point
+		 * @param const Eigen::Vector3d& Point, where only its xy components are used
+		 * @return bool False if there aren't points
+		 */
+		bool computeMargin(double& margin,
+						   const Eigen::Vector3d& point) const;
+
+		/** @brief Gets the vertexes of the hull in counter-clockwise order */
+		const std::vector<Eigen::Vector3d>& getVertexes() const;
+
+		/** @brief Gets the number of points, which includes the ones inside the hull */
+		unsigned int getNumberOfPoints() const;
+
+
+	private:
+		/** @brief Rebuilds the hull from all the points (monotone chain) */
+		void rebuild();
+
+		/**
+		 * @brief Adds a point to the hull, i.e. it replaces the edges seen from the point
+		 * @param const std::string& Name of the point
+		 * @param const Eigen::Vector3d& Point
+		 */
+		void addToHull(const std::string& name,
+					   const Eigen::Vector3d& point);
+
+		/** @brief Computes the normalized lines of the edges of the hull */
+		void updateLines();
+
+		/** @brief Named points */
+		std::map<std::string,Eigen::Vector3d> points_;
+
+		/** @brief Vertexes of the hull in counter-clockwise order, and their names */
+		std::vector<Eigen::Vector3d> vertexes_;
+		std::vector<std::string> vertex_names_;
+
+		/** @brief Lines of the edges of the hull, which are positive inside */
+		std::vector<LineCoeff2d> lines_;
+};
+
+} //@namespace math
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef DWL__UTILS__COPY_ON_WRITE__H
+#define DWL__UTILS__COPY_ON_WRITE__H
+
+#include <memory>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @class CopyOnWrite
+ * @brief Value that is shared by its copies until one of them is modified, i.e. copying it is a
+ * reference increment, and the first modification of a shared value clones it. So the copies
+ * are immutable snapshots that can be read from other threads while the original is modified
+ * by a single writer thread. Note that the value is cloned only if it's shared, which can be
+ * decided safely by the writer since only it can create new copies of its value
+ */
+template<typename T>
+class CopyOnWrite
+{
+	public:
+		/** @brief Constructor functions */
+		CopyOnWrite() : value_(std::make_shared<T>()) {}
+		explicit CopyOnWrite(const T& value) : value_(std::make_shared<T>(value)) {}
+
+		/** @brief Gets the value for reading it */
+		const T& read() const {
+			return *value_;
+		}
+
+		/** @brief Gets the value for modifying it, where it's cloned if it's shared */
+		T& write() {
+			if (value_.use_count() > 1)
+				value_ = std::make_shared<T>(*value_);
+			return *value_;
+		}
+
+		/** @brief Replaces the value by a default one, without cloning the shared one */
+		void reset() {
+			value_ = std::make_shared<T>();
+		}
+
+		/** @brief Indicates if the value is shared with other copies */
+		bool isShared() const {
+			return value_.use_count() > 1;
+		}
+
+
+	private:
+		/** @brief Shared value */
+		std::shared_ptr<T> value_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
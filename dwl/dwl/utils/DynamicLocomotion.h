@@ -71,6 +71,25 @@ struct SearchArea
 /** @brief Defines a search area map */
 typedef std::map<unsigned int, SearchArea> SearchAreaMap;
 
+/**
+ * @brief Struct that defines the cells and corners of a set of search areas, which are stacked
+ * per area in the order of their ids
+ */
+struct SearchAreaCells
+{
+	/** @brief Ids of the search areas */
+	std::vector<unsigned int> ids;
+
+	/** @brief Positions of the cells, i.e. the points of the grid of every area */
+	Eigen::Matrix2Xd points;
+
+	/** @brief Number of cells of every area */
+	std::vector<unsigned int> sizes;
+
+	/** @brief Corners of every area, i.e. four columns per area */
+	Eigen::Matrix2Xd corners;
+};
+
 /**
  * @struct NeighboringArea
  * @brief Struct that defines the neighboring area
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 #include <Eigen/Dense>
 #include <dwl/utils/GraphSearching.h>
 
@@ -30,6 +31,40 @@ struct Key
 	unsigned short int z;
 };
 
+/** @brief Struct that defines a rectangular region of cells using their (x,y) keys */
+struct CellRegion
+{
+	CellRegion() : min_key(), max_key(), empty(true) {}
+
+	/** @brief Expands the region for containing the key */
+	void add(const Key& key) {
+		if (empty) {
+			min_key = key;
+			max_key = key;
+			empty = false;
+		} else {
+			if (key.x < min_key.x)
+				min_key.x = key.x;
+			if (key.y < min_key.y)
+				min_key.y = key.y;
+			if (key.x > max_key.x)
+				max_key.x = key.x;
+			if (key.y > max_key.y)
+				max_key.y = key.y;
+		}
+	}
+
+	/** @brief Indicates if the key is inside the region */
+	bool contains(const Key& key) const {
+		return !empty && key.x >= min_key.x && key.x <= max_key.x &&
+				key.y >= min_key.y && key.y <= max_key.y;
+	}
+
+	Key min_key;
+	Key max_key;
+	bool empty;
+};
+
 /** @brief Struct that defines the information of the cell */
 struct Cell
 {
@@ -35,7 +35,7 @@ Eigen::Vector3d FrameTF::fromWorldToBaseFrame(const Eigen::Vector3d& vec_W,
 
 Eigen::Matrix3d FrameTF::getWorldToBaseRotation(const Eigen::Vector3d& rpy) const
 {
-	return math::getQuaternion(rpy).inverse().toRotationMatrix();
+	return math::getRotationMatrix(rpy).transpose();
 }
 
 
@@ -71,7 +71,7 @@ Eigen::Matrix3d FrameTF::getWorldToHorizontalRotation(const Eigen::Quaterniond&
 {
 	// Note that the rotation matrix is an orthogonal matrix, that is the
 	// inverse can computed as transpose. This improve the computation time
-	return getRotHorizontalToWorld(math::getRPY(q)).transpose();
+	return math::getYawRotationMatrix(math::getYaw(q)).transpose();
 }
 
 
@@ -91,7 +91,7 @@ Eigen::Vector3d FrameTF::fromBaseToWorldFrame(const Eigen::Vector3d& vec_B,
 
 Eigen::Matrix3d FrameTF::getBaseToWorldRotation(const Eigen::Vector3d& rpy) const
 {
-	return math::getQuaternion(rpy).toRotationMatrix();
+	return math::getRotationMatrix(rpy);
 }
 
 
@@ -123,7 +123,8 @@ Eigen::Matrix3d FrameTF::getBaseToHorizontalRotation(const Eigen::Vector3d& rpy)
 
 Eigen::Matrix3d FrameTF::getBaseToHorizontalRotation(const Eigen::Quaterniond& q) const
 {
-	return getRotBaseToHorizontal(math::getRPY(q));
+	// Removing the yaw rotation from the base rotation, which avoids the RPY angles
+	return math::getYawRotationMatrix(math::getYaw(q)).transpose() * q.toRotationMatrix();
 }
 
 
@@ -149,7 +150,7 @@ Eigen::Matrix3d FrameTF::getHorizontalToWorldRotation(const Eigen::Vector3d& rpy
 
 Eigen::Matrix3d FrameTF::getHorizontalToWorldRotation(const Eigen::Quaterniond& q) const
 {
-	return getRotHorizontalToWorld(math::getRPY(q));
+	return math::getYawRotationMatrix(math::getYaw(q));
 }
 
 
@@ -178,7 +179,167 @@ Eigen::Matrix3d FrameTF::getHorizontalToBaseRotation(const Eigen::Quaterniond& q
 {
 	// Note that the rotation matrix is an orthogonal matrix, that is the
 	// inverse can computed as transpose. This improve the computation time
-	return getRotBaseToHorizontal(math::getRPY(q)).transpose();
+	return getBaseToHorizontalRotation(q).transpose();
+}
+
+
+void FrameTF::fromWorldToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+								   const Eigen::Matrix3Xd& vecs_W,
+								   const Eigen::Vector3d& rpy) const
+{
+	rotate(vecs_B, getWorldToBaseRotation(rpy), vecs_W);
+}
+
+
+void FrameTF::fromWorldToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+								   const Eigen::Matrix3Xd& vecs_W,
+								   const Eigen::Quaterniond& q) const
+{
+	rotate(vecs_B, getWorldToBaseRotation(q), vecs_W);
+}
+
+
+void FrameTF::fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										 const Eigen::Matrix3Xd& vecs_W,
+										 const Eigen::Vector3d& rpy) const
+{
+	rotate(vecs_H, getWorldToHorizontalRotation(rpy), vecs_W);
+}
+
+
+void FrameTF::fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										 const Eigen::Matrix3Xd& vecs_W,
+										 const Eigen::Quaterniond& q) const
+{
+	rotate(vecs_H, getWorldToHorizontalRotation(q), vecs_W);
+}
+
+
+void FrameTF::fromBaseToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+								   const Eigen::Matrix3Xd& vecs_B,
+								   const Eigen::Vector3d& rpy) const
+{
+	rotate(vecs_W, getBaseToWorldRotation(rpy), vecs_B);
+}
+
+
+void FrameTF::fromBaseToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+								   const Eigen::Matrix3Xd& vecs_B,
+								   const Eigen::Quaterniond& q) const
+{
+	rotate(vecs_W, getBaseToWorldRotation(q), vecs_B);
+}
+
+
+void FrameTF::fromBaseToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Matrix3Xd& vecs_B,
+										const Eigen::Vector3d& rpy) const
+{
+	rotate(vecs_H, getBaseToHorizontalRotation(rpy), vecs_B);
+}
+
+
+void FrameTF::fromBaseToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Matrix3Xd& vecs_B,
+										const Eigen::Quaterniond& q) const
+{
+	rotate(vecs_H, getBaseToHorizontalRotation(q), vecs_B);
+}
+
+
+void FrameTF::fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										 const Eigen::Matrix3Xd& vecs_H,
+										 const Eigen::Vector3d& rpy) const
+{
+	rotate(vecs_W, getHorizontalToWorldRotation(rpy), vecs_H);
+}
+
+
+void FrameTF::fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										 const Eigen::Matrix3Xd& vecs_H,
+										 const Eigen::Quaterniond& q) const
+{
+	rotate(vecs_W, getHorizontalToWorldRotation(q), vecs_H);
+}
+
+
+void FrameTF::fromHorizontalToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+										const Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Vector3d& rpy) const
+{
+	rotate(vecs_B, getHorizontalToBaseRotation(rpy), vecs_H);
+}
+
+
+void FrameTF::fromHorizontalToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+										const Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Quaterniond& q) const
+{
+	rotate(vecs_B, getHorizontalToBaseRotation(q), vecs_H);
+}
+
+
+void FrameTF::fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										 const Eigen::Matrix3Xd& vecs_W,
+										 double yaw) const
+{
+	rotate<double>(vecs_H, math::getYawRotationMatrix(yaw).transpose(), vecs_W);
+}
+
+
+void FrameTF::fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										 const Eigen::Matrix3Xd& vecs_H,
+										 double yaw) const
+{
+	rotate(vecs_W, math::getYawRotationMatrix(yaw), vecs_H);
+}
+
+
+void FrameTF::fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										 const Eigen::Matrix3Xd& vecs_W,
+										 const Eigen::VectorXd& yaws) const
+{
+	rotateYaws(vecs_H, vecs_W, yaws, -1.);
+}
+
+
+void FrameTF::fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										 const Eigen::Matrix3Xd& vecs_H,
+										 const Eigen::VectorXd& yaws) const
+{
+	rotateYaws(vecs_W, vecs_H, yaws, 1.);
+}
+
+
+void FrameTF::fromWorldToBaseFrame(Eigen::Matrix3Xf& vecs_B,
+								   const Eigen::Matrix3Xf& vecs_W,
+								   const Eigen::Quaternionf& q) const
+{
+	rotate(vecs_B, (Eigen::Matrix3f) q.inverse().toRotationMatrix(), vecs_W);
+}
+
+
+void FrameTF::fromBaseToWorldFrame(Eigen::Matrix3Xf& vecs_W,
+								   const Eigen::Matrix3Xf& vecs_B,
+								   const Eigen::Quaternionf& q) const
+{
+	rotate(vecs_W, math::getRotationMatrix(q), vecs_B);
+}
+
+
+void FrameTF::fromWorldToHorizontalFrame(Eigen::Matrix3Xf& vecs_H,
+										 const Eigen::Matrix3Xf& vecs_W,
+										 const Eigen::VectorXf& yaws) const
+{
+	rotateYaws(vecs_H, vecs_W, yaws, -1.f);
+}
+
+
+void FrameTF::fromHorizontalToWorldFrame(Eigen::Matrix3Xf& vecs_W,
+										 const Eigen::Matrix3Xf& vecs_H,
+										 const Eigen::VectorXf& yaws) const
+{
+	rotateYaws(vecs_W, vecs_H, yaws, 1.f);
 }
 
 
@@ -92,6 +92,112 @@ class FrameTF
 		Eigen::Matrix3d getHorizontalToBaseRotation(const Eigen::Quaterniond& q) const;
 
 
+		/** @brief Transforms the defined vectors (columns) in the world into the
+		 * base frame given the orientation of the body: RPY angles or quaternion.
+		 * The rotation is computed once and applied to all the vectors */
+		void fromWorldToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+								  const Eigen::Matrix3Xd& vecs_W,
+								  const Eigen::Vector3d& rpy) const;
+		void fromWorldToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+								  const Eigen::Matrix3Xd& vecs_W,
+								  const Eigen::Quaterniond& q) const;
+
+		/** @brief Transforms the defined vectors (columns) in the world into the
+		 * horizontal frame given the orientation of the body: RPY angles or quaternion.
+		 * The rotation is computed once and applied to all the vectors */
+		void fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Matrix3Xd& vecs_W,
+										const Eigen::Vector3d& rpy) const;
+		void fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Matrix3Xd& vecs_W,
+										const Eigen::Quaterniond& q) const;
+
+		/** @brief Transforms the defined vectors (columns) in the base into the
+		 * world frame given the orientation of the body: RPY angles or quaternion.
+		 * The rotation is computed once and applied to all the vectors */
+		void fromBaseToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+								  const Eigen::Matrix3Xd& vecs_B,
+								  const Eigen::Vector3d& rpy) const;
+		void fromBaseToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+								  const Eigen::Matrix3Xd& vecs_B,
+								  const Eigen::Quaterniond& q) const;
+
+		/** @brief Transforms the defined vectors (columns) in the base into the
+		 * horizontal frame given the orientation of the body: RPY angles or quaternion.
+		 * The rotation is computed once and applied to all the vectors */
+		void fromBaseToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+									   const Eigen::Matrix3Xd& vecs_B,
+									   const Eigen::Vector3d& rpy) const;
+		void fromBaseToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+									   const Eigen::Matrix3Xd& vecs_B,
+									   const Eigen::Quaterniond& q) const;
+
+		/** @brief Transforms the defined vectors (columns) in the horizontal into the
+		 * world frame given the orientation of the body: RPY angles or quaternion.
+		 * The rotation is computed once and applied to all the vectors */
+		void fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										const Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Vector3d& rpy) const;
+		void fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										const Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Quaterniond& q) const;
+
+		/** @brief Transforms the defined vectors (columns) in the horizontal into the
+		 * base frame given the orientation of the body: RPY angles or quaternion.
+		 * The rotation is computed once and applied to all the vectors */
+		void fromHorizontalToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+									   const Eigen::Matrix3Xd& vecs_H,
+									   const Eigen::Vector3d& rpy) const;
+		void fromHorizontalToBaseFrame(Eigen::Matrix3Xd& vecs_B,
+									   const Eigen::Matrix3Xd& vecs_H,
+									   const Eigen::Quaterniond& q) const;
+
+		/** @brief Transforms the defined vectors (columns) in the world into the horizontal
+		 * frame given only the yaw angle, which is the only angle that defines the
+		 * horizontal frame */
+		void fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Matrix3Xd& vecs_W,
+										double yaw) const;
+
+		/** @brief Transforms the defined vectors (columns) in the horizontal into the world
+		 * frame given only the yaw angle, which is the only angle that defines the
+		 * horizontal frame */
+		void fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										const Eigen::Matrix3Xd& vecs_H,
+										double yaw) const;
+
+		/** @brief Transforms the defined vectors (columns) in the world into the horizontal
+		 * frame given a yaw angle per vector, e.g. for the samples of a trajectory.
+		 * Note that the rotation matrices aren't built */
+		void fromWorldToHorizontalFrame(Eigen::Matrix3Xd& vecs_H,
+										const Eigen::Matrix3Xd& vecs_W,
+										const Eigen::VectorXd& yaws) const;
+
+		/** @brief Transforms the defined vectors (columns) in the horizontal into the world
+		 * frame given a yaw angle per vector, e.g. for the samples of a trajectory.
+		 * Note that the rotation matrices aren't built */
+		void fromHorizontalToWorldFrame(Eigen::Matrix3Xd& vecs_W,
+										const Eigen::Matrix3Xd& vecs_H,
+										const Eigen::VectorXd& yaws) const;
+
+
+		/** @brief Transforms the defined vectors (columns) in single precision, e.g. for
+		 * screening the samples of a planner before refining them in double precision. The
+		 * world-base transforms are given by the quaternion of the body, and the
+		 * world-horizontal ones by a yaw angle per vector */
+		void fromWorldToBaseFrame(Eigen::Matrix3Xf& vecs_B,
+								  const Eigen::Matrix3Xf& vecs_W,
+								  const Eigen::Quaternionf& q) const;
+		void fromBaseToWorldFrame(Eigen::Matrix3Xf& vecs_W,
+								  const Eigen::Matrix3Xf& vecs_B,
+								  const Eigen::Quaternionf& q) const;
+		void fromWorldToHorizontalFrame(Eigen::Matrix3Xf& vecs_H,
+										const Eigen::Matrix3Xf& vecs_W,
+										const Eigen::VectorXf& yaws) const;
+		void fromHorizontalToWorldFrame(Eigen::Matrix3Xf& vecs_W,
+										const Eigen::Matrix3Xf& vecs_H,
+										const Eigen::VectorXf& yaws) const;
+
 		/** @brief Maps the defined vector in the world frame into the base
 		 * frame given the orientation of the body: RPY angles or quaternion */
 		Eigen::Vector3d mapWorldToBaseFrame(const Eigen::Vector3d& vec_W,
@@ -136,22 +242,37 @@ class FrameTF
 
 
 	private:
+		/** @brief Rotates the vectors (columns), which could be the same matrix */
+		template <typename Scalar>
+		void rotate(Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_out,
+					const Eigen::Matrix<Scalar,3,3>& rotation_mtx,
+					const Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_in) const;
+
+		/** @brief Rotates every vector (column) around the z axis by its yaw angle, where the
+		 * sign is -1 for the inverse rotation. The vectors could be the same matrix */
+		template <typename Scalar>
+		void rotateYaws(Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_out,
+						const Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_in,
+						const Eigen::Matrix<Scalar,Eigen::Dynamic,1>& yaws,
+						Scalar sign) const;
+
 		/** @brief Computes the rotation matrix from world to horizontal frame */
 		Eigen::Matrix3d inline getRotHorizontalToWorld(const Eigen::Vector3d& rpy) const {
 			// Note that the roll and pitch components are zero w.r.t. the
 			// world frame
-			Eigen::Vector3d rpy_H(0., 0., rpy(2));
-			return math::getRotationMatrix(rpy_H);
+			return math::getYawRotationMatrix(rpy(2));
 		}
 
 		/** @brief Computes the rotation matrix from world to horizontal frame */
 		Eigen::Matrix3d inline getRotBaseToHorizontal(const Eigen::Vector3d& rpy) const {
 			// Note that the yaw component is zero w.r.t. the base frame
+			double cr = cos(rpy(0)), sr = sin(rpy(0));
+			double cp = cos(rpy(1)), sp = sin(rpy(1));
 			Eigen::Matrix3d R;
 
-			R <<  cos(rpy(1)),  sin(rpy(0))*sin(rpy(1)),  cos(rpy(0))*sin(rpy(1)),
-					       0.,              cos(rpy(0)),             -sin(rpy(0)),
-				 -sin(rpy(1)),  sin(rpy(0))*cos(rpy(1)),  cos(rpy(0))*cos(rpy(1));
+			R <<  cp,  sr*sp,  cr*sp,
+				  0.,     cr,    -sr,
+				 -sp,  sr*cp,  cr*cp;
 
 			return R;
 		}
@@ -160,4 +281,6 @@ class FrameTF
 } //@namespace math
 } //@namespace dwl
 
+#include <dwl/utils/impl/FrameTF.hpp>
+
 #endif
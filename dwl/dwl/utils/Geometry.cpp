@@ -125,6 +125,123 @@ unsigned int computeMeanAndCovarianceMatrix(Eigen::Vector3d& mean,
 }
 
 
+void computePlaneParameters(Eigen::Matrix3Xd& normals,
+							Eigen::ArrayXXd& curvatures,
+							const Eigen::ArrayXXd& height,
+							double resolution,
+							unsigned int radius)
+{
+	unsigned int rows = height.rows(), cols = height.cols();
+	normals.resize(3, rows * cols);
+	curvatures.setZero(rows, cols);
+	if (rows == 0 || cols == 0)
+		return;
+
+	// Getting the mean height of the known cells, which is removed for reducing the cancellation
+	// errors of the summed-area tables
+	double height_sum = 0.;
+	unsigned int num_known = 0;
+	for (unsigned int i = 0; i < height.size(); i++) {
+		if (std::isfinite(height(i))) {
+			height_sum += height(i);
+			num_known++;
+		}
+	}
+	double height_offset = num_known != 0 ? height_sum / num_known : 0.;
+
+	// Computing the points of the grid, which is padded with unknown cells for the borders.
+	// Note that the coordinates of the unknown cells are zero, so they don't contribute
+	unsigned int padded_rows = rows + 2 * radius, padded_cols = cols + 2 * radius;
+	Eigen::ArrayXXd known = Eigen::ArrayXXd::Zero(padded_rows, padded_cols);
+	Eigen::ArrayXXd x = known, y = known, z = known;
+	for (unsigned int j = 0; j < cols; j++) {
+		for (unsigned int i = 0; i < rows; i++) {
+			if (!std::isfinite(height(i, j)))
+				continue;
+
+			known(i + radius, j + radius) = 1.;
+			x(i + radius, j + radius) = i * resolution;
+			y(i + radius, j + radius) = j * resolution;
+			z(i + radius, j + radius) = height(i, j) - height_offset;
+		}
+	}
+
+	// Computing the moments of every neighborhood, i.e. the number of points, the sums of the
+	// coordinates and the sums of their products
+	enum Moments {N = 0, SX, SY, SZ, SXX, SXY, SXZ, SYY, SYZ, SZZ, NUM_MOMENTS};
+	Eigen::ArrayXXd products[NUM_MOMENTS], moments[NUM_MOMENTS], table;
+	products[N] = known;
+	products[SX] = x;
+	products[SY] = y;
+	products[SZ] = z;
+	products[SXX] = x * x;
+	products[SXY] = x * y;
+	products[SXZ] = x * z;
+	products[SYY] = y * y;
+	products[SYZ] = y * z;
+	products[SZZ] = z * z;
+	for (unsigned int m = 0; m < NUM_MOMENTS; m++) {
+		computeSummedArea(table, products[m]);
+		computeWindowSums(moments[m], table, 2 * radius + 1);
+	}
+
+	// Solving the plane of every neighborhood from its covariance
+	for (unsigned int j = 0; j < cols; j++) {
+		for (unsigned int i = 0; i < rows; i++) {
+			unsigned int index = i + j * rows;
+			double num_points = moments[N](i, j);
+			if (num_points < 3) {
+				normals.col(index) = Eigen::Vector3d::UnitZ();
+				continue;
+			}
+
+			Eigen::Vector3d mean(moments[SX](i, j), moments[SY](i, j), moments[SZ](i, j));
+			mean /= num_points;
+			Eigen::Matrix3d covariance;
+			covariance << moments[SXX](i, j), moments[SXY](i, j), moments[SXZ](i, j),
+					moments[SXY](i, j), moments[SYY](i, j), moments[SYZ](i, j),
+					moments[SXZ](i, j), moments[SYZ](i, j), moments[SZZ](i, j);
+			covariance = covariance / num_points - mean * mean.transpose();
+
+			Eigen::Vector3d normal;
+			double curvature;
+			solvePlaneParameters(normal, curvature, covariance);
+			normals.col(index) = normal;
+			curvatures(i, j) = curvature;
+		}
+	}
+}
+
+
+void computeSummedArea(Eigen::ArrayXXd& table,
+					   const Eigen::ArrayXXd& array)
+{
+	// Accumulating along the columns, i.e. whole contiguous columns per operation, and then
+	// along the rows
+	table.setZero(array.rows() + 1, array.cols() + 1);
+	table.block(1, 1, array.rows(), array.cols()) = array;
+	for (unsigned int j = 1; j < table.cols(); j++)
+		table.col(j) += table.col(j - 1);
+	for (unsigned int i = 1; i < table.rows(); i++)
+		table.row(i) += table.row(i - 1);
+}
+
+
+void computeWindowSums(Eigen::ArrayXXd& sums,
+					   const Eigen::ArrayXXd& table,
+					   unsigned int window)
+{
+	if (table.rows() <= window || table.cols() <= window) {
+		sums.resize(0, 0);
+		return;
+	}
+
+	unsigned int rows = table.rows() - window, cols = table.cols() - window;
+	sums = table.block(window, window, rows, cols) - table.block(0, window, rows, cols) -
+			table.block(window, 0, rows, cols) + table.block(0, 0, rows, cols);
+}
+
+
 void solvePlaneParameters(Eigen::Vector3d &normal_vector,
 						  double &curvature,
 						  const Eigen::Matrix3d covariance_matrix)
@@ -230,11 +347,11 @@ void computeRoots(Eigen::Vector3d& roots,
 		double roots0 = roots(0);
 		double roots1 = roots(1);
 		double roots2 = roots(2);
-		if (roots(0) >= roots(1))
+		if (roots0 >= roots1)
 			std::swap(roots0, roots1);
-		if (roots(1) >= roots(2)) {
+		if (roots1 >= roots2) {
 			std::swap(roots1, roots2);
-			if (roots(0) >= roots(1))
+			if (roots0 >= roots1)
 				std::swap(roots0, roots1);
 		}
 		roots(0) = roots0;
@@ -82,6 +82,44 @@ unsigned int computeMeanAndCovarianceMatrix(Eigen::Vector3d& mean,
 											Eigen::Matrix3d& covariance_matrix,
 											const std::vector<Eigen::Vector3f>& cloud);
 
+/**
+ * @brief Computes the plane parameters (normal vector and curvature) of the neighborhood of
+ * every cell of a height grid in a single sweep. The moments of the points (x, y, z and their
+ * products) are accumulated in summed-area tables, so the covariance of every neighborhood is
+ * computed in constant time regardless of its size. The unknown cells (NaN) are skipped, and
+ * the cells with less of 3 known neighbors have a vertical normal and zero curvature
+ * @param Eigen::Matrix3Xd& Normal vectors, where the column x + y * rows is the (x,y) cell
+ * @param Eigen::ArrayXXd& Curvatures of the cells
+ * @param const Eigen::ArrayXXd& Heights of the cells, indexed as (x,y)
+ * @param double Resolution of the grid
+ * @param unsigned int Radius of the neighborhood in cells
+ */
+void computePlaneParameters(Eigen::Matrix3Xd& normals,
+							Eigen::ArrayXXd& curvatures,
+							const Eigen::ArrayXXd& height,
+							double resolution,
+							unsigned int radius);
+
+/**
+ * @brief Computes the summed-area table of an array, i.e. the sum of every upper-left block,
+ * with an additional zero row and column
+ * @param Eigen::ArrayXXd& Summed-area table
+ * @param const Eigen::ArrayXXd& Array
+ */
+void computeSummedArea(Eigen::ArrayXXd& table,
+					   const Eigen::ArrayXXd& array);
+
+/**
+ * @brief Computes the sums of every square window that is fully inside an array from its
+ * summed-area table, i.e. four lookups per window
+ * @param Eigen::ArrayXXd& Window sums, where (i,j) is the window with (i,j) as first cell
+ * @param const Eigen::ArrayXXd& Summed-area table of the array
+ * @param unsigned int Size of the window
+ */
+void computeWindowSums(Eigen::ArrayXXd& sums,
+					   const Eigen::ArrayXXd& table,
+					   unsigned int window);
+
 /**
  * @brief Solves the plane parameters
  * @param Eigen::Vector3d& Normal vector of the plane
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <list>
+#include <dwl/utils/MemoryPool.h>
 
 
 namespace dwl
@@ -44,8 +45,14 @@ struct Edge
 	Weight weight;
 };
 
+/**
+ * @brief Defines a list of edges for graph-searching algorithms, whose nodes can be allocated
+ * from the memory pool of a search query
+ */
+typedef std::list<Edge, utils::PoolAllocator<Edge> > EdgeList;
+
 /** Defines an adjacency map for graph-searching algorithms */
-typedef std::map<Vertex, std::list<Edge> > AdjacencyMap;
+typedef std::map<Vertex, EdgeList> AdjacencyMap;
 
 
 } //@namespace dwl
@@ -0,0 +1,212 @@
+#ifndef DWL__INDEXED_HEAP__H
+#define DWL__INDEXED_HEAP__H
+
+#include <dwl/utils/VertexTable.h>
+#include <algorithm>
+#include <limits>
+
+
+namespace dwl
+{
+
+/**
+ * @class IndexedHeap
+ * @brief IndexedHeap is a d-ary min-heap of vertices ordered by their priority (e.g. the f cost
+ * of A*). The heap position of every vertex is indexed by a vertex table, so the priority of a
+ * queued vertex is changed in place (decrease-key) instead of erasing and inserting nodes. The
+ * ties are broken by the vertex id in order to have a deterministic expansion order. The priority
+ * type only requires operator< (e.g. std::pair for the lexicographic keys of D* Lite)
+ */
+template<unsigned int D = 4, typename TPriority = Weight>
+class IndexedHeap
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param Vertex Number of dense vertices of the position table
+		 */
+		IndexedHeap(Vertex num_dense_vertices = 0) : positions_(NPOS, num_dense_vertices) {}
+
+		/** @brief Destructor function */
+		~IndexedHeap() {}
+
+		/**
+		 * @brief Resets the heap, and allocates the position table
+		 * @param Vertex Number of dense vertices of the position table
+		 */
+		void reset(Vertex num_dense_vertices) {
+			nodes_.clear();
+			positions_.reset(NPOS, num_dense_vertices);
+		}
+
+		/**
+		 * @brief Pushes a vertex, or changes its priority if it's already in the heap
+		 * @param Vertex Vertex id
+		 * @param const TPriority& Priority of the vertex
+		 */
+		void push(Vertex vertex, const TPriority& priority) {
+			unsigned int& position = positions_[vertex];
+			if (position == NPOS) {
+				position = nodes_.size();
+				nodes_.push_back(Node(priority, vertex));
+				siftUp(position);
+			} else {
+				TPriority old_priority = nodes_[position].priority;
+				nodes_[position].priority = priority;
+				if (priority < old_priority)
+					siftUp(position);
+				else
+					siftDown(position);
+			}
+		}
+
+		/** @brief Pops the vertex with the minimum priority */
+		void pop() {
+			positions_.erase(nodes_[0].vertex);
+			if (nodes_.size() > 1) {
+				nodes_[0] = nodes_.back();
+				positions_[nodes_[0].vertex] = 0;
+				nodes_.pop_back();
+				siftDown(0);
+			} else
+				nodes_.pop_back();
+		}
+
+		/**
+		 * @brief Erases a vertex if it's in the heap
+		 * @param Vertex Vertex id
+		 */
+		void erase(Vertex vertex) {
+			const unsigned int* position = positions_.find(vertex);
+			if (position == NULL)
+				return;
+
+			unsigned int erased_position = *position;
+			positions_.erase(vertex);
+			if (erased_position + 1 == nodes_.size()) {
+				nodes_.pop_back();
+				return;
+			}
+
+			// Moving the last node to the erased position
+			Vertex moved_vertex = nodes_.back().vertex;
+			nodes_[erased_position] = nodes_.back();
+			nodes_.pop_back();
+			positions_[moved_vertex] = erased_position;
+			siftUp(erased_position);
+			siftDown(positions_.get(moved_vertex));
+		}
+
+		/** @brief Gets the vertex with the minimum priority */
+		Vertex top() const {
+			return nodes_[0].vertex;
+		}
+
+		/** @brief Gets the minimum priority */
+		const TPriority& topPriority() const {
+			return nodes_[0].priority;
+		}
+
+		/**
+		 * @brief Indicates if the vertex is in the heap
+		 * @param Vertex Vertex id
+		 */
+		bool contains(Vertex vertex) const {
+			return positions_.count(vertex) != 0;
+		}
+
+		/** @brief Indicates if the heap is empty */
+		bool empty() const {
+			return nodes_.empty();
+		}
+
+		/** @brief Gets the number of vertices in the heap */
+		unsigned int size() const {
+			return nodes_.size();
+		}
+
+		/** @brief Clears the heap */
+		void clear() {
+			nodes_.clear();
+			positions_.clear();
+		}
+
+		/** @brief Gets the heap bytes of the nodes and of the positions of the vertices */
+		std::size_t getHeapBytes() const {
+			return utils::getHeapBytes(nodes_) + positions_.getHeapBytes();
+		}
+
+
+	private:
+		/** @brief Heap node */
+		struct Node
+		{
+			Node(const TPriority& priority, Vertex vertex) : priority(priority), vertex(vertex) {}
+
+			bool operator<(const Node& other) const {
+				return (priority < other.priority) ||
+						(!(other.priority < priority) && vertex < other.vertex);
+			}
+
+			TPriority priority;
+			Vertex vertex;
+		};
+
+		/** @brief Moves up a node until the heap property is satisfied */
+		void siftUp(unsigned int position) {
+			Node node = nodes_[position];
+			while (position > 0) {
+				unsigned int parent = (position - 1) / D;
+				if (!(node < nodes_[parent]))
+					break;
+				nodes_[position] = nodes_[parent];
+				positions_[nodes_[position].vertex] = position;
+				position = parent;
+			}
+			nodes_[position] = node;
+			positions_[node.vertex] = position;
+		}
+
+		/** @brief Moves down a node until the heap property is satisfied */
+		void siftDown(unsigned int position) {
+			Node node = nodes_[position];
+			unsigned int num_nodes = nodes_.size();
+			while (true) {
+				unsigned int first_child = D * position + 1;
+				if (first_child >= num_nodes)
+					break;
+
+				// Finding the child with the minimum priority
+				unsigned int min_child = first_child;
+				unsigned int last_child = std::min(first_child + D, num_nodes);
+				for (unsigned int child = first_child + 1; child < last_child; child++) {
+					if (nodes_[child] < nodes_[min_child])
+						min_child = child;
+				}
+				if (!(nodes_[min_child] < node))
+					break;
+
+				nodes_[position] = nodes_[min_child];
+				positions_[nodes_[position].vertex] = position;
+				position = min_child;
+			}
+			nodes_[position] = node;
+			positions_[node.vertex] = position;
+		}
+
+		/** @brief Position of the vertices that aren't in the heap */
+		static const unsigned int NPOS = std::numeric_limits<unsigned int>::max();
+
+		/** @brief Heap nodes */
+		std::vector<Node> nodes_;
+
+		/** @brief Heap position of every vertex */
+		VertexTable<unsigned int> positions_;
+};
+
+template<unsigned int D, typename TPriority>
+const unsigned int IndexedHeap<D, TPriority>::NPOS;
+
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,186 @@
+#include <dwl/utils/Instrumentation.h>
+#include <dwl/utils/Macros.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+struct Instrumentation::Registry
+{
+	Registry() : num_probes(0) {}
+
+	std::mutex mutex;
+	std::map<std::string, unsigned int> probe_ids;
+	std::string names[Instrumentation::MaxProbes];
+	ProbeType types[Instrumentation::MaxProbes];
+	std::atomic<unsigned int> num_probes;
+	std::vector<ThreadBuffer*> buffers;
+	std::vector<ThreadBuffer*> free_buffers;
+};
+
+
+Instrumentation::Registry& Instrumentation::getRegistry()
+{
+	// The registry is constructed in its first use from any translation unit, and it's never
+	// destroyed, so the thread buffers can be returned during the exit of the process
+	static Registry* registry = new Registry();
+	return *registry;
+}
+
+
+unsigned int Instrumentation::registerProbe(const std::string& name,
+											ProbeType type)
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	std::map<std::string, unsigned int>::iterator probe_it = registry.probe_ids.find(name);
+	if (probe_it != registry.probe_ids.end())
+		return probe_it->second;
+
+	unsigned int probe = registry.num_probes.load(std::memory_order_relaxed);
+	if (probe >= MaxProbes) {
+		printf(YELLOW "Warning: the %s probe was not registered because there are %u probes\n"
+				COLOR_RESET, name.c_str(), MaxProbes);
+		return MaxProbes;
+	}
+
+	registry.names[probe] = name;
+	registry.types[probe] = type;
+	registry.probe_ids[name] = probe;
+	registry.num_probes.store(probe + 1, std::memory_order_release);
+
+	return probe;
+}
+
+
+void Instrumentation::record(unsigned int probe,
+							 unsigned long count,
+							 unsigned long elapsed_ns)
+{
+	if (probe >= MaxProbes)
+		return;
+
+	// There is a single writer per buffer, so the values are updated without read-modify-write
+	// operations
+	ThreadBuffer& buffer = getThreadBuffer();
+	buffer.count[probe].store(buffer.count[probe].load(std::memory_order_relaxed) + count,
+							  std::memory_order_relaxed);
+	if (elapsed_ns != 0) {
+		buffer.total_ns[probe].store(
+				buffer.total_ns[probe].load(std::memory_order_relaxed) + elapsed_ns,
+				std::memory_order_relaxed);
+		if (elapsed_ns > buffer.max_ns[probe].load(std::memory_order_relaxed))
+			buffer.max_ns[probe].store(elapsed_ns, std::memory_order_relaxed);
+	}
+}
+
+
+void Instrumentation::getStatistics(std::vector<ProbeStatistics>& statistics)
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	unsigned int num_probes = registry.num_probes.load(std::memory_order_acquire);
+	statistics.assign(num_probes, ProbeStatistics());
+	for (unsigned int i = 0; i < num_probes; i++) {
+		statistics[i].name = registry.names[i];
+		statistics[i].type = registry.types[i];
+	}
+
+	// Summing up the records of all the buffers
+	for (unsigned int b = 0; b < registry.buffers.size(); b++) {
+		ThreadBuffer* buffer = registry.buffers[b];
+		for (unsigned int i = 0; i < num_probes; i++) {
+			statistics[i].count += buffer->count[i].load(std::memory_order_relaxed);
+			double total_time = 1e-9 * buffer->total_ns[i].load(std::memory_order_relaxed);
+			double max_time = 1e-9 * buffer->max_ns[i].load(std::memory_order_relaxed);
+			statistics[i].total_time += total_time;
+			statistics[i].max_time = std::max(statistics[i].max_time, max_time);
+		}
+	}
+}
+
+
+void Instrumentation::reset()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (unsigned int b = 0; b < registry.buffers.size(); b++) {
+		ThreadBuffer* buffer = registry.buffers[b];
+		for (unsigned int i = 0; i < MaxProbes; i++) {
+			buffer->count[i].store(0, std::memory_order_relaxed);
+			buffer->total_ns[i].store(0, std::memory_order_relaxed);
+			buffer->max_ns[i].store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+
+void Instrumentation::print()
+{
+	std::vector<ProbeStatistics> statistics;
+	getStatistics(statistics);
+
+	printf("%-48s %12s %14s %14s %14s\n", "probe", "count", "total [ms]", "mean [us]", "max [us]");
+	for (unsigned int i = 0; i < statistics.size(); i++) {
+		const ProbeStatistics& probe = statistics[i];
+		if (probe.count == 0)
+			continue;
+
+		if (probe.type == CounterProbe)
+			printf("%-48s %12lu\n", probe.name.c_str(), probe.count);
+		else
+			printf("%-48s %12lu %14.3f %14.3f %14.3f\n", probe.name.c_str(), probe.count,
+					1e3 * probe.total_time, 1e6 * probe.total_time / probe.count,
+					1e6 * probe.max_time);
+	}
+}
+
+
+Instrumentation::ThreadBuffer::ThreadBuffer()
+{
+	for (unsigned int i = 0; i < MaxProbes; i++) {
+		count[i].store(0, std::memory_order_relaxed);
+		total_ns[i].store(0, std::memory_order_relaxed);
+		max_ns[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+Instrumentation::ThreadBufferHandle::ThreadBufferHandle() : buffer(NULL)
+{
+	// Reusing the buffer of a finished thread if there is one
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	if (!registry.free_buffers.empty()) {
+		buffer = registry.free_buffers.back();
+		registry.free_buffers.pop_back();
+	} else {
+		buffer = new ThreadBuffer();
+		registry.buffers.push_back(buffer);
+	}
+}
+
+
+Instrumentation::ThreadBufferHandle::~ThreadBufferHandle()
+{
+	// Keeping the buffer, and its records, for the next threads
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.free_buffers.push_back(buffer);
+}
+
+
+Instrumentation::ThreadBuffer& Instrumentation::getThreadBuffer()
+{
+	static thread_local ThreadBufferHandle handle;
+	return *handle.buffer;
+}
+
+} //@namespace utils
+} //@namespace dwl
@@ -0,0 +1,184 @@
+#ifndef DWL__UTILS__INSTRUMENTATION__H
+#define DWL__UTILS__INSTRUMENTATION__H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/** @brief Types of probes, i.e. scoped timers or event counters */
+enum ProbeType {TimerProbe, CounterProbe};
+
+/**
+ * @struct ProbeStatistics
+ * @brief Statistics of a probe accumulated across all the threads. The count is the number
+ * of timed scopes or events, and the times are in seconds (zero for the counters)
+ */
+struct ProbeStatistics
+{
+	ProbeStatistics() : type(TimerProbe), count(0), total_time(0.), max_time(0.) {}
+
+	std::string name;
+	ProbeType type;
+	unsigned long count;
+	double total_time;
+	double max_time;
+};
+
+
+/**
+ * @class Instrumentation
+ * @brief Lightweight instrumentation of the hot paths, i.e. scoped timers and event counters.
+ * The probes are registered once by name, and every thread publishes its records in its own
+ * buffer, so recording a probe doesn't lock or share cache lines with other threads (a
+ * relaxed load and store per value). The buffers of finished threads are reused by the new
+ * threads, so their records are kept and the number of buffers is bounded by the number of
+ * concurrent threads. The statistics are the sum of all the buffers.
+ * The probes are recorded by the DWL_SCOPED_TIMER, DWL_SCOPED_TIMER_PROBE and
+ * DWL_COUNT_EVENTS macros, which are removed at compile time, unless DWL_WITH_INSTRUMENTATION
+ * is defined (i.e. the DWL_WITH_INSTRUMENTATION option of CMake)
+ */
+class Instrumentation
+{
+	public:
+		/** @brief Maximum number of probes */
+		static const unsigned int MaxProbes = 256;
+
+		/**
+		 * @brief Registers a probe, or gets it if it was already registered. Note that it
+		 * locks, so the probe has to be registered once, e.g. in a static variable
+		 * @param const std::string& Name of the probe
+		 * @param ProbeType Type of the probe
+		 * @return The id of the probe (MaxProbes if there isn't space for more probes)
+		 */
+		static unsigned int registerProbe(const std::string& name,
+										  ProbeType type = TimerProbe);
+
+		/**
+		 * @brief Records a probe in the buffer of the current thread
+		 * @param unsigned int Id of the probe
+		 * @param unsigned long Number of scopes or events
+		 * @param unsigned long Elapsed time in nanoseconds
+		 */
+		static void record(unsigned int probe,
+						   unsigned long count,
+						   unsigned long elapsed_ns);
+
+		/**
+		 * @brief Gets the statistics of the registered probes
+		 * @param std::vector<ProbeStatistics>& Statistics of every probe (in order of
+		 * registration)
+		 */
+		static void getStatistics(std::vector<ProbeStatistics>& statistics);
+
+		/**
+		 * @brief Resets the records of all the threads. Note that the records of the
+		 * probes running during the reset could be partially kept
+		 */
+		static void reset();
+
+		/** @brief Prints the statistics of the probes that have been recorded */
+		static void print();
+
+
+	private:
+		/** @brief Buffer of records of a thread, which has a single writer */
+		struct ThreadBuffer
+		{
+			ThreadBuffer();
+
+			std::atomic<unsigned long> count[MaxProbes];
+			std::atomic<unsigned long> total_ns[MaxProbes];
+			std::atomic<unsigned long> max_ns[MaxProbes];
+		};
+
+		/** @brief Returns the buffer of the thread to the pool when the thread finishes */
+		struct ThreadBufferHandle
+		{
+			ThreadBufferHandle();
+			~ThreadBufferHandle();
+
+			ThreadBuffer* buffer;
+		};
+
+		/** @brief Registry of probes and pool of thread buffers */
+		struct Registry;
+
+		/** @brief Gets the registry, which is never destroyed */
+		static Registry& getRegistry();
+
+		/** @brief Gets the buffer of the current thread */
+		static ThreadBuffer& getThreadBuffer();
+};
+
+
+/**
+ * @class ScopedTimer
+ * @brief Records the elapsed time of its scope in a timer probe
+ */
+class ScopedTimer
+{
+	public:
+		/**
+		 * @brief Constructor function, which starts the timer
+		 * @param unsigned int Id of the probe
+		 */
+		ScopedTimer(unsigned int probe) : probe_(probe), start_(Clock::now()) {}
+
+		/** @brief Destructor function, which records the elapsed time */
+		~ScopedTimer() {
+			std::chrono::nanoseconds elapsed = Clock::now() - start_;
+			Instrumentation::record(probe_, 1, elapsed.count());
+		}
+
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		/** @brief Id of the probe */
+		unsigned int probe_;
+
+		/** @brief Start time of the scope */
+		Clock::time_point start_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+
+#define DWL_PROBE_CONCAT_IMPL(a, b) a##b
+#define DWL_PROBE_CONCAT(a, b) DWL_PROBE_CONCAT_IMPL(a, b)
+
+#ifdef DWL_WITH_INSTRUMENTATION
+/** @brief Times the current scope in the probe with a name (string literal) */
+#define DWL_SCOPED_TIMER(name) \
+	static const unsigned int DWL_PROBE_CONCAT(dwl_probe_, __LINE__) = \
+			dwl::utils::Instrumentation::registerProbe(name); \
+	dwl::utils::ScopedTimer DWL_PROBE_CONCAT(dwl_timer_, __LINE__)( \
+			DWL_PROBE_CONCAT(dwl_probe_, __LINE__))
+
+/** @brief Times the current scope in a registered probe, e.g. a probe per model */
+#define DWL_SCOPED_TIMER_PROBE(probe) \
+	dwl::utils::ScopedTimer DWL_PROBE_CONCAT(dwl_timer_, __LINE__)(probe)
+
+/** @brief Counts a number of events in the probe with a name (string literal) */
+#define DWL_COUNT_EVENTS(name, num_events) \
+	do { \
+		static const unsigned int dwl_probe = \
+				dwl::utils::Instrumentation::registerProbe(name, dwl::utils::CounterProbe); \
+		dwl::utils::Instrumentation::record(dwl_probe, num_events, 0); \
+	} while (0)
+#else
+#define DWL_SCOPED_TIMER(name)
+#define DWL_SCOPED_TIMER_PROBE(probe)
+#define DWL_COUNT_EVENTS(name, num_events) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+#include <dwl/utils/Log.h>
+#include <dwl/utils/Macros.h>
+#include <chrono>
+#include <cstdarg>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/** @brief Names of the log levels */
+static const char* LevelNames[] = {"off", "error", "warning", "info", "debug"};
+
+/** @brief Sink of the records, and the mutex that serializes them */
+static std::mutex sink_mutex;
+static Log::Sink log_sink;
+
+/** @brief Time of the first record */
+static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+
+/** @brief Gets the default log level, i.e. the one of the environment or LogWarning */
+static int getDefaultLevel()
+{
+	LogLevel level = LogWarning;
+	const char* name = getenv("DWL_LOG_LEVEL");
+	if (name != NULL && !Log::parseLevel(level, name))
+		printf(YELLOW "Warning: the log level %s isn't defined\n" COLOR_RESET, name);
+
+	return level;
+}
+
+std::atomic<int> Log::level_(getDefaultLevel());
+
+
+void Log::setLevel(LogLevel level)
+{
+	level_ = level;
+}
+
+
+LogLevel Log::getLevel()
+{
+	return (LogLevel) level_.load(std::memory_order_relaxed);
+}
+
+
+void Log::setSink(const Sink& sink)
+{
+	std::lock_guard<std::mutex> lock(sink_mutex);
+	log_sink = sink;
+}
+
+
+void Log::write(LogLevel level,
+				const char* component,
+				const char* format, ...)
+{
+	LogRecord record;
+	record.level = level;
+	record.component = component;
+	record.time = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start_time).count();
+
+	// Formatting the message, where the buffer grows for long messages
+	char buffer[256];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	if (length < 0)
+		return;
+	if ((unsigned int) length < sizeof(buffer))
+		record.message = buffer;
+	else {
+		std::vector<char> long_buffer(length + 1);
+		va_start(args, format);
+		vsnprintf(long_buffer.data(), long_buffer.size(), format, args);
+		va_end(args);
+		record.message = long_buffer.data();
+	}
+
+	std::lock_guard<std::mutex> lock(sink_mutex);
+	if (log_sink) {
+		log_sink(record);
+		return;
+	}
+
+	switch (level) {
+		case LogError:
+			fprintf(stderr, RED "[%s] %s\n" COLOR_RESET, component, record.message.c_str());
+			break;
+		case LogWarning:
+			fprintf(stderr, YELLOW "[%s] %s\n" COLOR_RESET, component, record.message.c_str());
+			break;
+		default:
+			printf("[%s] %s\n", component, record.message.c_str());
+			break;
+	}
+}
+
+
+bool Log::parseLevel(LogLevel& level,
+					 const std::string& name)
+{
+	for (int i = LogOff; i <= LogDebug; i++) {
+		if (name == LevelNames[i]) {
+			level = (LogLevel) i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+} //@namespace utils
+} //@namespace dwl
@@ -0,0 +1,118 @@
+#ifndef DWL__UTILS__LOG__H
+#define DWL__UTILS__LOG__H
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/** @brief Levels of the log records, where a level includes the previous ones */
+enum LogLevel {LogOff, LogError, LogWarning, LogInfo, LogDebug};
+
+/**
+ * @struct LogRecord
+ * @brief Record of the log, i.e. its level, the component that wrote it (e.g. "ocp") and the
+ * formatted message. The time is in seconds since the first record
+ */
+struct LogRecord
+{
+	LogLevel level;
+	const char* component;
+	std::string message;
+	double time;
+};
+
+
+/**
+ * @class Log
+ * @brief Level-gated log of the library. The records above the log level are discarded
+ * before formatting them, so a disabled record costs a relaxed load in the DWL_LOG macros,
+ * and no console I/O runs in the evaluation paths unless its level is enabled. The records
+ * are written to a sink, which is the console by default (stderr for the errors and
+ * warnings), and it can be replaced by the host application, e.g. for forwarding them to its
+ * own logger. Note that the sink is called by one thread at a time. The default level is
+ * LogWarning, or the one of the DWL_LOG_LEVEL environment variable (off, error, warning,
+ * info or debug)
+ */
+class Log
+{
+	public:
+		/** @brief Sink of the log records */
+		typedef std::function<void(const LogRecord&)> Sink;
+
+		/**
+		 * @brief Sets the log level
+		 * @param LogLevel Maximum level of the written records
+		 */
+		static void setLevel(LogLevel level);
+
+		/** @brief Gets the log level */
+		static LogLevel getLevel();
+
+		/**
+		 * @brief Indicates if the records of a level are written
+		 * @param LogLevel Level of the records
+		 */
+		static bool isEnabled(LogLevel level) {
+			return level != LogOff && level <= level_.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Sets the sink of the records
+		 * @param const Sink& Sink of the records (empty for the console)
+		 */
+		static void setSink(const Sink& sink);
+
+		/**
+		 * @brief Writes a record, where the message is formatted as printf. Note that the
+		 * level isn't checked (see the DWL_LOG macros)
+		 * @param LogLevel Level of the record
+		 * @param const char* Component that writes the record
+		 * @param const char* Format of the message
+		 */
+		static void write(LogLevel level,
+						  const char* component,
+						  const char* format, ...)
+#ifdef __GNUC__
+				__attribute__((format(printf, 3, 4)))
+#endif
+				;
+
+		/**
+		 * @brief Parses the name of a log level
+		 * @param LogLevel& Log level
+		 * @param const std::string& Name of the level (off, error, warning, info or debug)
+		 * @return False if the name isn't a level
+		 */
+		static bool parseLevel(LogLevel& level,
+							   const std::string& name);
+
+
+	private:
+		/** @brief Log level */
+		static std::atomic<int> level_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+
+/** @brief Writes a printf-formatted record of a component if its level is enabled */
+#define DWL_LOG(level, component, ...) \
+	do { \
+		if (dwl::utils::Log::isEnabled(level)) \
+			dwl::utils::Log::write(level, component, __VA_ARGS__); \
+	} while (0)
+
+#define DWL_LOG_ERROR(component, ...) DWL_LOG(dwl::utils::LogError, component, __VA_ARGS__)
+#define DWL_LOG_WARNING(component, ...) DWL_LOG(dwl::utils::LogWarning, component, __VA_ARGS__)
+#define DWL_LOG_INFO(component, ...) DWL_LOG(dwl::utils::LogInfo, component, __VA_ARGS__)
+#define DWL_LOG_DEBUG(component, ...) DWL_LOG(dwl::utils::LogDebug, component, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,118 @@
+#include <dwl/utils/MemoryPool.h>
+#include <cstring>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+const std::size_t MemoryPool::GRANULARITY;
+const std::size_t MemoryPool::NUM_CLASSES;
+
+
+MemoryPool::MemoryPool(std::size_t block_size) : current_block_(0), next_(NULL), end_(NULL),
+		block_size_(block_size)
+{
+	std::memset(free_lists_, 0, sizeof(free_lists_));
+}
+
+
+MemoryPool::~MemoryPool()
+{
+	release();
+}
+
+
+void* MemoryPool::allocate(std::size_t size)
+{
+	// The large objects are allocated from the system
+	std::size_t size_class = (size + GRANULARITY - 1) / GRANULARITY;
+	if (size_class == 0)
+		size_class = 1;
+	if (size_class > NUM_CLASSES || size_class * GRANULARITY > block_size_)
+		return ::operator new(size);
+
+	// Reusing a deallocated object of the same size class
+	FreeNode*& free_list = free_lists_[size_class - 1];
+	if (free_list != NULL) {
+		FreeNode* node = free_list;
+		free_list = node->next;
+		return node;
+	}
+
+	// Bumping the pointer of the current block, where the next block is used (or allocated)
+	// if it's full
+	std::size_t aligned_size = size_class * GRANULARITY;
+	if (next_ == NULL || next_ + aligned_size > end_) {
+		if (next_ != NULL)
+			current_block_++;
+		if (current_block_ == blocks_.size())
+			blocks_.push_back(static_cast<char*>(::operator new(block_size_)));
+		next_ = blocks_[current_block_];
+		end_ = next_ + block_size_;
+	}
+
+	void* memory = next_;
+	next_ += aligned_size;
+	return memory;
+}
+
+
+void MemoryPool::deallocate(void* memory,
+							std::size_t size)
+{
+	if (memory == NULL)
+		return;
+
+	std::size_t size_class = (size + GRANULARITY - 1) / GRANULARITY;
+	if (size_class == 0)
+		size_class = 1;
+	if (size_class > NUM_CLASSES || size_class * GRANULARITY > block_size_) {
+		::operator delete(memory);
+		return;
+	}
+
+	FreeNode* node = static_cast<FreeNode*>(memory);
+	node->next = free_lists_[size_class - 1];
+	free_lists_[size_class - 1] = node;
+}
+
+
+void MemoryPool::reset()
+{
+	current_block_ = 0;
+	next_ = end_ = NULL;
+	std::memset(free_lists_, 0, sizeof(free_lists_));
+}
+
+
+void MemoryPool::release()
+{
+	for (unsigned int i = 0; i < blocks_.size(); i++)
+		::operator delete(blocks_[i]);
+	blocks_.clear();
+	reset();
+}
+
+
+unsigned int MemoryPool::getNumberOfBlocks() const
+{
+	return blocks_.size();
+}
+
+
+std::size_t MemoryPool::getBlockSize() const
+{
+	return block_size_;
+}
+
+
+std::size_t MemoryPool::getHeapBytes() const
+{
+	return blocks_.size() * block_size_ + blocks_.capacity() * sizeof(char*);
+}
+
+} //@namespace utils
+} //@namespace dwl
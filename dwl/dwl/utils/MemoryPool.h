@@ -0,0 +1,187 @@
+#ifndef DWL__UTILS__MEMORY_POOL__H
+#define DWL__UTILS__MEMORY_POOL__H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @class MemoryPool
+ * @brief Arena of memory blocks for the small objects of a query (e.g. the nodes of the lists,
+ * maps and sets of a graph search), i.e. an allocation bumps a pointer of the current block,
+ * and a deallocation pushes the object in a free list of its size class. The blocks are kept
+ * after a reset, so the next queries don't allocate memory from the system. Note that the pool
+ * isn't thread-safe, and the objects allocated from it can't be used after a reset
+ */
+class MemoryPool
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param std::size_t Size of the blocks
+		 */
+		MemoryPool(std::size_t block_size = 1 << 16);
+
+		/** @brief Destructor function, which releases the blocks */
+		~MemoryPool();
+
+		/**
+		 * @brief Allocates memory from the pool, where the large sizes are allocated from the
+		 * system
+		 * @param std::size_t Size of the memory
+		 * @return The allocated memory
+		 */
+		void* allocate(std::size_t size);
+
+		/**
+		 * @brief Returns memory to the pool
+		 * @param void* Memory
+		 * @param std::size_t Size of the memory, which has to be the allocated one
+		 */
+		void deallocate(void* memory,
+						std::size_t size);
+
+		/** @brief Frees all the allocated memory at once, where the blocks are kept */
+		void reset();
+
+		/** @brief Releases the blocks to the system */
+		void release();
+
+		/** @brief Gets the number of blocks */
+		unsigned int getNumberOfBlocks() const;
+
+		/** @brief Gets the size of the blocks */
+		std::size_t getBlockSize() const;
+
+		/**
+		 * @brief Gets the heap bytes of the blocks. Note that the large objects are allocated
+		 * from the system, so they aren't counted
+		 */
+		std::size_t getHeapBytes() const;
+
+
+	private:
+		/** @brief Pool isn't copyable */
+		MemoryPool(const MemoryPool&);
+		MemoryPool& operator=(const MemoryPool&);
+
+		/** @brief Node of the free lists */
+		struct FreeNode
+		{
+			FreeNode* next;
+		};
+
+		/** @brief Granularity of the sizes and number of size classes */
+		static const std::size_t GRANULARITY = 16;
+		static const std::size_t NUM_CLASSES = 32;
+
+		/** @brief Blocks of memory, and the current one */
+		std::vector<char*> blocks_;
+		unsigned int current_block_;
+
+		/** @brief Bump pointer of the current block, and its end */
+		char* next_;
+		char* end_;
+
+		/** @brief Free lists of every size class */
+		FreeNode* free_lists_[NUM_CLASSES];
+
+		/** @brief Size of the blocks */
+		std::size_t block_size_;
+};
+
+
+/**
+ * @class PoolAllocator
+ * @brief Allocator of the standard containers that allocates their nodes from a memory pool.
+ * A default-constructed allocator (i.e. without pool) allocates from the system, so it behaves
+ * like std::allocator
+ */
+template<typename T>
+class PoolAllocator
+{
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		template<typename U>
+		struct rebind
+		{
+			typedef PoolAllocator<U> other;
+		};
+
+		/** @brief Constructor functions */
+		PoolAllocator(MemoryPool* pool = NULL) : pool_(pool) {}
+		template<typename U>
+		PoolAllocator(const PoolAllocator<U>& other) : pool_(other.getPool()) {}
+
+		/** @brief Allocates the memory of a number of objects */
+		T* allocate(std::size_t n, const void* hint = 0) {
+			if (pool_ == NULL)
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+			return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+		}
+
+		/** @brief Deallocates the memory of a number of objects */
+		void deallocate(T* memory, std::size_t n) {
+			if (pool_ == NULL)
+				::operator delete(memory);
+			else
+				pool_->deallocate(memory, n * sizeof(T));
+		}
+
+		/** @brief Constructs and destroys an object */
+		template<typename U, typename... Args>
+		void construct(U* object, Args&&... args) {
+			::new((void*) object) U(std::forward<Args>(args)...);
+		}
+		template<typename U>
+		void destroy(U* object) {
+			object->~U();
+		}
+
+		/** @brief Gets the maximum number of objects */
+		std::size_t max_size() const {
+			return std::size_t(-1) / sizeof(T);
+		}
+
+		/** @brief Gets the pool */
+		MemoryPool* getPool() const {
+			return pool_;
+		}
+
+
+	private:
+		/** @brief Memory pool */
+		MemoryPool* pool_;
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b)
+{
+	return a.getPool() == b.getPool();
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b)
+{
+	return a.getPool() != b.getPool();
+}
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,101 @@
+#include <dwl/utils/MemoryUsage.h>
+#include <cstdio>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+MemoryUsage::MemoryUsage(const std::string& name,
+						 std::size_t bytes) : name_(name), bytes_(bytes)
+{
+
+}
+
+
+MemoryUsage::~MemoryUsage()
+{
+
+}
+
+
+void MemoryUsage::add(const std::string& name,
+					  std::size_t bytes)
+{
+	add(MemoryUsage(name, bytes));
+}
+
+
+void MemoryUsage::add(const MemoryUsage& usage)
+{
+	components_.push_back(usage);
+	bytes_ += usage.getBytes();
+}
+
+
+const MemoryUsage* MemoryUsage::find(const std::string& path) const
+{
+	std::size_t separator = path.find('/');
+	std::string name = path.substr(0, separator);
+	for (unsigned int i = 0; i < components_.size(); i++) {
+		if (components_[i].getName() != name)
+			continue;
+
+		if (separator == std::string::npos)
+			return &components_[i];
+		else
+			return components_[i].find(path.substr(separator + 1));
+	}
+
+	return NULL;
+}
+
+
+const std::string& MemoryUsage::getName() const
+{
+	return name_;
+}
+
+
+std::size_t MemoryUsage::getBytes() const
+{
+	return bytes_;
+}
+
+
+const std::vector<MemoryUsage>& MemoryUsage::getComponents() const
+{
+	return components_;
+}
+
+
+void MemoryUsage::print() const
+{
+	printf("%-48s %14s\n", "component", "memory [KiB]");
+	print(0);
+}
+
+
+void MemoryUsage::print(unsigned int depth) const
+{
+	std::string name = std::string(2 * depth, ' ') + name_;
+	printf("%-48s %14.1f\n", name.c_str(), bytes_ / 1024.);
+	for (unsigned int i = 0; i < components_.size(); i++)
+		components_[i].print(depth + 1);
+}
+
+
+std::size_t getHeapBytes(const std::string& value)
+{
+	// The small strings are stored inside the object
+	const char* object = reinterpret_cast<const char*>(&value);
+	if (value.data() >= object && value.data() < object + sizeof(value))
+		return 0;
+	else
+		return value.capacity() + 1;
+}
+
+} //@namespace utils
+} //@namespace dwl
@@ -0,0 +1,139 @@
+#ifndef DWL__UTILS__MEMORY_USAGE__H
+#define DWL__UTILS__MEMORY_USAGE__H
+
+#include <dwl/utils/CopyOnWrite.h>
+#include <Eigen/Dense>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @class MemoryUsage
+ * @brief Report of the bytes held by a subsystem (e.g. a terrain map or a search), which is
+ * broken down in named components that could be reports of other subsystems. The bytes are
+ * the heap memory of the subsystem, i.e. the size of its object isn't counted since it's
+ * usually embedded in other subsystem. Note that the values shared by copy-on-write copies
+ * are counted by every copy
+ */
+class MemoryUsage
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param const std::string& Name of the subsystem
+		 * @param std::size_t Bytes that aren't detailed in components
+		 */
+		MemoryUsage(const std::string& name = "",
+					std::size_t bytes = 0);
+
+		/** @brief Destructor function */
+		~MemoryUsage();
+
+		/**
+		 * @brief Adds a component to the report
+		 * @param const std::string& Name of the component
+		 * @param std::size_t Bytes of the component
+		 */
+		void add(const std::string& name,
+				 std::size_t bytes);
+
+		/**
+		 * @brief Adds the report of a subsystem as a component
+		 * @param const MemoryUsage& Report of the subsystem
+		 */
+		void add(const MemoryUsage& usage);
+
+		/**
+		 * @brief Finds a component of the report given its path, i.e. the names of the nested
+		 * components separated by slashes (e.g. "terrain_grid/tiles")
+		 * @param const std::string& Path of the component
+		 * @return The component, or NULL if it doesn't exist
+		 */
+		const MemoryUsage* find(const std::string& path) const;
+
+		/** @brief Gets the name of the subsystem */
+		const std::string& getName() const;
+
+		/** @brief Gets the total bytes, i.e. including the components */
+		std::size_t getBytes() const;
+
+		/** @brief Gets the components of the report */
+		const std::vector<MemoryUsage>& getComponents() const;
+
+		/** @brief Prints the report as a tree of components in KiB */
+		void print() const;
+
+
+	private:
+		/**
+		 * @brief Prints the report with an indentation
+		 * @param unsigned int Depth of the report in the tree
+		 */
+		void print(unsigned int depth) const;
+
+		/** @brief Name of the subsystem */
+		std::string name_;
+
+		/** @brief Total bytes */
+		std::size_t bytes_;
+
+		/** @brief Components of the report */
+		std::vector<MemoryUsage> components_;
+};
+
+
+/**
+ * @brief Estimates the heap bytes held by a value, i.e. the capacities of the containers and
+ * the heap bytes of their elements. The nodes of the trees and hash tables are estimated with
+ * the overhead of their pointers, but the overhead of the allocator isn't counted. The types
+ * with a getHeapBytes() method (e.g. WholeBodyState) report their own bytes, and the other
+ * types don't have heap memory
+ * @param const T& Value
+ * @return The heap bytes
+ */
+template<typename T>
+std::size_t getHeapBytes(const T& value);
+
+/** @brief Heap bytes of a dynamic-size Eigen matrix */
+template<typename S, int R, int C, int O, int MR, int MC>
+std::size_t getHeapBytes(const Eigen::Matrix<S,R,C,O,MR,MC>& matrix);
+
+/** @brief Heap bytes of a string, which are zero with small-string optimization */
+std::size_t getHeapBytes(const std::string& value);
+
+/** @brief Heap bytes of the containers */
+template<typename T, typename A>
+std::size_t getHeapBytes(const std::vector<T,A>& vector);
+
+template<typename T, typename A>
+std::size_t getHeapBytes(const std::deque<T,A>& deque);
+
+template<typename K, typename T, typename C, typename A>
+std::size_t getHeapBytes(const std::map<K,T,C,A>& map);
+
+template<typename K, typename T, typename H, typename E, typename A>
+std::size_t getHeapBytes(const std::unordered_map<K,T,H,E,A>& map);
+
+template<typename T1, typename T2>
+std::size_t getHeapBytes(const std::pair<T1,T2>& pair);
+
+/** @brief Heap bytes of a copy-on-write value, i.e. the shared value */
+template<typename T>
+std::size_t getHeapBytes(const CopyOnWrite<T>& value);
+
+} //@namespace utils
+} //@namespace dwl
+
+#include <dwl/utils/impl/MemoryUsage.hpp>
+
+#endif
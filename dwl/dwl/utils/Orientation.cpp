@@ -9,20 +9,13 @@ namespace math
 
 Eigen::Vector3d getRPY(const Eigen::Matrix3d& rotation_mtx)
 {
-	Eigen::Vector3d rpy;
-	rpy[0] = atan2f((float) rotation_mtx(2,1), (float) rotation_mtx(2,2));
-	rpy[1] = asinf((float) -rotation_mtx(2,0));
-	rpy[2] = atan2f((float) rotation_mtx(1,0), (float) rotation_mtx(0,0));
-
-	return rpy;
+	return getRPY<double>(rotation_mtx);
 }
 
 
 Eigen::Vector3d getRPY(const Eigen::Quaterniond& quaternion)
 {
-	Eigen::Matrix3d rotation_mtx = quaternion.toRotationMatrix();
-
-	return getRPY(rotation_mtx);
+	return getRPY<double>(quaternion);
 }
 
 
@@ -35,35 +28,19 @@ Eigen::Quaterniond getQuaternion(const Eigen::Matrix3d& rotation_mtx)
 
 Eigen::Quaterniond getQuaternion(const Eigen::Vector3d& rpy)
 {
-	double roll = rpy[0];
-	double pitch = rpy[1];
-	double yaw = rpy[2];
-
-	double w = cos(roll / 2.0) * cos(pitch / 2.0) * cos(yaw / 2.0) +
-			sin(roll / 2.0) * sin(pitch / 2.0) * sin(yaw / 2.0);
-	double x = sin(roll / 2.0) * cos(pitch / 2.0) * cos(yaw / 2.0) -
-			cos(roll / 2.0) * sin(pitch / 2.0) * sin(yaw / 2.0);
-	double y = cos(roll / 2.0) * sin(pitch / 2.0) * cos(yaw / 2.0) +
-			sin(roll / 2.0) * cos(pitch / 2.0) * sin(yaw / 2.0);
-	double z = cos(roll / 2.0) * cos(pitch / 2.0) * sin(yaw / 2.0) -
-			sin(roll / 2.0) * sin(pitch / 2.0) * cos(yaw / 2.0);
-
-	Eigen::Quaterniond quaternion(w, x, y, z);
-	return quaternion;
+	return getQuaternion<double>(rpy);
 }
 
 
 Eigen::Matrix3d getRotationMatrix(const Eigen::Quaterniond& quaternion)
 {
-	return quaternion.toRotationMatrix();
+	return getRotationMatrix<double>(quaternion);
 }
 
 
 Eigen::Matrix3d getRotationMatrix(const Eigen::Vector3d& rpy)
 {
-	Eigen::Quaterniond quaternion = getQuaternion(rpy);
-
-	return getRotationMatrix(quaternion);
+	return getRotationMatrix<double>(rpy);
 }
 
 
@@ -85,6 +62,25 @@ double getYaw(const Eigen::Vector3d& rpy)
 }
 
 
+double getYaw(const Eigen::Quaterniond& quaternion)
+{
+	return getYaw<double>(quaternion);
+}
+
+
+Eigen::Matrix3d getYawRotationMatrix(double yaw)
+{
+	double cy = cos(yaw), sy = sin(yaw);
+
+	Eigen::Matrix3d rotation_mtx;
+	rotation_mtx << cy, -sy, 0.,
+					sy,  cy, 0.,
+					0.,  0., 1.;
+
+	return rotation_mtx;
+}
+
+
 Eigen::Matrix3d getInverseEulerAnglesRatesMatrix(const Eigen::Vector3d& rpy)
 {
 	double pitch = getPitch(rpy);
@@ -203,5 +199,251 @@ Eigen::Matrix3d getDirectionCosineMatrix(const Eigen::Quaterniond& orientation)
 	return dcm;
 }
 
+
+/**
+ * @brief Approximates the atan2 with an odd polynomial of the ratio in [0,1], which is moved
+ * to the octant of the (x,y) point. It's branchless, so the batch loops are vectorized. Note
+ * that (0,0) gives zero as std::atan2
+ */
+static inline double fastAtan2(double y,
+							   double x)
+{
+	double abs_x = std::fabs(x), abs_y = std::fabs(y);
+	double max_xy = std::max(abs_x, abs_y);
+	double a = std::min(abs_x, abs_y) / (max_xy == 0. ? 1. : max_xy);
+	double s = a * a;
+	double angle = a * (0.99997726 + s * (-0.33262347 + s * (0.19354346 +
+			s * (-0.11643287 + s * (0.05265332 + s * -0.01172120)))));
+	angle = (abs_y > abs_x) ? M_PI_2 - angle : angle;
+	angle = (x < 0.) ? M_PI - angle : angle;
+	return (y < 0.) ? -angle : angle;
+}
+
+
+/**
+ * @brief Approximates the sine and cosine by reducing the angle to r = angle - k pi/2 in
+ * [-pi/4,pi/4], evaluating the Taylor polynomials of r, and rotating them by the quadrant
+ */
+static inline void fastSinCos(double& sin_angle,
+							  double& cos_angle,
+							  double angle)
+{
+	double k = std::floor(angle * M_2_PI + 0.5);
+	double r = angle - k * M_PI_2;
+	double r2 = r * r;
+	double sin_r = r * (1. + r2 * (-1. / 6 + r2 * (1. / 120 +
+			r2 * (-1. / 5040 + r2 * (1. / 362880)))));
+	double cos_r = 1. + r2 * (-0.5 + r2 * (1. / 24 + r2 * (-1. / 720 +
+			r2 * (1. / 40320 + r2 * (-1. / 3628800)))));
+
+	// Swapping and negating by the quadrant, i.e. k mod 4
+	double quadrant = k - 4. * std::floor(k / 4.);
+	bool swap = (quadrant == 1. || quadrant == 3.);
+	double s = swap ? cos_r : sin_r;
+	double c = swap ? sin_r : cos_r;
+	sin_angle = (quadrant >= 2.) ? -s : s;
+	cos_angle = (quadrant == 1. || quadrant == 2.) ? -c : c;
+}
+
+
+void computeAtan2(Eigen::ArrayXd& angle,
+				  const Eigen::ArrayXd& y,
+				  const Eigen::ArrayXd& x,
+				  bool fast)
+{
+	angle.resize(y.size());
+	if (fast) {
+		for (int i = 0; i < y.size(); i++)
+			angle(i) = fastAtan2(y(i), x(i));
+	} else {
+		for (int i = 0; i < y.size(); i++)
+			angle(i) = std::atan2(y(i), x(i));
+	}
+}
+
+
+void computeSinCos(Eigen::ArrayXd& sin_angle,
+				   Eigen::ArrayXd& cos_angle,
+				   const Eigen::ArrayXd& angle,
+				   bool fast)
+{
+	sin_angle.resize(angle.size());
+	cos_angle.resize(angle.size());
+	if (fast) {
+		for (int i = 0; i < angle.size(); i++)
+			fastSinCos(sin_angle(i), cos_angle(i), angle(i));
+	} else {
+		for (int i = 0; i < angle.size(); i++) {
+			sin_angle(i) = std::sin(angle(i));
+			cos_angle(i) = std::cos(angle(i));
+		}
+	}
+}
+
+
+/**
+ * @brief Computes the RPY angles of a batch from the needed elements of its rotation matrices,
+ * where the pitch argument is clamped as in the single conversion. The elements are given by a
+ * functor of the sample index, so the quaternions don't build the rotation matrices
+ */
+template <typename Elements>
+static void computeRPY(Eigen::MatrixX3d& rpy,
+					   const Elements& elements,
+					   unsigned int num_samples,
+					   bool fast)
+{
+	rpy.resize(num_samples, 3);
+	double* roll = rpy.col(0).data();
+	double* pitch = rpy.col(1).data();
+	double* yaw = rpy.col(2).data();
+	double r21, r22, r20, r10, r00;
+	if (fast) {
+		// The arcsine is the atan2 of the sine and cosine in the fast version
+		for (unsigned int i = 0; i < num_samples; i++) {
+			elements(r21, r22, r20, r10, r00, i);
+			double sin_pitch = std::max(-1., std::min(1., -r20));
+			roll[i] = fastAtan2(r21, r22);
+			pitch[i] = fastAtan2(sin_pitch, std::sqrt(1. - sin_pitch * sin_pitch));
+			yaw[i] = fastAtan2(r10, r00);
+		}
+	} else {
+		for (unsigned int i = 0; i < num_samples; i++) {
+			elements(r21, r22, r20, r10, r00, i);
+			roll[i] = std::atan2(r21, r22);
+			pitch[i] = std::asin(std::max(-1., std::min(1., -r20)));
+			yaw[i] = std::atan2(r10, r00);
+		}
+	}
+}
+
+
+void getRPY(Eigen::MatrixX3d& rpy,
+			const Eigen::MatrixX4d& quaternions,
+			bool fast)
+{
+	// Computing the elements of the rotation matrices as Eigen::Quaternion::toRotationMatrix
+	const double* qx = quaternions.col(0).data();
+	const double* qy = quaternions.col(1).data();
+	const double* qz = quaternions.col(2).data();
+	const double* qw = quaternions.col(3).data();
+	computeRPY(rpy, [&](double& r21, double& r22, double& r20, double& r10, double& r00,
+			unsigned int i) {
+		double x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+		r21 = 2 * (y * z + w * x);
+		r22 = 1 - 2 * (x * x + y * y);
+		r20 = 2 * (x * z - w * y);
+		r10 = 2 * (x * y + w * z);
+		r00 = 1 - 2 * (y * y + z * z);
+	}, quaternions.rows(), fast);
+}
+
+
+void getRPY(Eigen::MatrixX3d& rpy,
+			const RotationMatrixBatch& rotations,
+			bool fast)
+{
+	const double* rot00 = rotations.col(0).data();
+	const double* rot10 = rotations.col(1).data();
+	const double* rot20 = rotations.col(2).data();
+	const double* rot21 = rotations.col(5).data();
+	const double* rot22 = rotations.col(8).data();
+	computeRPY(rpy, [&](double& r21, double& r22, double& r20, double& r10, double& r00,
+			unsigned int i) {
+		r21 = rot21[i];
+		r22 = rot22[i];
+		r20 = rot20[i];
+		r10 = rot10[i];
+		r00 = rot00[i];
+	}, rotations.rows(), fast);
+}
+
+
+/**
+ * @brief Computes the sine and cosine of the RPY angles of a sample, which are scaled (e.g. the
+ * half angles of the quaternions)
+ */
+static inline void computeRPYSinCos(double* sin_rpy,
+									double* cos_rpy,
+									const Eigen::MatrixX3d& rpy,
+									unsigned int i,
+									double scale,
+									bool fast)
+{
+	for (unsigned int j = 0; j < 3; j++) {
+		double angle = scale * rpy(i,j);
+		if (fast)
+			fastSinCos(sin_rpy[j], cos_rpy[j], angle);
+		else {
+			sin_rpy[j] = std::sin(angle);
+			cos_rpy[j] = std::cos(angle);
+		}
+	}
+}
+
+
+void getQuaternion(Eigen::MatrixX4d& quaternions,
+				   const Eigen::MatrixX3d& rpy,
+				   bool fast)
+{
+	unsigned int num_samples = rpy.rows();
+	quaternions.resize(num_samples, 4);
+	double* qx = quaternions.col(0).data();
+	double* qy = quaternions.col(1).data();
+	double* qz = quaternions.col(2).data();
+	double* qw = quaternions.col(3).data();
+	for (unsigned int i = 0; i < num_samples; i++) {
+		// Computing the trigonometric functions of the half angles once
+		double s[3], c[3];
+		computeRPYSinCos(s, c, rpy, i, 0.5, fast);
+		qx[i] = s[0] * c[1] * c[2] - c[0] * s[1] * s[2];
+		qy[i] = c[0] * s[1] * c[2] + s[0] * c[1] * s[2];
+		qz[i] = c[0] * c[1] * s[2] - s[0] * s[1] * c[2];
+		qw[i] = c[0] * c[1] * c[2] + s[0] * s[1] * s[2];
+	}
+}
+
+
+void getRotationMatrix(RotationMatrixBatch& rotations,
+					   const Eigen::MatrixX3d& rpy,
+					   bool fast)
+{
+	// Computing directly R = Rz(yaw) * Ry(pitch) * Rx(roll) as the single conversion
+	unsigned int num_samples = rpy.rows();
+	rotations.resize(num_samples, 9);
+	for (unsigned int i = 0; i < num_samples; i++) {
+		double s[3], c[3];
+		computeRPYSinCos(s, c, rpy, i, 1., fast);
+		double sr = s[0], cr = c[0], sp = s[1], cp = c[1], sy = s[2], cy = c[2];
+		rotations(i,0) = cy * cp;
+		rotations(i,1) = sy * cp;
+		rotations(i,2) = -sp;
+		rotations(i,3) = cy * sp * sr - sy * cr;
+		rotations(i,4) = sy * sp * sr + cy * cr;
+		rotations(i,5) = cp * sr;
+		rotations(i,6) = cy * sp * cr + sy * sr;
+		rotations(i,7) = sy * sp * cr - cy * sr;
+		rotations(i,8) = cp * cr;
+	}
+}
+
+
+void getYaw(Eigen::VectorXd& yaw,
+			const Eigen::MatrixX4d& quaternions,
+			bool fast)
+{
+	unsigned int num_samples = quaternions.rows();
+	yaw.resize(num_samples);
+	const double* qx = quaternions.col(0).data();
+	const double* qy = quaternions.col(1).data();
+	const double* qz = quaternions.col(2).data();
+	const double* qw = quaternions.col(3).data();
+	for (unsigned int i = 0; i < num_samples; i++) {
+		double x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+		double sin_yaw = 2 * (x * y + w * z);
+		double cos_yaw = 1 - 2 * (y * y + z * z);
+		yaw(i) = fast ? fastAtan2(sin_yaw, cos_yaw) : std::atan2(sin_yaw, cos_yaw);
+	}
+}
+
 }
 }
@@ -2,6 +2,7 @@
 #define DWL__MATH__ORIENTATION__H
 
 #include <Eigen/Dense>
+#include <algorithm>
 
 
 namespace dwl
@@ -12,6 +13,56 @@ enum TypeOfOrientation {RollPitchYaw, Quaternion, RotationMatrix};
 namespace math
 {
 
+/**
+ * @brief Gets the roll, pitch and yaw angles from rotation matrix for a given scalar, e.g. the
+ * single-precision screening of sampling planners. The double-precision functions below use the
+ * same implementation
+ * @param const Eigen::Matrix<Scalar,3,3>& Rotation matrix
+ * @return Eigen::Matrix<Scalar,3,1> Roll, pitch and yaw angles
+ */
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,1> getRPY(const Eigen::Matrix<Scalar,3,3>& rotation_mtx);
+
+/**
+ * @brief Gets the roll, pitch and yaw angles from quaternion for a given scalar
+ * @param const Eigen::Quaternion<Scalar>& Quaternion
+ * @return Eigen::Matrix<Scalar,3,1> Roll, pitch and yaw angles
+ */
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,1> getRPY(const Eigen::Quaternion<Scalar>& quaternion);
+
+/**
+ * @brief Gets the quaternion from roll, pitch and yaw angles for a given scalar
+ * @param const Eigen::Matrix<Scalar,3,1>& Roll, pitch and yaw angles
+ * @return Eigen::Quaternion<Scalar> Quaternion
+ */
+template <typename Scalar>
+Eigen::Quaternion<Scalar> getQuaternion(const Eigen::Matrix<Scalar,3,1>& rpy);
+
+/**
+ * @brief Gets the rotation matrix from roll, pitch and yaw angles for a given scalar
+ * @param const Eigen::Matrix<Scalar,3,1>& Roll, pitch and yaw angles
+ * @return Eigen::Matrix<Scalar,3,3> Rotation matrix
+ */
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,3> getRotationMatrix(const Eigen::Matrix<Scalar,3,1>& rpy);
+
+/**
+ * @brief Gets the rotation matrix from quaternion for a given scalar
+ * @param const Eigen::Quaternion<Scalar>& Quaternion
+ * @return Eigen::Matrix<Scalar,3,3> Rotation matrix
+ */
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,3> getRotationMatrix(const Eigen::Quaternion<Scalar>& quaternion);
+
+/**
+ * @brief Gets the yaw angle from quaternion for a given scalar
+ * @param const Eigen::Quaternion<Scalar>& Quaternion
+ * @return Scalar Yaw angle
+ */
+template <typename Scalar>
+Scalar getYaw(const Eigen::Quaternion<Scalar>& quaternion);
+
 /**
  * @brief Gets the roll, pitch and yaw angles from rotation matrix
  * @param const Eigen::Matrix3d& Rotation matrix
@@ -78,6 +129,21 @@ double getPitch(const Eigen::Vector3d& rpy);
  */
 double getYaw(const Eigen::Vector3d& rpy);
 
+/**
+ * @brief Gets the yaw angle from quaternion without computing the other angles
+ * @param const Eigen::Quaterniond& Quaternion
+ * @return double Yaw angle
+ */
+double getYaw(const Eigen::Quaterniond& quaternion);
+
+/**
+ * @brief Gets the rotation matrix around the z axis, i.e. from the horizontal
+ * to the world frame
+ * @param double Yaw angle
+ * @return Eigen::Matrix3d Rotation matrix
+ */
+Eigen::Matrix3d getYawRotationMatrix(double yaw);
+
 /**
  * @brief Gets the inverse of Euler angles rates matrix from RPY vector
  * This matrix maps the euler rates (in ZYX convention) and omega vector
@@ -162,7 +228,95 @@ Eigen::Matrix3d getDirectionCosineMatrix(const Eigen::Vector3d& rpy);
  */
 Eigen::Matrix3d getDirectionCosineMatrix(const Eigen::Quaterniond& orientation);
 
+/**
+ * @brief Batch of rotation matrices, where every row is a rotation matrix stored in column-major
+ * order, i.e. the column 3 * j + i is the element (i,j)
+ */
+typedef Eigen::Matrix<double,Eigen::Dynamic,9> RotationMatrixBatch;
+
+/**
+ * @brief Computes the atan2 of a batch of values. The fast version is a polynomial
+ * approximation with an absolute error below 2e-6 rad, and it is branchless, so its loop is
+ * vectorized by the compiler
+ * @param Eigen::ArrayXd& Angles in [-pi,pi]
+ * @param const Eigen::ArrayXd& Values of the y coordinates
+ * @param const Eigen::ArrayXd& Values of the x coordinates
+ * @param bool True for using the fast approximation
+ */
+void computeAtan2(Eigen::ArrayXd& angle,
+				  const Eigen::ArrayXd& y,
+				  const Eigen::ArrayXd& x,
+				  bool fast = false);
+
+/**
+ * @brief Computes the sine and cosine of a batch of angles. The fast version reduces the angles
+ * to [-pi/4,pi/4] and evaluates polynomials with an absolute error below 2e-9, where the
+ * reduction loses precision for big angles (e.g. above 1e6 rad)
+ * @param Eigen::ArrayXd& Sine of the angles
+ * @param Eigen::ArrayXd& Cosine of the angles
+ * @param const Eigen::ArrayXd& Angles
+ * @param bool True for using the fast approximation
+ */
+void computeSinCos(Eigen::ArrayXd& sin_angle,
+				   Eigen::ArrayXd& cos_angle,
+				   const Eigen::ArrayXd& angle,
+				   bool fast = false);
+
+/**
+ * @brief Gets the roll, pitch and yaw angles of a batch of quaternions. The batches are stored
+ * as structure of arrays, i.e. every column is a component, so the conversions are loops
+ * over contiguous memory
+ * @param Eigen::MatrixX3d& Roll, pitch and yaw angles, one row per orientation
+ * @param const Eigen::MatrixX4d& Quaternions [x y z w], one row per orientation
+ * @param bool True for using the fast trigonometric approximations
+ */
+void getRPY(Eigen::MatrixX3d& rpy,
+			const Eigen::MatrixX4d& quaternions,
+			bool fast = false);
+
+/**
+ * @brief Gets the roll, pitch and yaw angles of a batch of rotation matrices
+ * @param Eigen::MatrixX3d& Roll, pitch and yaw angles, one row per orientation
+ * @param const RotationMatrixBatch& Rotation matrices, one row per orientation
+ * @param bool True for using the fast trigonometric approximations
+ */
+void getRPY(Eigen::MatrixX3d& rpy,
+			const RotationMatrixBatch& rotations,
+			bool fast = false);
+
+/**
+ * @brief Gets the quaternions of a batch of roll, pitch and yaw angles
+ * @param Eigen::MatrixX4d& Quaternions [x y z w], one row per orientation
+ * @param const Eigen::MatrixX3d& Roll, pitch and yaw angles, one row per orientation
+ * @param bool True for using the fast trigonometric approximations
+ */
+void getQuaternion(Eigen::MatrixX4d& quaternions,
+				   const Eigen::MatrixX3d& rpy,
+				   bool fast = false);
+
+/**
+ * @brief Gets the rotation matrices of a batch of roll, pitch and yaw angles
+ * @param RotationMatrixBatch& Rotation matrices, one row per orientation
+ * @param const Eigen::MatrixX3d& Roll, pitch and yaw angles, one row per orientation
+ * @param bool True for using the fast trigonometric approximations
+ */
+void getRotationMatrix(RotationMatrixBatch& rotations,
+					   const Eigen::MatrixX3d& rpy,
+					   bool fast = false);
+
+/**
+ * @brief Gets the yaw angles of a batch of quaternions without computing the other angles
+ * @param Eigen::VectorXd& Yaw angles
+ * @param const Eigen::MatrixX4d& Quaternions [x y z w], one row per orientation
+ * @param bool True for using the fast trigonometric approximations
+ */
+void getYaw(Eigen::VectorXd& yaw,
+			const Eigen::MatrixX4d& quaternions,
+			bool fast = false);
+
 }
 }
 
+#include <dwl/utils/impl/Orientation.hpp>
+
 #endif
@@ -0,0 +1,154 @@
+#ifndef DWL__RADIX_HEAP__H
+#define DWL__RADIX_HEAP__H
+
+#include <vector>
+
+
+namespace dwl
+{
+
+/**
+ * @class RadixHeap
+ * @brief RadixHeap is a monotone priority queue of integer keys (e.g. quantized costs), where
+ * the popped keys never decrease as in Dijkstra searches with non-negative weights. The values
+ * are stored in buckets by the highest bit that differs from the last popped key, so a push is
+ * O(1) and a pop is amortized O(log C), where C is the range of keys. It doesn't support
+ * decrease-key, so a decreased priority is pushed again and the outdated entries have to be
+ * skipped by the caller. The keys smaller than the last popped one are clamped to it
+ */
+template<typename TValue>
+class RadixHeap
+{
+	public:
+		/** @brief Key of the values */
+		typedef unsigned long long Key;
+
+		/** @brief Constructor function */
+		RadixHeap() : last_key_(0), size_(0) {}
+
+		/** @brief Destructor function */
+		~RadixHeap() {}
+
+		/**
+		 * @brief Pushes a value
+		 * @param Key Key of the value
+		 * @param const TValue& Value
+		 */
+		void push(Key key, const TValue& value) {
+			if (key < last_key_)
+				key = last_key_;
+
+			buckets_[getBucket(key)].push_back(Entry(key, value));
+			size_++;
+		}
+
+		/** @brief Pops a value with the minimum key */
+		void pop() {
+			updateMinimum();
+			buckets_[0].pop_back();
+			size_--;
+		}
+
+		/** @brief Gets a value with the minimum key */
+		const TValue& top() {
+			updateMinimum();
+			return buckets_[0].back().value;
+		}
+
+		/** @brief Gets the minimum key */
+		Key topKey() {
+			updateMinimum();
+			return last_key_;
+		}
+
+		/** @brief Indicates if the heap is empty */
+		bool empty() const {
+			return size_ == 0;
+		}
+
+		/** @brief Gets the number of values in the heap */
+		unsigned int size() const {
+			return size_;
+		}
+
+		/** @brief Clears the heap, where the buckets keep their memory */
+		void clear() {
+			for (unsigned int i = 0; i < NumBuckets; i++)
+				buckets_[i].clear();
+			last_key_ = 0;
+			size_ = 0;
+		}
+
+
+	private:
+		/** @brief Bucket entry */
+		struct Entry
+		{
+			Entry(Key key, const TValue& value) : key(key), value(value) {}
+
+			Key key;
+			TValue value;
+		};
+
+		/** @brief Number of buckets, i.e. one per bit of the keys and the one of the minimum */
+		static const unsigned int NumBuckets = 8 * sizeof(Key) + 1;
+
+		/**
+		 * @brief Gets the bucket of a key, i.e. the position of the highest bit that differs
+		 * from the last popped key
+		 * @param Key Key
+		 */
+		unsigned int getBucket(Key key) const {
+			Key diff = key ^ last_key_;
+			if (diff == 0)
+				return 0;
+#ifdef __GNUC__
+			return 8 * sizeof(Key) - __builtin_clzll(diff);
+#else
+			unsigned int bucket = 0;
+			while (diff != 0) {
+				diff >>= 1;
+				bucket++;
+			}
+			return bucket;
+#endif
+		}
+
+		/**
+		 * @brief Moves the values with the minimum key to the first bucket, where the first
+		 * non-empty bucket is redistributed around its minimum key
+		 */
+		void updateMinimum() {
+			if (!buckets_[0].empty())
+				return;
+
+			unsigned int bucket = 1;
+			while (buckets_[bucket].empty())
+				bucket++;
+
+			std::vector<Entry>& entries = buckets_[bucket];
+			Key min_key = entries[0].key;
+			for (unsigned int i = 1; i < entries.size(); i++) {
+				if (entries[i].key < min_key)
+					min_key = entries[i].key;
+			}
+
+			last_key_ = min_key;
+			for (unsigned int i = 0; i < entries.size(); i++)
+				buckets_[getBucket(entries[i].key)].push_back(entries[i]);
+			entries.clear();
+		}
+
+		/** @brief Buckets of the values */
+		std::vector<Entry> buckets_[NumBuckets];
+
+		/** @brief Last popped key, i.e. the minimum key of the heap */
+		Key last_key_;
+
+		/** @brief Number of values */
+		unsigned int size_;
+};
+
+} //@namespace dwl
+
+#endif
@@ -240,6 +240,387 @@ rbd::Vector6d computePointAcceleration(RigidBodyDynamics::Model& model,
 }
 
 
+void computeCentroidalMomentumMatrix(RigidBodyDynamics::Model& model,
+									 const RigidBodyDynamics::Math::VectorNd& Q,
+									 const RigidBodyDynamics::Math::VectorNd& QDot,
+									 RigidBodyDynamics::Math::MatrixNd& A,
+									 RigidBodyDynamics::Math::SpatialVector& Adot_qdot,
+									 RigidBodyDynamics::Math::Vector3d& com_pos)
+{
+	using namespace RigidBodyDynamics;
+	using namespace RigidBodyDynamics::Math;
+
+	LOG << "-------- " << __func__ << " --------" << std::endl;
+	assert (model.q_size == Q.size());
+	assert (model.qdot_size == QDot.size());
+
+	// Forward pass: computing the kinematics with zero acceleration and without
+	// gravity, and the rate of momentum of every body expressed in the world frame
+	// (at the origin). Note that the bias term of the rate of centroidal momentum
+	// doesn't depend on the CoM velocity since the linear momentum is parallel to it
+	double mass = 0.;
+	Vector3d com_moment = Vector3d::Zero();
+	SpatialVector hdot_0 = SpatialVectorZero;
+	model.v[0].setZero();
+	model.a[0].setZero();
+	for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+		unsigned int lambda = model.lambda[i];
+		jcalc(model, i, Q, QDot);
+
+		model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
+		model.v[i] = model.X_lambda[i].apply(model.v[lambda]) + model.v_J[i];
+		model.c[i] = model.c_J[i] + crossm(model.v[i], model.v_J[i]);
+		model.a[i] = model.X_lambda[i].apply(model.a[lambda]) + model.c[i];
+		model.Ic[i] = model.I[i];
+
+		if (!model.mBodies[i].mIsVirtual) {
+			SpatialVector h_i = model.I[i] * model.v[i];
+			SpatialVector hdot_i = model.I[i] * model.a[i] + crossf(model.v[i], h_i);
+			hdot_0 += model.X_base[i].applyTranspose(hdot_i);
+
+			// Note that the body rotation is the transpose of the world-to-body one
+			const Body& body = model.mBodies[i];
+			mass += body.mMass;
+			com_moment += body.mMass *
+					(model.X_base[i].r + model.X_base[i].E.transpose() * body.mCenterOfMass);
+		}
+	}
+	com_pos = com_moment / mass;
+
+	// Backward pass: computing the composite inertia of every subtree, which maps
+	// the joint velocities to the momentum of the subtree, i.e. A_j = X_j^T Ic_j S_j.
+	// The columns are processed before adding the subtree to the parent one
+	A = MatrixNd::Zero(6, model.qdot_size);
+	for (unsigned int i = model.mBodies.size() - 1; i > 0; i--) {
+		unsigned int q_index = model.mJoints[i].q_index;
+		if (model.mJoints[i].mDoFCount == 3) {
+			A.block<6,3>(0,q_index) = model.X_base[i].toMatrixTranspose() *
+					model.Ic[i].toMatrix() * model.multdof3_S[i];
+		} else {
+			A.block<6,1>(0,q_index) =
+					model.X_base[i].applyTranspose(model.Ic[i] * model.S[i]);
+		}
+
+		unsigned int lambda = model.lambda[i];
+		if (lambda != 0)
+			model.Ic[lambda] = model.Ic[lambda] + model.X_lambda[i].applyTranspose(model.Ic[i]);
+	}
+
+	// Moving the momentum from the world origin to the CoM, i.e. n_com = n_0 - c x f
+	Matrix3d C_com = math::skewSymmetricMatrixFromVector(com_pos);
+	A.topRows<3>() -= C_com * A.bottomRows<3>();
+	Adot_qdot = hdot_0;
+	Adot_qdot.segment<3>(0) -= com_pos.cross(hdot_0.segment<3>(3));
+}
+
+
+void computeCoMKinematics(RigidBodyDynamics::Model& model,
+						  const RigidBodyDynamics::Math::VectorNd& Q,
+						  const RigidBodyDynamics::Math::VectorNd& QDot,
+						  RigidBodyDynamics::Math::Vector3d& com_pos,
+						  RigidBodyDynamics::Math::Vector3d& com_vel,
+						  RigidBodyDynamics::Math::MatrixNd& com_jac,
+						  RigidBodyDynamics::Math::Vector3d& com_jacd_qdot,
+						  bool update_kinematics)
+{
+	using namespace RigidBodyDynamics;
+	using namespace RigidBodyDynamics::Math;
+
+	LOG << "-------- " << __func__ << " --------" << std::endl;
+	assert (model.q_size == Q.size());
+	assert (model.qdot_size == QDot.size());
+
+	if (update_kinematics)
+		UpdateKinematicsCustom(model, &Q, &QDot, NULL);
+
+	// Forward pass: computing the bias acceleration of every body (i.e. without
+	// generalized acceleration), and the first moment, linear momentum and bias rate
+	// of linear momentum of every body expressed in the world frame
+	unsigned int num_bodies = model.mBodies.size();
+	std::vector<SpatialVector, Eigen::aligned_allocator<SpatialVector> > a_bias(num_bodies);
+	std::vector<double> subtree_mass(num_bodies, 0.);
+	std::vector<Vector3d> subtree_moment(num_bodies, Vector3d::Zero());
+	double mass = 0.;
+	Vector3d com_moment = Vector3d::Zero();
+	Vector3d momentum = Vector3d::Zero();
+	Vector3d momentum_rate = Vector3d::Zero();
+	a_bias[0].setZero();
+	for (unsigned int i = 1; i < num_bodies; i++) {
+		a_bias[i] = model.X_lambda[i].apply(a_bias[model.lambda[i]]) + model.c[i];
+		if (model.mBodies[i].mIsVirtual)
+			continue;
+
+		// Getting the classical velocity and bias acceleration of the body CoM. Note that
+		// the body rotation is the transpose of the world-to-body one
+		const Body& body = model.mBodies[i];
+		Matrix3d body_rot = model.X_base[i].E.transpose();
+		Vector3d omega = model.v[i].segment<3>(0);
+		Vector3d body_vel = model.v[i].segment<3>(3) + omega.cross(body.mCenterOfMass);
+		Vector3d body_acc = a_bias[i].segment<3>(3) +
+				a_bias[i].segment<3>(0).cross(body.mCenterOfMass) + omega.cross(body_vel);
+
+		subtree_mass[i] = body.mMass;
+		subtree_moment[i] = body.mMass * (model.X_base[i].r + body_rot * body.mCenterOfMass);
+		mass += body.mMass;
+		com_moment += subtree_moment[i];
+		momentum += body.mMass * body_rot * body_vel;
+		momentum_rate += body.mMass * body_rot * body_acc;
+	}
+
+	// Backward pass: computing the mass and first moment of every subtree. A joint
+	// motion [w; v] (in the world frame) moves the first moment of its subtree with
+	// m_j v + w x h_j, so the columns are processed before adding the subtree to the
+	// parent one
+	com_jac = MatrixNd::Zero(3, model.qdot_size);
+	for (unsigned int i = num_bodies - 1; i > 0; i--) {
+		unsigned int q_index = model.mJoints[i].q_index;
+		SpatialTransform base_X_body = model.X_base[i].inverse();
+		unsigned int num_dof = (model.mJoints[i].mDoFCount == 3) ? 3 : 1;
+		for (unsigned int k = 0; k < num_dof; k++) {
+			SpatialVector S_k = (num_dof == 3) ?
+					SpatialVector(model.multdof3_S[i].col(k)) : model.S[i];
+			SpatialVector S_base = base_X_body.apply(S_k);
+			com_jac.col(q_index + k) = subtree_mass[i] * S_base.segment<3>(3) +
+					S_base.segment<3>(0).cross(subtree_moment[i]);
+		}
+
+		unsigned int lambda = model.lambda[i];
+		if (lambda != 0) {
+			subtree_mass[lambda] += subtree_mass[i];
+			subtree_moment[lambda] += subtree_moment[i];
+		}
+	}
+
+	com_pos = com_moment / mass;
+	com_vel = momentum / mass;
+	com_jac /= mass;
+	com_jacd_qdot = momentum_rate / mass;
+}
+
+
+void updateBranchKinematics(RigidBodyDynamics::Model& model,
+							const RigidBodyDynamics::Math::VectorNd& Q,
+							const RigidBodyDynamics::Math::VectorNd& QDot,
+							const std::vector<unsigned int>& branch_bodies)
+{
+	using namespace RigidBodyDynamics;
+	using namespace RigidBodyDynamics::Math;
+
+	LOG << "-------- " << __func__ << " --------" << std::endl;
+
+	// The parent of every branch body is the previous one (or the root)
+	for (unsigned int k = 0; k < branch_bodies.size(); k++) {
+		unsigned int i = branch_bodies[k];
+		unsigned int lambda = model.lambda[i];
+		jcalc(model, i, Q, QDot);
+
+		if (lambda != 0) {
+			model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
+			model.v[i] = model.X_lambda[i].apply(model.v[lambda]) + model.v_J[i];
+		} else {
+			model.X_base[i] = model.X_lambda[i];
+			model.v[i] = model.v_J[i];
+		}
+		model.c[i] = model.c_J[i] + crossm(model.v[i], model.v_J[i]);
+	}
+}
+
+
+void computeBranchInverseDynamics(RigidBodyDynamics::Model& model,
+								  const RigidBodyDynamics::Math::VectorNd& Q,
+								  const RigidBodyDynamics::Math::VectorNd& QDot,
+								  const RigidBodyDynamics::Math::VectorNd& QDDot,
+								  const std::vector<unsigned int>& branch_bodies,
+								  const std::vector<unsigned int>& subtree_bodies,
+								  RigidBodyDynamics::Math::VectorNd& Tau,
+								  std::vector<RigidBodyDynamics::Math::SpatialVector>* f_ext)
+{
+	using namespace RigidBodyDynamics;
+	using namespace RigidBodyDynamics::Math;
+
+	LOG << "-------- " << __func__ << " --------" << std::endl;
+	if (subtree_bodies.empty())
+		return;
+
+	// Forward pass: computing the velocity and acceleration of the chain bodies before
+	// the subtree, and the ones of the subtree bodies with their forces. Note that the
+	// gravity is the acceleration of the root
+	unsigned int first_body = subtree_bodies[0];
+	unsigned int num_bodies = 0;
+	while (num_bodies < branch_bodies.size() && branch_bodies[num_bodies] < first_body)
+		++num_bodies;
+	num_bodies += subtree_bodies.size();
+	model.v[0].setZero();
+	model.a[0].set(0., 0., 0., -model.gravity[0], -model.gravity[1], -model.gravity[2]);
+	for (unsigned int k = 0; k < num_bodies; k++) {
+		unsigned int num_chain = num_bodies - subtree_bodies.size();
+		unsigned int i = (k < num_chain) ? branch_bodies[k] : subtree_bodies[k - num_chain];
+		unsigned int q_index = model.mJoints[i].q_index;
+		unsigned int lambda = model.lambda[i];
+		jcalc(model, i, Q, QDot);
+
+		if (lambda != 0)
+			model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
+		else
+			model.X_base[i] = model.X_lambda[i];
+
+		model.v[i] = model.X_lambda[i].apply(model.v[lambda]) + model.v_J[i];
+		model.c[i] = model.c_J[i] + crossm(model.v[i], model.v_J[i]);
+
+		if (model.mJoints[i].mDoFCount == 3) {
+			model.a[i] = model.X_lambda[i].apply(model.a[lambda]) + model.c[i] +
+					model.multdof3_S[i] * Vector3d(QDDot[q_index], QDDot[q_index + 1], QDDot[q_index + 2]);
+		} else {
+			model.a[i] = model.X_lambda[i].apply(model.a[lambda]) + model.c[i] + model.S[i] * QDDot[q_index];
+		}
+
+		if (k < num_chain)
+			continue;
+
+		if (!model.mBodies[i].mIsVirtual) {
+			model.f[i] = model.I[i] * model.a[i] + crossf(model.v[i], model.I[i] * model.v[i]);
+		} else {
+			model.f[i].setZero();
+		}
+
+		if (f_ext != NULL && (*f_ext)[i] != SpatialVectorZero)
+			model.f[i] -= model.X_base[i].toMatrixAdjoint() * (*f_ext)[i];
+	}
+
+	// Backward pass: computing the torques of the subtree joints. Note that the forces
+	// of the first subtree body aren't propagated to the chain
+	for (unsigned int k = subtree_bodies.size(); k-- > 0;) {
+		unsigned int i = subtree_bodies[k];
+		unsigned int q_index = model.mJoints[i].q_index;
+		if (model.mJoints[i].mDoFCount == 3) {
+			Tau.block<3,1>(q_index, 0) = model.multdof3_S[i].transpose() * model.f[i];
+		} else {
+			Tau[q_index] = model.S[i].dot(model.f[i]);
+		}
+
+		if (k > 0) {
+			unsigned int lambda = model.lambda[i];
+			model.f[lambda] = model.f[lambda] + model.X_lambda[i].applyTranspose(model.f[i]);
+		}
+	}
+}
+
+bool computeInverseDynamicsDerivatives(RigidBodyDynamics::Model& model,
+									   const RigidBodyDynamics::Math::VectorNd& Q,
+									   const RigidBodyDynamics::Math::VectorNd& QDot,
+									   const RigidBodyDynamics::Math::VectorNd& QDDot,
+									   RigidBodyDynamics::Math::VectorNd& Tau,
+									   RigidBodyDynamics::Math::MatrixNd& dtau_dq,
+									   RigidBodyDynamics::Math::MatrixNd& dtau_dqd,
+									   RigidBodyDynamics::Math::MatrixNd& dtau_dqdd,
+									   std::vector<RigidBodyDynamics::Math::SpatialVector>* f_ext)
+{
+	using namespace RigidBodyDynamics;
+	using namespace RigidBodyDynamics::Math;
+
+	LOG << "-------- " << __func__ << " --------" << std::endl;
+	assert (model.q_size == Q.size());
+	assert (model.qdot_size == QDot.size());
+	assert (model.qdot_size == QDDot.size());
+
+	unsigned int num_bodies = model.mBodies.size();
+	for (unsigned int i = 1; i < num_bodies; i++) {
+		if (model.mJoints[i].mDoFCount != 1)
+			return false;
+	}
+
+	// Forward pass: computing the joint axis (J), its rate (dJ = v x J), the
+	// velocity (v) and acceleration (a) of every body, its inertia (I) and the
+	// forces of its motion (f), all of them expressed in the world frame (at the
+	// origin). Additionally, we compute the variation of the momentum with the
+	// velocity, i.e. B = v x* I - I v x + h x*, where (h x*) is the matrix of
+	// the operator s x* h for a motion s
+	std::vector<SpatialVector> J(num_bodies), dJ(num_bodies), psi(num_bodies);
+	std::vector<SpatialVector> v(num_bodies), a(num_bodies), f(num_bodies), f_e(num_bodies);
+	std::vector<SpatialMatrix> Ic(num_bodies), Bc(num_bodies);
+	v[0].setZero();
+	a[0] = SpatialVector(0., 0., 0., -model.gravity[0], -model.gravity[1], -model.gravity[2]);
+	for (unsigned int i = 1; i < num_bodies; i++) {
+		unsigned int q_index = model.mJoints[i].q_index;
+		unsigned int lambda = model.lambda[i];
+		jcalc(model, i, Q, QDot);
+		model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
+
+		J[i] = model.X_base[i].inverse().apply(model.S[i]);
+		v[i] = v[lambda] + J[i] * QDot(q_index);
+		dJ[i] = crossm(v[i], J[i]);
+		a[i] = a[lambda] + J[i] * QDDot(q_index) + dJ[i] * QDot(q_index);
+		// Variation of the acceleration with the position, i.e. J x a - v x dJ
+		psi[i] = crossm(J[i], a[i]) - crossm(v[i], dJ[i]);
+
+		Ic[i] = model.X_base[i].toMatrixTranspose() *
+				model.I[i].toMatrix() * model.X_base[i].toMatrix();
+		SpatialVector h = Ic[i] * v[i];
+		f[i] = Ic[i] * a[i] + crossf(v[i], h);
+
+		Matrix3d h_ang = math::skewSymmetricMatrixFromVector(h.segment<3>(0));
+		Matrix3d h_lin = math::skewSymmetricMatrixFromVector(h.segment<3>(3));
+		Bc[i] = crossf(v[i]) * Ic[i] - Ic[i] * crossm(v[i]);
+		Bc[i].block<3,3>(0,0) -= h_ang;
+		Bc[i].block<3,3>(0,3) -= h_lin;
+		Bc[i].block<3,3>(3,0) -= h_lin;
+
+		if (f_ext != NULL)
+			f_e[i] = (*f_ext)[i];
+		else
+			f_e[i].setZero();
+	}
+
+	// Backward pass: accumulating the subtree quantities (inertia, momentum
+	// variation and forces), and computing the derivatives. For a joint k and
+	// a joint j of its support (j <= k):
+	//   dtau_k/dq_j = J_k^T (Bc_k dJ_j - Ic_k psi_j) - (J_j x J_k)^T Fe_k
+	//   dtau_k/dqd_j = J_k^T (2 Ic_k dJ_j + Bc_k J_j)
+	//   dtau_k/dqdd_j = J_k^T Ic_k J_j
+	// and, for a joint j of its subtree (k < j):
+	//   dtau_k/dq_j = J_k^T (J_j x* Fb_j + Bc_j dJ_j - Ic_j psi_j)
+	//   dtau_k/dqd_j = J_k^T (2 Ic_j dJ_j + Bc_j J_j)
+	//   dtau_k/dqdd_j = J_k^T Ic_j J_j
+	// where Fb and Fe are the subtree forces of the motion and the external ones
+	Tau = VectorNd::Zero(model.qdot_size);
+	dtau_dq = MatrixNd::Zero(model.qdot_size, model.qdot_size);
+	dtau_dqd = MatrixNd::Zero(model.qdot_size, model.qdot_size);
+	dtau_dqdd = MatrixNd::Zero(model.qdot_size, model.qdot_size);
+	for (unsigned int k = num_bodies - 1; k > 0; k--) {
+		unsigned int k_index = model.mJoints[k].q_index;
+		Tau(k_index) = J[k].dot(f[k] - f_e[k]);
+
+		SpatialVector Ic_J = Ic[k] * J[k];
+		SpatialVector Bc_J = Bc[k].transpose() * J[k];
+		SpatialVector Fe_J = -crossf(J[k], f_e[k]);
+		for (unsigned int j = k; j != 0; j = model.lambda[j]) {
+			unsigned int j_index = model.mJoints[j].q_index;
+			dtau_dq(k_index,j_index) = Bc_J.dot(dJ[j]) - Ic_J.dot(psi[j]) + Fe_J.dot(J[j]);
+			dtau_dqd(k_index,j_index) = 2 * Ic_J.dot(dJ[j]) + Bc_J.dot(J[j]);
+			dtau_dqdd(k_index,j_index) = Ic_J.dot(J[j]);
+		}
+
+		SpatialVector col_q = crossf(J[k], f[k]) + Bc[k] * dJ[k] - Ic[k] * psi[k];
+		SpatialVector col_qd = 2 * Ic[k] * dJ[k] + Bc[k] * J[k];
+		for (unsigned int i = model.lambda[k]; i != 0; i = model.lambda[i]) {
+			unsigned int i_index = model.mJoints[i].q_index;
+			dtau_dq(i_index,k_index) = J[i].dot(col_q);
+			dtau_dqd(i_index,k_index) = J[i].dot(col_qd);
+			dtau_dqdd(i_index,k_index) = J[i].dot(Ic_J);
+		}
+
+		unsigned int lambda = model.lambda[k];
+		if (lambda != 0) {
+			Ic[lambda] += Ic[k];
+			Bc[lambda] += Bc[k];
+			f[lambda] += f[k];
+			f_e[lambda] += f_e[k];
+		}
+	}
+
+	return true;
+}
+
 void FloatingBaseInverseDynamics(RigidBodyDynamics::Model& model,
 								 const RigidBodyDynamics::Math::VectorNd &Q,
 								 const RigidBodyDynamics::Math::VectorNd &QDot,
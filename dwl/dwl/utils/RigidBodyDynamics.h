@@ -3,6 +3,7 @@
 
 #include <rbdl/rbdl.h>
 #include <dwl/utils/Math.h>
+#include <dwl/utils/BodyContainer.h>
 
 
 namespace dwl
@@ -21,6 +22,8 @@ typedef std::map<std::string,unsigned int> BodyID;
 typedef std::map<std::string,Eigen::Vector3d> BodyVector3d;
 typedef std::map<std::string,Eigen::VectorXd> BodyVectorXd;
 typedef std::map<std::string,Vector6d> BodyVector6d;
+typedef BodyContainer<Eigen::Vector3d> BodyContainer3d;
+typedef BodyContainer<Vector6d> BodyContainer6d;
 
 /**
  * @brief Vector coordinates
@@ -129,6 +132,128 @@ rbd::Vector6d computePointAcceleration(RigidBodyDynamics::Model& model,
 									   const Eigen::Vector3d point_position,
 									   bool update_kinematics);
 
+/**
+ * @brief Computes the centroidal momentum matrix and its bias term (i.e. the time
+ * derivative of the matrix times the generalized velocity) in a single pass
+ * over the bodies, i.e. with the Centroidal Composite Rigid Body Algorithm.
+ * The centroidal momentum is expressed in a frame located at the CoM and
+ * parallel to the world frame, with the order [angular, linear], and the
+ * columns follow the generalized velocity of RBDL
+ * @param RigidBodyDynamics::Model& Model of the rigid-body system
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint position
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint velocity
+ * @param RigidBodyDynamics::Math::MatrixNd& Centroidal momentum matrix
+ * @param RigidBodyDynamics::Math::SpatialVector& Bias term of the rate of the
+ * centroidal momentum
+ * @param RigidBodyDynamics::Math::Vector3d& CoM position
+ */
+void computeCentroidalMomentumMatrix(RigidBodyDynamics::Model& model,
+									 const RigidBodyDynamics::Math::VectorNd& Q,
+									 const RigidBodyDynamics::Math::VectorNd& QDot,
+									 RigidBodyDynamics::Math::MatrixNd& A,
+									 RigidBodyDynamics::Math::SpatialVector& Adot_qdot,
+									 RigidBodyDynamics::Math::Vector3d& com_pos);
+
+/**
+ * @brief Computes the CoM position, velocity, Jacobian and its bias acceleration
+ * (i.e. the time derivative of the Jacobian times the generalized velocity) in a
+ * single pass over the bodies. The Jacobian columns are computed from the mass
+ * and first moment of every subtree, so the tree isn't traversed per body. The
+ * quantities are expressed in the world frame, and the columns follow the
+ * generalized velocity of RBDL. Note that the bias accelerations are computed
+ * from the velocity terms of the model, so its acceleration isn't modified
+ * @param RigidBodyDynamics::Model& Model of the rigid-body system
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint position
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint velocity
+ * @param RigidBodyDynamics::Math::Vector3d& CoM position
+ * @param RigidBodyDynamics::Math::Vector3d& CoM velocity
+ * @param RigidBodyDynamics::Math::MatrixNd& CoM Jacobian
+ * @param RigidBodyDynamics::Math::Vector3d& CoM bias acceleration
+ * @param bool Update kinematic state (position and velocity)
+ */
+void computeCoMKinematics(RigidBodyDynamics::Model& model,
+						  const RigidBodyDynamics::Math::VectorNd& Q,
+						  const RigidBodyDynamics::Math::VectorNd& QDot,
+						  RigidBodyDynamics::Math::Vector3d& com_pos,
+						  RigidBodyDynamics::Math::Vector3d& com_vel,
+						  RigidBodyDynamics::Math::MatrixNd& com_jac,
+						  RigidBodyDynamics::Math::Vector3d& com_jacd_qdot,
+						  bool update_kinematics = true);
+
+/**
+ * @brief Updates the kinematics (the body transforms and velocities) of a branch,
+ * i.e. of the movable bodies of the chain from the root to a body. The other bodies
+ * aren't updated, so only the queries of this branch (e.g. its point positions and
+ * Jacobians without updating the kinematics) are valid
+ * @param RigidBodyDynamics::Model& Model of the rigid-body system
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint position
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint velocity
+ * @param const std::vector<unsigned int>& Movable bodies of the branch, ordered from
+ * the root
+ */
+void updateBranchKinematics(RigidBodyDynamics::Model& model,
+							const RigidBodyDynamics::Math::VectorNd& Q,
+							const RigidBodyDynamics::Math::VectorNd& QDot,
+							const std::vector<unsigned int>& branch_bodies);
+
+/**
+ * @brief Computes the inverse dynamics of the joints of a branch with the Recursive
+ * Newton-Euler algorithm restricted to the branch, i.e. the forward pass traverses
+ * the chain from the root and the subtree of the first branch joint, and the
+ * backward pass only the subtree. So, only the torques of the subtree joints are
+ * computed (the other ones aren't modified)
+ * @param RigidBodyDynamics::Model& Model of the rigid-body system
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint position
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint velocity
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint acceleration
+ * @param const std::vector<unsigned int>& Movable bodies of the branch, ordered from
+ * the root
+ * @param const std::vector<unsigned int>& Movable bodies of the subtree of the first
+ * branch joint, ordered from it
+ * @param RigidBodyDynamics::Math::VectorNd& Generalized joint torques
+ * @param std::vector<RigidBodyDynamics::Math::SpatialVector>* External forces
+ * expressed in the base frame
+ */
+void computeBranchInverseDynamics(RigidBodyDynamics::Model& model,
+								  const RigidBodyDynamics::Math::VectorNd& Q,
+								  const RigidBodyDynamics::Math::VectorNd& QDot,
+								  const RigidBodyDynamics::Math::VectorNd& QDDot,
+								  const std::vector<unsigned int>& branch_bodies,
+								  const std::vector<unsigned int>& subtree_bodies,
+								  RigidBodyDynamics::Math::VectorNd& Tau,
+								  std::vector<RigidBodyDynamics::Math::SpatialVector>* f_ext = NULL);
+
+/**
+ * @brief Computes the inverse dynamics and its analytical partial derivatives
+ * with respect to the generalized position, velocity and acceleration, i.e. as
+ * in Carpentier and Mansard (RSS 2018). The recursions are done with the
+ * spatial quantities expressed in the world frame, which makes the derivatives
+ * a second backward pass of the Recursive Newton-Euler Algorithm. The partial
+ * derivative with respect to the acceleration is the joint-space inertia
+ * matrix. Note that the external forces are expressed in base coordinates, as
+ * in RBDL, and they are considered constant, and that only joints with one
+ * degree of freedom are supported (a floating joint is described by six of them)
+ * @param RigidBodyDynamics::Model& Model of the rigid-body system
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint position
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint velocity
+ * @param const RigidBodyDynamics::Math::VectorNd& Generalized joint acceleration
+ * @param RigidBodyDynamics::Math::VectorNd& Joint forces
+ * @param RigidBodyDynamics::Math::MatrixNd& Derivative w.r.t. the position
+ * @param RigidBodyDynamics::Math::MatrixNd& Derivative w.r.t. the velocity
+ * @param RigidBodyDynamics::Math::MatrixNd& Derivative w.r.t. the acceleration
+ * @param std::vector<RigidBodyDynamcis::Math::SpatialVector>* Applied external forces
+ * @return False if the model has multi-DoF joints
+ */
+bool computeInverseDynamicsDerivatives(RigidBodyDynamics::Model& model,
+									   const RigidBodyDynamics::Math::VectorNd& Q,
+									   const RigidBodyDynamics::Math::VectorNd& QDot,
+									   const RigidBodyDynamics::Math::VectorNd& QDDot,
+									   RigidBodyDynamics::Math::VectorNd& Tau,
+									   RigidBodyDynamics::Math::MatrixNd& dtau_dq,
+									   RigidBodyDynamics::Math::MatrixNd& dtau_dqd,
+									   RigidBodyDynamics::Math::MatrixNd& dtau_dqdd,
+									   std::vector<RigidBodyDynamics::Math::SpatialVector>* f_ext = NULL);
+
 /**
  * @brief Computes the floating-base inverse dynamics
  * @param RigidBodyDynamcis::Model& Model of the rigid-body system
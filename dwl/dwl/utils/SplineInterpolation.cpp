@@ -1,4 +1,6 @@
 #include <dwl/utils/SplineInterpolation.h>
+#include <dwl/utils/Macros.h>
+#include <algorithm>
 
 
 namespace dwl
@@ -281,5 +283,313 @@ bool LinearSpline::getPoint(const double& current_time,
 	return true;
 }
 
+
+MultiCubicSpline::MultiCubicSpline() : initial_time_(0.), duration_(0.)
+{
+
+}
+
+
+MultiCubicSpline::~MultiCubicSpline()
+{
+
+}
+
+
+void MultiCubicSpline::setBoundary(const double& initial_time,
+								   const double& duration,
+								   const Eigen::VectorXd& start_pos,
+								   const Eigen::VectorXd& start_vel,
+								   const Eigen::VectorXd& end_pos,
+								   const Eigen::VectorXd& end_vel)
+{
+	initial_time_ = initial_time;
+	duration_ = duration;
+
+	// Computing the spline coefficients of all the channels, note that a zero duration
+	// keeps the start point
+	a0_ = start_pos.array();
+	if (duration_ == 0.) {
+		a1_.setZero(a0_.size());
+		a2_.setZero(a0_.size());
+		a3_.setZero(a0_.size());
+		return;
+	}
+
+	double T1 = duration_;
+	double T2 = duration_ * T1;
+	double T3 = duration_ * T2;
+	a1_ = start_vel.array();
+	a2_ = -((3 * a0_) - (3 * end_pos.array()) + (2 * T1 * a1_) + (T1 * end_vel.array())) / T2;
+	a3_ = ((2 * a0_) - (2 * end_pos.array()) + T1 * (a1_ + end_vel.array())) / T3;
+}
+
+
+void MultiCubicSpline::setBoundary(const double& initial_time,
+								   const double& duration,
+								   const Eigen::VectorXd& start_pos,
+								   const Eigen::VectorXd& end_pos)
+{
+	Eigen::VectorXd zero_vel = Eigen::VectorXd::Zero(start_pos.size());
+	setBoundary(initial_time, duration, start_pos, zero_vel, end_pos, zero_vel);
+}
+
+
+bool MultiCubicSpline::getPoint(const double& current_time,
+								Eigen::VectorXd& pos,
+								Eigen::VectorXd& vel,
+								Eigen::VectorXd& acc) const
+{
+	double dt = current_time - initial_time_;
+	if (dt > duration_)
+		dt = duration_;
+
+	// sanity checks
+	if (dt < 0)
+		return false;
+
+	// interpolated point of all the channels
+	double dt2 = dt * dt;
+	pos = (a0_ + a1_ * dt + a2_ * dt2 + a3_ * (dt * dt2)).matrix();
+	vel = (a1_ + 2 * a2_ * dt + 3 * a3_ * dt2).matrix();
+	acc = (2 * a2_ + 6 * a3_ * dt).matrix();
+
+	return true;
+}
+
+
+bool MultiCubicSpline::getPoint(const double& current_time,
+								Eigen::VectorXd& pos) const
+{
+	double dt = current_time - initial_time_;
+	if (dt > duration_)
+		dt = duration_;
+
+	// sanity checks
+	if (dt < 0)
+		return false;
+
+	double dt2 = dt * dt;
+	pos = (a0_ + a1_ * dt + a2_ * dt2 + a3_ * (dt * dt2)).matrix();
+
+	return true;
+}
+
+
+void MultiCubicSpline::getPoints(const Eigen::VectorXd& times,
+								 Eigen::MatrixXd& pos,
+								 Eigen::MatrixXd& vel,
+								 Eigen::MatrixXd& acc) const
+{
+	// Computing the powers of the elapsed times as row vectors
+	Eigen::RowVectorXd dt = (times.array() - initial_time_).min(duration_).matrix().transpose();
+	Eigen::RowVectorXd dt2 = dt.cwiseProduct(dt);
+	Eigen::RowVectorXd dt3 = dt2.cwiseProduct(dt);
+	Eigen::RowVectorXd ones = Eigen::RowVectorXd::Ones(times.size());
+
+	// Interpolating all the points of all the channels as outer products
+	pos.noalias() = a0_.matrix() * ones + a1_.matrix() * dt + a2_.matrix() * dt2 +
+			a3_.matrix() * dt3;
+	vel.noalias() = a1_.matrix() * ones + 2 * a2_.matrix() * dt + 3 * a3_.matrix() * dt2;
+	acc.noalias() = 2 * a2_.matrix() * ones + 6 * a3_.matrix() * dt;
+}
+
+
+unsigned int MultiCubicSpline::getNumberOfChannels() const
+{
+	return a0_.size();
+}
+
+MultiKnotCubicSpline::MultiKnotCubicSpline()
+{
+
+}
+
+
+MultiKnotCubicSpline::~MultiKnotCubicSpline()
+{
+
+}
+
+
+bool MultiKnotCubicSpline::fit(const Eigen::VectorXd& times,
+							   const Eigen::MatrixXd& positions,
+							   const Eigen::VectorXd& start_vel,
+							   const Eigen::VectorXd& end_vel)
+{
+	if (!setKnots(times, positions))
+		return false;
+
+	// The clamped boundaries are the first and last equations, i.e. the differences between
+	// the boundary velocities and the slopes of the first and last segments
+	unsigned int n = times_.size() - 1;
+	accelerations_.col(0) = 6 * ((positions_.col(1) - positions_.col(0)) / durations_(0) -
+			start_vel);
+	accelerations_.col(n) = 6 * (end_vel -
+			(positions_.col(n) - positions_.col(n-1)) / durations_(n-1));
+	solveTridiagonal(2 * durations_(0), durations_(0), durations_(n-1), 2 * durations_(n-1));
+	return true;
+}
+
+
+bool MultiKnotCubicSpline::fit(const Eigen::VectorXd& times,
+							   const Eigen::MatrixXd& positions)
+{
+	if (!setKnots(times, positions))
+		return false;
+
+	// The natural boundaries are the first and last equations, i.e. zero accelerations
+	unsigned int n = times_.size() - 1;
+	accelerations_.col(0).setZero();
+	accelerations_.col(n).setZero();
+	solveTridiagonal(1., 0., 0., 1.);
+	return true;
+}
+
+
+bool MultiKnotCubicSpline::getPoint(const double& current_time,
+									Eigen::VectorXd& pos,
+									Eigen::VectorXd& vel,
+									Eigen::VectorXd& acc) const
+{
+	unsigned int i;
+	double dt;
+	if (!getSegment(i, dt, current_time))
+		return false;
+
+	// Interpolating all the channels from the positions and accelerations of the knots
+	double h = durations_(i);
+	double a = 1. - dt / h;
+	double b = dt / h;
+	pos = a * positions_.col(i) + b * positions_.col(i+1) +
+			(h * h / 6) * ((a * a * a - a) * accelerations_.col(i) +
+					(b * b * b - b) * accelerations_.col(i+1));
+	vel = (positions_.col(i+1) - positions_.col(i)) / h +
+			(h / 6) * ((1. - 3 * a * a) * accelerations_.col(i) +
+					(3 * b * b - 1.) * accelerations_.col(i+1));
+	acc = a * accelerations_.col(i) + b * accelerations_.col(i+1);
+
+	return true;
+}
+
+
+bool MultiKnotCubicSpline::getPoint(const double& current_time,
+									Eigen::VectorXd& pos) const
+{
+	unsigned int i;
+	double dt;
+	if (!getSegment(i, dt, current_time))
+		return false;
+
+	double h = durations_(i);
+	double a = 1. - dt / h;
+	double b = dt / h;
+	pos = a * positions_.col(i) + b * positions_.col(i+1) +
+			(h * h / 6) * ((a * a * a - a) * accelerations_.col(i) +
+					(b * b * b - b) * accelerations_.col(i+1));
+
+	return true;
+}
+
+
+unsigned int MultiKnotCubicSpline::getNumberOfChannels() const
+{
+	return positions_.rows();
+}
+
+
+unsigned int MultiKnotCubicSpline::getNumberOfKnots() const
+{
+	return times_.size();
+}
+
+
+bool MultiKnotCubicSpline::setKnots(const Eigen::VectorXd& times,
+									const Eigen::MatrixXd& positions)
+{
+	unsigned int num_knots = times.size();
+	if (num_knots < 2 || positions.cols() != num_knots ||
+			(times.tail(num_knots - 1) - times.head(num_knots - 1)).minCoeff() <= 0.) {
+		printf(YELLOW "Warning: the knot times of the spline have to be increasing, and one per"
+				" column\n" COLOR_RESET);
+		return false;
+	}
+
+	times_ = times;
+	durations_ = times.tail(num_knots - 1) - times.head(num_knots - 1);
+	positions_ = positions;
+
+	// Computing the right-hand side of the interior knots, i.e. the differences of the slopes
+	// of the consecutive segments
+	accelerations_.resize(positions.rows(), num_knots);
+	for (unsigned int i = 1; i < num_knots - 1; i++) {
+		accelerations_.col(i) = 6 * ((positions.col(i+1) - positions.col(i)) / durations_(i) -
+				(positions.col(i) - positions.col(i-1)) / durations_(i-1));
+	}
+
+	return true;
+}
+
+
+void MultiKnotCubicSpline::solveTridiagonal(double start_diag,
+											double start_upper,
+											double end_lower,
+											double end_diag)
+{
+	// Eliminating the lower diagonal, where the pivots depend only on the knot times, so they
+	// are shared by all the channels. The interior rows are
+	// h_{i-1} m_{i-1} + 2 (h_{i-1} + h_i) m_i + h_i m_{i+1} = rhs_i
+	unsigned int n = times_.size() - 1;
+	upper_.resize(n + 1);
+	inv_pivots_.resize(n + 1);
+	inv_pivots_(0) = 1. / start_diag;
+	upper_(0) = start_upper * inv_pivots_(0);
+	accelerations_.col(0) *= inv_pivots_(0);
+	for (unsigned int i = 1; i <= n; i++) {
+		double lower, diag, upper;
+		if (i < n) {
+			lower = durations_(i-1);
+			diag = 2 * (durations_(i-1) + durations_(i));
+			upper = durations_(i);
+		} else {
+			lower = end_lower;
+			diag = end_diag;
+			upper = 0.;
+		}
+
+		inv_pivots_(i) = 1. / (diag - lower * upper_(i-1));
+		upper_(i) = upper * inv_pivots_(i);
+		accelerations_.col(i) = (accelerations_.col(i) - lower * accelerations_.col(i-1)) *
+				inv_pivots_(i);
+	}
+
+	// Back substitution of all the channels
+	for (int i = n - 1; i >= 0; i--)
+		accelerations_.col(i) -= upper_(i) * accelerations_.col(i+1);
+}
+
+
+bool MultiKnotCubicSpline::getSegment(unsigned int& index,
+									  double& dt,
+									  const double& current_time) const
+{
+	// sanity checks
+	if (times_.size() < 2 || current_time < times_(0))
+		return false;
+
+	// Searching the segment, where the times after the last knot are saturated
+	unsigned int n = times_.size() - 1;
+	const double* begin = times_.data();
+	index = std::upper_bound(begin, begin + n + 1, current_time) - begin;
+	index = (index == 0) ? 0 : index - 1;
+	if (index >= n) {
+		index = n - 1;
+		dt = durations_(index);
+	} else
+		dt = current_time - times_(index);
+
+	return true;
+}
+
 } //@namespace utils
 } //@namespace dwl
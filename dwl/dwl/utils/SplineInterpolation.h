@@ -1,6 +1,7 @@
 #ifndef DWL__MATH__SPLINE_INTERPOLATION__H
 #define DWL__MATH__SPLINE_INTERPOLATION__H
 
+#include <Eigen/Dense>
 #include <stdexcept>
 
 
@@ -246,7 +247,440 @@ class LinearSpline : public Spline
 					  double& p);
 };
 
+
+/**
+ * @brief MultiCubicSpline class defines a cubic spline interpolation of a set of channels (e.g.
+ * the base and joint states) that share the same time interval. The coefficients of all the
+ * channels are stored as Eigen arrays, so a point of every channel is interpolated together
+ * with array operations instead of one spline per channel
+ */
+class MultiCubicSpline
+{
+	public:
+		/** @brief Constructor function */
+		MultiCubicSpline();
+
+		/** @ Destructor function */
+		~MultiCubicSpline();
+
+		/**
+		 * @brief Sets the boundary of the spline
+		 * @param const double& Initial time
+		 * @param const double& Duration of the spline
+		 * @param const Eigen::VectorXd& Start position of the channels
+		 * @param const Eigen::VectorXd& Start velocity of the channels
+		 * @param const Eigen::VectorXd& End position of the channels
+		 * @param const Eigen::VectorXd& End velocity of the channels
+		 */
+		void setBoundary(const double& initial_time,
+						 const double& duration,
+						 const Eigen::VectorXd& start_pos,
+						 const Eigen::VectorXd& start_vel,
+						 const Eigen::VectorXd& end_pos,
+						 const Eigen::VectorXd& end_vel);
+
+		/**
+		 * @brief Sets the boundary of the spline with zero velocities
+		 * @param const double& Initial time
+		 * @param const double& Duration of the spline
+		 * @param const Eigen::VectorXd& Start position of the channels
+		 * @param const Eigen::VectorXd& End position of the channels
+		 */
+		void setBoundary(const double& initial_time,
+						 const double& duration,
+						 const Eigen::VectorXd& start_pos,
+						 const Eigen::VectorXd& end_pos);
+
+		/**
+		 * @brief Gets the value of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Eigen::VectorXd& Position of the channels
+		 * @param Eigen::VectorXd& Velocity of the channels
+		 * @param Eigen::VectorXd& Acceleration of the channels
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Eigen::VectorXd& pos,
+					  Eigen::VectorXd& vel,
+					  Eigen::VectorXd& acc) const;
+
+		/**
+		 * @brief Gets the position of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Eigen::VectorXd& Position of the channels
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Eigen::VectorXd& pos) const;
+
+		/**
+		 * @brief Gets the value of the channels for a set of times, where every column is the
+		 * interpolated point of a time. The times have to be inside the spline interval
+		 * @param const Eigen::VectorXd& Times of the points
+		 * @param Eigen::MatrixXd& Position of the channels
+		 * @param Eigen::MatrixXd& Velocity of the channels
+		 * @param Eigen::MatrixXd& Acceleration of the channels
+		 */
+		void getPoints(const Eigen::VectorXd& times,
+					   Eigen::MatrixXd& pos,
+					   Eigen::MatrixXd& vel,
+					   Eigen::MatrixXd& acc) const;
+
+		/** @brief Gets the number of channels */
+		unsigned int getNumberOfChannels() const;
+
+
+	private:
+		/** @brief Initial time of the spline */
+		double initial_time_;
+
+		/** @brief Duration of the spline */
+		double duration_;
+
+		/** @brief Spline coefficients of the channels */
+		Eigen::ArrayXd a0_;
+		Eigen::ArrayXd a1_;
+		Eigen::ArrayXd a2_;
+		Eigen::ArrayXd a3_;
+};
+
+
+/**
+ * @brief MultiKnotCubicSpline class defines a global C2 cubic spline of a set of channels over N
+ * knots, i.e. the positions, velocities and accelerations are continuous at the knots. The
+ * accelerations of the knots are the solution of a tridiagonal system that depends only on the
+ * knot times, so its forward elimination (Thomas algorithm) is computed once and applied to all
+ * the channels together. Hence, the fitting is O(N M) for M channels in a single pass, instead
+ * of one spline per pair of knots
+ */
+class MultiKnotCubicSpline
+{
+	public:
+		/** @brief Constructor function */
+		MultiKnotCubicSpline();
+
+		/** @ Destructor function */
+		~MultiKnotCubicSpline();
+
+		/**
+		 * @brief Fits the spline with clamped boundaries, i.e. the start and end velocities
+		 * @param const Eigen::VectorXd& Times of the knots, which have to be increasing
+		 * @param const Eigen::MatrixXd& Positions of the channels, where every column is a knot
+		 * @param const Eigen::VectorXd& Start velocity of the channels
+		 * @param const Eigen::VectorXd& End velocity of the channels
+		 * @return False if there are less than two knots or the times aren't increasing
+		 */
+		bool fit(const Eigen::VectorXd& times,
+				 const Eigen::MatrixXd& positions,
+				 const Eigen::VectorXd& start_vel,
+				 const Eigen::VectorXd& end_vel);
+
+		/**
+		 * @brief Fits the spline with natural boundaries, i.e. zero start and end accelerations
+		 * @param const Eigen::VectorXd& Times of the knots, which have to be increasing
+		 * @param const Eigen::MatrixXd& Positions of the channels, where every column is a knot
+		 * @return False if there are less than two knots or the times aren't increasing
+		 */
+		bool fit(const Eigen::VectorXd& times,
+				 const Eigen::MatrixXd& positions);
+
+		/**
+		 * @brief Gets the value of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Eigen::VectorXd& Position of the channels
+		 * @param Eigen::VectorXd& Velocity of the channels
+		 * @param Eigen::VectorXd& Acceleration of the channels
+		 * @return False if the current time is before the first knot
+		 */
+		bool getPoint(const double& current_time,
+					  Eigen::VectorXd& pos,
+					  Eigen::VectorXd& vel,
+					  Eigen::VectorXd& acc) const;
+
+		/**
+		 * @brief Gets the position of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Eigen::VectorXd& Position of the channels
+		 * @return False if the current time is before the first knot
+		 */
+		bool getPoint(const double& current_time,
+					  Eigen::VectorXd& pos) const;
+
+		/** @brief Gets the number of channels */
+		unsigned int getNumberOfChannels() const;
+
+		/** @brief Gets the number of knots */
+		unsigned int getNumberOfKnots() const;
+
+
+	private:
+		/**
+		 * @brief Sets the knots of the spline, and the right-hand side of the interior knots
+		 * @param const Eigen::VectorXd& Times of the knots
+		 * @param const Eigen::MatrixXd& Positions of the channels
+		 * @return False if there are less than two knots or the times aren't increasing
+		 */
+		bool setKnots(const Eigen::VectorXd& times,
+					  const Eigen::MatrixXd& positions);
+
+		/**
+		 * @brief Solves the tridiagonal system of the knot accelerations for all the channels,
+		 * where the right-hand side is stored in the accelerations
+		 * @param double First diagonal element, i.e. the start boundary condition
+		 * @param double First upper diagonal element
+		 * @param double Last lower diagonal element, i.e. the end boundary condition
+		 * @param double Last diagonal element
+		 */
+		void solveTridiagonal(double start_diag,
+							  double start_upper,
+							  double end_lower,
+							  double end_diag);
+
+		/**
+		 * @brief Gets the segment of a time, and its elapsed time saturated by the last knot
+		 * @param unsigned int& Index of the segment
+		 * @param double& Elapsed time of the segment
+		 * @param const double& Current time
+		 * @return False if the current time is before the first knot
+		 */
+		bool getSegment(unsigned int& index,
+						double& dt,
+						const double& current_time) const;
+
+		/** @brief Times of the knots and durations of the segments */
+		Eigen::VectorXd times_;
+		Eigen::VectorXd durations_;
+
+		/** @brief Positions and accelerations of the channels at the knots [channels x knots] */
+		Eigen::MatrixXd positions_;
+		Eigen::MatrixXd accelerations_;
+
+		/** @brief Forward elimination of the tridiagonal system, i.e. the modified upper
+		 * diagonal and the inverse of the pivots */
+		Eigen::VectorXd upper_;
+		Eigen::VectorXd inv_pivots_;
+};
+
+
+/**
+ * @brief SplineN class defines the common boundary of the splines of N channels, where the
+ * number of channels is defined at compile time. All the channels share the same time interval,
+ * and they are evaluated together with fixed-size Eigen arrays. Contrary to the Spline class,
+ * there aren't virtual calls
+ */
+template<int N>
+class SplineN
+{
+	public:
+		typedef Eigen::Matrix<double,N,1> Vector;
+		typedef Eigen::Array<double,N,1> Array;
+
+		struct Point {
+			Point() { setZero(); }
+			Point(const Vector& p,
+				  const Vector& v = Vector::Zero(),
+				  const Vector& a = Vector::Zero()) : x(p), xd(v), xdd(a) {}
+			void setZero() {
+				x.setZero();
+				xd.setZero();
+				xdd.setZero();}
+			Vector x;
+			Vector xd;
+			Vector xdd;
+			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+		};
+
+		/** @brief Constructor function */
+		SplineN();
+
+		/** @brief Gets the initial time of the spline */
+		double getInitialTime() const;
+
+		/** @brief Gets the duration of the spline */
+		double getDuration() const;
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+
+	protected:
+		/**
+		 * @brief Gets the elapsed time of the spline, which is saturated by the duration
+		 * @param double& Elapsed time
+		 * @param const double& Current time
+		 * @return False if the current time is before the initial time
+		 */
+		bool getElapsedTime(double& dt,
+							const double& current_time) const;
+
+		/** @brief Initial time of the spline */
+		double initial_time_;
+
+		/** @brief Duration of the spline */
+		double duration_;
+};
+
+
+/**
+ * @brief CubicSplineN class defines a cubic spline interpolation of N channels
+ */
+template<int N>
+class CubicSplineN : public SplineN<N>
+{
+	public:
+		typedef typename SplineN<N>::Vector Vector;
+		typedef typename SplineN<N>::Array Array;
+		typedef typename SplineN<N>::Point Point;
+
+		/** @brief Constructor function */
+		CubicSplineN();
+
+		/**
+		 * @brief Sets the boundary of the spline, and computes its coefficients
+		 * @param const double& Initial time
+		 * @param const double& Duration of the spline
+		 * @param const Point& Start point
+		 * @param const Point& End point
+		 */
+		void setBoundary(const double& initial_time,
+						 const double& duration,
+						 const Point& start,
+						 const Point& end);
+
+		/**
+		 * @brief Gets the value of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Point& Point value
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Point& p) const;
+
+		/**
+		 * @brief Gets the position of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Vector& Position value
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Vector& p) const;
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+
+	private:
+		/** @brief Spline coefficients of the channels */
+		Array a0_, a1_, a2_, a3_;
+};
+
+
+/**
+ * @brief FifthOrderPolySplineN class defines a 5-order spline interpolation of N channels
+ */
+template<int N>
+class FifthOrderPolySplineN : public SplineN<N>
+{
+	public:
+		typedef typename SplineN<N>::Vector Vector;
+		typedef typename SplineN<N>::Array Array;
+		typedef typename SplineN<N>::Point Point;
+
+		/** @brief Constructor function */
+		FifthOrderPolySplineN();
+
+		/**
+		 * @brief Sets the boundary of the spline, and computes its coefficients
+		 * @param const double& Initial time
+		 * @param const double& Duration of the spline
+		 * @param const Point& Start point
+		 * @param const Point& End point
+		 */
+		void setBoundary(const double& initial_time,
+						 const double& duration,
+						 const Point& start,
+						 const Point& end);
+
+		/**
+		 * @brief Gets the value of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Point& Point value
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Point& p) const;
+
+		/**
+		 * @brief Gets the position of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Vector& Position value
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Vector& p) const;
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+
+	private:
+		/** @brief Spline coefficients of the channels */
+		Array a0_, a1_, a2_, a3_, a4_, a5_;
+};
+
+
+/**
+ * @brief LinearSplineN class defines a linear spline interpolation of N channels
+ */
+template<int N>
+class LinearSplineN : public SplineN<N>
+{
+	public:
+		typedef typename SplineN<N>::Vector Vector;
+		typedef typename SplineN<N>::Array Array;
+		typedef typename SplineN<N>::Point Point;
+
+		/** @brief Constructor function */
+		LinearSplineN();
+
+		/**
+		 * @brief Sets the boundary of the spline, and computes its coefficients
+		 * @param const double& Initial time
+		 * @param const double& Duration of the spline
+		 * @param const Point& Start point
+		 * @param const Point& End point
+		 */
+		void setBoundary(const double& initial_time,
+						 const double& duration,
+						 const Point& start,
+						 const Point& end);
+
+		/**
+		 * @brief Gets the value of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Point& Point value
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Point& p) const;
+
+		/**
+		 * @brief Gets the position of the channels according to the spline interpolation
+		 * @param const double& Current time
+		 * @param Vector& Position value
+		 * @return False if the current time is before the initial time
+		 */
+		bool getPoint(const double& current_time,
+					  Vector& p) const;
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+
+	private:
+		/** @brief Spline coefficients of the channels */
+		Array a0_, a1_;
+};
+
 } //@namespace utils
 } //@namespace dwl
 
+#include <dwl/utils/impl/SplineInterpolation.hpp>
+
 #endif
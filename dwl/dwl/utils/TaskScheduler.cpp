@@ -0,0 +1,267 @@
+#include <dwl/utils/TaskScheduler.h>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/** @brief Scheduler and queue of the calling worker thread */
+static thread_local const TaskScheduler* current_scheduler = NULL;
+static thread_local unsigned int current_queue = 0;
+
+/** @brief Default scheduler and its configuration */
+static std::mutex default_mutex;
+static std::unique_ptr<TaskScheduler> default_scheduler;
+static unsigned int default_num_workers = 0;
+static std::vector<int> default_cores;
+
+
+TaskScheduler::TaskScheduler(unsigned int num_workers,
+							 const std::vector<int>& cores) : num_queued_jobs_(0),
+		max_parallelism_(0), stop_(false)
+{
+	if (num_workers == 0) {
+		if (!cores.empty())
+			num_workers = cores.size();
+		else
+			num_workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	// Creating the queues of the workers, and the one of the external threads
+	for (unsigned int i = 0; i < num_workers + 1; i++)
+		queues_.push_back(std::unique_ptr<JobQueue>(new JobQueue()));
+
+	for (unsigned int i = 0; i < num_workers; i++) {
+		workers_.push_back(std::thread([this, i, cores] {
+			if (!cores.empty())
+				setThreadAffinity(std::vector<int>(1, cores[i % cores.size()]));
+			workerLoop(i);
+		}));
+	}
+}
+
+
+TaskScheduler::~TaskScheduler()
+{
+	stop_ = true;
+	notifyAll();
+
+	for (unsigned int i = 0; i < workers_.size(); i++)
+		workers_[i].join();
+}
+
+
+void TaskScheduler::parallelFor(unsigned int num_tasks,
+								const Task& task,
+								unsigned int max_parallelism)
+{
+	// Getting the number of threads of the region, where the calling thread is one of them
+	unsigned int parallelism = workers_.size() + 1;
+	unsigned int global_parallelism = max_parallelism_.load(std::memory_order_relaxed);
+	if (global_parallelism != 0)
+		parallelism = std::min(parallelism, global_parallelism);
+	if (max_parallelism != 0)
+		parallelism = std::min(parallelism, max_parallelism);
+	parallelism = std::min(parallelism, num_tasks);
+	if (parallelism <= 1) {
+		for (unsigned int i = 0; i < num_tasks; i++)
+			task(i);
+		return;
+	}
+
+	// Queuing a job per extra thread, i.e. in the own queue of a worker (nested region) or in
+	// the one of the external threads
+	Region region(task, num_tasks);
+	unsigned int num_jobs = parallelism - 1;
+	unsigned int queue = isWorkerThread() ? current_queue : workers_.size();
+	region.pending_jobs = num_jobs;
+	{
+		std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+		for (unsigned int i = 0; i < num_jobs; i++)
+			queues_[queue]->jobs.push_back(&region);
+		num_queued_jobs_ += num_jobs;
+	}
+	notifyAll();
+
+	runTasks(region);
+
+	// Waiting for the jobs of the region, where the pending jobs are run meanwhile
+	while (region.pending_jobs.load(std::memory_order_acquire) != 0) {
+		Region* job;
+		if (popJob(job, queue)) {
+			runJob(*job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		condition_.wait(lock, [this, &region] {
+			return region.pending_jobs.load(std::memory_order_acquire) == 0 ||
+					num_queued_jobs_.load(std::memory_order_acquire) != 0;
+		});
+	}
+}
+
+
+void TaskScheduler::setMaxParallelism(unsigned int max_parallelism)
+{
+	max_parallelism_ = max_parallelism;
+}
+
+
+unsigned int TaskScheduler::getMaxParallelism() const
+{
+	unsigned int max_parallelism = max_parallelism_.load(std::memory_order_relaxed);
+	if (max_parallelism == 0)
+		return workers_.size() + 1;
+
+	return std::min(max_parallelism, (unsigned int) workers_.size() + 1);
+}
+
+
+unsigned int TaskScheduler::getNumberOfWorkers() const
+{
+	return workers_.size();
+}
+
+
+bool TaskScheduler::isWorkerThread() const
+{
+	return current_scheduler == this;
+}
+
+
+bool TaskScheduler::configureDefault(unsigned int num_workers,
+									 const std::vector<int>& cores)
+{
+	std::lock_guard<std::mutex> lock(default_mutex);
+	if (default_scheduler)
+		return false;
+
+	default_num_workers = num_workers;
+	default_cores = cores;
+	return true;
+}
+
+
+TaskScheduler& TaskScheduler::getDefault()
+{
+	std::lock_guard<std::mutex> lock(default_mutex);
+	if (!default_scheduler)
+		default_scheduler.reset(new TaskScheduler(default_num_workers, default_cores));
+
+	return *default_scheduler;
+}
+
+
+bool TaskScheduler::setThreadAffinity(const std::vector<int>& cores)
+{
+#ifdef __linux__
+	if (cores.empty())
+		return false;
+
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (unsigned int i = 0; i < cores.size(); i++) {
+		if (cores[i] < 0 || cores[i] >= CPU_SETSIZE)
+			return false;
+		CPU_SET(cores[i], &cpu_set);
+	}
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) == 0;
+#else
+	return false;
+#endif
+}
+
+
+void TaskScheduler::workerLoop(unsigned int worker)
+{
+	current_scheduler = this;
+	current_queue = worker;
+	while (true) {
+		Region* region;
+		if (popJob(region, worker)) {
+			runJob(*region);
+			continue;
+		}
+
+		// Waiting for a job, where the queued jobs are run before stopping
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		condition_.wait(lock, [this] {
+			return stop_ || num_queued_jobs_.load(std::memory_order_acquire) != 0;
+		});
+		if (stop_ && num_queued_jobs_.load(std::memory_order_acquire) == 0)
+			return;
+	}
+}
+
+
+bool TaskScheduler::popJob(Region*& region,
+						   unsigned int queue)
+{
+	if (num_queued_jobs_.load(std::memory_order_acquire) == 0)
+		return false;
+
+	// Popping the newest job of the own queue, since it's the one of the innermost region
+	{
+		JobQueue& own_queue = *queues_[queue];
+		std::lock_guard<std::mutex> lock(own_queue.mutex);
+		if (!own_queue.jobs.empty()) {
+			region = own_queue.jobs.back();
+			own_queue.jobs.pop_back();
+			num_queued_jobs_--;
+			return true;
+		}
+	}
+
+	// Stealing the oldest job of the rest of the queues
+	unsigned int num_queues = queues_.size();
+	for (unsigned int i = 1; i < num_queues; i++) {
+		JobQueue& other_queue = *queues_[(queue + i) % num_queues];
+		std::lock_guard<std::mutex> lock(other_queue.mutex);
+		if (!other_queue.jobs.empty()) {
+			region = other_queue.jobs.front();
+			other_queue.jobs.pop_front();
+			num_queued_jobs_--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void TaskScheduler::runTasks(Region& region)
+{
+	unsigned int index;
+	while ((index = region.next_task.fetch_add(1, std::memory_order_relaxed)) < region.num_tasks)
+		region.task(index);
+}
+
+
+void TaskScheduler::runJob(Region& region)
+{
+	runTasks(region);
+
+	// Notifying the end of the region. Note that the region cannot be used after the
+	// decrement, since its calling thread can return
+	if (region.pending_jobs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		notifyAll();
+}
+
+
+void TaskScheduler::notifyAll()
+{
+	std::lock_guard<std::mutex> lock(sleep_mutex_);
+	condition_.notify_all();
+}
+
+} //@namespace utils
+} //@namespace dwl
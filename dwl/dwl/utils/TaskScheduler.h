@@ -0,0 +1,182 @@
+#ifndef DWL__UTILS__TASK_SCHEDULER__H
+#define DWL__UTILS__TASK_SCHEDULER__H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @class TaskScheduler
+ * @brief Work-stealing scheduler of the parallel regions of the library, e.g. the chunks of
+ * knots of the optimal control problems or the candidates of the batched evaluations. Every
+ * worker has its own deque of jobs, where it pops its newest job and steals the oldest ones
+ * of the rest when it's empty. A parallel region is run by the calling thread together with
+ * the workers, and its calling thread runs the pending jobs while it waits. Thus, the nested
+ * regions are queued in the same workers instead of creating threads, so they don't
+ * oversubscribe the cores. The workers can be pinned to a set of cores, e.g. for keeping
+ * free the cores of a real-time control loop, and the parallelism of the regions can be
+ * limited for sharing the cores with the host application.
+ * Note that the tasks cannot throw exceptions, and they shouldn't block waiting for other
+ * tasks (except through nested regions)
+ */
+class TaskScheduler
+{
+	public:
+		/** @brief Task of a parallel region, which receives the index of the task */
+		typedef std::function<void(unsigned int)> Task;
+
+		/**
+		 * @brief Constructor function, which starts the workers
+		 * @param unsigned int Number of workers (zero for the number of pinned cores, or for
+		 * the number of hardware threads minus the calling thread)
+		 * @param const std::vector<int>& Cores of the workers, which are assigned in a
+		 * round-robin way (empty for no pinning)
+		 */
+		TaskScheduler(unsigned int num_workers = 0,
+					  const std::vector<int>& cores = std::vector<int>());
+
+		/** @brief Destructor function, which joins the workers */
+		~TaskScheduler();
+
+		/**
+		 * @brief Runs a parallel region, i.e. the tasks of the indexes [0, num_tasks), and waits
+		 * for them. The tasks are taken by the calling thread and the workers in order of index,
+		 * so every index is run once and by one thread
+		 * @param unsigned int Number of tasks
+		 * @param const Task& Task
+		 * @param unsigned int Maximum number of threads of the region, including the calling
+		 * one (zero for no limit)
+		 */
+		void parallelFor(unsigned int num_tasks,
+						 const Task& task,
+						 unsigned int max_parallelism = 0);
+
+		/**
+		 * @brief Sets the maximum number of threads of every region, including the calling
+		 * one, e.g. for sharing the cores with the host application. It can be changed while
+		 * running, and it applies to the next regions
+		 * @param unsigned int Maximum number of threads (zero for all the workers)
+		 */
+		void setMaxParallelism(unsigned int max_parallelism);
+
+		/** @brief Gets the maximum number of threads of a region, including the calling one */
+		unsigned int getMaxParallelism() const;
+
+		/** @brief Gets the number of workers */
+		unsigned int getNumberOfWorkers() const;
+
+		/** @brief Indicates if the calling thread is a worker of this scheduler */
+		bool isWorkerThread() const;
+
+		/**
+		 * @brief Configures the default scheduler, which must be done before its first use
+		 * @param unsigned int Number of workers (see the constructor)
+		 * @param const std::vector<int>& Cores of the workers (empty for no pinning)
+		 * @return False if the default scheduler already exists
+		 */
+		static bool configureDefault(unsigned int num_workers,
+									 const std::vector<int>& cores = std::vector<int>());
+
+		/** @brief Gets the default scheduler, which is shared by the library */
+		static TaskScheduler& getDefault();
+
+		/**
+		 * @brief Pins the calling thread to a set of cores, e.g. the one of a control loop
+		 * @param const std::vector<int>& Cores
+		 * @return False if the affinity isn't supported or the cores are invalid
+		 */
+		static bool setThreadAffinity(const std::vector<int>& cores);
+
+
+	private:
+		/** @brief Parallel region, which lives in the stack of its calling thread */
+		struct Region
+		{
+			Region(const Task& t, unsigned int n) : task(t), num_tasks(n), next_task(0),
+					pending_jobs(0) {}
+
+			const Task& task;
+			unsigned int num_tasks;
+			std::atomic<unsigned int> next_task;
+			std::atomic<unsigned int> pending_jobs;
+		};
+
+		/** @brief Deque of jobs of every worker, where a job is a runner of a region */
+		struct JobQueue
+		{
+			std::mutex mutex;
+			std::deque<Region*> jobs;
+		};
+
+		/** @brief Scheduler isn't copyable */
+		TaskScheduler(const TaskScheduler&);
+		TaskScheduler& operator=(const TaskScheduler&);
+
+		/**
+		 * @brief Loop of the workers, which runs the jobs until the scheduler stops
+		 * @param unsigned int Index of the worker
+		 */
+		void workerLoop(unsigned int worker);
+
+		/**
+		 * @brief Pops a job, i.e. the newest one of the own queue or the oldest of the rest
+		 * @param Region*& Region of the job
+		 * @param unsigned int Index of the own queue
+		 * @return False if there isn't any job
+		 */
+		bool popJob(Region*& region,
+					unsigned int queue);
+
+		/**
+		 * @brief Runs the tasks of a region until there aren't remaining indexes
+		 * @param Region& Region
+		 */
+		void runTasks(Region& region);
+
+		/**
+		 * @brief Runs a queued job of a region, i.e. its tasks and the end of the job
+		 * @param Region& Region
+		 */
+		void runJob(Region& region);
+
+		/**
+		 * @brief Notifies the threads that wait for jobs or for the end of their regions
+		 */
+		void notifyAll();
+
+		/** @brief Worker threads */
+		std::vector<std::thread> workers_;
+
+		/** @brief Job queues of the workers, and the one of the external threads (the last) */
+		std::vector<std::unique_ptr<JobQueue> > queues_;
+
+		/** @brief Number of queued jobs */
+		std::atomic<unsigned int> num_queued_jobs_;
+
+		/** @brief Sleeping of the threads without jobs */
+		std::mutex sleep_mutex_;
+		std::condition_variable condition_;
+
+		/** @brief Maximum number of threads of a region */
+		std::atomic<unsigned int> max_parallelism_;
+
+		/** @brief Indicates if the scheduler is stopping */
+		std::atomic<bool> stop_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,97 @@
+#include <dwl/utils/TimeIndex.h>
+#include <algorithm>
+#include <cmath>
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+TimeIndex::TimeIndex() : period_(0.), is_uniform_(false)
+{
+
+}
+
+
+TimeIndex::~TimeIndex()
+{
+
+}
+
+
+void TimeIndex::reset(const Eigen::Ref<const Eigen::VectorXd>& times,
+					  double tolerance)
+{
+	times_ = times;
+	unsigned int num_times = times_.size();
+	is_uniform_ = false;
+	period_ = 0.;
+	if (num_times < 2)
+		return;
+
+	// Checking if every time is in the uniform grid
+	period_ = (times_(num_times - 1) - times_(0)) / (num_times - 1);
+	if (period_ <= 0.)
+		return;
+
+	is_uniform_ = true;
+	for (unsigned int k = 1; k < num_times - 1 && is_uniform_; k++) {
+		if (fabs(times_(k) - (times_(0) + k * period_)) > tolerance * period_)
+			is_uniform_ = false;
+	}
+}
+
+
+unsigned int TimeIndex::getSegment(double time) const
+{
+	unsigned int num_times = times_.size();
+	if (num_times < 2)
+		return 0;
+
+	unsigned int last_segment = num_times - 2;
+	if (is_uniform_) {
+		// Computing the segment from the sampling period, and correcting the round-off
+		// errors of the grid
+		double position = (time - times_(0)) / period_;
+		if (position <= 0.)
+			return 0;
+
+		unsigned int k = std::min((unsigned int) floor(position), last_segment);
+		while (k > 0 && time < times_(k))
+			k--;
+		while (k < last_segment && time >= times_(k + 1))
+			k++;
+		return k;
+	}
+
+	// Searching the first time that is bigger than the given one
+	const double* first = times_.data();
+	const double* upper = std::upper_bound(first, first + num_times, time);
+	if (upper == first)
+		return 0;
+
+	return std::min((unsigned int) (upper - first) - 1, last_segment);
+}
+
+
+bool TimeIndex::isUniform() const
+{
+	return is_uniform_;
+}
+
+
+unsigned int TimeIndex::size() const
+{
+	return times_.size();
+}
+
+
+const Eigen::VectorXd& TimeIndex::getTimes() const
+{
+	return times_;
+}
+
+} //@namespace math
+} //@namespace dwl
@@ -0,0 +1,68 @@
+#ifndef DWL__MATH__TIME_INDEX__H
+#define DWL__MATH__TIME_INDEX__H
+
+#include <Eigen/Dense>
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+/**
+ * @class TimeIndex
+ * @brief Index of the increasing times of a sampled trajectory, which finds the segment of an
+ * arbitrary time. The segment of a uniformly sampled trajectory is computed in constant time,
+ * and the one of a non-uniform trajectory with a binary search
+ */
+class TimeIndex
+{
+	public:
+		/** @brief Constructor function */
+		TimeIndex();
+
+		/** @brief Destructor function */
+		~TimeIndex();
+
+		/**
+		 * @brief Resets the index, where the sampling is uniform if every time deviates from
+		 * the uniform grid less than a fraction of the sampling period
+		 * @param const Eigen::Ref<const Eigen::VectorXd>& Increasing times of the trajectory
+		 * @param double Relative tolerance of the uniform sampling
+		 */
+		void reset(const Eigen::Ref<const Eigen::VectorXd>& times,
+				   double tolerance = 1e-6);
+
+		/**
+		 * @brief Gets the segment of a time, i.e. the index k such as time_k <= time <
+		 * time_k+1. The times outside the trajectory are saturated by the first and last
+		 * segments
+		 * @param double Time
+		 * @return unsigned int Segment index
+		 */
+		unsigned int getSegment(double time) const;
+
+		/** @brief Indicates if the trajectory is uniformly sampled */
+		bool isUniform() const;
+
+		/** @brief Gets the number of times */
+		unsigned int size() const;
+
+		/** @brief Gets the indexed times */
+		const Eigen::VectorXd& getTimes() const;
+
+
+	private:
+		/** @brief Indexed times */
+		Eigen::VectorXd times_;
+
+		/** @brief Sampling period and a label that indicates if the sampling is uniform */
+		double period_;
+		bool is_uniform_;
+};
+
+} //@namespace math
+} //@namespace dwl
+
+#endif
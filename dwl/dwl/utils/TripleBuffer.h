@@ -0,0 +1,121 @@
+#ifndef DWL__UTILS__TRIPLE_BUFFER__H
+#define DWL__UTILS__TRIPLE_BUFFER__H
+
+#include <atomic>
+#include <stdint.h>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @class TripleBuffer
+ * @brief Wait-free handoff of values (e.g. plans) from a single writer thread to a single
+ * reader thread. The writer fills its back buffer and publishes it by exchanging it with the
+ * middle one, and the reader takes the middle one, if it's newer, by exchanging it with its
+ * front buffer. So both operations are a single atomic exchange, the reader always has a
+ * complete value that isn't modified while it's read, and the writer never waits for the
+ * reader. Every published value has a version stamp, i.e. the number of publications
+ */
+template<typename T>
+class TripleBuffer
+{
+	public:
+		/** @brief Constructor function */
+		TripleBuffer() : front_(0), back_(2), middle_(1), num_publications_(0) {
+			for (unsigned int i = 0; i < 3; i++)
+				versions_[i] = 0;
+		}
+
+		/** @brief Destructor function */
+		~TripleBuffer() {}
+
+		/**
+		 * @brief Gets the back buffer of the writer, which can be filled until it's published.
+		 * Note that it has a previous value (not the last published one)
+		 */
+		T& getWriteBuffer() {
+			return buffers_[back_];
+		}
+
+		/**
+		 * @brief Publishes the back buffer of the writer
+		 * @return The version of the published value
+		 */
+		uint64_t publish() {
+			uint64_t version = num_publications_.load(std::memory_order_relaxed) + 1;
+			versions_[back_] = version;
+			unsigned int last = middle_.exchange(back_ | FreshBit, std::memory_order_acq_rel);
+			back_ = last & IndexMask;
+			num_publications_.store(version, std::memory_order_release);
+			return version;
+		}
+
+		/**
+		 * @brief Publishes a value, i.e. it's copied in the back buffer
+		 * @param const T& Value
+		 * @return The version of the published value
+		 */
+		uint64_t publish(const T& value) {
+			getWriteBuffer() = value;
+			return publish();
+		}
+
+		/**
+		 * @brief Gets the last published value for the reader. The value isn't modified until
+		 * the next acquisition of the reader
+		 * @param bool* Indicates if the value changed since the last acquisition
+		 * @return The last published value (or the default one)
+		 */
+		const T& acquire(bool* updated = NULL) {
+			bool fresh = middle_.load(std::memory_order_relaxed) & FreshBit;
+			if (fresh) {
+				unsigned int last = middle_.exchange(front_, std::memory_order_acq_rel);
+				front_ = last & IndexMask;
+			}
+			if (updated != NULL)
+				*updated = fresh;
+			return buffers_[front_];
+		}
+
+		/** @brief Gets the value of the last acquisition of the reader */
+		const T& getReadBuffer() const {
+			return buffers_[front_];
+		}
+
+		/** @brief Gets the version of the last acquisition of the reader (zero for none) */
+		uint64_t getReadVersion() const {
+			return versions_[front_];
+		}
+
+		/** @brief Gets the version of the last publication, which can be called by any thread */
+		uint64_t getPublishedVersion() const {
+			return num_publications_.load(std::memory_order_acquire);
+		}
+
+
+	private:
+		/** @brief Encoding of the middle buffer, i.e. its index and if it's unread */
+		enum {IndexMask = 3, FreshBit = 4};
+
+		/** @brief Buffers and the versions of their values */
+		T buffers_[3];
+		uint64_t versions_[3];
+
+		/** @brief Buffers owned by the reader and the writer, which are in different cache
+		 * lines */
+		alignas(64) unsigned int front_;
+		alignas(64) unsigned int back_;
+
+		/** @brief Middle buffer, and number of publications */
+		alignas(64) std::atomic<unsigned int> middle_;
+		alignas(64) std::atomic<uint64_t> num_publications_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
@@ -30,25 +30,25 @@ std::string fileToXml(const std::string& filename)
 }
 
 
-void getJointNames(JointID& joints,
-				   const std::string& urdf_model,
-				   enum JointType type)
+/**
+ * @brief Gets the joints of the model in a depth-first order of the model tree
+ * @param std::vector<std::shared_ptr<urdf::Joint> >& Joints of the tree
+ * @param const std::shared_ptr<urdf::ModelInterface>& Parsed URDF model
+ */
+static void getTreeJoints(std::vector<std::shared_ptr<urdf::Joint> >& tree_joints,
+						  const std::shared_ptr<urdf::ModelInterface>& model)
 {
-	// Parsing the URDF-XML
-	std::shared_ptr<urdf::ModelInterface> model = urdf::parseURDF(urdf_model);
-
 	std::stack<std::shared_ptr<urdf::Link> > link_stack;
 	std::stack<int> branch_index_stack;
 
 	// Adding the bodies in a depth-first order of the model tree
-	std::map<std::string, std::shared_ptr<urdf::Link> > link_map = model->links_;
+	std::map<std::string, std::shared_ptr<urdf::Link> >& link_map = model->links_;
 	link_stack.push(link_map[model->getRoot()->name]);
 
 	if (link_stack.top()->child_joints.size() > 0) {
 		branch_index_stack.push(0);
 	}
 
-	unsigned int joint_idx = 0;
 	while (link_stack.size() > 0) {
 		std::shared_ptr<urdf::Link> current_link = link_stack.top();
 		unsigned int branch_idx = branch_index_stack.top();
@@ -64,43 +64,7 @@ void getJointNames(JointID& joints,
 			link_stack.push(link_map[current_joint->child_link_name]);
 			branch_index_stack.push(0);
 
-			// Searching joints names
-			if (type == free) {
-				if (current_joint->type == urdf::Joint::FLOATING ||
-						current_joint->type == urdf::Joint::PRISMATIC ||
-						current_joint->type == urdf::Joint::REVOLUTE ||
-						current_joint->type == urdf::Joint::CONTINUOUS) {
-					joints[current_joint->name] = joint_idx;
-					joint_idx++;
-				}
-			} else if (type == fixed) {
-				if (current_joint->type == urdf::Joint::FIXED) {
-					joints[current_joint->name] = joint_idx;
-					joint_idx++;
-				}
-			} else if (type == floating) {
-				if (current_joint->type == urdf::Joint::FLOATING) {
-					joints[current_joint->name] = joint_idx;
-					joint_idx++;
-				}
-
-				if (current_joint->type == urdf::Joint::PRISMATIC ||
-						current_joint->type == urdf::Joint::REVOLUTE ||
-						current_joint->type == urdf::Joint::CONTINUOUS) {
-					if (current_joint->limits->effort == 0) {
-						joints[current_joint->name] = joint_idx;
-						joint_idx++;
-					}
-				}
-			} else { // all joints
-				if (current_joint->type == urdf::Joint::FIXED)
-					joints[current_joint->name] =
-							std::numeric_limits<unsigned int>::max();
-				else {
-					joints[current_joint->name] = joint_idx;
-					joint_idx++;
-				}
-			}
+			tree_joints.push_back(current_joint);
 		} else {
 			link_stack.pop();
 			branch_index_stack.pop();
@@ -109,23 +73,78 @@ void getJointNames(JointID& joints,
 }
 
 
-void getEndEffectors(LinkID& end_effectors,
-					 const std::string& urdf_model)
+/**
+ * @brief Selects the joints of a type, where the ids follow the order of the tree joints
+ * @param JointID& Joint ids and names
+ * @param const std::vector<std::shared_ptr<urdf::Joint> >& Joints of the tree
+ * @param enum JointType Type of joints
+ */
+static void selectJoints(JointID& joints,
+						 const std::vector<std::shared_ptr<urdf::Joint> >& tree_joints,
+						 enum JointType type)
 {
-	// Parsing the URDF-XML
-	std::shared_ptr<urdf::ModelInterface> model = urdf::parseURDF(urdf_model);
+	unsigned int joint_idx = 0;
+	for (unsigned int j = 0; j < tree_joints.size(); j++) {
+		const std::shared_ptr<urdf::Joint>& current_joint = tree_joints[j];
+
+		// Searching joints names
+		if (type == free) {
+			if (current_joint->type == urdf::Joint::FLOATING ||
+					current_joint->type == urdf::Joint::PRISMATIC ||
+					current_joint->type == urdf::Joint::REVOLUTE ||
+					current_joint->type == urdf::Joint::CONTINUOUS) {
+				joints[current_joint->name] = joint_idx;
+				joint_idx++;
+			}
+		} else if (type == fixed) {
+			if (current_joint->type == urdf::Joint::FIXED) {
+				joints[current_joint->name] = joint_idx;
+				joint_idx++;
+			}
+		} else if (type == floating) {
+			if (current_joint->type == urdf::Joint::FLOATING) {
+				joints[current_joint->name] = joint_idx;
+				joint_idx++;
+			}
 
-	// Getting the fixed joint names
-	JointID fixed_joints;
-	getJointNames(fixed_joints, urdf_model, fixed);
+			if (current_joint->type == urdf::Joint::PRISMATIC ||
+					current_joint->type == urdf::Joint::REVOLUTE ||
+					current_joint->type == urdf::Joint::CONTINUOUS) {
+				if (current_joint->limits->effort == 0) {
+					joints[current_joint->name] = joint_idx;
+					joint_idx++;
+				}
+			}
+		} else { // all joints
+			if (current_joint->type == urdf::Joint::FIXED)
+				joints[current_joint->name] =
+						std::numeric_limits<unsigned int>::max();
+			else {
+				joints[current_joint->name] = joint_idx;
+				joint_idx++;
+			}
+		}
+	}
+}
 
+
+/**
+ * @brief Gets the end-effectors from the fixed joints of the model
+ * @param LinkID& End-effector link ids and names
+ * @param const std::shared_ptr<urdf::ModelInterface>& Parsed URDF model
+ * @param const JointID& Fixed joints
+ */
+static void selectEndEffectors(LinkID& end_effectors,
+							   const std::shared_ptr<urdf::ModelInterface>& model,
+							   const JointID& fixed_joints)
+{
 	// Getting the world, root, parent and child links
 	std::shared_ptr<urdf::Link> world_link = model->links_[model->getRoot()->name];
 	std::shared_ptr<urdf::Link> root_link = world_link->child_links[0];
 
 	// Searching the end-effector joints
 	unsigned int end_effector_idx = 0;
-	for (urdf_model::JointID::iterator jnt_it = fixed_joints.begin();
+	for (urdf_model::JointID::const_iterator jnt_it = fixed_joints.begin();
 			jnt_it != fixed_joints.end(); jnt_it++) {
 		std::string joint_name = jnt_it->first;
 		std::shared_ptr<urdf::Joint> current_joint = model->joints_[joint_name];
@@ -154,30 +173,18 @@ void getEndEffectors(LinkID& end_effectors,
 }
 
 
-void getJointLimits(JointLimits& joint_limits,
-					const std::string& urdf_model)
+/**
+ * @brief Gets the limits of the actuated joints from the free joints of the model
+ * @param JointLimits& Joint names and limits
+ * @param const std::shared_ptr<urdf::ModelInterface>& Parsed URDF model
+ * @param const JointID& Free joints
+ */
+static void selectJointLimits(JointLimits& joint_limits,
+							  const std::shared_ptr<urdf::ModelInterface>& model,
+							  const JointID& free_joints)
 {
-	// Parsing the URDF-XML
-	std::shared_ptr<urdf::ModelInterface> model = urdf::parseURDF(urdf_model);
-
-	// Getting the free joint names
-	JointID free_joints;
-	getJointNames(free_joints, urdf_model, free);
-
-	// Computing the number of actuated joints
-	unsigned num_joints = 0;
-	for (urdf_model::JointID::iterator jnt_it = free_joints.begin();
-			jnt_it != free_joints.end(); jnt_it++) {
-		std::string joint_name = jnt_it->first;
-		std::shared_ptr<urdf::Joint> current_joint = model->joints_[joint_name];
-
-		if (current_joint->type != urdf::Joint::FLOATING)
-			if (current_joint->limits->effort != 0) // Virtual floating-base joints
-				num_joints++;
-	}
-
 	// Searching the joint limits
-	for (urdf_model::JointID::iterator jnt_it = free_joints.begin();
+	for (urdf_model::JointID::const_iterator jnt_it = free_joints.begin();
 			jnt_it != free_joints.end(); jnt_it++) {
 		std::string joint_name = jnt_it->first;
 		std::shared_ptr<urdf::Joint> current_joint = model->joints_[joint_name];
@@ -194,18 +201,17 @@ void getJointLimits(JointLimits& joint_limits,
 }
 
 
-void getJointAxis(JointAxis& joints,
-				  const std::string& urdf_model,
-				  enum JointType type)
+/**
+ * @brief Gets the axis of a set of joints of the model
+ * @param JointAxis& Joint axis and names
+ * @param const std::shared_ptr<urdf::ModelInterface>& Parsed URDF model
+ * @param const JointID& Joints
+ */
+static void selectJointAxis(JointAxis& joints,
+							const std::shared_ptr<urdf::ModelInterface>& model,
+							const JointID& joint_ids)
 {
-	// Parsing the URDF-XML
-	std::shared_ptr<urdf::ModelInterface> model = urdf::parseURDF(urdf_model);
-
-	// Getting the joint names
-	JointID joint_ids;
-	getJointNames(joint_ids, urdf_model, type);
-
-	for (urdf_model::JointID::iterator jnt_it = joint_ids.begin();
+	for (urdf_model::JointID::const_iterator jnt_it = joint_ids.begin();
 			jnt_it != joint_ids.end(); jnt_it++) {
 		std::string joint_name = jnt_it->first;
 		std::shared_ptr<urdf::Joint> current_joint = model->joints_[joint_name];
@@ -221,18 +227,18 @@ void getJointAxis(JointAxis& joints,
 }
 
 
-void getFloatingBaseJointMotion(JointID& joints,
-								const std::string& urdf_model)
+/**
+ * @brief Gets the type of motion of the floating-base joints of the model
+ * @param JointID& Joint type of motion
+ * @param const std::shared_ptr<urdf::ModelInterface>& Parsed URDF model
+ * @param const JointID& Floating-base joints
+ */
+static void selectFloatingBaseJointMotion(JointID& joints,
+										  const std::shared_ptr<urdf::ModelInterface>& model,
+										  const JointID& floating_joints)
 {
-	// Parsing the URDF-XML
-	std::shared_ptr<urdf::ModelInterface> model = urdf::parseURDF(urdf_model);
-
-	// Getting the free joint names
-	JointAxis joint_axis;
-	getJointAxis(joint_axis, urdf_model, floating);
-
-	for (urdf_model::JointAxis::iterator jnt_it = joint_axis.begin();
-			jnt_it != joint_axis.end(); jnt_it++) {
+	for (urdf_model::JointID::const_iterator jnt_it = floating_joints.begin();
+			jnt_it != floating_joints.end(); jnt_it++) {
 		std::string joint_name = jnt_it->first;
 		std::shared_ptr<urdf::Joint> current_joint = model->joints_[joint_name];
 
@@ -272,5 +278,110 @@ void getFloatingBaseJointMotion(JointID& joints,
 	}
 }
 
+
+void getModelTables(ModelTables& tables,
+					const std::shared_ptr<urdf::ModelInterface>& model)
+{
+	// Walking the tree once, and then deriving all the tables from its joints
+	std::vector<std::shared_ptr<urdf::Joint> > tree_joints;
+	getTreeJoints(tree_joints, model);
+
+	selectJoints(tables.free_joints, tree_joints, free);
+	selectJoints(tables.fixed_joints, tree_joints, fixed);
+	selectJoints(tables.floating_joints, tree_joints, floating);
+	selectJointLimits(tables.joint_limits, model, tables.free_joints);
+	selectFloatingBaseJointMotion(tables.floating_joint_motions, model,
+								  tables.floating_joints);
+	selectEndEffectors(tables.end_effectors, model, tables.fixed_joints);
+}
+
+
+void getJointNames(JointID& joints,
+				   const std::shared_ptr<urdf::ModelInterface>& model,
+				   enum JointType type)
+{
+	std::vector<std::shared_ptr<urdf::Joint> > tree_joints;
+	getTreeJoints(tree_joints, model);
+	selectJoints(joints, tree_joints, type);
+}
+
+
+void getJointNames(JointID& joints,
+				   const std::string& urdf_model,
+				   enum JointType type)
+{
+	getJointNames(joints, urdf::parseURDF(urdf_model), type);
+}
+
+
+void getEndEffectors(LinkID& end_effectors,
+					 const std::shared_ptr<urdf::ModelInterface>& model)
+{
+	// Getting the fixed joint names
+	JointID fixed_joints;
+	getJointNames(fixed_joints, model, fixed);
+	selectEndEffectors(end_effectors, model, fixed_joints);
+}
+
+
+void getEndEffectors(LinkID& end_effectors,
+					 const std::string& urdf_model)
+{
+	getEndEffectors(end_effectors, urdf::parseURDF(urdf_model));
+}
+
+
+void getJointLimits(JointLimits& joint_limits,
+					const std::shared_ptr<urdf::ModelInterface>& model)
+{
+	// Getting the free joint names
+	JointID free_joints;
+	getJointNames(free_joints, model, free);
+	selectJointLimits(joint_limits, model, free_joints);
+}
+
+
+void getJointLimits(JointLimits& joint_limits,
+					const std::string& urdf_model)
+{
+	getJointLimits(joint_limits, urdf::parseURDF(urdf_model));
+}
+
+
+void getJointAxis(JointAxis& joints,
+				  const std::shared_ptr<urdf::ModelInterface>& model,
+				  enum JointType type)
+{
+	// Getting the joint names
+	JointID joint_ids;
+	getJointNames(joint_ids, model, type);
+	selectJointAxis(joints, model, joint_ids);
+}
+
+
+void getJointAxis(JointAxis& joints,
+				  const std::string& urdf_model,
+				  enum JointType type)
+{
+	getJointAxis(joints, urdf::parseURDF(urdf_model), type);
+}
+
+
+void getFloatingBaseJointMotion(JointID& joints,
+								const std::shared_ptr<urdf::ModelInterface>& model)
+{
+	// Getting the floating-base joint names
+	JointID floating_joints;
+	getJointNames(floating_joints, model, floating);
+	selectFloatingBaseJointMotion(joints, model, floating_joints);
+}
+
+
+void getFloatingBaseJointMotion(JointID& joints,
+								const std::string& urdf_model)
+{
+	getFloatingBaseJointMotion(joints, urdf::parseURDF(urdf_model));
+}
+
 } //@namespace urdf_model
 } //@namespace dwl
@@ -5,7 +5,9 @@
 #include <urdf_parser/urdf_parser.h>
 #include <Eigen/Dense>
 #include <map>
+#include <memory>
 #include <stack>
+#include <vector>
 
 
 namespace dwl
@@ -21,6 +23,27 @@ typedef std::map<std::string,unsigned int> LinkID;
 enum JointType {free = 0, fixed, floating, all};
 enum JointMotion {RX = 0, RY, RZ, TX, TY, TZ, FULL};
 
+/**
+ * @brief Tables of a parsed URDF model, i.e. the results of the accessors below, which are
+ * extracted in one walk of the model tree
+ */
+struct ModelTables
+{
+	/** @brief Free, fixed and floating-base joints (see getJointNames) */
+	JointID free_joints;
+	JointID fixed_joints;
+	JointID floating_joints;
+
+	/** @brief Limits of the actuated joints (see getJointLimits) */
+	JointLimits joint_limits;
+
+	/** @brief Type of motion of the floating-base joints (see getFloatingBaseJointMotion) */
+	JointID floating_joint_motions;
+
+	/** @brief End-effectors (see getEndEffectors) */
+	LinkID end_effectors;
+};
+
 /**
  * @brief Converts an urdf file to urdf xml
  * @param const std::string& File name, the full path has to be defined
@@ -28,6 +51,15 @@ enum JointMotion {RX = 0, RY, RZ, TX, TY, TZ, FULL};
  */
 std::string fileToXml(const std::string& filename);
 
+/**
+ * @brief Gets the tables of a parsed URDF model, so the URDF-XML is parsed once for all of
+ * them (e.g. with urdf::parseURDF)
+ * @param ModelTables& Tables of the model
+ * @param const std::shared_ptr<urdf::ModelInterface>& Parsed URDF model
+ */
+void getModelTables(ModelTables& tables,
+					const std::shared_ptr<urdf::ModelInterface>& model);
+
 /**
  * @brief Gets the joint names from URDF model. By default free joints are
  * get but it's possible
@@ -39,6 +71,11 @@ void getJointNames(JointID& joints,
 				   const std::string& urdf_model,
 				   enum JointType type = free);
 
+/** @brief As above, but for a parsed URDF model */
+void getJointNames(JointID& joints,
+				   const std::shared_ptr<urdf::ModelInterface>& model,
+				   enum JointType type = free);
+
 /**
  * @brief Get the end-effector names from URDF model
  * @param LinkID& End-effector link ids and names
@@ -47,6 +84,10 @@ void getJointNames(JointID& joints,
 void getEndEffectors(LinkID& end_effectors,
 					 const std::string& urdf_model);
 
+/** @brief As above, but for a parsed URDF model */
+void getEndEffectors(LinkID& end_effectors,
+					 const std::shared_ptr<urdf::ModelInterface>& model);
+
 /**
  * @brief Get the joint limits from URDF model. Floating-base joint are not
  * considered as joints
@@ -56,6 +97,10 @@ void getEndEffectors(LinkID& end_effectors,
 void getJointLimits(JointLimits& joint_limits,
 					const std::string& urdf_model);
 
+/** @brief As above, but for a parsed URDF model */
+void getJointLimits(JointLimits& joint_limits,
+					const std::shared_ptr<urdf::ModelInterface>& model);
+
 /**
  * @brief Gets the joint axis from URDF model. By default free joints are get
  * but it's possible
@@ -67,6 +112,11 @@ void getJointAxis(JointAxis& joints,
 				  const std::string& urdf_model,
 				  enum JointType type = free);
 
+/** @brief As above, but for a parsed URDF model */
+void getJointAxis(JointAxis& joints,
+				  const std::shared_ptr<urdf::ModelInterface>& model,
+				  enum JointType type = free);
+
 /**
  * @brief Gets the joint type of motion from URDF model. By default free joints
  * are get but it's
@@ -77,6 +127,10 @@ void getJointAxis(JointAxis& joints,
 void getFloatingBaseJointMotion(JointID& joints,
 								const std::string& urdf_model);
 
+/** @brief As above, but for a parsed URDF model */
+void getFloatingBaseJointMotion(JointID& joints,
+								const std::shared_ptr<urdf::ModelInterface>& model);
+
 } //@namespace urdf_model
 } //@namespace dwl
 
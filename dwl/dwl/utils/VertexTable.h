@@ -0,0 +1,175 @@
+#ifndef DWL__VERTEX_TABLE__H
+#define DWL__VERTEX_TABLE__H
+
+#include <dwl/utils/GraphSearching.h>
+#include <dwl/utils/MemoryUsage.h>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+
+namespace dwl
+{
+
+/**
+ * @class VertexTable
+ * @brief VertexTable stores a value per vertex (e.g. the g cost or previous vertex of a search).
+ * The vertex ids below the number of dense vertices are stored in contiguous arrays, and the
+ * rest in a hash table, so there is no node-based lookup. Note that clearing the table only
+ * resets the touched vertices
+ */
+template<typename T>
+class VertexTable
+{
+	public:
+		/**
+		 * @brief Constructor function
+		 * @param const T& Value of the vertices that aren't in the table
+		 * @param Vertex Number of dense vertices, i.e. vertex ids below it are stored in arrays
+		 */
+		VertexTable(const T& default_value = T(), Vertex num_dense_vertices = 0) : size_(0) {
+			reset(default_value, num_dense_vertices);
+		}
+
+		/** @brief Destructor function */
+		~VertexTable() {}
+
+		/**
+		 * @brief Resets the table, and allocates the dense arrays
+		 * @param const T& Value of the vertices that aren't in the table
+		 * @param Vertex Number of dense vertices
+		 */
+		void reset(const T& default_value, Vertex num_dense_vertices) {
+			default_value_ = default_value;
+			dense_values_.assign(num_dense_vertices, default_value);
+			dense_flags_.assign(num_dense_vertices, UNTOUCHED);
+			dense_touched_.clear();
+			hashed_values_.clear();
+			size_ = 0;
+		}
+
+		/**
+		 * @brief Gets the value of a vertex, where it's inserted with the default value if it
+		 * doesn't exist
+		 * @param Vertex Vertex id
+		 * @return T& Value of the vertex
+		 */
+		T& operator[](Vertex vertex) {
+			if (vertex < dense_values_.size()) {
+				unsigned char& flag = dense_flags_[vertex];
+				if (flag != STORED) {
+					if (flag == UNTOUCHED)
+						dense_touched_.push_back(vertex);
+					flag = STORED;
+					dense_values_[vertex] = default_value_;
+					size_++;
+				}
+				return dense_values_[vertex];
+			}
+
+			typename HashedValues::iterator it = hashed_values_.find(vertex);
+			if (it == hashed_values_.end()) {
+				size_++;
+				return hashed_values_.insert(std::make_pair(vertex, default_value_)).first->second;
+			}
+			return it->second;
+		}
+
+		/**
+		 * @brief Finds the value of a vertex
+		 * @param Vertex Vertex id
+		 * @return const T* Pointer to the value, or NULL if the vertex doesn't exist
+		 */
+		const T* find(Vertex vertex) const {
+			if (vertex < dense_values_.size())
+				return (dense_flags_[vertex] == STORED) ? &dense_values_[vertex] : NULL;
+
+			typename HashedValues::const_iterator it = hashed_values_.find(vertex);
+			return (it == hashed_values_.end()) ? NULL : &it->second;
+		}
+
+		/**
+		 * @brief Gets the value of a vertex without inserting it
+		 * @param Vertex Vertex id
+		 * @return const T& Value of the vertex, or the default value if it doesn't exist
+		 */
+		const T& get(Vertex vertex) const {
+			const T* value = find(vertex);
+			return (value == NULL) ? default_value_ : *value;
+		}
+
+		/**
+		 * @brief Counts the vertex, i.e. 1 if it exists and 0 otherwise (as std::map)
+		 * @param Vertex Vertex id
+		 * @return unsigned int Number of elements with this vertex id
+		 */
+		unsigned int count(Vertex vertex) const {
+			return (find(vertex) == NULL) ? 0 : 1;
+		}
+
+		/**
+		 * @brief Erases a vertex
+		 * @param Vertex Vertex id
+		 */
+		void erase(Vertex vertex) {
+			if (vertex < dense_values_.size()) {
+				if (dense_flags_[vertex] == STORED) {
+					dense_flags_[vertex] = ERASED;
+					size_--;
+				}
+			} else if (hashed_values_.erase(vertex) != 0)
+				size_--;
+		}
+
+		/** @brief Clears the table, which only resets the touched dense vertices */
+		void clear() {
+			for (unsigned int i = 0; i < dense_touched_.size(); i++)
+				dense_flags_[dense_touched_[i]] = UNTOUCHED;
+			dense_touched_.clear();
+			hashed_values_.clear();
+			size_ = 0;
+		}
+
+		/** @brief Gets the number of vertices in the table */
+		unsigned int size() const {
+			return size_;
+		}
+
+		/** @brief Gets the heap bytes of the table, i.e. of its dense and hashed values */
+		std::size_t getHeapBytes() const {
+			return utils::getHeapBytes(dense_values_) + utils::getHeapBytes(dense_flags_) +
+					utils::getHeapBytes(dense_touched_) + utils::getHeapBytes(hashed_values_);
+		}
+
+		/** @brief Indicates if the table is empty */
+		bool empty() const {
+			return size_ == 0;
+		}
+
+
+	private:
+		typedef std::unordered_map<Vertex, T> HashedValues;
+
+		/** @brief States of the dense vertices */
+		enum DenseFlag {UNTOUCHED = 0, STORED, ERASED};
+
+		/** @brief Value of the vertices that aren't in the table */
+		T default_value_;
+
+		/** @brief Values and states of the dense vertices */
+		std::vector<T> dense_values_;
+		std::vector<unsigned char> dense_flags_;
+
+		/** @brief Dense vertices touched since the last clear */
+		std::vector<Vertex> dense_touched_;
+
+		/** @brief Values of the rest of vertices */
+		HashedValues hashed_values_;
+
+		/** @brief Number of vertices in the table */
+		unsigned int size_;
+};
+
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,84 @@
+#include <dwl/utils/WorkerPool.h>
+#include <algorithm>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+WorkerPool::WorkerPool(unsigned int num_workers) : stop_(false)
+{
+	if (num_workers == 0)
+		num_workers = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (unsigned int i = 0; i < num_workers; i++)
+		workers_.push_back(std::thread(&WorkerPool::workerLoop, this));
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	condition_.notify_all();
+
+	for (unsigned int i = 0; i < workers_.size(); i++)
+		workers_[i].join();
+}
+
+
+void WorkerPool::submit(const Task& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push_back(task);
+	}
+	condition_.notify_one();
+}
+
+
+unsigned int WorkerPool::getNumberOfWorkers() const
+{
+	return workers_.size();
+}
+
+
+unsigned int WorkerPool::getNumberOfQueuedTasks()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return tasks_.size();
+}
+
+
+WorkerPool& WorkerPool::getDefault()
+{
+	static WorkerPool pool;
+	return pool;
+}
+
+
+void WorkerPool::workerLoop()
+{
+	while (true) {
+		// Waiting for a task, where the queued tasks are run before stopping
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+			if (tasks_.empty())
+				return;
+
+			task = tasks_.front();
+			tasks_.pop_front();
+		}
+
+		task();
+	}
+}
+
+} //@namespace utils
+} //@namespace dwl
@@ -0,0 +1,78 @@
+#ifndef DWL__UTILS__WORKER_POOL__H
+#define DWL__UTILS__WORKER_POOL__H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+/**
+ * @class WorkerPool
+ * @brief Fixed set of worker threads that run the submitted tasks in order of submission,
+ * e.g. the asynchronous computations of the planners. The threads are created once, so a
+ * submission only queues the task. There is a default pool that is shared by the planners
+ */
+class WorkerPool
+{
+	public:
+		/** @brief Task of the workers */
+		typedef std::function<void()> Task;
+
+		/**
+		 * @brief Constructor function, which starts the workers
+		 * @param unsigned int Number of workers (zero for the number of hardware threads)
+		 */
+		WorkerPool(unsigned int num_workers = 0);
+
+		/** @brief Destructor function, which runs the queued tasks and joins the workers */
+		~WorkerPool();
+
+		/**
+		 * @brief Queues a task, which is run by the first free worker
+		 * @param const Task& Task
+		 */
+		void submit(const Task& task);
+
+		/** @brief Gets the number of workers */
+		unsigned int getNumberOfWorkers() const;
+
+		/** @brief Gets the number of queued tasks, i.e. the ones that aren't running */
+		unsigned int getNumberOfQueuedTasks();
+
+		/** @brief Gets the default pool, which is created in the first call */
+		static WorkerPool& getDefault();
+
+
+	private:
+		/** @brief Pool isn't copyable */
+		WorkerPool(const WorkerPool&);
+		WorkerPool& operator=(const WorkerPool&);
+
+		/** @brief Loop of the workers, which runs the queued tasks until the pool stops */
+		void workerLoop();
+
+		/** @brief Worker threads */
+		std::vector<std::thread> workers_;
+
+		/** @brief Queue of tasks, which is guarded by the mutex */
+		std::deque<Task> tasks_;
+		std::mutex mutex_;
+		std::condition_variable condition_;
+
+		/** @brief Indicates if the pool is stopping */
+		bool stop_;
+};
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
@@ -1,17 +1,34 @@
 #include <dwl/utils/YamlWrapper.h>
+#include <sys/stat.h>
+#include <mutex>
 
 
 namespace dwl
 {
 
-YamlWrapper::YamlWrapper() : is_file_(false)
+struct YamlWrapper::FileCache
+{
+	/** @brief Parsed file and the properties used for detecting its changes */
+	struct Entry
+	{
+		time_t modification_time;
+		off_t size;
+		YAML::Node document;
+	};
+
+	std::mutex mutex;
+	std::map<std::string, Entry> entries;
+};
+
+
+YamlWrapper::YamlWrapper() : is_file_(false), is_loaded_(false)
 {
 
 }
 
 
 YamlWrapper::YamlWrapper(std::string filename) : filename_(filename),
-		is_file_(true)
+		is_file_(true), is_loaded_(false)
 {
 
 }
@@ -27,6 +44,8 @@ void YamlWrapper::setFile(std::string filename)
 {
 	filename_ = filename;
 	is_file_ = true;
+	is_loaded_ = false;
+	namespace_nodes_.clear();
 }
 
 
@@ -439,15 +458,82 @@ bool YamlWrapper::getNode(YAML::Node& node,
 		return false;
 	}
 
-	node = YAML::LoadFile(filename_);
-	for (std::size_t i = 0; i < ns.size(); i++) {
-		std::string ns_name = ns[i];
+	if (!is_loaded_ && !loadDocument())
+		return false;
 
-		node = node[ns_name];
-		if (!node)
+	// Looking for the node of namespaces that were already found
+	std::string key;
+	for (std::size_t i = 0; i < ns.size(); i++)
+		key += ns[i] + '\n';
+	std::map<std::string, YAML::Node>::const_iterator node_it = namespace_nodes_.find(key);
+	if (node_it != namespace_nodes_.end()) {
+		node.reset(node_it->second);
+		return true;
+	}
+
+	// Finding the node through const lookups, since the assignment of nodes would modify
+	// the cached document
+	YAML::Node ns_node = document_;
+	for (std::size_t i = 0; i < ns.size(); i++) {
+		const YAML::Node& parent = ns_node;
+		YAML::Node child = parent[ns[i]];
+		if (!child)
 			return false;
+		ns_node.reset(child);
+	}
+
+	namespace_nodes_[key].reset(ns_node);
+	node.reset(ns_node);
+	return true;
+}
+
+
+void YamlWrapper::clearFileCache()
+{
+	FileCache& cache = getFileCache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.entries.clear();
+}
+
+
+YamlWrapper::FileCache& YamlWrapper::getFileCache()
+{
+	// The cache is never destroyed, so the files can be read during the exit of the process
+	static FileCache* cache = new FileCache();
+	return *cache;
+}
+
+
+bool YamlWrapper::loadDocument()
+{
+	struct stat file_stat;
+	if (stat(filename_.c_str(), &file_stat) != 0) {
+		printf(YELLOW "Warning: the %s file doesn't exist\n" COLOR_RESET, filename_.c_str());
+		return false;
+	}
+
+	// Parsing the file only if it isn't cached or it changed. Every wrapper reads its own
+	// copy of the document, so the cached one isn't shared between threads
+	FileCache& cache = getFileCache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	std::map<std::string, FileCache::Entry>::iterator entry_it = cache.entries.find(filename_);
+	if (entry_it != cache.entries.end() &&
+			(entry_it->second.modification_time != file_stat.st_mtime ||
+			entry_it->second.size != file_stat.st_size)) {
+		cache.entries.erase(entry_it);
+		entry_it = cache.entries.end();
+	}
+	if (entry_it == cache.entries.end()) {
+		FileCache::Entry entry;
+		entry.modification_time = file_stat.st_mtime;
+		entry.size = file_stat.st_size;
+		entry.document = YAML::LoadFile(filename_);
+		entry_it = cache.entries.insert(std::make_pair(filename_, entry)).first;
 	}
 
+	document_.reset(YAML::Clone(entry_it->second.document));
+	namespace_nodes_.clear();
+	is_loaded_ = true;
 	return true;
 }
 
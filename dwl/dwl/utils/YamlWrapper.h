@@ -3,6 +3,7 @@
 
 #include <dwl/utils/utils.h>
 #include <fstream>
+#include <map>
 #include <yaml-cpp/yaml.h>
 
 
@@ -13,7 +14,9 @@ typedef std::vector<std::string> YamlNamespace;
 
 /**
  * @class YamlWrapper
- * @brief This class includes different functions for reading and writing YAML files
+ * @brief This class includes different functions for reading and writing YAML files. The file
+ * is parsed once per wrapper, and the parsed files are shared in a process-wide cache that is
+ * invalidated when the file changes (modification time or size)
  * @author Carlos Mastalli
  * @copyright BSD 3-Clause License
  */
@@ -297,13 +300,36 @@ class YamlWrapper
 		bool getNode(YAML::Node& node,
 					 const YamlNamespace& ns = YamlNamespace());
 
+		/** @brief Clears the process-wide cache of parsed files */
+		static void clearFileCache();
+
 
 	private:
+		/** @brief Process-wide cache of the parsed files */
+		struct FileCache;
+
+		/** @brief Gets the process-wide cache of the parsed files */
+		static FileCache& getFileCache();
+
+		/**
+		 * @brief Loads the document of the file from the process-wide cache, which parses the
+		 * file only if it isn't cached or if it changed
+		 * @return True if the document was loaded
+		 */
+		bool loadDocument();
+
 		/** @brief File name for data reading/writing from/to a yaml */
 		std::string filename_;
 
 		/** @brief Labels that indicates that the filename was defined */
 		bool is_file_;
+
+		/** @brief Parsed document of the file, and label that indicates if it was loaded */
+		YAML::Node document_;
+		bool is_loaded_;
+
+		/** @brief Nodes of the namespaces that were already found */
+		std::map<std::string, YAML::Node> namespace_nodes_;
 };
 
 } //@namespace dwl
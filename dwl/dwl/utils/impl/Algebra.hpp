@@ -0,0 +1,103 @@
+#ifndef DWL__MATH__ALGEBRA__IMPL_H
+#define DWL__MATH__ALGEBRA__IMPL_H
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+/**
+ * @brief Checks the rank of a LDLT factorization of a Gram matrix, i.e. the pivots are bigger
+ * than the tolerance relative to the biggest one
+ * @param const TFactorization& LDLT factorization
+ * @param double Relative tolerance of the pivots
+ * @return True if the Gram matrix has full rank
+ */
+template <typename TFactorization>
+bool isFullRankFactorization(const TFactorization& ldlt,
+							 double tolerance)
+{
+	if (ldlt.info() != Eigen::Success || ldlt.vectorD().size() == 0)
+		return false;
+
+	double max_pivot = ldlt.vectorD().cwiseAbs().maxCoeff();
+	return max_pivot > 0. && ldlt.vectorD().minCoeff() > tolerance * max_pivot;
+}
+
+
+template <typename TSolution, typename TMatrix, typename TVector>
+bool dampedLeastSquares(TSolution& solution,
+						const Eigen::MatrixBase<TMatrix>& matrix,
+						const Eigen::MatrixBase<TVector>& vector,
+						double damping,
+						double tolerance)
+{
+	typedef Eigen::Matrix<double,TMatrix::RowsAtCompileTime,TMatrix::RowsAtCompileTime> WideGram;
+	typedef Eigen::Matrix<double,TMatrix::ColsAtCompileTime,TMatrix::ColsAtCompileTime> TallGram;
+
+	// Solving the normal equations of the smaller Gram matrix
+	double damping_sq = damping * damping;
+	if (matrix.rows() <= matrix.cols()) {
+		WideGram gram = matrix * matrix.transpose();
+		gram.diagonal().array() += damping_sq;
+		Eigen::LDLT<WideGram> ldlt(gram);
+		if (isFullRankFactorization(ldlt, tolerance)) {
+			solution = matrix.transpose() * ldlt.solve(vector);
+			return true;
+		}
+	} else {
+		TallGram gram = matrix.transpose() * matrix;
+		gram.diagonal().array() += damping_sq;
+		Eigen::LDLT<TallGram> ldlt(gram);
+		if (isFullRankFactorization(ldlt, tolerance)) {
+			solution = ldlt.solve(matrix.transpose() * vector);
+			return true;
+		}
+	}
+
+	// Using the SVD for rank-deficient problems
+	solution = dampedSVDPseudoInverse(matrix, damping, tolerance) * vector;
+	return false;
+}
+
+
+template <typename TInverse, typename TMatrix>
+bool dampedPseudoInverse(TInverse& inverse,
+						 const Eigen::MatrixBase<TMatrix>& matrix,
+						 double damping,
+						 double tolerance)
+{
+	typedef Eigen::Matrix<double,TMatrix::RowsAtCompileTime,TMatrix::RowsAtCompileTime> WideGram;
+	typedef Eigen::Matrix<double,TMatrix::ColsAtCompileTime,TMatrix::ColsAtCompileTime> TallGram;
+
+	// Solving the normal equations of the smaller Gram matrix, where A' G^-1 = (G^-1 A)'
+	double damping_sq = damping * damping;
+	if (matrix.rows() <= matrix.cols()) {
+		WideGram gram = matrix * matrix.transpose();
+		gram.diagonal().array() += damping_sq;
+		Eigen::LDLT<WideGram> ldlt(gram);
+		if (isFullRankFactorization(ldlt, tolerance)) {
+			inverse = ldlt.solve(matrix).transpose();
+			return true;
+		}
+	} else {
+		TallGram gram = matrix.transpose() * matrix;
+		gram.diagonal().array() += damping_sq;
+		Eigen::LDLT<TallGram> ldlt(gram);
+		if (isFullRankFactorization(ldlt, tolerance)) {
+			inverse = ldlt.solve(matrix.transpose());
+			return true;
+		}
+	}
+
+	// Using the SVD for rank-deficient problems
+	inverse = dampedSVDPseudoInverse(matrix, damping, tolerance);
+	return false;
+}
+
+} //@namespace math
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef DWL__MATH__FRAME_TF__IMPL_H
+#define DWL__MATH__FRAME_TF__IMPL_H
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+template <typename Scalar>
+void FrameTF::rotate(Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_out,
+					 const Eigen::Matrix<Scalar,3,3>& rotation_mtx,
+					 const Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_in) const
+{
+	// Note that the product is evaluated in a temporary only if the input and output
+	// are the same matrix
+	if (&vecs_out == &vecs_in)
+		vecs_out = rotation_mtx * vecs_in;
+	else
+		vecs_out.noalias() = rotation_mtx * vecs_in;
+}
+
+
+template <typename Scalar>
+void FrameTF::rotateYaws(Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_out,
+						 const Eigen::Matrix<Scalar,3,Eigen::Dynamic>& vecs_in,
+						 const Eigen::Matrix<Scalar,Eigen::Dynamic,1>& yaws,
+						 Scalar sign) const
+{
+	// Rotating every vector around the z axis (in place if both are the same matrix)
+	if (&vecs_out != &vecs_in)
+		vecs_out = vecs_in;
+	for (unsigned int i = 0; i < vecs_out.cols(); i++) {
+		Scalar cy = std::cos(yaws(i)), sy = sign * std::sin(yaws(i));
+		Scalar x = vecs_out(0,i), y = vecs_out(1,i);
+		vecs_out(0,i) = cy * x - sy * y;
+		vecs_out(1,i) = sy * x + cy * y;
+	}
+}
+
+} //@namespace math
+} //@namespace dwl
+
+#endif
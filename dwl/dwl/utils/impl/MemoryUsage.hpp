@@ -0,0 +1,121 @@
+#ifndef DWL__UTILS__MEMORY_USAGE__IMPL_H
+#define DWL__UTILS__MEMORY_USAGE__IMPL_H
+
+
+namespace dwl
+{
+
+namespace utils
+{
+
+namespace internal
+{
+
+/** @brief Heap bytes of the types that report them, which is preferred by the overload */
+template<typename T>
+auto getReportedHeapBytes(const T& value, int) -> decltype(value.getHeapBytes())
+{
+	return value.getHeapBytes();
+}
+
+
+/** @brief Heap bytes of the other types, which don't have heap memory */
+template<typename T>
+std::size_t getReportedHeapBytes(const T&, long)
+{
+	return 0;
+}
+
+/** @brief Overhead of the pointers of the nodes of a tree (color, parent and children) */
+const std::size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+
+/** @brief Overhead of the nodes of a hash table (next node and cached hash) */
+const std::size_t HASH_NODE_OVERHEAD = 2 * sizeof(void*);
+
+} //@namespace internal
+
+
+template<typename T>
+std::size_t getHeapBytes(const T& value)
+{
+	return internal::getReportedHeapBytes(value, 0);
+}
+
+
+template<typename S, int R, int C, int O, int MR, int MC>
+std::size_t getHeapBytes(const Eigen::Matrix<S,R,C,O,MR,MC>& matrix)
+{
+	if (R == Eigen::Dynamic || C == Eigen::Dynamic)
+		return matrix.size() * sizeof(S);
+	else
+		return 0;
+}
+
+
+template<typename T, typename A>
+std::size_t getHeapBytes(const std::vector<T,A>& vector)
+{
+	std::size_t bytes = vector.capacity() * sizeof(T);
+	for (typename std::vector<T,A>::const_iterator it = vector.begin();
+			it != vector.end(); ++it)
+		bytes += getHeapBytes(*it);
+
+	return bytes;
+}
+
+
+template<typename T, typename A>
+std::size_t getHeapBytes(const std::deque<T,A>& deque)
+{
+	std::size_t bytes = deque.size() * sizeof(T);
+	for (typename std::deque<T,A>::const_iterator it = deque.begin();
+			it != deque.end(); ++it)
+		bytes += getHeapBytes(*it);
+
+	return bytes;
+}
+
+
+template<typename K, typename T, typename C, typename A>
+std::size_t getHeapBytes(const std::map<K,T,C,A>& map)
+{
+	typedef typename std::map<K,T,C,A>::value_type Value;
+	std::size_t bytes = map.size() * (sizeof(Value) + internal::TREE_NODE_OVERHEAD);
+	for (typename std::map<K,T,C,A>::const_iterator it = map.begin(); it != map.end(); ++it)
+		bytes += getHeapBytes(it->first) + getHeapBytes(it->second);
+
+	return bytes;
+}
+
+
+template<typename K, typename T, typename H, typename E, typename A>
+std::size_t getHeapBytes(const std::unordered_map<K,T,H,E,A>& map)
+{
+	typedef typename std::unordered_map<K,T,H,E,A>::value_type Value;
+	std::size_t bytes = map.size() * (sizeof(Value) + internal::HASH_NODE_OVERHEAD) +
+			map.bucket_count() * sizeof(void*);
+	for (typename std::unordered_map<K,T,H,E,A>::const_iterator it = map.begin();
+			it != map.end(); ++it)
+		bytes += getHeapBytes(it->first) + getHeapBytes(it->second);
+
+	return bytes;
+}
+
+
+template<typename T1, typename T2>
+std::size_t getHeapBytes(const std::pair<T1,T2>& pair)
+{
+	return getHeapBytes(pair.first) + getHeapBytes(pair.second);
+}
+
+
+template<typename T>
+std::size_t getHeapBytes(const CopyOnWrite<T>& value)
+{
+	return sizeof(T) + getHeapBytes(value.read());
+}
+
+} //@namespace utils
+} //@namespace dwl
+
+#endif
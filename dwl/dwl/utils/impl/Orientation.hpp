@@ -0,0 +1,88 @@
+#ifndef DWL__MATH__ORIENTATION__IMPL_H
+#define DWL__MATH__ORIENTATION__IMPL_H
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,1> getRPY(const Eigen::Matrix<Scalar,3,3>& rotation_mtx)
+{
+	// Note that the pitch argument is clamped since the rounding errors could move it
+	// outside [-1,1] near the gimbal lock. The std functions keep the scalar precision
+	Eigen::Matrix<Scalar,3,1> rpy;
+	rpy[0] = std::atan2(rotation_mtx(2,1), rotation_mtx(2,2));
+	rpy[1] = std::asin(std::max(Scalar(-1), std::min(Scalar(1), -rotation_mtx(2,0))));
+	rpy[2] = std::atan2(rotation_mtx(1,0), rotation_mtx(0,0));
+
+	return rpy;
+}
+
+
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,1> getRPY(const Eigen::Quaternion<Scalar>& quaternion)
+{
+	Eigen::Matrix<Scalar,3,3> rotation_mtx = quaternion.toRotationMatrix();
+
+	return getRPY<Scalar>(rotation_mtx);
+}
+
+
+template <typename Scalar>
+Eigen::Quaternion<Scalar> getQuaternion(const Eigen::Matrix<Scalar,3,1>& rpy)
+{
+	// Computing the trigonometric functions of the half angles once
+	Scalar cr = std::cos(rpy[0] / 2), sr = std::sin(rpy[0] / 2);
+	Scalar cp = std::cos(rpy[1] / 2), sp = std::sin(rpy[1] / 2);
+	Scalar cy = std::cos(rpy[2] / 2), sy = std::sin(rpy[2] / 2);
+
+	Scalar w = cr * cp * cy + sr * sp * sy;
+	Scalar x = sr * cp * cy - cr * sp * sy;
+	Scalar y = cr * sp * cy + sr * cp * sy;
+	Scalar z = cr * cp * sy - sr * sp * cy;
+
+	return Eigen::Quaternion<Scalar>(w, x, y, z);
+}
+
+
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,3> getRotationMatrix(const Eigen::Matrix<Scalar,3,1>& rpy)
+{
+	// Computing directly R = Rz(yaw) * Ry(pitch) * Rx(roll), which avoids the
+	// quaternion
+	Scalar cr = std::cos(rpy[0]), sr = std::sin(rpy[0]);
+	Scalar cp = std::cos(rpy[1]), sp = std::sin(rpy[1]);
+	Scalar cy = std::cos(rpy[2]), sy = std::sin(rpy[2]);
+
+	Eigen::Matrix<Scalar,3,3> rotation_mtx;
+	rotation_mtx << cy * cp,  cy * sp * sr - sy * cr,  cy * sp * cr + sy * sr,
+					sy * cp,  sy * sp * sr + cy * cr,  sy * sp * cr - cy * sr,
+					    -sp,                 cp * sr,                 cp * cr;
+
+	return rotation_mtx;
+}
+
+
+template <typename Scalar>
+Eigen::Matrix<Scalar,3,3> getRotationMatrix(const Eigen::Quaternion<Scalar>& quaternion)
+{
+	return quaternion.toRotationMatrix();
+}
+
+
+template <typename Scalar>
+Scalar getYaw(const Eigen::Quaternion<Scalar>& quaternion)
+{
+	// Note that only the first column of the rotation matrix is needed
+	Scalar w = quaternion.w(), x = quaternion.x();
+	Scalar y = quaternion.y(), z = quaternion.z();
+	return std::atan2(2 * (x * y + w * z), 1 - 2 * (y * y + z * z));
+}
+
+} //@namespace math
+} //@namespace dwl
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef DWL__MATH__SPLINE_INTERPOLATION__IMPL_H
+#define DWL__MATH__SPLINE_INTERPOLATION__IMPL_H
+
+
+namespace dwl
+{
+
+namespace math
+{
+
+template<int N>
+SplineN<N>::SplineN() : initial_time_(0.), duration_(0.)
+{
+
+}
+
+
+template<int N>
+double SplineN<N>::getInitialTime() const
+{
+	return initial_time_;
+}
+
+
+template<int N>
+double SplineN<N>::getDuration() const
+{
+	return duration_;
+}
+
+
+template<int N>
+bool SplineN<N>::getElapsedTime(double& dt,
+								const double& current_time) const
+{
+	dt = current_time - initial_time_;
+	if (dt > duration_)
+		dt = duration_;
+
+	// sanity checks
+	if (dt < 0)
+		return false;
+
+	return true;
+}
+
+
+template<int N>
+CubicSplineN<N>::CubicSplineN()
+{
+	a0_.setZero();
+	a1_.setZero();
+	a2_.setZero();
+	a3_.setZero();
+}
+
+
+template<int N>
+void CubicSplineN<N>::setBoundary(const double& initial_time,
+								  const double& duration,
+								  const Point& start,
+								  const Point& end)
+{
+	this->initial_time_ = initial_time;
+	this->duration_ = duration;
+
+	// Sanity check: no interpolation is required if the duration is zero
+	a0_ = start.x.array();
+	a1_ = start.xd.array();
+	if (duration == 0.) {
+		a2_ = start.xdd.array() / 2;
+		a3_.setZero();
+		return;
+	}
+
+	// powers of the duration
+	double T1 = duration;
+	double T2 = duration * T1;
+	double T3 = duration * T2;
+
+	// spline coefficients
+	a2_ = -((3 * a0_) - (3 * end.x.array()) + (2 * T1 * a1_) + (T1 * end.xd.array())) / T2;
+	a3_ = ((2 * a0_) - (2 * end.x.array()) + T1 * (a1_ + end.xd.array())) / T3;
+}
+
+
+template<int N>
+bool CubicSplineN<N>::getPoint(const double& current_time,
+							   Point& out) const
+{
+	double dt;
+	if (!this->getElapsedTime(dt, current_time))
+		return false;
+
+	// interpolated point of all the channels
+	double dt2 = dt * dt;
+	out.x = (a0_ + a1_ * dt + a2_ * dt2 + a3_ * (dt * dt2)).matrix();
+	out.xd = (a1_ + 2 * a2_ * dt + 3 * a3_ * dt2).matrix();
+	out.xdd = (2 * a2_ + 6 * a3_ * dt).matrix();
+
+	return true;
+}
+
+
+template<int N>
+bool CubicSplineN<N>::getPoint(const double& current_time,
+							   Vector& pos) const
+{
+	double dt;
+	if (!this->getElapsedTime(dt, current_time))
+		return false;
+
+	pos = (a0_ + dt * (a1_ + dt * (a2_ + dt * a3_))).matrix();
+
+	return true;
+}
+
+
+template<int N>
+FifthOrderPolySplineN<N>::FifthOrderPolySplineN()
+{
+	a0_.setZero();
+	a1_.setZero();
+	a2_.setZero();
+	a3_.setZero();
+	a4_.setZero();
+	a5_.setZero();
+}
+
+
+template<int N>
+void FifthOrderPolySplineN<N>::setBoundary(const double& initial_time,
+										   const double& duration,
+										   const Point& start,
+										   const Point& end)
+{
+	this->initial_time_ = initial_time;
+	this->duration_ = duration;
+
+	// Sanity check: no interpolation is required if the duration is zero
+	a0_ = start.x.array();
+	a1_ = start.xd.array();
+	a2_ = start.xdd.array() / 2;
+	if (duration == 0.) {
+		a3_.setZero();
+		a4_.setZero();
+		a5_.setZero();
+		return;
+	}
+
+	// powers of duration
+	double T1 = duration;
+	double T2 = duration * T1;
+	double T3 = duration * T2;
+	double T4 = duration * T3;
+	double T5 = duration * T4;
+
+	// spline coefficients
+	Array delta = end.x.array() - a0_;
+	a3_ = (20 * delta - T1 * (8 * end.xd.array() + 12 * a1_) -
+			T2 * (3 * start.xdd.array() - end.xdd.array())) / (2 * T3);
+	a4_ = (-30 * delta + T1 * (14 * end.xd.array() + 16 * a1_) +
+			T2 * (3 * start.xdd.array() - 2 * end.xdd.array())) / (2 * T4);
+	a5_ = (12 * delta - 6 * T1 * (end.xd.array() + a1_) +
+			T2 * (end.xdd.array() - start.xdd.array())) / (2 * T5);
+}
+
+
+template<int N>
+bool FifthOrderPolySplineN<N>::getPoint(const double& current_time,
+										Point& out) const
+{
+	double dt;
+	if (!this->getElapsedTime(dt, current_time))
+		return false;
+
+	// interpolated point of all the channels
+	double dt2 = dt * dt;
+	double dt3 = dt * dt2;
+	double dt4 = dt * dt3;
+	double dt5 = dt * dt4;
+	out.x = (a0_ + a1_ * dt + a2_ * dt2 + a3_ * dt3 + a4_ * dt4 + a5_ * dt5).matrix();
+	out.xd = (a1_ + 2 * a2_ * dt + 3 * a3_ * dt2 + 4 * a4_ * dt3 + 5 * a5_ * dt4).matrix();
+	out.xdd = (2 * a2_ + 6 * a3_ * dt + 12 * a4_ * dt2 + 20 * a5_ * dt3).matrix();
+
+	return true;
+}
+
+
+template<int N>
+bool FifthOrderPolySplineN<N>::getPoint(const double& current_time,
+										Vector& pos) const
+{
+	double dt;
+	if (!this->getElapsedTime(dt, current_time))
+		return false;
+
+	pos = (a0_ + dt * (a1_ + dt * (a2_ + dt * (a3_ + dt * (a4_ + dt * a5_))))).matrix();
+
+	return true;
+}
+
+
+template<int N>
+LinearSplineN<N>::LinearSplineN()
+{
+	a0_.setZero();
+	a1_.setZero();
+}
+
+
+template<int N>
+void LinearSplineN<N>::setBoundary(const double& initial_time,
+								   const double& duration,
+								   const Point& start,
+								   const Point& end)
+{
+	this->initial_time_ = initial_time;
+	this->duration_ = duration;
+
+	// Sanity check: no interpolation is required if the duration is zero
+	a0_ = start.x.array();
+	if (duration == 0.)
+		a1_.setZero();
+	else
+		a1_ = (end.x.array() - a0_) / duration;
+}
+
+
+template<int N>
+bool LinearSplineN<N>::getPoint(const double& current_time,
+								Point& out) const
+{
+	double dt;
+	if (!this->getElapsedTime(dt, current_time))
+		return false;
+
+	out.x = (a0_ + a1_ * dt).matrix();
+	out.xd = a1_.matrix();
+	out.xdd.setZero();
+
+	return true;
+}
+
+
+template<int N>
+bool LinearSplineN<N>::getPoint(const double& current_time,
+								Vector& pos) const
+{
+	double dt;
+	if (!this->getElapsedTime(dt, current_time))
+		return false;
+
+	pos = (a0_ + a1_ * dt).matrix();
+
+	return true;
+}
+
+} //@namespace math
+} //@namespace dwl
+
+#endif
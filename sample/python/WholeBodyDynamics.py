@@ -197,3 +197,21 @@ print("------------------------------ Active contacts --------------------------
 wdyn.getActiveContacts(active_contacts,
                        contact_forces, force_threshold);
 print("The active contacts:", active_contacts)
+
+
+
+print()
+print("------------------------------ Batched inverse dynamics ---------------------------")
+# Every row is a state, and an array without columns means no external forces
+num_states = 100
+batch_joint_pos = np.tile(joint_pos, (num_states, 1)) + \
+                  0.1 * np.random.randn(num_states, fbs.getJointDoF())
+base_batch = np.tile(base_pos, (num_states, 1))
+joint_batch = np.zeros((num_states, fbs.getJointDoF()))
+batch_base_wrench, batch_joint_forces = \
+    wdyn.computeInverseDynamicsBatch(base_batch, batch_joint_pos,
+                                     np.zeros((num_states, 6)), joint_batch,
+                                     np.zeros((num_states, 6)), joint_batch,
+                                     np.zeros((num_states, 0)))
+print("The batch of base wrenches:", batch_base_wrench.shape)
+print("The batch of joint forces:", batch_joint_forces.shape)
@@ -112,3 +112,15 @@ if wkin.computeInverseKinematics(base_pos, joint_pos, contact_pos_B, base_pos_in
     print("The joint positions:", joint_pos.transpose())
 else:
     print("The WB-IK problem could not be solved")
+
+
+# Computing the forward kinematics of a batch of states, where every row is a
+# state and the bodies are stacked as [quaternion, position] per foot
+num_states = 100
+batch_base_pos = np.tile(base_pos, (num_states, 1))
+batch_joint_pos = np.tile(fbs.getDefaultPosture(), (num_states, 1)) + \
+                  0.1 * np.random.randn(num_states, fbs.getJointDoF())
+batch_op_pos = wkin.computePositionBatch(batch_base_pos, batch_joint_pos,
+                                         fbs.getEndEffectorNames(dwl.FOOT),
+                                         dwl.Full, dwl.Quaternion)
+print("The batch of foot poses:", batch_op_pos.shape)
@@ -53,3 +53,22 @@ print("	contact_vel_W: ", ws.getContactVelocity_W())
 print("	contact_vel_H: ", ws.getContactVelocity_H())
 print("	lf_foot_wrc_B: ", ws.getContactWrench_B("lf_foot").transpose())
 print("	contact_wrc_B: ", ws.getContactWrench_B())
+
+
+# The attributes are views of the C++ storage, so they are modified in place
+joint_pos = ws.joint_pos
+joint_pos[0] = 0.25
+print("	joint_pos[0]: ", ws.getJointPosition()[0])
+
+
+# Exporting a trajectory to arrays [rows x K]
+trajectory = dwl.WholeBodyTrajectory()
+for k in range(5):
+	state = dwl.WholeBodyState()
+	state.setJointDoF(12)
+	state.time = 0.1 * k
+	trajectory.append(state)
+arrays = dwl.wholeBodyTrajectoryToArrays(trajectory)
+print("Trajectory arrays:")
+print("	time: ", arrays['time'].transpose())
+print("	joint_pos: ", arrays['joint_pos'].shape)
@@ -0,0 +1,73 @@
+#!/bin/bash
+
+
+# Display help
+programname=$0
+function usage {
+    echo "usage: $programname [--build:dir] [--jobs:] [cmake options]"
+    echo "	--help, -h			print this message"
+    echo "	--build:			specify the build directory (default build/pgo)"
+    echo "	--jobs:				specify the number of build jobs"
+    echo ""
+    echo "Builds DWL with profile-guided optimization, i.e. it builds instrumented code, runs"
+    echo "the benchmark and sample workloads (FK/ID, preview and planning), and rebuilds the"
+    echo "code with the recorded profiles. The rest of options are passed to cmake"
+    exit 1
+}
+
+
+# Check arguments
+source_dir=$(cd $(dirname $0)/.. && pwd)
+build_dir=$source_dir/build/pgo
+jobs=$(nproc)
+cmake_options=()
+for ARG in "$@"; do
+	if [ $ARG == "--help" ] || [ $ARG == "-h" ]; then  # Display help
+		usage
+		exit
+	elif [ ${ARG:0:8} == "--build:" ]; then
+		build_dir=${ARG:8}
+	elif [ ${ARG:0:7} == "--jobs:" ]; then
+		jobs=${ARG:7}
+	else
+		cmake_options+=("$ARG")
+	fi
+done
+profile_dir=$build_dir/profiles
+bin_dir=$source_dir/bin
+set -e
+
+
+################################################################################
+## build the instrumented code
+rm -rf $profile_dir
+mkdir -p $profile_dir
+cmake -S $source_dir -B $build_dir -DCMAKE_BUILD_TYPE=Release -DDWL_PGO=GENERATE \
+	-DDWL_PGO_DIR=$profile_dir -DDWL_WITH_BENCHMARK=ON -DDWL_WITH_SAMPLE=ON "${cmake_options[@]}"
+cmake --build $build_dir -- -j$jobs
+
+
+################################################################################
+## run the workloads, which record the profiles
+if [ -x $bin_dir/dwl_benchmark ]; then
+	$bin_dir/dwl_benchmark --benchmark_min_time=0.2
+else
+	echo "Warning: the micro-benchmark suite was not built (it requires Google Benchmark)"
+fi
+for workload in wif_benchmark kin_sample dyn_sample fb_sample; do
+	if [ -x $bin_dir/$workload ]; then
+		$bin_dir/$workload > /dev/null
+	fi
+done
+
+# Merging the raw profiles of Clang
+if ls $profile_dir/*.profraw > /dev/null 2>&1; then
+	llvm-profdata merge -output=$profile_dir/dwl.profdata $profile_dir/*.profraw
+fi
+
+
+################################################################################
+## rebuild the code with the profiles
+cmake -S $source_dir -B $build_dir -DDWL_PGO=USE
+cmake --build $build_dir -- -j$jobs
+echo "The profile-guided build is in $build_dir"
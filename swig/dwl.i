@@ -11,6 +11,9 @@
 #include <dwl/model/WholeBodyKinematics.h>
 #include <dwl/model/WholeBodyDynamics.h>
 #include <dwl/RobotStates.h>
+#include <dwl/TrajectoryContainer.h>
+#include <dwl/TrajectoryFile.h>
+#include <dwl/utils/MemoryUsage.h>
 
 // Optimization-related core functions
 #include <dwl/model/OptimizationModel.h>
@@ -114,6 +117,26 @@
 %rename(setFootAccelerationDict_B) setFootAcceleration_B(const rbd::BodyVectorXd&);
 %rename(setFootAccelerationDict_H) setFootAcceleration_H(const rbd::BodyVectorXd&);
 
+// Ignoring the batched methods of the kinematic and dynamic classes since they
+// use Eigen references, so they are wrapped below for NumPy arrays
+%ignore computeForwardKinematics(Eigen::MatrixXd&,
+								 const Eigen::Ref<const Eigen::MatrixXd>&,
+								 const Eigen::Ref<const Eigen::MatrixXd>&,
+								 const rbd::BodySelector&,
+								 enum rbd::Component,
+								 enum TypeOfOrientation,
+								 unsigned int);
+%ignore computeInverseDynamics(Eigen::MatrixXd&,
+							   Eigen::MatrixXd&,
+							   const Eigen::Ref<const Eigen::MatrixXd>&,
+							   const Eigen::Ref<const Eigen::MatrixXd>&,
+							   const Eigen::Ref<const Eigen::MatrixXd>&,
+							   const Eigen::Ref<const Eigen::MatrixXd>&,
+							   const Eigen::Ref<const Eigen::MatrixXd>&,
+							   const Eigen::Ref<const Eigen::MatrixXd>&,
+							   const Eigen::Ref<const Eigen::MatrixXd>&,
+							   unsigned int);
+
 // Ignoring two methods of the WholeBodyKinematic class that generate
 // ambiguity
 %ignore computeJointPosition(Eigen::VectorXd&,
@@ -142,6 +165,26 @@
 										   const Eigen::VectorXd&,
 										   const Eigen::VectorXd&);
 
+// Ignoring the state views of the trajectory containers since they return
+// Eigen blocks, so the points are accessed through getState and setState
+%ignore dwl::WholeBodyTrajectoryContainer::StateView;
+%ignore dwl::WholeBodyTrajectoryContainer::getView;
+%ignore dwl::ReducedBodyTrajectoryContainer::StateView;
+%ignore dwl::ReducedBodyTrajectoryContainer::getView;
+
+// Ignoring the quantities of the mapped trajectories since they return Eigen
+// maps, so the points are accessed through getState, and the whole trajectory
+// through toContainer (or loadTrajectory)
+%ignore dwl::trajectory_file::Magic;
+%rename("$ignore", regextarget=1, fullname=1)
+		"^dwl::MappedWholeBodyTrajectory::(time|duration|base_.*|joint_.*|contact_.*)$";
+%rename("$ignore", regextarget=1, fullname=1)
+		"^dwl::MappedReducedBodyTrajectory::(time|com_.*|angular_.*|cop|support_region|foot_.*)$";
+
+// Ignoring the generic heap bytes of the values since they are templates, so the
+// memory is reported through the getHeapBytes methods and the MemoryUsage reports
+%ignore dwl::utils::getHeapBytes;
+
 %rename(urdf_Joint) urdf::Joint;
 %rename(urdf_Pose) urdf::Pose;
 %include <dwl/utils/RigidBodyDynamics.h>
@@ -155,6 +198,36 @@
 %include <dwl/model/WholeBodyKinematics.h>
 %include <dwl/model/WholeBodyDynamics.h>
 %include <dwl/RobotStates.h>
+%include <dwl/TrajectoryContainer.h>
+%include <dwl/TrajectoryFile.h>
+%template(WholeBodyTrajectory) std::vector<dwl::WholeBodyState>;
+%template(ReducedBodyTrajectory) std::vector<dwl::ReducedBodyState>;
+%include <dwl/utils/MemoryUsage.h>
+%template(MemoryUsage_List) std::vector<dwl::utils::MemoryUsage>;
+
+// Exporting the trajectories to arrays, where the quantities of the containers
+// are views [rows x K] of the container storage, so every quantity of the whole
+// trajectory is converted once instead of once per state
+%pythoncode %{
+def wholeBodyTrajectoryToArrays(trajectory):
+    if not isinstance(trajectory, WholeBodyTrajectoryContainer):
+        container = WholeBodyTrajectoryContainer()
+        container.fromTrajectory(trajectory)
+        trajectory = container
+    names = ['time', 'duration', 'base_pos', 'base_vel', 'base_acc', 'base_eff',
+             'joint_pos', 'joint_vel', 'joint_acc', 'joint_eff', 'contact_pos',
+             'contact_vel', 'contact_acc', 'contact_eff']
+    return dict((name, getattr(trajectory, name)) for name in names)
+
+def reducedBodyTrajectoryToArrays(trajectory):
+    if not isinstance(trajectory, ReducedBodyTrajectoryContainer):
+        container = ReducedBodyTrajectoryContainer()
+        container.fromTrajectory(trajectory)
+        trajectory = container
+    names = ['time', 'com_pos', 'angular_pos', 'com_vel', 'angular_vel', 'com_acc',
+             'angular_acc', 'cop', 'support_region', 'foot_pos', 'foot_vel', 'foot_acc']
+    return dict((name, getattr(trajectory, name)) for name in names)
+%}
 
 // Extending the C++ class by adding printing methods in python
 %extend dwl::ReducedBodyState {
@@ -260,6 +333,80 @@
 %init %{
 	import_array();
 %}
+
+// Batched kinematics and dynamics over NumPy arrays, where every row is a state
+// (i.e. [N x n] arrays). A C-ordered array [N x n] has the memory layout of an
+// Eigen matrix [n x N], so the inputs are mapped without copying them, and the
+// states are evaluated in C++ (in parallel) with the GIL released
+%apply (double* IN_ARRAY2, int DIM1, int DIM2) {(double* base_pos, int num_base_pos, int base_pos_dim),
+												(double* joint_pos, int num_joint_pos, int joint_pos_dim),
+												(double* base_vel, int num_base_vel, int base_vel_dim),
+												(double* joint_vel, int num_joint_vel, int joint_vel_dim),
+												(double* base_acc, int num_base_acc, int base_acc_dim),
+												(double* joint_acc, int num_joint_acc, int joint_acc_dim),
+												(double* ext_force, int num_ext_force, int ext_force_dim)}
+%apply (double** ARGOUTVIEWM_ARRAY2, int* DIM1, int* DIM2) {(double** op_pos, int* num_op_pos, int* op_pos_dim),
+															(double** base_wrench, int* num_base_wrench, int* base_wrench_dim),
+															(double** joint_forces, int* num_joint_forces, int* joint_forces_dim)}
+%{
+// Copies a batch [n x N] to a new array [N x n], which is owned by NumPy
+void copyBatchToArray(double** array, int* num_states, int* dim,
+					  const Eigen::MatrixXd& batch)
+{
+	*num_states = batch.cols();
+	*dim = batch.rows();
+	*array = (double*) malloc(std::max((size_t) batch.size(), (size_t) 1) * sizeof(double));
+	Eigen::Map<Eigen::MatrixXd>(*array, batch.rows(), batch.cols()) = batch;
+}
+%}
+%extend dwl::model::WholeBodyKinematics {
+	void computePositionBatch(double** op_pos, int* num_op_pos, int* op_pos_dim,
+							  double* base_pos, int num_base_pos, int base_pos_dim,
+							  double* joint_pos, int num_joint_pos, int joint_pos_dim,
+							  const dwl::rbd::BodySelector& body_set,
+							  enum dwl::rbd::Component component = dwl::rbd::Full,
+							  enum dwl::TypeOfOrientation type = dwl::RollPitchYaw,
+							  unsigned int num_threads = 0) {
+		Eigen::Map<const Eigen::MatrixXd> base_pos_batch(base_pos, base_pos_dim, num_base_pos);
+		Eigen::Map<const Eigen::MatrixXd> joint_pos_batch(joint_pos, joint_pos_dim, num_joint_pos);
+		Eigen::MatrixXd op_pos_batch;
+		Py_BEGIN_ALLOW_THREADS
+		$self->computeForwardKinematics(op_pos_batch, base_pos_batch, joint_pos_batch,
+										body_set, component, type, num_threads);
+		Py_END_ALLOW_THREADS
+		copyBatchToArray(op_pos, num_op_pos, op_pos_dim, op_pos_batch);
+	}
+}
+%extend dwl::model::WholeBodyDynamics {
+	void computeInverseDynamicsBatch(double** base_wrench, int* num_base_wrench, int* base_wrench_dim,
+									 double** joint_forces, int* num_joint_forces, int* joint_forces_dim,
+									 double* base_pos, int num_base_pos, int base_pos_dim,
+									 double* joint_pos, int num_joint_pos, int joint_pos_dim,
+									 double* base_vel, int num_base_vel, int base_vel_dim,
+									 double* joint_vel, int num_joint_vel, int joint_vel_dim,
+									 double* base_acc, int num_base_acc, int base_acc_dim,
+									 double* joint_acc, int num_joint_acc, int joint_acc_dim,
+									 double* ext_force, int num_ext_force, int ext_force_dim,
+									 unsigned int num_threads = 0) {
+		Eigen::Map<const Eigen::MatrixXd> base_pos_batch(base_pos, base_pos_dim, num_base_pos);
+		Eigen::Map<const Eigen::MatrixXd> joint_pos_batch(joint_pos, joint_pos_dim, num_joint_pos);
+		Eigen::Map<const Eigen::MatrixXd> base_vel_batch(base_vel, base_vel_dim, num_base_vel);
+		Eigen::Map<const Eigen::MatrixXd> joint_vel_batch(joint_vel, joint_vel_dim, num_joint_vel);
+		Eigen::Map<const Eigen::MatrixXd> base_acc_batch(base_acc, base_acc_dim, num_base_acc);
+		Eigen::Map<const Eigen::MatrixXd> joint_acc_batch(joint_acc, joint_acc_dim, num_joint_acc);
+		Eigen::Map<const Eigen::MatrixXd> ext_force_batch(ext_force, ext_force_dim, num_ext_force);
+		Eigen::MatrixXd base_wrench_batch, joint_forces_batch;
+		Py_BEGIN_ALLOW_THREADS
+		$self->computeInverseDynamics(base_wrench_batch, joint_forces_batch,
+									  base_pos_batch, joint_pos_batch,
+									  base_vel_batch, joint_vel_batch,
+									  base_acc_batch, joint_acc_batch,
+									  ext_force_batch, num_threads);
+		Py_END_ALLOW_THREADS
+		copyBatchToArray(base_wrench, num_base_wrench, base_wrench_dim, base_wrench_batch);
+		copyBatchToArray(joint_forces, num_joint_forces, joint_forces_dim, joint_forces_batch);
+	}
+}
 // For the typemap of the optimization model interface
 %apply double& INOUT { double& cost };
 %apply (double* IN_ARRAY1, int DIM1) {(double* decision, int decision_dim),
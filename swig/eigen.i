@@ -175,6 +175,47 @@
     return true;
   };
 
+  // Creates a NumPy array that aliases the storage of an Eigen object, where the owner (i.e.
+  // the Python object that holds the Eigen object) is kept alive by the array. Note that the
+  // array is invalidated if the Eigen object is resized
+  template <class Derived>
+  bool ConvertFromEigenToNumPyView(PyObject** out, Eigen::PlainObjectBase<Derived>* in, PyObject* owner)
+  {
+    typedef typename Derived::Scalar Scalar;
+    npy_intp dims[2] = {in->rows(), in->cols()};
+    npy_intp strides[2];
+    if (Derived::IsRowMajor) {
+      strides[0] = in->cols() * sizeof(Scalar);
+      strides[1] = sizeof(Scalar);
+    } else {
+      strides[0] = sizeof(Scalar);
+      strides[1] = in->rows() * sizeof(Scalar);
+    }
+    *out = PyArray_New(&PyArray_Type, 2, dims, NumPyType<Scalar>(), strides,
+                       (void*) in->data(), 0, NPY_ARRAY_WRITEABLE, NULL);
+    if (*out == NULL)
+      return false;
+
+    Py_INCREF(owner);
+%#if NPY_API_VERSION < 0x00000007
+    PyArray_BASE((PyArrayObject*) *out) = owner;
+%#else
+    if (PyArray_SetBaseObject((PyArrayObject*) *out, owner) != 0) {
+      Py_DECREF(*out);
+      return false;
+    }
+%#endif
+    return true;
+  };
+
+  // Gets the Python object of the instance of a wrapped method, i.e. its first argument
+  inline PyObject* GetSwigOwner(PyObject* args)
+  {
+    if (args != NULL && PyTuple_Check(args))
+      return PyTuple_Size(args) > 0 ? PyTuple_GetItem(args, 0) : NULL;
+    return args;
+  };
+
   template<> int NumPyType<double>() {return NPY_DOUBLE;};
   template<> int NumPyType<int>() {return NPY_INT;};
 %}
@@ -223,11 +264,12 @@
   SWIG_fail;
 }
 
-// In: * (not yet implemented)
-%typemap(in, fragment="Eigen_Fragments") CLASS *
+// In: * (for setting the member attributes)
+%typemap(in, fragment="Eigen_Fragments") CLASS * (CLASS temp)
 {
-  PyErr_SetString(PyExc_ValueError, "The input typemap for non-const pointer is not yet implemented. Please report this problem to the developer.");
-  SWIG_fail;
+  if (!ConvertFromNumpyToEigenMatrix<CLASS>(&temp, $input))
+    SWIG_fail;
+  $1 = &temp;
 }
 
 // Out: (nothing: no constness)
@@ -251,11 +293,15 @@
     SWIG_fail;
 }
 
-// Out: & (not yet implemented)
+// Out: & (view that aliases the Eigen storage, and keeps its owner alive)
 %typemap(out, fragment="Eigen_Fragments") CLASS &
 {
-  PyErr_SetString(PyExc_ValueError, "The output typemap for non-const reference is not yet implemented. Please report this problem to the developer.");
-  SWIG_fail;
+  PyObject* owner = GetSwigOwner(args);
+  if (owner != NULL) {
+    if (!ConvertFromEigenToNumPyView<CLASS>(&$result, $1, owner))
+      SWIG_fail;
+  } else if (!ConvertFromEigenToNumPyMatrix<CLASS>(&$result, $1))
+    SWIG_fail;
 }
 
 // Out: const* (not yet implemented)
@@ -265,11 +311,16 @@
   SWIG_fail;
 }
 
-// Out: * (not yet implemented)
+// Out: * (view of the member attributes, e.g. WholeBodyState.joint_pos, which aliases the
+// Eigen storage, and keeps its owner alive)
 %typemap(out, fragment="Eigen_Fragments") CLASS *
 {
-  PyErr_SetString(PyExc_ValueError, "The output typemap for non-const pointer is not yet implemented. Please report this problem to the developer.");
-  SWIG_fail;
+  PyObject* owner = GetSwigOwner(args);
+  if (owner != NULL) {
+    if (!ConvertFromEigenToNumPyView<CLASS>(&$result, $1, owner))
+      SWIG_fail;
+  } else if (!ConvertFromEigenToNumPyMatrix<CLASS>(&$result, $1))
+    SWIG_fail;
 }
 
 // Argout: const & (Disabled and prevents calling of the non-const typemap)
@@ -363,14 +414,14 @@
 }
 
 // Out: const* std::vector<> (not yet implemented)
-%typemap(out, fragment="Eigen_Fragments") CLASS const*
+%typemap(out, fragment="Eigen_Fragments") std::vector<CLASS> const*
 {
   PyErr_SetString(PyExc_ValueError, "The output typemap for const vector pointer is not yet implemented. Please report this problem to the developer.");
   SWIG_fail;
 }
 
 // Out: * std::vector<> (not yet implemented)
-%typemap(out, fragment="Eigen_Fragments") CLASS *
+%typemap(out, fragment="Eigen_Fragments") std::vector<CLASS> *
 {
   PyErr_SetString(PyExc_ValueError, "The output typemap for non-const vector pointer is not yet implemented. Please report this problem to the developer.");
   SWIG_fail;
@@ -0,0 +1,66 @@
+#include <dwl/solver/ADMMQP.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 0.001;
+
+BOOST_AUTO_TEST_CASE(admm_qp) // specify a test case for the ADMM QP solver
+{
+	// min (x0 - 1)^2 + (x1 - 2)^2 s.t. x0 + x1 <= 2, 0 <= x <= 10
+	Eigen::SparseMatrix<double> hessian(2,2);
+	hessian.insert(0,0) = 2.;
+	hessian.insert(1,1) = 2.;
+	Eigen::SparseMatrix<double> constraint_mat(1,2);
+	constraint_mat.insert(0,0) = 1.;
+	constraint_mat.insert(0,1) = 1.;
+	Eigen::VectorXd gradient(2), lower_bound(2), upper_bound(2);
+	Eigen::VectorXd lower_constraint(1), upper_constraint(1);
+	gradient << -2., -4.;
+	lower_bound << 0., 0.;
+	upper_bound << 10., 10.;
+	lower_constraint << -1e20;
+	upper_constraint << 2.;
+
+	dwl::solver::ADMMQP solver;
+	solver.init(2, 1);
+	BOOST_CHECK(solver.compute(hessian, gradient, constraint_mat,
+							   lower_bound, upper_bound,
+							   lower_constraint, upper_constraint, 0.));
+	Eigen::VectorXd solution = solver.getOptimalSolution();
+	BOOST_CHECK_SMALL(solution(0) - 0.5, epsilon);
+	BOOST_CHECK_SMALL(solution(1) - 1.5, epsilon);
+	unsigned int cold_iterations = solver.getNumberOfIterations();
+
+	// Hotstarting with a new gradient, i.e. min (x0 - 3)^2 + (x1)^2 s.t. x0 + x1 <= 2
+	gradient << -6., 0.;
+	BOOST_CHECK(solver.hotstart(gradient,
+								lower_bound, upper_bound,
+								lower_constraint, upper_constraint, 0.));
+	solution = solver.getOptimalSolution();
+	BOOST_CHECK_SMALL(solution(0) - 2., epsilon);
+	BOOST_CHECK_SMALL(solution(1), epsilon);
+
+	// Hotstarting the same problem again converges immediately from the last solution
+	BOOST_CHECK(solver.hotstart(gradient,
+								lower_bound, upper_bound,
+								lower_constraint, upper_constraint, 0.));
+	BOOST_CHECK(solver.getNumberOfIterations() < cold_iterations);
+
+	// Solving an equality-constrained problem with the dense interface
+	Eigen::MatrixXd dense_hessian = Eigen::MatrixXd(hessian);
+	Eigen::MatrixXd dense_constraint = Eigen::MatrixXd(constraint_mat);
+	lower_constraint << 1.;
+	upper_constraint << 1.;
+	gradient << -2., -4.;
+	BOOST_CHECK(solver.compute(dense_hessian, gradient, dense_constraint,
+							   lower_bound, upper_bound,
+							   lower_constraint, upper_constraint, 0.));
+	solution = solver.getOptimalSolution();
+	BOOST_CHECK_SMALL(solution(0), epsilon);
+	BOOST_CHECK_SMALL(solution(1) - 1., epsilon);
+}
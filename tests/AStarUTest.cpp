@@ -0,0 +1,271 @@
+#include <dwl/solver/AStar.h>
+#include <dwl/solver/Dijkstrap.h>
+#include <dwl/solver/HashDistributedAStar.h>
+#include <cstdlib>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+// 8-connected grid where the vertex id is (x * size + y), and the edge weight is the cost of
+// the target cell
+class GridAdjacency : public dwl::model::AdjacencyModel
+{
+	public:
+		GridAdjacency(unsigned int size) : size_(size), cost_(size * size, 1.) {
+			name_ = "Grid";
+		}
+
+		dwl::model::AdjacencyModel* clone() const {
+			return new GridAdjacency(*this);
+		}
+
+		void getSuccessors(dwl::EdgeList& successors,
+						   dwl::Vertex vertex) {
+			dwl::Edge neighbor;
+			for (int dx = -1; dx <= 1; dx++) {
+				for (int dy = -1; dy <= 1; dy++) {
+					if ((dx != 0 || dy != 0) && getGridNeighbor(neighbor, vertex, dx, dy))
+						successors.push_back(neighbor);
+				}
+			}
+		}
+
+		bool getGridNeighbor(dwl::Edge& neighbor,
+							 dwl::Vertex vertex,
+							 int dx, int dy) {
+			int x = vertex / size_ + dx, y = vertex % size_ + dy;
+			if (x < 0 || y < 0 || x >= (int) size_ || y >= (int) size_)
+				return false;
+			neighbor.target = x * size_ + y;
+			neighbor.weight = cost_[neighbor.target];
+			return true;
+		}
+
+		// Chebyshev distance, which is admissible since the minimum cost is one
+		double heuristicCost(dwl::Vertex source, dwl::Vertex target) {
+			int dx = abs((int) (source / size_) - (int) (target / size_));
+			int dy = abs((int) (source % size_) - (int) (target % size_));
+			return std::max(dx, dy);
+		}
+
+		unsigned int size_;
+		std::vector<double> cost_;
+};
+
+
+// Checks that the path is connected in the grid, and computes its cost
+double pathCost(GridAdjacency& adjacency, const std::list<dwl::Vertex>& path)
+{
+	double cost = 0.;
+	unsigned int size = adjacency.size_;
+	for (std::list<dwl::Vertex>::const_iterator it = ++path.begin(); it != path.end(); it++) {
+		std::list<dwl::Vertex>::const_iterator prev = it;
+		--prev;
+		int dx = abs((int) (*it / size) - (int) (*prev / size));
+		int dy = abs((int) (*it % size) - (int) (*prev % size));
+		BOOST_CHECK(std::max(dx, dy) == 1);
+		cost += adjacency.cost_[*it];
+	}
+	return cost;
+}
+
+
+BOOST_AUTO_TEST_CASE(jump_point_search) // specify a test case for the jump point search
+{
+	GridAdjacency* adjacency = new GridAdjacency(60);
+	for (unsigned int x = 20; x < 40; x++) {
+		for (unsigned int y = 10; y < 50; y++)
+			adjacency->cost_[x * 60 + y] = 5.; // rough terrain in the middle of a flat floor
+	}
+	dwl::Vertex source = 5 * 60 + 30, target = 55 * 60 + 32;
+
+	dwl::solver::AStar astar;
+	astar.setAdjacencyModel(adjacency);
+	astar.setIndexedHeap(true, 60 * 60);
+	BOOST_CHECK(astar.compute(source, target, 1.));
+	double cost = astar.getMinimumCost();
+	int expansions = astar.getNumberOfExpansions();
+
+	// The jump point search finds a path with the same cost and far fewer expansions
+	GridAdjacency* jps_adjacency = new GridAdjacency(*adjacency);
+	dwl::solver::AStar jps;
+	jps.setAdjacencyModel(jps_adjacency);
+	jps.setIndexedHeap(true, 60 * 60);
+	jps.setJumpPointSearch(true);
+	BOOST_CHECK(jps.compute(source, target, 1.));
+	BOOST_CHECK_CLOSE(jps.getMinimumCost(), cost, 1e-9);
+	BOOST_CHECK(jps.getNumberOfExpansions() * 3 < expansions);
+
+	// The path has every cell, and its cost is the minimum one
+	std::list<dwl::Vertex> path = jps.getShortestPath(source, target);
+	BOOST_CHECK_EQUAL(path.front(), source);
+	BOOST_CHECK_EQUAL(path.back(), target);
+	BOOST_CHECK_CLOSE(pathCost(*adjacency, path), cost, 1e-9);
+
+	// The contiguous path has the same vertices
+	std::vector<dwl::Vertex> vertex_path;
+	jps.getShortestPath(vertex_path, source, target);
+	BOOST_CHECK(std::equal(vertex_path.begin(), vertex_path.end(), path.begin()));
+	BOOST_CHECK_EQUAL(vertex_path.size(), path.size());
+}
+
+
+
+BOOST_AUTO_TEST_CASE(multi_goal_search) // specify a test case for the multi-goal search
+{
+	GridAdjacency* adjacency = new GridAdjacency(40);
+	for (unsigned int y = 0; y < 35; y++)
+		adjacency->cost_[20 * 40 + y] = 30.; // a wall with a gap
+	dwl::Vertex source = 5 * 40 + 5;
+	std::vector<dwl::Vertex> targets;
+	targets.push_back(35 * 40 + 5);
+	targets.push_back(30 * 40 + 38);
+	targets.push_back(5 * 40 + 30);
+
+	// The best target is the cheapest one of the single-goal searches
+	double best_cost = std::numeric_limits<double>::max();
+	dwl::Vertex best_target = 0;
+	for (unsigned int i = 0; i < targets.size(); i++) {
+		dwl::solver::AStar astar;
+		astar.setAdjacencyModel(new GridAdjacency(*adjacency));
+		astar.setIndexedHeap(true, 40 * 40);
+		astar.compute(source, targets[i], 1.);
+		if (astar.getMinimumCost() < best_cost) {
+			best_cost = astar.getMinimumCost();
+			best_target = targets[i];
+		}
+	}
+
+	dwl::solver::AStar solver;
+	solver.setAdjacencyModel(adjacency);
+	BOOST_CHECK(solver.computeMultiGoal(source, targets, 1.));
+	BOOST_CHECK_EQUAL(solver.getReachedTarget(), best_target);
+	BOOST_CHECK_CLOSE(solver.getMinimumCost(), best_cost, 1e-9);
+
+	std::list<dwl::Vertex> path = solver.getShortestPath(source, solver.getReachedTarget());
+	BOOST_CHECK_EQUAL(path.front(), source);
+	BOOST_CHECK_EQUAL(path.back(), best_target);
+	BOOST_CHECK_CLOSE(pathCost(*adjacency, path), best_cost, 1e-9);
+}
+
+
+BOOST_AUTO_TEST_CASE(bidirectional_search) // specify a test case for the bidirectional search
+{
+	GridAdjacency* adjacency = new GridAdjacency(40);
+	for (unsigned int y = 0; y < 35; y++)
+		adjacency->cost_[20 * 40 + y] = 30.;
+	dwl::Vertex source = 5 * 40 + 5, target = 35 * 40 + 5;
+
+	dwl::solver::AStar astar;
+	astar.setAdjacencyModel(new GridAdjacency(*adjacency));
+	astar.setIndexedHeap(true, 40 * 40);
+	BOOST_CHECK(astar.compute(source, target, 1.));
+
+	// The bidirectional A* and Dijkstra searches find the shortest path, which is recorded in
+	// the previous vertices
+	dwl::solver::AStar solver;
+	solver.setAdjacencyModel(adjacency);
+	BOOST_CHECK(solver.computeBidirectional(source, target, 1.));
+	BOOST_CHECK_CLOSE(solver.getMinimumCost(), astar.getMinimumCost(), 1e-9);
+	std::list<dwl::Vertex> path = solver.getShortestPath(source, target);
+	BOOST_CHECK_EQUAL(path.front(), source);
+	BOOST_CHECK_EQUAL(path.back(), target);
+	BOOST_CHECK_CLOSE(pathCost(*adjacency, path), astar.getMinimumCost(), 1e-9);
+
+	dwl::solver::Dijkstrap dijkstra;
+	dijkstra.setAdjacencyModel(new GridAdjacency(*adjacency));
+	BOOST_CHECK(dijkstra.computeBidirectional(source, target, 1.));
+	BOOST_CHECK_CLOSE(dijkstra.getMinimumCost(), astar.getMinimumCost(), 1e-9);
+	path = dijkstra.getShortestPath(source, target);
+	BOOST_CHECK_CLOSE(pathCost(*adjacency, path), astar.getMinimumCost(), 1e-9);
+}
+
+
+// Grid with the precomputed adjacency map of every vertex
+class GridMapAdjacency : public GridAdjacency
+{
+	public:
+		GridMapAdjacency(const GridAdjacency& adjacency) : GridAdjacency(adjacency) {}
+
+		void computeAdjacencyMap(dwl::AdjacencyMap& adjacency_map,
+								 dwl::Vertex source,
+								 dwl::Vertex target) {
+			for (dwl::Vertex v = 0; v < size_ * size_; v++)
+				getSuccessors(adjacency_map[v], v);
+		}
+};
+
+
+BOOST_AUTO_TEST_CASE(quantized_dijkstra) // specify a test case for the radix-heap Dijkstra
+{
+	GridAdjacency adjacency(40);
+	for (unsigned int y = 0; y < 35; y++)
+		adjacency.cost_[20 * 40 + y] = 30.;
+	dwl::Vertex source = 5 * 40 + 5, target = 35 * 40 + 5;
+
+	dwl::solver::Dijkstrap dijkstra;
+	dijkstra.setAdjacencyModel(new GridMapAdjacency(adjacency));
+	dijkstra.setIndexedHeap(true, 40 * 40);
+	BOOST_CHECK(dijkstra.compute(source, target, 1.));
+	double cost = dijkstra.getMinimumCost();
+
+	// The integer weights are multiples of the quantum, so the search is exact
+	dwl::solver::Dijkstrap quantized;
+	quantized.setAdjacencyModel(new GridMapAdjacency(adjacency));
+	quantized.setCostQuantum(1.);
+	BOOST_CHECK(quantized.compute(source, target, 1.));
+	BOOST_CHECK_CLOSE(quantized.getMinimumCost(), cost, 1e-9);
+	std::list<dwl::Vertex> path = quantized.getShortestPath(source, target);
+	BOOST_CHECK_EQUAL(path.front(), source);
+	BOOST_CHECK_EQUAL(path.back(), target);
+	BOOST_CHECK_CLOSE(pathCost(adjacency, path), cost, 1e-9);
+
+	// A coarser quantum is within a quantum of the minimum cost
+	quantized.setCostQuantum(4.);
+	BOOST_CHECK(quantized.compute(source, target, 1.));
+	BOOST_CHECK(quantized.getMinimumCost() >= cost - 1e-9);
+	BOOST_CHECK(quantized.getMinimumCost() <= cost + 4.);
+	path = quantized.getShortestPath(source, target);
+	BOOST_CHECK_CLOSE(pathCost(adjacency, path), quantized.getMinimumCost(), 1e-9);
+}
+
+
+BOOST_AUTO_TEST_CASE(hash_distributed_search) // specify a test case for the HDA* search
+{
+	GridAdjacency* adjacency = new GridAdjacency(80);
+	for (unsigned int x = 20; x < 60; x++) {
+		for (unsigned int y = 0; y < 70; y++)
+			adjacency->cost_[x * 80 + y] = 4.; // rough terrain with a flat corridor
+	}
+	dwl::Vertex source = 5 * 80 + 10, target = 75 * 80 + 15;
+
+	dwl::solver::AStar astar;
+	astar.setAdjacencyModel(adjacency);
+	astar.setIndexedHeap(true, 80 * 80);
+	BOOST_CHECK(astar.compute(source, target, 1.));
+	double cost = astar.getMinimumCost();
+
+	// The parallel search finds a path with the minimum cost
+	GridAdjacency* hda_adjacency = new GridAdjacency(*adjacency);
+	dwl::solver::HashDistributedAStar hda(4);
+	hda.setAdjacencyModel(hda_adjacency);
+	BOOST_CHECK(hda.compute(source, target, 5.));
+	BOOST_CHECK_CLOSE(hda.getMinimumCost(), cost, 1e-9);
+
+	std::list<dwl::Vertex> path = hda.getShortestPath(source, target);
+	BOOST_CHECK_EQUAL(path.front(), source);
+	BOOST_CHECK_EQUAL(path.back(), target);
+	BOOST_CHECK_CLOSE(pathCost(*adjacency, path), cost, 1e-9);
+
+	// The inflated search is bounded by the inflation times the minimum cost
+	hda.setInflation(2.);
+	hda.setIndexedHeap(true, 80 * 80);
+	BOOST_CHECK(hda.compute(source, target, 5.));
+	BOOST_CHECK(hda.getMinimumCost() <= 2. * cost + 1e-9);
+	path = hda.getShortestPath(source, target);
+	BOOST_CHECK_EQUAL(path.front(), source);
+	BOOST_CHECK_EQUAL(path.back(), target);
+	BOOST_CHECK_CLOSE(pathCost(*adjacency, path), hda.getMinimumCost(), 1e-9);
+}
@@ -0,0 +1,92 @@
+#include <dwl/solver/ActiveSetQP.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 1e-6;
+
+BOOST_AUTO_TEST_CASE(active_set_qp) // specify a test case for the active-set QP solver
+{
+	// min (x0 - 1)^2 + (x1 - 2)^2 s.t. -x0 - x1 >= -2, x >= 0
+	Eigen::MatrixXd hessian = 2. * Eigen::MatrixXd::Identity(2,2);
+	Eigen::VectorXd gradient(2);
+	gradient << -2., -4.;
+	Eigen::MatrixXd constraint_mat(3,2);
+	constraint_mat << -1., -1.,
+					   1., 0.,
+					   0., 1.;
+	Eigen::VectorXd lower_constraint(3);
+	lower_constraint << -2., 0., 0.;
+
+	dwl::solver::ActiveSetQP solver;
+	BOOST_CHECK(solver.compute(hessian, gradient,
+							   constraint_mat, lower_constraint,
+							   Eigen::VectorXd::Zero(2)));
+	Eigen::VectorXd solution = solver.getOptimalSolution();
+	BOOST_CHECK_SMALL(solution(0) - 0.5, epsilon);
+	BOOST_CHECK_SMALL(solution(1) - 1.5, epsilon);
+	BOOST_CHECK_EQUAL(solver.getActiveSet().size(), 1);
+
+	// Solving a problem where the optimal point is in a vertex, i.e. min (x0 - 3)^2 + x1^2
+	gradient << -6., 2.;
+	BOOST_CHECK(solver.compute(hessian, gradient,
+							   constraint_mat, lower_constraint,
+							   Eigen::VectorXd::Zero(2)));
+	solution = solver.getOptimalSolution();
+	BOOST_CHECK_SMALL(solution(0) - 2., epsilon);
+	BOOST_CHECK_SMALL(solution(1), epsilon);
+
+	// The starting point has to be feasible
+	BOOST_CHECK(!solver.compute(hessian, gradient,
+								constraint_mat, lower_constraint,
+								-Eigen::VectorXd::Ones(2)));
+}
+
+
+BOOST_AUTO_TEST_CASE(active_set_qp_friction_pyramid) // specify a test case for the force distribution
+{
+	// Distributing a wrench with a lateral component to four contacts, i.e. min |M f - w|^2
+	// subject to friction pyramids, where the lateral force cannot be delivered
+	double mu = 0.5 / sqrt(2.);
+	unsigned int num_contacts = 4;
+	Eigen::MatrixXd force_map = Eigen::MatrixXd::Zero(3, 3 * num_contacts);
+	Eigen::MatrixXd constraint_mat = Eigen::MatrixXd::Zero(5 * num_contacts, 3 * num_contacts);
+	for (unsigned int i = 0; i < num_contacts; i++) {
+		force_map.block<3,3>(0, 3 * i).setIdentity();
+		constraint_mat.block<5,3>(5 * i, 3 * i) << 0., 0., 1.,
+												  -1., 0., mu,
+												   1., 0., mu,
+												   0., -1., mu,
+												   0., 1., mu;
+	}
+	Eigen::VectorXd wrench(3);
+	wrench << 300., 0., 400.;
+	Eigen::MatrixXd hessian = force_map.transpose() * force_map +
+			1e-6 * Eigen::MatrixXd::Identity(3 * num_contacts, 3 * num_contacts);
+	Eigen::VectorXd gradient = -force_map.transpose() * wrench;
+	Eigen::VectorXd lower_constraint = Eigen::VectorXd::Zero(5 * num_contacts);
+
+	dwl::solver::ActiveSetQP solver;
+	BOOST_CHECK(solver.compute(hessian, gradient,
+							   constraint_mat, lower_constraint,
+							   Eigen::VectorXd::Zero(3 * num_contacts)));
+	Eigen::VectorXd forces = solver.getOptimalSolution();
+	BOOST_CHECK(((constraint_mat * forces).array() >= -epsilon).all());
+	for (unsigned int i = 0; i < num_contacts; i++)
+		BOOST_CHECK(forces(3 * i) <= mu * forces(3 * i + 2) + epsilon);
+	unsigned int cold_iterations = solver.getNumberOfIterations();
+
+	// Warm-starting a slightly different wrench from the last solution and working set
+	wrench << 290., 0., 410.;
+	gradient = -force_map.transpose() * wrench;
+	BOOST_CHECK(solver.compute(hessian, gradient,
+							   constraint_mat, lower_constraint,
+							   solver.getOptimalSolution()));
+	BOOST_CHECK(solver.getNumberOfIterations() < cold_iterations);
+	forces = solver.getOptimalSolution();
+	BOOST_CHECK(((constraint_mat * forces).array() >= -epsilon).all());
+}
@@ -0,0 +1,65 @@
+#include <dwl/utils/Algebra.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 1e-9;
+
+BOOST_AUTO_TEST_CASE(damped_least_squares) // specify a test case for the SVD-free solves
+{
+	// Wide and tall matrices with full rank
+	Eigen::MatrixXd wide_mat = Eigen::MatrixXd::Random(3,7);
+	Eigen::MatrixXd tall_mat = Eigen::MatrixXd::Random(7,3);
+	Eigen::VectorXd wide_vec = Eigen::VectorXd::Random(3);
+	Eigen::VectorXd tall_vec = Eigen::VectorXd::Random(7);
+
+	Eigen::VectorXd wide_sol, tall_sol;
+	BOOST_CHECK(dwl::math::dampedLeastSquares(wide_sol, wide_mat, wide_vec));
+	BOOST_CHECK(dwl::math::dampedLeastSquares(tall_sol, tall_mat, tall_vec));
+	BOOST_CHECK((wide_sol - dwl::math::pseudoInverse(wide_mat) * wide_vec).norm() < epsilon);
+	BOOST_CHECK((tall_sol - dwl::math::pseudoInverse(tall_mat) * tall_vec).norm() < epsilon);
+
+	Eigen::MatrixXd wide_inv, tall_inv;
+	BOOST_CHECK(dwl::math::dampedPseudoInverse(wide_inv, wide_mat));
+	BOOST_CHECK(dwl::math::dampedPseudoInverse(tall_inv, tall_mat));
+	BOOST_CHECK((wide_inv - dwl::math::pseudoInverse(wide_mat)).norm() < epsilon);
+	BOOST_CHECK((tall_inv - dwl::math::pseudoInverse(tall_mat)).norm() < epsilon);
+
+	// Fixed-size expressions, e.g. a transposed leg Jacobian
+	Eigen::Matrix3d leg_jac = Eigen::Matrix3d::Random();
+	Eigen::Vector3d effort = Eigen::Vector3d::Random();
+	Eigen::Vector3d force;
+	BOOST_CHECK(dwl::math::dampedLeastSquares(force, leg_jac.transpose(), effort));
+	BOOST_CHECK((leg_jac.transpose() * force - effort).norm() < epsilon);
+
+	// The damped solution is the one of the regularized normal equations
+	double damping = 0.1;
+	BOOST_CHECK(dwl::math::dampedLeastSquares(tall_sol, tall_mat, tall_vec, damping));
+	Eigen::MatrixXd normal_mat = tall_mat.transpose() * tall_mat +
+			damping * damping * Eigen::MatrixXd::Identity(3,3);
+	BOOST_CHECK((normal_mat * tall_sol - tall_mat.transpose() * tall_vec).norm() < epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(damped_least_squares_rank_deficient) // specify a test case for the SVD fallback
+{
+	// Singular leg Jacobian, i.e. with repeated rows
+	Eigen::MatrixXd jac(3,4);
+	jac << 1., 2., 3., 4.,
+		   1., 2., 3., 4.,
+		   0., 1., 0., 1.;
+	Eigen::VectorXd vec(3);
+	vec << 1., 1., 2.;
+
+	Eigen::VectorXd sol;
+	BOOST_CHECK(!dwl::math::dampedLeastSquares(sol, jac, vec));
+	BOOST_CHECK((sol - dwl::math::pseudoInverse(jac) * vec).norm() < 1e-6);
+
+	Eigen::MatrixXd inv;
+	BOOST_CHECK(!dwl::math::dampedPseudoInverse(inv, jac));
+	BOOST_CHECK((inv - dwl::math::pseudoInverse(jac)).norm() < 1e-6);
+}
@@ -0,0 +1,73 @@
+#include <dwl/model/AutoDiffOptimizationModel.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+/**
+ * @brief The HS071 problem described with templated cost and constraint
+ * functions, i.e. min x1*x4*(x1+x2+x3)+x3 s.t. x1*x2*x3*x4 >= 25 and
+ * x1^2+x2^2+x3^2+x4^2 = 40
+ */
+class HS071AutoDiff : public dwl::model::AutoDiffOptimizationModel<HS071AutoDiff>
+{
+	public:
+		HS071AutoDiff()
+		{
+			state_dimension_ = 4;
+			constraint_dimension_ = 2;
+			init();
+		}
+
+		template<typename Scalar>
+		Scalar computeCost(const Eigen::Matrix<Scalar,Eigen::Dynamic,1>& x)
+		{
+			return x(0) * x(3) * (x(0) + x(1) + x(2)) + x(2);
+		}
+
+		template<typename Scalar>
+		void computeConstraints(Eigen::Matrix<Scalar,Eigen::Dynamic,1>& g,
+								const Eigen::Matrix<Scalar,Eigen::Dynamic,1>& x)
+		{
+			g.resize(2);
+			g(0) = x(0) * x(1) * x(2) * x(3);
+			g(1) = x(0) * x(0) + x(1) * x(1) + x(2) * x(2) + x(3) * x(3);
+		}
+};
+
+
+// Tolerance
+double epsilon = 0.00001;
+
+BOOST_AUTO_TEST_CASE(exact_derivatives) // specify a test case for AD derivatives
+{
+	HS071AutoDiff model;
+	BOOST_CHECK_EQUAL(model.getNumberOfNonzeroJacobian(), 8);
+	BOOST_CHECK_EQUAL(model.getNumberOfNonzeroHessian(), 10);
+
+	double x[4] = {1., 5., 5., 1.};
+	double lambda[2] = {1., 1.};
+
+	// Checking the cost gradient
+	double gradient[4];
+	double expected_gradient[4] = {12., 1., 2., 11.};
+	model.evaluateCostGradient(gradient, 4, x, 4);
+	for (unsigned int i = 0; i < 4; i++)
+		BOOST_CHECK_SMALL(gradient[i] - expected_gradient[i], epsilon);
+
+	// Checking the constraint Jacobian
+	double jacobian[8];
+	double expected_jacobian[8] = {25., 5., 5., 25., 2., 10., 10., 2.};
+	model.evaluateConstraintJacobian(jacobian, 8, NULL, 8, NULL, 8, x, 4, false);
+	for (unsigned int i = 0; i < 8; i++)
+		BOOST_CHECK_SMALL(jacobian[i] - expected_jacobian[i], epsilon);
+
+	// Checking the Lagrangian Hessian (lower-left triangle)
+	double hessian[10];
+	double expected_hessian[10] = {4., 6., 2., 6., 1., 2., 37., 6., 6., 2.};
+	model.evaluateLagrangianHessian(hessian, 10, NULL, 10, NULL, 10,
+									1., lambda, 2, x, 4, false);
+	for (unsigned int i = 0; i < 10; i++)
+		BOOST_CHECK_SMALL(hessian[i] - expected_hessian[i], epsilon);
+}
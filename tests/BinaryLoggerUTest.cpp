@@ -0,0 +1,94 @@
+#include <dwl/utils/BinaryLogger.h>
+#include <cmath>
+#include <cstdio>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+static void logRows(bool compression,
+					const std::string& filename,
+					unsigned int num_rows)
+{
+	dwl::utils::BinaryLogger logger;
+	logger.addChannel("time");
+	logger.addChannel("position");
+	logger.addChannel("constant");
+	logger.setBufferSize(num_rows, 64);
+	logger.setCompression(compression);
+	BOOST_CHECK(logger.open(filename));
+	BOOST_CHECK_EQUAL(logger.addChannel("late"), 3);
+
+	for (unsigned int k = 0; k < num_rows; k++) {
+		double row[3] = {1e-3 * k, sin(1e-3 * k), 0.5};
+		BOOST_CHECK(logger.append(row));
+	}
+	logger.close();
+	BOOST_CHECK_EQUAL(logger.getNumberOfDroppedRows(), 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(binary_logger) // specify a test case for writing and reading binary logs
+{
+	const unsigned int num_rows = 1000;
+	std::string raw_file = "dwl_raw_log.bin", compressed_file = "dwl_compressed_log.bin";
+	logRows(false, raw_file, num_rows);
+	logRows(true, compressed_file, num_rows);
+
+	dwl::utils::BinaryLogReader raw_reader, compressed_reader;
+	BOOST_CHECK(raw_reader.open(raw_file));
+	BOOST_CHECK(compressed_reader.open(compressed_file));
+	BOOST_CHECK_EQUAL(raw_reader.getChannels().size(), 3);
+	BOOST_CHECK_EQUAL(compressed_reader.getChannelIndex("position"), 1);
+	BOOST_CHECK_EQUAL(compressed_reader.getChannelIndex("late"), 3);
+	BOOST_CHECK_EQUAL(raw_reader.getNumberOfRows(), num_rows);
+	BOOST_CHECK_EQUAL(compressed_reader.getNumberOfRows(), num_rows);
+	BOOST_CHECK(raw_reader.getRawBlock(0) != NULL);
+	BOOST_CHECK(compressed_reader.getRawBlock(0) == NULL);
+
+	// The decoded values have to be identical to the logged ones
+	std::vector<double> raw_values, compressed_values;
+	for (unsigned int i = 0; i < 3; i++) {
+		raw_reader.readChannel(raw_values, i);
+		compressed_reader.readChannel(compressed_values, i);
+		BOOST_REQUIRE_EQUAL(raw_values.size(), num_rows);
+		BOOST_REQUIRE_EQUAL(compressed_values.size(), num_rows);
+		for (unsigned int k = 0; k < num_rows; k++)
+			BOOST_CHECK_EQUAL(raw_values[k], compressed_values[k]);
+	}
+	BOOST_CHECK_EQUAL(compressed_values[num_rows - 1], 0.5);
+	compressed_reader.readChannel(compressed_values, 1);
+	BOOST_CHECK_EQUAL(compressed_values[500], sin(0.5));
+
+	raw_reader.close();
+	compressed_reader.close();
+	remove(raw_file.c_str());
+	remove(compressed_file.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(binary_logger_full_buffer) // specify a test case for dropping rows
+{
+	// The rows are dropped when the ring buffer is full, instead of blocking the producer
+	dwl::utils::BinaryLogger logger;
+	logger.addChannel("value");
+	logger.setBufferSize(8, 8);
+	std::string filename = "dwl_dropped_log.bin";
+	BOOST_CHECK(logger.open(filename));
+	unsigned int num_appended = 0;
+	for (unsigned int k = 0; k < 10000; k++)
+		num_appended += logger.append(std::vector<double>(1, k));
+	logger.close();
+	BOOST_CHECK_EQUAL(num_appended + logger.getNumberOfDroppedRows(), 10000);
+
+	dwl::utils::BinaryLogReader reader;
+	BOOST_CHECK(reader.open(filename));
+	BOOST_CHECK_EQUAL(reader.getNumberOfRows(), num_appended);
+	std::vector<double> values;
+	reader.readChannel(values, 0);
+	for (unsigned int k = 1; k < values.size(); k++)
+		BOOST_CHECK(values[k] > values[k-1]);
+	reader.close();
+	remove(filename.c_str());
+}
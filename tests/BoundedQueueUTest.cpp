@@ -0,0 +1,50 @@
+#include <dwl/utils/BoundedQueue.h>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(bounded_queue) // specify a test case for the queues between the stages
+{
+	dwl::utils::BoundedQueue<unsigned int> queue(2);
+
+	// The consumer gets the values in order, while the producer waits for the free slots
+	std::vector<unsigned int> values;
+	std::thread consumer([&] {
+		unsigned int value;
+		while (queue.pop(value))
+			values.push_back(value);
+	});
+	for (unsigned int i = 0; i < 100; i++) {
+		BOOST_CHECK(queue.push(i));
+		BOOST_CHECK(queue.size() <= 2);
+	}
+	queue.close();
+	consumer.join();
+	BOOST_CHECK_EQUAL(values.size(), 100);
+	for (unsigned int i = 0; i < values.size(); i++)
+		BOOST_CHECK_EQUAL(values[i], i);
+
+	// A closed queue doesn't accept values, but its remaining values are popped
+	queue.reset(2);
+	BOOST_CHECK(queue.push(1));
+	queue.close();
+	BOOST_CHECK(queue.isClosed());
+	BOOST_CHECK(!queue.push(2));
+	unsigned int value;
+	BOOST_CHECK(queue.pop(value));
+	BOOST_CHECK_EQUAL(value, 1);
+	BOOST_CHECK(!queue.pop(value));
+
+	// Closing the queue wakes up a waiting producer
+	queue.reset(1);
+	BOOST_CHECK(queue.push(1));
+	bool pushed = true;
+	std::thread producer([&] { pushed = queue.push(2); });
+	queue.close();
+	producer.join();
+	BOOST_CHECK(!pushed);
+}
@@ -0,0 +1,59 @@
+#include <dwl/locomotion/CentroidalModelPredictiveControl.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+// Standing state of a quadruped with a given CoM height
+dwl::ReducedBodyState buildStandingState(double height)
+{
+	dwl::ReducedBodyState state;
+	state.com_pos << 0., 0., height;
+	state.foot_pos["lf_foot"] = Eigen::Vector3d(0.35, 0.3, -height);
+	state.foot_pos["rf_foot"] = Eigen::Vector3d(0.35, -0.3, -height);
+	state.foot_pos["lh_foot"] = Eigen::Vector3d(-0.35, 0.3, -height);
+	state.foot_pos["rh_foot"] = Eigen::Vector3d(-0.35, -0.3, -height);
+	return state;
+}
+
+
+BOOST_AUTO_TEST_CASE(centroidal_mpc) // specify a test case for the centroidal MPC
+{
+	dwl::rbd::BodySelector feet = {"lf_foot", "rf_foot", "lh_foot", "rh_foot"};
+	double mass = 80.;
+	Eigen::Matrix3d inertia = Eigen::Vector3d(1.5, 6., 6.5).asDiagonal();
+	dwl::solver::RiccatiInteriorPoint solver;
+	dwl::locomotion::CentroidalModelPredictiveControl mpc;
+	BOOST_CHECK(mpc.reset(&solver, feet, mass, inertia, 10, 0.03));
+
+	// The standing forces hold the weight of the robot
+	dwl::ReducedBodyState state = buildStandingState(0.55);
+	dwl::ReducedBodyTrajectory reference(1, state);
+	BOOST_CHECK(mpc.compute(state, reference));
+	Eigen::Vector3d total_force = Eigen::Vector3d::Zero();
+	for (unsigned int f = 0; f < feet.size(); f++)
+		total_force += mpc.getContactForces().find(feet[f])->second;
+	BOOST_CHECK_CLOSE(total_force(dwl::rbd::Z), mass * 9.81, 1.);
+	BOOST_CHECK_SMALL(total_force.head<2>().norm(), 1e-3);
+
+	dwl::ReducedBodyTrajectory prediction;
+	mpc.getPredictedTrajectory(prediction);
+	BOOST_CHECK_EQUAL(prediction.size(), 11);
+	BOOST_CHECK_SMALL(prediction.back().com_pos(dwl::rbd::Z) - 0.55, 1e-3);
+
+	// The swing feet of a trot don't have forces, and the stance ones respect the friction
+	dwl::simulation::PreviewSchedule schedule;
+	schedule.setFeet(feet);
+	schedule.addPhase(dwl::simulation::PreviewPhase(dwl::simulation::STANCE, {"lf_foot", "rh_foot"}));
+	schedule.addPhase(dwl::simulation::PreviewPhase(dwl::simulation::STANCE, {"rf_foot", "lh_foot"}));
+	mpc.setContactProperties(0.6, 1000.);
+	mpc.setContactSchedule(schedule, std::vector<double>(2, 0.15));
+	BOOST_CHECK(mpc.compute(state, reference));
+	const dwl::rbd::BodyVector3d& forces = mpc.getContactForces();
+	BOOST_CHECK_SMALL(forces.find("lf_foot")->second.norm(), 1e-9);
+	BOOST_CHECK_SMALL(forces.find("rh_foot")->second.norm(), 1e-9);
+	const Eigen::Vector3d& stance_force = forces.find("rf_foot")->second;
+	BOOST_CHECK(stance_force(dwl::rbd::Z) > 0.);
+	BOOST_CHECK(stance_force.head<2>().norm() <= 0.6 * sqrt(2.) * stance_force(dwl::rbd::Z));
+}
@@ -0,0 +1,55 @@
+#include <dwl/utils/Collocation.h>
+#include <cmath>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 1e-10;
+
+BOOST_AUTO_TEST_CASE(radau_nodes) // specify a test case for the Legendre-Gauss-Radau nodes
+{
+	// The two-node collocation is the Radau IIA method of third order
+	Eigen::VectorXd nodes;
+	dwl::math::computeRadauNodes(nodes, 2);
+	BOOST_CHECK_EQUAL(nodes.size(), 2);
+	BOOST_CHECK_SMALL(nodes(0) + 1. / 3., epsilon);
+	BOOST_CHECK_SMALL(nodes(1) - 1., epsilon);
+
+	// The nodes of the three-node collocation are (4 -/+ sqrt(6)) / 10 in a unit interval
+	dwl::math::computeRadauNodes(nodes, 3);
+	BOOST_CHECK_SMALL((nodes(0) + 1.) / 2. - (4. - sqrt(6.)) / 10., epsilon);
+	BOOST_CHECK_SMALL((nodes(1) + 1.) / 2. - (4. + sqrt(6.)) / 10., epsilon);
+	BOOST_CHECK_SMALL(nodes(2) - 1., epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(radau_differentiation) // specify a test case for the differentiation matrix
+{
+	// The differentiation is exact for the polynomials of degree N, i.e. the support points
+	for (unsigned int num_nodes = 1; num_nodes < 8; num_nodes++) {
+		Eigen::VectorXd nodes;
+		Eigen::MatrixXd diff_mat;
+		dwl::math::computeRadauNodes(nodes, num_nodes);
+		dwl::math::computeRadauDifferentiationMatrix(diff_mat, nodes);
+		BOOST_CHECK_EQUAL(diff_mat.rows(), num_nodes);
+		BOOST_CHECK_EQUAL(diff_mat.cols(), num_nodes + 1);
+
+		Eigen::VectorXd support(num_nodes + 1);
+		support << -1., nodes;
+		for (unsigned int degree = 0; degree <= num_nodes; degree++) {
+			Eigen::VectorXd values(num_nodes + 1);
+			for (unsigned int j = 0; j < num_nodes + 1; j++)
+				values(j) = pow(support(j), degree);
+
+			Eigen::VectorXd derivative = diff_mat * values;
+			for (unsigned int i = 0; i < num_nodes; i++) {
+				double expected = (degree == 0) ? 0. : degree * pow(nodes(i), degree - 1);
+				BOOST_CHECK_SMALL(derivative(i) - expected, 1e-8);
+			}
+		}
+	}
+}
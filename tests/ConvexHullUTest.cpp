@@ -0,0 +1,80 @@
+#include <dwl/utils/ConvexHull.h>
+#include <cstdlib>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(incremental_hull) // specify a test case for the incremental updates
+{
+	// Defining a squared support region with an inner point
+	dwl::math::ConvexHull hull;
+	hull.addPoint("lf", Eigen::Vector3d(1., 1., 0.));
+	hull.addPoint("lh", Eigen::Vector3d(0., 1., 0.));
+	hull.addPoint("rh", Eigen::Vector3d(0., 0., 0.));
+	hull.addPoint("rf", Eigen::Vector3d(1., 0., 0.));
+	hull.addPoint("inner", Eigen::Vector3d(0.5, 0.5, 0.));
+	BOOST_CHECK_EQUAL(hull.getNumberOfPoints(), 5);
+	BOOST_CHECK_EQUAL(hull.getVertexes().size(), 4);
+
+	double margin;
+	BOOST_REQUIRE(hull.computeMargin(margin, Eigen::Vector3d(0.5, 0.3, 0.)));
+	BOOST_CHECK_CLOSE(margin, 0.3, 1e-9);
+	hull.computeMargin(margin, Eigen::Vector3d(1.5, 0.5, 0.));
+	BOOST_CHECK_CLOSE(margin, -0.5, 1e-9);
+
+	// Adding an outer point replaces the edge that it sees
+	hull.addPoint("extra", Eigen::Vector3d(2., 0.5, 0.));
+	BOOST_CHECK_EQUAL(hull.getVertexes().size(), 5);
+	hull.computeMargin(margin, Eigen::Vector3d(1.5, 0.5, 0.));
+	BOOST_CHECK(margin > 0.);
+
+	// Removing the inner point doesn't change the hull, and removing a vertex does
+	hull.removePoint("inner");
+	BOOST_CHECK_EQUAL(hull.getVertexes().size(), 5);
+	hull.removePoint("extra");
+	BOOST_CHECK_EQUAL(hull.getVertexes().size(), 4);
+
+	// Setting a support line, where the margin is the negative distance to it
+	std::map<std::string,Eigen::Vector3d> line;
+	line["lf"] = Eigen::Vector3d(1., 1., 0.);
+	line["rh"] = Eigen::Vector3d(0., 0., 0.);
+	hull.setPoints(line);
+	BOOST_CHECK_EQUAL(hull.getNumberOfPoints(), 2);
+	hull.computeMargin(margin, Eigen::Vector3d(1., 0., 0.));
+	BOOST_CHECK_CLOSE(margin, -sqrt(0.5), 1e-9);
+
+	hull.clear();
+	BOOST_CHECK(!hull.computeMargin(margin, Eigen::Vector3d::Zero()));
+}
+
+
+BOOST_AUTO_TEST_CASE(random_hull) // specify a test case for the incremental and rebuilt hulls
+{
+	// The incremental hull has the margins of the hull built from scratch
+	srand(1);
+	dwl::math::ConvexHull hull;
+	std::map<std::string,Eigen::Vector3d> points;
+	for (unsigned int i = 0; i < 40; i++) {
+		std::stringstream name;
+		name << "point" << (rand() % 20);
+		if (rand() % 4 == 0) {
+			hull.removePoint(name.str());
+			points.erase(name.str());
+		} else {
+			Eigen::Vector3d point(rand() / (double) RAND_MAX, rand() / (double) RAND_MAX, 0.);
+			hull.addPoint(name.str(), point);
+			points[name.str()] = point;
+		}
+
+		dwl::math::ConvexHull rebuilt;
+		rebuilt.setPoints(points);
+		Eigen::Vector3d query(rand() / (double) RAND_MAX, rand() / (double) RAND_MAX, 0.);
+		double margin, rebuilt_margin;
+		BOOST_REQUIRE_EQUAL(hull.computeMargin(margin, query),
+							rebuilt.computeMargin(rebuilt_margin, query));
+		if (!points.empty())
+			BOOST_CHECK_SMALL(margin - rebuilt_margin, 1e-9);
+	}
+}
@@ -0,0 +1,77 @@
+#include <dwl/ocp/CostStack.h>
+#include <dwl/ocp/IntegralControlEnergyCost.h>
+#include <dwl/ocp/EvaluationArena.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+BOOST_AUTO_TEST_CASE(cost_stack) // specify a test case for the composed costs
+{
+	// Two control-energy costs with different weights
+	dwl::WholeBodyState state(2);
+	state.joint_eff << 2., -1.;
+	state.duration = 0.1;
+	dwl::WholeBodyState weights(2);
+	weights.joint_eff << 1., 3.;
+	dwl::ocp::IntegralControlEnergyCost light_cost, heavy_cost;
+	light_cost.setWeights(weights);
+	weights.joint_eff *= 10.;
+	heavy_cost.setWeights(weights);
+
+	// The stack cost is the sum of its costs
+	typedef dwl::ocp::CostStack<dwl::ocp::IntegralControlEnergyCost,
+								dwl::ocp::IntegralControlEnergyCost> ControlCostStack;
+	ControlCostStack stack(light_cost, heavy_cost);
+	double light, heavy, cost;
+	light_cost.compute(light, state);
+	heavy_cost.compute(heavy, state);
+	stack.compute(cost, state);
+	BOOST_CHECK_CLOSE(light, 0.7, 1e-8);
+	BOOST_CHECK_CLOSE(cost, light + heavy, 1e-8);
+
+	// The clone is a single cost for the optimal control problem, and the desired state is
+	// forwarded to the composed costs
+	dwl::ocp::Cost* clone = stack.clone();
+	state.time = 0.5;
+	clone->setDesiredState(state);
+	clone->compute(cost, state);
+	BOOST_CHECK_CLOSE(cost, light + heavy, 1e-8);
+	stack.setDesiredState(state);
+	BOOST_CHECK_EQUAL(stack.get<1>().getDesiredState().time, 0.5);
+	delete clone;
+}
+
+
+BOOST_AUTO_TEST_CASE(evaluation_arena) // specify a test case for the arena of the temporaries
+{
+	dwl::ocp::EvaluationArena arena;
+	const double* data;
+	{
+		// The nested scopes take different temporaries
+		dwl::ocp::EvaluationArena::Scope scope(arena);
+		Eigen::VectorXd& vector = scope.getVector(3);
+		vector << 1., 2., 3.;
+		data = vector.data();
+		{
+			dwl::ocp::EvaluationArena::Scope nested_scope(arena);
+			Eigen::VectorXd& nested_vector = nested_scope.getVector(3);
+			BOOST_CHECK(nested_vector.data() != data);
+		}
+		BOOST_CHECK_EQUAL(arena.getNumberOfTemporaries(), 2);
+	}
+
+	// The temporaries are reused with their memory after the scopes and the reset
+	arena.reset();
+	dwl::ocp::EvaluationArena::Scope scope(arena);
+	Eigen::VectorXd& vector = scope.getVector();
+	BOOST_CHECK_EQUAL(vector.size(), 3);
+	BOOST_CHECK_EQUAL(vector.data(), data);
+	dwl::WholeBodyState& state = scope.getState();
+	state.time = 1.;
+	BOOST_CHECK_EQUAL(arena.getNumberOfTemporaries(), 3);
+
+	// A copied arena (e.g. of a cloned model) doesn't share the temporaries
+	dwl::ocp::EvaluationArena copied_arena(arena);
+	BOOST_CHECK_EQUAL(copied_arena.getNumberOfTemporaries(), 0);
+}
@@ -0,0 +1,109 @@
+#include <dwl/solver/DStarLite.h>
+#include <dwl/solver/AnytimeRepairingAStar.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+// 4-connected grid where the vertex id is (x * size + y), and the edge weight is the cost of
+// the target cell
+class GridAdjacency : public dwl::model::AdjacencyModel
+{
+	public:
+		GridAdjacency(unsigned int size) : size_(size), cost_(size * size, 1.) {
+			name_ = "Grid";
+		}
+
+		void getSuccessors(dwl::EdgeList& successors,
+						   dwl::Vertex vertex) {
+			int x = vertex / size_, y = vertex % size_;
+			int dx[] = {1, -1, 0, 0}, dy[] = {0, 0, 1, -1};
+			for (unsigned int i = 0; i < 4; i++) {
+				int nx = x + dx[i], ny = y + dy[i];
+				if (nx < 0 || ny < 0 || nx >= (int) size_ || ny >= (int) size_)
+					continue;
+				dwl::Vertex neighbor = nx * size_ + ny;
+				successors.push_back(dwl::Edge(neighbor, cost_[neighbor]));
+			}
+		}
+
+		double heuristicCost(dwl::Vertex source, dwl::Vertex target) {
+			return 0.;
+		}
+
+		unsigned int size_;
+		std::vector<double> cost_;
+};
+
+
+// Computes the cost of the shortest path with a brute-force relaxation
+double shortestCost(GridAdjacency& adjacency, dwl::Vertex source, dwl::Vertex target)
+{
+	unsigned int num_vertices = adjacency.size_ * adjacency.size_;
+	std::vector<double> cost(num_vertices, std::numeric_limits<double>::infinity());
+	cost[source] = 0.;
+	for (unsigned int k = 0; k < num_vertices; k++) {
+		for (dwl::Vertex v = 0; v < num_vertices; v++) {
+			dwl::EdgeList successors;
+			adjacency.getSuccessors(successors, v);
+			for (dwl::EdgeList::iterator it = successors.begin(); it != successors.end(); it++)
+				cost[it->target] = std::min(cost[it->target], cost[v] + it->weight);
+		}
+	}
+	return cost[target];
+}
+
+
+BOOST_AUTO_TEST_CASE(dstar_lite) // specify a test case for the incremental D* Lite replanning
+{
+	GridAdjacency* adjacency = new GridAdjacency(10);
+	for (unsigned int y = 0; y < 8; y++)
+		adjacency->cost_[5 * 10 + y] = 20.; // a wall with a gap
+
+	dwl::solver::DStarLite solver;
+	solver.setAdjacencyModel(adjacency);
+	dwl::Vertex source = 0, target = 9 * 10 + 0;
+	BOOST_CHECK(solver.compute(source, target, 1.));
+	BOOST_CHECK_CLOSE(solver.getMinimumCost(), shortestCost(*adjacency, source, target), 1e-9);
+
+	std::list<dwl::Vertex> path = solver.getShortestPath(source, target);
+	BOOST_CHECK_EQUAL(path.front(), source);
+	BOOST_CHECK_EQUAL(path.back(), target);
+
+	// Moving the source along the path and repairing the search tree
+	std::list<dwl::Vertex>::iterator path_it = path.begin();
+	std::advance(path_it, 3);
+	source = *path_it;
+	BOOST_CHECK(solver.compute(source, target, 1.));
+	BOOST_CHECK_CLOSE(solver.getMinimumCost(), shortestCost(*adjacency, source, target), 1e-9);
+	path = solver.getShortestPath(source, target);
+	BOOST_CHECK_EQUAL(path.front(), source);
+}
+
+
+BOOST_AUTO_TEST_CASE(ara_star_solution_callback) // specify a test case for the streamed solutions
+{
+	GridAdjacency* adjacency = new GridAdjacency(10);
+	for (unsigned int y = 0; y < 8; y++)
+		adjacency->cost_[5 * 10 + y] = 20.;
+
+	// Recording every improved solution
+	std::vector<double> costs;
+	std::list<dwl::Vertex> last_path;
+	dwl::solver::AnytimeRepairingAStar solver;
+	solver.setAdjacencyModel(adjacency);
+	solver.setSolutionCallback([&](const std::list<dwl::Vertex>& path, double cost) {
+		costs.push_back(cost);
+		last_path = path;
+	});
+
+	dwl::Vertex source = 0, target = 9 * 10 + 0;
+	BOOST_CHECK(solver.compute(source, target, 1.));
+	BOOST_REQUIRE(!costs.empty());
+	for (unsigned int i = 1; i < costs.size(); i++)
+		BOOST_CHECK(costs[i] <= costs[i - 1]);
+	BOOST_CHECK_EQUAL(costs.back(), solver.getMinimumCost());
+	BOOST_CHECK_EQUAL(last_path.front(), source);
+	BOOST_CHECK_EQUAL(last_path.back(), target);
+}
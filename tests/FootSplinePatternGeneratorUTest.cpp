@@ -0,0 +1,78 @@
+#include <dwl/simulation/FootSplinePatternGenerator.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(multi_foot_swing) // specify a test case for the multi-foot swing generator
+{
+	// Defining the swing of two feet, where one of them steps down
+	dwl::rbd::BodyVector3d initial_pos, target_pos;
+	initial_pos["lf_foot"] = Eigen::Vector3d(0.35, 0.3, -0.55);
+	initial_pos["rh_foot"] = Eigen::Vector3d(-0.35, -0.3, -0.55);
+	initial_pos["lh_foot"] = Eigen::Vector3d(-0.35, 0.3, -0.55);
+	target_pos["lf_foot"] = Eigen::Vector3d(0.5, 0.32, -0.5);
+	target_pos["rh_foot"] = Eigen::Vector3d(-0.2, -0.28, -0.62);
+	dwl::simulation::StepParameters params(0.4, 0.1, 0.01);
+
+	dwl::simulation::MultiFootSplinePatternGenerator multi_generator;
+	multi_generator.setParameters(0.2, initial_pos, target_pos, params);
+	BOOST_CHECK_EQUAL(multi_generator.getNumberOfFeet(), 2);
+
+	std::vector<dwl::simulation::FootSplinePatternGenerator> generators(2);
+	const std::vector<std::string>& feet = multi_generator.getSwingFeet();
+	for (unsigned int i = 0; i < feet.size(); i++)
+		generators[i].setParameters(0.2, initial_pos[feet[i]], target_pos[feet[i]], params);
+
+	// Comparing the trajectories of every foot with the ones of the single-foot generator
+	Eigen::Matrix3Xd feet_pos, feet_vel, feet_acc;
+	Eigen::Vector3d foot_pos, foot_vel, foot_acc;
+	for (double time = 0.2; time < 0.7; time += 0.01) {
+		bool in_swing = multi_generator.generateTrajectory(feet_pos, feet_vel, feet_acc, time);
+		for (unsigned int i = 0; i < feet.size(); i++) {
+			BOOST_CHECK_EQUAL(in_swing,
+							  generators[i].generateTrajectory(foot_pos, foot_vel, foot_acc, time));
+			BOOST_CHECK(feet_pos.col(i).isApprox(foot_pos, 1e-9));
+			BOOST_CHECK((feet_vel.col(i) - foot_vel).norm() < 1e-9);
+			BOOST_CHECK((feet_acc.col(i) - foot_acc).norm() < 1e-7);
+		}
+	}
+	BOOST_CHECK(!multi_generator.generateTrajectory(feet_pos, feet_vel, feet_acc, 0.1));
+}
+
+
+BOOST_AUTO_TEST_CASE(swing_bounds) // specify a test case for the analytic swing bounds
+{
+	dwl::rbd::BodyVector3d initial_pos, target_pos;
+	initial_pos["lf_foot"] = Eigen::Vector3d(0.35, 0.3, -0.55);
+	initial_pos["rh_foot"] = Eigen::Vector3d(-0.35, -0.3, -0.55);
+	target_pos["lf_foot"] = Eigen::Vector3d(0.5, 0.32, -0.5);
+	target_pos["rh_foot"] = Eigen::Vector3d(-0.2, -0.28, -0.62);
+	dwl::simulation::StepParameters params(0.4, 0.1, 0.01);
+
+	dwl::simulation::MultiFootSplinePatternGenerator generator;
+	generator.setParameters(0., initial_pos, target_pos, params);
+	Eigen::Matrix3Xd lower_pos, upper_pos;
+	Eigen::VectorXd min_reach, max_reach;
+	generator.computePositionBounds(lower_pos, upper_pos);
+	generator.computeReachBounds(min_reach, max_reach, Eigen::Matrix3Xd::Zero(3, 2));
+
+	// The sampled trajectories have to be inside the bounds, and the position bounds are
+	// reached
+	Eigen::Matrix3Xd feet_pos, feet_vel, feet_acc;
+	Eigen::Matrix3Xd sampled_lower = Eigen::Matrix3Xd::Constant(3, 2, 1e9);
+	Eigen::Matrix3Xd sampled_upper = Eigen::Matrix3Xd::Constant(3, 2, -1e9);
+	for (double time = 0.; time <= 0.4 + 1e-9; time += 0.001) {
+		generator.generateTrajectory(feet_pos, feet_vel, feet_acc, time);
+		sampled_lower = sampled_lower.cwiseMin(feet_pos);
+		sampled_upper = sampled_upper.cwiseMax(feet_pos);
+		for (unsigned int i = 0; i < 2; i++) {
+			BOOST_CHECK(feet_pos.col(i).norm() >= min_reach(i) - 1e-9);
+			BOOST_CHECK(feet_pos.col(i).norm() <= max_reach(i) + 1e-9);
+		}
+	}
+	BOOST_CHECK((sampled_lower - lower_pos).norm() < 1e-6);
+	BOOST_CHECK((sampled_upper - upper_pos).norm() < 1e-6);
+	BOOST_CHECK(upper_pos(dwl::rbd::Z,0) > -0.5);
+}
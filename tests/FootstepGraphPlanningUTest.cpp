@@ -0,0 +1,199 @@
+#include <dwl/locomotion/FootstepGraphPlanning.h>
+#include <dwl/solver/AStar.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+// Flat terrain with a range of costs, and a rough band across the body path
+void buildTerrain(dwl::environment::TerrainMap& terrain)
+{
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (int i = -20; i < 40; i++) {
+		for (int j = -20; j < 20; j++) {
+			double cost = 1. + 0.1 * (((i * 7 + j * 3) % 5 + 5) % 5);
+			if (i >= 18 && i < 21)
+				cost = 20.;
+			dwl::Key key(32768 + i, 32768 + j, 32768);
+			terrain_data.data.push_back(dwl::TerrainCell(key, cost, 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+}
+
+
+// Body path along the x-axis at the nominal height
+std::vector<dwl::Pose> buildBodyPath(double initial_x,
+									 unsigned int num_poses)
+{
+	std::vector<dwl::Pose> body_path(num_poses);
+	for (unsigned int k = 0; k < num_poses; k++) {
+		body_path[k].position << initial_x + 0.05 * k, 0., 0.55;
+		body_path[k].orientation = Eigen::Quaterniond::Identity();
+	}
+	return body_path;
+}
+
+
+BOOST_AUTO_TEST_CASE(footstep_graph_planning) // specify a test case for the footstep graph
+{
+	dwl::robot::Robot robot;
+	robot.read(DWL_SOURCE_DIR"/config/hyq_planning.yaml");
+	dwl::environment::TerrainMap terrain;
+	buildTerrain(terrain);
+
+	dwl::locomotion::FootstepGraphPlanning planning;
+	planning.reset(&robot, &terrain);
+	planning.reset(new dwl::solver::AStar());
+
+	// The contacts follow the pattern of locomotion, and avoid the rough band
+	std::vector<dwl::Pose> body_path = buildBodyPath(0., 9);
+	std::vector<dwl::Contact> contacts;
+	BOOST_CHECK(planning.computeContactSequence(contacts, body_path));
+	BOOST_CHECK_EQUAL(contacts.size(), 8);
+	BOOST_CHECK_EQUAL(planning.getNumberOfReusedStages(), 0);
+	dwl::PatternOfLocomotionMap pattern = robot.getPatternOfLocomotion();
+	unsigned int foot = 0;
+	for (unsigned int k = 0; k < contacts.size(); k++) {
+		BOOST_CHECK_EQUAL(contacts[k].end_effector, foot);
+		dwl::Weight cost;
+		BOOST_CHECK(terrain.getTerrainCost(cost, (Eigen::Vector2d) contacts[k].position.head<2>()));
+		BOOST_CHECK(cost < 20.);
+		foot = pattern[foot];
+	}
+
+	// The same body path reuses the stages and the plan
+	std::vector<dwl::Contact> replanned_contacts;
+	BOOST_CHECK(planning.computeContactSequence(replanned_contacts, body_path));
+	BOOST_CHECK(planning.isReusedPlan());
+	BOOST_CHECK_EQUAL(planning.getNumberOfReusedStages(), 8);
+
+	// After the first footstep, the remaining plan is reused without searching
+	std::vector<dwl::Contact> current_contacts(1, contacts[0]);
+	robot.setCurrentContacts(current_contacts);
+	planning.setSwingFoot(pattern[0]);
+	std::vector<dwl::Pose> remaining_path(body_path.begin() + 1, body_path.end());
+	BOOST_CHECK(planning.computeContactSequence(replanned_contacts, remaining_path));
+	BOOST_CHECK(planning.isReusedPlan());
+	BOOST_CHECK_EQUAL(replanned_contacts.size(), 7);
+	for (unsigned int k = 0; k < replanned_contacts.size(); k++)
+		BOOST_CHECK(replanned_contacts[k].position == contacts[k + 1].position);
+}
+
+
+BOOST_AUTO_TEST_CASE(footstep_graph_replanning) // specify a test case for the incremental replans
+{
+	dwl::robot::Robot robot;
+	robot.read(DWL_SOURCE_DIR"/config/hyq_planning.yaml");
+	dwl::environment::TerrainMap terrain;
+	buildTerrain(terrain);
+
+	dwl::locomotion::FootstepGraphPlanning planning;
+	planning.reset(&robot, &terrain);
+	planning.reset(new dwl::solver::AStar());
+
+	// The depth of the search is the contact horizon
+	std::vector<dwl::Pose> body_path = buildBodyPath(0., 9);
+	std::vector<dwl::Contact> contacts;
+	planning.setContactHorizon(4);
+	BOOST_CHECK(planning.computeContactSequence(contacts, body_path));
+	BOOST_CHECK_EQUAL(contacts.size(), 4);
+
+	// A longer horizon reuses the scored stages, but it searches again
+	planning.setContactHorizon(0);
+	BOOST_CHECK(planning.computeContactSequence(contacts, body_path));
+	BOOST_CHECK_EQUAL(contacts.size(), 8);
+	BOOST_CHECK_EQUAL(planning.getNumberOfReusedStages(), 4);
+	BOOST_CHECK(!planning.isReusedPlan());
+
+	// A terrain change under the planned foothold rescores its stages, and the new plan
+	// avoids it
+	dwl::Key key;
+	terrain.getTerrainSpaceModel().coordToKeyChecked(key, contacts[5].position);
+	terrain.addCellToTerrainMap(dwl::TerrainCell(key, 50., 0.04, 0.));
+	std::vector<dwl::Contact> replanned_contacts;
+	BOOST_CHECK(planning.computeContactSequence(replanned_contacts, body_path));
+	BOOST_CHECK(!planning.isReusedPlan());
+	BOOST_CHECK(planning.getNumberOfReusedStages() < 8);
+	BOOST_CHECK_EQUAL(replanned_contacts.size(), 8);
+	BOOST_CHECK(replanned_contacts[5].position.head<2>() != contacts[5].position.head<2>());
+}
+
+
+BOOST_AUTO_TEST_CASE(foothold_cache) // specify a test case for the foothold cache
+{
+	dwl::robot::Robot robot;
+	robot.read(DWL_SOURCE_DIR"/config/hyq_planning.yaml");
+	dwl::environment::TerrainMap terrain;
+	buildTerrain(terrain);
+
+	dwl::locomotion::FootstepGraphPlanning planning;
+	planning.reset(&robot, &terrain);
+
+	// The second scoring of the same pose hits all the cells in the cache
+	std::vector<dwl::Pose> body_path = buildBodyPath(0., 1);
+	Eigen::Vector3d action(0.05, 0., 0.);
+	dwl::locomotion::FootholdCandidateMap candidates;
+	planning.scoreFootholdCandidates(candidates, body_path[0], action);
+	BOOST_CHECK_EQUAL(planning.getNumberOfFootholdCacheHits(), 0);
+	BOOST_CHECK(!candidates[0].empty());
+	dwl::locomotion::FootholdCandidate best = candidates[0][0];
+	dwl::locomotion::FootholdCandidateMap cached_candidates;
+	planning.scoreFootholdCandidates(cached_candidates, body_path[0], action);
+	BOOST_CHECK(planning.getNumberOfFootholdCacheHits() > 0);
+	BOOST_CHECK_EQUAL(cached_candidates[0].size(), candidates[0].size());
+	BOOST_CHECK(cached_candidates[0][0].position == best.position);
+
+	// A terrain change of the best cell invalidates only its sample
+	unsigned int num_hits = planning.getNumberOfFootholdCacheHits();
+	dwl::Key key;
+	terrain.getTerrainSpaceModel().coordToKeyChecked(key, best.position);
+	terrain.addCellToTerrainMap(dwl::TerrainCell(key, 50., 0.04, 0.));
+	planning.scoreFootholdCandidates(cached_candidates, body_path[0], action);
+	BOOST_CHECK_EQUAL(planning.getNumberOfFootholdCacheHits(), num_hits - 1);
+	BOOST_CHECK(cached_candidates[0][0].position.head<2>() != best.position.head<2>());
+	BOOST_CHECK_EQUAL(cached_candidates[0].back().cost, 50.);
+
+	// A disabled cache samples all the cells
+	planning.setFootholdCacheSize(0);
+	planning.scoreFootholdCandidates(cached_candidates, body_path[0], action);
+	BOOST_CHECK_EQUAL(planning.getNumberOfFootholdCacheHits(), 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(footstep_cost_to_go) // specify a test case for the terminal cost-to-go
+{
+	dwl::robot::Robot robot;
+	robot.read(DWL_SOURCE_DIR"/config/hyq_planning.yaml");
+	dwl::environment::TerrainMap terrain;
+	buildTerrain(terrain);
+
+	dwl::locomotion::FootstepGraphPlanning planning;
+	planning.reset(&robot, &terrain);
+	planning.reset(new dwl::solver::AStar());
+	planning.setContactHorizon(4);
+	std::vector<dwl::Pose> body_path = buildBodyPath(0., 9);
+	std::vector<dwl::Contact> contacts;
+	BOOST_CHECK(planning.computeContactSequence(contacts, body_path));
+
+	// The cost-to-go of the body planner pulls the last foothold of the horizon to the goal
+	std::shared_ptr<dwl::environment::CostToGoField> cost_to_go(
+			new dwl::environment::CostToGoField());
+	cost_to_go->compute(terrain, Eigen::Vector2d(1.2, 0.), Eigen::Vector2d(0., 0.), 1., 0.1);
+	planning.setCostToGoField(cost_to_go);
+	planning.setCostToGoWeight(1e6);
+	std::vector<dwl::Contact> terminal_contacts;
+	BOOST_CHECK(planning.computeContactSequence(terminal_contacts, body_path));
+	BOOST_CHECK(!planning.isReusedPlan());
+	BOOST_CHECK_EQUAL(terminal_contacts.size(), 4);
+	double initial_cost, terminal_cost;
+	BOOST_CHECK(cost_to_go->getCost(initial_cost, contacts.back().position.head<2>()));
+	BOOST_CHECK(cost_to_go->getCost(terminal_cost, terminal_contacts.back().position.head<2>()));
+	BOOST_CHECK(terminal_cost <= initial_cost);
+
+	// The plan is reused while the field doesn't change
+	BOOST_CHECK(planning.computeContactSequence(terminal_contacts, body_path));
+	BOOST_CHECK(planning.isReusedPlan());
+}
@@ -0,0 +1,39 @@
+#include <dwl/utils/FrameTF.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+BOOST_AUTO_TEST_CASE(single_precision_transforms) // specify a test case for the float path
+{
+	// The single-precision orientations agree with the double-precision ones
+	Eigen::Vector3d rpy(0.1, -0.2, 0.7);
+	Eigen::Vector3f rpy_f = rpy.cast<float>();
+	Eigen::Matrix3d rotation = dwl::math::getRotationMatrix(rpy);
+	Eigen::Matrix3f rotation_f = dwl::math::getRotationMatrix(rpy_f);
+	BOOST_CHECK((rotation.cast<float>() - rotation_f).norm() < 1e-5);
+	BOOST_CHECK((dwl::math::getRPY(rotation_f) - rpy_f).norm() < 1e-5);
+	BOOST_CHECK(fabs(dwl::math::getYaw(dwl::math::getQuaternion(rpy_f)) - rpy_f(2)) < 1e-5);
+
+	// The batched transforms of the samples agree too, also in place
+	dwl::math::FrameTF frame_tf;
+	Eigen::Matrix3Xd vecs = Eigen::Matrix3Xd::Random(3, 16);
+	Eigen::Matrix3Xf vecs_f = vecs.cast<float>();
+	Eigen::Quaterniond q = dwl::math::getQuaternion(rpy);
+	Eigen::Matrix3Xd vecs_B;
+	Eigen::Matrix3Xf vecs_B_f;
+	frame_tf.fromWorldToBaseFrame(vecs_B, vecs, q);
+	frame_tf.fromWorldToBaseFrame(vecs_B_f, vecs_f, q.cast<float>());
+	BOOST_CHECK((vecs_B.cast<float>() - vecs_B_f).norm() < 1e-5);
+	frame_tf.fromBaseToWorldFrame(vecs_B_f, vecs_B_f, q.cast<float>());
+	BOOST_CHECK((vecs_B_f - vecs_f).norm() < 1e-5);
+
+	Eigen::VectorXd yaws = Eigen::VectorXd::LinSpaced(16, -3., 3.);
+	Eigen::Matrix3Xd vecs_H;
+	Eigen::Matrix3Xf vecs_H_f;
+	frame_tf.fromWorldToHorizontalFrame(vecs_H, vecs, yaws);
+	frame_tf.fromWorldToHorizontalFrame(vecs_H_f, vecs_f, (Eigen::VectorXf) yaws.cast<float>());
+	BOOST_CHECK((vecs_H.cast<float>() - vecs_H_f).norm() < 1e-5);
+	frame_tf.fromHorizontalToWorldFrame(vecs_H_f, vecs_H_f, (Eigen::VectorXf) yaws.cast<float>());
+	BOOST_CHECK((vecs_H_f - vecs_f).norm() < 1e-5);
+}
@@ -0,0 +1,162 @@
+#include <dwl/utils/IndexedHeap.h>
+#include <dwl/utils/RadixHeap.h>
+#include <dwl/utils/GraphSearching.h>
+#include <cstdlib>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(vertex_table) // specify a test case for dense and hashed vertex tables
+{
+	// Using dense storage for the first 10 vertices and hashed storage for the rest
+	dwl::VertexTable<double> table(-1., 10);
+	table[3] = 0.5;
+	table[1000] = 2.5;
+	BOOST_CHECK_EQUAL(table.size(), 2);
+	BOOST_CHECK_EQUAL(table.count(3), 1);
+	BOOST_CHECK_EQUAL(table.count(4), 0);
+	BOOST_CHECK_EQUAL(table.get(1000), 2.5);
+	BOOST_CHECK_EQUAL(table.get(4), -1.);
+
+	// Erasing and clearing the vertices
+	table.erase(3);
+	BOOST_CHECK_EQUAL(table.count(3), 0);
+	BOOST_CHECK_EQUAL(table[3], -1.);
+	table.clear();
+	BOOST_CHECK(table.empty());
+	BOOST_CHECK(table.find(1000) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(indexed_heap) // specify a test case for the decrease-key heap
+{
+	dwl::IndexedHeap<4> heap(50);
+	heap.push(7, 3.);
+	heap.push(200, 1.);
+	heap.push(5, 2.);
+	BOOST_CHECK_EQUAL(heap.top(), 200);
+
+	// Decreasing and increasing the priorities in place
+	heap.push(7, 0.5);
+	BOOST_CHECK_EQUAL(heap.top(), 7);
+	BOOST_CHECK_EQUAL(heap.size(), 3);
+	heap.push(7, 4.);
+	BOOST_CHECK_EQUAL(heap.top(), 200);
+
+	// Checking the ties, which are broken by the vertex id
+	heap.push(3, 1.);
+	BOOST_CHECK_EQUAL(heap.top(), 3);
+
+	// Checking that the vertices are popped in order
+	dwl::Vertex expected[] = {3, 200, 5, 7};
+	for (unsigned int i = 0; i < 4; i++) {
+		BOOST_CHECK_EQUAL(heap.top(), expected[i]);
+		heap.pop();
+	}
+	BOOST_CHECK(heap.empty());
+	BOOST_CHECK(!heap.contains(7));
+
+	// Erasing vertices in the middle of the heap
+	for (unsigned int v = 0; v < 20; v++)
+		heap.push(v, 20. - v);
+	heap.erase(10);
+	heap.erase(19);
+	heap.erase(100);
+	BOOST_CHECK_EQUAL(heap.size(), 18);
+	BOOST_CHECK(!heap.contains(10));
+	BOOST_CHECK_EQUAL(heap.top(), 18);
+	heap.clear();
+
+	// Checking the order of random priorities
+	srand(1);
+	for (unsigned int i = 0; i < 1000; i++)
+		heap.push(rand() % 100, rand() % 1000);
+	double last_priority = -1.;
+	while (!heap.empty()) {
+		BOOST_CHECK(heap.topPriority() >= last_priority);
+		last_priority = heap.topPriority();
+		heap.pop();
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lexicographic_heap) // specify a test case for pair priorities
+{
+	typedef std::pair<dwl::Weight, dwl::Weight> Key;
+	dwl::IndexedHeap<4, Key> heap;
+	heap.push(1, Key(2., 1.));
+	heap.push(2, Key(2., 0.5));
+	heap.push(3, Key(3., 0.));
+	BOOST_CHECK_EQUAL(heap.top(), 2);
+	heap.erase(2);
+	BOOST_CHECK_EQUAL(heap.top(), 1);
+	BOOST_CHECK(heap.topPriority() == Key(2., 1.));
+}
+
+
+BOOST_AUTO_TEST_CASE(radix_heap) // specify a test case for the monotone heap of integer keys
+{
+	// Popping in order of key while the keys are pushed monotonically, as in Dijkstra
+	dwl::RadixHeap<unsigned int> heap;
+	heap.push(7, 0);
+	heap.push(3, 1);
+	heap.push(1000000, 2);
+	unsigned long long last_key = 0;
+	unsigned int num_pops = 0;
+	std::srand(3);
+	while (!heap.empty()) {
+		unsigned long long key = heap.topKey();
+		BOOST_CHECK(key >= last_key);
+		last_key = key;
+		heap.pop();
+		if (++num_pops < 200)
+			heap.push(key + std::rand() % 50, num_pops);
+	}
+	BOOST_CHECK_EQUAL(num_pops, 202);
+
+	// The keys below the last popped one are clamped, where the clearing resets the last key
+	heap.clear();
+	heap.push(10, 0);
+	heap.pop();
+	heap.push(5, 1);
+	BOOST_CHECK_EQUAL(heap.topKey(), 10);
+	BOOST_CHECK_EQUAL(heap.top(), 1);
+	heap.clear();
+	BOOST_CHECK(heap.empty());
+}
+
+
+BOOST_AUTO_TEST_CASE(memory_pool) // specify a test case for the pool of the search structures
+{
+	dwl::utils::MemoryPool pool(1024);
+	dwl::utils::PoolAllocator<dwl::Edge> allocator(&pool);
+	{
+		dwl::EdgeList edges(allocator);
+		for (unsigned int i = 0; i < 100; i++)
+			edges.push_back(dwl::Edge(i, 0.5 * i));
+		BOOST_CHECK_EQUAL(edges.back().target, 99);
+		BOOST_CHECK_CLOSE(edges.back().weight, 49.5, 1e-9);
+
+		// The nodes of the erased edges are reused, so the blocks don't grow
+		unsigned int num_blocks = pool.getNumberOfBlocks();
+		BOOST_CHECK(num_blocks > 1);
+		edges.clear();
+		for (unsigned int i = 0; i < 100; i++)
+			edges.push_back(dwl::Edge(i, 1.));
+		BOOST_CHECK_EQUAL(pool.getNumberOfBlocks(), num_blocks);
+	}
+
+	// The blocks are kept after a reset, and the default allocator doesn't use a pool
+	unsigned int num_blocks = pool.getNumberOfBlocks();
+	pool.reset();
+	dwl::EdgeList edges(allocator);
+	edges.push_back(dwl::Edge(1, 1.));
+	BOOST_CHECK_EQUAL(pool.getNumberOfBlocks(), num_blocks);
+	dwl::EdgeList system_edges;
+	system_edges = edges;
+	BOOST_CHECK(system_edges.get_allocator().getPool() == NULL);
+	BOOST_CHECK_EQUAL(system_edges.front().target, 1);
+	edges.clear();
+	pool.release();
+	BOOST_CHECK_EQUAL(pool.getNumberOfBlocks(), 0);
+}
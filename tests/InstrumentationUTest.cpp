@@ -0,0 +1,65 @@
+#define DWL_WITH_INSTRUMENTATION
+#include <dwl/utils/Instrumentation.h>
+#include <thread>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+static const dwl::utils::ProbeStatistics& getProbe(const std::vector<dwl::utils::ProbeStatistics>& stats,
+												  const std::string& name)
+{
+	for (unsigned int i = 0; i < stats.size(); i++) {
+		if (stats[i].name == name)
+			return stats[i];
+	}
+
+	static dwl::utils::ProbeStatistics empty;
+	return empty;
+}
+
+
+static void recordProbes(unsigned int num_scopes)
+{
+	for (unsigned int i = 0; i < num_scopes; i++) {
+		DWL_SCOPED_TIMER("test::scope");
+		DWL_COUNT_EVENTS("test::events", 2);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(scoped_timers_and_counters) // specify a test case for the instrumentation
+{
+	// The probes are registered once by name
+	unsigned int probe = dwl::utils::Instrumentation::registerProbe("test::registered");
+	BOOST_CHECK_EQUAL(dwl::utils::Instrumentation::registerProbe("test::registered"), probe);
+
+	// Recording the probes from this thread and several threads, where the buffers of the
+	// finished threads are kept
+	recordProbes(10);
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < 4; t++)
+		threads.push_back(std::thread(recordProbes, 100));
+	for (unsigned int t = 0; t < threads.size(); t++)
+		threads[t].join();
+	for (unsigned int t = 0; t < 3; t++)
+		std::thread(recordProbes, 5).join();
+
+	std::vector<dwl::utils::ProbeStatistics> stats;
+	dwl::utils::Instrumentation::getStatistics(stats);
+	const dwl::utils::ProbeStatistics& scope = getProbe(stats, "test::scope");
+	BOOST_CHECK_EQUAL(scope.type, dwl::utils::TimerProbe);
+	BOOST_CHECK_EQUAL(scope.count, 425);
+	BOOST_CHECK(scope.total_time >= scope.max_time);
+	const dwl::utils::ProbeStatistics& events = getProbe(stats, "test::events");
+	BOOST_CHECK_EQUAL(events.type, dwl::utils::CounterProbe);
+	BOOST_CHECK_EQUAL(events.count, 850);
+	BOOST_CHECK_EQUAL(events.total_time, 0.);
+
+	// Resetting the records of all the threads
+	dwl::utils::Instrumentation::reset();
+	dwl::utils::Instrumentation::getStatistics(stats);
+	BOOST_CHECK_EQUAL(getProbe(stats, "test::scope").count, 0);
+	BOOST_CHECK_EQUAL(getProbe(stats, "test::events").count, 0);
+}
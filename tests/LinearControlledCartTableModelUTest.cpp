@@ -0,0 +1,74 @@
+#include <dwl/simulation/LinearControlledCartTableModel.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+dwl::ReducedBodyState getInitialState()
+{
+	dwl::ReducedBodyState state;
+	state.time = 0.5;
+	state.com_pos = Eigen::Vector3d(0.1, -0.05, 0.55);
+	state.com_vel = Eigen::Vector3d(0.2, 0.05, 0.);
+	state.angular_pos = Eigen::Vector3d(0., 0., 0.3);
+	state.cop = Eigen::Vector3d(0.05, 0., 0.);
+	state.support_region["lf_foot"] = Eigen::Vector3d(0.35, 0.3, 0.02);
+	state.support_region["rf_foot"] = Eigen::Vector3d(0.35, -0.3, 0.);
+	state.support_region["lh_foot"] = Eigen::Vector3d(-0.35, 0.3, 0.);
+	return state;
+}
+
+void computeResponse(dwl::ReducedBodyState& response,
+					 double duration,
+					 const Eigen::Vector2d& cop_shift,
+					 double time)
+{
+	dwl::simulation::LinearControlledCartTableModel cart_table;
+	cart_table.setModelProperties(dwl::simulation::CartTableProperties(80.));
+	dwl::ReducedBodyState state = getInitialState();
+	cart_table.initResponse(state, dwl::simulation::CartTableControlParams(duration, cop_shift));
+	response = state;
+	cart_table.computeResponse(response, time);
+}
+
+BOOST_AUTO_TEST_CASE(response_derivatives) // specify a test case for the analytic derivatives
+{
+	double duration = 0.4;
+	Eigen::Vector2d cop_shift(0.08, -0.03);
+	dwl::simulation::LinearControlledCartTableModel cart_table;
+	cart_table.setModelProperties(dwl::simulation::CartTableProperties(80.));
+	dwl::ReducedBodyState state = getInitialState();
+	cart_table.initResponse(state, dwl::simulation::CartTableControlParams(duration, cop_shift));
+
+	// Comparing the derivatives with central finite differences, for an intermediate time
+	// and the end of the phase
+	double eps = 1e-6;
+	for (unsigned int terminal = 0; terminal < 2; terminal++) {
+		double time = terminal ? state.time + duration : state.time + 0.25;
+		dwl::simulation::CartTableResponseDerivatives derivatives;
+		cart_table.computeResponseDerivatives(derivatives, time, terminal);
+
+		for (unsigned int j = 0; j < 3; j++) {
+			double delta_duration = (j == 0) ? eps : 0.;
+			Eigen::Vector2d delta_shift = Eigen::Vector2d::Zero();
+			if (j > 0)
+				delta_shift(j - 1) = eps;
+
+			dwl::ReducedBodyState plus, minus;
+			double delta_time = terminal ? delta_duration : 0.;
+			computeResponse(plus, duration + delta_duration, cop_shift + delta_shift,
+							time + delta_time);
+			computeResponse(minus, duration - delta_duration, cop_shift - delta_shift,
+							time - delta_time);
+			Eigen::Vector3d com_pos = (plus.com_pos - minus.com_pos) / (2 * eps);
+			Eigen::Vector3d com_vel = (plus.com_vel - minus.com_vel) / (2 * eps);
+			Eigen::Vector3d com_acc = (plus.com_acc - minus.com_acc) / (2 * eps);
+			Eigen::Vector3d cop = (plus.cop - minus.cop) / (2 * eps);
+			BOOST_CHECK((derivatives.com_pos.col(j) - com_pos).norm() < 1e-6);
+			BOOST_CHECK((derivatives.com_vel.col(j) - com_vel).norm() < 1e-6);
+			BOOST_CHECK((derivatives.com_acc.col(j) - com_acc).norm() < 1e-5);
+			BOOST_CHECK((derivatives.cop.col(j) - cop).norm() < 1e-6);
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#include <dwl/utils/Log.h>
+#include <vector>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(log_levels) // specify a test case for the level-gated log
+{
+	std::vector<dwl::utils::LogRecord> records;
+	dwl::utils::Log::setSink([&records](const dwl::utils::LogRecord& record) {
+		records.push_back(record);
+	});
+
+	// The records above the level aren't formatted, so their arguments aren't evaluated
+	int num_evaluations = 0;
+	dwl::utils::Log::setLevel(dwl::utils::LogWarning);
+	BOOST_CHECK(dwl::utils::Log::isEnabled(dwl::utils::LogError));
+	BOOST_CHECK(!dwl::utils::Log::isEnabled(dwl::utils::LogInfo));
+	DWL_LOG_DEBUG("test", "value = %d", ++num_evaluations);
+	DWL_LOG_WARNING("test", "value = %d", ++num_evaluations);
+	BOOST_CHECK_EQUAL(num_evaluations, 1);
+	BOOST_CHECK_EQUAL(records.size(), 1);
+	BOOST_CHECK(records[0].level == dwl::utils::LogWarning);
+	BOOST_CHECK_EQUAL(std::string(records[0].component), "test");
+	BOOST_CHECK_EQUAL(records[0].message, "value = 1");
+
+	// The long messages are formatted entirely
+	dwl::utils::Log::setLevel(dwl::utils::LogDebug);
+	std::string long_message(1000, 'x');
+	DWL_LOG_DEBUG("test", "%s", long_message.c_str());
+	BOOST_CHECK_EQUAL(records.back().message, long_message);
+
+	dwl::utils::Log::setLevel(dwl::utils::LogOff);
+	DWL_LOG_ERROR("test", "error");
+	BOOST_CHECK_EQUAL(records.size(), 2);
+
+	dwl::utils::LogLevel level;
+	BOOST_CHECK(dwl::utils::Log::parseLevel(level, "info"));
+	BOOST_CHECK(level == dwl::utils::LogInfo);
+	BOOST_CHECK(!dwl::utils::Log::parseLevel(level, "verbose"));
+	dwl::utils::Log::setSink(dwl::utils::Log::Sink());
+}
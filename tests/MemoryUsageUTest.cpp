@@ -0,0 +1,78 @@
+#include <dwl/utils/MemoryUsage.h>
+#include <dwl/environment/TerrainGrid.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+BOOST_AUTO_TEST_CASE(heap_bytes) // specify a test case for the heap bytes of the values
+{
+	// The fixed-size values don't have heap memory
+	BOOST_CHECK_EQUAL(dwl::utils::getHeapBytes(3.), 0);
+	BOOST_CHECK_EQUAL(dwl::utils::getHeapBytes(Eigen::Vector3d::Zero()), 0);
+	BOOST_CHECK_EQUAL(dwl::utils::getHeapBytes(Eigen::Matrix3d()), 0);
+
+	// The dynamic-size matrices and the vectors count their capacity
+	Eigen::MatrixXd matrix(4, 5);
+	BOOST_CHECK_EQUAL(dwl::utils::getHeapBytes(matrix), 20 * sizeof(double));
+
+	std::vector<double> values(10);
+	values.reserve(16);
+	BOOST_CHECK_EQUAL(dwl::utils::getHeapBytes(values), 16 * sizeof(double));
+
+	// The nested containers count the heap bytes of their elements
+	std::vector<Eigen::VectorXd> vectors(3, Eigen::VectorXd(6));
+	BOOST_CHECK_EQUAL(dwl::utils::getHeapBytes(vectors),
+					  vectors.capacity() * sizeof(Eigen::VectorXd) + 18 * sizeof(double));
+
+	std::map<unsigned int, Eigen::VectorXd> map;
+	map[0] = Eigen::VectorXd(2);
+	map[1] = Eigen::VectorXd(3);
+	BOOST_CHECK(dwl::utils::getHeapBytes(map) >
+				2 * sizeof(std::pair<const unsigned int, Eigen::VectorXd>) + 5 * sizeof(double));
+}
+
+
+BOOST_AUTO_TEST_CASE(memory_report) // specify a test case for the memory reports
+{
+	dwl::utils::MemoryUsage grid("grid", 100);
+	grid.add("tiles", 400);
+
+	dwl::utils::MemoryUsage terrain("terrain");
+	terrain.add("cells", 24);
+	terrain.add(grid);
+
+	// The total bytes include the components
+	BOOST_CHECK_EQUAL(grid.getBytes(), 500);
+	BOOST_CHECK_EQUAL(terrain.getBytes(), 524);
+	BOOST_CHECK_EQUAL(terrain.getComponents().size(), 2);
+
+	// The nested components are found by their paths
+	const dwl::utils::MemoryUsage* tiles = terrain.find("grid/tiles");
+	BOOST_REQUIRE(tiles != NULL);
+	BOOST_CHECK_EQUAL(tiles->getBytes(), 400);
+	BOOST_CHECK(terrain.find("grid/directory") == NULL);
+	BOOST_CHECK(terrain.find("pyramid") == NULL);
+}
+
+
+BOOST_AUTO_TEST_CASE(terrain_grid_memory) // specify a test case for the memory of a terrain grid
+{
+	dwl::environment::TerrainGrid grid;
+	dwl::utils::MemoryUsage empty = grid.getMemoryUsage();
+	BOOST_CHECK_EQUAL(empty.getName(), "terrain_grid");
+
+	// Every allocated tile has the values of all of its cells
+	unsigned int tile_cells = dwl::environment::TerrainGrid::TILE_SIZE *
+			dwl::environment::TerrainGrid::TILE_SIZE;
+	grid.setCell(dwl::Key(0, 0, 0), 0.1, 1., Eigen::Vector3d::UnitZ());
+	grid.setCell(dwl::Key(200, 0, 0), 0.2, 1., Eigen::Vector3d::UnitZ());
+	BOOST_CHECK_EQUAL(grid.getNumberOfTiles(), 2);
+
+	dwl::utils::MemoryUsage usage = grid.getMemoryUsage();
+	const dwl::utils::MemoryUsage* tiles = usage.find("tiles");
+	BOOST_REQUIRE(tiles != NULL);
+	BOOST_CHECK(tiles->getBytes() >= 2 * tile_cells * (sizeof(double) + sizeof(Eigen::Vector3d)));
+	BOOST_CHECK(usage.getBytes() > empty.getBytes());
+}
@@ -0,0 +1,98 @@
+#include <dwl/model/ModelRegistry.h>
+#include <dwl/model/WholeBodyDynamics.h>
+#include <dwl/model/ModelCodeGenerator.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(shared_models) // specify a test case for the model registry
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	dwl::model::ModelRegistry::clear();
+
+	// The models of the same robot are parsed once, and the copies describe the same system
+	dwl::model::FloatingBaseSystem fbs;
+	dwl::model::WholeBodyDynamics wdyn;
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	BOOST_CHECK_EQUAL(dwl::model::ModelRegistry::getNumberOfSystems(), 1);
+	const dwl::model::FloatingBaseSystem& wdyn_fbs = wdyn.getFloatingBaseSystem();
+	BOOST_CHECK_EQUAL(fbs.getJointDoF(), wdyn_fbs.getJointDoF());
+	BOOST_CHECK(fbs.getJointNames() == wdyn_fbs.getJointNames());
+	BOOST_CHECK(fbs.getEndEffectorNames() == wdyn_fbs.getEndEffectorNames());
+	BOOST_CHECK(fbs.getDefaultPosture() == wdyn_fbs.getDefaultPosture());
+
+	// Resetting a system doesn't accumulate its names
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+	BOOST_CHECK_EQUAL(fbs.getJointNames().size(), fbs.getJointDoF());
+
+	// A different system file is another model
+	fbs.resetFromURDFFile(urdf_file);
+	BOOST_CHECK_EQUAL(dwl::model::ModelRegistry::getNumberOfSystems(), 2);
+	dwl::model::ModelRegistry::clear();
+	BOOST_CHECK_EQUAL(dwl::model::ModelRegistry::getNumberOfSystems(), 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(content_hash) // specify a test case for the content hash
+{
+	// FNV-1a reference values, and the chaining of strings
+	BOOST_CHECK_EQUAL(dwl::model::ModelRegistry::computeHash(""), 14695981039346656037ULL);
+	BOOST_CHECK_EQUAL(dwl::model::ModelRegistry::computeHash("a"), 0xaf63dc4c8601ec8cULL);
+	BOOST_CHECK_EQUAL(dwl::model::ModelRegistry::computeHash("b", dwl::model::ModelRegistry::computeHash("a")),
+					  dwl::model::ModelRegistry::computeHash("ab"));
+}
+
+
+BOOST_AUTO_TEST_CASE(shared_description) // specify a test case for the shared description
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+
+	// The copies share the description, and they own the RBDL model
+	dwl::model::FloatingBaseSystem fbs;
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+	dwl::model::FloatingBaseSystem fbs_copy = fbs;
+	BOOST_CHECK(&fbs.getDescription() == &fbs_copy.getDescription());
+	BOOST_CHECK(&fbs.getRBDModel() != &fbs_copy.getRBDModel());
+
+	// Modifying a copy doesn't modify the rest of the systems
+	fbs_copy.setTypeOfDynamicSystem(dwl::model::FixedBase);
+	BOOST_CHECK(&fbs.getDescription() != &fbs_copy.getDescription());
+	BOOST_CHECK(fbs.getTypeOfDynamicSystem() == dwl::model::FloatingBase);
+	BOOST_CHECK(fbs_copy.getTypeOfDynamicSystem() == dwl::model::FixedBase);
+}
+
+
+BOOST_AUTO_TEST_CASE(generated_models) // specify a test case for the generated models
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	dwl::model::GeneratedModelRegistry::clear();
+
+	// Generating the code of the model, which doesn't depend on the registered models
+	dwl::model::FloatingBaseSystem fbs;
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+	BOOST_CHECK(fbs.getGeneratedModel() == NULL);
+	std::string code;
+	dwl::model::ModelCodeGenerator generator;
+	BOOST_CHECK(generator.generate(code, fbs, "hyq"));
+	BOOST_CHECK(code.find(dwl::model::GeneratedModelRegistry::getSymbolName("hyq")) !=
+			std::string::npos);
+
+	// The systems of the same model use the registered one
+	const RigidBodyDynamics::Model& model = fbs.getRBDModel();
+	dwl::model::GeneratedModel generated = {"hyq",
+			dwl::model::GeneratedModelRegistry::computeHash(model),
+			(unsigned int) model.mBodies.size(), model.dof_count, NULL, NULL, NULL};
+	dwl::model::GeneratedModelRegistry::add(&generated);
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+	BOOST_CHECK(fbs.getGeneratedModel() == &generated);
+
+	dwl::model::GeneratedModelRegistry::clear();
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+	BOOST_CHECK(fbs.getGeneratedModel() == NULL);
+}
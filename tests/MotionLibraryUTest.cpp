@@ -0,0 +1,115 @@
+#include <dwl/locomotion/MotionLibrary.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+// Descriptor of a flat-terrain problem with a forward velocity command
+dwl::locomotion::MotionDescriptor buildDescriptor(double height,
+												  double velocity,
+												  uint64_t terrain_hash = 1)
+{
+	Eigen::VectorXd features(1), command(1);
+	features << height;
+	command << velocity;
+	return dwl::locomotion::MotionDescriptor(features, terrain_hash, command);
+}
+
+
+// Flat terrain with a step of 0.16 m at x = 0.4 m
+void buildTerrain(dwl::environment::TerrainMap& terrain)
+{
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (int i = -40; i < 40; i++) {
+		for (int j = -40; j < 40; j++) {
+			int level = (i >= 10) ? 4 : 0;
+			dwl::Key key(32768 + i, 32768 + j, 32768 + level);
+			terrain_data.data.push_back(dwl::TerrainCell(key, 1., 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+}
+
+
+BOOST_AUTO_TEST_CASE(motion_library) // specify a test case for the motion library
+{
+	dwl::locomotion::MotionLibrary<double> library(2);
+	double motion;
+	BOOST_CHECK(!library.lookup(motion, buildDescriptor(0.5, 0.2)));
+
+	// The nearest motion of the same terrain patch is retrieved
+	library.add(buildDescriptor(0.5, 0.2), 1.);
+	library.add(buildDescriptor(0.5, 0.6), 2.);
+	double distance;
+	BOOST_CHECK(library.lookup(motion, buildDescriptor(0.5, 0.5), &distance));
+	BOOST_CHECK_EQUAL(motion, 2.);
+	BOOST_CHECK_CLOSE(distance, 0.1, 1e-6);
+	BOOST_CHECK(!library.lookup(motion, buildDescriptor(0.5, 0.5, 2)));
+	BOOST_CHECK_EQUAL(library.getNumberOfHits(), 1);
+	BOOST_CHECK_EQUAL(library.getNumberOfMisses(), 2);
+
+	// The farther motions aren't retrieved
+	library.setMaximumDistance(0.05);
+	BOOST_CHECK(!library.lookup(motion, buildDescriptor(0.5, 0.4)));
+	library.setMaximumDistance(std::numeric_limits<double>::max());
+
+	// The least recently used motion is removed first
+	library.add(buildDescriptor(0.5, 1.), 3.);
+	BOOST_CHECK_EQUAL(library.size(), 2);
+	BOOST_CHECK(library.lookup(motion, buildDescriptor(0.5, 0.2)));
+	BOOST_CHECK_EQUAL(motion, 2.);
+
+	// A close motion replaces the stored one
+	library.setMinimumSpacing(0.01);
+	library.add(buildDescriptor(0.5, 1.005), 4.);
+	BOOST_CHECK_EQUAL(library.size(), 2);
+	BOOST_CHECK(library.lookup(motion, buildDescriptor(0.5, 1.)));
+	BOOST_CHECK_EQUAL(motion, 4.);
+}
+
+
+BOOST_AUTO_TEST_CASE(motion_descriptors) // specify a test case for the motion descriptors
+{
+	dwl::environment::TerrainMap terrain;
+	buildTerrain(terrain);
+
+	// The same step has the same hash in other places, but not the flat terrain
+	uint64_t step_hash = dwl::locomotion::computeTerrainHash(terrain, Eigen::Vector2d(0.4, 0.),
+															 0., 0.4, 0.08, 0.04);
+	BOOST_CHECK_EQUAL(step_hash, dwl::locomotion::computeTerrainHash(terrain,
+																	 Eigen::Vector2d(0.4, 0.4),
+																	 0., 0.4, 0.08, 0.04));
+	BOOST_CHECK(step_hash != dwl::locomotion::computeTerrainHash(terrain,
+																 Eigen::Vector2d(-0.8, 0.),
+																 0., 0.4, 0.08, 0.04));
+
+	// The aligned trajectory starts at the horizontal pose and time of the state
+	dwl::WholeBodyTrajectory trajectory(2, dwl::WholeBodyState(0));
+	trajectory[1].base_pos(dwl::rbd::LX) = 0.1;
+	trajectory[1].base_pos(dwl::rbd::LZ) = 0.5;
+	trajectory[1].base_vel(dwl::rbd::LX) = 1.;
+	trajectory[1].time = 0.1;
+	dwl::WholeBodyState state(0);
+	state.base_pos(dwl::rbd::AZ) = M_PI / 2;
+	state.base_pos(dwl::rbd::LX) = 1.;
+	state.time = 2.;
+	dwl::locomotion::alignTrajectory(trajectory, state);
+	BOOST_CHECK_CLOSE(trajectory[0].base_pos(dwl::rbd::LX), 1., 1e-6);
+	BOOST_CHECK_CLOSE(trajectory[1].base_pos(dwl::rbd::LX), 1., 1e-6);
+	BOOST_CHECK_CLOSE(trajectory[1].base_pos(dwl::rbd::LY), 0.1, 1e-6);
+	BOOST_CHECK_CLOSE(trajectory[1].base_pos(dwl::rbd::LZ), 0.5, 1e-6);
+	BOOST_CHECK_CLOSE(trajectory[1].base_pos(dwl::rbd::AZ), M_PI / 2, 1e-6);
+	BOOST_CHECK_CLOSE(trajectory[1].base_vel(dwl::rbd::LY), 1., 1e-6);
+	BOOST_CHECK_CLOSE(trajectory[1].time, 2.1, 1e-6);
+
+	// The features don't depend on the heading
+	Eigen::VectorXd features, aligned_features;
+	dwl::locomotion::computeStateFeatures(features, trajectory[1]);
+	trajectory[1].base_pos(dwl::rbd::AZ) = 0.;
+	trajectory[1].base_vel(dwl::rbd::LX) = 1.;
+	trajectory[1].base_vel(dwl::rbd::LY) = 0.;
+	dwl::locomotion::computeStateFeatures(aligned_features, trajectory[1]);
+	BOOST_CHECK(features.isApprox(aligned_features));
+}
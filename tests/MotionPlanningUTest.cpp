@@ -0,0 +1,97 @@
+#include <dwl/locomotion/MotionPlanning.h>
+#include <dwl/solver/AStar.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+// Motion planner that exposes the path smoothing
+class SmoothingPlanning : public dwl::locomotion::MotionPlanning
+{
+	public:
+		bool computePath(std::vector<dwl::Pose>& path,
+						 dwl::Pose start_pose,
+						 dwl::Pose goal_pose) {
+			return false;
+		}
+
+		void smooth(std::vector<dwl::Pose>& path) {
+			smoothPath(path);
+		}
+
+		bool isVisible(const dwl::Pose& initial_pose,
+					   const dwl::Pose& final_pose,
+					   double max_cost) {
+			return isLineOfSight(initial_pose, final_pose, max_cost);
+		}
+};
+
+
+// Pose at the center of a terrain cell
+dwl::Pose cellPose(dwl::environment::TerrainMap& terrain,
+				   unsigned short int i,
+				   unsigned short int j)
+{
+	dwl::Pose pose;
+	double x, y;
+	terrain.getTerrainSpaceModel().keyToCoord(x, 32768 + i, true);
+	terrain.getTerrainSpaceModel().keyToCoord(y, 32768 + j, true);
+	pose.position << x, y, 0.;
+	return pose;
+}
+
+
+BOOST_AUTO_TEST_CASE(path_smoothing) // specify a test case for the shortcut smoothing
+{
+	// Flat terrain with a block of rough terrain
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int i = 0; i < 40; i++) {
+		for (unsigned short int j = 0; j < 40; j++) {
+			double cost = (i >= 15 && i < 30 && j < 25) ? 10. : 1.;
+			terrain_data.data.push_back(dwl::TerrainCell(dwl::Key(32768 + i, 32768 + j, 32768),
+														 cost, 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+
+	SmoothingPlanning planning;
+	planning.reset(new dwl::solver::AStar());
+	planning.reset((dwl::robot::Robot*) NULL, &terrain);
+	planning.setPathSmoothing(true);
+
+	// A straight path is reduced to its endpoints
+	std::vector<dwl::Pose> path;
+	for (unsigned short int i = 0; i < 40; i++)
+		path.push_back(cellPose(terrain, i, 30));
+	planning.smooth(path);
+	BOOST_CHECK_EQUAL(path.size(), 2);
+	BOOST_CHECK(path.back().position == cellPose(terrain, 39, 30).position);
+
+	// A path around the rough block keeps the waypoints that avoid it
+	std::vector<dwl::Pose> detour;
+	for (unsigned short int j = 5; j < 30; j++)
+		detour.push_back(cellPose(terrain, 5, j));
+	for (unsigned short int i = 6; i < 36; i++)
+		detour.push_back(cellPose(terrain, i, 29));
+	for (unsigned short int j = 28; j > 5; j--)
+		detour.push_back(cellPose(terrain, 35, j));
+	planning.smooth(detour);
+	BOOST_CHECK(detour.size() > 2);
+	BOOST_CHECK(detour.size() < 8);
+	BOOST_CHECK(detour.front().position == cellPose(terrain, 5, 5).position);
+	BOOST_CHECK(detour.back().position == cellPose(terrain, 35, 6).position);
+	for (unsigned int k = 1; k < detour.size(); k++)
+		BOOST_CHECK(planning.isVisible(detour[k - 1], detour[k], 1.));
+
+	// With a bigger cost tolerance, the path crosses the rough block
+	std::vector<dwl::Pose> crossing(1, cellPose(terrain, 5, 5));
+	crossing.push_back(cellPose(terrain, 5, 29));
+	crossing.push_back(cellPose(terrain, 35, 29));
+	crossing.push_back(cellPose(terrain, 35, 6));
+	planning.setPathSmoothing(true, 10.);
+	planning.smooth(crossing);
+	BOOST_CHECK_EQUAL(crossing.size(), 2);
+}
@@ -0,0 +1,45 @@
+#include <dwl/model/OperationalSpaceDynamics.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 0.00001;
+
+BOOST_AUTO_TEST_CASE(operational_space_dynamics) // specify a test case for the OSD
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+	const dwl::rbd::BodySelector& feet = fbs.getEndEffectorNames(dwl::model::FOOT);
+
+	dwl::model::OperationalSpaceDynamics osd;
+	osd.reset(&wdyn);
+
+	dwl::rbd::Vector6d base_pos = 0.1 * dwl::rbd::Vector6d::Random();
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture();
+	BOOST_CHECK(osd.computeOperationalSpaceDynamics(base_pos, joint_pos, feet));
+
+	// The sparse factorization has to be the one of the joint-space inertia matrix
+	Eigen::MatrixXd inertia = wdyn.computeJointSpaceInertiaMatrix(base_pos, joint_pos);
+	const Eigen::MatrixXd& factor = osd.getInertiaFactor();
+	BOOST_CHECK_SMALL((factor.transpose() * factor - inertia).norm(), epsilon);
+
+	// Comparing the operational-space inertia and the null-space projector with the dense
+	// inversions
+	Eigen::MatrixXd jac;
+	wdyn.getWholeBodyKinematics().computeContactJacobian(jac, base_pos, joint_pos, feet);
+	Eigen::MatrixXd inertia_inv = inertia.inverse();
+	Eigen::MatrixXd task_inertia = (jac * inertia_inv * jac.transpose()).inverse();
+	Eigen::MatrixXd consistent_inv = inertia_inv * jac.transpose() * task_inertia;
+	BOOST_CHECK_SMALL((osd.getOperationalSpaceInertia() - task_inertia).norm(), epsilon);
+	BOOST_CHECK_SMALL((osd.getDynamicallyConsistentInverse() - consistent_inv).norm(), epsilon);
+
+	// The projected accelerations don't affect the task
+	BOOST_CHECK_SMALL((jac * osd.getNullSpaceProjector()).norm(), epsilon);
+}
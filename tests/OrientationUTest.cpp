@@ -0,0 +1,57 @@
+#include <dwl/utils/Orientation.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+BOOST_AUTO_TEST_CASE(batch_orientation) // specify a test case for the batch conversions
+{
+	// Defining a batch of RPY angles, where the pitch is inside (-pi/2,pi/2)
+	unsigned int num_samples = 200;
+	Eigen::MatrixX3d rpy(num_samples, 3);
+	for (unsigned int i = 0; i < num_samples; i++) {
+		double t = (double) i / num_samples;
+		rpy.row(i) << M_PI * (2 * t - 1), 1.5 * sin(7 * t), 3.1 * cos(11 * t);
+	}
+
+	// The exact conversions are the same as the single ones
+	Eigen::MatrixX4d quaternions;
+	dwl::math::RotationMatrixBatch rotations;
+	Eigen::MatrixX3d quaternion_rpy, rotation_rpy;
+	Eigen::VectorXd yaw;
+	dwl::math::getQuaternion(quaternions, rpy);
+	dwl::math::getRotationMatrix(rotations, rpy);
+	dwl::math::getRPY(quaternion_rpy, quaternions);
+	dwl::math::getRPY(rotation_rpy, rotations);
+	dwl::math::getYaw(yaw, quaternions);
+	for (unsigned int i = 0; i < num_samples; i++) {
+		Eigen::Vector3d angles = rpy.row(i).transpose();
+		Eigen::Quaterniond q = dwl::math::getQuaternion(angles);
+		Eigen::Matrix3d rot = dwl::math::getRotationMatrix(angles);
+		BOOST_CHECK_SMALL((quaternions.row(i).transpose() - q.coeffs()).norm(), 1e-12);
+		BOOST_CHECK_SMALL((Eigen::Map<const Eigen::Matrix3d>(rotations.row(i).eval().data()) -
+				rot).norm(), 1e-12);
+		BOOST_CHECK_SMALL((quaternion_rpy.row(i).transpose() - dwl::math::getRPY(q)).norm(), 1e-12);
+		BOOST_CHECK_SMALL((rotation_rpy.row(i).transpose() - dwl::math::getRPY(rot)).norm(), 1e-12);
+		BOOST_CHECK_SMALL(yaw(i) - dwl::math::getYaw(q), 1e-12);
+	}
+
+	// The fast conversions have bounded errors
+	Eigen::MatrixX4d fast_quaternions;
+	Eigen::MatrixX3d fast_rpy;
+	dwl::math::getQuaternion(fast_quaternions, rpy, true);
+	dwl::math::getRPY(fast_rpy, quaternions, true);
+	BOOST_CHECK_SMALL((fast_quaternions - quaternions).cwiseAbs().maxCoeff(), 1e-8);
+	BOOST_CHECK_SMALL((fast_rpy - quaternion_rpy).cwiseAbs().maxCoeff(), 1e-5);
+
+	Eigen::ArrayXd angles = Eigen::ArrayXd::LinSpaced(1001, -20., 20.);
+	Eigen::ArrayXd sin_angle, cos_angle, atan_angle;
+	dwl::math::computeSinCos(sin_angle, cos_angle, angles, true);
+	BOOST_CHECK_SMALL((sin_angle - angles.sin()).abs().maxCoeff(), 2e-9);
+	BOOST_CHECK_SMALL((cos_angle - angles.cos()).abs().maxCoeff(), 2e-9);
+	dwl::math::computeAtan2(atan_angle, sin_angle, cos_angle, true);
+	Eigen::ArrayXd exact_angle;
+	dwl::math::computeAtan2(exact_angle, sin_angle, cos_angle);
+	BOOST_CHECK_SMALL((atan_angle - exact_angle).abs().maxCoeff(), 2e-6);
+}
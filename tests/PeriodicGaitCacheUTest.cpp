@@ -0,0 +1,89 @@
+#include <dwl/simulation/PeriodicGaitCache.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+// Trotting schedule of a quadruped
+dwl::simulation::PreviewSchedule buildTrotSchedule()
+{
+	dwl::rbd::BodySelector feet = {"lf_foot", "rf_foot", "lh_foot", "rh_foot"};
+	dwl::simulation::PreviewSchedule schedule;
+	schedule.setFeet(feet);
+	schedule.addPhase(dwl::simulation::PreviewPhase(dwl::simulation::STANCE, {"lf_foot", "rh_foot"}));
+	schedule.addPhase(dwl::simulation::PreviewPhase(dwl::simulation::STANCE, {"rf_foot", "lh_foot"}));
+	return schedule;
+}
+
+
+// Reduced-body state with a CoM over its CoP and a given forward velocity
+dwl::ReducedBodyState buildState(const Eigen::Vector3d& com_pos,
+								  double yaw,
+								  double velocity)
+{
+	dwl::ReducedBodyState state;
+	state.time = 1.;
+	state.com_pos = com_pos;
+	state.angular_pos << 0., 0., yaw;
+	state.com_vel << velocity * cos(yaw), velocity * sin(yaw), 0.;
+	state.cop = com_pos - Eigen::Vector3d(0., 0., 0.55);
+	state.support_region["rf_foot"] = state.cop;
+	state.support_region["lh_foot"] = state.cop;
+	return state;
+}
+
+
+BOOST_AUTO_TEST_CASE(periodic_gait_cache) // specify a test case for the periodic gait cache
+{
+	dwl::simulation::PeriodicGaitCache cache(2);
+	dwl::simulation::PreviewSchedule schedule = buildTrotSchedule();
+	dwl::simulation::VelocityCommand command(Eigen::Vector2d(0.3, 0.), 0.);
+	dwl::simulation::PreviewControl control;
+	BOOST_CHECK(!cache.lookup(control, command, schedule));
+
+	// The commands of the same quantization cell share a cycle
+	dwl::ReducedBodyState state = buildState(Eigen::Vector3d::Zero(), 0., 0.3);
+	dwl::ReducedBodyTrajectory rollout(2, state);
+	rollout[1].com_pos << 0.1, 0., 0.;
+	rollout[1].time = 1.2;
+	std::vector<dwl::simulation::PreviewParams> params(2,
+			dwl::simulation::PreviewParams(0.2, Eigen::Vector2d::Zero()));
+	cache.add(command, schedule, state, dwl::simulation::PreviewControl(params), rollout);
+	dwl::simulation::VelocityCommand near_command(Eigen::Vector2d(0.31, 0.), 0.);
+	BOOST_CHECK(cache.lookup(control, near_command, schedule));
+	BOOST_CHECK_EQUAL(control.params.size(), 2);
+	BOOST_CHECK(!cache.lookup(control,
+			dwl::simulation::VelocityCommand(Eigen::Vector2d(0.5, 0.), 0.), schedule));
+
+	// The cycles of other actual phase have other key
+	dwl::simulation::PreviewSchedule next_schedule = buildTrotSchedule();
+	next_schedule.init(1);
+	BOOST_CHECK(cache.computeKey(command, schedule) != cache.computeKey(command, next_schedule));
+
+	// The fast path aligns the rollout to a near state in other place and heading
+	dwl::simulation::PreviewControl cycle_control;
+	dwl::ReducedBodyTrajectory cycle;
+	dwl::ReducedBodyState actual_state = buildState(Eigen::Vector3d(1., 2., 0.), M_PI_2, 0.3);
+	actual_state.time = 3.;
+	BOOST_CHECK(cache.lookupCycle(cycle_control, cycle, command, schedule, actual_state));
+	BOOST_CHECK_EQUAL(cycle.size(), 2);
+	BOOST_CHECK_SMALL((cycle[1].com_pos - Eigen::Vector3d(1., 2.1, 0.)).norm(), 1e-9);
+	BOOST_CHECK_CLOSE(cycle[1].time, 3.2, 1e-6);
+
+	// The farther states aren't served by the fast path
+	BOOST_CHECK(!cache.lookupCycle(cycle_control, cycle, command, schedule,
+			buildState(Eigen::Vector3d::Zero(), 0., 0.5)));
+	BOOST_CHECK_EQUAL(cache.getNumberOfHits(), 2);
+	BOOST_CHECK_EQUAL(cache.getNumberOfMisses(), 3);
+
+	// The least recently used cycle is removed first
+	cache.add(dwl::simulation::VelocityCommand(Eigen::Vector2d(0.5, 0.), 0.), schedule,
+			  state, control, rollout);
+	cache.lookup(control, command, schedule);
+	cache.add(dwl::simulation::VelocityCommand(Eigen::Vector2d(0.7, 0.), 0.), schedule,
+			  state, control, rollout);
+	BOOST_CHECK_EQUAL(cache.size(), 2);
+	BOOST_CHECK(cache.lookup(control, command, schedule));
+	BOOST_CHECK(!cache.lookup(control,
+			dwl::simulation::VelocityCommand(Eigen::Vector2d(0.5, 0.), 0.), schedule));
+}
@@ -0,0 +1,85 @@
+#include <dwl/solver/QuadProg++QP.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 1e-6;
+
+BOOST_AUTO_TEST_CASE(quadprog_qp) // specify a test case for the QuadProg++ solver
+{
+	// min (x0 - 1)^2 + (x1 - 2)^2 s.t. -2 <= -x0 - x1, x >= 0
+	Eigen::MatrixXd hessian = 2. * Eigen::MatrixXd::Identity(2,2);
+	Eigen::VectorXd gradient(2);
+	gradient << -2., -4.;
+	Eigen::MatrixXd constraint_mat(1,2);
+	constraint_mat << -1., -1.;
+	Eigen::VectorXd lower_constraint(1), upper_constraint(1);
+	lower_constraint << -2.;
+	upper_constraint << 1e19;
+	Eigen::VectorXd lower_bound = Eigen::VectorXd::Zero(2);
+	Eigen::VectorXd upper_bound = 1e19 * Eigen::VectorXd::Ones(2);
+
+	dwl::solver::QuadProgQP solver;
+	BOOST_CHECK(solver.compute(hessian, gradient, constraint_mat,
+							   lower_bound, upper_bound,
+							   lower_constraint, upper_constraint, 0.));
+	Eigen::VectorXd solution = solver.getOptimalSolution();
+	BOOST_CHECK_SMALL(solution(0) - 0.5, epsilon);
+	BOOST_CHECK_SMALL(solution(1) - 1.5, epsilon);
+	BOOST_CHECK_EQUAL(solver.getActiveSet().size(), 1);
+
+	// Fixing the first variable, i.e. an equality bound
+	upper_bound(0) = 0.;
+	BOOST_CHECK(solver.compute(hessian, gradient, constraint_mat,
+							   lower_bound, upper_bound,
+							   lower_constraint, upper_constraint, 0.));
+	solution = solver.getOptimalSolution();
+	BOOST_CHECK_SMALL(solution(0), epsilon);
+	BOOST_CHECK_SMALL(solution(1) - 2., epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(quadprog_qp_persistent) // specify a test case for the warm-started solves
+{
+	// Solving a sequence of QPs with a constant Hessian, e.g. min |x - r|^2 s.t. a box and a
+	// sum constraint, where the warm-started solutions are the ones from scratch
+	unsigned int n = 6;
+	Eigen::MatrixXd hessian = Eigen::MatrixXd::Identity(n,n);
+	hessian += 0.1 * Eigen::MatrixXd::Ones(n,n);
+	Eigen::MatrixXd constraint_mat = Eigen::MatrixXd::Ones(1,n);
+	Eigen::VectorXd lower_constraint(1), upper_constraint(1);
+	lower_constraint << -1.;
+	upper_constraint << 1.;
+	Eigen::VectorXd lower_bound = -0.5 * Eigen::VectorXd::Ones(n);
+	Eigen::VectorXd upper_bound = 0.5 * Eigen::VectorXd::Ones(n);
+
+	dwl::solver::QuadProgQP persistent_solver, solver;
+	persistent_solver.setPersistentFactorization(true);
+	for (unsigned int k = 0; k < 20; k++) {
+		Eigen::VectorXd gradient(n);
+		for (unsigned int i = 0; i < n; i++)
+			gradient(i) = sin(0.3 * k + i);
+
+		if (k == 0)
+			BOOST_CHECK(!persistent_solver.hotstart(gradient,
+													lower_bound, upper_bound,
+													lower_constraint, upper_constraint, 0.));
+		if (k % 2 == 0)
+			BOOST_CHECK(persistent_solver.compute(hessian, gradient, constraint_mat,
+												  lower_bound, upper_bound,
+												  lower_constraint, upper_constraint, 0.));
+		else
+			BOOST_CHECK(persistent_solver.hotstart(gradient,
+												   lower_bound, upper_bound,
+												   lower_constraint, upper_constraint, 0.));
+		BOOST_CHECK(solver.compute(hessian, gradient, constraint_mat,
+								   lower_bound, upper_bound,
+								   lower_constraint, upper_constraint, 0.));
+		BOOST_CHECK_SMALL((persistent_solver.getOptimalSolution() -
+				solver.getOptimalSolution()).norm(), epsilon);
+	}
+}
@@ -0,0 +1,119 @@
+#include <dwl/solver/RiccatiInteriorPoint.h>
+#include <dwl/solver/ADMMQP.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 0.001;
+
+// Condenses the double integrator problem, i.e. x = A_bar x0 + B_bar u
+void condense(Eigen::MatrixXd& hessian, Eigen::VectorXd& gradient,
+			  Eigen::MatrixXd& B_bar, Eigen::VectorXd& free_response,
+			  const Eigen::MatrixXd& A, const Eigen::MatrixXd& B,
+			  const Eigen::MatrixXd& Q, const Eigen::MatrixXd& R,
+			  const Eigen::VectorXd& x0, unsigned int horizon)
+{
+	unsigned int n = A.rows(), m = B.cols();
+	B_bar = Eigen::MatrixXd::Zero(horizon * n, horizon * m);
+	free_response = Eigen::VectorXd::Zero(horizon * n);
+	Eigen::MatrixXd Q_bar = Eigen::MatrixXd::Zero(horizon * n, horizon * n);
+	Eigen::VectorXd x = x0;
+	for (unsigned int i = 0; i < horizon; i++) {
+		x = A * x;
+		free_response.segment(i * n, n) = x;
+		Q_bar.block(i * n, i * n, n, n) = Q;
+		for (unsigned int j = 0; j <= i; j++) {
+			Eigen::MatrixXd A_pow = Eigen::MatrixXd::Identity(n, n);
+			for (unsigned int l = 0; l < i - j; l++)
+				A_pow = A_pow * A;
+			B_bar.block(i * n, j * m, n, m) = A_pow * B;
+		}
+	}
+	Eigen::MatrixXd R_bar = Eigen::MatrixXd::Zero(horizon * m, horizon * m);
+	for (unsigned int i = 0; i < horizon; i++)
+		R_bar.block(i * m, i * m, m, m) = R;
+
+	hessian = B_bar.transpose() * Q_bar * B_bar + R_bar;
+	gradient = B_bar.transpose() * Q_bar * free_response;
+}
+
+
+BOOST_AUTO_TEST_CASE(riccati_interior_point) // specify a test case for the Riccati solver
+{
+	// Double integrator with a horizon of 20 stages
+	unsigned int horizon = 20;
+	double dt = 0.1;
+	Eigen::MatrixXd A(2,2), B(2,1);
+	A << 1., dt, 0., 1.;
+	B << 0.5 * dt * dt, dt;
+	Eigen::MatrixXd Q = Eigen::MatrixXd::Identity(2,2);
+	Eigen::MatrixXd R = 0.01 * Eigen::MatrixXd::Identity(1,1);
+	Eigen::VectorXd x0(2);
+	x0 << 1., 0.;
+
+	dwl::solver::RiccatiInteriorPoint solver;
+	solver.init(2, 1, horizon, 0);
+	solver.setDynamics(A, B);
+	for (unsigned int k = 0; k < horizon; k++)
+		solver.setCost(k, Q, R, Eigen::MatrixXd::Zero(1,2),
+					   Eigen::VectorXd::Zero(2), Eigen::VectorXd::Zero(1));
+	solver.setTerminalCost(Q, Eigen::VectorXd::Zero(2));
+
+	// The unconstrained solution is the one of the condensed QP. Note that the stage cost of
+	// the initial state is constant
+	Eigen::MatrixXd hessian, B_bar;
+	Eigen::VectorXd gradient, free_response;
+	condense(hessian, gradient, B_bar, free_response, A, B, Q, R, x0, horizon);
+	Eigen::VectorXd expected = -hessian.ldlt().solve(gradient);
+	BOOST_CHECK(solver.compute(x0));
+	BOOST_CHECK_SMALL((solver.getOptimalInputs() - expected).lpNorm<Eigen::Infinity>(), epsilon);
+
+	// Bounding the inputs and the velocity
+	solver.init(2, 1, horizon, 2);
+	solver.setDynamics(A, B);
+	for (unsigned int k = 0; k < horizon; k++) {
+		Eigen::MatrixXd C(2,2), D(2,1);
+		C << 0., 1., 0., 0.;
+		D << 0., 1.;
+		Eigen::VectorXd lb(2), ub(2);
+		lb << -0.4, -2.;
+		ub << 0.4, 2.;
+		solver.setCost(k, Q, R, Eigen::MatrixXd::Zero(1,2),
+					   Eigen::VectorXd::Zero(2), Eigen::VectorXd::Zero(1));
+		solver.setConstraints(k, C, D, lb, ub);
+	}
+	solver.setTerminalCost(Q, Eigen::VectorXd::Zero(2));
+	BOOST_CHECK(solver.compute(x0));
+
+	// Comparing the solution with the one of the condensed QP
+	unsigned int variables = horizon;
+	Eigen::MatrixXd constraint_mat = Eigen::MatrixXd::Zero(horizon, variables);
+	Eigen::VectorXd lbG(horizon), ubG(horizon);
+	for (unsigned int i = 0; i < horizon - 1; i++) {
+		// Velocity of the stages 1 to N-1
+		constraint_mat.row(i) = B_bar.row(2 * i + 1);
+		lbG(i) = -0.4 - free_response(2 * i + 1);
+		ubG(i) = 0.4 - free_response(2 * i + 1);
+	}
+	lbG(horizon - 1) = -1e20;
+	ubG(horizon - 1) = 1e20;
+	dwl::solver::ADMMQP qp;
+	qp.init(variables, horizon);
+	qp.setParameters(1., 1.6, 100000);
+	qp.setTolerances(1e-8, 1e-8);
+	BOOST_CHECK(qp.compute(hessian, gradient, constraint_mat,
+						   Eigen::VectorXd::Constant(variables, -2.),
+						   Eigen::VectorXd::Constant(variables, 2.),
+						   lbG, ubG, 0.));
+	BOOST_CHECK_SMALL((solver.getOptimalInputs() -
+			qp.getOptimalSolution()).lpNorm<Eigen::Infinity>(), epsilon);
+	for (unsigned int k = 0; k < horizon; k++) {
+		BOOST_CHECK(fabs(solver.getOptimalState(k)(1)) <= 0.4 + epsilon);
+		BOOST_CHECK(fabs(solver.getOptimalInput(k)(0)) <= 2. + epsilon);
+	}
+	BOOST_CHECK(solver.getNumberOfIterations() < 50);
+}
@@ -0,0 +1,41 @@
+#include <dwl/robot/Robot.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+BOOST_AUTO_TEST_CASE(robot_search_areas) // specify a test case for the precomputed search areas
+{
+	dwl::robot::Robot robot;
+	robot.read(DWL_SOURCE_DIR"/config/hyq_planning.yaml");
+
+	// The search areas are the search window around the stance of the action
+	Eigen::Vector3d action(0.1, 0., 0.);
+	dwl::Vector3dMap stance = robot.getStance(action);
+	const dwl::SearchAreaMap& areas = robot.getFootstepSearchAreas(action);
+	BOOST_CHECK_EQUAL(areas.size(), 4);
+	for (dwl::SearchAreaMap::const_iterator area_it = areas.begin();
+			area_it != areas.end(); area_it++) {
+		const dwl::SearchArea& area = area_it->second;
+		BOOST_CHECK_CLOSE(area.min_x, stance[area_it->first](0) - 0.12, 1e-9);
+		BOOST_CHECK_CLOSE(area.max_y, stance[area_it->first](1) + 0.08, 1e-9);
+	}
+	BOOST_CHECK_CLOSE(robot.getFootstepSearchSize(-action).find(0)->second.max_x, -0.12, 1e-9);
+
+	// The cells of a heading are the robot-frame cells rotated by its yaw
+	Eigen::Matrix2Xd points = robot.getFootstepSearchCells(action).points;
+	BOOST_CHECK_EQUAL(points.cols(), 4 * 7 * 5);
+	double yaw = 2 * M_PI / robot.getNumberOfHeadings();
+	Eigen::Matrix2d rotation;
+	rotation << cos(yaw), -sin(yaw), sin(yaw), cos(yaw);
+	const dwl::SearchAreaCells& heading_cells = robot.getFootstepSearchCells(action, yaw);
+	BOOST_CHECK_SMALL((heading_cells.points - rotation * points).norm(), 1e-12);
+
+	// The yaws between the headings are rotated in the query
+	rotation << cos(0.1), -sin(0.1), sin(0.1), cos(0.1);
+	const dwl::SearchAreaCells& cells = robot.getFootstepSearchCells(action, 0.1);
+	BOOST_CHECK_SMALL((cells.points - rotation * points).norm(), 1e-12);
+	BOOST_CHECK_EQUAL(cells.corners.cols(), 16);
+	BOOST_CHECK_EQUAL(cells.sizes[2], 35);
+}
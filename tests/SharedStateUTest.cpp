@@ -0,0 +1,107 @@
+#include <dwl/SharedState.h>
+#include <thread>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(shared_whole_body_state) // specify a test case for shared whole-body states
+{
+	dwl::rbd::BodySelector contacts;
+	contacts.push_back("lf_foot");
+	contacts.push_back("rf_foot");
+	dwl::StateSchema schema(3, contacts);
+
+	dwl::SharedStatePublisher publisher;
+	BOOST_REQUIRE(publisher.create("/dwl_whole_body_state_utest", schema,
+								   dwl::shared_state::WholeBodyKind));
+
+	// The schema is read from the segment, and there isn't a state before the first publication
+	dwl::SharedStateSubscriber subscriber;
+	BOOST_REQUIRE(subscriber.open("/dwl_whole_body_state_utest"));
+	BOOST_CHECK_EQUAL(subscriber.getSchema().getJointDoF(), 3);
+	BOOST_CHECK(subscriber.getSchema().getNames() == contacts);
+	BOOST_CHECK(subscriber.getKind() == dwl::shared_state::WholeBodyKind);
+	BOOST_CHECK(!subscriber.hasNewState());
+	dwl::WholeBodyState read_state;
+	BOOST_CHECK(!subscriber.read(read_state));
+
+	// Publishing a state, where the second contact only has a wrench
+	dwl::WholeBodyState state;
+	state.setJointDoF(3);
+	state.time = 0.5;
+	state.base_pos = dwl::rbd::Vector6d::Constant(2.);
+	state.joint_pos = Eigen::Vector3d(1., 2., 3.);
+	state.joint_eff = Eigen::Vector3d(-1., -2., -3.);
+	state.contact_pos["lf_foot"] = Eigen::Vector3d(0.3, 0.2, -0.5);
+	state.contact_eff["rf_foot"] = dwl::rbd::Vector6d::Constant(10.);
+	BOOST_CHECK(publisher.publish(state));
+	BOOST_CHECK(!publisher.publish(dwl::ReducedBodyState()));
+	BOOST_CHECK_EQUAL(publisher.getNumberOfPublications(), 1);
+
+	BOOST_CHECK(subscriber.hasNewState());
+	BOOST_CHECK(subscriber.read(read_state));
+	BOOST_CHECK(!subscriber.hasNewState());
+	BOOST_CHECK_EQUAL(read_state.time, 0.5);
+	BOOST_CHECK(read_state.base_pos.isApprox(state.base_pos));
+	BOOST_CHECK(read_state.joint_eff.isApprox(state.joint_eff));
+	BOOST_CHECK(read_state.contact_pos["lf_foot"].isApprox(state.contact_pos["lf_foot"]));
+	BOOST_CHECK(read_state.contact_eff["rf_foot"].isApprox(state.contact_eff["rf_foot"]));
+	BOOST_CHECK_EQUAL(read_state.contact_pos.count("rf_foot"), 0);
+	BOOST_CHECK_EQUAL(read_state.contact_eff.count("lf_foot"), 0);
+
+	// The reduced-body states cannot be read from a whole-body segment
+	dwl::ReducedBodyState reduced_state;
+	BOOST_CHECK(!subscriber.read(reduced_state));
+
+	subscriber.close();
+	publisher.close();
+	BOOST_CHECK(!subscriber.open("/dwl_whole_body_state_utest"));
+}
+
+
+BOOST_AUTO_TEST_CASE(shared_reduced_body_state) // specify a test case for concurrent publications
+{
+	dwl::rbd::BodySelector feet;
+	feet.push_back("lf_foot");
+	dwl::StateSchema schema(0, feet);
+
+	dwl::SharedStatePublisher publisher;
+	BOOST_REQUIRE(publisher.create("/dwl_reduced_body_state_utest", schema,
+								   dwl::shared_state::ReducedBodyKind));
+	dwl::SharedStateSubscriber subscriber;
+	BOOST_REQUIRE(subscriber.open("/dwl_reduced_body_state_utest"));
+
+	// Publishing states where all the quantities are equal to the time, so a torn read
+	// would have different values
+	std::thread writer([&publisher]() {
+		dwl::ReducedBodyState state;
+		for (unsigned int k = 1; k <= 20000; k++) {
+			double value = k;
+			state.time = value;
+			state.com_pos.setConstant(value);
+			state.cop.setConstant(value);
+			state.foot_pos["lf_foot"] = Eigen::Vector3d::Constant(value);
+			publisher.publish(state);
+		}
+	});
+
+	bool consistent = true;
+	double last_time = 0.;
+	dwl::ReducedBodyState state;
+	while (last_time < 20000.) {
+		if (!subscriber.read(state))
+			continue;
+
+		consistent = consistent &&
+				state.com_pos.isConstant(state.time) &&
+				state.cop.isConstant(state.time) &&
+				state.foot_pos["lf_foot"].isConstant(state.time) &&
+				state.time >= last_time;
+		last_time = state.time;
+	}
+	writer.join();
+	BOOST_CHECK(consistent);
+	BOOST_CHECK_EQUAL(publisher.getNumberOfPublications(), 20000);
+}
@@ -0,0 +1,156 @@
+#include <dwl/SolveSnapshot.h>
+#include <dwl/simulation/PreviewLocomotion.h>
+#include <cstdio>
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+BOOST_AUTO_TEST_CASE(snapshot_states) // specify a test case for the encoding of the states
+{
+	dwl::WholeBodyState ws(3);
+	ws.time = 0.5;
+	ws.setBasePosition(Eigen::Vector3d(0.1, 0.2, 0.6));
+	ws.setJointPosition(Eigen::Vector3d(0.7, -1.4, 0.2));
+	ws.setContactPosition_B("lf_foot", Eigen::Vector3d(0.3, 0.2, -0.5));
+	ws.contact_eff["lf_foot"] = dwl::rbd::Vector6d::Constant(2.);
+
+	dwl::ReducedBodyState rs;
+	rs.com_pos << 0.1, 0., 0.55;
+	rs.cop << 0.05, 0.02, 0.;
+	rs.support_region["rh_foot"] = Eigen::Vector3d(-0.3, -0.2, 0.);
+
+	dwl::Pose pose;
+	pose.position << 1., 2., 0.5;
+	pose.orientation = Eigen::Quaterniond(Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitZ()));
+
+	dwl::SnapshotEncoder encoder;
+	encoder.writeState(ws);
+	encoder.writeState(rs);
+	encoder.writePose(pose);
+	encoder.writeString("stairs");
+
+	// The decoded values are equal to the encoded ones
+	dwl::SnapshotDecoder decoder(encoder.getData().data(), encoder.getData().size());
+	dwl::WholeBodyState decoded_ws;
+	dwl::ReducedBodyState decoded_rs;
+	dwl::Pose decoded_pose;
+	std::string name;
+	BOOST_CHECK(decoder.readState(decoded_ws));
+	BOOST_CHECK(decoder.readState(decoded_rs));
+	BOOST_CHECK(decoder.readPose(decoded_pose));
+	BOOST_CHECK(decoder.readString(name));
+	BOOST_CHECK(decoder.isValid());
+	BOOST_CHECK_EQUAL(decoder.getRemainingBytes(), 0);
+
+	BOOST_CHECK_EQUAL(decoded_ws.getJointDoF(), 3);
+	BOOST_CHECK_EQUAL(decoded_ws.time, 0.5);
+	BOOST_CHECK(decoded_ws.base_pos.isApprox(ws.base_pos));
+	BOOST_CHECK(decoded_ws.joint_pos.isApprox(ws.joint_pos));
+	BOOST_CHECK(decoded_ws.contact_pos["lf_foot"].isApprox(ws.contact_pos["lf_foot"]));
+	BOOST_CHECK(decoded_ws.contact_eff["lf_foot"].isApprox(ws.contact_eff["lf_foot"]));
+	BOOST_CHECK(decoded_rs.com_pos.isApprox(rs.com_pos));
+	BOOST_CHECK(decoded_rs.support_region["rh_foot"].isApprox(rs.support_region["rh_foot"]));
+	BOOST_CHECK(decoded_pose.position.isApprox(pose.position));
+	BOOST_CHECK(decoded_pose.orientation.isApprox(pose.orientation));
+	BOOST_CHECK_EQUAL(name, "stairs");
+
+	// A truncated payload invalidates the decoder
+	dwl::SnapshotDecoder truncated(encoder.getData().data(), encoder.getData().size() - 4);
+	BOOST_CHECK(truncated.readState(decoded_ws));
+	BOOST_CHECK(truncated.readState(decoded_rs));
+	BOOST_CHECK(truncated.readPose(decoded_pose));
+	BOOST_CHECK(!truncated.readString(name));
+	BOOST_CHECK(!truncated.isValid());
+}
+
+
+BOOST_AUTO_TEST_CASE(snapshot_preview_control) // specify a test case for the preview controls
+{
+	dwl::simulation::PreviewControl control;
+	control.params.push_back(dwl::simulation::PreviewParams(0.2, Eigen::Vector2d(0.01, 0.)));
+	dwl::simulation::PreviewParams swing(1, 0.3, Eigen::Vector2d(0., 0.02));
+	swing.phase = dwl::simulation::PreviewPhase(dwl::simulation::STANCE,
+												dwl::rbd::BodySelector(1, "lf_foot"));
+	swing.phase.setFootShift("lf_foot", Eigen::Vector2d(0.1, 0.));
+	control.params.push_back(swing);
+
+	dwl::SnapshotEncoder encoder;
+	encoder.writePreviewControl(control);
+	encoder.writeVelocityCommand(dwl::simulation::VelocityCommand(Eigen::Vector2d(0.3, 0.), 0.1));
+
+	dwl::SnapshotDecoder decoder(encoder.getData().data(), encoder.getData().size());
+	dwl::simulation::PreviewControl decoded;
+	dwl::simulation::VelocityCommand command;
+	BOOST_CHECK(decoder.readPreviewControl(decoded));
+	BOOST_CHECK(decoder.readVelocityCommand(command));
+	BOOST_REQUIRE_EQUAL(decoded.params.size(), 2);
+	BOOST_CHECK_EQUAL(decoded.params[1].id, 1);
+	BOOST_CHECK_EQUAL(decoded.params[1].duration, 0.3);
+	BOOST_CHECK(decoded.params[1].phase.doStep());
+	BOOST_CHECK(decoded.params[1].phase.isSwingFoot("lf_foot"));
+	BOOST_CHECK(!decoded.params[0].phase.isSwingFoot("lf_foot"));
+	BOOST_CHECK(decoded.params[1].phase.getFootShift("lf_foot").isApprox(Eigen::Vector2d(0.1, 0.)));
+	BOOST_CHECK_EQUAL(command.angular, 0.1);
+}
+
+
+BOOST_AUTO_TEST_CASE(snapshot_file) // specify a test case for the recording of snapshot files
+{
+	std::string filename = "solve_snapshot_utest.snap";
+	dwl::SnapshotRecorder recorder;
+	recorder.setMaxRecords(2);
+	BOOST_REQUIRE(recorder.open(filename));
+	BOOST_CHECK(recorder.isRecording());
+
+	dwl::SnapshotEncoder encoder;
+	encoder.writeDouble(1.5);
+	BOOST_CHECK(recorder.record(dwl::solve_snapshot::HierarchicalPlanningKind, encoder));
+	encoder.clear();
+	encoder.writeVector(Eigen::VectorXd::LinSpaced(4, 0., 3.));
+	BOOST_CHECK(recorder.record(dwl::solve_snapshot::WholeBodyTrajectoryOptimizationKind,
+								encoder));
+
+	// The recording stops after the maximum number of records
+	BOOST_CHECK(!recorder.isRecording());
+	BOOST_CHECK(!recorder.record(dwl::solve_snapshot::HierarchicalPlanningKind, encoder));
+	recorder.close();
+	BOOST_CHECK_EQUAL(recorder.getNumberOfRecords(), 2);
+
+	dwl::SnapshotReader reader;
+	BOOST_REQUIRE(reader.open(filename));
+	BOOST_REQUIRE_EQUAL(reader.getNumberOfRecords(), 2);
+	BOOST_CHECK(!reader.isTruncated());
+	BOOST_CHECK_EQUAL(reader.getHeader(0).kind, dwl::solve_snapshot::HierarchicalPlanningKind);
+	BOOST_CHECK_EQUAL(reader.getHeader(1).sequence, 1);
+	double value = 0.;
+	dwl::SnapshotDecoder first = reader.getPayload(0);
+	BOOST_CHECK(first.readDouble(value));
+	BOOST_CHECK_EQUAL(value, 1.5);
+	Eigen::VectorXd vector;
+	dwl::SnapshotDecoder second = reader.getPayload(1);
+	BOOST_CHECK(second.readVector(vector));
+	BOOST_CHECK_EQUAL(vector.size(), 4);
+	BOOST_CHECK_EQUAL(vector(3), 3.);
+
+	// A fixed-size vector of a different size invalidates the decoder
+	Eigen::Vector3d fixed;
+	dwl::SnapshotDecoder mismatched = reader.getPayload(1);
+	BOOST_CHECK(!mismatched.readVector(fixed));
+
+	// A truncated last record (e.g. of a crashed process) is ignored
+	FILE* file = fopen(filename.c_str(), "r+b");
+	BOOST_REQUIRE(file != NULL);
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fclose(file);
+	BOOST_REQUIRE(truncate(filename.c_str(), size - 8) == 0);
+	BOOST_REQUIRE(reader.open(filename));
+	BOOST_CHECK_EQUAL(reader.getNumberOfRecords(), 1);
+	BOOST_CHECK(reader.isTruncated());
+	remove(filename.c_str());
+
+	BOOST_CHECK(!reader.open(filename));
+}
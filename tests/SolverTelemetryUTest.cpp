@@ -0,0 +1,58 @@
+#include <dwl/solver/SolverTelemetry.h>
+#include <cstdio>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(solver_telemetry) // specify a test case for the telemetry stream
+{
+	std::string filename = "dwl_solver_telemetry.bin";
+	dwl::solver::SolverTelemetry telemetry;
+	BOOST_CHECK(!telemetry.recordIteration(dwl::solver::TelemetryIteration()));
+	BOOST_CHECK(telemetry.open(filename));
+
+	// Recording two solves, where every iteration evaluates the cost twice and its gradient
+	const unsigned int num_iterations = 10;
+	for (unsigned int solve = 0; solve < 2; solve++) {
+		telemetry.startSolve();
+		for (unsigned int k = 0; k < num_iterations; k++) {
+			{
+				dwl::solver::SolverTelemetry::ScopedEvaluation
+						timer(&telemetry, dwl::solver::CostEvaluation);
+			}
+			telemetry.recordEvaluation(dwl::solver::CostEvaluation, 1e-3);
+			telemetry.recordEvaluation(dwl::solver::GradientEvaluation, 2e-3);
+
+			dwl::solver::TelemetryIteration iteration;
+			iteration.iteration = k;
+			iteration.objective = 1. / (k + 1);
+			iteration.violation = 1e-2 * (num_iterations - k);
+			iteration.step_size = 0.5;
+			BOOST_CHECK(telemetry.recordIteration(iteration));
+		}
+	}
+	telemetry.close();
+	BOOST_CHECK_EQUAL(telemetry.getNumberOfDroppedRows(), 0);
+
+	dwl::utils::BinaryLogReader reader;
+	BOOST_CHECK(reader.open(filename));
+	BOOST_CHECK_EQUAL(reader.getNumberOfRows(), 2 * num_iterations);
+
+	std::vector<double> solves, objectives, cost_counts, gradient_times, hessian_counts;
+	reader.readChannel(solves, reader.getChannelIndex("solve"));
+	reader.readChannel(objectives, reader.getChannelIndex("objective"));
+	reader.readChannel(cost_counts, reader.getChannelIndex("cost_count"));
+	reader.readChannel(gradient_times, reader.getChannelIndex("gradient_time"));
+	reader.readChannel(hessian_counts, reader.getChannelIndex("hessian_count"));
+	for (unsigned int k = 0; k < 2 * num_iterations; k++) {
+		BOOST_CHECK_EQUAL(solves[k], k < num_iterations ? 1. : 2.);
+		BOOST_CHECK_EQUAL(objectives[k], 1. / (k % num_iterations + 1));
+		BOOST_CHECK_EQUAL(cost_counts[k], 2.);
+		BOOST_CHECK_CLOSE(gradient_times[k], 2e-3, 1e-3);
+		BOOST_CHECK_EQUAL(hessian_counts[k], 0.);
+	}
+	reader.close();
+	remove(filename.c_str());
+}
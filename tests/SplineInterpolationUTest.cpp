@@ -0,0 +1,56 @@
+#include <dwl/utils/SplineInterpolation.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+BOOST_AUTO_TEST_CASE(multi_knot_cubic_spline) // specify a test case for the global spline
+{
+	// Sampling a cubic and a parabola in non-uniform knots
+	Eigen::VectorXd times(5);
+	times << 0., 0.1, 0.35, 0.5, 0.9;
+	Eigen::MatrixXd positions(2, times.size());
+	for (unsigned int k = 0; k < times.size(); k++) {
+		double t = times(k);
+		positions(0, k) = 1. - 2. * t + 3. * t * t - t * t * t;
+		positions(1, k) = t * t;
+	}
+	Eigen::VectorXd start_vel(2), end_vel(2);
+	start_vel << -2., 0.;
+	end_vel << -2. + 6. * 0.9 - 3. * 0.81, 1.8;
+
+	// The clamped spline reproduces the polynomials in every segment
+	dwl::math::MultiKnotCubicSpline spline;
+	BOOST_CHECK(spline.fit(times, positions, start_vel, end_vel));
+	BOOST_CHECK_EQUAL(spline.getNumberOfChannels(), 2);
+	BOOST_CHECK_EQUAL(spline.getNumberOfKnots(), 5);
+	Eigen::VectorXd pos, vel, acc;
+	double t = 0.42;
+	BOOST_CHECK(spline.getPoint(t, pos, vel, acc));
+	BOOST_CHECK_SMALL(pos(0) - (1. - 2. * t + 3. * t * t - t * t * t), 1e-10);
+	BOOST_CHECK_SMALL(vel(0) - (-2. + 6. * t - 3. * t * t), 1e-10);
+	BOOST_CHECK_SMALL(acc(0) - (6. - 6. * t), 1e-10);
+	BOOST_CHECK_SMALL(acc(1) - 2., 1e-10);
+
+	// The times out of the knots are rejected or saturated
+	BOOST_CHECK(!spline.getPoint(-0.1, pos));
+	BOOST_CHECK(spline.getPoint(1.5, pos));
+	BOOST_CHECK_SMALL((pos - positions.col(4)).norm(), 1e-10);
+
+	// The natural spline has zero accelerations at the boundaries, and it's continuous in
+	// the knots
+	BOOST_CHECK(spline.fit(times, positions));
+	spline.getPoint(0., pos, vel, acc);
+	BOOST_CHECK_SMALL(acc.norm(), 1e-10);
+	Eigen::VectorXd pos_before, vel_before, acc_before;
+	spline.getPoint(0.35 - 1e-9, pos_before, vel_before, acc_before);
+	spline.getPoint(0.35, pos, vel, acc);
+	BOOST_CHECK_SMALL((pos - positions.col(2)).norm(), 1e-10);
+	BOOST_CHECK_SMALL((vel - vel_before).norm(), 1e-6);
+	BOOST_CHECK_SMALL((acc - acc_before).norm(), 1e-6);
+
+	// The knot times have to be increasing
+	times(2) = 0.1;
+	BOOST_CHECK(!spline.fit(times, positions));
+}
@@ -183,3 +183,53 @@ BOOST_AUTO_TEST_CASE(line_support) // specify a test case for line region
 		}
 	}
 }
+
+
+BOOST_AUTO_TEST_CASE(ordered_support) // specify a test case for ordered support region
+{
+	// Declaring the constraints, where the second one uses the fixed-size kernel
+	dwl::ocp::SupportPolygonConstraint constraint, ordered_constraint;
+	ordered_constraint.setOrderedVertexes(true);
+
+	// Defining the squared support region in counter-clockwise order
+	double dim = 1.;
+	std::vector<Eigen::Vector3d> support;
+	support.push_back(Eigen::Vector3d(0., 0., 0.));
+	support.push_back(Eigen::Vector3d(dim, 0., 0.));
+	support.push_back(Eigen::Vector3d(dim, dim, 0.));
+	support.push_back(Eigen::Vector3d(0., dim, 0.));
+	double margin = 0.05;
+
+	// The margins and gradients are the ones of the sorted polygon
+	Eigen::Vector3d point(0.3, 0.6, 0.);
+	dwl::ocp::PolygonState state(point, support, margin);
+	Eigen::VectorXd value, ordered_value;
+	Eigen::MatrixXd gradient, ordered_gradient;
+	constraint.compute(value, state);
+	ordered_constraint.compute(ordered_value, state);
+	constraint.computeGradient(gradient, state);
+	ordered_constraint.computeGradient(ordered_gradient, state);
+	BOOST_REQUIRE_EQUAL(ordered_value.size(), 4);
+	BOOST_CHECK_CLOSE(ordered_value.minCoeff(), value.minCoeff(), 1e-9);
+	BOOST_CHECK_CLOSE(ordered_value.sum(), value.sum(), 1e-9);
+	BOOST_CHECK_CLOSE(ordered_gradient.cwiseAbs().sum(), gradient.cwiseAbs().sum(), 1e-9);
+
+	// The gradients of the kernel match the finite differences
+	dwl::ocp::SupportPolygonConstraint::KernelVertexes vertexes;
+	vertexes << 0., dim, dim, 0.,
+				0., 0., dim, dim;
+	Eigen::Vector4d margins, margins_eps;
+	Eigen::Matrix<double,4,2> point_grad, point_grad_eps;
+	Eigen::Matrix<double,4,8> vertex_grad, vertex_grad_eps;
+	dwl::ocp::SupportPolygonConstraint::computeMargins(margins, point_grad, vertex_grad,
+													   point.head<2>(), vertexes, 4, margin);
+	double eps = 1e-6;
+	for (unsigned int k = 0; k < 8; k++) {
+		dwl::ocp::SupportPolygonConstraint::KernelVertexes vertexes_eps = vertexes;
+		vertexes_eps(k % 2, k / 2) += eps;
+		dwl::ocp::SupportPolygonConstraint::computeMargins(margins_eps, point_grad_eps,
+														   vertex_grad_eps, point.head<2>(),
+														   vertexes_eps, 4, margin);
+		BOOST_CHECK_SMALL(((margins_eps - margins) / eps - vertex_grad.col(k)).norm(), 1e-4);
+	}
+}
@@ -0,0 +1,47 @@
+#include <dwl/utils/TaskScheduler.h>
+#include <atomic>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(task_scheduler) // specify a test case for the task scheduler
+{
+	// Every index of a region is run once
+	dwl::utils::TaskScheduler scheduler(3);
+	BOOST_CHECK_EQUAL(scheduler.getNumberOfWorkers(), 3);
+	BOOST_CHECK(!scheduler.isWorkerThread());
+	std::vector<unsigned int> num_runs(1000, 0);
+	scheduler.parallelFor(num_runs.size(), [&num_runs](unsigned int i) { num_runs[i]++; });
+	for (unsigned int i = 0; i < num_runs.size(); i++)
+		BOOST_CHECK_EQUAL(num_runs[i], 1);
+
+	// The nested regions are run by the same workers
+	std::atomic<unsigned int> num_nested_runs(0), num_worker_runs(0);
+	scheduler.parallelFor(8, [&](unsigned int i) {
+		scheduler.parallelFor(50, [&](unsigned int j) {
+			num_nested_runs++;
+			if (scheduler.isWorkerThread())
+				num_worker_runs++;
+		});
+	});
+	BOOST_CHECK_EQUAL(num_nested_runs, 400);
+	BOOST_CHECK(num_worker_runs <= num_nested_runs);
+
+	// The limited regions don't run more threads than the limit
+	std::atomic<int> num_running(0), max_running(0);
+	scheduler.setMaxParallelism(2);
+	BOOST_CHECK_EQUAL(scheduler.getMaxParallelism(), 2);
+	scheduler.parallelFor(100, [&](unsigned int i) {
+		int running = ++num_running;
+		int current_max = max_running;
+		while (running > current_max && !max_running.compare_exchange_weak(current_max, running));
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+		num_running--;
+	});
+	BOOST_CHECK(max_running <= 2);
+
+	// A region without workers is run by the calling thread
+	scheduler.parallelFor(10, [&](unsigned int i) { BOOST_CHECK(!scheduler.isWorkerThread()); }, 1);
+}
@@ -0,0 +1,894 @@
+#include <dwl/environment/TerrainMap.h>
+#include <dwl/environment/TerrainFeaturePipeline.h>
+#include <dwl/environment/CostToGoField.h>
+#include <dwl/environment/LocalTerrainPatch.h>
+#include <dwl/environment/TerrainDistanceField.h>
+#include <dwl/environment/SharedTerrainMap.h>
+#include <dwl/environment/PointCloudTerrainPipeline.h>
+#include <thread>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(terrain_grid) // specify a test case for the tiled terrain grid
+{
+	dwl::environment::TerrainGrid grid;
+	dwl::Key key(32768, 32768, 0);
+	dwl::Key neighbor_key(32769, 32768, 0);
+	dwl::Key far_key(100, 65535, 0);
+	unsigned int cell;
+	BOOST_CHECK(grid.findCell(cell, key) == NULL);
+
+	// Adding cells in two different tiles
+	grid.setCell(key, 0.1, 2., Eigen::Vector3d::UnitX());
+	grid.setCell(neighbor_key, 0.2, 3., Eigen::Vector3d::UnitZ());
+	grid.setCell(far_key, -0.3, 4., Eigen::Vector3d::UnitY());
+	BOOST_CHECK_EQUAL(grid.getNumberOfCells(), 3);
+	BOOST_CHECK_EQUAL(grid.getNumberOfTiles(), 2);
+
+	const dwl::environment::TerrainGrid::Tile* tile = grid.findCell(cell, key);
+	BOOST_REQUIRE(tile != NULL);
+	BOOST_CHECK_EQUAL(tile->height[cell], 0.1);
+	BOOST_CHECK_EQUAL(tile->cost[cell], 2.);
+	BOOST_CHECK(tile->normal[cell] == Eigen::Vector3d::UnitX());
+	tile = grid.findCell(cell, far_key);
+	BOOST_REQUIRE(tile != NULL);
+	BOOST_CHECK_EQUAL(tile->cost[cell], 4.);
+	BOOST_CHECK(grid.findCell(cell, dwl::Key(32770, 32768, 0)) == NULL);
+
+	// Overwriting a cell doesn't add a new one
+	grid.setCell(key, 0.5, 1., Eigen::Vector3d::UnitZ());
+	BOOST_CHECK_EQUAL(grid.getNumberOfCells(), 3);
+	tile = grid.findCell(cell, key);
+	BOOST_CHECK_EQUAL(tile->height[cell], 0.5);
+
+	// Removing the only cell of a tile releases it
+	grid.removeCell(far_key);
+	BOOST_CHECK(grid.findCell(cell, far_key) == NULL);
+	BOOST_CHECK_EQUAL(grid.getNumberOfTiles(), 1);
+	grid.setCell(far_key, 0., 5., Eigen::Vector3d::UnitZ());
+	BOOST_CHECK_EQUAL(grid.getNumberOfTiles(), 2);
+
+	grid.clear();
+	BOOST_CHECK_EQUAL(grid.getNumberOfCells(), 0);
+	BOOST_CHECK(grid.findCell(cell, key) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(terrain_patch) // specify a test case for incremental terrain updates
+{
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int i = 0; i < 4; i++)
+		terrain_data.data.push_back(dwl::TerrainCell(dwl::Key(32768 + i, 32768, 32768), 1., 0.04, 0.));
+	terrain.setTerrainMap(terrain_data);
+	BOOST_CHECK_EQUAL(terrain.getAverageCostOfTerrain(), 1.);
+	terrain.clearDirtyRegion();
+
+	// Updating one cell and adding a new one
+	dwl::TerrainData patch;
+	patch.plane_size = 0.04;
+	patch.height_size = 0.04;
+	patch.data.push_back(dwl::TerrainCell(dwl::Key(32769, 32768, 32768), 3., 0.04, 0.));
+	patch.data.push_back(dwl::TerrainCell(dwl::Key(32769, 32770, 32768), 6., 0.04, 0.));
+	BOOST_CHECK(terrain.updateTerrainMap(patch));
+	BOOST_CHECK_EQUAL(terrain.getTerrainDataMap().size(), 5);
+	BOOST_CHECK_CLOSE(terrain.getAverageCostOfTerrain(), 12. / 5., 1e-9);
+
+	dwl::Vertex vertex;
+	terrain.getTerrainSpaceModel().keyToVertex(vertex, dwl::Key(32769, 32770, 32768), true);
+	BOOST_CHECK_EQUAL(terrain.getTerrainCost(vertex), 6.);
+
+	// Looking up the cost by the keys of the cell
+	dwl::Weight cost;
+	BOOST_CHECK(terrain.getTerrainCost(cost, dwl::Key(32769, 32770, 0)));
+	BOOST_CHECK_EQUAL(cost, 6.);
+	BOOST_CHECK(!terrain.getTerrainCost(cost, dwl::Key(32770, 32770, 0)));
+
+	// Checking the dirty region, which only contains the patch
+	const dwl::CellRegion& region = terrain.getDirtyRegion();
+	BOOST_CHECK(!region.empty);
+	BOOST_CHECK_EQUAL(region.min_key.x, 32769);
+	BOOST_CHECK_EQUAL(region.max_key.x, 32769);
+	BOOST_CHECK_EQUAL(region.min_key.y, 32768);
+	BOOST_CHECK_EQUAL(region.max_key.y, 32770);
+	BOOST_CHECK(!region.contains(dwl::Key(32768, 32768, 0)));
+	terrain.clearDirtyRegion();
+	BOOST_CHECK(terrain.getDirtyRegion().empty);
+}
+
+
+BOOST_AUTO_TEST_CASE(terrain_revision) // specify a test case for the log of terrain changes
+{
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int i = 0; i < 10; i++)
+		terrain_data.data.push_back(dwl::TerrainCell(dwl::Key(32768 + i, 32768, 32768), 1., 0.04, 0.));
+	terrain.setTerrainMap(terrain_data);
+	unsigned long revision = terrain.getRevision();
+
+	dwl::CellRegion near_region, far_region;
+	near_region.add(dwl::Key(32768, 32768, 0));
+	near_region.add(dwl::Key(32770, 32770, 0));
+	far_region.add(dwl::Key(32775, 32768, 0));
+	far_region.add(dwl::Key(32777, 32770, 0));
+	BOOST_CHECK(!terrain.isChangedRegion(near_region, revision));
+	BOOST_CHECK(terrain.isChangedRegion(near_region, revision - 1));
+
+	// An incremental patch only changes its region, and the dirty region doesn't affect the log
+	dwl::TerrainData patch;
+	patch.plane_size = 0.04;
+	patch.height_size = 0.04;
+	patch.data.push_back(dwl::TerrainCell(dwl::Key(32769, 32769, 32768), 3., 0.04, 0.));
+	BOOST_CHECK(terrain.updateTerrainMap(patch));
+	terrain.clearDirtyRegion();
+	BOOST_CHECK(terrain.getRevision() > revision);
+	BOOST_CHECK(terrain.isChangedRegion(near_region, revision));
+	BOOST_CHECK(!terrain.isChangedRegion(far_region, revision));
+
+	// A full change changes every region
+	unsigned long patch_revision = terrain.getRevision();
+	terrain.setTerrainMap(terrain_data);
+	BOOST_CHECK(terrain.isChangedRegion(far_region, patch_revision));
+}
+
+
+BOOST_AUTO_TEST_CASE(occupancy_grid) // specify a test case for the bit-packed occupancy grid
+{
+	// Resetting a region that needs several words per row
+	dwl::CellRegion region;
+	region.add(dwl::Key(1000, 2000, 0));
+	region.add(dwl::Key(1199, 2049, 0));
+	dwl::environment::OccupancyGrid grid;
+	BOOST_CHECK(grid.isEmpty());
+	grid.reset(region);
+	BOOST_CHECK(!grid.isEmpty());
+	BOOST_CHECK_EQUAL(grid.countOccupied(dwl::Key(0, 0, 0), dwl::Key(65535, 65535, 0)), 0);
+
+	// Adding obstacles in different words
+	grid.setOccupied(dwl::Key(1000, 2000, 0));
+	grid.setOccupied(dwl::Key(1063, 2010, 0));
+	grid.setOccupied(dwl::Key(1064, 2010, 0));
+	grid.setOccupied(dwl::Key(1199, 2049, 0));
+	grid.setOccupied(dwl::Key(999, 2000, 0)); // outside
+	BOOST_CHECK(grid.isOccupied(dwl::Key(1063, 2010, 0)));
+	BOOST_CHECK(!grid.isOccupied(dwl::Key(1062, 2010, 0)));
+	BOOST_CHECK(!grid.isOccupied(dwl::Key(999, 2000, 0)));
+	BOOST_CHECK_EQUAL(grid.countOccupied(dwl::Key(0, 0, 0), dwl::Key(65535, 65535, 0)), 4);
+
+	// Checking rectangles inside a word, across words and clipped by the region
+	BOOST_CHECK(!grid.isAnyOccupied(dwl::Key(1001, 2000, 0), dwl::Key(1062, 2049, 0)));
+	BOOST_CHECK(grid.isAnyOccupied(dwl::Key(1001, 2005, 0), dwl::Key(1063, 2015, 0)));
+	BOOST_CHECK_EQUAL(grid.countOccupied(dwl::Key(1060, 2010, 0), dwl::Key(1070, 2010, 0)), 2);
+	BOOST_CHECK(!grid.isAnyOccupied(dwl::Key(1065, 2000, 0), dwl::Key(1198, 2049, 0)));
+	BOOST_CHECK(grid.isAnyOccupied(dwl::Key(1150, 2040, 0), dwl::Key(1300, 2100, 0)));
+
+	// Checking a footprint described by its row spans
+	std::vector<dwl::environment::RowSpan> footprint;
+	footprint.push_back(dwl::environment::RowSpan(2009, 1050, 1070));
+	footprint.push_back(dwl::environment::RowSpan(2011, 1050, 1070));
+	BOOST_CHECK(!grid.isAnyOccupied(footprint));
+	footprint.push_back(dwl::environment::RowSpan(2010, 1064, 1064));
+	BOOST_CHECK(grid.isAnyOccupied(footprint));
+
+	// Removing an obstacle
+	grid.setOccupied(dwl::Key(1064, 2010, 0), false);
+	BOOST_CHECK(!grid.isAnyOccupied(footprint));
+	BOOST_CHECK_EQUAL(grid.countOccupied(dwl::Key(0, 0, 0), dwl::Key(65535, 65535, 0)), 3);
+}
+
+
+BOOST_AUTO_TEST_CASE(distance_field) // specify a test case for the obstacle distance field
+{
+	dwl::environment::DistanceField field;
+	field.reset(0.1, 0.5);
+	BOOST_CHECK(field.isEmpty());
+	BOOST_CHECK_EQUAL(field.getDistance(dwl::Key(1000, 1000, 0)), 0.5);
+
+	// Adding the obstacles incrementally, where the second one grows the region
+	std::vector<dwl::Key> obstacles;
+	obstacles.push_back(dwl::Key(1000, 1000, 0));
+	obstacles.push_back(dwl::Key(1030, 1002, 0));
+	obstacles.push_back(dwl::Key(1003, 1004, 0));
+	for (unsigned int i = 0; i < obstacles.size(); i++)
+		field.addObstacle(obstacles[i]);
+	BOOST_CHECK(!field.isEmpty());
+
+	// Comparing with the brute-force distances and the full transform
+	dwl::environment::DistanceField full_field;
+	full_field.reset(0.1, 0.5);
+	full_field.compute(obstacles);
+	double max_error = 0.;
+	for (unsigned short int x = 990; x < 1040; x++) {
+		for (unsigned short int y = 990; y < 1015; y++) {
+			double distance = 0.5;
+			for (unsigned int i = 0; i < obstacles.size(); i++)
+				distance = std::min(distance, 0.1 * hypot(x - obstacles[i].x, y - obstacles[i].y));
+
+			dwl::Key key(x, y, 0);
+			max_error = std::max(max_error, fabs(field.getDistance(key) - distance));
+			max_error = std::max(max_error, fabs(full_field.getDistance(key) - distance));
+		}
+	}
+	BOOST_CHECK_SMALL(max_error, 1e-9);
+	BOOST_CHECK_CLOSE(field.getDistance(dwl::Key(1000, 1003, 0)), 0.3, 1e-6);
+
+	// Removing an obstacle
+	field.removeObstacles(std::vector<dwl::Key>(1, obstacles[2]));
+	BOOST_CHECK_CLOSE(field.getDistance(dwl::Key(1003, 1004, 0)), 0.5, 1e-6);
+	BOOST_CHECK_CLOSE(field.getDistance(dwl::Key(1000, 1003, 0)), 0.3, 1e-6);
+	BOOST_CHECK_CLOSE(field.getDistance(dwl::Key(1001, 1001, 0)), 0.1 * sqrt(2.), 1e-6);
+}
+
+
+BOOST_AUTO_TEST_CASE(morton_vertex_ordering) // specify a test case for the Morton vertex ids
+{
+	dwl::environment::SpaceDiscretization space(0.04, 0.04, M_PI / 200);
+	dwl::Key key(32800, 32700, 12);
+	dwl::Vertex row_vertex, morton_vertex;
+	space.keyToVertex(row_vertex, key, true);
+	space.setVertexOrdering(dwl::environment::Morton);
+	BOOST_CHECK(space.getVertexOrdering() == dwl::environment::Morton);
+
+	// Converting the keys and states in both directions
+	dwl::Key decoded_key;
+	space.keyToVertex(morton_vertex, key, true);
+	BOOST_CHECK(morton_vertex != row_vertex);
+	space.vertexToKey(decoded_key, morton_vertex, true);
+	BOOST_CHECK_EQUAL(decoded_key.x, key.x);
+	BOOST_CHECK_EQUAL(decoded_key.y, key.y);
+	space.keyToVertex(morton_vertex, key, false);
+	space.vertexToKey(decoded_key, morton_vertex, false);
+	BOOST_CHECK_EQUAL(decoded_key.x, key.x);
+	BOOST_CHECK_EQUAL(decoded_key.y, key.y);
+	BOOST_CHECK_EQUAL(decoded_key.z, key.z);
+
+	Eigen::Vector3d state(1.02, -0.58, 1.), decoded_state;
+	dwl::Vertex state_vertex;
+	space.stateToVertex(state_vertex, state);
+	space.vertexToState(decoded_state, state_vertex);
+	BOOST_CHECK_SMALL(fabs(decoded_state(0) - state(0)), 0.02 + 1e-9);
+	BOOST_CHECK_SMALL(fabs(decoded_state(1) - state(1)), 0.02 + 1e-9);
+	BOOST_CHECK_SMALL(fabs(decoded_state(2) - state(2)), M_PI / 200 + 1e-9);
+
+	// The neighbors along both axes have close ids
+	dwl::Vertex x_neighbor, y_neighbor;
+	space.keyToVertex(morton_vertex, dwl::Key(32768, 32768, 0), true);
+	space.keyToVertex(x_neighbor, dwl::Key(32769, 32768, 0), true);
+	space.keyToVertex(y_neighbor, dwl::Key(32768, 32769, 0), true);
+	BOOST_CHECK(x_neighbor - morton_vertex < 4 && y_neighbor - morton_vertex < 4);
+}
+
+
+BOOST_AUTO_TEST_CASE(state_window) // specify a test case for the dense state vertexes
+{
+	dwl::environment::SpaceDiscretization space(0.04, 0.04, M_PI / 8);
+	BOOST_CHECK(!space.hasStateWindow());
+	BOOST_CHECK_EQUAL(space.getNumberOfWindowVertices(dwl::XY_Y), 0);
+	BOOST_CHECK(space.setStateWindow(Eigen::Vector2d(1., -0.5), Eigen::Vector2d(1., 1.)));
+	BOOST_CHECK(!space.setStateWindow(Eigen::Vector2d(1., -0.5), Eigen::Vector2d(1., 1.)));
+	dwl::Vertex num_vertices = space.getNumberOfWindowVertices(dwl::XY_Y);
+	BOOST_CHECK_EQUAL(space.getNumberOfWindowVertices(dwl::XY), 27 * 27);
+	BOOST_CHECK_EQUAL(num_vertices, 27 * 27 * 16);
+
+	// The states inside the window have dense vertexes, where the yaw varies fastest and
+	// wraps around
+	Eigen::Vector3d state(1.22, -0.3, 0.5), decoded_state;
+	dwl::Vertex vertex, yaw_neighbor, wrapped_vertex;
+	space.stateToVertex(vertex, state);
+	BOOST_CHECK(vertex < num_vertices);
+	space.vertexToState(decoded_state, vertex);
+	BOOST_CHECK_SMALL(fabs(decoded_state(0) - state(0)), 0.02 + 1e-9);
+	BOOST_CHECK_SMALL(fabs(decoded_state(1) - state(1)), 0.02 + 1e-9);
+	BOOST_CHECK_SMALL(fabs(decoded_state(2) - state(2)), M_PI / 8 + 1e-9);
+	space.stateToVertex(yaw_neighbor, Eigen::Vector3d(1.22, -0.3, 0.5 + M_PI / 8));
+	BOOST_CHECK_EQUAL(yaw_neighbor, vertex + 1);
+	space.stateToVertex(wrapped_vertex, Eigen::Vector3d(1.22, -0.3, 0.5 + 2 * M_PI));
+	BOOST_CHECK_EQUAL(wrapped_vertex, vertex);
+
+	Eigen::Vector2d state_2d(0.6, -0.9), decoded_state_2d;
+	space.stateToVertex(vertex, state_2d);
+	BOOST_CHECK(vertex < space.getNumberOfWindowVertices(dwl::XY));
+	space.vertexToState(decoded_state_2d, vertex);
+	BOOST_CHECK_SMALL((decoded_state_2d - state_2d).cwiseAbs().maxCoeff(), 0.02 + 1e-9);
+
+	// The states outside the window have vertexes after the window ones
+	Eigen::Vector3d far_state(3., 2., 2.);
+	space.stateToVertex(vertex, far_state);
+	BOOST_CHECK(vertex >= num_vertices);
+	space.vertexToState(decoded_state, vertex);
+	BOOST_CHECK_SMALL(fabs(decoded_state(0) - far_state(0)), 0.02 + 1e-9);
+	BOOST_CHECK_SMALL(fabs(decoded_state(1) - far_state(1)), 0.02 + 1e-9);
+	BOOST_CHECK_SMALL(fabs(decoded_state(2) - far_state(2)), M_PI / 8 + 1e-9);
+
+	// Moving the window of the terrain map is a full change
+	dwl::environment::TerrainMap terrain;
+	terrain.setStateResolution(0.04, M_PI / 8);
+	unsigned long revision = terrain.getRevision();
+	terrain.setStateWindow(Eigen::Vector2d(0., 0.), Eigen::Vector2d(2., 2.));
+	BOOST_CHECK(terrain.getRevision() > revision);
+	revision = terrain.getRevision();
+	terrain.setStateWindow(Eigen::Vector2d(0.01, 0.01), Eigen::Vector2d(2., 2.));
+	BOOST_CHECK_EQUAL(terrain.getRevision(), revision);
+	dwl::CellRegion region;
+	region.add(dwl::Key(32768, 32768, 32768));
+	BOOST_CHECK(!terrain.isChangedRegion(region, revision));
+	terrain.setStateWindow(Eigen::Vector2d(0.5, 0.), Eigen::Vector2d(2., 2.));
+	BOOST_CHECK(terrain.isChangedRegion(region, revision));
+	terrain.removeStateWindow();
+	BOOST_CHECK(!terrain.getTerrainSpaceModel().hasStateWindow());
+}
+
+
+BOOST_AUTO_TEST_CASE(batch_key_conversions) // specify a test case for the batched conversions
+{
+	dwl::environment::SpaceDiscretization space(0.04, 0.04, M_PI / 8);
+	space.setEnvironmentResolution(0.02, false);
+	space.setStateWindow(Eigen::Vector2d(1., -0.5), Eigen::Vector2d(1., 1.));
+
+	// Using more points than a block of the batched conversions
+	const unsigned int num_points = 600;
+	Eigen::Matrix3Xd points(3, num_points);
+	for (unsigned int i = 0; i < num_points; i++)
+		points.col(i) << -3. + 0.011 * i, 2. - 0.007 * i, sin(0.1 * i);
+	points(0,7) = std::numeric_limits<double>::quiet_NaN();
+	points(2,9) = 1e6;
+
+	// The batched conversions give the same keys and vertexes than the scalar ones
+	std::vector<dwl::Key> keys;
+	std::vector<bool> valid;
+	std::vector<dwl::Vertex> vertices_2d, vertices_3d, state_vertices_2d, state_vertices_3d;
+	Eigen::Matrix2Xd points_2d = points.topRows<2>();
+	BOOST_CHECK_EQUAL(space.coordToKeyChecked(keys, valid, points), num_points - 2);
+	BOOST_CHECK(!valid[7] && !valid[9]);
+	space.coordToVertex(vertices_2d, points_2d);
+	space.coordToVertex(vertices_3d, points);
+	space.stateToVertex(state_vertices_2d, points_2d);
+	space.stateToVertex(state_vertices_3d, points);
+	for (unsigned int i = 0; i < num_points; i++) {
+		if (i == 7 || i == 9)
+			continue;
+
+		dwl::Key key;
+		dwl::Vertex vertex;
+		space.coordToKeyChecked(key, points.col(i));
+		BOOST_CHECK(valid[i]);
+		BOOST_CHECK(keys[i].x == key.x && keys[i].y == key.y && keys[i].z == key.z);
+		space.coordToVertex(vertex, (Eigen::Vector2d) points.col(i).head<2>());
+		BOOST_CHECK_EQUAL(vertices_2d[i], vertex);
+		space.coordToVertex(vertex, (Eigen::Vector3d) points.col(i));
+		BOOST_CHECK_EQUAL(vertices_3d[i], vertex);
+		space.stateToVertex(vertex, (Eigen::Vector2d) points.col(i).head<2>());
+		BOOST_CHECK_EQUAL(state_vertices_2d[i], vertex);
+		space.stateToVertex(vertex, (Eigen::Vector3d) points.col(i));
+		BOOST_CHECK_EQUAL(state_vertices_3d[i], vertex);
+	}
+
+	Eigen::Matrix2Xd coordinates_2d;
+	Eigen::Matrix3Xd coordinates_3d;
+	space.vertexToCoord(coordinates_2d, vertices_2d);
+	space.vertexToCoord(coordinates_3d, vertices_3d);
+	for (unsigned int i = 0; i < num_points; i += 13) {
+		Eigen::Vector2d coordinate_2d;
+		Eigen::Vector3d coordinate_3d;
+		space.vertexToCoord(coordinate_2d, vertices_2d[i]);
+		space.vertexToCoord(coordinate_3d, vertices_3d[i]);
+		BOOST_CHECK_SMALL((coordinates_2d.col(i) - coordinate_2d).cwiseAbs().maxCoeff(), 1e-12);
+		BOOST_CHECK_SMALL((coordinates_3d.col(i) - coordinate_3d).cwiseAbs().maxCoeff(), 1e-12);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(terrain_pyramid) // specify a test case for the coarse terrain levels
+{
+	// Building a 4x4 terrain, where the cost increases along x and the height along y
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int y = 0; y < 4; y++) {
+		for (unsigned short int x = 0; x < 4; x++) {
+			dwl::Key key(32768 + x, 32768 + y, 32768 + y);
+			terrain_data.data.push_back(dwl::TerrainCell(key, x, Eigen::Vector3d::UnitZ(), 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+	terrain.setTerrainPyramidLevels(2);
+	BOOST_CHECK_EQUAL(terrain.getTerrainPyramid().getNumberOfLevels(), 2);
+	BOOST_CHECK_EQUAL(terrain.getTerrainPyramid().getNumberOfCells(1), 4);
+	BOOST_CHECK_EQUAL(terrain.getTerrainPyramid().getNumberOfCells(2), 1);
+
+	// Checking the aggregates of both levels
+	const dwl::environment::TerrainPyramid& pyramid = terrain.getTerrainPyramid();
+	const dwl::environment::TerrainAggregate* cell = pyramid.findCell(dwl::Key(32771, 32768, 0), 1);
+	BOOST_REQUIRE(cell != NULL);
+	BOOST_CHECK_EQUAL(cell->num_cells, 4);
+	BOOST_CHECK_CLOSE(cell->mean_cost, 2.5, 1e-9);
+	BOOST_CHECK_EQUAL(cell->max_cost, 3.);
+	BOOST_CHECK_CLOSE(cell->max_height - cell->min_height, 0.04, 1e-6);
+
+	cell = terrain.getTerrainAggregate(Eigen::Vector2d(0.05, 0.05), 2);
+	BOOST_REQUIRE(cell != NULL);
+	BOOST_CHECK_EQUAL(cell->num_cells, 16);
+	BOOST_CHECK_CLOSE(cell->mean_cost, 1.5, 1e-9);
+	BOOST_CHECK_CLOSE(cell->max_height - cell->min_height, 0.12, 1e-6);
+	BOOST_CHECK_CLOSE(cell->mean_height - cell->min_height, 0.06, 1e-6);
+	BOOST_CHECK_SMALL((cell->normal - Eigen::Vector3d::UnitZ()).norm(), 1e-9);
+	BOOST_CHECK(pyramid.findCell(dwl::Key(32772, 32768, 0), 2) == NULL);
+
+	// Updating and removing cells, which only updates their ancestors
+	dwl::TerrainData patch;
+	patch.plane_size = 0.04;
+	patch.height_size = 0.04;
+	patch.data.push_back(dwl::TerrainCell(dwl::Key(32768, 32768, 32768), 17.,
+										  Eigen::Vector3d::UnitZ(), 0.04, 0.));
+	BOOST_CHECK(terrain.updateTerrainMap(patch));
+	dwl::Vertex vertex;
+	terrain.getTerrainSpaceModel().keyToVertex(vertex, dwl::Key(32771, 32771, 0), true);
+	terrain.removeCellToTerrainMap(vertex);
+	cell = pyramid.findCell(dwl::Key(32768, 32768, 0), 2);
+	BOOST_REQUIRE(cell != NULL);
+	BOOST_CHECK_EQUAL(cell->num_cells, 15);
+	BOOST_CHECK_CLOSE(cell->mean_cost, (24. + 17. - 3.) / 15., 1e-9);
+	BOOST_CHECK_EQUAL(cell->max_cost, 17.);
+}
+
+
+BOOST_AUTO_TEST_CASE(terrain_feature_pipeline) // specify a test case for the batched features
+{
+	dwl::environment::TerrainFeaturePipeline pipeline;
+	pipeline.setResolution(0.02, 0.02);
+	pipeline.setNeighboringArea(0.04);
+	pipeline.setFeature(dwl::environment::SlopeFeature, 1., M_PI / 4);
+	pipeline.setFeature(dwl::environment::CurvatureFeature, 0., 1.);
+	pipeline.setFeature(dwl::environment::RoughnessFeature, 0., 1.);
+	pipeline.setFeature(dwl::environment::HeightDeviationFeature, 2., 0.1);
+
+	// Checking the features of a tilted plane, which only has slope inside the borders
+	Eigen::ArrayXXd height(20, 10), cost;
+	for (unsigned int j = 0; j < height.cols(); j++)
+		for (unsigned int i = 0; i < height.rows(); i++)
+			height(i, j) = 0.5 * 0.02 * i + 1.;
+	pipeline.compute(cost, height);
+	BOOST_CHECK_EQUAL(cost.rows(), 20);
+	BOOST_CHECK_EQUAL(cost.cols(), 10);
+	BOOST_CHECK_CLOSE(pipeline.getFeature(dwl::environment::SlopeFeature)(10, 5), 0.5, 1e-6);
+	BOOST_CHECK_SMALL(pipeline.getFeature(dwl::environment::CurvatureFeature)(10, 5), 1e-6);
+	BOOST_CHECK_SMALL(pipeline.getFeature(dwl::environment::RoughnessFeature)(10, 5), 1e-6);
+	BOOST_CHECK_SMALL(pipeline.getFeature(dwl::environment::HeightDeviationFeature)(10, 5), 1e-9);
+	BOOST_CHECK_CLOSE(cost(10, 5), 0.5, 1e-6);
+
+	// Checking a step, where the height deviation saturates
+	height.setZero();
+	height.bottomRows(10).setConstant(0.5);
+	pipeline.compute(cost, height);
+	BOOST_CHECK_CLOSE(pipeline.getFeature(dwl::environment::HeightDeviationFeature)(10, 5),
+					  0.5 - 0.5 * 3. / 5., 1e-6);
+	BOOST_CHECK_CLOSE(cost(10, 5), 1. + 2., 1e-6);
+	BOOST_CHECK_SMALL(cost(2, 5), 1e-9);
+
+	// Computing the terrain cells of the plane, which are tilted around the y axis
+	for (unsigned int j = 0; j < height.cols(); j++)
+		for (unsigned int i = 0; i < height.rows(); i++)
+			height(i, j) = 0.5 * 0.02 * i;
+	dwl::TerrainData terrain_data;
+	pipeline.computeTerrainData(terrain_data, height, Eigen::Vector2d(1., 2.));
+	BOOST_CHECK_EQUAL(terrain_data.data.size(), 200);
+	BOOST_CHECK_EQUAL(terrain_data.plane_size, 0.02);
+	Eigen::Vector3d normal = Eigen::Vector3d(-0.5, 0., 1.).normalized();
+	BOOST_CHECK_SMALL((terrain_data.data[25].normal - normal).norm(), 1e-6);
+
+	// The OpenCL backend gives the CPU costs, and the CPU backend is kept if it isn't available
+	height.bottomRows(10).array() += 0.2;
+	Eigen::ArrayXXd cpu_cost;
+	pipeline.compute(cpu_cost, height);
+	if (pipeline.setBackend(dwl::environment::OpenCLBackend)) {
+		pipeline.compute(cost, height);
+		BOOST_CHECK(cost.isApprox(cpu_cost, 1e-9));
+	} else
+		BOOST_CHECK_EQUAL(pipeline.getBackend(), dwl::environment::CpuBackend);
+}
+
+
+BOOST_AUTO_TEST_CASE(grid_plane_fitting) // specify a test case for the batched plane fitting
+{
+	// Building a curved surface with an unknown cell
+	double resolution = 0.02;
+	Eigen::ArrayXXd height(12, 9);
+	for (unsigned int j = 0; j < height.cols(); j++)
+		for (unsigned int i = 0; i < height.rows(); i++)
+			height(i, j) = 0.3 * i * resolution - 0.1 * j * resolution + 0.5 * pow(i * resolution, 2);
+	height(5, 4) = std::numeric_limits<double>::quiet_NaN();
+
+	Eigen::Matrix3Xd normals;
+	Eigen::ArrayXXd curvatures;
+	dwl::math::computePlaneParameters(normals, curvatures, height, resolution, 2);
+	BOOST_CHECK_EQUAL(normals.cols(), 12 * 9);
+
+	// Comparing with the plane fitting of every neighborhood
+	double max_error = 0.;
+	for (int j = 0; j < height.cols(); j++) {
+		for (int i = 0; i < height.rows(); i++) {
+			std::vector<Eigen::Vector3f> points;
+			for (int v = std::max(j - 2, 0); v <= std::min(j + 2, (int) height.cols() - 1); v++) {
+				for (int u = std::max(i - 2, 0); u <= std::min(i + 2, (int) height.rows() - 1); u++) {
+					if (std::isfinite(height(u, v)))
+						points.push_back(Eigen::Vector3f(u * resolution, v * resolution, height(u, v)));
+				}
+			}
+
+			Eigen::Vector3d mean, normal;
+			Eigen::Matrix3d covariance;
+			double curvature;
+			dwl::math::computeMeanAndCovarianceMatrix(mean, covariance, points);
+			dwl::math::solvePlaneParameters(normal, curvature, covariance);
+			max_error = std::max(max_error, (normals.col(i + j * height.rows()) - normal).norm());
+			max_error = std::max(max_error, fabs(curvatures(i, j) - curvature));
+		}
+	}
+	BOOST_CHECK_SMALL(max_error, 1e-4);
+}
+
+
+BOOST_AUTO_TEST_CASE(cost_to_go_field) // specify a test case for the backward heuristic field
+{
+	// Building a 10x10 free terrain with a wall that has a gap
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int y = 0; y < 10; y++) {
+		for (unsigned short int x = 0; x < 10; x++) {
+			double cost = (x == 5 && y < 8) ? 10. : 0.;
+			dwl::Key key(32768 + x, 32768 + y, 32768);
+			terrain_data.data.push_back(dwl::TerrainCell(key, cost, Eigen::Vector3d::UnitZ(), 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+
+	dwl::environment::CostToGoField field;
+	field.setMargin(0.);
+	Eigen::Vector2d goal(0.02, 0.02), start(0.38, 0.02);
+	field.compute(terrain, goal, start, 1., 0.1);
+	BOOST_REQUIRE(field.isComputed());
+
+	double cost;
+	BOOST_REQUIRE(field.getCost(cost, goal));
+	BOOST_CHECK_SMALL(cost, 1e-12);
+	BOOST_REQUIRE(field.getCost(cost, Eigen::Vector2d(0.06, 0.02)));
+	BOOST_CHECK_CLOSE(cost, 0.04 * 0.1, 1e-9);
+
+	// The cost-to-go of the start goes through the gap instead of crossing the wall
+	BOOST_REQUIRE(field.getCost(cost, start));
+	BOOST_CHECK(cost > 9 * 0.04 * 0.1);
+	BOOST_CHECK(cost < 0.04 * 10.1);
+	BOOST_CHECK(!field.getCost(cost, Eigen::Vector2d(0.5, 0.02)));
+
+	// The quantized-cost mode expands the decreased costs again, so the field is the same
+	dwl::environment::CostToGoField quantized_field;
+	quantized_field.setMargin(0.);
+	quantized_field.setCostQuantum(0.01);
+	quantized_field.compute(terrain, goal, start, 1., 0.1);
+	for (unsigned int y = 0; y < 10; y++) {
+		for (unsigned int x = 0; x < 10; x++) {
+			Eigen::Vector2d position(0.04 * x + 0.02, 0.04 * y + 0.02);
+			double quantized_cost;
+			BOOST_REQUIRE(field.getCost(cost, position));
+			BOOST_REQUIRE(quantized_field.getCost(quantized_cost, position));
+			BOOST_CHECK_CLOSE(quantized_cost, cost, 1e-9);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(local_terrain_patch) // specify a test case for the interpolated terrain patch
+{
+	// Building a 10x10 terrain with linear costs and heights, so the bilinear interpolation
+	// is exact between the centers of the cells
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int y = 0; y < 10; y++) {
+		for (unsigned short int x = 0; x < 10; x++) {
+			dwl::Key key(32768 + x, 32768 + y, 32768);
+			terrain_data.data.push_back(dwl::TerrainCell(key, x + 2. * y, Eigen::Vector3d::UnitZ(),
+														 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+
+	dwl::environment::LocalTerrainPatch patch;
+	BOOST_CHECK(!patch.isBuilt());
+	patch.build(terrain, Eigen::Vector2d(0.2, 0.2), 0.1);
+	BOOST_REQUIRE(patch.isBuilt());
+
+	// Comparing the patch with the terrain map in the centers of the cells
+	Eigen::Vector2d center(0.22, 0.18);
+	BOOST_CHECK(patch.isInside(center));
+	BOOST_CHECK_CLOSE(patch.getCost(center), terrain.getTerrainCost(center), 1e-9);
+	BOOST_CHECK_CLOSE(patch.getHeight(center), terrain.getTerrainHeight(center), 1e-9);
+
+	// Interpolating between the cells, and clamping the positions outside the patch
+	BOOST_CHECK_CLOSE(patch.getCost(Eigen::Vector2d(0.23, 0.2)), 5.25 + 2. * 4.5, 1e-9);
+	BOOST_CHECK(!patch.isInside(Eigen::Vector2d(0.5, 0.2)));
+	BOOST_CHECK_CLOSE(patch.getCost(Eigen::Vector2d(0.5, 0.2)),
+					  patch.getCost(Eigen::Vector2d(0.3, 0.2)), 1e-9);
+	patch.clear();
+	BOOST_CHECK(!patch.isBuilt());
+}
+
+
+BOOST_AUTO_TEST_CASE(interpolated_terrain_height) // specify a test case for the smooth heights
+{
+	// Building a 10x10 terrain with a ramp along x, where both interpolations are exact
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int y = 0; y < 10; y++) {
+		for (unsigned short int x = 0; x < 10; x++) {
+			dwl::Key key(32768 + x, 32768 + y, 32768 + x);
+			terrain_data.data.push_back(dwl::TerrainCell(key, 0., Eigen::Vector3d::UnitZ(),
+														 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+
+	double height;
+	Eigen::Vector2d gradient;
+	Eigen::Vector2d position(0.21, 0.17);
+	BOOST_CHECK(terrain.getInterpolatedTerrainHeight(height, gradient, position));
+	BOOST_CHECK_CLOSE(height, 0.21, 1e-6);
+	BOOST_CHECK_SMALL((gradient - Eigen::Vector2d(1., 0.)).norm(), 1e-6);
+	BOOST_CHECK(terrain.getInterpolatedTerrainHeight(height, gradient, position,
+													 dwl::environment::BicubicInterpolation));
+	BOOST_CHECK_CLOSE(height, 0.21, 1e-6);
+	BOOST_CHECK_SMALL((gradient - Eigen::Vector2d(1., 0.)).norm(), 1e-6);
+
+	Eigen::Vector3d normal;
+	BOOST_CHECK(terrain.getInterpolatedTerrainNormal(normal, position));
+	BOOST_CHECK_SMALL((normal - Eigen::Vector3d(-1., 0., 1.).normalized()).norm(), 1e-6);
+
+	// The bicubic gradient is continuous across the cell borders
+	Eigen::Vector2d gradient_left, gradient_right;
+	terrain_data.data[55].key.z += 2;
+	terrain.setTerrainMap(terrain_data);
+	terrain.getInterpolatedTerrainHeight(height, gradient_left, Eigen::Vector2d(0.22 - 1e-9, 0.2),
+										 dwl::environment::BicubicInterpolation);
+	terrain.getInterpolatedTerrainHeight(height, gradient_right, Eigen::Vector2d(0.22 + 1e-9, 0.2),
+										 dwl::environment::BicubicInterpolation);
+	BOOST_CHECK_SMALL((gradient_left - gradient_right).norm(), 1e-6);
+
+	// The batch of positions, where the last one needs unknown cells
+	Eigen::Matrix2Xd positions(2, 3);
+	positions << 0.1, 0.3, 0.39,
+				 0.1, 0.1, 0.1;
+	Eigen::VectorXd heights;
+	Eigen::Matrix2Xd gradients;
+	BOOST_CHECK_EQUAL(terrain.getInterpolatedTerrainHeights(heights, gradients, positions), 1);
+	BOOST_CHECK_CLOSE(heights(0), 0.1, 1e-6);
+	BOOST_CHECK_CLOSE(heights(1), 0.3, 1e-6);
+	BOOST_CHECK_CLOSE(heights(2), 0.38, 1e-6);
+	BOOST_CHECK_SMALL(gradients(0, 2), 1e-9);
+}
+
+
+BOOST_AUTO_TEST_CASE(terrain_distance_field) // specify a test case for the terrain signed distances
+{
+	// Building a 20x20 flat terrain, where the height of the cells is 0.02 m
+	dwl::environment::TerrainMap terrain;
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int y = 0; y < 20; y++) {
+		for (unsigned short int x = 0; x < 20; x++) {
+			dwl::Key key(32768 + x, 32768 + y, 32768);
+			terrain_data.data.push_back(dwl::TerrainCell(key, 0., Eigen::Vector3d::UnitZ(),
+														 0.04, 0.));
+		}
+	}
+	terrain.setTerrainMap(terrain_data);
+
+	dwl::environment::TerrainDistanceField field;
+	BOOST_CHECK(field.isEmpty());
+	field.setMaxDistance(0.2);
+	field.compute(terrain);
+	BOOST_REQUIRE(!field.isEmpty());
+
+	// Checking the distances above and below the surface
+	double distance;
+	Eigen::Vector3d gradient;
+	BOOST_CHECK(field.getDistance(distance, gradient, Eigen::Vector3d(0.4, 0.4, 0.12)));
+	BOOST_CHECK_CLOSE(distance, 0.1, 1e-4);
+	BOOST_CHECK_SMALL((gradient - Eigen::Vector3d::UnitZ()).norm(), 1e-4);
+	BOOST_CHECK_CLOSE(field.getDistance(Eigen::Vector3d(0.4, 0.4, -0.03)), -0.05, 1e-4);
+	BOOST_CHECK_CLOSE(field.getDistance(Eigen::Vector3d(0.4, 0.4, 1.)), 0.2, 1e-4);
+	BOOST_CHECK(!field.getDistance(distance, gradient, Eigen::Vector3d(5., 0.4, 0.1)));
+
+	// Raising a block, where the incremental update matches the full computation
+	dwl::TerrainData patch;
+	patch.plane_size = 0.04;
+	patch.height_size = 0.04;
+	for (unsigned short int y = 8; y < 12; y++)
+		for (unsigned short int x = 8; x < 12; x++)
+			patch.data.push_back(dwl::TerrainCell(dwl::Key(32768 + x, 32768 + y, 32770), 0.,
+												  Eigen::Vector3d::UnitZ(), 0.04, 0.));
+	terrain.clearDirtyRegion();
+	BOOST_CHECK(terrain.updateTerrainMap(patch));
+	field.update(terrain, terrain.getDirtyRegion());
+	dwl::environment::TerrainDistanceField full_field;
+	full_field.setMaxDistance(0.2);
+	full_field.compute(terrain);
+	BOOST_CHECK_EQUAL(field.getNumberOfVoxels(), full_field.getNumberOfVoxels());
+
+	double max_error = 0.;
+	for (double x = 0.; x < 0.8; x += 0.013) {
+		for (double z = -0.1; z < 0.3; z += 0.011) {
+			Eigen::Vector3d point(x, 0.41, z);
+			max_error = std::max(max_error, fabs(field.getDistance(point) -
+												 full_field.getDistance(point)));
+		}
+	}
+	BOOST_CHECK_SMALL(max_error, 1e-6);
+
+	// The side of the block is closer than its top
+	BOOST_CHECK_CLOSE(field.getDistance(Eigen::Vector3d(0.3, 0.42, 0.08)), 0.04, 1e-4);
+}
+
+
+BOOST_AUTO_TEST_CASE(rolling_terrain_window) // specify a test case for the robot-centric window
+{
+	// Building a 2x2 tiles window with a row of cells that crosses three tiles
+	dwl::environment::TerrainMap terrain;
+	terrain.setResolution(0.04, true);
+	terrain.setRollingWindow(2 * 64 * 0.04);
+	dwl::CellRegion window = terrain.getRollingWindowRegion();
+	BOOST_REQUIRE(!window.empty);
+	BOOST_CHECK_EQUAL(window.max_key.x - window.min_key.x + 1, 128);
+
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (unsigned short int x = 0; x < 192; x++)
+		terrain_data.data.push_back(dwl::TerrainCell(dwl::Key(32704 + x, 32768, 32768), 1., 0.04, 0.));
+	terrain.setTerrainMap(terrain_data);
+	BOOST_CHECK_EQUAL(terrain.getTerrainDataMap().size(), 128);
+	double height;
+	BOOST_CHECK(terrain.getTerrainHeight(height, Eigen::Vector2d(-2.5, 0.01)));
+	BOOST_CHECK(!terrain.getTerrainHeight(height, Eigen::Vector2d(2.6, 0.01)));
+
+	// Recentering one tile forward, which only removes the cells of the exposed tile
+	unsigned long revision = terrain.getRevision();
+	BOOST_CHECK(terrain.recenterRollingWindow(Eigen::Vector2d(2.6, 0.)));
+	BOOST_CHECK(!terrain.recenterRollingWindow(Eigen::Vector2d(2.65, 0.)));
+	BOOST_CHECK_EQUAL(terrain.getTerrainDataMap().size(), 64);
+	BOOST_CHECK(!terrain.getTerrainHeight(height, Eigen::Vector2d(-2.5, 0.01)));
+	BOOST_CHECK(terrain.getTerrainHeight(height, Eigen::Vector2d(0.01, 0.01)));
+	BOOST_CHECK(terrain.isChangedRegion(window, revision));
+
+	// The exposed strip is reused by the new cells, and the average cost is kept consistent
+	BOOST_CHECK(terrain.updateTerrainMap(terrain_data));
+	BOOST_CHECK_EQUAL(terrain.getTerrainDataMap().size(), 128);
+	BOOST_CHECK(terrain.getTerrainHeight(height, Eigen::Vector2d(2.6, 0.01)));
+	BOOST_CHECK_CLOSE(terrain.getAverageCostOfTerrain(), 1., 1e-9);
+}
+
+
+BOOST_AUTO_TEST_CASE(shared_terrain_map) // specify a test case for the terrain snapshots
+{
+	// Publishing a flat terrain of 0.04 m, whose snapshot isn't modified by the next updates
+	dwl::environment::SharedTerrainMap shared_terrain;
+	dwl::environment::TerrainMap& terrain = shared_terrain.getWriteMap();
+	terrain.setResolution(0.04, true);
+	dwl::TerrainData terrain_data;
+	terrain_data.plane_size = 0.04;
+	terrain_data.height_size = 0.04;
+	for (int i = -20; i < 20; i++) {
+		for (int j = -20; j < 20; j++)
+			terrain_data.data.push_back(dwl::TerrainCell(dwl::Key(32768 + i, 32768 + j, 32769),
+														 1., 0.04, 0.));
+	}
+	terrain.setTerrainMap(terrain_data);
+	BOOST_CHECK_EQUAL(shared_terrain.publish(), 1);
+	std::shared_ptr<const dwl::environment::TerrainMap> snapshot = shared_terrain.acquire();
+
+	terrain.addCellToTerrainMap(dwl::TerrainCell(dwl::Key(32768, 32768, 32773), 2., 0.04, 0.));
+	double height;
+	BOOST_CHECK(snapshot->getTerrainHeight(height, Eigen::Vector2d(0.02, 0.02)));
+	BOOST_CHECK_CLOSE(height, 0.06, 1e-6);
+	BOOST_CHECK_CLOSE(snapshot->getAverageCostOfTerrain(), 1., 1e-9);
+	BOOST_CHECK(terrain.getTerrainHeight(height, Eigen::Vector2d(0.02, 0.02)));
+	BOOST_CHECK_CLOSE(height, 0.22, 1e-6);
+
+	// The copies of a grid share its tiles until they are modified
+	dwl::environment::TerrainGrid grid;
+	grid.setCell(dwl::Key(32768, 32768, 0), 1., 0., Eigen::Vector3d::UnitZ());
+	dwl::environment::TerrainGrid grid_copy = grid;
+	grid.setCell(dwl::Key(32768, 32768, 0), 2., 0., Eigen::Vector3d::UnitZ());
+	grid.removeCell(dwl::Key(32769, 32768, 0));
+	unsigned int cell;
+	const dwl::environment::TerrainGrid::Tile* tile = grid_copy.findCell(cell, dwl::Key(32768, 32768, 0));
+	BOOST_REQUIRE(tile != NULL);
+	BOOST_CHECK_CLOSE(tile->height[cell], 1., 1e-9);
+	tile = grid.findCell(cell, dwl::Key(32768, 32768, 0));
+	BOOST_REQUIRE(tile != NULL);
+	BOOST_CHECK_CLOSE(tile->height[cell], 2., 1e-9);
+
+	// A reader only acquires complete versions, i.e. the terrain is always flat while the
+	// writer raises it and publishes it
+	bool consistent = true;
+	std::thread reader([&shared_terrain, &consistent]() {
+		for (unsigned int k = 0; k < 200; k++) {
+			std::shared_ptr<const dwl::environment::TerrainMap> map = shared_terrain.acquire();
+			double first_height, last_height;
+			if (map->getTerrainHeight(first_height, Eigen::Vector2d(-0.6, -0.6)) &&
+					map->getTerrainHeight(last_height, Eigen::Vector2d(0.6, 0.6)))
+				consistent &= std::fabs(first_height - last_height) < 1e-9;
+		}
+	});
+	for (unsigned short int level = 32770; level < 32790; level++) {
+		for (unsigned int i = 0; i < terrain_data.data.size(); i++)
+			terrain_data.data[i].key.z = level;
+		terrain.setTerrainMap(terrain_data);
+		shared_terrain.publish();
+	}
+	reader.join();
+	BOOST_CHECK(consistent);
+	BOOST_CHECK_EQUAL(shared_terrain.getNumberOfPublications(), 21);
+}
+
+
+BOOST_AUTO_TEST_CASE(point_cloud_terrain_pipeline) // specify a test case for the point binning
+{
+	// A batch of a flat floor at 0.1 m (four points per cell), with a box of 0.3 m, an isolated
+	// outlier and an invalid point
+	Eigen::Matrix3Xd points(3, 4 * 400 + 2);
+	unsigned int k = 0;
+	for (int i = 0; i < 20; i++) {
+		for (int j = 0; j < 20; j++) {
+			for (int p = 0; p < 4; p++) {
+				double x = (i + 0.25 + 0.5 * (p % 2)) * 0.04;
+				double y = (j + 0.25 + 0.5 * (p / 2)) * 0.04;
+				double z = (i >= 10 && j >= 10) ? 0.3 : 0.1;
+				points.col(k++) << x, y, z - 0.01 * p;
+			}
+		}
+	}
+	points.col(k++) << 1.5, 1.5, 0.1;
+	points.col(k++) << std::numeric_limits<double>::quiet_NaN(), 0., 0.;
+
+	dwl::environment::PointCloudTerrainPipeline pipeline;
+	pipeline.setResolution(0.04, 0.04);
+	pipeline.setMinimumPoints(2);
+	dwl::TerrainData terrain_update;
+	BOOST_CHECK(pipeline.compute(terrain_update, points));
+	BOOST_CHECK_EQUAL(terrain_update.data.size(), 400);
+	BOOST_CHECK_EQUAL(pipeline.getNumberOfDiscardedPoints(), 2);
+
+	// The threads give the same update, where the cell heights are the highest points
+	pipeline.setNumberOfThreads(4);
+	dwl::environment::TerrainMap terrain;
+	terrain.setResolution(0.04, true);
+	terrain.setResolution(0.04, false);
+	BOOST_CHECK(pipeline.update(terrain, points));
+	BOOST_CHECK_EQUAL(terrain.getTerrainDataMap().size(), 400);
+	double height;
+	BOOST_CHECK(terrain.getTerrainHeight(height, Eigen::Vector2d(0.1, 0.1)));
+	BOOST_CHECK_CLOSE(height, 0.1, 1e-6);
+	BOOST_CHECK(terrain.getTerrainHeight(height, Eigen::Vector2d(0.7, 0.7)));
+	BOOST_CHECK_CLOSE(height, 0.3, 1e-6);
+	BOOST_CHECK(!terrain.getTerrainHeight(height, Eigen::Vector2d(1.5, 1.5)));
+
+	// The flat cells are cheaper than the edge of the box
+	double flat_cost, edge_cost;
+	BOOST_CHECK(terrain.getTerrainCost(flat_cost, Eigen::Vector2d(0.1, 0.1)));
+	BOOST_CHECK(terrain.getTerrainCost(edge_cost, Eigen::Vector2d(0.42, 0.6)));
+	BOOST_CHECK_SMALL(flat_cost, 1e-9);
+	BOOST_CHECK(edge_cost > flat_cost);
+}
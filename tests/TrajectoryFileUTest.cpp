@@ -0,0 +1,93 @@
+#include <dwl/TrajectoryFile.h>
+#include <cstdio>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(whole_body_trajectory_file) // specify a test case for whole-body trajectory files
+{
+	// Creating a trajectory, where the second contact is only defined in the odd points
+	dwl::WholeBodyTrajectory trajectory(5);
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		dwl::WholeBodyState& state = trajectory[k];
+		state.setJointDoF(3);
+		state.time = 0.1 * k;
+		state.duration = 0.1;
+		state.base_pos = dwl::rbd::Vector6d::Constant(k);
+		state.joint_pos = Eigen::Vector3d(1., 2., 3.) * k;
+		state.joint_eff = Eigen::Vector3d(-1., -2., -3.) * k;
+		state.contact_pos["lf_foot"] = Eigen::Vector3d(0.3, 0.2, -0.5 + k);
+		if (k % 2 == 1)
+			state.contact_eff["rf_foot"] = dwl::rbd::Vector6d::Constant(10. * k);
+	}
+
+	std::string filename = "dwl_whole_body_trajectory.bin";
+	BOOST_CHECK(dwl::saveTrajectory(filename, trajectory));
+
+	// The mapped trajectory is read without copying
+	dwl::MappedWholeBodyTrajectory mapped;
+	BOOST_REQUIRE(mapped.open(filename));
+	BOOST_CHECK_EQUAL(mapped.size(), 5);
+	BOOST_CHECK_EQUAL(mapped.getJointDoF(), 3);
+	BOOST_CHECK_EQUAL(mapped.getContactNames().size(), 2);
+	BOOST_CHECK_EQUAL(mapped.time()(4), 0.4);
+	BOOST_CHECK_EQUAL(mapped.joint_pos()(2,3), 9.);
+	BOOST_CHECK_EQUAL(((uintptr_t) mapped.joint_pos().data()) % 64, 0);
+	BOOST_CHECK(!mapped.hasContact(2, 1, dwl::WholeBodyTrajectoryContainer::EFFORT));
+	BOOST_CHECK(mapped.hasContact(3, 1, dwl::WholeBodyTrajectoryContainer::EFFORT));
+
+	dwl::WholeBodyState state;
+	mapped.getState(state, 3);
+	BOOST_CHECK(state.joint_eff.isApprox(trajectory[3].joint_eff));
+	BOOST_CHECK(state.contact_pos["lf_foot"].isApprox(trajectory[3].contact_pos["lf_foot"]));
+	BOOST_CHECK(state.contact_eff["rf_foot"].isApprox(trajectory[3].contact_eff["rf_foot"]));
+	BOOST_CHECK_EQUAL(state.contact_pos.count("rf_foot"), 0);
+
+	// Loading the trajectory in a container
+	dwl::WholeBodyTrajectoryContainer container;
+	BOOST_CHECK(dwl::loadTrajectory(container, filename));
+	BOOST_CHECK_EQUAL(container.size(), 5);
+	BOOST_CHECK(container.base_pos.isApprox(mapped.base_pos()));
+	BOOST_CHECK(!container.hasContact(4, 1, dwl::WholeBodyTrajectoryContainer::EFFORT));
+	mapped.close();
+
+	// The reduced-body view doesn't load a whole-body file
+	dwl::MappedReducedBodyTrajectory reduced;
+	BOOST_CHECK(!reduced.open(filename));
+	remove(filename.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(reduced_body_trajectory_file) // specify a test case for reduced-body trajectory files
+{
+	dwl::ReducedBodyTrajectory trajectory(4);
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		dwl::ReducedBodyState& state = trajectory[k];
+		state.time = 0.2 * k;
+		state.com_pos = Eigen::Vector3d(0.1 * k, 0., 0.55);
+		state.cop = Eigen::Vector3d(0.1 * k, 0.01, 0.);
+		state.support_region["lh_foot"] = Eigen::Vector3d(-0.3, 0.2, 0.);
+		if (k > 1)
+			state.foot_pos["rh_foot"] = Eigen::Vector3d(-0.3, -0.2, 0.1 * k);
+	}
+
+	std::string filename = "dwl_reduced_body_trajectory.bin";
+	BOOST_CHECK(dwl::saveTrajectory(filename, trajectory));
+
+	dwl::MappedReducedBodyTrajectory mapped;
+	BOOST_REQUIRE(mapped.open(filename));
+	BOOST_CHECK_EQUAL(mapped.size(), 4);
+	BOOST_CHECK(mapped.com_pos().col(3).isApprox(trajectory[3].com_pos));
+
+	dwl::ReducedBodyTrajectoryContainer container;
+	BOOST_CHECK(dwl::loadTrajectory(container, filename));
+	dwl::ReducedBodyTrajectory loaded;
+	container.toTrajectory(loaded);
+	BOOST_REQUIRE_EQUAL(loaded.size(), 4);
+	BOOST_CHECK_EQUAL(loaded[1].foot_pos.count("rh_foot"), 0);
+	BOOST_CHECK(loaded[2].foot_pos["rh_foot"].isApprox(trajectory[2].foot_pos["rh_foot"]));
+	BOOST_CHECK(loaded[0].support_region["lh_foot"].isApprox(trajectory[0].support_region["lh_foot"]));
+	remove(filename.c_str());
+}
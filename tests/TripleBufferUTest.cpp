@@ -0,0 +1,65 @@
+#include <dwl/utils/TripleBuffer.h>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+BOOST_AUTO_TEST_CASE(triple_buffer) // specify a test case for the wait-free plan handoff
+{
+	dwl::utils::TripleBuffer<std::vector<double> > plans;
+
+	// There isn't a plan before the first publication
+	bool updated = true;
+	BOOST_CHECK(plans.acquire(&updated).empty());
+	BOOST_CHECK(!updated);
+	BOOST_CHECK_EQUAL(plans.getReadVersion(), 0);
+
+	// The acquired plan doesn't change until the next acquisition
+	BOOST_CHECK_EQUAL(plans.publish(std::vector<double>(3, 1.)), 1);
+	const std::vector<double>& plan = plans.acquire(&updated);
+	BOOST_CHECK(updated);
+	BOOST_CHECK_EQUAL(plans.getReadVersion(), 1);
+	plans.publish(std::vector<double>(3, 2.));
+	plans.publish(std::vector<double>(3, 3.));
+	BOOST_CHECK_EQUAL(plan[0], 1.);
+	BOOST_CHECK_EQUAL(plans.acquire(&updated)[0], 3.);
+	BOOST_CHECK_EQUAL(plans.getReadVersion(), 3);
+	plans.acquire(&updated);
+	BOOST_CHECK(!updated);
+}
+
+
+BOOST_AUTO_TEST_CASE(concurrent_triple_buffer) // specify a test case for concurrent handoffs
+{
+	// Publishing plans where all the values are the version, so a torn read would have
+	// different values
+	dwl::utils::TripleBuffer<std::vector<double> > plans;
+	const unsigned int num_plans = 20000;
+	std::thread planner([&plans, num_plans]() {
+		for (unsigned int k = 1; k <= num_plans; k++) {
+			std::vector<double>& plan = plans.getWriteBuffer();
+			plan.assign(1 + k % 50, (double) k);
+			plans.publish();
+		}
+	});
+
+	bool consistent = true;
+	uint64_t last_version = 0;
+	while (last_version < num_plans) {
+		const std::vector<double>& plan = plans.acquire();
+		uint64_t version = plans.getReadVersion();
+		if (version == 0)
+			continue;
+
+		for (unsigned int i = 0; i < plan.size(); i++)
+			consistent = consistent && plan[i] == (double) version;
+		consistent = consistent && plan.size() == 1 + version % 50 && version >= last_version;
+		last_version = version;
+	}
+	planner.join();
+	BOOST_CHECK(consistent);
+	BOOST_CHECK_EQUAL(plans.getPublishedVersion(), num_plans);
+}
@@ -0,0 +1,47 @@
+#include <dwl/locomotion/WholeBodyController.h>
+#include <dwl/solver/QuadProg++QP.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+BOOST_AUTO_TEST_CASE(standing_control) // specify a test case for a standing posture
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+
+	// Defining a standing state with all the feet in contact
+	unsigned int num_joints = fbs.getJointDoF();
+	dwl::WholeBodyState state(num_joints);
+	state.setJointPosition(fbs.getDefaultPosture());
+	dwl::rbd::BodySelector feet = fbs.getEndEffectorNames(dwl::model::FOOT);
+	for (unsigned int f = 0; f < feet.size(); f++) {
+		dwl::rbd::Vector6d wrench = dwl::rbd::Vector6d::Zero();
+		wrench(dwl::rbd::LZ) = fbs.getTotalMass() * fbs.getGravityAcceleration() / feet.size();
+		state.setContactWrench_B(feet[f], wrench);
+	}
+
+	dwl::solver::QuadProgQP qp;
+	qp.setPersistentFactorization(true);
+	dwl::locomotion::WholeBodyController controller;
+	controller.reset(&wdyn, &qp);
+	BOOST_CHECK(controller.compute(state, state));
+
+	// The contact forces hold the robot, and the base doesn't accelerate
+	const Eigen::VectorXd& forces = controller.getContactForces();
+	BOOST_CHECK_EQUAL(forces.size(), 3 * feet.size());
+	double normal_force = 0.;
+	for (unsigned int f = 0; f < feet.size(); f++)
+		normal_force += forces(3 * f + dwl::rbd::Z);
+	BOOST_CHECK_CLOSE(normal_force, fbs.getTotalMass() * fbs.getGravityAcceleration(), 1.);
+	BOOST_CHECK_SMALL(controller.getBaseAcceleration().norm(), 1e-3);
+	BOOST_CHECK_EQUAL(controller.getJointForces().size(), num_joints);
+
+	// The next tick of the same state is hotstarted
+	BOOST_CHECK(controller.compute(state, state));
+	BOOST_CHECK_SMALL(controller.getBaseAcceleration().norm(), 1e-3);
+}
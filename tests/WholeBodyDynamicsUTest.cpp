@@ -0,0 +1,559 @@
+#include <dwl/model/WholeBodyDynamics.h>
+#include <dwl/model/ContactEstimator.h>
+#include <dwl/model/RobotBatch.h>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+// Counting the heap allocations when it's enabled
+static bool count_allocations = false;
+static unsigned int num_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+	if (count_allocations)
+		++num_allocations;
+
+	void* ptr = std::malloc(size);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+
+// Tolerance
+double epsilon = 0.00001;
+
+BOOST_AUTO_TEST_CASE(no_alloc_inverse_dynamics) // specify a test case for allocation-free ID
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+
+	// Defining the robot state
+	unsigned int num_joints = fbs.getJointDoF();
+	dwl::rbd::Vector6d base_pos = dwl::rbd::Vector6d::Zero();
+	dwl::rbd::Vector6d base_vel = dwl::rbd::Vector6d::Zero();
+	dwl::rbd::Vector6d base_acc = dwl::rbd::Vector6d::Zero();
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture();
+	Eigen::VectorXd joint_vel = Eigen::VectorXd::Zero(num_joints);
+	Eigen::VectorXd joint_acc = Eigen::VectorXd::Zero(num_joints);
+
+	// Defining the external forces, which are indexed by end-effector
+	dwl::rbd::BodyContainer6d grf(fbs.getEndEffectorNames());
+	dwl::rbd::BodyVector6d grf_map;
+	for (unsigned int i = 0; i < grf.size(); i++)
+		grf[i] << 0., 0., 0., 0., 0., 190.778;
+	grf.toMap(grf_map);
+
+	// Sizing the outputs before calling the real-time routine
+	dwl::rbd::Vector6d base_wrench, base_wrench_map;
+	Eigen::VectorXd joint_forces(num_joints), joint_forces_map(num_joints);
+
+	// Checking that there isn't heap allocation in the real-time routine
+	num_allocations = 0;
+	count_allocations = true;
+	for (unsigned int k = 0; k < 100; k++) {
+		wdyn.computeInverseDynamics(base_wrench, joint_forces,
+									base_pos, joint_pos,
+									base_vel, joint_vel,
+									base_acc, joint_acc, grf);
+	}
+	count_allocations = false;
+	BOOST_CHECK_EQUAL(num_allocations, 0);
+
+	// Checking that we get the same results than the map-based routine
+	wdyn.computeInverseDynamics(base_wrench_map, joint_forces_map,
+								base_pos, joint_pos,
+								base_vel, joint_vel,
+								base_acc, joint_acc, grf_map);
+	for (unsigned int i = 0; i < 6; i++)
+		BOOST_CHECK_SMALL(base_wrench(i) - base_wrench_map(i), epsilon);
+	for (unsigned int j = 0; j < num_joints; j++)
+		BOOST_CHECK_SMALL(joint_forces(j) - joint_forces_map(j), epsilon);
+}
+
+BOOST_AUTO_TEST_CASE(batch_inverse_dynamics) // specify a test case for trajectory ID
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+
+	// Defining a trajectory with different joint positions per knot
+	unsigned int num_knots = 10;
+	dwl::WholeBodyTrajectory trajectory(num_knots);
+	for (unsigned int k = 0; k < num_knots; k++) {
+		dwl::WholeBodyState& state = trajectory[k];
+		state.setJointDoF(fbs.getJointDoF());
+		state.joint_pos = fbs.getDefaultPosture() +
+				0.01 * k * Eigen::VectorXd::Ones(fbs.getJointDoF());
+		state.base_acc(dwl::rbd::LZ) = 0.1 * k;
+	}
+
+	// Computing the inverse dynamics of the trajectory in parallel
+	std::vector<dwl::rbd::Vector6d> base_wrench;
+	std::vector<Eigen::VectorXd> joint_forces;
+	wdyn.computeInverseDynamics(base_wrench, joint_forces, trajectory, 3);
+	BOOST_CHECK_EQUAL(base_wrench.size(), num_knots);
+	BOOST_CHECK_EQUAL(joint_forces.size(), num_knots);
+
+	// Checking that we get the same results than knot-by-knot evaluation
+	for (unsigned int k = 0; k < num_knots; k++) {
+		const dwl::WholeBodyState& state = trajectory[k];
+		dwl::rbd::Vector6d knot_base_wrench;
+		Eigen::VectorXd knot_joint_forces;
+		wdyn.computeInverseDynamics(knot_base_wrench, knot_joint_forces,
+									state.base_pos, state.joint_pos,
+									state.base_vel, state.joint_vel,
+									state.base_acc, state.joint_acc,
+									state.contact_eff);
+		for (unsigned int i = 0; i < 6; i++)
+			BOOST_CHECK_SMALL(base_wrench[k](i) - knot_base_wrench(i), epsilon);
+		for (unsigned int j = 0; j < fbs.getJointDoF(); j++)
+			BOOST_CHECK_SMALL(joint_forces[k](j) - knot_joint_forces(j), epsilon);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(matrix_batch_inverse_dynamics) // specify a test case for batched ID
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+	const dwl::rbd::BodySelector& ee_names = fbs.getEndEffectorNames();
+
+	// Defining a batch of random states, where every column is a state
+	unsigned int num_states = 10;
+	unsigned int num_joints = fbs.getJointDoF();
+	Eigen::MatrixXd base_pos = 0.1 * Eigen::MatrixXd::Random(6, num_states);
+	Eigen::MatrixXd base_vel = Eigen::MatrixXd::Random(6, num_states);
+	Eigen::MatrixXd base_acc = Eigen::MatrixXd::Random(6, num_states);
+	Eigen::MatrixXd joint_pos = 0.2 * Eigen::MatrixXd::Random(num_joints, num_states);
+	Eigen::MatrixXd joint_vel = Eigen::MatrixXd::Random(num_joints, num_states);
+	Eigen::MatrixXd joint_acc = Eigen::MatrixXd::Random(num_joints, num_states);
+	Eigen::MatrixXd ext_force = 10. * Eigen::MatrixXd::Random(6 * ee_names.size(), num_states);
+	for (unsigned int k = 0; k < num_states; k++)
+		joint_pos.col(k) += fbs.getDefaultPosture();
+
+	// Computing the inverse dynamics of the batch in parallel
+	Eigen::MatrixXd base_wrench, joint_forces;
+	wdyn.computeInverseDynamics(base_wrench, joint_forces,
+								base_pos, joint_pos,
+								base_vel, joint_vel,
+								base_acc, joint_acc,
+								ext_force, 3);
+	BOOST_CHECK_EQUAL(base_wrench.cols(), num_states);
+	BOOST_CHECK_EQUAL(joint_forces.rows(), num_joints);
+
+	// Checking that we get the same results than state-by-state evaluation
+	for (unsigned int k = 0; k < num_states; k++) {
+		dwl::rbd::BodyVector6d state_force;
+		for (unsigned int i = 0; i < ee_names.size(); i++)
+			state_force[ee_names[i]] = ext_force.block<6,1>(6 * i, k);
+
+		dwl::rbd::Vector6d state_wrench;
+		Eigen::VectorXd state_forces;
+		wdyn.computeInverseDynamics(state_wrench, state_forces,
+									base_pos.col(k), joint_pos.col(k),
+									base_vel.col(k), joint_vel.col(k),
+									base_acc.col(k), joint_acc.col(k),
+									state_force);
+		BOOST_CHECK_SMALL((base_wrench.col(k) - state_wrench).norm(), epsilon);
+		BOOST_CHECK_SMALL((joint_forces.col(k) - state_forces).norm(), epsilon);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(robot_batch) // specify a test case for the batch of robot instances
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	dwl::model::RobotBatch batch;
+	batch.modelFromURDFFile(urdf_file, yarf_file);
+	batch.setNumberOfThreads(3);
+	dwl::model::WholeBodyDynamics& wdyn = batch.getWholeBodyDynamics();
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+
+	// Setting the instances in random motions around the default posture
+	unsigned int num_instances = 8;
+	batch.resize(num_instances);
+	BOOST_CHECK_EQUAL(batch.getNumberOfInstances(), num_instances);
+	dwl::WholeBodyTrajectoryContainer& states = batch.getStates();
+	states.base_vel.setRandom();
+	states.joint_vel.setRandom();
+	states.base_acc.setRandom();
+	states.joint_acc.setRandom();
+
+	// Checking that we get the same results than instance-by-instance evaluation
+	batch.computeInverseDynamics();
+	for (unsigned int i = 0; i < num_instances; i++) {
+		BOOST_CHECK_SMALL((states.joint_pos.col(i) - fbs.getDefaultPosture()).norm(), epsilon);
+
+		dwl::WholeBodyState ws;
+		batch.getState(ws, i);
+		dwl::rbd::Vector6d state_wrench;
+		Eigen::VectorXd state_forces;
+		wdyn.computeInverseDynamics(state_wrench, state_forces,
+									ws.base_pos, ws.joint_pos,
+									ws.base_vel, ws.joint_vel,
+									ws.base_acc, ws.joint_acc);
+		BOOST_CHECK_SMALL((states.base_eff.col(i) - state_wrench).norm(), epsilon);
+		BOOST_CHECK_SMALL((states.joint_eff.col(i) - state_forces).norm(), epsilon);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(fixed_size_inverse_dynamics) // specify a test case for fixed-size ID
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+	const dwl::rbd::BodySelector& ee_names = fbs.getEndEffectorNames();
+	BOOST_REQUIRE_EQUAL(fbs.getJointDoF(), 12);
+	BOOST_REQUIRE_EQUAL(fbs.getNumberOfEndEffectors(), 4);
+
+	// Defining a random state with contact forces
+	dwl::WholeBodyState ws(fbs.getJointDoF());
+	ws.base_pos = 0.1 * dwl::rbd::Vector6d::Random();
+	ws.base_vel = dwl::rbd::Vector6d::Random();
+	ws.base_acc = dwl::rbd::Vector6d::Random();
+	ws.joint_pos = fbs.getDefaultPosture() + 0.2 * Eigen::VectorXd::Random(12);
+	ws.joint_vel = Eigen::VectorXd::Random(12);
+	ws.joint_acc = Eigen::VectorXd::Random(12);
+	for (unsigned int i = 0; i < ee_names.size(); i++)
+		ws.setContactWrench_B(ee_names[i], 10. * dwl::rbd::Vector6d::Random());
+
+	// The fixed-size routine has to match the dynamic-size one
+	dwl::QuadrupedWholeBodyState fixed_ws;
+	BOOST_REQUIRE(fixed_ws.fromWholeBodyState(ws, ee_names));
+	dwl::rbd::Vector6d fixed_base_wrench, base_wrench;
+	Eigen::Matrix<double,12,1> fixed_joint_forces;
+	Eigen::VectorXd joint_forces;
+	wdyn.computeInverseDynamics(fixed_base_wrench, fixed_joint_forces, fixed_ws);
+	wdyn.computeInverseDynamics(base_wrench, joint_forces,
+								ws.base_pos, ws.joint_pos,
+								ws.base_vel, ws.joint_vel,
+								ws.base_acc, ws.joint_acc,
+								ws.contact_eff);
+	BOOST_CHECK_SMALL((fixed_base_wrench - base_wrench).norm(), epsilon);
+	BOOST_CHECK_SMALL((fixed_joint_forces - joint_forces).norm(), epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(centroidal_momentum_matrix) // specify a test case for the CMM
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	dwl::model::FloatingBaseSystem fbs;
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+
+	// Defining a robot state without base rotation rate, so the generalized position
+	// could be integrated with the generalized velocity
+	unsigned int num_joints = fbs.getJointDoF();
+	dwl::rbd::Vector6d base_pos = dwl::rbd::Vector6d::Zero();
+	dwl::rbd::Vector6d base_vel = dwl::rbd::Vector6d::Zero();
+	base_pos << 0.1, -0.05, 0.3, 0.2, 0.1, 0.6;
+	base_vel << 0., 0., 0., 0.3, -0.2, 0.1;
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture();
+	Eigen::VectorXd joint_vel = Eigen::VectorXd::LinSpaced(num_joints, -0.5, 0.5);
+	Eigen::VectorXd q_dot(6 + num_joints);
+	q_dot << base_vel, joint_vel;
+
+	Eigen::MatrixXd cmm;
+	dwl::rbd::Vector6d cmm_dot_qd;
+	wdyn.computeCentroidalMomentumMatrix(cmm, cmm_dot_qd,
+										 base_pos, joint_pos,
+										 base_vel, joint_vel);
+	BOOST_CHECK_EQUAL(cmm.rows(), 6);
+	BOOST_CHECK_EQUAL(cmm.cols(), 6 + num_joints);
+
+	// The linear momentum is the total mass times the CoM velocity
+	dwl::rbd::Vector6d momentum = cmm * q_dot;
+	Eigen::Vector3d com_vel = fbs.getSystemCoMRate(base_pos, joint_pos, base_vel, joint_vel);
+	BOOST_CHECK_SMALL((momentum.segment<3>(dwl::rbd::LX) -
+			fbs.getTotalMass() * com_vel).norm(), 1e-6);
+
+	// The bias term is the rate of momentum without generalized acceleration, which is
+	// compared with finite differences
+	double dt = 1e-6;
+	Eigen::MatrixXd cmm_next;
+	dwl::rbd::Vector6d cmm_dot_qd_next;
+	wdyn.computeCentroidalMomentumMatrix(cmm_next, cmm_dot_qd_next,
+										 base_pos + dt * base_vel,
+										 joint_pos + dt * joint_vel,
+										 base_vel, joint_vel);
+	dwl::rbd::Vector6d momentum_rate = (cmm_next * q_dot - momentum) / dt;
+	BOOST_CHECK_SMALL((momentum_rate - cmm_dot_qd).norm(), 1e-3);
+}
+
+
+BOOST_AUTO_TEST_CASE(com_kinematics) // specify a test case for the single-pass CoM kinematics
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	dwl::model::FloatingBaseSystem fbs;
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+
+	// Defining a robot state without base rotation rate, so the generalized position
+	// could be integrated with the generalized velocity
+	unsigned int num_joints = fbs.getJointDoF();
+	dwl::rbd::Vector6d base_pos = dwl::rbd::Vector6d::Zero();
+	dwl::rbd::Vector6d base_vel = dwl::rbd::Vector6d::Zero();
+	base_pos << 0.1, -0.05, 0.3, 0.2, 0.1, 0.6;
+	base_vel << 0., 0., 0., 0.3, -0.2, 0.1;
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture();
+	Eigen::VectorXd joint_vel = Eigen::VectorXd::LinSpaced(num_joints, -0.5, 0.5);
+	Eigen::VectorXd q_dot(6 + num_joints);
+	q_dot << base_vel, joint_vel;
+
+	// The CoM position and velocity are the ones of the system, and the Jacobian maps the
+	// generalized velocity to the CoM velocity
+	Eigen::Vector3d com_pos, com_vel, com_jacd_qd;
+	Eigen::MatrixXd com_jac;
+	fbs.computeSystemCoMKinematics(com_pos, com_vel, com_jac, com_jacd_qd,
+								   base_pos, joint_pos, base_vel, joint_vel);
+	BOOST_CHECK_EQUAL(com_jac.rows(), 3);
+	BOOST_CHECK_EQUAL(com_jac.cols(), 6 + num_joints);
+	BOOST_CHECK_SMALL((com_jac * q_dot - com_vel).norm(), 1e-6);
+	BOOST_CHECK_SMALL((com_vel -
+			fbs.getSystemCoMRate(base_pos, joint_pos, base_vel, joint_vel)).norm(), 1e-6);
+	BOOST_CHECK_SMALL((com_pos - fbs.getSystemCoM(base_pos, joint_pos)).norm(), 1e-6);
+
+	// The Jacobian is the linear part of the centroidal momentum matrix per mass
+	Eigen::MatrixXd cmm;
+	dwl::rbd::Vector6d cmm_dot_qd;
+	wdyn.computeCentroidalMomentumMatrix(cmm, cmm_dot_qd,
+										 base_pos, joint_pos,
+										 base_vel, joint_vel);
+	BOOST_CHECK_SMALL((cmm.bottomRows<3>() / fbs.getTotalMass() - com_jac).norm(), 1e-6);
+
+	// The bias acceleration is the rate of the CoM velocity without generalized
+	// acceleration, which is compared with finite differences
+	double dt = 1e-6;
+	Eigen::Vector3d com_pos_next, com_vel_next, com_jacd_qd_next;
+	Eigen::MatrixXd com_jac_next;
+	fbs.computeSystemCoMKinematics(com_pos_next, com_vel_next, com_jac_next, com_jacd_qd_next,
+								   base_pos + dt * base_vel, joint_pos + dt * joint_vel,
+								   base_vel, joint_vel);
+	BOOST_CHECK_SMALL(((com_vel_next - com_vel) / dt - com_jacd_qd).norm(), 1e-3);
+}
+
+
+BOOST_AUTO_TEST_CASE(inverse_dynamics_derivatives) // specify a test case for the ID derivatives
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	dwl::model::FloatingBaseSystem fbs;
+	fbs.resetFromURDFFile(urdf_file, yarf_file);
+
+	// Defining a generic robot state and the ground reaction forces
+	unsigned int num_joints = fbs.getJointDoF();
+	unsigned int system_dof = fbs.getSystemDoF();
+	dwl::rbd::Vector6d base_pos, base_vel, base_acc;
+	base_pos << 0.1, -0.05, 0.3, 0.2, 0.1, 0.6;
+	base_vel << 0.2, -0.1, 0.3, 0.3, -0.2, 0.1;
+	base_acc << -0.4, 0.3, 0.1, 0.5, 0.2, -0.3;
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture();
+	Eigen::VectorXd joint_vel = Eigen::VectorXd::LinSpaced(num_joints, -0.5, 0.5);
+	Eigen::VectorXd joint_acc = Eigen::VectorXd::LinSpaced(num_joints, 1., -1.);
+	dwl::rbd::BodySelector feet = fbs.getEndEffectorNames();
+	dwl::rbd::BodyVector6d grf;
+	for (unsigned int i = 0; i < feet.size(); i++)
+		grf[feet[i]] << 0., 0., 0., 10. * i, -5., 190.778;
+
+	Eigen::MatrixXd dtau_dq, dtau_dqd, dtau_dqdd;
+	BOOST_CHECK(wdyn.computeInverseDynamicsDerivatives(dtau_dq, dtau_dqd, dtau_dqdd,
+													   base_pos, joint_pos,
+													   base_vel, joint_vel,
+													   base_acc, joint_acc, grf));
+
+	// The derivative with respect to the acceleration is the joint-space inertia matrix
+	Eigen::MatrixXd inertia_mat = wdyn.computeJointSpaceInertiaMatrix(base_pos, joint_pos);
+	BOOST_CHECK_SMALL((dtau_dqdd - inertia_mat).norm(), 1e-9);
+
+	// Comparing the derivatives with central differences of the inverse dynamics
+	Eigen::VectorXd q = fbs.toGeneralizedJointState(base_pos, joint_pos);
+	Eigen::VectorXd qd = fbs.toGeneralizedJointState(base_vel, joint_vel);
+	Eigen::VectorXd qdd = fbs.toGeneralizedJointState(base_acc, joint_acc);
+	double h = 1e-6;
+	Eigen::MatrixXd fd_dq(system_dof, system_dof), fd_dqd(system_dof, system_dof);
+	for (unsigned int j = 0; j < system_dof; j++) {
+		Eigen::VectorXd tau_q[2], tau_qd[2];
+		for (unsigned int s = 0; s < 2; s++) {
+			Eigen::VectorXd delta = Eigen::VectorXd::Zero(system_dof);
+			delta(j) = (s == 0) ? h : -h;
+
+			dwl::rbd::Vector6d pos_base, vel_base, wrench;
+			Eigen::VectorXd pos_joint, vel_joint, forces;
+			fbs.fromGeneralizedJointState(pos_base, pos_joint, (Eigen::VectorXd) (q + delta));
+			wdyn.computeInverseDynamics(wrench, forces,
+										pos_base, pos_joint,
+										base_vel, joint_vel,
+										base_acc, joint_acc, grf);
+			tau_q[s] = fbs.toGeneralizedJointState(wrench, forces);
+
+			fbs.fromGeneralizedJointState(vel_base, vel_joint, (Eigen::VectorXd) (qd + delta));
+			wdyn.computeInverseDynamics(wrench, forces,
+										base_pos, joint_pos,
+										vel_base, vel_joint,
+										base_acc, joint_acc, grf);
+			tau_qd[s] = fbs.toGeneralizedJointState(wrench, forces);
+		}
+		fd_dq.col(j) = (tau_q[0] - tau_q[1]) / (2 * h);
+		fd_dqd.col(j) = (tau_qd[0] - tau_qd[1]) / (2 * h);
+	}
+	BOOST_CHECK_SMALL((dtau_dq - fd_dq).norm(), 1e-4 * fd_dq.norm());
+	BOOST_CHECK_SMALL((dtau_dqd - fd_dqd).norm(), 1e-4 * fd_dqd.norm());
+}
+
+
+BOOST_AUTO_TEST_CASE(contact_estimator) // specify a test case for the stateful contact estimator
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+
+	// Defining the robot state, where the first two feet are loaded
+	unsigned int num_joints = fbs.getJointDoF();
+	dwl::rbd::Vector6d base_pos = dwl::rbd::Vector6d::Zero();
+	dwl::rbd::Vector6d base_vel = dwl::rbd::Vector6d::Zero();
+	dwl::rbd::Vector6d base_acc = dwl::rbd::Vector6d::Zero();
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture();
+	Eigen::VectorXd joint_vel = Eigen::VectorXd::Zero(num_joints);
+	Eigen::VectorXd joint_acc = Eigen::VectorXd::Zero(num_joints);
+	dwl::rbd::BodySelector feet = fbs.getEndEffectorNames();
+	dwl::rbd::BodyVector6d grf;
+	for (unsigned int i = 0; i < feet.size(); i++) {
+		double load = i < 2 ? 190.778 : 0.;
+		grf[feet[i]] << 0., 0., 0., 0., 0., load;
+	}
+
+	dwl::rbd::Vector6d base_wrench;
+	Eigen::VectorXd joint_forces;
+	wdyn.computeInverseDynamics(base_wrench, joint_forces,
+								base_pos, joint_pos,
+								base_vel, joint_vel,
+								base_acc, joint_acc, grf);
+
+	// Comparing with the stateless estimation
+	dwl::rbd::BodySelector active_contacts;
+	dwl::rbd::BodyVector6d contact_forces;
+	wdyn.estimateActiveContactsAndForces(active_contacts, contact_forces,
+										 base_pos, joint_pos,
+										 base_vel, joint_vel,
+										 base_acc, joint_acc,
+										 joint_forces, feet, 30.);
+
+	dwl::model::ContactEstimator estimator;
+	estimator.reset(&wdyn, feet);
+	estimator.setForceThresholds(30., 15.);
+	estimator.setDebounceTicks(2);
+	BOOST_CHECK(estimator.update(base_pos, joint_pos,
+								 base_vel, joint_vel,
+								 base_acc, joint_acc, joint_forces));
+	const dwl::rbd::BodyContainer6d& forces = estimator.getContactForces();
+	for (unsigned int i = 0; i < feet.size(); i++)
+		BOOST_CHECK_SMALL((forces[i] - contact_forces[feet[i]]).norm(), epsilon);
+
+	// The contacts are activated after the debounce ticks, and the force maps are reused
+	dwl::rbd::BodySelector estimated_contacts;
+	estimator.getActiveContacts(estimated_contacts);
+	BOOST_CHECK(estimated_contacts.empty());
+	estimator.update(base_pos, joint_pos,
+					 base_vel, joint_vel,
+					 base_acc, joint_acc, joint_forces);
+	estimator.getActiveContacts(estimated_contacts);
+	std::sort(active_contacts.begin(), active_contacts.end());
+	std::sort(estimated_contacts.begin(), estimated_contacts.end());
+	BOOST_CHECK(estimated_contacts == active_contacts);
+	BOOST_CHECK_EQUAL(estimator.getNumberOfFactorizations(), feet.size());
+
+	// Checking the hysteresis, i.e. a force between the thresholds keeps the contact states
+	for (unsigned int i = 0; i < feet.size(); i++)
+		grf[feet[i]](dwl::rbd::LZ) = i < 2 ? 20. : 0.;
+	wdyn.computeInverseDynamics(base_wrench, joint_forces,
+								base_pos, joint_pos,
+								base_vel, joint_vel,
+								base_acc, joint_acc, grf);
+	for (unsigned int k = 0; k < 3; k++) {
+		estimator.update(base_pos, joint_pos,
+						 base_vel, joint_vel,
+						 base_acc, joint_acc, joint_forces);
+	}
+	estimator.getActiveContacts(estimated_contacts);
+	std::sort(estimated_contacts.begin(), estimated_contacts.end());
+	BOOST_CHECK(estimated_contacts == active_contacts);
+
+	// Checking that there isn't heap allocation in the incremental updates
+	num_allocations = 0;
+	count_allocations = true;
+	for (unsigned int k = 0; k < 100; k++) {
+		estimator.update(base_pos, joint_pos,
+						 base_vel, joint_vel,
+						 base_acc, joint_acc, joint_forces);
+	}
+	count_allocations = false;
+	BOOST_CHECK_EQUAL(num_allocations, 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(branch_inverse_dynamics) // specify a test case for the branch-local ID
+{
+	dwl::model::WholeBodyDynamics wdyn;
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+	wdyn.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wdyn.getFloatingBaseSystem();
+
+	// Defining a random robot state
+	unsigned int num_joints = fbs.getJointDoF();
+	dwl::rbd::Vector6d base_pos = 0.1 * dwl::rbd::Vector6d::Random();
+	dwl::rbd::Vector6d base_vel = dwl::rbd::Vector6d::Random();
+	dwl::rbd::Vector6d base_acc = dwl::rbd::Vector6d::Random();
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture() +
+			0.2 * Eigen::VectorXd::Random(num_joints);
+	Eigen::VectorXd joint_vel = Eigen::VectorXd::Random(num_joints);
+	Eigen::VectorXd joint_acc = Eigen::VectorXd::Random(num_joints);
+
+	// The branch joint forces are the ones of the whole-body RNEA
+	dwl::rbd::Vector6d base_wrench;
+	Eigen::VectorXd joint_forces;
+	wdyn.computeInverseDynamics(base_wrench, joint_forces,
+								base_pos, joint_pos,
+								base_vel, joint_vel,
+								base_acc, joint_acc);
+	for (unsigned int i = 0; i < fbs.getNumberOfEndEffectors(); i++) {
+		Eigen::VectorXd branch_forces;
+		wdyn.computeBranchInverseDynamics(branch_forces,
+										  base_pos, joint_pos,
+										  base_vel, joint_vel,
+										  base_acc, joint_acc, i);
+		BOOST_CHECK_SMALL((branch_forces - fbs.getBranchState(joint_forces, i)).norm(), epsilon);
+	}
+}
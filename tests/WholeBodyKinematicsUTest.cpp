@@ -0,0 +1,300 @@
+#include <dwl/model/WholeBodyKinematics.h>
+#include <algorithm>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+
+
+// Tolerance
+double epsilon = 0.00001;
+
+BOOST_AUTO_TEST_CASE(analytic_leg_ik) // specify a test case for the analytic leg IK
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+
+	// The system file registers the HAA-HFE-KFE IK, and the numerical IK is used otherwise
+	dwl::model::WholeBodyKinematics analytic_wkin, numerical_wkin;
+	analytic_wkin.modelFromURDFFile(urdf_file, yarf_file);
+	numerical_wkin.modelFromURDFFile(urdf_file);
+	analytic_wkin.setIKWarmStart(false);
+	numerical_wkin.setIKWarmStart(false);
+	const dwl::model::FloatingBaseSystem& fbs = analytic_wkin.getFloatingBaseSystem();
+	const dwl::rbd::BodySelector& feet = fbs.getEndEffectorNames(dwl::model::FOOT);
+
+	// Solving the IK of postures around the default one
+	dwl::rbd::Vector6d base_pos = dwl::rbd::Vector6d::Zero();
+	for (unsigned int k = 0; k < 20; k++) {
+		Eigen::VectorXd joint_pos = fbs.getDefaultPosture() +
+				0.2 * Eigen::VectorXd::Random(fbs.getJointDoF());
+		dwl::rbd::BodyVectorXd fk_pos;
+		analytic_wkin.computeForwardKinematics(fk_pos, base_pos, joint_pos,
+											   feet, dwl::rbd::Linear);
+		dwl::rbd::BodyVector3d feet_pos;
+		for (unsigned int f = 0; f < feet.size(); f++)
+			feet_pos[feet[f]] = fk_pos[feet[f]];
+
+		// Both IKs have to reach the feet positions from the default posture
+		Eigen::VectorXd analytic_pos, numerical_pos;
+		BOOST_CHECK(analytic_wkin.computeJointPosition(analytic_pos, feet_pos,
+													   fbs.getDefaultPosture()));
+		BOOST_CHECK(numerical_wkin.computeJointPosition(numerical_pos, feet_pos,
+														fbs.getDefaultPosture()));
+		BOOST_CHECK_SMALL((analytic_pos - joint_pos).norm(), epsilon);
+		BOOST_CHECK_SMALL((numerical_pos - joint_pos).norm(), epsilon);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(stacked_contact_jacobian) // specify a test case for the contact jacobian
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+
+	dwl::model::WholeBodyKinematics wkin;
+	wkin.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wkin.getFloatingBaseSystem();
+	const dwl::rbd::BodySelector& feet = fbs.getEndEffectorNames(dwl::model::FOOT);
+
+	dwl::rbd::Vector6d base_pos = 0.1 * dwl::rbd::Vector6d::Random();
+	dwl::rbd::Vector6d base_vel = dwl::rbd::Vector6d::Random();
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture() +
+			0.2 * Eigen::VectorXd::Random(fbs.getJointDoF());
+	Eigen::VectorXd joint_vel = Eigen::VectorXd::Random(fbs.getJointDoF());
+
+	// The stacked jacobian and J_d*q_d have to match the per-body computations
+	Eigen::MatrixXd contact_jac, fixed_jac, full_jac, expected_fixed_jac;
+	Eigen::VectorXd jacd_qd;
+	wkin.computeContactJacobian(contact_jac, jacd_qd,
+								base_pos, joint_pos,
+								base_vel, joint_vel,
+								feet);
+	wkin.computeContactJacobian(fixed_jac,
+								base_pos, joint_pos,
+								feet, true);
+	wkin.computeJacobian(full_jac, base_pos, joint_pos, feet, dwl::rbd::Linear);
+	wkin.getFixedBaseJacobian(expected_fixed_jac, full_jac);
+	BOOST_CHECK_SMALL((contact_jac - full_jac).norm(), epsilon);
+	BOOST_CHECK_SMALL((fixed_jac - expected_fixed_jac).norm(), epsilon);
+
+	dwl::rbd::BodyVectorXd expected_jacd_qd;
+	wkin.computeJdotQdot(expected_jacd_qd,
+						 base_pos, joint_pos,
+						 base_vel, joint_vel,
+						 feet, dwl::rbd::Linear);
+	for (unsigned int f = 0; f < feet.size(); f++)
+		BOOST_CHECK_SMALL((jacd_qd.segment<3>(3 * f) - expected_jacd_qd[feet[f]]).norm(), epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(batch_forward_kinematics) // specify a test case for batched FK
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+
+	dwl::model::WholeBodyKinematics wkin;
+	wkin.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wkin.getFloatingBaseSystem();
+	const dwl::rbd::BodySelector& feet = fbs.getEndEffectorNames(dwl::model::FOOT);
+
+	// Defining a batch of random states, where every column is a state
+	unsigned int num_states = 10;
+	Eigen::MatrixXd base_pos = 0.1 * Eigen::MatrixXd::Random(6, num_states);
+	Eigen::MatrixXd joint_pos = 0.2 * Eigen::MatrixXd::Random(fbs.getJointDoF(), num_states);
+	for (unsigned int k = 0; k < num_states; k++)
+		joint_pos.col(k) += fbs.getDefaultPosture();
+
+	// The batch has to match the state-by-state evaluation, where the bodies are stacked
+	Eigen::MatrixXd op_pos;
+	wkin.computeForwardKinematics(op_pos, base_pos, joint_pos, feet,
+								  dwl::rbd::Full, dwl::Quaternion, 3);
+	BOOST_CHECK_EQUAL(op_pos.rows(), 7 * feet.size());
+	BOOST_CHECK_EQUAL(op_pos.cols(), num_states);
+	for (unsigned int k = 0; k < num_states; k++) {
+		dwl::rbd::BodyVectorXd fk_pos;
+		wkin.computeForwardKinematics(fk_pos, base_pos.col(k), joint_pos.col(k), feet,
+									  dwl::rbd::Full, dwl::Quaternion);
+		for (unsigned int f = 0; f < feet.size(); f++)
+			BOOST_CHECK_SMALL((op_pos.block(7 * f, k, 7, 1) - fk_pos[feet[f]]).norm(), epsilon);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(trajectory_contact_kinematics) // specify a test case for the trajectory-wide contacts
+{
+	std::string urdf_file = DWL_SOURCE_DIR"/sample/hyq.urdf";
+	std::string yarf_file = DWL_SOURCE_DIR"/config/hyq.yarf";
+
+	dwl::model::WholeBodyKinematics wkin;
+	wkin.modelFromURDFFile(urdf_file, yarf_file);
+	const dwl::model::FloatingBaseSystem& fbs = wkin.getFloatingBaseSystem();
+	dwl::rbd::BodySelector feet = fbs.getEndEffectorNames(dwl::model::FOOT);
+
+	// Defining a trajectory of random states, where the last contact isn't a body
+	unsigned int num_points = 10;
+	std::vector<std::string> contact_names = feet;
+	contact_names.push_back("no_body");
+	dwl::WholeBodyTrajectoryContainer trajectory;
+	trajectory.resize(num_points, fbs.getJointDoF(), contact_names);
+	trajectory.base_pos = 0.1 * Eigen::MatrixXd::Random(6, num_points);
+	trajectory.base_vel = Eigen::MatrixXd::Random(6, num_points);
+	trajectory.base_acc = Eigen::MatrixXd::Random(6, num_points);
+	trajectory.joint_pos = 0.2 * Eigen::MatrixXd::Random(fbs.getJointDoF(), num_points);
+	trajectory.joint_vel = Eigen::MatrixXd::Random(fbs.getJointDoF(), num_points);
+	trajectory.joint_acc = Eigen::MatrixXd::Random(fbs.getJointDoF(), num_points);
+	for (unsigned int k = 0; k < num_points; k++)
+		trajectory.joint_pos.col(k) += fbs.getDefaultPosture();
+
+	// The trajectory-wide computation has to match the separated ones of every point
+	wkin.computeContactKinematics(trajectory, 3);
+	unsigned int no_body = feet.size();
+	for (unsigned int k = 0; k < num_points; k++) {
+		dwl::rbd::Vector6d base_pos = trajectory.base_pos.col(k);
+		dwl::rbd::Vector6d base_vel = trajectory.base_vel.col(k);
+		dwl::rbd::Vector6d base_acc = trajectory.base_acc.col(k);
+		Eigen::VectorXd joint_pos = trajectory.joint_pos.col(k);
+		Eigen::VectorXd joint_vel = trajectory.joint_vel.col(k);
+		Eigen::VectorXd joint_acc = trajectory.joint_acc.col(k);
+		dwl::rbd::BodyVectorXd fk_pos, fk_vel, fk_acc;
+		wkin.computeForwardKinematics(fk_pos, base_pos, joint_pos, feet, dwl::rbd::Linear);
+		wkin.computeVelocity(fk_vel, base_pos, joint_pos, base_vel, joint_vel,
+							 feet, dwl::rbd::Linear);
+		wkin.computeAcceleration(fk_acc, base_pos, joint_pos, base_vel, joint_vel,
+								 base_acc, joint_acc, feet, dwl::rbd::Linear);
+		for (unsigned int f = 0; f < feet.size(); f++) {
+			BOOST_CHECK(trajectory.hasContact(k, f,
+					dwl::WholeBodyTrajectoryContainer::ACCELERATION));
+			BOOST_CHECK_SMALL((trajectory.contact_pos.block<3,1>(3 * f, k) -
+					fk_pos[feet[f]]).norm(), epsilon);
+			BOOST_CHECK_SMALL((trajectory.contact_vel.block<3,1>(3 * f, k) -
+					fk_vel[feet[f]]).norm(), epsilon);
+			BOOST_CHECK_SMALL((trajectory.contact_acc.block<3,1>(3 * f, k) -
+					fk_acc[feet[f]]).norm(), epsilon);
+		}
+		BOOST_CHECK(!trajectory.hasContact(k, no_body,
+				dwl::WholeBodyTrajectoryContainer::POSITION));
+	}
+
+	// The per-state version updates the kinematics once for the three quantities
+	dwl::rbd::BodyVectorXd contact_pos, contact_vel, contact_acc;
+	wkin.computeContactKinematics(contact_pos, contact_vel, contact_acc,
+								  trajectory.base_pos.col(0), trajectory.joint_pos.col(0),
+								  trajectory.base_vel.col(0), trajectory.joint_vel.col(0),
+								  trajectory.base_acc.col(0), trajectory.joint_acc.col(0),
+								  contact_names);
+	BOOST_CHECK_EQUAL(contact_acc.size(), feet.size());
+	BOOST_CHECK_SMALL((contact_acc[feet[0]] - trajectory.contact_acc.block<3,1>(0,0)).norm(),
+					  epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(branch_tables) // specify a test case for the precomputed branches
+{
+	dwl::model::FloatingBaseSystem fbs;
+	fbs.resetFromURDFFile(DWL_SOURCE_DIR"/sample/hyq.urdf", DWL_SOURCE_DIR"/config/hyq.yarf");
+	const dwl::rbd::BodySelector& names = fbs.getEndEffectorNames();
+
+	// The index-based branches are the ones of the end-effector names
+	Eigen::VectorXd joint_pos = Eigen::VectorXd::Random(fbs.getJointDoF());
+	for (unsigned int i = 0; i < names.size(); i++) {
+		BOOST_CHECK_EQUAL(fbs.getEndEffectorIndex(names[i]), i);
+
+		unsigned int pos_idx, num_dof, ee_pos_idx, ee_num_dof;
+		fbs.getBranch(pos_idx, num_dof, names[i]);
+		fbs.getBranch(ee_pos_idx, ee_num_dof, i);
+		BOOST_CHECK_EQUAL(ee_num_dof, num_dof);
+		BOOST_CHECK_EQUAL(ee_pos_idx, pos_idx);
+		BOOST_CHECK(fbs.getBranchState(joint_pos, i) == fbs.getBranchState(joint_pos, names[i]));
+
+		Eigen::VectorXd new_joint_pos = joint_pos;
+		fbs.setBranchState(new_joint_pos, Eigen::VectorXd::Zero(num_dof), i);
+		BOOST_CHECK_SMALL(fbs.getBranchState(new_joint_pos, names[i]).norm(), epsilon);
+	}
+	BOOST_CHECK_EQUAL(fbs.getEndEffectorIndex("unknown"), names.size());
+
+	// The total mass is the one of the bodies
+	double mass = 0.;
+	const RigidBodyDynamics::Model& model = fbs.getRBDModel();
+	for (unsigned int i = 0; i < model.mBodies.size(); i++)
+		mass += model.mBodies[i].mMass;
+	BOOST_CHECK_CLOSE(fbs.getTotalMass(), mass, epsilon);
+	BOOST_CHECK_EQUAL(fbs.getJointIds().size(), fbs.getJointNames().size());
+}
+
+
+BOOST_AUTO_TEST_CASE(branch_kinematics) // specify a test case for the branch-local kinematics
+{
+	dwl::model::WholeBodyKinematics wkin;
+	wkin.modelFromURDFFile(DWL_SOURCE_DIR"/sample/hyq.urdf", DWL_SOURCE_DIR"/config/hyq.yarf");
+	const dwl::model::FloatingBaseSystem& fbs = wkin.getFloatingBaseSystem();
+	const dwl::rbd::BodySelector& names = fbs.getEndEffectorNames();
+
+	// The branch quantities are the ones of the whole tree
+	dwl::rbd::Vector6d base_pos = 0.1 * dwl::rbd::Vector6d::Random();
+	Eigen::VectorXd joint_pos = fbs.getDefaultPosture() +
+			0.2 * Eigen::VectorXd::Random(fbs.getJointDoF());
+	dwl::rbd::BodyVectorXd fk_pos;
+	Eigen::MatrixXd full_jac;
+	wkin.computeForwardKinematics(fk_pos, base_pos, joint_pos, names, dwl::rbd::Linear);
+	wkin.computeJacobian(full_jac, base_pos, joint_pos, names, dwl::rbd::Linear);
+	for (unsigned int i = 0; i < names.size(); i++) {
+		unsigned int pos_idx, num_dof;
+		fbs.getBranch(pos_idx, num_dof, i);
+
+		Eigen::Vector3d branch_pos;
+		Eigen::MatrixXd branch_jac;
+		wkin.computeBranchForwardKinematics(branch_pos, base_pos, joint_pos, i);
+		BOOST_CHECK_SMALL((branch_pos - fk_pos[names[i]]).norm(), epsilon);
+		wkin.computeBranchJacobian(branch_jac, base_pos, joint_pos, i);
+		BOOST_CHECK_EQUAL(branch_jac.cols(), num_dof);
+		BOOST_CHECK_SMALL((branch_jac - full_jac.block(3 * i, pos_idx, 3, num_dof)).norm(),
+						  epsilon);
+	}
+
+	// The chains start in the root, and the subtrees in the first branch joint
+	for (unsigned int i = 0; i < names.size(); i++) {
+		const std::vector<unsigned int>& chain = fbs.getBranchBodyIds(i);
+		const std::vector<unsigned int>& subtree = fbs.getBranchSubtreeIds(i);
+		BOOST_CHECK_EQUAL(fbs.getRBDModel().lambda[chain.front()], 0);
+		BOOST_CHECK(std::find(chain.begin(), chain.end(), subtree.front()) != chain.end());
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(kinematics_cache) // specify a test case for the cached kinematics state
+{
+	dwl::model::FloatingBaseSystem fbs, reference_fbs;
+	fbs.resetFromURDFFile(DWL_SOURCE_DIR"/sample/hyq.urdf", DWL_SOURCE_DIR"/config/hyq.yarf");
+	reference_fbs.resetFromURDFFile(DWL_SOURCE_DIR"/sample/hyq.urdf",
+									DWL_SOURCE_DIR"/config/hyq.yarf");
+	RigidBodyDynamics::Model& model = fbs.getRBDModel();
+	RigidBodyDynamics::Model& reference = reference_fbs.getRBDModel();
+	Eigen::VectorXd q = 0.2 * Eigen::VectorXd::Random(model.q_size);
+	Eigen::VectorXd qd = Eigen::VectorXd::Random(model.qdot_size);
+	Eigen::VectorXd qdd = Eigen::VectorXd::Random(model.qdot_size);
+
+	// A velocity-only update after a position update (i.e. with the cached position) is
+	// the full update of the model
+	fbs.updateKinematics(q);
+	fbs.updateKinematics(q, &qd);
+	RigidBodyDynamics::UpdateKinematicsCustom(reference, &q, &qd, NULL);
+	for (unsigned int i = 1; i < model.mBodies.size(); i++)
+		BOOST_CHECK_SMALL((model.v[i] - reference.v[i]).norm(), epsilon);
+
+	// And the same for an acceleration-only update
+	fbs.updateKinematics(q, &qd, &qdd);
+	RigidBodyDynamics::UpdateKinematicsCustom(reference, &q, &qd, &qdd);
+	for (unsigned int i = 1; i < model.mBodies.size(); i++)
+		BOOST_CHECK_SMALL((model.a[i] - reference.a[i]).norm(), epsilon);
+
+	// A new velocity at the cached position changes only the velocity level
+	qd = Eigen::VectorXd::Random(model.qdot_size);
+	fbs.updateKinematics(q, &qd);
+	RigidBodyDynamics::UpdateKinematicsCustom(reference, &q, &qd, NULL);
+	for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+		BOOST_CHECK_SMALL((model.X_base[i].r - reference.X_base[i].r).norm(), epsilon);
+		BOOST_CHECK_SMALL((model.v[i] - reference.v[i]).norm(), epsilon);
+	}
+}
@@ -1,4 +1,6 @@
 #include <dwl/WholeBodyState.h>
+#include <dwl/TrajectoryContainer.h>
+#include <dwl/FixedWholeBodyState.h>
 
 #define BOOST_TEST_MODULE DWL_TESTS
 #include <boost/test/included/unit_test.hpp>
@@ -182,3 +184,333 @@ BOOST_AUTO_TEST_CASE(base_joint) // specify a test case for joint states
 	for (unsigned int i = 0; i < old_joint_state.size(); i++)
 		BOOST_CHECK_SMALL((double) (new_joint_state(i) - old_joint_state(i)), epsilon);
 }
+
+
+BOOST_AUTO_TEST_CASE(state_move) // specify a test case for moving the whole-body states
+{
+	// The vectors of a moved state are transferred instead of copied
+	dwl::WholeBodyState ws(12);
+	ws.setJointPosition(Eigen::VectorXd::Constant(12, 0.5));
+	const double* joint_pos = ws.joint_pos.data();
+	dwl::WholeBodyState moved_ws(std::move(ws));
+	BOOST_CHECK(moved_ws.joint_pos.data() == joint_pos);
+	BOOST_CHECK_SMALL(moved_ws.getJointPosition(3) - 0.5, epsilon);
+
+	// A trajectory of states doesn't copy them when it grows
+	dwl::WholeBodyTrajectory trajectory;
+	trajectory.reserve(2);
+	trajectory.push_back(std::move(moved_ws));
+	trajectory.emplace_back(12);
+	BOOST_CHECK(trajectory[0].joint_pos.data() == joint_pos);
+	BOOST_CHECK_EQUAL(trajectory[1].getJointDoF(), 12);
+}
+
+
+BOOST_AUTO_TEST_CASE(trajectory_container) // specify a test case for trajectory containers
+{
+	// Defining a whole-body trajectory where the contacts change
+	dwl::WholeBodyTrajectory trajectory(3, dwl::WholeBodyState(2));
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		trajectory[k].time = 0.1 * k;
+		trajectory[k].setBasePosition(Eigen::Vector3d(0.1 * k, 0.2, 0.6));
+		trajectory[k].setJointPosition(Eigen::Vector2d(0.5, -0.2 * k));
+		trajectory[k].setContactWrench_B("lf_foot", dwl::rbd::Vector6d::Ones() * k);
+	}
+	trajectory[1].setContactPosition_B("lf_foot", Eigen::Vector3d(0.3, 0.2, -0.5));
+
+	// Testing the round trip between the trajectory and the container
+	dwl::WholeBodyTrajectoryContainer container;
+	container.fromTrajectory(trajectory);
+	BOOST_CHECK_EQUAL(container.size(), 3);
+	BOOST_CHECK_EQUAL(container.getJointDoF(), 2);
+	BOOST_CHECK_EQUAL(container.getContactIndex("lf_foot"), 0);
+	BOOST_CHECK(!container.hasContact(0, 0, dwl::WholeBodyTrajectoryContainer::POSITION));
+	BOOST_CHECK(container.hasContact(1, 0, dwl::WholeBodyTrajectoryContainer::POSITION));
+
+	dwl::WholeBodyTrajectory new_trajectory;
+	container.toTrajectory(new_trajectory);
+	BOOST_CHECK_EQUAL(new_trajectory.size(), trajectory.size());
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		BOOST_CHECK_SMALL(new_trajectory[k].time - trajectory[k].time, epsilon);
+		BOOST_CHECK_SMALL((new_trajectory[k].base_pos - trajectory[k].base_pos).norm(), epsilon);
+		BOOST_CHECK_SMALL((new_trajectory[k].joint_pos - trajectory[k].joint_pos).norm(), epsilon);
+		BOOST_CHECK_EQUAL(new_trajectory[k].contact_pos.size(), trajectory[k].contact_pos.size());
+		BOOST_CHECK_SMALL((new_trajectory[k].contact_eff["lf_foot"] -
+				trajectory[k].contact_eff["lf_foot"]).norm(), epsilon);
+	}
+
+	// Testing the state view
+	dwl::WholeBodyTrajectoryContainer::StateView view = container.getView(2);
+	view.joint_pos()(1) = 1.5;
+	view.contact_pos(0) = Eigen::Vector3d(0.1, 0.1, -0.4);
+	BOOST_CHECK_SMALL(container.joint_pos(1,2) - 1.5, epsilon);
+	BOOST_CHECK(container.hasContact(2, 0, dwl::WholeBodyTrajectoryContainer::POSITION));
+
+	// Testing the reduced-body container
+	dwl::ReducedBodyTrajectory reduced_trajectory(2);
+	reduced_trajectory[0].com_pos = Eigen::Vector3d(0., 0., 0.55);
+	reduced_trajectory[1].com_pos = Eigen::Vector3d(0.1, 0., 0.55);
+	reduced_trajectory[1].support_region["rh_foot"] = Eigen::Vector3d(-0.3, -0.2, 0.);
+
+	dwl::ReducedBodyTrajectoryContainer reduced_container;
+	reduced_container.fromTrajectory(reduced_trajectory);
+	BOOST_CHECK_SMALL(reduced_container.com_pos(0,1) - 0.1, epsilon);
+	BOOST_CHECK(!reduced_container.hasFoot(0, 0, dwl::ReducedBodyTrajectoryContainer::SUPPORT));
+
+	dwl::ReducedBodyState reduced_state;
+	reduced_container.getState(reduced_state, 1);
+	BOOST_CHECK_SMALL((reduced_state.support_region["rh_foot"] -
+			Eigen::Vector3d(-0.3, -0.2, 0.)).norm(), epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(trajectory_query) // specify a test case for the time-indexed trajectory queries
+{
+	// Defining a uniform trajectory of a cubic motion, which is reproduced by the Hermite
+	// interpolation
+	dwl::WholeBodyTrajectory trajectory(11, dwl::WholeBodyState(2));
+	for (unsigned int k = 0; k < trajectory.size(); k++) {
+		double t = 0.1 * k;
+		trajectory[k].time = t;
+		trajectory[k].joint_pos << t * t * t, 1.;
+		trajectory[k].joint_vel << 3 * t * t, 0.;
+		trajectory[k].joint_eff << t, 0.;
+		trajectory[k].setContactPosition_B("lf_foot", Eigen::Vector3d(t, 0., -0.5));
+	}
+	trajectory[6].contact_pos.erase("lf_foot");
+
+	dwl::WholeBodyTrajectoryQuery query;
+	query.reset(trajectory);
+	BOOST_CHECK(query.getTimeIndex().isUniform());
+	BOOST_CHECK_EQUAL(query.getSegment(0.35), 3);
+	BOOST_CHECK_EQUAL(query.getSegment(trajectory[3].time), 3);
+	BOOST_CHECK_EQUAL(query.getSegment(1.5), 9);
+
+	dwl::WholeBodyState state;
+	BOOST_CHECK(query.getState(state, 0.37));
+	BOOST_CHECK_SMALL(state.joint_pos(0) - pow(0.37, 3), epsilon);
+	BOOST_CHECK_SMALL(state.joint_vel(0) - 3 * pow(0.37, 2), epsilon);
+	BOOST_CHECK_SMALL(state.joint_acc(0) - 6 * 0.37, epsilon);
+	BOOST_CHECK_SMALL(state.joint_eff(0) - 0.37, epsilon);
+	BOOST_CHECK_SMALL(state.getContactPosition_B("lf_foot")(0) - 0.37, epsilon);
+
+	// A contact that is not defined in the end of the segment is held, and it's missing
+	// in the segments that start without it
+	BOOST_CHECK(query.getState(state, 0.55));
+	BOOST_CHECK_SMALL(state.getContactPosition_B("lf_foot")(0) - 0.5, epsilon);
+	BOOST_CHECK(query.getState(state, 0.65));
+	BOOST_CHECK_EQUAL(state.contact_pos.count("lf_foot"), 0);
+	BOOST_CHECK(!query.getState(state, 1.2));
+	BOOST_CHECK_SMALL(state.time - 1., epsilon);
+
+	// The non-uniform trajectories are searched
+	trajectory[4].time = 0.42;
+	query.reset(trajectory);
+	BOOST_CHECK(!query.getTimeIndex().isUniform());
+	BOOST_CHECK_EQUAL(query.getSegment(0.41), 3);
+	BOOST_CHECK_EQUAL(query.getSegment(0.42), 4);
+	BOOST_CHECK_EQUAL(query.getSegment(0.95), 9);
+	BOOST_CHECK_EQUAL(query.getSegment(-1.), 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(fixed_size_state) // specify a test case for fixed-size states
+{
+	dwl::rbd::BodySelector feet = {"lf_foot", "lh_foot", "rf_foot", "rh_foot"};
+	dwl::WholeBodyState ws(12);
+	ws.base_pos << 0.1, -0.2, 0.3, 1., 2., 0.5;
+	ws.base_vel = dwl::rbd::Vector6d::Random();
+	ws.joint_pos = Eigen::VectorXd::Random(12);
+	ws.joint_vel = Eigen::VectorXd::Random(12);
+	for (unsigned int f = 0; f < feet.size(); f++) {
+		ws.setContactPosition_B(feet[f], Eigen::Vector3d::Random());
+		ws.setContactVelocity_B(feet[f], Eigen::Vector3d::Random());
+	}
+
+	// The fixed-size state has to describe the same state
+	dwl::QuadrupedWholeBodyState fixed_ws;
+	BOOST_CHECK(fixed_ws.fromWholeBodyState(ws, feet));
+	BOOST_CHECK(!fixed_ws.fromWholeBodyState(ws, dwl::rbd::BodySelector(2, "lf_foot")));
+	dwl::QuadrupedWholeBodyState::ContactMatrix3d pos_W, vel_W;
+	fixed_ws.getContactPosition_W(pos_W);
+	fixed_ws.getContactVelocity_W(vel_W);
+	for (unsigned int f = 0; f < feet.size(); f++) {
+		BOOST_CHECK_SMALL((pos_W.col(f) - ws.getContactPosition_W(feet[f])).norm(), epsilon);
+		BOOST_CHECK_SMALL((vel_W.col(f) - ws.getContactVelocity_W(feet[f])).norm(), epsilon);
+	}
+
+	// Setting the contact positions from the world frame
+	fixed_ws.setContactPosition_W(pos_W);
+	for (unsigned int f = 0; f < feet.size(); f++)
+		BOOST_CHECK_SMALL((fixed_ws.contact_pos.col(f) -
+				ws.getContactPosition_B(feet[f])).norm(), epsilon);
+
+	// Checking the conversion of generalized states, which uses the RBDL order
+	dwl::QuadrupedWholeBodyState::GeneralizedVector q;
+	fixed_ws.getGeneralizedPosition(q);
+	BOOST_CHECK_SMALL((q.head<3>() - ws.getBasePosition()).norm(), epsilon);
+	BOOST_CHECK_SMALL((q.segment<3>(3) - ws.getBaseRPY()).norm(), epsilon);
+	dwl::QuadrupedWholeBodyState other_ws;
+	other_ws.setGeneralizedPosition(q);
+	BOOST_CHECK_SMALL((other_ws.base_pos - ws.base_pos).norm(), epsilon);
+	BOOST_CHECK_SMALL((other_ws.joint_pos - ws.joint_pos).norm(), epsilon);
+
+	// The dynamic-size state has the same generalized states, which are written in
+	// caller-owned buffers
+	Eigen::VectorXd gen_pos, gen_vel;
+	ws.getGeneralizedPosition(gen_pos);
+	ws.getGeneralizedVelocity(gen_vel);
+	BOOST_CHECK_SMALL((gen_pos - q).norm(), epsilon);
+	const double* gen_pos_data = gen_pos.data();
+	ws.getGeneralizedPosition(gen_pos);
+	BOOST_CHECK(gen_pos.data() == gen_pos_data);
+	dwl::WholeBodyState other_dyn_ws(12);
+	other_dyn_ws.setGeneralizedPosition(gen_pos);
+	other_dyn_ws.setGeneralizedVelocity(gen_vel);
+	BOOST_CHECK_SMALL((other_dyn_ws.base_pos - ws.base_pos).norm(), epsilon);
+	BOOST_CHECK_SMALL((other_dyn_ws.base_vel - ws.base_vel).norm(), epsilon);
+	BOOST_CHECK_SMALL((other_dyn_ws.joint_vel - ws.joint_vel).norm(), epsilon);
+
+	// Converting back to a whole-body state
+	dwl::WholeBodyState new_ws;
+	fixed_ws.toWholeBodyState(new_ws, feet);
+	BOOST_CHECK_EQUAL(new_ws.getJointDoF(), 12);
+	BOOST_CHECK_SMALL((new_ws.joint_vel - ws.joint_vel).norm(), epsilon);
+	for (unsigned int f = 0; f < feet.size(); f++)
+		BOOST_CHECK_SMALL((new_ws.getContactPosition_W(feet[f]) -
+				ws.getContactPosition_W(feet[f])).norm(), epsilon);
+
+	// A swing foot is an inactive slot, which isn't copied to the whole-body state
+	BOOST_CHECK_EQUAL(fixed_ws.getNumberOfActiveContacts(), 4);
+	ws.contact_pos.erase("rf_foot");
+	ws.contact_vel.erase("rf_foot");
+	BOOST_CHECK(fixed_ws.fromWholeBodyState(ws, feet));
+	BOOST_CHECK(!fixed_ws.isActiveContact(2));
+	BOOST_CHECK_EQUAL(fixed_ws.getNumberOfActiveContacts(), 3);
+	BOOST_CHECK(fixed_ws.contact_pos.col(2).isZero());
+	fixed_ws.toWholeBodyState(new_ws, feet);
+	BOOST_CHECK_EQUAL(new_ws.contact_pos.size(), 3);
+	BOOST_CHECK_EQUAL(new_ws.contact_pos.count("rf_foot"), 0);
+	fixed_ws.setActiveContact(0, false);
+	BOOST_CHECK(fixed_ws.contact_pos.col(0).isZero());
+	BOOST_CHECK_EQUAL(fixed_ws.getNumberOfActiveContacts(), 2);
+}
+
+
+BOOST_AUTO_TEST_CASE(cached_rotations) // specify a test case for cached rotations and bulk getters
+{
+	dwl::WholeBodyState ws(0);
+	ws.setBasePosition(Eigen::Vector3d(0.1, 0.2, 0.6));
+	ws.setBaseRPY(Eigen::Vector3d(0.1, -0.2, 0.5));
+	ws.setBaseVelocity_W(Eigen::Vector3d(0.3, 0.1, 0.));
+	ws.setBaseAngularVelocity_W(Eigen::Vector3d(0.1, 0.2, 0.3));
+	ws.setBaseAcceleration_W(Eigen::Vector3d(0., 0.2, 0.1));
+	ws.setBaseAngularAcceleration_W(Eigen::Vector3d(0.2, 0.1, 0.));
+	ws.setContactPosition_B("lf_foot", Eigen::Vector3d(0.3, 0.2, -0.5));
+	ws.setContactPosition_B("rh_foot", Eigen::Vector3d(-0.3, -0.2, -0.5));
+	ws.setContactVelocity_B("lf_foot", Eigen::Vector3d(0.1, 0., 0.2));
+	ws.setContactVelocity_B("rh_foot", Eigen::Vector3d(0., 0.1, 0.));
+	ws.setContactAcceleration_B("lf_foot", Eigen::Vector3d(0.1, 0.1, 0.));
+	ws.setContactAcceleration_B("rh_foot", Eigen::Vector3d(0., 0., 0.3));
+
+	// The bulk getters have to match the per-contact ones, and set the missing contacts
+	// to zero
+	dwl::rbd::BodySelector names;
+	names.push_back("lf_foot");
+	names.push_back("rh_foot");
+	names.push_back("lh_foot");
+	dwl::rbd::BodyContainer3d pos_W, pos_H, vel_W, vel_H, acc_W;
+	pos_W.reset(names);
+	pos_H.reset(names);
+	vel_W.reset(names);
+	vel_H.reset(names);
+	acc_W.reset(names);
+	ws.getContactPosition_W(pos_W);
+	ws.getContactPosition_H(pos_H);
+	ws.getContactVelocity_W(vel_W);
+	ws.getContactVelocity_H(vel_H);
+	ws.getContactAcceleration_W(acc_W);
+	for (unsigned int k = 0; k < 2; k++) {
+		for (unsigned int i = 0; i < 3; i++) {
+			BOOST_CHECK_SMALL(pos_W[k](i) - ws.getContactPosition_W(names[k])(i), epsilon);
+			BOOST_CHECK_SMALL(pos_H[k](i) - ws.getContactPosition_H(names[k])(i), epsilon);
+			BOOST_CHECK_SMALL(vel_W[k](i) - ws.getContactVelocity_W(names[k])(i), epsilon);
+			BOOST_CHECK_SMALL(vel_H[k](i) - ws.getContactVelocity_H(names[k])(i), epsilon);
+			BOOST_CHECK_SMALL(acc_W[k](i) - ws.getContactAcceleration_W(names[k])(i), epsilon);
+		}
+	}
+	BOOST_CHECK_SMALL(pos_W[2].norm(), epsilon);
+	BOOST_CHECK_SMALL(vel_W[2].norm(), epsilon);
+
+	// The cached rotation has to follow the base orientation, even if it's modified directly
+	ws.base_pos(dwl::rbd::AZ) = -0.4;
+	Eigen::Matrix3d W_rot_B =
+			dwl::math::getQuaternion(ws.getBaseRPY()).toRotationMatrix();
+	BOOST_CHECK_SMALL((ws.getBaseToWorldRotation() - W_rot_B).norm(), epsilon);
+	BOOST_CHECK_SMALL((ws.getBaseVelocity_B() -
+			W_rot_B.transpose() * ws.getBaseVelocity_W()).norm(), epsilon);
+}
+
+
+BOOST_AUTO_TEST_CASE(orientation_conversions) // specify a test case for orientation conversions
+{
+	Eigen::Vector3d rpy(0.3, -0.7, 2.1);
+	Eigen::Quaterniond q = dwl::math::getQuaternion(rpy);
+	Eigen::Matrix3d W_rot_B = dwl::math::getRotationMatrix(rpy);
+
+	// The closed-form rotation matrix and the double-precision angles have to be consistent
+	BOOST_CHECK_SMALL((W_rot_B - q.toRotationMatrix()).norm(), 1e-12);
+	BOOST_CHECK_SMALL((dwl::math::getRPY(W_rot_B) - rpy).norm(), 1e-12);
+	BOOST_CHECK_SMALL(dwl::math::getYaw(q) - rpy(2), 1e-12);
+
+	// The quaternion overloads of the horizontal frame don't use the RPY angles
+	dwl::math::FrameTF tf;
+	BOOST_CHECK_SMALL((tf.getHorizontalToWorldRotation(q) -
+			tf.getHorizontalToWorldRotation(rpy)).norm(), 1e-12);
+	BOOST_CHECK_SMALL((tf.getBaseToHorizontalRotation(q) -
+			tf.getBaseToHorizontalRotation(rpy)).norm(), 1e-12);
+	BOOST_CHECK_SMALL((tf.getHorizontalToWorldRotation(q) *
+			tf.getBaseToHorizontalRotation(q) - W_rot_B).norm(), 1e-12);
+
+	// The pitch angle is well defined in the gimbal lock
+	Eigen::Vector3d rpy_lock = dwl::math::getRPY(
+			dwl::math::getRotationMatrix(Eigen::Vector3d(0., M_PI / 2., 0.)));
+	BOOST_CHECK(rpy_lock.allFinite());
+	BOOST_CHECK_SMALL(rpy_lock(1) - M_PI / 2., 1e-6);
+}
+
+
+BOOST_AUTO_TEST_CASE(batch_frame_transforms) // specify a test case for batch frame transforms
+{
+	dwl::math::FrameTF tf;
+	Eigen::Vector3d rpy(0.2, -0.1, 0.8);
+	Eigen::Quaterniond q = dwl::math::getQuaternion(rpy);
+	Eigen::Matrix3Xd vecs = Eigen::Matrix3Xd::Random(3, 5);
+
+	// The batch transforms have to match the transforms of every vector
+	Eigen::Matrix3Xd vecs_B, vecs_H, vecs_W;
+	tf.fromWorldToBaseFrame(vecs_B, vecs, rpy);
+	tf.fromBaseToHorizontalFrame(vecs_H, vecs, q);
+	tf.fromHorizontalToWorldFrame(vecs_W, vecs, rpy(2));
+	for (unsigned int i = 0; i < vecs.cols(); i++) {
+		Eigen::Vector3d vec = vecs.col(i);
+		BOOST_CHECK_SMALL((vecs_B.col(i) - tf.fromWorldToBaseFrame(vec, rpy)).norm(), 1e-12);
+		BOOST_CHECK_SMALL((vecs_H.col(i) - tf.fromBaseToHorizontalFrame(vec, rpy)).norm(), 1e-12);
+		BOOST_CHECK_SMALL((vecs_W.col(i) - tf.fromHorizontalToWorldFrame(vec, rpy)).norm(), 1e-12);
+	}
+
+	// The transforms could be done in place, and with a yaw angle per vector
+	Eigen::VectorXd yaws = Eigen::VectorXd::LinSpaced(vecs.cols(), -1., 1.);
+	Eigen::Matrix3Xd vecs_inplace = vecs;
+	tf.fromWorldToHorizontalFrame(vecs_inplace, vecs_inplace, yaws);
+	for (unsigned int i = 0; i < vecs.cols(); i++) {
+		Eigen::Vector3d vec = vecs.col(i);
+		Eigen::Vector3d vec_H =
+				tf.fromWorldToHorizontalFrame(vec, Eigen::Vector3d(0.3, 0.1, yaws(i)));
+		BOOST_CHECK_SMALL((vecs_inplace.col(i) - vec_H).norm(), 1e-12);
+	}
+	tf.fromBaseToWorldFrame(vecs_inplace, vecs_inplace, q);
+	tf.fromWorldToBaseFrame(vecs_inplace, vecs_inplace, q);
+	tf.fromHorizontalToWorldFrame(vecs_inplace, vecs_inplace, yaws);
+	BOOST_CHECK_SMALL((vecs_inplace - vecs).norm(), 1e-12);
+}
@@ -0,0 +1,59 @@
+#include <dwl/utils/WorkerPool.h>
+#include <dwl/solver/OptimizationSolver.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+/** @brief Solver that iterates until the cancellation is requested */
+class CancellableSolver : public dwl::solver::OptimizationSolver
+{
+	public:
+		bool compute(double computation_time) {
+			while (!isCancellationRequested())
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			return false;
+		}
+};
+
+
+BOOST_AUTO_TEST_CASE(worker_pool) // specify a test case for the worker pool
+{
+	// Every submitted task is run, including the queued ones of the destruction
+	std::atomic<unsigned int> num_runs(0);
+	{
+		dwl::utils::WorkerPool pool(2);
+		BOOST_CHECK_EQUAL(pool.getNumberOfWorkers(), 2);
+		for (unsigned int i = 0; i < 100; i++)
+			pool.submit([&num_runs] { num_runs++; });
+	}
+	BOOST_CHECK_EQUAL(num_runs, 100);
+
+	// The default pool has one worker at least
+	BOOST_CHECK(dwl::utils::WorkerPool::getDefault().getNumberOfWorkers() > 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(solver_cancellation) // specify a test case for the solver cancellation
+{
+	// A computation in the pool is stopped by the cancellation request
+	CancellableSolver solver;
+	dwl::utils::WorkerPool pool(1);
+	std::promise<bool> promise;
+	std::future<bool> result = promise.get_future();
+	pool.submit([&solver, &promise] { promise.set_value(solver.compute(1.)); });
+	BOOST_CHECK(result.wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout);
+
+	solver.requestCancellation();
+	BOOST_CHECK(result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+	BOOST_CHECK(!result.get());
+	BOOST_CHECK(solver.isCancellationRequested());
+
+	// The request holds until it's reset
+	solver.resetCancellation();
+	BOOST_CHECK(!solver.isCancellationRequested());
+}
@@ -0,0 +1,74 @@
+#include <dwl/utils/YamlWrapper.h>
+#include <fstream>
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE DWL_TESTS
+#include <boost/test/included/unit_test.hpp>
+
+
+
+void writeFile(const std::string& filename,
+			   const std::string& content)
+{
+	std::ofstream file(filename.c_str());
+	file << content;
+}
+
+
+BOOST_AUTO_TEST_CASE(read_namespaces) // specify a test case for reading namespaces
+{
+	std::string filename = "yaml_wrapper_utest.yaml";
+	writeFile(filename, "solver:\n  termination:\n    max_iter: 10\n    tol: 1e-6\n"
+			"  output:\n    verbose: true\n");
+	dwl::YamlWrapper::clearFileCache();
+
+	// The same namespace is read many times from the parsed document
+	dwl::YamlWrapper yaml_reader(filename);
+	dwl::YamlNamespace termination_ns = {"solver", "termination"};
+	int max_iter = 0;
+	double tol = 0.;
+	bool verbose = false;
+	for (unsigned int i = 0; i < 3; i++) {
+		BOOST_CHECK(yaml_reader.read(max_iter, "max_iter", termination_ns));
+		BOOST_CHECK(yaml_reader.read(tol, "tol", termination_ns));
+	}
+	BOOST_CHECK(yaml_reader.read(verbose, "verbose", {"solver", "output"}));
+	BOOST_CHECK_EQUAL(max_iter, 10);
+	BOOST_CHECK_CLOSE(tol, 1e-6, 1e-9);
+	BOOST_CHECK(verbose);
+
+	// Missing fields and namespaces don't modify the document
+	BOOST_CHECK(!yaml_reader.read(max_iter, "max_iter", {"solver", "barrier"}));
+	BOOST_CHECK(!yaml_reader.read(max_iter, "print_level", termination_ns));
+	dwl::YamlWrapper other_reader(filename);
+	BOOST_CHECK(other_reader.read(max_iter, "max_iter", termination_ns));
+	BOOST_CHECK_EQUAL(max_iter, 10);
+
+	unlink(filename.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(file_changes) // specify a test case for the invalidation of the cache
+{
+	std::string filename = "yaml_wrapper_utest.yaml";
+	writeFile(filename, "max_iter: 10\n");
+	dwl::YamlWrapper::clearFileCache();
+
+	int max_iter = 0;
+	dwl::YamlWrapper yaml_reader(filename);
+	BOOST_CHECK(yaml_reader.read(max_iter, "max_iter"));
+	BOOST_CHECK_EQUAL(max_iter, 10);
+
+	// A new wrapper parses the file again once it changes
+	writeFile(filename, "max_iter: 200\n");
+	dwl::YamlWrapper new_reader(filename);
+	BOOST_CHECK(new_reader.read(max_iter, "max_iter"));
+	BOOST_CHECK_EQUAL(max_iter, 200);
+
+	// Setting the file reloads the document of a wrapper
+	yaml_reader.setFile(filename);
+	BOOST_CHECK(yaml_reader.read(max_iter, "max_iter"));
+	BOOST_CHECK_EQUAL(max_iter, 200);
+
+	unlink(filename.c_str());
+}
@@ -17,6 +17,11 @@ class HS071Cost : public ocp::Cost
 		HS071Cost() {name_ = "HS071";}
 		~HS071Cost() {}
 
+		HS071Cost* clone() const
+		{
+			return new HS071Cost(*this);
+		}
+
 		void compute(double& cost,
 					 const WholeBodyState& state)
 		{
@@ -46,6 +46,11 @@ class HS071DynamicalSystem : public ocp::DynamicalSystem
 
 		~HS071DynamicalSystem() {}
 
+		HS071DynamicalSystem* clone() const
+		{
+			return new HS071DynamicalSystem(*this);
+		}
+
 		void compute(Eigen::VectorXd& constraint,
 					 const WholeBodyState& state)
 		{
@@ -57,6 +62,11 @@ class HS071DynamicalSystem : public ocp::DynamicalSystem
 					state.joint_pos(3) * state.joint_pos(3);
 		}
 
+		unsigned int getIntegrationDimension()
+		{
+			return 0;
+		}
+
 		void getBounds(Eigen::VectorXd& lower_bound,
 					   Eigen::VectorXd& upper_bound)
 		{